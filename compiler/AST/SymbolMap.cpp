@@ -0,0 +1,218 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SymbolMap.h"
+
+#include "symbol.h"
+
+#include <cstdint>
+
+// Fibonacci hashing of the symbol's id; 'mask' is the table size - 1.
+static inline unsigned int slotFor(Symbol* key, unsigned int mask) {
+  uint32_t h = (uint32_t) key->id * 2654435769u;
+
+  return (h ^ (h >> 16)) & mask;
+}
+
+SymbolMap::SymbolMap() : n(0), v(NULL), used(0) {
+
+}
+
+SymbolMap::SymbolMap(const SymbolMap& other) : n(0), v(NULL), used(0) {
+  copy(other);
+}
+
+SymbolMap::~SymbolMap() {
+  clear();
+}
+
+SymbolMap& SymbolMap::operator=(const SymbolMap& other) {
+  if (this != &other) {
+    copy(other);
+  }
+
+  return *this;
+}
+
+void SymbolMap::clear() {
+  if (v != NULL && v != small) {
+    free(v);
+  }
+
+  n    = 0;
+  v    = NULL;
+  used = 0;
+}
+
+void SymbolMap::copy(const SymbolMap& other) {
+  if (this == &other) {
+    return;
+  }
+
+  clear();
+
+  if (other.v == NULL) {
+    return;
+
+  } else if (other.v == other.small) {
+    for (int i = 0; i < other.n; i++) {
+      small[i].key   = other.small[i].key;
+      small[i].value = other.small[i].value;
+    }
+
+    v = small;
+
+  } else {
+    v = (SymbolMapElem*) malloc(other.n * sizeof(SymbolMapElem));
+    memcpy((void*) v, other.v, other.n * sizeof(SymbolMapElem));
+  }
+
+  n    = other.n;
+  used = other.used;
+}
+
+SymbolMapElem* SymbolMap::find(Symbol* key) const {
+  if (key == NULL || v == NULL) {
+    return NULL;
+
+  } else if (v == small) {
+    for (int i = 0; i < n; i++) {
+      if (small[i].key == key) {
+        return &v[i];
+      }
+    }
+
+  } else {
+    unsigned int mask = n - 1;
+
+    for (unsigned int i = slotFor(key, mask); v[i].key; i = (i + 1) & mask) {
+      if (v[i].key == key) {
+        return &v[i];
+      }
+    }
+  }
+
+  return NULL;
+}
+
+Symbol* SymbolMap::get(Symbol* key) const {
+  SymbolMapElem* elem = find(key);
+
+  return elem != NULL ? elem->value : NULL;
+}
+
+SymbolMapElem* SymbolMap::get_record(Symbol* key) const {
+  return find(key);
+}
+
+SymbolMapElem* SymbolMap::put(Symbol* key, Symbol* value) {
+  if (key == NULL) {
+    return NULL;
+  }
+
+  if (SymbolMapElem* elem = find(key)) {
+    elem->value = value;
+    return elem;
+  }
+
+  if (v == NULL) {
+    v = small;
+  }
+
+  if (v == small && used < SMALL_SIZE) {
+    small[used].key   = key;
+    small[used].value = value;
+    n = ++used;
+
+    return &small[used - 1];
+  }
+
+  if (v == small) {
+    rehash(MIN_TABLE_SIZE);
+
+  } else if (2 * (used + 1) > n) {
+    rehash(2 * n);
+  }
+
+  insert(key, value);
+
+  return find(key);
+}
+
+// Add an entry known not to be in the table, which has room for it.
+void SymbolMap::insert(Symbol* key, Symbol* value) {
+  unsigned int mask = n - 1;
+  unsigned int i    = slotFor(key, mask);
+
+  while (v[i].key) {
+    i = (i + 1) & mask;
+  }
+
+  v[i].key   = key;
+  v[i].value = value;
+  used++;
+}
+
+void SymbolMap::rehash(int size) {
+  SymbolMapElem* oldV = v;
+  int            oldN = n;
+
+  v    = (SymbolMapElem*) calloc(size, sizeof(SymbolMapElem));
+  n    = size;
+  used = 0;
+
+  for (int i = 0; i < oldN; i++) {
+    if (oldV[i].key) {
+      insert(oldV[i].key, oldV[i].value);
+    }
+  }
+
+  if (oldV != small) {
+    free(oldV);
+  }
+}
+
+void SymbolMap::map_union(const SymbolMap& other) {
+  for (int i = 0; i < other.n; i++) {
+    if (other.v[i].key) {
+      put(other.v[i].key, other.v[i].value);
+    }
+  }
+}
+
+int SymbolMap::count() const {
+  return used;
+}
+
+void SymbolMap::get_keys(Vec<Symbol*>& keys) const {
+  for (int i = 0; i < n; i++) {
+    if (v[i].key) {
+      keys.add(v[i].key);
+    }
+  }
+}
+
+void SymbolMap::get_values(Vec<Symbol*>& values) const {
+  for (int i = 0; i < n; i++) {
+    if (v[i].key) {
+      values.add(v[i].value);
+    }
+  }
+}
@@ -46,6 +46,8 @@
 #include "type.h"
 #include "WhileStmt.h"
 
+#include <cstdlib>
+#include <new>
 #include <ostream>
 #include <sstream>
 #include <string>
@@ -58,6 +60,92 @@ foreach_ast(decl_gvecs);
 
 static int uid = 1;
 
+/************************************* | **************************************
+*                                                                             *
+* AST nodes are carved out of large slabs instead of being malloc'ed one at   *
+* a time, which saves the per-allocation overhead on millions of small nodes. *
+* There is a free list per (rounded) node size, so a node deleted by          *
+* cleanAst() is reused by the next node of the same size, which in practice   *
+* is the same node type.  Slabs are never returned; the compiler's AST only   *
+* shrinks for brief periods.                                                  *
+*                                                                             *
+* Setting CHPL_DISABLE_AST_POOL in the environment allocates each node with   *
+* the global operator new instead, so tools like valgrind can see them.       *
+*                                                                             *
+************************************** | *************************************/
+
+static const size_t kAstPoolAlign   = alignof(std::max_align_t);
+static const size_t kAstPoolMaxSize = 1024;        // larger nodes aren't pooled
+static const size_t kAstPoolSlab    = 1024 * 1024;
+
+struct AstPoolFreeNode {
+  AstPoolFreeNode* next;
+};
+
+static AstPoolFreeNode* astPoolFreeLists[kAstPoolMaxSize / kAstPoolAlign + 1];
+static char*            astPoolCur     = NULL;
+static char*            astPoolEnd     = NULL;
+static int              astPoolEnabled = -1;       // not yet decided
+
+static bool useAstPool(size_t size) {
+  if (astPoolEnabled < 0)
+    astPoolEnabled = getenv("CHPL_DISABLE_AST_POOL") == NULL ? 1 : 0;
+
+  return astPoolEnabled == 1 && size <= kAstPoolMaxSize;
+}
+
+static size_t astPoolRoundSize(size_t size) {
+  return (size + kAstPoolAlign - 1) / kAstPoolAlign * kAstPoolAlign;
+}
+
+void* BaseAST::operator new(size_t size) {
+  if (useAstPool(size) == false)
+    return ::operator new(size);
+
+  size_t            rounded = astPoolRoundSize(size);
+  AstPoolFreeNode*& head    = astPoolFreeLists[rounded / kAstPoolAlign];
+
+  if (head != NULL) {
+    void* ptr = head;
+
+    head = head->next;
+
+    return ptr;
+  }
+
+  if (astPoolCur == NULL || astPoolCur + rounded > astPoolEnd) {
+    astPoolCur = (char*) malloc(kAstPoolSlab);
+
+    if (astPoolCur == NULL)
+      throw std::bad_alloc();
+
+    astPoolEnd = astPoolCur + kAstPoolSlab;
+  }
+
+  void* ptr = astPoolCur;
+
+  astPoolCur += rounded;
+
+  return ptr;
+}
+
+void BaseAST::operator delete(void* ptr, size_t size) {
+  if (ptr == NULL)
+    return;
+
+  if (useAstPool(size) == false) {
+    ::operator delete(ptr);
+    return;
+  }
+
+  AstPoolFreeNode*  node = (AstPoolFreeNode*) ptr;
+  AstPoolFreeNode*& head = astPoolFreeLists[astPoolRoundSize(size) /
+                                            kAstPoolAlign];
+
+  node->next = head;
+  head       = node;
+}
+
 #define decl_counters(type)                                             \
   int n##type = g##type##s.n, k##type = n##type*sizeof(type)/1024
 
@@ -26,6 +26,7 @@
 #include "DoWhileStmt.h"
 #include "driver.h"
 #include "ForLoop.h"
+#include "sparseBitVec.h"
 #include "stlUtil.h"
 #include "stmt.h"
 #include "view.h"
@@ -616,45 +617,57 @@ void BasicBlock::computeBackwardOrder(FnSymbol* fn,
 }
 
 //#define DEBUG_FLOW
-void BasicBlock::backwardFlowAnalysis(FnSymbol*             fn,
-                                      std::vector<BitVec*>& GEN,
-                                      std::vector<BitVec*>& KILL,
-                                      std::vector<BitVec*>& IN,
-                                      std::vector<BitVec*>& OUT) {
-  bool iterate = true;
+//
+// A worklist solver: a block is revisited only when the IN set of one
+// of its successors changed.  The blocks start on the list in reverse
+// order so, in the common case of blocks numbered in program order,
+// successors are mostly processed before their predecessors.
+//
+void BasicBlock::backwardFlowAnalysis(FnSymbol*                   fn,
+                                      std::vector<SparseBitVec*>& GEN,
+                                      std::vector<SparseBitVec*>& KILL,
+                                      std::vector<SparseBitVec*>& IN,
+                                      std::vector<SparseBitVec*>& OUT) {
+  size_t            nbbs = fn->basicBlocks->size();
+  std::queue<int>   work;
+  std::vector<bool> queued(nbbs, true);
+  SparseBitVec      newIn;
+
+  for (size_t i = nbbs; i > 0; i--) {
+    work.push(i - 1);
+  }
 
-  while (iterate) {
-    int i = 0;
+  while (work.empty() == false) {
+    int         i  = work.front();
+    BasicBlock* bb = (*fn->basicBlocks)[i];
 
-    iterate = false;
+    work.pop();
+    queued[i] = false;
 
-    for_vector(BasicBlock, bb, *fn->basicBlocks) {
-      for (size_t j = 0; j < IN[i]->ndata; j++) {
-        unsigned int new_in  = (OUT[i]->data[j] & ~KILL[i]->data[j]) | GEN[i]->data[j];
-        unsigned int new_out = 0;
+    for_vector(BasicBlock, bbout, bb->outs) {
+      OUT[i]->disjunction(*IN[bbout->id]);
+    }
 
-        if (new_in != IN[i]->data[j]) {
-          IN[i]->data[j] = new_in;
-          iterate = true;
-        }
+    newIn = *OUT[i];
+    newIn.difference(*KILL[i]);
+    newIn.disjunction(*GEN[i]);
 
-        for_vector(BasicBlock, bbout, bb->outs) {
-          new_out = new_out | IN[bbout->id]->data[j];
-        }
+    if (newIn != *IN[i]) {
+      *IN[i] = newIn;
 
-        if (new_out != OUT[i]->data[j]) {
-          OUT[i]->data[j] = new_out;
-          iterate = true;
+      for_vector(BasicBlock, bbin, bb->ins) {
+        if (queued[bbin->id] == false) {
+          queued[bbin->id] = true;
+          work.push(bbin->id);
         }
       }
-
-      i++;
     }
+  }
+
 #ifdef DEBUG_FLOW
-    printf("IN\n");  printBitVectorSets(IN);
-    printf("OUT\n"); printBitVectorSets(OUT);
+  printf("IN\n");  printBitVectorSets(IN);
+  printf("OUT\n"); printBitVectorSets(OUT);
 #endif
-  }
 }
 
 
@@ -694,7 +707,7 @@ void BasicBlock::forwardFlowAnalysis(FnSymbol*             fn,
 
     for (size_t j = 0; j < IN[i]->ndata; j++) {
       if (bb->ins.size() > 0) {
-        unsigned int new_in = (intersect) ? (unsigned int) (-1) : 0;
+        BitVec::Word new_in = (intersect) ? ~((BitVec::Word) 0) : 0;
 
         for_vector(BasicBlock, bbin, bb->ins) {
           if (intersect)
@@ -709,7 +722,7 @@ void BasicBlock::forwardFlowAnalysis(FnSymbol*             fn,
         }
       }
 
-      unsigned int new_out = (IN[i]->data[j] & ~KILL[i]->data[j]) | GEN[i]->data[j];
+      BitVec::Word new_out = (IN[i]->data[j] & ~KILL[i]->data[j]) | GEN[i]->data[j];
 
       if (new_out != OUT[i]->data[j]) {
         OUT[i]->data[j] = new_out;
@@ -818,3 +831,38 @@ void BasicBlock::printBitVectorSets(std::vector<BitVec*>& sets) {
 
   printf("\n");
 }
+
+void BasicBlock::printLocalsVectorSets(std::vector<SparseBitVec*>& sets,
+                                       Vec<Symbol*>                locals) {
+  int i = 0;
+
+  for_vector(SparseBitVec, set, sets) {
+    printf("%2d: ", i);
+
+    for (size_t j = set->first(); j != SparseBitVec::npos; j = set->next(j))
+      printf("%s[%d] ", locals.v[j]->name, locals.v[j]->id);
+
+    printf("\n");
+
+    i++;
+  }
+
+  printf("\n");
+}
+
+void BasicBlock::printBitVectorSets(std::vector<SparseBitVec*>& sets) {
+  int i = 0;
+
+  for_vector(SparseBitVec, set, sets) {
+    printf("%2d: ", i);
+
+    for (size_t j = set->first(); j != SparseBitVec::npos; j = set->next(j))
+      printf("%zu ", j);
+
+    printf("\n");
+
+    i++;
+  }
+
+  printf("\n");
+}
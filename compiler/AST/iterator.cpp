@@ -22,7 +22,6 @@
 
 #include "astutil.h"
 #include "bb.h"
-#include "bitVec.h"
 #include "CForLoop.h"
 #include "driver.h"
 #include "expr.h"
@@ -33,6 +32,7 @@
 #include "preFold.h"
 #include "resolution.h"
 #include "resolveFunction.h"
+#include "sparseBitVec.h"
 #include "stlUtil.h"
 #include "stmt.h"
 #include "stringutil.h"
@@ -1528,7 +1528,7 @@ static void collectLiveLocalVariables(Vec<Symbol*>& syms, FnSymbol* fn, BlockStm
   Map<Symbol*,int> localMap;
   Vec<SymExpr*> useSet;
   Vec<SymExpr*> defSet;
-  std::vector<BitVec*> OUT;
+  std::vector<SparseBitVec*> OUT;
 
   liveVariableAnalysis(fn, locals, localMap, useSet, defSet, OUT);
 
@@ -1551,12 +1551,7 @@ static void collectLiveLocalVariables(Vec<Symbol*>& syms, FnSymbol* fn, BlockStm
     }
 
     if (collect) {
-      BitVec live(locals.n);
-
-      for (int j = 0; j < locals.n; j++) {
-        if (OUT[block]->get(j))
-          live.set(j);
-      }
+      SparseBitVec live(*OUT[block]);
 
       for (int k = bb->exprs.size() - 1; k >= 0; k--) {
         CallExpr*             call = toCallExpr(bb->exprs[k]);
@@ -1565,10 +1560,10 @@ static void collectLiveLocalVariables(Vec<Symbol*>& syms, FnSymbol* fn, BlockStm
         if ((call && call->isPrimitive(PRIM_YIELD)) ||
             (singleLoop && bb->exprs[k] == singleLoop->next) ||
             (singleLoop && bb->exprs[k] == singleLoop->body.head)) {
-          for (int j = 0; j < locals.n; j++) {
-            if (live.get(j)) {
-              syms.add_exclusive(locals.v[j]);
-            }
+          for (size_t j = live.first();
+               j != SparseBitVec::npos;
+               j = live.next(j)) {
+            syms.add_exclusive(locals.v[j]);
           }
         }
 
@@ -1587,7 +1582,7 @@ static void collectLiveLocalVariables(Vec<Symbol*>& syms, FnSymbol* fn, BlockStm
     block++;
   }
 
-  for_vector(BitVec, out, OUT)
+  for_vector(SparseBitVec, out, OUT)
     delete out;
 
   // C_FOR_LOOP needs to ensure the for-loop init variables are also
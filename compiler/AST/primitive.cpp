@@ -1077,6 +1077,8 @@ initPrimitive() {
 
   // used in error-handling conditional. args: error variable
   prim_def(PRIM_CHECK_ERROR, "check error", returnInfoVoid, false, false);
+  // the boolean argument, with a hint to the backend that it is rarely true
+  prim_def(PRIM_UNLIKELY, "unlikely", returnInfoBool);
   // used before error handling is lowered to represent the current error
   prim_def(PRIM_CURRENT_ERROR, "current error", returnInfoError, false, false);
 
@@ -1140,6 +1142,15 @@ initPrimitive() {
   // That symbol includes OPT_INFO_... flags.
   prim_def(PRIM_OPTIMIZATION_INFO, "optimization info", returnInfoVoid, true, false);
 
+  // GPU kernels outlined by outlineGpuKernels().
+  // The global ID of the current thread in a kernel.
+  prim_def(PRIM_GPU_THREAD_ID, "gpu thread id", returnInfoInt64);
+  // Is the current task running on a GPU sublocale?
+  prim_def(PRIM_GPU_ON_GPU_SUBLOC, "gpu on gpu sublocale", returnInfoBool);
+  // args are: kernel name, lo, hi, then the kernel's other arguments.
+  // Runs the kernel once for each index in lo..hi.
+  prim_def(PRIM_GPU_KERNEL_LAUNCH, "gpu kernel launch", returnInfoVoid, true, true);
+
   prim_def(PRIM_GATHER_TESTS, "gather tests", returnInfoDefaultInt);
   prim_def(PRIM_GET_TEST_BY_NAME, "get test by name", returnInfoVoid);
   prim_def(PRIM_GET_TEST_BY_INDEX, "get test by index", returnInfoVoid);
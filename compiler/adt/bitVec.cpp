@@ -22,7 +22,20 @@
 
 #include <cstdlib>
 
-#define TYPE unsigned
+static inline size_t wordOf(size_t i) {
+  return i / BitVec::WORD_BITS;
+}
+
+static inline BitVec::Word maskOf(size_t i) {
+  return ((BitVec::Word) 1) << (i % BitVec::WORD_BITS);
+}
+
+// The bits of the last word that are inside the vector.
+static inline BitVec::Word tailMask(size_t in_size) {
+  size_t rem = in_size % BitVec::WORD_BITS;
+
+  return (rem == 0) ? ~((BitVec::Word) 0) : maskOf(rem) - 1;
+}
 
 BitVec::BitVec(size_t in_size) {
   if (in_size == 0) {
@@ -30,9 +43,9 @@ BitVec::BitVec(size_t in_size) {
     this->in_size = 0;
     data          = NULL;
   } else {
-    ndata         = 1 + (in_size - 1) / (sizeof(TYPE) << 3);
+    ndata         = 1 + (in_size - 1) / WORD_BITS;
     this->in_size = in_size;
-    data          = (TYPE*) calloc(ndata, sizeof(TYPE));
+    data          = (Word*) calloc(ndata, sizeof(Word));
   }
 }
 
@@ -44,7 +57,7 @@ BitVec::BitVec(const BitVec& rhs)
 {
   if (ndata > 0)
   {
-    data = (TYPE*) calloc(ndata, sizeof(TYPE));
+    data = (Word*) malloc(ndata * sizeof(Word));
 
     copy(rhs);
   }
@@ -68,18 +81,12 @@ bool BitVec::get(size_t i) const {
     INT_FATAL("BitVec::get -- operand out of range.");
 #endif
 
-  size_t j = i / (sizeof(TYPE) << 3);
-  size_t k = i - j * (sizeof(TYPE) << 3);
-
-  return data[j] & (1 << k);
+  return (data[wordOf(i)] & maskOf(i)) != 0;
 }
 
 
 void BitVec::unset(size_t i) {
-  size_t j = i / (sizeof(TYPE) << 3);
-  size_t k = i - j * (sizeof(TYPE) << 3);
-
-  data[j] &= ((TYPE)-1) - (1 << k);
+  data[wordOf(i)] &= ~maskOf(i);
 }
 
 
@@ -89,8 +96,11 @@ void BitVec::disjunction(const BitVec& other) {
     INT_FATAL("BitVec::disjunction -- operand lengths must be equal.");
 #endif
 
+  Word*       __restrict__ d = data;
+  const Word* __restrict__ o = other.data;
+
   for (size_t i = 0; i < ndata; i++)
-    data[i] |= other.data[i];
+    d[i] |= o[i];
 }
 
 
@@ -100,8 +110,25 @@ void BitVec::intersection(const BitVec& other) {
     INT_FATAL("BitVec::intersection -- operand lengths must be equal.");
 #endif
 
+  Word*       __restrict__ d = data;
+  const Word* __restrict__ o = other.data;
+
+  for (size_t i = 0; i < ndata; i++)
+    d[i] &= o[i];
+}
+
+
+void BitVec::difference(const BitVec& other) {
+#if DEBUG
+  if (other.in_size != in_size)
+    INT_FATAL("BitVec::difference -- operand lengths must be equal.");
+#endif
+
+  Word*       __restrict__ d = data;
+  const Word* __restrict__ o = other.data;
+
   for (size_t i = 0; i < ndata; i++)
-    data[i] &= other.data[i];
+    d[i] &= ~o[i];
 }
 
 
@@ -119,29 +146,26 @@ bool BitVec::equals(const BitVec& other) const {
     INT_FATAL("BitVec::disjunction -- operand lengths must be equal.");
 #endif
 
-  bool retval = true;
+  Word diff = 0;
 
-  for (size_t i = 0; i < ndata && retval == true; i++) {
-    if (data[i] != other.data[i]) {
-      retval = false;
-    }
-  }
+  for (size_t i = 0; i < ndata; i++)
+    diff |= data[i] ^ other.data[i];
 
-  return retval;
+  return diff == 0;
 }
 
 
 void BitVec::set() {
   for (size_t i = 0; i < ndata; i++)
-    data[i] = ~0;
+    data[i] = ~((Word) 0);
+
+  if (ndata > 0)
+    data[ndata - 1] &= tailMask(in_size);
 }
 
 
 void BitVec::set(size_t i) {
-  size_t j = i / (sizeof(TYPE) << 3);
-  size_t k = i - j * (sizeof(TYPE) << 3);
-
-  data[j] |= 1 << k;
+  data[wordOf(i)] |= maskOf(i);
 }
 
 
@@ -152,10 +176,7 @@ void BitVec::reset() {
 
 
 void BitVec::reset(size_t i) {
-  size_t j = i / (sizeof(TYPE) << 3);
-  size_t k = i - j * (sizeof(TYPE) << 3);
-
-  data[j] &= ((size_t)-1) - (1 << k);
+  data[wordOf(i)] &= ~maskOf(i);
 }
 
 
@@ -166,50 +187,32 @@ void BitVec::copy(const BitVec& other) {
 
 
 void BitVec::copy(size_t i, bool value) {
-  size_t j = i / (sizeof(TYPE) << 3);
-  size_t k = i - j * (sizeof(TYPE) << 3);
-
-  data[j] &= ~(1 << k);
-
   if (value)
-    data[j] |= (1 << k);
+    set(i);
+  else
+    reset(i);
 }
 
 
 void BitVec::flip() {
   for (size_t i = 0; i < ndata; i++)
     data[i] = ~data[i];
+
+  if (ndata > 0)
+    data[ndata - 1] &= tailMask(in_size);
 }
 
 
 void BitVec::flip(size_t i) {
-  size_t j = i / (sizeof(TYPE)<<3);
-  size_t k = i - j*(sizeof(TYPE)<<3);
-
-  data[j] ^= 1 << k;
+  data[wordOf(i)] ^= maskOf(i);
 }
 
 
-/*
- * The current use of this function expects there to be almost no 1's
- * in which case this algorithm is the most efficient instead of an
- * implementation that uses divide and conquer shifting and counting with
- * hex manipulation (I have no idea what the name of that bit counting
- * algorithm is)
- */
 size_t BitVec::count() const {
   size_t count = 0;
 
-  for (size_t i = 0; i < ndata; i++) {
-    size_t localCount = 0;
-    size_t x          = data[i];
-
-    for (localCount = 0; x; localCount++) {
-      x &= x - 1;
-    }
-
-    count += localCount;
-  }
+  for (size_t i = 0; i < ndata; i++)
+    count += __builtin_popcountll(data[i]);
 
   return count;
 }
@@ -221,23 +224,17 @@ size_t BitVec::size() const {
 
 
 bool BitVec::test(size_t i) const {
-  size_t j = i / (sizeof(TYPE) << 3);
-  size_t k = i - j * (sizeof(TYPE) << 3);
-
-  return data[j] & (1 << k);
+  return (data[wordOf(i)] & maskOf(i)) != 0;
 }
 
 
 bool BitVec::any() const {
-  bool retval = false;
+  Word any = 0;
 
-  for (size_t i = 0; i < ndata && retval == false; i++) {
-    if (data[i] > 0) {
-      retval = true;
-    }
-  }
+  for (size_t i = 0; i < ndata; i++)
+    any |= data[i];
 
-  return retval;
+  return any != 0;
 }
 
 
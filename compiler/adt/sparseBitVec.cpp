@@ -0,0 +1,254 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sparseBitVec.h"
+
+#include <algorithm>
+
+static const size_t WORD_BITS = 64;
+
+static inline SparseBitVec::Word maskOf(size_t i) {
+  return ((SparseBitVec::Word) 1) << (i % WORD_BITS);
+}
+
+SparseBitVec::SparseBitVec() {
+
+}
+
+void SparseBitVec::clear() {
+  mIndex.clear();
+  mBits.clear();
+}
+
+// The position of the first stored word whose index is >= 'word'.
+size_t SparseBitVec::find(size_t word) const {
+  return std::lower_bound(mIndex.begin(), mIndex.end(), word) -
+         mIndex.begin();
+}
+
+bool SparseBitVec::get(size_t i) const {
+  size_t word = i / WORD_BITS;
+  size_t pos  = find(word);
+
+  return pos < mIndex.size() && mIndex[pos] == word &&
+         (mBits[pos] & maskOf(i)) != 0;
+}
+
+bool SparseBitVec::test(size_t i) const {
+  return get(i);
+}
+
+void SparseBitVec::set(size_t i) {
+  size_t word = i / WORD_BITS;
+  size_t pos  = find(word);
+
+  if (pos < mIndex.size() && mIndex[pos] == word) {
+    mBits[pos] |= maskOf(i);
+
+  } else {
+    mIndex.insert(mIndex.begin() + pos, word);
+    mBits.insert(mBits.begin() + pos, maskOf(i));
+  }
+}
+
+void SparseBitVec::reset(size_t i) {
+  size_t word = i / WORD_BITS;
+  size_t pos  = find(word);
+
+  if (pos < mIndex.size() && mIndex[pos] == word) {
+    mBits[pos] &= ~maskOf(i);
+
+    if (mBits[pos] == 0) {
+      mIndex.erase(mIndex.begin() + pos);
+      mBits.erase(mBits.begin() + pos);
+    }
+  }
+}
+
+bool SparseBitVec::disjunction(const SparseBitVec& other) {
+  size_t n = mIndex.size();
+  size_t m = other.mIndex.size();
+
+  if (m == 0) {
+    return false;
+  }
+
+  std::vector<size_t> index;
+  std::vector<Word>   bits;
+  bool                changed = false;
+  size_t              i       = 0;
+  size_t              j       = 0;
+
+  index.reserve(n + m);
+  bits.reserve(n + m);
+
+  while (i < n || j < m) {
+    if (j == m || (i < n && mIndex[i] < other.mIndex[j])) {
+      index.push_back(mIndex[i]);
+      bits.push_back(mBits[i]);
+      i++;
+
+    } else if (i == n || other.mIndex[j] < mIndex[i]) {
+      index.push_back(other.mIndex[j]);
+      bits.push_back(other.mBits[j]);
+      changed = true;
+      j++;
+
+    } else {
+      Word w = mBits[i] | other.mBits[j];
+
+      changed = changed || w != mBits[i];
+
+      index.push_back(mIndex[i]);
+      bits.push_back(w);
+      i++;
+      j++;
+    }
+  }
+
+  if (changed) {
+    mIndex.swap(index);
+    mBits.swap(bits);
+  }
+
+  return changed;
+}
+
+bool SparseBitVec::intersection(const SparseBitVec& other) {
+  size_t n       = mIndex.size();
+  size_t m       = other.mIndex.size();
+  size_t out     = 0;
+  size_t j       = 0;
+  bool   changed = false;
+
+  for (size_t i = 0; i < n; i++) {
+    Word w = 0;
+
+    while (j < m && other.mIndex[j] < mIndex[i]) {
+      j++;
+    }
+
+    if (j < m && other.mIndex[j] == mIndex[i]) {
+      w = mBits[i] & other.mBits[j];
+    }
+
+    changed = changed || w != mBits[i];
+
+    if (w != 0) {
+      mIndex[out] = mIndex[i];
+      mBits[out]  = w;
+      out++;
+    }
+  }
+
+  mIndex.resize(out);
+  mBits.resize(out);
+
+  return changed;
+}
+
+bool SparseBitVec::difference(const SparseBitVec& other) {
+  size_t n       = mIndex.size();
+  size_t m       = other.mIndex.size();
+  size_t out     = 0;
+  size_t j       = 0;
+  bool   changed = false;
+
+  for (size_t i = 0; i < n; i++) {
+    Word w = mBits[i];
+
+    while (j < m && other.mIndex[j] < mIndex[i]) {
+      j++;
+    }
+
+    if (j < m && other.mIndex[j] == mIndex[i]) {
+      w &= ~other.mBits[j];
+    }
+
+    changed = changed || w != mBits[i];
+
+    if (w != 0) {
+      mIndex[out] = mIndex[i];
+      mBits[out]  = w;
+      out++;
+    }
+  }
+
+  mIndex.resize(out);
+  mBits.resize(out);
+
+  return changed;
+}
+
+bool SparseBitVec::equals(const SparseBitVec& other) const {
+  return mIndex == other.mIndex && mBits == other.mBits;
+}
+
+size_t SparseBitVec::count() const {
+  size_t count = 0;
+
+  for (size_t i = 0; i < mBits.size(); i++) {
+    count += __builtin_popcountll(mBits[i]);
+  }
+
+  return count;
+}
+
+bool SparseBitVec::any() const {
+  return mIndex.empty() == false;
+}
+
+bool SparseBitVec::none() const {
+  return mIndex.empty();
+}
+
+size_t SparseBitVec::first() const {
+  if (mIndex.empty()) {
+    return npos;
+  }
+
+  return mIndex[0] * WORD_BITS + __builtin_ctzll(mBits[0]);
+}
+
+size_t SparseBitVec::next(size_t i) const {
+  size_t word = i / WORD_BITS;
+  size_t pos  = find(word);
+
+  if (pos < mIndex.size() && mIndex[pos] == word) {
+    size_t bit  = i % WORD_BITS;
+    Word   rest = 0;
+
+    if (bit + 1 < WORD_BITS) {
+      rest = mBits[pos] & ~(maskOf(bit + 1) - 1);
+    }
+
+    if (rest != 0) {
+      return word * WORD_BITS + __builtin_ctzll(rest);
+    }
+
+    pos++;
+  }
+
+  if (pos == mIndex.size()) {
+    return npos;
+  }
+
+  return mIndex[pos] * WORD_BITS + __builtin_ctzll(mBits[pos]);
+}
@@ -40,7 +40,11 @@
 // Returns the loop metadata node to associate with the branch.
 // If thisLoopParallelAccess is set, accessGroup will be set to the
 // metadata node to use in llvm.access.group metadata for this loop.
-static llvm::MDNode* generateLoopMetadata(bool thisLoopParallelAccess,
+// The vectorization hints are only added if vectorize is set, and
+// unroll-and-jam is requested if unrollAndJamCount > 1.
+static llvm::MDNode* generateLoopMetadata(bool vectorize,
+                                          bool thisLoopParallelAccess,
+                                          int  unrollAndJamCount,
                                           llvm::MDNode*& accessGroup)
 {
   GenInfo* info = gGenInfo;
@@ -51,6 +55,24 @@ static llvm::MDNode* generateLoopMetadata(bool thisLoopParallelAccess,
   auto tmpNode        = llvm::MDNode::getTemporary(ctx, llvm::None);
   args.push_back(tmpNode.get());
 
+  accessGroup = NULL;
+
+  if (unrollAndJamCount > 1) {
+    llvm::Constant* count =
+      llvm::ConstantInt::get(llvm::Type::getInt32Ty(ctx), unrollAndJamCount);
+    llvm::Metadata *unrollAndJam[] = {
+        llvm::MDString::get(ctx, "llvm.loop.unroll_and_jam.count"),
+        llvm::ConstantAsMetadata::get(count) };
+
+    args.push_back(llvm::MDNode::get(ctx, unrollAndJam));
+  }
+
+  if (vectorize == false) {
+    llvm::MDNode *loopMetadata = llvm::MDNode::get(ctx, args);
+    loopMetadata->replaceOperandWith(0, loopMetadata);
+    return loopMetadata;
+  }
+
   // llvm.loop.vectorize.enable metadata is only used by LoopVectorizer to:
   // 1) Explicitly disable vectorization of particular loop
   // 2) Print warning when vectorization is enabled (using metadata) and
@@ -65,7 +87,6 @@ static llvm::MDNode* generateLoopMetadata(bool thisLoopParallelAccess,
     anyParallelAccesses = true;
     accessGroup = llvm::MDNode::getDistinct(ctx, {});
   } else {
-    accessGroup = NULL;
     for (auto & loopData : info->loopStack) {
       if (loopData.markMemoryOps)
         anyParallelAccesses = true;
@@ -123,6 +144,28 @@ static void addLoopMetadata(llvm::Instruction* instruction,
   instruction->setMetadata("llvm.loop", loopMetadata);
 }
 
+// Is this the outer loop of a perfect nest of two C for loops, i.e. is
+// the only loop directly in its body another C for loop? Those are what
+// --unroll-and-jam applies to; LLVM checks the rest of what makes
+// unroll-and-jam legal and profitable.
+static bool isPerfectlyNestedOuterLoop(CForLoop* loop)
+{
+  int numInner = 0;
+
+  for_alist(stmt, loop->body)
+  {
+    if (BlockStmt* block = toBlockStmt(stmt))
+    {
+      if (isCForLoop(block))
+        numInner++;
+      else if (block->isLoopStmt())
+        return false;
+    }
+  }
+
+  return numInner == 1;
+}
+
 #endif
 
 /************************************ | *************************************
@@ -245,16 +288,27 @@ GenRet CForLoop::codegen()
     llvm::MDNode* accessGroup = nullptr;
     llvm::MDNode* loopMetadata = nullptr;
 
-    if(fNoVectorize == false && isVectorizable()) {
-      loopMetadata = generateLoopMetadata(isParallelAccessVectorizable(),
+    bool vectorize         = fNoVectorize == false && isVectorizable();
+    int  unrollAndJamCount = 0;
+
+    if (unroll_and_jam_count > 1 && isPerfectlyNestedOuterLoop(this))
+      unrollAndJamCount = unroll_and_jam_count;
+
+    if(vectorize || unrollAndJamCount > 1) {
+      loopMetadata = generateLoopMetadata(vectorize,
+                                          isParallelAccessVectorizable(),
+                                          unrollAndJamCount,
                                           accessGroup);
+    }
+
+    if(vectorize) {
       LoopData data(accessGroup, isParallelAccessVectorizable());
       info->loopStack.push_back(data);
     }
 
     body.codegen("");
 
-    if(loopMetadata)
+    if(vectorize)
       info->loopStack.pop_back();
 
     info->lvt->removeLayer();
@@ -20,8 +20,37 @@
 
 #include "LoopStmt.h"
 
+#include "astutil.h"
 #include "codegen.h"
 #include "driver.h"
+#include "stlUtil.h"
+
+static bool sameFile(const char* a, const char* b)
+{
+  return a != NULL && b != NULL && strcmp(a, b) == 0;
+}
+
+// After iterator inlining, a loop's own location is often a line in the
+// iterator it came from (e.g. in ChapelRange.chpl). For the report, use
+// the first statement in its body that is from the same file as the
+// enclosing function instead, which is normally the user's loop body.
+static BaseAST* reportLocation(LoopStmt* loop)
+{
+  FnSymbol* fn = loop->getFunction();
+
+  if (fn == NULL || sameFile(loop->fname(), fn->fname()))
+    return loop;
+
+  std::vector<Expr*> exprs;
+  collect_stmts(loop, exprs);
+
+  for_vector(Expr, expr, exprs) {
+    if (expr != loop && sameFile(expr->fname(), fn->fname()))
+      return expr;
+  }
+
+  return loop;
+}
 
 void LoopStmt::reportVectorizable()
 {
@@ -31,6 +60,8 @@ void LoopStmt::reportVectorizable()
 
     if (developer || mod->modTag == MOD_USER)
     {
+      BaseAST* loc = reportLocation(this);
+
       if (this->isVectorizable()) {
         const char* kind = NULL;
 
@@ -44,10 +75,22 @@ void LoopStmt::reportVectorizable()
           kind = "loop vectorization (with parallel access)";
 
         if (developer)
-          USR_PRINT(this, "%s hinted for %s [%i]", kind,
+          USR_PRINT(loc, "%s hinted for %s [%i]", kind,
+                    this->astTagAsString(), this->id);
+        else
+          USR_PRINT(loc, "%s hinted for %s", kind,
+                    this->astTagAsString());
+
+      } else if (this->isOrderIndependent()) {
+        // The reason was reported when the hazard was found
+        // (see markVectorizableForallLoops()).
+        if (developer)
+          USR_PRINT(loc, "loop vectorization not hinted for %s [%i] "
+                    "-- vectorization hazard",
                     this->astTagAsString(), this->id);
         else
-          USR_PRINT(this, "%s hinted for %s", kind,
+          USR_PRINT(loc, "loop vectorization not hinted for %s "
+                    "-- vectorization hazard",
                     this->astTagAsString());
       }
     }
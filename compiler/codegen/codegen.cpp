@@ -66,6 +66,7 @@
 
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <unistd.h>
 
 // function prototypes
 static bool compareSymbol(const void* v1, const void* v2);
@@ -816,17 +817,30 @@ static void genFilenameTable() {
 // chpl_funSymTable     = cname, Chapel name
 // chpl_filenumSymTable = Chapel file name index, Chapel line number
 //
+// With --unwind-line-numbers, the functions in user modules come first
+// and chpl_sizeUserSymTable says how many table entries they take up,
+// so the runtime can find the innermost user frame of an error.
+//
 static void genUnwindSymbolTable(){
   std::vector<FnSymbol*> symbols;
+  size_t                 numUserSymbols = 0;
 
   //If CHPL_UNWIND is none we don't want any symbols in our tables
   if(strcmp(CHPL_UNWIND, "none") != 0){
+    std::vector<FnSymbol*> otherSymbols;
+
     // Gets only user symbols
     forv_Vec(FnSymbol, fn, gFnSymbols) {
       if(strncmp(fn->name, "chpl_", 5) || fn->hasFlag(FLAG_MODULE_INIT)) {
-        symbols.push_back(fn);
+        if (fUnwindLineNumbers && fn->getModule()->modTag == MOD_USER)
+          symbols.push_back(fn);
+        else
+          otherSymbols.push_back(fn);
       }
     }
+
+    numUserSymbols = symbols.size();
+    symbols.insert(symbols.end(), otherSymbols.begin(), otherSymbols.end());
   }
 
   // Generate the cname, Chapel name table
@@ -880,6 +894,7 @@ static void genUnwindSymbolTable(){
 
   // Now emit the size of the symbol table
   genGlobalInt32("chpl_sizeSymTable", symbols.size() * 2);
+  genGlobalInt32("chpl_sizeUserSymTable", numUserSymbols * 2);
 }
 
 static void
@@ -2434,7 +2449,7 @@ static void codegenPartTwo() {
 
     if(debugCCode)
     {
-      debug_info = new debug_data(*info->module);
+      debug_info = new debug_data(*info->module, fDebugLineTablesOnly);
     }
     if(debug_info) {
       // first find the main module, this will be the compile unit.
@@ -2453,7 +2468,12 @@ static void codegenPartTwo() {
     prepareCodegenLLVM();
 #endif
   } else {
-    openCFile(&hdrfile,  "chpl__header", "h");
+    // With --incremental, chpl__header.h and the user modules' files are
+    // only replaced when they change, so their objects can be reused.
+    if (fIncrementalCompilation)
+      openCFileIfChanged(&hdrfile, "chpl__header", "h");
+    else
+      openCFile(&hdrfile, "chpl__header", "h");
     openCFile(&mainfile, "_main",        "c");
     openCFile(&defnfile, "chpl__defn",    "c");
     openCFile(&strconfig,  "chpl_str_config", "c");
@@ -2471,14 +2491,7 @@ static void codegenPartTwo() {
         const char* filename = NULL;
         filename = generateFileName(fileNameHashMap, filename, currentModule->name);
         if(currentModule->modTag == MOD_USER) {
-          fileinfo modulefile;
-          openCFile(&modulefile, filename, "c");
-          int modulePathLen = strlen(astr(modulefile.pathname));
-          char path[FILENAME_MAX];
-          strncpy(path, astr(modulefile.pathname), modulePathLen-2);
-          path[modulePathLen-2]='\0';
-          userFileName.push_back(astr(path));
-          closeCFile(&modulefile);
+          userFileName.push_back(genIntermediateFilename(filename));
         }
       }
     }
@@ -2529,16 +2542,25 @@ static void codegenPartTwo() {
       const char* filename = NULL;
       filename = generateFileName(fileNameHashMap, filename,currentModule->name);
 
+      bool separate = fIncrementalCompilation &&
+                      currentModule->modTag == MOD_USER;
+
       fileinfo modulefile;
-      openCFile(&modulefile, filename, "c");
+      if (separate)
+        openCFileIfChanged(&modulefile, filename, "c");
+      else
+        openCFile(&modulefile, filename, "c");
       info->cfile = modulefile.fptr;
-      if(fIncrementalCompilation && (currentModule->modTag == MOD_USER))
+      if(separate)
         fprintf(modulefile.fptr, "#include \"chpl__header.h\"\n");
       currentModule->codegenDef();
 
-      closeCFile(&modulefile);
+      if (separate)
+        closeCFileIfChanged(&modulefile);
+      else
+        closeCFile(&modulefile);
 
-      if(!(fIncrementalCompilation && (currentModule->modTag == MOD_USER)))
+      if(!separate)
         fprintf(mainfile.fptr, "#include \"%s%s\"\n", filename, ".c");
     }
 
@@ -2555,7 +2577,10 @@ static void codegenPartTwo() {
     fprintf(hdrfile.fptr, "\n#endif");
     fprintf(hdrfile.fptr, " /* END CHPL_GEN_HEADER_INCLUDE_GUARD */\n");
 
-    closeCFile(&hdrfile);
+    if (fIncrementalCompilation)
+      closeCFileIfChanged(&hdrfile);
+    else
+      closeCFile(&hdrfile);
     fprintf(mainfile.fptr, "/* last line not #include to avoid gcc bug */\n");
     closeCFile(&mainfile);
     closeCFile(&defnfile);
@@ -2609,6 +2634,16 @@ void makeBinary(void) {
 #endif
   } else {
     const char* makeflags = printSystemCommands ? "-f " : "-s -f ";
+
+    // With --incremental each user module is a separate object, so
+    // let make compile them in parallel unless it was told otherwise.
+    if (fIncrementalCompilation && getenv("MAKEFLAGS") == NULL) {
+      long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+      if (ncpus > 1)
+        makeflags = astr("-j", istr(ncpus), " ", makeflags);
+    }
+
     const char* command = astr(astr(CHPL_MAKE, " "),
                                makeflags,
                                getIntermediateDirName(), "/Makefile");
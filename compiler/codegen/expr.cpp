@@ -42,6 +42,9 @@
 
 #ifdef HAVE_LLVM
 #include "llvm/IR/Module.h"
+#if HAVE_LLVM_VER >= 100
+#include "llvm/IR/IntrinsicsNVPTX.h"
+#endif
 #include "clang/CodeGen/CGFunctionInfo.h"
 #endif
 
@@ -4012,6 +4015,24 @@ DEFINE_PRIM(PRIM_UNARY_PLUS) {
 DEFINE_PRIM(PRIM_UNARY_LNOT) {
   ret = codegenIsZero(call->get(1));
 }
+DEFINE_PRIM(PRIM_UNLIKELY) {
+  GenRet tmp = codegenValue(call->get(1));
+
+  if (gGenInfo->cfile) {
+    ret.c = "CHPL_UNLIKELY(" + tmp.c + ")";
+  } else {
+#ifdef HAVE_LLVM
+    GenInfo*        info    = gGenInfo;
+    llvm::Type*     type    = tmp.val->getType();
+    llvm::Function* expect  = llvm::Intrinsic::getDeclaration(info->module,
+                                                llvm::Intrinsic::expect,
+                                                type);
+    llvm::Value*    args[2] = { tmp.val, llvm::ConstantInt::get(type, 0) };
+
+    ret.val = info->irBuilder->CreateCall(expect, args);
+#endif
+  }
+}
 DEFINE_PRIM(PRIM_ADD) {
     ret = codegenAdd(call->get(1), call->get(2));
 }
@@ -5405,6 +5426,58 @@ DEFINE_PRIM(PRIM_OPTIMIZATION_INFO) {
   // No action required here
 }
 
+DEFINE_PRIM(PRIM_GPU_THREAD_ID) {
+  // blockIdx.x * blockDim.x + threadIdx.x, as an int(64)
+  if (gGenInfo->cfile) {
+    INT_FATAL(call, "GPU kernels require the LLVM backend");
+  } else {
+#ifdef HAVE_LLVM
+    GenInfo*        info   = gGenInfo;
+    llvm::Function* ctaid  = llvm::Intrinsic::getDeclaration(info->module,
+                               llvm::Intrinsic::nvvm_read_ptx_sreg_ctaid_x);
+    llvm::Function* ntid   = llvm::Intrinsic::getDeclaration(info->module,
+                               llvm::Intrinsic::nvvm_read_ptx_sreg_ntid_x);
+    llvm::Function* tid    = llvm::Intrinsic::getDeclaration(info->module,
+                               llvm::Intrinsic::nvvm_read_ptx_sreg_tid_x);
+    llvm::Type*     i64    = llvm::Type::getInt64Ty(info->module->getContext());
+
+    // Widen before the arithmetic so large grids don't wrap at 32 bits.
+    llvm::Value* ctaidV = info->irBuilder->CreateZExt(
+                            info->irBuilder->CreateCall(ctaid), i64);
+    llvm::Value* ntidV  = info->irBuilder->CreateZExt(
+                            info->irBuilder->CreateCall(ntid), i64);
+    llvm::Value* tidV   = info->irBuilder->CreateZExt(
+                            info->irBuilder->CreateCall(tid), i64);
+
+    ret.val = info->irBuilder->CreateAdd(
+                info->irBuilder->CreateMul(ctaidV, ntidV), tidV);
+#endif
+  }
+}
+
+DEFINE_PRIM(PRIM_GPU_ON_GPU_SUBLOC) {
+  ret = codegenCallExpr("chpl_gpu_running_on_gpu_subloc");
+}
+
+DEFINE_PRIM(PRIM_GPU_KERNEL_LAUNCH) {
+  // args are: kernel name, lo, hi, the kernel's other arguments, line, file
+  // The other arguments are local temps; the runtime gets their addresses.
+  int                 nActuals = call->numActuals();
+  std::vector<GenRet> args;
+
+  args.push_back(call->get(nActuals - 1));
+  args.push_back(call->get(nActuals));
+  args.push_back(call->get(1));
+  args.push_back(call->get(2));
+  args.push_back(call->get(3));
+  args.push_back(new_IntSymbol(nActuals - 5, INT_SIZE_32));
+
+  for (int i = 4; i <= nActuals - 2; i++)
+    args.push_back(codegenCastToVoidStar(codegenAddrOf(call->get(i))));
+
+  codegenCall("chpl_gpu_launch_kernel", args);
+}
+
 void CallExpr::registerPrimitivesForCodegen() {
   // The following macros call registerPrimitiveCodegen for
   // the DEFINE_PRIM routines above for each primitive labelled
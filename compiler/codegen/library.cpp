@@ -510,6 +510,7 @@ static void makePXDFile(std::vector<FnSymbol*> functions) {
 
 static void makePYXSetupFunctions(std::vector<FnSymbol*> moduleInits);
 static void makeOpaqueArrayClass();
+static void makeExternalArrayClass();
 
 // Generate the .pyx file for the library.  This will also be used when
 // creating the Python module.
@@ -570,12 +571,15 @@ static void makePYXFile(std::vector<FnSymbol*> functions) {
     // Necessary for using numpy types
     fprintf(pyx.fptr, "import numpy\n");
     fprintf(pyx.fptr, "cimport numpy\n");
+    fprintf(pyx.fptr, "numpy.import_array()\n");
+    fprintf(pyx.fptr, "from cpython.ref cimport Py_INCREF\n");
     // Necessary for supporting pointers
     fprintf(pyx.fptr, "import ctypes\n");
     fprintf(pyx.fptr, "from libc.stdint cimport intptr_t\n\n");
 
     makePYXSetupFunctions(moduleInits);
     makeOpaqueArrayClass();
+    makeExternalArrayClass();
 
     // Add Python wrapper for the exported functions, to translate the types
     // appropriately
@@ -663,6 +667,23 @@ static void makeOpaqueArrayClass() {
   fprintf(outfile, "\t\tself.cleanup()\n\n");
 }
 
+// Owns an array returned from Chapel.  Numpy arrays made from the array's
+// memory keep one of these as their base object, so the memory is freed
+// when the last of them is collected.  That has to happen before
+// chpl_cleanup() shuts down the runtime.
+static void makeExternalArrayClass() {
+  GenInfo* info = gGenInfo;
+  FILE* outfile = info->cfile;
+
+  fprintf(outfile, "cdef class ChplExternalArray:\n");
+  fprintf(outfile, "\tcdef chpl_external_array val\n\n");
+  fprintf(outfile, "\tcdef inline setVal(self, chpl_external_array val):\n");
+  fprintf(outfile, "\t\tself.val = val\n\n");
+
+  fprintf(outfile, "\tdef __dealloc__(self):\n");
+  fprintf(outfile, "\t\tchpl_free_external_array(self.val)\n\n");
+}
+
 // create the Python file which will be used to compile the .pyx, .pxd, library,
 // and header files into a Python module.
 static void makePYFile() {
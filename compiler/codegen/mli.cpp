@@ -45,6 +45,8 @@ static const char* server_arg = "chpl_server.arg";
 static const char* server_res = "chpl_server.res";
 static const char* marshal_push_prefix = "chpl_mli_mtpush_";
 static const char* marshal_pull_prefix = "chpl_mli_mtpull_";
+static const char* batch_pack_prefix = "chpl_mli_bpack_";
+static const char* batch_unpack_prefix = "chpl_mli_bunpack_";
 static const char* socket_push_name = "chpl_mli_push";
 static const char* socket_pull_name = "chpl_mli_pull";
 static const char* scope_begin = "{\n";
@@ -99,6 +101,10 @@ private:
   std::string genMarshalRoutine(Type* t, bool out);
   std::string genMarshalPushRoutine(Type* t);
   std::string genMarshalPullRoutine(Type* t);
+  std::string genBatchRoutine(Type* t, bool out);
+  std::string genBatchCall(const char* var, Type* t, bool out);
+  std::string genServerBatchDispatchSwitch(const std::vector<FnSymbol*>& fns);
+  std::string genServersideBatchRPC(FnSymbol* fn);
   std::string genServerDispatchSwitch(const std::vector<FnSymbol*>& fns);
   std::string genDebugPrintCall(FnSymbol* fn);
   std::string genDebugPrintCall(const char* msg);
@@ -301,6 +307,18 @@ void MLIContext::emitMarshalRoutines(void) {
     gen += this->genMarshalPullRoutine(i->first);
   }
 
+  // Batched calls are packed only by the client and unpacked only by
+  // the server.
+  gen += "#ifdef CHPL_MLI_IS_CLIENT\n";
+  for (i = this->typeMap.begin(); i != this->typeMap.end(); ++i) {
+    gen += this->genBatchRoutine(i->first, true);
+  }
+  gen += "#else\n";
+  for (i = this->typeMap.begin(); i != this->typeMap.end(); ++i) {
+    gen += this->genBatchRoutine(i->first, false);
+  }
+  gen += "#endif\n";
+
   this->setOutputAndWrite(&this->fiMarshalling, gen);
 
   return;
@@ -552,11 +570,112 @@ std::string MLIContext::genMarshalPullRoutine(Type* t) {
   return this->genMarshalRoutine(t, false);
 }
 
+//
+// Batched calls (see client_runtime.c) carry their arguments in one
+// buffer with no ACKs: a scalar as its raw bytes, a string or byte
+// buffer as a uint64_t length followed by the bytes.  Packing appends
+// to the client's batch, unpacking reads from and advances "*cur".
+//
+std::string MLIContext::genBatchRoutine(Type* t, bool out) {
+  int64_t id = this->assignUniqueTypeID(t);
+  std::string tn = this->genTypeName(t);
+  std::string gen;
+
+  if (out) {
+    gen += "static void ";
+    gen += batch_pack_prefix;
+    gen += str(id);
+    gen += "(";
+    gen += tn;
+    gen += " obj)";
+  } else {
+    gen += "static ";
+    gen += tn;
+    gen += " ";
+    gen += batch_unpack_prefix;
+    gen += str(id);
+    gen += "(const char** cur)";
+  }
+
+  gen += scope_begin;
+
+  if (!out) { gen += this->genNewDecl(t, "result"); }
+
+  if (isPrimitiveScalar(t) && !is_complex_type(t)) {
+    if (out) {
+      gen += "chpl_mli_batch_put(&obj, sizeof(obj));\n";
+    } else {
+      gen += "memcpy(&result, *cur, sizeof(result));\n";
+      gen += "*cur += sizeof(result);\n";
+    }
+
+  } else if (t->getValType() == exportTypeChplByteBuffer) {
+    if (out) {
+      gen += "chpl_mli_batch_put(&obj.size, sizeof(obj.size));\n";
+      gen += "chpl_mli_batch_put(obj.data, obj.size);\n";
+    } else {
+      gen += "memcpy(&result.size, *cur, sizeof(result.size));\n";
+      gen += "*cur += sizeof(result.size);\n";
+      gen += "result.isOwned = true;\n";
+      gen += "result.data = mli_malloc(result.size + 1);\n";
+      gen += "if (result.data == NULL) ";
+      gen += "chpl_mli_terminate(CHPL_MLI_CODE_EMEMORY);\n";
+      gen += "memcpy(result.data, *cur, result.size);\n";
+      gen += "result.data[result.size] = '\\0';\n";
+      gen += "*cur += result.size;\n";
+    }
+
+  } else {
+    // A c_string, or a c_ptr(int8) that was a Chapel string.
+    gen += this->genNewDecl("uint64_t", "bytes");
+
+    if (out) {
+      gen += "bytes = strlen((const char*) obj);\n";
+      gen += "chpl_mli_batch_put(&bytes, sizeof(bytes));\n";
+      gen += "chpl_mli_batch_put(obj, bytes);\n";
+    } else {
+      gen += this->genNewDecl("char*", "buffer");
+      gen += "memcpy(&bytes, *cur, sizeof(bytes));\n";
+      gen += "*cur += sizeof(bytes);\n";
+      gen += "buffer = mli_malloc(bytes + 1);\n";
+      gen += "if (buffer == NULL) chpl_mli_terminate(CHPL_MLI_CODE_EMEMORY);\n";
+      gen += "memcpy(buffer, *cur, bytes);\n";
+      gen += "buffer[bytes] = '\\0';\n";
+      gen += "*cur += bytes;\n";
+      gen += "result = (";
+      gen += tn;
+      gen += ") buffer;\n";
+    }
+  }
+
+  if (!out) { gen += "return result;\n"; }
+
+  gen += scope_end;
+  gen += "\n";
+
+  return gen;
+}
+
+std::string MLIContext::genBatchCall(const char* var, Type* t, bool out) {
+  std::string gen;
+  int64_t id = this->assignUniqueTypeID(t);
+
+  gen += out ? batch_pack_prefix : batch_unpack_prefix;
+  gen += str(id);
+  gen += "(";
+  gen += out ? var : "cur";
+  gen += ");\n";
+
+  return gen;
+}
+
 void MLIContext::emitServerDispatchRoutine(void) {
   std::string gen;
 
   gen += this->genServerDispatchSwitch(this->exps);
   gen += "\n";
+  gen += this->genServerBatchDispatchSwitch(this->exps);
+  gen += "\n";
   
   this->setOutputAndWrite(&this->fiServerBundle, gen);
 
@@ -634,6 +753,21 @@ void MLIContext::emitServerWrapper(FnSymbol* fn) {
   gen += scope_end;
   gen += "\n";
 
+  // Routines that return nothing can also be called in a batch.
+  if (fn->retType == dtVoid) {
+    prototype = "int64_t chpl_mli_sbwrapper_";
+    prototype += this->genFuncNumericID(fn);
+    prototype += "(const char** cur)";
+
+    gen += prototype + ";\n";
+    gen += prototype;
+    gen += scope_begin;
+    gen += this->genServersideBatchRPC(fn);
+    gen += "return 0;\n";
+    gen += scope_end;
+    gen += "\n";
+  }
+
   this->setOutputAndWrite(&this->fiServerBundle, gen);
  
   return;
@@ -722,6 +856,44 @@ MLIContext::genServerDispatchSwitch(const std::vector<FnSymbol*>& fns) {
   return gen;
 }
 
+std::string
+MLIContext::genServerBatchDispatchSwitch(const std::vector<FnSymbol*>& fns) {
+  std::string gen;
+
+  gen += "int64_t chpl_mli_sbatch_dispatch";
+  gen += "(int64_t function, const char** cur)";
+  gen += scope_begin;
+  gen += "int64_t err = 0;\n";
+  gen += "switch (function)";
+  gen += scope_begin;
+
+  for_vector(FnSymbol, fn, fns) {
+    if (fn->retType != dtVoid) { continue; }
+
+    gen += "case ";
+    gen += this->genFuncNumericID(fn);
+    gen += ": ";
+    gen += scope_begin;
+
+    if (this->debugPrint) {
+      gen += this->genDebugPrintCall(fn);
+    }
+
+    gen += "err = chpl_mli_sbwrapper_";
+    gen += this->genFuncNumericID(fn);
+    gen += "(cur);\n";
+    gen += scope_end;
+    gen += "break;\n";
+  }
+
+  gen += "default: return CHPL_MLI_CODE_ENOFUNC; break;\n";
+  gen += scope_end;
+  gen += "return err;\n";
+  gen += scope_end;
+
+  return gen;
+}
+
 //
 // This filter will change as we support more and more type classes.
 //
@@ -786,6 +958,24 @@ std::string MLIContext::genClientsideRPC(FnSymbol* fn) {
     gen += this->genDebugPrintCall(fn);
   }
 
+  if (hasVoidReturnType) {
+    // In a batch, just pack the call; the batch is sent later.
+    gen += "if (chpl_mli_batching())";
+    gen += scope_begin;
+    gen += "chpl_mli_batch_call(id);\n";
+
+    for (int i = 1; i <= fn->numFormals(); i++) {
+      ArgSymbol* as = fn->getFormal(i);
+      gen += this->genBatchCall(as->name, getTypeFromFormal(as), true);
+    }
+
+    gen += "return;\n";
+    gen += scope_end;
+  } else {
+    // Calls already batched have to run first.
+    gen += "chpl_mli_batch_flush();\n";
+  }
+
   // Push function to call.
   gen += this->genSocketPushCall(client_main, "id");
 
@@ -900,6 +1090,48 @@ std::string MLIContext::genServersideRPC(FnSymbol* fn) {
   return gen;
 }
 
+std::string MLIContext::genServersideBatchRPC(FnSymbol* fn) {
+  std::string gen;
+  std::string call;
+
+  INT_ASSERT(fn->retType == dtVoid);
+
+  call += fn->cname;
+  call += "(";
+
+  for (int i = 1; i <= fn->numFormals(); i++) {
+    Type* t = this->getTypeFromFormal(fn, i);
+    std::string tmp;
+
+    tmp += "tmp_";
+    tmp += fn->getFormal(i)->name;
+
+    gen += this->genTypeName(t);
+    gen += " ";
+    gen += tmp;
+    gen += "=";
+    gen += this->genBatchCall(NULL, t, false);
+
+    call += (i > 1) ? "," : "";
+    call += tmp;
+  }
+
+  call += ");\n";
+  gen += call;
+
+  // As in genServersideRPC, the server frees what it unpacked.
+  for (int i = 1; i <= fn->numFormals(); i++) {
+    Type* t = this->getTypeFromFormal(fn, i);
+    if (this->isTypeRequiringAlloc(t)) {
+      std::string tmp = "tmp_";
+      tmp += fn->getFormal(i)->name;
+      gen += this->genMemCleanup(t, tmp.c_str());
+    }
+  }
+
+  return gen;
+}
+
 std::string MLIContext::genMemCleanup(Type* t, const char* var) {
   std::string gen;
 
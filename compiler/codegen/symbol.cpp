@@ -1206,6 +1206,13 @@ static std::string pythonArgToByteBuffer(ArgSymbol* as) {
   return res;
 }
 
+// Arrays of these element types have the same layout in NumPy and in
+// Chapel, so they can be shared instead of copied.
+static bool isPythonZeroCopyEltType(Type* t) {
+  return is_int_type(t) || is_uint_type(t) || is_real_type(t) ||
+         is_complex_type(t);
+}
+
 static std::string pythonArgToExternalArray(ArgSymbol* as) {
   std::string strname = as->cname;
 
@@ -1216,19 +1223,52 @@ static std::string pythonArgToExternalArray(ArgSymbol* as) {
     // do a translation in the python wrapper.
     std::string typeStr = getPythonTypeName(eltType->type, PYTHON_PYX);
     std::string typeStrCDefs = getPythonTypeName(eltType->type, C_PYX);
+    std::string res = "\tcdef chpl_external_array chpl_" + strname + "\n";
+    std::string indent = "\t";
+
+    if (isPythonZeroCopyEltType(eltType->type)) {
+      //
+      // If the argument exports a writable, contiguous buffer of the right
+      // element type (a NumPy array, say), point Chapel at that memory
+      // rather than copying it.  The buffer stays alive for the call since
+      // the argument refers to it.  E.g.
+      //
+      //   cdef element type[::1] chpl_view_foo = None
+      //   try:
+      //     chpl_view_foo = foo
+      //   except (TypeError, ValueError, BufferError):
+      //     pass
+      //   if chpl_view_foo is not None and chpl_view_foo.shape[0] > 0:
+      //     chpl_foo = chpl_make_external_array_ptr(
+      //                  <void*>&chpl_view_foo[0], chpl_view_foo.shape[0])
+      //   else:
+      //     (copy, as below)
+      //
+      std::string view = "chpl_view_" + strname;
+
+      res += "\tcdef " + typeStrCDefs + "[::1] " + view + " = None\n";
+      res += "\ttry:\n";
+      res += "\t\t" + view + " = " + strname + "\n";
+      res += "\texcept (TypeError, ValueError, BufferError):\n";
+      res += "\t\tpass\n";
+      res += "\tif " + view + " is not None and " + view + ".shape[0] > 0:\n";
+      res += "\t\tchpl_" + strname + " = chpl_make_external_array_ptr(";
+      res += "<void*>&" + view + "[0], " + view + ".shape[0])\n";
+      res += "\telse:\n";
+      indent += "\t";
+    }
 
     // Create the memory needed to store the contents of what was passed to us
-    // E.g. cdef chpl_external_array chpl_foo =
-    //          chpl_make_external_array(sizeof(element type), len(foo))
-    std::string res = "\tcdef chpl_external_array chpl_" + strname;
+    // E.g. chpl_foo = chpl_make_external_array(sizeof(element type), len(foo))
+    res += indent + "chpl_" + strname;
     res += " = chpl_make_external_array(sizeof(" + typeStrCDefs + "), len(";
     res += strname + "))\n";
 
     // Copy the contents over.
     // E.g. for i in range(len(foo)):
     //         (<element type*>chpl_foo.elts)[i] = foo[i]
-    res += "\tfor i in range(len(" + strname + ")):\n";
-    res += "\t\t(<" + typeStrCDefs + "*>chpl_" + strname + ".elts)[i] = ";
+    res += indent + "for i in range(len(" + strname + ")):\n";
+    res += indent + "\t(<" + typeStrCDefs + "*>chpl_" + strname + ".elts)[i] = ";
     res += strname + "[i]\n";
 
     return res;
@@ -1361,7 +1401,6 @@ void TypeSymbol::codegenDef() {
     }
 
     llvmType = type;
-    if(debug_info) debug_info->get_type(this->type);
 #endif
   }
 }
@@ -2173,7 +2212,8 @@ void FnSymbol::codegenPrototype() {
     }
 
     llvm::Function::LinkageTypes linkage = llvm::Function::InternalLinkage;
-    if (hasFlag(FLAG_EXPORT))
+    // The runtime looks kernels up by name in the GPU binary.
+    if (hasFlag(FLAG_EXPORT) || (gCodegenGPU && hasFlag(FLAG_GPU_CODEGEN)))
       linkage = llvm::Function::ExternalLinkage;
 
     // No other function with the same name exists.
@@ -2377,6 +2417,7 @@ void FnSymbol::codegenDef() {
 
     if (this->hasFlag(FLAG_FUNCTION_TERMINATES_PROGRAM)) {
       func->addFnAttr(llvm::Attribute::NoReturn);
+      func->addFnAttr(llvm::Attribute::Cold);
     }
 
     if (specializeCCode) {
@@ -2933,6 +2974,35 @@ static void pythonRetExternalArray(FnSymbol* fn, std::string& funcCall,
   std::string typeStr = getPythonTypeName(eltType, PYTHON_PYX);
   std::string typeStrCDefs = getPythonTypeName(eltType, C_PYX);
 
+  if (isPythonZeroCopyEltType(eltType)) {
+    //
+    // Hand the Chapel memory to a numpy array without copying it.  The
+    // array's base object owns the chpl_external_array and frees it when
+    // the array is collected:
+    //
+    //  cdef ChplExternalArray ret_owner = ChplExternalArray()
+    //  ret_owner.setVal(ret_arr)
+    //  cdef numpy.npy_intp ret_dims[1]
+    //  ret_dims[0] = ret_arr.num_elts
+    //  cdef numpy.ndarray ret = numpy.PyArray_SimpleNewFromData(1,
+    //    ret_dims, numpy.dtype((numpy dtype)).num, ret_arr.elts)
+    //  Py_INCREF(ret_owner)
+    //  numpy.PyArray_SetBaseObject(ret, ret_owner)
+    //
+    std::string res;
+    res += "\tcdef ChplExternalArray ret_owner = ChplExternalArray()\n";
+    res += "\tret_owner.setVal(ret_arr)\n";
+    res += "\tcdef numpy.npy_intp ret_dims[1]\n";
+    res += "\tret_dims[0] = ret_arr.num_elts\n";
+    res += "\tcdef numpy.ndarray ret = numpy.PyArray_SimpleNewFromData(1, ";
+    res += "ret_dims, numpy.dtype(" + typeStr + ").num, ret_arr.elts)\n";
+    // PyArray_SetBaseObject() steals a reference.
+    res += "\tPy_INCREF(ret_owner)\n";
+    res += "\tnumpy.PyArray_SetBaseObject(ret, ret_owner)\n";
+    returnStmt += res;
+    return;
+  }
+
   //
   // Create the numpy array to return. The form looks like:
   //
@@ -36,11 +36,16 @@
 #include "llvmVer.h"
 #include "misc.h"
 #include "passes.h"
+#include "stlUtil.h"
 #include "stringutil.h"
 #include "symbol.h"
 #include "vec.h"
 #include "wellknown.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #ifdef HAVE_LLVM
 #include "llvm/IR/Module.h"
 #include "llvm/IR/DataLayout.h"
@@ -58,6 +63,104 @@ void Type::codegenDef() {
   INT_FATAL(this, "Unexpected call to Type::codegenDef");
 }
 
+/************************************* | **************************************
+*                                                                             *
+* Both backends refer to fields by name, so the order in which they are       *
+* emitted is free for types that no C code or runtime header depends on.      *
+* For those, emit the fields in decreasing order of alignment so that no      *
+* padding is needed between them.                                             *
+*                                                                             *
+************************************** | *************************************/
+
+// Used for types whose alignment is not known before the backend runs.
+static const int MAX_FIELD_ALIGNMENT = 16;
+
+static int fieldAlignment(Type* type) {
+  if (type == dtBool) {
+    return 1;
+
+  } else if (is_bool_type(type) ||
+             is_int_type(type)  ||
+             is_uint_type(type) ||
+             is_real_type(type) ||
+             is_imag_type(type)) {
+    return get_width(type) / 8;
+
+  } else if (is_complex_type(type)) {
+    return get_width(type) / 16;
+
+  } else if (isClassLikeOrPtr(type)               ||
+             isClass(type)                        ||
+             type->symbol->hasFlag(FLAG_REF)      ||
+             type->symbol->hasFlag(FLAG_WIDE_REF) ||
+             type->symbol->hasFlag(FLAG_WIDE_CLASS)) {
+    return 8;
+
+  } else if (AggregateType* at = toAggregateType(type)) {
+    if (at->symbol->hasFlag(FLAG_EXTERN) == false && isRecord(at)) {
+      int retval = 1;
+
+      for_fields(field, at) {
+        retval = std::max(retval, fieldAlignment(field->type));
+      }
+
+      return retval;
+    }
+  }
+
+  return MAX_FIELD_ALIGNMENT;
+}
+
+static bool canReorderFields(AggregateType* at) {
+  Symbol* sym = at->symbol;
+
+  if (fNoReorderFields                       ||
+      at->aggregateTag == AGGREGATE_UNION    ||
+      sym->hasFlag(FLAG_EXTERN)              ||
+      sym->hasFlag(FLAG_EXPORT)              ||
+      sym->hasFlag(FLAG_OBJECT_CLASS)        ||
+      sym->hasFlag(FLAG_WIDE_CLASS)          ||
+      sym->hasFlag(FLAG_WIDE_REF)            ||
+      sym->hasFlag(FLAG_STAR_TUPLE)) {
+    return false;
+  }
+
+  return sym->hasFlag(FLAG_REORDER_FIELDS) ||
+         sym->hasFlag(FLAG_TUPLE)          ||
+         sym->hasFlag(FLAG_ITERATOR_CLASS);
+}
+
+static bool compareFieldAlignment(const std::pair<int, Symbol*>& a,
+                                  const std::pair<int, Symbol*>& b) {
+  return a.first > b.first;
+}
+
+static void fieldsInLayoutOrder(AggregateType*        at,
+                                std::vector<Symbol*>& fields) {
+  std::vector<std::pair<int, Symbol*> > sorted;
+
+  for_fields(field, at) {
+    fields.push_back(field);
+  }
+
+  if (fields.size() > 2 && canReorderFields(at)) {
+    // The first field of a class is its super class or, for an argument
+    // bundle, the runtime's task header.  Either must stay at offset 0.
+    size_t first = (at->aggregateTag == AGGREGATE_CLASS) ? 1 : 0;
+
+    for (size_t i = first; i < fields.size(); i++) {
+      sorted.push_back(std::make_pair(fieldAlignment(fields[i]->type),
+                                      fields[i]));
+    }
+
+    std::stable_sort(sorted.begin(), sorted.end(), compareFieldAlignment);
+
+    for (size_t i = first; i < fields.size(); i++) {
+      fields[i] = sorted[i - first].second;
+    }
+  }
+}
+
 
 void Type::codegenPrototype() { }
 
@@ -193,6 +296,32 @@ GenRet AggregateType::codegenClassStructType()
   return ret;
 }
 
+#ifdef HAVE_LLVM
+// With --vector-tuples, a homogeneous tuple of 2^n integers or reals that
+// fills a 128, 256 or 512 bit SIMD register is an LLVM vector rather than
+// an array.  The layout in memory is the same, but the element-wise
+// loops over it can be done in registers.
+static bool isSIMDTuple(AggregateType* at) {
+  Type* eltType = at->getField("x0")->type;
+  int   length  = at->fields.length;
+
+  if (fVectorTuples == false ||
+      (is_int_type(eltType)  == false &&
+       is_uint_type(eltType) == false &&
+       is_real_type(eltType) == false)) {
+    return false;
+  }
+
+  if (length < 2 || (length & (length - 1)) != 0) {
+    return false;
+  }
+
+  int bits = get_width(eltType) * length;
+
+  return bits == 128 || bits == 256 || bits == 512;
+}
+#endif
+
 void AggregateType::codegenDef() {
   GenInfo* info = gGenInfo;
   FILE* outfile = info->cfile;
@@ -211,7 +340,16 @@ void AggregateType::codegenDef() {
     } else {
 #ifdef HAVE_LLVM
       llvm::Type *elementType = getField("x0")->type->codegen().type;
-      type = llvm::ArrayType::get(elementType, fields.length);
+
+      if (isSIMDTuple(this)) {
+#if HAVE_LLVM_VER >= 110
+        type = llvm::FixedVectorType::get(elementType, fields.length);
+#else
+        type = llvm::VectorType::get(elementType, fields.length);
+#endif
+      } else {
+        type = llvm::ArrayType::get(elementType, fields.length);
+      }
 #endif
     }
   } else if (symbol->hasFlag(FLAG_C_ARRAY)) {
@@ -301,7 +439,11 @@ void AggregateType::codegenDef() {
       }
 
       if (this->fields.length != 0) {
-        for_fields(field, this) {
+        std::vector<Symbol*> layout;
+
+        fieldsInLayoutOrder(this, layout);
+
+        for_vector(Symbol, field, layout) {
           field->codegenDef();
         }
       }
@@ -369,7 +511,11 @@ void AggregateType::codegenDef() {
           // TODO - don't ever allocate 0-byte structures
           params.push_back(llvm::Type::getInt32Ty(info->llvmContext));
         }
-        for_fields(field, this) {
+        std::vector<Symbol*> layout;
+
+        fieldsInLayoutOrder(this, layout);
+
+        for_vector(Symbol, field, layout) {
           llvm::Type* fieldType = field->type->symbol->codegen().type;
           AggregateType* ct = toAggregateType(field->type);
           if(ct && field->hasFlag(FLAG_SUPER_CLASS))
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _SYMBOL_MAP_H_
+#define _SYMBOL_MAP_H_
+
+#include "map.h"
+
+class Symbol;
+
+typedef MapElem<Symbol*,Symbol*> SymbolMapElem;
+
+//
+// A Symbol* -> Symbol* map: substitutions, copy maps, and the like.
+//
+// This used to be a Map<Symbol*,Symbol*>, whose prime-sized tables,
+// short probe limit and modulo hashing made put() and get() costly on
+// the big maps built while copying and instantiating functions.  It
+// keeps the interface the compiler uses from Map, including the 'n'
+// and 'v' fields that form_Map iterates over, but
+//
+//  - up to SMALL_SIZE entries are kept in insertion order in storage
+//    inside the map itself, so the many tiny maps never allocate, and
+//
+//  - larger maps are a power-of-two table with linear probing, at most
+//    half full, hashed on the symbol's id so that iteration order does
+//    not depend on where symbols were allocated.
+//
+// As with Map, NULL is not a valid key and entries cannot be removed.
+//
+class SymbolMap {
+public:
+  // Number of slots in 'v'; 0 when the map has never had an entry.
+  int            n;
+  SymbolMapElem* v;
+
+                 SymbolMap();
+                 SymbolMap(const SymbolMap& other);
+                ~SymbolMap();
+
+  SymbolMap&     operator=(const SymbolMap& other);
+
+  Symbol*        get(Symbol* key)                         const;
+  SymbolMapElem* get_record(Symbol* key)                  const;
+  SymbolMapElem* put(Symbol* key, Symbol* value);
+
+  void           map_union(const SymbolMap& other);
+  void           copy(const SymbolMap& other);
+  void           clear();
+
+  int            count()                                  const;
+  void           get_keys(Vec<Symbol*>& keys)             const;
+  void           get_values(Vec<Symbol*>& values)         const;
+
+private:
+  enum { SMALL_SIZE = 4, MIN_TABLE_SIZE = 16 };
+
+  SymbolMapElem* find(Symbol* key)                        const;
+  void           insert(Symbol* key, Symbol* value);
+  void           rehash(int size);
+
+  int            used;
+  SymbolMapElem  small[SMALL_SIZE];
+};
+
+#endif
@@ -34,11 +34,13 @@
 #ifndef _BASEAST_H_
 #define _BASEAST_H_
 
+#include <cstddef>
 #include <ostream>
 #include <string>
 
 #include "astlocs.h"
 #include "map.h"
+#include "SymbolMap.h"
 #include "vec.h"
 
 //
@@ -142,9 +144,6 @@ foreach_ast(decl_gvecs);
 //
 // type definitions for common maps
 //
-typedef Map<Symbol*,Symbol*>     SymbolMap;
-typedef MapElem<Symbol*,Symbol*> SymbolMapElem;
-
 typedef struct {
   const char* name; //key
   Symbol* value;
@@ -284,6 +283,10 @@ public:
 
   static  const     std::string tabText;
 
+  // AST nodes come from a pool, see baseAST.cpp
+  static void*      operator new(size_t size);
+  static void       operator delete(void* ptr, size_t size);
+
 protected:
                     BaseAST(AstTag type);
   virtual          ~BaseAST() = default;
@@ -22,6 +22,7 @@
 #define _BB_H_
 
 class BitVec;
+class SparseBitVec;
 class Expr;
 class FnSymbol;
 class LabelSymbol;
@@ -44,6 +45,7 @@ class BasicBlock
  public:
   typedef std::vector<BasicBlock*> BasicBlockVector;
   typedef std::vector<BitVec*> BitVecVector;
+  typedef std::vector<SparseBitVec*> SparseBitVecVector;
   typedef std::set<BasicBlock*> BasicBlockSet;
 
   //
@@ -77,11 +79,13 @@ public:
   static void        computeBackwardOrder(FnSymbol* fn,
                                           std::vector<int> & order);
 
-  static void        backwardFlowAnalysis(FnSymbol*     fn,
-                                          BitVecVector& GEN,
-                                          BitVecVector& KILL,
-                                          BitVecVector& IN,
-                                          BitVecVector& OUT);
+  // Uses sparse sets; the only backward analysis is liveness, whose
+  // sets are small compared to the number of locals.
+  static void        backwardFlowAnalysis(FnSymbol*           fn,
+                                          SparseBitVecVector& GEN,
+                                          SparseBitVecVector& KILL,
+                                          SparseBitVecVector& IN,
+                                          SparseBitVecVector& OUT);
 
   static void        forwardFlowAnalysis (FnSymbol*     fn,
                                           BitVecVector& GEN,
@@ -99,8 +103,13 @@ public:
   static void        printLocalsVectorSets(BitVecVector& sets,
                                            Vec<Symbol*>  locals);
 
+  static void        printLocalsVectorSets(SparseBitVecVector& sets,
+                                           Vec<Symbol*>        locals);
+
   static void        printBitVectorSets(BitVecVector& sets);
 
+  static void        printBitVectorSets(SparseBitVecVector& sets);
+
 
   static BasicBlock*                          basicBlock;
   static Map<LabelSymbol*, BasicBlock*>       labelMaps;
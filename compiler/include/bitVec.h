@@ -22,10 +22,21 @@
 #define _CHPL_BIT_VEC_H_
 
 #include <cstddef>
-
+#include <cstdint>
+
+//
+// A dense bit vector.  The bits are kept in 64-bit words and the whole-
+// vector operations are plain loops over the words, which the host
+// compiler vectorizes.  Bits past size() are always zero, so count(),
+// any() and equals() can work a word at a time.
+//
 class BitVec {
 public:
-  unsigned* data;
+  typedef uint64_t Word;
+
+  static const size_t WORD_BITS = 64;
+
+  Word*     data;
   size_t    in_size;
   size_t    ndata;
 
@@ -43,6 +54,7 @@ public:
 
   void   disjunction(const BitVec& other);
   void   intersection(const BitVec& other);
+  void   difference(const BitVec& other);
 
   void   operator =  (const BitVec& other) { this->copy(other);         }
 
@@ -79,11 +91,7 @@ public:
 
 inline void BitVec::operator-=(const BitVec& other)
 {
-  BitVec not_other(other);
-
-  not_other.flip();
-
-  this->intersection(not_other);
+  this->difference(other);
 }
 
 inline bool operator==(const BitVec& a, const BitVec& b)
@@ -122,10 +130,9 @@ inline BitVec operator+(const BitVec& a, const BitVec& b)
 
 inline BitVec operator-(const BitVec& a, const BitVec& b)
 {
-  BitVec result(b);
+  BitVec result(a);
 
-  result.flip();
-  result.intersection(a);
+  result.difference(b);
 
   return result;
 }
@@ -53,6 +53,7 @@ void check_scalarReplace();
 void check_refPropagation();
 void check_copyPropagation();
 void check_deadCodeElimination();
+void check_removeDeadFields();
 void check_removeEmptyRecords();
 void check_localizeGlobals();
 void check_loopInvariantCodeMotion();
@@ -60,6 +61,7 @@ void check_prune2();
 void check_returnStarTuplesByRefArgs();
 void check_insertWideReferences();
 void check_optimizeOnClauses();
+void check_outlineGpuKernels();
 void check_addInitCalls();
 void check_insertLineNumbers();
 void check_denormalize();
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _COMPILE_PROFILE_H_
+#define _COMPILE_PROFILE_H_
+
+/************************************* | **************************************
+*                                                                             *
+* --profile-compile <filename> writes a profile of the compiler itself in the *
+* Chrome trace event format, for chrome://tracing or https://ui.perfetto.dev. *
+*                                                                             *
+* Each pass is an event with the resident set size at its end, the change    *
+* in it over the pass, the peak RSS so far, and the number of live AST nodes. *
+* Other events only record time, since reading the RSS has a cost.           *
+* Within 'resolve', every function resolved and every new instantiation is   *
+* an event of its own, nested in the events that caused it.                   *
+*                                                                             *
+* Events are written as they end, and the closing ']' is optional in this    *
+* format, so the file is usable even if the compiler exits with an error.    *
+*                                                                             *
+************************************** | *************************************/
+
+class FnSymbol;
+
+extern bool fCompileProfile;
+
+void        compileProfileOpen(const char* filename);
+void        compileProfileClose();
+
+// "file:line" for 'fn', noting the generic it was instantiated from.
+const char* compileProfileFnDetail(FnSymbol* fn);
+
+class CompileProfileEvent
+{
+public:
+                 CompileProfileEvent(const char* category,
+                                     const char* name,
+                                     const char* detail     = nullptr,
+                                     bool        withMemory = false);
+                ~CompileProfileEvent();
+
+private:
+  void           begin(const char* category,
+                       const char* name,
+                       const char* detail,
+                       bool        withMemory);
+  void           end();
+
+  bool           mActive;
+  bool           mWithMemory;
+  const char*    mCategory;
+  const char*    mName;
+  const char*    mDetail;
+  unsigned long  mStartUsecs;
+  long           mStartRssKB;
+};
+
+inline CompileProfileEvent::CompileProfileEvent(const char* category,
+                                                const char* name,
+                                                const char* detail,
+                                                bool        withMemory)
+{
+  mActive = fCompileProfile;
+
+  if (mActive)
+    begin(category, name, detail, withMemory);
+}
+
+inline CompileProfileEvent::~CompileProfileEvent()
+{
+  if (mActive)
+    end();
+}
+
+#endif
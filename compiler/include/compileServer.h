@@ -0,0 +1,55 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _COMPILE_SERVER_H_
+#define _COMPILE_SERVER_H_
+
+/************************************* | **************************************
+*                                                                             *
+* --compile-server <socket> parses the internal modules once and then waits   *
+* for compile requests on a Unix domain socket.  Each request is served by a  *
+* fork() of the server, which carries on from the parse of the command line   *
+* files with the internal modules already in memory.                          *
+*                                                                             *
+* The passes after parsing change the AST in place, so no later state can be  *
+* shared between compiles; what the server saves is the internal module      *
+* parse and everything before it (argument handling, printchplenv, ...).      *
+*                                                                             *
+* All compiler options are those the server was started with.  A request     *
+* only gives the directory to compile in, the output name (-o) and the        *
+* source files, which is what 'chpl --compile-server-connect <socket> ...'   *
+* sends.  The compile's standard output and error come back on the            *
+* connection, followed by its exit status.  Requests are served one at a      *
+* time.                                                                       *
+*                                                                             *
+************************************** | *************************************/
+
+// Called by parse() once the internal modules are parsed.  Only returns
+// in a child process that is to compile a request.
+void compileServerRun(const char* socketPath);
+
+// Send the source files named on the command line to the server at
+// 'socketPath', copy its output to stderr, and return the compile's
+// exit status.
+int  compileServerRequest(const char*  socketPath,
+                          int          numFiles,
+                          const char** files);
+
+#endif
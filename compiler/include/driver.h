@@ -43,6 +43,10 @@ extern bool fNoInlineIterators;
 extern bool fNoLoopInvariantCodeMotion;
 extern bool fNoInterproceduralAliasAnalysis;
 extern bool fNoInline;
+extern bool fNoDevirtualize;
+extern bool fNoBulkCopyRecords;
+extern bool fNoStrengthReduceIndexing;
+extern bool fNoMergeFunctions;
 extern bool fNoLiveAnalysis;
 extern bool fNoFormalDomainChecks;
 extern bool fNoLocalChecks;
@@ -50,11 +54,13 @@ extern bool fNoNilChecks;
 extern bool fIgnoreNilabilityErrors;
 extern bool fOverloadSetsChecks;
 extern bool fNoStackChecks;
+extern bool fUnwindLineNumbers;
 extern bool fNoCastChecks;
 extern bool fNoDivZeroChecks;
 extern bool fMungeUserIdents;
 extern bool fEnableTaskTracking;
 extern bool fLLVMWideOpt;
+extern int  fLlvmCodegenThreads;
 
 extern bool fAutoLocalAccess;
 extern bool fDynamicAutoLocalAccess;
@@ -63,6 +69,8 @@ extern bool fReportAutoLocalAccess;
 extern bool fAutoAggregation;
 extern bool fReportAutoAggregation;
 
+extern bool fAutoBulkCopy;
+
 extern bool fNoRemoteValueForwarding;
 extern bool fNoInferConstRefs;
 extern bool fNoRemoteSerialization;
@@ -73,16 +81,22 @@ extern bool fNoOptimizeRangeIteration;
 extern bool fNoOptimizeLoopIterators;
 extern bool fNoVectorize;
 extern bool fForceVectorize;
+extern bool fVectorTuples;
 extern bool fNoPrivatization;
 extern bool fNoOptimizeOnClauses;
 extern bool fNoRemoveEmptyRecords;
+extern bool fNoRemoveDeadFields;
+extern bool fNoReorderFields;
 extern bool fNoInferLocalFields;
 extern bool fRemoveUnreachableBlocks;
 extern bool fReplaceArrayAccessesWithRefTemps;
 extern int  optimize_on_clause_limit;
 extern int  scalar_replace_limit;
 extern int  inline_iter_yield_limit;
+extern int  inline_size_limit;
 extern int  tuple_copy_limit;
+extern int  unroll_and_jam_count;
+extern int  llvm_prefetch_distance;
 
 extern bool fNoOptimizeForallUnordered;
 extern bool fReportOptimizeForallUnordered;
@@ -136,6 +150,13 @@ extern const char* CHPL_LLVM_UNIQ_CFG_PATH;
 extern bool  printPasses;
 extern FILE* printPassesFile;
 
+extern char fCompileServer[FILENAME_MAX+1];
+extern char fCompileServerConnect[FILENAME_MAX+1];
+
+extern char fProfileGenerate[FILENAME_MAX+1];
+extern char fProfileUse[FILENAME_MAX+1];
+extern char fLlvmRuntimeBitcode[FILENAME_MAX+1];
+
 extern char fExplainCall[256];
 extern int  explainCallID;
 extern int  breakOnResolveID;
@@ -223,12 +244,17 @@ extern bool fReportVectorizedLoops;
 extern bool fReportOptimizedOn;
 extern bool fReportPromotion;
 extern bool fReportScalarReplace;
+extern bool fReportDeadFields;
+extern bool fReportGpuKernels;
 extern bool fReportDeadBlocks;
 extern bool fReportDeadModules;
 
 extern bool fPermitUnhandledModuleErrors;
 
 extern bool debugCCode;
+extern bool fDebugLineTablesOnly;
+
+extern char fExternCCacheDir[FILENAME_MAX+1];
 extern bool optimizeCCode;
 extern bool specializeCCode;
 
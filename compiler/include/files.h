@@ -60,6 +60,8 @@ const char* stripdirectories(const char* filename);
 
 void openCFile(fileinfo* fi, const char* name, const char* ext = NULL);
 void closeCFile(fileinfo* fi, bool beautifyIt=true);
+void openCFileIfChanged(fileinfo* fi, const char* name, const char* ext);
+bool closeCFileIfChanged(fileinfo* fi, bool beautifyIt=true);
 
 fileinfo* openTmpFile(const char* tmpfilename, const char* mode = "w");
 
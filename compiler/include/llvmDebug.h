@@ -33,6 +33,7 @@ namespace llvm {
   class DISubprogram;
 }
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/IR/DIBuilder.h"
 #include <vector>
 
@@ -49,7 +50,8 @@ class debug_data
 #ifdef HAVE_LLVM
  public:
   static bool can_debug() { return true; }
-  debug_data(llvm::Module &m) : dibuilder(m){}
+  debug_data(llvm::Module &m, bool lineTablesOnly)
+    : dibuilder(m), lineTablesOnly(lineTablesOnly) {}
   void finalize();
   void create_compile_unit(const char *file, const char *directory, bool is_optimized, const char *flags);
 
@@ -76,6 +78,12 @@ class debug_data
  private:
   llvm::DIBuilder dibuilder;
   bool optimized;
+  // Only describe functions and lines, as for -gline-tables-only; no
+  // types or variables.
+  bool lineTablesOnly;
+  // Types that lower to the same LLVM type, as ref types and generic
+  // instantiations often do, share one description.
+  llvm::DenseMap<llvm::Type*, llvm::DIType*> typesByLLVMType;
   //std::vector<llvm::DIFile>files;
   std::map<const char*,llvm::DIFile*,lessAstr> filesByName;
   //std::vector<llvm::DIType>types;
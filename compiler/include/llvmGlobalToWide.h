@@ -158,6 +158,11 @@ struct GlobalToWideInfo {
   runtime_fn_t memsetFn;
   llvm::FunctionType* memsetFnType;
 
+  // args:  src nodeid, src address, num bytes, commID, line, file
+  // Only set when loads in loops are to be prefetched.
+  runtime_fn_t prefetchFn;
+  llvm::FunctionType* prefetchFnType;
+
   // Dummy function storing the runtime dependencies
   // so that they are not removed by the inliner.
   // This function should be removed from the module
@@ -172,6 +177,7 @@ struct GlobalToWideInfo {
       putFn(NULL), putFnType(NULL),
       getPutFn(NULL), getPutFnType(NULL),
       memsetFn(NULL), memsetFnType(NULL),
+      prefetchFn(NULL), prefetchFnType(NULL),
       hasPreservingFn(false), preservingFn(NULL) { }
 };
 
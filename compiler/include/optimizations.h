@@ -43,12 +43,14 @@ class BaseAST;
 class BitVec;
 class BlockStmt;
 class CallExpr;
+class CForLoop;
 class DefExpr;
 class FnSymbol;
 class ForallStmt;
 class Symbol;
 class SymExpr;
 class LifetimeInformation;
+class SparseBitVec;
 
 void removeUnnecessaryGotos(FnSymbol* fn, bool removeEpilogueLabel = false);
 size_t localCopyPropagation(FnSymbol* fn);
@@ -72,13 +74,20 @@ void liveVariableAnalysis(FnSymbol* fn,
                           Map<Symbol*,int>& localID,
                           Vec<SymExpr*>& useSet,
                           Vec<SymExpr*>& defSet,
-                          std::vector<BitVec*>& OUT);
+                          std::vector<SparseBitVec*>& OUT);
 
 void remoteValueForwarding();
 
 void inferConstRefs();
 
 void computeNoAliasSets();
+bool isAddrTaken(Symbol* var);
+
+bool isInvariantInLoop(Symbol* sym, FnSymbol* fn, CForLoop* loop);
+
+void strengthReduceIndexing();
+
+void bulkCopyRecordLoops();
 
 void removeInitOrAutoCopyPostResolution(CallExpr *call);
 void setDefinedConstForDomainSymbol(Symbol *domainSym, Expr *nextExpr,
@@ -61,11 +61,13 @@ void lowerIterators();
 void makeBinary();
 void normalize();
 void optimizeOnClauses();
+void outlineGpuKernels();
 void parallel();
 void prune();
 void prune2();
 void readExternC();
 void refPropagation();
+void removeDeadFields();
 void removeEmptyRecords();
 void removeUnnecessaryAutoCopyCalls();
 void replaceArrayAccessesWithRefTemps();
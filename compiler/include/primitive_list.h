@@ -302,6 +302,7 @@
   PRIMITIVE_R(PRIM_REQUIRE)
 
   PRIMITIVE_R(PRIM_CHECK_ERROR)
+  PRIMITIVE_G(PRIM_UNLIKELY)
   PRIMITIVE_R(PRIM_CURRENT_ERROR)
 
   PRIMITIVE_R(PRIM_TO_UNMANAGED_CLASS_CHECKED)
@@ -321,6 +322,10 @@
 
   PRIMITIVE_G(PRIM_OPTIMIZATION_INFO)
 
+  PRIMITIVE_G(PRIM_GPU_THREAD_ID)
+  PRIMITIVE_G(PRIM_GPU_ON_GPU_SUBLOC)
+  PRIMITIVE_G(PRIM_GPU_KERNEL_LAUNCH)
+
   PRIMITIVE_R(PRIM_GATHER_TESTS)
   PRIMITIVE_R(PRIM_GET_TEST_BY_INDEX)
   PRIMITIVE_R(PRIM_GET_TEST_BY_NAME)
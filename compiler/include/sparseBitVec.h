@@ -0,0 +1,93 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _CHPL_SPARSE_BIT_VEC_H_
+#define _CHPL_SPARSE_BIT_VEC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//
+// A bit set that only stores the 64-bit words that have a bit set, as
+// parallel vectors of word indices (sorted) and words.  Use it instead
+// of BitVec for sets over a large universe that are usually nearly
+// empty, e.g. the live locals of each basic block in a big function,
+// where a BitVec per block is quadratic in the size of the function.
+//
+// The set operations merge the two index vectors, so they cost time
+// proportional to the words present rather than to the universe.
+//
+class SparseBitVec {
+public:
+  typedef uint64_t Word;
+
+  static const size_t npos = (size_t) -1;
+
+         SparseBitVec();
+
+  void   clear();
+
+  bool   get(size_t i)                                               const;
+  bool   test(size_t i)                                              const;
+  bool   operator[](size_t i) const { return get(i); }
+
+  void   set(size_t i);
+  void   reset(size_t i);
+  void   unset(size_t i) { reset(i); }
+
+  // These return true if this set changed.
+  bool   disjunction(const SparseBitVec& other);
+  bool   intersection(const SparseBitVec& other);
+  bool   difference(const SparseBitVec& other);
+
+  void   operator |= (const SparseBitVec& other) { disjunction(other);  }
+  void   operator &= (const SparseBitVec& other) { intersection(other); }
+  void   operator -= (const SparseBitVec& other) { difference(other);   }
+
+  bool   equals(const SparseBitVec& other)                           const;
+
+  size_t count()                                                     const;
+  bool   any()                                                       const;
+  bool   none()                                                      const;
+
+  // Iterate over the set bits with
+  //   for (size_t i = s.first(); i != SparseBitVec::npos; i = s.next(i))
+  size_t first()                                                     const;
+  size_t next(size_t i)                                              const;
+
+private:
+  size_t find(size_t word)                                           const;
+
+  std::vector<size_t> mIndex;
+  std::vector<Word>   mBits;
+};
+
+inline bool operator==(const SparseBitVec& a, const SparseBitVec& b)
+{
+  return a.equals(b);
+}
+
+inline bool operator!=(const SparseBitVec& a, const SparseBitVec& b)
+{
+  return ! a.equals(b);
+}
+
+#endif
@@ -29,8 +29,11 @@
 #include <cctype>
 #include <cstring>
 #include <cstdio>
+#include <set>
 #include <sstream>
 
+#include <unistd.h>
+
 #ifdef HAVE_LLVM
 #include "clang/AST/GlobalDecl.h"
 
@@ -50,6 +53,7 @@
 #include "clang/Driver/Job.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendAction.h"
+#include "clang/Frontend/FrontendActions.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Lex/MacroInfo.h"
 #include "clang/Lex/Preprocessor.h"
@@ -57,18 +61,25 @@
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Linker/Linker.h"
 #include "llvm/MC/SubtargetFeature.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 
 #if HAVE_LLVM_VER >= 90
 #include "llvm/Support/CodeGen.h"
@@ -130,6 +141,7 @@ using namespace CodeGen;
 
 #include "llvmGlobalToWide.h"
 #include "llvmAggregateGlobalOps.h"
+#include "llvmPrefetchGlobalLoads.h"
 #include "llvmDumpIR.h"
 
 static void setupForGlobalToWide();
@@ -137,6 +149,7 @@ static void adjustLayoutForGlobalToWide();
 static void setupModule();
 
 fileinfo    gAllExternCode;
+std::string ggpuFatbinPath;
 
 // forward declare
 class CCodeGenConsumer;
@@ -1293,12 +1306,24 @@ class CCodeGenConsumer final : public ASTConsumer {
      // can keep it open to codegen more later.
      savedCtx = &Context;
      INT_ASSERT(savedCtx == info->clangInfo->Ctx);
-   }
 
-   void HandleTagDeclDefinition(TagDecl *D) override {
-      if (Diags->hasErrorOccurred()) return;
+     // Declarations that came from a precompiled header weren't parsed,
+     // so we haven't seen them yet.
+     if (!info->clangInfo->Clang->getPreprocessorOpts()
+                                  .ImplicitPCHInclude.empty()) {
+       for (Decl* d : Context.getTranslationUnitDecl()->decls()) {
+         if (!d->isFromASTFile()) continue;
+         doHandleDecl(d);
+         if (TagDecl* td = dyn_cast<TagDecl>(d)) {
+           if (td->isCompleteDefinition())
+             noteTagDecl(td);
+         }
+       }
+     }
+   }
 
-      // make a note of C globals
+   // make a note of C globals
+   void noteTagDecl(TagDecl *D) {
       if(EnumDecl *ed = dyn_cast<EnumDecl>(D)) {
          // Add the enum type
          info->lvt->addGlobalCDecl(ed);
@@ -1315,6 +1340,11 @@ class CCodeGenConsumer final : public ASTConsumer {
            info->lvt->addGlobalCDecl(rd);
          }
       }
+    }
+
+   void HandleTagDeclDefinition(TagDecl *D) override {
+      if (Diags->hasErrorOccurred()) return;
+      noteTagDecl(D);
       if (parseOnly) return;
       Builder->HandleTagDeclDefinition(D);
     }
@@ -1438,6 +1468,30 @@ static void cleanupClang(ClangInfo* clangInfo)
   deleteClang(clangInfo);
 }
 
+static void addClangResourceDir(CompilerInvocation* CI,
+                                const std::string& clangexe)
+{
+  SmallString<128> P;
+  SmallString<128> P2; // avoids a valgrind overlapping memcpy
+
+  P = clangexe;
+  // Remove /clang from foo/bin/clang
+  P2 = sys::path::parent_path(P);
+  // Remove /bin   from foo/bin
+  P = sys::path::parent_path(P2);
+
+  if( ! P.equals("") ) {
+    // Get foo/lib/clang/<version>/
+    sys::path::append(P, "lib");
+    sys::path::append(P, "clang");
+    sys::path::append(P, CLANG_VERSION_STRING);
+  }
+  CI->getHeaderSearchOpts().ResourceDir = std::string(P.str());
+  sys::path::append(P, "include");
+  CI->getHeaderSearchOpts().AddPath(
+      P.str(), frontend::System,false, false);
+}
+
 void setupClang(GenInfo* info, std::string mainFile)
 {
   ClangInfo* clangInfo = info->clangInfo;
@@ -1569,27 +1623,19 @@ void setupClang(GenInfo* info, std::string mainFile)
     clangInfo->codegenOptions.OptimizationLevel = 3;
   }
 
-  {
-    // Make sure we include clang's internal header dir
-    SmallString<128> P;
-    SmallString<128> P2; // avoids a valgrind overlapping memcpy
-
-    P = clangexe;
-    // Remove /clang from foo/bin/clang
-    P2 = sys::path::parent_path(P);
-    // Remove /bin   from foo/bin
-    P = sys::path::parent_path(P2);
-
-    if( ! P.equals("") ) {
-      // Get foo/lib/clang/<version>/
-      sys::path::append(P, "lib");
-      sys::path::append(P, "clang");
-      sys::path::append(P, CLANG_VERSION_STRING);
-    }
-    CI->getHeaderSearchOpts().ResourceDir = std::string(P.str());
-    sys::path::append(P, "include");
-    CI->getHeaderSearchOpts().AddPath(
-        P.str(), frontend::System,false, false);
+  // Make sure we include clang's internal header dir
+  addClangResourceDir(CI, clangexe);
+
+  // A cached precompiled header has been checked against the contents
+  // of everything it includes (see getCachedPCH()), so clang needn't
+  // check their timestamps.
+  if (!CI->getPreprocessorOpts().ImplicitPCHInclude.empty()) {
+#if HAVE_LLVM_VER >= 130
+    CI->getPreprocessorOpts().DisablePCHOrModuleValidation =
+      DisableValidationForModuleKind::PCH;
+#else
+    CI->getPreprocessorOpts().DisablePCHValidation = true;
+#endif
   }
 
   // Create the compilers actual diagnostics engine.
@@ -1613,6 +1659,12 @@ void setupClang(GenInfo* info, std::string mainFile)
       splitStringWhitespace(llvmFlags, vec);
     }
 
+    // The unroll-and-jam pass only runs when asked for; see
+    // --unroll-and-jam and CForLoop::codegen()
+    if (unroll_and_jam_count > 1) {
+      vec.push_back("-enable-unroll-and-jam");
+    }
+
     std::vector<const char*> Args;
     Args.push_back("chpl-llvm-opts");
     for (auto & i : vec) {
@@ -1865,7 +1917,10 @@ void configurePMBuilder(PassManagerBuilder &PMBuilder, bool forFunctionPasses, i
   PMBuilder.LoopVectorize = opts.VectorizeLoop;
 
   PMBuilder.DisableUnrollLoops = !opts.UnrollLoops;
-  PMBuilder.MergeFunctions = opts.MergeFunctions;
+  // Generic instantiations often lower to the same IR, e.g. for int(64)
+  // and uint(64); let LLVM fold them into one function.
+  PMBuilder.MergeFunctions = opts.MergeFunctions ||
+                             (!fNoMergeFunctions && !forFunctionPasses);
 #if HAVE_LLVM_VER > 60
   PMBuilder.PrepareForThinLTO = opts.PrepareForThinLTO;
 #else
@@ -1875,6 +1930,21 @@ void configurePMBuilder(PassManagerBuilder &PMBuilder, bool forFunctionPasses, i
   PMBuilder.PrepareForLTO = opts.PrepareForLTO;
   PMBuilder.RerollLoops = opts.RerollLoops;
 
+  // Profile-guided optimization. Each locale is a separate process, so
+  // the profile file name includes the process id (%p); the files are
+  // merged with 'llvm-profdata merge' into the one --profile-use reads.
+  // Branch weights and function entry counts from the profile drive
+  // LLVM's inlining, block placement and hot/cold function splitting.
+  if (!forFunctionPasses) {
+    if (fProfileGenerate[0]) {
+      PMBuilder.EnablePGOInstrGen = true;
+      PMBuilder.PGOInstrGen = std::string(fProfileGenerate) +
+                              "/chpl-%m-%p.profraw";
+    }
+    if (fProfileUse[0])
+      PMBuilder.PGOInstrUse = fProfileUse;
+  }
+
 
   // Enable Region Vectorizer aka Outer Loop Vectorizer
 #ifdef HAVE_LLVM_RV
@@ -1980,6 +2050,249 @@ bool setAlreadyConvertedExtern(ModuleSymbol* module, const char* name)
 }
 
 
+//
+// Precompiled headers for the C we read with clang, kept across
+// compiles in --extern-c-cache-dir.  A cache entry is named for a hash
+// of the clang version, the arguments and the text being precompiled,
+// and records a hash of every file that text pulled in, so that the
+// entry isn't used once any header it depends on has changed.
+//
+static std::string hashString(const std::string& s) {
+  llvm::MD5 hash;
+  llvm::MD5::MD5Result result;
+  SmallString<32> str;
+
+  hash.update(s);
+  hash.final(result);
+  llvm::MD5::stringifyResult(result, str);
+  return std::string(str.str());
+}
+
+static bool hashFile(const std::string& path, std::string& hash) {
+  auto buf = llvm::MemoryBuffer::getFile(path);
+  if (!buf)
+    return false;
+  hash = hashString((*buf)->getBuffer().str());
+  return true;
+}
+
+static bool readFileToString(const char* path, std::string& text) {
+  auto buf = llvm::MemoryBuffer::getFile(path);
+  if (!buf)
+    return false;
+  text = (*buf)->getBuffer().str();
+  return true;
+}
+
+// Is every file listed in 'depsPath' unchanged?
+static bool pchDepsUpToDate(const std::string& depsPath) {
+  std::string deps;
+  if (!readFileToString(depsPath.c_str(), deps))
+    return false;
+
+  std::istringstream in(deps);
+  std::string line;
+  while (std::getline(in, line)) {
+    size_t space = line.find(' ');
+    std::string hash;
+    if (space == std::string::npos ||
+        !hashFile(line.substr(space + 1), hash) ||
+        hash != line.substr(0, space))
+      return false;
+  }
+  return true;
+}
+
+// The files named in a make-style dependency file clang wrote.
+static std::vector<std::string> readMakeDeps(const std::string& path) {
+  std::vector<std::string> files;
+  std::string text;
+  std::string cur;
+
+  if (!readFileToString(path.c_str(), text))
+    return files;
+
+  for (size_t i = 0; i < text.size(); i++) {
+    char c = text[i];
+    if (c == '\\' && i + 1 < text.size()) {
+      char next = text[i + 1];
+      if (next == '\n') {
+        i++;
+        continue;
+      }
+      if (next == ' ') {
+        cur += ' ';
+        i++;
+        continue;
+      }
+    }
+    if (isspace(c)) {
+      if (!cur.empty() && cur[cur.size() - 1] != ':')
+        files.push_back(cur);
+      cur.clear();
+    } else {
+      cur += c;
+    }
+  }
+  if (!cur.empty() && cur[cur.size() - 1] != ':')
+    files.push_back(cur);
+
+  return files;
+}
+
+// Precompile 'header' into 'pch', recording its inputs in 'depsPath'.
+static bool buildPCH(const std::string& clangexe,
+                     const std::vector<std::string>& args,
+                     const std::string& header,
+                     const std::string& pch,
+                     const std::string& depsPath) {
+  std::vector<const char*> clangArgs;
+  std::string makeDeps = pch + ".d";
+  std::string tmpPch = pch + ".tmp";
+
+  clangArgs.push_back("<chapel clang driver invocation>");
+  for (const std::string& arg : args)
+    clangArgs.push_back(arg.c_str());
+  clangArgs.push_back("-x");
+  clangArgs.push_back("c-header");
+  clangArgs.push_back(header.c_str());
+  clangArgs.push_back("-o");
+  clangArgs.push_back(tmpPch.c_str());
+
+  IntrusiveRefCntPtr<DiagnosticOptions> diagOptions = new DiagnosticOptions();
+  IntrusiveRefCntPtr<DiagnosticIDs> diagID = new DiagnosticIDs();
+  DiagnosticsEngine diags(diagID, &*diagOptions,
+                          new TextDiagnosticPrinter(errs(), &*diagOptions));
+
+  clang::driver::Driver TheDriver(clangexe,
+                                  llvm::sys::getDefaultTargetTriple(),
+                                  diags);
+  std::unique_ptr<clang::driver::Compilation>
+    C(TheDriver.BuildCompilation(clangArgs));
+  if (!C || C->getJobs().empty())
+    return false;
+  clang::driver::Command& job = *C->getJobs().begin();
+
+  CompilerInstance Clang;
+  Clang.createDiagnostics();
+#if HAVE_LLVM_VER >= 100
+  bool success = CompilerInvocation::CreateFromArgs(
+            Clang.getInvocation(), job.getArguments(), diags);
+#else
+  bool success = CompilerInvocation::CreateFromArgs(
+            Clang.getInvocation(),
+            &job.getArguments().front(), (&job.getArguments().back())+1,
+            diags);
+#endif
+  if (!success)
+    return false;
+
+  addClangResourceDir(&Clang.getInvocation(), clangexe);
+
+  DependencyOutputOptions& depOpts = Clang.getDependencyOutputOpts();
+  depOpts.OutputFile = makeDeps;
+  depOpts.Targets.push_back("pch");
+  depOpts.IncludeSystemHeaders = true;
+
+  GeneratePCHAction action;
+  if (!Clang.ExecuteAction(action))
+    return false;
+
+  std::string deps;
+  for (const std::string& file : readMakeDeps(makeDeps)) {
+    std::string hash;
+    if (!hashFile(file, hash))
+      return false;
+    deps += hash + " " + file + "\n";
+  }
+  llvm::sys::fs::remove(makeDeps);
+
+  std::error_code err;
+  llvm::raw_fd_ostream depsOut(depsPath, err);
+  if (err)
+    return false;
+  depsOut << deps;
+  depsOut.close();
+
+  // Rename last, so other compiles never see a partial header.
+  return !llvm::sys::fs::rename(tmpPch, pch);
+}
+
+//
+// Return a precompiled header for 'text' compiled with 'args', or ""
+// if there's no cache or the header can't be built, in which case the
+// caller should have clang parse the text as usual.
+//
+static std::string getCachedPCH(const std::string& clangexe,
+                                const std::vector<std::string>& args,
+                                const std::string& text) {
+  if (fExternCCacheDir[0] == '\0')
+    return "";
+
+  // CUDA compiles run more than one cc1 job; don't try those.
+  if (localeUsesGPU())
+    return "";
+
+  std::string key = CLANG_VERSION_STRING;
+  for (const std::string& arg : args)
+    key += "\n" + arg;
+  key += "\n" + text;
+
+  SmallString<128> base(fExternCCacheDir);
+  sys::fs::make_absolute(base);
+  if (sys::fs::create_directories(base))
+    return "";
+  sys::path::append(base, hashString(key));
+
+  std::string header = std::string(base.str()) + ".h";
+  std::string pch = std::string(base.str()) + ".pch";
+  std::string deps = std::string(base.str()) + ".deps";
+
+  if (sys::fs::exists(pch) && pchDepsUpToDate(deps))
+    return pch;
+
+  {
+    std::error_code err;
+    llvm::raw_fd_ostream out(header, err);
+    if (err)
+      return "";
+    out << text;
+  }
+
+  if (printSystemCommands)
+    printf("<internal clang precompiling %s>\n", header.c_str());
+
+  if (!buildPCH(clangexe, args, header, pch, deps))
+    return "";
+
+  return pch;
+}
+
+// The extern block code, with the per-module files it #includes inlined.
+static bool readAllExternCode(std::string& text) {
+  std::string all;
+  if (!readFileToString(gAllExternCode.filename, all))
+    return false;
+
+  std::istringstream in(all);
+  std::string line;
+  const std::string prefix = "#include \"";
+  while (std::getline(in, line)) {
+    if (line.compare(0, prefix.size(), prefix) == 0 &&
+        line.size() > prefix.size() + 1 && line[line.size() - 1] == '"') {
+      std::string block;
+      std::string path = line.substr(prefix.size(),
+                                     line.size() - prefix.size() - 1);
+      if (!readFileToString(path.c_str(), block))
+        return false;
+      text += block + "\n";
+    } else {
+      text += line + "\n";
+    }
+  }
+  return true;
+}
+
 void runClang(const char* just_parse_filename) {
   static bool is_installed_fatal_error_handler = false;
 
@@ -2106,7 +2419,7 @@ void runClang(const char* just_parse_filename) {
   }
 
   if (debugCCode) {
-    args.push_back(clang_debug);
+    args.push_back(fDebugLineTablesOnly ? "-gline-tables-only" : clang_debug);
     args.push_back("-DCHPL_DEBUG");
   }
 
@@ -2185,31 +2498,71 @@ void runClang(const char* just_parse_filename) {
 
   if (!just_parse_filename) {
     // Running clang to compile all runtime and extern blocks
+    std::vector<std::string> includes;
+    std::string pchText;
+    std::string pch;
 
     // Include header files from the command line.
     {
       int filenum = 0;
       while (const char* inputFilename = nthFilename(filenum++)) {
         if (isCHeader(inputFilename)) {
-          clangOtherArgs.push_back("-include");
-          clangOtherArgs.push_back(inputFilename);
+          SmallString<128> path(inputFilename);
+          sys::fs::make_absolute(path);
+          includes.push_back(inputFilename);
+          pchText += "#include \"" + std::string(path.str()) + "\"\n";
         }
       }
     }
 
     // Include header containing libc wrappers
-    clangOtherArgs.push_back("-include");
-    clangOtherArgs.push_back("llvm/chapel_libc_wrapper.h");
+    includes.push_back("llvm/chapel_libc_wrapper.h");
+    pchText += "#include \"llvm/chapel_libc_wrapper.h\"\n";
 
     // Include extern C blocks
     if( fAllowExternC && gAllExternCode.filename ) {
-      clangOtherArgs.push_back("-include");
-      clangOtherArgs.push_back(gAllExternCode.filename);
+      includes.push_back(gAllExternCode.filename);
+    }
+
+    // These all go in one precompiled header, if we're caching them.
+    std::vector<std::string> pchArgs = clangCCArgs;
+    pchArgs.insert(pchArgs.end(),
+                   clangOtherArgs.begin(), clangOtherArgs.end());
+    if (fExternCCacheDir[0] != '\0' &&
+        (!fAllowExternC || !gAllExternCode.filename ||
+         readAllExternCode(pchText))) {
+      pch = getCachedPCH(clangCC, pchArgs, pchText);
+    }
+
+    if (!pch.empty()) {
+      clangOtherArgs.push_back("-include-pch");
+      clangOtherArgs.push_back(pch);
+    } else {
+      for (const std::string& include : includes) {
+        clangOtherArgs.push_back("-include");
+        clangOtherArgs.push_back(include);
+      }
     }
   } else {
     // Just running clang to parse the extern blocks for this module.
-    clangOtherArgs.push_back("-include");
-    clangOtherArgs.push_back(just_parse_filename);
+    std::vector<std::string> pchArgs = clangCCArgs;
+    std::string text;
+    std::string pch;
+
+    pchArgs.insert(pchArgs.end(),
+                   clangOtherArgs.begin(), clangOtherArgs.end());
+    if (fExternCCacheDir[0] != '\0' &&
+        readFileToString(just_parse_filename, text)) {
+      pch = getCachedPCH(clangCC, pchArgs, text);
+    }
+
+    if (!pch.empty()) {
+      clangOtherArgs.push_back("-include-pch");
+      clangOtherArgs.push_back(pch);
+    } else {
+      clangOtherArgs.push_back("-include");
+      clangOtherArgs.push_back(just_parse_filename);
+    }
   }
 
   if( printSystemCommands ) {
@@ -3154,6 +3507,16 @@ void addAggregateGlobalOps(const PassManagerBuilder &Builder,
   }
 }
 
+static
+void addPrefetchGlobalLoads(const PassManagerBuilder &Builder,
+    llvm::legacy::PassManagerBase &PM) {
+  GenInfo* info = gGenInfo;
+  if( fLLVMWideOpt && llvm_prefetch_distance > 0 ) {
+    PM.add(createPrefetchGlobalLoadsPass(&info->globalToWideInfo,
+                                         llvm_prefetch_distance));
+  }
+}
+
 static
 void addGlobalToWide(const PassManagerBuilder &Builder,
     llvm::legacy::PassManagerBase &PM) {
@@ -3204,6 +3567,141 @@ bool getIrDumpExtensionPoint(llvmStageNum_t s,
   return false;
 }
 
+// Does 'v', or a constant expression it is built from, refer to one of 'gvs'?
+static
+bool refersToGlobal(llvm::Value* v, const std::set<llvm::GlobalValue*>& gvs) {
+  if (llvm::GlobalValue* gv = llvm::dyn_cast<llvm::GlobalValue>(v))
+    return gvs.count(gv) != 0;
+
+  if (llvm::Constant* c = llvm::dyn_cast<llvm::Constant>(v)) {
+    for (llvm::Value* op : c->operands())
+      if (refersToGlobal(op, gvs))
+        return true;
+  }
+
+  return false;
+}
+
+// Link what the module uses from the runtime bitcode given with
+// --llvm-runtime-bitcode, so that runtime functions can be inlined into
+// the generated code.  The program is still linked against the runtime
+// library: imported functions become available_externally, so their
+// bodies are only there to be optimized, and imported variables become
+// declarations.  A function that refers to a mutable static variable of
+// the runtime, directly or through other functions, keeps only its
+// declaration, since a copy of it would use a copy of the variable.
+static
+void linkRuntimeBitcode() {
+  if (fLlvmRuntimeBitcode[0] == '\0') return;
+
+  GenInfo* info = gGenInfo;
+  llvm::Module* module = info->module;
+  llvm::SMDiagnostic err;
+
+  std::unique_ptr<llvm::Module> runtime =
+    llvm::parseIRFile(fLlvmRuntimeBitcode, err, module->getContext());
+
+  if (!runtime)
+    USR_FATAL("Could not read runtime bitcode %s: %s",
+              fLlvmRuntimeBitcode, err.getMessage().str().c_str());
+
+  runtime->setDataLayout(module->getDataLayout());
+  runtime->setTargetTriple(module->getTargetTriple());
+
+  std::set<llvm::GlobalValue*> own;
+  for (llvm::GlobalValue& gv : module->global_values())
+    if (!gv.isDeclaration())
+      own.insert(&gv);
+
+  if (llvm::Linker::linkModules(*module, std::move(runtime),
+                                llvm::Linker::Flags::LinkOnlyNeeded))
+    USR_FATAL("Could not link runtime bitcode %s", fLlvmRuntimeBitcode);
+
+  std::set<llvm::GlobalValue*> tainted;
+
+  for (llvm::GlobalVariable& gv : module->globals()) {
+    if (own.count(&gv) || gv.isDeclaration())
+      continue;
+
+    if (gv.hasLocalLinkage()) {
+      if (!gv.isConstant())
+        tainted.insert(&gv);
+    } else if (gv.isConstant()) {
+      gv.setComdat(nullptr);
+      gv.setLinkage(llvm::GlobalValue::AvailableExternallyLinkage);
+    } else {
+      gv.setComdat(nullptr);
+      gv.setInitializer(nullptr);
+      gv.setLinkage(llvm::GlobalValue::ExternalLinkage);
+    }
+  }
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (llvm::Function& fn : *module) {
+      if (own.count(&fn) || fn.isDeclaration() || tainted.count(&fn))
+        continue;
+
+      bool refers = false;
+      for (llvm::BasicBlock& bb : fn)
+        for (llvm::Instruction& insn : bb)
+          for (llvm::Value* op : insn.operands())
+            if (refersToGlobal(op, tainted))
+              refers = true;
+
+      if (refers) {
+        tainted.insert(&fn);
+        changed = true;
+      }
+    }
+  }
+
+  // Local functions are copies private to this module, and are only
+  // left referring to a tainted variable if nothing else uses them.
+  for (llvm::Function& fn : *module) {
+    if (own.count(&fn) || fn.isDeclaration() || fn.hasLocalLinkage())
+      continue;
+
+    if (tainted.count(&fn)) {
+      fn.deleteBody();
+    } else {
+      fn.setComdat(nullptr);
+      fn.setLinkage(llvm::GlobalValue::AvailableExternallyLinkage);
+    }
+  }
+}
+
+// Embed the GPU fatbinary, built by the GPU codegen child process, in
+// the CPU module as chpl_gpuBinary.  The runtime loads its kernels from
+// there when it starts up.
+static
+void embedGpuBinary() {
+  GenInfo* info = gGenInfo;
+  llvm::Module* module = info->module;
+
+  ggpuFatbinPath = genIntermediateFilename("chpl__gpu.fatbin");
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> fatbin =
+    llvm::MemoryBuffer::getFile(ggpuFatbinPath);
+  if (!fatbin)
+    USR_FATAL("Could not read GPU binary %s: %s", ggpuFatbinPath.c_str(),
+              fatbin.getError().message().c_str());
+
+  llvm::StringRef bytes = (*fatbin)->getBuffer();
+  llvm::Constant* init =
+    llvm::ConstantDataArray::get(module->getContext(),
+                                 llvm::ArrayRef<uint8_t>(
+                                   (const uint8_t*) bytes.data(),
+                                   bytes.size()));
+
+  llvm::GlobalVariable* gv =
+    new llvm::GlobalVariable(*module, init->getType(), /* isConstant */ true,
+                             llvm::GlobalValue::ExternalLinkage, init,
+                             "chpl_gpuBinary");
+  gv->setAlignment(llvm::MaybeAlign(8));
+}
+
 static
 void addDumpIrPass(const PassManagerBuilder &Builder,
     llvm::legacy::PassManagerBase &PM) {
@@ -3246,6 +3744,13 @@ void setupForGlobalToWide(void) {
   info->memsetFn = memsetFn;
   info->memsetFnType = memsetFn->getFunctionType();
 
+  if( llvm_prefetch_distance > 0 ) {
+    llvm::Function* prefetchFn = getFunctionLLVM("chpl_gen_comm_prefetch");
+    INT_ASSERT(prefetchFn);
+    info->prefetchFn = prefetchFn;
+    info->prefetchFnType = prefetchFn->getFunctionType();
+  }
+
   // Call these functions in a dummy externally visible
   // function which GlobalToWide should remove. We need to do that
   // in order to prevent the functions from being removed for
@@ -3275,8 +3780,10 @@ void setupForGlobalToWide(void) {
      llvm::BasicBlock::Create(ginfo->module->getContext(), "entry", fn);
   ginfo->irBuilder->SetInsertPoint(block);
 
+  // prefetchFn is last since it is NULL when not prefetching
   llvm::Value* fns[] = {info->getFn, info->putFn,
-                        info->getPutFn, info->memsetFn, NULL};
+                        info->getPutFn, info->memsetFn,
+                        info->prefetchFn, NULL};
 
   llvm::Value* ret = llvm::Constant::getNullValue(retType);
   llvm::Function::arg_iterator args = fn->arg_begin();
@@ -3380,6 +3887,11 @@ static void runLLVMLinking(std::string useLinkCXX, std::string options,
 static std::string getLibraryOutputPath();
 static void moveGeneratedLibraryFile(const char* tmpbinname);
 static void moveResultFromTmp(const char* resultName, const char* tmpbinname);
+#if HAVE_LLVM_VER >= 100
+static void emitObjectPartitions(const std::string& moduleFilename,
+                                 int numPartitions,
+                                 std::vector<std::string>& partitionFiles);
+#endif
 
 void makeBinaryLLVM(void) {
 
@@ -3395,6 +3907,7 @@ void makeBinaryLLVM(void) {
   std::string asmFilename;
   std::string ptxObjectFilename;
   std::string fatbinFilename;
+  std::vector<std::string> partitionFiles;
 
   if (gCodegenGPU == false) {
     moduleFilename = genIntermediateFilename("chpl__module.o");
@@ -3480,6 +3993,11 @@ void makeBinaryLLVM(void) {
     addedGlobalExts = true;
   }
 
+  linkRuntimeBitcode();
+
+  if (localeUsesGPU())
+    embedGpuBinary();
+
   // Create PassManager and run optimizations
   PassManagerBuilder PMBuilder;
 
@@ -3491,6 +4009,7 @@ void makeBinaryLLVM(void) {
 
   // Add the Global to Wide optimization if necessary.
   if (fLLVMWideOpt) {
+    PMBuilder.addExtension(PassManagerBuilder::EP_OptimizerLast, addPrefetchGlobalLoads);
     PMBuilder.addExtension(PassManagerBuilder::EP_OptimizerLast, addAggregateGlobalOps);
     PMBuilder.addExtension(PassManagerBuilder::EP_OptimizerLast, addGlobalToWide);
     PMBuilder.addExtension(PassManagerBuilder::EP_EnabledOnOptLevel0, addGlobalToWide);
@@ -3602,6 +4121,15 @@ void makeBinaryLLVM(void) {
 
     bool disableVerify = !developer;
 
+    int numPartitions = fLlvmCodegenThreads;
+    if (numPartitions <= 0)
+      numPartitions = sysconf(_SC_NPROCESSORS_ONLN);
+
+#if HAVE_LLVM_VER >= 100
+    if (gCodegenGPU == false && numPartitions > 1) {
+      emitObjectPartitions(moduleFilename, numPartitions, partitionFiles);
+    } else
+#endif
     if (gCodegenGPU == false) {
       llvm::raw_fd_ostream outputOfile(moduleFilename, error, flags);
       if (error || outputOfile.has_error())
@@ -3769,6 +4297,10 @@ void makeBinaryLLVM(void) {
   // Substitute $CHPL_HOME $CHPL_RUNTIME_LIB etc
   expandInstallationPaths(clangLDArgs);
 
+  // Link in the profiling runtime that writes the profile at exit
+  if (fProfileGenerate[0])
+    clangLDArgs.push_back("-fprofile-generate");
+
 
   std::string runtime_ld_override(CHPL_RUNTIME_LIB);
   runtime_ld_override += "/";
@@ -3788,7 +4320,7 @@ void makeBinaryLLVM(void) {
     useLinkCXX = ldOverride[0];
 
 
-  std::vector<std::string> dotOFiles;
+  std::vector<std::string> dotOFiles = partitionFiles;
 
   // Gather C flags for compiling C files.
   std::string cargs;
@@ -3840,7 +4372,7 @@ void makeBinaryLLVM(void) {
   options += get_clang_sysroot_args();
 
   if(debugCCode) {
-    options += " -g";
+    options += fDebugLineTablesOnly ? " -gline-tables-only" : " -g";
   }
 
   // We used to supply link args here *and* later on
@@ -3915,6 +4447,66 @@ void makeBinaryLLVM(void) {
   }
 }
 
+#if HAVE_LLVM_VER >= 100
+// Emits the optimized module as 'numPartitions' object files, generating
+// code for the partitions on parallel threads.  The module is split the
+// way llvm::SplitModule does it, so the objects linked together are
+// equivalent to the single object we would otherwise emit.  The first
+// partition goes to 'moduleFilename' and the names of the others are
+// appended to 'partitionFiles'.
+static void emitObjectPartitions(const std::string& moduleFilename,
+                                 int numPartitions,
+                                 std::vector<std::string>& partitionFiles) {
+  GenInfo* info = gGenInfo;
+  llvm::TargetMachine* targetMachine = info->targetMachine;
+
+  std::vector<std::unique_ptr<llvm::raw_fd_ostream>> outputFiles;
+  std::vector<llvm::raw_pwrite_stream*> outputStreams;
+
+  for (int i = 0; i < numPartitions; i++) {
+    std::string filename = moduleFilename;
+    if (i > 0) {
+      filename = genIntermediateFilename(astr("chpl__module-", istr(i), ".o"));
+      partitionFiles.push_back(filename);
+    }
+
+    std::error_code error;
+    outputFiles.emplace_back(new llvm::raw_fd_ostream(filename, error,
+                                                      llvm::sys::fs::F_None));
+    if (error || outputFiles.back()->has_error())
+      USR_FATAL("Could not open output file %s", filename.c_str());
+
+    outputStreams.push_back(outputFiles.back().get());
+  }
+
+  // Each thread needs its own TargetMachine, set up like ours.
+  auto createTargetMachine = [targetMachine]() {
+    const llvm::Target& target = targetMachine->getTarget();
+    return std::unique_ptr<llvm::TargetMachine>(
+      target.createTargetMachine(targetMachine->getTargetTriple().str(),
+                                 targetMachine->getTargetCPU(),
+                                 targetMachine->getTargetFeatureString(),
+                                 targetMachine->Options,
+                                 targetMachine->getRelocationModel(),
+                                 targetMachine->getCodeModel(),
+                                 targetMachine->getOptLevel()));
+  };
+
+#if HAVE_LLVM_VER >= 130
+  llvm::splitCodeGen(*info->module, outputStreams, {},
+                     createTargetMachine, llvm::CGFT_ObjectFile);
+#else
+  // Before LLVM 13, splitCodeGen() takes ownership of the module, but
+  // ours belongs to clang's CodeGenerator.
+  llvm::splitCodeGen(llvm::CloneModule(*info->module), outputStreams, {},
+                     createTargetMachine, llvm::CGFT_ObjectFile);
+#endif
+
+  for (auto& outputFile : outputFiles)
+    outputFile->close();
+}
+#endif
+
 static void makeLLVMStaticLibrary(std::string moduleFilename,
                                   const char* tmpbinname,
                                   std::vector<std::string> dotOFiles) {
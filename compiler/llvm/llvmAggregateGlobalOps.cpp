@@ -199,6 +199,171 @@ Instruction* postponeDependentInstructions(
   return LastMemopUse;
 }
 
+// Do two pointers to be loaded from compute the same address?
+static bool isSameAddress(Value* A, Value* B)
+{
+  if (A == B)
+    return true;
+
+  GetElementPtrInst* GA = dyn_cast<GetElementPtrInst>(A);
+  GetElementPtrInst* GB = dyn_cast<GetElementPtrInst>(B);
+
+  return GA && GB && GA->isIdenticalTo(GB);
+}
+
+static bool isDefinedOutside(Value* V, BasicBlock* BB)
+{
+  Instruction* I = dyn_cast<Instruction>(V);
+
+  return I == NULL || I->getParent() != BB;
+}
+
+// Can this instruction be moved past going backwards
+// when moving a load up to the end of the predecessor?
+static bool canHoistLoadPast(Instruction* I)
+{
+  return !I->mayWriteToMemory() &&
+         isGuaranteedToTransferExecutionToSuccessor(I);
+}
+
+// Find a load in BB of the same type and from the same address as Load
+// that BB always does before anything that might write memory.
+static LoadInst* findAnticipatedLoad(LoadInst* Load, BasicBlock* BB)
+{
+  for (BasicBlock::iterator BI = BB->begin(); !BI->isTerminator(); ++BI) {
+    Instruction& insnRef = *BI;
+    Instruction* insn = &insnRef;
+
+    if (LoadInst* other = dyn_cast<LoadInst>(insn)) {
+      if (other->isSimple() &&
+          other->getType() == Load->getType() &&
+          isSameAddress(other->getPointerOperand(),
+                        Load->getPointerOperand()))
+        return other;
+    }
+
+    if (!canHoistLoadPast(insn))
+      return NULL;
+  }
+
+  return NULL;
+}
+
+// tryAggregating only looks within one basic block, so e.g.
+//   x = r.a; if c then y = r.b; else y = r.b + r.c;
+// gets r.a and r.b separately. When every successor of BB does a global
+// load before it writes memory, move that load to the end of BB (and drop
+// the copies in the other successors) so it can be aggregated with the
+// loads already there. Since every path out of BB would do the load
+// anyway, no new memory is read. A successor with BB as its only
+// predecessor that BB branches to unconditionally is the straight-line
+// case of the same thing.
+static bool hoistAnticipatedGlobalLoads(BasicBlock* BB,
+                                        unsigned globalSpace,
+                                        bool DebugThis)
+{
+  Instruction* term = BB->getTerminator();
+
+  if (term == NULL || !isa<BranchInst>(term))
+    return false;
+
+  SmallVector<BasicBlock*, 2> succs;
+
+  for (unsigned i = 0; i < term->getNumSuccessors(); i++) {
+    BasicBlock* succ = term->getSuccessor(i);
+
+    if (succ == BB ||
+        succ->getSinglePredecessor() != BB ||
+        isa<PHINode>(succ->begin()))
+      return false;
+
+    for (BasicBlock* other : succs)
+      if (other == succ)
+        return false;
+
+    succs.push_back(succ);
+  }
+
+  if (succs.empty())
+    return false;
+
+  BasicBlock* first = succs[0];
+  bool changed = false;
+
+  for (BasicBlock::iterator BI = first->begin(); !BI->isTerminator();) {
+    Instruction& insnRef = *BI;
+    Instruction* insn = &insnRef;
+    ++BI; // don't invalidate iterator.
+
+    if (!isMergeableGlobalLoadOrStore(insn, globalSpace, true, false)) {
+      if (!canHoistLoadPast(insn))
+        break;
+      continue;
+    }
+
+    LoadInst* load = cast<LoadInst>(insn);
+    Value* ptr = load->getPointerOperand();
+    GetElementPtrInst* gep = NULL;
+
+    // The address has to be available in BB. An address computed in
+    // 'first' from values available in BB is recomputed there.
+    if (!isDefinedOutside(ptr, first)) {
+      gep = dyn_cast<GetElementPtrInst>(ptr);
+
+      if (gep == NULL)
+        continue;
+
+      bool operandsOutside = true;
+      for (Value* op : gep->operands())
+        if (!isDefinedOutside(op, first))
+          operandsOutside = false;
+
+      if (!operandsOutside)
+        continue;
+    }
+
+    SmallVector<LoadInst*, 2> others;
+    bool everywhere = true;
+
+    for (size_t i = 1; i < succs.size(); i++) {
+      LoadInst* other = findAnticipatedLoad(load, succs[i]);
+
+      if (other == NULL) {
+        everywhere = false;
+        break;
+      }
+
+      others.push_back(other);
+    }
+
+    if (!everywhere)
+      continue;
+
+    if( DebugThis ) {
+      dbgs() << "hoisting anticipated load: ";
+      load->print(dbgs(), true);
+      dbgs() << '\n';
+    }
+
+    if (gep != NULL) {
+      Instruction* newGep = gep->clone();
+      newGep->insertBefore(term);
+      load->setOperand(load->getPointerOperandIndex(), newGep);
+    }
+
+    load->moveBefore(term);
+
+    for (LoadInst* other : others) {
+      other->replaceAllUsesWith(load);
+      other->eraseFromParent();
+    }
+
+    changed = true;
+  }
+
+  return changed;
+}
+
 // The next several fns are stolen almost totally unmodified from MemCpyOptimizer.
 // modified code areas say CUSTOM.
 
@@ -850,6 +1015,22 @@ bool AggregateGlobalOpsOpt::runOnFunction(Function &F) {
   DL = & F.getParent()->getDataLayout();
   //TLI = &getAnalysis<TargetLibraryInfo>();
 
+  // First bring loads that are done on every path out of a block into
+  // that block. Repeat so that loads can move up through nested branches.
+  for (int round = 0; round < 4; round++) {
+    bool hoisted = false;
+
+    for (Function::iterator BB = F.begin(), BBE = F.end(); BB != BBE; ++BB) {
+      if (hoistAnticipatedGlobalLoads(&*BB, globalSpace, DebugThis))
+        hoisted = true;
+    }
+
+    if (!hoisted)
+      break;
+
+    ChangedFn = true;
+  }
+
   // Walk all instruction in the function.
   for (Function::iterator BB = F.begin(), BBE = F.end(); BB != BBE; ++BB) {
 
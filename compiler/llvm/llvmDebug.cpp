@@ -115,7 +115,11 @@ void debug_data::create_compile_unit(const char *file, const char *directory, bo
                                     chapel_string, /* Producer */
                                     is_optimized, /* isOptimized */
                                     flags, /* Flags */
-                                    0 /* RV */ );
+                                    0, /* RV */
+                                    "", /* SplitName */
+                                    lineTablesOnly ?
+                                    llvm::DICompileUnit::LineTablesOnly :
+                                    llvm::DICompileUnit::FullDebug);
 }
 
 
@@ -463,10 +467,25 @@ llvm::DIType* debug_data::construct_type(Type *type)
   return NULL;
 }
 
+// Types are only described when something we describe refers to them.
 llvm::DIType* debug_data::get_type(Type *type)
 {
+  if( lineTablesOnly ) return NULL;
+
   if( NULL == type->symbol->llvmDIType ) {
-    type->symbol->llvmDIType = construct_type(type);
+    llvm::Type* ty = type->symbol->llvmType;
+    AggregateType* at = toAggregateType(type);
+    bool shareable = ty != NULL &&
+                     (type->symbol->hasFlag(FLAG_REF) ||
+                      (at != NULL && at->instantiatedFrom != NULL));
+
+    if( shareable && typesByLLVMType.count(ty) > 0 ) {
+      type->symbol->llvmDIType = typesByLLVMType[ty];
+    } else {
+      llvm::DIType* N = construct_type(type);
+      type->symbol->llvmDIType = N;
+      if( shareable && N != NULL ) typesByLLVMType[ty] = N;
+    }
   }
   return llvm::cast_or_null<llvm::DIType>(type->symbol->llvmDIType);
 }
@@ -526,10 +545,13 @@ llvm::DISubroutineType* debug_data::get_function_type(FnSymbol *function)
 {
   llvm::SmallVector<llvm::Metadata *,16> ret_arg_types;
 
-  ret_arg_types.push_back(get_type(function->retType));
-  for_formals(arg, function)
-  {
-    ret_arg_types.push_back(get_type(arg->type));
+  // With line tables only, every function gets the same empty type.
+  if( !lineTablesOnly ) {
+    ret_arg_types.push_back(get_type(function->retType));
+    for_formals(arg, function)
+    {
+      ret_arg_types.push_back(get_type(arg->type));
+    }
   }
   llvm::DITypeRefArray ret_arg_arr = dibuilder.getOrCreateTypeArray(ret_arg_types);
   return this->dibuilder.createSubroutineType(ret_arg_arr);
@@ -545,8 +567,10 @@ llvm::DISubprogram* debug_data::construct_function(FnSymbol *function)
   // Get the function using the cname since that is how it is
   // stored in the generated code. The name is just used within Chapel.
 
-  llvm::DINamespace* module = get_module_scope(modSym);
   llvm::DIFile* file = get_file(file_name);
+  llvm::DIScope* module = lineTablesOnly ?
+                          (llvm::DIScope*) file :
+                          (llvm::DIScope*) get_module_scope(modSym);
 
   llvm::DISubroutineType* function_type = get_function_type(function);
 
@@ -622,6 +646,8 @@ llvm::DIGlobalVariableExpression* debug_data::construct_global_variable(VarSymbo
 
 llvm::DIGlobalVariableExpression* debug_data::get_global_variable(VarSymbol *gVarSym)
 {
+  if( lineTablesOnly ) return NULL;
+
   if( NULL == gVarSym->llvmDIGlobalVariable ) {
     gVarSym->llvmDIGlobalVariable = construct_global_variable(gVarSym);
   }
@@ -664,6 +690,8 @@ llvm::DIVariable* debug_data::construct_variable(VarSymbol *varSym)
 
 llvm::DIVariable* debug_data::get_variable(VarSymbol *varSym)
 {
+  if( lineTablesOnly ) return NULL;
+
   if( NULL == varSym->llvmDIVariable ){
     varSym->llvmDIVariable = construct_variable(varSym);
   }
@@ -704,6 +732,8 @@ llvm::DIVariable* debug_data::construct_formal_arg(ArgSymbol *argSym, unsigned A
 
 llvm::DIVariable* debug_data::get_formal_arg(ArgSymbol *argSym, unsigned int ArgNo)
 {
+  if( lineTablesOnly ) return NULL;
+
   if( NULL == argSym->llvmDIFormal ){
     argSym->llvmDIFormal = construct_formal_arg(argSym, ArgNo);
   }
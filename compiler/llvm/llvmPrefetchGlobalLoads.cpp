@@ -0,0 +1,257 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Software pipelining of global (wide pointer) loads in loops.
+//
+// A load from address space(globalSpace) in an innermost loop whose
+// address advances by a fixed stride each iteration, e.g.
+//
+//   for i in 0..n-1 {
+//     %p = getelementptr ... %A, %i    ; %A is a global pointer
+//     %v = load %p
+//   }
+//
+// gets a call
+//
+//   chpl_gen_comm_prefetch(node(%q), addr(%q), sizeof(*%p), ...)
+//
+// just before it, where %q is the address the load will use
+// 'distance' iterations later, clamped to the address of the last
+// iteration so that nothing past the data the loop reads is fetched.
+// With the remote data cache on, that prefetch starts a non-blocking
+// get and the later load waits for it; local data just gets a
+// hardware prefetch.
+//
+// Only loads done on every iteration, and whose loop has a computable
+// trip count, are prefetched.  node() and addr() are GlobalToWide's
+// dummy functions, so this pass has to run before that one.
+
+#include "llvmPrefetchGlobalLoads.h"
+
+#ifdef HAVE_LLVM
+
+#include "llvmUtil.h"
+
+#include "llvm/Pass.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Verifier.h"
+
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+
+#if HAVE_LLVM_VER >= 110
+#include "llvm/Transforms/Utils/ScalarEvolutionExpander.h"
+#else
+#include "llvm/Analysis/ScalarEvolutionExpander.h"
+#endif
+
+using namespace llvm;
+
+namespace {
+
+static const bool DEBUG = false;
+static const bool extraChecks = true;
+// Set a function name here to get lots of debugging output.
+static const char* debugThisFn = "";
+
+  struct PrefetchGlobalLoads final : public FunctionPass {
+    GlobalToWideInfo* info;
+    unsigned distance;
+
+  public:
+    static char ID; // Pass identification, replacement for typeid
+    PrefetchGlobalLoads() : FunctionPass(ID) {
+      info = NULL;
+      distance = 0;
+    }
+    PrefetchGlobalLoads(GlobalToWideInfo* _info, unsigned _distance)
+      : FunctionPass(ID) {
+      info = _info;
+      distance = _distance;
+    }
+
+    bool runOnFunction(Function &F) override;
+
+  private:
+    void getAnalysisUsage(AnalysisUsage &AU) const override {
+      AU.setPreservesCFG();
+      AU.addRequired<DominatorTreeWrapperPass>();
+      AU.addRequired<LoopInfoWrapperPass>();
+      AU.addRequired<ScalarEvolutionWrapperPass>();
+    }
+
+    bool prefetchLoop(Loop* L, DominatorTree* DT, ScalarEvolution* SE,
+                      bool DebugThis);
+    void emitPrefetch(LoadInst* load, Value* early);
+  };
+
+  char PrefetchGlobalLoads::ID = 0;
+  static RegisterPass<PrefetchGlobalLoads> X("prefetch-global-loads", "Prefetch Global Pointer Loads in Loops", false /* only looks at CFG */, false /* Analysis pass */ );
+
+} // end anon namespace.
+
+// createPrefetchGlobalLoadsPass - The public interface to this file...
+FunctionPass *createPrefetchGlobalLoadsPass(GlobalToWideInfo* info,
+                                            unsigned distance)
+{
+  return new PrefetchGlobalLoads(info, distance);
+}
+
+// Is 'BB' run on every iteration of 'L', including the last one?
+static bool runsEveryIteration(Loop* L, BasicBlock* BB, DominatorTree* DT) {
+  SmallVector<BasicBlock*, 4> exiting;
+
+  L->getExitingBlocks(exiting);
+
+  for (BasicBlock* exit : exiting) {
+    if (!DT->dominates(BB, exit))
+      return false;
+  }
+
+  return !exiting.empty();
+}
+
+// Add the prefetch of the global pointer 'early' just before 'load'.
+void PrefetchGlobalLoads::emitPrefetch(LoadInst* load, Value* early) {
+  Module* M = load->getModule();
+  const DataLayout& DL = M->getDataLayout();
+  FunctionType* fnTy = info->prefetchFnType;
+  Type* globalPtrTy = early->getType();
+  IRBuilder<> B(load);
+
+  Value* node = B.CreateCall(getNodeFn(M, info, globalPtrTy), early);
+  Value* addr = B.CreateCall(getAddrFn(M, info, globalPtrTy), early);
+  uint64_t size = DL.getTypeStoreSize(load->getType());
+  unsigned line = 0;
+
+  if (const DebugLoc& loc = load->getDebugLoc())
+    line = loc.getLine();
+
+  Value* args[] = {
+    B.CreateIntCast(node, fnTy->getParamType(0), false),
+    B.CreatePointerCast(addr, fnTy->getParamType(1)),
+    ConstantInt::get(fnTy->getParamType(2), size),
+    ConstantInt::get(fnTy->getParamType(3), 0),
+    ConstantInt::get(fnTy->getParamType(4), line),
+    ConstantInt::get(fnTy->getParamType(5), 0)
+  };
+
+  B.CreateCall(fnTy, info->prefetchFn, args);
+}
+
+bool PrefetchGlobalLoads::prefetchLoop(Loop* L, DominatorTree* DT,
+                                       ScalarEvolution* SE, bool DebugThis) {
+  const SCEV* btc = SE->getBackedgeTakenCount(L);
+
+  if (isa<SCEVCouldNotCompute>(btc))
+    return false;
+
+  // The iteration 'distance' ahead of this one, but no later than the last.
+  Type* countTy = btc->getType();
+  const SCEV* ahead = SE->getAddRecExpr(SE->getConstant(countTy, distance),
+                                        SE->getOne(countTy),
+                                        L, SCEV::FlagAnyWrap);
+  const SCEV* iter = SE->getUMinExpr(ahead, btc);
+
+  SCEVExpander expander(*SE, L->getHeader()->getModule()->getDataLayout(),
+                        "prefetch");
+  SmallPtrSet<const SCEV*, 8> done;
+  SmallVector<std::pair<LoadInst*, const SCEV*>, 8> loads;
+
+  for (BasicBlock* BB : L->blocks()) {
+    if (!runsEveryIteration(L, BB, DT))
+      continue;
+
+    for (Instruction& I : *BB) {
+      LoadInst* load = dyn_cast<LoadInst>(&I);
+
+      if (!load || !load->isSimple() ||
+          load->getPointerAddressSpace() != info->globalSpace)
+        continue;
+
+      const SCEVAddRecExpr* ar =
+        dyn_cast<SCEVAddRecExpr>(SE->getSCEV(load->getPointerOperand()));
+
+      if (!ar || ar->getLoop() != L || !ar->isAffine())
+        continue;
+
+      const SCEV* early = ar->evaluateAtIteration(iter, *SE);
+
+      if (!isSafeToExpandAt(early, load, *SE) || !done.insert(early).second)
+        continue;
+
+      loads.push_back(std::make_pair(load, early));
+    }
+  }
+
+  for (auto& pair : loads) {
+    LoadInst* load = pair.first;
+    Value* early = expander.expandCodeFor(pair.second,
+                                          load->getPointerOperandType(),
+                                          load);
+
+    emitPrefetch(load, early);
+
+    if( DebugThis ) {
+      dbgs() << "Prefetching " << *load << " as " << *early << "\n";
+    }
+  }
+
+  return !loads.empty();
+}
+
+// PrefetchGlobalLoads::runOnFunction - This is the main transformation
+// entry point for a function.
+//
+bool PrefetchGlobalLoads::runOnFunction(Function &F) {
+  bool ChangedFn = false;
+  bool DebugThis = DEBUG;
+
+  if( info == NULL || !info->prefetchFn || distance == 0 ) {
+    return false;
+  }
+
+  if( debugThisFn[0] && F.getName() == debugThisFn ) {
+    DebugThis = true;
+  }
+
+  DominatorTree* DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+  LoopInfo* LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+  ScalarEvolution* SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+
+  for (Loop* L : LI->getLoopsInPreorder()) {
+    if (L->getSubLoops().empty() && prefetchLoop(L, DT, SE, DebugThis))
+      ChangedFn = true;
+  }
+
+  if( extraChecks ) {
+    assert(!verifyFunction(F, &errs()));
+  }
+
+  return ChangedFn;
+}
+
+#endif
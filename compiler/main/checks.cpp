@@ -319,6 +319,16 @@ void check_deadCodeElimination()
   // Suggestion: Ensure no dead code.
 }
 
+void check_removeDeadFields()
+{
+  check_afterEveryPass();
+  check_afterNormalization();
+  check_afterCallDestructors();
+  check_afterLowerIterators();
+  check_afterResolveIntents();
+  check_afterInlineFunctions();
+}
+
 void check_removeEmptyRecords()
 {
   check_afterEveryPass();
@@ -391,6 +401,16 @@ void check_optimizeOnClauses()
   check_afterInlineFunctions();
 }
 
+void check_outlineGpuKernels()
+{
+  check_afterEveryPass();
+  check_afterNormalization();
+  check_afterCallDestructors();
+  check_afterLowerIterators();
+  check_afterResolveIntents();
+  check_afterInlineFunctions();
+}
+
 void check_addInitCalls()
 {
   check_afterEveryPass();
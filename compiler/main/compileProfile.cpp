@@ -0,0 +1,171 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compileProfile.h"
+
+#include "baseAST.h"
+#include "misc.h"
+#include "stringutil.h"
+#include "symbol.h"
+#include "timer.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <cstdio>
+
+bool         fCompileProfile = false;
+
+static FILE* sProfileFile    = NULL;
+static Timer sProfileTimer;
+static bool  sFirstEvent     = true;
+
+#define sum_gvecs(type) g##type##s.n
+
+static long liveAstCount() {
+  return foreach_ast_sep(sum_gvecs, +);
+}
+
+#undef sum_gvecs
+
+// The current resident set size in KiB, or -1 if unknown.
+static long currentRssKB() {
+  long  pages = -1;
+  FILE* fp    = fopen("/proc/self/statm", "r");
+
+  if (fp != NULL) {
+    long size = 0;
+
+    if (fscanf(fp, "%ld %ld", &size, &pages) != 2)
+      pages = -1;
+
+    fclose(fp);
+  }
+
+  return pages < 0 ? -1 : pages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// The peak resident set size in KiB.
+static long peakRssKB() {
+  struct rusage usage;
+
+  getrusage(RUSAGE_SELF, &usage);
+
+#if defined(__APPLE__)
+  return usage.ru_maxrss / 1024;  // bytes on Mac OS X
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+static void writeJsonString(const char* str) {
+  fputc('"', sProfileFile);
+
+  for (const char* p = str; *p != '\0'; p++) {
+    if (*p == '"' || *p == '\\')
+      fprintf(sProfileFile, "\\%c", *p);
+    else if ((unsigned char) *p < 0x20)
+      fprintf(sProfileFile, "\\u%04x", (unsigned char) *p);
+    else
+      fputc(*p, sProfileFile);
+  }
+
+  fputc('"', sProfileFile);
+}
+
+void compileProfileOpen(const char* filename) {
+  sProfileFile = fopen(filename, "w");
+
+  if (sProfileFile == NULL) {
+    USR_WARN("Error opening profile file: %s.", filename);
+    return;
+  }
+
+  fprintf(sProfileFile, "[");
+
+  fCompileProfile = true;
+  sProfileTimer.start();
+}
+
+void compileProfileClose() {
+  if (sProfileFile != NULL) {
+    fprintf(sProfileFile, "\n]\n");
+    fclose(sProfileFile);
+
+    sProfileFile    = NULL;
+    fCompileProfile = false;
+  }
+}
+
+const char* compileProfileFnDetail(FnSymbol* fn) {
+  const char* detail = astr(fn->fname(), ":", istr(fn->linenum()));
+
+  if (FnSymbol* generic = fn->instantiatedFrom)
+    detail = astr(detail, ", instantiated from ",
+                  generic->fname(), ":", istr(generic->linenum()));
+
+  return detail;
+}
+
+void CompileProfileEvent::begin(const char* category,
+                                const char* name,
+                                const char* detail,
+                                bool        withMemory) {
+  mCategory   = category;
+  mName       = name;
+  mDetail     = detail;
+  mWithMemory = withMemory;
+  mStartUsecs = sProfileTimer.elapsedUsecs();
+  mStartRssKB = withMemory ? currentRssKB() : 0;
+}
+
+void CompileProfileEvent::end() {
+  // The file may have been closed while this event was open.
+  if (sProfileFile == NULL)
+    return;
+
+  unsigned long now = sProfileTimer.elapsedUsecs();
+
+  fprintf(sProfileFile, "%s\n{\"name\":", sFirstEvent ? "" : ",");
+  writeJsonString(mName);
+  fprintf(sProfileFile, ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+                        ",\"ts\":%lu,\"dur\":%lu,\"args\":{",
+          mCategory, mStartUsecs, now - mStartUsecs);
+
+  const char* sep = "";
+
+  if (mDetail != NULL) {
+    fprintf(sProfileFile, "\"detail\":");
+    writeJsonString(mDetail);
+    sep = ",";
+  }
+
+  if (mWithMemory) {
+    long rssKB = currentRssKB();
+
+    fprintf(sProfileFile, "%s\"rssKB\":%ld,\"rssDeltaKB\":%ld"
+                          ",\"peakRssKB\":%ld,\"asts\":%ld",
+            sep, rssKB, rssKB - mStartRssKB, peakRssKB(), liveAstCount());
+  }
+
+  fprintf(sProfileFile, "}}");
+
+  sFirstEvent = false;
+}
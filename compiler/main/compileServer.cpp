@@ -0,0 +1,288 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compileServer.h"
+
+#include "files.h"
+#include "misc.h"
+#include "stringutil.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+//
+// A request is a sequence of NUL-terminated strings:
+//
+//   <number of files> <directory> <output name, maybe empty> <file>...
+//
+// The reply is the compile's output, then a NUL, then its exit status
+// in decimal.
+//
+
+static void initAddress(sockaddr_un* addr, const char* socketPath) {
+  memset(addr, 0, sizeof(*addr));
+
+  addr->sun_family = AF_UNIX;
+
+  if (strlen(socketPath) >= sizeof(addr->sun_path)) {
+    USR_FATAL("compile server socket path '%s' is too long", socketPath);
+  }
+
+  strcpy(addr->sun_path, socketPath);
+}
+
+static bool writeAll(int fd, const char* buf, size_t len) {
+  while (len > 0) {
+    ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+
+    if (n < 0 && errno == EINTR) {
+      continue;
+    } else if (n <= 0) {
+      return false;
+    }
+
+    buf += n;
+    len -= n;
+  }
+
+  return true;
+}
+
+// Reads one request from 'fd'; returns false if it is malformed or the
+// connection closes early.
+static bool readRequest(int fd, std::vector<std::string>& request) {
+  std::string item;
+  size_t      expected = 3;
+
+  while (request.size() < expected) {
+    char    c = '\0';
+    ssize_t n = read(fd, &c, 1);
+
+    if (n < 0 && errno == EINTR) {
+      continue;
+    } else if (n <= 0) {
+      return false;
+    }
+
+    if (c != '\0') {
+      item += c;
+
+    } else {
+      request.push_back(item);
+
+      if (request.size() == 1) {
+        expected += strtoul(item.c_str(), NULL, 10);
+      }
+
+      item.clear();
+    }
+  }
+
+  return true;
+}
+
+// In the child: set up the compile that 'request' asks for.
+static void startRequest(const std::vector<std::string>& request) {
+  std::vector<const char*> files;
+
+  if (chdir(request[1].c_str()) != 0) {
+    USR_FATAL("compile server can't change to directory '%s': %s",
+              request[1].c_str(), strerror(errno));
+  }
+
+  if (request[2].empty() == false) {
+    strncpy(executableFilename, request[2].c_str(), FILENAME_MAX);
+    executableFilename[FILENAME_MAX] = '\0';
+  }
+
+  for (size_t i = 3; i < request.size(); i++) {
+    files.push_back(astr(request[i].c_str()));
+  }
+
+  addSourceFiles((int) files.size(), files.data());
+}
+
+static int waitForCompile(pid_t pid) {
+  int status = 0;
+
+  while (waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR) {
+      return 1;
+    }
+  }
+
+  if (WIFEXITED(status)) {
+    return WEXITSTATUS(status);
+  } else if (WIFSIGNALED(status)) {
+    return 128 + WTERMSIG(status);
+  }
+
+  return 1;
+}
+
+void compileServerRun(const char* socketPath) {
+  sockaddr_un addr;
+  int         listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  initAddress(&addr, socketPath);
+
+  if (listenFd < 0) {
+    USR_FATAL("can't create compile server socket: %s", strerror(errno));
+  }
+
+  unlink(socketPath);
+
+  if (bind(listenFd, (sockaddr*) &addr, sizeof(addr)) != 0 ||
+      listen(listenFd, 16)                            != 0) {
+    USR_FATAL("can't listen on compile server socket '%s': %s",
+              socketPath, strerror(errno));
+  }
+
+  fprintf(stderr, "compile server listening on %s\n", socketPath);
+
+  while (true) {
+    std::vector<std::string> request;
+    int                      conn   = accept(listenFd, NULL, NULL);
+    int                      status = 1;
+    char                     reply[32];
+
+    if (conn < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      USR_FATAL("compile server accept failed: %s", strerror(errno));
+    }
+
+    if (readRequest(conn, request) == false) {
+      close(conn);
+      continue;
+    }
+
+    // Don't let the child inherit anything still buffered.
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t pid = fork();
+
+    if (pid == 0) {
+      close(listenFd);
+
+      dup2(conn, STDOUT_FILENO);
+      dup2(conn, STDERR_FILENO);
+
+      close(conn);
+
+      startRequest(request);
+
+      return;
+    }
+
+    if (pid > 0) {
+      status = waitForCompile(pid);
+    }
+
+    snprintf(reply, sizeof(reply), "%c%d", '\0', status);
+
+    writeAll(conn, reply, 1 + strlen(reply + 1));
+
+    close(conn);
+  }
+}
+
+int compileServerRequest(const char*  socketPath,
+                         int          numFiles,
+                         const char** files) {
+  sockaddr_un addr;
+  std::string request;
+  std::string status;
+  bool        inStatus = false;
+  char        cwd[FILENAME_MAX+1];
+  char        buf[4096];
+  int         fd       = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  initAddress(&addr, socketPath);
+
+  if (fd < 0 || connect(fd, (sockaddr*) &addr, sizeof(addr)) != 0) {
+    USR_FATAL("can't connect to compile server at '%s': %s",
+              socketPath, strerror(errno));
+  }
+
+  if (getcwd(cwd, sizeof(cwd)) == NULL) {
+    USR_FATAL("can't get the current directory: %s", strerror(errno));
+  }
+
+  request += istr(numFiles);
+  request += '\0';
+  request += cwd;
+  request += '\0';
+  request += executableFilename;
+  request += '\0';
+
+  for (int i = 0; i < numFiles; i++) {
+    request += files[i];
+    request += '\0';
+  }
+
+  if (writeAll(fd, request.data(), request.size()) == false) {
+    USR_FATAL("can't send request to compile server: %s", strerror(errno));
+  }
+
+  while (true) {
+    ssize_t n = read(fd, buf, sizeof(buf));
+
+    if (n < 0 && errno == EINTR) {
+      continue;
+    } else if (n <= 0) {
+      break;
+    }
+
+    for (ssize_t i = 0; i < n; i++) {
+      if (inStatus) {
+        status += buf[i];
+
+      } else if (buf[i] == '\0') {
+        fwrite(buf, 1, i, stderr);
+        inStatus = true;
+      }
+    }
+
+    if (inStatus == false) {
+      fwrite(buf, 1, n, stderr);
+    }
+  }
+
+  close(fd);
+
+  if (inStatus == false || status.empty()) {
+    USR_FATAL("lost connection to compile server");
+  }
+
+  return atoi(status.c_str());
+}
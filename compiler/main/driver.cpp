@@ -28,6 +28,8 @@
 #include "arg.h"
 #include "chpl.h"
 #include "commonFlags.h"
+#include "compileProfile.h"
+#include "compileServer.h"
 #include "config.h"
 #include "countTokens.h"
 #include "docsDriver.h"
@@ -141,6 +143,7 @@ bool fNoOptimizeLoopIterators = false;
 bool fNoVectorize = false; // adjusted in postVectorize
 static bool fYesVectorize = false;
 bool fForceVectorize = false;
+bool fVectorTuples = false;
 bool fNoGlobalConstOpt = false;
 bool fNoFastFollowers = false;
 bool fNoInlineIterators = false;
@@ -153,6 +156,7 @@ bool fNoNilChecks = false;
 bool fIgnoreNilabilityErrors = false;
 bool fOverloadSetsChecks = true;
 bool fNoStackChecks = false;
+bool fUnwindLineNumbers = false;
 bool fNoInferLocalFields = false;
 bool fReplaceArrayAccessesWithRefTemps = false;
 bool fUserSetStackChecks = false;
@@ -167,12 +171,23 @@ bool fReportAutoLocalAccess= false;
 bool fAutoAggregation = false;
 bool fReportAutoAggregation= false;
 
+bool fAutoBulkCopy = false;
+
 bool  printPasses     = false;
 FILE* printPassesFile = NULL;
 
+char fCompileServer[FILENAME_MAX+1] = "";
+char fCompileServerConnect[FILENAME_MAX+1] = "";
+char fProfileGenerate[FILENAME_MAX+1] = "";
+char fProfileUse[FILENAME_MAX+1] = "";
+char fLlvmRuntimeBitcode[FILENAME_MAX+1] = "";
+
 // flag for llvmWideOpt
 bool fLLVMWideOpt = false;
 
+// number of threads for LLVM code generation, 0 for one per processor
+int fLlvmCodegenThreads = 1;
+
 bool fWarnConstLoops = true;
 bool fWarnUnstable = false;
 
@@ -185,9 +200,15 @@ bool fNoLoopInvariantCodeMotion = false;
 bool fNoInterproceduralAliasAnalysis = true;
 bool fNoChecks = false;
 bool fNoInline = false;
+bool fNoDevirtualize = false;
+bool fNoBulkCopyRecords = false;
+bool fNoStrengthReduceIndexing = false;
+bool fNoMergeFunctions = false;
 bool fNoPrivatization = false;
 bool fNoOptimizeOnClauses = false;
 bool fNoRemoveEmptyRecords = true;
+bool fNoRemoveDeadFields = true;
+bool fNoReorderFields = false;
 bool fRemoveUnreachableBlocks = true;
 bool fMinimalModules = false;
 bool fIncrementalCompilation = false;
@@ -196,7 +217,10 @@ bool fNoOptimizeForallUnordered = false;
 int optimize_on_clause_limit = 20;
 int scalar_replace_limit = 8;
 int inline_iter_yield_limit = 10;
+int inline_size_limit = 32;
 int tuple_copy_limit = scalar_replace_limit;
+int unroll_and_jam_count = 0;
+int llvm_prefetch_distance = 0;
 bool fGenIDS = false;
 bool fDetectColorTerminal = true;
 bool fUseColorTerminal = false;
@@ -242,6 +266,8 @@ bool fReportOptimizedOn = false;
 bool fReportOptimizeForallUnordered = false;
 bool fReportPromotion = false;
 bool fReportScalarReplace = false;
+bool fReportDeadFields = false;
+bool fReportGpuKernels = false;
 bool fReportDeadBlocks = false;
 bool fReportDeadModules = false;
 bool fPermitUnhandledModuleErrors = false;
@@ -269,6 +295,9 @@ char breakOnCodegenCname[256] = "";
 int breakOnCodegenID = 0;
 
 bool debugCCode = false;
+bool fDebugLineTablesOnly = false;
+
+char fExternCCacheDir[FILENAME_MAX+1] = "";
 bool optimizeCCode = false;
 bool specializeCCode = false;
 
@@ -561,6 +590,14 @@ static void setChapelDebug(const ArgumentDescription* desc, const char* arg_unus
   printCppLineno = true;
 }
 
+static void setDebugLineTablesOnly(const ArgumentDescription* desc,
+                                   const char* arg_unused) {
+  if (fDebugLineTablesOnly) {
+    debugCCode = true;
+    printCppLineno = true;
+  }
+}
+
 static void setPrintIr(const ArgumentDescription* desc, const char* arg) {
   if (llvmPrintIrStageNum == llvmStageNum::NOPRINT)
     llvmPrintIrStageNum = llvmStageNum::BASIC;
@@ -742,6 +779,10 @@ static void setFastFlag(const ArgumentDescription* desc, const char* unused) {
   fNoLoopInvariantCodeMotion= false;
   fNoInterproceduralAliasAnalysis = false;
   fNoInline = false;
+  fNoDevirtualize = false;
+  fNoBulkCopyRecords = false;
+  fNoStrengthReduceIndexing = false;
+  fNoMergeFunctions = false;
   fNoInlineIterators = false;
   fNoOptimizeRangeIteration = false;
   fNoOptimizeLoopIterators = false;
@@ -792,6 +833,11 @@ static void setBaselineFlag(const ArgumentDescription* desc, const char* unused)
                                       // --no-interprocedural-alias-analysis
   fNoInterproceduralAliasAnalysis = true;
   fNoInline = true;                   // --no-inline
+  fNoDevirtualize = true;             // --no-devirtualize
+  fNoBulkCopyRecords = true;          // --no-bulk-copy-records
+  fNoStrengthReduceIndexing = true;   // --no-strength-reduce-indexing
+  fNoReorderFields = true;            // --no-reorder-fields
+  fNoMergeFunctions = true;           // --no-merge-functions
   fNoInlineIterators = true;          // --no-inline-iterators
   fNoLiveAnalysis = true;             // --no-live-analysis
   fNoOptimizeRangeIteration = true;   // --no-optimize-range-iteration
@@ -864,6 +910,10 @@ static void setPrintPassesFile(const ArgumentDescription* desc, const char* file
   }
 }
 
+static void setProfileCompileFile(const ArgumentDescription* desc, const char* fileName) {
+  compileProfileOpen(fileName);
+}
+
 static void setLocal (const ArgumentDescription* desc, const char* unused) {
   // Used in postLocal() to set fLocal if user threw flag
   fUserSetLocal = true;
@@ -932,18 +982,22 @@ static ArgumentDescription arg_desc[] = {
 
  {"", ' ', NULL, "Optimization Control Options", NULL, NULL, NULL, NULL},
  {"baseline", ' ', NULL, "Disable all Chapel optimizations", "F", &fBaseline, "CHPL_BASELINE", setBaselineFlag},
+ {"bulk-copy-records", ' ', NULL, "Enable [disable] replacing loops that copy arrays of simple records with bulk copies", "n", &fNoBulkCopyRecords, "CHPL_DISABLE_BULK_COPY_RECORDS", NULL},
  {"cache-remote", ' ', NULL, "[Don't] enable cache for remote data", "N", &fCacheRemote, "CHPL_CACHE_REMOTE", NULL},
  {"copy-propagation", ' ', NULL, "Enable [disable] copy propagation", "n", &fNoCopyPropagation, "CHPL_DISABLE_COPY_PROPAGATION", NULL},
  {"dead-code-elimination", ' ', NULL, "Enable [disable] dead code elimination", "n", &fNoDeadCodeElimination, "CHPL_DISABLE_DEAD_CODE_ELIMINATION", NULL},
+ {"devirtualize", ' ', NULL, "Enable [disable] devirtualization of dynamically dispatched calls", "n", &fNoDevirtualize, "CHPL_DISABLE_DEVIRTUALIZE", NULL},
  {"fast", ' ', NULL, "Disable checks; optimize/specialize code", "F", &fFastFlag, "CHPL_FAST", setFastFlag},
  {"fast-followers", ' ', NULL, "Enable [disable] fast followers", "n", &fNoFastFollowers, "CHPL_DISABLE_FAST_FOLLOWERS", NULL},
  {"ieee-float", ' ', NULL, "Generate code that is strict [lax] with respect to IEEE compliance", "N", &fieeefloat, "CHPL_IEEE_FLOAT", setFloatOptFlag},
  {"ignore-local-classes", ' ', NULL, "Disable [enable] local classes", "N", &fIgnoreLocalClasses, NULL, NULL},
  {"inline", ' ', NULL, "Enable [disable] function inlining", "n", &fNoInline, NULL, NULL},
+ {"inline-size-limit", ' ', "<limit>", "Limit on the size of functions inlined without the inline keyword, 0 to disable", "I", &inline_size_limit, "CHPL_INLINE_SIZE_LIMIT", NULL},
  {"inline-iterators", ' ', NULL, "Enable [disable] iterator inlining", "n", &fNoInlineIterators, "CHPL_DISABLE_INLINE_ITERATORS", NULL},
  {"inline-iterators-yield-limit", ' ', "<limit>", "Limit number of yields permitted in inlined iterators", "I", &inline_iter_yield_limit, "CHPL_INLINE_ITER_YIELD_LIMIT", NULL},
  {"live-analysis", ' ', NULL, "Enable [disable] live variable analysis", "n", &fNoLiveAnalysis, "CHPL_DISABLE_LIVE_ANALYSIS", NULL},
  {"loop-invariant-code-motion", ' ', NULL, "Enable [disable] loop invariant code motion", "n", &fNoLoopInvariantCodeMotion, NULL, NULL},
+ {"merge-functions", ' ', NULL, "Enable [disable] merging of functions with identical LLVM IR", "n", &fNoMergeFunctions, "CHPL_DISABLE_MERGE_FUNCTIONS", NULL},
  {"optimize-forall-unordered-ops", ' ', NULL, "Enable [disable] optimization of foralls to unordered operations", "n", &fNoOptimizeForallUnordered, "CHPL_DISABLE_OPTIMIZE_FORALL_UNORDERED_OPS", NULL},
  {"optimize-range-iteration", ' ', NULL, "Enable [disable] optimization of iteration over anonymous ranges", "n", &fNoOptimizeRangeIteration, "CHPL_DISABLE_OPTIMIZE_RANGE_ITERATION", NULL},
  {"optimize-loop-iterators", ' ', NULL, "Enable [disable] optimization of iterators composed of a single loop", "n", &fNoOptimizeLoopIterators, "CHPL_DISABLE_OPTIMIZE_LOOP_ITERATORS", NULL},
@@ -955,15 +1009,18 @@ static ArgumentDescription arg_desc[] = {
  {"remove-copy-calls", ' ', NULL, "Enable [disable] remove copy calls", "n", &fNoRemoveCopyCalls, "CHPL_DISABLE_REMOVE_COPY_CALLS", NULL},
  {"scalar-replacement", ' ', NULL, "Enable [disable] scalar replacement", "n", &fNoScalarReplacement, "CHPL_DISABLE_SCALAR_REPLACEMENT", NULL},
  {"scalar-replace-limit", ' ', "<limit>", "Limit on the size of tuples being replaced during scalar replacement", "I", &scalar_replace_limit, "CHPL_SCALAR_REPLACE_TUPLE_LIMIT", NULL},
+ {"strength-reduce-indexing", ' ', NULL, "Enable [disable] strength reduction of array index arithmetic in loops", "n", &fNoStrengthReduceIndexing, "CHPL_DISABLE_STRENGTH_REDUCE_INDEXING", NULL},
  {"tuple-copy-opt", ' ', NULL, "Enable [disable] tuple (memcpy) optimization", "n", &fNoTupleCopyOpt, "CHPL_DISABLE_TUPLE_COPY_OPT", NULL},
  {"tuple-copy-limit", ' ', "<limit>", "Limit on the size of tuples considered for optimization", "I", &tuple_copy_limit, "CHPL_TUPLE_COPY_LIMIT", NULL},
  {"infer-local-fields", ' ', NULL, "Enable [disable] analysis to infer local fields in classes and records", "n", &fNoInferLocalFields, "CHPL_DISABLE_INFER_LOCAL_FIELDS", NULL},
  {"vectorize", ' ', NULL, "Enable [disable] generation of vectorization hints", "n", &fNoVectorize, "CHPL_DISABLE_VECTORIZATION", setVectorize},
+ {"unroll-and-jam", ' ', "<count>", "Ask LLVM to unroll-and-jam the outer loop of perfectly nested C for loops by <count>", "I", &unroll_and_jam_count, "CHPL_UNROLL_AND_JAM", NULL},
 
  {"auto-local-access", ' ', NULL, "Enable [disable] using local access automatically", "N", &fAutoLocalAccess, "CHPL_DISABLE_AUTO_LOCAL_ACCESS", NULL},
  {"dynamic-auto-local-access", ' ', NULL, "Enable [disable] using local access automatically (dynamic only)", "N", &fDynamicAutoLocalAccess, "CHPL_DISABLE_DYNAMIC_AUTO_LOCAL_ACCESS", NULL},
 
  {"auto-aggregation", ' ', NULL, "Enable [disable] automatically aggregating remote accesses in foralls", "N", &fAutoAggregation, "CHPL_AUTO_AGGREGATION", NULL},
+ {"auto-bulk-copy", ' ', NULL, "Enable [disable] turning array copy foralls into slice assignments", "N", &fAutoBulkCopy, "CHPL_AUTO_BULK_COPY", NULL},
 
  {"", ' ', NULL, "Run-time Semantic Check Options", NULL, NULL, NULL, NULL},
  {"checks", ' ', NULL, "Enable [disable] all following run-time checks", "n", &fNoChecks, "CHPL_NO_CHECKS", setChecks},
@@ -974,6 +1031,7 @@ static ArgumentDescription arg_desc[] = {
  {"local-checks", ' ', NULL, "Enable [disable] local block checking", "n", &fNoLocalChecks, NULL, NULL},
  {"nil-checks", ' ', NULL, "Enable [disable] runtime nil checking", "n", &fNoNilChecks, "CHPL_NO_NIL_CHECKS", NULL},
  {"stack-checks", ' ', NULL, "Enable [disable] stack overflow checking", "n", &fNoStackChecks, "CHPL_STACK_CHECKS", setStackChecks},
+ {"unwind-line-numbers", ' ', NULL, "Find the user line of a run-time error by stack unwinding instead of passing line numbers through library functions", "N", &fUnwindLineNumbers, "CHPL_UNWIND_LINE_NUMBERS", NULL},
 
  {"", ' ', NULL, "C Code Generation Options", NULL, NULL, NULL, NULL},
  {"codegen", ' ', NULL, "[Don't] Do code generation", "n", &no_codegen, "CHPL_NO_CODEGEN", NULL},
@@ -981,10 +1039,12 @@ static ArgumentDescription arg_desc[] = {
  {"max-c-ident-len", ' ', NULL, "Maximum length of identifiers in generated code, 0 for unlimited", "I", &fMaxCIdentLen, "CHPL_MAX_C_IDENT_LEN", NULL},
  {"munge-user-idents", ' ', NULL, "[Don't] Munge user identifiers to avoid naming conflicts with external code", "N", &fMungeUserIdents, "CHPL_MUNGE_USER_IDENTS"},
  {"savec", ' ', "<directory>", "Save generated C code in directory", "P", saveCDir, "CHPL_SAVEC_DIR", verifySaveCDir},
+ {"extern-c-cache-dir", ' ', "<directory>", "Keep precompiled extern blocks and C headers in directory across compiles", "P", fExternCCacheDir, "CHPL_EXTERN_C_CACHE_DIR", NULL},
 
  {"", ' ', NULL, "C Code Compilation Options", NULL, NULL, NULL, NULL},
  {"ccflags", ' ', "<flags>", "Back-end C compiler flags (can be specified multiple times)", "S", NULL, "CHPL_CC_FLAGS", setCCFlags},
  {"debug", 'g', NULL, "[Don't] Support debugging of generated C code", "N", &debugCCode, "CHPL_DEBUG", setChapelDebug},
+ {"debug-line-tables-only", ' ', NULL, "[Don't] Limit debug information to line tables, as for profiling", "N", &fDebugLineTablesOnly, "CHPL_DEBUG_LINE_TABLES_ONLY", setDebugLineTablesOnly},
  {"dynamic", ' ', NULL, "Generate a dynamically linked binary", "F", &fLinkStyle, NULL, setDynamicLink},
  {"hdr-search-path", 'I', "<directory>", "C header search path", "P", incFilename, "CHPL_INCLUDE_PATH", handleIncDir},
  {"ldflags", ' ', "<flags>", "Back-end C linker flags (can be specified multiple times)", "S", NULL, "CHPL_LD_FLAGS", setLDFlags},
@@ -998,15 +1058,23 @@ static ArgumentDescription arg_desc[] = {
  {"", ' ', NULL, "LLVM Code Generation Options", NULL, NULL, NULL, NULL},
  {"llvm", ' ', NULL, "[Don't] use the LLVM code generator", "N", &fYesLlvmCodegen, "CHPL_LLVM_CODEGEN", setLlvmCodegen},
  {"llvm-wide-opt", ' ', NULL, "Enable [disable] LLVM wide pointer optimizations", "N", &fLLVMWideOpt, "CHPL_LLVM_WIDE_OPTS", NULL},
+ {"llvm-prefetch-distance", ' ', "<n>", "With --llvm-wide-opt, prefetch wide loads in loops <n> iterations ahead", "I", &llvm_prefetch_distance, "CHPL_LLVM_PREFETCH_DISTANCE", NULL},
+ {"llvm-codegen-threads", ' ', "<n>", "Split LLVM code generation across n threads, 0 for one per processor", "I", &fLlvmCodegenThreads, "CHPL_LLVM_CODEGEN_THREADS", NULL},
+ {"llvm-runtime-bitcode", ' ', "<file>", "Link the runtime built as LLVM bitcode in <file> into the program so it can be inlined", "P", fLlvmRuntimeBitcode, "CHPL_LLVM_RUNTIME_BITCODE", NULL},
+ {"profile-generate", ' ', "<directory>", "Instrument the generated code to write a profile per locale into <directory>", "P", fProfileGenerate, "CHPL_PROFILE_GENERATE", NULL},
+ {"profile-use", ' ', "<file>", "Optimize using a profile merged with 'llvm-profdata merge'", "P", fProfileUse, "CHPL_PROFILE_USE", NULL},
  {"mllvm", ' ', "<flags>", "LLVM flags (can be specified multiple times)", "S", NULL, "CHPL_MLLVM", setLLVMFlags},
 
  {"", ' ', NULL, "Compilation Trace Options", NULL, NULL, NULL, NULL},
  {"print-commands", ' ', NULL, "[Don't] print system commands", "N", &printSystemCommands, "CHPL_PRINT_COMMANDS", NULL},
  {"print-passes", ' ', NULL, "[Don't] print compiler passes", "N", &printPasses, "CHPL_PRINT_PASSES", NULL},
  {"print-passes-file", ' ', "<filename>", "Print compiler passes to <filename>", "S", NULL, "CHPL_PRINT_PASSES_FILE", setPrintPassesFile},
+ {"profile-compile", ' ', "<filename>", "Write a Chrome trace of compile time, memory and AST size to <filename>", "S", NULL, "CHPL_PROFILE_COMPILE", setProfileCompileFile},
 
  {"", ' ', NULL, "Miscellaneous Options", NULL, NULL, NULL, NULL},
  DRIVER_ARG_DEVELOPER,
+ {"compile-server", ' ', "<socket>", "Parse internal modules once, then serve compiles requested on <socket>", "P", fCompileServer, "CHPL_COMPILE_SERVER", NULL},
+ {"compile-server-connect", ' ', "<socket>", "Have the compile server on <socket> compile the given files", "P", fCompileServerConnect, NULL, NULL},
  {"explain-call", ' ', "<call>[:<module>][:<line>]", "Explain resolution of call", "S256", fExplainCall, NULL, NULL},
  {"explain-instantiation", ' ', "<function|type>[:<module>][:<line>]", "Explain instantiation of type", "S256", fExplainInstantiation, NULL, NULL},
  {"explain-verbose", ' ', NULL, "Enable [disable] tracing of disambiguation with 'explain' options", "N", &fExplainVerbose, "CHPL_EXPLAIN_VERBOSE", NULL},
@@ -1084,12 +1152,14 @@ static ArgumentDescription arg_desc[] = {
  {"report-optimized-loop-iterators", ' ', NULL, "Print stats on optimized single loop iterators", "F", &fReportOptimizedLoopIterators, NULL, NULL},
  {"report-inlined-iterators", ' ', NULL, "Print stats on inlined iterators", "F", &fReportInlinedIterators, NULL, NULL},
  {"report-vectorized-loops", ' ', NULL, "Show which loops have vectorization hints", "F", &fReportVectorizedLoops, NULL, NULL},
- {"report-optimized-on", ' ', NULL, "Print information about on clauses that have been optimized for potential fast remote fork operation", "F", &fReportOptimizedOn, NULL, NULL},
+ {"report-optimized-on", ' ', NULL, "Print information about on clauses that have or have not been optimized for potential fast remote fork operation", "F", &fReportOptimizedOn, NULL, NULL},
  {"report-auto-local-access", ' ', NULL, "Enable compiler logs for auto local access optimization", "N", &fReportAutoLocalAccess, "CHPL_REPORT_AUTO_LOCAL_ACCESS", NULL},
  {"report-auto-aggregation", ' ', NULL, "Enable compiler logs for automatic aggregation", "N", &fReportAutoAggregation, "CHPL_REPORT_AUTO_AGGREGATION", NULL},
  {"report-optimized-forall-unordered-ops", ' ', NULL, "Show which statements in foralls have been converted to unordered operations", "F", &fReportOptimizeForallUnordered, NULL, NULL},
  {"report-promotion", ' ', NULL, "Print information about scalar promotion", "F", &fReportPromotion, NULL, NULL},
  {"report-scalar-replace", ' ', NULL, "Print scalar replacement stats", "F", &fReportScalarReplace, NULL, NULL},
+ {"report-dead-fields", ' ', NULL, "Print fields removed because they are never read", "F", &fReportDeadFields, NULL, NULL},
+ {"report-gpu-kernels", ' ', NULL, "Show which forall loops have been outlined into GPU kernels", "F", &fReportGpuKernels, NULL, NULL},
 
  {"", ' ', NULL, "Developer Flags -- Miscellaneous", NULL, NULL, NULL, NULL},
  {"allow-noinit-array-not-pod", ' ', NULL, "Allow noinit for arrays of records", "N", &fAllowNoinitArrayNotPod, "CHPL_BREAK_ON_CODEGEN", NULL},
@@ -1134,7 +1204,9 @@ static ArgumentDescription arg_desc[] = {
  {"print-id-on-error", ' ', NULL, "[Don't] print AST id in error messages", "N", &fPrintIDonError, "CHPL_PRINT_ID_ON_ERROR", NULL},
  {"print-unused-internal-functions", ' ', NULL, "[Don't] print names and locations of unused internal functions", "N", &fPrintUnusedInternalFns, NULL, NULL},
  {"region-vectorizer", ' ', NULL, "Enable [disable] region vectorizer", "N", &fRegionVectorizer, NULL, NULL},
+ {"remove-dead-fields", ' ', NULL, "Enable [disable] removal of fields that are never read", "n", &fNoRemoveDeadFields, "CHPL_DISABLE_REMOVE_DEAD_FIELDS", NULL},
  {"remove-empty-records", ' ', NULL, "Enable [disable] empty record removal", "n", &fNoRemoveEmptyRecords, "CHPL_DISABLE_REMOVE_EMPTY_RECORDS", NULL},
+ {"reorder-fields", ' ', NULL, "Enable [disable] laying out fields of compiler-generated types by alignment", "n", &fNoReorderFields, "CHPL_DISABLE_REORDER_FIELDS", NULL},
  {"remove-unreachable-blocks", ' ', NULL, "[Don't] remove unreachable blocks after resolution", "N", &fRemoveUnreachableBlocks, "CHPL_REMOVE_UNREACHABLE_BLOCKS", NULL},
  {"replace-array-accesses-with-ref-temps", ' ', NULL, "Enable [disable] replacing array accesses with reference temps (experimental)", "N", &fReplaceArrayAccessesWithRefTemps, NULL, NULL },
  {"incremental", ' ', NULL, "Enable [disable] using incremental compilation", "N", &fIncrementalCompilation, "CHPL_INCREMENTAL_COMP", NULL},
@@ -1143,6 +1215,7 @@ static ArgumentDescription arg_desc[] = {
  {"print-additional-errors", ' ', NULL, "Print additional errors", "F", &fPrintAdditionalErrors, NULL,NULL},
  {"stop-after-pass", ' ', "<passname>", "Stop compilation after reaching this pass", "S128", &stopAfterPass, "CHPL_STOP_AFTER_PASS", NULL},
  {"force-vectorize", ' ', NULL, "Ignore vectorization hazards when vectorizing loops", "N", &fForceVectorize, NULL, NULL},
+ {"vector-tuples", ' ', NULL, "[Don't] represent numeric homogeneous tuples of SIMD width as LLVM vectors", "N", &fVectorTuples, "CHPL_VECTOR_TUPLES", NULL},
  {"warn-const-loops", ' ', NULL, "Enable [disable] warnings for some 'while' loops with constant conditions", "N", &fWarnConstLoops, "CHPL_WARN_CONST_LOOPS", NULL},
  {"warn-domain-literal", ' ', NULL, "Enable [disable] old domain literal syntax warnings", "n", &fNoWarnDomainLiteral, "CHPL_WARN_DOMAIN_LITERAL", setWarnDomainLiteral},
  {"warn-tuple-iteration", ' ', NULL, "Enable [disable] warnings for tuple iteration", "n", &fNoWarnTupleIteration, "CHPL_WARN_TUPLE_ITERATION", setWarnTupleIteration},
@@ -1225,7 +1298,10 @@ static void printStuff(const char* argv0) {
     clean_exit(status);
   }
 
-  if (fPrintHelp || (!printedSomething && sArgState.nfile_arguments < 1)) {
+  bool needFiles = (fCompileServer[0] == '\0');
+
+  if (fPrintHelp ||
+      (!printedSomething && needFiles && sArgState.nfile_arguments < 1)) {
     if (printedSomething) printf("\n");
 
     usage(&sArgState, !fPrintHelp, fPrintEnvHelp, fPrintSettingsHelp);
@@ -1507,6 +1583,31 @@ static void checkLLVMCodeGen() {
   if (fLlvmCodegen)
     USR_FATAL("This compiler was built without LLVM support");
 #endif
+
+  if ((fProfileGenerate[0] || fProfileUse[0]) && !fLlvmCodegen)
+    USR_FATAL("--profile-generate and --profile-use require --llvm");
+
+  if (fLlvmRuntimeBitcode[0] && !fLlvmCodegen)
+    USR_FATAL("--llvm-runtime-bitcode requires --llvm");
+
+  if (fProfileGenerate[0] && fProfileUse[0])
+    USR_FATAL("--profile-generate and --profile-use can't be used together");
+}
+
+static void checkUnwindLineNumbers() {
+  if (fUnwindLineNumbers == false)
+    return;
+
+  if (strcmp(CHPL_UNWIND, "none") == 0)
+    USR_FATAL("--unwind-line-numbers requires CHPL_UNWIND other than 'none'");
+
+  // The line of each frame comes from the binary's debug line table.
+  if (debugCCode == false) {
+    if (ccflags.length() > 0)
+      ccflags += ' ';
+
+    ccflags += "-g";
+  }
 }
 
 static void checkTargetCpu() {
@@ -1584,6 +1685,8 @@ static void postprocess_args() {
 
   checkLLVMCodeGen();
 
+  checkUnwindLineNumbers();
+
   checkTargetCpu();
 
   checkIncrementalAndOptimized();
@@ -1627,6 +1730,12 @@ int main(int argc, char* argv[]) {
 
     process_args(&sArgState, argc, argv);
 
+    if (fCompileServerConnect[0] != '\0') {
+      clean_exit(compileServerRequest(fCompileServerConnect,
+                                      sArgState.nfile_arguments,
+                                      sArgState.file_argument));
+    }
+
     setupChplGlobals(argv[0]);
 
     postprocess_args();
@@ -1646,7 +1755,10 @@ int main(int argc, char* argv[]) {
   if (fRunlldb)
     runCompilerInLLDB(argc, argv);
 
-  addSourceFiles(sArgState.nfile_arguments, sArgState.file_argument);
+  // A compile server gets its source files from each request.
+  if (fCompileServer[0] == '\0') {
+    addSourceFiles(sArgState.nfile_arguments, sArgState.file_argument);
+  }
 
   runPasses(tracker, fDocs);
 
@@ -1666,6 +1778,8 @@ int main(int argc, char* argv[]) {
     fclose(printPassesFile);
   }
 
+  compileProfileClose();
+
   clean_exit(0);
 
   return 0;
@@ -21,6 +21,7 @@
 #include "runpasses.h"
 
 #include "checks.h"
+#include "compileProfile.h"
 #include "driver.h"
 #include "log.h"
 #include "parser.h"
@@ -70,6 +71,7 @@ struct PassInfo {
 #define LOG_refPropagation                     LOG_NO_SHORT
 #define LOG_copyPropagation                    LOG_NO_SHORT
 #define LOG_deadCodeElimination                LOG_NO_SHORT
+#define LOG_removeDeadFields                   LOG_NO_SHORT
 #define LOG_removeEmptyRecords                 LOG_NO_SHORT
 #define LOG_localizeGlobals                    LOG_NO_SHORT
 #define LOG_loopInvariantCodeMotion            LOG_NO_SHORT
@@ -77,6 +79,7 @@ struct PassInfo {
 #define LOG_returnStarTuplesByRefArgs          LOG_NO_SHORT
 #define LOG_insertWideReferences               LOG_NO_SHORT
 #define LOG_optimizeOnClauses                  LOG_NO_SHORT
+#define LOG_outlineGpuKernels                  LOG_NO_SHORT
 #define LOG_addInitCalls                       LOG_NO_SHORT
 #define LOG_insertLineNumbers                  LOG_NO_SHORT
 #define LOG_denormalize                        LOG_NO_SHORT
@@ -137,6 +140,7 @@ static PassInfo sPassList[] = {
   RUN(refPropagation),          // reference propagation
   RUN(copyPropagation),         // copy propagation
   RUN(deadCodeElimination),     // eliminate dead code
+  RUN(removeDeadFields),        // remove fields that are never read
   RUN(removeEmptyRecords),      // remove empty records
   RUN(localizeGlobals),         // pull out global constants from loop runs
   RUN(loopInvariantCodeMotion), // move loop invariant code above loop runs
@@ -146,6 +150,7 @@ static PassInfo sPassList[] = {
 
   RUN(insertWideReferences),    // inserts wide references for on clauses
   RUN(optimizeOnClauses),       // Optimize on clauses
+  RUN(outlineGpuKernels),       // outline forall loop bodies into GPU kernels
   RUN(addInitCalls),            // Add module init calls and guards.
 
   // AST to C or LLVM
@@ -196,6 +201,8 @@ void runPasses(PhaseTracker& tracker, bool isChpldoc) {
 static void runPass(PhaseTracker& tracker, size_t passIndex, bool isChpldoc) {
   PassInfo* info = &sPassList[passIndex];
 
+  CompileProfileEvent profileEvent("pass", info->name, nullptr, true);
+
   //
   // The primary work for this pass
   //
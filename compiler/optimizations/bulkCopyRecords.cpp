@@ -21,12 +21,17 @@
 // bulkCopyRecords.cpp
 //
 // Look for record assignment functions that can be replaced by an assign
-// primitive.
+// primitive, and for loops copying arrays of such records that can be
+// replaced by a single bulk copy.
 //
 #include "passes.h" // For global declaration of the main routine.
+#include "optimizations.h"
 
 #include "stmt.h"
 #include "astutil.h"
+#include "CForLoop.h"
+#include "codegen.h" // localeUsesGPU
+#include "driver.h"
 #include "stlUtil.h"
 #include "resolution.h" // isPOD
 
@@ -140,3 +145,478 @@ void bulkCopyRecords()
 
   containsRef.clear();
 }
+
+
+/************************************* | **************************************
+*                                                                             *
+* Bulk copies of arrays of POD records                                        *
+*                                                                             *
+* Once the assignment above is inlined, copying an array of simple records    *
+* (whole-array or slice assignment, or a user loop) leaves C for loops like   *
+*                                                                             *
+*   for (i = lo, j = lo2; i <= hi; i += 1, j += 1) {                          *
+*     dst = &dstData[i + dOff];                                               *
+*     src = &srcData[j + sOff];                                               *
+*     *dst = *src;                                                            *
+*   }                                                                         *
+*                                                                             *
+* with one PRIM_ASSIGN, and possibly one remote get or put, per element.      *
+* When the body does nothing but compute the two element addresses and copy   *
+* one to the other, replace the loop by                                       *
+*                                                                             *
+*   if (the addresses advance by one element per iteration &&                 *
+*       the copy is nonempty && a forward copy is the same as a memmove) {    *
+*     if (dst is local)      chpl_comm_array_get(dst, node(src), src, n);     *
+*     else if (src is local) chpl_comm_array_put(src, node(dst), dst, n);     *
+*   }                                                                         *
+*   if (that didn't happen) <the original loop>                               *
+*                                                                             *
+* chpl_gen_comm_get/put turn into a memmove when both sides are local.        *
+*                                                                             *
+************************************** | *************************************/
+
+static bool isLoopHeaderStmt(Expr* expr, CForLoop* loop) {
+  return expr->parentExpr == loop->initBlockGet() ||
+         expr->parentExpr == loop->incrBlockGet();
+}
+
+// Find the induction variables: 'v = lo' in the init clause and 'v += step'
+// in the increment clause, with nothing else in either clause, no other
+// definitions, and no uses after the loop.
+static bool findInductionVars(FnSymbol* fn, CForLoop* loop,
+                              std::map<Symbol*, Symbol*>& lo,
+                              std::map<Symbol*, Symbol*>& step) {
+  for_alist(expr, loop->incrBlockGet()->body) {
+    CallExpr* call = toCallExpr(expr);
+    if (call == NULL || !call->isPrimitive(PRIM_ADD_ASSIGN) ||
+        !isSymExpr(call->get(1)) || !isSymExpr(call->get(2))) {
+      return false;
+    }
+    step[toSymExpr(call->get(1))->symbol()] = toSymExpr(call->get(2))->symbol();
+  }
+
+  for_alist(expr, loop->initBlockGet()->body) {
+    CallExpr* call = toCallExpr(expr);
+    if (call == NULL || !call->isPrimitive(PRIM_ASSIGN) ||
+        !isSymExpr(call->get(1)) || !isSymExpr(call->get(2))) {
+      return false;
+    }
+    Symbol* var = toSymExpr(call->get(1))->symbol();
+    if (step.count(var) == 0 || lo.count(var) != 0) {
+      return false;
+    }
+    lo[var] = toSymExpr(call->get(2))->symbol();
+  }
+
+  if (step.size() == 0 || lo.size() != step.size()) {
+    return false;
+  }
+
+  for (std::map<Symbol*, Symbol*>::iterator it = step.begin();
+       it != step.end(); ++it) {
+    Symbol* var = it->first;
+
+    if (!isVarSymbol(var) || var->isRef() || !is_int_type(var->type) ||
+        lo[var]->type != var->type || it->second->type != var->type ||
+        !isInvariantInLoop(lo[var], fn, loop) ||
+        !isInvariantInLoop(it->second, fn, loop)) {
+      return false;
+    }
+
+    for_SymbolSymExprs(se, var) {
+      if (!loop->contains(se)) {
+        return false;
+      }
+    }
+
+    for_SymbolDefs(def, var) {
+      if (!isLoopHeaderStmt(def->getStmtExpr(), loop)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+static bool isLoopVariant(Symbol* sym,
+                          std::map<Symbol*, CallExpr*>& defOf,
+                          std::map<Symbol*, Symbol*>& step) {
+  return step.count(sym) != 0 || defOf.count(sym) != 0;
+}
+
+// Can the value of 'expr' be computed before the loop, given values for
+// the induction variables and for the body temps in 'defOf'? Only address
+// arithmetic is allowed: no loads, stores or calls. It must also be affine
+// in the induction variables, since bulkCopyLoop() checks for unit stride
+// by looking at just the first two iterations.
+static bool isIndexArithmetic(Expr* expr,
+                              std::map<Symbol*, CallExpr*>& defOf,
+                              std::map<Symbol*, Symbol*>& step,
+                              FnSymbol* fn, CForLoop* loop) {
+  if (SymExpr* se = toSymExpr(expr)) {
+    Symbol* sym = se->symbol();
+    if (sym->isRef()) {
+      return false;
+    }
+    return isLoopVariant(sym, defOf, step) ||
+           isInvariantInLoop(sym, fn, loop);
+  }
+
+  CallExpr* call = toCallExpr(expr);
+  if (call == NULL) {
+    return false;
+  }
+
+  int firstValue = 1;
+  if (call->isPrimitive(PRIM_CAST)) {
+    // narrowing casts could wrap
+    SymExpr* type = toSymExpr(call->get(1));
+    if (type == NULL || (type->symbol()->type != dtInt[INT_SIZE_64] &&
+                         type->symbol()->type != dtUInt[INT_SIZE_64])) {
+      return false;
+    }
+    firstValue = 2;
+  } else if (call->isPrimitive(PRIM_ARRAY_GET)) {
+    SymExpr* data = toSymExpr(call->get(1));
+    if (data == NULL ||
+        !data->symbol()->type->symbol->hasFlag(FLAG_DATA_CLASS) ||
+        !isInvariantInLoop(data->symbol(), fn, loop)) {
+      return false;
+    }
+    firstValue = 2;
+  } else if (call->isPrimitive(PRIM_MULT)) {
+    // i*k is affine, i*i and i*j are not
+    SymExpr* a = toSymExpr(call->get(1));
+    SymExpr* b = toSymExpr(call->get(2));
+    if (a != NULL && b != NULL &&
+        isLoopVariant(a->symbol(), defOf, step) &&
+        isLoopVariant(b->symbol(), defOf, step)) {
+      return false;
+    }
+  } else if (!call->isPrimitive(PRIM_ADD) &&
+             !call->isPrimitive(PRIM_SUBTRACT)) {
+    return false;
+  }
+
+  for (int i = firstValue; i <= call->numActuals(); i++) {
+    SymExpr* se = toSymExpr(call->get(i));
+    if (se == NULL || !isIndexArithmetic(se, defOf, step, fn, loop)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Follow copies of the reference 'sym' back to the PRIM_ARRAY_GET it
+// came from.
+static Symbol* findElementRef(Symbol* sym,
+                              std::map<Symbol*, CallExpr*>& defOf) {
+  while (sym != NULL && defOf.count(sym) != 0) {
+    Expr* rhs = defOf[sym]->get(2);
+    if (CallExpr* call = toCallExpr(rhs)) {
+      return call->isPrimitive(PRIM_ARRAY_GET) ? sym : NULL;
+    }
+    sym = toSymExpr(rhs)->symbol();
+  }
+  return NULL;
+}
+
+static Symbol* mapped(SymbolMap& map, Symbol* sym) {
+  Symbol* ret = map.get(sym);
+  return ret != NULL ? ret : sym;
+}
+
+static Symbol* insertTempBefore(Expr* anchor, const char* name, Type* type,
+                                Expr* value) {
+  VarSymbol* tmp = newTemp(name, type);
+  anchor->insertBefore(new DefExpr(tmp));
+  anchor->insertBefore(new CallExpr(PRIM_MOVE, tmp, value));
+  return tmp;
+}
+
+static bool bulkCopyLoop(FnSymbol* fn, CForLoop* loop) {
+  if (loop->initBlockGet() == NULL || loop->testBlockGet() == NULL ||
+      loop->incrBlockGet() == NULL) {
+    return false;
+  }
+
+  std::map<Symbol*, Symbol*> lo;
+  std::map<Symbol*, Symbol*> step;
+
+  if (!findInductionVars(fn, loop, lo, step)) {
+    return false;
+  }
+
+  // The test must be 'i <= hi' for one of them.
+  BlockStmt* testBlock = loop->testBlockGet();
+  CallExpr*  test      = NULL;
+
+  if (testBlock->body.length == 1) {
+    test = toCallExpr(testBlock->body.head);
+  }
+
+  if (test == NULL || !test->isPrimitive(PRIM_LESSOREQUAL) ||
+      !isSymExpr(test->get(1)) || !isSymExpr(test->get(2))) {
+    return false;
+  }
+
+  Symbol* index = toSymExpr(test->get(1))->symbol();
+  Symbol* hi    = toSymExpr(test->get(2))->symbol();
+
+  if (step.count(index) == 0 || index->type != dtInt[INT_SIZE_DEFAULT] ||
+      hi->type != index->type || !isInvariantInLoop(hi, fn, loop)) {
+    return false;
+  }
+
+  // The body may only compute addresses and make one record assignment.
+  std::map<Symbol*, CallExpr*> defOf;
+  CallExpr* assign = NULL;
+
+  for_alist(expr, loop->body) {
+    if (DefExpr* def = toDefExpr(expr)) {
+      if (!isVarSymbol(def->sym) && def->sym != loop->continueLabelGet()) {
+        return false;
+      }
+      continue;
+    }
+
+    CallExpr* call = toCallExpr(expr);
+    if (call == NULL) {
+      return false;
+    }
+
+    if (call->isPrimitive(PRIM_ASSIGN) && assign == NULL &&
+        isSymExpr(call->get(1)) && isSymExpr(call->get(2))) {
+      assign = call;
+      continue;
+    }
+
+    if (!call->isPrimitive(PRIM_MOVE) || !isSymExpr(call->get(1))) {
+      return false;
+    }
+
+    Symbol* lhs = toSymExpr(call->get(1))->symbol();
+    Expr*   rhs = call->get(2);
+
+    if (lhs->defPoint->parentExpr != loop || defOf.count(lhs) != 0) {
+      return false;
+    }
+
+    if (lhs->isRef()) {
+      // references may only be element addresses or copies of them
+      SymExpr* rhsSe = toSymExpr(rhs);
+      if (rhsSe != NULL) {
+        if (defOf.count(rhsSe->symbol()) == 0 || !rhsSe->symbol()->isRef()) {
+          return false;
+        }
+      } else if (!isCallExpr(rhs) ||
+                 !toCallExpr(rhs)->isPrimitive(PRIM_ARRAY_GET) ||
+                 !isIndexArithmetic(rhs, defOf, step, fn, loop)) {
+        return false;
+      }
+    } else if (toCallExpr(rhs) != NULL &&
+               toCallExpr(rhs)->isPrimitive(PRIM_ARRAY_GET)) {
+      return false;
+    } else if (!isIndexArithmetic(rhs, defOf, step, fn, loop)) {
+      return false;
+    }
+
+    defOf[lhs] = call;
+  }
+
+  if (assign == NULL) {
+    return false;
+  }
+
+  Symbol* dst = findElementRef(toSymExpr(assign->get(1))->symbol(), defOf);
+  Symbol* src = findElementRef(toSymExpr(assign->get(2))->symbol(), defOf);
+
+  if (dst == NULL || src == NULL ||
+      !dst->isRef() || !src->isRef() ||
+      dst->getValType() != src->getValType()) {
+    return false;
+  }
+
+  Type* eltType = dst->getValType();
+
+  if (!isRecord(eltType) || isRecordWrappedType(eltType) ||
+      !isPOD(eltType) || typeContainsRef(eltType)) {
+    return false;
+  }
+
+  Symbol* dstOff = toSymExpr(toCallExpr(defOf[dst]->get(2))->get(2))->symbol();
+  Symbol* srcOff = toSymExpr(toCallExpr(defOf[src]->get(2))->get(2))->symbol();
+
+  if (dstOff->type != index->type || srcOff->type != index->type) {
+    return false;
+  }
+
+  //
+  // Compute the body's temps for the first two iterations before the loop.
+  //
+  SET_LINENO(loop);
+
+  SymbolMap first;
+  SymbolMap second;
+
+  for (std::map<Symbol*, Symbol*>::iterator it = step.begin();
+       it != step.end(); ++it) {
+    Symbol* var = it->first;
+    first.put(var, lo[var]);
+    second.put(var, insertTempBefore(loop, "bulk_next", var->type,
+                                     new CallExpr(PRIM_ADD, lo[var],
+                                                  it->second)));
+  }
+
+  for_alist(expr, loop->body) {
+    if (DefExpr* def = toDefExpr(expr)) {
+      if (def->sym == loop->continueLabelGet()) {
+        continue;
+      }
+    }
+    if (expr != assign) {
+      loop->insertBefore(expr->copy(&first));
+      loop->insertBefore(expr->copy(&second));
+    }
+  }
+
+  Type*   idxType  = index->type;
+  Symbol* one      = new_IntSymbol(1);
+
+  Symbol* dst1 = mapped(first, dstOff);
+  Symbol* src1 = mapped(first, srcOff);
+
+  Symbol* dstStride = insertTempBefore(loop, "bulk_dst_stride", idxType,
+                        new CallExpr(PRIM_SUBTRACT, mapped(second, dstOff),
+                                     dst1));
+  Symbol* srcStride = insertTempBefore(loop, "bulk_src_stride", idxType,
+                        new CallExpr(PRIM_SUBTRACT, mapped(second, srcOff),
+                                     src1));
+  Symbol* len = insertTempBefore(loop, "bulk_len", idxType,
+                  new CallExpr(PRIM_ADD,
+                               new CallExpr(PRIM_SUBTRACT, hi, lo[index]),
+                               one));
+
+  Symbol* canCopy = insertTempBefore(loop, "bulk_can_copy", dtBool,
+    new CallExpr(PRIM_AND,
+      new CallExpr(PRIM_AND,
+                   new CallExpr(PRIM_EQUAL, step[index], one),
+                   new CallExpr(PRIM_LESSOREQUAL, lo[index], hi)),
+      new CallExpr(PRIM_AND,
+                   new CallExpr(PRIM_EQUAL, dstStride, one),
+                   new CallExpr(PRIM_EQUAL, srcStride, one))));
+
+  Symbol* copied = insertTempBefore(loop, "bulk_copied", dtBool,
+                                    new SymExpr(gFalse));
+
+  //
+  // Copy from whichever side is local.
+  //
+  BlockStmt* bulkBlock = new BlockStmt();
+  BlockStmt* getBlock  = new BlockStmt();
+  BlockStmt* putBlock  = new BlockStmt();
+  Symbol*    dstElt    = first.get(dst);
+  Symbol*    srcElt    = first.get(src);
+
+  VarSymbol* dstNode = newTemp("bulk_dst_node", NODE_ID_TYPE);
+  VarSymbol* srcNode = newTemp("bulk_src_node", NODE_ID_TYPE);
+
+  bulkBlock->insertAtTail(new DefExpr(dstNode));
+  bulkBlock->insertAtTail(new CallExpr(PRIM_MOVE, dstNode,
+                            new CallExpr(PRIM_WIDE_GET_NODE, dstElt)));
+  bulkBlock->insertAtTail(new DefExpr(srcNode));
+  bulkBlock->insertAtTail(new CallExpr(PRIM_MOVE, srcNode,
+                            new CallExpr(PRIM_WIDE_GET_NODE, srcElt)));
+
+  // A forward copy differs from a memmove only if dst starts inside src.
+  // The two can only overlap if they are on the same node, and then
+  // their addresses are comparable even if their data pointers differ.
+  CallExpr*  srcGet    = toCallExpr(defOf[src]->get(2));
+  Symbol*    srcData   = toSymExpr(srcGet->get(1))->symbol();
+  Symbol*    srcEndIdx = newTemp("bulk_src_end_idx", idxType);
+  Symbol*    srcEnd    = newTemp("bulk_src_end", src->type);
+  Symbol*    dstAddr   = newTemp("bulk_dst_addr", dtCVoidPtr);
+  Symbol*    srcAddr   = newTemp("bulk_src_addr", dtCVoidPtr);
+  Symbol*    endAddr   = newTemp("bulk_src_end_addr", dtCVoidPtr);
+  Symbol*    safe      = newTemp("bulk_safe", dtBool);
+  BlockStmt* copyBlock = new BlockStmt();
+
+  bulkBlock->insertAtTail(new DefExpr(srcEndIdx));
+  bulkBlock->insertAtTail(new CallExpr(PRIM_MOVE, srcEndIdx,
+                            new CallExpr(PRIM_ADD, src1, len)));
+  bulkBlock->insertAtTail(new DefExpr(srcEnd));
+  bulkBlock->insertAtTail(new CallExpr(PRIM_MOVE, srcEnd,
+                            new CallExpr(PRIM_ARRAY_GET, srcData, srcEndIdx)));
+  bulkBlock->insertAtTail(new DefExpr(dstAddr));
+  bulkBlock->insertAtTail(new CallExpr(PRIM_MOVE, dstAddr,
+                            new CallExpr(PRIM_WIDE_GET_ADDR, dstElt)));
+  bulkBlock->insertAtTail(new DefExpr(srcAddr));
+  bulkBlock->insertAtTail(new CallExpr(PRIM_MOVE, srcAddr,
+                            new CallExpr(PRIM_WIDE_GET_ADDR, srcElt)));
+  bulkBlock->insertAtTail(new DefExpr(endAddr));
+  bulkBlock->insertAtTail(new CallExpr(PRIM_MOVE, endAddr,
+                            new CallExpr(PRIM_WIDE_GET_ADDR, srcEnd)));
+  bulkBlock->insertAtTail(new DefExpr(safe));
+  bulkBlock->insertAtTail(new CallExpr(PRIM_MOVE, safe,
+    new CallExpr(PRIM_OR,
+                 new CallExpr(PRIM_NOTEQUAL, dstNode, srcNode),
+                 new CallExpr(PRIM_OR,
+                              new CallExpr(PRIM_LESSOREQUAL, dstAddr, srcAddr),
+                              new CallExpr(PRIM_LESSOREQUAL, endAddr,
+                                           dstAddr)))));
+
+  getBlock->insertAtTail(new CallExpr(PRIM_CHPL_COMM_ARRAY_GET,
+                                      dstElt, srcNode, srcElt, len));
+  getBlock->insertAtTail(new CallExpr(PRIM_MOVE, copied, gTrue));
+
+  putBlock->insertAtTail(new CallExpr(PRIM_CHPL_COMM_ARRAY_PUT,
+                                      srcElt, dstNode, dstElt, len));
+  putBlock->insertAtTail(new CallExpr(PRIM_MOVE, copied, gTrue));
+
+  copyBlock->insertAtTail(new CondStmt(
+    new CallExpr(PRIM_EQUAL, dstNode, gNodeID),
+    getBlock,
+    new CondStmt(new CallExpr(PRIM_EQUAL, srcNode, gNodeID), putBlock)));
+
+  bulkBlock->insertAtTail(new CondStmt(new SymExpr(safe), copyBlock));
+
+  loop->insertBefore(new CondStmt(new SymExpr(canCopy), bulkBlock));
+
+  // Otherwise copy element by element as before.
+  BlockStmt* loopBlock = new BlockStmt();
+  loop->insertBefore(new CondStmt(new SymExpr(copied), new BlockStmt(),
+                                  loopBlock));
+  loopBlock->insertAtTail(loop->remove());
+
+  return true;
+}
+
+void bulkCopyRecordLoops()
+{
+  if (fNoBulkCopyRecords)
+    return;
+
+  std::vector<CForLoop*> loops;
+
+  forv_Vec(BlockStmt, block, gBlockStmts) {
+    if (CForLoop* loop = toCForLoop(block)) {
+      if (loop->inTree()) {
+        loops.push_back(loop);
+      }
+    }
+  }
+
+  for_vector(CForLoop, loop, loops) {
+    // Leave loops the GPU outliner could turn into kernels alone.
+    if (localeUsesGPU() && loop->isOrderIndependent())
+      continue;
+
+    if (FnSymbol* fn = toFnSymbol(loop->parentSymbol)) {
+      bulkCopyLoop(fn, loop);
+    }
+  }
+
+  containsRef.clear();
+}
@@ -58,6 +58,7 @@ enum CallRejectReason {
   CRR_ACCEPT,
   CRR_NOT_ARRAY_ACCESS_LIKE,
   CRR_NO_CLEAN_INDEX_MATCH,
+  CRR_INDEX_HAS_OFFSET,
   CRR_ACCESS_BASE_IS_LOOP_INDEX,
   CRR_ACCESS_BASE_IS_NOT_OUTER_VAR,
   CRR_ACCESS_BASE_IS_SHADOW_VAR,
@@ -75,6 +76,8 @@ std::set<astlocT> primMaybeAggregateAssignLocations;
 
 
 static bool callHasSymArguments(CallExpr *ce, const std::vector<Symbol *> &syms);
+static bool callHasOffsetSymArguments(CallExpr *ce,
+                                      const std::vector<Symbol *> &syms);
 static Symbol *getDotDomBaseSym(Expr *expr);
 static Expr *getDomExprFromTypeExprOrQuery(Expr *e);
 static Symbol *getDomSym(Symbol *arrSym);
@@ -125,6 +128,7 @@ static void symbolicFastFollowerAnalysis(ForallStmt *forall);
 static const char *getForallCloneTypeStr(Symbol *aggMarker);
 static CallExpr *getAggGenCallForChild(Expr *child, bool srcAggregation);
 static bool assignmentSuitableForAggregation(CallExpr *call, ForallStmt *forall);
+static bool isRemoteCompoundAssignment(CallExpr *call, ForallStmt *forall);
 static void insertAggCandidate(CallExpr *call, ForallStmt *forall);
 static bool handleYieldedArrayElementsInAssignment(CallExpr *call,
                                                    ForallStmt *forall);
@@ -134,13 +138,19 @@ static void removeAggregatorFromMaybeAggAssign(CallExpr *call, int argIndex);
 static void removeAggregatorFromFunction(Symbol *aggregator, FnSymbol *parent);
 static void removeAggregationFromRecursiveForallHelp(BlockStmt *block);
 static void autoAggregation(ForallStmt *forall);
+static void autoBulkCopy(ForallStmt *forall);
 
 void doPreNormalizeArrayOptimizations() {
   const bool anyAnalysisNeeded = fAutoLocalAccess ||
                                  fAutoAggregation ||
+                                 fAutoBulkCopy ||
                                  !fNoFastFollowers;
   if (anyAnalysisNeeded) {
     forv_Vec(ForallStmt, forall, gForallStmts) {
+      if (fAutoBulkCopy) {
+        autoBulkCopy(forall);
+      }
+
       if (!fNoFastFollowers) {
         symbolicFastFollowerAnalysis(forall);
       }
@@ -156,6 +166,122 @@ void doPreNormalizeArrayOptimizations() {
   }
 }
 
+// Can `expr`, the iterand of a forall, be evaluated again without side
+// effects? We accept `D`, `A.domain` and `lo..hi` with symbols as bounds.
+static bool isDuplicableIterand(Expr *expr) {
+  if (isSymExpr(expr)) {
+    return true;
+  }
+  if (getDotDomBaseSym(expr) != NULL) {
+    return true;
+  }
+  if (CallExpr *call = toCallExpr(expr)) {
+    if (call->isNamed("chpl_build_bounded_range")) {
+      for_actuals(actual, call) {
+        if (!isSymExpr(actual)) {
+          return false;
+        }
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+// If `stmt` is `A[idx] = B[idx]`, return `A` and `B`
+static bool isCopyOfIndex(Expr *stmt, Symbol *idx,
+                          Symbol *&lhsBase, Symbol *&rhsBase) {
+  CallExpr *assign = toCallExpr(stmt);
+  if (assign == NULL || !assign->isNamedAstr(astrSassign) ||
+      assign->numActuals() != 2) {
+    return false;
+  }
+
+  Symbol *bases[2] = { NULL, NULL };
+  for (int i = 0 ; i < 2 ; i++) {
+    CallExpr *access = toCallExpr(assign->get(i+1));
+    if (access == NULL || access->numActuals() != 1) return false;
+
+    SymExpr *baseSE = toSymExpr(access->baseExpr);
+    SymExpr *argSE = toSymExpr(access->get(1));
+    if (baseSE == NULL || argSE == NULL || argSE->symbol() != idx ||
+        baseSE->symbol() == idx) {
+      return false;
+    }
+    bases[i] = baseSE->symbol();
+  }
+
+  lhsBase = bases[0];
+  rhsBase = bases[1];
+  return true;
+}
+
+// Turn
+//
+//   forall i in D do A[i] = B[i];
+//
+// in user code into
+//
+//   param isBulkCopy = isArray(A) && isArray(B) &&
+//                      (isDomain(D) || isBoundedRange(D));
+//   if isBulkCopy then A[D] = B[D]; else forall i in D do A[i] = B[i];
+//
+// so that arrays are copied with slice assignment, which uses bulk transfer
+// where the arrays' distributions support it, rather than one possibly remote
+// access per element.
+static void autoBulkCopy(ForallStmt *forall) {
+  if (forall->getModule()->modTag != MOD_USER ||
+      forall->zippered() ||
+      forall->numInductionVars() != 1 ||
+      forall->numIteratedExprs() != 1 ||
+      forall->numShadowVars() != 0 ||
+      forall->isForallExpr() ||
+      forall->fromReduce() ||
+      forall->createdFromForLoop() ||
+      forall->loopBody()->body.length != 1) {
+    return;
+  }
+
+  Symbol *idx = forall->firstInductionVarDef()->sym;
+  Expr *iterand = forall->firstIteratedExpr();
+  Symbol *lhsBase = NULL;
+  Symbol *rhsBase = NULL;
+
+  if (!isDuplicableIterand(iterand) ||
+      !isCopyOfIndex(forall->loopBody()->body.head, idx, lhsBase, rhsBase)) {
+    return;
+  }
+
+  SET_LINENO(forall);
+
+  VarSymbol *isBulkCopy = newTemp("isBulkCopy");
+  isBulkCopy->addFlag(FLAG_MAYBE_PARAM);
+
+  CallExpr *isRngDom = new CallExpr("||",
+                                    new CallExpr("isDomain", iterand->copy()),
+                                    new CallExpr("isBoundedRange",
+                                                 iterand->copy()));
+  CallExpr *check = new CallExpr("&&",
+                                 new CallExpr("isArray", lhsBase),
+                                 new CallExpr("&&",
+                                              new CallExpr("isArray", rhsBase),
+                                              isRngDom));
+
+  BlockStmt *bulkBlock = new BlockStmt();
+  bulkBlock->insertAtTail(new CallExpr(astrSassign,
+                                       new CallExpr(lhsBase, iterand->copy()),
+                                       new CallExpr(rhsBase, iterand->copy())));
+
+  BlockStmt *loopBlock = new BlockStmt();
+
+  forall->insertBefore(new DefExpr(isBulkCopy));
+  forall->insertBefore(new CallExpr(PRIM_MOVE, isBulkCopy, check));
+  forall->insertBefore(new CondStmt(new SymExpr(isBulkCopy), bulkBlock,
+                                    loopBlock));
+
+  loopBlock->insertAtTail(forall->remove());
+}
+
 Expr *preFoldMaybeLocalArrElem(CallExpr *call) {
 
   // This primitive is created with 4 arguments:
@@ -613,6 +739,61 @@ static bool callHasSymArguments(CallExpr *ce, const std::vector<Symbol *> &syms)
   return true;
 }
 
+static bool isIntImmediate(Expr *expr) {
+  if (SymExpr *se = toSymExpr(expr)) {
+    if (VarSymbol *var = toVarSymbol(se->symbol())) {
+      return var->immediate != NULL &&
+             (var->immediate->const_kind == NUM_KIND_INT ||
+              var->immediate->const_kind == NUM_KIND_UINT);
+    }
+  }
+  return false;
+}
+
+// like callHasSymArguments, but true only if at least one argument is `sym+c`,
+// `sym-c` or `c+sym` for an integer literal `c`, as in stencils. Such accesses
+// can leave the local subdomain, so we don't optimize them; this is used for
+// reporting.
+static bool callHasOffsetSymArguments(CallExpr *ce,
+                                      const std::vector<Symbol *> &syms) {
+  bool hasOffset = false;
+
+  if (((std::size_t)ce->argList.length) != syms.size()) return false;
+  for (int i = 0 ; i < ce->argList.length ; i++) {
+    Expr *arg = ce->get(i+1);
+    if (SymExpr *argSE = toSymExpr(arg)) {
+      if (argSE->symbol() != syms[i]) {
+        return false;
+      }
+    }
+    else if (CallExpr *argCall = toCallExpr(arg)) {
+      if (argCall->numActuals() != 2) return false;
+
+      SymExpr *lhs = toSymExpr(argCall->get(1));
+      SymExpr *rhs = toSymExpr(argCall->get(2));
+      if (argCall->isNamed("+")) {
+        if (!((lhs && lhs->symbol() == syms[i] && isIntImmediate(rhs)) ||
+              (rhs && rhs->symbol() == syms[i] && isIntImmediate(lhs)))) {
+          return false;
+        }
+      }
+      else if (argCall->isNamed("-")) {
+        if (!(lhs && lhs->symbol() == syms[i] && isIntImmediate(rhs))) {
+          return false;
+        }
+      }
+      else {
+        return false;
+      }
+      hasOffset = true;
+    }
+    else {
+      return false;
+    }
+  }
+  return hasOffset;
+}
+
 // Return the symbol `A` from an expression if it is in the form `A.domain`
 static Symbol *getDotDomBaseSym(Expr *expr) {
   if (CallExpr *ce = toCallExpr(expr)) {
@@ -945,6 +1126,9 @@ static const char *getCallRejectReasonStr(CallRejectReason reason) {
     case CRR_NO_CLEAN_INDEX_MATCH:
       return "call arguments don't match loop indices cleanly";
       break;
+    case CRR_INDEX_HAS_OFFSET:
+      return "call arguments are loop indices with offsets";
+      break;
     case CRR_NOT_ARRAY_ACCESS_LIKE:
       return "call doesn't look like array access";
       break;
@@ -1012,7 +1196,16 @@ static Symbol *getCallBaseSymIfSuitable(CallExpr *call, ForallStmt *forall,
       }
 
       if (!found) {
-        if (reason != NULL) *reason = CRR_NO_CLEAN_INDEX_MATCH;
+        if (reason != NULL) {
+          *reason = CRR_NO_CLEAN_INDEX_MATCH;
+          for (it = forall->optInfo.multiDIndices.begin();
+               it != forall->optInfo.multiDIndices.end();
+               it++) {
+            if (callHasOffsetSymArguments(call, *it)) {
+              *reason = CRR_INDEX_HAS_OFFSET;
+            }
+          }
+        }
         return NULL;
       }
     }
@@ -1556,6 +1749,61 @@ static CallExpr *confirmAccess(CallExpr *call) {
   return repl;
 }
 
+//
+// Is `call` an operator that, applied to arrays, is promoted elementwise?
+//
+static bool isPromotableOperator(CallExpr *call) {
+  static const char *ops[] = { "+", "-", "*", "/", "%", "**",
+                               "&", "|", "^", "<<", ">>", "!", "~",
+                               "==", "!=", "<", "<=", ">", ">=", NULL };
+
+  if (call->numActuals() < 1 || call->numActuals() > 2) {
+    return false;
+  }
+
+  for (int i = 0; ops[i] != NULL; i++) {
+    if (call->isNamed(ops[i])) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+//
+// Collects the symbols whose followers an iterand is iterated with: the
+// symbol itself for `A` or `A.domain`, and every non-literal operand of a
+// chain of promoted operators such as `B + C * D`, whose follower zips
+// those of its operands. Returns false if the iterand is anything else.
+//
+static bool getIterandBaseSyms(Expr *iterExpr, std::vector<Symbol *> &syms) {
+  if (isUnresolvedSymExpr(iterExpr)) {
+    return false;
+  }
+  else if (SymExpr *iterSE = toSymExpr(iterExpr)) {
+    if (!iterSE->symbol()->isImmediate()) {
+      syms.push_back(iterSE->symbol());
+    }
+    return true;
+  }
+  else if (Symbol *dotDomBaseSym = getDotDomBaseSym(iterExpr)) {
+    syms.push_back(dotDomBaseSym);
+    return true;
+  }
+  else if (CallExpr *call = toCallExpr(iterExpr)) {
+    if (isPromotableOperator(call)) {
+      for_actuals(actual, call) {
+        if (!getIterandBaseSyms(actual, syms)) {
+          return false;
+        }
+      }
+      return true;
+    }
+  }
+
+  return false;
+}
+
 //
 // An analysis to enable overriding dynamic checks for fast followers
 //
@@ -1570,46 +1818,42 @@ static void symbolicFastFollowerAnalysis(ForallStmt *forall) {
   bool confirm = true;
 
   for_alist(iterExpr, forall->iteratedExpressions()) {
-    Symbol *iterBaseSym = NULL;
-    Symbol *iterBaseDomSym = NULL;
+    std::vector<Symbol *> iterBaseSyms;
 
-    // record it if it is a symbol
-    if (isUnresolvedSymExpr(iterExpr) || isSymExpr(iterExpr)) {
-      if (SymExpr *iterSE = toSymExpr(iterExpr)) {
-        iterBaseSym = iterSE->symbol();
-      }
-    }
-    // it might be in the form `A.domain`
-    else if (Symbol *dotDomBaseSym = getDotDomBaseSym(iterExpr)) {
-      iterBaseSym = dotDomBaseSym;
-    }
-
-    // break if we couldn't get a symbol that we can analyze further
-    if (iterBaseSym == NULL) {
+    // break if we couldn't get symbols that we can analyze further
+    if (!getIterandBaseSyms(iterExpr, iterBaseSyms) || iterBaseSyms.empty()) {
       confirm = false;
       break;
     }
 
-    if (Symbol *domainSymbol = getDomSym(iterBaseSym)) {
-      // found a symbol through a definition that I can recognize
-      iterBaseDomSym = domainSymbol;
-    }
-    else {
-      // for now, just roll the dice and hope that it was a domain
-      iterBaseDomSym = iterBaseSym;
-    }
+    for_vector(Symbol, iterBaseSym, iterBaseSyms) {
+      Symbol *iterBaseDomSym = NULL;
 
-    if (commonDomSym == NULL) {
-      commonDomSym = iterBaseDomSym;
-    }
-    else {
-      // this iterator's symbol is different then what I assumed to be the
-      // common domain for all iterators. Not much I can do with this loop
-      if (commonDomSym != iterBaseDomSym) {
-        confirm = false;
-        break;
+      if (Symbol *domainSymbol = getDomSym(iterBaseSym)) {
+        // found a symbol through a definition that I can recognize
+        iterBaseDomSym = domainSymbol;
+      }
+      else {
+        // for now, just roll the dice and hope that it was a domain
+        iterBaseDomSym = iterBaseSym;
+      }
+
+      if (commonDomSym == NULL) {
+        commonDomSym = iterBaseDomSym;
+      }
+      else {
+        // this iterator's symbol is different then what I assumed to be the
+        // common domain for all iterators. Not much I can do with this loop
+        if (commonDomSym != iterBaseDomSym) {
+          confirm = false;
+          break;
+        }
       }
     }
+
+    if (!confirm) {
+      break;
+    }
   }
   forall->optInfo.hasAlignedFollowers = confirm;
 }
@@ -1651,6 +1895,14 @@ static void autoAggregation(ForallStmt *forall) {
 
             insertAggCandidate(lastCall, forall);
           }
+          else {
+            LOG_AA(1, "Not an aggregation candidate: needs a local access on "
+                      "one side and an array access on the other", lastCall);
+          }
+        }
+        else if (isRemoteCompoundAssignment(lastCall, forall)) {
+          LOG_AA(1, "Not an aggregation candidate: only '=' is aggregated, "
+                    "not compound assignments", lastCall);
         }
 
         if (reportedLoc) {
@@ -1864,6 +2116,34 @@ static bool assignmentSuitableForAggregation(CallExpr *call, ForallStmt *forall)
   return false;
 }
 
+// Is 'call' an update like `A[i] += x` where `A[i]` may be remote?  These
+// would need combining aggregators, which we don't have, so this is only
+// used to explain why they are not aggregated.
+static bool isRemoteCompoundAssignment(CallExpr *call, ForallStmt *forall) {
+  static const char *ops[] = { "+=", "-=", "*=", "/=", "%=", "**=",
+                               "&=", "|=", "^=", "<<=", ">>=" };
+
+  bool isCompound = false;
+  for (size_t i = 0 ; i < sizeof(ops)/sizeof(ops[0]) ; i++) {
+    if (call->isNamed(ops[i])) {
+      isCompound = true;
+      break;
+    }
+  }
+
+  if (isCompound && call->numActuals() == 2) {
+    if (CallExpr *leftCall = toCallExpr(call->get(1))) {
+      if (!leftCall->isPrimitive(PRIM_MAYBE_LOCAL_THIS)) {
+        return getCallBaseSymIfSuitable(leftCall, forall,
+                                        /*checkArgs=*/false,
+                                        NULL) != NULL;
+      }
+    }
+  }
+
+  return false;
+}
+
 Expr *preFoldMaybeAggregateAssign(CallExpr *call) {
   INT_ASSERT(call->isPrimitive(PRIM_MAYBE_AGGREGATE_ASSIGN));
 
@@ -249,6 +249,7 @@ static bool isSafeRefPrimitive(SymExpr* use) {
     case PRIM_UNARY_PLUS:
     case PRIM_UNARY_NOT:
     case PRIM_UNARY_LNOT:
+    case PRIM_UNLIKELY:
     case PRIM_ADD:
     case PRIM_SUBTRACT:
     case PRIM_MULT:
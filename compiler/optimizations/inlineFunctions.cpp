@@ -28,11 +28,14 @@
 #include "stmt.h"
 #include "stringutil.h"
 
+#include <algorithm>
+#include <map>
 #include <set>
 #include <vector>
 
 static void updateRefCalls();
 static void inlineFunctionsImpl();
+static void autoInlineFunctions();
 static void inlineFunction(FnSymbol* fn, std::set<FnSymbol*>& inlinedSet);
 static void inlineCall(CallExpr* call);
 static void updateDerefCalls();
@@ -54,6 +57,8 @@ void inlineFunctions() {
 
   inlineFunctionsImpl();
 
+  autoInlineFunctions();
+
   updateDerefCalls();
 
   inlineCleanup();
@@ -170,6 +175,178 @@ static void inlineAtCallSites(FnSymbol* fn) {
   }
 }
 
+/************************************* | **************************************
+*                                                                             *
+* Inline small functions that are not marked inline.                          *
+*                                                                             *
+* A function is a candidate if it is a leaf, i.e. it calls nothing but        *
+* extern functions, or if it is a field accessor or a 'this' method, which    *
+* are what most array and record accesses reduce to.  Its size is the number  *
+* of expressions in its body, less one per formal and one for the call, which *
+* inlining saves.  Leaves are inlined up to --inline-size-limit and           *
+* accessors and 'this' methods, which help later passes the most, up to       *
+* twice that.                                                                 *
+*                                                                             *
+* Each caller is visited once, so the calls that inlining copies into it are  *
+* not themselves inlined, and a caller may grow by at most the larger of its  *
+* own size and a few times the limit.  Together these keep compile time       *
+* linear in the size of the program.                                          *
+*                                                                             *
+* The inlined functions are left in place for prune2() to remove once they    *
+* have no calls left.                                                         *
+*                                                                             *
+************************************** | *************************************/
+
+static int  astSize(FnSymbol* fn);
+static int  autoInlineCost(FnSymbol* fn);
+
+static void autoInlineFunctions() {
+  if (fNoInline == true || inline_size_limit <= 0) {
+    return;
+  }
+
+  std::map<FnSymbol*, int> costs;
+
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    if (fn->inTree() == true) {
+      int cost = autoInlineCost(fn);
+
+      if (cost >= 0) {
+        costs[fn] = cost;
+      }
+    }
+  }
+
+  if (costs.empty() == true) {
+    return;
+  }
+
+  forv_Vec(FnSymbol, caller, gFnSymbols) {
+    if (caller->inTree()                 == false ||
+        caller->hasFlag(FLAG_INLINE)     ==  true ||
+        caller->hasFlag(FLAG_NO_FN_BODY) ==  true) {
+      continue;
+    }
+
+    std::vector<CallExpr*> calls;
+    int                    budget = std::max(astSize(caller),
+                                             4 * inline_size_limit);
+
+    collectFnCalls(caller, calls);
+
+    for_vector(CallExpr, call, calls) {
+      FnSymbol*                          fn = call->resolvedFunction();
+      std::map<FnSymbol*, int>::iterator it = costs.find(fn);
+
+      if (it == costs.end() || fn == caller || call->parentSymbol == NULL) {
+        continue;
+      }
+
+      if (it->second > budget) {
+        if (report_inlining) {
+          printf("chapel compiler: reporting inlining, "
+                 "%s function was not inlined into %s, "
+                 "which has grown too much\n",
+                 fn->cname,
+                 caller->cname);
+        }
+
+        continue;
+      }
+
+      budget -= it->second;
+
+      inlineCall(call);
+
+      if (report_inlining) {
+        printf("chapel compiler: reporting inlining, "
+               "%s function was inlined into %s (size %d)\n",
+               fn->cname,
+               caller->cname,
+               it->second);
+      }
+    }
+  }
+}
+
+static int astSize(FnSymbol* fn) {
+  std::vector<Expr*> exprs;
+
+  collectExprs(fn->body, exprs);
+
+  return (int) exprs.size();
+}
+
+// Returns the cost of inlining 'fn' at a call, or -1 if it is not a
+// candidate for automatic inlining.
+static int autoInlineCost(FnSymbol* fn) {
+  if (fn->hasFlag(FLAG_INLINE)                    == true ||
+      fn->hasFlag(FLAG_EXTERN)                    == true ||
+      fn->hasFlag(FLAG_EXPORT)                    == true ||
+      fn->hasFlag(FLAG_NO_FN_BODY)                == true ||
+      fn->hasFlag(FLAG_MODULE_INIT)               == true ||
+      fn->hasFlag(FLAG_GEN_MAIN_FUNC)             == true ||
+      fn->hasFlag(FLAG_ON)                        == true ||
+      fn->hasFlag(FLAG_ON_BLOCK)                  == true ||
+      fn->hasFlag(FLAG_BEGIN_BLOCK)               == true ||
+      fn->hasFlag(FLAG_COBEGIN_OR_COFORALL_BLOCK) == true ||
+      isTaskFun(fn)                               == true ||
+      fn->isIterator()                            == true) {
+    return -1;
+  }
+
+  CallExpr* last = toCallExpr(fn->body->body.tail);
+
+  if (last == NULL || last->isPrimitive(PRIM_RETURN) == false) {
+    return -1;
+  }
+
+  std::vector<DefExpr*> defs;
+
+  collectDefExprs(fn->body, defs);
+
+  for_vector(DefExpr, def, defs) {
+    if (isFnSymbol(def->sym) == true) {
+      return -1;
+    }
+  }
+
+  bool isAccessor = fn->hasFlag(FLAG_FIELD_ACCESSOR) == true ||
+                    (fn->hasFlag(FLAG_METHOD) == true && fn->name == astrThis);
+  bool isLeaf     = true;
+
+  std::vector<CallExpr*> calls;
+
+  collectFnCalls(fn, calls);
+
+  for_vector(CallExpr, call, calls) {
+    FnSymbol* calledFn = call->resolvedFunction();
+
+    if (calledFn == fn) {
+      return -1;
+
+    } else if (calledFn->hasFlag(FLAG_EXTERN) == false) {
+      isLeaf = false;
+
+      if (calledFn->hasFlag(FLAG_ON_BLOCK)                  == true ||
+          calledFn->hasFlag(FLAG_BEGIN_BLOCK)               == true ||
+          calledFn->hasFlag(FLAG_COBEGIN_OR_COFORALL_BLOCK) == true ||
+          isTaskFun(calledFn)                               == true) {
+        return -1;
+      }
+    }
+  }
+
+  int limit = isAccessor ? 2 * inline_size_limit : inline_size_limit;
+  int cost  = std::max(astSize(fn) - fn->numFormals() - 1, 0);
+
+  if ((isLeaf == true || isAccessor == true) && cost <= limit) {
+    return cost;
+  }
+
+  return -1;
+}
+
 /************************************* | **************************************
 *                                                                             *
 * inlines the function called by 'call' at that call site                     *
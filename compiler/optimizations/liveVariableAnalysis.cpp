@@ -22,8 +22,8 @@
 
 #include "astutil.h"
 #include "bb.h"
-#include "bitVec.h"
 #include "expr.h"
+#include "sparseBitVec.h"
 #include "stlUtil.h"
 #include "stmt.h"
 
@@ -48,7 +48,7 @@ liveVariableAnalysis(FnSymbol* fn,
                      Map<Symbol*,int>& localMap,
                      Vec<SymExpr*>& useSet,
                      Vec<SymExpr*>& defSet,
-                     std::vector<BitVec*>& OUT) {
+                     std::vector<SparseBitVec*>& OUT) {
   BasicBlock::buildLocalsVectorMap(fn, locals, localMap);
 
 #ifdef DEBUG_LIVE
@@ -65,15 +65,15 @@ liveVariableAnalysis(FnSymbol* fn,
   // IN(i): the set of variables that are live at entry to basic
   // block i
   //
-  std::vector<BitVec*> USE;
-  std::vector<BitVec*> DEF;
-  std::vector<BitVec*> IN;
+  std::vector<SparseBitVec*> USE;
+  std::vector<SparseBitVec*> DEF;
+  std::vector<SparseBitVec*> IN;
 
   for_vector(BasicBlock, bb, *fn->basicBlocks) {
-    BitVec* use = new BitVec(locals.n);
-    BitVec* def = new BitVec(locals.n);
-    BitVec* lvin = new BitVec(locals.n);
-    BitVec* lvout = new BitVec(locals.n);
+    SparseBitVec* use = new SparseBitVec();
+    SparseBitVec* def = new SparseBitVec();
+    SparseBitVec* lvin = new SparseBitVec();
+    SparseBitVec* lvout = new SparseBitVec();
     for_vector(Expr, expr, bb->exprs) {
       std::vector<BaseAST*> asts;
       collect_asts(expr, asts);
@@ -109,12 +109,12 @@ liveVariableAnalysis(FnSymbol* fn,
 
   BasicBlock::backwardFlowAnalysis(fn, USE, DEF, IN, OUT);
 
-  for_vector(BitVec, use, USE)
+  for_vector(SparseBitVec, use, USE)
     delete use, use = 0;
 
-  for_vector(BitVec, def, DEF)
+  for_vector(SparseBitVec, def, DEF)
     delete def, def = 0;
 
-  for_vector(BitVec, in, IN)
+  for_vector(SparseBitVec, in, IN)
     delete in, in = 0;
 }
@@ -41,6 +41,7 @@
 #include <algorithm>
 #include <set>
 #include <stack>
+#include <utility>
 
 
 
@@ -396,6 +397,7 @@ static bool isLoopInvariantPrimitive(PrimitiveOp* primitiveOp)
       case PRIM_UNARY_PLUS:
       case PRIM_UNARY_NOT:
       case PRIM_UNARY_LNOT:
+      case PRIM_UNLIKELY:
       case PRIM_ADD:
       case PRIM_SUBTRACT:
       case PRIM_MULT:
@@ -448,6 +450,8 @@ static bool isLoopInvariantPrimitive(PrimitiveOp* primitiveOp)
       case PRIM_ADDR_OF:
       case PRIM_SET_REFERENCE:
       case PRIM_DEREF:
+
+      case PRIM_CAST:
         return true;
     default:
       break;
@@ -458,6 +462,38 @@ static bool isLoopInvariantPrimitive(PrimitiveOp* primitiveOp)
 }
 
 
+/*
+ * Privatized-object lookups (chpl_getPrivatizedClass(pid)) are what
+ * every access to a distributed array or domain starts with. The
+ * table entry for a pid doesn't change while the object is alive, so
+ * the lookup is invariant whenever the pid is.
+ */
+static bool isLoopInvariantExternCall(CallExpr* call) {
+  if (FnSymbol* fn = call->resolvedFunction()) {
+    if (fn->hasFlag(FLAG_EXTERN) &&
+        strcmp(fn->name, "chpl_getPrivatizedClass") == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+/*
+ * A domain passed with a const intent can't change for the duration of
+ * the call, so loads of its metadata (its instance, bounds, strides,
+ * and so on) don't have to be redone on every iteration even though
+ * the formal is a ref.
+ */
+static bool isConstDomainFormal(Symbol* sym) {
+  if (ArgSymbol* arg = toArgSymbol(sym)) {
+    return (arg->intent & INTENT_FLAG_CONST) != 0 &&
+           arg->getValType()->symbol->hasFlag(FLAG_DOMAIN);
+  }
+  return false;
+}
+
+
 /*
  * Simple function to check if a symExpr is constant
  */
@@ -594,7 +630,8 @@ static bool allOperandsAreLoopInvariant(Expr* expr, std::set<SymExpr*>& loopInva
   //if there was a different loop invariant operand, make sure all its arguments
   //are invariant
   if(CallExpr* callExpr = toCallExpr(expr)) {
-    if(callExpr->primitive && isLoopInvariantPrimitive(callExpr->primitive)) {
+    if((callExpr->primitive && isLoopInvariantPrimitive(callExpr->primitive)) ||
+       isLoopInvariantExternCall(callExpr)) {
       if(callExpr->isPrimitive(PRIM_MOVE) || callExpr->isPrimitive(PRIM_ASSIGN)) {
         return allOperandsAreLoopInvariant(callExpr->get(2), loopInvariants, loopInvariantInstructions, loop, actualDefs);
       }
@@ -674,6 +711,33 @@ static bool allOperandsAreLoopInvariant(Expr* expr, std::set<SymExpr*>& loopInva
   return false;
 }
 
+/*
+ * computeNoAliasSets leaves a PRIM_NO_ALIAS_SET(formal, others...) at the
+ * start of a function for each ref formal it proved doesn't alias the
+ * other formals listed. Collect those as (formal, other) pairs, both ways.
+ */
+static void collectNoAliasFormals(FnSymbol* fn, std::set<std::pair<Symbol*, Symbol*> >& noAliasFormals) {
+  for_alist(expr, fn->body->body) {
+    CallExpr* call = toCallExpr(expr);
+
+    if(call == NULL || call->isPrimitive(PRIM_NO_ALIAS_SET) == false)
+      continue;
+
+    ArgSymbol* formal = toArgSymbol(toSymExpr(call->get(1))->symbol());
+    if(formal == NULL)
+      continue;
+
+    for_actuals(actual, call) {
+      if(ArgSymbol* other = toArgSymbol(toSymExpr(actual)->symbol())) {
+        if(other != formal) {
+          noAliasFormals.insert(std::pair<Symbol*, Symbol*>(formal, other));
+          noAliasFormals.insert(std::pair<Symbol*, Symbol*>(other, formal));
+        }
+      }
+    }
+  }
+}
+
 static bool computeAliases(FnSymbol* fn, std::map<Symbol*, std::set<Symbol*> >& aliases) {
   //Since the current alias analysis is pretty conservative, you can run into
   //the case where you have so many aliases that you run of space in memory to
@@ -691,15 +755,20 @@ static bool computeAliases(FnSymbol* fn, std::map<Symbol*, std::set<Symbol*> >&
   startTimer(computeAliasTimer);
 
   //Compute the aliases for the function's parameters. Any args passed by ref
-  //can potentially alias each other.
+  //can potentially alias each other, unless the interprocedural analysis in
+  //computeNoAliasSets showed that they don't.
   // TODO: pull out this alias analysis
-  // TODO: use results of computeNoAliasSets
+  std::set<std::pair<Symbol*, Symbol*> > noAliasFormals;
+  collectNoAliasFormals(fn, noAliasFormals);
+
   for_alist(formal1, fn->formals) {
     for_alist(formal2, fn->formals) {
       if(formal1 == formal2)
         continue;
       if(ArgSymbol* arg1 = toArgSymbol(toDefExpr(formal1)->sym)) {
         if(ArgSymbol* arg2 = toArgSymbol(toDefExpr(formal2)->sym)) {
+          if(noAliasFormals.count(std::pair<Symbol*, Symbol*>(arg1, arg2)))
+            continue;
           // TODO: should this handle const ref?
           if(arg1->intent == INTENT_REF && arg2->intent == INTENT_REF) {
             aliases[arg1].insert(arg2);
@@ -915,13 +984,13 @@ static void computeLoopInvariants(std::vector<SymExpr*>& loopInvariants,
     if (isArgSymbol(symExpr->symbol()) &&
         symExpr->getValType()->symbol->hasFlag(FLAG_ITERATOR_CLASS) == false) {
       if(ArgSymbol* argSymbol = toArgSymbol(symExpr->symbol())) {
-        if(argSymbol->isRef()) {
+        if(argSymbol->isRef() && !isConstDomainFormal(argSymbol)) {
           mightHaveBeenDeffedElseWhere = true;
         }
       }
       for_set(Symbol, aliasSym, aliases[symExpr->symbol()]) {
         if(ArgSymbol* argSymbol = toArgSymbol(aliasSym)) {
-          if(argSymbol->isRef()) {
+          if(argSymbol->isRef() && !isConstDomainFormal(argSymbol)) {
             mightHaveBeenDeffedElseWhere = true;
           }
         }
@@ -944,11 +1013,12 @@ static void computeLoopInvariants(std::vector<SymExpr*>& loopInvariants,
         mightHaveBeenDeffedElseWhere = true;
       }
     }
-    if (symExpr->symbol()->isRef()) {
+    if (symExpr->symbol()->isRef() &&
+        !isConstDomainFormal(symExpr->symbol())) {
         mightHaveBeenDeffedElseWhere = true;
     }
     for_set(Symbol, aliasSym, aliases[symExpr->symbol()]) {
-      if (aliasSym->isRef()) {
+      if (aliasSym->isRef() && !isConstDomainFormal(aliasSym)) {
         mightHaveBeenDeffedElseWhere = true;
       }
     }
@@ -1260,6 +1330,35 @@ static long licmFn(FnSymbol* fn) {
   return numLoops;
 }
 
+//
+// Is sym a local value of fn that nothing in the C for loop defines?
+// This is the test the loop rewrites that run after LICM use for the
+// bounds, strides and block factors they depend on.
+//
+bool isInvariantInLoop(Symbol* sym, FnSymbol* fn, CForLoop* loop) {
+  if (VarSymbol* var = toVarSymbol(sym)) {
+    if (var->immediate != NULL) {
+      return true;
+    }
+  }
+
+  if (!isVarSymbol(sym) && !isArgSymbol(sym)) {
+    return false;
+  }
+
+  if (sym->isRef() || sym->defPoint->parentSymbol != fn || isAddrTaken(sym)) {
+    return false;
+  }
+
+  for_SymbolDefs(def, sym) {
+    if (loop->contains(def)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 void loopInvariantCodeMotion(void) {
 
   // compute array element alias sets
@@ -1280,6 +1379,14 @@ void loopInvariantCodeMotion(void) {
     numLoops += licmFn(fn);
   }
 
+  // replace loops copying arrays of simple records with bulk copies,
+  // which needs the data pointers and block factors hoisted
+  bulkCopyRecordLoops();
+
+  // now that the block factors are hoisted, turn index arithmetic
+  // into recurrences
+  strengthReduceIndexing();
+
   stopTimer(overallTimer);
 
 #ifdef detailedTiming
@@ -522,7 +522,6 @@ void addNoAliasSetsInFn(FnSymbol* fn) {
 }
 
 
-static
 bool isAddrTaken(Symbol* var) {
   // Only handles values
   INT_ASSERT(!var->isRef());
@@ -36,6 +36,7 @@
 #include "virtualDispatch.h"
 #include "wellknown.h"
 
+#include <set>
 #include <stack>
 
 /*
@@ -56,8 +57,14 @@
    forall iterations could run in any order, these last statements could
    also complete in any order.
 
-   This handles PRIM_ASSIGN as well as several chpl_comm_atomic functions
-   by converting them to unordered calls within the runtime.
+   This handles PRIM_ASSIGN, PRIM_SET_MEMBER (record and class field
+   stores) as well as several chpl_comm_atomic functions by converting
+   them to unordered calls within the runtime.
+
+   Statements before the last ones can be converted too, if nothing
+   after them in the iteration could observe them: see
+   laterStmtsIndependent().  That covers non-fetching atomics anywhere
+   in the body and runs of independent trailing stores.
 
    It could handle PRIM_ARRAY_SET_FIRST as well if that becomes
    important in the future.
@@ -230,6 +237,12 @@ bool exprIsOptimizable(BlockStmt* loop, Expr* lastStmt,
       if (lhs->getValType() == rhs->getValType()) // same type
         if (isPOD(lhs->getValType())) // no custom = overloads
           return true;
+    } else if (call->isPrimitive(PRIM_SET_MEMBER)) {
+      Symbol* field = toSymExpr(call->get(2))->symbol();
+      Expr* rhs = call->get(3);
+      if (field->getValType() == rhs->getValType()) // same type
+        if (isPOD(field->getValType()))
+          return true;
     } else if (FnSymbol* fn = call->resolvedFunction()) {
       if (fn->_this &&
           fn->_this->getValType()->symbol->hasFlag(FLAG_ATOMIC_TYPE)) {
@@ -243,6 +256,37 @@ bool exprIsOptimizable(BlockStmt* loop, Expr* lastStmt,
   return false;
 }
 
+// The destination and source of a statement exprIsOptimizable() accepted.
+static void getStoreOperands(CallExpr* call, SymExpr*& lhs, SymExpr*& rhs) {
+  lhs = NULL;
+  rhs = NULL;
+  if (call->numActuals() >= 1)
+    lhs = toSymExpr(call->get(1));
+  if (call->isPrimitive(PRIM_SET_MEMBER))
+    rhs = toSymExpr(call->get(3));
+  else if (call->numActuals() >= 2)
+    rhs = toSymExpr(call->get(2));
+}
+
+// Returns the last statements along with any other top-level statements
+// in the loop body that might be made unordered. Whether those really
+// can be is decided after inlining (see laterStmtsIndependent()), but
+// they need their lifetime information now. They are returned last to
+// first, so that marking them gives each its own PRIM_OPTIMIZATION_INFO.
+static void getCandidateStmts(BlockStmt* loop,
+                              LifetimeInformation* lifetimeInfo,
+                              std::vector<Expr*>& stmts) {
+  getLastStmts(loop, stmts);
+
+  std::set<Expr*> seen(stmts.begin(), stmts.end());
+
+  for (Expr* cur = loop->body.last(); cur != NULL; cur = cur->prev) {
+    if (isCallExpr(cur) && seen.count(cur) == 0 &&
+        exprIsOptimizable(loop, cur, lifetimeInfo))
+      stmts.push_back(cur);
+  }
+}
+
 static bool forallNoTaskPrivate(ForallStmt* forall) {
   for_shadow_vars (shadow, temp, forall) {
     if (shadow->isReduce()) {
@@ -299,27 +343,40 @@ void MarkOptimizableForallLastStmts::markLoopsInForall(ForallStmt* forall) {
   bool addNoTaskPrivate = forallNoTaskPrivate(forall);
   std::vector< std::vector<Expr*> > lastStatementsPerBody;
 
-  // Gather the last statements in each loop body
   std::vector<BlockStmt*> bodies = forall->loopBodies();
-  for_vector(BlockStmt, block, bodies) {
-    std::vector<Expr*> lastStmts;
-    getLastStmts(block, lastStmts);
-    lastStatementsPerBody.push_back(lastStmts);
-  }
-
-  // Compute the number of last statements
-  // (expecting it matches across fast-follower/follower bodies)
   int numLastStmts = -1;
-  for (size_t loopNum = 0;
-       loopNum < lastStatementsPerBody.size();
-       loopNum++) {
-    int numThisLoop = (int) lastStatementsPerBody[loopNum].size();
-    if (numLastStmts == -1)
-      numLastStmts = numThisLoop;
-    else if (numLastStmts != numThisLoop)
-      return; // Give up on optimizing it
+
+  // Gather the candidate statements in each loop body, falling back
+  // to just the last statements if the bodies don't agree on them.
+  for (int onlyLast = 0; onlyLast < 2 && numLastStmts == -1; onlyLast++) {
+    lastStatementsPerBody.clear();
+    for_vector(BlockStmt, block, bodies) {
+      std::vector<Expr*> lastStmts;
+      if (onlyLast)
+        getLastStmts(block, lastStmts);
+      else
+        getCandidateStmts(block, lifetimeInfo, lastStmts);
+      lastStatementsPerBody.push_back(lastStmts);
+    }
+
+    // Compute the number of last statements
+    // (expecting it matches across fast-follower/follower bodies)
+    for (size_t loopNum = 0;
+         loopNum < lastStatementsPerBody.size();
+         loopNum++) {
+      int numThisLoop = (int) lastStatementsPerBody[loopNum].size();
+      if (numLastStmts == -1)
+        numLastStmts = numThisLoop;
+      else if (numLastStmts != numThisLoop) {
+        numLastStmts = -1;
+        break;
+      }
+    }
   }
 
+  if (numLastStmts == -1)
+    return; // Give up on optimizing it
+
   // Consider the last statements
   for (int stmtNum = 0; stmtNum < numLastStmts; stmtNum++) {
 
@@ -337,12 +394,7 @@ void MarkOptimizableForallLastStmts::markLoopsInForall(ForallStmt* forall) {
       if (exprIsOptimizable(block, stmt, lifetimeInfo)) {
         SymExpr* lhs = NULL;
         SymExpr* rhs = NULL;
-        if (CallExpr* call = toCallExpr(stmt)) {
-          if (call->numActuals() >= 1)
-            lhs = toSymExpr(call->get(1));
-          if (call->numActuals() >= 2)
-            rhs = toSymExpr(call->get(2));
-        }
+        getStoreOperands(toCallExpr(stmt), lhs, rhs);
         if (lhs && symbolOutlivesLoop(block, lhs->symbol(), lifetimeInfo))
           addLhsOutlivesForall = true;
         if (rhs && symbolOutlivesLoop(block, rhs->symbol(), lifetimeInfo))
@@ -360,12 +412,7 @@ void MarkOptimizableForallLastStmts::markLoopsInForall(ForallStmt* forall) {
       if (exprIsOptimizable(block, stmt, lifetimeInfo)) {
         SymExpr* lhs = NULL;
         SymExpr* rhs = NULL;
-        if (CallExpr* call = toCallExpr(stmt)) {
-          if (call->numActuals() >= 1)
-            lhs = toSymExpr(call->get(1));
-          if (call->numActuals() >= 2)
-            rhs = toSymExpr(call->get(2));
-        }
+        getStoreOperands(toCallExpr(stmt), lhs, rhs);
         if (lhs && addLhsOutlivesForall)
           addOptimizationFlag(stmt, OPT_INFO_LHS_OUTLIVES_FORALL);
         if (rhs && addRhsOutlivesForall)
@@ -728,26 +775,31 @@ static bool isOptimizableAtomicFunction(const char* cname) {
   return false;
 }
 
-static bool isOptimizableAtomicStmt(Expr* stmt, BlockStmt* loop) {
-  // If this were to change, we'd need conditionals below to check
-  // that the call is not within a PRIM_MOVE, since we can't do the
-  // optimization if the return value is used.
-  INT_ASSERT(stmt == stmt->getStmtExpr());
-
-  Symbol* refAtomic = NULL;
+// Returns the atomic operated on, if stmt is an optimizable atomic call.
+static Symbol* getOptimizableAtomicTarget(Expr* stmt) {
   if (CallExpr* call = toCallExpr(stmt)) {
     if (FnSymbol* fn = call->resolvedFunction()) {
       if (fn->hasFlag(FLAG_EXTERN)) {
         if (isOptimizableAtomicFunction(fn->cname)) {
           if (startsWith(fn->cname, "chpl_comm_atomic_")) {
-            refAtomic = toSymExpr(call->get(3))->symbol();
+            return toSymExpr(call->get(3))->symbol();
           } else {
-            refAtomic = toSymExpr(call->get(1))->symbol();
+            return toSymExpr(call->get(1))->symbol();
           }
         }
       }
     }
   }
+  return NULL;
+}
+
+static bool isOptimizableAtomicStmt(Expr* stmt, BlockStmt* loop) {
+  // If this were to change, we'd need conditionals below to check
+  // that the call is not within a PRIM_MOVE, since we can't do the
+  // optimization if the return value is used.
+  INT_ASSERT(stmt == stmt->getStmtExpr());
+
+  Symbol* refAtomic = getOptimizableAtomicTarget(stmt);
 
   if (refAtomic != NULL)
     if (BlockStmt* defInBlock = toBlockStmt(refAtomic->defPoint->parentExpr))
@@ -901,6 +953,107 @@ static bool isOptimizableAssignStmt(Expr* stmt, BlockStmt* loop) {
   return false;
 }
 
+static bool isOptimizableSetMemberStmt(Expr* stmt, BlockStmt* loop) {
+  Symbol* base = NULL;
+  if (CallExpr* call = toCallExpr(stmt))
+    if (call->isPrimitive(PRIM_SET_MEMBER))
+      if (SymExpr* baseSe = toSymExpr(call->get(1)))
+        if (isSymExpr(call->get(3)))
+          base = baseSe->symbol();
+
+  if (base)
+    if (base->isRef() || isClass(base->type))
+      if (BlockStmt* defInBlock = toBlockStmt(base->defPoint->parentExpr))
+        if (isBlockWithinBlock(defInBlock, loop))
+          if (CallExpr* marker = findMarkerNear(stmt))
+            if (hasOptimizationFlag(marker, OPT_INFO_LHS_OUTLIVES_FORALL) &&
+                hasOptimizationFlag(marker, OPT_INFO_FLAG_NO_TASK_PRIVATE))
+              return true;
+
+  return false;
+}
+
+static bool isMemoryAccessPrim(CallExpr* call) {
+  return call->isPrimitive(PRIM_DEREF) ||
+         call->isPrimitive(PRIM_GET_MEMBER) ||
+         call->isPrimitive(PRIM_GET_MEMBER_VALUE) ||
+         call->isPrimitive(PRIM_GET_SVEC_MEMBER) ||
+         call->isPrimitive(PRIM_GET_SVEC_MEMBER_VALUE) ||
+         call->isPrimitive(PRIM_ARRAY_GET);
+}
+
+// Does a value of type outer contain one of type inner, directly or in
+// a nested record, tuple or union field?
+static bool typeContains(Type* outer, Type* inner) {
+  AggregateType* at = toAggregateType(outer);
+  if (at == NULL || isClass(at))
+    return false;
+
+  for_fields(field, at) {
+    Type* fieldType = field->type->getValType();
+    if (fieldType == inner || typeContains(fieldType, inner))
+      return true;
+  }
+
+  return false;
+}
+
+// Could memory accessed as type a overlap memory accessed as type b?
+static bool typesMayOverlap(Type* a, Type* b) {
+  return a == b || typeContains(a, b) || typeContains(b, a);
+}
+
+// Returns true if nothing after stmt in the loop body could observe the
+// store (or atomic update) to memory of type storedType that stmt does,
+// so that it may complete at any time before the end of the forall.
+// Values of different types can't overlap unless one contains the
+// other, so it is enough that no later statement refers to or loads
+// anything of an overlapping type, and that there are no later calls
+// other than to the same atomic function (which commutes with stmt),
+// remote fences, and halts.
+static bool laterStmtsIndependent(Expr* stmt, Type* storedType,
+                                  BlockStmt* loop) {
+  CallExpr* stmtCall = toCallExpr(stmt);
+  FnSymbol* stmtFn = stmtCall ? stmtCall->resolvedFunction() : NULL;
+
+  CForLoop* cfor = toCForLoop(loop);
+
+  for (Expr* cur = stmt->next; cur != NULL; cur = cur->next) {
+    if (cfor && (cur == cfor->initBlockGet() ||
+                 cur == cfor->testBlockGet() ||
+                 cur == cfor->incrBlockGet()))
+      continue;
+
+    std::vector<CallExpr*> calls;
+    collectCallExprs(cur, calls);
+    for_vector(CallExpr, call, calls) {
+      if (call->isPrimitive(PRIM_VIRTUAL_METHOD_CALL))
+        return false;
+
+      if (FnSymbol* fn = call->resolvedFunction()) {
+        if (fn != stmtFn &&
+            !fn->hasFlag(FLAG_COMPILER_ADDED_REMOTE_FENCE) &&
+            !fn->hasFlag(FLAG_FUNCTION_TERMINATES_PROGRAM))
+          return false;
+      } else if (isMemoryAccessPrim(call) &&
+                 typesMayOverlap(call->typeInfo()->getValType(),
+                                 storedType)) {
+        return false;
+      }
+    }
+
+    std::vector<SymExpr*> symExprs;
+    collectSymExprs(cur, symExprs);
+    for_vector(SymExpr, se, symExprs) {
+      Symbol* sym = se->symbol();
+      if (sym->isRef() && typesMayOverlap(sym->getValType(), storedType))
+        return false;
+    }
+  }
+
+  return true;
+}
+
 static CondStmt *getAggregationCondStmt(Expr *stmt) {
 
   // if this was an aggregatable assignment, it must be inside a then block of
@@ -988,6 +1141,46 @@ static void transformAssignStmt(Expr* stmt) {
 }
 
 
+static void transformSetMemberStmt(Expr* stmt) {
+  SET_LINENO(stmt);
+
+  CallExpr* call = toCallExpr(stmt);
+
+  INT_ASSERT(call->isPrimitive(PRIM_SET_MEMBER));
+
+  Symbol* base = toSymExpr(call->get(1))->symbol();
+  Symbol* field = toSymExpr(call->get(2))->symbol();
+  Symbol* rhs = toSymExpr(call->get(3))->symbol();
+
+  Type* fieldRefType = field->type->getRefType();
+  Type* rhsRefType = rhs->getValType()->getRefType();
+  if (fieldRefType == NULL || rhsRefType == NULL)
+    return;
+
+  if (fReportOptimizeForallUnordered) {
+    if (developer || printsUserLocation(call)) {
+      USR_PRINT(call, "Optimized field store to be unordered");
+    }
+  }
+
+  VarSymbol* fieldRef = newTemp("unordered_field", fieldRefType);
+  call->insertBefore(new DefExpr(fieldRef));
+  call->insertBefore(new CallExpr(PRIM_MOVE, fieldRef,
+                                  new CallExpr(PRIM_GET_MEMBER, base, field)));
+
+  if (!rhs->isRef()) {
+    VarSymbol* rhsRef = newTemp("unordered_src", rhsRefType);
+    call->insertBefore(new DefExpr(rhsRef));
+    call->insertBefore(new CallExpr(PRIM_MOVE, rhsRef,
+                                    new CallExpr(PRIM_ADDR_OF, rhs)));
+    rhs = rhsRef;
+  }
+
+  call->insertBefore(new CallExpr(PRIM_UNORDERED_ASSIGN, fieldRef, rhs));
+  call->remove();
+}
+
+
 void optimizeForallUnorderedOps() {
 
   if (fReportBlocking) {
@@ -1018,6 +1211,7 @@ void optimizeForallUnorderedOps() {
   std::vector<Expr*> atomicsToOptimize;
   std::vector<CondStmt*> aggCondsToTransform;
   std::vector<Expr*> assignsToOptimize;
+  std::vector<Expr*> setMembersToOptimize;
 
   // Gather expressions to optimize. This is done separately from
   // doing the transformation so that the transformation itself does
@@ -1028,22 +1222,53 @@ void optimizeForallUnorderedOps() {
     if (block->isLoopStmt()) {
       LoopStmt* loop = toLoopStmt(block);
 
-      {
-        std::vector<Expr*> lastStmts;
-        getLastStmts(loop, lastStmts);
-        for_vector(Expr, lastStmt, lastStmts) {
-          if (isOptimizableAtomicStmt(lastStmt, loop)) {
-            atomicsToOptimize.push_back(lastStmt);
+      std::vector<Expr*> lastStmts;
+      getLastStmts(loop, lastStmts);
+      for_vector(Expr, lastStmt, lastStmts) {
+        if (isOptimizableAtomicStmt(lastStmt, loop)) {
+          atomicsToOptimize.push_back(lastStmt);
+        }
+        else if (isOptimizableAssignStmt(lastStmt, loop)) {
+          if (CondStmt *aggCond = getAggregationCondStmt(lastStmt)) {
+            aggCondsToTransform.push_back(aggCond);
           }
-          else if (isOptimizableAssignStmt(lastStmt, loop)) {
-            if (CondStmt *aggCond = getAggregationCondStmt(lastStmt)) {
-              aggCondsToTransform.push_back(aggCond);
-            }
-            else {
-              assignsToOptimize.push_back(lastStmt);
-            }
+          else {
+            assignsToOptimize.push_back(lastStmt);
           }
         }
+        else if (isOptimizableSetMemberStmt(lastStmt, loop)) {
+          setMembersToOptimize.push_back(lastStmt);
+        }
+      }
+
+      // Other candidates were marked during lifetime checking. Each
+      // one is the statement just before its PRIM_OPTIMIZATION_INFO.
+      std::set<Expr*> seen(lastStmts.begin(), lastStmts.end());
+      for_alist(stmt, loop->body) {
+        CallExpr* marker = toCallExpr(stmt);
+        if (marker == NULL || !marker->isPrimitive(PRIM_OPTIMIZATION_INFO))
+          continue;
+
+        Expr* cand = skipIgnoredStmts(marker);
+        if (cand == NULL || !isCallExpr(cand) || seen.count(cand) > 0)
+          continue;
+
+        CallExpr* call = toCallExpr(cand);
+        if (isOptimizableAtomicStmt(cand, loop)) {
+          Type* t = getOptimizableAtomicTarget(cand)->getValType();
+          if (laterStmtsIndependent(cand, t, loop))
+            atomicsToOptimize.push_back(cand);
+        }
+        else if (isOptimizableAssignStmt(cand, loop)) {
+          Type* t = toSymExpr(call->get(1))->symbol()->getValType();
+          if (laterStmtsIndependent(cand, t, loop))
+            assignsToOptimize.push_back(cand);
+        }
+        else if (isOptimizableSetMemberStmt(cand, loop)) {
+          Type* t = toSymExpr(call->get(2))->symbol()->getValType();
+          if (laterStmtsIndependent(cand, t, loop))
+            setMembersToOptimize.push_back(cand);
+        }
       }
     }
   }
@@ -1058,6 +1283,9 @@ void optimizeForallUnorderedOps() {
   for_vector(Expr, assign, assignsToOptimize) {
     transformAssignStmt(assign);
   }
+  for_vector(Expr, setMember, setMembersToOptimize) {
+    transformSetMemberStmt(setMember);
+  }
 
   cleanupRemainingAggCondStmts();
 }
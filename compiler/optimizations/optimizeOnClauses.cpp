@@ -32,8 +32,11 @@
 #include "expr.h"
 #include "stlUtil.h"
 #include "stmt.h"
+#include "stringutil.h"
+#include "virtualDispatch.h"
 #include "wellknown.h"
 
+#include <map>
 #include <vector>
 
 
@@ -112,6 +115,7 @@ classifyPrimitive(CallExpr *call) {
   case PRIM_UNARY_PLUS:
   case PRIM_UNARY_NOT:
   case PRIM_UNARY_LNOT:
+  case PRIM_UNLIKELY:
   case PRIM_ADD:
   case PRIM_SUBTRACT:
   case PRIM_MULT:
@@ -169,6 +173,9 @@ classifyPrimitive(CallExpr *call) {
   case PRIM_NO_ALIAS_SET:
   case PRIM_COPIES_NO_ALIAS_SET:
   case PRIM_OPTIMIZATION_INFO:
+
+  case PRIM_GPU_THREAD_ID:
+  case PRIM_GPU_ON_GPU_SUBLOC:
     return FAST_AND_LOCAL;
 
   case PRIM_MOVE:
@@ -285,6 +292,7 @@ classifyPrimitive(CallExpr *call) {
     // However, they are communication free.
     //
   case PRIM_STRING_COPY:
+  case PRIM_GPU_KERNEL_LAUNCH:
     return LOCAL_NOT_FAST;
 
   case PRIM_GET_DYNAMIC_END_COUNT:
@@ -367,6 +375,73 @@ inLocalBlock(CallExpr *call) {
   return false;
 }
 
+// Why markFastSafeFn() found a function not fast, or not local,
+// for --report-optimized-on.
+static std::map<FnSymbol*, const char*> notFastReasons;
+
+static int
+rejectFn(FnSymbol* fn, int is, const char* reason) {
+  notFastReasons[fn] = reason;
+  return is;
+}
+
+static const char*
+calleeReason(FnSymbol* callee) {
+  std::map<FnSymbol*, const char*>::iterator it = notFastReasons.find(callee);
+
+  if (it == notFastReasons.end()) {
+    // still being classified further up the call chain
+    return astr("calls recursive function ", callee->name);
+  }
+
+  return astr("calls ", callee->name, ", which ", it->second);
+}
+
+static int
+markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited);
+
+// A virtual method call is fast (local) if the root method and all of its
+// overrides are.  Looking up the method in the vtable is a local load; the
+// class id it is indexed by is computed by an earlier PRIM_GETCID, which is
+// classified on its own.
+static int
+markFastSafeVirtualCall(CallExpr* call, int recurse,
+                        std::set<FnSymbol*>& visited, const char** reason) {
+  FnSymbol*      root    = call->resolvedOrVirtualFunction();
+  Vec<FnSymbol*> targets;
+  int            retval  = FAST_AND_LOCAL;
+
+  targets.add(root);
+
+  forv_Vec(FnSymbol, target, targets) {
+    if (Vec<FnSymbol*>* children = virtualChildrenMap.get(target)) {
+      forv_Vec(FnSymbol, child, *children) {
+        if (targets.in(child) == NULL) {
+          targets.add(child);
+        }
+      }
+    }
+  }
+
+  forv_Vec(FnSymbol, target, targets) {
+    int is = markFastSafeFn(target, recurse - 1, visited);
+
+    if (is != FAST_AND_LOCAL && *reason == NULL) {
+      *reason = calleeReason(target);
+    }
+
+    if (!isLocal(is)) {
+      return NOT_FAST_NOT_LOCAL;
+    }
+
+    if (is == LOCAL_NOT_FAST) {
+      retval = LOCAL_NOT_FAST;
+    }
+  }
+
+  return retval;
+}
+
 static int
 markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited) {
 
@@ -391,10 +466,13 @@ markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited) {
       fn->addFlag(FLAG_LOCAL_FN);
       return FAST_AND_LOCAL;
     } else if(fn->hasFlag(FLAG_LOCAL_FN)) {
-      return LOCAL_NOT_FAST;
+      return rejectFn(fn, LOCAL_NOT_FAST,
+                      "is an extern function not marked fast-on safe");
     } else {
       // Other extern functions are not fast or local.
-      return NOT_FAST_NOT_LOCAL;
+      return rejectFn(fn, NOT_FAST_NOT_LOCAL,
+                      "is an extern function not marked local or "
+                      "fast-on safe");
     }
   }
 
@@ -405,9 +483,12 @@ markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited) {
   // We will return NOT_FAST_NOT_LOCAL immediately if we see something
   // in the function that is not local.
   bool maybefast = true;
+  const char* slowReason = NULL;
 
-  if (fn->hasFlag(FLAG_NON_BLOCKING))
+  if (fn->hasFlag(FLAG_NON_BLOCKING)) {
     maybefast = false;
+    slowReason = "is non-blocking";
+  }
 
   std::vector<CallExpr*> calls;
 
@@ -416,32 +497,60 @@ markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited) {
   for_vector(CallExpr, call, calls) {
     bool inLocal = fn->hasFlag(FLAG_LOCAL_FN) || inLocalBlock(call);
 
-    if (call->primitive) {
+    if (call->isPrimitive(PRIM_VIRTUAL_METHOD_CALL) && recurse > 0) {
+      const char* reason = NULL;
+      int is = markFastSafeVirtualCall(call, recurse, visited, &reason);
+
+      is = setLocal(is, inLocal);
+
+      if (!isLocal(is)) {
+        return rejectFn(fn, NOT_FAST_NOT_LOCAL, reason);
+      }
+
+      if (is == LOCAL_NOT_FAST) {
+        maybefast = false;
+        if (slowReason == NULL) slowReason = reason;
+      }
+
+    } else if (call->primitive) {
       int is = classifyPrimitive(call, inLocal);
 
       if (!isLocal(is)) {
         // FAST_NOT_LOCAL or NOT_FAST_NOT_LOCAL
-        return NOT_FAST_NOT_LOCAL;
+        return rejectFn(fn, NOT_FAST_NOT_LOCAL,
+                        astr("uses primitive '", call->primitive->name,
+                             "', which may communicate"));
       }
 
       // is == FAST_AND_LOCAL requires no action
       if (is == LOCAL_NOT_FAST) {
         maybefast = false;
+        if (slowReason == NULL)
+          slowReason = astr("uses primitive '", call->primitive->name,
+                            "', which may block or allocate");
       }
 
     } else {
       if (recurse<=0 || !call->isResolved()) {
         // didn't resolve or past too much recursion.
         // No function calls allowed
-        return NOT_FAST_NOT_LOCAL;
+        if (recurse <= 0)
+          return rejectFn(fn, NOT_FAST_NOT_LOCAL,
+                          "makes calls deeper than --optimize-on-clause-limit");
+        else
+          return rejectFn(fn, NOT_FAST_NOT_LOCAL,
+                          "makes an indirect function call");
 
       } else {
         // Handle nested 'on' statements
         if (call->resolvedFunction()->hasFlag(FLAG_ON_BLOCK)) {
           if (inLocal) {
             maybefast = false;
+            if (slowReason == NULL)
+              slowReason = "contains a nested on statement";
           } else {
-            return NOT_FAST_NOT_LOCAL;
+            return rejectFn(fn, NOT_FAST_NOT_LOCAL,
+                            "contains a nested on statement");
           }
         }
 
@@ -454,11 +563,14 @@ markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited) {
         is = setLocal(is, inLocal);
 
         if (!isLocal(is)) {
-          return NOT_FAST_NOT_LOCAL;
+          return rejectFn(fn, NOT_FAST_NOT_LOCAL,
+                          calleeReason(call->resolvedFunction()));
         }
 
         if (is == LOCAL_NOT_FAST) {
           maybefast = false;
+          if (slowReason == NULL)
+            slowReason = calleeReason(call->resolvedFunction());
         }
         // otherwise, possibly still fast.
       }
@@ -472,6 +584,8 @@ markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited) {
     if (BlockStmt* block = toBlockStmt(stmt)) {
       if (block->isLoopStmt()) {
         maybefast = false;
+        if (slowReason == NULL)
+          slowReason = "contains a loop";
         break;
       }
     }
@@ -489,7 +603,7 @@ markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited) {
 
     return FAST_AND_LOCAL;
   } else {
-    return LOCAL_NOT_FAST;
+    return rejectFn(fn, LOCAL_NOT_FAST, slowReason);
   }
 }
 
@@ -613,7 +727,9 @@ optimizeOnClauses(void) {
       removeRmemFences = removeUnnecessaryFences(fn);
     }
 
-    if ( (fastFork || removeRmemFences) && fReportOptimizedOn) {
+    bool reportMissed = fn->hasFlag(FLAG_ON_BLOCK) && !fastFork;
+
+    if ( (fastFork || removeRmemFences || reportMissed) && fReportOptimizedOn) {
       ModuleSymbol *mod = toModuleSymbol(fn->defPoint->parentSymbol);
       INT_ASSERT(mod);
       if (developer ||
@@ -625,9 +741,17 @@ optimizeOnClauses(void) {
           printf("Optimized rmem fence (%s) in module %s (%s:%d)\n",
                fn->cname, mod->name, fn->fname(), fn->linenum());
         }
+        if (reportMissed) {
+          const char* reason = notFastReasons[fn];
+          printf("Did not optimize on clause (%s) in module %s (%s:%d): "
+                 "it %s\n",
+                 fn->cname, mod->name, fn->fname(), fn->linenum(),
+                 reason ? reason : "is not fast");
+        }
         if (developer) printf("(id %i)\n", fn->id);
       }
     }
   }
+  notFastReasons.clear();
   addRunningTaskModifiers();
 }
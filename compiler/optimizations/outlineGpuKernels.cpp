@@ -0,0 +1,487 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Outline the bodies of forall loops into GPU kernels, for the gpu
+// locale model.
+//
+// After lowerIterators, a forall over a range is an order-independent
+// C for loop:
+//
+//   for (i = lo; i <= hi; i += 1) { body }
+//
+// When the body can run on a GPU -- it is all primitives, it uses no
+// wide references, classes or module-level variables, and it writes
+// no variables declared outside of it -- the loop becomes
+//
+//   if (running on a GPU sublocale)
+//     launch chpl_gpu_kernel_N(lo, hi, <variables the body reads>)
+//   else
+//     the original loop
+//
+// and chpl_gpu_kernel_N runs the body for index lo + its thread ID.
+// The variables are passed by value, so only the pointers in them,
+// the elements of arrays, reach memory outside of the kernel.  The
+// runtime puts arrays for GPU sublocales in managed memory.
+//
+
+#include "passes.h"
+
+#include "astutil.h"
+#include "CForLoop.h"
+#include "codegen.h"
+#include "driver.h"
+#include "expr.h"
+#include "stlUtil.h"
+#include "stmt.h"
+#include "stringutil.h"
+#include "symbol.h"
+#include "type.h"
+
+#include <set>
+#include <vector>
+
+static int kernelCount = 0;
+
+
+//
+// Match the header "i = lo; i <= hi; i += 1" with an int(64) index.
+//
+static bool isSimpleHeader(CForLoop* loop,
+                           Symbol*& index, Symbol*& lo, Symbol*& hi) {
+  BlockStmt* init = loop->initBlockGet();
+  BlockStmt* test = loop->testBlockGet();
+  BlockStmt* incr = loop->incrBlockGet();
+
+  if (init->body.length != 1 || test->body.length != 1 ||
+      incr->body.length != 1)
+    return false;
+
+  CallExpr* initCall = toCallExpr(init->body.head);
+  CallExpr* testCall = toCallExpr(test->body.head);
+  CallExpr* incrCall = toCallExpr(incr->body.head);
+
+  if (initCall == NULL || testCall == NULL || incrCall == NULL ||
+      !(initCall->isPrimitive(PRIM_ASSIGN) ||
+        initCall->isPrimitive(PRIM_MOVE)) ||
+      !testCall->isPrimitive(PRIM_LESSOREQUAL) ||
+      !incrCall->isPrimitive(PRIM_ADD_ASSIGN))
+    return false;
+
+  SymExpr* initIndex = toSymExpr(initCall->get(1));
+  SymExpr* initLo    = toSymExpr(initCall->get(2));
+  SymExpr* testIndex = toSymExpr(testCall->get(1));
+  SymExpr* testHi    = toSymExpr(testCall->get(2));
+  SymExpr* incrIndex = toSymExpr(incrCall->get(1));
+  int64_t  step      = 0;
+
+  if (initIndex == NULL || initLo == NULL || testIndex == NULL ||
+      testHi == NULL || incrIndex == NULL ||
+      !get_int(incrCall->get(2), &step) || step != 1)
+    return false;
+
+  index = initIndex->symbol();
+  lo    = initLo->symbol();
+  hi    = testHi->symbol();
+
+  Type* int64 = dtInt[INT_SIZE_64];
+
+  return testIndex->symbol() == index && incrIndex->symbol() == index &&
+         !index->isRef() && index->type == int64 &&
+         !lo->isRef() && lo->type == int64 &&
+         !hi->isRef() && hi->type == int64;
+}
+
+
+static bool isGpuSafePrimitive(CallExpr* call) {
+  switch (call->primitive->tag) {
+  case PRIM_NOOP:
+  case PRIM_MOVE:
+  case PRIM_ASSIGN:
+  case PRIM_UNORDERED_ASSIGN:
+  case PRIM_ADD_ASSIGN:
+  case PRIM_SUBTRACT_ASSIGN:
+  case PRIM_MULT_ASSIGN:
+  case PRIM_DIV_ASSIGN:
+  case PRIM_MOD_ASSIGN:
+  case PRIM_LSH_ASSIGN:
+  case PRIM_RSH_ASSIGN:
+  case PRIM_AND_ASSIGN:
+  case PRIM_OR_ASSIGN:
+  case PRIM_XOR_ASSIGN:
+
+  case PRIM_UNARY_MINUS:
+  case PRIM_UNARY_PLUS:
+  case PRIM_UNARY_NOT:
+  case PRIM_UNARY_LNOT:
+  case PRIM_UNLIKELY:
+  case PRIM_ADD:
+  case PRIM_SUBTRACT:
+  case PRIM_MULT:
+  case PRIM_DIV:
+  case PRIM_MOD:
+  case PRIM_LSH:
+  case PRIM_RSH:
+  case PRIM_EQUAL:
+  case PRIM_NOTEQUAL:
+  case PRIM_LESSOREQUAL:
+  case PRIM_GREATEROREQUAL:
+  case PRIM_LESS:
+  case PRIM_GREATER:
+  case PRIM_AND:
+  case PRIM_OR:
+  case PRIM_XOR:
+  case PRIM_MIN:
+  case PRIM_MAX:
+  case PRIM_GET_REAL:
+  case PRIM_GET_IMAG:
+
+  case PRIM_ADDR_OF:
+  case PRIM_SET_REFERENCE:
+  case PRIM_DEREF:
+  case PRIM_PTR_EQUAL:
+  case PRIM_PTR_NOTEQUAL:
+  case PRIM_CAST_TO_VOID_STAR:
+
+  case PRIM_GET_MEMBER:
+  case PRIM_GET_MEMBER_VALUE:
+  case PRIM_SET_MEMBER:
+  case PRIM_GET_SVEC_MEMBER:
+  case PRIM_GET_SVEC_MEMBER_VALUE:
+  case PRIM_SET_SVEC_MEMBER:
+
+  case PRIM_ARRAY_GET:
+  case PRIM_ARRAY_SET:
+  case PRIM_ARRAY_SET_FIRST:
+  case PRIM_ARRAY_SHIFT_BASE_POINTER:
+
+  case PRIM_INVARIANT_START:
+  case PRIM_NO_ALIAS_SET:
+  case PRIM_COPIES_NO_ALIAS_SET:
+  case PRIM_OPTIMIZATION_INFO:
+    return true;
+
+  case PRIM_CAST: {
+    // Only numeric casts; the others call into the runtime.
+    Type* to   = call->get(1)->typeInfo();
+    Type* from = call->get(2)->getValType();
+
+    return (is_arithmetic_type(to) || is_bool_type(to)) &&
+           (is_arithmetic_type(from) || is_bool_type(from));
+  }
+
+  default:
+    return false;
+  }
+}
+
+
+//
+// Could the variable be modified through this use of it?
+//
+static bool isWrittenAt(SymExpr* se) {
+  CallExpr* call = toCallExpr(se->parentExpr);
+
+  if (call == NULL || call->primitive == NULL)
+    return false;
+
+  switch (call->primitive->tag) {
+  case PRIM_MOVE:
+  case PRIM_ASSIGN:
+  case PRIM_UNORDERED_ASSIGN:
+  case PRIM_ADD_ASSIGN:
+  case PRIM_SUBTRACT_ASSIGN:
+  case PRIM_MULT_ASSIGN:
+  case PRIM_DIV_ASSIGN:
+  case PRIM_MOD_ASSIGN:
+  case PRIM_LSH_ASSIGN:
+  case PRIM_RSH_ASSIGN:
+  case PRIM_AND_ASSIGN:
+  case PRIM_OR_ASSIGN:
+  case PRIM_XOR_ASSIGN:
+  case PRIM_SET_MEMBER:
+  case PRIM_SET_SVEC_MEMBER:
+  case PRIM_GET_MEMBER:
+  case PRIM_GET_SVEC_MEMBER:
+    return call->get(1) == se;
+
+  case PRIM_ADDR_OF:
+  case PRIM_SET_REFERENCE:
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+
+static bool isGpuSafeType(Symbol* sym) {
+  Type* t = sym->getValType();
+
+  return !sym->isWideRef() &&
+         !t->symbol->hasFlag(FLAG_WIDE_REF) &&
+         !t->symbol->hasFlag(FLAG_WIDE_CLASS) &&
+         !isClassLike(t) &&
+         t != dtStringC &&
+         t != dtCFnPtr;
+}
+
+
+//
+// Can 'loop' run as a kernel?  If so, return the symbols the body
+// reads from outside of itself, other than the index, in 'captured'.
+//
+static bool isGpuEligible(CForLoop* loop, Symbol* index,
+                          std::vector<Symbol*>& captured) {
+  FnSymbol*              fn     = loop->getFunction();
+  BlockStmt*             init   = loop->initBlockGet();
+  BlockStmt*             test   = loop->testBlockGet();
+  BlockStmt*             incr   = loop->incrBlockGet();
+  std::set<Symbol*>      seen;
+  std::vector<SymExpr*>  indexUses;
+
+  if (fn == NULL || fn->hasFlag(FLAG_GPU_CODEGEN))
+    return false;
+
+  // The index must be dead after the loop, since the kernel doesn't
+  // leave it at hi+1.
+  collectSymExprsFor(fn, index, indexUses);
+  for_vector(SymExpr, se, indexUses) {
+    if (!loop->contains(se))
+      return false;
+  }
+
+  for_alist(stmt, loop->body) {
+    if (stmt == init || stmt == test || stmt == incr)
+      continue;
+
+    std::vector<BaseAST*> asts;
+    collect_asts(stmt, asts);
+
+    for_vector(BaseAST, ast, asts) {
+      if (CallExpr* call = toCallExpr(ast)) {
+        if (call->primitive == NULL || !isGpuSafePrimitive(call))
+          return false;
+
+      } else if (GotoStmt* gotoStmt = toGotoStmt(ast)) {
+        LabelSymbol* target = gotoStmt->gotoTarget();
+        if (target == NULL || !loop->contains(target->defPoint))
+          return false;
+
+      } else if (BlockStmt* block = toBlockStmt(ast)) {
+        // local, on, begin, ... blocks
+        if (!block->isLoopStmt() && block->blockInfoGet() != NULL)
+          return false;
+
+      } else if (SymExpr* se = toSymExpr(ast)) {
+        Symbol* sym = se->symbol();
+
+        if (isTypeSymbol(sym) || isLabelSymbol(sym))
+          continue;
+
+        if (isFnSymbol(sym) || !isGpuSafeType(sym))
+          return false;
+
+        VarSymbol* var = toVarSymbol(sym);
+        if (var != NULL && var->immediate != NULL)
+          continue;
+
+        if (sym == index) {
+          if (isWrittenAt(se))
+            return false;
+          continue;
+        }
+
+        if (loop->contains(sym->defPoint))
+          continue;
+
+        if (isGlobal(sym) || sym->isRef() || isWrittenAt(se))
+          return false;
+
+        if (seen.insert(sym).second)
+          captured.push_back(sym);
+      }
+    }
+  }
+
+  return true;
+}
+
+
+static FnSymbol* outlineLoop(CForLoop* loop, Symbol* index, Symbol* lo,
+                             Symbol* hi, std::vector<Symbol*>& captured) {
+  SET_LINENO(loop);
+
+  ModuleSymbol* mod    = loop->getModule();
+  FnSymbol*     kernel = new FnSymbol(astr("chpl_gpu_kernel_",
+                                           istr(++kernelCount)));
+  ArgSymbol*    loArg  = new ArgSymbol(INTENT_IN, "lo", dtInt[INT_SIZE_64]);
+  ArgSymbol*    hiArg  = new ArgSymbol(INTENT_IN, "hi", dtInt[INT_SIZE_64]);
+  CallExpr*     launch = new CallExpr(PRIM_GPU_KERNEL_LAUNCH,
+                                      new_CStringSymbol(kernel->name),
+                                      lo, hi);
+  BlockStmt*    gpuBlock = new BlockStmt();
+  SymbolMap     map;
+
+  kernel->addFlag(FLAG_GPU_CODEGEN);
+  kernel->retType = dtVoid;
+  kernel->insertFormalAtTail(loArg);
+  kernel->insertFormalAtTail(hiArg);
+
+  // The launch passes the addresses of copies of the captured symbols.
+  for_vector(Symbol, sym, captured) {
+    ArgSymbol* arg = new ArgSymbol(INTENT_IN, sym->name, sym->type);
+    VarSymbol* tmp = newTemp(sym->name, sym->type);
+
+    kernel->insertFormalAtTail(arg);
+    map.put(sym, arg);
+
+    gpuBlock->insertAtTail(new DefExpr(tmp));
+    gpuBlock->insertAtTail(new CallExpr(PRIM_MOVE, tmp, sym));
+    launch->insertAtTail(tmp);
+  }
+
+  gpuBlock->insertAtTail(launch);
+
+  // idx = lo + thread ID; if (idx <= hi) { body }
+  VarSymbol* tid     = newTemp("tid", dtInt[INT_SIZE_64]);
+  VarSymbol* idx     = newTemp(index->name, dtInt[INT_SIZE_64]);
+  VarSymbol* inRange = newTemp("inRange", dtBool);
+  BlockStmt* body    = new BlockStmt();
+
+  map.put(index, idx);
+
+  kernel->insertAtTail(new DefExpr(tid));
+  kernel->insertAtTail(new CallExpr(PRIM_MOVE, tid,
+                                    new CallExpr(PRIM_GPU_THREAD_ID)));
+  kernel->insertAtTail(new DefExpr(idx));
+  kernel->insertAtTail(new CallExpr(PRIM_MOVE, idx,
+                                    new CallExpr(PRIM_ADD, loArg, tid)));
+  kernel->insertAtTail(new DefExpr(inRange));
+  kernel->insertAtTail(new CallExpr(PRIM_MOVE, inRange,
+                                    new CallExpr(PRIM_LESSOREQUAL,
+                                                 idx, hiArg)));
+
+  // Copy the loop as a whole so gotos within it get the copied labels,
+  // then keep just its body.
+  CForLoop*          copy = toCForLoop(loop->copy(&map));
+  std::vector<Expr*> stmts;
+
+  for_alist(stmt, copy->body) {
+    if (stmt != copy->initBlockGet() && stmt != copy->testBlockGet() &&
+        stmt != copy->incrBlockGet())
+      stmts.push_back(stmt);
+  }
+
+  for_vector(Expr, stmt, stmts) {
+    body->insertAtTail(stmt->remove());
+  }
+
+  kernel->insertAtTail(new CondStmt(new SymExpr(inRange), body));
+  kernel->insertAtTail(new CallExpr(PRIM_RETURN, gVoid));
+
+  mod->block->insertAtTail(new DefExpr(kernel));
+
+  // if (onGpu) { launch } else { loop }
+  VarSymbol* onGpu    = newTemp("onGpu", dtBool);
+  BlockStmt* cpuBlock = new BlockStmt();
+  CondStmt*  cond     = new CondStmt(new SymExpr(onGpu), gpuBlock, cpuBlock);
+
+  loop->insertBefore(new DefExpr(onGpu));
+  loop->insertBefore(new CallExpr(PRIM_MOVE, onGpu,
+                                  new CallExpr(PRIM_GPU_ON_GPU_SUBLOC)));
+  loop->replace(cond);
+  cpuBlock->insertAtTail(loop);
+
+  return kernel;
+}
+
+
+static bool shouldReport(CForLoop* loop) {
+  if (!fReportGpuKernels)
+    return false;
+
+  ModuleSymbol* mod = loop->getModule();
+  INT_ASSERT(mod);
+
+  return developer || mod->modTag == MOD_USER;
+}
+
+
+void outlineGpuKernels() {
+  if (!localeUsesGPU())
+    return;
+
+  std::vector<CForLoop*> candidates;
+  std::set<CForLoop*>    eligible;
+
+  forv_Vec(BlockStmt, block, gBlockStmts) {
+    CForLoop* loop = toCForLoop(block);
+
+    if (loop != NULL && loop->inTree() && loop->isOrderIndependent())
+      candidates.push_back(loop);
+  }
+
+  std::vector<Symbol*> indices, los, his;
+  std::vector<std::vector<Symbol*> > captures;
+  std::vector<CForLoop*> loops;
+
+  for_vector(CForLoop, loop, candidates) {
+    Symbol* index = NULL;
+    Symbol* lo    = NULL;
+    Symbol* hi    = NULL;
+    std::vector<Symbol*> captured;
+
+    if (isSimpleHeader(loop, index, lo, hi) &&
+        isGpuEligible(loop, index, captured)) {
+      eligible.insert(loop);
+      loops.push_back(loop);
+      indices.push_back(index);
+      los.push_back(lo);
+      his.push_back(hi);
+      captures.push_back(captured);
+
+    } else if (shouldReport(loop)) {
+      USR_PRINT(loop, "Loop is not eligible for a GPU kernel");
+    }
+  }
+
+  // Outline only the outermost of nested eligible loops.
+  for (size_t i = 0; i < loops.size(); i++) {
+    bool nested = false;
+
+    for (Expr* e = loops[i]->parentExpr; e != NULL; e = e->parentExpr) {
+      if (CForLoop* outer = toCForLoop(e)) {
+        if (eligible.count(outer))
+          nested = true;
+      }
+    }
+
+    if (!nested) {
+      bool      report = shouldReport(loops[i]);
+      CForLoop* loop   = loops[i];
+      FnSymbol* kernel = outlineLoop(loop, indices[i], los[i], his[i],
+                                     captures[i]);
+
+      if (report)
+        USR_PRINT(loop, "Outlined loop into GPU kernel %s", kernel->name);
+    }
+  }
+}
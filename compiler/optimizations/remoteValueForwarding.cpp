@@ -36,7 +36,8 @@ static void updateLoopBodyClasses(Map<Symbol*, Vec<SymExpr*>*>& defMap,
 static void updateTaskFunctions(Map<Symbol*, Vec<SymExpr*>*>& defMap,
                                 Map<Symbol*, Vec<SymExpr*>*>& useMap);
 
-static void buildSyncAccessFunctionSet(Vec<FnSymbol*>& syncAccessFunctionSet);
+static void buildSyncAccessFunctionSet(Vec<FnSymbol*>& syncAccessFunctionSet,
+                                       bool            includeAtomics);
 
 static bool isSafeToDeref(Map<Symbol*, Vec<SymExpr*>*>& defMap,
                           Map<Symbol*, Vec<SymExpr*>*>& useMap,
@@ -196,11 +197,16 @@ static bool isSafeToDerefField(Map<Symbol*, Vec<SymExpr*>*>& defMap,
 static bool canForwardValue(Map<Symbol*, Vec<SymExpr*>*>& defMap,
                             Map<Symbol*, Vec<SymExpr*>*>& useMap,
                             Vec<FnSymbol*>&               syncFns,
+                            Vec<FnSymbol*>&               fenceFns,
                             FnSymbol*                     fn,
                             ArgSymbol*                    arg);
 
 static bool isSufficientlyConst(ArgSymbol* arg);
 
+static bool isSmallReadOnlyValue(Vec<FnSymbol*>& fenceFns,
+                                 FnSymbol*       fn,
+                                 ArgSymbol*      arg);
+
 static CallExpr* findDestroyCallForArg(ArgSymbol* arg);
 
 static void defaultForwarding(Map<Symbol*, Vec<SymExpr*>*>& useMap,
@@ -241,8 +247,10 @@ static bool shouldSerialize(ArgSymbol* arg) {
 static void updateTaskFunctions(Map<Symbol*, Vec<SymExpr*>*>& defMap,
                                 Map<Symbol*, Vec<SymExpr*>*>& useMap) {
   Vec<FnSymbol*> syncSet;
+  Vec<FnSymbol*> fenceSet;
 
-  buildSyncAccessFunctionSet(syncSet);
+  buildSyncAccessFunctionSet(syncSet,  false);
+  buildSyncAccessFunctionSet(fenceSet, true);
 
   forv_Vec(FnSymbol, fn, gFnSymbols) {
     if (fn->hasFlag(FLAG_ON) == true) {
@@ -251,7 +259,7 @@ static void updateTaskFunctions(Map<Symbol*, Vec<SymExpr*>*>& defMap,
 
       // For each reference arg that is safe to dereference
       for_formals(arg, fn) {
-        if (canForwardValue(defMap, useMap, syncSet, fn, arg)) {
+        if (canForwardValue(defMap, useMap, syncSet, fenceSet, fn, arg)) {
           if (shouldSerialize(arg)) {
             insertSerialization(fn, arg);
           } else {
@@ -266,6 +274,7 @@ static void updateTaskFunctions(Map<Symbol*, Vec<SymExpr*>*>& defMap,
 static bool canForwardValue(Map<Symbol*, Vec<SymExpr*>*>& defMap,
                             Map<Symbol*, Vec<SymExpr*>*>& useMap,
                             Vec<FnSymbol*>&               syncFns,
+                            Vec<FnSymbol*>&               fenceFns,
                             FnSymbol*                     fn,
                             ArgSymbol*                    arg) {
   bool retval = false;
@@ -323,8 +332,10 @@ static bool canForwardValue(Map<Symbol*, Vec<SymExpr*>*>& defMap,
         // to simply get to the wide class pointer. Because the reference is
         // never written to, we can simply RVF the class pointer.
         retval = true;
+      } else if (arg->hasFlag(FLAG_REF_TO_IMMUTABLE)) {
+        retval = true;
       } else {
-        retval = arg->hasFlag(FLAG_REF_TO_IMMUTABLE);
+        retval = isSmallReadOnlyValue(fenceFns, fn, arg);
       }
     } else {
       retval = false;
@@ -373,6 +384,102 @@ static bool isSufficientlyConst(ArgSymbol* arg) {
   return retval;
 }
 
+//
+// Estimate how many bytes forwarding a value of this type would add to the
+// on-statement's payload, or return -1 if it is not a plain value that can
+// simply be copied: scalars, class pointers, and tuples and records made of
+// those.
+//
+static int forwardedValueSize(Type* type) {
+  int retval = -1;
+
+  if (is_int_type(type)  || is_uint_type(type) ||
+      is_real_type(type) || is_imag_type(type) ||
+      is_complex_type(type)) {
+    retval = get_width(type) / 8;
+
+  } else if (is_bool_type(type) || is_enum_type(type)) {
+    retval = 8;
+
+  } else if (isClassLike(type)) {
+    // it will be a wide pointer by the time it is sent
+    retval = 16;
+
+  } else if (AggregateType* at = toAggregateType(type)) {
+    if (at->isRecord() == true                   &&
+        isRecordWrappedType(at) == false         &&
+        at->symbol->hasFlag(FLAG_POD) == true    &&
+        at->symbol->hasFlag(FLAG_EXTERN) == false) {
+      retval = 0;
+
+      for_fields(field, at) {
+        int fieldSize = field->isRef() ? -1 : forwardedValueSize(field->type);
+
+        if (fieldSize < 0) {
+          retval = -1;
+          break;
+        }
+
+        retval += fieldSize;
+      }
+    }
+  }
+
+  return retval;
+}
+
+//
+// A 'const ref' argument of a blocking on-function can be forwarded by
+// value, even though the referent is not known to be immutable, when
+//
+//   - the value is small enough that sending it costs less than the GETs
+//     back to the origin it saves (see forwardedValueSize()),
+//
+//   - the referent is a local variable of the caller at every call site,
+//     so only the caller, which is waiting for the on-statement, could
+//     otherwise change it, and no other reference formal could be used to
+//     write it, and
+//
+//   - the on-body never synchronizes with another task, so no write by
+//     another task can be ordered before one of its reads.
+//
+// This lets tuples and small records of scalars that the on-body reads
+// travel with the on-statement instead of being fetched each time.
+//
+static const int maxForwardedValueBytes = 64;
+
+static bool isSmallReadOnlyValue(Vec<FnSymbol*>& fenceFns,
+                                 FnSymbol*       fn,
+                                 ArgSymbol*      arg) {
+  int size = forwardedValueSize(arg->getValType());
+
+  if (size < 0 || size > maxForwardedValueBytes) {
+    return false;
+  }
+
+  if (fn->hasFlag(FLAG_NON_BLOCKING) == true || fenceFns.set_in(fn)) {
+    return false;
+  }
+
+  for_formals(formal, fn) {
+    if (formal != arg && formal->isRef() && formal->intent != INTENT_CONST_REF) {
+      return false;
+    }
+  }
+
+  forv_Vec(CallExpr, call, *fn->calledBy) {
+    SymExpr*   actual = toSymExpr(formal_to_actual(call, arg));
+    VarSymbol* var    = actual ? toVarSymbol(actual->symbol()) : NULL;
+
+    if (var == NULL || var->isRef() || isGlobal(var) ||
+        var->defPoint->parentSymbol != call->parentSymbol) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 // Now that we changed the formal from ref to value,
 // adjust its intent as well.
 static void adjustArgIntentForDeref(ArgSymbol* arg) {
@@ -724,20 +831,27 @@ static bool isSyncSingleMethod(FnSymbol* fn) {
   return retval;
 }
 
+static bool isAtomicMethod(FnSymbol* fn) {
+  return fn->_this != NULL && isAtomicType(fn->_this->getValType());
+}
+
 /************************************* | **************************************
 *                                                                             *
-* Compute set of functions that access sync variables.                        *
+* Compute set of functions that access sync variables, and atomic variables   *
+* too if includeAtomics is true.                                              *
 *                                                                             *
 ************************************** | *************************************/
 
-static void buildSyncAccessFunctionSet(Vec<FnSymbol*>& syncAccessFunctionSet) {
+static void buildSyncAccessFunctionSet(Vec<FnSymbol*>& syncAccessFunctionSet,
+                                       bool            includeAtomics) {
   Vec<FnSymbol*> syncAccessFunctionVec;
 
   //
   // Find all methods on sync/single vars
   //
   forv_Vec(FnSymbol, fn, gFnSymbols) {
-    if (isSyncSingleMethod(fn)) {
+    if (isSyncSingleMethod(fn) ||
+        (includeAtomics && isAtomicMethod(fn))) {
       if (!fn->hasFlag(FLAG_DONT_DISABLE_REMOTE_VALUE_FORWARDING) &&
           !syncAccessFunctionSet.set_in(fn)) {
         syncAccessFunctionSet.set_add(fn);
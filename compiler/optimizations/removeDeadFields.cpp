@@ -0,0 +1,197 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// removeDeadFields
+//
+// Removes the fields of records and classes that are stored to but
+// never read, along with the stores, so that every instance gets
+// smaller.  The general distributions in particular carry caches,
+// locks and optional metadata in their per-element and per-locale
+// types that many programs never look at.
+//
+// A field is dead if every reference to it is the member operand of a
+// PRIM_SET_MEMBER that stores a symbol.  Any other reference, such as
+// a PRIM_GET_MEMBER, which yields a reference that might be read
+// through, keeps the field.  Types whose layout is fixed by something
+// other than the Chapel code that uses them -- extern and exported
+// types, types passed to or returned by extern functions, and types the
+// code generator builds itself -- are left alone.
+//
+
+#include "passes.h"
+
+#include "astutil.h"
+#include "driver.h"
+#include "expr.h"
+#include "stlUtil.h"
+#include "stmt.h"
+#include "symbol.h"
+#include "type.h"
+
+#include <set>
+#include <vector>
+
+static void collectExternTypes(std::set<Type*>& externTypes);
+static bool canRemoveFields(AggregateType* at, std::set<Type*>& externTypes);
+static bool isDeadField(Symbol* field, std::vector<CallExpr*>& stores);
+
+void removeDeadFields() {
+  if (fNoRemoveDeadFields == true) {
+    return;
+  }
+
+  std::set<Type*> externTypes;
+
+  collectExternTypes(externTypes);
+
+  forv_Vec(AggregateType, at, gAggregateTypes) {
+    if (at->inTree() == false || canRemoveFields(at, externTypes) == false) {
+      continue;
+    }
+
+    std::vector<DefExpr*> deadFields;
+
+    for_fields(field, at) {
+      std::vector<CallExpr*> stores;
+
+      if (isDeadField(field, stores) == true) {
+        for_vector(CallExpr, store, stores) {
+          store->remove();
+        }
+
+        deadFields.push_back(field->defPoint);
+      }
+    }
+
+    for_vector(DefExpr, def, deadFields) {
+      if (fReportDeadFields == true) {
+        printf("Removed field %s of %s, which is never read\n",
+               def->sym->name,
+               at->symbol->name);
+      }
+
+      def->remove();
+    }
+  }
+}
+
+//
+// Record a type whose layout is visible to C, along with every type
+// reachable from it: the element type of a c_ptr/ddata, and the types
+// of its fields, since those determine its layout too.
+//
+static void addExternType(Type* type, std::set<Type*>& externTypes) {
+  Type* valType = type->getValType();
+
+  if (externTypes.insert(valType).second == false) {
+    return;
+  }
+
+  if (AggregateType* at = toAggregateType(valType)) {
+    TypeSymbol* ts = at->symbol;
+
+    if (ts->hasFlag(FLAG_C_PTR_CLASS) == true ||
+        ts->hasFlag(FLAG_DATA_CLASS)  == true) {
+      if (TypeSymbol* eltType = getDataClassType(ts)) {
+        addExternType(eltType->type, externTypes);
+      }
+    }
+
+    for_fields(field, at) {
+      addExternType(field->type, externTypes);
+    }
+  }
+}
+
+static void collectExternTypes(std::set<Type*>& externTypes) {
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    if (fn->inTree()               == true &&
+        (fn->hasFlag(FLAG_EXTERN) == true ||
+         fn->hasFlag(FLAG_EXPORT) == true)) {
+      addExternType(fn->retType, externTypes);
+
+      for_formals(formal, fn) {
+        addExternType(formal->type, externTypes);
+      }
+    }
+  }
+
+  forv_Vec(TypeSymbol, ts, gTypeSymbols) {
+    if (ts->inTree()               == true &&
+        (ts->hasFlag(FLAG_EXTERN) == true ||
+         ts->hasFlag(FLAG_EXPORT) == true)) {
+      addExternType(ts->type, externTypes);
+    }
+  }
+
+  forv_Vec(VarSymbol, var, gVarSymbols) {
+    if (var->inTree()               == true &&
+        (var->hasFlag(FLAG_EXTERN) == true ||
+         var->hasFlag(FLAG_EXPORT) == true)) {
+      addExternType(var->type, externTypes);
+    }
+  }
+}
+
+static bool canRemoveFields(AggregateType* at, std::set<Type*>& externTypes) {
+  TypeSymbol* ts = at->symbol;
+
+  return ts->hasFlag(FLAG_EXTERN)       == false &&
+         ts->hasFlag(FLAG_EXPORT)       == false &&
+         ts->hasFlag(FLAG_REF)          == false &&
+         ts->hasFlag(FLAG_WIDE_REF)     == false &&
+         ts->hasFlag(FLAG_WIDE_CLASS)   == false &&
+         ts->hasFlag(FLAG_TUPLE)        == false &&
+         ts->hasFlag(FLAG_DATA_CLASS)   == false &&
+         ts->hasFlag(FLAG_HEAP)         == false &&
+         ts->hasFlag(FLAG_C_PTR_CLASS)  == false &&
+         ts->hasFlag(FLAG_OBJECT_CLASS) == false &&
+         ts->hasFlag(FLAG_ATOMIC_TYPE)  == false &&
+         ts->hasFlag(FLAG_SYNC)         == false &&
+         ts->hasFlag(FLAG_SINGLE)       == false &&
+         externTypes.count(at)          == 0;
+}
+
+static bool isDeadField(Symbol* field, std::vector<CallExpr*>& stores) {
+  if (field->name == astrSuper) {
+    return false;
+  }
+
+  for_SymbolSymExprs(se, field) {
+    if (se->inTree() == false) {
+      continue;
+    }
+
+    CallExpr* call = toCallExpr(se->parentExpr);
+
+    if (call                               == NULL  ||
+        call->isPrimitive(PRIM_SET_MEMBER) == false ||
+        call->get(2)                       != se    ||
+        isSymExpr(call->get(3))            == false ||
+        call->getStmtExpr()                != call) {
+      return false;
+    }
+
+    stores.push_back(call);
+  }
+
+  return true;
+}
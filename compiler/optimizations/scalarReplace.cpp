@@ -45,6 +45,8 @@ static int srRecordReplaced = 0;
 
 //
 // typeVec - a vector of candidate types for scalar replacement
+// escapeSet - a set of the classes in typeVec that are only candidates
+//             because their instances might not escape
 // varSet - a set of candidate variables for scalar replacement
 // typeOrder - topological ordering of candidate types
 //              e.g. (int, (int, int)) before (int, int)
@@ -53,6 +55,7 @@ static int srRecordReplaced = 0;
 // useMap - useMap for varSet
 //
 static Vec<AggregateType*> typeVec;
+static Vec<AggregateType*> escapeSet;
 static Vec<Symbol*> varSet;
 static Map<AggregateType*,int> typeOrder;
 static Map<AggregateType*,Vec<Symbol*>*> typeVarMap;
@@ -102,6 +105,38 @@ compareTypesByOrder(const void* v1, const void* v2) {
     return 0;
 }
 
+//
+// Any class may have instances that never escape the function that
+// allocates them: scalarReplaceClass() only replaces an instance whose
+// one def is a visible allocation and whose uses are all field accesses
+// or its free, so no pointer to it is ever stored, passed or returned.
+// These are the classes it is worth looking at beyond the iterator
+// classes.  Types with special runtime layouts or semantics are left
+// alone, as are subclasses, whose inherited fields are reached through
+// an embedded 'super' object that scalar replacement can't split.
+//
+static bool
+isEscapeCandidate(TypeSymbol* ts) {
+  AggregateType* ct = toAggregateType(ts->type);
+
+  forv_Vec(AggregateType, parent, ct->dispatchParents) {
+    if (!parent->symbol->hasFlag(FLAG_OBJECT_CLASS))
+      return false;
+  }
+
+  return isClass(ts->type) &&
+    !ts->hasFlag(FLAG_ITERATOR_CLASS) &&
+    !ts->hasFlag(FLAG_EXTERN) &&
+    !ts->hasFlag(FLAG_DATA_CLASS) &&
+    !ts->hasFlag(FLAG_NO_OBJECT) &&
+    !ts->hasFlag(FLAG_OBJECT_CLASS) &&
+    !ts->hasFlag(FLAG_REF) &&
+    !ts->hasFlag(FLAG_WIDE_CLASS) &&
+    !ts->hasFlag(FLAG_SYNC) &&
+    !ts->hasFlag(FLAG_SINGLE) &&
+    !ts->hasFlag(FLAG_ATOMIC_TYPE);
+}
+
 static bool
 removeIdentityDefs(Symbol* sym) {
   bool change = false;
@@ -585,6 +620,10 @@ scalarReplace() {
           typeVarMap.put(ct, new Vec<Symbol*>());
           if (AggregateType* rct = toAggregateType(ct->refType))
             typeVarMap.put(rct, new Vec<Symbol*>());
+        } else if (isEscapeCandidate(ts)) {
+          typeVec.add(ct);
+          escapeSet.set_add(ct);
+          typeVarMap.put(ct, new Vec<Symbol*>());
         }
       }
     }
@@ -652,6 +691,16 @@ scalarReplace() {
               debugScalarReplacementFailure(var);
           }
         }
+      } else if (escapeSet.set_in(ct)) {
+        // Only the allocation check and rewrite are sound for these: the
+        // cleanups below assume the iterator classes' single-use temps.
+        forv_Vec(Symbol, var, *varVec) {
+          if (var->defPoint->parentSymbol) {
+            bool result = scalarReplaceClass(ct, var);
+            if (debugScalarReplacement && !result)
+              debugScalarReplacementFailure(var);
+          }
+        }
       } else {
         bool change;
         do {
@@ -676,6 +725,7 @@ scalarReplace() {
     // cleanup
     //
     typeVec.clear();
+    escapeSet.clear();
     varSet.clear();
     typeOrder.clear();
     form_Map(AggregateTypeToVecSymbolMapElem, e, typeVarMap) {
@@ -0,0 +1,258 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "optimizations.h"
+
+#include "astutil.h"
+#include "CForLoop.h"
+#include "codegen.h" // localeUsesGPU
+#include "driver.h"
+#include "expr.h"
+#include "stlUtil.h"
+#include "stmt.h"
+#include "symbol.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+/* Strength reduction of index arithmetic in C for loops.
+
+   Once array accesses are inlined, each A[i] or A[i,j] in a loop over
+   a rectangular array computes its offset from scratch: the index in
+   each dimension times that dimension's block factor (and stride),
+   summed.  LICM has hoisted the block factors by the time we get here,
+   so what's left in the loop is products of the loop index and
+   invariants.  This replaces each such product with a variable that
+   is set before the loop and advanced by step*factor alongside the
+   index, so the offset becomes a simple recurrence the back end can
+   vectorize.  For example:
+
+     for (i = lo; i <= hi; i += s) {     t0 = lo * blk; d0 = s * blk;
+       idx = i;                          for (i = lo, sr = t0; i <= hi;
+       t = idx * blk;                         i += s, sr += d0) {
+       ... data[t - off] ...               idx = i;
+     }                                     t = sr;
+                                           ... data[t - off] ...
+                                         }
+
+   The same pattern comes out of loops over localAccess() and of the
+   inner loops of forall bodies, which are C for loops too.
+ */
+
+static bool isIntegralType(Type* t) {
+  return is_int_type(t) || is_uint_type(t);
+}
+
+// Returns the statement in block that is 'prim(sym, ...)', if there is
+// exactly one statement in the block that mentions sym.
+static CallExpr* findOnlyCallOn(BlockStmt* block, Symbol* sym,
+                                PrimitiveTag prim) {
+  CallExpr* found = NULL;
+
+  for_alist(expr, block->body) {
+    std::vector<SymExpr*> symExprs;
+    collectSymExprsFor(expr, sym, symExprs);
+
+    if (symExprs.size() == 0) {
+      continue;
+    }
+
+    CallExpr* call = toCallExpr(expr);
+    if (found != NULL || call == NULL || !call->isPrimitive(prim) ||
+        call->numActuals() != 2 || symExprs.size() != 1 ||
+        symExprs[0] != call->get(1) || !isSymExpr(call->get(2))) {
+      return NULL;
+    }
+    found = call;
+  }
+
+  return found;
+}
+
+static void strengthReduceLoop(FnSymbol* fn, CForLoop* loop) {
+  BlockStmt* initBlock = loop->initBlockGet();
+  BlockStmt* incrBlock = loop->incrBlockGet();
+
+  if (initBlock == NULL || incrBlock == NULL) {
+    return;
+  }
+
+  //
+  // Find the induction variable: 'i = lo' in the init clause, 'i += s'
+  // in the increment clause, and no other definitions in the loop.
+  //
+  Symbol*   idx      = NULL;
+  CallExpr* initCall = NULL;
+  CallExpr* incrCall = NULL;
+
+  for_alist(expr, incrBlock->body) {
+    CallExpr* call = toCallExpr(expr);
+    if (call != NULL && call->isPrimitive(PRIM_ADD_ASSIGN)) {
+      if (SymExpr* se = toSymExpr(call->get(1))) {
+        idx = se->symbol();
+        break;
+      }
+    }
+  }
+
+  if (idx == NULL || !isVarSymbol(idx) || idx->isRef() ||
+      !isIntegralType(idx->type) || isAddrTaken(idx)) {
+    return;
+  }
+
+  initCall = findOnlyCallOn(initBlock, idx, PRIM_ASSIGN);
+  incrCall = findOnlyCallOn(incrBlock, idx, PRIM_ADD_ASSIGN);
+
+  if (initCall == NULL || incrCall == NULL) {
+    return;
+  }
+
+  for_SymbolDefs(def, idx) {
+    if (loop->contains(def) &&
+        def->parentExpr != initCall && def->parentExpr != incrCall) {
+      return;
+    }
+  }
+
+  Symbol* lo   = toSymExpr(initCall->get(2))->symbol();
+  Symbol* step = toSymExpr(incrCall->get(2))->symbol();
+
+  if (lo->type != idx->type || step->type != idx->type ||
+      !isInvariantInLoop(lo, fn, loop) || !isInvariantInLoop(step, fn, loop)) {
+    return;
+  }
+
+  //
+  // The body usually copies the index into the user's index variable
+  // first.  Copies that are defined only in the loop body have the
+  // index's value wherever they are used in the body.
+  //
+  std::set<Symbol*> copies;
+  copies.insert(idx);
+
+  std::vector<CallExpr*> calls;
+  for_alist(expr, loop->body) {
+    collectCallExprs(expr, calls);
+  }
+
+  for_vector(CallExpr, call, calls) {
+    if (call->isPrimitive(PRIM_MOVE)) {
+      SymExpr* lhs = toSymExpr(call->get(1));
+      SymExpr* rhs = toSymExpr(call->get(2));
+
+      if (lhs != NULL && rhs != NULL && rhs->symbol() == idx &&
+          isVarSymbol(lhs->symbol()) && !lhs->symbol()->isRef() &&
+          lhs->symbol()->type == idx->type &&
+          loop->contains(lhs->symbol()->defPoint) &&
+          lhs->symbol()->countDefs() == 1 &&
+          !isAddrTaken(lhs->symbol())) {
+        copies.insert(lhs->symbol());
+      }
+    }
+  }
+
+  //
+  // Replace 'move t, copy * k' by 'move t, sr', with
+  //   before the loop:  sr0 = lo * k;  delta = step * k;
+  //   init clause:      sr = sr0;
+  //   incr clause:      sr += delta;
+  // One sr serves every product with the same invariant factor.
+  //
+  std::map<Symbol*, Symbol*> reducedFor;
+
+  for_vector(CallExpr, call, calls) {
+    if (!call->isPrimitive(PRIM_MOVE)) {
+      continue;
+    }
+
+    CallExpr* mult = toCallExpr(call->get(2));
+    if (mult == NULL || !mult->isPrimitive(PRIM_MULT)) {
+      continue;
+    }
+
+    SymExpr* lhs = toSymExpr(call->get(1));
+    SymExpr* a   = toSymExpr(mult->get(1));
+    SymExpr* b   = toSymExpr(mult->get(2));
+
+    if (lhs == NULL || a == NULL || b == NULL ||
+        lhs->symbol()->isRef() || lhs->symbol()->type != idx->type) {
+      continue;
+    }
+
+    Symbol* factor = NULL;
+    if (copies.count(a->symbol()) && !copies.count(b->symbol())) {
+      factor = b->symbol();
+    } else if (copies.count(b->symbol()) && !copies.count(a->symbol())) {
+      factor = a->symbol();
+    }
+
+    if (factor == NULL || factor->type != idx->type ||
+        !isInvariantInLoop(factor, fn, loop)) {
+      continue;
+    }
+
+    Symbol* sr = reducedFor[factor];
+
+    if (sr == NULL) {
+      SET_LINENO(loop);
+
+      VarSymbol* sr0   = newTemp("sr_init", idx->type);
+      VarSymbol* delta = newTemp("sr_step", idx->type);
+
+      sr = newTemp("sr_idx", idx->type);
+      reducedFor[factor] = sr;
+
+      loop->insertBefore(new DefExpr(sr0));
+      loop->insertBefore(new CallExpr(PRIM_MOVE, sr0,
+                                      new CallExpr(PRIM_MULT, lo, factor)));
+      loop->insertBefore(new DefExpr(delta));
+      loop->insertBefore(new CallExpr(PRIM_MOVE, delta,
+                                      new CallExpr(PRIM_MULT, step, factor)));
+      loop->insertBefore(new DefExpr(sr));
+
+      initCall->insertAfter(new CallExpr(PRIM_ASSIGN, sr, sr0));
+      incrCall->insertAfter(new CallExpr(PRIM_ADD_ASSIGN, sr, delta));
+    }
+
+    SET_LINENO(mult);
+    mult->replace(new SymExpr(sr));
+  }
+}
+
+void strengthReduceIndexing() {
+  if (fNoStrengthReduceIndexing)
+    return;
+
+  forv_Vec(BlockStmt, block, gBlockStmts) {
+    if (CForLoop* loop = toCForLoop(block)) {
+      // The GPU outliner needs exactly one statement in the init and
+      // increment clauses, so leave loops it could outline alone.
+      if (localeUsesGPU() && loop->isOrderIndependent())
+        continue;
+
+      if (loop->inTree()) {
+        if (FnSymbol* fn = toFnSymbol(loop->parentSymbol)) {
+          strengthReduceLoop(fn, loop);
+        }
+      }
+    }
+  }
+}
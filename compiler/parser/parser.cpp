@@ -22,6 +22,7 @@
 
 #include "bison-chapel.h"
 #include "build.h"
+#include "compileServer.h"
 #include "config.h"
 #include "countTokens.h"
 #include "docsDriver.h"
@@ -35,7 +36,16 @@
 #include "symbol.h"
 #include "wellknown.h"
 
+#include <condition_variable>
 #include <cstdlib>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 BlockStmt*           yyblock                       = NULL;
 const char*          yyfilename                    = NULL;
@@ -80,6 +90,14 @@ static const char*   searchThePath(const char*      modName,
                                    bool             isInternal,
                                    Vec<const char*> searchPath);
 
+static void          prefetchFile(const char* path);
+
+static void          prefetchMod(const char* modName, bool isInternal);
+
+static char*         takePrefetchedFile(const char* path, size_t* size);
+
+static void          stopPrefetching();
+
 /************************************* | **************************************
 *                                                                             *
 *                                                                             *
@@ -95,8 +113,17 @@ void parse() {
 
   parseInternalModules();
 
+  if (fCompileServer[0] != '\0') {
+    // The server forks, and the children wouldn't have our threads.
+    stopPrefetching();
+
+    compileServerRun(fCompileServer);
+  }
+
   parseCommandLineFiles();
 
+  stopPrefetching();
+
   checkConfigs();
 
   finishCountingTokens();
@@ -280,6 +307,11 @@ static void countTokensInCmdLineFiles() {
 
 static void parseInternalModules() {
   if (fDocs == false || fDocsProcessUsedModules == true) {
+    prefetchMod("ChapelBase",           true);
+    prefetchMod("ChapelStandard",       true);
+    prefetchMod("PrintModuleInitOrder", true);
+    prefetchMod("SysCTypes",            false);
+
     baseModule            = parseMod("ChapelBase",           true);
     standardModule        = parseMod("ChapelStandard",       true);
     printModuleInitModule = parseMod("PrintModuleInitOrder", true);
@@ -327,6 +359,14 @@ static void parseCommandLineFiles() {
     printModuleSearchPath();
   }
 
+  while ((inputFileName = nthFilename(fileNum++))) {
+    if (isChplSource(inputFileName)) {
+      prefetchFile(inputFileName);
+    }
+  }
+
+  fileNum = 0;
+
   while ((inputFileName = nthFilename(fileNum++))) {
     if (isChplSource(inputFileName)) {
       parseFile(inputFileName, MOD_USER, true, false);
@@ -488,7 +528,19 @@ static void ensureRequiredStandardModulesAreParsed() {
 ************************************** | *************************************/
 
 static void parseDependentModules(bool isInternal) {
-  forv_Vec(const char*, modName, sModNameList) {
+  int prefetched = 0;
+
+  // Parsing a module can add more to the list, so read ahead whatever
+  // we know about so far before each one.
+  for (int i = 0; i < sModNameList.n; i++) {
+    const char* modName = sModNameList.v[i];
+
+    for (; prefetched < sModNameList.n; prefetched++) {
+      if (sModDoneSet.set_in(sModNameList.v[prefetched]) == NULL) {
+        prefetchMod(sModNameList.v[prefetched], isInternal);
+      }
+    }
+
     if (sModDoneSet.set_in(modName)   == NULL &&
         parseMod(modName, isInternal) != NULL) {
       sModDoneSet.set_add(modName);
@@ -536,6 +588,7 @@ static ModuleSymbol* parseMod(const char* modName, bool isInternal) {
 
 static bool containsOnlyModules(BlockStmt* block, const char* path);
 static void addModuleToDoneList(ModuleSymbol* module);
+static char* readWholeFile(FILE* fp, size_t* size);
 
 //
 // This is a check to see whether we've already parsed this file
@@ -624,7 +677,21 @@ static ModuleSymbol* parseFile(const char* path,
 
     stringBufferInit();
 
-    yyset_in(fp, context.scanner);
+    // Scan the file in place rather than through stdio and the lexer's
+    // refill buffer, falling back to the FILE* if it can't be read whole.
+    size_t          size   = 0;
+    char*           text   = takePrefetchedFile(path, &size);
+    YY_BUFFER_STATE handle = NULL;
+
+    if (text == NULL) {
+      text = readWholeFile(fp, &size);
+    }
+
+    if (text != NULL) {
+      handle = yy_scan_buffer(text, size + 2, context.scanner);
+    } else {
+      yyset_in(fp, context.scanner);
+    }
 
     while (lexerStatus != 0 && parserStatus == YYPUSH_MORE) {
       YYSTYPE yylval;
@@ -653,8 +720,14 @@ static ModuleSymbol* parseFile(const char* path,
     yypstate_delete(parser);
 
     // Cleanup after the lexer
+    if (handle != NULL) {
+      yy_delete_buffer(handle, context.scanner);
+    }
+
     yylex_destroy(context.scanner);
 
+    free(text);
+
     closeInputFile(fp);
 
     // Halt now if there were parse errors.
@@ -728,6 +801,240 @@ static ModuleSymbol* parseFile(const char* path,
   return retval;
 }
 
+/************************************* | **************************************
+*                                                                             *
+* Module files are read ahead on a few threads while we parse, once we know   *
+* we will want them: the command line files up front, and the modules other   *
+* modules use as soon as the uses are parsed.  The threads only read bytes;   *
+* lexing, parsing and building the AST stay on this thread, because the AST   *
+* constructors share global state (node ids, the astr() table and the gVec    *
+* lists), so the parse order and the AST are the same as without this.        *
+*                                                                             *
+************************************** | *************************************/
+
+struct PrefetchedFile {
+  bool   done;
+  char*  text;
+  size_t size;
+};
+
+static std::mutex                             sPrefetchMutex;
+static std::condition_variable                sPrefetchCV;
+static std::deque<const char*>                sPrefetchQueue;
+static std::map<const char*, PrefetchedFile>  sPrefetched;
+static std::vector<std::thread>               sPrefetchThreads;
+static bool                                   sPrefetchStopping = false;
+
+static const unsigned                         sMaxPrefetchThreads = 4;
+
+// Like readWholeFile(), without stdio so it can run on any thread.
+static char* readWholeFileAt(const char* path, size_t* size) {
+  int         fd     = open(path, O_RDONLY);
+  struct stat st;
+  char*       retval = NULL;
+
+  if (fd < 0) {
+    return NULL;
+  }
+
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+    size_t len  = (size_t) st.st_size;
+    size_t got  = 0;
+
+    retval = (char*) malloc(len + 2);
+
+    while (retval != NULL && got < len) {
+      ssize_t n = read(fd, retval + got, len - got);
+
+      if (n <= 0) {
+        free(retval);
+
+        retval = NULL;
+      } else {
+        got += (size_t) n;
+      }
+    }
+
+    if (retval != NULL) {
+      retval[len]     = '\0';
+      retval[len + 1] = '\0';
+
+      *size = len;
+    }
+  }
+
+  close(fd);
+
+  return retval;
+}
+
+static void prefetchWorker() {
+  std::unique_lock<std::mutex> lock(sPrefetchMutex);
+
+  while (true) {
+    sPrefetchCV.wait(lock, [] {
+      return sPrefetchStopping || sPrefetchQueue.empty() == false;
+    });
+
+    if (sPrefetchQueue.empty() == true) {
+      return;
+    }
+
+    const char* path = sPrefetchQueue.front();
+    size_t      size = 0;
+    char*       text = NULL;
+
+    sPrefetchQueue.pop_front();
+
+    lock.unlock();
+    text = readWholeFileAt(path, &size);
+    lock.lock();
+
+    PrefetchedFile& file = sPrefetched[path];
+
+    file.done = true;
+    file.text = text;
+    file.size = size;
+
+    sPrefetchCV.notify_all();
+  }
+}
+
+// 'path' must be an astr(), since that's what we look it up by.
+static void prefetchFile(const char* path) {
+  path = astr(path);
+
+  std::lock_guard<std::mutex> lock(sPrefetchMutex);
+
+  if (sPrefetched.count(path) > 0 || sPrefetchStopping == true) {
+    return;
+  }
+
+  if (sPrefetchThreads.size() < sMaxPrefetchThreads &&
+      sPrefetchThreads.size() < std::thread::hardware_concurrency()) {
+    try {
+      sPrefetchThreads.push_back(std::thread(prefetchWorker));
+    } catch (const std::system_error&) {
+      // No more threads; parseFile() will just read what we don't.
+    }
+  }
+
+  if (sPrefetchThreads.empty() == true) {
+    return;
+  }
+
+  PrefetchedFile file = { false, NULL, 0 };
+
+  sPrefetched[path] = file;
+  sPrefetchQueue.push_back(path);
+
+  sPrefetchCV.notify_one();
+}
+
+// Find the file parseMod() will, without its ambiguity warnings, since
+// we may never parse it.
+static void prefetchMod(const char* modName, bool isInternal) {
+  const char*      fileName = astr(modName, ".chpl");
+  Vec<const char*> noPath;
+  Vec<const char*> paths[2] = {
+    isInternal ? sIntModPath : sUsrModPath,
+    isInternal ? noPath      : sStdModPath
+  };
+
+  for (int i = 0; i < 2; i++) {
+    forv_Vec(const char*, dirName, paths[i]) {
+      const char* path = astr(dirName, "/", fileName);
+      struct stat st;
+
+      if (stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+        prefetchFile(path);
+        return;
+      }
+    }
+  }
+}
+
+// The contents of 'path' if it was read ahead, else NULL.  The buffer
+// ends with the two NULs yy_scan_buffer() needs; the caller frees it.
+static char* takePrefetchedFile(const char* path, size_t* size) {
+  std::unique_lock<std::mutex> lock(sPrefetchMutex);
+
+  std::map<const char*, PrefetchedFile>::iterator it =
+    sPrefetched.find(astr(path));
+
+  if (it == sPrefetched.end()) {
+    return NULL;
+  }
+
+  sPrefetchCV.wait(lock, [&it] { return it->second.done; });
+
+  char* retval = it->second.text;
+
+  *size = it->second.size;
+
+  it->second.text = NULL;
+
+  return retval;
+}
+
+static void stopPrefetching() {
+  {
+    std::lock_guard<std::mutex> lock(sPrefetchMutex);
+
+    sPrefetchStopping = true;
+
+    sPrefetchQueue.clear();
+  }
+
+  sPrefetchCV.notify_all();
+
+  for (size_t i = 0; i < sPrefetchThreads.size(); i++) {
+    sPrefetchThreads[i].join();
+  }
+
+  sPrefetchThreads.clear();
+
+  for (std::map<const char*, PrefetchedFile>::iterator it = sPrefetched.begin();
+       it != sPrefetched.end();
+       ++it) {
+    free(it->second.text);
+  }
+
+  sPrefetched.clear();
+
+  sPrefetchStopping = false;
+}
+
+// Read the rest of 'fp' into a malloc'ed buffer followed by the two NULs
+// that yy_scan_buffer() requires.  Returns NULL if 'fp' is not a regular
+// file or can't be read.
+static char* readWholeFile(FILE* fp, size_t* size) {
+  struct stat st;
+  char*       retval = NULL;
+
+  if (fstat(fileno(fp), &st) == 0 && S_ISREG(st.st_mode)) {
+    size_t len = (size_t) st.st_size;
+
+    retval = (char*) malloc(len + 2);
+
+    if (retval != NULL && fread(retval, 1, len, fp) == len) {
+      retval[len]     = '\0';
+      retval[len + 1] = '\0';
+
+      *size = len;
+
+    } else {
+      free(retval);
+
+      retval = NULL;
+
+      rewind(fp);
+    }
+  }
+
+  return retval;
+}
+
 static bool containsOnlyModules(BlockStmt* block, const char* path) {
   int           moduleDefs     =     0;
   bool          hasUses        = false;
@@ -1183,6 +1183,10 @@ void lowerCheckErrorPrimitive()
       VarSymbol* errorExistsVar = newTemp("errorExists", dtBool);
       DefExpr*   def            = new DefExpr(errorExistsVar);
       CallExpr*  errorExists    = new CallExpr(PRIM_NOTEQUAL, errorVar, gNil);
+
+      // Keep the error handling path out of the way of the normal one.
+      errorExists = new CallExpr(PRIM_UNLIKELY, errorExists);
+
       CallExpr*  move = new CallExpr(PRIM_MOVE, errorExistsVar, errorExists);
 
       Expr* stmt = call->getStmtExpr();
@@ -32,6 +32,7 @@
 
 #include <algorithm>
 #include <queue>
+#include <set>
 
 //
 // insertLineNumbers() inserts line numbers and filenames into
@@ -120,6 +121,23 @@ static ArgSymbol* newFile(FnSymbol* fn) {
   return file;
 }
 
+//
+// Is 'call' a primitive or extern call, whose line and file only go to
+// the runtime?  PRIM_GET_USER_FILE and PRIM_GET_USER_LINE are not: the
+// Chapel code wants the user's line as a value.
+//
+static bool isRuntimeCall(CallExpr* call) {
+  if (call->primitive != NULL) {
+    return call->isPrimitive(PRIM_GET_USER_FILE) == false &&
+           call->isPrimitive(PRIM_GET_USER_LINE) == false;
+
+  } else if (FnSymbol* fn = call->resolvedFunction()) {
+    return fn->hasFlag(FLAG_EXTERN);
+  }
+
+  return false;
+}
+
 //
 // insert a line number and filename actual into a call; add line
 // number and filename formal arguments to the function in which this
@@ -163,6 +181,9 @@ insertLineNumber(CallExpr* call) {
   else if (developer && !fn->hasFlag(FLAG_ALWAYS_PROPAGATE_LINE_FILE_INFO))
     preferASTLine = true; // developer mode generally uses AST line numbers
                           // FLAG_ALWAYS_PROPAGATE_LINE_FILE_INFO overrides
+  else if (fUnwindLineNumbers && lineArg == NULL && isRuntimeCall(call))
+    preferASTLine = true; // the runtime finds the user's line by unwinding
+                          // the stack, so don't add arguments to reach it
 
   if (preferASTLine) {
     // This branch handles the case in which line number
@@ -290,6 +311,160 @@ static void insertNilChecks() {
   }
 }
 
+//
+// Remove a nil check when an earlier check of the same symbol is
+// known to have run with no assignment to the symbol in between.
+//
+// Only function-local symbols whose value can change solely through
+// PRIM_MOVE/PRIM_ASSIGN are considered.  The walk is over the
+// statements of each block in order: a nested block or conditional
+// starts with what is known on entry, a loop body additionally forgets
+// everything assigned anywhere in the loop, and a label forgets
+// everything because it may be reached by a goto.
+//
+typedef std::set<Symbol*> CheckedSet;
+
+static bool isNilCheckCandidate(Symbol* sym, FnSymbol* fn) {
+  if (isVarSymbol(sym) == false && isArgSymbol(sym) == false) {
+    return false;
+  }
+
+  if (sym->defPoint == NULL             ||
+      sym->defPoint->parentSymbol != fn ||
+      sym->isRef()                      ||
+      sym->hasFlag(FLAG_CONCURRENTLY_ACCESSED)) {
+    return false;
+  }
+
+  for_SymbolSymExprs(se, sym) {
+    CallExpr* call = toCallExpr(se->parentExpr);
+
+    if (call == NULL) {
+      continue;
+
+    } else if (call->isPrimitive(PRIM_ADDR_OF) ||
+               call->isPrimitive(PRIM_SET_REFERENCE)) {
+      return false;
+
+    } else if ((call->isPrimitive(PRIM_MOVE) ||
+                call->isPrimitive(PRIM_ASSIGN)) && call->get(1) == se) {
+      continue;
+
+    } else if (isDefAndOrUse(se) & 1) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void collectAssigned(Expr* expr, CheckedSet& assigned) {
+  std::vector<SymExpr*> symExprs;
+
+  collectSymExprs(expr, symExprs);
+
+  for_vector(SymExpr, se, symExprs) {
+    if (CallExpr* call = toCallExpr(se->parentExpr)) {
+      if ((call->isPrimitive(PRIM_MOVE) || call->isPrimitive(PRIM_ASSIGN)) &&
+          call->get(1) == se) {
+        assigned.insert(se->symbol());
+      }
+    }
+  }
+}
+
+static void forgetAssigned(Expr* expr, CheckedSet& checked) {
+  CheckedSet assigned;
+
+  if (checked.empty() == false) {
+    collectAssigned(expr, assigned);
+
+    for (CheckedSet::iterator it = assigned.begin();
+         it != assigned.end();
+         ++it) {
+      checked.erase(*it);
+    }
+  }
+}
+
+static void removeRedundantNilChecks(BlockStmt*        block,
+                                     const CheckedSet& candidates,
+                                     CheckedSet        checked) {
+  for_alist(stmt, block->body) {
+    if (CallExpr* call = toCallExpr(stmt)) {
+      if (call->isPrimitive(PRIM_CHECK_NIL)) {
+        if (SymExpr* se = toSymExpr(call->get(1))) {
+          Symbol* sym = se->symbol();
+
+          if (candidates.count(sym) != 0) {
+            if (checked.count(sym) != 0) {
+              call->remove();
+            } else {
+              checked.insert(sym);
+            }
+          }
+        }
+
+      } else {
+        forgetAssigned(call, checked);
+      }
+
+    } else if (DefExpr* def = toDefExpr(stmt)) {
+      if (isLabelSymbol(def->sym)) {
+        checked.clear();
+      }
+
+    } else if (BlockStmt* inner = toBlockStmt(stmt)) {
+      CheckedSet innerChecked = checked;
+
+      if (inner->isLoopStmt()) {
+        forgetAssigned(inner, innerChecked);
+      }
+
+      removeRedundantNilChecks(inner, candidates, innerChecked);
+
+      forgetAssigned(inner, checked);
+
+    } else if (CondStmt* cond = toCondStmt(stmt)) {
+      forgetAssigned(cond->condExpr, checked);
+
+      removeRedundantNilChecks(cond->thenStmt, candidates, checked);
+
+      if (cond->elseStmt != NULL) {
+        removeRedundantNilChecks(cond->elseStmt, candidates, checked);
+      }
+
+      forgetAssigned(cond, checked);
+
+    } else {
+      forgetAssigned(stmt, checked);
+    }
+  }
+}
+
+static void removeRedundantNilChecks() {
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    std::vector<CallExpr*> calls;
+    CheckedSet             candidates;
+
+    collectCallExprs(fn->body, calls);
+
+    for_vector(CallExpr, call, calls) {
+      if (call->isPrimitive(PRIM_CHECK_NIL)) {
+        if (SymExpr* se = toSymExpr(call->get(1))) {
+          if (isNilCheckCandidate(se->symbol(), fn)) {
+            candidates.insert(se->symbol());
+          }
+        }
+      }
+    }
+
+    if (candidates.empty() == false) {
+      removeRedundantNilChecks(fn->body, candidates, CheckedSet());
+    }
+  }
+}
+
 void insertLineNumbers() {
   compute_call_sites();
 
@@ -314,12 +489,13 @@ void insertLineNumbers() {
 
   if (!fNoNilChecks) {
     insertNilChecks();
+    removeRedundantNilChecks();
   }
 
   // loop over all primitives that require a line number and filename
   // and pass them an actual line number and filename
   forv_Vec(CallExpr, call, gCallExprs) {
-    if (call->primitive && call->primitive->passLineno) {
+    if (call->primitive && call->primitive->passLineno && call->inTree()) {
       insertLineNumber(call);
     }
   }
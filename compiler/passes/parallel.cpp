@@ -145,6 +145,7 @@ static void create_arg_bundle_class(FnSymbol* fn, CallExpr* fcall, ModuleSymbol*
   TypeSymbol* new_c = new TypeSymbol(astr("_class_locals", fn->name), ctype);
   new_c->addFlag(FLAG_NO_OBJECT);
   new_c->addFlag(FLAG_NO_WIDE_CLASS);
+  new_c->addFlag(FLAG_REORDER_FIELDS);
 
   // Add the runtime header field
   if (fn->hasFlag(FLAG_ON)) {
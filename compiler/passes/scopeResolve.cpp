@@ -732,7 +732,8 @@ static void resolveUnresolvedSymExprs() {
   //
 
   forv_Vec(CallExpr, call, gCallExprs) {
-    resolveModuleCall(call);
+    if (call->inTree())
+      resolveModuleCall(call);
   }
 
   forv_Vec(UnresolvedSymExpr, unresolvedSymExpr, gUnresolvedSymExprs) {
@@ -2752,17 +2753,96 @@ static void markUsedModule(std::set<ModuleSymbol*>& set, ModuleSymbol* mod) {
   }
 }
 
+static void markRootModules(std::set<ModuleSymbol*>& set) {
+  markUsedModule(set, stringLiteralModule);
+
+  markUsedModule(set, ModuleSymbol::mainModule());
+
+  if (printModuleInitModule)
+    markUsedModule(set, printModuleInitModule);
+}
+
+static bool isTopLevelModule(ModuleSymbol* mod) {
+  if (mod == theProgram || mod == rootModule || mod->defPoint == NULL)
+    return false;
+
+  ModuleSymbol* parent = mod->defPoint->getModule();
+
+  return parent == theProgram || parent == rootModule;
+}
+
+//
+// An early, conservative version of removeUnusedModules(), run once the
+// use and import statements are resolved so that the rest of scope
+// resolution and normalization only walk modules the program can reach.
+//
+// Qualified references (M.x) only add to modUseList once they are
+// resolved, so a module is also kept if its name appears in any module
+// that is kept.
+//
+static void removeUnreferencedModules() {
+  std::map<const char*, std::vector<ModuleSymbol*> > modulesByName;
+  std::set<ModuleSymbol*>                            usedModules;
+  std::set<ModuleSymbol*>                            scanned;
+  bool                                               changed = true;
+
+  forv_Vec(ModuleSymbol, mod, gModuleSymbols) {
+    modulesByName[mod->name].push_back(mod);
+  }
+
+  markRootModules(usedModules);
+
+  while (changed) {
+    std::vector<ModuleSymbol*> toScan;
+
+    changed = false;
+
+    for_set(ModuleSymbol, mod, usedModules) {
+      if (isTopLevelModule(mod) && scanned.count(mod) == 0)
+        toScan.push_back(mod);
+    }
+
+    for_vector(ModuleSymbol, mod, toScan) {
+      std::vector<BaseAST*> asts;
+
+      scanned.insert(mod);
+
+      collect_asts(mod, asts);
+
+      for_vector(BaseAST, ast, asts) {
+        const char* name = NULL;
+
+        if (UnresolvedSymExpr* urse = toUnresolvedSymExpr(ast)) {
+          name = urse->unresolved;
+        } else if (SymExpr* se = toSymExpr(ast)) {
+          if (isModuleSymbol(se->symbol()))
+            name = se->symbol()->name;
+        }
+
+        if (name != NULL && modulesByName.count(name) != 0) {
+          for_vector(ModuleSymbol, named, modulesByName[name]) {
+            if (usedModules.count(named) == 0) {
+              markUsedModule(usedModules, named);
+              changed = true;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  forv_Vec(ModuleSymbol, mod, gModuleSymbols) {
+    if (usedModules.count(mod) == 0 && mod->defPoint->inTree())
+      mod->defPoint->remove();
+  }
+}
+
 // Figure out if there are any modules that are not used at all.
 // If so, completely remove these modules from the tree.
 static void removeUnusedModules() {
   std::set<ModuleSymbol*> usedModules;
 
-  markUsedModule(usedModules, stringLiteralModule);
-
-  markUsedModule(usedModules, ModuleSymbol::mainModule());
-
-  if (printModuleInitModule)
-    markUsedModule(usedModules, printModuleInitModule);
+  markRootModules(usedModules);
 
   // Now remove any module not in the set
   forv_Vec(ModuleSymbol, mod, gModuleSymbols) {
@@ -2951,6 +3031,8 @@ void scopeResolve() {
 
   processImportExprs();
 
+  removeUnreferencedModules();
+
   enableModuleUsesCache = true;
 
   computeClassHierarchy();
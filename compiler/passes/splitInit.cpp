@@ -838,9 +838,15 @@ static bool doFindCopyElisionPoints(Expr* start,
     // { ... }  (nested block)
     } else if (BlockStmt* block = toBlockStmt(cur)) {
 
+      // An elided on-statement runs its body once, on this task, so it
+      // is treated like a plain block.  Other on-statements and task
+      // constructs have been outlined by now; a value passed to them
+      // with an 'in' intent is copied into a formal temp at the call,
+      // which is handled like any other copy above.
       if (block->isLoopStmt() ||
           (block->isRealBlockStmt() == false &&
-           !block->blockInfoGet()->isPrimitive(PRIM_BLOCK_LOCAL))) {
+           !block->blockInfoGet()->isPrimitive(PRIM_BLOCK_LOCAL) &&
+           !block->blockInfoGet()->isPrimitive(PRIM_BLOCK_ELIDED_ON))) {
         // Loop / on / begin / etc - just check for uses
         Expr* start = block->body.first();
         VariablesSet newEligible;
@@ -38,8 +38,29 @@ SymbolMapCache promotionsCache;
 
 static bool isCacheEntryMatch(SymbolMap* s1, SymbolMap* s2);
 
+uint64_t symbolMapSignature(SymbolMap* map) {
+  uint64_t sig = 0;
+
+  // Sum a mix of each pair, so the order of the pairs doesn't matter.
+  // Pairs mapping to NULL are left out, because isCacheEntryMatch()
+  // treats them the same as missing keys.
+  form_Map(SymbolMapElem, e, *map) {
+    if (e->value == NULL)
+      continue;
+
+    uint64_t h = (uint64_t) (uintptr_t) e->key * 0x9e3779b97f4a7c15ULL
+                 ^ (uint64_t) (uintptr_t) e->value;
+    h ^= h >> 31;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 29;
+    sig += h;
+  }
+
+  return sig;
+}
+
 SymbolMapCacheEntry::SymbolMapCacheEntry(FnSymbol* ifn, SymbolMap* imap) :
-  fn(ifn), map(*imap) { }
+  fn(ifn), map(*imap), sig(symbolMapSignature(imap)) { }
 
 
 void
@@ -64,8 +85,9 @@ addCache(SymbolMapCache& cache,
 FnSymbol*
 checkCache(SymbolMapCache& cache, FnSymbol* oldFn, SymbolMap* map) {
   if (Vec<SymbolMapCacheEntry*>* entries = cache.get(oldFn)) {
+    uint64_t sig = symbolMapSignature(map);
     forv_Vec(SymbolMapCacheEntry, entry, *entries) {
-      if (isCacheEntryMatch(map, &entry->map))
+      if (entry->sig == sig && isCacheEntryMatch(map, &entry->map))
         return entry->fn;
     }
   }
@@ -236,7 +258,7 @@ void genericsCacheSummary(BaseAST* ast) {
 SymbolMapScopeCache genericsCache;
 
 SymbolMapScopeCacheEntry::SymbolMapScopeCacheEntry(FnSymbol* ifn, SymbolMap* imap) :
-  fn(ifn), map(*imap) { }
+  fn(ifn), map(*imap), sig(symbolMapSignature(imap)) { }
 
 void
 addCache(SymbolMapScopeCache& cache,
@@ -265,8 +287,10 @@ checkCache(SymbolMapScopeCache& cache, FnSymbol* oldFn,
            VisibilityInfo* visInfo, SymbolMap* map)
 {
   if (Vec<SymbolMapScopeCacheEntry*>* entries = cache.get(oldFn)) {
+    uint64_t sig = symbolMapSignature(map);
     forv_Vec(SymbolMapScopeCacheEntry, entry, *entries) {
-      if (isCacheEntryMatch(map, &entry->map) &&
+      if (entry->sig == sig &&
+          isCacheEntryMatch(map, &entry->map) &&
           (visInfo == NULL || isApplicableInstantiation(*visInfo, entry->fn)) )
         return entry->fn;
     }
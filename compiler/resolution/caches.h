@@ -28,6 +28,15 @@ class VisibilityInfo;
 class GenericsCacheInfo;
 class ResolutionCandidate;
 
+//
+// symbolMapSignature(map): an order-independent hash of the key-value
+//                          pairs in map.  Maps with the same pairs have
+//                          the same signature, so cache lookups compare
+//                          signatures first and only compare the maps
+//                          themselves when those match.
+//
+uint64_t symbolMapSignature(SymbolMap* map);
+
 //
 // SymbolMapCache: FnSymbol -> FnSymbol cache based on a SymbolMap
 //
@@ -47,6 +56,7 @@ public:
 
   FnSymbol* fn;
   SymbolMap map;
+  uint64_t  sig;   // symbolMapSignature(&map)
 };
 
 typedef Map<FnSymbol*,     Vec<SymbolMapCacheEntry*>*> SymbolMapCache;
@@ -95,6 +105,7 @@ public:
 
   FnSymbol* fn;
   SymbolMap map;
+  uint64_t  sig;   // symbolMapSignature(&map)
 };
 
 typedef Map<FnSymbol*,     Vec<SymbolMapScopeCacheEntry*>*> SymbolMapScopeCache;
@@ -4783,12 +4783,75 @@ static void gatherLastResortCandidates(CallInfo&                  info,
   numVisited = ++idx;
 }
 
+//
+// A quick check that 'fn' has room for the call's actuals and that the
+// call has enough of them for its formals without defaults, mirroring
+// ResolutionCandidate::computeAlignment().  Overloaded names often have
+// hundreds of visible functions, most of which fail here without the
+// cost of building a ResolutionCandidate and tagging, expanding and
+// aligning the function.  Returns true if the full check is needed.
+//
+static bool arityCanMatch(CallInfo& info, FnSymbol* fn) {
+  bool isOperator  = fn->hasFlag(FLAG_OPERATOR);
+  int  numFormals  = 0;
+  int  numRequired = 0;
+  int  numActuals  = 0;
+  bool skipNext    = false;
+
+  if (fn->hasFlag(FLAG_INIT_TUPLE) == true) {
+    return true;
+  }
+
+  for_formals(formal, fn) {
+    bool isMethodFormal = isOperator == true &&
+                          (formal->typeInfo() == dtMethodToken ||
+                           formal->hasFlag(FLAG_ARG_THIS) == true);
+
+    if (formal->variableExpr != NULL) {
+      return true;
+    }
+
+    // Operators skip a method token formal and the one after it, and
+    // need no actual for either.
+    if (skipNext == true) {
+      skipNext = false;
+    } else if (isOperator == true && formal->typeInfo() == dtMethodToken) {
+      skipNext = true;
+    } else {
+      numFormals++;
+    }
+
+    if (formal->defaultExpr == NULL && isMethodFormal == false) {
+      numRequired++;
+    }
+  }
+
+  skipNext = false;
+
+  for (int i = 0; i < info.actuals.n; i++) {
+    if (isOperator == true) {
+      // ... and method token and "this" actuals, unless named.
+      if (info.actualNames.v[i] != NULL) {
+        return true;
+      } else if (skipNext == true) {
+        skipNext = false;
+        continue;
+      } else if (info.actuals.v[i]->typeInfo() == dtMethodToken) {
+        skipNext = true;
+        continue;
+      }
+    }
+
+    numActuals++;
+  }
+
+  return numRequired <= numActuals && numActuals <= numFormals;
+}
+
 static void filterCandidate(CallInfo&                  info,
                             VisibilityInfo&            visInfo,
                             FnSymbol*                  fn,
                             Vec<ResolutionCandidate*>& candidates) {
-  ResolutionCandidate* candidate = new ResolutionCandidate(fn);
-
   if (fExplainVerbose &&
       ((explainCallLine && explainCallMatch(info.call)) ||
        info.call->id == explainCallID)) {
@@ -4799,6 +4862,12 @@ static void filterCandidate(CallInfo&                  info,
     }
   }
 
+  if (arityCanMatch(info, fn) == false) {
+    return;
+  }
+
+  ResolutionCandidate* candidate = new ResolutionCandidate(fn);
+
   if (candidate->isApplicable(info, &visInfo)) {
     candidates.add(candidate);
   } else {
@@ -23,6 +23,7 @@
 #include "astutil.h"
 #include "caches.h"
 #include "chpl.h"
+#include "compileProfile.h"
 #include "driver.h"
 #include "expr.h"
 #include "PartialCopyData.h"
@@ -389,6 +390,9 @@ FnSymbol* instantiateSignature(FnSymbol*  fn,
     } else {
       SET_LINENO(fn);
 
+      CompileProfileEvent profileEvent("instantiate", fn->name,
+                      fCompileProfile ? compileProfileFnDetail(fn) : nullptr);
+
       // copy generic class type if this function is a type constructor
       SymbolMap map;
       FnSymbol* newFn = NULL;
@@ -30,6 +30,10 @@
 #include "visibleFunctions.h"
 #include "view.h" // for debugging
 
+#include <map>
+#include <utility>
+#include <vector>
+
 
 /*********** debugging support ***********/
 
@@ -1489,6 +1493,28 @@ static ImplementsStmt* checkInferredImplStmt(CallExpr* callsite,
   return success ? istm : NULL;
 }
 
+// The outcome of constraintIsSatisfiedAtCallSite() depends only on
+// the interface, the constraint's actual types, and what is visible
+// from the call site. Remember it for each visibility scope so that
+// other call sites in that scope skip the visible function lookup
+// and the matching of the ImplementsStmts.
+typedef std::pair<InterfaceSymbol*, BlockStmt*>        ConsCacheScope;
+typedef std::pair<ConsCacheScope, std::vector<Type*> > ConsCacheKey;
+static std::map<ConsCacheKey, ImplementsStmt*>         constraintCache;
+
+// Returns false if 'call2wf' has an actual that is not a SymExpr.
+static bool buildConsCacheKey(InterfaceSymbol* isym, CallExpr* callsite,
+                              CallExpr* call2wf, ConsCacheKey& key) {
+  key.first = ConsCacheScope(isym, getVisibilityScope(callsite));
+  for_alist(act, call2wf->argList) {
+    SymExpr* se = toSymExpr(act);
+    if (se == NULL)
+      return false;
+    key.second.push_back(se->symbol()->type);
+  }
+  return true;
+}
+
 /*
 constraintIsSatisfiedAtCallSite() checks if 'constraint' is satisfied.
 Return the corresponding ImplementsStmt if yes, NULL if no.
@@ -1512,6 +1538,8 @@ Efficiency:
  * Place the created ImplementsStmt as far out as possible
    so it can be reused in more cases.
    Ex. place it in the innermost scope that defines any functions or has POI.
+- Remember the outcome, successful or not, in 'constraintCache'
+  so that it is computed once per visibility scope.
 */
 ConstraintSat constraintIsSatisfiedAtCallSite(CallExpr*      callsite,
                                               IfcConstraint* constraint,
@@ -1544,6 +1572,18 @@ ConstraintSat constraintIsSatisfiedAtCallSite(CallExpr*      callsite,
   // If semantically allowed, see #16731, we could optimize by breaking out
   // from gatherVisibleWrapperFns once a successful match is found.
 
+  ConsCacheKey key;
+  bool         cacheable = buildConsCacheKey(isym, callsite, call2wf, key);
+
+  if (cacheable) {
+    std::map<ConsCacheKey, ImplementsStmt*>::iterator it =
+      constraintCache.find(key);
+
+    if (it != constraintCache.end() &&
+        (it->second == NULL || it->second->inTree()))
+      return ConstraintSat(it->second, nullptr);
+  }
+
   Vec<FnSymbol*> visibleFns;
   gatherVisibleWrapperFns(callsite, call2wf, visibleFns);
 
@@ -1563,6 +1603,9 @@ ConstraintSat constraintIsSatisfiedAtCallSite(CallExpr*      callsite,
 
   call2wf = nullptr; // call2wf may now be useless
 
+  if (cacheable)
+    constraintCache[key] = bestIstm;
+
   cgprintCheckedConstraint(isym, constraint, callsite, bestIstm,
         pick.conSuccess != nullptr || pick.genSuccess != nullptr);
 
@@ -1205,7 +1205,7 @@ static void handleRecursiveIter(ForallStmt* fs,
 
   PARBlock->insertAtTail(PARBody);
 
-  if (sv2ov.size() > 0)  // actually, the size of a Map is given by sv2ov.i
+  if (sv2ov.count() > 0)
     update_symbols(fs->loopBody(), &sv2ov);
 
   // Transfer the loop body from fs to PARBody.
@@ -1037,7 +1037,8 @@ createArgBundleCopyFn(AggregateType* ct, FnSymbol* loopBodyFnWrapper) {
 static AggregateType*
 bundleLoopBodyFnArgsForIteratorFnCall(CallExpr* iteratorFnCall,
                                       CallExpr* loopBodyFnCall,
-                                      FnSymbol* loopBodyFnWrapper) {
+                                      FnSymbol* loopBodyFnWrapper,
+                                      bool      bundleOnStack) {
   FnSymbol* iteratorFn = iteratorFnCall->resolvedFunction();
   FnSymbol* loopBodyFn = loopBodyFnCall->resolvedFunction();
 
@@ -1057,14 +1058,23 @@ bundleLoopBodyFnArgsForIteratorFnCall(CallExpr* iteratorFnCall,
   rct->fields.insertAtTail(new DefExpr(new VarSymbol("_val", ct)));
   ct->refType = rct;
 
-  // Create the argument bundle.
+  // Create the argument bundle.  It only has to live as long as the
+  // iterator function call, so unless tasks or on-statements in the
+  // iterator might hold on to it, it goes on the stack.  Recursive
+  // iterators create one of these per level.
   // args = (ct*)malloc(sizeof(ct));
   VarSymbol* argBundle = newTemp("argBundle", ct);
   iteratorFnCall->insertBefore(new DefExpr(argBundle));
-  insertChplHereAlloc(iteratorFnCall, false /*insertAfter*/, argBundle,
-                      ct, newMemDesc("bundled args"));
+  if (bundleOnStack) {
+    iteratorFnCall->insertBefore(new CallExpr(PRIM_MOVE, argBundle,
+                                   new CallExpr(PRIM_STACK_ALLOCATE_CLASS,
+                                                ct->symbol)));
+  } else {
+    insertChplHereAlloc(iteratorFnCall, false /*insertAfter*/, argBundle,
+                        ct, newMemDesc("bundled args"));
+    iteratorFnCall->insertAfter(callChplHereFree(argBundle));
+  }
   iteratorFnCall->insertAtTail(argBundle);
-  iteratorFnCall->insertAfter(callChplHereFree(argBundle));
 
   // loopBodyWrapper(int index, ct* fn_args) {
   //   loopBodyFn(index);
@@ -1328,6 +1338,32 @@ static bool fnContainsOn(FnSymbol* fn)
 }
 
 
+// Returns true if the given function starts any tasks, including on
+// statements; false otherwise.
+static bool fnContainsTasks(FnSymbol* fn)
+{
+  std::vector<CallExpr*> calls;
+
+  collectCallExprs(fn, calls);
+
+  for_vector(CallExpr, call, calls) {
+    if (call->isPrimitive(PRIM_BLOCK_ON) ||
+        call->isPrimitive(PRIM_BLOCK_BEGIN) ||
+        call->isPrimitive(PRIM_BLOCK_BEGIN_ON) ||
+        call->isPrimitive(PRIM_BLOCK_COBEGIN) ||
+        call->isPrimitive(PRIM_BLOCK_COBEGIN_ON) ||
+        call->isPrimitive(PRIM_BLOCK_COFORALL) ||
+        call->isPrimitive(PRIM_BLOCK_COFORALL_ON))
+      return true;
+
+    if (resolvedToTaskFun(call))
+      return true;
+  }
+
+  return false;
+}
+
+
 static FnSymbol*
 createIteratorFn(FnSymbol* iterator, CallExpr* iteratorFnCall, Symbol* index,
                  CallExpr* loopBodyFnCall, FnSymbol* loopBodyFnWrapper,
@@ -1343,7 +1379,9 @@ createIteratorFn(FnSymbol* iterator, CallExpr* iteratorFnCall, Symbol* index,
   // Now calls the newly-created iterator function.
   iteratorFnCall->baseExpr->replace(new SymExpr(iteratorFn));
   AggregateType* argsBundleType =
-    bundleLoopBodyFnArgsForIteratorFnCall(iteratorFnCall, loopBodyFnCall, loopBodyFnWrapper);
+    bundleLoopBodyFnArgsForIteratorFnCall(iteratorFnCall, loopBodyFnCall,
+                                          loopBodyFnWrapper,
+                                          !fnContainsTasks(iterator));
 
   iteratorFn->body = iterator->body->copy();
   iterator->defPoint->insertBefore(new DefExpr(iteratorFn));
@@ -1449,7 +1487,9 @@ expandRecursiveIteratorInline(ForLoop* forLoop)
     iteratorFnMap.put(iterator, iteratorFn);
   } else {
     iteratorFnCall->baseExpr->replace(new SymExpr(iteratorFn));
-    bundleLoopBodyFnArgsForIteratorFnCall(iteratorFnCall, loopBodyFnCall, loopBodyFnWrapper);
+    bundleLoopBodyFnArgsForIteratorFnCall(iteratorFnCall, loopBodyFnCall,
+                                          loopBodyFnWrapper,
+                                          !fnContainsTasks(iterator));
 
     Symbol* argBundleTmp = newTemp("argBundleTmp", iteratorFn->getFormal(3)->type);
 
@@ -2355,12 +2395,21 @@ expandForLoop(ForLoop* forLoop) {
   VarSymbol* iterator = toVarSymbol(se2->symbol());
   bool converted = false;
 
-  if (!fNoInlineIterators)
   {
     FnSymbol* iterFn = getTheIteratorFn(iterator->type);
-    if (iterFn->iteratorInfo                          &&
+
+    // Recursive iterators aren't inlined, just turned into a function
+    // that calls the loop body for each yield (see
+    // expandRecursiveIteratorInline()).  That keeps each level's state
+    // in a stack frame instead of an iterator class that re-dispatches
+    // on state at every step, so we do it however many yields there
+    // are, and with --no-inline-iterators.
+    bool recursive = iterFn->hasFlag(FLAG_RECURSIVE_ITERATOR);
+
+    if ((!fNoInlineIterators || recursive)            &&
+        iterFn->iteratorInfo                          &&
         !iterator->type->symbol->hasFlag(FLAG_TUPLE)  &&
-        canInlineIterator(iterFn)                     &&
+        (recursive || canInlineIterator(iterFn))      &&
         ! isVirtualIterator(iterFn)                   ) {
       converted = expandIteratorInline(forLoop);
     }
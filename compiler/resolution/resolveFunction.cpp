@@ -24,6 +24,7 @@
 #include "AstVisitorTraverse.h"
 #include "caches.h"
 #include "CatchStmt.h"
+#include "compileProfile.h"
 #include "CForLoop.h"
 #include "DecoratedClassType.h"
 #include "DeferStmt.h"
@@ -510,6 +511,9 @@ static void resolveAlsoConversions(FnSymbol* fn, CallExpr* forCall);
 
 void resolveFunction(FnSymbol* fn, CallExpr* forCall) {
   if (! fn->isResolved() && ! fn->hasFlag(FLAG_CG_INTERIM_INST)) {
+    CompileProfileEvent profileEvent("resolveFunction", fn->name,
+                      fCompileProfile ? compileProfileFnDetail(fn) : nullptr);
+
     if (fn->id == breakOnResolveID) {
       printf("breaking on resolve fn %s[%d] (%d args)\n",
              fn->name, fn->id, fn->numFormals());
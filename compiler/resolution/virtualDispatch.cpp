@@ -57,6 +57,7 @@ static child type could end up calling something in the parent.
 #include "stmt.h"
 #include "symbol.h"
 
+#include <map>
 #include <set>
 #include <vector>
 
@@ -1283,14 +1284,28 @@ static void checkMethodsOverride() {
 
 static bool wasSuperDot(CallExpr* call);
 
+static void findInstantiatedClasses(std::vector<AggregateType*>& classes);
+
+static bool devirtualizeCall(CallExpr*                          call,
+                             FnSymbol*                          fn,
+                             const std::vector<AggregateType*>& classes);
+
 void insertDynamicDispatchCalls() {
+  std::vector<AggregateType*> classes;
+
+  if (fNoDevirtualize == false) {
+    findInstantiatedClasses(classes);
+  }
+
   forv_Vec(CallExpr, call, gCallExprs) {
     if (call->inTree()) {
       if (FnSymbol* fn = call->resolvedFunction()) {
 
         if (virtualChildrenMap.get(fn) != NULL  &&   // There are overrides
             wasSuperDot(call)          == false &&   // Not super.<foo>()
-            call->isNamed("init")      == false) {   // Not an initializer
+            call->isNamed("init")      == false &&   // Not an initializer
+            (fNoDevirtualize           ==  true ||
+             devirtualizeCall(call, fn, classes) == false)) {
           SET_LINENO(call);
 
           // The variable <cid> must have the same size as the type
@@ -1330,3 +1345,205 @@ static bool wasSuperDot(CallExpr* call) {
 
   return retval;
 }
+
+/************************************* | **************************************
+*                                                                             *
+* Devirtualization by class hierarchy analysis.                               *
+*                                                                             *
+* Every class object gets its cid from a PRIM_SETCID in an initializer, so    *
+* the classes that have a PRIM_SETCID are all the classes that objects can    *
+* have at run time.  For a call whose receiver has static type S, the         *
+* methods it can reach are the virtual method table entries of those classes  *
+* that are subtypes of S.                                                     *
+*                                                                             *
+*   - If that is one method, the call becomes a direct call to it.            *
+*                                                                             *
+*   - If it is two, and one of them is reached from a single class, the call  *
+*     tests for that class and calls its method directly, falling back to     *
+*     the dynamic dispatch otherwise.                                         *
+*                                                                             *
+* Either way the direct calls are ordinary resolved calls, so inlining can    *
+* consider them.                                                              *
+*                                                                             *
+************************************** | *************************************/
+
+static bool      canCallDirectly(FnSymbol* fn, FnSymbol* target);
+
+static void      insertReceiverCast(CallExpr* call,
+                                    Symbol*   thisTmp,
+                                    Expr*     anchor);
+
+static CallExpr* buildDirectCall(CallExpr* call,
+                                 FnSymbol* target,
+                                 Symbol*   thisTmp);
+
+static void findInstantiatedClasses(std::vector<AggregateType*>& classes) {
+  std::set<AggregateType*> seen;
+
+  forv_Vec(CallExpr, call, gCallExprs) {
+    if (call->inTree() && call->isPrimitive(PRIM_SETCID)) {
+      Type* type = canonicalClassType(call->get(1)->getValType());
+
+      if (AggregateType* at = toAggregateType(type)) {
+        if (seen.insert(at).second == true) {
+          classes.push_back(at);
+        }
+      }
+    }
+  }
+}
+
+// Returns true if 'call' was devirtualized, and so must not be turned
+// into a PRIM_VIRTUAL_METHOD_CALL.  If it was guarded, the fallback is
+// 'call' itself, which is left for the caller to convert.
+static bool devirtualizeCall(CallExpr*                          call,
+                             FnSymbol*                          fn,
+                             const std::vector<AggregateType*>& classes) {
+  SymExpr*                 recv  = toSymExpr(call->get(2));
+  MapElem<FnSymbol*, int>* index = virtualMethodMap.get_record(fn);
+  std::vector<FnSymbol*>   targets;
+  std::map<FnSymbol*, std::vector<AggregateType*> > reachedFrom;
+
+  if (recv == NULL || recv->symbol()->isRef() == true || index == NULL) {
+    return false;
+  }
+
+  Type* super = canonicalClassType(recv->getValType());
+
+  for_vector(AggregateType, at, classes) {
+    if (isSubType(at, super) == true) {
+      Vec<FnSymbol*>* vfns = virtualMethodTable.get(at);
+
+      if (vfns == NULL || index->value >= vfns->n) {
+        return false;
+      }
+
+      FnSymbol* target = vfns->v[index->value];
+
+      if (reachedFrom.count(target) == 0) {
+        targets.push_back(target);
+      }
+
+      reachedFrom[target].push_back(at);
+    }
+  }
+
+  if (targets.size() == 1) {
+    FnSymbol* target = targets[0];
+
+    if (target == fn) {
+      return true;
+
+    } else if (canCallDirectly(fn, target) == true) {
+      SET_LINENO(call);
+
+      VarSymbol* thisTmp = newTemp("_devirtualize_this_", target->_this->type);
+
+      insertReceiverCast(call, thisTmp, call->getStmtExpr());
+
+      call->replace(buildDirectCall(call, target, thisTmp));
+
+      return true;
+    }
+
+  } else if (targets.size() == 2) {
+    FnSymbol* target = targets[0];
+    Expr*     stmt   = call->getStmtExpr();
+    CallExpr* move   = toCallExpr(stmt);
+
+    if (reachedFrom[target].size() != 1) {
+      target = targets[1];
+    }
+
+    if (reachedFrom[target].size()  == 1     &&
+        canCallDirectly(fn, target) == true  &&
+        fn->throwsError()           == false &&
+        (stmt == call ||
+         (move != NULL &&
+          (move->isPrimitive(PRIM_MOVE) || move->isPrimitive(PRIM_ASSIGN)) &&
+          move->get(2) == call))) {
+      SET_LINENO(call);
+
+      AggregateType* at       = reachedFrom[target][0];
+      VarSymbol*     isTarget = newTemp("_devirtualize_tmp_", dtBool);
+      VarSymbol*     thisTmp  = newTemp("_devirtualize_this_",
+                                        target->_this->type);
+      BlockStmt*     thenStmt = new BlockStmt();
+      BlockStmt*     elseStmt = new BlockStmt();
+      CallExpr*      direct   = buildDirectCall(call, target, thisTmp);
+
+      if (stmt == call) {
+        thenStmt->insertAtTail(direct);
+      } else {
+        thenStmt->insertAtTail(new CallExpr(move->primitive,
+                                            move->get(1)->copy(),
+                                            direct));
+      }
+
+      insertReceiverCast(call, thisTmp, thenStmt->body.head);
+
+      stmt->insertBefore(new DefExpr(isTarget));
+      stmt->insertBefore(new CallExpr(PRIM_MOVE,
+                                      isTarget,
+                                      new CallExpr(PRIM_TESTCID,
+                                                   recv->copy(),
+                                                   at->symbol)));
+      stmt->insertBefore(new CondStmt(new SymExpr(isTarget),
+                                      thenStmt,
+                                      elseStmt));
+
+      elseStmt->insertAtTail(stmt->remove());
+    }
+  }
+
+  return false;
+}
+
+// Can a call resolved to 'fn' be replaced with a call to its override
+// 'target', casting only the receiver?
+static bool canCallDirectly(FnSymbol* fn, FnSymbol* target) {
+  if (target->retType       != fn->retType       ||
+      target->retTag        != fn->retTag        ||
+      target->throwsError() != fn->throwsError() ||
+      target->numFormals()  != fn->numFormals()  ||
+      target->_this         == NULL              ||
+      target->_this->isRef() == true) {
+    return false;
+  }
+
+  for (int i = 1; i <= fn->numFormals(); i++) {
+    ArgSymbol* formal       = fn->getFormal(i);
+    ArgSymbol* targetFormal = target->getFormal(i);
+
+    if (formal != fn->_this &&
+        (targetFormal->type   != formal->type ||
+         targetFormal->intent != formal->intent)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Define 'thisTmp' before 'anchor' as the receiver of 'call' cast to the
+// type of the temp.
+static void insertReceiverCast(CallExpr* call, Symbol* thisTmp, Expr* anchor) {
+  anchor->insertBefore(new DefExpr(thisTmp));
+  anchor->insertBefore(new CallExpr(PRIM_MOVE,
+                                    thisTmp,
+                                    new CallExpr(PRIM_CAST,
+                                                 thisTmp->type->symbol,
+                                                 call->get(2)->copy())));
+}
+
+// Returns a copy of 'call' that calls 'target' on 'thisTmp'.
+static CallExpr* buildDirectCall(CallExpr* call,
+                                 FnSymbol* target,
+                                 Symbol*   thisTmp) {
+  CallExpr* direct = call->copy();
+
+  direct->baseExpr->replace(new SymExpr(target));
+  direct->get(2)->replace(new SymExpr(thisTmp));
+
+  return direct;
+}
@@ -69,6 +69,37 @@ static Map<BlockStmt*, VisibleFunctionBlock*> visibleFunctionMap;
 
 static int                                    nVisibleFunctions       = 0;
 
+/*
+   Walking the use and import chains from a scope is repeated for every
+   call to a name, which adds up for names with many overloads like '='
+   and '+'.  So the functions found by a walk from a scope are memoized
+   by the scope's id and the name.  Entries for the first POI (visInfo
+   != NULL) and for all POIs (visInfo == NULL) are kept separately.
+
+   An entry is stale once a function with that name has been added to
+   any scope, which visibleFnsNameGen tracks.  A walk is not memoized
+   if it checked whether a private symbol is visible from the call,
+   since the answer depends on where the call is, or if it followed a
+   renaming, since it then depends on more than one name.
+ */
+
+class VisibleFunctionsMemo {
+public:
+  int                                   nameGen;
+  std::vector<FnSymbol*>                fns;
+  std::vector<BlockStmt*>               visitedScopes;
+  BlockStmt*                            nextPOI;
+};
+
+typedef std::pair<int, const char*> VisibleFunctionsMemoKey;
+typedef std::map<VisibleFunctionsMemoKey, VisibleFunctionsMemo>
+                                      VisibleFunctionsMemoMap;
+
+static VisibleFunctionsMemoMap                visibleFnsMemo;
+static VisibleFunctionsMemoMap                visibleFnsMemoAllPOIs;
+static std::map<const char*, int>             visibleFnsNameGen;
+static bool                                   visibleFnsMemoizable    = true;
+
 /************************************* | **************************************
 *                                                                             *
 *                                                                             *
@@ -145,6 +176,13 @@ static void getVisibleMethodsVI(const char*           name,
 
 static void  buildVisibleFunctionMap();
 
+static void getVisibleFunctionsMemoized(const char*           name,
+                                        CallExpr*             call,
+                                        BlockStmt*            block,
+                                        VisibilityInfo*       visInfo,
+                                        std::set<BlockStmt*>& visited,
+                                        Vec<FnSymbol*>&       visibleFns);
+
 static BlockStmt* getVisibilityScopeNoParentModule(Expr* expr);
 
 void getMoreVisibleFunctionsOrMethods(const char*     name,
@@ -195,7 +233,8 @@ void findVisibleFunctions(CallInfo&             info,
       if (visInfo->useMethodVisibility)
         getVisibleMethodsVI(info.name, call, visInfo, visited, visibleFns);
       else
-        getVisibleFunctionsVI(info.name, call, visInfo, visited, visibleFns);
+        getVisibleFunctionsMemoized(info.name, call, visInfo->currStart,
+                                    visInfo, *visited, visibleFns);
 
     } else {
       if (useMethodVisibilityRules(call, info.name))
@@ -256,6 +295,7 @@ static void buildVisibleFunctionMap() {
         vfb->visibleFunctions.put(fn->name, fns);
       }
       fns->add(fn);
+      visibleFnsNameGen[fn->name]++;
     }
   }
   nVisibleFunctions = gFnSymbols.n;
@@ -893,8 +933,72 @@ void getVisibleFunctions(const char*      name,
   BlockStmt*           block    = getVisibilityScope(call);
   std::set<BlockStmt*> visited;
 
-  getVisibleFunctionsImpl(name, call, block, NULL,
+  getVisibleFunctionsMemoized(name, call, block, NULL,
+                              visited, visibleFns);
+}
+
+// Like getVisibleFunctionsImpl() starting at 'block', but reuses the
+// result of an earlier walk from 'block' for 'name' when it can.
+static void getVisibleFunctionsMemoized(const char*           name,
+                                        CallExpr*             call,
+                                        BlockStmt*            block,
+                                        VisibilityInfo*       visInfo,
+                                        std::set<BlockStmt*>& visited,
+                                        Vec<FnSymbol*>&       visibleFns)
+{
+  // Only a walk starting from scratch can be reused.
+  if (!visited.empty() || call->id == breakOnResolveID ||
+      (visInfo != NULL && !visInfo->visitedScopes.empty())) {
+    getVisibleFunctionsImpl(name, call, block, visInfo,
+                            visited, visibleFns, false);
+    return;
+  }
+
+  VisibleFunctionsMemoMap& memo = visInfo ? visibleFnsMemo
+                                          : visibleFnsMemoAllPOIs;
+  VisibleFunctionsMemoKey  key(block->id, name);
+  int                      nameGen = visibleFnsNameGen[name];
+  VisibleFunctionsMemoMap::iterator it = memo.find(key);
+
+  if (it != memo.end() && it->second.nameGen == nameGen) {
+    VisibleFunctionsMemo& entry = it->second;
+
+    for (size_t i = 0; i < entry.fns.size(); i++)
+      visibleFns.add(entry.fns[i]);
+
+    if (visInfo != NULL) {
+      for (size_t i = 0; i < entry.visitedScopes.size(); i++) {
+        visited.insert(entry.visitedScopes[i]);
+        visInfo->visitedScopes.push_back(entry.visitedScopes[i]);
+      }
+      visInfo->nextPOI = entry.nextPOI;
+    }
+
+    return;
+  }
+
+  int start = visibleFns.n;
+
+  visibleFnsMemoizable = true;
+  getVisibleFunctionsImpl(name, call, block, visInfo,
                           visited, visibleFns, false);
+
+  if (visibleFnsMemoizable) {
+    VisibleFunctionsMemo& entry = memo[key];
+
+    entry.nameGen = nameGen;
+    entry.fns.clear();
+    for (int i = start; i < visibleFns.n; i++)
+      entry.fns.push_back(visibleFns.v[i]);
+
+    if (visInfo != NULL) {
+      entry.visitedScopes = visInfo->visitedScopes;
+      entry.nextPOI       = visInfo->nextPOI;
+    } else {
+      entry.visitedScopes.clear();
+      entry.nextPOI       = NULL;
+    }
+  }
 }
 
 static BlockStmt* getVisibleFnsInstantiationPt(BlockStmt* block) {
@@ -974,6 +1078,7 @@ static void getVisibleFnsFirstVisit(const char*       name,
         if (fn->hasFlag(FLAG_PRIVATE)) {
           // Ensure that private functions are not used outside of their
           // proper scope
+          visibleFnsMemoizable = false;
           if (!privacyChecked) {
             // We haven't checked the privacy of a function in this scope yet.
             // Do so now, and remember the result
@@ -1045,8 +1150,12 @@ static void getVisibleFnsFromUseList(const char*      name,
             // The use statement could be of an enum instead of a module,
             // but only modules can define functions.
 
+            if (mod->hasFlag(FLAG_PRIVATE))
+              visibleFnsMemoizable = false;
+
             if (mod->isVisible(call)) {
               if (use->isARenamedSym(name)) {
+                visibleFnsMemoizable = false;
                 getVisibleFunctionsImpl(use->getRenamedSym(name),
                   call, mod->block, visInfo, visited, visibleFns, true);
               } else {
@@ -1068,8 +1177,11 @@ static void getVisibleFnsFromUseList(const char*      name,
           INT_ASSERT(se);
           ModuleSymbol* mod = toModuleSymbol(se->symbol());
           INT_ASSERT(mod);
+          if (mod->hasFlag(FLAG_PRIVATE))
+            visibleFnsMemoizable = false;
           if (mod->isVisible(call)) {
             if (import->isARenamedSym(name)) {
+              visibleFnsMemoizable = false;
               getVisibleFunctionsImpl(import->getRenamedSym(name),
                 call, mod->block, visInfo, visited, visibleFns, true);
             } else {
@@ -1279,6 +1391,10 @@ void visibleFunctionsClear() {
   }
 
   visibleFunctionMap.clear();
+
+  visibleFnsMemo.clear();
+  visibleFnsMemoAllPOIs.clear();
+  visibleFnsNameGen.clear();
 }
 
 /************************************* | **************************************
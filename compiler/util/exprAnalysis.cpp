@@ -238,6 +238,7 @@ bool SafeExprAnalysis::isSafePrimitive(CallExpr* ce) {
     case PRIM_UNARY_PLUS:
     case PRIM_UNARY_NOT:
     case PRIM_UNARY_LNOT:
+    case PRIM_UNLIKELY:
     case PRIM_ADD:
     case PRIM_SUBTRACT:
     case PRIM_MULT:
@@ -285,6 +286,8 @@ bool SafeExprAnalysis::isSafePrimitive(CallExpr* ce) {
     case PRIM_INVARIANT_START:
     case PRIM_NO_ALIAS_SET:
     case PRIM_COPIES_NO_ALIAS_SET:
+    case PRIM_GPU_THREAD_ID:
+    case PRIM_GPU_ON_GPU_SUBLOC:
       return true;
     case PRIM_UNKNOWN:
       if(strcmp(prim->name, "string_length_bytes") == 0 ||
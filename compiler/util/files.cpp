@@ -360,6 +360,60 @@ void closeCFile(fileinfo* fi, bool beautifyIt) {
     beautify(fi);
 }
 
+//
+// For --incremental: write a C file under a temporary name and, on
+// closing it, replace the real file only if the contents changed.  An
+// unchanged file keeps its timestamp, so make will reuse the object
+// file built from it by an earlier compile into the same --savec
+// directory.
+//
+void openCFileIfChanged(fileinfo* fi, const char* name, const char* ext) {
+  openCFile(fi, name, astr(ext, ".tmp"));
+}
+
+static bool sameFileContents(const char* path1, const char* path2) {
+  FILE* f1 = openfile(path1, "r", false);
+  FILE* f2 = openfile(path2, "r", false);
+  bool same = (f1 != NULL && f2 != NULL);
+
+  while (same) {
+    char buf1[4096];
+    char buf2[4096];
+    size_t n1 = fread(buf1, 1, sizeof(buf1), f1);
+    size_t n2 = fread(buf2, 1, sizeof(buf2), f2);
+
+    if (n1 != n2 || memcmp(buf1, buf2, n1) != 0)
+      same = false;
+    else if (n1 == 0)
+      break;
+  }
+
+  if (f1) closefile(f1);
+  if (f2) closefile(f2);
+
+  return same;
+}
+
+bool closeCFileIfChanged(fileinfo* fi, bool beautifyIt) {
+  const char* tmpPath = fi->pathname;
+  const char* path = asubstr(tmpPath, strrchr(tmpPath, '.'));
+  bool changed = true;
+
+  closeCFile(fi, beautifyIt);
+
+  if (sameFileContents(tmpPath, path)) {
+    unlink(tmpPath);
+    changed = false;
+  } else if (rename(tmpPath, path) != 0) {
+    USR_FATAL("renaming %s to %s: %s", tmpPath, path, strerror(errno));
+  }
+
+  fi->filename = asubstr(fi->filename, strrchr(fi->filename, '.'));
+  fi->pathname = path;
+
+  return changed;
+}
+
 fileinfo* openTmpFile(const char* tmpfilename, const char* mode) {
   fileinfo* newfile = (fileinfo*)malloc(sizeof(fileinfo));
 
@@ -641,6 +695,26 @@ static void genCFileBuildRules(FILE* makefile) {
 }
 
 
+// With --incremental, each user module is compiled to its own object.
+// These depend on their C files and the generated header rather than
+// FORCE, so an object whose sources were left unchanged is reused.
+static void genUserObjBuildRules(FILE* makefile,
+                                 const std::vector<const char*>& splitFiles) {
+  if (splitFiles.empty())
+    return;
+
+  const char* header = genIntermediateFilename("chpl__header.h");
+
+  fprintf(makefile, "$(TMPBINNAME): $(CHPLUSEROBJ)\n\n");
+  for (size_t i = 0; i < splitFiles.size(); i++) {
+    fprintf(makefile, "%s: %s.c %s\n", splitFiles[i], splitFiles[i], header);
+    fprintf(makefile,
+            "\t$(CC) $(CHPL_MAKE_BASE_CFLAGS) $(GEN_CFLAGS) $(COMP_GEN_CFLAGS) -c -o $@ $(CHPL_RT_INC_DIR) $<\n");
+    fprintf(makefile, "\n");
+  }
+}
+
+
 static void genObjFiles(FILE* makefile) {
   int filenum = 0;
   int first = 1;
@@ -911,6 +985,7 @@ void codegen_makefile(fileinfo* mainfile, const char** tmpbinname,
   fprintf(makefile.fptr, "%s\n\n", incpath.c_str());
 
   genCFileBuildRules(makefile.fptr);
+  genUserObjBuildRules(makefile.fptr, splitFiles);
   closeCFile(&makefile, false);
 }
 
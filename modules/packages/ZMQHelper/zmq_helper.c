@@ -20,6 +20,8 @@
 
 #include "ZMQHelper/zmq_helper.h"
 
+#include <errno.h>
+
 // Used when the option specified for zmq_getsockopt would modify a char*,
 // due to c_strings in Chapel being const char*.
 int zmq_getsockopt_string_helper(void* s, int option, const char** res) {
@@ -38,3 +40,108 @@ int zmq_getsockopt_int_helper(void* s, int option, int* res) {
   int err = zmq_getsockopt(s, option, res, &intsize);
   return err;
 }
+
+static void zmq_chpl_free_helper(void* data, void* hint) {
+  chpl_free(data);
+}
+
+static int zmq_msg_init_zero_copy(zmq_msg_t* msg, void* data, size_t size,
+                                  zmq_free_fn* ffn, void* hint) {
+  if (ffn == NULL)
+    ffn = zmq_chpl_free_helper;
+  if (zmq_msg_init_data(msg, data, size, ffn, hint) != 0) {
+    // 0MQ never took the buffer, but the caller already gave it up.
+    ffn(data, hint);
+    return -1;
+  }
+  return 0;
+}
+
+int zmq_send_zero_copy_helper(void* s, void* data, size_t size,
+                              zmq_free_fn* ffn, void* hint, int flags) {
+  zmq_msg_t msg;
+  int ret;
+
+  if (zmq_msg_init_zero_copy(&msg, data, size, ffn, hint) != 0)
+    return -1;
+  ret = zmq_msg_send(&msg, s, flags);
+  if (ret < 0) {
+    // On failure the message is still ours; closing it frees the buffer.
+    int err = errno;
+    zmq_msg_close(&msg);
+    errno = err;
+  }
+  return ret;
+}
+
+int64_t zmq_send_multipart_helper(void* s, void** data, size_t* sizes,
+                                  int64_t nparts, zmq_free_fn* ffn,
+                                  void* hint, int flags) {
+  int64_t i;
+
+  for (i = 0; i < nparts; i++) {
+    int partFlags = (i < nparts - 1) ? (flags | ZMQ_SNDMORE) : flags;
+    if (zmq_send_zero_copy_helper(s, data[i], sizes[i],
+                                  ffn, hint, partFlags) < 0) {
+      // The remaining buffers were handed over too, so release them.
+      int err = errno;
+      int64_t j;
+      for (j = i + 1; j < nparts; j++) {
+        if (ffn == NULL)
+          chpl_free(data[j]);
+        else
+          ffn(data[j], hint);
+      }
+      errno = err;
+      return -1;
+    }
+  }
+  return nparts;
+}
+
+int zmq_recv_zero_copy_helper(void* s, void** msg, void** data,
+                              size_t* size, int* more, int flags) {
+  zmq_msg_t* m = (zmq_msg_t*) chpl_malloc(sizeof(zmq_msg_t));
+  int ret;
+
+  zmq_msg_init(m);
+  ret = zmq_msg_recv(m, s, flags);
+  if (ret < 0) {
+    int err = errno;
+    zmq_msg_close(m);
+    chpl_free(m);
+    errno = err;
+    return -1;
+  }
+  *msg = m;
+  *data = zmq_msg_data(m);
+  *size = zmq_msg_size(m);
+  *more = zmq_msg_more(m);
+  return ret;
+}
+
+int64_t zmq_recv_multipart_helper(void* s, void** msgs, void** data,
+                                  size_t* sizes, int64_t maxparts,
+                                  int* more, int flags) {
+  int64_t n = 0;
+
+  *more = 1;
+  while (n < maxparts && *more) {
+    // Later parts of a message are already here, so only the first
+    // receive can block or fail with EAGAIN.
+    if (zmq_recv_zero_copy_helper(s, &msgs[n], &data[n], &sizes[n],
+                                  more, flags) < 0)
+      return (n == 0) ? -1 : n;
+    n++;
+  }
+  if (n == 0)
+    *more = 0;
+  return n;
+}
+
+void zmq_msg_release_helper(void* msg) {
+  if (msg == NULL)
+    return;
+  zmq_msg_close((zmq_msg_t*) msg);
+  chpl_free(msg);
+}
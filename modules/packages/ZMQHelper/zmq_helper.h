@@ -30,4 +30,39 @@
 int zmq_getsockopt_string_helper(void* s, int option, const char** res);
 int zmq_getsockopt_int_helper(void* s, int option, int* res);
 
+// Zero-copy sends.  The socket takes ownership of the data buffer(s),
+// which must not be touched again by the caller, whether or not the
+// send succeeds.  A buffer is released by calling ffn(data, hint) once
+// 0MQ is done with it, which may be on one of 0MQ's own threads; if
+// ffn is NULL, the buffer must have come from chpl_malloc() and is
+// released with chpl_free().
+int zmq_send_zero_copy_helper(void* s, void* data, size_t size,
+                              zmq_free_fn* ffn, void* hint, int flags);
+
+// Sends nparts buffers as the parts of one multipart message, in a
+// single call.  flags apply to every part; ZMQ_SNDMORE is added to all
+// but the last one.  Returns the number of parts sent, or -1 with errno
+// set.
+int64_t zmq_send_multipart_helper(void* s, void** data, size_t* sizes,
+                                  int64_t nparts, zmq_free_fn* ffn,
+                                  void* hint, int flags);
+
+// Zero-copy receive.  On success *msg is set to a message handle and
+// *data and *size to the received bytes, which stay valid until the
+// handle is passed to zmq_msg_release_helper(); *more is set if more
+// parts of the same message follow.  Returns the size, or -1 with errno
+// set (and nothing to release).
+int zmq_recv_zero_copy_helper(void* s, void** msg, void** data,
+                              size_t* size, int* more, int flags);
+
+// Receives up to maxparts parts of one message, as with
+// zmq_recv_zero_copy_helper.  Returns the number of parts received,
+// each of which must be released, or -1 with errno set if the first one
+// could not be received.  *more is set if the message has parts left.
+int64_t zmq_recv_multipart_helper(void* s, void** msgs, void** data,
+                                  size_t* sizes, int64_t maxparts,
+                                  int* more, int flags);
+
+void zmq_msg_release_helper(void* msg);
+
 #endif
@@ -24,6 +24,7 @@
 #include "chpltypes.h"
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 #include <gmp.h>
 
 #include "chpl-comm-compiler-macros.h"
@@ -107,6 +108,98 @@ c_string chpl_gmp_mpz_get_str(int base, mpz_t x) {
   return str;
 }
 
+//
+// Bulk operations over arrays of mpz_t, so that an operation on a whole
+// array crosses into C once rather than once per element.  The arrays
+// are given as a pointer to the first element's mpz_t and the stride in
+// bytes between elements, which lets them be used directly on arrays of
+// records that hold an mpz_t.  All arrays in one call share the stride.
+//
+#define CHPL_GMP_MPZ_ELT(base, stride, i)                            \
+  ((mpz_ptr) ((char*) (base) + (size_t) (i) * (stride)))
+
+static inline
+void chpl_gmp_mpz_add_n(mpz_ptr dst, mpz_srcptr a, mpz_srcptr b,
+                        size_t stride, int64_t n) {
+  int64_t i;
+  for (i = 0; i < n; i++)
+    mpz_add(CHPL_GMP_MPZ_ELT(dst, stride, i),
+            CHPL_GMP_MPZ_ELT(a, stride, i),
+            CHPL_GMP_MPZ_ELT(b, stride, i));
+}
+
+static inline
+void chpl_gmp_mpz_mul_n(mpz_ptr dst, mpz_srcptr a, mpz_srcptr b,
+                        size_t stride, int64_t n) {
+  int64_t i;
+  for (i = 0; i < n; i++)
+    mpz_mul(CHPL_GMP_MPZ_ELT(dst, stride, i),
+            CHPL_GMP_MPZ_ELT(a, stride, i),
+            CHPL_GMP_MPZ_ELT(b, stride, i));
+}
+
+static inline
+void chpl_gmp_mpz_mod_n(mpz_ptr dst, mpz_srcptr a, mpz_srcptr b,
+                        size_t stride, int64_t n) {
+  int64_t i;
+  for (i = 0; i < n; i++)
+    mpz_mod(CHPL_GMP_MPZ_ELT(dst, stride, i),
+            CHPL_GMP_MPZ_ELT(a, stride, i),
+            CHPL_GMP_MPZ_ELT(b, stride, i));
+}
+
+//
+// Packing lets a remote array of mpz_t be moved in one transfer rather
+// than one per element plus one per element's limbs: pack on the
+// locale that owns the values, get the buffer, and unpack.  A packed
+// value is one limb holding its signed size (as in _mp_size) followed
+// by that many limbs, least significant first.
+//
+static inline
+int64_t chpl_gmp_mpz_pack_size(mpz_srcptr src, size_t stride, int64_t n) {
+  int64_t i, nlimbs = n;
+  for (i = 0; i < n; i++)
+    nlimbs += mpz_size(CHPL_GMP_MPZ_ELT(src, stride, i));
+  return nlimbs;
+}
+
+// buf must hold chpl_gmp_mpz_pack_size() limbs; returns the limbs used.
+static inline
+int64_t chpl_gmp_mpz_pack(mp_limb_t* buf, mpz_srcptr src, size_t stride,
+                          int64_t n) {
+  mp_limb_t* p = buf;
+  int64_t i;
+  for (i = 0; i < n; i++) {
+    mpz_srcptr x = CHPL_GMP_MPZ_ELT(src, stride, i);
+    size_t size = mpz_size(x);
+    *p++ = (mp_limb_t) x->_mp_size;
+    memcpy(p, mpz_limbs_read(x), size * sizeof(mp_limb_t));
+    p += size;
+  }
+  return p - buf;
+}
+
+// dst must already be initialized; returns the limbs consumed.
+static inline
+int64_t chpl_gmp_mpz_unpack(mpz_ptr dst, size_t stride, int64_t n,
+                            const mp_limb_t* buf) {
+  const mp_limb_t* p = buf;
+  int64_t i;
+  for (i = 0; i < n; i++) {
+    mpz_ptr x = CHPL_GMP_MPZ_ELT(dst, stride, i);
+    mp_size_t signSize = (mp_size_t) (mp_limb_signed_t) *p++;
+    mp_size_t size = (signSize < 0) ? -signSize : signSize;
+    if (size == 0) {
+      mpz_set_ui(x, 0);
+      continue;
+    }
+    memcpy(mpz_limbs_write(x, size), p, size * sizeof(mp_limb_t));
+    mpz_limbs_finish(x, signSize);
+    p += size;
+  }
+  return p - buf;
+}
+
 //
 // These functions wrap the equivalent GMP macros to support LLVM backend
 //
@@ -38,6 +38,35 @@ void chpl_mli_terminate(enum chpl_mli_errors e);
 int chpl_mli_client_launch(int argc, char** argv);
 void chpl_library_init(int argc, char** argv);
 void chpl_library_finalize(void);
+void chpl_library_batch_begin(void);
+void chpl_library_batch_end(void);
+int chpl_mli_batching(void);
+void chpl_mli_batch_put(const void* data, uint64_t bytes);
+void chpl_mli_batch_call(int64_t id);
+void chpl_mli_batch_flush(void);
+
+// Path of the shared-memory segment we offered the server, if any.
+static char chpl_mli_shm_path[CHPL_MLI_SHM_PATH_MAX];
+static struct chpl_mli_shm_seg* chpl_mli_shm_offered = NULL;
+
+//
+// Batched calls.  Between chpl_library_batch_begin() and the matching
+// chpl_library_batch_end(), calls to exported routines that return
+// nothing don't go to the server one at a time.  Their IDs and
+// arguments are packed into a buffer which is sent in one request when
+// the batch ends, when it grows past CHPL_MLI_BATCH_FLUSH_BYTES, or
+// before any call that returns a value, so calls still run in order.
+//
+#define CHPL_MLI_BATCH_FLUSH_BYTES ((uint64_t) 1 << 20)
+
+struct chpl_mli_batch {
+  int depth;
+  char* buf;
+  uint64_t used;
+  uint64_t cap;
+};
+
+static struct chpl_mli_batch chpl_mli_batch;
 
 //
 // The `mli_free` routine should resolve to a call to `free` on the client
@@ -106,6 +135,130 @@ void chpl_mli_terminate(enum chpl_mli_errors e) {
   mli_terminate();
 }
 
+int chpl_mli_batching(void) {
+  return chpl_mli_batch.depth > 0;
+}
+
+void chpl_mli_batch_put(const void* data, uint64_t bytes) {
+  struct chpl_mli_batch* b = &chpl_mli_batch;
+
+  if (b->used + bytes > b->cap) {
+    uint64_t cap = b->cap ? b->cap : 4096;
+    char* buf = NULL;
+
+    while (cap < b->used + bytes) { cap *= 2; }
+
+    buf = mli_malloc(cap);
+    if (buf == NULL) { chpl_mli_terminate(CHPL_MLI_CODE_EMEMORY); }
+
+    if (b->buf != NULL) {
+      memcpy(buf, b->buf, b->used);
+      mli_free(b->buf);
+    }
+
+    b->buf = buf;
+    b->cap = cap;
+  }
+
+  memcpy(b->buf + b->used, data, bytes);
+  b->used += bytes;
+}
+
+// Start a batched call; its arguments are packed after this.
+void chpl_mli_batch_call(int64_t id) {
+  if (chpl_mli_batch.used >= CHPL_MLI_BATCH_FLUSH_BYTES) {
+    chpl_mli_batch_flush();
+  }
+
+  chpl_mli_batch_put(&id, sizeof(id));
+}
+
+void chpl_mli_batch_flush(void) {
+  struct chpl_mli_batch* b = &chpl_mli_batch;
+  int64_t code = CHPL_MLI_CODE_BATCH;
+  int64_t st = 0;
+  int64_t mem_err = 0;
+
+  if (b->used == 0) { return; }
+
+  chpl_mli_debugf("Sending batch of %llu bytes\n",
+                  (unsigned long long) b->used);
+
+  chpl_mli_push(chpl_client.main, &code, sizeof(code), 0);
+  chpl_mli_pull(chpl_client.main, &st, sizeof(st), 0);
+
+  // Same handshake as for a string: length, allocation ACK, bytes, ACK.
+  chpl_mli_push(chpl_client.arg, &b->used, sizeof(b->used), 0);
+  chpl_mli_pull(chpl_client.arg, &mem_err, sizeof(mem_err), 0);
+  if (mem_err) { chpl_mli_terminate(CHPL_MLI_CODE_EMEMORY); }
+  chpl_mli_push(chpl_client.arg, b->buf, b->used, 0);
+  chpl_mli_pull(chpl_client.arg, ((void*)""), 0, 0);
+
+  b->used = 0;
+}
+
+void chpl_library_batch_begin(void) {
+  chpl_mli_batch.depth++;
+}
+
+void chpl_library_batch_end(void) {
+  if (chpl_mli_batch.depth == 0) { return; }
+  if (--chpl_mli_batch.depth == 0) { chpl_mli_batch_flush(); }
+}
+
+//
+// Create a shared-memory segment for the server to pick up, if it
+// turns out to be on this node.
+//
+static
+void chpl_mli_shm_offer(void) {
+  const char* dir = "/dev/shm";
+  const char* env = getenv("CHPL_RT_MLI_SHM");
+  struct stat st;
+
+  if (env != NULL && (env[0] == '0' || env[0] == 'f' || env[0] == 'F' ||
+                      env[0] == 'n' || env[0] == 'N')) {
+    return;
+  }
+
+  if (stat(dir, &st) != 0 || !S_ISDIR(st.st_mode)) { dir = "/tmp"; }
+
+  snprintf(chpl_mli_shm_path, sizeof(chpl_mli_shm_path),
+           "%s/chpl-mli-%d", dir, (int) getpid());
+
+  chpl_mli_shm_offered = chpl_mli_shm_map(chpl_mli_shm_path, 1);
+  if (chpl_mli_shm_offered == NULL) { return; }
+
+  chpl_mli_shm_offered->magic = CHPL_MLI_SHM_MAGIC;
+  setenv("CHPL_MLI_SHM_PATH", chpl_mli_shm_path, 1);
+}
+
+//
+// The server says whether it mapped the segment; either way the file
+// is no longer needed.
+//
+static
+void chpl_mli_shm_accept(void) {
+  int ok = 0;
+
+  chpl_mli_pull(chpl_client.setup_sock, &ok, sizeof(ok), 0);
+
+  if (chpl_mli_shm_offered == NULL) { return; }
+
+  unlink(chpl_mli_shm_path);
+  unsetenv("CHPL_MLI_SHM_PATH");
+
+  if (ok) {
+    chpl_mli_debugf("Using shared memory %s\n", chpl_mli_shm_path);
+    chpl_mli_shm_activate(chpl_mli_shm_offered, chpl_client.main,
+                          chpl_client.arg, chpl_client.res);
+  } else {
+    chpl_mli_shm_unmap(chpl_mli_shm_offered);
+  }
+
+  chpl_mli_shm_offered = NULL;
+}
+
 //
 // Many of the launchers call `chpl_launch_using_exec`, so we make sure to
 // fork before calling `chpl_launcher_main` to avoid overwriting the client
@@ -159,6 +312,7 @@ void chpl_library_init(int argc, char** argv) {
   char socketFlag[22] = "--chpl-mli-socket-loc";
   argv_plus_sock[argc] = socketFlag;
   argv_plus_sock[argc + 1] = setup_sock_conn;
+  chpl_mli_shm_offer();
   chpl_mli_debugf("Spawning server with %d args\n", argc_plus_sock);
   chpl_mli_client_launch(argc_plus_sock, argv_plus_sock);
   chpl_mli_debugf("Clean up extended %s\n", "argv");
@@ -178,6 +332,8 @@ void chpl_library_init(int argc, char** argv) {
   chpl_mli_connect(chpl_client.arg, arg_conn);
   chpl_mli_connect(chpl_client.res, res_conn);
 
+  chpl_mli_shm_accept();
+
   chpl_mli_debugf("Clean up %s\n", "client port strings");
   mli_free(main_conn);
   mli_free(arg_conn);
@@ -192,6 +348,8 @@ void chpl_library_finalize(void) {
   if (finalized) { return; }
   finalized = 1;
 
+  chpl_mli_batch_flush();
+
   {
     int64_t shutdown = CHPL_MLI_CODE_SHUTDOWN;
     chpl_mli_push(chpl_client.main, &shutdown, sizeof(shutdown), 0);
@@ -203,6 +361,8 @@ void chpl_library_finalize(void) {
 
   // TODO: It would be a good idea to set LINGER to 0 as well.
   // TODO: Maybe move the close connections to deinit?
+  chpl_mli_shm_deactivate();
+
   chpl_mli_close(chpl_client.setup_sock);
   chpl_mli_close(chpl_client.main);
   chpl_mli_close(chpl_client.arg);
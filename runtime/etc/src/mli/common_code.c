@@ -28,6 +28,11 @@
 #include <stdarg.h>
 #include <assert.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <zmq.h>
 
 //
@@ -123,7 +128,8 @@ enum chpl_mli_errors {
   CHPL_MLI_CODE_ENOFUNC   = -3,
   CHPL_MLI_CODE_ESOCKET   = -4,
   CHPL_MLI_CODE_EEXCEPT   = -5,
-  CHPL_MLI_CODE_EMEMORY   = -6
+  CHPL_MLI_CODE_EMEMORY   = -6,
+  CHPL_MLI_CODE_BATCH     = -7
 
 };
 
@@ -137,10 +143,11 @@ const char* chpl_mli_errstr(enum chpl_mli_errors e) {
     "ENOFUNC",
     "ESOCKET",
     "EEXCEPT",
-    "EMEMORY"
+    "EMEMORY",
+    "BATCH"
   };
 
-  if (e > CHPL_MLI_CODE_NONE || e < CHPL_MLI_CODE_EMEMORY) {
+  if (e > CHPL_MLI_CODE_NONE || e < CHPL_MLI_CODE_BATCH) {
     return "INVALID_ERROR_CODE";
   }
 
@@ -227,13 +234,199 @@ void chpl_mli_close(void* socket) {
   zmq_close(socket);
 }
 
+//
+// Shared-memory transport.
+//
+// When the server's locale 0 is on the same node as the client, the
+// client and server map a shared segment holding a pair of byte rings
+// for each of the main, arg and res sockets, and chpl_mli_push/pull
+// use those instead of ZMQ.  Each push becomes a length header and the
+// bytes, so the message boundaries ZMQ gives us are kept.
+//
+// The client creates the segment before launching the server and puts
+// its path in CHPL_MLI_SHM_PATH.  If the server can map it (so it is on
+// the same node), it says so on the setup socket, and both sides switch
+// over.  Setting CHPL_RT_MLI_SHM=false on the client turns this off.
+//
+#define CHPL_MLI_SHM_MAGIC      0x63686d6c69736d31ull
+#define CHPL_MLI_SHM_SOCKETS    3
+#define CHPL_MLI_SHM_RING_SIZE  ((uint64_t) 1 << 20)
+#define CHPL_MLI_SHM_PATH_MAX   64
+
+struct chpl_mli_shm_ring {
+  uint64_t head;                  // bytes read, written by the reader
+  char pad0[56];
+  uint64_t tail;                  // bytes written, written by the writer
+  char pad1[56];
+  char data[CHPL_MLI_SHM_RING_SIZE];
+};
+
+struct chpl_mli_shm_seg {
+  uint64_t magic;
+  char pad[56];
+  // [socket][0] carries client to server, [socket][1] server to client.
+  struct chpl_mli_shm_ring rings[CHPL_MLI_SHM_SOCKETS][2];
+};
+
+static struct chpl_mli_shm_seg* chpl_mli_shm = NULL;
+static void* chpl_mli_shm_sockets[CHPL_MLI_SHM_SOCKETS];
+
+static
+int chpl_mli_shm_index(void* socket) {
+  int i;
+
+  if (chpl_mli_shm == NULL) { return -1; }
+
+  for (i = 0; i < CHPL_MLI_SHM_SOCKETS; i++) {
+    if (chpl_mli_shm_sockets[i] == socket) { return i; }
+  }
+
+  return -1;
+}
+
+static
+void chpl_mli_shm_wait(unsigned* spins) {
+  struct timespec ts = { 0, 20000 };
+
+  if (++(*spins) < 1000) { return; }
+  if (*spins < 2000) { sched_yield(); return; }
+  nanosleep(&ts, NULL);
+}
+
+// Copy bytes into the ring, or out of it into 'buf' (dropping them if
+// 'buf' is NULL), waiting for the other side as needed.
+static
+void chpl_mli_shm_copy(struct chpl_mli_shm_ring* r, void* buf,
+                       uint64_t bytes, int out) {
+  char* p = (char*) buf;
+  unsigned spins = 0;
+
+  while (bytes > 0) {
+    uint64_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    uint64_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+    uint64_t pos = out ? tail : head;
+    uint64_t avail = out ? CHPL_MLI_SHM_RING_SIZE - (tail - head)
+                         : tail - head;
+    uint64_t off = pos % CHPL_MLI_SHM_RING_SIZE;
+    uint64_t n = bytes;
+
+    if (avail == 0) {
+      chpl_mli_shm_wait(&spins);
+      continue;
+    }
+    spins = 0;
+
+    if (n > avail) { n = avail; }
+    if (n > CHPL_MLI_SHM_RING_SIZE - off) { n = CHPL_MLI_SHM_RING_SIZE - off; }
+
+    if (out) {
+      memcpy(&r->data[off], p, n);
+      __atomic_store_n(&r->tail, tail + n, __ATOMIC_RELEASE);
+    } else {
+      if (p != NULL) { memcpy(p, &r->data[off], n); }
+      __atomic_store_n(&r->head, head + n, __ATOMIC_RELEASE);
+    }
+
+    if (p != NULL) { p += n; }
+    bytes -= n;
+  }
+}
+
+static
+struct chpl_mli_shm_ring* chpl_mli_shm_ring(int idx, int out) {
+#ifdef CHPL_MLI_IS_SERVER
+  return &chpl_mli_shm->rings[idx][out ? 1 : 0];
+#else
+  return &chpl_mli_shm->rings[idx][out ? 0 : 1];
+#endif
+}
+
+// Map the segment at 'path', creating it if asked to.
+static
+struct chpl_mli_shm_seg* chpl_mli_shm_map(const char* path, int create) {
+  size_t size = sizeof(struct chpl_mli_shm_seg);
+  void* seg = NULL;
+  struct stat st;
+  int fd = -1;
+
+  fd = create ? open(path, O_RDWR | O_CREAT | O_EXCL, 0600)
+              : open(path, O_RDWR);
+  if (fd < 0) { return NULL; }
+
+  if ((create && ftruncate(fd, size) != 0) ||
+      fstat(fd, &st) != 0 || (size_t) st.st_size != size) {
+    close(fd);
+    if (create) { unlink(path); }
+    return NULL;
+  }
+
+  seg = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (seg == MAP_FAILED) {
+    if (create) { unlink(path); }
+    return NULL;
+  }
+
+  return (struct chpl_mli_shm_seg*) seg;
+}
+
+static
+void chpl_mli_shm_unmap(struct chpl_mli_shm_seg* seg) {
+  munmap((void*) seg, sizeof(struct chpl_mli_shm_seg));
+}
+
+// Start using the segment for the given sockets.
+static
+void chpl_mli_shm_activate(struct chpl_mli_shm_seg* seg, void* main,
+                           void* arg, void* res) {
+  chpl_mli_shm_sockets[0] = main;
+  chpl_mli_shm_sockets[1] = arg;
+  chpl_mli_shm_sockets[2] = res;
+  chpl_mli_shm = seg;
+}
+
+static
+void chpl_mli_shm_deactivate(void) {
+  if (chpl_mli_shm == NULL) { return; }
+  chpl_mli_shm_unmap(chpl_mli_shm);
+  chpl_mli_shm = NULL;
+}
+
 static
 int chpl_mli_push(void* socket, void* buffer, size_t bytes, int flags) {
+  int idx = chpl_mli_shm_index(socket);
+
+  if (idx >= 0) {
+    struct chpl_mli_shm_ring* r = chpl_mli_shm_ring(idx, 1);
+    uint64_t len = bytes;
+    chpl_mli_shm_copy(r, &len, sizeof(len), 1);
+    chpl_mli_shm_copy(r, buffer, len, 1);
+    return (int) bytes;
+  }
+
   return zmq_send(socket, buffer, bytes, flags);  
 }
 
+//
+// Like zmq_recv(), returns the size of the message, which may be more
+// than the 'bytes' that were stored.
+//
 static
 int chpl_mli_pull(void* socket, void* buffer, size_t bytes, int flags) {
+  int idx = chpl_mli_shm_index(socket);
+
+  if (idx >= 0) {
+    struct chpl_mli_shm_ring* r = chpl_mli_shm_ring(idx, 0);
+    uint64_t len = 0;
+    uint64_t n = 0;
+    chpl_mli_shm_copy(r, &len, sizeof(len), 0);
+    n = len < bytes ? len : bytes;
+    chpl_mli_shm_copy(r, buffer, n, 0);
+    chpl_mli_shm_copy(r, NULL, len - n, 0);
+    return (int) len;
+  }
+
   return zmq_recv(socket, buffer, bytes, flags);
 }
 
@@ -30,9 +30,10 @@ void chpl_mli_terminate(enum chpl_mli_errors e);
 void chpl_mli_smain(const char* setup_conn);
 
 //
-// The definition of this is generated by the compiler.
+// The definitions of these are generated by the compiler.
 //
 int64_t chpl_mli_sdispatch(int64_t id);
+int64_t chpl_mli_sbatch_dispatch(int64_t id, const char** cur);
 
 //
 // Contains sockets.
@@ -76,6 +77,71 @@ void chpl_mli_terminate(enum chpl_mli_errors e) {
   mli_terminate();
 }
 
+//
+// Map the client's shared-memory segment if it offered one and it is on
+// this node, and tell the client whether we did.
+//
+static
+void chpl_mli_shm_reply(void) {
+  const char* path = getenv("CHPL_MLI_SHM_PATH");
+  struct chpl_mli_shm_seg* seg = NULL;
+  int ok = 0;
+
+  if (path != NULL) {
+    seg = chpl_mli_shm_map(path, 0);
+    if (seg != NULL && seg->magic != CHPL_MLI_SHM_MAGIC) {
+      chpl_mli_shm_unmap(seg);
+      seg = NULL;
+    }
+  }
+
+  ok = (seg != NULL);
+  chpl_mli_debugf("Shared memory transport: %d\n", ok);
+  chpl_mli_push(chpl_server.setup_sock, &ok, sizeof(ok), 0);
+
+  if (ok) {
+    chpl_mli_shm_activate(seg, chpl_server.main, chpl_server.arg,
+                          chpl_server.res);
+  }
+}
+
+//
+// Run a batch of calls (see client_runtime.c).  Each entry is a function
+// ID followed by its packed arguments.
+//
+static
+void chpl_mli_sbatch(void) {
+  uint64_t bytes = 0;
+  int64_t mem_err = 0;
+  char* buffer = NULL;
+  const char* cur = NULL;
+
+  chpl_mli_pull(chpl_server.arg, &bytes, sizeof(bytes), 0);
+  buffer = mli_malloc(bytes);
+  mem_err = (buffer == NULL);
+  chpl_mli_push(chpl_server.arg, &mem_err, sizeof(mem_err), 0);
+  if (mem_err) { chpl_mli_terminate(CHPL_MLI_CODE_EMEMORY); }
+  chpl_mli_pull(chpl_server.arg, buffer, bytes, 0);
+  chpl_mli_push(chpl_server.arg, ((void*)""), 0, 0);
+
+  cur = buffer;
+
+  while (cur < buffer + bytes) {
+    int64_t id = 0;
+
+    memcpy(&id, cur, sizeof(id));
+    cur += sizeof(id);
+
+    chpl_mli_debugf("Batched request for ID: %lld\n", (long long) id);
+
+    if (chpl_mli_sbatch_dispatch(id, &cur) == CHPL_MLI_CODE_ENOFUNC) {
+      chpl_mli_terminate(CHPL_MLI_CODE_ENOFUNC);
+    }
+  }
+
+  mli_free(buffer);
+}
+
 void chpl_mli_smain(const char* setup_conn) {
   int64_t id = -1;
   int64_t ack = 0;
@@ -109,6 +175,7 @@ void chpl_mli_smain(const char* setup_conn) {
   chpl_mli_push_connection(main_conn);
   chpl_mli_push_connection(arg_conn);
   chpl_mli_push_connection(res_conn);
+  chpl_mli_shm_reply();
 
   chpl_mli_debugf("%s\n", "Clean up obtained connection strings");
   mli_free(main_conn);
@@ -132,7 +199,10 @@ void chpl_mli_smain(const char* setup_conn) {
       ack = CHPL_MLI_CODE_ESOCKET;
     }
 
-    if (id < 0) {
+    if (id == CHPL_MLI_CODE_BATCH) {
+      chpl_mli_debugf("%s\n", "Received batch");
+      ack = CHPL_MLI_CODE_NONE;
+    } else if (id < 0) {
       chpl_mli_debugf("Client sent code: %s\n", chpl_mli_errstr(id));
       ack = CHPL_MLI_CODE_SHUTDOWN;
       execute = 0;
@@ -147,13 +217,19 @@ void chpl_mli_smain(const char* setup_conn) {
     if (err < 0) { chpl_mli_debugf("Socket error on write: %d\n", err); }
 
     // TODO: This ack value is currently just overwritten...
-    if (execute && id > 0) { ack = chpl_mli_sdispatch(id); }
+    if (execute && id == CHPL_MLI_CODE_BATCH) {
+      chpl_mli_sbatch();
+    } else if (execute && id > 0) {
+      ack = chpl_mli_sdispatch(id);
+    }
   }
 
   chpl_mli_debugf("Shutdown, code: %s\n", chpl_mli_errstr(id));
 
   seconds = (double) (clock() - before) / (double) CLOCKS_PER_SEC;
 
+  chpl_mli_shm_deactivate();
+
   chpl_mli_close(chpl_server.setup_sock);
   chpl_mli_close(chpl_server.main);
   chpl_mli_close(chpl_server.arg);
@@ -28,6 +28,7 @@ extern "C" {
 // This is the type of the task private data used by the cache
 typedef struct {
   int64_t last_acquire; // cache acquire barrier sets this
+  void* cache;          // this task's own cache, if caches follow tasks
 } chpl_cache_taskPrvData_t;
 
 #ifdef __cplusplus
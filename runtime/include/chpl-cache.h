@@ -60,9 +60,6 @@ void chpl_cache_warn_if_disabled(void)
     if (CHPL_ASAN) {
       chpl_warning("Disabling --cache-remote due to incompatibility with "
                    "AddressSanitizer (quiet with CHPL_RT_CACHE_QUIET=true)", 0, 0);
-    } else if (chpl_task_canMigrateThreads()) {
-      chpl_warning("Disabling --cache-remote because tasks can migrate "
-                   "threads (quiet with CHPL_RT_CACHE_QUIET=true)", 0, 0);
     }
   }
 }
@@ -70,10 +67,10 @@ void chpl_cache_warn_if_disabled(void)
 static inline
 int chpl_cache_enabled(void)
 {
-  // The remote cache is not compatible with ASan, and it uses thread local
-  // storage, so if tasks can migrate between threads we lose our ability to
-  // correctly fence.
-  return CHPL_CACHE_REMOTE && !CHPL_ASAN && !chpl_task_canMigrateThreads();
+  // The remote cache is not compatible with ASan.  If tasks can migrate
+  // between threads, the cache follows the task instead of the thread
+  // (see chpl_cache_task_end).
+  return CHPL_CACHE_REMOTE && !CHPL_ASAN;
 }
 #undef CHPL_ASAN
 
@@ -82,6 +79,11 @@ int chpl_cache_enabled(void)
 void chpl_cache_init(void);
 void chpl_cache_exit(void);
 
+// Called by the tasking layer when a task ends.  If tasks can migrate
+// between threads, each task has its own cache, and this flushes and
+// frees it.
+void chpl_cache_task_end(void);
+
 // If release is set, waits on any pending puts in the cache.
 // If acquire is set, sets this task's last acquire fence to 
 // the cache's current request number.
@@ -105,10 +107,25 @@ void chpl_cache_release(int ln, int32_t fn)
 // calling on a put or a get.
 void chpl_cache_comm_put(void* addr, c_nodeid_t node, void* raddr,
                          size_t size, int32_t commID, int ln, int32_t fn);
+// If nontemporal is set, the caller expects to read the data only once,
+// so it is moved straight into addr without taking up room in the cache.
+// Dirty data for the region that is still in the cache is written back
+// first, and the region is invalidated, so the get observes it.
 void chpl_cache_comm_get(void *addr, c_nodeid_t node, void* raddr,
-                         size_t size, int32_t commID, int ln, int32_t fn);
+                         size_t size, int nontemporal,
+                         int32_t commID, int ln, int32_t fn);
 void chpl_cache_comm_prefetch(c_nodeid_t node, void* raddr,
                               size_t size, int32_t commID, int ln, int32_t fn);
+// Start prefetches into the cache for a batch of remote regions (region
+// i is size_v[i] bytes at raddr_v[i] on node_v[i]) and return a handle.
+// Passing the handle to chpl_cache_comm_wait_prefetch waits until the
+// prefetched data has arrived, without waiting for any cache operations
+// started after the batch.  A handle of 0 means there is nothing to wait
+// for.  Handles are only meaningful to the task that created them.
+int64_t chpl_cache_comm_prefetch_v(int v_len, c_nodeid_t* node_v,
+                                   void** raddr_v, size_t* size_v,
+                                   int32_t commID, int ln, int32_t fn);
+void chpl_cache_comm_wait_prefetch(int64_t handle);
 void  chpl_cache_comm_get_strd(
                    void *addr, void *dststr, c_nodeid_t node, void *raddr,
                    void *srcstr, void *count, int32_t strlevels,
@@ -119,8 +136,11 @@ void  chpl_cache_comm_put_strd(
                       size_t elemSize, int32_t commID, int ln, int32_t fn);
 void chpl_cache_comm_put_unordered(void* addr, c_nodeid_t node, void* raddr,
                                    size_t size, int32_t commID, int ln, int32_t fn);
+// Unordered gets never allocate cache entries, so nontemporal has no
+// effect on them today; it is accepted to match chpl_cache_comm_get.
 void chpl_cache_comm_get_unordered(void *addr, c_nodeid_t node, void* raddr,
-                                   size_t size, int32_t commID, int ln, int32_t fn);
+                                   size_t size, int nontemporal,
+                                   int32_t commID, int ln, int32_t fn);
 void chpl_cache_comm_getput_unordered(c_nodeid_t dstnode, void* dstaddr,
                                       c_nodeid_t srcnode, void* srcaddr,
                                       size_t size, int32_t commID,
@@ -131,6 +151,8 @@ void chpl_cache_comm_getput_unordered_task_fence(void);
 void chpl_cache_print(void);
 void chpl_cache_assert_released(void);
 void chpl_cache_print_stats(void);
+// Print the top call sites from CHPL_RT_CACHE_SITE_STATS, if it is set.
+void chpl_cache_print_site_stats(void);
 // just stores 0s in the cache; here to exercise the data structures
 // returns 1 if the data was cached
 int chpl_cache_mock_get(c_nodeid_t node, uint64_t raddr, size_t size);
@@ -55,7 +55,25 @@ void chpl_gen_comm_get(void *addr, c_nodeid_t node, void* raddr,
     chpl_memmove(addr, raddr, size);
 #ifdef HAS_CHPL_CACHE_FNS
   } else if( chpl_cache_enabled() ) {
-    chpl_cache_comm_get(addr, node, raddr, size, commID, ln, fn);
+    chpl_cache_comm_get(addr, node, raddr, size, 0, commID, ln, fn);
+#endif
+  } else {
+    chpl_comm_get(addr, node, raddr, size, commID, ln, fn);
+  }
+}
+
+// Like chpl_gen_comm_get, but for data that will only be read once
+// (e.g. by a single-pass loop), which should not displace cached data.
+static inline
+void chpl_gen_comm_get_nontemporal(void *addr, c_nodeid_t node, void* raddr,
+                                   size_t size, int32_t commID, int ln,
+                                   int32_t fn)
+{
+  if (chpl_nodeID == node) {
+    chpl_memmove(addr, raddr, size);
+#ifdef HAS_CHPL_CACHE_FNS
+  } else if( chpl_cache_enabled() ) {
+    chpl_cache_comm_get(addr, node, raddr, size, 1, commID, ln, fn);
 #endif
   } else {
     chpl_comm_get(addr, node, raddr, size, commID, ln, fn);
@@ -87,6 +105,39 @@ void chpl_gen_comm_prefetch(c_nodeid_t node, void* raddr,
   }
 }
 
+// Prefetch a batch of (possibly remote) regions, returning a handle to
+// pass to chpl_gen_comm_wait_prefetch once the data is needed.
+static inline
+int64_t chpl_gen_comm_prefetch_v(int v_len, c_nodeid_t* node_v,
+                                 void** raddr_v, size_t* size_v,
+                                 int32_t commID, int ln, int32_t fn)
+{
+  for (int i = 0; i < v_len; i++) {
+    if (node_v[i] == chpl_nodeID)
+      chpl_gen_comm_prefetch(node_v[i], raddr_v[i], size_v[i],
+                             commID, ln, fn);
+  }
+#ifdef HAS_CHPL_CACHE_FNS
+  if( chpl_cache_enabled() ) {
+    // (the cache skips the local regions)
+    return chpl_cache_comm_prefetch_v(v_len, node_v, raddr_v, size_v,
+                                      commID, ln, fn);
+  }
+#endif
+  // Can't do anything else if we don't have a remote data cache.
+  return 0;
+}
+
+static inline
+void chpl_gen_comm_wait_prefetch(int64_t handle)
+{
+#ifdef HAS_CHPL_CACHE_FNS
+  if( chpl_cache_enabled() && handle != 0 ) {
+    chpl_cache_comm_wait_prefetch(handle);
+  }
+#endif
+}
+
 
 static inline
 void chpl_gen_comm_put(void* addr, c_nodeid_t node, void* raddr,
@@ -141,7 +192,22 @@ void chpl_gen_comm_get_unordered(void *addr, c_nodeid_t node, void* raddr,
   if (0) {
 #ifdef HAS_CHPL_CACHE_FNS
   } else if( chpl_cache_enabled() ) {
-    chpl_cache_comm_get_unordered(addr, node, raddr, size, commID, ln, fn);
+    chpl_cache_comm_get_unordered(addr, node, raddr, size, 0, commID, ln, fn);
+#endif
+  } else {
+    chpl_comm_get_unordered(addr, node, raddr, size, commID, ln, fn);
+  }
+}
+
+static inline
+void chpl_gen_comm_get_unordered_nontemporal(void *addr, c_nodeid_t node,
+                                             void* raddr, size_t size,
+                                             int32_t commID, int ln, int32_t fn)
+{
+  if (0) {
+#ifdef HAS_CHPL_CACHE_FNS
+  } else if( chpl_cache_enabled() ) {
+    chpl_cache_comm_get_unordered(addr, node, raddr, size, 1, commID, ln, fn);
 #endif
   } else {
     chpl_comm_get_unordered(addr, node, raddr, size, commID, ln, fn);
@@ -23,9 +23,13 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 
 #include "chpl-atomics.h"
 #include "chpl-comm.h"
+#include "chpl-thread-local-storage.h"
+#include "chpltimers.h"
 #include "error.h"
 
 #ifdef __cplusplus
@@ -58,13 +62,46 @@ extern int chpl_comm_diags_print_unstable;
   MACRO(cache_get_hits) \
   MACRO(cache_get_misses) \
   MACRO(cache_put_hits) \
-  MACRO(cache_put_misses)
+  MACRO(cache_put_misses) \
+  MACRO(cache_strided_readahead_hits) \
+  MACRO(comm_dom_acquires) \
+  MACRO(comm_dom_wait_nsecs)
 
+//
+// For these we also keep the total bytes moved and a histogram of
+// transfer sizes.  Size bin i counts transfers of [2**i, 2**(i+1))
+// bytes, with everything bigger in the last bin.
+//
+#define CHPL_COMM_DIAGS_XFER_VARS_ALL(MACRO) \
+  MACRO(get) \
+  MACRO(get_nb) \
+  MACRO(put) \
+  MACRO(put_nb)
+
+//
+// For these we keep a histogram of latencies, binned the same way but
+// in nanoseconds.  Only blocking operations are timed.
+//
+#define CHPL_COMM_DIAGS_LAT_VARS_ALL(MACRO) \
+  MACRO(get) \
+  MACRO(put) \
+  MACRO(execute_on)
+
+#define CHPL_COMM_DIAGS_HIST_BINS 32
 
 typedef struct _chpl_commDiagnostics {
 #define _COMM_DIAGS_DECL(cdv) uint64_t cdv;
   CHPL_COMM_DIAGS_VARS_ALL(_COMM_DIAGS_DECL)
 #undef _COMM_DIAGS_DECL
+#define _COMM_DIAGS_DECL_XFER(cdv)                    \
+  uint64_t cdv ## _bytes;                             \
+  uint64_t cdv ## _size_hist[CHPL_COMM_DIAGS_HIST_BINS];
+  CHPL_COMM_DIAGS_XFER_VARS_ALL(_COMM_DIAGS_DECL_XFER)
+#undef _COMM_DIAGS_DECL_XFER
+#define _COMM_DIAGS_DECL_LAT(cdv)                     \
+  uint64_t cdv ## _lat_hist[CHPL_COMM_DIAGS_HIST_BINS];
+  CHPL_COMM_DIAGS_LAT_VARS_ALL(_COMM_DIAGS_DECL_LAT)
+#undef _COMM_DIAGS_DECL_LAT
 } chpl_commDiagnostics;
 
 void chpl_comm_startVerbose(chpl_bool, chpl_bool);
@@ -79,43 +116,135 @@ void chpl_comm_stopDiagnosticsHere(void);
 void chpl_comm_resetDiagnosticsHere(void);
 void chpl_comm_getDiagnosticsHere(chpl_commDiagnostics *cd);
 
+//
+// If CHPL_RT_COMM_DIAGS_COUNTS_FILE is set, count communication over the
+// user program on every locale and have each write its counts to
+// "<file>.<node id>" at exit, one "<counter> <value>" per line.  The
+// start call is made from the pre-user-code hook, the report call from
+// the exit path once all locales are done with user code.
+//
+void chpl_comm_diags_counts_start(void);
+void chpl_comm_diags_counts_report(void);
+
 
 ////////////////////
 //
 // Private
 //
+
+//
+// The counters are sharded, with each thread bumping the ones in its
+// own cache-line-aligned slot and readers summing over all the slots.
+// This keeps diagnostics from bouncing cache lines between cores on
+// nodes with many threads.  If there are more threads than slots some
+// will share, which is still correct, just slower.
+//
+#define CHPL_COMM_DIAGS_SHARDS 128
+#define CHPL_COMM_DIAGS_ALIGN 64
+
 typedef struct _chpl_atomic_commDiagnostics {
 #define _COMM_DIAGS_DECL_ATOMIC(cdv) atomic_uint_least64_t cdv;
   CHPL_COMM_DIAGS_VARS_ALL(_COMM_DIAGS_DECL_ATOMIC)
 #undef _COMM_DIAGS_DECL_ATOMIC
-} chpl_atomic_commDiagnostics;
+#define _COMM_DIAGS_DECL_ATOMIC_XFER(cdv)                       \
+  atomic_uint_least64_t cdv ## _bytes;                          \
+  atomic_uint_least64_t cdv ## _size_hist[CHPL_COMM_DIAGS_HIST_BINS];
+  CHPL_COMM_DIAGS_XFER_VARS_ALL(_COMM_DIAGS_DECL_ATOMIC_XFER)
+#undef _COMM_DIAGS_DECL_ATOMIC_XFER
+#define _COMM_DIAGS_DECL_ATOMIC_LAT(cdv)                        \
+  atomic_uint_least64_t cdv ## _lat_hist[CHPL_COMM_DIAGS_HIST_BINS];
+  CHPL_COMM_DIAGS_LAT_VARS_ALL(_COMM_DIAGS_DECL_ATOMIC_LAT)
+#undef _COMM_DIAGS_DECL_ATOMIC_LAT
+} __attribute__((aligned(CHPL_COMM_DIAGS_ALIGN)))
+  chpl_atomic_commDiagnostics;
 
-extern chpl_atomic_commDiagnostics chpl_comm_diags_counters;
+extern chpl_atomic_commDiagnostics
+       chpl_comm_diags_counters[CHPL_COMM_DIAGS_SHARDS];
 extern atomic_int_least16_t chpl_comm_diags_disable_flag;
 
+int chpl_comm_diags_new_shard(void);
+
+#ifdef CHPL_TLS
+extern CHPL_TLS int chpl_comm_diags_my_shard;
+#endif
+
+static inline
+chpl_atomic_commDiagnostics* chpl_comm_diags_shard(void) {
+#ifdef CHPL_TLS
+  if (chpl_comm_diags_my_shard < 0) {
+    chpl_comm_diags_my_shard = chpl_comm_diags_new_shard();
+  }
+  return &chpl_comm_diags_counters[chpl_comm_diags_my_shard];
+#else
+  uintptr_t self = (uintptr_t) pthread_self();
+  return &chpl_comm_diags_counters[((self >> 12) ^ self)
+                                   % CHPL_COMM_DIAGS_SHARDS];
+#endif
+}
+
+#define _COMM_DIAGS_HIST_EACH(cdv, what)                                \
+        for (int _bin = 0; _bin < CHPL_COMM_DIAGS_HIST_BINS; _bin++) {  \
+          what(cdv[_bin]);                                              \
+        }
+
 static inline
 void chpl_comm_diags_init(void) {
+  for (int _s = 0; _s < CHPL_COMM_DIAGS_SHARDS; _s++) {
 #define _COMM_DIAGS_INIT(cdv) \
-        atomic_init_uint_least64_t(&chpl_comm_diags_counters.cdv, 0);
+        atomic_init_uint_least64_t(&chpl_comm_diags_counters[_s].cdv, 0);
   CHPL_COMM_DIAGS_VARS_ALL(_COMM_DIAGS_INIT);
+#define _COMM_DIAGS_INIT_XFER(cdv)                                      \
+        _COMM_DIAGS_INIT(cdv ## _bytes)                                 \
+        _COMM_DIAGS_HIST_EACH(cdv ## _size_hist, _COMM_DIAGS_INIT)
+  CHPL_COMM_DIAGS_XFER_VARS_ALL(_COMM_DIAGS_INIT_XFER);
+#undef _COMM_DIAGS_INIT_XFER
+#define _COMM_DIAGS_INIT_LAT(cdv)                                       \
+        _COMM_DIAGS_HIST_EACH(cdv ## _lat_hist, _COMM_DIAGS_INIT)
+  CHPL_COMM_DIAGS_LAT_VARS_ALL(_COMM_DIAGS_INIT_LAT);
+#undef _COMM_DIAGS_INIT_LAT
 #undef _COMM_DIAGS_INIT
+  }
   atomic_init_int_least16_t(&chpl_comm_diags_disable_flag, 0);
 }
 
 static inline
 void chpl_comm_diags_reset(void) {
+  for (int _s = 0; _s < CHPL_COMM_DIAGS_SHARDS; _s++) {
 #define _COMM_DIAGS_RESET(cdv) \
-        atomic_store_uint_least64_t(&chpl_comm_diags_counters.cdv, 0);
- CHPL_COMM_DIAGS_VARS_ALL(_COMM_DIAGS_RESET);
+        atomic_store_uint_least64_t(&chpl_comm_diags_counters[_s].cdv, 0);
+  CHPL_COMM_DIAGS_VARS_ALL(_COMM_DIAGS_RESET);
+#define _COMM_DIAGS_RESET_XFER(cdv)                                     \
+        _COMM_DIAGS_RESET(cdv ## _bytes)                                \
+        _COMM_DIAGS_HIST_EACH(cdv ## _size_hist, _COMM_DIAGS_RESET)
+  CHPL_COMM_DIAGS_XFER_VARS_ALL(_COMM_DIAGS_RESET_XFER);
+#undef _COMM_DIAGS_RESET_XFER
+#define _COMM_DIAGS_RESET_LAT(cdv)                                      \
+        _COMM_DIAGS_HIST_EACH(cdv ## _lat_hist, _COMM_DIAGS_RESET)
+  CHPL_COMM_DIAGS_LAT_VARS_ALL(_COMM_DIAGS_RESET_LAT);
+#undef _COMM_DIAGS_RESET_LAT
 #undef _COMM_DIAGS_RESET
+  }
 }
 
 static inline
 void chpl_comm_diags_copy(chpl_commDiagnostics* cd) {
-#define _COMM_DIAGS_COPY(cdv) \
-        cd->cdv = atomic_load_uint_least64_t(&chpl_comm_diags_counters.cdv);
+  memset(cd, 0, sizeof(*cd));
+  for (int _s = 0; _s < CHPL_COMM_DIAGS_SHARDS; _s++) {
+#define _COMM_DIAGS_COPY(cdv)                                           \
+        cd->cdv +=                                                      \
+          atomic_load_uint_least64_t(&chpl_comm_diags_counters[_s].cdv);
   CHPL_COMM_DIAGS_VARS_ALL(_COMM_DIAGS_COPY);
+#define _COMM_DIAGS_COPY_XFER(cdv)                                      \
+        _COMM_DIAGS_COPY(cdv ## _bytes)                                 \
+        _COMM_DIAGS_HIST_EACH(cdv ## _size_hist, _COMM_DIAGS_COPY)
+  CHPL_COMM_DIAGS_XFER_VARS_ALL(_COMM_DIAGS_COPY_XFER);
+#undef _COMM_DIAGS_COPY_XFER
+#define _COMM_DIAGS_COPY_LAT(cdv)                                       \
+        _COMM_DIAGS_HIST_EACH(cdv ## _lat_hist, _COMM_DIAGS_COPY)
+  CHPL_COMM_DIAGS_LAT_VARS_ALL(_COMM_DIAGS_COPY_LAT);
+#undef _COMM_DIAGS_COPY_LAT
 #undef _COMM_DIAGS_COPY
+  }
 }
 
 static inline
@@ -179,11 +308,68 @@ int chpl_comm_diags_is_enabled(void) {
                                   + ((strlen(kind) == 0) ? 0 : 1)),     \
                                  kind, (int) node)
 
-#define chpl_comm_diags_incr(_ctr)                                           \
+#define chpl_comm_diags_incr(_ctr) chpl_comm_diags_add(_ctr, 1)
+
+static inline
+int chpl_comm_diags_hist_bin(uint64_t val) {
+  int bin = (val == 0) ? 0 : 63 - __builtin_clzll(val);
+  return (bin < CHPL_COMM_DIAGS_HIST_BINS) ? bin : CHPL_COMM_DIAGS_HIST_BINS - 1;
+}
+
+//
+// Count a transfer of one of the CHPL_COMM_DIAGS_XFER_VARS_ALL kinds,
+// along with its size.
+//
+#define chpl_comm_diags_xfer(_ctr, _size)                                    \
+  do {                                                                       \
+    if (chpl_comm_diagnostics && chpl_comm_diags_is_enabled()) {             \
+      chpl_atomic_commDiagnostics* _cds = chpl_comm_diags_shard();           \
+      uint64_t _sz = (_size);                                                \
+      int _bin = chpl_comm_diags_hist_bin(_sz);                              \
+      (void) atomic_fetch_add_explicit_uint_least64_t(                       \
+               &_cds->_ctr, 1, memory_order_relaxed);                        \
+      (void) atomic_fetch_add_explicit_uint_least64_t(                       \
+               &_cds->_ctr ## _bytes, _sz, memory_order_relaxed);            \
+      (void) atomic_fetch_add_explicit_uint_least64_t(                       \
+               &_cds->_ctr ## _size_hist[_bin], 1, memory_order_relaxed);    \
+    }                                                                        \
+  } while(0)
+
+//
+// Time one of the CHPL_COMM_DIAGS_LAT_VARS_ALL kinds of operation.
+// The clock is only read when diagnostics are on, so this costs one
+// branch otherwise:
+//   uint64_t t = chpl_comm_diags_lat_start();
+//   ... do the operation ...
+//   chpl_comm_diags_lat_end(get, t);
+//
+static inline
+uint64_t chpl_comm_diags_lat_start(void) {
+  if (!(chpl_comm_diagnostics && chpl_comm_diags_is_enabled()))
+    return 0;
+  return chpl_timer_ticks();
+}
+
+#define chpl_comm_diags_lat_end(_ctr, _start)                                \
+  do {                                                                       \
+    uint64_t _t0 = (_start);                                                 \
+    if (_t0 != 0) {                                                          \
+      uint64_t _lat = chpl_comm_diags_lat_start();                           \
+      if (_lat != 0) {                                                       \
+        _lat = (_lat > _t0) ? chpl_timer_ticks_to_ns(_lat - _t0) : 0;       \
+        (void) atomic_fetch_add_explicit_uint_least64_t(                     \
+                 &chpl_comm_diags_shard()->_ctr ## _lat_hist                 \
+                   [chpl_comm_diags_hist_bin(_lat)],                         \
+                 1, memory_order_relaxed);                                   \
+      }                                                                      \
+    }                                                                        \
+  } while(0)
+
+#define chpl_comm_diags_add(_ctr, _val)                                      \
   do {                                                                       \
     if (chpl_comm_diagnostics && chpl_comm_diags_is_enabled()) {             \
-      atomic_uint_least64_t* ctrAddr = &chpl_comm_diags_counters._ctr;       \
-      (void) atomic_fetch_add_explicit_uint_least64_t(ctrAddr, 1,            \
+      atomic_uint_least64_t* ctrAddr = &chpl_comm_diags_shard()->_ctr;       \
+      (void) atomic_fetch_add_explicit_uint_least64_t(ctrAddr, (_val),       \
                                                       memory_order_relaxed); \
     }                                                                        \
   } while(0)
@@ -49,12 +49,26 @@ extern void** chpl_rt_priv_bcast_tab;
 extern int chpl_rt_priv_bcast_tab_len;
 extern size_t chpl_rt_priv_bcast_lens[];
 
+//
+// This is node 0's table of the other nodes' buffer addresses during
+// a tree broadcast of the global variables (see chpl-comm.c).
+//
+extern void** chpl_comm_bcast_addr_tab;
+
+//
+// This is node 0's table of all the nodes' startup phase times while
+// they are being gathered (see chpl-init-timeline.c).
+//
+extern double* chpl_init_timeline_tab;
+
 #define CHPL_RT_PRV_BCAST_TAB_ENTRIES(MACRO) \
   MACRO(chpl_verbose_comm)                   \
   MACRO(chpl_comm_diagnostics)               \
   MACRO(chpl_comm_diags_print_unstable)      \
   MACRO(chpl_verbose_comm_stacktrace)        \
-  MACRO(chpl_verbose_mem)
+  MACRO(chpl_verbose_mem)                    \
+  MACRO(chpl_comm_bcast_addr_tab)            \
+  MACRO(chpl_init_timeline_tab)
 
 #define _RT_PRV_BCAST_M(sym)  chpl_rt_prv_tab_ ## sym ## _idx,
 typedef enum {
@@ -68,6 +82,57 @@ typedef enum {
 //
 void chpl_comm_init_prv_bcast_tab(void);
 
+//
+// Broadcast trees.  Collective broadcasts rooted at node 0 move their
+// data down a tree with this fan-out, so that no node serves more than
+// that many others.  It is set by CHPL_RT_COMM_BCAST_FANOUT.  0 means
+// the root serves everyone directly.
+//
+int chpl_comm_bcast_fanout(void);
+
+static inline
+c_nodeid_t chpl_comm_bcast_tree_parent(c_nodeid_t node, int fanout) {
+  return (node - 1) / fanout;
+}
+
+static inline
+int chpl_comm_bcast_tree_depth(c_nodeid_t node, int fanout) {
+  int depth;
+  for (depth = 0; node > 0; depth++) {
+    node = chpl_comm_bcast_tree_parent(node, fanout);
+  }
+  return depth;
+}
+
+//
+// Remote allocation (see chpl_comm_remote_alloc() in chpl-comm.h).
+// Comm layers must supply these; neither is called for our own node.
+// chpl_comm_impl_remote_alloc() gets 'n' blocks of 'size' bytes, where
+// 0 < n <= CHPL_COMM_REMOTE_ALLOC_MAX, from 'node''s memory layer in
+// one round trip and stores their addresses in ptrs[], which can be
+// anywhere in our memory.  chpl_comm_impl_remote_free() frees a block
+// on 'node' and needn't wait for that to happen.
+//
+#define CHPL_COMM_REMOTE_ALLOC_MAX 32
+
+void chpl_comm_impl_remote_alloc(c_nodeid_t node, size_t size, size_t n,
+                                 void** ptrs);
+void chpl_comm_impl_remote_free(c_nodeid_t node, void* p);
+
+//
+// Native collectives (see chpl_comm_allreduce() in chpl-comm.h).  Comm
+// layers that define CHPL_COMM_IMPL_COLLECTIVES supply these.  They
+// return true if they did the operation, or false to have the shared
+// code do it instead, which they have to decide the same way on every
+// node.
+//
+#ifdef CHPL_COMM_IMPL_COLLECTIVES
+chpl_bool chpl_comm_impl_allreduce(void* buf, size_t count,
+                                   chpl_comm_coll_type_t type,
+                                   chpl_comm_coll_op_t op);
+chpl_bool chpl_comm_impl_bcast(void* buf, size_t size, c_nodeid_t root);
+#endif
+
 //
 // Broadcast one of our runtime-specific variables.
 //
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_comm_trace_h_
+#define _chpl_comm_trace_h_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Binary communication tracing.
+//
+// This is a low-overhead alternative to verbose comm.  Instead of a
+// line of text per operation, each thread collects fixed-size records
+// in a buffer of its own, and full buffers are written out with
+// pwritev() to one file per node.  The files are named
+// <fileroot>.<nodeID>, and node 0 also writes <fileroot>.files, which
+// maps the filename indices in the records to names.  The traces are
+// meant to be analyzed offline with $CHPL_HOME/tools/chpl-comm-trace.
+//
+// Tracing is started and stopped per node.  Setting CHPL_RT_COMM_TRACE
+// to a file root traces the whole run on all nodes.
+//
+
+#define CHPL_COMM_TRACE_MAGIC   "CHPLCTRC"
+#define CHPL_COMM_TRACE_VERSION 1
+
+//
+// Each trace file starts with this header, followed by records.  All
+// fields are in the native byte order of the node that wrote them.
+//
+typedef struct {
+  char magic[8];          // CHPL_COMM_TRACE_MAGIC, not NUL-terminated
+  uint32_t version;       // CHPL_COMM_TRACE_VERSION
+  uint32_t rec_size;      // sizeof(chpl_comm_trace_rec_t)
+  int32_t node;           // the node that wrote this file
+  int32_t num_nodes;
+  uint64_t start_ns;      // CLOCK_REALTIME when tracing started
+} chpl_comm_trace_hdr_t;
+
+//
+// One record per communication operation, as seen by the initiator.
+//
+typedef struct {
+  uint64_t time_ns;       // CLOCK_REALTIME when the operation started
+  uint64_t size;          // bytes moved, or argument size for executeOns
+  int32_t remote_node;    // the other node; the initiator is the file's
+  int32_t lineno;         // source line of communication
+  int32_t filename;       // source file index of communication
+  uint8_t kind;           // a chpl_comm_cb_event_kind_t
+  uint8_t pad[3];
+} chpl_comm_trace_rec_t;
+
+void chpl_comm_trace_init(void);
+void chpl_comm_trace_start(const char* fileroot);
+void chpl_comm_trace_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -138,6 +138,20 @@ chpl_comm_nb_handle_t chpl_comm_put_nb(void *addr, c_nodeid_t node, void* raddr,
                                        size_t size, int32_t commID,
                                        int ln, int32_t fn);
 
+// Do a vector of PUTs, all to the same node, in a nonblocking fashion,
+// returning a single handle which can be used to wait for all of them
+// to complete.  Element i copies size_v[i] bytes from addr_v[i] to
+// raddr_v[i] on the node.  The regions must not overlap.  As with
+// chpl_comm_put_nb(), none of the source buffers may be modified before
+// the request completes.  Comm layers that can do so should issue the
+// PUTs as a single chained/batched network operation.  Comm layers
+// without nonblocking handles may complete all of the PUTs before
+// returning, and return NULL.
+chpl_comm_nb_handle_t chpl_comm_put_nb_v(int v_len, void** addr_v,
+                                         c_nodeid_t node, void** raddr_v,
+                                         size_t* size_v, int32_t commID,
+                                         int ln, int32_t fn);
+
 // Returns nonzero iff the handle has already been waited for and has
 // been cleared out in a call to chpl_comm_{wait,try}_some.
 // This function must not call chpl_task_yield.
@@ -240,7 +254,22 @@ void chpl_comm_rollcall(void);
 // chpl_comm_regMemHeapTouch():
 //   For configurations that use a static/fixed heap, this attempts to
 //   touch the heap in an interleaved and parallel manner to improve
-//   NUMA affinity and speed up faulting in the memory.
+//   NUMA affinity and speed up faulting in the memory.  The touching
+//   threads are bound to cores in each NUMA domain.  Setting
+//   CHPL_RT_COMM_HEAP_TOUCH_POLICY=block gives each domain one
+//   contiguous block instead of interleaving, and
+//   CHPL_RT_COMM_HEAP_TOUCH_REPORT reports how long the touch took.
+//
+// chpl_comm_regMemHeapTouchParts():
+//   Like chpl_comm_regMemHeapTouch(), but for a heap split into
+//   contiguous per-NUMA-domain parts: each part is touched in parallel
+//   from threads on its own domain.
+//
+// chpl_comm_regMemHeapNumaParts():
+//   If the initial registered heap has been split into contiguous
+//   parts, one per NUMA domain in sublocale order and each localized
+//   to its domain, this returns the number of parts and sets the size
+//   of each.  Otherwise it returns 0.
 //
 // chpl_comm_regMemAllocThreshold():
 //   Allocations smaller than this should be done normally, by the
@@ -267,6 +296,19 @@ void chpl_comm_rollcall(void);
 //   perhaps not performance-optimal, to first try to free it here, and
 //   only free it elsewhere if this function returns false.
 //
+// chpl_comm_regMemRegister()
+//   Register memory that did not come from chpl_comm_regMemAlloc(),
+//   such as a buffer owned by a C or Python library, so that it can be
+//   the source or target of RMA without going through a bounce buffer.
+//   Returns true if the memory was registered, in which case it must
+//   be passed to chpl_comm_regMemDeregister() before it is freed, or
+//   false if the comm layer could not or need not register it.
+//
+// chpl_comm_regMemDeregister()
+//   Undo a chpl_comm_regMemRegister() that returned true, given the
+//   same address and size.  There must be no RMA to or from the memory
+//   in flight.
+//
 #ifndef CHPL_COMM_IMPL_REG_MEM_HEAP_INFO
 #define CHPL_COMM_IMPL_REG_MEM_HEAP_INFO(start_p, size_p)   \
         do { *(start_p) = NULL ; *(size_p) = 0; } while (0)
@@ -285,6 +327,16 @@ size_t chpl_comm_regMemHeapPageSize(void) {
 }
 
 void chpl_comm_regMemHeapTouch(void* start, size_t size);
+void chpl_comm_regMemHeapTouchParts(void* start, int nparts, size_t partSize);
+
+#ifndef CHPL_COMM_IMPL_REG_MEM_HEAP_NUMA_PARTS
+#define CHPL_COMM_IMPL_REG_MEM_HEAP_NUMA_PARTS(partSize_p) \
+        (*(partSize_p) = 0, 0)
+#endif
+static inline
+int chpl_comm_regMemHeapNumaParts(size_t* partSize_p) {
+  return CHPL_COMM_IMPL_REG_MEM_HEAP_NUMA_PARTS(partSize_p);
+}
 
 #ifndef CHPL_COMM_IMPL_REG_MEM_ALLOC_THRESHOLD
   #define CHPL_COMM_IMPL_REG_MEM_ALLOC_THRESHOLD() SIZE_MAX
@@ -338,6 +390,22 @@ chpl_bool chpl_comm_regMemFree(void* p, size_t size) {
   return CHPL_COMM_IMPL_REG_MEM_FREE(p, size);
 }
 
+#ifndef CHPL_COMM_IMPL_REG_MEM_REGISTER
+#define CHPL_COMM_IMPL_REG_MEM_REGISTER(p, size) false
+#endif
+static inline
+chpl_bool chpl_comm_regMemRegister(void* p, size_t size) {
+  return CHPL_COMM_IMPL_REG_MEM_REGISTER(p, size);
+}
+
+#ifndef CHPL_COMM_IMPL_REG_MEM_DEREGISTER
+#define CHPL_COMM_IMPL_REG_MEM_DEREGISTER(p, size) return
+#endif
+static inline
+void chpl_comm_regMemDeregister(void* p, size_t size) {
+  CHPL_COMM_IMPL_REG_MEM_DEREGISTER(p, size);
+}
+
 //
 // These routines are used by the Chapel runtime to broadcast the
 // locations of module-level ("global") variables to all locales
@@ -519,6 +587,95 @@ void chpl_comm_execute_on_fast(c_nodeid_t node, c_sublocid_t subloc,
                                chpl_comm_on_bundle_t *arg, size_t arg_size,
                                int ln, int32_t fn);
 
+//
+// non-blocking fast execute_on (i.e., run in handler, don't wait)
+// arg can be reused immediately after this call completes.
+// Comm layers that can't do this get a regular non-blocking
+// execute_on instead, which has the same semantics.
+//
+#ifdef CHPL_COMM_IMPL_EXECUTE_ON_FAST_NB
+void chpl_comm_execute_on_fast_nb(c_nodeid_t node, c_sublocid_t subloc,
+                                  chpl_fn_int_t fid,
+                                  chpl_comm_on_bundle_t *arg, size_t arg_size,
+                                  int ln, int32_t fn);
+#else
+static inline
+void chpl_comm_execute_on_fast_nb(c_nodeid_t node, c_sublocid_t subloc,
+                                  chpl_fn_int_t fid,
+                                  chpl_comm_on_bundle_t *arg, size_t arg_size,
+                                  int ln, int32_t fn) {
+  chpl_comm_execute_on_nb(node, subloc, fid, arg, arg_size, ln, fn);
+}
+#endif
+
+//
+// Remote allocation.  These allocate and free memory in another node's
+// heap (with its memory layer) without an 'on' statement: the target's
+// AM handler does the work, with no task spawned there.  The returned
+// addresses are only meaningful on 'node'.
+//
+// Small requests are satisfied from a pool of blocks that each node
+// keeps for each other one and refills in batches, so most of them
+// don't communicate at all.  The _batch() form gets 'n' blocks of
+// 'size' bytes each, in as few round trips as the comm layer allows.
+// Blocks from any of these are freed with chpl_comm_remote_free(),
+// which doesn't wait.
+//
+void* chpl_comm_remote_alloc(c_nodeid_t node, size_t size,
+                             int ln, int32_t fn);
+void chpl_comm_remote_alloc_batch(c_nodeid_t node, size_t size,
+                                  size_t n, void** ptrs,
+                                  int ln, int32_t fn);
+void chpl_comm_remote_free(c_nodeid_t node, void* p, int ln, int32_t fn);
+
+// Called at startup, after chpl_comm_post_task_init().
+void chpl_comm_remote_alloc_init(void);
+
+//
+// Collective operations.  Every node must call each of these, from
+// one task at a time and in the same order as the other nodes, with
+// the same type, op, count, size and root.  They return once this
+// node's part is done; other nodes may still be finishing theirs.
+//
+// chpl_comm_allreduce() combines the 'count' elements of 'buf' with
+// the corresponding elements on all the other nodes, in place.  The
+// result is the same on every node, bit for bit, even for reals.
+// chpl_comm_allgather() puts the 'size' bytes at 'src' from each node
+// n at dst[n * size] on every node.  chpl_comm_bcast() copies the
+// 'size' bytes at 'buf' on 'root' to 'buf' on all the other nodes.
+//
+// Comm layers with native collectives do them that way; otherwise they
+// are done with PUTs, by recursive doubling (allreduce), a binomial
+// tree (bcast) and Bruck's algorithm (allgather).  The buffers can be
+// anywhere in memory.
+//
+typedef enum {
+  chpl_comm_coll_int32,
+  chpl_comm_coll_int64,
+  chpl_comm_coll_uint32,
+  chpl_comm_coll_uint64,
+  chpl_comm_coll_real32,
+  chpl_comm_coll_real64,
+} chpl_comm_coll_type_t;
+
+typedef enum {
+  chpl_comm_coll_sum,
+  chpl_comm_coll_prod,
+  chpl_comm_coll_min,
+  chpl_comm_coll_max,
+  chpl_comm_coll_band,          // bitwise ops are for integral types
+  chpl_comm_coll_bor,
+  chpl_comm_coll_bxor,
+} chpl_comm_coll_op_t;
+
+void chpl_comm_allreduce(void* buf, size_t count,
+                         chpl_comm_coll_type_t type, chpl_comm_coll_op_t op);
+void chpl_comm_allgather(const void* src, void* dst, size_t size);
+void chpl_comm_bcast(void* buf, size_t size, c_nodeid_t root);
+
+// Called at startup, after chpl_comm_remote_alloc_init().
+void chpl_comm_coll_init(void);
+
 //
 // Hook to ensure remote memory consistency after unordered operations.
 //
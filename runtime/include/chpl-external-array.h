@@ -43,6 +43,12 @@ chpl_external_array chpl_make_external_array_ptr(void* elts,
                                                  uint64_t num_elts);
 chpl_external_array chpl_make_external_array_ptr_free(void* elts,
                                                       uint64_t num_elts);
+chpl_external_array chpl_make_external_array_ptr_reg(void* elts,
+                                                     uint64_t elt_size,
+                                                     uint64_t num_elts);
+chpl_external_array chpl_make_external_array_ptr_free_reg(void* elts,
+                                                          uint64_t elt_size,
+                                                          uint64_t num_elts);
 void chpl_free_external_array(chpl_external_array x);
 void chpl_call_free_func(void* func, void* elts);
 
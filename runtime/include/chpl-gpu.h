@@ -0,0 +1,81 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_gpu_h_
+#define _chpl_gpu_h_
+
+#ifndef LAUNCHER
+
+#include <stddef.h>
+#include <stdint.h>
+#include "chpltypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef HAS_GPU_LOCALE
+
+//
+// GPU support for the gpu locale model.  Each GPU on a node is one of
+// its sublocales: sublocale i is device i, and the node's CPUs are the
+// locale itself (c_sublocid_any).  The compiler outlines eligible
+// order-independent loops into kernels (see outlineGpuKernels()) and
+// launches them with chpl_gpu_launch_kernel() when the task is running
+// on a GPU sublocale.  The kernels are loaded from the fatbinary the
+// compiler embeds in the program, chpl_gpuBinary.
+//
+// Arrays allocated for a GPU sublocale get managed memory, so both the
+// device and the host can get to their elements.
+//
+
+void chpl_gpu_init(void);
+
+int chpl_gpu_num_devices(void);
+
+static inline
+chpl_bool chpl_gpu_subloc_is_device(c_sublocid_t subloc) {
+  return isActualSublocID(subloc) && subloc < chpl_gpu_num_devices();
+}
+
+chpl_bool chpl_gpu_running_on_gpu_subloc(void);
+
+//
+// Launch the kernel with the given name on the current task's GPU, with
+// one thread per index in [lo, hi], and wait for it to finish.  The
+// varargs are nargs pointers to the kernel's arguments after lo and hi.
+//
+void chpl_gpu_launch_kernel(int ln, int32_t fn, const char* name,
+                            int64_t lo, int64_t hi, int nargs, ...);
+
+void* chpl_gpu_mem_alloc(size_t size, c_sublocid_t subloc,
+                         int32_t lineno, int32_t filename);
+chpl_bool chpl_gpu_is_device_ptr(void* p);
+void chpl_gpu_mem_free(void* p, int32_t lineno, int32_t filename);
+
+#endif // HAS_GPU_LOCALE
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LAUNCHER
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_init_timeline_h_
+#define _chpl_init_timeline_h_
+
+//
+// Startup timeline.
+//
+// Each node records when it finishes each phase of runtime startup.
+// If CHPL_RT_INIT_TIMELINE is set to true, node 0 gathers those times
+// once module initialization is done and prints the minimum, median,
+// and maximum time for each phase across the nodes, along with the
+// node that was slowest.  Setting it to "json" prints the same thing
+// as a JSON object.  Times are in seconds.
+//
+
+#include "chpltypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// The phases, in the order they happen.  Each one runs from the end
+// of the one before it (or from the start of chpl_rt_init(), for the
+// first) to the point where it is marked.
+//
+#define CHPL_INIT_PHASES(m)                                            \
+  m(ARGS_ENV,       "early args and error init")                       \
+  m(TOPO,           "topology init")                                   \
+  m(COMM,           "comm init")                                       \
+  m(MEM,            "memory init")                                     \
+  m(COMM_POST_MEM,  "comm post-mem init (heap registration)")          \
+  m(COMM_BARRIER,   "comm init barrier")                               \
+  m(ARGS,           "config vars and args")                            \
+  m(TASK,           "tasking init")                                    \
+  m(COMM_POST_TASK, "comm post-task init and cache init")              \
+  m(ROLLCALL,       "comm rollcall")                                   \
+  m(MAIN_BARRIER,   "barrier before main")                             \
+  m(MODULE_INIT,    "module init")
+
+#define _CHPL_INIT_PHASE_M(sym, name) chpl_init_phase_ ## sym,
+typedef enum {
+  CHPL_INIT_PHASES(_CHPL_INIT_PHASE_M)
+  chpl_init_num_phases
+} chpl_init_phase_t;
+#undef _CHPL_INIT_PHASE_M
+
+void chpl_init_timeline_start(void);
+void chpl_init_timeline_mark(chpl_init_phase_t phase);
+
+//
+// Gathers and prints the timeline, if it was asked for.  This must be
+// called collectively, after the comm layer is fully up.
+//
+void chpl_init_timeline_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
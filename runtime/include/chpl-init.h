@@ -41,6 +41,13 @@ void chpl_execute_module_deinit(c_fn_ptr deinitFun);
 void chpl_library_init(int argc, char* argv[]);
 void chpl_library_finalize(void);
 
+// Calls made between these to exported routines that return nothing
+// may be sent to a multi-locale library's server together.  Batches
+// nest; the calls go out by the outermost end at the latest.  In a
+// single-locale library calls are direct and these do nothing.
+void chpl_library_batch_begin(void);
+void chpl_library_batch_end(void);
+
 void chpl_std_module_init(void);
 
 #ifdef __cplusplus
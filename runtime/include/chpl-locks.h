@@ -0,0 +1,254 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_locks_h_
+#define _chpl_locks_h_
+
+#include <stdint.h>
+#include "chpltypes.h"
+#include "chpl-atomics.h"
+#include "chpl-sync-wait.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Queue-based locks for runtime-internal data structures.
+//
+// With a test-and-set lock (atomic_spinlock_t) every waiter keeps
+// hitting the same cache line, so under heavy contention the line
+// bounces between cores and even the owner's release gets slow.  The
+// locks here hand off in FIFO order and keep waiters out of each
+// other's way:
+//
+//   chpl_ticket_lock_t: a waiter takes a ticket and watches the "now
+//     serving" count, backing off in proportion to how many waiters
+//     are ahead of it.  It is small, so it suits locks embedded in
+//     many objects.
+//
+//   chpl_mcs_lock_t: waiters form a queue and each one spins on a flag
+//     in its own queue node, so a release touches only the next
+//     waiter's line.  The caller provides the node, usually on its
+//     stack, and passes the same one to lock and unlock.
+//
+// As with atomic_spinlock_t, a waiter that has spun for a while starts
+// yielding to the tasking layer between checks.
+//
+// With CHPL_RT_LOCK_PROFILE set, each lock counts, per the site name
+// it was initialized with, how often it was acquired, how often that
+// had to wait and for how many spins.  The totals go to stderr at exit.
+//
+
+// Spins between checks, per waiter ahead of us in a ticket lock.
+#define CHPL_LOCK_BACKOFF       16
+// After this many checks, yield between them.
+#define CHPL_LOCK_YIELD_AFTER   1024
+
+typedef struct chpl_lock_prof_site chpl_lock_prof_site_t;
+
+// The profiling record for the named site, or NULL if profiling is off.
+chpl_lock_prof_site_t* chpl_lock_prof_site(const char* name);
+
+// Count one acquisition at 'site' that spun 'spins' times first.
+void chpl_lock_prof_record(chpl_lock_prof_site_t* site, uint64_t spins);
+
+// Print the profile, if profiling is on.
+void chpl_lock_prof_report(void);
+
+static inline
+void chpl_lock_wait_step(uint64_t checks, uint32_t relax) {
+  if (checks < CHPL_LOCK_YIELD_AFTER) {
+    uint32_t i;
+    for (i = 0; i < relax; i++)
+      chpl_sync_cpu_relax();
+  } else {
+    chpl_task_yield();
+  }
+}
+
+
+//
+// Ticket lock
+//
+typedef struct {
+  atomic_uint_least32_t next;     // next ticket to hand out
+  atomic_uint_least32_t serving;  // ticket that holds the lock
+  chpl_lock_prof_site_t* prof;
+} chpl_ticket_lock_t;
+
+static inline
+void chpl_ticket_lock_init(chpl_ticket_lock_t* l, const char* site) {
+  atomic_init_uint_least32_t(&l->next, 0);
+  atomic_init_uint_least32_t(&l->serving, 0);
+  l->prof = chpl_lock_prof_site(site);
+}
+
+static inline
+void chpl_ticket_lock_destroy(chpl_ticket_lock_t* l) {
+  atomic_destroy_uint_least32_t(&l->next);
+  atomic_destroy_uint_least32_t(&l->serving);
+}
+
+static inline
+chpl_bool chpl_ticket_lock_try(chpl_ticket_lock_t* l) {
+  uint_least32_t t = atomic_load_explicit_uint_least32_t(&l->serving,
+                                                          memory_order_relaxed);
+  uint_least32_t expected = t;
+  if (atomic_compare_exchange_strong_explicit_uint_least32_t(
+        &l->next, &expected, t + 1,
+        memory_order_acquire, memory_order_relaxed)) {
+    if (l->prof != NULL)
+      chpl_lock_prof_record(l->prof, 0);
+    return true;
+  }
+  return false;
+}
+
+static inline
+void chpl_ticket_lock(chpl_ticket_lock_t* l) {
+  uint_least32_t me = atomic_fetch_add_explicit_uint_least32_t(
+                        &l->next, 1, memory_order_relaxed);
+  uint_least32_t cur;
+  uint64_t checks = 0;
+
+  while ((cur = atomic_load_explicit_uint_least32_t(&l->serving,
+                                                    memory_order_acquire))
+         != me) {
+    chpl_lock_wait_step(checks++, (uint32_t) (me - cur) * CHPL_LOCK_BACKOFF);
+  }
+
+  if (l->prof != NULL)
+    chpl_lock_prof_record(l->prof, checks);
+}
+
+static inline
+void chpl_ticket_unlock(chpl_ticket_lock_t* l) {
+  // Only the holder writes 'serving', so this needn't be an RMW.
+  uint_least32_t t = atomic_load_explicit_uint_least32_t(&l->serving,
+                                                         memory_order_relaxed);
+  atomic_store_explicit_uint_least32_t(&l->serving, t + 1,
+                                       memory_order_release);
+}
+
+
+//
+// MCS lock
+//
+typedef struct {
+  atomic_uintptr_t next;          // next waiter's node
+  atomic_bool locked;             // set while we wait
+} chpl_mcs_node_t;
+
+typedef struct {
+  atomic_uintptr_t tail;          // last waiter's node, 0 if unlocked
+  chpl_lock_prof_site_t* prof;
+} chpl_mcs_lock_t;
+
+static inline
+void chpl_mcs_lock_init(chpl_mcs_lock_t* l, const char* site) {
+  atomic_init_uintptr_t(&l->tail, 0);
+  l->prof = chpl_lock_prof_site(site);
+}
+
+static inline
+void chpl_mcs_lock_destroy(chpl_mcs_lock_t* l) {
+  atomic_destroy_uintptr_t(&l->tail);
+}
+
+// Only the "locks" atomics need this, but a node is done with once
+// its owner has unlocked (or failed to lock).
+static inline
+void chpl_mcs_node_destroy(chpl_mcs_node_t* me) {
+  atomic_destroy_uintptr_t(&me->next);
+  atomic_destroy_bool(&me->locked);
+}
+
+static inline
+chpl_bool chpl_mcs_lock_try(chpl_mcs_lock_t* l, chpl_mcs_node_t* me) {
+  uintptr_t expected = 0;
+
+  atomic_init_uintptr_t(&me->next, 0);
+  atomic_init_bool(&me->locked, false);
+  if (atomic_compare_exchange_strong_explicit_uintptr_t(
+        &l->tail, &expected, (uintptr_t) me,
+        memory_order_acquire, memory_order_relaxed)) {
+    if (l->prof != NULL)
+      chpl_lock_prof_record(l->prof, 0);
+    return true;
+  }
+  chpl_mcs_node_destroy(me);
+  return false;
+}
+
+static inline
+void chpl_mcs_lock(chpl_mcs_lock_t* l, chpl_mcs_node_t* me) {
+  uintptr_t pred;
+  uint64_t checks = 0;
+
+  atomic_init_uintptr_t(&me->next, 0);
+  atomic_init_bool(&me->locked, true);
+
+  pred = atomic_exchange_explicit_uintptr_t(&l->tail, (uintptr_t) me,
+                                            memory_order_acq_rel);
+  if (pred != 0) {
+    atomic_store_explicit_uintptr_t(&((chpl_mcs_node_t*) pred)->next,
+                                    (uintptr_t) me, memory_order_release);
+    while (atomic_load_explicit_bool(&me->locked, memory_order_acquire)) {
+      chpl_lock_wait_step(checks++, 1);
+    }
+  }
+
+  if (l->prof != NULL)
+    chpl_lock_prof_record(l->prof, checks);
+}
+
+static inline
+void chpl_mcs_unlock(chpl_mcs_lock_t* l, chpl_mcs_node_t* me) {
+  uintptr_t next = atomic_load_explicit_uintptr_t(&me->next,
+                                                  memory_order_acquire);
+  uint64_t checks = 0;
+
+  if (next == 0) {
+    uintptr_t expected = (uintptr_t) me;
+    if (atomic_compare_exchange_strong_explicit_uintptr_t(
+          &l->tail, &expected, 0,
+          memory_order_release, memory_order_relaxed)) {
+      chpl_mcs_node_destroy(me);
+      return;
+    }
+    // Someone is enqueueing behind us; wait for them to link in.
+    while ((next = atomic_load_explicit_uintptr_t(&me->next,
+                                                  memory_order_acquire))
+           == 0) {
+      chpl_lock_wait_step(checks++, 1);
+    }
+  }
+
+  atomic_store_explicit_bool(&((chpl_mcs_node_t*) next)->locked, false,
+                             memory_order_release);
+  chpl_mcs_node_destroy(me);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -27,6 +27,7 @@
 #include <stdint.h>
 #include <string.h>
 #include "chpl-comm.h"
+#include "chpl-gpu.h"
 #include "chpl-mem.h"
 #include "chpl-mem-desc.h"
 #include "chpl-mem-hook.h"
@@ -50,10 +51,77 @@ chpl_bool chpl_mem_size_justifies_comm_alloc(size_t size) {
 }
 
 
+//
+// Large arrays, those at least chpl_mem_array_large_threshold bytes
+// (CHPL_RT_MEM_ARRAY_LARGE_THRESHOLD) that the comm layer doesn't
+// allocate, are mapped directly, 2 MiB aligned, and backed by
+// hugepages: transparent ones by default, or explicitly reserved ones
+// with CHPL_RT_MEM_ARRAY_HUGEPAGES=explicit ("none" turns hugepages
+// off).  Arrays for a given sublocale are bound to its NUMA domain.
+// Others are split across the NUMA domains in order, by default unless
+// the locale model is flat (CHPL_RT_MEM_ARRAY_NUMA_SPREAD).  None of
+// this is done when the comm layer has a fixed registered heap.
+//
+// Large arrays are resized in place where possible: address space can
+// be reserved beyond the initial size (chpl_mem_array_alloc_growable()),
+// and growing within it or shrinking just changes page protections.
+// Growing past the reservation moves the pages on Linux, via mremap(),
+// so it never needs the old and new arrays to coexist.
+//
+extern size_t chpl_mem_array_large_threshold;
+
+void chpl_mem_array_init(void);
+void* chpl_mem_array_large_alloc(size_t, size_t, c_sublocid_t);
+void* chpl_mem_array_large_realloc(void*, size_t);
+chpl_bool chpl_mem_array_is_large(void*);
+chpl_bool chpl_mem_array_large_free(void*);
+
 static inline
-void* chpl_mem_array_alloc(size_t nmemb, size_t eltSize,
-                           c_sublocid_t subloc, chpl_bool* callPostAlloc,
-                           int32_t lineno, int32_t filename) {
+chpl_bool chpl_mem_size_justifies_large_alloc(size_t size) {
+  return size >= chpl_mem_array_large_threshold;
+}
+
+
+#ifdef HAS_GPU_LOCALE
+//
+// Arrays for GPU sublocales are in managed memory (see chpl-gpu.h).
+// Resizing one, or moving one onto or off of a GPU, copies it.
+//
+static inline
+void* chpl_mem_array_gpu_realloc(void* p, size_t oldSize, size_t newSize,
+                                 c_sublocid_t subloc,
+                                 int32_t lineno, int32_t filename) {
+  void* newp = chpl_gpu_subloc_is_device(subloc)
+               ? chpl_gpu_mem_alloc(newSize, subloc, lineno, filename)
+               : chpl_malloc(newSize);
+
+  if (p != NULL) {
+    memcpy(newp, p, (oldSize < newSize) ? oldSize : newSize);
+    if (chpl_gpu_is_device_ptr(p))
+      chpl_gpu_mem_free(p, lineno, filename);
+    else if (!(chpl_mem_size_justifies_comm_alloc(oldSize)
+               && chpl_comm_regMemFree(p, oldSize))
+             && !chpl_mem_array_large_free(p))
+      chpl_free(p);
+  }
+
+  return newp;
+}
+#endif
+
+
+//
+// Like chpl_mem_array_alloc(), but for arrays expected to grow to as
+// many as maxNmemb elements, such as those over list-like domains.  If
+// the array is large, address space for maxNmemb elements is reserved
+// so that reallocating it up to that size won't move it.
+//
+static inline
+void* chpl_mem_array_alloc_growable(size_t nmemb, size_t maxNmemb,
+                                    size_t eltSize,
+                                    c_sublocid_t subloc,
+                                    chpl_bool* callPostAlloc,
+                                    int32_t lineno, int32_t filename) {
   //
   // To support dynamic array registration by comm layers, in addition
   // to the address to the allocated memory this returns either true or
@@ -72,7 +140,13 @@ void* chpl_mem_array_alloc(size_t nmemb, size_t eltSize,
   const size_t size = nmemb * eltSize;
   void* p = NULL;
   *callPostAlloc = false;
-  if (chpl_mem_size_justifies_comm_alloc(size)) {
+#ifdef HAS_GPU_LOCALE
+  if (chpl_gpu_subloc_is_device(subloc)) {
+    p = chpl_gpu_mem_alloc(size, subloc, lineno, filename);
+  }
+#endif
+
+  if (p == NULL && chpl_mem_size_justifies_comm_alloc(size)) {
     p = chpl_comm_regMemAlloc(size, CHPL_RT_MD_ARRAY_ELEMENTS,
                               lineno, filename);
     if (p != NULL) {
@@ -80,6 +154,10 @@ void* chpl_mem_array_alloc(size_t nmemb, size_t eltSize,
     }
   }
 
+  if (p == NULL && chpl_mem_size_justifies_large_alloc(size)) {
+    p = chpl_mem_array_large_alloc(size, maxNmemb * eltSize, subloc);
+  }
+
   if (p == NULL) {
     p = chpl_malloc(nmemb * eltSize);
   }
@@ -91,6 +169,15 @@ void* chpl_mem_array_alloc(size_t nmemb, size_t eltSize,
 }
 
 
+static inline
+void* chpl_mem_array_alloc(size_t nmemb, size_t eltSize,
+                           c_sublocid_t subloc, chpl_bool* callPostAlloc,
+                           int32_t lineno, int32_t filename) {
+  return chpl_mem_array_alloc_growable(nmemb, nmemb, eltSize, subloc,
+                                       callPostAlloc, lineno, filename);
+}
+
+
 static inline
 void chpl_mem_array_postAlloc(void* p, size_t nmemb, size_t eltSize,
                               int32_t lineno, int32_t filename) {
@@ -119,7 +206,14 @@ void* chpl_mem_array_realloc(void* p, size_t oldNmemb, size_t newNmemb,
   const size_t oldSize = oldNmemb * eltSize;
   void* newp = NULL;
   *callPostAlloc = false;
-  if (chpl_mem_size_justifies_comm_alloc(oldSize)) {
+#ifdef HAS_GPU_LOCALE
+  if (chpl_gpu_subloc_is_device(subloc) || chpl_gpu_is_device_ptr(p)) {
+    newp = chpl_mem_array_gpu_realloc(p, oldSize, newSize, subloc,
+                                      lineno, filename);
+  }
+#endif
+
+  if (newp == NULL && chpl_mem_size_justifies_comm_alloc(oldSize)) {
     newp = chpl_comm_regMemRealloc(p, oldSize, newSize,
                                    CHPL_RT_MD_ARRAY_ELEMENTS,
                                    lineno, filename);
@@ -128,6 +222,33 @@ void* chpl_mem_array_realloc(void* p, size_t oldNmemb, size_t newNmemb,
     }
   }
 
+  if (newp == NULL
+      && (chpl_mem_size_justifies_large_alloc(newSize)
+          || chpl_mem_size_justifies_large_alloc(oldSize))) {
+    //
+    // Moving into or out of large arrays can't be done with the memory
+    // layer's realloc.  Resizing a large one is done in place if we
+    // can, and by copying only if not.
+    //
+    chpl_bool oldLarge = chpl_mem_array_is_large(p);
+    if (oldLarge && chpl_mem_size_justifies_large_alloc(newSize))
+      newp = chpl_mem_array_large_realloc(p, newSize);
+    if (newp == NULL) {
+      if (chpl_mem_size_justifies_large_alloc(newSize))
+        newp = chpl_mem_array_large_alloc(newSize, newSize, subloc);
+      if (newp == NULL && oldLarge)
+        newp = chpl_malloc(newSize);
+      if (newp != NULL) {
+        if (p != NULL)
+          memcpy(newp, p, (oldSize < newSize) ? oldSize : newSize);
+        if (oldLarge)
+          (void) chpl_mem_array_large_free(p);
+        else
+          chpl_free(p);
+      }
+    }
+  }
+
   if (newp == NULL) {
     newp = chpl_realloc(p, newSize);
   }
@@ -165,12 +286,24 @@ void chpl_mem_array_free(void* p,
   //
   chpl_memhook_free_pre(p, lineno, filename);
 
+#ifdef HAS_GPU_LOCALE
+  if (chpl_gpu_is_device_ptr(p)) {
+    chpl_gpu_mem_free(p, lineno, filename);
+    return;
+  }
+#endif
+
   const size_t size = nmemb * eltSize;
   if (chpl_mem_size_justifies_comm_alloc(size)
       && chpl_comm_regMemFree(p, size)) {
     return;
   }
 
+  if (chpl_mem_size_justifies_large_alloc(size)
+      && chpl_mem_array_large_free(p)) {
+    return;
+  }
+
   chpl_free(p);
 }
 
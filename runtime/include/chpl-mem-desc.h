@@ -70,6 +70,8 @@ extern "C" {
   m(STR_CONCAT_DATA,      "string concat data",                       true ), \
   m(STR_MOVE_DATA,        "string move data",                         true ), \
   m(STR_SELECT_DATA,      "string select data",                       true ), \
+  m(STR_INTERN_DATA,      "interned string data",                     false), \
+  m(VDEBUG_BUFFER,        "visual debug buffer",                      false), \
   m(CFG_ARG_COPY_DATA,    "config arg copy data",                     true ), \
   m(CF_TABLE_DATA,        "config table data",                        true ), \
   m(LOCALE_NAME_BUF,      "locale name buffer",                       true ), \
@@ -91,6 +93,9 @@ extern "C" {
   m(GMP,                  "gmp data",                                 true ), \
   m(GETS_PUTS_STRIDES,    "put_strd/get_strd array of strides",       true ), \
   m(MLI_DATA,             "multilocale interop data",                 true ), \
+  m(REMOTE_ALLOC,         "remote allocation",                        true ), \
+  m(GPU_UTIL,             "GPU layer utility space",                  false), \
+  m(COMM_COLL_BUF,        "comm layer collective buffer",             false), \
   m(NUM,                  "*** this must be the last entry ***",      true )
 
 
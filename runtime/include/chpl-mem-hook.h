@@ -32,6 +32,7 @@
 
 // Need memory tracking prototypes for inlined memory routines
 #include "chplmemtrack.h"
+#include "chpl-mem-sample.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -72,6 +73,13 @@ void chpl_memhook_check_post(void* memAlloc,
                              chpl_mem_descInt_t description,
                              int32_t lineno, int32_t filename);
 
+//
+// If set, this is called with each pointer about to be freed (or
+// reallocated).  Comm layers that cache state keyed by local address,
+// such as memory registrations, use it to invalidate that state.
+//
+extern void (*chpl_memhook_free_notify)(void*);
+
 
 static inline
 void chpl_memhook_malloc_pre(size_t number, size_t size,
@@ -91,12 +99,16 @@ void chpl_memhook_malloc_post(void* memAlloc,
     chpl_memhook_check_post(memAlloc, description, lineno, filename);
   if (CHPL_MEMHOOKS_ACTIVE)
     chpl_track_malloc(memAlloc, number, size, description, lineno, filename);
+  chpl_mem_sample_alloc(memAlloc, number * size, description);
 }
 
 
 static inline
 void chpl_memhook_free_pre(void* memAlloc,
                            int32_t lineno, int32_t filename) {
+  if (chpl_memhook_free_notify != NULL && memAlloc != NULL)
+    (*chpl_memhook_free_notify)(memAlloc);
+  chpl_mem_sample_dealloc(memAlloc);
   if (CHPL_MEMHOOKS_ACTIVE) {
     // call this one just to check heap is initialized.
     chpl_memhook_check_pre(0, 0, 0, lineno, filename);
@@ -109,6 +121,9 @@ static inline
 void chpl_memhook_realloc_pre(void* memAlloc, size_t size,
                               chpl_mem_descInt_t description,
                               int32_t lineno, int32_t filename) {
+  if (chpl_memhook_free_notify != NULL && memAlloc != NULL)
+    (*chpl_memhook_free_notify)(memAlloc);
+  chpl_mem_sample_dealloc(memAlloc);
   if (CHPL_MEMHOOKS_ACTIVE) {
     chpl_memhook_check_pre(1, size, description, lineno, filename);
     chpl_track_realloc_pre(memAlloc, size, description, lineno, filename);
@@ -126,6 +141,7 @@ void chpl_memhook_realloc_post(void* moreMemAlloc, void* memAlloc,
   if (CHPL_MEMHOOKS_ACTIVE)
     chpl_track_realloc_post(moreMemAlloc, memAlloc, size, description,
                        lineno, filename);
+  chpl_mem_sample_alloc(moreMemAlloc, size, description);
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_mem_sample_H_
+#define _chpl_mem_sample_H_
+
+#ifndef LAUNCHER
+
+#include "chpl-mem-desc.h"
+#include "chpl-thread-local-storage.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Sampling heap profiler.
+//
+// This is a low-overhead alternative to --memTrack.  Setting
+// CHPL_RT_MEM_SAMPLE_INTERVAL to N records about one allocation per N
+// bytes allocated (at exponentially distributed intervals), with the
+// call stack that made it.  Allocating threads keep their own sample
+// state and stacks, and sampled addresses go in a lock-free table so
+// that frees can find them, so allocation and free take no global lock.
+//
+// The samples are printed as a pprof heap profile (heap_v2 format) by
+// chpl_printMemAllocs() and chpl_printMemAllocsByDesc() when memory
+// tracking is off, and at exit on their own.  They go to the memory
+// log (--memLog).  Sending the signal in CHPL_RT_MEM_SAMPLE_SIGNAL
+// (default SIGUSR2, 0 for none) asks for a profile, which is printed
+// at the next sampled allocation.
+//
+extern size_t chpl_mem_sample_interval;   // 0: not sampling
+
+void chpl_mem_sample_init(void);
+void chpl_mem_sample_take(void* p, size_t size, chpl_mem_descInt_t desc);
+void chpl_mem_sample_free(void* p);
+void chpl_mem_sample_print(FILE* f, chpl_mem_descInt_t desc,
+                           int64_t threshold);
+
+#ifdef CHPL_TLS
+// bytes left to allocate on this thread before the next sample
+extern CHPL_TLS int64_t chpl_mem_sample_countdown;
+#endif
+
+static inline
+void chpl_mem_sample_alloc(void* p, size_t size, chpl_mem_descInt_t desc) {
+  if (chpl_mem_sample_interval == 0 || p == NULL)
+    return;
+#ifdef CHPL_TLS
+  if ((chpl_mem_sample_countdown -= (int64_t) size) >= 0)
+    return;
+#endif
+  chpl_mem_sample_take(p, size, desc);
+}
+
+static inline
+void chpl_mem_sample_dealloc(void* p) {
+  if (chpl_mem_sample_interval == 0 || p == NULL)
+    return;
+  chpl_mem_sample_free(p);
+}
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif // LAUNCHER
+
+#endif // _chpl_mem_sample_H_
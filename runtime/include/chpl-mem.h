@@ -25,7 +25,9 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
+#include <sys/types.h>
 #include <assert.h>
 #include "arg.h"
 #include "chpl-mem-desc.h"
@@ -192,6 +194,19 @@ void* chpl_mem_layerAlloc(size_t, int32_t lineno, int32_t filename);
 void* chpl_mem_layerRealloc(void*, size_t, int32_t lineno, int32_t filename);
 void chpl_mem_layerFree(void*, int32_t lineno, int32_t filename);
 
+//
+// Memory layer tuning.  chpl_mem_bindThreadArena() binds the calling
+// thread to the allocator arena for its NUMA domain, if the layer has
+// per-NUMA arenas; the tasking layers call it for their threads.
+// chpl_mem_setDecayTime() sets how long unused dirty pages linger
+// before being returned to the system (-1: forever), returning 0 on
+// success.  chpl_mem_layerReportStats() prints the layer's own
+// statistics, if it has any.
+//
+void chpl_mem_bindThreadArena(void);
+int chpl_mem_setDecayTime(ssize_t seconds);
+void chpl_mem_layerReportStats(FILE*);
+
 #ifdef __cplusplus
 }
 #endif
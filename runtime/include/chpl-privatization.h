@@ -23,6 +23,7 @@
 #ifndef LAUNCHER
 #include <stdint.h>
 #include "chpltypes.h"
+#include "chpl-atomics.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -36,13 +37,30 @@ typedef struct chpl_privateObject_s {
   void* obj;
 } chpl_privateObject_t;
 
-// This is a dynamically-allocated array of chpl_privateObject_t.
-extern chpl_privateObject_t* chpl_privateObjects;
+//
+// The privatized objects are kept in a two-level table: a fixed-size
+// directory of pointers to chunks of chpl_privateObject_t.  Chunks are
+// allocated on demand and never move, so readers need no lock and the
+// table grows without copying.
+//
+#define CHPL_PRIVATE_OBJECTS_CHUNK_BITS 12
+#define CHPL_PRIVATE_OBJECTS_CHUNK_SIZE (1 << CHPL_PRIVATE_OBJECTS_CHUNK_BITS)
+#define CHPL_PRIVATE_OBJECTS_MAX_CHUNKS (1 << 16)
 
-// Compiler generates accesses like chpl_privateObjects[i];
-// see chpl_getPrivatizedCopy.
-// This allows TBAA information for chpl_privateObjects to be used.
-// At the very least, inlining it would be important for performance.
+extern atomic_uintptr_t chpl_privateObjects[CHPL_PRIVATE_OBJECTS_MAX_CHUNKS];
+
+// Module code gets privatized copies through this (see
+// chpl_getPrivatizedCopy).  It must be inlined for performance.  The
+// relaxed load is enough because whoever has a pid was handed it
+// after chpl_newPrivatizedClass() stored the object.
+static inline
+void* chpl_getPrivatizedClass(int64_t pid) {
+  chpl_privateObject_t* chunk = (chpl_privateObject_t*)
+    atomic_load_explicit_uintptr_t(
+      &chpl_privateObjects[pid >> CHPL_PRIVATE_OBJECTS_CHUNK_BITS],
+      memory_order_relaxed);
+  return chunk[pid & (CHPL_PRIVATE_OBJECTS_CHUNK_SIZE - 1)].obj;
+}
 
 void chpl_clearPrivatizedClass(int64_t);
 
@@ -85,6 +85,29 @@ int string_index_of(c_string x, c_string y);
 c_string string_index(c_string x, int i, int32_t lineno, int32_t filename);
 c_string string_select(c_string x, int low, int high, int stride, int32_t lineno, int32_t filename);
 
+//
+// Variants of string_copy, string_concat and string_select that store the
+// result in the bufsize bytes at buf, without allocating, when it fits
+// there along with its terminating NUL.  Longer results are allocated as
+// usual.  Free these results with string_free_buf(), which leaves results
+// in buf alone.
+//
+c_string string_copy_buf(char* buf, size_t bufsize, c_string x, int32_t lineno, int32_t filename);
+c_string string_concat_buf(char* buf, size_t bufsize, c_string x, c_string y, int32_t lineno, int32_t filename);
+c_string string_select_buf(char* buf, size_t bufsize, c_string x, int low, int high, int stride, int32_t lineno, int32_t filename);
+
+void string_free_buf(const char* buf, c_string x, int32_t lineno, int32_t filename);
+
+//
+// Interned strings: returns the table's copy of the string, adding it on
+// first use.  Interned strings are never freed, and equal strings intern
+// to the same pointer, so they can be compared with ==.  This is meant for
+// names and keys that recur many times (module names, identifiers) rather
+// than for user data.  Thread-safe.
+//
+c_string string_intern(c_string x);
+c_string string_intern_len(const char* x, int64_t len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -38,7 +38,17 @@ struct chpl_chpl____wide_chpl_string_s;
 
 chpl_string chpl_wide_string_copy(struct chpl_chpl____wide_chpl_string_s* x, int32_t lineno, int32_t filename);
 
-#define CHPL_SHORT_STRING_SIZE 8
+// Copies the n wide strings in x[] into newly-allocated local strings in
+// out[].  The remote gets are issued together and completed with a single
+// fence, so copying many strings from another locale costs about one
+// round trip rather than one per string.
+void chpl_wide_string_copy_many(int64_t n, struct chpl_chpl____wide_chpl_string_s* x, chpl_string* out, int32_t lineno, int32_t filename);
+
+// Strings of up to CHPL_SHORT_STRING_SIZE-1 bytes (plus the NUL) are
+// stored inline in a chpl__inPlaceBuffer instead of on the heap.
+#ifndef CHPL_SHORT_STRING_SIZE
+#define CHPL_SHORT_STRING_SIZE 24
+#endif
 
 typedef struct chpl__inPlaceBuffer_t {
   uint8_t data[CHPL_SHORT_STRING_SIZE];
@@ -47,6 +57,43 @@ typedef struct chpl__inPlaceBuffer_t {
 uint8_t* chpl__getInPlaceBufferData(chpl__inPlaceBuffer* buf);
 uint8_t* chpl__getInPlaceBufferDataForWrite(chpl__inPlaceBuffer* buf);
 
+// Copy, concatenate or select into buf when the result is short enough,
+// and otherwise onto the heap.  Results must be freed with
+// chpl__inPlaceBufferFree, which only frees heap results.
+static inline
+chpl_bool chpl__isInPlaceBufferData(chpl__inPlaceBuffer* buf, c_string s) {
+  return s == (c_string) buf->data;
+}
+
+static inline
+c_string chpl__inPlaceBufferCopy(chpl__inPlaceBuffer* buf, c_string x,
+                                 int32_t lineno, int32_t filename) {
+  return string_copy_buf((char*) buf->data, sizeof(buf->data), x,
+                         lineno, filename);
+}
+
+static inline
+c_string chpl__inPlaceBufferConcat(chpl__inPlaceBuffer* buf,
+                                   c_string x, c_string y,
+                                   int32_t lineno, int32_t filename) {
+  return string_concat_buf((char*) buf->data, sizeof(buf->data), x, y,
+                           lineno, filename);
+}
+
+static inline
+c_string chpl__inPlaceBufferSelect(chpl__inPlaceBuffer* buf, c_string x,
+                                   int low, int high, int stride,
+                                   int32_t lineno, int32_t filename) {
+  return string_select_buf((char*) buf->data, sizeof(buf->data), x,
+                           low, high, stride, lineno, filename);
+}
+
+static inline
+void chpl__inPlaceBufferFree(chpl__inPlaceBuffer* buf, c_string s,
+                             int32_t lineno, int32_t filename) {
+  string_free_buf((const char*) buf->data, s, lineno, filename);
+}
+
 #ifdef __cplusplus
 }
 #endif
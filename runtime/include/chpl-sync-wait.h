@@ -0,0 +1,96 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_sync_wait_h_
+#define _chpl_sync_wait_h_
+
+#include <stdint.h>
+#include "chpltypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Adaptive waiting for sync variables.
+//
+// A task waiting for a sync variable to change state first spins,
+// then yields a few times, and only then parks.  How long it spins is
+// calibrated per sync variable from how long recent waits on it took:
+// waits that were satisfied while spinning pull the spin limit toward
+// the number of spins they needed, and waits that ended up parking
+// shrink it.  This keeps tight producer/consumer handoffs out of the
+// park path without burning cycles on variables that are always slow.
+//
+// The tasking layers keep a spin hint in each chpl_sync_aux_t and
+// count the outcomes in chpl_task_infoRuntime_t.
+//
+
+#define CHPL_SYNC_SPIN_MIN   16
+#define CHPL_SYNC_SPIN_MAX   16384
+#define CHPL_SYNC_NUM_YIELDS 4
+
+// How each wait ended, counted per task.
+typedef struct {
+  uint64_t spins;   // satisfied while spinning
+  uint64_t yields;  // satisfied while yielding
+  uint64_t parks;   // had to park
+} chpl_sync_wait_stats_t;
+
+static inline
+void chpl_sync_cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  __asm__ __volatile__ ("yield");
+#endif
+}
+
+// How many times to spin, given the variable's current hint.
+static inline
+uint32_t chpl_sync_spin_limit(uint32_t hint) {
+  uint32_t limit = 2 * hint;
+  if (limit < CHPL_SYNC_SPIN_MIN)
+    return CHPL_SYNC_SPIN_MIN;
+  if (limit > CHPL_SYNC_SPIN_MAX)
+    return CHPL_SYNC_SPIN_MAX;
+  return limit;
+}
+
+// Fold the outcome of a wait into the variable's hint.  Racy updates
+// by concurrent waiters are fine; this is only a heuristic.
+static inline
+void chpl_sync_spin_update(uint32_t* hint, uint32_t spun,
+                           chpl_bool satisfied_spinning) {
+  int64_t h = *hint;
+  if (satisfied_spinning)
+    h += ((int64_t) spun - h) / 8;
+  else
+    h -= h / 8;
+  if (h < CHPL_SYNC_SPIN_MIN)
+    h = CHPL_SYNC_SPIN_MIN;
+  *hint = (uint32_t) h;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_task_arena_h_
+#define _chpl_task_arena_h_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Task-lifetime arena allocation.
+//
+// chpl_task_arena_alloc() hands out memory that stays valid until the
+// calling task ends, at which point the tasking layer releases all of
+// it at once.  There is no individual free.  It is meant for short-
+// lived per-task temporaries, which would otherwise each go through
+// chpl_mem_alloc() and, often, be freed by some other thread.
+//
+// The arena lives in the task's chpl_task_infoRuntime_t.  Its chunks
+// come from, and go back to, a small cache kept by each thread, so
+// most tasks never call the memory layer at all.
+//
+
+typedef struct chpl_task_arena_chunk chpl_task_arena_chunk_t;
+
+typedef struct {
+  chpl_task_arena_chunk_t* chunks;   // chunks in use, newest first
+  char* cur;                         // next free byte in newest chunk
+  char* end;                         // end of newest chunk
+} chpl_task_arena_t;
+
+//
+// Allocate from the current task's arena.  Must be called from within
+// a task.
+//
+void* chpl_task_arena_alloc(size_t size, int32_t lineno, int32_t filename);
+
+//
+// Called by the tasking layer when a task ends.
+//
+void chpl_task_arena_release(chpl_task_arena_t* arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
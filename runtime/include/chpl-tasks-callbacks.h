@@ -120,6 +120,31 @@ extern "C" {
 //   are wanted later, the callback function must allocate memory to
 //   hold a copy of the pointed-to data and duplicate it itself.
 //
+//
+// EVENT RING
+//
+//     int chpl_task_install_event_ring(void);
+//     int chpl_task_uninstall_event_ring(void);
+//     size_t chpl_task_drain_events(chpl_task_cb_event_t* evs, size_t max);
+//     uint64_t chpl_task_events_dropped(void);
+//
+//   As an alternative to callbacks, which run synchronously on the
+//   tasking layer's hot path, a tool can install the event ring.  While
+//   it is installed every create, begin, and end event is recorded as a
+//   chpl_task_cb_event_t, with a timestamp, in a lock-free ring owned by
+//   the thread where the event occurred.  The tool then calls
+//   chpl_task_drain_events() from a thread of its own choosing, as
+//   often as it likes, to copy up to 'max' of the buffered events out
+//   of all the threads' rings into 'evs'.  It returns the number of
+//   events copied.  Events from any one thread come out in the order
+//   they occurred; events from different threads can be merged by
+//   their timestamps.
+//
+//   The rings are of fixed size.  Events that arrive when their ring is
+//   full are dropped, and chpl_task_events_dropped() returns how many
+//   have been, in total.  Installing is counted, like a callback, so
+//   install and uninstall calls must be balanced.
+//
 
 typedef enum {
   chpl_task_cb_event_kind_create,
@@ -159,12 +184,27 @@ typedef struct {
 
 typedef void (*chpl_task_cb_fn_t)(const chpl_task_cb_info_t*);
 
+typedef struct {
+  uint64_t time;                // CLOCK_MONOTONIC, in nanoseconds
+  uint64_t id;                  // task ID, unique within locale
+  int32_t filename;             // source file of task definition
+  int32_t lineno;               // source line of task definition
+  chpl_fn_int_t fid;            // number of function to call
+  uint8_t event_kind;           // a chpl_task_cb_event_kind_t
+  uint8_t is_executeOn;         // !=0: task is for executeOn body
+} chpl_task_cb_event_t;
+
 int chpl_task_install_callback(chpl_task_cb_event_kind_t,
                                chpl_task_cb_info_kind_t,
                                chpl_task_cb_fn_t);
 int chpl_task_uninstall_callback(chpl_task_cb_event_kind_t,
                                  chpl_task_cb_fn_t);
 
+int chpl_task_install_event_ring(void);
+int chpl_task_uninstall_event_ring(void);
+size_t chpl_task_drain_events(chpl_task_cb_event_t*, size_t);
+uint64_t chpl_task_events_dropped(void);
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
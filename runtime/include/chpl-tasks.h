@@ -27,6 +27,8 @@
 #include "chplcgfns.h"
 #include "chpltypes.h"
 #include "chpl-comm-task-decls.h"
+#include "chpl-sync-wait.h"
+#include "chpl-task-arena.h"
 #include "chpl-tasks-impl.h"
 
 #ifdef __cplusplus
@@ -43,6 +45,10 @@ extern "C" {
 //
 typedef struct {
   chpl_comm_taskPrvData_t comm_data;
+  chpl_task_arena_t arena;           // see chpl-task-arena.h
+  chpl_sync_wait_stats_t sync_wait;  // see chpl-sync-wait.h
+  int32_t numa_hint;                 // NUMA placement hint + 1; 0 for none
+  struct qio_linebuf_s* linebuf;     // see qio_linebuf.h
 } chpl_task_infoRuntime_t;
 
 //
@@ -67,6 +73,7 @@ typedef struct chpl_task_bundle {
   chpl_fn_int_t requested_fid;
   chpl_fn_p requested_fn;
   chpl_taskID_t id;
+  uint64_t spawn_time;          // for tasking-layer profiling, if any
   chpl_task_infoChapel_t infoChapel;
   uint64_t payload[0];
 } chpl_task_bundle_t;
@@ -208,6 +215,43 @@ void chpl_task_addToTaskList(
          chpl_bool,          // is begin{} stmt?  (vs. cobegin or coforall)
          int,                // line at which function begins
          int32_t);           // name of file containing function
+
+//
+// Add a batch of cobegin/coforall tasks to a task list at once.  The
+// 'num_tasks' arg bundles are contiguous in memory, each 'arg_size'
+// bytes long, and all call the same function.  This is equivalent to
+// calling addToTaskList() on each one, but lets the tasking layer
+// create them with less overhead.
+//
+void chpl_task_addTasksToTaskList(
+         chpl_fn_int_t,      // function to call for each task
+         void*,              // the arg bundles, contiguous
+         size_t,             // length of each arg bundle
+         int32_t,            // number of tasks (arg bundles)
+         c_sublocid_t,       // desired sublocale
+         void**,             // task list
+         c_nodeid_t,         // locale (node) where task list resides
+         int,                // line at which function begins
+         int32_t);           // name of file containing function
+
+//
+// Add a leaf task to a task list.  This is like addToTaskList(), but
+// the caller promises that the task body is a non-blocking leaf: it
+// does no sync/single waits, creates no tasks, and does no on-stmts.
+// Tasking layers can then run such tasks back to back on a shared
+// stack instead of giving each its own.  Running a body that does
+// block this way may stall other leaf tasks, or deadlock.
+//
+void chpl_task_addLeafToTaskList(
+         chpl_fn_int_t,      // function to call for task
+         chpl_task_bundle_t*,// argument to the function
+         size_t,             // length of the argument
+         c_sublocid_t,       // desired sublocale
+         void**,             // task list
+         c_nodeid_t,         // locale (node) where task list resides
+         chpl_bool,          // is begin{} stmt?  (vs. cobegin or coforall)
+         int,                // line at which function begins
+         int32_t);           // name of file containing function
 void chpl_task_executeTasksInList(void**);
 
 //
@@ -333,6 +377,28 @@ chpl_task_infoChapel_t* chpl_task_getInfoChapelInBundle(chpl_task_bundle_t* b)
   return &b->infoChapel;
 }
 
+//
+// NUMA placement hints.  While a task has a hint set, tasks it creates
+// without a specific sublocale are started near the given NUMA domain,
+// for tasking layers that can place tasks.  Pass c_sublocid_any to
+// clear the hint.  Setting the hint from chpl_topo_getMemLocality() of
+// the data the new tasks will work on starts them near that data.
+//
+static inline
+void chpl_task_setNumaHint(c_sublocid_t numa) {
+  chpl_task_infoRuntime_t* infoRuntime = chpl_task_getInfoRuntime();
+  if (infoRuntime != NULL)
+    infoRuntime->numa_hint = isActualSublocID(numa) ? numa + 1 : 0;
+}
+
+static inline
+c_sublocid_t chpl_task_getNumaHint(void) {
+  chpl_task_infoRuntime_t* infoRuntime = chpl_task_getInfoRuntime();
+  if (infoRuntime == NULL || infoRuntime->numa_hint == 0)
+    return c_sublocid_any;
+  return infoRuntime->numa_hint - 1;
+}
+
 
 //
 // Returns the maximum width of parallelism the tasking layer expects
@@ -452,6 +518,28 @@ size_t chpl_task_getEnvCallStackSize(void);
 //
 size_t chpl_task_getDefaultCallStackSize(void);
 
+//
+// Load feedback for data-parallel constructs.  When
+// CHPL_RT_ADAPTIVE_DATA_PAR is set, a forall that would create
+// maxTasks tasks can ask how many are actually worthwhile, given the
+// idle threads and queued tasks on this locale right now.  Nested and
+// concurrent foralls then mostly run serially in the tasks that are
+// already busy instead of oversubscribing the locale.  Otherwise this
+// just returns maxTasks.  The result is always at least 1.
+//
+// chpl_task_shouldSplitWork() supports lazy binary splitting: a task
+// working through a range of iterations checks it every so often, and
+// splits off half its remaining range as a new task only when it says
+// there are few enough tasks queued that the new one would be picked
+// up soon.  The threshold is CHPL_RT_ADAPTIVE_SPLIT_THRESHOLD queued
+// tasks (default 2).
+//
+// Both are common to all tasking implementations and so are
+// implemented in runtime/src/chpl-tasks.c.
+//
+uint32_t chpl_task_getAdaptiveNumTasks(uint32_t maxTasks);
+chpl_bool chpl_task_shouldSplitWork(void);
+
 //
 // These are service functions provided to the runtime by the module
 // code.
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_timer_wheel_h_
+#define _chpl_timer_wheel_h_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Per-locale hierarchical timer wheel.
+//
+// A tasking layer that can park a task (block it without tying up a
+// worker thread) uses this to implement chpl_task_sleep(): it parks
+// the task and arranges for a timer callback to make it runnable
+// again.  Adding a timer is O(1), and the wheel is serviced by one
+// thread that sleeps in the kernel until the next timer is due, so
+// thousands of sleeping tasks cost neither CPU nor worker threads.
+//
+// The resolution is CHPL_TIMER_WHEEL_TICK_SECS.  Timers never fire
+// early, and normally fire within a tick of when they are due.
+//
+
+#define CHPL_TIMER_WHEEL_TICK_SECS 1.0e-3
+
+typedef struct chpl_timer_wheel_entry {
+  struct chpl_timer_wheel_entry* next;
+  uint64_t expiry;                   // tick at which to fire
+  void (*fn)(void*);
+  void* arg;
+} chpl_timer_wheel_entry_t;
+
+//
+// Call fn(arg) on the timer service thread once 'secs' seconds have
+// passed.  The entry belongs to the wheel until fn is called, so it
+// must stay valid until then.  fn should be brief and must not block.
+//
+void chpl_timer_wheel_add(chpl_timer_wheel_entry_t* e, double secs,
+                          void (*fn)(void*), void* arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -24,6 +24,7 @@
 
 #include "chpltypes.h"
 
+#include <stddef.h>
 #include <stdint.h>
 
 
@@ -60,6 +61,22 @@ int chpl_topo_getNumNumaDomains(void);
 //
 void chpl_topo_setThreadLocality(c_sublocid_t);
 
+//
+// bind the current thread to one CPU (PU), given its OS index
+//
+// returns 0 on success, -1 if binding isn't supported or the CPU
+// doesn't exist
+//
+int chpl_topo_setThreadCPU(int);
+
+//
+// get the OS index of the first CPU (PU) of a NUMA domain's i'th core,
+// counting cyclically, for use with chpl_topo_setThreadCPU()
+//
+// returns -1 if the topology isn't known
+//
+int chpl_topo_getNumaCPU(c_sublocid_t, int);
+
 //
 // get the sublocale where the current thread is running
 //
@@ -110,6 +127,97 @@ void chpl_topo_touchMemFromSubloc(void*, size_t, chpl_bool, c_sublocid_t);
 //
 c_sublocid_t chpl_topo_getMemLocality(void*);
 
+//
+// is a PCI device (a NIC, say) attached close to the CPUs this process
+// is bound to?
+//
+// args:
+//   PCI domain, bus, device, and function numbers
+//
+// returns 1 if it is, 0 if it isn't, and -1 if we can't tell
+//
+int chpl_topo_isPCIDevNear(int, int, int, int);
+
+//
+// which NUMA domain is a PCI device attached to?
+//
+// args:
+//   PCI domain, bus, device, and function numbers
+//
+// returns the sublocale whose CPUs are local to the device, or
+// c_sublocid_any if we can't tell
+//
+c_sublocid_t chpl_topo_getPCIDevLocality(int, int, int, int);
+
+//
+// how far is a PCI device from the CPUs this process is bound to?
+//
+// args:
+//   PCI domain, bus, device, and function numbers
+//
+// returns the smallest NUMA distance (in ACPI SLIT units, where 10
+// means local) between the device's NUMA node and ours, or -1 if we
+// can't tell
+//
+int chpl_topo_getPCIDevDistance(int, int, int, int);
+
+//
+// Cache hierarchy.  This describes the data (or unified) cache at
+// each level, as seen from the CPUs this process can run on.
+// Instruction caches are not included.
+//
+typedef struct {
+  int level;            // 1 for L1, 2 for L2, and so on
+  size_t size;          // bytes in one instance of the cache
+  int lineSize;         // bytes; 0 if unknown
+  int associativity;    // ways; 0 if unknown, -1 if fully associative
+  int numSharingCPUs;   // CPUs (PUs) sharing one instance
+  int numInstances;     // instances serving the accessible CPUs
+} chpl_topo_cacheInfo_t;
+
+//
+// how many cache levels are there?  0 if the topology isn't known
+//
+int chpl_topo_getNumCacheLevels(void);
+
+//
+// get the description of a cache level (1-based)
+//
+// returns 0 on success, -1 if there is no such level
+//
+int chpl_topo_getCacheInfo(int, chpl_topo_cacheInfo_t*);
+
+//
+// get the size of one instance of a cache level (1-based, or 0 for the
+// last level cache), in bytes
+//
+// returns 0 if the size isn't known; this is meant to be simple to
+// call from generated code, for choosing blocking factors and such
+//
+size_t chpl_topo_getCacheSize(int);
+
+//
+// get the last level cache share of one CPU (PU), that is, the LLC
+// size divided by the number of CPUs sharing it, in bytes
+//
+// returns 0 if the size isn't known
+//
+size_t chpl_topo_getLLCSizePerCPU(void);
+
+//
+// Last level cache sharing groups.  The CPUs that share an instance of
+// the last level cache form a group.  Groups are numbered from 0 among
+// those serving the accessible CPUs.
+//
+int chpl_topo_getNumLLCGroups(void);
+
+//
+// get the LLC group of a CPU (PU), given its OS index
+//
+// returns -1 if the topology isn't known or the CPU isn't accessible
+//
+int chpl_topo_getLLCGroup(int);
+
 
 #ifdef __cplusplus
 } // end extern "C"
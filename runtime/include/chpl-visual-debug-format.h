@@ -0,0 +1,170 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Visual Debug binary record format
+//
+// This header is shared by the runtime (chpl-visual-debug.c), which
+// writes these records, and chplvis (tools/chplvis/DataModel.cxx),
+// which reads them, so it must not depend on any other runtime header.
+//
+// A data file starts with the text lines described in
+// tools/chplvis/TextDataFormat.txt, up to and including a line
+//
+//   Binary: <record size>
+//
+// after which the rest of the file is a sequence of fixed-size binary
+// records in the writing machine's byte order.  The records of one node
+// are written through per-thread buffers, so they are in time order
+// only between Tag, Pause and End records.
+//
+
+#ifndef _chpl_visual_debug_format_h_
+#define _chpl_visual_debug_format_h_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHPL_VDEBUG_REC_SIZE 64
+
+typedef enum {
+  chpl_vdebug_rec_none = 0,
+  chpl_vdebug_rec_task,         // task created
+  chpl_vdebug_rec_begin_task,   // task began running
+  chpl_vdebug_rec_end_task,     // task ended
+  chpl_vdebug_rec_put_nb,
+  chpl_vdebug_rec_get_nb,
+  chpl_vdebug_rec_put,
+  chpl_vdebug_rec_get,
+  chpl_vdebug_rec_put_strd,
+  chpl_vdebug_rec_get_strd,
+  chpl_vdebug_rec_fork,
+  chpl_vdebug_rec_fork_nb,
+  chpl_vdebug_rec_fork_fast,
+  chpl_vdebug_rec_vdb_mark,     // task is part of VisualDebug itself
+  chpl_vdebug_rec_tag,
+  chpl_vdebug_rec_pause,
+  chpl_vdebug_rec_end,          // last record in the file
+  chpl_vdebug_rec_tag_name,     // followed by the name, see below
+  chpl_vdebug_rec_comm_sum      // puts or gets that were not recorded
+} chpl_vdebug_rec_kind_t;
+
+//
+// When sampling is on (CHPL_RT_VDEBUG_SAMPLE, CHPL_RT_VDEBUG_MIN_SIZE),
+// only some puts and gets get records of their own.  The rest are
+// counted per remote node and direction and written as comm_sum
+// records just before the next Tag, Pause or End record, so the totals
+// stay exact.
+//
+// One record.  The first half is common to all kinds; which member of
+// the union is valid depends on the kind.  A tag_name record is
+// followed by ceil(len / CHPL_VDEBUG_REC_SIZE) records' worth of raw
+// bytes holding the name, which is not NUL-terminated.
+//
+typedef struct chpl_vdebug_rec_s {
+  uint8_t  kind;                // a chpl_vdebug_rec_kind_t
+  uint8_t  isOn;                // task: created for an on-statement
+  int16_t  subloc;              // forks: target sublocale
+  int32_t  nodeID;
+  int64_t  sec;                 // time of day
+  int32_t  usec;
+  int32_t  lineno;
+  int64_t  taskID;              // the task doing this (task: the new task)
+  union {
+    struct {
+      int64_t  parentID;
+      int32_t  fileno;
+      int32_t  fid;
+    } task;
+    struct {                    // puts and gets, plain or not
+      int32_t  remoteNodeID;
+      int32_t  commID;
+      int32_t  fileno;
+      int32_t  elemSize;
+      uint64_t length;
+    } comm;
+    struct {
+      int32_t  remoteNodeID;
+      int32_t  fid;
+      int32_t  fileno;
+      int32_t  pad;
+      uint64_t argSize;
+    } fork;
+    struct {                    // tag, pause and end: getrusage() times
+      int32_t  userSec;
+      int32_t  userUsec;
+      int32_t  sysSec;
+      int32_t  sysUsec;
+      int32_t  tagno;
+    } times;
+    struct {
+      int32_t  tagno;
+      int32_t  len;
+    } tagName;
+    struct {
+      int32_t  remoteNodeID;
+      int32_t  isGet;
+      uint64_t count;           // number of puts or gets
+      uint64_t bytes;           // total bytes moved by them
+    } commSum;
+    uint8_t    pad[32];
+  } u;
+} chpl_vdebug_rec_t;
+
+// Fails to compile if the record isn't the documented size.
+typedef char chpl_vdebug_rec_size_check
+  [(sizeof(chpl_vdebug_rec_t) == CHPL_VDEBUG_REC_SIZE) ? 1 : -1];
+
+//
+// With CHPL_RT_VDEBUG_SHARED_FILE, all nodes write to one file,
+// <dir>/<dir>-all, instead of one file per node.  It starts with a
+// chpl_vdebug_shared_hdr_t, followed by one chpl_vdebug_section_t per
+// node saying where that node's data is.  A node's data is what it
+// would otherwise have written to its own file.  Sections start at
+// CHPL_VDEBUG_SHARED_HDR_SIZE(numNodes) + nodeID * sectionSize, and
+// the unused part of each is left as a hole in the file.
+//
+
+#define CHPL_VDEBUG_SHARED_MAGIC "ChplVdebugShared"   // no NUL in the file
+
+typedef struct {
+  char     magic[16];
+  int32_t  numNodes;
+  int32_t  pad;
+  uint64_t sectionSize;
+} chpl_vdebug_shared_hdr_t;
+
+typedef struct {
+  uint64_t offset;
+  uint64_t length;              // bytes written, updated at each Tag/Pause/End
+} chpl_vdebug_section_t;
+
+#define CHPL_VDEBUG_SHARED_HDR_SIZE(numNodes)                          \
+  (((sizeof(chpl_vdebug_shared_hdr_t)                                  \
+     + (numNodes) * sizeof(chpl_vdebug_section_t)) + 4095) / 4096 * 4096)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -87,6 +87,9 @@ extern const int32_t chpl_filenameTableSize;
 extern const c_string chpl_funSymTable[];
 extern const int chpl_filenumSymTable[];
 extern const int32_t chpl_sizeSymTable;
+// Number of leading entries that are user functions; 0 unless the
+// program was compiled with --unwind-line-numbers.
+extern const int32_t chpl_sizeUserSymTable;
 
 extern char* chpl_executionCommand;
 
@@ -94,6 +97,9 @@ extern char* chpl_executionCommand;
 extern const chpl_fn_p chpl_ftable[];
 extern const chpl_fn_info chpl_finfo[];
 
+/* GPU kernels as a CUDA fatbinary, with CHPL_LOCALE_MODEL=gpu: */
+extern const char chpl_gpuBinary[];
+
 extern void chpl__initStringLiterals(void);
 
 
@@ -51,6 +51,10 @@ void chpl_printMemAllocs(int64_t threshold,
                          int32_t lineno, int32_t filename);
 void chpl_printMemAllocsByDesc(c_string descString, int64_t threshold,
                                int32_t lineno, int32_t filename);
+// Current and peak usage per memory descriptor, with when each peak
+// happened and what each descriptor held at the overall high water
+// mark.  Printed at exit if CHPL_RT_MEM_DESC_PEAKS is set.
+void chpl_printMemPeaksByDesc(int32_t lineno, int32_t filename);
 void chpl_startVerboseMem(void);
 void chpl_stopVerboseMem(void);
 void chpl_startVerboseMemHere(void);
@@ -23,7 +23,9 @@
 
 #include "chpltypes.h"  // For _real64.
 
+#include <stdint.h>
 #include <sys/time.h>   // For struct timeval.
+#include <time.h>       // For clock_gettime().
 
 #ifdef __cplusplus
 extern "C" {
@@ -41,6 +43,56 @@ void chpl_timevalue_parts(_timevalue t, int32_t* seconds, int32_t* minutes, int3
 
 _real64 chpl_now_time(void);
 
+//
+// Cheap timestamps for instrumentation.  chpl_timer_ticks() reads the
+// invariant TSC on x86-64 or the virtual counter on AArch64, which
+// takes a few ns where clock_gettime() takes a few tens, and
+// chpl_timer_ticks_to_ns() converts tick counts (typically
+// differences) to nanoseconds.  Where there is no counter that ticks
+// at a constant rate, or with CHPL_RT_TIMER_USE_CYCLE_COUNTER=false,
+// the ticks are CLOCK_MONOTONIC nanoseconds instead.  Either way they
+// only compare within one process.  User code can get to these with
+// extern procs.
+//
+extern chpl_bool chpl_timer_use_counter;
+extern double chpl_timer_ns_per_tick;
+
+void chpl_timer_init(void);
+
+static inline
+uint64_t chpl_timer_ticks(void) {
+#if defined(__x86_64__)
+  if (chpl_timer_use_counter) {
+    uint32_t lo, hi;
+    __asm__ __volatile__ ("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t) hi << 32) | lo;
+  }
+#elif defined(__aarch64__)
+  if (chpl_timer_use_counter) {
+    uint64_t t;
+    __asm__ __volatile__ ("mrs %0, cntvct_el0" : "=r"(t));
+    return t;
+  }
+#endif
+  {
+    struct timespec ts;
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+  }
+}
+
+static inline
+uint64_t chpl_timer_ticks_to_ns(uint64_t ticks) {
+  return chpl_timer_use_counter
+         ? (uint64_t) ((double) ticks * chpl_timer_ns_per_tick)
+         : ticks;
+}
+
+static inline
+uint64_t chpl_timer_now_ns(void) {
+  return chpl_timer_ticks_to_ns(chpl_timer_ticks());
+}
+
 #endif // LAUNCHER
 
 #ifdef __cplusplus
@@ -33,6 +33,21 @@ extern "C" {
     chpl_comm_impl_regMemHeapInfo(start_p, size_p)
 void chpl_comm_impl_regMemHeapInfo(void** start_p, size_t* size_p);
 
+//
+// We can run non-blocking fast execute_on bodies in the AM handler.
+//
+#define CHPL_COMM_IMPL_EXECUTE_ON_FAST_NB 1
+
+//
+// Allreduce and broadcast use the GASNet-EX collectives.
+//
+#define CHPL_COMM_IMPL_COLLECTIVES 1
+
+//
+// Network atomics, through GASNet-EX atomic domains.
+//
+#include "chpl-comm-native-atomics.h"
+
 #ifdef __cplusplus
 }
 #endif
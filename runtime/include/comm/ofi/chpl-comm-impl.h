@@ -37,6 +37,18 @@ void chpl_comm_impl_regMemHeapInfo(void** start_p, size_t* size_p);
         chpl_comm_impl_regMemHeapPageSize()
 size_t chpl_comm_impl_regMemHeapPageSize(void);
 
+#define CHPL_COMM_IMPL_REG_MEM_HEAP_NUMA_PARTS(partSize_p) \
+        chpl_comm_impl_regMemHeapNumaParts(partSize_p)
+int chpl_comm_impl_regMemHeapNumaParts(size_t* partSize_p);
+
+#define CHPL_COMM_IMPL_REG_MEM_REGISTER(p, size) \
+        chpl_comm_impl_regMemRegister(p, size)
+chpl_bool chpl_comm_impl_regMemRegister(void* p, size_t size);
+
+#define CHPL_COMM_IMPL_REG_MEM_DEREGISTER(p, size) \
+        chpl_comm_impl_regMemDeregister(p, size)
+void chpl_comm_impl_regMemDeregister(void* p, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -37,15 +37,21 @@
 extern "C" {
 #endif
 
+// Max unordered third-party transfers a task can have in flight.
+#define CHPL_COMM_OFI_MAX_XFERS 8
+
 typedef struct {
   chpl_bool taskIsEnding;       // task is ending? (anticipate _downEndCount())
   chpl_bool amDonePending;      // some delayed AM 'done' is expected?
   uint8_t amDone;               // delayed 'done' indicator
+  uint8_t numXfers;             // unordered 3rd-party xfers in flight
+  uint8_t xferDone[CHPL_COMM_OFI_MAX_XFERS]; // their 'done' indicators
   void* putBitmap;              // PUT target nodes
   chpl_cache_taskPrvData_t cache_data;
   void* amo_nf_buff;
   void* get_buff;
   void* put_buff;
+  void* put_agg_buff;
 } chpl_comm_taskPrvData_t;
 
 //
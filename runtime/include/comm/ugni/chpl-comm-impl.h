@@ -69,6 +69,14 @@ void chpl_comm_impl_regMemPostRealloc(void* oldp, size_t oldSize,
         chpl_comm_impl_regMemFree(p, size)
 chpl_bool chpl_comm_impl_regMemFree(void* p, size_t size);
 
+#define CHPL_COMM_IMPL_REG_MEM_REGISTER(p, size) \
+        chpl_comm_impl_regMemRegister(p, size)
+chpl_bool chpl_comm_impl_regMemRegister(void* p, size_t size);
+
+#define CHPL_COMM_IMPL_REG_MEM_DEREGISTER(p, size) \
+        chpl_comm_impl_regMemDeregister(p, size)
+void chpl_comm_impl_regMemDeregister(void* p, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -99,6 +107,44 @@ void chpl_comm_impl_task_end(void);
 void chpl_comm_statsStartHere(void);
 void chpl_comm_statsReport(chpl_bool);
 
+//
+// Per-comm-domain statistics.  These are collected while comm
+// diagnostics are on, or always if CHPL_RT_COMM_UGNI_CD_STATS is set.
+// Acquisition waits (finding a free comm domain) are kept separate
+// from transaction latencies (post to completion), so contention for
+// comm domains can be told apart from network latency.  Histogram bin
+// i counts latencies below 2**(i + CHPL_COMM_UGNI_LAT_HIST_SHIFT) ns;
+// the last bin counts everything else.  chpl_comm_statsStartHere()
+// zeroes these along with the other perfstats.
+//
+typedef enum {
+  chpl_comm_ugni_op_fma_put,
+  chpl_comm_ugni_op_fma_get,
+  chpl_comm_ugni_op_rdma_put,
+  chpl_comm_ugni_op_rdma_get,
+  chpl_comm_ugni_op_amo,
+  chpl_comm_ugni_op_chained,
+  chpl_comm_ugni_op_count
+} chpl_comm_ugni_op_t;
+
+#define CHPL_COMM_UGNI_LAT_HIST_BINS 16
+#define CHPL_COMM_UGNI_LAT_HIST_SHIFT 9
+
+typedef struct {
+  uint64_t cnt;
+  uint64_t nsecs;
+  uint64_t hist[CHPL_COMM_UGNI_LAT_HIST_BINS];
+} chpl_comm_ugni_latStats_t;
+
+typedef struct {
+  uint64_t acq_cnt;
+  uint64_t acq_wait_nsecs;
+  chpl_comm_ugni_latStats_t ops[chpl_comm_ugni_op_count];
+} chpl_comm_ugni_commDomStats_t;
+
+int chpl_comm_statsNumCommDoms(void);
+void chpl_comm_statsGetCommDom(int, chpl_comm_ugni_commDomStats_t*);
+
 #ifdef __cplusplus
 }
 #endif
@@ -26,8 +26,13 @@
 #include <sys/types.h>
 #include <stdlib.h>
 #include <inttypes.h>
+#include <string.h>
 #include <wchar.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "utf8-decoder.h"
 
 #ifdef __cplusplus
@@ -87,7 +92,7 @@ int chpl_enc_decode_char_buf_utf8(int32_t* CHPL_ENC_RESTRICT chr,
   uint32_t codepoint=0, state;
   int bytes_read = 0;
   state = 0;
-  while( buf != end ) {
+  while( buf + bytes_read != end ) {
     chpl_enc_utf8_decode(&state, &codepoint,
                          *((const unsigned char*)buf+bytes_read));
     bytes_read++;
@@ -200,10 +205,41 @@ int chpl_enc_decode_char_buf_wctype(int32_t* CHPL_ENC_RESTRICT chr,
 #endif
 }
 
+/*
+ * Returns the number of bytes at the start of `buf` that are ASCII.  Text is
+ * mostly ASCII, so this lets callers skip the byte-at-a-time decoder for
+ * long runs of it.  Checks 16 bytes at a time with SSE2 (which every x86-64
+ * processor has) and 8 bytes at a time otherwise.
+ *
+ * :arg buflen: Upper limit for number of bytes to read
+ */
+static inline
+ssize_t chpl_enc_ascii_prefix_len(const char* buf, ssize_t buflen) {
+  ssize_t i = 0;
+#ifdef __SSE2__
+  while (i + 16 <= buflen) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(buf + i));
+    if (_mm_movemask_epi8(v) != 0) break;
+    i += 16;
+  }
+#endif
+  while (i + 8 <= buflen) {
+    uint64_t w;
+    memcpy(&w, buf + i, sizeof(w));
+    if ((w & 0x8080808080808080ULL) != 0) break;
+    i += 8;
+  }
+  while (i < buflen && (unsigned char) buf[i] < 0x80) {
+    i++;
+  }
+  return i;
+}
+
 /*
  * Check if the bytes in the char buffer form a valid UTF8 sequence
  *
  * :arg buflen: Upper limit for number of bytes to read
+ * :arg num_cp: An out argument that stores the number of codepoints
  *
  * :returns: 0 if valid, -1 if illegal byte sequence
  */
@@ -211,10 +247,17 @@ static inline
 int chpl_enc_validate_buf(const char *buf, ssize_t buflen, int64_t *num_cp) {
   int32_t cp;
   int nbytes;
+  ssize_t nascii;
 
-  int offset = 0;
+  ssize_t offset = 0;
   *num_cp = 0;
   while (offset<buflen) {
+    // ASCII bytes are always valid and are one codepoint each
+    nascii = chpl_enc_ascii_prefix_len(buf+offset, buflen-offset);
+    offset += nascii;
+    *num_cp += nascii;
+    if (offset == buflen) break;
+
     // you can create a chapel string with a codepoint that represents an
     // escaped byte, so the last argument is true
     if (chpl_enc_decode_char_buf_utf8(&cp, &nbytes, buf+offset,
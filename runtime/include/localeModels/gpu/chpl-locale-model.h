@@ -28,6 +28,11 @@
 extern "C" {
 #endif
 
+//
+// The GPUs on a node are its sublocales; see chpl-gpu.h.
+//
+#define HAS_GPU_LOCALE
+
 //
 // This is the type of a global locale ID.
 //
@@ -164,4 +164,38 @@
 #  endif // __BYTE_ORDER
 #endif // ! htobe64
 
+// Swap every element of an array in place.  bswap_## may not exist
+// on BSD systems, so these spell out the swaps; they are plain loops
+// so that the compiler can recognize them and vectorize them.
+static inline
+void qio_bswap_array16(uint16_t* restrict p, size_t n) {
+  size_t i;
+  for( i = 0; i < n; i++ ) {
+    uint16_t x = p[i];
+    p[i] = (uint16_t) ((x >> 8) | (x << 8));
+  }
+}
+
+static inline
+void qio_bswap_array32(uint32_t* restrict p, size_t n) {
+  size_t i;
+  for( i = 0; i < n; i++ ) {
+    uint32_t x = p[i];
+    p[i] = (x >> 24) | ((x & 0x00ff0000u) >> 8) |
+           ((x & 0x0000ff00u) << 8) | (x << 24);
+  }
+}
+
+static inline
+void qio_bswap_array64(uint64_t* restrict p, size_t n) {
+  size_t i;
+  for( i = 0; i < n; i++ ) {
+    uint64_t x = p[i];
+    x = ((x & 0xffffffff00000000ull) >> 32) | ((x & 0x00000000ffffffffull) << 32);
+    x = ((x & 0xffff0000ffff0000ull) >> 16) | ((x & 0x0000ffff0000ffffull) << 16);
+    x = ((x & 0xff00ff00ff00ff00ull) >> 8)  | ((x & 0x00ff00ff00ff00ffull) << 8);
+    p[i] = x;
+  }
+}
+
 #endif // ! _BSWAP_H_
@@ -101,6 +101,12 @@ extern "C" {
 
 // how large is an iobuf?
 extern size_t qbytes_iobuf_size;
+// how many free iobufs does each thread keep for reuse?
+extern int qbytes_iobuf_cache_max;
+
+// Alignment of addresses, offsets and lengths for O_DIRECT I/O.
+// 4096 satisfies both 512-byte and 4K logical block devices.
+#define QBYTES_DIRECT_ALIGN 4096
 
 struct qbytes_s;
 
@@ -162,7 +168,16 @@ void qbytes_free_qio_free(qbytes_t* b);
 void _qbytes_init_generic(qbytes_t* ret, void* give_data, int64_t len, qbytes_free_t free_function);
 qioerr qbytes_create_generic(qbytes_t** out, void* give_data, int64_t len, qbytes_free_t free_function);
 qioerr _qbytes_init_iobuf(qbytes_t* ret);
+// Create an iobuf of qbytes_iobuf_size bytes.  These come from a
+// freelist per thread, and only newly allocated ones are zeroed.
 qioerr qbytes_create_iobuf(qbytes_t** out);
+
+// Create an iobuf suitable for O_DIRECT: its data is aligned to
+// QBYTES_DIRECT_ALIGN and its length is qbytes_iobuf_size rounded up
+// to a multiple of that.  These come from a small pool, so a reused
+// one is not zeroed.
+qioerr qbytes_create_direct_iobuf(qbytes_t** out);
+void qbytes_free_direct_iobuf(qbytes_t* b);
 qioerr _qbytes_init_calloc(qbytes_t* ret, int64_t len);
 
 // The caller is responsible for calling qbytes_release on the return value.
@@ -30,4 +30,9 @@
 #include "bulkget.h"
 #include "sys.h"
 #include "qio_popen.h"
+#include "qio_uring.h"
+#include "qio_split.h"
+#include "qio_stats.h"
+#include "qio_compress.h"
+#include "qio_s3.h"
 #include "qio_plugin_api.h"
@@ -27,6 +27,7 @@
 #include "sys.h"
 #include "qio_style.h"
 #include "qio_error.h"
+#include "qio_stats.h"
 
 #include <stddef.h>
 #include <stdio.h>
@@ -84,6 +85,7 @@ typedef uint32_t qio_hint_t;
 
 #ifdef _chplrt_H_
 #include "chpl-atomics.h"
+#include "chpl-locks.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -96,7 +98,7 @@ typedef qio_fdflag_t fdflag_t;
 
 // make a re-entrant lock.
 typedef struct {
-  atomic_spinlock_t lock;
+  chpl_ticket_lock_t lock;
   chpl_taskID_t owner; // task ID of owner.
   uint64_t count; // how many times owner has locked.
 } qio_lock_t;
@@ -109,12 +111,12 @@ void qio_unlock(qio_lock_t* x);
 static inline qioerr qio_lock_init(qio_lock_t* x) {
   x->owner = NULL_OWNER;
   x->count = 0;
-  atomic_init_spinlock_t(&x->lock);
+  chpl_ticket_lock_init(&x->lock, "qio_lock");
   return 0;
 }
 
 static inline void qio_lock_destroy(qio_lock_t* x) {
-  atomic_destroy_spinlock_t(&x->lock);
+  chpl_ticket_lock_destroy(&x->lock);
 }
 
 #ifdef __cplusplus
@@ -178,6 +180,9 @@ extern "C" {
 extern ssize_t qio_too_small_for_default_mmap;
 extern ssize_t qio_too_large_for_default_mmap;
 extern ssize_t qio_mmap_chunk_iobufs;
+extern ssize_t qio_mmap_chunk_max_iobufs;
+extern ssize_t qio_initial_mmap_max_readonly;
+extern int qio_mmap_hugepage;
 
 /* Wrap system calls readv, writev, preadv, pwritev
  * to take a buffer.
@@ -225,6 +230,8 @@ char* qio_chtype_to_string(qio_chtype_t type);
      -- noreuse -- pread/pwrite
      -- cached -- mmap for reads and writes
      -- force_readwrite
+     -- uring -- io_uring where available (or by default for seekable
+                 files with CHPL_RT_QIO_URING), otherwise pread/pwrite
  */
 
 #define QIO_HINT_AFTERCHTYPE 0x0010
@@ -235,13 +242,14 @@ typedef enum {
   QIO_METHOD_FREADFWRITE = 3*QIO_HINT_AFTERCHTYPE,
   QIO_METHOD_MMAP = 4*QIO_HINT_AFTERCHTYPE,
   QIO_METHOD_MEMORY = 5*QIO_HINT_AFTERCHTYPE,
+  QIO_METHOD_URING = 6*QIO_HINT_AFTERCHTYPE,
   //QIO_METHOD_LIBEVENT,
 } qio_method_t;
 #define QIO_METHODMASK 0x00f0
 #define QIO_HINT_AFTERMETHOD 0x0100
 #define QIO_METHOD_DEFAULT 0
 #define QIO_MIN_METHOD QIO_METHOD_READWRITE
-#define QIO_MAX_METHOD QIO_METHOD_MEMORY
+#define QIO_MAX_METHOD QIO_METHOD_URING
 
 enum {
   QIO_HINT_RANDOM       = QIO_HINT_AFTERMETHOD,
@@ -251,14 +259,14 @@ enum {
   QIO_HINT_CACHED       = QIO_HINT_BANDWIDTH<<1,
   QIO_HINT_PARALLEL     = QIO_HINT_CACHED<<1,
   QIO_HINT_DIRECT       = QIO_HINT_PARALLEL<<1,
-     // note -- if DIRECT is set, you must do aligned I/O;
-     // offset, request size must be 512-byte aligned, and
-     // user buffer must be page-aligned. This should more or
-     // less work the way you expect for a buffered channel,
-     // but you'll have to round out all files to a multiple of 512
-     // bytes. This library could help by turning off O_DIRECT when
-     // encountering improper alignment, but the linux open man page
-     // says:
+     // note -- if DIRECT is set, buffered channels get their
+     // buffers from an aligned pool (see qbytes_create_direct_iobuf)
+     // and I/O that is aligned to QBYTES_DIRECT_ALIGN goes straight to
+     // the device. Unaligned reads go through aligned bounce buffers
+     // and unaligned parts of writes (e.g. the tail of a file) are
+     // written with O_DIRECT turned off, so files keep their exact
+     // length. Keep I/O aligned where possible since the linux open
+     // man page says:
 //Applications should avoid mixing O_DIRECT and normal I/O to the same file, and
 //especially to overlapping byte regions in the same file.  Even when the file
 //system correctly handles the coherency issues in this situation, overall I/O
@@ -276,6 +284,11 @@ enum {
   // is opened within the qio implementation.  Otherwise, the user (or system)
   // has to close it.
   QIO_HINT_OWNED        = QIO_HINT_NOFAST<<1,
+
+  // Writes to stdout/stderr go to a per-task line buffer instead of the
+  // channel's buffer; see qio_linebuf.h.  Only applies to read/write
+  // channels on fd 1 or 2, which become unbuffered.
+  QIO_HINT_TASKLINEBUF  = QIO_HINT_OWNED<<1,
 };
 
 
@@ -336,6 +349,9 @@ char* qio_hints_to_string(qio_hint_t hint)
       case QIO_METHOD_MEMORY:
         strcat(buf, " memory"); ok = 1;
         break;
+      case QIO_METHOD_URING:
+        strcat(buf, " uring"); ok = 1;
+        break;
       // no default to get warned if any are added.
     }
   }
@@ -352,6 +368,7 @@ char* qio_hints_to_string(qio_hint_t hint)
   if( hint & QIO_HINT_NOREUSE ) strcat(buf, " noreuse");
   if( hint & QIO_HINT_NOFAST ) strcat(buf, " nofast");
   if( hint & QIO_HINT_OWNED ) strcat(buf, " owned");
+  if( hint & QIO_HINT_TASKLINEBUF ) strcat(buf, " tasklinebuf");
 
   return qio_strdup(buf);
 }
@@ -378,6 +395,8 @@ typedef struct qio_file_s {
 
   //void* fs_info; // Holds the filesystem information (as a user defined struct)
   void* file_info; // Holds the file information (as a user defined struct)
+  // C entry points for file_info; NULL to use the Chapel ones.
+  const struct qio_plugin_ops_s* plugin_ops;
 
   qio_fdflag_t fdflags;
   bool closed;
@@ -391,6 +410,10 @@ typedef struct qio_file_s {
   //  but the mapping is fixed for the lifetime of
   //  the file. That's so that no locking is necessary
   //  on the file object itself).
+
+  // I/O statistics from the file's closed channels (and its
+  // initial mapping). Updated atomically; see qio_stats.h.
+  qio_io_stats_t stats;
   
   // When writing files with buffered-mmap, we will mmap
   // the file in chunks. As a result, we might need to extend
@@ -452,6 +475,9 @@ qioerr qio_file_open_access_usr(qio_file_t** file_out, const char* pathname,
                                void* fs_info);
 
 qioerr qio_get_fs_type(qio_file_t* fl, int* out);
+// Sets *shared_out to 1 if the file is on a filesystem (Lustre, GPFS,
+// NFS, ...) that other nodes can open by the same path.
+qioerr qio_file_is_shared_fs(qio_file_t* fl, int* shared_out);
 qioerr qio_get_chunk(qio_file_t* fl, int64_t* len_out);
 qioerr qio_locales_for_region(qio_file_t* fl, off_t start, off_t end, const char*** locale_names_out, int64_t* num_locs_out);
 
@@ -584,11 +610,17 @@ qioerr qio_file_length(qio_file_t* f, int64_t *len_out);
  *      -- write data in any user-space buffers to disk
  *         (use sys_fsync to guarantee data is on disk).
  *
+ * -- transfer(read channel, int64_t len)
+ *      -- move data from a read channel to this one. Buffered data
+ *         is shared rather than copied, and on Linux data between
+ *         plain file descriptors is moved by the kernel with
+ *         copy_file_range, sendfile or splice.
+ *
  * FUTURE
  * -- readahead()
  *      -- system readahead in background
  * -- splice(output_channels[], int64_t len)
- *      -- copy an amount of data to some output channels
+ *      -- copy an amount of data to several output channels
  * -- tee(output_channels[], int64_t len)
 
  */
@@ -648,6 +680,13 @@ typedef struct qio_channel_s {
   qio_hint_t hints;
   qio_fdflag_t flags;
 
+  // read-ahead and write-behind state, for sequential channels;
+  // NULL if the channel does its I/O synchronously.
+  struct qio_channel_async_s* async;
+
+  // I/O statistics, protected by the channel lock.
+  qio_io_stats_t stats;
+
   // buffered channel materials.
   /* When reading, we 'require' then read from
    * right_mark_start to (potentially) heavy->av_end
@@ -1260,6 +1299,11 @@ int64_t qio_channel_end_offset_unlocked(qio_channel_t* ch)
 
 qioerr qio_channel_end_offset(const int threadsafe, qio_channel_t* ch, int64_t* offset_out);
 
+// Get the I/O statistics (see qio_stats.h) for a channel so far, or
+// for a file's channels that have been closed.
+qioerr qio_channel_get_stats(const int threadsafe, qio_channel_t* ch, qio_io_stats_t* stats_out);
+void qio_file_get_stats(qio_file_t* f, qio_io_stats_t* stats_out);
+
 
 qioerr qio_channel_advance(const int threadsafe, qio_channel_t* ch, int64_t nbytes);
 
@@ -1267,6 +1311,12 @@ qioerr qio_channel_put_bytes(const int threadsafe, qio_channel_t* ch, qbytes_t*
 
 qioerr qio_channel_put_buffer(const int threadsafe, qio_channel_t* ch, qbuffer_t* src, qbuffer_iter_t src_start, qbuffer_iter_t src_end);
 
+// Move len bytes (or everything up to EOF if len < 0) from the
+// reading channel src to the writing channel dst, without copying
+// through user space where possible. Returns EEOF with the amount
+// moved in *amt_out if fewer than len bytes were available.
+qioerr qio_channel_transfer(const int threadsafe, qio_channel_t* dst, qio_channel_t* src, int64_t len, int64_t* amt_out);
+
 
 static inline
 qioerr qio_channel_flush(const int threadsafe, qio_channel_t* ch)
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QIO_ASYNC_H_
+#define _QIO_ASYNC_H_
+
+#include "sys_basic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Background I/O threads for read-ahead and write-behind.
+//
+// A job is submitted to a small pool of pthreads, which runs its
+// function and then marks it done.  The submitting task can go on with
+// other work, and later waits with qio_async_wait(), which yields to
+// the tasking layer until the job finishes.
+//
+// Jobs only do system calls on memory the submitter set aside for
+// them; they must not call back into the tasking layer.
+
+typedef struct qio_async_job_s {
+  struct qio_async_job_s* next;
+  void (*fn)(struct qio_async_job_s*);
+  int done;
+} qio_async_job_t;
+
+// How many buffers may each sequential channel have in flight?
+// 0 if read-ahead and write-behind are disabled.  Set by
+// CHPL_RT_QIO_ASYNC_DEPTH.
+int qio_async_depth(void);
+
+// Run job->fn(job) on a background thread.
+void qio_async_submit(qio_async_job_t* job);
+
+// Wait for a submitted job to finish.
+void qio_async_wait(qio_async_job_t* job);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif
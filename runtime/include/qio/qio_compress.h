@@ -0,0 +1,92 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QIO_COMPRESS_H_
+#define _QIO_COMPRESS_H_
+
+#include "sys_basic.h"
+#include "qio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Compressed files.
+//
+// qio_file_open_compressed wraps a qio file holding compressed data in
+// a plugin file whose channels read and write the uncompressed bytes,
+// so the usual qio_channel_* calls work on it unchanged.
+//
+// The data is stored as a sequence of independently compressed blocks
+// of (by default) QIO_COMPRESS_DEFAULT_BLOCK uncompressed bytes, and
+// each block starts with a small header recording its compressed and
+// uncompressed sizes:
+//
+//  - gzip blocks are gzip members with a 'QZ' extra field holding the
+//    sizes (as BGZF does), so the whole file is still a valid gzip
+//    file that gunzip and zcat can read;
+//  - zstd and lz4 blocks are a skippable frame holding the sizes
+//    followed by a normal zstd or lz4 frame, so zstd -d and lz4 -d
+//    can read the file too.
+//
+// Opening a compressed file for reading walks the block headers to
+// build an index, which lets a channel start at any uncompressed
+// offset and lets several channels read different parts of the file
+// at once.  While a channel reads, it decompresses the next few blocks
+// on the qio async threads; while a channel writes, full blocks are
+// compressed on those threads and written in order.  The number of
+// blocks a channel keeps in flight is CHPL_RT_QIO_ASYNC_DEPTH (with 0
+// doing the work in the calling task).
+//
+// A compressed file is either read or written, not both, and writing
+// only appends: a writing channel has to start at the end of the
+// data and only one can be open at a time.
+//
+// Which codecs are available depends on the libraries the runtime was
+// built with (CHPL_QIO_COMPRESS); the others return ENOSYS.
+
+typedef enum {
+  QIO_COMPRESS_DETECT = 0, // reading only: use the codec the file has
+  QIO_COMPRESS_GZIP = 1,
+  QIO_COMPRESS_ZSTD = 2,
+  QIO_COMPRESS_LZ4 = 3,
+} qio_compress_codec_t;
+
+#define QIO_COMPRESS_DEFAULT_BLOCK (1024*1024)
+#define QIO_COMPRESS_MAX_BLOCK (1024*1024*1024)
+
+// Was support for this codec built in?
+int qio_compress_supported(int codec);
+
+// Open a compressed file on top of base, which is retained.
+// fdflags should have exactly one of QIO_FDFLAG_READABLE and
+// QIO_FDFLAG_WRITEABLE; base must be empty when writing.
+// level < 0 uses the codec's default level and block_size <= 0 uses
+// QIO_COMPRESS_DEFAULT_BLOCK; both are ignored when reading.
+qioerr qio_file_open_compressed(qio_file_t** file_out, qio_file_t* base,
+                                int codec, int level, int64_t block_size,
+                                qio_fdflag_t fdflags,
+                                const qio_style_t* style);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QIO_EVENT_H_
+#define _QIO_EVENT_H_
+
+#include "sys_basic.h"
+#include "sys.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Event-driven waiting for sockets.
+//
+// With CHPL_RT_QIO_EVENT_SOCKETS set, the sys_recv*, sys_send* and
+// sys_accept calls on a blocking socket don't block their pthread.
+// They try the operation without blocking, and if it would block they
+// register the socket with a single epoll set shared by the whole
+// locale and yield to the tasking layer until it is ready.  Whichever
+// waiting task gets there first polls the set on behalf of all of
+// them.  So many tasks can each be waiting on their own connection
+// while only a few worker threads are in use.
+//
+// Sockets the program itself made non-blocking keep returning EAGAIN
+// as usual.  Where epoll isn't available, qio_event_enabled() is
+// always false.
+
+// Should socket calls wait through the event loop?
+int qio_event_enabled(void);
+
+// Wait until fd is readable (writing == 0) or writable (writing != 0),
+// or has an error or hangup pending.
+err_t qio_event_wait(fd_t fd, int writing);
+
+// Called when fd is closed, to wake any tasks still waiting on it.
+void qio_event_forget(fd_t fd);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif
@@ -198,6 +198,19 @@ qioerr qio_channel_read_svarint(const int threadsafe, qio_channel_t* restrict ch
 qioerr qio_channel_write_uvarint(const int threadsafe, qio_channel_t* restrict ch, uint64_t num);
 qioerr qio_channel_write_svarint(const int threadsafe, qio_channel_t* restrict ch, int64_t num);
 
+// Reading/writing 'n' varints at once.  These take the channel lock once
+// and work directly on the channel buffer when they can.
+qioerr qio_channel_read_uvarints(const int threadsafe, qio_channel_t* restrict ch, uint64_t* restrict ptr, ssize_t n);
+qioerr qio_channel_read_svarints(const int threadsafe, qio_channel_t* restrict ch, int64_t* restrict ptr, ssize_t n);
+qioerr qio_channel_write_uvarints(const int threadsafe, qio_channel_t* restrict ch, const uint64_t* restrict ptr, ssize_t n);
+qioerr qio_channel_write_svarints(const int threadsafe, qio_channel_t* restrict ch, const int64_t* restrict ptr, ssize_t n);
+
+// Reading/writing an array of 'n' integers of 'elt_size' bytes (1, 2, 4
+// or 8) in 'byteorder', with one bulk copy and one byte swapping pass
+// rather than a channel call per element.
+qioerr qio_channel_read_ints(const int threadsafe, const int byteorder, qio_channel_t* restrict ch, void* restrict ptr, size_t elt_size, ssize_t n);
+qioerr qio_channel_write_ints(const int threadsafe, const int byteorder, qio_channel_t* restrict ch, const void* restrict ptr, size_t elt_size, ssize_t n);
+
 
 static inline
 qioerr qio_channel_read_int(const int threadsafe, const int byteorder, qio_channel_t* restrict ch, void* restrict ptr, size_t len, int issigned) {
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QIO_LINEBUF_H_
+#define _QIO_LINEBUF_H_
+
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per-task line buffering for stdout and stderr.
+//
+// With CHPL_RT_QIO_TASK_LINEBUF set, channels writing to stdout or
+// stderr don't share a channel buffer.  Each task collects what it
+// writes in a buffer of its own, and the buffer goes out to the fd in
+// whole lines, with one write under a per-fd lock, when it fills up,
+// when the channel is flushed, and when the task ends.  So lines from
+// different tasks never interleave, and a task writing a line doesn't
+// wait on the others except briefly when it actually writes.  Output
+// from different tasks comes out in the order the lines are written
+// to the fd, not the order the tasks wrote them.
+//
+// A channel gets this behavior if the buffering is enabled and it
+// writes to fd 1 or 2 with read/write, or if it is opened with
+// QIO_HINT_TASKLINEBUF.  Writes made outside of any task go straight
+// to the fd.
+
+typedef struct qio_linebuf_s qio_linebuf_t;
+
+// Is per-task line buffering turned on?
+int qio_linebuf_enabled(void);
+
+// Buffer len bytes from ptr in the current task's buffer for fd.
+// Same conventions as sys_write(); all of ptr is taken unless there
+// is an error writing out the buffer.
+int qio_linebuf_write(int fd, const void* ptr, size_t len,
+                      ssize_t* num_written_out);
+
+// Write out everything the current task has buffered for fd,
+// including any partial line.
+int qio_linebuf_flush(int fd);
+
+// Called by the tasking layer when a task ends, with a pointer to the
+// task's buffer pointer.  Writes out and frees the buffer.
+void qio_linebuf_task_end(qio_linebuf_t** lbp);
+
+// Write out every task's buffers.  Called at exit.
+void qio_linebuf_flush_all(void);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif
@@ -52,6 +52,31 @@ syserr chpl_qio_get_locales_for_region(void* file, int64_t start, int64_t end, v
 
 // close a file
 syserr chpl_qio_file_close(void* file);
+
+// Plugins written in C can provide these entry points directly
+// instead of going through the Chapel-exported ones above.  Each
+// member has the same meaning as the chpl_qio_ function of that name;
+// NULL members report ENOSYS.  The file_close entry point should free
+// the plugin's file state.
+typedef struct qio_plugin_ops_s {
+  qioerr (*setup_plugin_channel)(void* file, void** plugin_ch, int64_t start, int64_t end, qio_channel_t* qio_ch);
+  qioerr (*read_atleast)(void* plugin_ch, int64_t amt);
+  qioerr (*write)(void* plugin_ch, int64_t amt);
+  qioerr (*channel_close)(void* plugin_ch);
+  qioerr (*filelength)(void* file, int64_t* length);
+  qioerr (*getpath)(void* file, const char** str, int64_t* len);
+  qioerr (*fsync)(void* file);
+  qioerr (*get_chunk)(void* file, int64_t* length);
+  qioerr (*get_locales_for_region)(void* file, int64_t start, int64_t end, void **localeNamesPtr, int64_t* nLocales);
+  qioerr (*file_close)(void* file);
+} qio_plugin_ops_t;
+
+// Like qio_file_init_plugin, but calls ops instead of the
+// chpl_qio_ functions.  ops must outlive the file.
+qioerr qio_file_init_plugin_ops(qio_file_t** file_out, void* file_info,
+                                const qio_plugin_ops_t* ops,
+                                int fdflags, const qio_style_t* style);
+
 #ifdef __cplusplus
 }
 #endif
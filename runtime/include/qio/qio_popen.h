@@ -55,6 +55,11 @@ qioerr qio_openproc(const char** argv,
 qioerr qio_waitpid(int64_t pid,
                    int blocking, int* done, int* exitcode);
 
+// Start the persistent spawn helper if CHPL_RT_QIO_SPAWN_HELPER is
+// set.  Called once during startup, before the heap is set up, so the
+// fork is cheap; after that qio_openproc() never forks this process.
+void qio_spawn_helper_start(void);
+
 qioerr qio_proc_communicate(
     const int threadsafe,
     qio_channel_t* input,
@@ -56,6 +56,11 @@ typedef struct qio_regexp_options_s {
 
 void qio_regexp_init_default_options(qio_regexp_options_t* options);
 
+// Compiled regexps are cached, first per thread and then in a cache
+// shared by all threads, so that a pattern is compiled only once per
+// process.  The shared cache keeps the CHPL_RT_QIO_REGEXP_CACHE_SIZE
+// (default 256) most recently used patterns; 0 turns it off.
+
 // Returns true for ok
 // and if false return an error string in *err_str that must
 // be freed by the caller (and was made with qio_malloc())
@@ -142,6 +147,49 @@ int64_t qio_regexp_replace(qio_regexp_t* regexp, const char* repl, int64_t repl_
 //
 qioerr qio_regexp_channel_match(const qio_regexp_t* regexp, const int threadsafe, struct qio_channel_s* ch, int64_t maxlen, int anchor, qio_bool can_discard, qio_bool keep_unmatched, qio_bool keep_whole_pattern, qio_regexp_string_piece_t* submatch, int64_t nsubmatch);
 
+// Sets of regular expressions, for finding which of many patterns
+// match a string in one pass over it (rather than one pass per
+// pattern).  All patterns in a set share the options and anchoring
+// given when it is created.
+//
+// Patterns are added with qio_regexp_set_add, which returns the index
+// that identifies the pattern in match results, or -1 if the pattern
+// is invalid (with an error string in *err_str that must be freed by
+// the caller).  Once all patterns are added, qio_regexp_set_compile
+// prepares the set for matching; after that, the set can be matched
+// against from many tasks at once.
+typedef struct qio_regexp_set_s {
+  void* set;
+} qio_regexp_set_t;
+
+static inline
+qio_regexp_set_t qio_regexp_set_null(void)
+{
+  qio_regexp_set_t ret;
+  ret.set = NULL;
+  return ret;
+}
+
+void qio_regexp_set_create(const qio_regexp_options_t* options, int anchor, qio_regexp_set_t* set);
+int64_t qio_regexp_set_add(qio_regexp_set_t* set, const char* str, int64_t str_len, const char** err_str);
+qio_bool qio_regexp_set_compile(qio_regexp_set_t* set);
+void qio_regexp_set_destroy(qio_regexp_set_t* set);
+
+// Stores the indices of the patterns matching str, in increasing order,
+// in matched[0..nmatched-1] and returns how many patterns matched (which
+// can be more than nmatched).  Returns -1 if the set is not compiled or
+// if the matcher ran out of memory.
+int64_t qio_regexp_set_match(const qio_regexp_set_t* set, const char* str, int64_t str_len, int64_t* matched, int64_t nmatched);
+
+// Reads one record from the channel and matches the set against it, as
+// with qio_regexp_set_match.  The record ends just before the byte delim
+// (or at EOF, or after maxlen bytes); delim < 0 means the record is the
+// rest of the channel up to maxlen bytes.  The channel is left after the
+// record and its delimiter.  Returns EEOF if there was nothing left to
+// read, and otherwise stores the number of matching patterns in
+// *nfound_out.
+qioerr qio_regexp_set_channel_match(const qio_regexp_set_t* set, const int threadsafe, struct qio_channel_s* ch, int64_t maxlen, int32_t delim, int64_t* matched, int64_t nmatched, int64_t* nfound_out);
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
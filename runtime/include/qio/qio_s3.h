@@ -0,0 +1,80 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QIO_S3_H_
+#define _QIO_S3_H_
+
+#include "sys_basic.h"
+#include "qio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Objects in an S3-compatible object store.
+//
+// qio_file_open_s3 returns a plugin file for one object, so that
+// qio channels can read and write it without a staged local copy.
+//
+// A reading channel fetches the object with ranged GETs of
+// CHPL_RT_QIO_S3_CHUNK bytes (8 MiB by default), keeping several in
+// flight on their own connections and handing them to the channel
+// buffer in order.  How many depends on the file's and channel's
+// hints:
+//
+//  - QIO_HINT_SEQUENTIAL: CHPL_RT_QIO_S3_CONNECTIONS (8 by default);
+//  - no hint: half as many;
+//  - QIO_HINT_PARALLEL: 2, since many channels are expected to read
+//    their own parts of the object at once.
+//
+// A writing channel uploads the object with a multipart upload, one
+// part per chunk (at least the store's 5 MiB minimum), with up to
+// CHPL_RT_QIO_S3_CONNECTIONS parts in flight.  Objects smaller than a
+// chunk are written with a single PUT.  The new object appears when
+// the channel is closed; if any part fails, the upload is aborted and
+// the error is returned by the close.  As with other object stores,
+// an object is either read or written: a writing channel has to start
+// at offset 0 and only one can be open at a time.
+//
+// Requests are signed with AWS signature version 4 when
+// AWS_ACCESS_KEY_ID and AWS_SECRET_ACCESS_KEY are set (with
+// AWS_SESSION_TOKEN if present) for AWS_REGION (default us-east-1);
+// otherwise they are sent unsigned.
+//
+// This needs libcurl (build with CHPL_QIO_S3=curl); without it,
+// qio_file_open_s3 returns ENOSYS.
+
+#define QIO_S3_DEFAULT_CHUNK (8*1024*1024)
+#define QIO_S3_MIN_PART (5*1024*1024)
+
+// path is s3://bucket/key or bucket/key.  endpoint is the store's base
+// URL, e.g. http://localhost:9000; NULL uses CHPL_RT_QIO_S3_ENDPOINT
+// or else AWS for AWS_REGION.  fdflags should have exactly one of
+// QIO_FDFLAG_READABLE and QIO_FDFLAG_WRITEABLE.  Opening for reading
+// gets the object's length and returns ENOENT if it doesn't exist.
+qioerr qio_file_open_s3(qio_file_t** file_out, const char* path,
+                        const char* endpoint, qio_fdflag_t fdflags,
+                        qio_hint_t iohints, const qio_style_t* style);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QIO_SPLIT_H_
+#define _QIO_SPLIT_H_
+
+#include "sys_basic.h"
+#include "qio.h"
+#include "qio_regexp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Splitting a file into record-aligned ranges for parallel parsing.
+//
+// qio_file_split_records divides [start, end) of a file into nranges
+// ranges of about the same size, moving each interior boundary forward
+// to the start of the next record.  A record ends with the byte delim
+// (e.g. '\n'), or, if regexp is not NULL, with a match of regexp (so
+// e.g. "\r?\n" can be used).  The boundary is placed just after the
+// first delimiter that ends at or beyond the evenly spaced target
+// offset; a boundary with no delimiter after it moves to end.  Ranges
+// may be empty when records are longer than the ranges.
+//
+// bounds_out must have room for nranges+1 offsets; range i is
+// [bounds_out[i], bounds_out[i+1]).  bounds_out[0] is start and
+// bounds_out[nranges] is end.  If end is less than 0 the file's
+// length is used.
+
+qioerr qio_file_split_records(qio_file_t* file, int64_t start, int64_t end,
+                              int64_t nranges, int32_t delim,
+                              const qio_regexp_t* regexp,
+                              int64_t* bounds_out);
+
+// Open one channel for each range computed by qio_file_split_records.
+// channels_out must have room for nranges channels.  On an error, no
+// channels are returned.
+qioerr qio_file_open_split_channels(qio_file_t* file, qio_hint_t hints,
+                                    int readable, int writeable,
+                                    int64_t nranges, const int64_t* bounds,
+                                    qio_style_t* style,
+                                    qio_channel_t** channels_out);
+
+// Distributed reads of a file on a shared filesystem.
+//
+// Rather than having every locale read through the channel or file
+// owned by one locale, each locale can open the file itself and read
+// just its part.  The owning locale checks qio_file_is_shared_fs and
+// sends the path (from qio_file_path) to the readers.
+//
+// qio_file_split_locales divides [start, end) into nlocales ranges,
+// rounding each interior boundary to a multiple of the file's chunk
+// size (the stripe size on Lustre, see qio_get_chunk) so that
+// neighbouring locales don't contend for the same stripe.  bounds_out
+// is as for qio_file_split_records.  For files from a filesystem
+// plugin, qio_locales_for_region can then say which locales hold
+// each range.
+
+qioerr qio_file_split_locales(qio_file_t* file, int64_t start, int64_t end,
+                              int64_t nlocales, int64_t* bounds_out);
+
+// Open path read-only with a new fd on the calling locale for
+// reading [start, end).  Returns ENOTSUP if the file found at path
+// here is not on a shared filesystem, since then it may not be the
+// same file.  QIO_HINT_CACHED only prefetches [start, end) rather
+// than the whole file.
+qioerr qio_file_open_shared_region(qio_file_t** file_out, const char* path,
+                                   int64_t start, int64_t end,
+                                   qio_hint_t iohints,
+                                   const qio_style_t* style);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QIO_STATS_H_
+#define _QIO_STATS_H_
+
+#include "sys_basic.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// I/O statistics.
+//
+// When CHPL_RT_QIO_STATS is set, each channel counts the I/O it does
+// below the buffer: the bytes and system calls it used to fill or
+// drain its buffer (or, for unbuffered channels, to do each read or
+// write), the time spent blocked in those calls, and how often it
+// refilled, flushed, or mapped part of the file.  A channel's counts
+// are added to its file's and to the process totals when the channel
+// is closed, and the process totals are printed to stderr at
+// exit along with the page faults the process took (which is where
+// time reading mmap'd files goes).
+//
+// With the statistics off, the I/O paths only check a flag.
+
+typedef struct qio_io_stats_s {
+  int64_t bytes_read;
+  int64_t bytes_written;
+  int64_t read_calls;   // read-side system calls (or read-ahead requests)
+  int64_t write_calls;
+  int64_t read_ns;      // time blocked in them
+  int64_t write_ns;
+  int64_t refills;      // times a buffered reader needed more data
+  int64_t flushes;      // times a buffered writer wrote data out
+  int64_t mmaps;        // regions of the file mapped
+  int64_t mmap_bytes;
+  // iobuf freelist; these are only counted in the process totals
+  int64_t iobuf_hits;   // iobufs reused from a thread's freelist
+  int64_t iobuf_misses; // iobufs allocated
+  int64_t iobuf_remote_frees; // returned to the thread that created them
+} qio_io_stats_t;
+
+extern int qio_stats_state; // -1 until CHPL_RT_QIO_STATS is checked
+void qio_stats_setup(void);
+
+static inline
+int qio_stats_enabled(void)
+{
+  if( qio_stats_state < 0 ) qio_stats_setup();
+  return qio_stats_state;
+}
+
+// Turn statistics on or off (overriding CHPL_RT_QIO_STATS).  Channels
+// only count while statistics are on.
+void qio_stats_enable(int on);
+
+// A monotonic clock, in nanoseconds.
+int64_t qio_stats_now_ns(void);
+
+// Atomically add the counts in src to dst.
+void qio_stats_add(qio_io_stats_t* dst, const qio_io_stats_t* src);
+
+// Atomically read the counts in src.
+void qio_stats_get(const qio_io_stats_t* src, qio_io_stats_t* out);
+
+// Totals for the process so far.
+void qio_stats_get_global(qio_io_stats_t* out);
+void qio_stats_add_global(const qio_io_stats_t* src);
+
+// Print the process totals to f.
+void qio_stats_print(FILE* f);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif
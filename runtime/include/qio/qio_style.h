@@ -186,6 +186,8 @@ typedef struct qio_style_s {
 
   // realfmt does not apply to integers.
   uint8_t realfmt; //0 -> print with %g; 1 -> print with %f; 2 -> print with %e
+                   //3 -> print the shortest digits that read back
+                   //     exactly, laid out like %.17g (ignores precision)
 
   // Other data type choices
   //
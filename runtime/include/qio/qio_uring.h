@@ -0,0 +1,69 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QIO_URING_H_
+#define _QIO_URING_H_
+
+#include "sys_basic.h"
+#include "qio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Support for QIO_METHOD_URING.
+//
+// Requests are submitted to a single io_uring shared by the whole
+// process.  A task whose request is in flight yields to the tasking
+// layer while it waits rather than blocking its pthread in a system
+// call, and requests from different tasks that arrive close together
+// go to the kernel in one submission.
+//
+// When the kernel (or the headers we were built with) doesn't support
+// io_uring, qio_uring_available() returns false and choose_io_method()
+// uses QIO_METHOD_PREADPWRITE instead.
+
+// Can we use io_uring?  The ring is set up on the first call.
+int qio_uring_available(void);
+
+// Should io_uring be used for seekable files when no method is
+// requested?  Set by CHPL_RT_QIO_URING.
+int qio_uring_is_default(void);
+
+// These mirror qio_preadv/qio_pwritev: they transfer between the file
+// and the part of buf between start and end, at seek_to_offset.
+qioerr qio_uring_preadv(qio_file_t* file, qbuffer_t* buf,
+                        qbuffer_iter_t start, qbuffer_iter_t end,
+                        int64_t seek_to_offset, ssize_t* num_read);
+qioerr qio_uring_pwritev(qio_file_t* file, qbuffer_t* buf,
+                         qbuffer_iter_t start, qbuffer_iter_t end,
+                         int64_t seek_to_offset, ssize_t* num_written);
+
+// These mirror sys_pread/sys_pwrite.
+err_t qio_uring_pread(fd_t fd, void* buf, size_t count, off_t offset,
+                      ssize_t* num_read_out);
+err_t qio_uring_pwrite(fd_t fd, const void* buf, size_t count, off_t offset,
+                       ssize_t* num_written_out);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif
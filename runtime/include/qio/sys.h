@@ -50,6 +50,24 @@ static inline int chpl_macro_int_errno(void) { return errno; }
 #define LUSTRE_SUPER_MAGIC     0x0BD00BD0
 #endif
 
+// Other filesystems that every node of a cluster typically shares,
+// also from the statfs man page (GPFS from its headers).
+#ifndef NFS_SUPER_MAGIC
+#define NFS_SUPER_MAGIC        0x6969
+#endif
+#ifndef GPFS_SUPER_MAGIC
+#define GPFS_SUPER_MAGIC       0x47504653
+#endif
+#ifndef CIFS_MAGIC_NUMBER
+#define CIFS_MAGIC_NUMBER      0xFF534D42
+#endif
+#ifndef SMB2_MAGIC_NUMBER
+#define SMB2_MAGIC_NUMBER      0xFE534D42
+#endif
+#ifndef CEPH_SUPER_MAGIC
+#define CEPH_SUPER_MAGIC       0x00C36400
+#endif
+
 // TAKZ - In the case where we are unable to include statfs or fstatfs, we need to
 // have a struct defined. As well, the Mac and linux statfs structs differ on what
 // different field names represent, and this way we have a uniform struct across all
@@ -151,6 +169,8 @@ err_t sys_feof(FILE* stream, int *iseof);
 err_t sys_ferror(FILE* stream);
 err_t sys_posix_fadvise(fd_t fd, off_t offset, off_t len, int advice);
 err_t sys_posix_madvise(void* addr, size_t len, int advice);
+// madvise, for advice posix_madvise doesn't have (e.g. MADV_HUGEPAGE)
+err_t sys_madvise(void* addr, size_t len, int advice);
 
 // returns an allocated string in string_out, which must be freed.
 err_t sys_strerror(err_t error, const char** string_out);
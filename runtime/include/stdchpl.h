@@ -49,6 +49,7 @@
 #include "chpl-export-wrappers.h"
 #include "chpl-external-array.h"
 #include "chpl-file-utils.h"
+#include "chpl-gpu.h"
 #include <chplfp.h>
 #include "chplglob.h"
 #include "chplio.h"
@@ -104,5 +104,12 @@
 #endif
 #endif
 
+// Hint to the C compiler that the condition 'x' is rarely true.
+#ifdef __GNUC__
+#define CHPL_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define CHPL_UNLIKELY(x) (x)
+#endif
+
 
 #endif
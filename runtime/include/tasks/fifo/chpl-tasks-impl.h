@@ -65,6 +65,7 @@ typedef struct {
   chpl_thread_mutex_t lock;
   chpl_thread_condvar_t signal_full;  // wait for full; signal this when full
   chpl_thread_condvar_t signal_empty; // wait for empty; signal this when empty
+  uint32_t            spin_hint;    // adaptive spin limit; chpl-sync-wait.h
   //  threadlayer_sync_aux_t tl_aux;
 } chpl_sync_aux_t;
 
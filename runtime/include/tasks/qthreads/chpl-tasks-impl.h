@@ -64,6 +64,7 @@ typedef struct {
     int       is_full;
     aligned_t signal_full;
     aligned_t signal_empty;
+    uint32_t  spin_hint;    // adaptive spin limit; see chpl-sync-wait.h
 } chpl_sync_aux_t;
 
 #ifdef __cplusplus
@@ -151,12 +151,16 @@ you get a full barrier ).
 
 == Implementation Notes ==
 
-The cache itself is a 2Q cache (because this kind of cache is reported to have
-better efficiency than a plain LRU). Besides being in a queue of one sort or
+The cache itself is a 2Q cache by default (because this kind of cache is
+reported to have better efficiency than a plain LRU). CLOCK and ARC
+replacement policies are also available; see 'Tuning' below. Besides being in a queue of one sort or
 another, entries are also stored in a 'pointer tree' which is a two-level
 'hashtable' where the hash function just selects different portions of the
 remote address. The pointer tree uses separate chaining (ie, each hash table
 element is actually a linked list of elements that go into that bucket).
+Before walking the pointer tree, lookups check a small direct-mapped memo
+of recently found entries (the 'L0', see struct lookup_memo_s), since
+fine-grained access loops tend to hit the same few pages over and over.
 
 The cache consists of 'cache entries', one per 'cache page'. A 'cache page' is
 1024 bytes in the current implementation. The pointer tree and the 2Q queues
@@ -181,6 +185,77 @@ from an 8 byte request. We chose 1024 bytes for the cache page size because it
 is the smallest request size that allows close to peak bandwidth in our
 network.
 
+== Tuning ==
+
+The following environment variables adjust the cache without rebuilding
+the runtime. They are read once, at startup.
+
+  CHPL_RT_CACHE_PAGES        number of cache pages per cache (rounded
+                             up to a power of 2; default 1024)
+  CHPL_RT_CACHE_DIRTY_PAGES  how many pages can be dirty at once
+                             (default 16 + pages/64)
+  CHPL_RT_CACHE_PENDING      maximum number of pending nonblocking
+                             operations (rounded up to a power of 2;
+                             default 32)
+  CHPL_RT_CACHE_POLICY       replacement policy: 2q (the default),
+                             clock, or arc
+  CHPL_RT_CACHE_WRITE_COMBINE_GAP
+                             largest clean gap (in bytes) between dirty
+                             regions of a page that write-back may fill
+                             in with cached data (default 0, never)
+
+The cache page and line size are still set at compile time (see
+CACHEPAGE_BITS and CACHELINE_BITS) since they determine the size of
+the per-entry bitmasks.
+
+The replacement policy is implemented by a small table of functions
+(struct cache_policy_s) that decide what happens when an entry is used
+again and which entry to evict. All policies share the Ain, Aout and Am
+queues:
+
+  - 2Q uses them as described in the 2Q paper.
+  - CLOCK keeps every entry in Ain and gives entries that were used
+    since the last sweep a second chance by moving them back to the head
+    of Ain. It does not remember evicted entries.
+  - ARC uses Ain as T1 (seen once), Am as T2 (seen more than once),
+    Aout as B1 (evicted from T1) and an additional queue, Bout, as B2
+    (evicted from T2). Hits in B1 or B2 adjust the target size of T1.
+
+Each cache counts hits, misses, hits on remembered evicted entries, and
+evictions; chpl_cache_print_stats reports these along with the policy.
+
+== Per-call-site statistics ==
+
+Setting CHPL_RT_CACHE_SITE_STATS=true makes each cache count, for each
+source location (the ln/fn passed to the cache entry points), the GET
+and PUT hits and misses, the pages evicted to make room for that
+location's accesses, and the lines that sequential and strided readahead
+fetched for it but that were never used (readahead waste). The
+counters live in a small open-addressed table in each cache. Like the
+rest of the cache, this table is only touched by the pthread (or task)
+that owns the cache, so it needs no locks. The table of a cache is
+merged into a locale-wide table when the cache is destroyed, and at
+exit the live caches are merged as well. Then the top
+CHPL_RT_CACHE_SITE_STATS_TOP (default 20) locations are printed, ranked
+by misses plus evictions plus wasted lines. Evictions and waste are
+charged to the location whose operation was running at the time, so
+they are approximate when tasks on one pthread interleave.
+
+== Tasks that migrate between threads ==
+
+Normally there is one cache per pthread, shared by all the tasks that
+run on it, and a task's fences only work on the cache of the pthread it
+runs on. If the tasking layer can move a task to another pthread (for
+example qthreads with work stealing), the task would leave its dirty
+data and its fence state behind. It could even move in the middle of a
+cache operation, whenever that operation yields. So when
+chpl_task_canMigrateThreads() is true, each task gets a cache of its own
+instead. The cache is stored in the task's private data and so it moves
+with the task. It is created on the task's first cached operation, and
+it is flushed and freed by chpl_cache_task_end when the task finishes.
+Since these caches are per task, they are smaller by default
+(DEFAULT_TASK_CACHE_PAGES).
+
 When processing a GET, we first check to see if the requested cache page is
 in the pointer tree. If not, we find an unused cache page and immediately start
 a nonblocking get into the appropriate portion of that page. While the get is
@@ -198,6 +273,16 @@ buffer.
 When processing GETs on adjacent memory locations, the cache triggers
 both synchronous and asynchronous read-ahead.
 
+Accesses that skip through remote memory with a fixed, non-unit stride
+(e.g. walking a column of a row-major array, or a halo exchange) never
+look sequential, so each access would otherwise be a cold miss. To handle
+these, each cache keeps a small table of 'stride streams', one per
+(node, task) pair, recording the address of recent misses. Once a stream
+has seen the same stride several times in a row, the cache prefetches
+the next few addresses at that stride. Lines brought in this way are
+marked so that a later hit on them can be counted separately and can
+keep the stream going.
+
 When processing a PUT, we similarly check for the requested cache page in the
 pointer tree and use an unused page if not. We find a unused 'dirty entry' to
 track the dirty bits of the cache page if the cache entry does not already have
@@ -281,6 +366,7 @@ use.
 #include "chpl-cache.h"
 #include "chpl-comm-strd-xfer.h"
 #include "chpl-linefile-support.h"
+#include "chpl-topo.h" // chpl_topo_getLLCSizePerCPU()
 #include "sys.h" // sys_page_size()
 #include "chpl-comm-compiler-macros.h"
 #include "chpl-comm-no-warning-macros.h" // No warnings for chpl_comm_get etc.
@@ -304,8 +390,17 @@ use.
 #define EXTRA_YIELDS 0
 
 // How many pending operations can we have at once?
+// This is the default, which can be changed with CHPL_RT_CACHE_PENDING.
 #define MAX_PENDING 32
 
+// How many pages are in each cache by default?
+// This can be changed with CHPL_RT_CACHE_PAGES.  When the last level
+// cache size is known, the default is instead one CPU's share of it,
+// but no more than this.
+#define DEFAULT_CACHE_PAGES 1024
+// ... and in each per-task cache, when caches follow tasks
+#define DEFAULT_TASK_CACHE_PAGES 64
+
 // CACHEPAGE_BITS
 // Controls the cache page size - the cache manages items of this many bytes
 // but also includes facilities for partial pages (valid and dirty bits).
@@ -351,6 +446,16 @@ typedef int16_t entry_id_t;
 
 #define MAX_SEQUENTIAL_READAHEAD_BYTES (MAX_PAGES_PER_PREFETCH*CACHEPAGE_SIZE)
 
+// Should we enable readahead for strided access?
+#define ENABLE_READAHEAD_TRIGGER_STRIDED 1
+
+// How many (node, task) access streams do we track for stride detection?
+#define STRIDE_STREAMS 8
+// How many times in a row must a stride repeat before we prefetch?
+#define STRIDE_CONFIDENCE 2
+// How many strides ahead of the current access do we prefetch?
+#define STRIDE_READAHEAD_DEPTH 4
+
 // These defines can enable different kinds of debugging output.
 
 //#define TIME
@@ -505,6 +610,17 @@ struct cache_table_slot_s {
   struct cache_table_entry_s m[TABLE_ENTRIES_PER_SLOT];
 };
 
+// The lookup memo ("L0"): recently found page -> entry mappings.
+// An entry is only memoized while it is in the pointer tree;
+// tree_remove clears its memo slot.
+#define LOOKUP_MEMO_BITS 4
+#define LOOKUP_MEMO_SIZE (1 << LOOKUP_MEMO_BITS)
+struct lookup_memo_s {
+  raddr_t raddr;   // always aligned to CACHEPAGE_SIZE
+  c_nodeid_t node;
+  struct cache_entry_s* entry; // NULL means nothing memoized here
+};
+
 // List for storing free pages. ~16 bytes/page
 // TODO: could convert many of the next sections to use cache base-relative
 // addressing and as a result save about 1/2 the space.
@@ -530,6 +646,7 @@ struct dirty_entry_s {
 #define QUEUE_AIN 1
 #define QUEUE_AOUT 2
 #define QUEUE_AM 3
+#define QUEUE_BOUT 4
 
 static inline
 raddr_t raddr_max(raddr_t a, raddr_t b)
@@ -543,7 +660,7 @@ raddr_t raddr_min(raddr_t a, raddr_t b)
 }
 
 // This entry stores the main information for the cache.
-// ~88 bytes. TODO: can we shrink it to 64 bytes?
+// ~96 bytes. TODO: can we shrink it to 64 bytes?
 struct cache_entry_s {
   struct cache_list_entry_s base; // contains raddr, node, next offset
   // Queue information. This entry could be in Ain, Aout, or Am queues.
@@ -556,6 +673,9 @@ struct cache_entry_s {
   // Set it to the task_local pointer for the task reserving the entry.
   chpl_cache_taskPrvData_t* entryReservedByTask;
 
+  // Set when the entry is used again; cleared by the CLOCK policy's sweep.
+  int referenced;
+
   // Readahead information.
   readahead_distance_t readahead_skip;
   readahead_distance_t readahead_len; // == 0 if this page doesn't trigger readahead.
@@ -567,6 +687,13 @@ struct cache_entry_s {
   unsigned char* page;
   // Which of the cache lines have we done 'get's for?
   uint64_t valid_lines[CACHE_LINES_PER_PAGE_BITMASK_WORDS];
+  // Which of the valid lines were brought in by strided readahead
+  // and have not been used yet?
+  uint64_t strided_lines[CACHE_LINES_PER_PAGE_BITMASK_WORDS];
+  // Which of the valid lines were brought in by any readahead and have
+  // not been used yet? Only kept with per-call-site statistics.
+  uint64_t readahead_lines[CACHE_LINES_PER_PAGE_BITMASK_WORDS];
+  int readahead_site; // site whose access triggered that readahead
   // dirty info if this cache page is dirty, NULL otherwise.
   struct dirty_entry_s* dirty;
   // What is the minimum sequence number stored in this cache entry?
@@ -606,12 +733,27 @@ static void unset_valid_lines(uint64_t* valid, uintptr_t skip, uintptr_t len)
   unset_valids_for_skip_len(valid, myvalid, skip, len, CACHE_LINES_PER_PAGE_BITMASK_WORDS);
 }
 
+// This tracks recent cache misses for one (node, task) pair
+// in order to detect strided access patterns.
+struct stride_stream_s {
+  chpl_cache_taskPrvData_t* task; // NULL if this stream is unused
+  c_nodeid_t node;
+  raddr_t last_addr;  // line address of the last access in the stream
+  intptr_t stride;    // last observed distance between accesses, in bytes
+  int confidence;     // how many times in a row we have seen stride
+};
+
+struct cache_policy_s;
+
 struct rdcache_s {
-  // A 2Q cache.
+  // A 2Q cache (by default).
   // See "2Q: A Low Overhead High Performance Buffer Management
   //      Replacement Algorithm"
   //    by Theodore Johnson and Dennis Sasha, Proc 20th VLDB conference, 1994.
 
+  // The replacement policy in use.
+  const struct cache_policy_s* policy;
+
   // The next request number -- there is currently no request or cache
   // element with this sequence number.
   cache_seqn_t next_request_number;
@@ -623,6 +765,11 @@ struct rdcache_s {
   c_nodeid_t last_cache_miss_read_node;
   raddr_t last_cache_miss_read_addr;
 
+  // Access streams used to detect strided access patterns.
+  // New streams replace old ones in round-robin order.
+  int stride_streams_next;
+  struct stride_stream_s stride_streams[STRIDE_STREAMS];
+
   // Used with the lookup table. This is the number of bits
   // for the number of table slots.
   int table_bits;
@@ -690,6 +837,27 @@ struct rdcache_s {
   struct cache_entry_s* am_lru_head;
   struct cache_entry_s* am_lru_tail;
 
+  // Bout, a FIFO queue of entries fallen off of Am (used only by ARC)
+  // Together, Aout and Bout store at most aout_max entries.
+  unsigned int bout_current; // current length of bout list
+  struct cache_entry_s *bout_head;
+  struct cache_entry_s *bout_tail;
+
+  // ARC's adaptive target for the length of Ain
+  unsigned int arc_target;
+
+  // Replacement policy statistics
+  uint64_t policy_hits;       // found a page in the cache
+  uint64_t policy_misses;     // had to add a page to the cache
+  uint64_t policy_ghost_hits; // misses that hit Aout or Bout
+  uint64_t policy_evictions;  // pages evicted from the cache
+
+  // Per-call-site statistics (NULL unless CHPL_RT_CACHE_SITE_STATS)
+  struct cache_site_stats_s* site_stats;
+  int cur_site;                   // index of the current op's site, or -1
+  uint64_t site_stats_dropped;    // ops whose site didn't fit in the table
+  struct rdcache_s* site_stats_next; // list of caches with site stats
+
   // List of dirty pages (for write-combining)
   int num_dirty_pages;
   struct dirty_entry_s *dirty_lru_head;
@@ -703,6 +871,9 @@ struct rdcache_s {
   chpl_comm_nb_handle_t *pending;
   cache_seqn_t *pending_sequence_numbers;
 
+  // Memo of recent lookups, checked before the lookup table
+  struct lookup_memo_s lookup_memo[LOOKUP_MEMO_SIZE];
+
   // Lookup table
   __attribute__ ((aligned (64)))
   struct cache_table_slot_s table[];
@@ -754,6 +925,215 @@ static void check_line_aligned(void* ptr)
   assert(((intptr_t) ptr) % 64 == 0);
 }
 
+struct cache_policy_s {
+  const char* name;
+  // Called when an entry in Ain or Am is used again.
+  void (*use)(struct rdcache_s* cache, struct cache_entry_s* entry);
+  // Called when an entry in Aout or Bout is needed again,
+  // just before make_entry moves it to Am. Can be NULL.
+  void (*ghost_hit)(struct rdcache_s* cache, struct cache_entry_s* entry);
+  // Evicts an entry in order to free up a page.
+  void (*reclaim)(struct rdcache_s* cache,
+                  chpl_cache_taskPrvData_t* task_local,
+                  int give_up_if_locked);
+};
+
+static const struct cache_policy_s cache_policy_2q;
+static const struct cache_policy_s cache_policy_clock;
+static const struct cache_policy_s cache_policy_arc;
+
+// Cache geometry and policy, shared by the caches of all pthreads.
+// These are set in chpl_cache_do_init from CHPL_RT_CACHE_* variables.
+static int cache_config_pages = DEFAULT_CACHE_PAGES;
+static int cache_config_dirty_pages = 16 + DEFAULT_CACHE_PAGES / 64;
+static unsigned int cache_config_pending = MAX_PENDING;
+static int cache_config_write_combine_gap = 0;
+static const struct cache_policy_s* cache_config_policy = &cache_policy_2q;
+// Does each task have its own cache? (set when tasks can migrate threads)
+static int cache_follows_task = 0;
+// How many call sites to report, if keeping per-call-site statistics
+static int cache_config_site_stats = 0;
+
+
+// Per-call-site statistics
+
+#define SITE_STATS_BITS 10
+#define SITE_STATS_MERGED_BITS 14
+// How far to probe before giving up on finding a slot
+#define SITE_STATS_PROBES 16
+
+struct cache_site_stats_s {
+  int used;
+  int ln;
+  int32_t fn;
+  uint64_t get_hits;
+  uint64_t get_misses;
+  uint64_t put_hits;
+  uint64_t put_misses;
+  uint64_t evictions;
+  uint64_t readahead_lines;  // lines fetched by readahead for this site
+  uint64_t readahead_waste;  // ... that were never used
+};
+
+// Caches with site statistics, and the merged statistics of destroyed
+// caches. Only used when caches are created, destroyed, and at exit.
+static pthread_mutex_t site_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct rdcache_s* site_stats_caches = NULL;
+static struct cache_site_stats_s* site_stats_merged = NULL;
+static uint64_t site_stats_merged_dropped = 0;
+
+static inline
+unsigned int site_stats_hash(int ln, int32_t fn)
+{
+  return ((uint32_t) fn * 2654435761u) ^ ((uint32_t) ln * 40503u);
+}
+
+// Find (adding if necessary) the slot for a site in a table
+// with 2^bits slots. Returns -1 if the table is too full.
+static
+int site_stats_find(struct cache_site_stats_s* table, int bits,
+                    int ln, int32_t fn)
+{
+  unsigned int mask = (1u << bits) - 1;
+  unsigned int h = site_stats_hash(ln, fn);
+  int i;
+
+  for( i = 0; i < SITE_STATS_PROBES; i++ ) {
+    struct cache_site_stats_s* s = &table[(h + i) & mask];
+    if( ! s->used ) {
+      s->used = 1;
+      s->ln = ln;
+      s->fn = fn;
+      return (h + i) & mask;
+    }
+    if( s->ln == ln && s->fn == fn ) return (h + i) & mask;
+  }
+  return -1;
+}
+
+// Record which site the current cache operation is for.
+static inline
+void site_stats_begin(struct rdcache_s* cache, int ln, int32_t fn)
+{
+  if( cache->site_stats ) {
+    cache->cur_site = site_stats_find(cache->site_stats, SITE_STATS_BITS,
+                                      ln, fn);
+    if( cache->cur_site < 0 ) cache->site_stats_dropped++;
+  }
+}
+
+static inline
+struct cache_site_stats_s* site_stats_cur(struct rdcache_s* cache)
+{
+  if( cache->site_stats && cache->cur_site >= 0 )
+    return &cache->site_stats[cache->cur_site];
+  return NULL;
+}
+
+// Forget any unused readahead lines in the given lines of a page,
+// counting them as waste for the site that asked for the readahead.
+// Note skip/len are in line numbers, NOT byte offsets!
+static
+void site_stats_readahead_unused(struct rdcache_s* cache,
+                                 struct cache_entry_s* entry,
+                                 uintptr_t skip, uintptr_t len)
+{
+  uint64_t before = 0, after = 0;
+  int i;
+
+  if( ! cache->site_stats ) return;
+
+  for( i = 0; i < CACHE_LINES_PER_PAGE_BITMASK_WORDS; i++ )
+    before += chpl_bitops_popcount_64(entry->readahead_lines[i]);
+  if( before == 0 ) return;
+
+  unset_valid_lines(entry->readahead_lines, skip, len);
+
+  for( i = 0; i < CACHE_LINES_PER_PAGE_BITMASK_WORDS; i++ )
+    after += chpl_bitops_popcount_64(entry->readahead_lines[i]);
+
+  if( entry->readahead_site >= 0 )
+    cache->site_stats[entry->readahead_site].readahead_waste += before - after;
+}
+
+static
+void site_stats_merge(struct cache_site_stats_s* into, int into_bits,
+                      uint64_t* into_dropped,
+                      struct cache_site_stats_s* from, int from_bits)
+{
+  int i, j;
+
+  for( i = 0; i < (1 << from_bits); i++ ) {
+    struct cache_site_stats_s* f = &from[i];
+    struct cache_site_stats_s* t;
+    if( ! f->used ) continue;
+    j = site_stats_find(into, into_bits, f->ln, f->fn);
+    if( j < 0 ) {
+      (*into_dropped)++;
+      continue;
+    }
+    t = &into[j];
+    t->get_hits += f->get_hits;
+    t->get_misses += f->get_misses;
+    t->put_hits += f->put_hits;
+    t->put_misses += f->put_misses;
+    t->evictions += f->evictions;
+    t->readahead_lines += f->readahead_lines;
+    t->readahead_waste += f->readahead_waste;
+  }
+}
+
+static
+void site_stats_register(struct rdcache_s* cache)
+{
+  cache->site_stats = chpl_calloc(1 << SITE_STATS_BITS,
+                                  sizeof(struct cache_site_stats_s));
+  pthread_mutex_lock(&site_stats_lock);
+  cache->site_stats_next = site_stats_caches;
+  site_stats_caches = cache;
+  pthread_mutex_unlock(&site_stats_lock);
+}
+
+// Merge the cache's statistics into the locale-wide table and forget it.
+static
+void site_stats_unregister(struct rdcache_s* cache)
+{
+  struct rdcache_s** p;
+
+  pthread_mutex_lock(&site_stats_lock);
+  for( p = &site_stats_caches; *p; p = &(*p)->site_stats_next ) {
+    if( *p == cache ) {
+      *p = cache->site_stats_next;
+      break;
+    }
+  }
+  if( site_stats_merged == NULL )
+    site_stats_merged = chpl_calloc(1 << SITE_STATS_MERGED_BITS,
+                                    sizeof(struct cache_site_stats_s));
+  site_stats_merge(site_stats_merged, SITE_STATS_MERGED_BITS,
+                   &site_stats_merged_dropped,
+                   cache->site_stats, SITE_STATS_BITS);
+  site_stats_merged_dropped += cache->site_stats_dropped;
+  pthread_mutex_unlock(&site_stats_lock);
+
+  chpl_free(cache->site_stats);
+  cache->site_stats = NULL;
+}
+
+static
+uint64_t site_stats_badness(const struct cache_site_stats_s* s)
+{
+  return s->get_misses + s->put_misses + s->evictions + s->readahead_waste;
+}
+
+static
+int site_stats_cmp(const void* a, const void* b)
+{
+  uint64_t x = site_stats_badness((const struct cache_site_stats_s*) a);
+  uint64_t y = site_stats_badness((const struct cache_site_stats_s*) b);
+  return (x < y) - (x > y); // descending
+}
+
 // aka create_cache
 static
 struct rdcache_s* cache_create(void) {
@@ -773,13 +1153,13 @@ struct rdcache_s* cache_create(void) {
 
   size_t total_size = 0;
   size_t allocated_size = 0;
-  unsigned int pending_len = MAX_PENDING;
+  unsigned int pending_len = cache_config_pending;
   unsigned char* buffer;
   unsigned char* pages;
 
   // This used to grow based on the number of locales, but that
   // would mean increasing memory usage per node, which isn't acceptable.
-  cache_pages = 1024;
+  cache_pages = cache_config_pages;
 
   ain_pages = cache_pages / 4; // 2Q: "Kin should be 25% of page slots"
                                // but here we set it smaller so that
@@ -788,8 +1168,12 @@ struct rdcache_s* cache_create(void) {
   aout_pages = cache_pages / 2; // 2Q: "Kout should hold identifiers for as
                                 // many pages as would fit in 50% of the
                                 // buffer"
+  // CLOCK keeps everything in Ain.
+  if (cache_config_policy == &cache_policy_clock)
+    ain_pages = cache_pages;
+
   // How many pages can be dirty at once?
-  dirty_pages = 16 + cache_pages / 64;
+  dirty_pages = cache_config_dirty_pages;
 
   // How many cache entries do we need?
   n_entries = cache_pages + aout_pages;
@@ -867,6 +1251,15 @@ struct rdcache_s* cache_create(void) {
   c->last_cache_miss_read_node = -1;
   c->last_cache_miss_read_addr = 0;
 
+  c->stride_streams_next = 0;
+  for( i = 0; i < STRIDE_STREAMS; i++ ) {
+    c->stride_streams[i].task = NULL;
+    c->stride_streams[i].node = -1;
+    c->stride_streams[i].last_addr = 0;
+    c->stride_streams[i].stride = 0;
+    c->stride_streams[i].confidence = 0;
+  }
+
   c->max_pages = cache_pages;
   c->max_entries = n_entries;
 
@@ -893,6 +1286,7 @@ struct rdcache_s* cache_create(void) {
     entries[i].base.next = next;
     entries[i].queue = QUEUE_FREE;
     entries[i].entryReservedByTask = NULL;
+    entries[i].referenced = 0;
   }
 
 
@@ -911,6 +1305,29 @@ struct rdcache_s* cache_create(void) {
   c->am_lru_head = NULL;
   c->am_lru_tail = NULL;
 
+  c->bout_current = 0;
+  c->bout_head = NULL;
+  c->bout_tail = NULL;
+
+  for( i = 0; i < LOOKUP_MEMO_SIZE; i++ ) {
+    c->lookup_memo[i].raddr = 0;
+    c->lookup_memo[i].node = 0;
+    c->lookup_memo[i].entry = NULL;
+  }
+
+  c->policy = cache_config_policy;
+  c->arc_target = 0;
+  c->policy_hits = 0;
+  c->policy_misses = 0;
+  c->policy_ghost_hits = 0;
+  c->policy_evictions = 0;
+
+  c->site_stats = NULL;
+  c->cur_site = -1;
+  c->site_stats_dropped = 0;
+  c->site_stats_next = NULL;
+  if( cache_config_site_stats ) site_stats_register(c);
+
   c->num_dirty_pages = 0;
   c->dirty_lru_head = NULL;
   c->dirty_lru_tail = NULL;
@@ -929,7 +1346,7 @@ struct rdcache_s* cache_create(void) {
   }
   c->dirty_lru_tail = &dirty_nodes[dirty_pages-1];
 
-  c->pending_len = MAX_PENDING;
+  c->pending_len = pending_len;
   c->pending_first_entry = -1;
   c->pending_last_entry = -1;
   // already set c->pending to allocated region
@@ -952,6 +1369,7 @@ struct rdcache_s* cache_create(void) {
 
 static
 void cache_destroy(struct rdcache_s *cache) {
+  if( cache->site_stats ) site_stats_unregister(cache);
   chpl_free(cache);
 }
 
@@ -1037,6 +1455,10 @@ void rdcache_print(struct rdcache_s* cache) {
   for( entry = cache->am_lru_head; entry; entry = entry->next ) {
     cache_entry_print(cache, entry, "     am ", 1);
   }
+  printf("  Bout:\n");
+  for( entry = cache->bout_head; entry; entry = entry->next ) {
+    cache_entry_print(cache, entry, "   bout ", 1);
+  }
 
   fflush(stdout);
 }
@@ -1150,13 +1572,37 @@ struct cache_entry_s* lookup_entry_prev(struct rdcache_s* tree,
   return NULL;
 }
 
+static inline
+struct lookup_memo_s* lookup_memo_slot(struct rdcache_s* tree,
+                                       int32_t node, raddr_t raddr) {
+  uint64_t h = (raddr >> CACHEPAGE_BITS) ^ ((uint64_t) node << 3);
+  return &tree->lookup_memo[h & (LOOKUP_MEMO_SIZE - 1)];
+}
+
 static inline
 struct cache_entry_s* lookup_entry(struct rdcache_s* tree,
                                    int32_t node, raddr_t raddr) {
 
   struct cache_table_entry_s* prev_table;
   struct cache_entry_s* prev_list;
-  return lookup_entry_prev(tree, node, raddr, &prev_table, &prev_list);
+  struct cache_entry_s* entry;
+  struct lookup_memo_s* memo;
+
+  memo = lookup_memo_slot(tree, node, raddr);
+  if (memo->entry != NULL && memo->raddr == raddr && memo->node == node) {
+    if (VERIFY)
+      assert(memo->entry ==
+             lookup_entry_prev(tree, node, raddr, &prev_table, &prev_list));
+    return memo->entry;
+  }
+
+  entry = lookup_entry_prev(tree, node, raddr, &prev_table, &prev_list);
+  if (entry != NULL) {
+    memo->raddr = raddr;
+    memo->node = node;
+    memo->entry = entry;
+  }
+  return entry;
 }
 
 // When we know the entry is not in the tree, use this function
@@ -1211,12 +1657,19 @@ void tree_remove(struct rdcache_s* tree, struct cache_entry_s* element)
   int32_t node;
   raddr_t raddr;
   struct cache_entry_s* next;
+  struct lookup_memo_s* memo;
 
   DEBUG_PRINT(("%d: Removing %p element %p\n", chpl_nodeID,
                (void*) element->raddr, element));
 
   raddr = element->base.raddr;
   node = element->base.node;
+
+  // Forget the element in the lookup memo, if it is there.
+  memo = lookup_memo_slot(tree, node, raddr);
+  if (memo->entry == element)
+    memo->entry = NULL;
+
   next = (struct cache_entry_s *) element->base.next;
   entry = lookup_entry_prev(tree, node, raddr, &prev_table, &prev_list);
 
@@ -1304,11 +1757,27 @@ void unreserve_entry(struct rdcache_s* cache,
                    struct cache_entry_s* entry);
 
 
+// Remove entry z, which has no page, from the tree and put it
+// on the free list.
+static
+void free_entry(struct rdcache_s* cache, struct cache_entry_s* z)
+{
+  struct cache_list_entry_s* entry;
+
+  // Remove entry from the tree
+  tree_remove(cache, z);
+
+  z->queue = QUEUE_FREE;
+
+  // and store it on the free list.
+  entry = &z->base;
+  SINGLE_PUSH_HEAD(cache, entry, free_entries);
+}
+
 static
 void aout_evict(struct rdcache_s* cache)
 {
   struct cache_entry_s* z;
-  struct cache_list_entry_s* entry;
 
   z = cache->aout_tail;
 
@@ -1321,19 +1790,51 @@ void aout_evict(struct rdcache_s* cache)
   cache->aout_current--;
 
   // Remove entry (which we are kicking off of Aout) from the tree
-  tree_remove(cache, z);
+  // and store it on the free list.
+  free_entry(cache, z);
+}
 
-  z->queue = QUEUE_FREE;
+static
+void bout_evict(struct rdcache_s* cache)
+{
+  struct cache_entry_s* z;
 
-  // and store it on the free list.
-  entry = &z->base;
-  SINGLE_PUSH_HEAD(cache, entry, free_entries);
+  z = cache->bout_tail;
+
+  if( !z ) return;
+
+  assert(z->entryReservedByTask == NULL);
+
+  // Remove the tail element from Bout
+  DOUBLE_REMOVE_TAIL(cache, bout);
+  cache->bout_current--;
+
+  free_entry(cache, z);
+}
+
+// Make sure that Aout and Bout together store no more than aout_max
+// entries. Like ARC's REPLACE, this prefers to forget entries evicted
+// from Ain once Ain and Aout together cover the whole cache.
+static
+void ghosts_trim(struct rdcache_s* cache)
+{
+  while( cache->aout_current + cache->bout_current > cache->aout_max ) {
+    if( cache->bout_current == 0 ||
+        (cache->aout_current > 0 &&
+         cache->ain_current + cache->aout_current >= cache->max_pages) )
+      aout_evict(cache);
+    else
+      bout_evict(cache);
+  }
 }
 
+// Evict the tail of Ain. If keep_ghost is set, the entry will
+// be remembered in Aout; otherwise it is freed.
 static
 void ain_evict(struct rdcache_s* cache,
                chpl_cache_taskPrvData_t* task_local,
-               int give_up_if_locked)
+               int give_up_if_locked,
+               int keep_ghost)
 {
 
   while (1) {
@@ -1376,34 +1877,44 @@ void ain_evict(struct rdcache_s* cache,
 
     DOUBLE_REMOVE_TAIL(cache, ain);
     cache->ain_current--;
+    cache->policy_evictions++;
+    if( site_stats_cur(cache) ) site_stats_cur(cache)->evictions++;
 
-    y->queue = QUEUE_AOUT;
+    if (keep_ghost) {
+      y->queue = QUEUE_AOUT;
 
-    // Since we are kicking entry off of Ain, we have to add it to Aout.
-    DOUBLE_PUSH_HEAD(cache, y, aout);
-    cache->aout_current++;
+      // Since we are kicking entry off of Ain, we have to add it to Aout.
+      DOUBLE_PUSH_HEAD(cache, y, aout);
+      cache->aout_current++;
 
-    // "unlock" entry y
-    unreserve_entry(cache, task_local, y);
+      // "unlock" entry y
+      unreserve_entry(cache, task_local, y);
 
-    if( cache->aout_current > cache->aout_max ) {
-      // Remove the tail element from aout.
-      aout_evict(cache);
+      // Remove tail elements from aout/bout if there are too many.
+      ghosts_trim(cache);
+    } else {
+      // "unlock" entry y
+      unreserve_entry(cache, task_local, y);
+
+      // Remove it from the pointer tree and add it to the free list.
+      free_entry(cache, y);
     }
     return;
   }
 }
 
 
+// Evict the tail of Am. If keep_ghost is set, the entry will
+// be remembered in Bout; otherwise it is freed.
 static
 void am_evict(struct rdcache_s *cache,
               chpl_cache_taskPrvData_t* task_local,
-              int give_up_if_locked)
+              int give_up_if_locked,
+              int keep_ghost)
 {
 
   while (1) {
     struct cache_entry_s* y = cache->am_lru_tail;
-    struct cache_list_entry_s* entry;
 
     if (y==NULL)
       return;
@@ -1436,41 +1947,172 @@ void am_evict(struct rdcache_s *cache,
 
     DOUBLE_REMOVE_TAIL(cache, am_lru);
     cache->am_current--;
-
-    // Remove this entry in Am from the pointer tree.
-    tree_remove(cache, y);
-
-    y->queue = QUEUE_FREE;
-
-    // Add y to the free list
-    entry = &y->base;
-    SINGLE_PUSH_HEAD(cache, entry, free_entries);
+    cache->policy_evictions++;
+    if( site_stats_cur(cache) ) site_stats_cur(cache)->evictions++;
 
     // "unlock" entry y
     unreserve_entry(cache, task_local, y);
+
+    if (keep_ghost) {
+      y->queue = QUEUE_BOUT;
+      DOUBLE_PUSH_HEAD(cache, y, bout);
+      cache->bout_current++;
+
+      // Remove tail elements from aout/bout if there are too many.
+      ghosts_trim(cache);
+    } else {
+      // Remove this entry in Am from the pointer tree
+      // and add it to the free list.
+      free_entry(cache, y);
+    }
     return;
   }
 }
 
+////// 2Q replacement policy
+
 static
-void reclaim(struct rdcache_s* cache,
-             chpl_cache_taskPrvData_t* task_local,
-             int give_up_if_locked)
+void use_2q(struct rdcache_s* cache, struct cache_entry_s* entry)
+{
+  // If it's on the Am queue, move it to the front of the Am queue.
+  if( entry->queue == QUEUE_AM ) {
+    DOUBLE_REMOVE(cache, entry, am_lru);
+    DOUBLE_PUSH_HEAD(cache, entry, am_lru);
+  }
+  // Otherwise (it is in Ain) so leave it where it is.
+}
+
+static
+void reclaim_2q(struct rdcache_s* cache,
+                chpl_cache_taskPrvData_t* task_local,
+                int give_up_if_locked)
 {
   // This is like 'reclaimfor' in the 2Q paper
   // if the number of elements in Ain > max
   if( cache->ain_current > cache->ain_max ) {
     // Page out the tail of Ain (and record it in Aout)
     // ain_evict will also evict from aout if necessary.
-    ain_evict(cache, task_local, give_up_if_locked);
+    ain_evict(cache, task_local, give_up_if_locked, /* keep_ghost */ 1);
   } else {
     // otherwise
     // page out the tail of Am, call it Y
     // do not put it on Aout, as it hasn't been accessed recently.
-    am_evict(cache, task_local, give_up_if_locked);
+    am_evict(cache, task_local, give_up_if_locked, /* keep_ghost */ 0);
   }
 }
 
+static const struct cache_policy_s cache_policy_2q = {
+  "2q", use_2q, NULL, reclaim_2q
+};
+
+////// CLOCK replacement policy
+
+static
+void use_clock(struct rdcache_s* cache, struct cache_entry_s* entry)
+{
+  entry->referenced = 1;
+}
+
+static
+void reclaim_clock(struct rdcache_s* cache,
+                   chpl_cache_taskPrvData_t* task_local,
+                   int give_up_if_locked)
+{
+  unsigned int i;
+
+  // The tail of Ain is the clock hand. Give entries that were
+  // referenced since the hand last passed them a second chance by
+  // clearing the bit and moving them to the head. Stop at a reserved
+  // entry, since ain_evict handles waiting for those.
+  for( i = 0; i < cache->ain_current; i++ ) {
+    struct cache_entry_s* y = cache->ain_tail;
+    if( y == NULL || !y->referenced || y->entryReservedByTask != NULL )
+      break;
+    y->referenced = 0;
+    DOUBLE_REMOVE_TAIL(cache, ain);
+    DOUBLE_PUSH_HEAD(cache, y, ain);
+  }
+
+  ain_evict(cache, task_local, give_up_if_locked, /* keep_ghost */ 0);
+}
+
+static const struct cache_policy_s cache_policy_clock = {
+  "clock", use_clock, NULL, reclaim_clock
+};
+
+////// ARC replacement policy
+// See "ARC: A Self-Tuning, Low Overhead Replacement Cache"
+//    by Nimrod Megiddo and Dharmendra S. Modha, FAST 2003.
+// Ain is T1, Am is T2, Aout is B1, and Bout is B2.
+
+static
+void use_arc(struct rdcache_s* cache, struct cache_entry_s* entry)
+{
+  if( entry->queue == QUEUE_AIN ) {
+    // Seen twice now, so move it to the front of Am.
+    DOUBLE_REMOVE(cache, entry, ain);
+    cache->ain_current--;
+    DOUBLE_PUSH_HEAD(cache, entry, am_lru);
+    cache->am_current++;
+    entry->queue = QUEUE_AM;
+  } else if( entry->queue == QUEUE_AM ) {
+    DOUBLE_REMOVE(cache, entry, am_lru);
+    DOUBLE_PUSH_HEAD(cache, entry, am_lru);
+  }
+}
+
+static
+void ghost_hit_arc(struct rdcache_s* cache, struct cache_entry_s* entry)
+{
+  unsigned int delta;
+
+  if( entry->queue == QUEUE_AOUT ) {
+    // Ain would have been a better place for this entry, so grow it.
+    delta = 1;
+    if( cache->aout_current > 0 && cache->bout_current > cache->aout_current )
+      delta = cache->bout_current / cache->aout_current;
+    cache->arc_target += delta;
+    if( cache->arc_target > (unsigned int) cache->max_pages )
+      cache->arc_target = cache->max_pages;
+  } else if( entry->queue == QUEUE_BOUT ) {
+    // Am would have been a better place for this entry, so shrink Ain.
+    delta = 1;
+    if( cache->bout_current > 0 && cache->aout_current > cache->bout_current )
+      delta = cache->aout_current / cache->bout_current;
+    if( cache->arc_target > delta )
+      cache->arc_target -= delta;
+    else
+      cache->arc_target = 0;
+  }
+}
+
+static
+void reclaim_arc(struct rdcache_s* cache,
+                 chpl_cache_taskPrvData_t* task_local,
+                 int give_up_if_locked)
+{
+  // Like ARC's REPLACE: evict from Ain if it is larger than its target,
+  // otherwise from Am. Either way, remember the evicted entry.
+  if( cache->ain_current > 0 &&
+      (cache->ain_current > cache->arc_target || cache->am_current == 0) ) {
+    ain_evict(cache, task_local, give_up_if_locked, /* keep_ghost */ 1);
+  } else {
+    am_evict(cache, task_local, give_up_if_locked, /* keep_ghost */ 1);
+  }
+}
+
+static const struct cache_policy_s cache_policy_arc = {
+  "arc", use_arc, ghost_hit_arc, reclaim_arc
+};
+
+static inline
+void reclaim(struct rdcache_s* cache,
+             chpl_cache_taskPrvData_t* task_local,
+             int give_up_if_locked)
+{
+  cache->policy->reclaim(cache, task_local, give_up_if_locked);
+}
+
 static
 struct cache_entry_s* allocate_entry(struct rdcache_s* cache)
 {
@@ -1744,6 +2386,7 @@ void validate_cache(struct rdcache_s* tree,
   int in_ain;
   int in_aout;
   int in_am;
+  int in_bout;
   int num_used_pages = 0;
   int num_dirty = 0;
   int table_slots;
@@ -1783,10 +2426,12 @@ void validate_cache(struct rdcache_s* tree,
         in_ain = find_in_queue(tree->ain_head, bottom_cur);
         in_aout = find_in_queue(tree->aout_head, bottom_cur);
         in_am = find_in_queue(tree->am_lru_head, bottom_cur);
-        assert( in_ain || in_aout || in_am );
+        in_bout = find_in_queue(tree->bout_head, bottom_cur);
+        assert( in_ain || in_aout || in_am || in_bout );
         if( in_ain ) assert( bottom_cur->queue == QUEUE_AIN );
         if( in_aout ) assert( bottom_cur->queue == QUEUE_AOUT );
         if( in_am ) assert( bottom_cur->queue == QUEUE_AM );
+        if( in_bout ) assert( bottom_cur->queue == QUEUE_BOUT );
         assert( bottom_cur->queue != QUEUE_FREE );
         if( bottom_cur->page ) num_used_pages++;
         if( bottom_cur->dirty ) num_dirty++;
@@ -1808,6 +2453,11 @@ void validate_cache(struct rdcache_s* tree,
   in_am = validate_queue(tree, task_local,
                          tree->am_lru_head, tree->am_lru_tail, QUEUE_AM);
   assert( in_am == tree->am_current );
+  // 3b: Entries in Bout must be in the tree
+  in_bout = validate_queue(tree, task_local,
+                           tree->bout_head, tree->bout_tail, QUEUE_BOUT);
+  assert( in_bout == tree->bout_current );
+  assert( in_aout + in_bout <= tree->aout_max );
 
   // 4: dirty list must be well-formed
   {
@@ -1842,7 +2492,8 @@ void validate_cache(struct rdcache_s* tree,
     for (cur = tree->free_entries_head; cur; cur = cur->next) {
       num_free_entries++;
     }
-    assert( in_ain + in_aout + in_am + num_free_entries == tree->max_entries );
+    assert( in_ain + in_aout + in_am + in_bout + num_free_entries ==
+            tree->max_entries );
   }
 
   // 6: must not lose pages
@@ -1976,15 +2627,192 @@ int try_reserve_entry(struct rdcache_s* cache,
   }
 }
 
-// "unlock" the entry
+// "unlock" the entry
+static
+void unreserve_entry(struct rdcache_s* cache,
+                   chpl_cache_taskPrvData_t* task_local,
+                   struct cache_entry_s* entry) {
+  assert(entry->entryReservedByTask == task_local);
+  entry->entryReservedByTask = NULL;
+}
+
+
+// Write-combining support.
+//
+// Dirty regions are written back by way of a put batch, which gathers
+// the regions (from one or more pages on the same node) into a single
+// vectored put. Adjacent regions are merged when they are contiguous
+// both here and on the remote node, as happens with consecutive pages.
+// All of the entries in a batch must be reserved by the task that
+// builds it until put_batch_start has been called for the last time,
+// since the page memory must not change before the puts are started.
+#define PUT_BATCH_LEN 64
+#define PUT_BATCH_ENTRIES 16
+
+struct put_batch_s {
+  c_nodeid_t node;
+  int n_puts;
+  void* addr_v[PUT_BATCH_LEN];
+  void* raddr_v[PUT_BATCH_LEN];
+  size_t size_v[PUT_BATCH_LEN];
+  int n_entries;
+  struct cache_entry_s* entries[PUT_BATCH_ENTRIES];
+};
+
+static
+void put_batch_init(struct put_batch_s* batch, c_nodeid_t node)
+{
+  batch->node = node;
+  batch->n_puts = 0;
+  batch->n_entries = 0;
+}
+
+// Start the puts gathered so far. Each entry in the batch then has to
+// wait for them before its page can be modified or reused.
+// Note: chpl_comm_put_nb_v, pending_push can yield
+static
+void put_batch_start(struct rdcache_s* cache, struct put_batch_s* batch)
+{
+  chpl_comm_nb_handle_t handle;
+  cache_seqn_t sn;
+  int i;
+
+  if( batch->n_puts == 0 ) return;
+
+  DEBUG_PRINT(("chpl_comm_put_nb_v(%i, %p, %i, %p, %i)\n",
+               batch->n_puts, batch->addr_v[0], batch->node,
+               batch->raddr_v[0], (int) batch->size_v[0]));
+
+  handle = chpl_comm_put_nb_v(batch->n_puts, batch->addr_v, batch->node,
+                              batch->raddr_v, batch->size_v,
+                              CHPL_COMM_UNKNOWN_ID, -1, 0);
+  if (EXTRA_YIELDS) {
+    TRACE_YIELD_PRINT(("%d: task %d cache %p yielding in put_batch_start "
+                       "for chpl_comm_put_nb_v\n",
+                       chpl_nodeID, (int) chpl_task_getId(), cache));
+
+    chpl_task_yield();
+
+    TRACE_YIELD_PRINT(("%d: task %d cache %p back in put_batch_start\n",
+                       chpl_nodeID, (int) chpl_task_getId(), cache));
+  }
+
+  // Save the handle in the list of pending requests.
+  sn = pending_push(cache, handle);
+  for( i = 0; i < batch->n_entries; i++ ) {
+    batch->entries[i]->max_put_sequence_number = sn;
+  }
+
+  batch->n_puts = 0;
+}
+
+// Can this clean stretch of the page [from, to) be written back along
+// with the dirty data around it? Only if the bytes are really here:
+// the lines must be valid and no prefetch may still be filling them.
+static
+int put_batch_gap_ok(struct rdcache_s* cache,
+                     struct cache_entry_s* entry,
+                     uintptr_t from, uintptr_t to)
+{
+  uintptr_t first_line, last_line;
+
+  if( to - from > (uintptr_t) cache_config_write_combine_gap ) return 0;
+  if( entry->max_prefetch_sequence_number >
+      cache->completed_request_number ) return 0;
+
+  first_line = from >> CACHELINE_BITS;
+  last_line = (to - 1) >> CACHELINE_BITS;
+  return check_valid_lines(entry->valid_lines,
+                           first_line, last_line - first_line + 1);
+}
+
+// Add all of the dirty regions of a page to the batch and clear its
+// dirty bits. The entry must be reserved, must be on the batch's node,
+// and the batch must have room for another entry.
+//
+// A clean gap between two dirty regions is written back too if it is no
+// larger than CHPL_RT_CACHE_WRITE_COMBINE_GAP. That is off by default
+// because it stores cached bytes that this task did not write, which
+// would overwrite a concurrent store to those bytes by another locale.
+static
+void put_batch_add_dirty(struct rdcache_s* cache,
+                         struct put_batch_s* batch,
+                         struct cache_entry_s* entry)
+{
+  struct dirty_entry_s* dirty = entry->dirty;
+  uint64_t* dirty_bits = dirty->dirty;
+  unsigned char* page = entry->page;
+  uintptr_t start, got_skip, got_len, next_skip, next_len;
+  unsigned char* addr;
+  raddr_t raddr;
+  int n;
+
+  assert(page);
+  assert(entry->base.node == batch->node);
+  assert(batch->n_entries < PUT_BATCH_ENTRIES);
+
+  batch->entries[batch->n_entries++] = entry;
+
+  start = 0;
+  while( get_skip_len_for_valids(dirty_bits, start, &got_skip, &got_len, CACHEPAGE_BITMASK_WORDS) ) {
+
+    // Try to extend the region across small clean gaps.
+    while( cache_config_write_combine_gap > 0 &&
+           get_skip_len_for_valids(dirty_bits, got_skip + got_len,
+                                   &next_skip, &next_len,
+                                   CACHEPAGE_BITMASK_WORDS) &&
+           put_batch_gap_ok(cache, entry, got_skip + got_len, next_skip) ) {
+      got_len = next_skip + next_len - got_skip;
+    }
+
+    addr = page + got_skip;
+    raddr = entry->base.raddr + got_skip;
+
+    n = batch->n_puts;
+    if( n > 0 &&
+        (unsigned char*) batch->addr_v[n-1] + batch->size_v[n-1] == addr &&
+        (raddr_t) batch->raddr_v[n-1] + batch->size_v[n-1] == raddr ) {
+      // Contiguous with the previous region (from the page before this one).
+      batch->size_v[n-1] += got_len;
+    } else {
+      if( n == PUT_BATCH_LEN ) {
+        put_batch_start(cache, batch);
+        n = 0;
+      }
+      batch->addr_v[n] = addr;
+      batch->raddr_v[n] = (void*) raddr;
+      batch->size_v[n] = got_len;
+      batch->n_puts = n + 1;
+    }
+
+    // Move past this region of 1s in dirty bits.
+    start = got_skip + got_len;
+  }
+
+  // Now remove the dirty structure and put it back on its free list.
+  // This has the effect of clearing the dirty bits.
+  DOUBLE_REMOVE(cache, dirty, dirty_lru);
+  dirty->entry = NULL;
+  entry->dirty = NULL;
+  DOUBLE_PUSH_TAIL(cache, dirty, dirty_lru);
+  // ... and decrement the number of dirty pages.
+  cache->num_dirty_pages--;
+}
+
+// Start any remaining puts in the batch and unreserve its entries.
 static
-void unreserve_entry(struct rdcache_s* cache,
-                   chpl_cache_taskPrvData_t* task_local,
-                   struct cache_entry_s* entry) {
-  assert(entry->entryReservedByTask == task_local);
-  entry->entryReservedByTask = NULL;
-}
+void put_batch_finish(struct rdcache_s* cache,
+                      chpl_cache_taskPrvData_t* task_local,
+                      struct put_batch_s* batch)
+{
+  int i;
 
+  put_batch_start(cache, batch);
+  for( i = 0; i < batch->n_entries; i++ ) {
+    unreserve_entry(cache, task_local, batch->entries[i]);
+  }
+  batch->n_entries = 0;
+}
 
 // For the region of this page in raddr,len, we complete any pending/not
 // started operations that possibly overlap with that region.
@@ -1999,15 +2827,12 @@ void flush_entry(struct rdcache_s* cache,
 {
   struct page_list_s* free_page_list_entry;
   unsigned char* page;
-  uintptr_t start;
-  struct dirty_entry_s* dirty;
   uint64_t *dirty_bits;
   raddr_t skip = raddr & CACHEPAGE_MASK;
   uintptr_t len = len_in;
   raddr_t line_start, line_last, line_next;
   uintptr_t num_lines, skip_lines;
-  chpl_comm_nb_handle_t handle;
-  uintptr_t got_skip, got_len;
+  struct put_batch_s batch;
 
   assert(entry->entryReservedByTask == task_local);
 
@@ -2034,54 +2859,14 @@ void flush_entry(struct rdcache_s* cache,
     // start writes for all dirty bits
 
     if( entry->dirty ) {
-      dirty = entry->dirty;
-      page = entry->page;
-      assert(page);
-
-      dirty_bits = dirty->dirty;
+      dirty_bits = entry->dirty->dirty;
       if( len == CACHEPAGE_SIZE ||
           any_set_for_skip_len(dirty_bits, skip, len, CACHEPAGE_BITMASK_WORDS) ) {
-        start = 0;
-        while( get_skip_len_for_valids(dirty_bits, start, &got_skip, &got_len, CACHEPAGE_BITMASK_WORDS) ) {
-
-          start = got_skip;
-          // Start a put for len bytes starting at page + start
-          DEBUG_PRINT(("chpl_comm_start_put(%p, %i, %p, %i)\n",
-                 page+start, entry->base.node, (void*) (entry->raddr+start),
-                 (int) got_len));
-
-          // Note: chpl_comm_put_nb, pending_push can yield
-          handle =
-            chpl_comm_put_nb(page+start, /*local addr*/
-                             entry->base.node,
-                             (void*)(entry->base.raddr+start),
-                             got_len /*size*/,
-                             CHPL_COMM_UNKNOWN_ID, -1, 0);
-          if (EXTRA_YIELDS) {
-            TRACE_YIELD_PRINT(("%d: task %d cache %p yielding in flush_entry "
-                               "for chpl_comm_put_nb\n",
-                               chpl_nodeID, (int) chpl_task_getId(), cache));
-
-            chpl_task_yield();
-
-            TRACE_YIELD_PRINT(("%d: task %d cache %p back in flush_entry\n",
-                               chpl_nodeID, (int) chpl_task_getId(), cache));
-          }
-
-          // Save the handle in the list of pending requests.
-          entry->max_put_sequence_number = pending_push(cache, handle);
-
-          // Move past this region of 1s in dirty bits.
-          start = got_skip + got_len;
-        }
-        // Now remove the dirty structure and put it back on its free list.
-        // This has the effect of clearing the dirty bits.
-        DOUBLE_REMOVE(cache, dirty, dirty_lru);
-        dirty->entry = NULL;
-        entry->dirty = NULL;
-        DOUBLE_PUSH_TAIL(cache, dirty, dirty_lru);
-        // ... and decrement the number of dirty pages.
-        cache->num_dirty_pages--;
+        // Write back all of the dirty regions with one vectored put.
+        // Note: put_batch_start can yield
+        put_batch_init(&batch, entry->base.node);
+        put_batch_add_dirty(cache, &batch, entry);
+        put_batch_start(cache, &batch);
       }
     }
   }
@@ -2109,13 +2894,19 @@ void flush_entry(struct rdcache_s* cache,
       entry->max_put_sequence_number = NO_SEQUENCE_NUMBER;
       entry->max_prefetch_sequence_number = NO_SEQUENCE_NUMBER;
       memset(entry->valid_lines, 0, CACHE_LINES_PER_PAGE_BITMASK_WORDS*sizeof(uint64_t));
+      memset(entry->strided_lines, 0, CACHE_LINES_PER_PAGE_BITMASK_WORDS*sizeof(uint64_t));
+      site_stats_readahead_unused(cache, entry, 0, CACHE_LINES_PER_PAGE);
     } else {
       unset_valid_lines(entry->valid_lines, skip_lines, num_lines);
+      unset_valid_lines(entry->strided_lines, skip_lines, num_lines);
+      site_stats_readahead_unused(cache, entry, skip_lines, num_lines);
     }
   }
 
   // If evicting, remove the page from the cache and put it on a free list.
   if( op & FLUSH_DO_EVICT ) {
+    site_stats_readahead_unused(cache, entry, 0, CACHE_LINES_PER_PAGE);
+
     // But, our entry no longer can have a page associated with it.
     page = entry->page;
     entry->page = NULL;
@@ -2134,25 +2925,20 @@ void flush_entry(struct rdcache_s* cache,
 }
 
 // Call this function to tell the cache that we are 'use'ing an entry;
-// it will move it to the front of any LRU queue
+// the replacement policy will e.g. move it to the front of an LRU queue
 // (particularly for the Am queue).
-static
+static inline
 void use_entry(struct rdcache_s* cache,
                struct cache_entry_s* entry)
 {
-  // If it's on the Am queue, move it to the front of the Am queue.
-  if( entry->queue == QUEUE_AM ) {
-    DOUBLE_REMOVE(cache, entry, am_lru);
-    DOUBLE_PUSH_HEAD(cache, entry, am_lru);
-  }
-  // Otherwise (it is in Ain) so leave it where it is.
+  cache->policy->use(cache, entry);
 }
 
 // Plumb a cache entry into the tree.
 // If aout_entry is not NULL, we will replace an existing entry from Aout
-// if one is present (and aout_entry is probably such an entry, but
-// cache manipulations might have removed it, e.g.). If the entry from Aout
-// exists, it will be moved to Am.
+// (or Bout) if one is present (and aout_entry is probably such an entry,
+// but cache manipulations might have removed it, e.g.). If the entry from
+// Aout exists, it will be moved to Am.
 //
 // Otherwise, this will create a new entry in Ain and it will assume
 // that the entry does not currently exist in the cache.
@@ -2176,7 +2962,7 @@ struct cache_entry_s* make_entry(struct rdcache_s* tree,
   bottom_match = NULL;
   if (aout_entry) {
     if (aout_entry->base.raddr == raddr && aout_entry->base.node == node &&
-        aout_entry->queue == QUEUE_AOUT) {
+        (aout_entry->queue == QUEUE_AOUT || aout_entry->queue == QUEUE_BOUT)) {
       // OK to reuse aout_entry - it was not removed.
       bottom_match = aout_entry;
     }
@@ -2187,23 +2973,37 @@ struct cache_entry_s* make_entry(struct rdcache_s* tree,
     assert( bottom_match->base.node == node );
     assert( bottom_match->base.raddr == raddr );
     // We shouldn't be replacing something in Ain or Am; use use_entry instead
-    assert(bottom_match->queue == QUEUE_AOUT);
+    assert(bottom_match->queue == QUEUE_AOUT ||
+           bottom_match->queue == QUEUE_BOUT);
 
     DEBUG_PRINT(("%d: Found %p in Aout\n", chpl_nodeID, (void*) raddr));
+    tree->policy_ghost_hits++;
+    if (tree->policy->ghost_hit)
+      tree->policy->ghost_hit(tree, bottom_match);
+
     // add X to the head of Am
-    DOUBLE_REMOVE(tree, bottom_match, aout);
-    tree->aout_current--;
+    if (bottom_match->queue == QUEUE_AOUT) {
+      DOUBLE_REMOVE(tree, bottom_match, aout);
+      tree->aout_current--;
+    } else {
+      DOUBLE_REMOVE(tree, bottom_match, bout);
+      tree->bout_current--;
+    }
     DOUBLE_PUSH_HEAD(tree, bottom_match, am_lru);
     tree->am_current++;
 
     bottom_match->queue = QUEUE_AM;
     bottom_match->entryReservedByTask = NULL;
+    bottom_match->referenced = 0;
     bottom_match->readahead_skip = 0;
     bottom_match->readahead_len = 0;
     // Set the page to the one the caller already allocated
     bottom_match->page = page;
     // Clear the valid lines
     memset(&bottom_match->valid_lines, 0, sizeof(uint64_t)*CACHE_LINES_PER_PAGE_BITMASK_WORDS);
+    memset(&bottom_match->strided_lines, 0, sizeof(uint64_t)*CACHE_LINES_PER_PAGE_BITMASK_WORDS);
+    memset(&bottom_match->readahead_lines, 0, sizeof(uint64_t)*CACHE_LINES_PER_PAGE_BITMASK_WORDS);
+    bottom_match->readahead_site = -1;
     // Clear the dirty pointer and sequence numbers.
     bottom_match->dirty = NULL;
     bottom_match->min_sequence_number = NO_SEQUENCE_NUMBER;
@@ -2226,6 +3026,7 @@ struct cache_entry_s* make_entry(struct rdcache_s* tree,
 
     bottom_tmp->queue = QUEUE_AIN;
     bottom_tmp->entryReservedByTask = NULL;
+    bottom_tmp->referenced = 0;
     bottom_tmp->readahead_skip = 0;
     bottom_tmp->readahead_len = 0;
 
@@ -2233,6 +3034,9 @@ struct cache_entry_s* make_entry(struct rdcache_s* tree,
     bottom_tmp->prev = NULL;
     bottom_tmp->page = page;
     memset(&bottom_tmp->valid_lines, 0, sizeof(uint64_t)*CACHE_LINES_PER_PAGE_BITMASK_WORDS);
+    memset(&bottom_tmp->strided_lines, 0, sizeof(uint64_t)*CACHE_LINES_PER_PAGE_BITMASK_WORDS);
+    memset(&bottom_tmp->readahead_lines, 0, sizeof(uint64_t)*CACHE_LINES_PER_PAGE_BITMASK_WORDS);
+    bottom_tmp->readahead_site = -1;
     bottom_tmp->dirty = NULL;
     bottom_tmp->min_sequence_number = NO_SEQUENCE_NUMBER;
     bottom_tmp->max_put_sequence_number = NO_SEQUENCE_NUMBER;
@@ -2336,6 +3140,7 @@ struct cache_entry_s* get_reserved_entry(struct rdcache_s* cache,
 
       // move entry to the front of the cache if needed
       use_entry(cache, entry);
+      cache->policy_hits++;
       return entry;
 
     } else if (aout_entry) {
@@ -2362,6 +3167,7 @@ struct cache_entry_s* get_reserved_entry(struct rdcache_s* cache,
         }
 
         // "lock"ed entry
+        cache->policy_misses++;
         return entry;
       }
     } else {
@@ -2395,6 +3201,7 @@ struct cache_entry_s* get_reserved_entry(struct rdcache_s* cache,
         }
 
         // "lock"ed entry
+        cache->policy_misses++;
         return entry;
       }
     }
@@ -2587,6 +3394,7 @@ int cache_get(struct rdcache_s* cache,
               unsigned char * addr,
               c_nodeid_t node, raddr_t raddr, size_t size,
               int sequential_readahead_length,
+              int strided_readahead,
               int32_t commID, int ln, int32_t fn);
 
 static
@@ -2689,6 +3497,7 @@ void cache_get_trigger_readahead(struct rdcache_s* cache,
                 /* addr */ NULL /* means prefetch */,
                 node, prefetch_start, prefetch_end - prefetch_start,
                 next_ra_length,
+                /* strided_readahead */ 0,
                 commID, ln, fn);
     } else {
       // We could not prefetch, so record a cache miss so
@@ -2796,7 +3605,144 @@ void cache_get_compute_readahead_extend(struct rdcache_s* cache,
   *ra_line_end_inout = ra_line_end;
 }
 
+// Record an access to ra_line by this task in the stride stream for
+// (node, task) and update the stream's stride and confidence.
+//
+// Returns the stride in bytes if the stream has a stable stride that
+// is not handled by sequential readahead, or 0 otherwise.
+// Sets *first_step to the first multiple of the stride that should be
+// prefetched: 1 when the stride has just been confirmed, and otherwise
+// STRIDE_READAHEAD_DEPTH, since the closer strides were already
+// prefetched by earlier accesses in the stream.
+static
+intptr_t cache_get_detect_stride(struct rdcache_s* cache,
+                                 chpl_cache_taskPrvData_t* task_local,
+                                 c_nodeid_t node, raddr_t ra_line,
+                                 int* first_step)
+{
+  struct stride_stream_s* stream = NULL;
+  intptr_t delta;
+  int was_confident;
+  int i;
+
+  for( i = 0; i < STRIDE_STREAMS; i++ ) {
+    if( cache->stride_streams[i].task == task_local &&
+        cache->stride_streams[i].node == node ) {
+      stream = &cache->stride_streams[i];
+      break;
+    }
+  }
+
+  if( stream == NULL ) {
+    // Start a new stream, replacing the oldest one.
+    stream = &cache->stride_streams[cache->stride_streams_next];
+    cache->stride_streams_next =
+      (cache->stride_streams_next + 1) % STRIDE_STREAMS;
+
+    stream->task = task_local;
+    stream->node = node;
+    stream->last_addr = ra_line;
+    stream->stride = 0;
+    stream->confidence = 0;
+    return 0;
+  }
+
+  delta = (intptr_t) (ra_line - stream->last_addr);
+
+  // Repeated accesses to the same line don't tell us anything.
+  if( delta == 0 ) return 0;
+
+  stream->last_addr = ra_line;
+
+  was_confident = (stream->confidence >= STRIDE_CONFIDENCE);
+  if( delta == stream->stride ) {
+    if( stream->confidence < STRIDE_CONFIDENCE ) stream->confidence++;
+  } else {
+    stream->stride = delta;
+    stream->confidence = 0;
+    return 0;
+  }
+
+  // Unit-stride access is handled by sequential readahead.
+  if( stream->confidence < STRIDE_CONFIDENCE ||
+      (-CACHELINE_SIZE <= delta && delta <= CACHELINE_SIZE) )
+    return 0;
+
+  *first_step = was_confident ? STRIDE_READAHEAD_DEPTH : 1;
+  return delta;
+}
+
+// Called for a cache miss or for a hit on a line brought in by
+// strided readahead. If this access continues a strided access pattern,
+// this will start prefetches for the next few accesses in the pattern.
+// The prefetched regions are the same size and alignment as
+// raddr..raddr+size-1.
+//
+// Assumes that no entry is reserved by this task (since it can
+// reserve other entries and yield).
+static
+void cache_get_trigger_strided_readahead(struct rdcache_s* cache,
+                                         chpl_cache_taskPrvData_t* task_local,
+                                         c_nodeid_t node,
+                                         raddr_t raddr, size_t size,
+                                         int32_t commID, int ln, int32_t fn)
+{
+  intptr_t stride;
+  int first_step = 0;
+  int step;
+  size_t page_size;
+  raddr_t ra_line;
+  raddr_t request_page;
+
+  ra_line = round_down_to_mask(raddr, CACHELINE_MASK);
+
+  stride = cache_get_detect_stride(cache, task_local, node, ra_line,
+                                   &first_step);
+  if( stride == 0 || is_congested(cache) ) return;
+
+  page_size = sys_page_size();
+  request_page = round_down_to_mask(raddr, page_size-1);
+
+  for( step = first_step; step <= STRIDE_READAHEAD_DEPTH; step++ ) {
+    raddr_t prefetch_start = raddr + step * stride;
+    raddr_t prefetch_end = prefetch_start + size;
+
+    // Stop if the prefetch would wrap around the address space.
+    if( (stride > 0 && prefetch_start < raddr) ||
+        (stride < 0 && prefetch_start > raddr) ||
+        prefetch_end < prefetch_start )
+      break;
+
+    // As with sequential readahead, only prefetch memory we know to be
+    // gettable, or, failing that, memory on the same system page as the
+    // request.
+    if( chpl_task_guardPagesInUse() ||
+        !chpl_comm_addr_gettable(node, (void*)prefetch_start, size) ) {
+      if( round_down_to_mask(prefetch_start, page_size-1) != request_page ||
+          round_down_to_mask(prefetch_end-1, page_size-1) != request_page )
+        break;
+    }
+
+    TRACE_READAHEAD_PRINT(("%d: task %d starting strided readahead "
+                           "stride %i from %p to %p\n",
+                           chpl_nodeID, (int)chpl_task_getId(), (int) stride,
+                           (void*) (prefetch_start), (void*) (prefetch_end)));
+
+    // note - this can yield
+    cache_get(cache, task_local,
+              /* addr */ NULL /* means prefetch */,
+              node, prefetch_start, size,
+              /* sequential_readahead_length */ 0,
+              /* strided_readahead */ 1,
+              commID, ln, fn);
+
+    if( is_congested(cache) ) break;
+  }
+}
+
 // If addr == NULL, this will prefetch.
+// If strided_readahead is set, this prefetch was started by
+// strided readahead.
 // This call handles only accesses within a page.
 // returns 1 if the request was a "hit"
 static
@@ -2806,6 +3752,7 @@ int cache_get_in_page(struct rdcache_s* cache,
                       c_nodeid_t node, raddr_t raddr, size_t size,
                       raddr_t ra_first_page, raddr_t ra_last_page,
                       int sequential_readahead_length,
+                      int strided_readahead,
                       int32_t commID, int ln, int32_t fn)
 {
   struct cache_entry_s* entry;
@@ -2816,6 +3763,7 @@ int cache_get_in_page(struct rdcache_s* cache,
   cache_seqn_t sn = NO_SEQUENCE_NUMBER;
   int isprefetch;
   int entry_after_acquire;
+  int strided_hit = 0;
   chpl_comm_nb_handle_t handle;
   uintptr_t readahead_len, readahead_skip;
 
@@ -2911,6 +3859,26 @@ int cache_get_in_page(struct rdcache_s* cache,
       // Copy the data out.
       chpl_memcpy(addr, entry->page + (raddr-ra_page), size);
 
+      // Was this data brought in by strided readahead?
+      // If so, count the hit once and continue the strided readahead.
+      if( ENABLE_READAHEAD_TRIGGER_STRIDED &&
+          any_valid_lines(entry->strided_lines,
+                          (ra_line - ra_page) >> CACHELINE_BITS,
+                          (ra_line_end - ra_line) >> CACHELINE_BITS) ) {
+        unset_valid_lines(entry->strided_lines,
+                          (ra_line - ra_page) >> CACHELINE_BITS,
+                          (ra_line_end - ra_line) >> CACHELINE_BITS);
+        chpl_comm_diags_incr(cache_strided_readahead_hits);
+        strided_hit = 1;
+      }
+
+      // The readahead for these lines paid off.
+      if( cache->site_stats ) {
+        unset_valid_lines(entry->readahead_lines,
+                          (ra_line - ra_page) >> CACHELINE_BITS,
+                          (ra_line_end - ra_line) >> CACHELINE_BITS);
+      }
+
 #ifdef DUMP
       {
         // printing out gotten data for debug
@@ -2949,6 +3917,10 @@ int cache_get_in_page(struct rdcache_s* cache,
                                     raddr, size,
                                     readahead_skip, readahead_len,
                                     commID, ln, fn);
+        if( strided_hit )
+          cache_get_trigger_strided_readahead(cache, task_local,
+                                              node, raddr, size,
+                                              commID, ln, fn);
         return 1;
       }
     }
@@ -2956,6 +3928,12 @@ int cache_get_in_page(struct rdcache_s* cache,
     // "unlock" the entry
     unreserve_entry(cache, task_local, entry);
     entry = NULL;
+
+    // note - triggering readahead can yield
+    if( strided_hit )
+      cache_get_trigger_strided_readahead(cache, task_local,
+                                          node, raddr, size,
+                                          commID, ln, fn);
     return 1;
   }
 
@@ -3026,6 +4004,24 @@ int cache_get_in_page(struct rdcache_s* cache,
     assert(entry->base.raddr == ra_page && entry->base.node == node);
 
     entry->max_prefetch_sequence_number = seqn_max(entry->max_prefetch_sequence_number, sn);
+
+    // Note which lines strided readahead brought in.
+    if( strided_readahead ) {
+      set_valid_lines(entry->strided_lines,
+                      (ra_line - ra_page) >> CACHELINE_BITS,
+                      (ra_line_end - ra_line) >> CACHELINE_BITS);
+    }
+
+    // ... and which lines any readahead brought in, for site statistics.
+    if( site_stats_cur(cache) &&
+        (sequential_readahead_length != 0 || strided_readahead) ) {
+      set_valid_lines(entry->readahead_lines,
+                      (ra_line - ra_page) >> CACHELINE_BITS,
+                      (ra_line_end - ra_line) >> CACHELINE_BITS);
+      entry->readahead_site = cache->cur_site;
+      site_stats_cur(cache)->readahead_lines +=
+        (ra_line_end - ra_line) >> CACHELINE_BITS;
+    }
   }
 
   // Set the minimum sequence number
@@ -3129,6 +4125,14 @@ int cache_get_in_page(struct rdcache_s* cache,
   // TODO: is this call necessary?
   ensure_free_page(cache, task_local, /* give_up_if_locked */ 0);
 
+  // Record this miss for stride detection and possibly start
+  // strided readahead. note - this can yield.
+  if( ENABLE_READAHEAD_TRIGGER_STRIDED && !isprefetch ) {
+    cache_get_trigger_strided_readahead(cache, task_local,
+                                        node, raddr, size,
+                                        commID, ln, fn);
+  }
+
   return 0;
 }
 
@@ -3141,6 +4145,7 @@ int cache_get(struct rdcache_s* cache,
               unsigned char * addr,
               c_nodeid_t node, raddr_t raddr, size_t size,
               int sequential_readahead_length,
+              int strided_readahead,
               int32_t commID, int ln, int32_t fn)
 {
   raddr_t ra_first_page;
@@ -3199,6 +4204,7 @@ int cache_get(struct rdcache_s* cache,
                             node, requested_start, requested_size,
                             ra_first_page, ra_last_page,
                             sequential_readahead_length,
+                            strided_readahead,
                             commID, ln, fn);
 
     all_hits = all_hits && hit;
@@ -3510,6 +4516,11 @@ static
 void cache_clean_dirty(struct rdcache_s* cache,
                        chpl_cache_taskPrvData_t* task_local)
 {
+  struct put_batch_s batch;
+
+  // Dirty pages on the same node are written back together, which
+  // combines the writes of all the tasks sharing this cache.
+  put_batch_init(&batch, 0);
 
   while (1) {
     struct dirty_entry_s* cur;
@@ -3521,7 +4532,19 @@ void cache_clean_dirty(struct rdcache_s* cache,
 
     victim = cur->entry;
 
+    if( batch.n_entries > 0 &&
+        (victim->base.node != batch.node ||
+         batch.n_entries == PUT_BATCH_ENTRIES) ) {
+      put_batch_finish(cache, task_local, &batch);
+    }
+
     if (!try_reserve_entry(cache, task_local, victim)) {
+      // Never wait for an entry while holding others.
+      if( batch.n_entries > 0 ) {
+        put_batch_finish(cache, task_local, &batch);
+        continue;
+      }
+
       // couldn't reserve entry - yield and try the lookup again
       TRACE_YIELD_PRINT(("%d: task %d cache %p yielding in clean_dirty\n",
                          chpl_nodeID, (int) chpl_task_getId(), cache));
@@ -3534,10 +4557,13 @@ void cache_clean_dirty(struct rdcache_s* cache,
       continue;
     }
 
-    // "lock"ed entry
-    flush_entry(cache, task_local, victim,
-                FLUSH_DO_CLEAR_DIRTY, 0, CACHEPAGE_SIZE);
-    unreserve_entry(cache, task_local, victim);
+    // "lock"ed entry; it stays reserved until the batch is finished
+    batch.node = victim->base.node;
+    put_batch_add_dirty(cache, &batch, victim);
+  }
+
+  if( batch.n_entries > 0 ) {
+    put_batch_finish(cache, task_local, &batch);
   }
 }
 
@@ -3565,9 +4591,23 @@ static struct rdcache_s* cache_create(void);
 CHPL_TLS_DECL(struct rdcache_s*,cache_remote_data);
 static pthread_key_t pthread_cache_info_key; // stores struct rdcache_s*
 
+static
+chpl_cache_taskPrvData_t* task_private_cache_data(void);
+
 static
 struct rdcache_s* tls_cache_remote_data(void) {
-  struct rdcache_s *cache = CHPL_TLS_GET(cache_remote_data);
+  struct rdcache_s *cache;
+  if( cache_follows_task ) {
+    // The cache is stored with the task rather than the pthread.
+    chpl_cache_taskPrvData_t* task_local = task_private_cache_data();
+    cache = (struct rdcache_s*) task_local->cache;
+    if( ! cache ) {
+      cache = cache_create();
+      task_local->cache = cache;
+    }
+    return cache;
+  }
+  cache = CHPL_TLS_GET(cache_remote_data);
   if( ! cache && chpl_cache_enabled() ) {
     cache = cache_create();
     CHPL_TLS_SET(cache_remote_data, cache);
@@ -3591,11 +4631,104 @@ void destroy_pthread_local_cache(void* arg)
   cache_destroy(s);
 }
 
+// Round up to a power of 2 (for values > 0).
+static
+int64_t round_up_to_pow2(int64_t v)
+{
+  int64_t ret = 1;
+  while( ret < v ) ret <<= 1;
+  return ret;
+}
+
+// Read the cache geometry and policy from the environment.
+static
+void cache_read_config(void)
+{
+  int64_t pages;
+  int64_t dirty_pages;
+  int64_t pending;
+  int64_t gap;
+  int64_t default_pages;
+  const char* policy;
+
+  cache_follows_task = chpl_task_canMigrateThreads();
+  default_pages = cache_follows_task ? DEFAULT_TASK_CACHE_PAGES
+                                     : DEFAULT_CACHE_PAGES;
+  if( ! cache_follows_task ) {
+    size_t llc_share = chpl_topo_getLLCSizePerCPU();
+    if( llc_share > 0 ) {
+      int64_t llc_pages = round_up_to_pow2(llc_share / CACHEPAGE_SIZE);
+      if( llc_pages < DEFAULT_TASK_CACHE_PAGES )
+        llc_pages = DEFAULT_TASK_CACHE_PAGES;
+      if( llc_pages < default_pages )
+        default_pages = llc_pages;
+    }
+  }
+
+  // The upper bound keeps entry offsets within their 32 bits.
+  pages = chpl_env_rt_get_int("CACHE_PAGES", default_pages);
+  if( pages < 16 || pages > (1 << 16) ) {
+    chpl_warning("CHPL_RT_CACHE_PAGES must be between 16 and 65536; "
+                 "using the default", 0, 0);
+    pages = default_pages;
+  }
+  pages = round_up_to_pow2(pages);
+
+  dirty_pages = chpl_env_rt_get_int("CACHE_DIRTY_PAGES", 16 + pages / 64);
+  if( dirty_pages < 1 || dirty_pages > pages ) {
+    chpl_warning("CHPL_RT_CACHE_DIRTY_PAGES must be between 1 and the "
+                 "number of cache pages; using the default", 0, 0);
+    dirty_pages = 16 + pages / 64;
+  }
+
+  pending = chpl_env_rt_get_int("CACHE_PENDING", MAX_PENDING);
+  if( pending < 1 || pending > 4096 ) {
+    chpl_warning("CHPL_RT_CACHE_PENDING must be between 1 and 4096; "
+                 "using the default", 0, 0);
+    pending = MAX_PENDING;
+  }
+  pending = round_up_to_pow2(pending);
+
+  policy = chpl_env_rt_get("CACHE_POLICY", "2q");
+  if( strcasecmp(policy, "2q") == 0 ) {
+    cache_config_policy = &cache_policy_2q;
+  } else if( strcasecmp(policy, "clock") == 0 ) {
+    cache_config_policy = &cache_policy_clock;
+  } else if( strcasecmp(policy, "arc") == 0 ) {
+    cache_config_policy = &cache_policy_arc;
+  } else {
+    chpl_warning("CHPL_RT_CACHE_POLICY must be 2q, clock, or arc; "
+                 "using 2q", 0, 0);
+    cache_config_policy = &cache_policy_2q;
+  }
+
+  // Filling in a gap writes back data we did not write ourselves;
+  // see put_batch_add_dirty().
+  gap = chpl_env_rt_get_int("CACHE_WRITE_COMBINE_GAP", 0);
+  if( gap < 0 || gap > CACHEPAGE_SIZE ) {
+    chpl_warning("CHPL_RT_CACHE_WRITE_COMBINE_GAP must be between 0 and "
+                 "the cache page size; using 0", 0, 0);
+    gap = 0;
+  }
+
+  cache_config_pages = pages;
+  cache_config_dirty_pages = dirty_pages;
+  cache_config_pending = pending;
+  cache_config_write_combine_gap = gap;
+
+  if( chpl_env_rt_get_bool("CACHE_SITE_STATS", false) ) {
+    int64_t top = chpl_env_rt_get_int("CACHE_SITE_STATS_TOP", 20);
+    cache_config_site_stats = (top > 0) ? top : 20;
+  }
+}
+
 static
 void chpl_cache_do_init(void)
 {
   static int inited = 0;
   if( ! inited ) {
+    cache_read_config();
+
     // We will need some thread-local storage.
     // We create two versions: cache_remote_data stores
     // our pointer to the struct rd_cache_s* and is what
@@ -3628,6 +4761,28 @@ void chpl_cache_exit(void)
   CHPL_TLS_DELETE(cache_remote_data);
 }
 
+void chpl_cache_task_end(void)
+{
+  chpl_task_infoRuntime_t* infoRuntime;
+  chpl_cache_taskPrvData_t* task_local;
+  struct rdcache_s* cache;
+
+  if( ! cache_follows_task || ! chpl_cache_enabled() ) return;
+
+  infoRuntime = chpl_task_getInfoRuntime();
+  if( ! infoRuntime ) return;
+
+  task_local = &infoRuntime->comm_data.cache_data;
+  cache = (struct rdcache_s*) task_local->cache;
+  if( ! cache ) return;
+
+  // Nobody else can see this cache, but its puts may still be in flight.
+  cache_clean_dirty(cache, task_local);
+  wait_all(cache);
+  task_local->cache = NULL;
+  cache_destroy(cache);
+}
+
 
 void chpl_cache_fence(int acquire, int release, int ln, int32_t fn)
 {
@@ -3721,6 +4876,8 @@ void chpl_cache_comm_put(void* addr, c_nodeid_t node, void* raddr,
   chpl_cache_print();
 #endif
 
+  site_stats_begin(cache, ln, fn);
+
   all_hits = cache_put(cache, task_local,
                        addr, node, (raddr_t)raddr, size,
                        commID, ln, fn);
@@ -3730,20 +4887,30 @@ void chpl_cache_comm_put(void* addr, c_nodeid_t node, void* raddr,
       chpl_comm_diags_incr(cache_put_hits);
     else
       chpl_comm_diags_incr(cache_put_misses);
+    if (site_stats_cur(cache)) {
+      if (all_hits)
+        site_stats_cur(cache)->put_hits++;
+      else
+        site_stats_cur(cache)->put_misses++;
+    }
   }
 
   return;
 }
 
 void chpl_cache_comm_get(void *addr, c_nodeid_t node, void* raddr,
-                         size_t size, int32_t commID, int ln, int32_t fn)
+                         size_t size, int nontemporal,
+                         int32_t commID, int ln, int32_t fn)
 {
   //printf("get len %d node %d raddr %p\n", (int) len * elemSize, node, raddr);
   struct rdcache_s* cache = tls_cache_remote_data();
   chpl_cache_taskPrvData_t* task_local = task_private_cache_data();
   int all_hits;
 
-  if (size_merits_direct_comm(cache, size)) {
+  // Non-temporal gets take the same path as large ones: write back and
+  // drop whatever the cache holds for the region, then get directly
+  // into addr.  No entries are allocated, so nothing useful is evicted.
+  if (nontemporal || size_merits_direct_comm(cache, size)) {
     cache_invalidate(cache, task_local, node, (raddr_t)raddr, size);
     chpl_comm_get(addr, node, raddr, size, commID, ln, fn);
     if (EXTRA_YIELDS) {
@@ -3767,15 +4934,23 @@ void chpl_cache_comm_get(void *addr, c_nodeid_t node, void* raddr,
   chpl_cache_print();
 #endif
 
+  site_stats_begin(cache, ln, fn);
+
   all_hits = cache_get(cache, task_local,
                        addr, node, (raddr_t)raddr, size,
-                       0, commID, ln, fn);
+                       0, 0, commID, ln, fn);
 
   if (size != 0) {
     if (all_hits)
       chpl_comm_diags_incr(cache_get_hits);
     else
       chpl_comm_diags_incr(cache_get_misses);
+    if (site_stats_cur(cache)) {
+      if (all_hits)
+        site_stats_cur(cache)->get_hits++;
+      else
+        site_stats_cur(cache)->get_misses++;
+    }
   }
 
   return;
@@ -3791,18 +4966,70 @@ void chpl_cache_comm_prefetch(c_nodeid_t node, void* raddr,
 
   chpl_comm_diags_verbose_rdma("prefetch", node, size, ln, fn, commID);
 
+  site_stats_begin(cache, ln, fn);
+
   // Always use the cache for prefetches.
   cache_get(cache, task_local,
             /* addr */ NULL, node, (raddr_t)raddr, size,
             /* sequential_readahead_length */ 0,
+            /* strided_readahead */ 0,
             CHPL_COMM_UNKNOWN_ID, ln, fn);
 
   // TODO: record prefetches somewhere in diagnostic counters
 }
 
+int64_t chpl_cache_comm_prefetch_v(int v_len, c_nodeid_t* node_v,
+                                   void** raddr_v, size_t* size_v,
+                                   int32_t commID, int ln, int32_t fn)
+{
+  struct rdcache_s* cache = tls_cache_remote_data();
+  chpl_cache_taskPrvData_t* task_local = task_private_cache_data();
+  cache_seqn_t sn;
+  int i;
+
+  TRACE_PRINT(("%d: in chpl_cache_comm_prefetch_v (%d regions)\n",
+               chpl_nodeID, v_len));
+
+  site_stats_begin(cache, ln, fn);
+
+  for( i = 0; i < v_len; i++ ) {
+    // Local and empty regions have nothing to land in the cache.
+    if( node_v[i] == chpl_nodeID || size_v[i] == 0 ) continue;
+
+    chpl_comm_diags_verbose_rdma("prefetch", node_v[i], size_v[i],
+                                 ln, fn, commID);
+
+    // note - this can yield
+    cache_get(cache, task_local,
+              /* addr */ NULL, node_v[i], (raddr_t)raddr_v[i], size_v[i],
+              /* sequential_readahead_length */ 0,
+              /* strided_readahead */ 0,
+              CHPL_COMM_UNKNOWN_ID, ln, fn);
+  }
+
+  // Every operation started so far, including the prefetches above
+  // and any earlier ones for the same lines, has a sequence number no
+  // larger than this one.
+  sn = cache->next_request_number - 1;
+  if( sn <= cache->completed_request_number ) return NO_SEQUENCE_NUMBER;
+  return sn;
+}
+
+void chpl_cache_comm_wait_prefetch(int64_t handle)
+{
+  struct rdcache_s* cache = tls_cache_remote_data();
+
+  TRACE_PRINT(("%d: in chpl_cache_comm_wait_prefetch(%i)\n",
+               chpl_nodeID, (int) handle));
+
+  // note - this can yield
+  wait_for(cache, handle);
+}
+
 struct cache_strd_callback_ctx {
   struct rdcache_s* cache;
   chpl_cache_taskPrvData_t* task_local;
+  int all_hits;
 };
 
 static
@@ -3841,14 +5068,150 @@ void strd_invalidate(void *addr, void *dststr, c_nodeid_t node,
                    &ctx, &strd_invalidate_fn, commID, ln, fn);
 }
 
+static
+void strd_cached_prefetch_fn(void* addr,
+                             int32_t node,
+                             void* raddr,
+                             size_t size,
+                             void* ctxv,
+                             int32_t commID,
+                             int ln,
+                             int32_t fn)
+{
+  struct cache_strd_callback_ctx* ctx = (struct cache_strd_callback_ctx*) ctxv;
+
+  // note - this can yield
+  if (!cache_get(ctx->cache, ctx->task_local,
+                 /* addr */ NULL, node, (raddr_t)raddr, size,
+                 /* sequential_readahead_length */ 0,
+                 /* strided_readahead */ 0,
+                 commID, ln, fn))
+    ctx->all_hits = 0;
+}
+
+static
+void strd_cached_get_fn(void* addr,
+                        int32_t node,
+                        void* raddr,
+                        size_t size,
+                        void* ctxv,
+                        int32_t commID,
+                        int ln,
+                        int32_t fn)
+{
+  struct cache_strd_callback_ctx* ctx = (struct cache_strd_callback_ctx*) ctxv;
+
+  // note - this can yield
+  cache_get(ctx->cache, ctx->task_local,
+            (unsigned char*)addr, node, (raddr_t)raddr, size,
+            /* sequential_readahead_length */ 0,
+            /* strided_readahead */ 0,
+            commID, ln, fn);
+}
+
+static
+void strd_cached_put_fn(void* addr,
+                        int32_t node,
+                        void* raddr,
+                        size_t size,
+                        void* ctxv,
+                        int32_t commID,
+                        int ln,
+                        int32_t fn)
+{
+  struct cache_strd_callback_ctx* ctx = (struct cache_strd_callback_ctx*) ctxv;
+
+  // note - this can yield
+  if (!cache_put(ctx->cache, ctx->task_local,
+                 (unsigned char*)addr, node, (raddr_t)raddr, size,
+                 commID, ln, fn))
+    ctx->all_hits = 0;
+}
+
+// Decide whether a strided transfer should go through the cache.
+// It should when every contiguous chunk is small enough that we would
+// have cached it as an individual get/put, and when the remote
+// footprint of the whole transfer fits in the part of the cache that
+// newly fetched pages land in (Ain for 2Q).  Otherwise the second pass
+// of a strided get could find its own prefetches already evicted, and
+// we are better off with the strided comm primitive.
+//
+// This is not allowed to modify the cache
+static
+int strd_merits_cache(const struct rdcache_s* cache,
+                      void* remote_strides, void* count_arg,
+                      int32_t strlevels, size_t elemSize)
+{
+  size_t* srcstr = (size_t*) remote_strides;
+  size_t* count = (size_t*) count_arg;
+  size_t chunk = count[0] * elemSize;
+  size_t nchunks = 1;
+  size_t span = chunk;
+  size_t pages_by_chunk;
+  size_t pages_by_span;
+  size_t pages;
+  int32_t i;
+
+  if (chunk == 0 || size_merits_direct_comm(cache, chunk))
+    return 0;
+
+  for (i = 0; i < strlevels; i++) {
+    if (count[i+1] == 0)
+      return 0;
+    nchunks *= count[i+1];
+    span += srcstr[i] * elemSize * (count[i+1] - 1);
+  }
+
+  // Each chunk is smaller than a page, so it touches at most two.
+  pages_by_chunk = 2 * nchunks;
+  pages_by_span = span / CACHEPAGE_SIZE + 2;
+  pages = (pages_by_chunk < pages_by_span) ? pages_by_chunk : pages_by_span;
+
+  return pages <= (size_t) cache->ain_max;
+}
+
 #define STRIDED_INVALIDATE_ALL 0
 
 void chpl_cache_comm_get_strd(void *addr, void *dststr, c_nodeid_t node,
                               void *raddr, void *srcstr, void *count,
                               int32_t strlevels, size_t elemSize,
                               int32_t commID, int ln, int32_t fn) {
+  struct rdcache_s* cache = tls_cache_remote_data();
+
   TRACE_PRINT(("%d: in chpl_cache_comm_get_strd\n", chpl_nodeID));
 
+  if (strd_merits_cache(cache, srcstr, count, strlevels, elemSize)) {
+    struct cache_strd_callback_ctx ctx;
+    ctx.cache = cache;
+    ctx.task_local = task_private_cache_data();
+    ctx.all_hits = 1;
+
+    site_stats_begin(cache, ln, fn);
+
+    // First start fetching every line that is not already valid, so
+    // that the misses overlap with each other, then copy the chunks
+    // out of the cache.  The fetched lines stay behind for the next
+    // strided get of the same region.
+    strd_common_call(addr, dststr, node,
+                     raddr, srcstr, count, strlevels, elemSize,
+                     &ctx, &strd_cached_prefetch_fn, commID, ln, fn);
+    strd_common_call(addr, dststr, node,
+                     raddr, srcstr, count, strlevels, elemSize,
+                     &ctx, &strd_cached_get_fn, commID, ln, fn);
+
+    if (ctx.all_hits)
+      chpl_comm_diags_incr(cache_get_hits);
+    else
+      chpl_comm_diags_incr(cache_get_misses);
+    if (site_stats_cur(cache)) {
+      if (ctx.all_hits)
+        site_stats_cur(cache)->get_hits++;
+      else
+        site_stats_cur(cache)->get_misses++;
+    }
+    return;
+  }
+
   if (STRIDED_INVALIDATE_ALL) {
     // do a full fence - so that:
     // 1) any pending writes are completed (in case they were to the
@@ -3868,9 +5231,6 @@ void chpl_cache_comm_get_strd(void *addr, void *dststr, c_nodeid_t node,
   chpl_comm_get_strd(addr, dststr, node, raddr, srcstr, count, strlevels,
                      elemSize, commID, ln, fn);
   if (EXTRA_YIELDS) {
-#ifdef TRACE_YIELDS
-    struct rdcache_s* cache = tls_cache_remote_data();
-#endif
     TRACE_YIELD_PRINT(("%d: task %d cache %p yielding for chpl_comm_get_strd\n",
                       chpl_nodeID, (int) chpl_task_getId(), cache));
 
@@ -3884,8 +5244,39 @@ void chpl_cache_comm_put_strd(void *addr, void *dststr, c_nodeid_t node,
                               void *raddr, void *srcstr, void *count,
                               int32_t strlevels, size_t elemSize,
                               int32_t commID, int ln, int32_t fn) {
+  struct rdcache_s* cache = tls_cache_remote_data();
+
   TRACE_PRINT(("%d: in chpl_cache_comm_put_strd\n", chpl_nodeID));
 
+  if (strd_merits_cache(cache, dststr, count, strlevels, elemSize)) {
+    struct cache_strd_callback_ctx ctx;
+    ctx.cache = cache;
+    ctx.task_local = task_private_cache_data();
+    ctx.all_hits = 1;
+
+    site_stats_begin(cache, ln, fn);
+
+    // Store each chunk into the cache as a write-back put, exactly as
+    // a sequence of small chpl_cache_comm_put calls would.  Note that
+    // for a strided put 'addr'/'dststr' describe the remote side and
+    // 'raddr'/'srcstr' the local one.
+    strd_common_call(raddr, srcstr, node,
+                     addr, dststr, count, strlevels, elemSize,
+                     &ctx, &strd_cached_put_fn, commID, ln, fn);
+
+    if (ctx.all_hits)
+      chpl_comm_diags_incr(cache_put_hits);
+    else
+      chpl_comm_diags_incr(cache_put_misses);
+    if (site_stats_cur(cache)) {
+      if (ctx.all_hits)
+        site_stats_cur(cache)->put_hits++;
+      else
+        site_stats_cur(cache)->put_misses++;
+    }
+    return;
+  }
+
   if (STRIDED_INVALIDATE_ALL) {
     // do a full fence - so that:
     // 1) any pending writes are completed (in case they were to the
@@ -3896,8 +5287,9 @@ void chpl_cache_comm_put_strd(void *addr, void *dststr, c_nodeid_t node,
     // system. This is just the current (possibly temporary) solution.
     chpl_cache_fence(1, 1, ln, fn);
   } else {
-    strd_invalidate(addr, dststr, node,
-                    raddr, srcstr, count,
+    // the remote side of a strided put is 'addr'/'dststr'
+    strd_invalidate(raddr, srcstr, node,
+                    addr, dststr, count,
                     strlevels, elemSize,
                     commID, ln, fn);
   }
@@ -3905,9 +5297,6 @@ void chpl_cache_comm_put_strd(void *addr, void *dststr, c_nodeid_t node,
   chpl_comm_put_strd(addr, dststr, node, raddr, srcstr, count, strlevels,
                      elemSize, commID, ln, fn);
   if (EXTRA_YIELDS) {
-#ifdef TRACE_YIELDS
-    struct rdcache_s* cache = tls_cache_remote_data();
-#endif
     TRACE_YIELD_PRINT(("%d: task %d cache %p yielding for chpl_comm_put_strd\n",
                        chpl_nodeID, (int) chpl_task_getId(), cache));
 
@@ -3941,8 +5330,11 @@ void chpl_cache_comm_put_unordered(void* addr, c_nodeid_t node, void* raddr,
 }
 
 void chpl_cache_comm_get_unordered(void *addr, c_nodeid_t node, void* raddr,
-                                   size_t size, int32_t commID, int ln, int32_t fn)
+                                   size_t size, int nontemporal,
+                                   int32_t commID, int ln, int32_t fn)
 {
+  // Unordered gets already bypass the cache, so 'nontemporal' changes
+  // nothing here.
   struct rdcache_s* cache = tls_cache_remote_data();
   chpl_cache_taskPrvData_t* task_local = task_private_cache_data();
   cache_invalidate(cache, task_local, node, (raddr_t)raddr, size);
@@ -4057,16 +5449,90 @@ void chpl_cache_print_stats(void) {
 
   printf("%d: task %d cache statistics "
          "ain=%i/%i "
-         "aout=%i/%i am=%i "
+         "aout=%i/%i am=%i bout=%i "
          "table=(%i lists/%i full/%i used/%i slots and %i/%i sub-slots) "
          "entries=%i/%i\n",
          chpl_nodeID, (int) chpl_task_getId(),
          cache->ain_current, cache->ain_max,
          cache->aout_current, cache->aout_max,
-         cache->am_current,
+         cache->am_current, cache->bout_current,
          n_colliding_slots, n_full_slots, n_used_slots, table_slots,
          n_full_subslots, n_subslots,
          n_bottom_entries, cache->max_entries);
+  printf("%d: task %d cache policy %s "
+         "pages=%i dirty=%i pending=%i "
+         "hits=%" PRIu64 " misses=%" PRIu64 " ghost_hits=%" PRIu64 " "
+         "evictions=%" PRIu64,
+         chpl_nodeID, (int) chpl_task_getId(), cache->policy->name,
+         cache->max_pages, cache_config_dirty_pages, (int) cache->pending_len,
+         cache->policy_hits, cache->policy_misses, cache->policy_ghost_hits,
+         cache->policy_evictions);
+  if (cache->policy == &cache_policy_arc)
+    printf(" target=%u", cache->arc_target);
+  printf("\n");
+}
+
+void chpl_cache_print_site_stats(void)
+{
+  struct rdcache_s* cache;
+  struct cache_site_stats_s* sites;
+  int n_slots = 1 << SITE_STATS_MERGED_BITS;
+  int n_sites = 0;
+  int i;
+
+  if( ! chpl_cache_enabled() || ! cache_config_site_stats ) return;
+
+  pthread_mutex_lock(&site_stats_lock);
+
+  // Fold in the caches that are still alive.
+  if( site_stats_merged == NULL )
+    site_stats_merged = chpl_calloc(n_slots,
+                                    sizeof(struct cache_site_stats_s));
+  for( cache = site_stats_caches; cache; cache = cache->site_stats_next ) {
+    site_stats_merge(site_stats_merged, SITE_STATS_MERGED_BITS,
+                     &site_stats_merged_dropped,
+                     cache->site_stats, SITE_STATS_BITS);
+    site_stats_merged_dropped += cache->site_stats_dropped;
+    memset(cache->site_stats, 0,
+           (1 << SITE_STATS_BITS) * sizeof(struct cache_site_stats_s));
+    cache->site_stats_dropped = 0;
+  }
+
+  // Compact the table and rank the sites.
+  sites = site_stats_merged;
+  for( i = 0; i < n_slots; i++ ) {
+    if( sites[i].used ) sites[n_sites++] = sites[i];
+  }
+  qsort(sites, n_sites, sizeof(struct cache_site_stats_s), site_stats_cmp);
+
+  printf("%d: cache site statistics (top %d of %d sites",
+         chpl_nodeID,
+         n_sites < cache_config_site_stats ? n_sites : cache_config_site_stats,
+         n_sites);
+  if( site_stats_merged_dropped )
+    printf(", %" PRIu64 " operations not recorded", site_stats_merged_dropped);
+  printf(")\n");
+  printf("%d: %-32s %10s %10s %10s %10s %10s %10s %10s\n",
+         chpl_nodeID, "site", "get hits", "get misses", "put hits",
+         "put misses", "evictions", "ra lines", "ra wasted");
+  for( i = 0; i < n_sites && i < cache_config_site_stats; i++ ) {
+    char where[256];
+    snprintf(where, sizeof(where), "%s:%d",
+             chpl_lookupFilename(sites[i].fn), sites[i].ln);
+    printf("%d: %-32s %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64
+           " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n",
+           chpl_nodeID, where,
+           sites[i].get_hits, sites[i].get_misses,
+           sites[i].put_hits, sites[i].put_misses,
+           sites[i].evictions,
+           sites[i].readahead_lines, sites[i].readahead_waste);
+  }
+
+  // Start over, in case this is called again.
+  memset(site_stats_merged, 0, n_slots * sizeof(struct cache_site_stats_s));
+  site_stats_merged_dropped = 0;
+
+  pthread_mutex_unlock(&site_stats_lock);
 }
 
 // Returns 1 if the data was already cached
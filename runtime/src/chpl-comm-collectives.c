@@ -0,0 +1,357 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Collective operations; see chpl_comm_allreduce() in chpl-comm.h.
+//
+// Unless the comm layer does them natively, these are built from one
+// step, coll_sendrecv(), in which a node may send a block to one node
+// and receive a block from another.  The receiver tells the sender
+// where to PUT the data by PUTting the address into the sender's
+// mailbox for it, and the sender says the data is there by PUTting the
+// collective's sequence number into the receiver's mailbox for it.
+// This relies on one node's PUTs to another arriving in order.
+//
+// Each node has a mailbox for every other node, and only that node
+// writes it.  Within one collective a node writes each field of a
+// given mailbox at most once, and it can't start the next collective
+// until the owner has read what it wrote, because it was waiting on
+// the owner's reply.  So the sequence numbers tell the owner all it
+// needs to know.
+//
+
+#include "chplrt.h"
+
+#include "chpl-atomics.h"
+#include "chpl-comm.h"
+#include "chpl-comm-compiler-macros.h"
+#include "chpl-comm-internal.h"
+#include "chpl-mem.h"
+#include "chpl-mem-desc.h"
+#include "chpl-tasks.h"
+#include "error.h"
+
+// Don't get warning macros for chpl_comm_get etc
+#include "chpl-comm-no-warning-macros.h"
+
+#include <stdint.h>
+#include <string.h>
+
+typedef struct {
+  void* readyAddr;              // where the writer wants our data
+  uint64_t readySeq;            // readyAddr is for this collective
+  uint64_t doneSeq;             // the writer's data for this one is here
+} coll_box_t;
+
+//
+// Our mailboxes, one per node.  The pointer is static, so the other
+// nodes can GET it from the same address here; they cache what they
+// got in coll_peer_boxes[].
+//
+static coll_box_t* coll_boxes;
+static coll_box_t** coll_peer_boxes;
+static uint64_t coll_seq;
+
+
+void chpl_comm_coll_init(void) {
+  if (chpl_numNodes <= 1)
+    return;
+
+  coll_boxes = chpl_mem_allocManyZero(chpl_numNodes, sizeof(coll_boxes[0]),
+                                      CHPL_RT_MD_COMM_COLL_BUF, 0, 0);
+  coll_peer_boxes = chpl_mem_allocManyZero(chpl_numNodes,
+                                           sizeof(coll_peer_boxes[0]),
+                                           CHPL_RT_MD_COMM_COLL_BUF, 0, 0);
+}
+
+
+//
+// Our mailbox on 'node'.
+//
+static inline
+coll_box_t* coll_box_on(c_nodeid_t node) {
+  if (coll_peer_boxes[node] == NULL) {
+    coll_box_t* boxes;
+    chpl_comm_get(&boxes, node, &coll_boxes, sizeof(boxes),
+                  CHPL_COMM_UNKNOWN_ID, 0, 0);
+    coll_peer_boxes[node] = boxes;
+  }
+  return &coll_peer_boxes[node][chpl_nodeID];
+}
+
+
+static inline
+void coll_wait(uint64_t* p, uint64_t seq) {
+  while (*(volatile uint64_t*) p != seq) {
+    chpl_task_yield();
+  }
+  chpl_atomic_thread_fence(memory_order_acquire);
+}
+
+
+//
+// Send 'size' bytes at 'sendBuf' to node 'to', and receive into
+// 'recvBuf' from node 'from'.  Either node can be -1, for none.
+//
+static
+void coll_sendrecv(c_nodeid_t to, const void* sendBuf, size_t size,
+                   c_nodeid_t from, void* recvBuf) {
+  uint64_t seq = coll_seq;
+
+  if (from >= 0) {
+    coll_box_t* box = coll_box_on(from);
+    chpl_comm_put(&recvBuf, from, &box->readyAddr, sizeof(recvBuf),
+                  CHPL_COMM_UNKNOWN_ID, 0, 0);
+    chpl_comm_put(&seq, from, &box->readySeq, sizeof(seq),
+                  CHPL_COMM_UNKNOWN_ID, 0, 0);
+  }
+
+  if (to >= 0) {
+    coll_box_t* box = coll_box_on(to);
+    coll_wait(&coll_boxes[to].readySeq, seq);
+    if (size > 0) {
+      chpl_comm_put((void*) sendBuf, to, coll_boxes[to].readyAddr, size,
+                    CHPL_COMM_UNKNOWN_ID, 0, 0);
+    }
+    chpl_comm_put(&seq, to, &box->doneSeq, sizeof(seq),
+                  CHPL_COMM_UNKNOWN_ID, 0, 0);
+  }
+
+  if (from >= 0) {
+    coll_wait(&coll_boxes[from].doneSeq, seq);
+  }
+}
+
+
+static inline
+size_t coll_type_size(chpl_comm_coll_type_t type) {
+  switch (type) {
+  case chpl_comm_coll_int32:  return sizeof(int32_t);
+  case chpl_comm_coll_int64:  return sizeof(int64_t);
+  case chpl_comm_coll_uint32: return sizeof(uint32_t);
+  case chpl_comm_coll_uint64: return sizeof(uint64_t);
+  case chpl_comm_coll_real32: return sizeof(_real32);
+  case chpl_comm_coll_real64: return sizeof(_real64);
+  }
+  chpl_internal_error("unknown collective type");
+  return 0;
+}
+
+
+//
+// dst[i] = dst[i] op src[i].  The ops are commutative, so partners
+// that combine each other's data get identical results.
+//
+#define COLL_COMBINE_ARITH(T)                                           \
+  do {                                                                  \
+    T* d = (T*) dst;                                                    \
+    const T* s = (const T*) src;                                        \
+    size_t i;                                                           \
+    switch (op) {                                                       \
+    case chpl_comm_coll_sum:                                            \
+      for (i = 0; i < count; i++) d[i] = d[i] + s[i];                   \
+      return;                                                           \
+    case chpl_comm_coll_prod:                                           \
+      for (i = 0; i < count; i++) d[i] = d[i] * s[i];                   \
+      return;                                                           \
+    case chpl_comm_coll_min:                                            \
+      for (i = 0; i < count; i++) if (s[i] < d[i]) d[i] = s[i];         \
+      return;                                                           \
+    case chpl_comm_coll_max:                                            \
+      for (i = 0; i < count; i++) if (s[i] > d[i]) d[i] = s[i];         \
+      return;                                                           \
+    default:                                                            \
+      break;                                                            \
+    }                                                                   \
+  } while (0)
+
+#define COLL_COMBINE_BITS(T)                                            \
+  do {                                                                  \
+    T* d = (T*) dst;                                                    \
+    const T* s = (const T*) src;                                        \
+    size_t i;                                                           \
+    switch (op) {                                                       \
+    case chpl_comm_coll_band:                                           \
+      for (i = 0; i < count; i++) d[i] &= s[i];                         \
+      return;                                                           \
+    case chpl_comm_coll_bor:                                            \
+      for (i = 0; i < count; i++) d[i] |= s[i];                         \
+      return;                                                           \
+    case chpl_comm_coll_bxor:                                           \
+      for (i = 0; i < count; i++) d[i] ^= s[i];                         \
+      return;                                                           \
+    default:                                                            \
+      break;                                                            \
+    }                                                                   \
+  } while (0)
+
+static
+void coll_combine(void* dst, const void* src, size_t count,
+                  chpl_comm_coll_type_t type, chpl_comm_coll_op_t op) {
+  switch (type) {
+  case chpl_comm_coll_int32:
+    COLL_COMBINE_ARITH(int32_t);
+    COLL_COMBINE_BITS(int32_t);
+    break;
+  case chpl_comm_coll_int64:
+    COLL_COMBINE_ARITH(int64_t);
+    COLL_COMBINE_BITS(int64_t);
+    break;
+  case chpl_comm_coll_uint32:
+    COLL_COMBINE_ARITH(uint32_t);
+    COLL_COMBINE_BITS(uint32_t);
+    break;
+  case chpl_comm_coll_uint64:
+    COLL_COMBINE_ARITH(uint64_t);
+    COLL_COMBINE_BITS(uint64_t);
+    break;
+  case chpl_comm_coll_real32:
+    COLL_COMBINE_ARITH(_real32);
+    break;
+  case chpl_comm_coll_real64:
+    COLL_COMBINE_ARITH(_real64);
+    break;
+  }
+  chpl_internal_error("unsupported collective reduction");
+}
+
+
+void chpl_comm_allreduce(void* buf, size_t count,
+                         chpl_comm_coll_type_t type, chpl_comm_coll_op_t op) {
+  const size_t size = count * coll_type_size(type);
+  const c_nodeid_t me = chpl_nodeID;
+  c_nodeid_t p2;
+  c_nodeid_t extra;
+  void* tmp;
+
+  if (chpl_numNodes <= 1 || count == 0)
+    return;
+
+#ifdef CHPL_COMM_IMPL_COLLECTIVES
+  if (chpl_comm_impl_allreduce(buf, count, type, op))
+    return;
+#endif
+
+  coll_seq++;
+  tmp = chpl_mem_alloc(size, CHPL_RT_MD_COMM_COLL_BUF, 0, 0);
+
+  //
+  // Fold the nodes past the largest power of 2 into the ones below it,
+  // do recursive doubling among those, and unfold.
+  //
+  for (p2 = 1; p2 <= chpl_numNodes / 2; p2 *= 2)
+    ;
+  extra = chpl_numNodes - p2;
+
+  if (me >= p2) {
+    coll_sendrecv(me - p2, buf, size, -1, NULL);
+  } else if (me < extra) {
+    coll_sendrecv(-1, NULL, 0, me + p2, tmp);
+    coll_combine(buf, tmp, count, type, op);
+  }
+
+  if (me < p2) {
+    for (c_nodeid_t mask = 1; mask < p2; mask <<= 1) {
+      c_nodeid_t partner = me ^ mask;
+      coll_sendrecv(partner, buf, size, partner, tmp);
+      coll_combine(buf, tmp, count, type, op);
+    }
+  }
+
+  if (me >= p2) {
+    coll_sendrecv(-1, NULL, 0, me - p2, buf);
+  } else if (me < extra) {
+    coll_sendrecv(me + p2, buf, size, -1, NULL);
+  }
+
+  chpl_mem_free(tmp, 0, 0);
+}
+
+
+void chpl_comm_allgather(const void* src, void* dst, size_t size) {
+  const c_nodeid_t me = chpl_nodeID;
+  const c_nodeid_t n = chpl_numNodes;
+  char* tmp;
+
+  if (n <= 1) {
+    memmove(dst, src, size);
+    return;
+  }
+
+  if (size == 0)
+    return;
+
+  coll_seq++;
+
+  //
+  // Bruck's algorithm.  tmp[i] collects the block from node me+i, and
+  // in the round for 'dist' we pass the blocks we have so far to node
+  // me-dist and get node me+dist's.
+  //
+  tmp = chpl_mem_alloc(n * size, CHPL_RT_MD_COMM_COLL_BUF, 0, 0);
+  memcpy(tmp, src, size);
+
+  for (c_nodeid_t dist = 1; dist < n; dist *= 2) {
+    c_nodeid_t cnt = (dist < n - dist) ? dist : n - dist;
+    coll_sendrecv((me - dist + n) % n, tmp, cnt * size,
+                  (me + dist) % n, tmp + dist * size);
+  }
+
+  for (c_nodeid_t i = 0; i < n; i++) {
+    memcpy((char*) dst + ((me + i) % n) * size, tmp + i * size, size);
+  }
+
+  chpl_mem_free(tmp, 0, 0);
+}
+
+
+void chpl_comm_bcast(void* buf, size_t size, c_nodeid_t root) {
+  const c_nodeid_t n = chpl_numNodes;
+  const c_nodeid_t rel = (chpl_nodeID - root + n) % n;
+  c_nodeid_t mask;
+
+  if (n <= 1 || size == 0)
+    return;
+
+#ifdef CHPL_COMM_IMPL_COLLECTIVES
+  if (chpl_comm_impl_bcast(buf, size, root))
+    return;
+#endif
+
+  coll_seq++;
+
+  //
+  // Binomial tree.  Relative to the root, we get the data from the
+  // node that differs from us in our lowest 1 bit, and pass it on to
+  // the nodes that differ from us in one lower bit.
+  //
+  for (mask = 1; mask < n; mask <<= 1) {
+    if (rel & mask) {
+      coll_sendrecv(-1, NULL, 0, (rel - mask + root) % n, buf);
+      break;
+    }
+  }
+
+  for (mask >>= 1; mask > 0; mask >>= 1) {
+    if (rel + mask < n) {
+      coll_sendrecv((rel + mask + root) % n, buf, size, -1, NULL);
+    }
+  }
+}
@@ -31,6 +31,8 @@
 #include "chpl-mem-consistency.h"
 #include "error.h"
 
+#include <inttypes.h>
+#include <limits.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -41,11 +43,27 @@ int chpl_comm_diagnostics = 0;
 int chpl_comm_diags_print_unstable = 0;
 
 atomic_int_least16_t chpl_comm_diags_disable_flag;
-chpl_atomic_commDiagnostics chpl_comm_diags_counters;
+chpl_atomic_commDiagnostics chpl_comm_diags_counters[CHPL_COMM_DIAGS_SHARDS];
+
+#ifdef CHPL_TLS
+CHPL_TLS int chpl_comm_diags_my_shard = -1;
+#endif
+
+static atomic_uint_least32_t next_shard;
 
 static pthread_once_t bcastPrintUnstable_once = PTHREAD_ONCE_INIT;
 
 
+//
+// Hand out counter shards to threads round-robin, as they first
+// touch the diagnostics.
+//
+int chpl_comm_diags_new_shard(void) {
+  return (int) (atomic_fetch_add_uint_least32_t(&next_shard, 1)
+                % CHPL_COMM_DIAGS_SHARDS);
+}
+
+
 static
 void broadcast_print_unstable(void) {
   chpl_comm_diags_disable();
@@ -143,3 +161,46 @@ void chpl_comm_resetDiagnosticsHere() {
 void chpl_comm_getDiagnosticsHere(chpl_commDiagnostics *cd) {
   chpl_comm_diags_copy(cd);
 }
+
+
+static const char* counts_file = NULL;
+
+void chpl_comm_diags_counts_start(void) {
+  counts_file = chpl_env_rt_get("COMM_DIAGS_COUNTS_FILE", NULL);
+  if (counts_file == NULL || counts_file[0] == '\0') {
+    counts_file = NULL;
+    return;
+  }
+
+  chpl_comm_resetDiagnosticsHere();
+  chpl_comm_startDiagnosticsHere(false);
+}
+
+
+void chpl_comm_diags_counts_report(void) {
+  chpl_commDiagnostics cd;
+  char fname[PATH_MAX];
+  FILE* f;
+
+  if (counts_file == NULL)
+    return;
+
+  chpl_comm_stopDiagnosticsHere();
+  chpl_comm_getDiagnosticsHere(&cd);
+
+  snprintf(fname, sizeof(fname), "%s.%d", counts_file, (int) chpl_nodeID);
+  if ((f = fopen(fname, "w")) == NULL) {
+    chpl_warning("cannot open comm diagnostics counts file", 0, 0);
+    return;
+  }
+
+#define _COMM_DIAGS_WRITE(cdv) \
+  fprintf(f, "%s %" PRIu64 "\n", #cdv, cd.cdv);
+  CHPL_COMM_DIAGS_VARS_ALL(_COMM_DIAGS_WRITE)
+#define _COMM_DIAGS_WRITE_XFER(cdv) _COMM_DIAGS_WRITE(cdv ## _bytes)
+  CHPL_COMM_DIAGS_XFER_VARS_ALL(_COMM_DIAGS_WRITE_XFER)
+#undef _COMM_DIAGS_WRITE_XFER
+#undef _COMM_DIAGS_WRITE
+
+  fclose(f);
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Remote allocation; see chpl_comm_remote_alloc() in chpl-comm.h.
+// The comm layers do the actual requests.
+//
+
+#include "chplrt.h"
+
+#include "chpl-comm.h"
+#include "chpl-comm-internal.h"
+#include "chpl-env.h"
+#include "chpl-locks.h"
+#include "chpl-mem.h"
+#include "chpl-mem-desc.h"
+
+//
+// Per target node, we keep blocks of each of these size classes:
+// 32, 64, 128 and 256 bytes.  A pool that runs dry is refilled with
+// half as many blocks as it can hold, in one request.
+//
+#define POOL_MIN_SHIFT  5
+#define POOL_CLASSES    4
+#define POOL_DEPTH      CHPL_COMM_REMOTE_ALLOC_MAX
+#define POOL_REFILL     (POOL_DEPTH / 2)
+
+typedef struct {
+  chpl_ticket_lock_t lock;
+  int cnt;
+  void* blocks[POOL_DEPTH];
+} pool_t;
+
+static pool_t* pools;           // [node * POOL_CLASSES + class]; may be NULL
+
+
+void chpl_comm_remote_alloc_init(void) {
+  if (chpl_numNodes <= 1
+      || !chpl_env_rt_get_bool("COMM_REMOTE_ALLOC_POOL", true))
+    return;
+
+  pools = chpl_mem_calloc(chpl_numNodes * POOL_CLASSES, sizeof(pools[0]),
+                          CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+  for (int i = 0; i < chpl_numNodes * POOL_CLASSES; i++) {
+    chpl_ticket_lock_init(&pools[i].lock, "remote_alloc_pool");
+  }
+}
+
+
+static inline
+int pool_class(size_t size) {
+  for (int c = 0; c < POOL_CLASSES; c++) {
+    if (size <= ((size_t) 1 << (POOL_MIN_SHIFT + c)))
+      return c;
+  }
+  return -1;
+}
+
+
+static
+void* pool_alloc(c_nodeid_t node, int c) {
+  pool_t* pl = &pools[node * POOL_CLASSES + c];
+  void* got[POOL_REFILL];
+  void* p = NULL;
+  int i;
+
+  chpl_ticket_lock(&pl->lock);
+  if (pl->cnt > 0)
+    p = pl->blocks[--pl->cnt];
+  chpl_ticket_unlock(&pl->lock);
+
+  if (p != NULL)
+    return p;
+
+  //
+  // Refill.  Others may have done so too in the meantime; if there
+  // isn't room for what we got, give the extras back.
+  //
+  chpl_comm_impl_remote_alloc(node, (size_t) 1 << (POOL_MIN_SHIFT + c),
+                              POOL_REFILL, got);
+
+  chpl_ticket_lock(&pl->lock);
+  for (i = 1; i < POOL_REFILL && pl->cnt < POOL_DEPTH; i++)
+    pl->blocks[pl->cnt++] = got[i];
+  chpl_ticket_unlock(&pl->lock);
+
+  for ( ; i < POOL_REFILL; i++)
+    chpl_comm_impl_remote_free(node, got[i]);
+
+  return got[0];
+}
+
+
+void* chpl_comm_remote_alloc(c_nodeid_t node, size_t size,
+                             int ln, int32_t fn) {
+  void* p;
+  int c;
+
+  if (node == chpl_nodeID)
+    return chpl_mem_alloc(size, CHPL_RT_MD_REMOTE_ALLOC, ln, fn);
+
+  if (pools != NULL && (c = pool_class(size)) >= 0)
+    return pool_alloc(node, c);
+
+  chpl_comm_impl_remote_alloc(node, size, 1, &p);
+  return p;
+}
+
+
+void chpl_comm_remote_alloc_batch(c_nodeid_t node, size_t size,
+                                  size_t n, void** ptrs,
+                                  int ln, int32_t fn) {
+  if (node == chpl_nodeID) {
+    for (size_t i = 0; i < n; i++)
+      ptrs[i] = chpl_mem_alloc(size, CHPL_RT_MD_REMOTE_ALLOC, ln, fn);
+    return;
+  }
+
+  for (size_t i = 0; i < n; i += CHPL_COMM_REMOTE_ALLOC_MAX) {
+    size_t cnt = n - i;
+    if (cnt > CHPL_COMM_REMOTE_ALLOC_MAX)
+      cnt = CHPL_COMM_REMOTE_ALLOC_MAX;
+    chpl_comm_impl_remote_alloc(node, size, cnt, &ptrs[i]);
+  }
+}
+
+
+void chpl_comm_remote_free(c_nodeid_t node, void* p, int ln, int32_t fn) {
+  if (p == NULL)
+    return;
+
+  if (node == chpl_nodeID)
+    chpl_mem_free(p, ln, fn);
+  else
+    chpl_comm_impl_remote_free(node, p);
+}
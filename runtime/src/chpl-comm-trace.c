@@ -0,0 +1,332 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Binary communication tracing.
+//
+
+#include "chplrt.h"
+
+#include "chpl-comm.h"
+#include "chpl-comm-callbacks.h"
+#include "chpl-comm-trace.h"
+#include "chpl-atomics.h"
+#include "chpl-env.h"
+#include "chpl-linefile-support.h"
+#include "chpl-mem.h"
+#include "chpl-thread-local-storage.h"
+#include "chplcgfns.h"
+#include "error.h"
+#include "sys.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/param.h>
+#include <sys/uio.h>
+#include <time.h>
+
+#define TRACE_BUF_RECS 4096
+
+//
+// Per-thread trace buffers.  Each thread fills its own and writes it
+// out when it is full.  The buffers are also on a list, so that
+// stopping the trace can flush the partial ones.  The mutex in each is
+// only contended when stopping.
+//
+typedef struct trace_buf {
+  struct trace_buf* next;
+  pthread_mutex_t lock;
+  int gen;                      // trace generation the records belong to
+  int num_recs;
+  chpl_comm_trace_rec_t recs[TRACE_BUF_RECS];
+} trace_buf_t;
+
+static trace_buf_t* trace_bufs;
+static pthread_mutex_t trace_bufs_lock = PTHREAD_MUTEX_INITIALIZER;
+
+#ifdef CHPL_TLS
+static CHPL_TLS trace_buf_t* my_trace_buf;
+#else
+static pthread_key_t my_trace_buf_key;
+static pthread_once_t my_trace_buf_key_once = PTHREAD_ONCE_INIT;
+#endif
+
+static int trace_on;
+static int trace_gen;
+static fd_t trace_fd = -1;
+static atomic_uint_least64_t trace_file_off;
+
+static void cb_trace_comm(const chpl_comm_cb_info_t*);
+
+
+static inline
+uint64_t trace_now(void) {
+  struct timespec ts;
+  (void) clock_gettime(CLOCK_REALTIME, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+}
+
+
+//
+// Write out the records in a buffer, if they belong to the current
+// trace, and empty it.  The caller holds the buffer's lock.
+//
+static
+void trace_buf_flush(trace_buf_t* tb) {
+  if (tb->num_recs > 0 && tb->gen == trace_gen && trace_fd >= 0) {
+    struct iovec iov;
+    ssize_t num_written;
+    size_t len = tb->num_recs * sizeof(tb->recs[0]);
+    uint64_t off;
+
+    iov.iov_base = tb->recs;
+    iov.iov_len = len;
+    off = atomic_fetch_add_uint_least64_t(&trace_file_off, len);
+    if (sys_pwritev(trace_fd, &iov, 1, off, &num_written) != 0
+        || (size_t) num_written != len) {
+      chpl_warning("comm trace: write failed, records lost", 0, 0);
+    }
+  }
+
+  tb->num_recs = 0;
+}
+
+
+#ifndef CHPL_TLS
+static
+void make_my_trace_buf_key(void) {
+  if (pthread_key_create(&my_trace_buf_key, NULL) != 0) {
+    chpl_internal_error("pthread_key_create(&my_trace_buf_key) failed");
+  }
+}
+#endif
+
+
+static
+trace_buf_t* get_my_trace_buf(void) {
+  trace_buf_t* tb;
+
+#ifdef CHPL_TLS
+  tb = my_trace_buf;
+#else
+  if (pthread_once(&my_trace_buf_key_once, make_my_trace_buf_key) != 0) {
+    chpl_internal_error("pthread_once(&my_trace_buf_key_once) failed");
+  }
+  tb = (trace_buf_t*) pthread_getspecific(my_trace_buf_key);
+#endif
+
+  if (tb == NULL) {
+    tb = (trace_buf_t*) chpl_mem_alloc(sizeof(*tb), CHPL_RT_MD_COMM_UTIL,
+                                       0, 0);
+    (void) pthread_mutex_init(&tb->lock, NULL);
+    tb->gen = trace_gen;
+    tb->num_recs = 0;
+
+    pthread_mutex_lock(&trace_bufs_lock);
+    tb->next = trace_bufs;
+    trace_bufs = tb;
+    pthread_mutex_unlock(&trace_bufs_lock);
+
+#ifdef CHPL_TLS
+    my_trace_buf = tb;
+#else
+    (void) pthread_setspecific(my_trace_buf_key, tb);
+#endif
+  }
+
+  return tb;
+}
+
+
+static
+void cb_trace_comm(const chpl_comm_cb_info_t* info) {
+  trace_buf_t* tb;
+  chpl_comm_trace_rec_t* rec;
+
+  if (!trace_on) {
+    return;
+  }
+
+  tb = get_my_trace_buf();
+  pthread_mutex_lock(&tb->lock);
+
+  if (tb->gen != trace_gen) {
+    // left over from an earlier trace, already flushed or dropped
+    tb->gen = trace_gen;
+    tb->num_recs = 0;
+  }
+
+  rec = &tb->recs[tb->num_recs];
+  memset(rec, 0, sizeof(*rec));
+  rec->time_ns = trace_now();
+  rec->remote_node = (int32_t) info->remoteNodeID;
+  rec->kind = (uint8_t) info->event_kind;
+
+  switch (info->event_kind) {
+  case chpl_comm_cb_event_kind_put:
+  case chpl_comm_cb_event_kind_put_nb:
+  case chpl_comm_cb_event_kind_get:
+  case chpl_comm_cb_event_kind_get_nb:
+    rec->size = info->iu.comm.size;
+    rec->lineno = info->iu.comm.lineno;
+    rec->filename = info->iu.comm.filename;
+    break;
+  case chpl_comm_cb_event_kind_put_strd:
+  case chpl_comm_cb_event_kind_get_strd:
+    {
+      const struct chpl_comm_info_comm_strd* cm = &info->iu.comm_strd;
+      size_t size = cm->elemSize;
+      for (int32_t i = 0; i <= cm->stridelevels; i++) {
+        size *= cm->count[i];
+      }
+      rec->size = size;
+      rec->lineno = cm->lineno;
+      rec->filename = cm->filename;
+    }
+    break;
+  case chpl_comm_cb_event_kind_executeOn:
+  case chpl_comm_cb_event_kind_executeOn_nb:
+  case chpl_comm_cb_event_kind_executeOn_fast:
+    rec->size = info->iu.executeOn.arg_size;
+    rec->lineno = info->iu.executeOn.lineno;
+    rec->filename = info->iu.executeOn.filename;
+    break;
+  default:
+    break;
+  }
+
+  if (++tb->num_recs == TRACE_BUF_RECS) {
+    trace_buf_flush(tb);
+  }
+
+  pthread_mutex_unlock(&tb->lock);
+}
+
+
+//
+// Node 0 writes out the filename table, so that the analysis tool can
+// turn the filename indices in the records back into names.
+//
+static
+void write_filename_table(const char* fileroot) {
+  char fname[MAXPATHLEN];
+  FILE* f;
+
+  snprintf(fname, sizeof(fname), "%s.files", fileroot);
+  if ((f = fopen(fname, "w")) == NULL) {
+    chpl_warning("comm trace: cannot create filename table", 0, 0);
+    return;
+  }
+
+  for (int32_t ix = 0; ix < chpl_filenameTableSize; ix++) {
+    fprintf(f, "%d %s\n", (int) ix, chpl_lookupFilename(ix));
+  }
+
+  fclose(f);
+}
+
+
+void chpl_comm_trace_start(const char* fileroot) {
+  char fname[MAXPATHLEN];
+  chpl_comm_trace_hdr_t hdr;
+  ssize_t num_written;
+
+  if (trace_fd >= 0) {
+    chpl_comm_trace_stop();
+  }
+
+  if (fileroot == NULL || fileroot[0] == '\0') {
+    fileroot = "chpl-comm-trace";
+  }
+
+  snprintf(fname, sizeof(fname), "%s.%d", fileroot, (int) chpl_nodeID);
+  if (sys_open(fname, O_WRONLY | O_CREAT | O_TRUNC, 0666, &trace_fd) != 0) {
+    char msg[MAXPATHLEN + 100];
+    snprintf(msg, sizeof(msg), "comm trace: cannot create %s: %s",
+             fname, strerror(errno));
+    chpl_warning(msg, 0, 0);
+    trace_fd = -1;
+    return;
+  }
+
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, CHPL_COMM_TRACE_MAGIC, sizeof(hdr.magic));
+  hdr.version = CHPL_COMM_TRACE_VERSION;
+  hdr.rec_size = sizeof(chpl_comm_trace_rec_t);
+  hdr.node = (int32_t) chpl_nodeID;
+  hdr.num_nodes = (int32_t) chpl_numNodes;
+  hdr.start_ns = trace_now();
+  (void) sys_pwrite(trace_fd, &hdr, sizeof(hdr), 0, &num_written);
+  atomic_store_uint_least64_t(&trace_file_off, sizeof(hdr));
+
+  if (chpl_nodeID == 0) {
+    write_filename_table(fileroot);
+  }
+
+  trace_gen++;
+
+  for (int k = 0; k < chpl_comm_cb_num_event_kinds; k++) {
+    (void) chpl_comm_install_callback((chpl_comm_cb_event_kind_t) k,
+                                      cb_trace_comm);
+  }
+
+  trace_on = 1;
+}
+
+
+void chpl_comm_trace_stop(void) {
+  trace_buf_t* tb;
+
+  if (trace_fd < 0) {
+    return;
+  }
+
+  trace_on = 0;
+
+  for (int k = 0; k < chpl_comm_cb_num_event_kinds; k++) {
+    (void) chpl_comm_uninstall_callback((chpl_comm_cb_event_kind_t) k,
+                                        cb_trace_comm);
+  }
+
+  pthread_mutex_lock(&trace_bufs_lock);
+  for (tb = trace_bufs; tb != NULL; tb = tb->next) {
+    pthread_mutex_lock(&tb->lock);
+    trace_buf_flush(tb);
+    pthread_mutex_unlock(&tb->lock);
+  }
+  pthread_mutex_unlock(&trace_bufs_lock);
+
+  (void) sys_close(trace_fd);
+  trace_fd = -1;
+}
+
+
+void chpl_comm_trace_init(void) {
+  const char* fileroot;
+
+  atomic_init_uint_least64_t(&trace_file_off, 0);
+
+  if ((fileroot = chpl_env_rt_get("COMM_TRACE", NULL)) != NULL) {
+    chpl_comm_trace_start(fileroot);
+  }
+}
@@ -38,7 +38,9 @@
 
 #include <pthread.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 int32_t chpl_nodeID = -1;
@@ -53,7 +55,97 @@ void chpl_comm_register_global_var(int i, wide_ptr_t *ptr_to_wide_ptr) {
 }
 
 
+static pthread_once_t bcastFanout_once = PTHREAD_ONCE_INIT;
+static int bcastFanout;
+
+static
+void set_bcastFanout(void)
+{
+  bcastFanout = (int) chpl_env_rt_get_int("COMM_BCAST_FANOUT", 8);
+  if (bcastFanout < 0) {
+    bcastFanout = 0;
+  }
+}
+
+int chpl_comm_bcast_fanout(void)
+{
+  if (pthread_once(&bcastFanout_once, set_bcastFanout) != 0) {
+    chpl_internal_error("pthread_once(&bcastFanout_once) failed");
+  }
+
+  return bcastFanout;
+}
+
+
+void** chpl_comm_bcast_addr_tab;
+
+//
+// Tree broadcast of the global variables.  Each non-0 node GETs the
+// wide pointers from its parent's copy, one tree level per barrier
+// phase, so node 0 only serves its own children.  The parents' buffer
+// addresses are collected in a table on node 0 first.
+//
+static
+void broadcast_global_vars_tree(wide_ptr_t* buf_on_0, int fanout) {
+  size_t size = chpl_numGlobalsOnHeap * sizeof(wide_ptr_t);
+  int myDepth = chpl_comm_bcast_tree_depth(chpl_nodeID, fanout);
+  int maxDepth = chpl_comm_bcast_tree_depth(chpl_numNodes - 1, fanout);
+  wide_ptr_t* buf = NULL;
+
+  if (chpl_nodeID == 0) {
+    chpl_comm_bcast_addr_tab =
+      chpl_mem_allocManyZero(chpl_numNodes, sizeof(chpl_comm_bcast_addr_tab[0]),
+                             CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+    chpl_comm_bcast_rt_private(chpl_comm_bcast_addr_tab);
+  }
+  chpl_comm_barrier("broadcast global vars addr table");
+
+  if (chpl_nodeID != 0) {
+    buf = (wide_ptr_t*)
+          chpl_mem_alloc(size, CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+    chpl_comm_put(&buf, 0, &chpl_comm_bcast_addr_tab[chpl_nodeID],
+                  sizeof(buf), CHPL_COMM_UNKNOWN_ID, 0, -1);
+  }
+  chpl_comm_barrier("broadcast global vars buffers");
+
+  for (int depth = 1; depth <= maxDepth; depth++) {
+    if (depth == myDepth) {
+      c_nodeid_t parent = chpl_comm_bcast_tree_parent(chpl_nodeID, fanout);
+      void* pbuf;
+      if (parent == 0) {
+        pbuf = buf_on_0;
+      } else {
+        chpl_comm_get(&pbuf, 0, &chpl_comm_bcast_addr_tab[parent],
+                      sizeof(pbuf), CHPL_COMM_UNKNOWN_ID, 0, -1);
+      }
+      chpl_comm_get(buf, parent, pbuf, size, CHPL_COMM_UNKNOWN_ID, 0, -1);
+      for (int i = 0; i < chpl_numGlobalsOnHeap; i++) {
+        *chpl_globals_registry[i] = buf[i];
+      }
+    }
+    chpl_comm_barrier("broadcast global vars tree level");
+  }
+
+  //
+  // The last barrier above guarantees that everyone is done with all
+  // the buffers, and also keeps node 0 from running any Chapel code
+  // until all the other nodes have recorded the wide pointers.
+  //
+  if (chpl_nodeID == 0) {
+    chpl_mem_free(chpl_comm_bcast_addr_tab, 0, 0);
+    chpl_comm_bcast_addr_tab = NULL;
+    if (buf_on_0 != NULL) {
+      chpl_mem_free(buf_on_0, 0, 0);
+    }
+  } else {
+    chpl_mem_free(buf, 0, 0);
+  }
+}
+
+
 void chpl_comm_broadcast_global_vars(int numGlobals) {
+  int fanout;
+
   //
   // On node 0: gather up the global variables' wide pointers into a
   //            buffer; return that buffer if it needs deallocating
@@ -63,6 +155,16 @@ void chpl_comm_broadcast_global_vars(int numGlobals) {
   wide_ptr_t* buf_on_0;
   buf_on_0 = chpl_comm_broadcast_global_vars_helper();
 
+  //
+  // With more nodes than node 0 would serve in a tree anyway, do a
+  // tree broadcast.
+  //
+  fanout = chpl_comm_bcast_fanout();
+  if (fanout > 0 && chpl_numNodes > fanout + 1) {
+    broadcast_global_vars_tree(buf_on_0, fanout);
+    return;
+  }
+
   //
   // On node 0: barrier to ensure the other nodes have the global vars;
   //            free the buffer if needed.
@@ -161,23 +263,58 @@ typedef struct {
   uintptr_t size;
   int tid;
   int nthreads;
+  int nparts;                     // 0: interleave; else # of blocks
+  uintptr_t part_size;
 } memory_region;
 
-// Pin a thread a specific NUMA domain and cyclically touch pages to get
-// interleaved memory. We don't have an accurate estimate of the page size when
-// Transparent Huge Pages (THP) are used, so we fault in regions in at least 2
-// MiB chunks to cover the most common THP size. We then touch the first
-// element of every system page or non-transparent huge page to fault in.
+// Pin a thread to a core in a specific NUMA domain and touch pages so
+// that they land there.  With nparts == 0 the domains' threads touch
+// the region cyclically, to get interleaved memory.  Otherwise it is in
+// nparts blocks of part_size bytes, and only the threads on domain d
+// touch block d, cyclically among themselves.  We don't have an
+// accurate estimate of the page size when Transparent Huge Pages (THP)
+// are used, so we fault in regions in at least 2 MiB chunks to cover
+// the most common THP size. We then touch the first element of every
+// system page or non-transparent huge page to fault in.
 static void *touch_thread(void *mem_region) {
   memory_region* mr = (memory_region*) mem_region;
 
   uintptr_t page_size = chpl_comm_regMemHeapPageSize();
   uintptr_t touch_size = page_size > 2<<20 ? page_size: 2<<20;
+  int ndoms = (mr->nparts > 0) ? mr->nparts : chpl_topo_getNumNumaDomains();
+  int dom = mr->tid % ndoms;
+  int dom_tid = mr->tid / ndoms;
+  int cpu;
+
+  if ((cpu = chpl_topo_getNumaCPU(dom, dom_tid)) < 0
+      || chpl_topo_setThreadCPU(cpu) != 0) {
+    chpl_topo_setThreadLocality(dom);
+  }
+
+  if (mr->nparts > 0) {
+    // threads tid, tid+ndoms, ... are the ones on this domain
+    int dom_nthreads = (mr->nthreads - dom + ndoms - 1) / ndoms;
+    unsigned char* part_start = mr->start + (uintptr_t) dom * mr->part_size;
+    unsigned char* aligned_start = round_up_to_mask_ptr(part_start,
+                                                        touch_size-1);
+    uintptr_t aligned_offset = (uintptr_t)aligned_start - (uintptr_t)part_start;
+    if (aligned_offset >= mr->part_size)
+      return NULL;
+    uintptr_t aligned_size = round_down_to_mask(mr->part_size - aligned_offset,
+                                                touch_size-1);
+    for (uintptr_t tr=dom_tid*touch_size; tr<aligned_size;
+         tr+=dom_nthreads*touch_size) {
+      for (uintptr_t pr=tr; pr<tr+touch_size; pr+=page_size) {
+        aligned_start[pr] = 0;
+      }
+    }
+    return NULL;
+  }
+
   unsigned char* aligned_start = round_up_to_mask_ptr(mr->start, touch_size-1);
   uintptr_t aligned_offset = (uintptr_t)aligned_start - (uintptr_t)mr->start;
   uintptr_t aligned_size = round_down_to_mask(mr->size - aligned_offset, touch_size-1);
 
-  chpl_topo_setThreadLocality(mr->tid % chpl_topo_getNumNumaDomains());
   // Iterate through all the touch regions cyclically
   for (uintptr_t tr=mr->tid*touch_size; tr<aligned_size; tr+=mr->nthreads*touch_size) {
     // Iterate through all the page regions in the current region we're touching
@@ -188,29 +325,77 @@ static void *touch_thread(void *mem_region) {
   return NULL;
 }
 
-// Touch or fault-in a region of memory. Meant to be used on the registered
-// heap/segment for configurations that register a static heap.  We try to
-// touch the memory in an interleaved/cyclic fashion in parallel to improve
-// NUMA affinity and the speed of faulting memory in. Without this memory will
-// be faulted in serially at NIC registration time, which is slow and leads to
-// poor NUMA affinity with memory split evenly in massive chunks across NUMA
-// domains.
-void chpl_comm_regMemHeapTouch(void* start, uintptr_t size) {
+static void touch_heap(void* start, uintptr_t size,
+                       int nparts, uintptr_t part_size) {
   int nthreads = chpl_topo_getNumCPUsPhysical(true);
   pthread_t thread_id[nthreads];
   memory_region mem_regions[nthreads];
+  struct timespec t0, t1;
+
+  if (nparts > nthreads)
+    nthreads = nparts;              // at least one thread per block
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
 
   for (int tid=0; tid<nthreads; tid++) {
     mem_regions[tid].start = start;
     mem_regions[tid].size = size;
     mem_regions[tid].tid = tid;
     mem_regions[tid].nthreads = nthreads;
+    mem_regions[tid].nparts = nparts;
+    mem_regions[tid].part_size = part_size;
     pthread_create(&thread_id[tid], NULL, touch_thread, (void *)&mem_regions[tid]);
   }
 
   for (int tid=0; tid<nthreads; tid++) {
     pthread_join(thread_id[tid], NULL);
   }
+
+  if (chpl_env_rt_get_bool("COMM_HEAP_TOUCH_REPORT", false)) {
+    double secs;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    fprintf(stderr,
+            "%d: heap touch: %.2f GiB in %.3f s (%.2f GiB/s), "
+            "%d threads, %s\n",
+            (int) chpl_nodeID, size / (double) (1 << 30), secs,
+            (secs > 0) ? size / (double) (1 << 30) / secs : 0.0,
+            nthreads, (nparts > 0) ? "blocked" : "interleaved");
+  }
+}
+
+// Touch or fault-in a region of memory. Meant to be used on the registered
+// heap/segment for configurations that register a static heap.  We touch
+// the memory in parallel to improve NUMA affinity and the speed of
+// faulting memory in. Without this memory will be faulted in serially at
+// NIC registration time, which is slow and leads to poor NUMA affinity
+// with memory split evenly in massive chunks across NUMA domains.  By
+// default the memory is interleaved across the NUMA domains in 2 MiB
+// chunks; CHPL_RT_COMM_HEAP_TOUCH_POLICY=block instead gives each domain
+// one contiguous block.
+void chpl_comm_regMemHeapTouch(void* start, uintptr_t size) {
+  const char* policy = chpl_env_rt_get("COMM_HEAP_TOUCH_POLICY", "interleave");
+  int ndoms = chpl_topo_getNumNumaDomains();
+
+  if (strcmp(policy, "block") == 0 && ndoms > 1) {
+    touch_heap(start, size, ndoms, size / ndoms);
+  } else {
+    if (strcmp(policy, "interleave") != 0 && strcmp(policy, "block") != 0) {
+      char msg[100];
+      snprintf(msg, sizeof(msg),
+               "CHPL_RT_COMM_HEAP_TOUCH_POLICY=%s unknown; using "
+               "\"interleave\"", policy);
+      chpl_warning(msg, 0, 0);
+    }
+    touch_heap(start, size, 0, 0);
+  }
+}
+
+// Touch a region split into nparts contiguous parts of part_size bytes,
+// each part from threads on the NUMA domain with the same index.
+void chpl_comm_regMemHeapTouchParts(void* start, int nparts,
+                                    size_t part_size) {
+  touch_heap(start, (uintptr_t) nparts * part_size, nparts, part_size);
 }
 
 void* chpl_get_global_serialize_table(int64_t idx) {
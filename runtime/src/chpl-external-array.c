@@ -20,8 +20,25 @@
 #include "chplrt.h"
 
 #include "chpl-external-array.h"
+#include "chpl-comm.h"
 #include "chpl-mem.h"
 
+#include <pthread.h>
+
+//
+// External arrays whose memory is registered with the comm layer, so
+// that it can be deregistered when the array is freed.  We expect few
+// of these at a time, so a list will do.
+//
+typedef struct chpl_external_reg_s {
+  void* elts;
+  size_t size;
+  struct chpl_external_reg_s* next;
+} chpl_external_reg_t;
+
+static chpl_external_reg_t* regList = NULL;
+static pthread_mutex_t regListLock = PTHREAD_MUTEX_INITIALIZER;
+
 static void chpl_wrap_chapel_free_call(void* mem) {
   chpl_mem_free(mem, 0, 0);
 }
@@ -57,7 +74,67 @@ chpl_external_array chpl_make_external_array_ptr_free(void* elts,
   return ret;
 }
 
+static void chpl_register_external_array(chpl_external_array* x,
+                                         uint64_t elt_size) {
+  size_t size = elt_size * x->num_elts;
+  chpl_external_reg_t* reg;
+
+  if (x->elts == NULL || !chpl_comm_regMemRegister(x->elts, size))
+    return;
+
+  reg = (chpl_external_reg_t*) chpl_mem_alloc(sizeof(*reg),
+                                              CHPL_RT_MD_COMM_UTIL, 0, 0);
+  reg->elts = x->elts;
+  reg->size = size;
+  pthread_mutex_lock(&regListLock);
+  reg->next = regList;
+  regList = reg;
+  pthread_mutex_unlock(&regListLock);
+}
+
+// Like chpl_make_external_array_ptr(), but also registers the memory
+// with the comm layer (if it needs that) so it can be the source or
+// target of RMA directly.  The registration is undone when the array
+// is freed with chpl_free_external_array(), so the memory must not be
+// freed some other way first.
+chpl_external_array chpl_make_external_array_ptr_reg(void* elts,
+                                                     uint64_t elt_size,
+                                                     uint64_t num_elts) {
+  chpl_external_array ret = chpl_make_external_array_ptr(elts, num_elts);
+  chpl_register_external_array(&ret, elt_size);
+  return ret;
+}
+
+chpl_external_array chpl_make_external_array_ptr_free_reg(void* elts,
+                                                          uint64_t elt_size,
+                                                          uint64_t num_elts) {
+  chpl_external_array ret = chpl_make_external_array_ptr_free(elts,
+                                                              num_elts);
+  chpl_register_external_array(&ret, elt_size);
+  return ret;
+}
+
 void chpl_free_external_array(chpl_external_array x) {
+  chpl_external_reg_t* reg = NULL;
+
+  pthread_mutex_lock(&regListLock);
+  if (regList != NULL) {
+    chpl_external_reg_t** pReg;
+    for (pReg = &regList; *pReg != NULL; pReg = &(*pReg)->next) {
+      if ((*pReg)->elts == x.elts) {
+        reg = *pReg;
+        *pReg = reg->next;
+        break;
+      }
+    }
+  }
+  pthread_mutex_unlock(&regListLock);
+
+  if (reg != NULL) {
+    chpl_comm_regMemDeregister(reg->elts, reg->size);
+    chpl_mem_free(reg, 0, 0);
+  }
+
   chpl_call_free_func(x.freer, x.elts);
 }
 
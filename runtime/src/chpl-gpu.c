@@ -0,0 +1,195 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// GPU sublocale support, over the CUDA driver API.  See chpl-gpu.h.
+//
+
+#include "chplrt.h"
+
+#ifdef HAS_GPU_LOCALE
+
+#include "chplcgfns.h"
+#include "chpl-env.h"
+#include "chpl-gpu.h"
+#include "chpl-mem.h"
+#include "chpl-mem-desc.h"
+#include "chpl-tasks.h"
+#include "error.h"
+
+#include <cuda.h>
+#include <stdarg.h>
+#include <stdint.h>
+
+#define CUDA_CALL(call)                                                 \
+  do {                                                                  \
+    CUresult _rc = (call);                                              \
+    if (_rc != CUDA_SUCCESS) {                                          \
+      const char* _msg = NULL;                                          \
+      (void) cuGetErrorString(_rc, &_msg);                              \
+      chpl_internal_error_v("%s: %s", #call,                            \
+                            (_msg == NULL) ? "unknown error" : _msg);   \
+    }                                                                   \
+  } while (0)
+
+static int num_devices;
+static CUcontext* contexts;             // primary context, per device
+static CUmodule* modules;               // chpl_gpuBinary, per device
+static int* max_grid_x;                 // grid size limit, per device
+static int block_size;
+
+
+void chpl_gpu_init(void) {
+  //
+  // With no usable devices the GPU sublocales are never entered, so
+  // everything runs on the CPUs.
+  //
+  if (cuInit(0) != CUDA_SUCCESS
+      || cuDeviceGetCount(&num_devices) != CUDA_SUCCESS
+      || num_devices <= 0) {
+    num_devices = 0;
+    return;
+  }
+
+  contexts = chpl_mem_allocMany(num_devices, sizeof(contexts[0]),
+                                CHPL_RT_MD_GPU_UTIL, 0, 0);
+  modules = chpl_mem_allocMany(num_devices, sizeof(modules[0]),
+                               CHPL_RT_MD_GPU_UTIL, 0, 0);
+  max_grid_x = chpl_mem_allocMany(num_devices, sizeof(max_grid_x[0]),
+                                  CHPL_RT_MD_GPU_UTIL, 0, 0);
+
+  for (int i = 0; i < num_devices; i++) {
+    CUdevice dev;
+    CUDA_CALL(cuDeviceGet(&dev, i));
+    CUDA_CALL(cuDevicePrimaryCtxRetain(&contexts[i], dev));
+    CUDA_CALL(cuCtxSetCurrent(contexts[i]));
+    CUDA_CALL(cuModuleLoadData(&modules[i], chpl_gpuBinary));
+    CUDA_CALL(cuDeviceGetAttribute(&max_grid_x[i],
+                                   CU_DEVICE_ATTRIBUTE_MAX_GRID_DIM_X, dev));
+  }
+
+  block_size = (int) chpl_env_rt_get_int("GPU_BLOCK_SIZE", 256);
+  if (block_size <= 0) {
+    chpl_warning("CHPL_RT_GPU_BLOCK_SIZE must be positive; using 256", 0, 0);
+    block_size = 256;
+  }
+}
+
+
+int chpl_gpu_num_devices(void) {
+  return num_devices;
+}
+
+
+chpl_bool chpl_gpu_running_on_gpu_subloc(void) {
+  return chpl_gpu_subloc_is_device(chpl_task_getRequestedSubloc());
+}
+
+
+void chpl_gpu_launch_kernel(int ln, int32_t fn, const char* name,
+                            int64_t lo, int64_t hi, int nargs, ...) {
+  c_sublocid_t dev = chpl_task_getRequestedSubloc();
+  CUfunction kernel;
+  void* params[2 + nargs];
+  va_list ap;
+
+  if (!chpl_gpu_subloc_is_device(dev)) {
+    chpl_error("GPU kernel launched off of a GPU sublocale", ln, fn);
+  }
+
+  if (hi < lo)
+    return;
+
+  params[0] = &lo;
+  params[1] = &hi;
+  va_start(ap, nargs);
+  for (int i = 0; i < nargs; i++) {
+    params[2 + i] = va_arg(ap, void*);
+  }
+  va_end(ap);
+
+  {
+    uint64_t n = (uint64_t) (hi - lo) + 1;
+    uint64_t blocks = (n + block_size - 1) / block_size;
+
+    //
+    // Each thread handles one index, so the whole range has to fit in a
+    // single grid.  (n wraps to 0 for the full int(64) range.)
+    //
+    if (n == 0 || blocks > (uint64_t) max_grid_x[dev]) {
+      chpl_error("GPU kernel iteration space is too large for one grid",
+                 ln, fn);
+    }
+
+    CUDA_CALL(cuCtxSetCurrent(contexts[dev]));
+    CUDA_CALL(cuModuleGetFunction(&kernel, modules[dev], name));
+    CUDA_CALL(cuLaunchKernel(kernel,
+                             (unsigned int) blocks, 1, 1,
+                             (unsigned int) block_size, 1, 1,
+                             0, NULL, params, NULL));
+    CUDA_CALL(cuCtxSynchronize());
+  }
+}
+
+
+//
+// Array memory for GPU sublocales is managed, so the host can
+// initialize it and the kernels can use it in place.
+//
+void* chpl_gpu_mem_alloc(size_t size, c_sublocid_t subloc,
+                         int32_t lineno, int32_t filename) {
+  CUdeviceptr p;
+
+  if (size == 0)
+    size = 1;
+
+  CUDA_CALL(cuCtxSetCurrent(contexts[subloc]));
+  if (cuMemAllocManaged(&p, size, CU_MEM_ATTACH_GLOBAL) != CUDA_SUCCESS) {
+    chpl_error("Out of GPU memory", lineno, filename);
+  }
+
+  return (void*) p;
+}
+
+
+chpl_bool chpl_gpu_is_device_ptr(void* p) {
+  unsigned int managed = 0;
+
+  if (num_devices == 0 || p == NULL)
+    return false;
+
+  //
+  // Memory the driver doesn't know about gets an error here, not a
+  // false attribute.
+  //
+  if (cuPointerGetAttribute(&managed, CU_POINTER_ATTRIBUTE_IS_MANAGED,
+                            (CUdeviceptr) p) != CUDA_SUCCESS)
+    return false;
+
+  return managed != 0;
+}
+
+
+void chpl_gpu_mem_free(void* p, int32_t lineno, int32_t filename) {
+  CUDA_CALL(cuCtxSetCurrent(contexts[0]));
+  CUDA_CALL(cuMemFree((CUdeviceptr) p));
+}
+
+#endif // HAS_GPU_LOCALE
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Startup timeline support.
+//
+
+#include "chplrt.h"
+
+#include "chpl-comm.h"
+#include "chpl-comm-compiler-macros.h"
+#include "chpl-comm-internal.h"
+#include "chpl-env.h"
+#include "chpl-init-timeline.h"
+#include "chpl-mem.h"
+#include "chpltimers.h"
+#include "error.h"
+
+// Don't get warning macros for chpl_comm_put.
+#include "chpl-comm-no-warning-macros.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+double* chpl_init_timeline_tab;
+
+static double startTime;
+static double phaseEnd[chpl_init_num_phases];
+
+#define _CHPL_INIT_PHASE_M(sym, name) name,
+static const char* phaseNames[chpl_init_num_phases] =
+  { CHPL_INIT_PHASES(_CHPL_INIT_PHASE_M) };
+#undef _CHPL_INIT_PHASE_M
+
+
+static
+double now(void) {
+  _timevalue t = chpl_now_timevalue();
+  return (double) chpl_timevalue_seconds(t)
+         + 1.0e-6 * (double) chpl_timevalue_microseconds(t);
+}
+
+
+void chpl_init_timeline_start(void) {
+  startTime = now();
+}
+
+
+void chpl_init_timeline_mark(chpl_init_phase_t phase) {
+  phaseEnd[phase] = now();
+}
+
+
+static
+int cmp_double(const void* a, const void* b) {
+  double x = *(const double*) a;
+  double y = *(const double*) b;
+  return (x < y) ? -1 : (x > y) ? 1 : 0;
+}
+
+
+static
+void print_timeline(double* tab, chpl_bool json) {
+  double* col;
+  int p, n;
+
+  col = chpl_mem_allocMany(chpl_numNodes, sizeof(col[0]),
+                           CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+
+  if (json) {
+    printf("{\"numLocales\": %d, \"phases\": [", (int) chpl_numNodes);
+  } else {
+    printf("startup timeline (seconds, %d locales):\n", (int) chpl_numNodes);
+    printf("  %-40s %10s %10s %10s  %s\n",
+           "phase", "min", "median", "max", "max on");
+  }
+
+  for (p = 0; p < chpl_init_num_phases; p++) {
+    double median;
+    int maxNode = 0;
+
+    for (n = 0; n < chpl_numNodes; n++) {
+      col[n] = tab[n * chpl_init_num_phases + p];
+      if (col[n] > tab[maxNode * chpl_init_num_phases + p]) {
+        maxNode = n;
+      }
+    }
+    qsort(col, chpl_numNodes, sizeof(col[0]), cmp_double);
+    median = (chpl_numNodes % 2 == 1)
+             ? col[chpl_numNodes / 2]
+             : (col[chpl_numNodes / 2 - 1] + col[chpl_numNodes / 2]) / 2;
+
+    if (json) {
+      printf("%s\n  {\"phase\": \"%s\", \"min\": %.6f, \"median\": %.6f, "
+             "\"max\": %.6f, \"maxLocale\": %d}",
+             (p == 0) ? "" : ",", phaseNames[p],
+             col[0], median, col[chpl_numNodes - 1], maxNode);
+    } else {
+      printf("  %-40s %10.6f %10.6f %10.6f  %d\n",
+             phaseNames[p], col[0], median, col[chpl_numNodes - 1], maxNode);
+    }
+  }
+
+  if (json) {
+    printf("\n]}\n");
+  }
+  fflush(stdout);
+
+  chpl_mem_free(col, 0, 0);
+}
+
+
+void chpl_init_timeline_report(void) {
+  const char* ev = chpl_env_rt_get("INIT_TIMELINE", NULL);
+  chpl_bool json = (ev != NULL && strcasecmp(ev, "json") == 0);
+  double times[chpl_init_num_phases];
+  double prev;
+  int p;
+
+  if (!json && !chpl_env_str_to_bool("INIT_TIMELINE", ev, false)) {
+    return;
+  }
+
+  prev = startTime;
+  for (p = 0; p < chpl_init_num_phases; p++) {
+    times[p] = phaseEnd[p] - prev;
+    prev = phaseEnd[p];
+  }
+
+  //
+  // Node 0 makes a table for everyone's times and broadcasts where it
+  // is, then the other nodes PUT their times into it.
+  //
+  if (chpl_nodeID == 0) {
+    chpl_init_timeline_tab =
+      chpl_mem_allocMany(chpl_numNodes * chpl_init_num_phases,
+                         sizeof(chpl_init_timeline_tab[0]),
+                         CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+    memcpy(chpl_init_timeline_tab, times, sizeof(times));
+    chpl_comm_bcast_rt_private(chpl_init_timeline_tab);
+  }
+  chpl_comm_barrier("init timeline table");
+
+  if (chpl_nodeID != 0) {
+    chpl_comm_put(times, 0,
+                  &chpl_init_timeline_tab[chpl_nodeID * chpl_init_num_phases],
+                  sizeof(times), CHPL_COMM_UNKNOWN_ID, 0, -1);
+  }
+  chpl_comm_barrier("init timeline gathered");
+
+  if (chpl_nodeID == 0) {
+    print_timeline(chpl_init_timeline_tab, json);
+    chpl_mem_free(chpl_init_timeline_tab, 0, 0);
+    chpl_init_timeline_tab = NULL;
+  }
+}
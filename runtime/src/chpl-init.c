@@ -26,16 +26,22 @@
 #include "chplcgfns.h"
 #include "chpl-cache.h"
 #include "chpl-comm.h"
+#include "chpl-comm-diags.h"
+#include "chpl-comm-trace.h"
+#include "chpl-gpu.h"
 #include "chplexit.h"
 #include "chplio.h"
 #include "chpl-init.h"
+#include "chpl-init-timeline.h"
 #include "chpl-mem.h"
+#include "chpl-mem-array.h"
 #include "chplmemtrack.h"
 #include "chpl-privatization.h"
 #include "chpl-tasks.h"
 #include "chpl-topo.h"
 #include "chpl-linefile-support.h"
 #include "chplsys.h"
+#include "chpltimers.h"
 #include "config.h"
 #include "error.h"
 
@@ -94,6 +100,8 @@ static void recordExecutionCommand(int argc, char *argv[]) {
 // code.  The call on non-0 locales is made from chpl_main(), above.
 //
 void chpl_rt_preUserCodeHook(void) {
+  chpl_init_timeline_mark(chpl_init_phase_MODULE_INIT);
+
   //
   // The module initialization functions have all completed on each
   // node, locally, before we are called. 
@@ -119,6 +127,7 @@ void chpl_rt_preUserCodeHook(void) {
   //
   chpl_comm_barrier("pre-user-code hook: task counts stable");
   chpl_setMemFlags();
+  chpl_comm_diags_counts_start();
 
   //
   // Finally, we have to do a third barrier to make sure all the nodes
@@ -126,6 +135,11 @@ void chpl_rt_preUserCodeHook(void) {
   // user code and execution starts spreading around the nodes.
   //
   chpl_comm_barrier("pre-user-code hook: mem tracking inited");
+
+  //
+  // Now that startup is over, report how long it took if asked.
+  //
+  chpl_init_timeline_report();
 }
 
 
@@ -156,6 +170,8 @@ void chpl_rt_init(int argc, char* argv[]) {
   int runInGDB;
   int runInLLDB;
 
+  chpl_init_timeline_start();
+
   // Check that we can get the page size.
   assert( sys_page_size() > 0 );
 
@@ -173,13 +189,27 @@ void chpl_rt_init(int argc, char* argv[]) {
   //
   parseArgs(false, parse_dash_E, &argc, argv);
 
+  // Fork the spawn helper, if requested, while our heap is small.
+  qio_spawn_helper_start();
+
   chpl_error_init();  // This does local-only initialization
+  chpl_timer_init();
+  chpl_init_timeline_mark(chpl_init_phase_ARGS_ENV);
   chpl_topo_init();
+  chpl_init_timeline_mark(chpl_init_phase_TOPO);
   chpl_comm_init(&argc, &argv);
+  chpl_init_timeline_mark(chpl_init_phase_COMM);
   chpl_mem_init();
+  chpl_init_timeline_mark(chpl_init_phase_MEM);
   chpl_comm_post_mem_init();
+  chpl_mem_array_init();
+#ifdef HAS_GPU_LOCALE
+  chpl_gpu_init();
+#endif
+  chpl_init_timeline_mark(chpl_init_phase_COMM_POST_MEM);
 
   chpl_comm_barrier("about to leave comm init code");
+  chpl_init_timeline_mark(chpl_init_phase_COMM_BARRIER);
 
   CreateConfigVarTable();      // get ready to start tracking config vars
   chpl_gen_main_arg.argv = chpl_malloc(argc * sizeof(char*));
@@ -214,6 +244,8 @@ void chpl_rt_init(int argc, char* argv[]) {
     }
   }
 
+  chpl_init_timeline_mark(chpl_init_phase_ARGS);
+
   //
   // Initialize the task management layer.
   //
@@ -221,22 +253,29 @@ void chpl_rt_init(int argc, char* argv[]) {
 
   // Initialize privatization, needs to happen before hitting module init
   chpl_privatization_init();
+  chpl_init_timeline_mark(chpl_init_phase_TASK);
 
   //
   // Some comm layer initialization has to wait until after the
   // tasking layer is initialized.
   //
   chpl_comm_post_task_init();
+  chpl_comm_remote_alloc_init();
+  chpl_comm_coll_init();
 #ifdef HAS_CHPL_CACHE_FNS
   chpl_cache_init();
 #endif
+  chpl_init_timeline_mark(chpl_init_phase_COMM_POST_TASK);
   chpl_comm_rollcall();
+  chpl_comm_trace_init();
+  chpl_init_timeline_mark(chpl_init_phase_ROLLCALL);
 
   //
   // Make sure the runtime is fully set up on all locales before we start
   // running Chapel code.
   //
   chpl_comm_barrier("barrier before main");
+  chpl_init_timeline_mark(chpl_init_phase_MAIN_BARRIER);
 }
 
 //
@@ -358,3 +397,10 @@ void chpl_library_finalize(void) {
   chpl_deinitModules();
   chpl_rt_finalize(0);
 }
+
+//
+// Only multi-locale libraries batch calls; see chpl-init.h.
+//
+void chpl_library_batch_begin(void) { }
+
+void chpl_library_batch_end(void) { }
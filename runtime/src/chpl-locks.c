@@ -0,0 +1,119 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Lock contention profiling; the locks themselves are in chpl-locks.h.
+//
+
+#include "chplrt.h"
+
+#include "chpl-comm.h"
+#include "chpl-env.h"
+#include "chpl-locks.h"
+#include "chpl-mem-sys.h"
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+struct chpl_lock_prof_site {
+  chpl_lock_prof_site_t* next;
+  const char* name;
+  atomic_uint_least64_t acquires;
+  atomic_uint_least64_t contended;  // acquisitions that had to wait
+  atomic_uint_least64_t spins;      // checks made while waiting
+};
+
+static chpl_lock_prof_site_t* sites;
+static pthread_mutex_t sites_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int prof_enabled = -1;
+
+
+chpl_lock_prof_site_t* chpl_lock_prof_site(const char* name) {
+  chpl_lock_prof_site_t* s;
+
+  if (prof_enabled < 0)
+    prof_enabled = chpl_env_rt_get_bool("LOCK_PROFILE", false) ? 1 : 0;
+  if (!prof_enabled)
+    return NULL;
+
+  pthread_mutex_lock(&sites_lock);
+
+  for (s = sites; s != NULL; s = s->next) {
+    if (strcmp(s->name, name) == 0)
+      break;
+  }
+
+  if (s == NULL) {
+    // Sites live until exit.  Use the system allocator, since locks
+    // may be set up before the memory layer is.
+    s = (chpl_lock_prof_site_t*) sys_calloc(1, sizeof(*s));
+    if (s != NULL) {
+      s->name = name;
+      atomic_init_uint_least64_t(&s->acquires, 0);
+      atomic_init_uint_least64_t(&s->contended, 0);
+      atomic_init_uint_least64_t(&s->spins, 0);
+      s->next = sites;
+      sites = s;
+    }
+  }
+
+  pthread_mutex_unlock(&sites_lock);
+
+  return s;
+}
+
+
+void chpl_lock_prof_record(chpl_lock_prof_site_t* site, uint64_t spins) {
+  atomic_fetch_add_explicit_uint_least64_t(&site->acquires, 1,
+                                           memory_order_relaxed);
+  if (spins > 0) {
+    atomic_fetch_add_explicit_uint_least64_t(&site->contended, 1,
+                                             memory_order_relaxed);
+    atomic_fetch_add_explicit_uint_least64_t(&site->spins, spins,
+                                             memory_order_relaxed);
+  }
+}
+
+
+void chpl_lock_prof_report(void) {
+  chpl_lock_prof_site_t* s;
+
+  if (prof_enabled <= 0)
+    return;
+
+  pthread_mutex_lock(&sites_lock);
+
+  for (s = sites; s != NULL; s = s->next) {
+    uint64_t acquires = atomic_load_uint_least64_t(&s->acquires);
+    uint64_t contended = atomic_load_uint_least64_t(&s->contended);
+    uint64_t spins = atomic_load_uint_least64_t(&s->spins);
+
+    fprintf(stderr,
+            "%d: lock %s: %" PRIu64 " acquires, %" PRIu64 " contended, "
+            "%" PRIu64 " spins (%.1f per contended)\n",
+            (int) chpl_nodeID, s->name, acquires, contended, spins,
+            contended ? (double) spins / contended : 0.0);
+  }
+
+  pthread_mutex_unlock(&sites_lock);
+}
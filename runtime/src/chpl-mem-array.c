@@ -0,0 +1,343 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Large-array allocation.  See chpl-mem-array.h.
+//
+#ifdef __linux__
+#define _GNU_SOURCE                     // for mremap()
+#endif
+#include "chplrt.h"
+
+#include "chpl-comm.h"
+#include "chpl-env.h"
+#include "chpl-env-gen.h"
+#include "chpl-mem-array.h"
+#include "chpl-topo.h"
+#include "chplsys.h"
+#include "error.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#define LARGE_ARRAY_ALIGN ((size_t) 2 << 20)   // 2 MiB, the usual hugepage
+
+size_t chpl_mem_array_large_threshold = SIZE_MAX;
+
+typedef enum {
+  hugepages_none,                       // plain pages
+  hugepages_thp,                        // madvise(MADV_HUGEPAGE)
+  hugepages_explicit,                   // mmap(MAP_HUGETLB)
+} hugepages_mode_t;
+
+static hugepages_mode_t hugepages_mode;
+static chpl_bool numa_spread;
+
+//
+// Every large array is on this list, so that free and realloc can tell
+// large arrays from those that came from the memory layer.  There are
+// never many of them.
+//
+typedef struct large_array {
+  struct large_array* next;
+  void* base;                           // as mapped
+  size_t len;                           // accessible
+  size_t reserved;                      // as mapped, len + PROT_NONE tail
+  c_sublocid_t subloc;
+} large_array_t;
+
+static large_array_t* large_arrays;
+static pthread_mutex_t large_arrays_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+void chpl_mem_array_init(void) {
+  const char* ev;
+  void* heapStart;
+  size_t heapSize;
+
+  //
+  // Large arrays are mapped separately, so they can't be used when the
+  // comm layer needs all memory to be in its registered heap.
+  //
+  chpl_comm_regMemHeapInfo(&heapStart, &heapSize);
+  if (heapStart != NULL) {
+    return;
+  }
+
+  if ((ev = chpl_env_rt_get("MEM_ARRAY_HUGEPAGES", NULL)) == NULL
+      || strcmp(ev, "thp") == 0) {
+    hugepages_mode = hugepages_thp;
+  } else if (strcmp(ev, "explicit") == 0) {
+    hugepages_mode = hugepages_explicit;
+  } else if (strcmp(ev, "none") == 0) {
+    hugepages_mode = hugepages_none;
+  } else {
+    char msg[100];
+    snprintf(msg, sizeof(msg),
+             "CHPL_RT_MEM_ARRAY_HUGEPAGES=%s unknown; using \"thp\"", ev);
+    chpl_warning(msg, 0, 0);
+    hugepages_mode = hugepages_thp;
+  }
+
+  numa_spread = chpl_env_rt_get_bool("MEM_ARRAY_NUMA_SPREAD",
+                                     strcmp(CHPL_LOCALE_MODEL, "flat") != 0);
+
+  chpl_mem_array_large_threshold =
+    (size_t) chpl_env_rt_get_int("MEM_ARRAY_LARGE_THRESHOLD",
+                                 (int64_t) 64 << 20);
+  if (chpl_mem_array_large_threshold < LARGE_ARRAY_ALIGN)
+    chpl_mem_array_large_threshold = LARGE_ARRAY_ALIGN;
+}
+
+
+static inline
+size_t large_len(size_t size) {
+  return (size + LARGE_ARRAY_ALIGN - 1) & ~(LARGE_ARRAY_ALIGN - 1);
+}
+
+
+//
+// Map an aligned region of *preserved bytes, with only the first len
+// of them accessible.  Explicit hugepages can't be reserved without
+// being committed, so those get no reservation (*preserved == len).
+//
+static
+void* map_large(size_t len, size_t* preserved) {
+  size_t reserved = *preserved;
+  void* p;
+
+  if (hugepages_mode == hugepages_explicit) {
+#ifdef MAP_HUGETLB
+    p = mmap(NULL, len, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED) {
+      *preserved = len;
+      return p;
+    }
+#endif
+    // no hugepages to be had; fall back to transparent ones
+  }
+
+  //
+  // Over-map by the alignment so we can trim to an aligned start.
+  //
+  {
+    unsigned char* raw;
+    unsigned char* aligned;
+    size_t head, tail;
+
+    raw = mmap(NULL, reserved + LARGE_ARRAY_ALIGN, PROT_NONE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (raw == MAP_FAILED)
+      return NULL;
+
+    aligned = (unsigned char*) (((uintptr_t) raw + LARGE_ARRAY_ALIGN - 1)
+                                & ~(uintptr_t) (LARGE_ARRAY_ALIGN - 1));
+    head = aligned - raw;
+    tail = LARGE_ARRAY_ALIGN - head;
+    if (head > 0)
+      (void) munmap(raw, head);
+    if (tail > 0)
+      (void) munmap(aligned + reserved, tail);
+    if (mprotect(aligned, len, PROT_READ | PROT_WRITE) != 0) {
+      (void) munmap(aligned, reserved);
+      return NULL;
+    }
+    p = aligned;
+  }
+
+#ifdef MADV_HUGEPAGE
+  if (hugepages_mode != hugepages_none)
+    (void) madvise(p, len, MADV_HUGEPAGE);
+#endif
+
+  return p;
+}
+
+
+//
+// Set the NUMA policy for [p, p+len); the pages themselves are placed
+// when our caller first touches them, typically in parallel.
+//
+static
+void set_large_locality(void* p, size_t len, c_sublocid_t subloc) {
+  if (isActualSublocID(subloc)) {
+    chpl_topo_setMemLocality(p, len, true, subloc);
+  } else if (numa_spread && chpl_topo_getNumNumaDomains() > 1) {
+    chpl_topo_setMemSubchunkLocality(p, len, true, NULL);
+  }
+}
+
+
+void* chpl_mem_array_large_alloc(size_t size, size_t reserveSize,
+                                 c_sublocid_t subloc) {
+  size_t len = large_len(size);
+  size_t reserved = large_len((reserveSize > size) ? reserveSize : size);
+  large_array_t* la;
+  void* p;
+
+  if ((la = chpl_malloc(sizeof(*la))) == NULL)
+    return NULL;
+
+  if ((p = map_large(len, &reserved)) == NULL) {
+    chpl_free(la);
+    return NULL;
+  }
+
+  set_large_locality(p, len, subloc);
+
+  la->base = p;
+  la->len = len;
+  la->reserved = reserved;
+  la->subloc = subloc;
+  pthread_mutex_lock(&large_arrays_lock);
+  la->next = large_arrays;
+  large_arrays = la;
+  pthread_mutex_unlock(&large_arrays_lock);
+
+  return p;
+}
+
+
+static
+large_array_t* find_large(void* p, chpl_bool unlink) {
+  large_array_t** pla;
+  large_array_t* la;
+
+  pthread_mutex_lock(&large_arrays_lock);
+  for (pla = &large_arrays; (la = *pla) != NULL; pla = &la->next) {
+    if (la->base == p) {
+      if (unlink)
+        *pla = la->next;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&large_arrays_lock);
+
+  return la;
+}
+
+
+chpl_bool chpl_mem_array_is_large(void* p) {
+  return large_arrays != NULL && p != NULL && find_large(p, false) != NULL;
+}
+
+
+chpl_bool chpl_mem_array_large_free(void* p) {
+  large_array_t* la;
+
+  if (large_arrays == NULL || p == NULL
+      || (la = find_large(p, true)) == NULL) {
+    return false;
+  }
+
+  (void) munmap(la->base, la->reserved);
+  chpl_free(la);
+  return true;
+}
+
+
+//
+// Resize a large array without copying it.  Shrinking and growing
+// within the reservation just change protections.  Growing past it
+// moves the pages, not their contents, with mremap() onto a fresh
+// aligned reservation.  The array stays on the list throughout, so
+// we hold the list lock to keep its entry stable.
+//
+void* chpl_mem_array_large_realloc(void* p, size_t newSize) {
+  size_t newLen = large_len(newSize);
+  large_array_t* la;
+  unsigned char* base;
+  void* newp = NULL;
+
+  if (large_arrays == NULL || p == NULL)
+    return NULL;
+
+  pthread_mutex_lock(&large_arrays_lock);
+  for (la = large_arrays; la != NULL && la->base != p; la = la->next)
+    ;
+  if (la == NULL) {
+    pthread_mutex_unlock(&large_arrays_lock);
+    return NULL;
+  }
+
+  base = la->base;
+  if (newLen == la->len) {
+    newp = base;
+  } else if (newLen < la->len) {
+    //
+    // Give back the tail's pages but keep the address space, so that
+    // growing again is cheap.
+    //
+    if (mprotect(base + newLen, la->len - newLen, PROT_NONE) == 0) {
+      (void) madvise(base + newLen, la->len - newLen, MADV_DONTNEED);
+      la->len = newLen;
+      newp = base;
+    }
+  } else if (newLen <= la->reserved) {
+    if (mprotect(base + la->len, newLen - la->len,
+                 PROT_READ | PROT_WRITE) == 0) {
+#ifdef MADV_HUGEPAGE
+      if (hugepages_mode != hugepages_none)
+        (void) madvise(base + la->len, newLen - la->len, MADV_HUGEPAGE);
+#endif
+      set_large_locality(base + la->len, newLen - la->len, la->subloc);
+      la->len = newLen;
+      newp = base;
+    }
+  } else {
+#if defined(__linux__) && defined(MREMAP_FIXED)
+    //
+    // Map an aligned, inaccessible target and move the pages onto it.
+    //
+    size_t reserved = newLen;
+    void* target;
+
+    if ((target = map_large(0, &reserved)) != NULL) {
+      newp = mremap(base, la->len, newLen, MREMAP_MAYMOVE | MREMAP_FIXED,
+                    target);
+      if (newp == MAP_FAILED) {
+        (void) munmap(target, reserved);
+        newp = NULL;
+      } else if (la->reserved > la->len) {
+        // what's left of the old mapping is just its reservation
+        (void) munmap(base + la->len, la->reserved - la->len);
+      }
+    }
+    if (newp != NULL) {
+      unsigned char* tail = (unsigned char*) newp + la->len;
+#ifdef MADV_HUGEPAGE
+      if (hugepages_mode != hugepages_none)
+        (void) madvise(tail, newLen - la->len, MADV_HUGEPAGE);
+#endif
+      set_large_locality(tail, newLen - la->len, la->subloc);
+      la->base = newp;
+      la->len = newLen;
+      la->reserved = newLen;
+    }
+#endif
+  }
+
+  pthread_mutex_unlock(&large_arrays_lock);
+  return newp;
+}
@@ -32,6 +32,9 @@
 #include <stdint.h>
 
 
+void (*chpl_memhook_free_notify)(void*) = NULL;
+
+
 void chpl_memhook_check_pre(size_t number, size_t size,
                             chpl_mem_descInt_t description,
                             int32_t lineno, int32_t filename) {
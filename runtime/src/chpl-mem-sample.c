@@ -0,0 +1,447 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Sampling heap profiler.  See chpl-mem-sample.h.
+//
+#include "chplrt.h"
+
+#include "chpl-atomics.h"
+#include "chpl-comm.h"
+#include "chpl-env.h"
+#include "chpl-mem-sample.h"
+#include "chpl-mem-sys.h"
+#include "chplmemtrack.h"
+#include "error.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef CHPL_DO_UNWIND
+#define UNW_LOCAL_ONLY
+#include <libunwind.h>
+#elif defined(__GLIBC__)
+#include <execinfo.h>
+#endif
+
+#define MAX_FRAMES 32
+
+size_t chpl_mem_sample_interval;
+
+//
+// The call stacks samples were taken at, with their totals.  Each
+// thread has its own table of these, which only it adds to.  The
+// in-use counts are also decremented by whatever thread frees a
+// sampled allocation, so they're atomic.
+//
+typedef struct sample_stack {
+  struct sample_stack* next;
+  uint64_t hash;
+  chpl_mem_descInt_t desc;
+  int num_frames;
+  void* frames[MAX_FRAMES];
+  int64_t alloc_objs;
+  int64_t alloc_bytes;
+  atomic_int_least64_t inuse_objs;
+  atomic_int_least64_t inuse_bytes;
+} sample_stack_t;
+
+#define STACK_BUCKETS 256
+
+typedef struct sample_thread {
+  struct sample_thread* next;
+  int64_t countdown;                    // used when there's no CHPL_TLS
+  uint64_t rng;
+  int started;
+  int busy;                             // guards against recursion
+  sample_stack_t* stacks[STACK_BUCKETS];
+} sample_thread_t;
+
+static sample_thread_t* sample_threads;
+static pthread_mutex_t sample_threads_lock = PTHREAD_MUTEX_INITIALIZER;
+
+#ifdef CHPL_TLS
+CHPL_TLS int64_t chpl_mem_sample_countdown;
+static CHPL_TLS sample_thread_t* my_sample_thread;
+#else
+static pthread_key_t my_sample_thread_key;
+static pthread_once_t my_sample_thread_key_once = PTHREAD_ONCE_INIT;
+#endif
+
+//
+// Live sampled allocations, by address.  A slot is claimed by CASing
+// its address from 0, and released by storing 0 after the rest has
+// been cleared.  A free only has to look in the one bucket its address
+// hashes to.  If a bucket is full the sample is just not kept.
+//
+typedef struct {
+  atomic_uintptr_t ptr;
+  sample_stack_t* stack;
+  size_t size;
+} sample_slot_t;
+
+#define SLOTS_PER_BUCKET 8
+#define LG_SAMPLE_BUCKETS 15
+
+static sample_slot_t* sample_slots;
+static atomic_uint_least64_t samples_dropped;
+
+static pthread_mutex_t sample_print_lock = PTHREAD_MUTEX_INITIALIZER;
+static volatile sig_atomic_t sample_print_requested;
+
+
+static inline
+sample_slot_t* bucket_for(void* p) {
+  uint64_t h = ((uint64_t) (uintptr_t) p >> 4) * 0x9e3779b97f4a7c15ULL;
+  return &sample_slots[(h >> (64 - LG_SAMPLE_BUCKETS)) * SLOTS_PER_BUCKET];
+}
+
+
+static
+void sample_signal_handler(int sig) {
+  sample_print_requested = 1;
+}
+
+
+#ifndef CHPL_TLS
+static
+void make_my_sample_thread_key(void) {
+  if (pthread_key_create(&my_sample_thread_key, NULL) != 0) {
+    chpl_internal_error("pthread_key_create(&my_sample_thread_key) failed");
+  }
+}
+#endif
+
+
+static
+sample_thread_t* get_my_sample_thread(void) {
+  sample_thread_t* st;
+
+#ifdef CHPL_TLS
+  st = my_sample_thread;
+#else
+  if (pthread_once(&my_sample_thread_key_once,
+                   make_my_sample_thread_key) != 0) {
+    chpl_internal_error("pthread_once(&my_sample_thread_key_once) failed");
+  }
+  st = (sample_thread_t*) pthread_getspecific(my_sample_thread_key);
+#endif
+
+  if (st == NULL) {
+    //
+    // This uses the system allocator, so it doesn't come back here.
+    //
+    if ((st = sys_calloc(1, sizeof(*st))) == NULL)
+      return NULL;
+    st->rng = ((uint64_t) (uintptr_t) st) ^ (uint64_t) time(NULL)
+              ^ 0x2545f4914f6cdd1dULL;
+
+    pthread_mutex_lock(&sample_threads_lock);
+    st->next = sample_threads;
+    sample_threads = st;
+    pthread_mutex_unlock(&sample_threads_lock);
+
+#ifdef CHPL_TLS
+    my_sample_thread = st;
+#else
+    (void) pthread_setspecific(my_sample_thread_key, st);
+#endif
+  }
+
+  return st;
+}
+
+
+//
+// Bytes until the next sample: exponentially distributed with a mean
+// of the sampling interval, so that samples don't lock step with
+// regular allocation patterns.
+//
+static
+int64_t next_countdown(sample_thread_t* st) {
+  double u;
+
+  st->rng ^= st->rng << 13;
+  st->rng ^= st->rng >> 7;
+  st->rng ^= st->rng << 17;
+  u = ((st->rng >> 11) + 1) * (1.0 / 9007199254740992.0);  // (0, 1]
+  return (int64_t) (-log(u) * (double) chpl_mem_sample_interval) + 1;
+}
+
+
+static
+int capture_frames(void** frames, int max) {
+#ifdef CHPL_DO_UNWIND
+  return unw_backtrace(frames, max);
+#elif defined(__GLIBC__)
+  return backtrace(frames, max);
+#else
+  frames[0] = __builtin_return_address(0);
+  return 1;
+#endif
+}
+
+
+static
+sample_stack_t* find_stack(sample_thread_t* st, chpl_mem_descInt_t desc,
+                           void** frames, int num_frames) {
+  uint64_t h = 0xcbf29ce484222325ULL ^ (uint64_t) desc;
+  sample_stack_t* ss;
+  int b;
+
+  for (int i = 0; i < num_frames; i++)
+    h = (h ^ (uint64_t) (uintptr_t) frames[i]) * 0x100000001b3ULL;
+
+  b = h % STACK_BUCKETS;
+  for (ss = st->stacks[b]; ss != NULL; ss = ss->next) {
+    if (ss->hash == h && ss->desc == desc && ss->num_frames == num_frames
+        && memcmp(ss->frames, frames, num_frames * sizeof(frames[0])) == 0)
+      return ss;
+  }
+
+  if ((ss = sys_calloc(1, sizeof(*ss))) == NULL)
+    return NULL;
+  ss->hash = h;
+  ss->desc = desc;
+  ss->num_frames = num_frames;
+  memcpy(ss->frames, frames, num_frames * sizeof(frames[0]));
+  atomic_init_int_least64_t(&ss->inuse_objs, 0);
+  atomic_init_int_least64_t(&ss->inuse_bytes, 0);
+
+  // fill in first, then publish, so printing never sees a partial one
+  ss->next = st->stacks[b];
+  chpl_atomic_thread_fence(memory_order_release);
+  st->stacks[b] = ss;
+
+  return ss;
+}
+
+
+void chpl_mem_sample_init(void) {
+  int sig;
+
+  chpl_mem_sample_interval = chpl_env_rt_get_size("MEM_SAMPLE_INTERVAL", 0);
+  if (chpl_mem_sample_interval == 0)
+    return;
+
+  sample_slots = sys_calloc((size_t) SLOTS_PER_BUCKET << LG_SAMPLE_BUCKETS,
+                            sizeof(sample_slots[0]));
+  if (sample_slots == NULL) {
+    chpl_warning("cannot allocate the memory sample table; not sampling",
+                 0, 0);
+    chpl_mem_sample_interval = 0;
+    return;
+  }
+  atomic_init_uint_least64_t(&samples_dropped, 0);
+
+  //
+  // Capture a stack trace now, since the first one may allocate.
+  //
+  {
+    void* frames[MAX_FRAMES];
+    (void) capture_frames(frames, MAX_FRAMES);
+  }
+
+  sig = (int) chpl_env_rt_get_int("MEM_SAMPLE_SIGNAL", SIGUSR2);
+  if (sig > 0) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = sample_signal_handler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    if (sigaction(sig, &sa, NULL) != 0) {
+      chpl_warning("cannot install the memory sample signal handler", 0, 0);
+    }
+  }
+}
+
+
+void chpl_mem_sample_take(void* p, size_t size, chpl_mem_descInt_t desc) {
+  sample_thread_t* st;
+  void* frames[MAX_FRAMES];
+  int num_frames;
+  sample_stack_t* ss;
+
+  if ((st = get_my_sample_thread()) == NULL || st->busy)
+    return;
+
+#ifndef CHPL_TLS
+  if ((st->countdown -= (int64_t) size) >= 0)
+    return;
+#endif
+
+  st->busy = 1;
+
+  if (sample_print_requested) {
+    sample_print_requested = 0;
+    chpl_printMemAllocsByDesc("", 0, 0, 0);
+  }
+
+  //
+  // A new thread's countdown starts at 0, so its first allocation
+  // comes here just to start it counting.
+  //
+  if (!st->started) {
+    st->started = 1;
+  } else if ((num_frames = capture_frames(frames, MAX_FRAMES)) > 0
+             && (ss = find_stack(st, desc, frames, num_frames)) != NULL) {
+    sample_slot_t* bucket = bucket_for(p);
+    int i;
+
+    ss->alloc_objs++;
+    ss->alloc_bytes += size;
+
+    for (i = 0; i < SLOTS_PER_BUCKET; i++) {
+      uintptr_t expected = 0;
+      if (atomic_compare_exchange_strong_uintptr_t(&bucket[i].ptr, &expected,
+                                                   (uintptr_t) p)) {
+        bucket[i].stack = ss;
+        bucket[i].size = size;
+        (void) atomic_fetch_add_int_least64_t(&ss->inuse_objs, 1);
+        (void) atomic_fetch_add_int_least64_t(&ss->inuse_bytes, size);
+        break;
+      }
+    }
+    if (i == SLOTS_PER_BUCKET)
+      (void) atomic_fetch_add_uint_least64_t(&samples_dropped, 1);
+  }
+
+#ifdef CHPL_TLS
+  chpl_mem_sample_countdown = next_countdown(st);
+#else
+  st->countdown = next_countdown(st);
+#endif
+
+  st->busy = 0;
+}
+
+
+void chpl_mem_sample_free(void* p) {
+  sample_slot_t* bucket = bucket_for(p);
+
+  for (int i = 0; i < SLOTS_PER_BUCKET; i++) {
+    if (atomic_load_explicit_uintptr_t(&bucket[i].ptr, memory_order_acquire)
+        == (uintptr_t) p) {
+      //
+      // Only the one freeing p can match it, so the slot is ours.
+      //
+      sample_stack_t* ss = bucket[i].stack;
+      size_t size = bucket[i].size;
+      bucket[i].stack = NULL;
+      atomic_store_explicit_uintptr_t(&bucket[i].ptr, 0,
+                                      memory_order_release);
+      (void) atomic_fetch_add_int_least64_t(&ss->inuse_objs, -1);
+      (void) atomic_fetch_add_int_least64_t(&ss->inuse_bytes,
+                                            -(int64_t) size);
+      return;
+    }
+  }
+}
+
+
+static
+chpl_bool stack_selected(sample_stack_t* ss, chpl_mem_descInt_t desc,
+                         int64_t threshold) {
+  return ((desc == -1 || ss->desc == desc)
+          && atomic_load_int_least64_t(&ss->inuse_bytes) >= threshold);
+}
+
+
+//
+// Print the samples in the legacy pprof heap profile format, in the
+// heap_v2 flavor that tells pprof the sampling interval, so it can
+// scale the sampled counts back up.  The memory map lets pprof
+// symbolize the addresses.
+//
+void chpl_mem_sample_print(FILE* f, chpl_mem_descInt_t desc,
+                           int64_t threshold) {
+  int64_t tot[4] = { 0, 0, 0, 0 };
+  sample_thread_t* st;
+  sample_stack_t* ss;
+  FILE* maps;
+
+  if (chpl_mem_sample_interval == 0)
+    return;
+
+  pthread_mutex_lock(&sample_print_lock);
+
+  pthread_mutex_lock(&sample_threads_lock);
+  st = sample_threads;
+  pthread_mutex_unlock(&sample_threads_lock);
+
+  for (sample_thread_t* t = st; t != NULL; t = t->next) {
+    for (int b = 0; b < STACK_BUCKETS; b++) {
+      for (ss = t->stacks[b]; ss != NULL; ss = ss->next) {
+        if (stack_selected(ss, desc, threshold)) {
+          tot[0] += atomic_load_int_least64_t(&ss->inuse_objs);
+          tot[1] += atomic_load_int_least64_t(&ss->inuse_bytes);
+          tot[2] += ss->alloc_objs;
+          tot[3] += ss->alloc_bytes;
+        }
+      }
+    }
+  }
+
+  fprintf(f, "heap profile: %" PRId64 ": %" PRId64 " [ %" PRId64 ": %"
+          PRId64 "] @ heap_v2/%zu\n",
+          tot[0], tot[1], tot[2], tot[3], chpl_mem_sample_interval);
+
+  for (sample_thread_t* t = st; t != NULL; t = t->next) {
+    for (int b = 0; b < STACK_BUCKETS; b++) {
+      for (ss = t->stacks[b]; ss != NULL; ss = ss->next) {
+        if (!stack_selected(ss, desc, threshold))
+          continue;
+        fprintf(f, "%" PRId64 ": %" PRId64 " [%" PRId64 ": %" PRId64 "] @",
+                atomic_load_int_least64_t(&ss->inuse_objs),
+                atomic_load_int_least64_t(&ss->inuse_bytes),
+                ss->alloc_objs, ss->alloc_bytes);
+        for (int i = 0; i < ss->num_frames; i++)
+          fprintf(f, " %p", ss->frames[i]);
+        fprintf(f, "\n");
+      }
+    }
+  }
+
+  fprintf(f, "\nMAPPED_LIBRARIES:\n");
+  if ((maps = fopen("/proc/self/maps", "r")) != NULL) {
+    char buf[512];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), maps)) > 0)
+      (void) fwrite(buf, 1, n, f);
+    fclose(maps);
+  }
+  fflush(f);
+
+  if (atomic_load_uint_least64_t(&samples_dropped) > 0) {
+    char msg[100];
+    snprintf(msg, sizeof(msg),
+             "memory sampling dropped %" PRIu64 " samples (table full)",
+             atomic_load_uint_least64_t(&samples_dropped));
+    chpl_warning(msg, 0, 0);
+  }
+
+  pthread_mutex_unlock(&sample_print_lock);
+}
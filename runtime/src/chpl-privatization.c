@@ -22,72 +22,77 @@
 #include "chpl-privatization.h"
 #include "chpl-mem.h"
 #include "chpl-atomics.h"
+#include "error.h"
 
-static int64_t chpl_capPrivateObjects = 0;
-static atomic_spinlock_t lock;
-
-chpl_privateObject_t* chpl_privateObjects = NULL;
+atomic_uintptr_t chpl_privateObjects[CHPL_PRIVATE_OBJECTS_MAX_CHUNKS];
 
 void chpl_privatization_init(void) {
-  atomic_init_spinlock_t(&lock);
-}
-
-static inline int64_t max(int64_t a, int64_t b) {
-  return a > b ? a : b;
+  for (int i = 0; i < CHPL_PRIVATE_OBJECTS_MAX_CHUNKS; i++) {
+    atomic_init_uintptr_t(&chpl_privateObjects[i], (uintptr_t) NULL);
+  }
 }
 
-// Note that this function can be called in parallel and more notably it can be
-// called with non-monotonic pid's. e.g. this may be called with pid 27, and
-// then pid 2, so it has to ensure that the privatized array has at least pid+1
-// elements. Be __very__ careful if you have to update it.
-void chpl_newPrivatizedClass(void* v, int64_t pid) {
-  atomic_lock_spinlock_t(&lock);
+//
+// Return the chunk holding the given pid, allocating it if needed.
+// If several tasks race to allocate the same chunk, one wins the CAS
+// and the rest free their copies.  Those were never visible to anyone
+// else, so this is the only reclamation we ever need to do.
+//
+static chpl_privateObject_t* get_chunk(int64_t pid) {
+  int64_t ci = pid >> CHPL_PRIVATE_OBJECTS_CHUNK_BITS;
+  uintptr_t chunk;
+  uintptr_t newChunk;
 
-  // initialize array to a default size
-  if (chpl_privateObjects == NULL) {
-    chpl_capPrivateObjects = 2*max(pid, 4);
-    chpl_privateObjects =
-        chpl_mem_allocManyZero(chpl_capPrivateObjects,
-                               sizeof(chpl_privateObject_t),
-                               CHPL_RT_MD_COMM_PRV_OBJ_ARRAY, 0, 0);
-  } else {
-    // if we're out of space, double (or more) the array size
-    if (pid >= chpl_capPrivateObjects) {
-      chpl_privateObject_t* tmp;
-      int64_t oldCap;
+  if (pid < 0 || ci >= CHPL_PRIVATE_OBJECTS_MAX_CHUNKS) {
+    chpl_internal_error("privatized object id out of range");
+  }
 
-      oldCap = chpl_capPrivateObjects;
-      chpl_capPrivateObjects = 2*max(pid, oldCap);
+  chunk = atomic_load_explicit_uintptr_t(&chpl_privateObjects[ci],
+                                         memory_order_acquire);
+  if (chunk != (uintptr_t) NULL) {
+    return (chpl_privateObject_t*) chunk;
+  }
 
-      tmp = chpl_mem_allocManyZero(chpl_capPrivateObjects,
-                                   sizeof(chpl_privateObject_t),
-                                   CHPL_RT_MD_COMM_PRV_OBJ_ARRAY, 0, 0);
-      chpl_memcpy((void*)tmp, (void*)chpl_privateObjects,
-                  (oldCap)*sizeof(chpl_privateObject_t));
-      chpl_privateObjects = tmp;
-      // purposely leak old copies of chpl_privateObject to avoid the need to
-      // lock chpl_getPrivatizedClass; TODO: fix with lock free data structure
-    }
+  newChunk = (uintptr_t)
+    chpl_mem_allocManyZero(CHPL_PRIVATE_OBJECTS_CHUNK_SIZE,
+                           sizeof(chpl_privateObject_t),
+                           CHPL_RT_MD_COMM_PRV_OBJ_ARRAY, 0, 0);
+  if (atomic_compare_exchange_strong_explicit_uintptr_t(
+        &chpl_privateObjects[ci], &chunk, newChunk,
+        memory_order_acq_rel, memory_order_acquire)) {
+    return (chpl_privateObject_t*) newChunk;
   }
-  chpl_privateObjects[pid].obj = v;
 
-  atomic_unlock_spinlock_t(&lock);
+  chpl_mem_free((void*) newChunk, 0, 0);
+  return (chpl_privateObject_t*) chunk;
+}
+
+// Note that this function can be called in parallel and more notably it can be
+// called with non-monotonic pid's. e.g. this may be called with pid 27, and
+// then pid 2, so it has to ensure that the chunk holding pid exists.
+void chpl_newPrivatizedClass(void* v, int64_t pid) {
+  chpl_privateObject_t* chunk = get_chunk(pid);
+  chunk[pid & (CHPL_PRIVATE_OBJECTS_CHUNK_SIZE - 1)].obj = v;
 }
 
 void chpl_clearPrivatizedClass(int64_t i) {
-  atomic_lock_spinlock_t(&lock);
-  chpl_privateObjects[i].obj = NULL;
-  atomic_unlock_spinlock_t(&lock);
+  chpl_privateObject_t* chunk = get_chunk(i);
+  chunk[i & (CHPL_PRIVATE_OBJECTS_CHUNK_SIZE - 1)].obj = NULL;
 }
 
 // Used to check for leaks of privatized classes
 int64_t chpl_numPrivatizedClasses(void) {
   int64_t ret = 0;
-  atomic_lock_spinlock_t(&lock);
-  for (int64_t i = 0; i < chpl_capPrivateObjects; i++) {
-    if (chpl_privateObjects[i].obj)
-      ret++;
+  for (int ci = 0; ci < CHPL_PRIVATE_OBJECTS_MAX_CHUNKS; ci++) {
+    chpl_privateObject_t* chunk = (chpl_privateObject_t*)
+      atomic_load_explicit_uintptr_t(&chpl_privateObjects[ci],
+                                     memory_order_acquire);
+    if (chunk == NULL)
+      continue;
+    for (int i = 0; i < CHPL_PRIVATE_OBJECTS_CHUNK_SIZE; i++) {
+      if (chunk[i].obj)
+        ret++;
+    }
   }
-  atomic_unlock_spinlock_t(&lock);
   return ret;
 }
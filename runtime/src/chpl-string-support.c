@@ -33,6 +33,7 @@
  *
  */
 #include <stdarg.h>
+#include <pthread.h>
 #include "chplrt.h"
 #include "sys_basic.h"
 #include "chpl-mem.h"
@@ -78,38 +79,56 @@ c_string chpl_format(c_string format, ...) {
 }
 
 
+// Returns buf if a result of len bytes (plus the NUL) fits in it, and
+// otherwise newly-allocated memory.
+static char*
+string_result(char* buf, size_t bufsize, size_t len, chpl_mem_descInt_t desc,
+              int32_t lineno, int32_t filename) {
+  if (len < bufsize)
+    return buf;
+  return (char*)chpl_mem_allocMany(1, len + 1, desc, lineno, filename);
+}
+
 c_string
-string_copy(c_string x, int32_t lineno, int32_t filename)
+string_copy_buf(char* buf, size_t bufsize, c_string x,
+                int32_t lineno, int32_t filename)
 {
   char *z;
+  size_t len;
 
   // If the input string is null, just return null.
   if (x == NULL)
     return NULL;
 
-  z = (char*)chpl_mem_allocMany(1, strlen(x)+1, CHPL_RT_MD_STR_COPY_DATA,
-                                lineno, filename);
-  return strcpy(z, x);
+  len = strlen(x);
+  z = string_result(buf, bufsize, len, CHPL_RT_MD_STR_COPY_DATA,
+                    lineno, filename);
+  return memcpy(z, x, len + 1);
 }
 
-// string_concat always returns a newly-allocated c_string (or NULL).
 c_string
-string_concat(c_string x, c_string y, int32_t lineno, int32_t filename) {
+string_copy(c_string x, int32_t lineno, int32_t filename)
+{
+  return string_copy_buf(NULL, 0, x, lineno, filename);
+}
+
+c_string
+string_concat_buf(char* buf, size_t bufsize, c_string x, c_string y,
+                  int32_t lineno, int32_t filename) {
   char* z;
   size_t xlen;
   size_t ylen;
 
   if (x == NULL)
-    return string_copy(y, lineno, filename);
+    return string_copy_buf(buf, bufsize, y, lineno, filename);
   if (y == NULL)
-    return string_copy(x, lineno, filename);
+    return string_copy_buf(buf, bufsize, x, lineno, filename);
 
   xlen = strlen(x);
   ylen = strlen(y);
 
-  z = (char*)chpl_mem_allocMany(1, xlen + ylen + 1,
-                                CHPL_RT_MD_STR_CONCAT_DATA,
-                                lineno, filename);
+  z = string_result(buf, bufsize, xlen + ylen, CHPL_RT_MD_STR_CONCAT_DATA,
+                    lineno, filename);
 
   // memcpy can be more efficient than the str??? functions because it does not
   // look for terminating NUL characters.  We are guaranteed that the source
@@ -122,19 +141,30 @@ string_concat(c_string x, c_string y, int32_t lineno, int32_t filename) {
   return z;
 }
 
+// string_concat always returns a newly-allocated c_string (or NULL).
+c_string
+string_concat(c_string x, c_string y, int32_t lineno, int32_t filename) {
+  return string_concat_buf(NULL, 0, x, y, lineno, filename);
+}
+
 // Returns the index of the first occurrence of a substring within a string, or
 // 0 if the substring is not in the string.
+//
+// strstr() is left to the C library: glibc and the BSD libcs implement it
+// with the two-way algorithm plus vectorized scans chosen for the CPU at
+// load time, which beats anything we could reasonably do here.
 int string_index_of(c_string haystack, c_string needle) {
   c_string substring = strstr(haystack, needle);
   return substring ? (int) (substring-haystack)+1 : 0;
 }
 
-// Returns a newly-allocated string containing (a copy of) the bytes selected
-// from the original string.
+// Returns a string containing (a copy of) the bytes selected from the
+// original string, in buf if it fits there and otherwise newly-allocated.
 // It is up to the caller to make sure low and high are within the string
 // bounds and that stride is not 0.
 c_string
-string_select(c_string x, int low, int high, int stride, int32_t lineno, int32_t filename) {
+string_select_buf(char* buf, size_t bufsize, c_string x, int low, int high,
+                  int stride, int32_t lineno, int32_t filename) {
   char* result = NULL;
   char* dst = NULL;
   int size;
@@ -144,8 +174,8 @@ string_select(c_string x, int low, int high, int stride, int32_t lineno, int32_t
   if (high < low) return NULL;
 
   size = high - low + 1;
-  result = chpl_mem_allocMany(1, size + 1, CHPL_RT_MD_STR_SELECT_DATA,
-                              lineno, filename);
+  result = string_result(buf, bufsize, size, CHPL_RT_MD_STR_SELECT_DATA,
+                         lineno, filename);
   src = stride > 0 ? x + low - 1 : x + high - 1;
   dst = result;
   if (stride == 1) {
@@ -167,6 +197,19 @@ string_select(c_string x, int low, int high, int stride, int32_t lineno, int32_t
   return result;
 }
 
+// Returns a newly-allocated string containing (a copy of) the bytes selected
+// from the original string.
+c_string
+string_select(c_string x, int low, int high, int stride, int32_t lineno, int32_t filename) {
+  return string_select_buf(NULL, 0, x, low, high, stride, lineno, filename);
+}
+
+void
+string_free_buf(const char* buf, c_string x, int32_t lineno, int32_t filename) {
+  if (x != NULL && x != buf)
+    chpl_mem_free((void*) x, lineno, filename);
+}
+
 // Returns a string containing the character at the given index of the input
 // string, or an empty string if the index is out of bounds.
 c_string
@@ -192,3 +235,109 @@ string_contains(c_string x, c_string y) {
 }
 
 
+
+
+//
+// The interned string table.  This is a chained hash table that doubles
+// its bucket count when it holds more strings than buckets.  Entries are
+// allocated with their string inline and are never freed.
+//
+typedef struct string_intern_entry_s {
+  struct string_intern_entry_s* next;
+  uint64_t hash;
+  size_t len;
+  char str[];
+} string_intern_entry_t;
+
+#define STRING_INTERN_MIN_BUCKETS 64
+
+static pthread_mutex_t string_intern_lock = PTHREAD_MUTEX_INITIALIZER;
+static string_intern_entry_t** string_intern_buckets = NULL;
+static size_t string_intern_nbuckets = 0;
+static size_t string_intern_count = 0;
+
+// 64-bit FNV-1a
+static uint64_t string_intern_hash(const char* x, size_t len) {
+  uint64_t h = 14695981039346656037ULL;
+  size_t i;
+  for (i = 0; i < len; i++) {
+    h ^= (unsigned char) x[i];
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+static void string_intern_grow(void) {
+  size_t nbuckets = string_intern_nbuckets == 0 ? STRING_INTERN_MIN_BUCKETS
+                                                : 2 * string_intern_nbuckets;
+  string_intern_entry_t** buckets;
+  size_t i;
+
+  // This file is shared with the launcher, which has no allocManyZero.
+  buckets = (string_intern_entry_t**)
+    chpl_mem_allocMany(nbuckets, sizeof(*buckets),
+                       CHPL_RT_MD_STR_INTERN_DATA, 0, 0);
+  memset(buckets, 0, nbuckets * sizeof(*buckets));
+
+  for (i = 0; i < string_intern_nbuckets; i++) {
+    string_intern_entry_t* e = string_intern_buckets[i];
+    while (e != NULL) {
+      string_intern_entry_t* next = e->next;
+      size_t b = e->hash & (nbuckets - 1);
+      e->next = buckets[b];
+      buckets[b] = e;
+      e = next;
+    }
+  }
+
+  if (string_intern_buckets != NULL)
+    chpl_mem_free(string_intern_buckets, 0, 0);
+  string_intern_buckets = buckets;
+  string_intern_nbuckets = nbuckets;
+}
+
+c_string
+string_intern_len(const char* x, int64_t len) {
+  uint64_t h;
+  string_intern_entry_t* e;
+  size_t b;
+
+  if (x == NULL)
+    return NULL;
+
+  h = string_intern_hash(x, len);
+
+  pthread_mutex_lock(&string_intern_lock);
+
+  if (string_intern_count >= string_intern_nbuckets)
+    string_intern_grow();
+
+  b = h & (string_intern_nbuckets - 1);
+  for (e = string_intern_buckets[b]; e != NULL; e = e->next) {
+    if (e->hash == h && e->len == (size_t) len &&
+        memcmp(e->str, x, len) == 0)
+      break;
+  }
+
+  if (e == NULL) {
+    e = (string_intern_entry_t*)
+      chpl_mem_allocMany(1, sizeof(*e) + len + 1,
+                         CHPL_RT_MD_STR_INTERN_DATA, 0, 0);
+    e->hash = h;
+    e->len = len;
+    memcpy(e->str, x, len);
+    e->str[len] = '\0';
+    e->next = string_intern_buckets[b];
+    string_intern_buckets[b] = e;
+    string_intern_count++;
+  }
+
+  pthread_mutex_unlock(&string_intern_lock);
+
+  return e->str;
+}
+
+c_string
+string_intern(c_string x) {
+  return string_intern_len(x, string_length_bytes(x));
+}
@@ -40,6 +40,38 @@ chpl_wide_string_copy(chpl____wide_chpl_string* x, int32_t lineno, int32_t filen
   return s;
 }
 
+void
+chpl_wide_string_copy_many(int64_t n, chpl____wide_chpl_string* x,
+                           chpl_string* out,
+                           int32_t lineno, int32_t filename) {
+  chpl_bool anyRemote = false;
+  int64_t i;
+
+  for (i = 0; i < n; i++) {
+    c_nodeid_t node;
+    void* s;
+
+    if (x[i].addr == NULL) {
+      out[i] = NULL;
+      continue;
+    }
+
+    s = chpl_mem_alloc(x[i].size, CHPL_RT_MD_STR_COPY_DATA, lineno, filename);
+    node = chpl_rt_nodeFromLocaleID(x[i].locale);
+    if (node == chpl_nodeID) {
+      memcpy(s, x[i].addr, x[i].size);
+    } else {
+      chpl_gen_comm_get_unordered(s, node, (void *)(x[i].addr), x[i].size,
+                                  CHPL_COMM_UNKNOWN_ID, lineno, filename);
+      anyRemote = true;
+    }
+    out[i] = s;
+  }
+
+  if (anyRemote)
+    chpl_gen_comm_getput_unordered_task_fence();
+}
+
 uint8_t* chpl__getInPlaceBufferData(chpl__inPlaceBuffer* buf) {
   return buf->data;
 }
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Task-lifetime arena allocation.
+//
+
+#include "chplrt.h"
+
+#include "chpl-mem.h"
+#include "chpl-task-arena.h"
+#include "chpl-tasks.h"
+#include "chpl-thread-local-storage.h"
+#include "error.h"
+
+#include <stdint.h>
+
+#define ARENA_CHUNK_SIZE  ((size_t) 64 * 1024)
+#define ARENA_ALIGN       16
+#define ARENA_CACHE_MAX   4             // chunks each thread keeps
+
+struct chpl_task_arena_chunk {
+  chpl_task_arena_chunk_t* next;
+  size_t size;                          // of the data area
+  uint64_t pad;                         // keep data ARENA_ALIGN-aligned
+  char data[];
+};
+
+#ifdef CHPL_TLS
+static CHPL_TLS chpl_task_arena_chunk_t* chunk_cache;
+static CHPL_TLS int chunk_cache_cnt;
+#endif
+
+
+static
+chpl_task_arena_chunk_t* get_chunk(size_t size,
+                                   int32_t lineno, int32_t filename) {
+  chpl_task_arena_chunk_t* c;
+
+#ifdef CHPL_TLS
+  if (size <= ARENA_CHUNK_SIZE && chunk_cache != NULL) {
+    c = chunk_cache;
+    chunk_cache = c->next;
+    chunk_cache_cnt--;
+    return c;
+  }
+#endif
+
+  if (size < ARENA_CHUNK_SIZE)
+    size = ARENA_CHUNK_SIZE;
+  c = (chpl_task_arena_chunk_t*) chpl_mem_alloc(sizeof(*c) + size,
+                                                CHPL_RT_MD_TASK_LAYER_UNSPEC,
+                                                lineno, filename);
+  c->size = size;
+  return c;
+}
+
+
+static
+void put_chunk(chpl_task_arena_chunk_t* c) {
+#ifdef CHPL_TLS
+  // Only standard-size chunks are worth keeping.
+  if (c->size == ARENA_CHUNK_SIZE && chunk_cache_cnt < ARENA_CACHE_MAX) {
+    c->next = chunk_cache;
+    chunk_cache = c;
+    chunk_cache_cnt++;
+    return;
+  }
+#endif
+
+  chpl_mem_free(c, 0, 0);
+}
+
+
+void* chpl_task_arena_alloc(size_t size, int32_t lineno, int32_t filename) {
+  chpl_task_infoRuntime_t* infoRuntime = chpl_task_getInfoRuntime();
+  chpl_task_arena_t* arena;
+  chpl_task_arena_chunk_t* c;
+  void* p;
+
+  if (infoRuntime == NULL) {
+    chpl_internal_error("chpl_task_arena_alloc() called outside a task");
+  }
+
+  arena = &infoRuntime->arena;
+  size = (size + ARENA_ALIGN - 1) & ~((size_t) ARENA_ALIGN - 1);
+
+  if (size > (size_t) (arena->end - arena->cur)) {
+    c = get_chunk(size, lineno, filename);
+
+    // Oversize requests get a chunk of their own, behind the current one
+    // so we can keep allocating from what's left of that.
+    if (c->size > ARENA_CHUNK_SIZE && arena->chunks != NULL) {
+      c->next = arena->chunks->next;
+      arena->chunks->next = c;
+      return c->data;
+    }
+
+    c->next = arena->chunks;
+    arena->chunks = c;
+    arena->cur = c->data;
+    arena->end = c->data + c->size;
+  }
+
+  p = arena->cur;
+  arena->cur += size;
+  return p;
+}
+
+
+void chpl_task_arena_release(chpl_task_arena_t* arena) {
+  chpl_task_arena_chunk_t* c;
+
+  while ((c = arena->chunks) != NULL) {
+    arena->chunks = c->next;
+    put_chunk(c);
+  }
+
+  arena->cur = arena->end = NULL;
+}
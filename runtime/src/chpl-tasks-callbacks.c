@@ -23,17 +23,29 @@
 //
 #include "chplrt.h"
 
+#include "chpl-atomics.h"
 #include "chpl-comm.h"
+#include "chpl-mem.h"
+#include "chpl-thread-local-storage.h"
+#include "chpltimers.h"
 #include "error.h"
 #include "chpl-tasks-callbacks.h"
 #include "chpl-tasks-callbacks-internal.h"
 
+#include <pthread.h>
+#include <string.h>
+
 //
 // Tasking callback support.
 //
+// chpl_task_callback_counts[] counts everything that wants to see an
+// event: the installed callback functions plus the event ring, if it
+// is installed.  That way the inlined have-callbacks test covers both.
+//
 #define MAX_CBS_PER_EVENT 10
 
 static struct cb_info {
+  int num_fns;
   chpl_task_cb_fn_t fns[MAX_CBS_PER_EVENT];
   chpl_task_cb_info_kind_t info_kinds[MAX_CBS_PER_EVENT];
 } cb_info[chpl_task_cb_num_event_kinds];
@@ -41,6 +53,36 @@ static struct cb_info {
 int chpl_task_callback_counts[chpl_task_cb_num_event_kinds] = {0};
 
 
+//
+// Event ring support.  Each thread that sees an event gets its own
+// single-producer ring.  Drains are serialized by a lock, so each ring
+// also has a single consumer.  The rings are on a list so draining can
+// find them all; they are never freed.
+//
+#define EVENT_RING_SIZE 4096            // must be a power of 2
+
+typedef struct event_ring {
+  struct event_ring* next;
+  atomic_uint_least64_t head;           // next slot to fill (producer)
+  char pad[64 - sizeof(atomic_uint_least64_t)];
+  atomic_uint_least64_t tail;           // next slot to drain (consumer)
+  chpl_task_cb_event_t evs[EVENT_RING_SIZE];
+} event_ring_t;
+
+static int event_ring_installs;
+static event_ring_t* event_rings;
+static pthread_mutex_t event_rings_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t event_drain_lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_uint_least64_t events_dropped;
+
+#ifdef CHPL_TLS
+static CHPL_TLS event_ring_t* my_event_ring;
+#else
+static pthread_key_t my_event_ring_key;
+static pthread_once_t my_event_ring_key_once = PTHREAD_ONCE_INIT;
+#endif
+
+
 //
 // Tasking callback support.
 //
@@ -54,13 +96,14 @@ int chpl_task_install_callback(chpl_task_cb_event_kind_t event_kind,
     return -1;
   }
 
-  i = chpl_task_callback_counts[event_kind];
+  i = cb_info[event_kind].num_fns;
 
   if (i >= MAX_CBS_PER_EVENT) {
     errno = ENOMEM;
     return -1;
   }
 
+  cb_info[event_kind].num_fns++;
   chpl_task_callback_counts[event_kind]++;
 
   cb_info[event_kind].fns[i]= cb_fn;
@@ -80,7 +123,7 @@ int chpl_task_uninstall_callback(chpl_task_cb_event_kind_t event_kind,
     return -1;
   }
 
-  for (i = 0, found_i = -1; i < chpl_task_callback_counts[event_kind]; i++) {
+  for (i = 0, found_i = -1; i < cb_info[event_kind].num_fns; i++) {
     if (cb_info[event_kind].fns[i] == cb_fn) {
       found_i = i;
       break;
@@ -92,17 +135,167 @@ int chpl_task_uninstall_callback(chpl_task_cb_event_kind_t event_kind,
     return -1;
   }
 
-  for (i = found_i + 1; i < chpl_task_callback_counts[event_kind]; i++) {
+  for (i = found_i + 1; i < cb_info[event_kind].num_fns; i++) {
     cb_info[event_kind].fns[i - 1] = cb_info[event_kind].fns[i];
     cb_info[event_kind].info_kinds[i - 1] = cb_info[event_kind].info_kinds[i];
   }
 
+  cb_info[event_kind].num_fns--;
   chpl_task_callback_counts[event_kind]--;
 
   return 0;
 }
 
 
+int chpl_task_install_event_ring(void) {
+  int k;
+
+  if (event_ring_installs++ == 0) {
+    for (k = 0; k < chpl_task_cb_num_event_kinds; k++)
+      chpl_task_callback_counts[k]++;
+  }
+
+  return 0;
+}
+
+
+int chpl_task_uninstall_event_ring(void) {
+  int k;
+
+  if (event_ring_installs <= 0) {
+    errno = ENOENT;
+    return -1;
+  }
+
+  if (--event_ring_installs == 0) {
+    for (k = 0; k < chpl_task_cb_num_event_kinds; k++)
+      chpl_task_callback_counts[k]--;
+  }
+
+  return 0;
+}
+
+
+#ifndef CHPL_TLS
+static
+void make_my_event_ring_key(void) {
+  if (pthread_key_create(&my_event_ring_key, NULL) != 0) {
+    chpl_internal_error("pthread_key_create(&my_event_ring_key) failed");
+  }
+}
+#endif
+
+
+static
+event_ring_t* get_my_event_ring(void) {
+  event_ring_t* r;
+
+#ifdef CHPL_TLS
+  r = my_event_ring;
+#else
+  if (pthread_once(&my_event_ring_key_once, make_my_event_ring_key) != 0) {
+    chpl_internal_error("pthread_once(&my_event_ring_key_once) failed");
+  }
+  r = (event_ring_t*) pthread_getspecific(my_event_ring_key);
+#endif
+
+  if (r == NULL) {
+    r = (event_ring_t*) chpl_mem_alloc(sizeof(*r),
+                                       CHPL_RT_MD_TASK_LAYER_UNSPEC, 0, 0);
+    atomic_init_uint_least64_t(&r->head, 0);
+    atomic_init_uint_least64_t(&r->tail, 0);
+
+    pthread_mutex_lock(&event_rings_lock);
+    r->next = event_rings;
+    event_rings = r;
+    pthread_mutex_unlock(&event_rings_lock);
+
+#ifdef CHPL_TLS
+    my_event_ring = r;
+#else
+    (void) pthread_setspecific(my_event_ring_key, r);
+#endif
+  }
+
+  return r;
+}
+
+
+static inline
+void event_ring_put(chpl_task_cb_event_kind_t event_kind,
+                    chpl_fn_int_t fid, int32_t filename, int lineno,
+                    uint64_t id, int is_executeOn) {
+  event_ring_t* r = get_my_event_ring();
+  uint64_t head, tail;
+  chpl_task_cb_event_t* ev;
+
+  head = atomic_load_explicit_uint_least64_t(&r->head, memory_order_relaxed);
+  tail = atomic_load_explicit_uint_least64_t(&r->tail, memory_order_acquire);
+  if (head - tail >= EVENT_RING_SIZE) {
+    (void) atomic_fetch_add_uint_least64_t(&events_dropped, 1);
+    return;
+  }
+
+  ev = &r->evs[head & (EVENT_RING_SIZE - 1)];
+  ev->time = chpl_timer_now_ns();
+  ev->id = id;
+  ev->filename = filename;
+  ev->lineno = lineno;
+  ev->fid = fid;
+  ev->event_kind = (uint8_t) event_kind;
+  ev->is_executeOn = (is_executeOn != 0);
+
+  atomic_store_explicit_uint_least64_t(&r->head, head + 1,
+                                       memory_order_release);
+}
+
+
+size_t chpl_task_drain_events(chpl_task_cb_event_t* evs, size_t max) {
+  event_ring_t* r;
+  size_t n = 0;
+
+  pthread_mutex_lock(&event_rings_lock);
+  r = event_rings;
+  pthread_mutex_unlock(&event_rings_lock);
+
+  pthread_mutex_lock(&event_drain_lock);
+
+  for ( ; r != NULL && n < max; r = r->next) {
+    uint64_t tail, head;
+
+    tail = atomic_load_explicit_uint_least64_t(&r->tail,
+                                               memory_order_relaxed);
+    head = atomic_load_explicit_uint_least64_t(&r->head,
+                                               memory_order_acquire);
+
+    // copy out in at most two pieces, around the end of the ring
+    while (tail != head && n < max) {
+      size_t i = tail & (EVENT_RING_SIZE - 1);
+      size_t cnt = head - tail;
+      if (cnt > EVENT_RING_SIZE - i)
+        cnt = EVENT_RING_SIZE - i;
+      if (cnt > max - n)
+        cnt = max - n;
+      memcpy(&evs[n], &r->evs[i], cnt * sizeof(evs[0]));
+      n += cnt;
+      tail += cnt;
+    }
+
+    atomic_store_explicit_uint_least64_t(&r->tail, tail,
+                                         memory_order_release);
+  }
+
+  pthread_mutex_unlock(&event_drain_lock);
+
+  return n;
+}
+
+
+uint64_t chpl_task_events_dropped(void) {
+  return atomic_load_uint_least64_t(&events_dropped);
+}
+
+
 void chpl_task_do_callbacks_internal(chpl_task_cb_event_kind_t event_kind,
                                      chpl_fn_int_t fid,
                                      int32_t filename,
@@ -113,12 +306,16 @@ void chpl_task_do_callbacks_internal(chpl_task_cb_event_kind_t event_kind,
   chpl_task_cb_info_t info;
   int i;
 
+  if (event_ring_installs > 0) {
+    event_ring_put(event_kind, fid, filename, lineno, id, is_executeOn);
+  }
+
   cbp = &cb_info[event_kind];
 
   info.nodeID = chpl_nodeID;
   info.event_kind = event_kind;
 
-  for (i = 0; i < chpl_task_callback_counts[event_kind]; i++) {
+  for (i = 0; i < cbp->num_fns; i++) {
     info.info_kind = cbp->info_kinds[i];
 
     switch (cbp->info_kinds[i]) {
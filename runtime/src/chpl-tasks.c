@@ -24,6 +24,7 @@
 //
 #include "chplrt.h"
 #include "chpl-comm.h"
+#include "chpl-env.h"
 #include "chpl-tasks.h"
 #include "chpl-topo.h"
 #include "error.h"
@@ -208,3 +209,69 @@ size_t chpl_task_getDefaultCallStackSize(void)
 
   return deflt;
 }
+
+
+//
+// The number of threads that could pick up a new task right now
+// without oversubscribing the CPUs.  Layers with a fixed set of
+// threads don't necessarily count idle ones (qthreads doesn't), so
+// for those we go by the queued task count alone.
+//
+static uint32_t available_threads(void)
+{
+  uint32_t fixed = chpl_task_getFixedNumThreads();
+  uint32_t queued = chpl_task_getNumQueuedTasks();
+  uint32_t busy;
+  uint32_t limit;
+
+  if (fixed > 0) {
+    limit = fixed;
+    busy = queued;
+  }
+  else {
+    limit = (uint32_t) chpl_topo_getNumCPUsPhysical(true);
+    busy = chpl_task_getNumThreads() - chpl_task_getNumIdleThreads()
+           + queued;
+  }
+
+  return (busy < limit) ? limit - busy : 0;
+}
+
+
+uint32_t chpl_task_getAdaptiveNumTasks(uint32_t maxTasks)
+{
+  static int       env_checked = 0;
+  static chpl_bool adaptive = false;
+  uint32_t         num;
+
+  if (!env_checked) {
+    adaptive = chpl_env_rt_get_bool("ADAPTIVE_DATA_PAR", false);
+    env_checked = 1;
+  }
+
+  if (!adaptive || maxTasks <= 1)
+    return (maxTasks < 1) ? 1 : maxTasks;
+
+  //
+  // The calling task does one share of the work itself, so it can use
+  // one more task than there are threads available.
+  //
+  num = available_threads() + 1;
+  return (num < maxTasks) ? num : maxTasks;
+}
+
+
+chpl_bool chpl_task_shouldSplitWork(void)
+{
+  static int      env_checked = 0;
+  static uint32_t threshold = 2;
+
+  if (!env_checked) {
+    int64_t t = chpl_env_rt_get_int("ADAPTIVE_SPLIT_THRESHOLD", 2);
+    threshold = (t < 1) ? 1 : (uint32_t) t;
+    env_checked = 1;
+  }
+
+  return chpl_task_getNumQueuedTasks() < threshold
+         && available_threads() > 0;
+}
@@ -0,0 +1,261 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Per-locale hierarchical timer wheel, for parking sleeping tasks.
+//
+
+#include "chplrt.h"
+
+#include "chpl-timer-wheel.h"
+#include "chpltypes.h"
+#include "error.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+
+//
+// Four levels of 64 slots each.  Level 0 slots are one tick apiece;
+// each slot of level L covers a whole rotation of level L-1.  A timer
+// goes in the lowest level whose span reaches its expiry, and moves
+// ("cascades") down a level each time the level below wraps around
+// to it, until it is in level 0 and fires.  At 1 ms per tick the top
+// level spans about 4.6 hours; timers further out than that sit in
+// its farthest slot and cascade around it until they're in range.
+//
+#define TW_LEVEL_BITS 6
+#define TW_SLOTS      (1 << TW_LEVEL_BITS)
+#define TW_SLOT_MASK  (TW_SLOTS - 1)
+#define TW_LEVELS     4
+#define TW_SPAN(l)    ((uint64_t) 1 << (TW_LEVEL_BITS * (l)))
+
+static chpl_timer_wheel_entry_t* tw_slots[TW_LEVELS][TW_SLOTS];
+static uint64_t tw_occupied[TW_LEVELS];  // bit per non-empty slot
+static uint64_t tw_count;                // timers in the wheel
+static uint64_t tw_curTick;              // next tick to be serviced
+
+static pthread_mutex_t tw_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t tw_cond;
+static pthread_once_t tw_once = PTHREAD_ONCE_INIT;
+
+
+static uint64_t now_ticks(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000 + (uint64_t) ts.tv_nsec / 1000000;
+}
+
+
+static void place(chpl_timer_wheel_entry_t* e) {
+  uint64_t delta = e->expiry - tw_curTick;
+  int level;
+  int slot;
+
+  for (level = 0; level < TW_LEVELS - 1; level++) {
+    if (delta < TW_SPAN(level + 1)) {
+      break;
+    }
+  }
+
+  if (delta < TW_SPAN(TW_LEVELS)) {
+    slot = (e->expiry >> (TW_LEVEL_BITS * level)) & TW_SLOT_MASK;
+  } else {
+    slot = ((tw_curTick + TW_SPAN(TW_LEVELS) - 1)
+            >> (TW_LEVEL_BITS * level)) & TW_SLOT_MASK;
+  }
+
+  e->next = tw_slots[level][slot];
+  tw_slots[level][slot] = e;
+  tw_occupied[level] |= (uint64_t) 1 << slot;
+}
+
+
+static chpl_timer_wheel_entry_t* take_slot(int level, int slot) {
+  chpl_timer_wheel_entry_t* list = tw_slots[level][slot];
+  tw_slots[level][slot] = NULL;
+  tw_occupied[level] &= ~((uint64_t) 1 << slot);
+  return list;
+}
+
+
+//
+// Move the timers in the level-L slots we've just reached down into
+// the lower levels.  Call only when tw_curTick is a multiple of the
+// level 1 span.
+//
+static void cascade(void) {
+  for (int level = 1; level < TW_LEVELS; level++) {
+    int slot = (tw_curTick >> (TW_LEVEL_BITS * level)) & TW_SLOT_MASK;
+    chpl_timer_wheel_entry_t* e = take_slot(level, slot);
+
+    while (e != NULL) {
+      chpl_timer_wheel_entry_t* next = e->next;
+      place(e);
+      e = next;
+    }
+
+    if (slot != 0) {
+      break;
+    }
+  }
+}
+
+
+//
+// Service every tick up to and including 'now', moving the expired
+// timers onto *fired for the caller to run once it drops the lock.
+//
+static void advance(uint64_t now, chpl_timer_wheel_entry_t** fired) {
+  while (tw_curTick <= now) {
+    if (tw_count == 0) {
+      tw_curTick = now + 1;
+      break;
+    }
+
+    int slot = tw_curTick & TW_SLOT_MASK;
+    chpl_timer_wheel_entry_t* e = take_slot(0, slot);
+    while (e != NULL) {
+      chpl_timer_wheel_entry_t* next = e->next;
+      e->next = *fired;
+      *fired = e;
+      tw_count--;
+      e = next;
+    }
+
+    //
+    // With nothing else in level 0 we can skip straight to the next
+    // cascade (or to 'now').
+    //
+    uint64_t nextTick = tw_curTick + 1;
+    if (tw_occupied[0] == 0) {
+      uint64_t boundary = (tw_curTick | TW_SLOT_MASK) + 1;
+      nextTick = (now + 1 < boundary) ? now + 1 : boundary;
+    }
+
+    tw_curTick = nextTick;
+    if ((tw_curTick & TW_SLOT_MASK) == 0) {
+      cascade();
+    }
+  }
+}
+
+
+//
+// When the service thread next has something to do: the next busy
+// level 0 slot, or else the next cascade.
+//
+static uint64_t next_event_tick(void) {
+  int cur = tw_curTick & TW_SLOT_MASK;
+
+  if (tw_occupied[0] != 0) {
+    uint64_t rot = (tw_occupied[0] >> cur)
+                   | (cur == 0 ? 0 : tw_occupied[0] << (TW_SLOTS - cur));
+    return tw_curTick + __builtin_ctzll(rot);
+  }
+
+  return (tw_curTick | TW_SLOT_MASK) + 1;
+}
+
+
+static void* service_thread(void* unused) {
+  chpl_timer_wheel_entry_t* fired = NULL;
+
+  pthread_mutex_lock(&tw_lock);
+
+  while (1) {
+    advance(now_ticks(), &fired);
+
+    if (fired != NULL) {
+      pthread_mutex_unlock(&tw_lock);
+      while (fired != NULL) {
+        chpl_timer_wheel_entry_t* e = fired;
+        fired = e->next;
+        (*e->fn)(e->arg);
+      }
+      pthread_mutex_lock(&tw_lock);
+    } else if (tw_count == 0) {
+      pthread_cond_wait(&tw_cond, &tw_lock);
+    } else {
+      uint64_t wake = next_event_tick();
+      struct timespec ts = { .tv_sec = wake / 1000,
+                             .tv_nsec = (wake % 1000) * 1000000 };
+      pthread_cond_timedwait(&tw_cond, &tw_lock, &ts);
+    }
+  }
+
+  return NULL;
+}
+
+
+static void start_service_thread(void) {
+  pthread_condattr_t attr;
+  pthread_t thread;
+
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&tw_cond, &attr);
+  pthread_condattr_destroy(&attr);
+
+  tw_curTick = now_ticks();
+
+  if (pthread_create(&thread, NULL, service_thread, NULL) != 0) {
+    chpl_internal_error("cannot create timer wheel service thread");
+  }
+  pthread_detach(thread);
+}
+
+
+void chpl_timer_wheel_add(chpl_timer_wheel_entry_t* e, double secs,
+                          void (*fn)(void*), void* arg) {
+  uint64_t ticks = (secs <= 0.0)
+                   ? 0
+                   : (uint64_t) (secs / CHPL_TIMER_WHEEL_TICK_SECS + 0.999999);
+
+  pthread_once(&tw_once, start_service_thread);
+
+  e->fn = fn;
+  e->arg = arg;
+
+  pthread_mutex_lock(&tw_lock);
+
+  //
+  // Round up a tick, so that a partly elapsed current tick can't make
+  // us fire early.
+  //
+  e->expiry = now_ticks() + ticks + 1;
+  if (e->expiry < tw_curTick) {
+    e->expiry = tw_curTick;
+  }
+
+  //
+  // Only wake the service thread if this timer is due before whatever
+  // it's already waiting for.
+  //
+  chpl_bool wake = (tw_count == 0 || e->expiry < next_event_tick());
+  place(e);
+  tw_count++;
+
+  pthread_mutex_unlock(&tw_lock);
+
+  if (wake) {
+    pthread_cond_signal(&tw_cond);
+  }
+}
@@ -23,8 +23,15 @@
 #include "chplrt.h"
 
 #include "chpltimers.h"
+#include "chpl-env.h"
 
 #include <time.h>   // For struct tm.
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+chpl_bool chpl_timer_use_counter = false;
+double chpl_timer_ns_per_tick = 1.0;
 
 _timevalue chpl_null_timevalue(void) {
   _timevalue ret;
@@ -56,3 +63,59 @@ void chpl_timevalue_parts(_timevalue t, int32_t* seconds, int32_t* minutes, int3
   if( yday ) *yday = localt.tm_yday;
   if( isdst ) *isdst = localt.tm_isdst;
 }
+
+
+#if defined(__x86_64__)
+static uint64_t monotonic_ns(void) {
+  struct timespec ts;
+  (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+}
+#endif
+
+void chpl_timer_init(void)
+{
+  if (!chpl_env_rt_get_bool("TIMER_USE_CYCLE_COUNTER", true))
+    return;
+
+#if defined(__x86_64__)
+  {
+    unsigned int eax, ebx, ecx, edx;
+    uint64_t ns0, ns1, tsc0, tsc1;
+
+    // Without an invariant TSC (CPUID 80000007H, EDX bit 8) the rate
+    // can change with the P-state, and the cores' counts can drift.
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)
+        || (edx & (1U << 8)) == 0)
+      return;
+
+    //
+    // Calibrate against CLOCK_MONOTONIC.  2ms keeps the error from
+    // the clock reads themselves down in the parts per million.
+    //
+    chpl_timer_use_counter = true;
+    ns0 = monotonic_ns();
+    tsc0 = chpl_timer_ticks();
+    do {
+      ns1 = monotonic_ns();
+    } while (ns1 - ns0 < 2000000);
+    tsc1 = chpl_timer_ticks();
+
+    if (tsc1 <= tsc0) {
+      chpl_timer_use_counter = false;
+      return;
+    }
+    chpl_timer_ns_per_tick = (double) (ns1 - ns0) / (double) (tsc1 - tsc0);
+  }
+#elif defined(__aarch64__)
+  {
+    // The generic timer runs at the fixed rate in CNTFRQ_EL0.
+    uint64_t freq;
+    __asm__ __volatile__ ("mrs %0, cntfrq_el0" : "=r"(freq));
+    if (freq == 0)
+      return;
+    chpl_timer_ns_per_tick = 1.0e9 / (double) freq;
+    chpl_timer_use_counter = true;
+  }
+#endif
+}
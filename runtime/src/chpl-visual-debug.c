@@ -23,12 +23,17 @@
 //
 
 #include "chpl-visual-debug.h"
+#include "chpl-visual-debug-format.h"
 #include "chplrt.h"
 #include "chpl-comm.h"
 #include "chpl-tasks.h"
 #include "chpl-tasks-callbacks.h"
 #include "chpl-comm-callbacks.h"
 #include "chpl-linefile-support.h"
+#include "chpl-env.h"
+#include "chpl-mem.h"
+#include "error.h"
+#include <pthread.h>
 #include <stdint.h>
 #include <string.h>
 #include <unistd.h>
@@ -67,8 +72,76 @@ int chpl_vdebug = 0;
 
 #define TID_STRING(buff, tid) (chpl_task_idToString(buff, CHPL_TASK_ID_STRING_MAX_LEN, tid))
 
-#define VDEBUG_GETPUT_FORMAT_NAMES "kind tv srcNodeID dstNodeID commTaskID addr raddr elemSize length commID lineNumber fileno"
-#define VDEBUG_GETPUT_FORMAT_STRING "%s: %lld.%06ld %d %d %s %#lx %#lx %zd %zd %d %d %d\n"
+
+//
+// Shared file mode (CHPL_RT_VDEBUG_SHARED_FILE): all nodes write to one
+// file, each in a section of its own at a fixed offset, instead of each
+// writing a file.  The layout is in chpl-visual-debug-format.h.  Each
+// node's section is vdebug_sect_size bytes; anything past that is
+// dropped, except that the last VDEBUG_SECT_RESERVE bytes are kept for
+// Tag, Pause and End records so the data stays consistent.
+//
+
+#define VDEBUG_SECT_RESERVE (64 * 1024)
+
+static chpl_bool vdebug_shared = false;
+static size_t vdebug_sect_size;
+static off_t vdebug_sect_base;          // offset of this node's section
+static size_t vdebug_sect_used;
+static chpl_bool vdebug_sect_full;
+static pthread_mutex_t vdebug_sect_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Write all of p[0..len-1] to the vdebug file.
+static int vdebug_write (const void *p, size_t len, chpl_bool useReserve) {
+  const char *cp = (const char *) p;
+  off_t off = 0;
+
+  if (vdebug_shared) {
+    size_t limit = vdebug_sect_size - (useReserve ? 0 : VDEBUG_SECT_RESERVE);
+    pthread_mutex_lock (&vdebug_sect_lock);
+    if (vdebug_sect_used + len > limit) {
+      if (!vdebug_sect_full)
+        chpl_warning ("Visual Debug section is full, dropping events "
+                      "(see CHPL_RT_VDEBUG_SECTION_SIZE)", 0, 0);
+      vdebug_sect_full = true;
+      pthread_mutex_unlock (&vdebug_sect_lock);
+      return -1;
+    }
+    off = vdebug_sect_base + vdebug_sect_used;
+    vdebug_sect_used += len;
+    pthread_mutex_unlock (&vdebug_sect_lock);
+  }
+
+  while (len > 0 && chpl_vdebug_fd >= 0) {
+    ssize_t wrv = vdebug_shared ? pwrite (chpl_vdebug_fd, cp, len, off)
+                                : write (chpl_vdebug_fd, cp, len);
+    if (wrv < 0) {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    cp += wrv;
+    len -= wrv;
+    off += wrv;
+  }
+  return 0;
+}
+
+// In shared file mode, record how much of this node's section is used.
+// Done at each Tag, Pause and End, so the file is usable even if the
+// program dies before stopping Visual Debug.
+static void vdebug_update_index (void) {
+  chpl_vdebug_section_t sect;
+
+  if (!vdebug_shared || chpl_vdebug_fd < 0)
+    return;
+  pthread_mutex_lock (&vdebug_sect_lock);
+  sect.offset = vdebug_sect_base;
+  sect.length = vdebug_sect_used;
+  pthread_mutex_unlock (&vdebug_sect_lock);
+  (void) pwrite (chpl_vdebug_fd, &sect, sizeof (sect),
+                 sizeof (chpl_vdebug_shared_hdr_t) + chpl_nodeID * sizeof (sect));
+}
 
 int chpl_dprintf (int fd, const char * format, ...) {
   char buffer[2048]; 
@@ -80,13 +153,207 @@ int chpl_dprintf (int fd, const char * format, ...) {
   retval = vsnprintf (buffer, sizeof (buffer), format, ap);
   va_end(ap);
   if (retval > 0) {
-    wrv = write (fd, buffer,retval);
+    if (fd == chpl_vdebug_fd)
+      wrv = vdebug_write (buffer, retval, true);
+    else
+      wrv = write (fd, buffer,retval);
     if (wrv < 0) return -1;
     return retval;
   }
   return -1;
 }
 
+//
+// After the text header, events are written as the fixed-size binary
+// records defined in chpl-visual-debug-format.h.  Each thread collects
+// its records in a buffer of its own and writes the whole buffer at
+// once.  All the buffers are flushed before writing a Tag, Pause or
+// End record, so events stay on the correct side of those.
+//
+
+#define VDEBUG_BUF_RECS 1024
+
+// Puts and gets that were sampled out, per remote node and direction
+typedef struct {
+  uint64_t count;
+  uint64_t bytes;
+} vdebug_comm_sum_t;
+
+typedef struct vdebug_buf_s {
+  struct vdebug_buf_s* next;    // list of all buffers, for flushing
+  pthread_mutex_t lock;
+  int nrecs;
+  int64_t commsSinceRec;        // puts and gets since the last one recorded
+  vdebug_comm_sum_t* sums;      // [2 * chpl_numNodes], gets first
+  chpl_vdebug_rec_t recs[VDEBUG_BUF_RECS];
+} vdebug_buf_t;
+
+//
+// Sampling: record one put or get in vdebug_sample_every, and only
+// those moving at least vdebug_sample_min_size bytes.  The others are
+// summed up and written as comm_sum records.  Tasks and forks are
+// always recorded, since chplvis needs all of them to track tasks.
+//
+static int64_t vdebug_sample_every = 1;
+static size_t vdebug_sample_min_size = 0;
+
+static pthread_mutex_t vdebug_bufs_lock = PTHREAD_MUTEX_INITIALIZER;
+static vdebug_buf_t* vdebug_bufs = NULL;
+static pthread_key_t vdebug_buf_key;
+static pthread_once_t vdebug_buf_key_once = PTHREAD_ONCE_INIT;
+
+static void vdebug_make_buf_key (void) {
+  if (pthread_key_create (&vdebug_buf_key, NULL) != 0)
+    chpl_internal_error ("cannot create Visual Debug buffer key");
+}
+
+// Write the records in one piece, so that they aren't interleaved with
+// other threads' records.  isMark is set for Tag, Pause and End records
+// and tag names, which may use the reserve in shared file mode.
+static void vdebug_write_recs (const chpl_vdebug_rec_t *recs, int nrecs,
+                               chpl_bool isMark) {
+  (void) vdebug_write (recs, nrecs * sizeof (recs[0]), isMark);
+}
+
+static vdebug_buf_t *vdebug_my_buf (void) {
+  vdebug_buf_t *buf;
+
+  (void) pthread_once (&vdebug_buf_key_once, vdebug_make_buf_key);
+  buf = (vdebug_buf_t *) pthread_getspecific (vdebug_buf_key);
+  if (buf == NULL) {
+    buf = (vdebug_buf_t *) chpl_mem_alloc (sizeof (*buf),
+                                           CHPL_RT_MD_VDEBUG_BUFFER, 0, 0);
+    pthread_mutex_init (&buf->lock, NULL);
+    buf->nrecs = 0;
+    buf->commsSinceRec = 0;
+    buf->sums = NULL;
+    pthread_mutex_lock (&vdebug_bufs_lock);
+    buf->next = vdebug_bufs;
+    vdebug_bufs = buf;
+    pthread_mutex_unlock (&vdebug_bufs_lock);
+    (void) pthread_setspecific (vdebug_buf_key, buf);
+  }
+  return buf;
+}
+
+static void vdebug_put_rec (const chpl_vdebug_rec_t *rec) {
+  vdebug_buf_t *buf = vdebug_my_buf ();
+
+  pthread_mutex_lock (&buf->lock);
+  buf->recs[buf->nrecs++] = *rec;
+  if (buf->nrecs == VDEBUG_BUF_RECS) {
+    vdebug_write_recs (buf->recs, buf->nrecs, false);
+    buf->nrecs = 0;
+  }
+  pthread_mutex_unlock (&buf->lock);
+}
+
+static void vdebug_init_rec (chpl_vdebug_rec_t *rec, chpl_vdebug_rec_kind_t kind,
+                             int32_t nodeID, chpl_taskID_t taskID);
+
+// Record a put or get, or add it to this thread's sums if it isn't
+// sampled.
+static void vdebug_put_comm_rec (const chpl_vdebug_rec_t *rec, int isGet,
+                                 uint64_t bytes) {
+  vdebug_buf_t *buf = vdebug_my_buf ();
+
+  pthread_mutex_lock (&buf->lock);
+  if (bytes >= vdebug_sample_min_size
+      && ++buf->commsSinceRec >= vdebug_sample_every) {
+    buf->commsSinceRec = 0;
+    buf->recs[buf->nrecs++] = *rec;
+    if (buf->nrecs == VDEBUG_BUF_RECS) {
+      vdebug_write_recs (buf->recs, buf->nrecs, false);
+      buf->nrecs = 0;
+    }
+  } else {
+    vdebug_comm_sum_t *sum;
+    if (buf->sums == NULL) {
+      size_t sz = 2 * chpl_numNodes * sizeof (buf->sums[0]);
+      buf->sums = (vdebug_comm_sum_t *) chpl_mem_alloc (sz,
+                                          CHPL_RT_MD_VDEBUG_BUFFER, 0, 0);
+      memset (buf->sums, 0, sz);
+    }
+    sum = &buf->sums[(isGet ? 0 : chpl_numNodes) + rec->u.comm.remoteNodeID];
+    sum->count++;
+    sum->bytes += bytes;
+  }
+  pthread_mutex_unlock (&buf->lock);
+}
+
+// Write a thread's sums as comm_sum records and clear them.
+static void vdebug_write_sums (vdebug_buf_t *buf) {
+  chpl_vdebug_rec_t recs[64];
+  int nrecs = 0;
+
+  for (int32_t i = 0; i < 2 * chpl_numNodes; i++) {
+    if (buf->sums[i].count == 0)
+      continue;
+    vdebug_init_rec (&recs[nrecs], chpl_vdebug_rec_comm_sum, chpl_nodeID, 0);
+    recs[nrecs].u.commSum.remoteNodeID = i % chpl_numNodes;
+    recs[nrecs].u.commSum.isGet = i < chpl_numNodes;
+    recs[nrecs].u.commSum.count = buf->sums[i].count;
+    recs[nrecs].u.commSum.bytes = buf->sums[i].bytes;
+    buf->sums[i].count = 0;
+    buf->sums[i].bytes = 0;
+    if (++nrecs == 64) {
+      vdebug_write_recs (recs, nrecs, false);
+      nrecs = 0;
+    }
+  }
+  if (nrecs > 0)
+    vdebug_write_recs (recs, nrecs, false);
+}
+
+// Write out (or, if !doWrite, throw away) every thread's buffered records.
+static void vdebug_flush_bufs (int doWrite) {
+  vdebug_buf_t *buf;
+
+  pthread_mutex_lock (&vdebug_bufs_lock);
+  for (buf = vdebug_bufs; buf != NULL; buf = buf->next) {
+    pthread_mutex_lock (&buf->lock);
+    if (doWrite && buf->nrecs > 0)
+      vdebug_write_recs (buf->recs, buf->nrecs, false);
+    buf->nrecs = 0;
+    if (buf->sums != NULL) {
+      if (doWrite)
+        vdebug_write_sums (buf);
+      else
+        memset (buf->sums, 0, 2 * chpl_numNodes * sizeof (buf->sums[0]));
+    }
+    buf->commsSinceRec = 0;
+    pthread_mutex_unlock (&buf->lock);
+  }
+  pthread_mutex_unlock (&vdebug_bufs_lock);
+}
+
+static void vdebug_init_rec (chpl_vdebug_rec_t *rec, chpl_vdebug_rec_kind_t kind,
+                             int32_t nodeID, chpl_taskID_t taskID) {
+  struct timeval tv;
+  (void) gettimeofday (&tv, NULL);
+  memset (rec, 0, sizeof (*rec));
+  rec->kind = kind;
+  rec->nodeID = nodeID;
+  rec->sec = tv.tv_sec;
+  rec->usec = tv.tv_usec;
+  rec->taskID = (int64_t) taskID;
+}
+
+static void vdebug_set_times (chpl_vdebug_rec_t *rec, int tagno) {
+  struct rusage ru;
+  if ( getrusage (RUSAGE_SELF, &ru) < 0) {
+    ru.ru_utime.tv_sec = 0;
+    ru.ru_utime.tv_usec = 0;
+    ru.ru_stime.tv_sec = 0;
+    ru.ru_stime.tv_usec = 0;
+  }
+  rec->u.times.userSec = ru.ru_utime.tv_sec;
+  rec->u.times.userUsec = ru.ru_utime.tv_usec;
+  rec->u.times.sysSec = ru.ru_stime.tv_sec;
+  rec->u.times.sysUsec = ru.ru_stime.tv_usec;
+  rec->u.times.tagno = tagno;
+}
+
 static int chpl_make_vdebug_file (const char *rootname) {
     char fname[MAXPATHLEN]; 
     struct stat sb;
@@ -106,8 +373,16 @@ static int chpl_make_vdebug_file (const char *rootname) {
       }
     }
     
-    snprintf (fname, sizeof (fname), "%s/%s-%d", rootname, rootname, chpl_nodeID);
-    chpl_vdebug_fd = open (fname, O_WRONLY|O_CREAT|O_TRUNC|O_APPEND, 0666);
+    vdebug_shared = chpl_env_rt_get_bool ("VDEBUG_SHARED_FILE", false);
+    if (!vdebug_shared) {
+      snprintf (fname, sizeof (fname), "%s/%s-%d", rootname, rootname, chpl_nodeID);
+      chpl_vdebug_fd = open (fname, O_WRONLY|O_CREAT|O_TRUNC|O_APPEND, 0666);
+    } else {
+      // No O_TRUNC, other nodes may already be writing.  Old data past
+      // the end of a section is ignored, since the index has its length.
+      snprintf (fname, sizeof (fname), "%s/%s-all", rootname, rootname);
+      chpl_vdebug_fd = open (fname, O_WRONLY|O_CREAT, 0666);
+    }
     if (chpl_vdebug_fd < 0) {
       fprintf (stderr, "Visual Debug failed to open %s: %s\n",
                fname, strerror (errno));
@@ -115,6 +390,33 @@ static int chpl_make_vdebug_file (const char *rootname) {
       return -1;
     }
 
+    if (vdebug_shared) {
+      chpl_vdebug_shared_hdr_t hdr;
+
+      vdebug_sect_size = chpl_env_rt_get_size ("VDEBUG_SECTION_SIZE",
+                                               (size_t) 256 << 20);
+      if (vdebug_sect_size < 2 * VDEBUG_SECT_RESERVE)
+        vdebug_sect_size = 2 * VDEBUG_SECT_RESERVE;
+      vdebug_sect_base = CHPL_VDEBUG_SHARED_HDR_SIZE (chpl_numNodes)
+                         + (off_t) chpl_nodeID * vdebug_sect_size;
+      vdebug_sect_used = 0;
+      vdebug_sect_full = false;
+
+      // Every node writes the same header, and its own index entry
+      memset (&hdr, 0, sizeof (hdr));
+      memcpy (hdr.magic, CHPL_VDEBUG_SHARED_MAGIC, sizeof (hdr.magic));
+      hdr.numNodes = chpl_numNodes;
+      hdr.sectionSize = vdebug_sect_size;
+      if (pwrite (chpl_vdebug_fd, &hdr, sizeof (hdr), 0) != sizeof (hdr)) {
+        fprintf (stderr, "Visual Debug failed to write %s: %s\n",
+                 fname, strerror (errno));
+        close (chpl_vdebug_fd);
+        chpl_vdebug_fd = -1;
+        return -1;
+      }
+      vdebug_update_index ();
+    }
+
     return 0;
 }
 
@@ -146,6 +448,14 @@ void chpl_vdebug_start (const char *fileroot, double now) {
   // Get the root of the file name.
   rootname = (fileroot == NULL || fileroot[0] == 0) ? ".Vdebug" : fileroot; 
   
+  // Drop anything left over from a previous run
+  vdebug_flush_bufs (0);
+
+  vdebug_sample_every = chpl_env_rt_get_int ("VDEBUG_SAMPLE", 1);
+  if (vdebug_sample_every < 1)
+    vdebug_sample_every = 1;
+  vdebug_sample_min_size = chpl_env_rt_get_size ("VDEBUG_MIN_SIZE", 0);
+
   // In case of an error, just return
   if (chpl_make_vdebug_file (rootname) < 0)
     return;
@@ -158,7 +468,7 @@ void chpl_vdebug_start (const char *fileroot, double now) {
     ru.ru_stime.tv_usec = 0;
   }
   chpl_dprintf (chpl_vdebug_fd,
-                "ChplVdebug: ver 1.4 nodes %d nid %d tid %s seq %.3lf %lld.%06ld %ld.%06ld %ld.%06ld \n",
+                "ChplVdebug: ver 1.5 nodes %d nid %d tid %s seq %.3lf %lld.%06ld %ld.%06ld %ld.%06ld \n",
                 chpl_numNodes, chpl_nodeID, TID_STRING(buff, startTask), now,
                 (long long) tv.tv_sec, (long) tv.tv_usec,
                 (long) ru.ru_utime.tv_sec, (long) ru.ru_utime.tv_usec,
@@ -192,7 +502,10 @@ void chpl_vdebug_start (const char *fileroot, double now) {
                     chpl_finfo[ix].lineno, chpl_finfo[ix].fileno,
                     chpl_finfo[ix].name);
   }
-  
+
+  // Everything after this is binary records
+  chpl_dprintf (chpl_vdebug_fd, "Binary: %d\n", (int) sizeof (chpl_vdebug_rec_t));
+
   chpl_vdebug = 1;
 }
 
@@ -201,10 +514,7 @@ void chpl_vdebug_start (const char *fileroot, double now) {
 // Should be the last record in the file.
 
 void chpl_vdebug_stop (void) {
-  struct rusage ru;  
-  struct timeval tv;
-  chpl_taskID_t stopTask = chpl_task_getId();
-  char buff[CHPL_TASK_ID_STRING_MAX_LEN];
+  chpl_vdebug_rec_t rec;
 
   // First, shutdown VisualDebug
   chpl_vdebug = 0;
@@ -212,20 +522,13 @@ void chpl_vdebug_stop (void) {
 
   // Now log the stop
   if (chpl_vdebug_fd >= 0) {
-    (void) gettimeofday (&tv, NULL);
-    if ( getrusage (RUSAGE_SELF, &ru) < 0) {
-      ru.ru_utime.tv_sec = 0;
-      ru.ru_utime.tv_usec = 0;
-      ru.ru_stime.tv_sec = 0;
-      ru.ru_stime.tv_usec = 0;
-    }
-    // Generate the End record
-    chpl_dprintf (chpl_vdebug_fd, "End: %lld.%06ld %ld.%06ld %ld.%06ld %d %s\n",
-                  (long long) tv.tv_sec, (long) tv.tv_usec,
-                  (long) ru.ru_utime.tv_sec, (long) ru.ru_utime.tv_usec,
-                  (long) ru.ru_stime.tv_sec, (long) ru.ru_stime.tv_usec,
-                  chpl_nodeID, TID_STRING(buff, stopTask));
+    vdebug_init_rec (&rec, chpl_vdebug_rec_end, chpl_nodeID, chpl_task_getId());
+    vdebug_set_times (&rec, 0);
+    vdebug_flush_bufs (1);
+    vdebug_write_recs (&rec, 1, true);
+    vdebug_update_index ();
     close (chpl_vdebug_fd);
+    chpl_vdebug_fd = -1;
   }
 }
 
@@ -236,268 +539,166 @@ void chpl_vdebug_stop (void) {
 // the xxxVdebug() call and chplvis should ignore them.
 
 void chpl_vdebug_mark (void) {
-  struct timeval tv;
-  chpl_taskID_t tagTask = chpl_task_getId();
-  char buff[CHPL_TASK_ID_STRING_MAX_LEN];
-  (void) gettimeofday (&tv, NULL);
-  chpl_dprintf (chpl_vdebug_fd, "VdbMark: %lld.%06ld %d %s\n",
-                (long long) tv.tv_sec, (long) tv.tv_usec, chpl_nodeID, TID_STRING(buff, tagTask) );
+  chpl_vdebug_rec_t rec;
+  vdebug_init_rec (&rec, chpl_vdebug_rec_vdb_mark, chpl_nodeID, chpl_task_getId());
+  vdebug_put_rec (&rec);
 }
 
 // Record>  tname: tag# tagname
 
 void chpl_vdebug_tagname (const char* tagname, int tagno) {
-  chpl_dprintf (chpl_vdebug_fd, "tname: %d %s\n", tagno, tagname);
+  chpl_vdebug_rec_t rec[1 + (MAXPATHLEN / CHPL_VDEBUG_REC_SIZE)];
+  size_t len = strlen (tagname);
+  int nrecs;
+
+  if (len > MAXPATHLEN)
+    len = MAXPATHLEN;
+  nrecs = 1 + (len + CHPL_VDEBUG_REC_SIZE - 1) / CHPL_VDEBUG_REC_SIZE;
+
+  vdebug_init_rec (&rec[0], chpl_vdebug_rec_tag_name, chpl_nodeID, chpl_task_getId());
+  rec[0].u.tagName.tagno = tagno;
+  rec[0].u.tagName.len = len;
+  memset (&rec[1], 0, (nrecs - 1) * sizeof (rec[0]));
+  memcpy (&rec[1], tagname, len);
+  vdebug_write_recs (rec, nrecs, true);
 }
 
 // Record>  Tag: time.sec user.time sys.time nodeId taskId tag# 
 
 void chpl_vdebug_tag (int tagno) {
-  struct rusage ru;
-  struct timeval tv;
-  
-  chpl_taskID_t tagTask = chpl_task_getId();
-  char buff[CHPL_TASK_ID_STRING_MAX_LEN];
-
-  (void) gettimeofday (&tv, NULL);
-  if ( getrusage (RUSAGE_SELF, &ru) < 0) {
-    ru.ru_utime.tv_sec = 0;
-    ru.ru_utime.tv_usec = 0;
-    ru.ru_stime.tv_sec = 0;
-    ru.ru_stime.tv_usec = 0;
-  }
-  chpl_dprintf (chpl_vdebug_fd, "Tag: %lld.%06ld %ld.%06ld %ld.%06ld %d %s %d\n",
-                (long long) tv.tv_sec, (long) tv.tv_usec,
-                (long) ru.ru_utime.tv_sec, (long) ru.ru_utime.tv_usec,
-                (long) ru.ru_stime.tv_sec, (long) ru.ru_stime.tv_usec,
-                chpl_nodeID, TID_STRING(buff, tagTask), tagno);
+  chpl_vdebug_rec_t rec;
+  vdebug_init_rec (&rec, chpl_vdebug_rec_tag, chpl_nodeID, chpl_task_getId());
+  vdebug_set_times (&rec, tagno);
+  vdebug_flush_bufs (1);
+  vdebug_write_recs (&rec, 1, true);
+  vdebug_update_index ();
   chpl_vdebug = 1;
 }
 
 // Record>  Pause: time.sec user.time sys.time nodeId taskId tag#
 
 void chpl_vdebug_pause (int tagno) {
-  struct rusage ru;
-  struct timeval tv;
-  chpl_taskID_t pauseTask = chpl_task_getId();
-  char buff[CHPL_TASK_ID_STRING_MAX_LEN];
+  chpl_vdebug_rec_t rec;
 
   if (chpl_vdebug_fd >=0 && chpl_vdebug == 1) {
-    (void) gettimeofday (&tv, NULL);
-    if ( getrusage (RUSAGE_SELF, &ru) < 0) {
-      ru.ru_utime.tv_sec = 0;
-      ru.ru_utime.tv_usec = 0;
-      ru.ru_stime.tv_sec = 0;
-      ru.ru_stime.tv_usec = 0;
-    }
-    chpl_dprintf (chpl_vdebug_fd, "Pause: %lld.%06ld %ld.%06ld %ld.%06ld %d %s %d\n",
-                  (long long) tv.tv_sec, (long) tv.tv_usec,
-                  (long) ru.ru_utime.tv_sec, (long) ru.ru_utime.tv_usec,
-                  (long) ru.ru_stime.tv_sec, (long) ru.ru_stime.tv_usec,
-                  chpl_nodeID, TID_STRING(buff, pauseTask), tagno);
+    vdebug_init_rec (&rec, chpl_vdebug_rec_pause, chpl_nodeID, chpl_task_getId());
+    vdebug_set_times (&rec, tagno);
+    vdebug_flush_bufs (1);
+    vdebug_write_recs (&rec, 1, true);
+    vdebug_update_index ();
     chpl_vdebug = 0;
   }
 }
 
 // Routines to log data ... put here so other places can
 // just call this code to get things logged.
-// FIXME: the size argument (size_t) is being cast to int here. chplvis needs
-//        to be updated to take in size_t. The elemsize field is no longer
-//        relevant as well.
 
-// Record>  nb_put: time.sec srcNodeId dstNodeId commTaskId addr raddr elemsize 
-//                  length lineNumber fileName
+// Record>  put, get, nb_put, nb_get: time.sec nodeId remoteNodeId
+//          commTaskId elemsize length commID lineNumber fileName
 //
+// Note: for gets, nodeId is the node requesting the get
+
+static void vdebug_comm (chpl_vdebug_rec_kind_t kind,
+                         const chpl_comm_cb_info_t *info) {
+  const struct chpl_comm_info_comm *cm = &info->iu.comm;
+  chpl_vdebug_rec_t rec;
+  vdebug_init_rec (&rec, kind, info->localNodeID, chpl_task_getId());
+  rec.lineno = cm->lineno;
+  rec.u.comm.remoteNodeID = info->remoteNodeID;
+  rec.u.comm.commID = cm->commID;
+  rec.u.comm.fileno = cm->filename;
+  rec.u.comm.elemSize = 1;
+  rec.u.comm.length = cm->size;
+  vdebug_put_comm_rec (&rec, kind == chpl_vdebug_rec_get_nb
+                             || kind == chpl_vdebug_rec_get, cm->size);
+}
 
 void cb_comm_put_nb (const chpl_comm_cb_info_t *info) {
-  if (chpl_vdebug) {
-    struct timeval tv;
-    const struct chpl_comm_info_comm *cm = &info->iu.comm;
-    chpl_taskID_t commTask = chpl_task_getId();
-    char buff[CHPL_TASK_ID_STRING_MAX_LEN];
-    (void) gettimeofday (&tv, NULL);
-    chpl_dprintf (chpl_vdebug_fd, 
-                  VDEBUG_GETPUT_FORMAT_STRING, "nb_put",
-                  (long long) tv.tv_sec, (long) tv.tv_usec,  info->localNodeID,
-                  info->remoteNodeID, TID_STRING(buff, commTask), (unsigned long) cm->addr,
-                  (unsigned long) cm->raddr, (size_t)1, cm->size,
-                  cm->commID, cm->lineno, cm->filename);
-  }
+  if (chpl_vdebug)
+    vdebug_comm (chpl_vdebug_rec_put_nb, info);
 }
 
-// Record>  nb_get: time.sec dstNodeId srcNodeId commTaskId addr raddr elemsize 
-//                  length lineNumber fileName
-//
-// Note: dstNodeId is node requesting Get
-
 void cb_comm_get_nb (const chpl_comm_cb_info_t *info) {
-  if (chpl_vdebug) {
-    struct timeval tv;
-    const struct chpl_comm_info_comm *cm = &info->iu.comm;
-    chpl_taskID_t commTask = chpl_task_getId();
-    char buff[CHPL_TASK_ID_STRING_MAX_LEN];
-    (void) gettimeofday (&tv, NULL);
-    chpl_dprintf (chpl_vdebug_fd,
-                  VDEBUG_GETPUT_FORMAT_STRING, "nb_get",
-                  (long long) tv.tv_sec, (long) tv.tv_usec,  info->localNodeID,
-                  info->remoteNodeID, TID_STRING(buff, commTask), (unsigned long) cm->addr,
-                  (unsigned long) cm->raddr, (size_t)1, cm->size,
-                  cm->commID, cm->lineno, cm->filename);
-  }
+  if (chpl_vdebug)
+    vdebug_comm (chpl_vdebug_rec_get_nb, info);
 }
 
-// Record>  put: time.sec srcNodeId dstNodeId commTaskId addr raddr elemsize 
-//               length lineNumber fileName
-
-
 void cb_comm_put (const chpl_comm_cb_info_t *info) {
-  if (chpl_vdebug) {
-    struct timeval tv;
-    const struct chpl_comm_info_comm *cm = &info->iu.comm;
-    chpl_taskID_t commTask = chpl_task_getId();
-    char buff[CHPL_TASK_ID_STRING_MAX_LEN];
-    (void) gettimeofday (&tv, NULL);
-    chpl_dprintf (chpl_vdebug_fd,
-                  VDEBUG_GETPUT_FORMAT_STRING, "put",
-                  (long long) tv.tv_sec, (long) tv.tv_usec, info->localNodeID,
-                  info->remoteNodeID, TID_STRING(buff, commTask), (unsigned long) cm->addr,
-                  (unsigned long) cm->raddr, (size_t)1, cm->size,
-                  cm->commID, cm->lineno, cm->filename);
-  }
+  if (chpl_vdebug)
+    vdebug_comm (chpl_vdebug_rec_put, info);
 }
 
-// Record>  get: time.sec dstNodeId srcNodeId commTaskId addr raddr elemsize 
-//               length lineNumber fileName
-//
-// Note:  dstNodeId is for the node making the request
-
 void cb_comm_get (const chpl_comm_cb_info_t *info) {
-  if (chpl_vdebug) {
-    struct timeval tv;
-    const struct chpl_comm_info_comm *cm = &info->iu.comm;
-    chpl_taskID_t commTask = chpl_task_getId();
-    char buff[CHPL_TASK_ID_STRING_MAX_LEN];
-    (void) gettimeofday (&tv, NULL);
-    chpl_dprintf (chpl_vdebug_fd,
-                  VDEBUG_GETPUT_FORMAT_STRING, "get",
-                  (long long) tv.tv_sec, (long) tv.tv_usec,  info->localNodeID,
-                  info->remoteNodeID, TID_STRING(buff, commTask), (unsigned long) cm->addr,
-                  (unsigned long) cm->raddr, (size_t)1, cm->size,
-                  cm->commID, cm->lineno, cm->filename);
-  }
+  if (chpl_vdebug)
+    vdebug_comm (chpl_vdebug_rec_get, info);
 }
 
-// Record>  st_put: time.sec srcNodeId dstNodeId commTaskId addr raddr elemsize 
-//                  length lineNumber fileName
+// Record>  st_put, st_get: time.sec nodeId remoteNodeId commTaskId
+//          elemsize length commID lineNumber fileName
+//
+// length is the number of elements moved
 
-void cb_comm_put_strd (const chpl_comm_cb_info_t *info) {
-    if (chpl_vdebug) {
-    struct timeval tv;
-    size_t length;
-    const struct chpl_comm_info_comm_strd *cm = &info->iu.comm_strd;
-    chpl_taskID_t commTask = chpl_task_getId();
-    char buff[CHPL_TASK_ID_STRING_MAX_LEN];
-    (void) gettimeofday (&tv, NULL);
-
-    length = 1;
-    for (int32_t i = 0; i < cm->stridelevels; i++) {
-      length *= cm->count[i];
-    }
+static void vdebug_comm_strd (chpl_vdebug_rec_kind_t kind,
+                              const chpl_comm_cb_info_t *info) {
+  const struct chpl_comm_info_comm_strd *cm = &info->iu.comm_strd;
+  chpl_vdebug_rec_t rec;
+  size_t length = 1;
 
-    chpl_dprintf (chpl_vdebug_fd,
-                  VDEBUG_GETPUT_FORMAT_STRING, "st_put",
-                  (long long) tv.tv_sec, (long) tv.tv_usec,  info->localNodeID, 
-                  info->remoteNodeID, TID_STRING(buff, commTask),
-                  (unsigned long) cm->srcaddr, (unsigned long) cm->dstaddr, cm->elemSize,
-                  length, cm->commID, cm->lineno, cm->filename);
-    // printout srcstrides and dststrides and stridelevels and count?
+  for (int32_t i = 0; i < cm->stridelevels; i++) {
+    length *= cm->count[i];
   }
 
+  vdebug_init_rec (&rec, kind, info->localNodeID, chpl_task_getId());
+  rec.lineno = cm->lineno;
+  rec.u.comm.remoteNodeID = info->remoteNodeID;
+  rec.u.comm.commID = cm->commID;
+  rec.u.comm.fileno = cm->filename;
+  rec.u.comm.elemSize = cm->elemSize;
+  rec.u.comm.length = length;
+  vdebug_put_comm_rec (&rec, kind == chpl_vdebug_rec_get_strd,
+                       length * cm->elemSize);
 }
 
-// Record>  st_get: time.sec dstNodeId srcNodeId commTaskId addr raddr elemsize 
-//                  length lineNumber fileName
-//
-// Note:  dstNode is node making request for get
+void cb_comm_put_strd (const chpl_comm_cb_info_t *info) {
+  if (chpl_vdebug)
+    vdebug_comm_strd (chpl_vdebug_rec_put_strd, info);
+}
 
 void cb_comm_get_strd (const chpl_comm_cb_info_t *info) {
-  if (chpl_vdebug) {
-    struct timeval tv;
-    size_t length;
-    const struct chpl_comm_info_comm_strd *cm = &info->iu.comm_strd;
-    chpl_taskID_t commTask = chpl_task_getId();
-    char buff[CHPL_TASK_ID_STRING_MAX_LEN];
-    (void) gettimeofday (&tv, NULL);
-
-    length = 1;
-    for (int32_t i = 0; i < cm->stridelevels; i++) {
-      length *= cm->count[i];
-    }
-
-    chpl_dprintf (chpl_vdebug_fd,
-                  VDEBUG_GETPUT_FORMAT_STRING, "st_get",
-                  (long long) tv.tv_sec, (long) tv.tv_usec, info->localNodeID,
-                  info->remoteNodeID, TID_STRING(buff, commTask),
-                  (unsigned long) cm->dstaddr, (unsigned long) cm->srcaddr, cm->elemSize,
-                  length, cm->commID, cm->lineno, cm->filename);
-    // print out the srcstrides and dststrides and stridelevels and count?
-  }
+  if (chpl_vdebug)
+    vdebug_comm_strd (chpl_vdebug_rec_get_strd, info);
 }
 
-// Record>  fork: time.sec nodeId forkNodeId subLoc funcId arg argSize forkTaskId lineNumber fileName
+// Record>  fork, fork_nb, f_fork: time.sec nodeId forkNodeId subLoc funcId
+//          argSize forkTaskId lineNumber fileName
+
+static void vdebug_fork (chpl_vdebug_rec_kind_t kind,
+                         const chpl_comm_cb_info_t *info) {
+  const struct chpl_comm_info_comm_executeOn *cm = &info->iu.executeOn;
+  chpl_vdebug_rec_t rec;
+  vdebug_init_rec (&rec, kind, info->localNodeID, chpl_task_getId());
+  rec.subloc = cm->subloc;
+  rec.lineno = cm->lineno;
+  rec.u.fork.remoteNodeID = info->remoteNodeID;
+  rec.u.fork.fid = cm->fid;
+  rec.u.fork.fileno = cm->filename;
+  rec.u.fork.argSize = cm->arg_size;
+  vdebug_put_rec (&rec);
+}
 
 void cb_comm_executeOn (const chpl_comm_cb_info_t *info) {
-
-  // Visual Debug Support
-  if (chpl_vdebug) {
-    const struct chpl_comm_info_comm_executeOn *cm = &info->iu.executeOn;
-    chpl_taskID_t executeOnTask = chpl_task_getId();
-    char buff[CHPL_TASK_ID_STRING_MAX_LEN];
-    struct timeval tv;
-    (void) gettimeofday (&tv, NULL);
-    chpl_dprintf (chpl_vdebug_fd,
-                  "fork: %lld.%06ld %d %d %d %d %#lx %zd %s %d %d\n",
-                  (long long) tv.tv_sec, (long) tv.tv_usec, info->localNodeID,
-                  info->remoteNodeID, cm->subloc, cm->fid, (unsigned long) cm->arg,
-                  cm->arg_size, TID_STRING(buff, executeOnTask),
-                  cm->lineno, cm->filename);
-  }
+  if (chpl_vdebug)
+    vdebug_fork (chpl_vdebug_rec_fork, info);
 }
 
-// Record>  fork_nb: time.sec nodeId forkNodeId subLoc funcId arg argSize forkTaskId lineNumber fileName
-
-
 void  cb_comm_executeOn_nb (const chpl_comm_cb_info_t *info) {
-  if (chpl_vdebug) {
-    const struct chpl_comm_info_comm_executeOn *cm = &info->iu.executeOn;
-    chpl_taskID_t executeOnTask = chpl_task_getId();
-    char buff[CHPL_TASK_ID_STRING_MAX_LEN];
-    struct timeval tv;
-    (void) gettimeofday (&tv, NULL);
-    chpl_dprintf (chpl_vdebug_fd, "fork_nb: %lld.%06ld %d %d %d %d %#lx %zd %s %d %d\n",
-                  (long long) tv.tv_sec, (long) tv.tv_usec, info->localNodeID,
-                  info->remoteNodeID, cm->subloc, cm->fid, (unsigned long) cm->arg, 
-                  cm->arg_size, TID_STRING(buff, executeOnTask),
-                  cm->lineno, cm->filename);
-  }
+  if (chpl_vdebug)
+    vdebug_fork (chpl_vdebug_rec_fork_nb, info);
 }
 
-// Record>  f_fork: time.sec nodeId forkNodeId subLoc funcId arg argSize forkTaskId lineNumber fileName
-
 void cb_comm_executeOn_fast (const chpl_comm_cb_info_t *info) {
-  if (chpl_vdebug) {
-    const struct chpl_comm_info_comm_executeOn *cm = &info->iu.executeOn;
-    chpl_taskID_t executeOnTask = chpl_task_getId();
-    char buff[CHPL_TASK_ID_STRING_MAX_LEN];
-    struct timeval tv;
-    (void) gettimeofday (&tv, NULL);
-    chpl_dprintf (chpl_vdebug_fd,
-                  "f_fork: %lld.%06ld %d %d %d %d %#lx %zd %s %d %d\n",
-                  (long long) tv.tv_sec, (long) tv.tv_usec, info->localNodeID,
-                  info->remoteNodeID, cm->subloc, cm->fid, (unsigned long)cm->arg, 
-                  cm->arg_size, TID_STRING(buff, executeOnTask),
-                  cm->lineno, cm->filename);
-  }
+  if (chpl_vdebug)
+    vdebug_fork (chpl_vdebug_rec_fork_fast, info);
 }
 
 
@@ -599,50 +800,39 @@ int uninstall_callbacks (void) {
 // Record>  task: time.sec nodeId taskId parentTaskId On/Local lineNum srcName fid
 
 void cb_task_create (const chpl_task_cb_info_t *info) {
-  struct timeval tv;
+  chpl_vdebug_rec_t rec;
   if (!chpl_vdebug) return;
   if (chpl_vdebug_fd >= 0) {
-    chpl_taskID_t taskId = chpl_task_getId();
-    char buff[CHPL_TASK_ID_STRING_MAX_LEN];
-    //printf ("taskCB: event: %d, node %d proc %s task id: %llu, new task id: %llu\n",
-    //         (int)info->event_kind, (int)info->nodeID,
-    //        (info->iu.full.is_executeOn ? "O" : "L"), taskId, info->iu.full.id);
-    (void)gettimeofday(&tv, NULL);
-    chpl_dprintf (chpl_vdebug_fd, "task: %lld.%06ld %lld %ld %s %s %ld %d %d\n",
-                  (long long) tv.tv_sec, (long) tv.tv_usec,
-                  (long long) info->nodeID, (long int) info->iu.full.id,
-                  TID_STRING(buff, taskId),
-                  (info->iu.full.is_executeOn ? "O" : "L"),
-                  (long int) info->iu.full.lineno,
-                  info->iu.full.filename,
-                  info->iu.full.fid);
-   }
+    vdebug_init_rec (&rec, chpl_vdebug_rec_task, info->nodeID, info->iu.full.id);
+    rec.isOn = info->iu.full.is_executeOn ? 1 : 0;
+    rec.lineno = info->iu.full.lineno;
+    rec.u.task.parentID = (int64_t) chpl_task_getId();
+    rec.u.task.fileno = info->iu.full.filename;
+    rec.u.task.fid = info->iu.full.fid;
+    vdebug_put_rec (&rec);
+  }
 }
 
 // Record>  Btask: time.sec nodeId taskId
 
 void cb_task_begin (const chpl_task_cb_info_t *info) {
-  struct timeval tv;
+  chpl_vdebug_rec_t rec;
   if (!chpl_vdebug) return;
   if (chpl_vdebug_fd >= 0) {
-    (void)gettimeofday(&tv, NULL);
-    chpl_dprintf (chpl_vdebug_fd, "Btask: %lld.%06ld %lld %lu\n",
-                  (long long) tv.tv_sec, (long) tv.tv_usec,
-                  (long long) info->nodeID, (unsigned long) info->iu.full.id);
- 
+    vdebug_init_rec (&rec, chpl_vdebug_rec_begin_task, info->nodeID,
+                     info->iu.full.id);
+    vdebug_put_rec (&rec);
   }
 }
 
 // Record>  Etask: time.sec nodeId taskId
 
 void cb_task_end (const chpl_task_cb_info_t *info) {
-  struct timeval tv;
+  chpl_vdebug_rec_t rec;
   if (!chpl_vdebug) return;
   if (chpl_vdebug_fd >= 0) {
-    (void)gettimeofday(&tv, NULL);
-    chpl_dprintf (chpl_vdebug_fd, "Etask: %lld.%06ld %lld %lu\n",
-                  (long long) tv.tv_sec, (long) tv.tv_usec,
-                  (long long) info->nodeID, (unsigned long) info->iu.id_only.id);
- 
+    vdebug_init_rec (&rec, chpl_vdebug_rec_end_task, info->nodeID,
+                     info->iu.id_only.id);
+    vdebug_put_rec (&rec);
   }
 }
@@ -21,26 +21,38 @@
 #include "chplrt.h"
 
 #include "chpl_rt_utils_static.h"
+#include "chpl-cache.h"
 #include "chpl-comm.h"
+#include "chpl-comm-diags.h"
+#include "chpl-comm-trace.h"
 #include "chplexit.h"
+#include "chpl-locks.h"
 #include "chpl-mem.h"
 #include "chplmemtrack.h"
 #include "chpl-topo.h"
 #include "gdb.h"
+#include "qio_linebuf.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 
 static void chpl_exit_common(int status, int all) {
+  qio_linebuf_flush_all();
   fflush(stdout);
   fflush(stderr);
   if (status != 0) {
     gdbShouldBreakHere();
   }
+  chpl_comm_trace_stop();
   chpl_comm_pre_task_exit(all);
   if (all) {
+    chpl_comm_diags_counts_report();
     chpl_task_exit();
+#ifdef HAS_CHPL_CACHE_FNS
+    chpl_cache_print_site_stats();
+#endif
     chpl_reportMemInfo();
+    chpl_lock_prof_report();
   }
   chpl_comm_exit(all, status);
   if (all) {
@@ -23,16 +23,19 @@
 #include "chplmemtrack.h"
 #include "chpl-mem.h"
 #include "chpl-mem-desc.h"
+#include "chpl-mem-sample.h"
 #include "chpl-mem-sys.h"  // mem layer not initialized yet, need system alloc
 #include "chpl-tasks.h"
 #include "chpltypes.h"
 #include "chpl-comm.h"
 #include "chpl-comm-internal.h"
+#include "chpl-env.h"
 #include "chplcgfns.h"
 #include "chpl-linefile-support.h"
 #include "config.h"
 #include "error.h"
 
+#include "chpl-atomics.h"
 #include "chpl-comm-compiler-macros.h"
 
 #include <assert.h>
@@ -43,6 +46,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <inttypes.h>
+#include <time.h>
 
 int chpl_verbose_mem = 0;
 int chpl_memTrack = 0;
@@ -81,10 +85,31 @@ static int hashSizes[NUM_HASH_SIZE_INDICES] = { 1543, 3079, 6151, 12289, 24593,
                                                 196613, 393241, 786433, 1572869, 3145739,
                                                 6291469, 12582917, 25165843, 50331653,
                                                 100663319, 201326611, 402653189, 805306457 };
-static int hashSizeIndex = 0;
-static int hashSize = 0;
+//
+// The table is split into shards by address, each with its own lock,
+// so that tracking from many threads doesn't all serialize on one.
+// A shard resizes incrementally: when it grows or shrinks it keeps its
+// old bucket array, and each later operation on the shard moves a few
+// of the old buckets over until none are left.  Until then, lookups
+// check both.
+//
+#define NUM_MEM_SHARDS 64
+#define MIGRATE_BUCKETS 16
 
-static memTableEntry** memTable = NULL;
+typedef struct {
+  pthread_mutex_t lock;
+  memTableEntry** table;
+  int hashSizeIndex;
+  int hashSize;
+  memTableEntry** oldTable;       // being migrated from, or NULL
+  int oldHashSize;
+  int oldMigrated;                // old buckets [0, oldMigrated) moved
+  size_t entries;
+  size_t allocated;               // sum of allocations in this shard
+  size_t freed;                   // sum of frees in this shard
+} memShard;
+
+static memShard memShards[NUM_MEM_SHARDS];
 
 static _Bool memStats = false;
 static _Bool memLeaksByType = false;
@@ -96,11 +121,39 @@ static c_string memLog = NULL;
 static FILE* memLogFile = NULL;
 static c_string memLeaksLog = NULL;
 
-static size_t totalMem = 0;       /* total memory currently allocated */
-static size_t maxMem = 0;         /* maximum total memory during run  */
-static size_t totalAllocated = 0; /* total memory allocated */
-static size_t totalFreed = 0;     /* total memory freed */
-static size_t totalEntries = 0;     /* number of entries in hash table */
+static atomic_uint_least64_t totalMem;  /* total memory currently allocated */
+static atomic_uint_least64_t maxMem;    /* maximum total memory during run  */
+
+//
+// Per-descriptor usage: what's allocated now, the most there ever was
+// and when (in ns since tracking started), and what each descriptor
+// had when the overall total last reached a new high.  That last one
+// is only re-snapshotted when the high grows by 1/64 or more, to keep
+// it cheap while memory use is ramping up.
+//
+typedef struct {
+  atomic_uint_least64_t cur;
+  atomic_uint_least64_t peak;
+  atomic_uint_least64_t peakTime;
+  size_t atMaxMem;
+} descUsage;
+
+static int numDescUsages;
+static descUsage* descUsages;
+static uint64_t atMaxMemTotal;
+static uint64_t atMaxMemTime;
+static pthread_mutex_t atMaxMemLock = PTHREAD_MUTEX_INITIALIZER;
+static struct timespec memTrackStart;
+
+//
+// The optional timeline sampler (CHPL_RT_MEM_TIMELINE=<file>) writes
+// the per-descriptor usage to a CSV file every
+// CHPL_RT_MEM_TIMELINE_INTERVAL_MS milliseconds (default 100).
+//
+static FILE* timelineFile;
+static pthread_t timelineThread;
+static volatile int timelineStop;
+static int64_t timelineIntervalMs;
 
 
 // We can't use a sync var for concurrency control here.  The Qthreads
@@ -109,25 +162,129 @@ static size_t totalEntries = 0;     /* number of entries in hash table */
 // sync var here when exiting (to report memTrack results, say), after
 // the tasking layer is shut down, ends up trying to create a qthread in
 // the terminated Qthreads library.  Chaos results.  We also cannot use
-// an atomic var, because with CHPL_ATOMICS=locks those are implemented
-// by means of sync vars.  So, we use a pthread mutex.  Note that this
-// is only safe if we cannot switch tasks on a pthread while holding the
-// mutex and then try to lock it recursively.  Currently that is the
-// case, since we do not yield while holding the mutex.
-// 
-static pthread_mutex_t memTrack_lockVar = PTHREAD_MUTEX_INITIALIZER;
+// a Chapel atomic var, because with CHPL_ATOMICS=locks those are
+// implemented by means of sync vars.  So, we use pthread mutexes, one
+// per shard, and the runtime's own C atomics for the totals.  Note
+// that this is only safe if we cannot switch tasks on a pthread while
+// holding a mutex and then try to lock it recursively.  Currently that
+// is the case, since we do not yield while holding one.
+//
+static inline
+memShard* shardFor(void* memAlloc) {
+  uint64_t u = (uint64_t) (uintptr_t) memAlloc;
+  return &memShards[((u >> 4) ^ (u >> 12) ^ (u >> 20)) % NUM_MEM_SHARDS];
+}
+
+static inline
+void memShard_lock(memShard* sh) {
+  (void) pthread_mutex_lock(&sh->lock);
+}
+
+static inline
+void memShard_unlock(memShard* sh) {
+  (void) pthread_mutex_unlock(&sh->lock);
+}
 
+// Allocation and free lock just the shard for the address.
 static inline
-void memTrack_lock(void) {
-  (void) pthread_mutex_lock(&memTrack_lockVar);
+void memTrack_lock(void* memAlloc) {
+  memShard_lock(shardFor(memAlloc));
 }
 
 static inline
-void memTrack_unlock(void) {
-  (void) pthread_mutex_unlock(&memTrack_lockVar);
+void memTrack_unlock(void* memAlloc) {
+  memShard_unlock(shardFor(memAlloc));
+}
+
+// The reports lock every shard, in order, to see a consistent table.
+static void memTrack_lockAll(void) {
+  for (int i = 0; i < NUM_MEM_SHARDS; i++)
+    memShard_lock(&memShards[i]);
+}
+
+static void memTrack_unlockAll(void) {
+  for (int i = NUM_MEM_SHARDS - 1; i >= 0; i--)
+    memShard_unlock(&memShards[i]);
+}
+
+
+
+static uint64_t memTrackTime(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) (ts.tv_sec - memTrackStart.tv_sec) * 1000000000
+         + ts.tv_nsec - memTrackStart.tv_nsec;
+}
+
+
+static void* timelineFn(void* arg) {
+  struct timespec ts;
+
+  ts.tv_sec = timelineIntervalMs / 1000;
+  ts.tv_nsec = (timelineIntervalMs % 1000) * 1000000;
+  while (!timelineStop) {
+    (void) nanosleep(&ts, NULL);
+    fprintf(timelineFile, "%.3f,%" PRIu64,
+            memTrackTime() / 1e9, atomic_load_uint_least64_t(&totalMem));
+    for (int i = 0; i < numDescUsages; i++)
+      fprintf(timelineFile, ",%" PRIu64,
+              atomic_load_uint_least64_t(&descUsages[i].cur));
+    fprintf(timelineFile, "\n");
+  }
+  return NULL;
+}
+
+
+static void startTimeline(void) {
+  const char* name;
+  char* filename;
+
+  if ((name = chpl_env_rt_get("MEM_TIMELINE", NULL)) == NULL)
+    return;
+  if (!chpl_memTrack) {
+    chpl_warning("CHPL_RT_MEM_TIMELINE needs memory tracking; "
+                 "rerun with --memTrack", 0, 0);
+    return;
+  }
+
+  filename = (char*)sys_malloc((strlen(name)+10)*sizeof(char));
+  if (chpl_numNodes == 1)
+    strcpy(filename, name);
+  else
+    sprintf(filename, "%s.%" PRI_c_nodeid_t, name, chpl_nodeID);
+  timelineFile = fopen(filename, "w");
+  sys_free(filename);
+  if (timelineFile == NULL) {
+    chpl_warning("cannot open the CHPL_RT_MEM_TIMELINE file", 0, 0);
+    return;
+  }
+
+  fprintf(timelineFile, "time_s,total");
+  for (int i = 0; i < numDescUsages; i++)
+    fprintf(timelineFile, ",%s", chpl_mem_descString(i));
+  fprintf(timelineFile, "\n");
+
+  timelineIntervalMs = chpl_env_rt_get_int("MEM_TIMELINE_INTERVAL_MS", 100);
+  if (timelineIntervalMs < 1)
+    timelineIntervalMs = 1;
+  timelineStop = 0;
+  if (pthread_create(&timelineThread, NULL, timelineFn, NULL) != 0) {
+    chpl_warning("cannot start the memory timeline thread", 0, 0);
+    fclose(timelineFile);
+    timelineFile = NULL;
+  }
 }
 
 
+static void stopTimeline(void) {
+  if (timelineFile == NULL)
+    return;
+  timelineStop = 1;
+  (void) pthread_join(timelineThread, NULL);
+  fclose(timelineFile);
+  timelineFile = NULL;
+}
+
 
 void chpl_setMemFlags(void) {
   chpl_bool local_memTrack = false;
@@ -179,11 +336,30 @@ void chpl_setMemFlags(void) {
     }
   }
 
+  atomic_init_uint_least64_t(&totalMem, 0);
+  atomic_init_uint_least64_t(&maxMem, 0);
   if (chpl_memTrack) {
-    hashSizeIndex = 0;
-    hashSize = hashSizes[hashSizeIndex];
-    memTable = sys_calloc(hashSize, sizeof(memTableEntry*));
+    for (int i = 0; i < NUM_MEM_SHARDS; i++) {
+      memShard* sh = &memShards[i];
+      (void) pthread_mutex_init(&sh->lock, NULL);
+      sh->hashSizeIndex = 0;
+      sh->hashSize = hashSizes[sh->hashSizeIndex];
+      sh->table = sys_calloc(sh->hashSize, sizeof(memTableEntry*));
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &memTrackStart);
+    numDescUsages = CHPL_RT_MD_NUM + chpl_mem_numDescs;
+    descUsages = sys_calloc(numDescUsages, sizeof(descUsages[0]));
+    for (int i = 0; i < numDescUsages; i++) {
+      atomic_init_uint_least64_t(&descUsages[i].cur, 0);
+      atomic_init_uint_least64_t(&descUsages[i].peak, 0);
+      atomic_init_uint_least64_t(&descUsages[i].peakTime, 0);
+    }
   }
+
+  startTimeline();
+
+  chpl_mem_sample_init();
 }
 
 
@@ -199,58 +375,116 @@ static unsigned hash(void* memAlloc, int hashSize) {
 }
 
 
-static void increaseMemStat(size_t chunk, int32_t lineno, int32_t filename) {
-  totalMem += chunk;
-  totalAllocated += chunk;
-  if (memMax && (totalMem > memMax)) {
+// Record which descriptors make up a new overall high.
+static void snapshotAtMaxMem(uint64_t now) {
+  pthread_mutex_lock(&atMaxMemLock);
+  if (now >= atMaxMemTotal + atMaxMemTotal / 64) {
+    atMaxMemTotal = now;
+    atMaxMemTime = memTrackTime();
+    for (int i = 0; i < numDescUsages; i++)
+      descUsages[i].atMaxMem = atomic_load_uint_least64_t(&descUsages[i].cur);
+  }
+  pthread_mutex_unlock(&atMaxMemLock);
+}
+
+
+static void increaseMemStat(memShard* sh, size_t chunk,
+                            chpl_mem_descInt_t description,
+                            int32_t lineno, int32_t filename) {
+  uint64_t now = atomic_fetch_add_uint_least64_t(&totalMem, chunk) + chunk;
+  uint64_t max = atomic_load_uint_least64_t(&maxMem);
+  sh->allocated += chunk;
+  if (memMax && (now > memMax)) {
     chpl_error("Exceeded memory limit", lineno, filename);
   }
-  if (totalMem > maxMem)
-    maxMem = totalMem;
+
+  if (description >= 0 && description < numDescUsages) {
+    descUsage* du = &descUsages[description];
+    uint64_t dcur = atomic_fetch_add_uint_least64_t(&du->cur, chunk) + chunk;
+    uint64_t dpeak = atomic_load_uint_least64_t(&du->peak);
+    while (dcur > dpeak) {
+      if (atomic_compare_exchange_strong_uint_least64_t(&du->peak, &dpeak,
+                                                         dcur)) {
+        atomic_store_uint_least64_t(&du->peakTime, memTrackTime());
+        break;
+      }
+    }
+  }
+
+  while (now > max) {
+    if (atomic_compare_exchange_strong_uint_least64_t(&maxMem, &max, now)) {
+      if (now >= atMaxMemTotal + atMaxMemTotal / 64)
+        snapshotAtMaxMem(now);
+      break;
+    }
+  }
 }
 
 
-static void decreaseMemStat(size_t chunk) {
-  totalMem -= chunk; // > totalMem ? 0 : totalMem - chunk;
-  totalFreed += chunk;
+static void decreaseMemStat(memShard* sh, size_t chunk,
+                            chpl_mem_descInt_t description) {
+  (void) atomic_fetch_sub_uint_least64_t(&totalMem, chunk);
+  sh->freed += chunk;
+  if (description >= 0 && description < numDescUsages)
+    (void) atomic_fetch_sub_uint_least64_t(&descUsages[description].cur,
+                                           chunk);
 }
 
 
+// Start moving a shard to a bigger or smaller bucket array.
 static void
-resizeTable(int direction) {
-  memTableEntry** newMemTable = NULL;
-  int newHashSizeIndex, newHashSize, newHashValue;
-  int i;
+startResize(memShard* sh, int direction) {
+  sh->oldTable = sh->table;
+  sh->oldHashSize = sh->hashSize;
+  sh->oldMigrated = 0;
+
+  sh->hashSizeIndex += direction;
+  sh->hashSize = hashSizes[sh->hashSizeIndex];
+  sh->table = sys_calloc(sh->hashSize, sizeof(memTableEntry*));
+}
+
+
+// Move a few more of a shard's old buckets, if it's resizing.
+static void
+continueResize(memShard* sh) {
   memTableEntry* me;
   memTableEntry* next;
+  int i, end;
 
-  newHashSizeIndex = hashSizeIndex + direction;
-  newHashSize = hashSizes[newHashSizeIndex];
-  newMemTable = sys_calloc(newHashSize, sizeof(memTableEntry*));
+  if (sh->oldTable == NULL)
+    return;
 
-  for (i = 0; i < hashSize; i++) {
-    for (me = memTable[i]; me != NULL; me = next) {
+  end = sh->oldMigrated + MIGRATE_BUCKETS;
+  if (end > sh->oldHashSize)
+    end = sh->oldHashSize;
+  for (i = sh->oldMigrated; i < end; i++) {
+    for (me = sh->oldTable[i]; me != NULL; me = next) {
+      unsigned newHashValue = hash(me->memAlloc, sh->hashSize);
       next = me->nextInBucket;
-      newHashValue = hash(me->memAlloc, newHashSize);
-      me->nextInBucket = newMemTable[newHashValue];
-      newMemTable[newHashValue] = me;
+      me->nextInBucket = sh->table[newHashValue];
+      sh->table[newHashValue] = me;
     }
+    sh->oldTable[i] = NULL;
   }
+  sh->oldMigrated = end;
 
-  sys_free(memTable);
-  memTable = newMemTable;
-  hashSize = newHashSize;
-  hashSizeIndex = newHashSizeIndex;
+  if (sh->oldMigrated == sh->oldHashSize) {
+    sys_free(sh->oldTable);
+    sh->oldTable = NULL;
+  }
 }
 
 static void addMemTableEntry(void *memAlloc, size_t number, size_t size,
                              chpl_mem_descInt_t description, int32_t lineno,
                              int32_t filename) {
+  memShard* sh = shardFor(memAlloc);
   unsigned hashValue;
   memTableEntry* memEntry;
 
-  if ((totalEntries+1)*2 > hashSize && hashSizeIndex < NUM_HASH_SIZE_INDICES-1)
-    resizeTable(1);
+  continueResize(sh);
+  if (sh->oldTable == NULL && (sh->entries+1)*2 > sh->hashSize
+      && sh->hashSizeIndex < NUM_HASH_SIZE_INDICES-1)
+    startResize(sh, 1);
 
   memEntry = (memTableEntry*) sys_calloc(1, sizeof(memTableEntry));
   if (!memEntry) {
@@ -258,54 +492,84 @@ static void addMemTableEntry(void *memAlloc, size_t number, size_t size,
                lineno, filename);
   }
 
-  hashValue = hash(memAlloc, hashSize);
-  memEntry->nextInBucket = memTable[hashValue];
-  memTable[hashValue] = memEntry;
+  hashValue = hash(memAlloc, sh->hashSize);
+  memEntry->nextInBucket = sh->table[hashValue];
+  sh->table[hashValue] = memEntry;
   memEntry->description = description;
   memEntry->memAlloc = memAlloc;
   memEntry->lineno = lineno;
   memEntry->filename = filename;
   memEntry->number = number;
   memEntry->size = size;
-  increaseMemStat(number*size, lineno, filename);
-  totalEntries += 1;
+  increaseMemStat(sh, number*size, description, lineno, filename);
+  sh->entries += 1;
 }
 
 
-static memTableEntry* removeMemTableEntry(void* address) {
-  unsigned hashValue = hash(address, hashSize);
-  memTableEntry* thisBucketEntry = memTable[hashValue];
-  memTableEntry* deletedBucket = NULL;
+// Unlink and return the entry for address from one bucket, if it's there.
+static memTableEntry* removeFromBucket(memTableEntry** bucket,
+                                       void* address) {
+  memTableEntry** pme;
+  memTableEntry* me;
 
-  if (!thisBucketEntry)
-    return NULL;
+  for (pme = bucket; (me = *pme) != NULL; pme = &me->nextInBucket) {
+    if (me->memAlloc == address) {
+      *pme = me->nextInBucket;
+      return me;
+    }
+  }
+  return NULL;
+}
 
-  if (thisBucketEntry->memAlloc == address) {
-    memTable[hashValue] = thisBucketEntry->nextInBucket;
-    deletedBucket = thisBucketEntry;
-  } else {
-    for (thisBucketEntry = memTable[hashValue];
-         thisBucketEntry != NULL;
-         thisBucketEntry = thisBucketEntry->nextInBucket) {
 
-      memTableEntry* nextBucketEntry = thisBucketEntry->nextInBucket;
+static memTableEntry* removeMemTableEntry(void* address) {
+  memShard* sh = shardFor(address);
+  memTableEntry* deletedBucket;
 
-      if (nextBucketEntry && nextBucketEntry->memAlloc == address) {
-        thisBucketEntry->nextInBucket = nextBucketEntry->nextInBucket;
-        deletedBucket = nextBucketEntry;
-      }
-    }
+  continueResize(sh);
+
+  deletedBucket = removeFromBucket(&sh->table[hash(address, sh->hashSize)],
+                                   address);
+  if (!deletedBucket && sh->oldTable != NULL) {
+    unsigned oldHashValue = hash(address, sh->oldHashSize);
+    if (oldHashValue >= sh->oldMigrated)
+      deletedBucket = removeFromBucket(&sh->oldTable[oldHashValue], address);
   }
+
   if (deletedBucket) {
-    decreaseMemStat(deletedBucket->number * deletedBucket->size);
-    totalEntries -= 1;
-    if (totalEntries*8 < hashSize && hashSizeIndex > 0)
-      resizeTable(-1);
+    decreaseMemStat(sh, deletedBucket->number * deletedBucket->size,
+                    deletedBucket->description);
+    sh->entries -= 1;
+    if (sh->oldTable == NULL && sh->entries*8 < sh->hashSize
+        && sh->hashSizeIndex > 0)
+      startResize(sh, -1);
   }
   return deletedBucket;
 }
 
 
+//
+// Call fn on every table entry.  The caller holds all the shard locks.
+//
+static void forEachMemTableEntry(void (*fn)(memTableEntry*, void*),
+                                 void* arg) {
+  for (int s = 0; s < NUM_MEM_SHARDS; s++) {
+    memShard* sh = &memShards[s];
+    memTableEntry* me;
+    for (int i = 0; i < sh->hashSize; i++) {
+      for (me = sh->table[i]; me != NULL; me = me->nextInBucket)
+        fn(me, arg);
+    }
+    if (sh->oldTable != NULL) {
+      for (int i = sh->oldMigrated; i < sh->oldHashSize; i++) {
+        for (me = sh->oldTable[i]; me != NULL; me = me->nextInBucket)
+          fn(me, arg);
+      }
+    }
+  }
+}
+
+
 uint64_t chpl_memoryUsed(int32_t lineno, int32_t filename) {
   if (!chpl_memTrack) {
     chpl_warning("invalid call to memoryUsed(); rerun with --memTrack",
@@ -313,7 +577,7 @@ uint64_t chpl_memoryUsed(int32_t lineno, int32_t filename) {
     return 0;
   }
 
-  return (uint64_t)totalMem;
+  return atomic_load_uint_least64_t(&totalMem);
 }
 
 
@@ -348,14 +612,24 @@ void chpl_printMemAllocStats(int32_t lineno, int32_t filename) {
   // Take a pre-run through the descriptions and values to figure
   // out how long each line will need to be.
   //
-  static const struct {
+  size_t totalAllocated = 0;
+  size_t totalFreed = 0;
+
+  memTrack_lockAll();
+  for (int i = 0; i < NUM_MEM_SHARDS; i++) {
+    totalAllocated += memShards[i].allocated;
+    totalFreed += memShards[i].freed;
+  }
+  memTrack_unlockAll();
+
+  const struct {
     const char* desc;
-    size_t* val;
+    size_t val;
   } descsVals[] = {
-    { "Allocated Now:", &totalMem },
-    { "Allocation High Water Mark:", &maxMem },
-    { "Sum of Allocations:", &totalAllocated },
-    { "Sum of Frees:", &totalFreed },
+    { "Allocated Now:", atomic_load_uint_least64_t(&totalMem) },
+    { "Allocation High Water Mark:", atomic_load_uint_least64_t(&maxMem) },
+    { "Sum of Allocations:", totalAllocated },
+    { "Sum of Frees:", totalFreed },
   };
   const int nDescsVals = sizeof(descsVals) / sizeof(descsVals[0]);
 
@@ -367,9 +641,9 @@ void chpl_printMemAllocStats(int32_t lineno, int32_t filename) {
     if (thisDescWidth > descWidth)
       descWidth = thisDescWidth;
     const int thisMemWidth =
-                (*descsVals[i].val == 0)
+                (descsVals[i].val == 0)
                 ? 1
-                : (int) lrint(ceil(log10((double) *descsVals[i].val)));
+                : (int) lrint(ceil(log10((double) descsVals[i].val)));
     if (thisMemWidth > memWidth)
       memWidth = thisMemWidth;
   }
@@ -381,19 +655,15 @@ void chpl_printMemAllocStats(int32_t lineno, int32_t filename) {
   char buf[4 * (strlen(prefixBuf) + 1 + descWidth + 1 + memWidth + 1) + 1];
   size_t len;
 
-  memTrack_lock();
-
   len = 0;
   for (int i = 0; i < nDescsVals; i++) {
     len += snprintf(buf + len, sizeof(buf) - len,
                     "%s %-*s %*zd\n",
                     prefixBuf,
                     descWidth, descsVals[i].desc,
-                    memWidth, *descsVals[i].val);
+                    memWidth, descsVals[i].val);
   }
 
-  memTrack_unlock();
-
   fputs(buf, memLogFile);
 }
 
@@ -404,10 +674,17 @@ static int memTableEntryCmp(const void* p1, const void* p2) {
 }
 
 
+static void addToTypeTable(memTableEntry* me, void* arg) {
+  size_t* table = (size_t*) arg;
+  table[3*me->description] += me->number*me->size;
+  table[3*me->description+1] += 1;
+  table[3*me->description+2] = me->description;
+}
+
+
 static void printMemAllocsByType(_Bool forLeaks,
                                  int32_t lineno, int32_t filename) {
   size_t* table;
-  memTableEntry* me;
   int i;
   const int numberWidth   = 9;
   const int numEntries = CHPL_RT_MD_NUM+chpl_mem_numDescs;
@@ -421,13 +698,9 @@ static void printMemAllocsByType(_Bool forLeaks,
 
   table = (size_t*)sys_calloc(numEntries, 3*sizeof(size_t));
 
-  for (i = 0; i < hashSize; i++) {
-    for (me = memTable[i]; me != NULL; me = me->nextInBucket) {
-      table[3*me->description] += me->number*me->size;
-      table[3*me->description+1] += 1;
-      table[3*me->description+2] = me->description;
-    }
-  }
+  memTrack_lockAll();
+  forEachMemTableEntry(addToTypeTable, table);
+  memTrack_unlockAll();
 
   qsort(table, numEntries, 3*sizeof(size_t), memTableEntryCmp);
 
@@ -490,8 +763,8 @@ void chpl_printMemAllocsByDesc(const char* descString, int64_t threshold,
 
 
 static int descCmp(const void* p1, const void* p2) {
-  memTableEntry* m1 = *(memTableEntry**)p1;
-  memTableEntry* m2 = *(memTableEntry**)p2;
+  const memTableEntry* m1 = (const memTableEntry*)p1;
+  const memTableEntry* m2 = (const memTableEntry*)p2;
   c_string m1Filename;
   c_string m2Filename;
 
@@ -507,6 +780,32 @@ static int descCmp(const void* p1, const void* p2) {
 }
 
 
+// Count the entries selected by description (-1 for all) and threshold,
+// copying them into table, up to max of them, if there is a table.
+struct selectArgs {
+  chpl_mem_descInt_t description;
+  int64_t threshold;
+  memTableEntry* table;
+  int max;
+  int n;
+};
+
+static void selectMemTableEntry(memTableEntry* me, void* arg) {
+  struct selectArgs* sel = (struct selectArgs*) arg;
+  size_t chunk = me->number * me->size;
+  if (chunk < sel->threshold)
+    return;
+  if (sel->description != -1 && me->description != sel->description)
+    return;
+  if (sel->table != NULL) {
+    if (sel->n >= sel->max)
+      return;
+    sel->table[sel->n] = *me;
+  }
+  sel->n += 1;
+}
+
+
 // If description is -1, print all entries; otherwise print only those with the
 // matching CHPL_RT_MD_ descriptor.
 // Print only those entries exceeding threshold.
@@ -529,30 +828,50 @@ printMemAllocs(chpl_mem_descInt_t description, int64_t threshold,
   c_string memEntryFilename;
   int n, i;
   char* loc;
-  memTableEntry** table;
+  memTableEntry* table;
 
   if (!chpl_memTrack) {
+    if (chpl_mem_sample_interval > 0) {
+      // not tracking everything, but we can say what the samples show
+      chpl_mem_sample_print(memLogFile, description, threshold);
+      return;
+    }
     chpl_warning("invalid call to printMemAllocs(); rerun with --memTrack",
                  lineno, filename);
     return;
   }
 
-  n = 0;
+  //
+  // Count the entries to print, then copy them out, so that we don't
+  // hold the shard locks while printing.
+  //
+  struct selectArgs sel = { description, threshold, NULL, 0, 0 };
+
+  memTrack_lockAll();
+  forEachMemTableEntry(selectMemTableEntry, &sel);
+  memTrack_unlockAll();
+
+  n = sel.n;
+  table = (memTableEntry*)sys_malloc((n > 0 ? n : 1)*sizeof(memTableEntry));
+  if (!table)
+    chpl_error("out of memory printing memory table", lineno, filename);
+
+  sel.table = table;
+  sel.max = n;
+  sel.n = 0;
+  memTrack_lockAll();
+  forEachMemTableEntry(selectMemTableEntry, &sel);
+  memTrack_unlockAll();
+  n = sel.n;
+
   filenameWidth = strlen("Allocated Memory (Bytes)");
-  for (i = 0; i < hashSize; i++) {
-    for (memEntry = memTable[i]; memEntry != NULL; memEntry = memEntry->nextInBucket) {
-      size_t chunk = memEntry->number * memEntry->size;
-      if (chunk < threshold)
-        continue;
-      if (description != -1 && memEntry->description != description)
-        continue;
-      n += 1;
-      if (memEntry->filename) {
-        memEntryFilename = chpl_lookupFilename(memEntry->filename);
-        filenameLength = strlen(memEntryFilename);
-        if (filenameLength > filenameWidth)
-          filenameWidth = filenameLength;
-      }
+  for (i = 0; i < n; i++) {
+    memEntry = &table[i];
+    if (memEntry->filename) {
+      memEntryFilename = chpl_lookupFilename(memEntry->filename);
+      filenameLength = strlen(memEntryFilename);
+      if (filenameLength > filenameWidth)
+        filenameWidth = filenameLength;
     }
   }
 
@@ -579,27 +898,12 @@ printMemAllocs(chpl_mem_descInt_t description, int64_t threshold,
     fprintf(memLogFile, "=");
   fprintf(memLogFile, "\n");
 
-  table = (memTableEntry**)sys_malloc(n*sizeof(memTableEntry*));
-  if (!table)
-    chpl_error("out of memory printing memory table", lineno, filename);
-
-  n = 0;
-  for (i = 0; i < hashSize; i++) {
-    for (memEntry = memTable[i]; memEntry != NULL; memEntry = memEntry->nextInBucket) {
-      size_t chunk = memEntry->number * memEntry->size;
-      if (chunk < threshold)
-        continue;
-      if (description != -1 && memEntry->description != description)
-        continue;
-      table[n++] = memEntry;
-    }
-  }
-  qsort(table, n, sizeof(memTableEntry*), descCmp);
+  qsort(table, n, sizeof(memTableEntry), descCmp);
 
   loc = (char*)sys_malloc((filenameWidth+numberWidth+1)*sizeof(char));
 
   for (i = 0; i < n; i++) {
-    memEntry = table[i];
+    memEntry = &table[i];
     if (memEntry->filename) {
       memEntryFilename = chpl_lookupFilename(memEntry->filename);
       sprintf(loc, "%s:%" PRId32, memEntryFilename, memEntry->lineno);
@@ -624,25 +928,72 @@ printMemAllocs(chpl_mem_descInt_t description, int64_t threshold,
 }
 
 
+void chpl_printMemPeaksByDesc(int32_t lineno, int32_t filename) {
+  const int numberWidth = 13;
+  const int timeWidth = 10;
+
+  if (!chpl_memTrack) {
+    chpl_warning("invalid call to printMemPeaksByDesc(); rerun with "
+                 "--memTrack",
+                 lineno, filename);
+    return;
+  }
+
+  // The snapshot may change while we print; we don't lock it, in case
+  // printing allocates.
+  fprintf(memLogFile, "=========================================\n");
+  fprintf(memLogFile, "Memory Usage Peaks by Type (node %" PRI_c_nodeid_t
+                      ")\n", chpl_nodeID);
+  fprintf(memLogFile, "High water mark %" PRIu64 " bytes, near %.3f s\n",
+          atomic_load_uint_least64_t(&maxMem), atMaxMemTime / 1e9);
+  fprintf(memLogFile, "==============================================================\n");
+  fprintf(memLogFile, "%-*s%-*s%-*s%-*s%s\n",
+          numberWidth, "Now", numberWidth, "Peak", timeWidth, "Peak (s)",
+          numberWidth, "At HWM", "Description of allocation");
+  fprintf(memLogFile, "==============================================================\n");
+  for (int i = 0; i < numDescUsages; i++) {
+    descUsage* du = &descUsages[i];
+    if (atomic_load_uint_least64_t(&du->peak) == 0)
+      continue;
+    fprintf(memLogFile, "%-*" PRIu64 "%-*" PRIu64 "%-*.3f%-*zu%s\n",
+            numberWidth, atomic_load_uint_least64_t(&du->cur),
+            numberWidth, atomic_load_uint_least64_t(&du->peak),
+            timeWidth, atomic_load_uint_least64_t(&du->peakTime) / 1e9,
+            numberWidth, du->atMaxMem,
+            chpl_mem_descString(i));
+  }
+  fprintf(memLogFile, "==============================================================\n");
+}
+
+
 void chpl_reportMemInfo() {
+  stopTimeline();
+  if (chpl_memTrack && chpl_env_rt_get_bool("MEM_DESC_PEAKS", false)) {
+    fprintf(memLogFile, "\n");
+    chpl_printMemPeaksByDesc(0, 0);
+  }
+  if (chpl_mem_sample_interval > 0) {
+    chpl_mem_sample_print(memLogFile, -1, 0);
+  }
   if (memStats) {
     fprintf(memLogFile, "\n");
     chpl_printMemAllocStats(0, 0);
+    chpl_mem_layerReportStats(memLogFile);
   }
   if (memLeaksByType) {
-    if (totalMem) {
+    if (atomic_load_uint_least64_t(&totalMem)) {
       fprintf(memLogFile, "\n");
       printMemAllocsByType(true /* forLeaks */, 0, 0);
     }
   }
   if (memLeaksByDesc && strcmp(memLeaksByDesc, "")) {
-    if (totalMem) {
+    if (atomic_load_uint_least64_t(&totalMem)) {
       fprintf(memLogFile, "\n");
       chpl_printMemAllocsByDesc(memLeaksByDesc, memThreshold, 0, 0);
     }
   }
   if (memLeaks) {
-    if (totalMem) {
+    if (atomic_load_uint_least64_t(&totalMem)) {
       fprintf(memLogFile, "\n");
       printMemAllocs(-1, memThreshold, 0, 0);
     }
@@ -666,9 +1017,9 @@ void chpl_track_malloc(void* memAlloc, size_t number, size_t size,
                        int32_t lineno, int32_t filename) {
   if (number * size > memThreshold) {
     if (chpl_memTrack && chpl_mem_descTrack(description)) {
-      memTrack_lock();
+      memTrack_lock(memAlloc);
       addMemTableEntry(memAlloc, number, size, description, lineno, filename);
-      memTrack_unlock();
+      memTrack_unlock(memAlloc);
     }
     if (chpl_verbose_mem) {
       fprintf(memLogFile, "%" PRI_c_nodeid_t ": %s:%" PRId32
@@ -684,7 +1035,7 @@ void chpl_track_malloc(void* memAlloc, size_t number, size_t size,
 void chpl_track_free(void* memAlloc, int32_t lineno, int32_t filename) {
   memTableEntry* memEntry = NULL;
   if (chpl_memTrack) {
-    memTrack_lock();
+    memTrack_lock(memAlloc);
     memEntry = removeMemTableEntry(memAlloc);
     if (memEntry) {
       if (chpl_verbose_mem) {
@@ -696,7 +1047,7 @@ void chpl_track_free(void* memAlloc, int32_t lineno, int32_t filename) {
       }
       sys_free(memEntry);
     }
-    memTrack_unlock();
+    memTrack_unlock(memAlloc);
   } else if (chpl_verbose_mem && !memEntry) {
     fprintf(memLogFile, "%" PRI_c_nodeid_t ": %s:%" PRId32 ": free at %p\n",
             chpl_nodeID, (filename ? chpl_lookupFilename(filename) : "--"),
@@ -711,13 +1062,13 @@ void chpl_track_realloc_pre(void* memAlloc, size_t size,
   memTableEntry* memEntry = NULL;
 
   if (chpl_memTrack && size > memThreshold) {
-    memTrack_lock();
     if (memAlloc) {
+      memTrack_lock(memAlloc);
       memEntry = removeMemTableEntry(memAlloc);
       if (memEntry)
         sys_free(memEntry);
+      memTrack_unlock(memAlloc);
     }
-    memTrack_unlock();
   }
 }
 
@@ -728,9 +1079,9 @@ void chpl_track_realloc_post(void* moreMemAlloc,
                          int32_t lineno, int32_t filename) {
   if (size > memThreshold) {
     if (chpl_memTrack && chpl_mem_descTrack(description)) {
-      memTrack_lock();
+      memTrack_lock(moreMemAlloc);
       addMemTableEntry(moreMemAlloc, 1, size, description, lineno, filename);
-      memTrack_unlock();
+      memTrack_unlock(moreMemAlloc);
     }
     if (chpl_verbose_mem) {
       fprintf(memLogFile, "%" PRI_c_nodeid_t ": %s:%" PRId32
@@ -46,6 +46,7 @@
 // Don't get warning macros for chpl_comm_get etc
 #include "chpl-comm-no-warning-macros.h"
 
+#include <pthread.h>
 #include <signal.h>
 #include <sched.h>
 #include <stdint.h>
@@ -55,6 +56,25 @@
 
 static gasnet_seginfo_t* seginfo_table = NULL;
 
+//
+// With GASNet-EX we do strided transfers through its native VIS
+// interface, which takes Chapel's representation (element size, and
+// the contiguous count in elements) directly.  Otherwise we use the
+// legacy byte-count interface.
+//
+// GASNet-EX also gives us remote atomics, through atomic domains.
+// These are offloaded to the NIC on conduits that can do that, and
+// done by GASNet itself via AMs everywhere else.
+//
+#if defined(GEX_SPEC_VERSION_MAJOR)
+#define CHPL_COMM_GASNET_GEX_VIS 1
+#define CHPL_COMM_GASNET_GEX_AD 1
+static gex_TM_t gex_tm;
+static gex_AD_t amo_ad_int32, amo_ad_int64, amo_ad_uint32, amo_ad_uint64,
+                amo_ad_real32, amo_ad_real64;
+static void amo_ad_init(void);
+#endif
+
 // Gasnet AM handler arguments are only 32 bits, so here we have
 // functions to get the 2 arguments for a 64-bit pointer,
 // and a function to reconstitute the pointer from the 2 arguments.
@@ -254,7 +274,11 @@ typedef enum {
   SHUTDOWN,             // tell nodes to get ready for shutdown
   BCAST_SEGINFO,        // broadcast for segment info table
   DO_REPLY_PUT,         // do a PUT here from another locale
-  DO_COPY_PAYLOAD       // copy AM payload to another address
+  DO_COPY_PAYLOAD,      // copy AM payload to another address
+  ALLOC,                // allocate memory for another locale
+  ALLOC_RESULT,         // return allocated addresses and ack to a done_t
+  DO_AMO,               // do an AMO on an object outside the segment
+  DO_AMO_RESULT         // return an AMO result and ack to a done_t
 } AM_handler_function_idx_t;
 
 static void AM_fork_fast(gasnet_token_t token, void* buf, size_t nbytes) {
@@ -576,6 +600,164 @@ void AM_copy_payload(gasnet_token_t token, void* buf, size_t nbytes,
   GASNET_Safe(gasnet_AMReplyShort2(token, SIGNAL, ack0, ack1));
 }
 
+#ifdef CHPL_COMM_GASNET_GEX_AD
+//
+// Network atomics
+//
+// Objects in the GASNet segment are operated on through the atomic
+// domains (see do_amo_*() below).  GASNet can't reach anything else,
+// so AMOs on such objects are done with processor atomics by the
+// owning node.  A given object is always in one place or the other,
+// so the two kinds never race on the same memory.
+//
+typedef union {
+  int32_t  i32;
+  int64_t  i64;
+  uint32_t u32;
+  uint64_t u64;
+  _real32  r32;
+  _real64  r64;
+} amo_datum_t;
+
+typedef struct {
+  void*       obj;
+  void*       result;           // on the caller; NULL if non-fetching
+  void*       ack;              // on the caller; done_t*
+  gex_OP_t    op;
+  gex_DT_t    dt;
+  size_t      size;
+  amo_datum_t opnd1;
+  amo_datum_t opnd2;
+} amo_req_t;
+
+#define AMO_CPU_BIT_CASES(aType, v1)                                    \
+    case GEX_OP_AND:                                                    \
+    case GEX_OP_FAND:                                                   \
+      return atomic_fetch_and_##aType(o, v1);                           \
+    case GEX_OP_OR:                                                     \
+    case GEX_OP_FOR:                                                    \
+      return atomic_fetch_or_##aType(o, v1);                            \
+    case GEX_OP_XOR:                                                    \
+    case GEX_OP_FXOR:                                                   \
+      return atomic_fetch_xor_##aType(o, v1);
+
+#define AMO_CPU_NO_BIT_CASES(aType, v1)
+
+#define DEFN_AMO_CPU(fnType, Type, aType, bitCases)                     \
+  static Type amo_cpu_##fnType(gex_OP_t op, void* obj,                  \
+                               Type v1, Type v2) {                      \
+    atomic_##aType* o = (atomic_##aType*) obj;                          \
+    switch (op) {                                                       \
+    case GEX_OP_SET:                                                    \
+      atomic_store_##aType(o, v1);                                      \
+      return 0;                                                         \
+    case GEX_OP_GET:                                                    \
+      return atomic_load_##aType(o);                                    \
+    case GEX_OP_SWAP:                                                   \
+      return atomic_exchange_##aType(o, v1);                            \
+    case GEX_OP_FCAS:                                                   \
+      (void) atomic_compare_exchange_strong_##aType(o, &v1, v2);        \
+      return v1;                                                        \
+    case GEX_OP_ADD:                                                    \
+    case GEX_OP_FADD:                                                   \
+      return atomic_fetch_add_##aType(o, v1);                           \
+    case GEX_OP_SUB:                                                    \
+    case GEX_OP_FSUB:                                                   \
+      return atomic_fetch_sub_##aType(o, v1);                           \
+    bitCases(aType, v1)                                                 \
+    default:                                                            \
+      CHPL_INTERNAL_ERROR("unexpected AMO op");                         \
+    }                                                                   \
+    return 0;                                                           \
+  }
+
+DEFN_AMO_CPU(int32, int32_t, int_least32_t, AMO_CPU_BIT_CASES)
+DEFN_AMO_CPU(int64, int64_t, int_least64_t, AMO_CPU_BIT_CASES)
+DEFN_AMO_CPU(uint32, uint32_t, uint_least32_t, AMO_CPU_BIT_CASES)
+DEFN_AMO_CPU(uint64, uint64_t, uint_least64_t, AMO_CPU_BIT_CASES)
+DEFN_AMO_CPU(real32, _real32, _real32, AMO_CPU_NO_BIT_CASES)
+DEFN_AMO_CPU(real64, _real64, _real64, AMO_CPU_NO_BIT_CASES)
+
+static void AM_amo(gasnet_token_t token, void* buf, size_t nbytes) {
+  amo_req_t* r = buf;
+  amo_datum_t res;
+
+  assert(nbytes == sizeof(amo_req_t));
+
+  switch (r->dt) {
+  case GEX_DT_I32:
+    res.i32 = amo_cpu_int32(r->op, r->obj, r->opnd1.i32, r->opnd2.i32);
+    break;
+  case GEX_DT_I64:
+    res.i64 = amo_cpu_int64(r->op, r->obj, r->opnd1.i64, r->opnd2.i64);
+    break;
+  case GEX_DT_U32:
+    res.u32 = amo_cpu_uint32(r->op, r->obj, r->opnd1.u32, r->opnd2.u32);
+    break;
+  case GEX_DT_U64:
+    res.u64 = amo_cpu_uint64(r->op, r->obj, r->opnd1.u64, r->opnd2.u64);
+    break;
+  case GEX_DT_FLT:
+    res.r32 = amo_cpu_real32(r->op, r->obj, r->opnd1.r32, r->opnd2.r32);
+    break;
+  case GEX_DT_DBL:
+    res.r64 = amo_cpu_real64(r->op, r->obj, r->opnd1.r64, r->opnd2.r64);
+    break;
+  default:
+    CHPL_INTERNAL_ERROR("unexpected AMO datatype");
+  }
+
+  GASNET_Safe(gasnet_AMReplyMedium4(token, DO_AMO_RESULT, &res, r->size,
+                                    Arg0(r->ack), Arg1(r->ack),
+                                    Arg0(r->result), Arg1(r->result)));
+}
+
+static void AM_amo_result(gasnet_token_t token, void* buf, size_t nbytes,
+                          gasnet_handlerarg_t ack0, gasnet_handlerarg_t ack1,
+                          gasnet_handlerarg_t res0, gasnet_handlerarg_t res1)
+{
+  void* result = get_ptr_from_args(res0, res1);
+
+  if (result != NULL)
+    memcpy(result, buf, nbytes);
+
+  AM_signal(token, ack0, ack1);
+}
+#endif
+
+typedef struct {
+  void*    ptrs;                // on the caller; where the addresses go
+  void*    ack;                 // on the caller; done_t*
+  size_t   size;                // bytes per block
+  uint32_t n;                   // number of blocks
+} alloc_req_t;
+
+static void AM_alloc(gasnet_token_t token, void* buf, size_t nbytes) {
+  alloc_req_t* r = buf;
+  void* ptrs[CHPL_COMM_REMOTE_ALLOC_MAX];
+
+  assert(nbytes == sizeof(alloc_req_t));
+  assert(r->n <= CHPL_COMM_REMOTE_ALLOC_MAX);
+
+  for (uint32_t i = 0; i < r->n; i++) {
+    ptrs[i] = chpl_mem_alloc(r->size, CHPL_RT_MD_REMOTE_ALLOC, 0, 0);
+  }
+
+  GASNET_Safe(gasnet_AMReplyMedium4(token, ALLOC_RESULT,
+                                    ptrs, r->n * sizeof(void*),
+                                    Arg0(r->ack), Arg1(r->ack),
+                                    Arg0(r->ptrs), Arg1(r->ptrs)));
+}
+
+static void AM_alloc_result(gasnet_token_t token, void* buf, size_t nbytes,
+                            gasnet_handlerarg_t ack0, gasnet_handlerarg_t ack1,
+                            gasnet_handlerarg_t ptrs0, gasnet_handlerarg_t ptrs1)
+{
+  memcpy(get_ptr_from_args(ptrs0, ptrs1), buf, nbytes);
+
+  AM_signal(token, ack0, ack1);
+}
+
 static gasnet_handlerentry_t ftable[] = {
   {FORK,          AM_fork},
   {FORK_SMALL,    AM_fork_small},
@@ -593,7 +775,13 @@ static gasnet_handlerentry_t ftable[] = {
   {SHUTDOWN,      AM_shutdown},
   {BCAST_SEGINFO, AM_bcast_seginfo},
   {DO_REPLY_PUT,  AM_reply_put},
-  {DO_COPY_PAYLOAD, AM_copy_payload}
+  {DO_COPY_PAYLOAD, AM_copy_payload},
+  {ALLOC,         AM_alloc},
+  {ALLOC_RESULT,  AM_alloc_result},
+#ifdef CHPL_COMM_GASNET_GEX_AD
+  {DO_AMO,        AM_amo},
+  {DO_AMO_RESULT, AM_amo_result},
+#endif
 };
 
 //
@@ -628,7 +816,64 @@ chpl_comm_nb_handle_t chpl_comm_put_nb(void *addr, c_nodeid_t node, void* raddr,
 
   ret = gasnet_put_nb_bulk(node, raddr, addr, size);
 
-  chpl_comm_diags_incr(put_nb);
+  chpl_comm_diags_xfer(put_nb, size);
+
+  return (chpl_comm_nb_handle_t) ret;
+}
+
+chpl_comm_nb_handle_t chpl_comm_put_nb_v(int v_len, void** addr_v,
+                                         c_nodeid_t node, void** raddr_v,
+                                         size_t* size_v, int32_t commID,
+                                         int ln, int32_t fn)
+{
+  gasnet_handle_t ret;
+  int n_in_segment;
+  int vi;
+
+  if (v_len == 1)
+    return chpl_comm_put_nb(addr_v[0], node, raddr_v[0], size_v[0],
+                            commID, ln, fn);
+
+  //
+  // Do the callbacks and any PUTs we can't do directly before we open
+  // the access region, since both of those may communicate themselves.
+  // A PUT we can't do directly goes through chpl_comm_put(), which
+  // does its own callbacks and diagnostics, so each element is reported
+  // exactly once.
+  //
+  n_in_segment = 0;
+  for (vi = 0; vi < v_len; vi++) {
+#ifndef GASNET_SEGMENT_EVERYTHING
+    if (!chpl_comm_addr_gettable(node, raddr_v[vi], size_v[vi])) {
+      chpl_comm_put(addr_v[vi], node, raddr_v[vi], size_v[vi],
+                    commID, ln, fn);
+      continue;
+    }
+#endif
+
+    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put_nb)) {
+      chpl_comm_cb_info_t cb_data =
+        {chpl_comm_cb_event_kind_put_nb, chpl_nodeID, node,
+         .iu.comm={addr_v[vi], raddr_v[vi], size_v[vi], commID, ln, fn}};
+      chpl_comm_do_callbacks (&cb_data);
+    }
+
+    n_in_segment++;
+  }
+
+  if (n_in_segment == 0)
+    return NULL;
+
+  gasnet_begin_nbi_accessregion();
+  for (vi = 0; vi < v_len; vi++) {
+#ifndef GASNET_SEGMENT_EVERYTHING
+    if (!chpl_comm_addr_gettable(node, raddr_v[vi], size_v[vi]))
+      continue; // already done above
+#endif
+    gasnet_put_nbi_bulk(node, raddr_v[vi], addr_v[vi], size_v[vi]);
+    chpl_comm_diags_xfer(put_nb, size_v[vi]);
+  }
+  ret = gasnet_end_nbi_accessregion();
 
   return (chpl_comm_nb_handle_t) ret;
 }
@@ -662,7 +907,7 @@ chpl_comm_nb_handle_t chpl_comm_get_nb(void* addr, c_nodeid_t node, void* raddr,
 
   ret = gasnet_get_nb_bulk(addr, node, raddr, size);
 
-  chpl_comm_diags_incr(get_nb);
+  chpl_comm_diags_xfer(get_nb, size);
 
   return (chpl_comm_nb_handle_t) ret;
 }
@@ -709,8 +954,10 @@ int chpl_comm_addr_gettable(c_nodeid_t node, void* start, size_t len)
 }
 
 
+static int numPollingThreads = 1;
+
 int32_t chpl_comm_getMaxThreads(void) {
-  return GASNETI_MAX_THREADS-1;
+  return GASNETI_MAX_THREADS - numPollingThreads;
 }
 
 //
@@ -723,7 +970,12 @@ int32_t chpl_comm_getMaxThreads(void) {
 // even though the tasking layer can implement it however it likes, as a
 // task or thread or whatever.
 //
-static volatile int pollingRunning;
+// On conduits where concurrent polling doesn't contend, more than one
+// thread can be devoted to polling by setting CHPL_RT_COMM_GASNET_
+// POLLING_THREADS.  The extra ones are plain pthreads, since the
+// tasking layer only gives us one comm task.
+//
+static atomic_int_least32_t pollingRunning;
 static volatile int pollingQuit;
 static chpl_bool pollingRequired;
 static atomic_bool pollingLock;
@@ -744,18 +996,31 @@ static inline void am_poll_try(void) {
 }
 
 static void polling(void* x) {
-  pollingRunning = 1;
+  (void) atomic_fetch_add_int_least32_t(&pollingRunning, 1);
 
   while (!pollingQuit) {
     am_poll_try();
     chpl_task_yield();
   }
 
-  pollingRunning = 0;
+  (void) atomic_fetch_sub_int_least32_t(&pollingRunning, 1);
+}
+
+static void* polling_helper(void* x) {
+  (void) atomic_fetch_add_int_least32_t(&pollingRunning, 1);
+
+  while (!pollingQuit) {
+    am_poll_try();
+    sched_yield();
+  }
+
+  (void) atomic_fetch_sub_int_least32_t(&pollingRunning, 1);
+  return NULL;
 }
 
 static void setup_polling(void) {
   atomic_init_bool(&pollingLock, false);
+  atomic_init_int_least32_t(&pollingRunning, 0);
 #if defined(GASNET_CONDUIT_IBV)
   pollingRequired = false;
   chpl_env_set("GASNET_RCV_THREAD", "1", 1);
@@ -764,17 +1029,48 @@ static void setup_polling(void) {
 #endif
 }
 
+static void set_num_polling_threads(void) {
+  numPollingThreads = chpl_env_rt_get_int("COMM_GASNET_POLLING_THREADS", 1);
+  if (numPollingThreads < 1) {
+    numPollingThreads = 1;
+  }
+#if defined(GASNET_CONDUIT_IBV) || defined(GASNET_CONDUIT_UCX) || defined(GASNET_CONDUIT_ARIES)
+  if (numPollingThreads > 1) {
+    // polling is serialized here (see am_poll_try()), so extra threads
+    // would only spin on the lock
+    if (chpl_nodeID == 0) {
+      chpl_warning("CHPL_RT_COMM_GASNET_POLLING_THREADS > 1 has no effect "
+                   "with this conduit; using 1", 0, 0);
+    }
+    numPollingThreads = 1;
+  }
+#endif
+}
+
 static void start_polling(void) {
+  int i;
+
   if (!pollingRequired) return;
 
-  pollingRunning = 0;
   pollingQuit = 0;
 
   if (chpl_task_createCommTask(polling, NULL)) {
     chpl_internal_error("unable to start polling task for gasnet");
   }
 
-  while (!pollingRunning) {
+  for (i = 1; i < numPollingThreads; i++) {
+    pthread_t thread;
+    pthread_attr_t attr;
+
+    if (pthread_attr_init(&attr) != 0
+        || pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED) != 0
+        || pthread_create(&thread, &attr, polling_helper, NULL) != 0) {
+      chpl_internal_error("unable to start polling thread for gasnet");
+    }
+    (void) pthread_attr_destroy(&attr);
+  }
+
+  while (atomic_load_int_least32_t(&pollingRunning) < numPollingThreads) {
     sched_yield();
   }
 }
@@ -785,7 +1081,7 @@ static void stop_polling(chpl_bool wait) {
   pollingQuit = 1;
 
   if (wait) {
-    while (pollingRunning) {
+    while (atomic_load_int_least32_t(&pollingRunning) > 0) {
       sched_yield();
     }
   }
@@ -836,15 +1132,26 @@ void chpl_comm_init(int *argc_p, char ***argv_p) {
   set_num_comm_domains();
   setup_polling();
 
+  // Let VIS pack small-chunk strided transfers at the remote end with
+  // AMs, rather than doing a separate RDMA for every contiguous chunk.
+  chpl_env_set("GASNET_VIS_AMPIPE", "1", 0);
+
   assert(sizeof(gasnet_handlerarg_t)==sizeof(uint32_t));
 
   gasnet_init(argc_p, argv_p);
   chpl_nodeID = gasnet_mynode();
   chpl_numNodes = gasnet_nodes();
+  set_num_polling_threads();
   GASNET_Safe(gasnet_attach(ftable,
                             sizeof(ftable)/sizeof(gasnet_handlerentry_t),
                             gasnet_getMaxLocalSegmentSize(),
                             0));
+#ifdef CHPL_COMM_GASNET_GEX_VIS
+  gasnet_QueryGexObjects(NULL, NULL, &gex_tm, NULL);
+#endif
+#ifdef CHPL_COMM_GASNET_GEX_AD
+  amo_ad_init();
+#endif
   // TODO (EJR: 03/03/16): we currently "leak" seginfo_table. We should
   // probably free it on exit (but only for "clean" exits.)
   seginfo_table = (gasnet_seginfo_t*)sys_malloc(chpl_numNodes*sizeof(gasnet_seginfo_t));
@@ -1104,7 +1411,8 @@ void  chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
     }
 
     chpl_comm_diags_verbose_rdma("put", node, size, ln, fn, commID);
-    chpl_comm_diags_incr(put);
+    chpl_comm_diags_xfer(put, size);
+    const uint64_t lat_start = chpl_comm_diags_lat_start();
 
     // Handle remote address not in remote segment.
 #ifdef GASNET_SEGMENT_EVERYTHING
@@ -1157,6 +1465,8 @@ void  chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
         wait_done_obj(&done, false);
       }
     }
+
+    chpl_comm_diags_lat_end(put, lat_start);
   }
 }
 
@@ -1179,7 +1489,8 @@ void  chpl_comm_get(void* addr, c_nodeid_t node, void* raddr,
     }
 
     chpl_comm_diags_verbose_rdma("get", node, size, ln, fn, commID);
-    chpl_comm_diags_incr(get);
+    chpl_comm_diags_xfer(get, size);
+    const uint64_t lat_start = chpl_comm_diags_lat_start();
 
     // Handle remote address not in remote segment.
 
@@ -1276,6 +1587,8 @@ void  chpl_comm_get(void* addr, c_nodeid_t node, void* raddr,
         chpl_mem_free(local_buf, 0, 0);
       }
     }
+
+    chpl_comm_diags_lat_end(get, lat_start);
   }
 }
 
@@ -1292,6 +1605,16 @@ void  chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode_i
   const size_t strlvls = (size_t)stridelevels;
   const gasnet_node_t srcnode = (gasnet_node_t)srcnode_id;
 
+#ifdef CHPL_COMM_GASNET_GEX_VIS
+  // Only the strides are measured in number of bytes.
+  ptrdiff_t dststr[strlvls];
+  ptrdiff_t srcstr[strlvls];
+
+  for (i=0; i<strlvls; i++) {
+    srcstr[i] = srcstrides[i] * elemSize;
+    dststr[i] = dststrides[i] * elemSize;
+  }
+#else
   size_t dststr[strlvls];
   size_t srcstr[strlvls];
   size_t cnt[strlvls+1];
@@ -1309,6 +1632,7 @@ void  chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode_i
     }
     cnt[strlvls] = count[strlvls];
   }
+#endif
 
   // Communications callback support
   if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get_strd)) {
@@ -1326,7 +1650,13 @@ void  chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode_i
   }
 
   // TODO -- handle strided get for non-registered memory
+#ifdef CHPL_COMM_GASNET_GEX_VIS
+  (void) gex_VIS_StridedGetBlocking(gex_tm, dstaddr, dststr,
+                                    srcnode, srcaddr, srcstr,
+                                    elemSize, count, strlvls, 0);
+#else
   gasnet_gets_bulk(dstaddr, dststr, srcnode, srcaddr, srcstr, cnt, strlvls);
+#endif
 }
 
 // See the comment for chpl_comm_gets().
@@ -1338,6 +1668,16 @@ void  chpl_comm_put_strd(void* dstaddr, size_t* dststrides, c_nodeid_t dstnode_i
   const size_t strlvls = (size_t)stridelevels;
   const gasnet_node_t dstnode = (gasnet_node_t)dstnode_id;
 
+#ifdef CHPL_COMM_GASNET_GEX_VIS
+  // Only the strides are measured in number of bytes.
+  ptrdiff_t dststr[strlvls];
+  ptrdiff_t srcstr[strlvls];
+
+  for (i=0; i<strlvls; i++) {
+    srcstr[i] = srcstrides[i] * elemSize;
+    dststr[i] = dststrides[i] * elemSize;
+  }
+#else
   size_t dststr[strlvls];
   size_t srcstr[strlvls];
   size_t cnt[strlvls+1];
@@ -1354,6 +1694,7 @@ void  chpl_comm_put_strd(void* dstaddr, size_t* dststrides, c_nodeid_t dstnode_i
     }
     cnt[strlvls] = count[strlvls];
   }
+#endif
 
   // Communications callback support
   if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put_strd)) {
@@ -1371,7 +1712,13 @@ void  chpl_comm_put_strd(void* dstaddr, size_t* dststrides, c_nodeid_t dstnode_i
   }
 
   // TODO -- handle strided put for non-registered memory
+#ifdef CHPL_COMM_GASNET_GEX_VIS
+  (void) gex_VIS_StridedPutBlocking(gex_tm, dstnode, dstaddr, dststr,
+                                    srcaddr, srcstr,
+                                    elemSize, count, strlvls, 0);
+#else
   gasnet_puts_bulk(dstnode, dstaddr, dststr, srcaddr, srcstr, cnt, strlvls);
+#endif
 }
 
 #define MAX_UNORDERED_TRANS_SZ 1024
@@ -1422,6 +1769,250 @@ void chpl_comm_put_unordered(void* addr, c_nodeid_t node, void* raddr,
 
 void chpl_comm_getput_unordered_task_fence(void) { }
 
+#ifdef CHPL_COMM_GASNET_GEX_AD
+//
+// Atomic domains, one per Chapel network atomic type.  These are
+// created collectively right after attach and live until exit.
+//
+static void amo_ad_init(void) {
+  const gex_OP_t arith_ops = (GEX_OP_SET | GEX_OP_GET | GEX_OP_SWAP
+                              | GEX_OP_FCAS
+                              | GEX_OP_ADD | GEX_OP_FADD
+                              | GEX_OP_SUB | GEX_OP_FSUB);
+  const gex_OP_t int_ops = (arith_ops
+                            | GEX_OP_AND | GEX_OP_FAND
+                            | GEX_OP_OR | GEX_OP_FOR
+                            | GEX_OP_XOR | GEX_OP_FXOR);
+
+  (void) gex_AD_Create(&amo_ad_int32, gex_tm, GEX_DT_I32, int_ops, 0);
+  (void) gex_AD_Create(&amo_ad_int64, gex_tm, GEX_DT_I64, int_ops, 0);
+  (void) gex_AD_Create(&amo_ad_uint32, gex_tm, GEX_DT_U32, int_ops, 0);
+  (void) gex_AD_Create(&amo_ad_uint64, gex_tm, GEX_DT_U64, int_ops, 0);
+  (void) gex_AD_Create(&amo_ad_real32, gex_tm, GEX_DT_FLT, arith_ops, 0);
+  (void) gex_AD_Create(&amo_ad_real64, gex_tm, GEX_DT_DBL, arith_ops, 0);
+}
+
+static inline
+int amo_in_segment(c_nodeid_t node, void* object, size_t size) {
+#ifdef GASNET_SEGMENT_EVERYTHING
+  return 1;
+#else
+  return chpl_comm_addr_gettable(node, object, size);
+#endif
+}
+
+static inline
+gex_Flags_t amo_order_flags(memory_order order) {
+  switch (order) {
+  case memory_order_relaxed:
+    return 0;
+  case memory_order_consume:
+  case memory_order_acquire:
+    return GEX_FLAG_AD_ACQ;
+  case memory_order_release:
+    return GEX_FLAG_AD_REL;
+  default:
+    return GEX_FLAG_AD_ACQ | GEX_FLAG_AD_REL;
+  }
+}
+
+//
+// Do an AMO and wait for it to complete.  result is NULL for the
+// non-fetching ops.
+//
+#define DEFN_DO_AMO(fnType, Type, gexSfx, gexDT, fld)                   \
+  static void do_amo_##fnType(c_nodeid_t node, void* object,            \
+                              gex_OP_t op, Type opnd1, Type opnd2,      \
+                              Type* result, gex_Flags_t flags) {        \
+    if (amo_in_segment(node, object, sizeof(Type))) {                   \
+      gex_Event_Wait(gex_AD_OpNB_##gexSfx(amo_ad_##fnType, result,      \
+                                          (gex_Rank_t) node, object,    \
+                                          op, opnd1, opnd2, flags));    \
+    } else if (node == chpl_nodeID) {                                   \
+      Type res = amo_cpu_##fnType(op, object, opnd1, opnd2);            \
+      if (result != NULL)                                               \
+        *result = res;                                                  \
+    } else {                                                            \
+      done_t done;                                                      \
+      amo_req_t req = { .obj = object, .result = result, .ack = &done,  \
+                        .op = op, .dt = gexDT, .size = sizeof(Type) };  \
+      req.opnd1.fld = opnd1;                                            \
+      req.opnd2.fld = opnd2;                                            \
+      init_done_obj(&done, 1);                                          \
+      GASNET_Safe(gasnet_AMRequestMedium0(node, DO_AMO,                 \
+                                          &req, sizeof(req)));          \
+      wait_done_obj(&done, false);                                      \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  static void do_amo_nbi_##fnType(c_nodeid_t node, void* object,        \
+                                  gex_OP_t op, Type opnd1) {            \
+    if (amo_in_segment(node, object, sizeof(Type))) {                   \
+      gex_AD_OpNBI_##gexSfx(amo_ad_##fnType, NULL, (gex_Rank_t) node,   \
+                            object, op, opnd1, 0, 0);                   \
+    } else {                                                            \
+      do_amo_##fnType(node, object, op, opnd1, 0, NULL, 0);             \
+    }                                                                   \
+  }
+
+DEFN_DO_AMO(int32, int32_t, I32, GEX_DT_I32, i32)
+DEFN_DO_AMO(int64, int64_t, I64, GEX_DT_I64, i64)
+DEFN_DO_AMO(uint32, uint32_t, U32, GEX_DT_U32, u32)
+DEFN_DO_AMO(uint64, uint64_t, U64, GEX_DT_U64, u64)
+DEFN_DO_AMO(real32, _real32, FLT, GEX_DT_FLT, r32)
+DEFN_DO_AMO(real64, _real64, DBL, GEX_DT_DBL, r64)
+
+
+#define DEFN_CHPL_COMM_ATOMIC_WRITE(fnType, Type)                       \
+  void chpl_comm_atomic_write_##fnType                                  \
+         (void* desired, c_nodeid_t node, void* object,                 \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo write", node, ln, fn);             \
+    chpl_comm_diags_incr(amo);                                          \
+    do_amo_##fnType(node, object, GEX_OP_SET, *(Type*) desired, 0,      \
+                    NULL, amo_order_flags(order));                      \
+  }
+
+DEFN_CHPL_COMM_ATOMIC_WRITE(int32, int32_t)
+DEFN_CHPL_COMM_ATOMIC_WRITE(int64, int64_t)
+DEFN_CHPL_COMM_ATOMIC_WRITE(uint32, uint32_t)
+DEFN_CHPL_COMM_ATOMIC_WRITE(uint64, uint64_t)
+DEFN_CHPL_COMM_ATOMIC_WRITE(real32, _real32)
+DEFN_CHPL_COMM_ATOMIC_WRITE(real64, _real64)
+
+
+#define DEFN_CHPL_COMM_ATOMIC_READ(fnType, Type)                        \
+  void chpl_comm_atomic_read_##fnType                                   \
+         (void* result, c_nodeid_t node, void* object,                  \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo read", node, ln, fn);              \
+    chpl_comm_diags_incr(amo);                                          \
+    do_amo_##fnType(node, object, GEX_OP_GET, 0, 0,                     \
+                    (Type*) result, amo_order_flags(order));            \
+  }
+
+DEFN_CHPL_COMM_ATOMIC_READ(int32, int32_t)
+DEFN_CHPL_COMM_ATOMIC_READ(int64, int64_t)
+DEFN_CHPL_COMM_ATOMIC_READ(uint32, uint32_t)
+DEFN_CHPL_COMM_ATOMIC_READ(uint64, uint64_t)
+DEFN_CHPL_COMM_ATOMIC_READ(real32, _real32)
+DEFN_CHPL_COMM_ATOMIC_READ(real64, _real64)
+
+
+#define DEFN_CHPL_COMM_ATOMIC_XCHG(fnType, Type)                        \
+  void chpl_comm_atomic_xchg_##fnType                                   \
+         (void* desired, c_nodeid_t node, void* object, void* result,   \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo xchg", node, ln, fn);              \
+    chpl_comm_diags_incr(amo);                                          \
+    do_amo_##fnType(node, object, GEX_OP_SWAP, *(Type*) desired, 0,     \
+                    (Type*) result, amo_order_flags(order));            \
+  }
+
+DEFN_CHPL_COMM_ATOMIC_XCHG(int32, int32_t)
+DEFN_CHPL_COMM_ATOMIC_XCHG(int64, int64_t)
+DEFN_CHPL_COMM_ATOMIC_XCHG(uint32, uint32_t)
+DEFN_CHPL_COMM_ATOMIC_XCHG(uint64, uint64_t)
+DEFN_CHPL_COMM_ATOMIC_XCHG(real32, _real32)
+DEFN_CHPL_COMM_ATOMIC_XCHG(real64, _real64)
+
+
+#define DEFN_CHPL_COMM_ATOMIC_CMPXCHG(fnType, Type)                     \
+  void chpl_comm_atomic_cmpxchg_##fnType                                \
+         (void* expected, void* desired, c_nodeid_t node, void* object, \
+          chpl_bool32* result, memory_order succ, memory_order fail,    \
+          int ln, int32_t fn) {                                         \
+    chpl_comm_diags_verbose_amo("amo cmpxchg", node, ln, fn);           \
+    chpl_comm_diags_incr(amo);                                          \
+    Type old_value;                                                     \
+    Type old_expected;                                                  \
+    memcpy(&old_expected, expected, sizeof(Type));                      \
+    do_amo_##fnType(node, object, GEX_OP_FCAS,                          \
+                    old_expected, *(Type*) desired,                     \
+                    &old_value, amo_order_flags(succ));                 \
+    *result = (chpl_bool32)(old_value == old_expected);                 \
+    if (!*result) memcpy(expected, &old_value, sizeof(Type));           \
+  }
+
+DEFN_CHPL_COMM_ATOMIC_CMPXCHG(int32, int32_t)
+DEFN_CHPL_COMM_ATOMIC_CMPXCHG(int64, int64_t)
+DEFN_CHPL_COMM_ATOMIC_CMPXCHG(uint32, uint32_t)
+DEFN_CHPL_COMM_ATOMIC_CMPXCHG(uint64, uint64_t)
+DEFN_CHPL_COMM_ATOMIC_CMPXCHG(real32, _real32)
+DEFN_CHPL_COMM_ATOMIC_CMPXCHG(real64, _real64)
+
+
+//
+// GASNet-EX has native subtraction, so unlike the other comm layers
+// we don't need to negate the operand and add.
+//
+#define DEFN_IFACE_AMO_SIMPLE_OP(fnOp, gexOp, gexFOp, fnType, Type)     \
+  void chpl_comm_atomic_##fnOp##_##fnType                               \
+         (void* operand, c_nodeid_t node, void* object,                 \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo " #fnOp, node, ln, fn);            \
+    chpl_comm_diags_incr(amo);                                          \
+    do_amo_##fnType(node, object, gexOp, *(Type*) operand, 0,           \
+                    NULL, amo_order_flags(order));                      \
+  }                                                                     \
+                                                                        \
+  void chpl_comm_atomic_##fnOp##_unordered_##fnType                     \
+         (void* operand, c_nodeid_t node, void* object,                 \
+          int ln, int32_t fn) {                                         \
+    chpl_comm_diags_verbose_amo("amo unord_" #fnOp, node, ln, fn);      \
+    chpl_comm_diags_incr(amo);                                          \
+    do_amo_nbi_##fnType(node, object, gexOp, *(Type*) operand);         \
+  }                                                                     \
+                                                                        \
+  void chpl_comm_atomic_fetch_##fnOp##_##fnType                         \
+         (void* operand, c_nodeid_t node, void* object, void* result,   \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo fetch_" #fnOp, node, ln, fn);      \
+    chpl_comm_diags_incr(amo);                                          \
+    do_amo_##fnType(node, object, gexFOp, *(Type*) operand, 0,          \
+                    (Type*) result, amo_order_flags(order));            \
+  }
+
+DEFN_IFACE_AMO_SIMPLE_OP(and, GEX_OP_AND, GEX_OP_FAND, int32, int32_t)
+DEFN_IFACE_AMO_SIMPLE_OP(and, GEX_OP_AND, GEX_OP_FAND, int64, int64_t)
+DEFN_IFACE_AMO_SIMPLE_OP(and, GEX_OP_AND, GEX_OP_FAND, uint32, uint32_t)
+DEFN_IFACE_AMO_SIMPLE_OP(and, GEX_OP_AND, GEX_OP_FAND, uint64, uint64_t)
+
+DEFN_IFACE_AMO_SIMPLE_OP(or, GEX_OP_OR, GEX_OP_FOR, int32, int32_t)
+DEFN_IFACE_AMO_SIMPLE_OP(or, GEX_OP_OR, GEX_OP_FOR, int64, int64_t)
+DEFN_IFACE_AMO_SIMPLE_OP(or, GEX_OP_OR, GEX_OP_FOR, uint32, uint32_t)
+DEFN_IFACE_AMO_SIMPLE_OP(or, GEX_OP_OR, GEX_OP_FOR, uint64, uint64_t)
+
+DEFN_IFACE_AMO_SIMPLE_OP(xor, GEX_OP_XOR, GEX_OP_FXOR, int32, int32_t)
+DEFN_IFACE_AMO_SIMPLE_OP(xor, GEX_OP_XOR, GEX_OP_FXOR, int64, int64_t)
+DEFN_IFACE_AMO_SIMPLE_OP(xor, GEX_OP_XOR, GEX_OP_FXOR, uint32, uint32_t)
+DEFN_IFACE_AMO_SIMPLE_OP(xor, GEX_OP_XOR, GEX_OP_FXOR, uint64, uint64_t)
+
+DEFN_IFACE_AMO_SIMPLE_OP(add, GEX_OP_ADD, GEX_OP_FADD, int32, int32_t)
+DEFN_IFACE_AMO_SIMPLE_OP(add, GEX_OP_ADD, GEX_OP_FADD, int64, int64_t)
+DEFN_IFACE_AMO_SIMPLE_OP(add, GEX_OP_ADD, GEX_OP_FADD, uint32, uint32_t)
+DEFN_IFACE_AMO_SIMPLE_OP(add, GEX_OP_ADD, GEX_OP_FADD, uint64, uint64_t)
+DEFN_IFACE_AMO_SIMPLE_OP(add, GEX_OP_ADD, GEX_OP_FADD, real32, _real32)
+DEFN_IFACE_AMO_SIMPLE_OP(add, GEX_OP_ADD, GEX_OP_FADD, real64, _real64)
+
+DEFN_IFACE_AMO_SIMPLE_OP(sub, GEX_OP_SUB, GEX_OP_FSUB, int32, int32_t)
+DEFN_IFACE_AMO_SIMPLE_OP(sub, GEX_OP_SUB, GEX_OP_FSUB, int64, int64_t)
+DEFN_IFACE_AMO_SIMPLE_OP(sub, GEX_OP_SUB, GEX_OP_FSUB, uint32, uint32_t)
+DEFN_IFACE_AMO_SIMPLE_OP(sub, GEX_OP_SUB, GEX_OP_FSUB, uint64, uint64_t)
+DEFN_IFACE_AMO_SIMPLE_OP(sub, GEX_OP_SUB, GEX_OP_FSUB, real32, _real32)
+DEFN_IFACE_AMO_SIMPLE_OP(sub, GEX_OP_SUB, GEX_OP_FSUB, real64, _real64)
+
+//
+// Unordered AMOs are issued as GASNet implicit-handle ops, which are
+// tracked per thread.  This relies on a task not migrating between
+// threads in between its unordered AMOs and the fence, which holds
+// for all our tasking layers.
+//
+void chpl_comm_atomic_unordered_task_fence(void) {
+  gex_NBI_Wait(GEX_EC_RMW, 0);
+}
+#endif
+
 static inline
 void  execute_on_common(c_nodeid_t node, c_sublocid_t subloc,
                         chpl_fn_int_t fid,
@@ -1536,6 +2127,83 @@ void  execute_on_common(c_nodeid_t node, c_sublocid_t subloc,
     wait_done_obj(&done, !fast);
 }
 
+void chpl_comm_impl_remote_alloc(c_nodeid_t node, size_t size, size_t n,
+                                 void** ptrs) {
+  done_t done;
+  alloc_req_t req = { .ptrs = ptrs, .ack = &done, .size = size, .n = n };
+
+  init_done_obj(&done, 1);
+  GASNET_Safe(gasnet_AMRequestMedium0(node, ALLOC, &req, sizeof(req)));
+  wait_done_obj(&done, false);
+}
+
+void chpl_comm_impl_remote_free(c_nodeid_t node, void* p) {
+  GASNET_Safe(gasnet_AMRequestShort2(node, FREE, Arg0(p), Arg1(p)));
+}
+
+//
+// Collectives, through the GASNet-EX ones.  As in chpl_comm_barrier()
+// we poll for completion ourselves, yielding in between, rather than
+// having GASNet block us in gex_Event_Wait().
+//
+static
+void wait_coll_event(gex_Event_t ev) {
+  while (gex_Event_Test(ev) != GASNET_OK) {
+    chpl_task_yield();
+  }
+}
+
+chpl_bool chpl_comm_impl_allreduce(void* buf, size_t count,
+                                   chpl_comm_coll_type_t type,
+                                   chpl_comm_coll_op_t op) {
+  gex_DT_t dt;
+  size_t dt_sz;
+  gex_OP_t gop;
+  void* src;
+
+  switch (type) {
+  case chpl_comm_coll_int32:  dt = GEX_DT_I32; dt_sz = 4; break;
+  case chpl_comm_coll_int64:  dt = GEX_DT_I64; dt_sz = 8; break;
+  case chpl_comm_coll_uint32: dt = GEX_DT_U32; dt_sz = 4; break;
+  case chpl_comm_coll_uint64: dt = GEX_DT_U64; dt_sz = 8; break;
+  case chpl_comm_coll_real32: dt = GEX_DT_FLT; dt_sz = 4; break;
+  case chpl_comm_coll_real64: dt = GEX_DT_DBL; dt_sz = 8; break;
+  default: return false;
+  }
+
+  switch (op) {
+  case chpl_comm_coll_sum:  gop = GEX_OP_ADD;  break;
+  case chpl_comm_coll_prod: gop = GEX_OP_MULT; break;
+  case chpl_comm_coll_min:  gop = GEX_OP_MIN;  break;
+  case chpl_comm_coll_max:  gop = GEX_OP_MAX;  break;
+  case chpl_comm_coll_band: gop = GEX_OP_AND;  break;
+  case chpl_comm_coll_bor:  gop = GEX_OP_OR;   break;
+  case chpl_comm_coll_bxor: gop = GEX_OP_XOR;  break;
+  default: return false;
+  }
+
+  if ((dt == GEX_DT_FLT || dt == GEX_DT_DBL)
+      && (gop == GEX_OP_AND || gop == GEX_OP_OR || gop == GEX_OP_XOR)) {
+    return false;
+  }
+
+  //
+  // GASNet doesn't promise the reduction can be done in place.
+  //
+  src = chpl_mem_alloc(count * dt_sz, CHPL_RT_MD_COMM_COLL_BUF, 0, 0);
+  chpl_memcpy(src, buf, count * dt_sz);
+  wait_coll_event(gex_Coll_ReduceToAllNB(gex_tm, buf, src, dt, dt_sz, count,
+                                         gop, NULL, NULL, 0));
+  chpl_mem_free(src, 0, 0);
+  return true;
+}
+
+chpl_bool chpl_comm_impl_bcast(void* buf, size_t size, c_nodeid_t root) {
+  wait_coll_event(gex_Coll_BroadcastNB(gex_tm, (gex_Rank_t) root,
+                                       buf, buf, size, 0));
+  return true;
+}
+
 ////GASNET - introduce locale-int size
 ////GASNET - is caller in chpl_comm_on_bundle_t redundant? active message can determine this.
 void  chpl_comm_execute_on(c_nodeid_t node, c_sublocid_t subloc,
@@ -1556,9 +2224,12 @@ void  chpl_comm_execute_on(c_nodeid_t node, c_sublocid_t subloc,
 
     chpl_comm_diags_verbose_executeOn("", node, ln, fn);
     chpl_comm_diags_incr(execute_on);
+    const uint64_t lat_start = chpl_comm_diags_lat_start();
 
     execute_on_common(node, subloc, fid, arg, arg_size,
                      /*fast*/ false, /*blocking*/ true);
+
+    chpl_comm_diags_lat_end(execute_on, lat_start);
   }
 }
 
@@ -1610,3 +2281,28 @@ void  chpl_comm_execute_on_fast(c_nodeid_t node, c_sublocid_t subloc,
                       /*fast*/ true, /*blocking*/ true);
   }
 }
+
+// GASNET - should only be called for "small" functions
+void  chpl_comm_execute_on_fast_nb(c_nodeid_t node, c_sublocid_t subloc,
+                                   chpl_fn_int_t fid,
+                                   chpl_comm_on_bundle_t *arg, size_t arg_size,
+                                   int ln, int32_t fn) {
+  if (chpl_nodeID == node) {
+    assert(0);
+    chpl_ftable_call(fid, arg);
+  } else {
+    // Communications callback support
+    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn_fast)) {
+      chpl_comm_cb_info_t cb_data =
+        {chpl_comm_cb_event_kind_executeOn_fast, chpl_nodeID, node,
+         .iu.executeOn={subloc, fid, arg, arg_size, ln, fn}};
+      chpl_comm_do_callbacks (&cb_data);
+    }
+
+    chpl_comm_diags_verbose_executeOn("non-blocking fast", node, ln, fn);
+    chpl_comm_diags_incr(execute_on_fast);
+
+    execute_on_common(node, subloc, fid, arg, arg_size,
+                      /*fast*/ true, /*blocking*/ false);
+  }
+}
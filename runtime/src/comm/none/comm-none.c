@@ -67,6 +67,18 @@ chpl_comm_nb_handle_t chpl_comm_put_nb(void *addr, c_nodeid_t node, void* raddr,
   return NULL;
 }
 
+chpl_comm_nb_handle_t chpl_comm_put_nb_v(int v_len, void** addr_v,
+                                         c_nodeid_t node, void** raddr_v,
+                                         size_t* size_v, int32_t commID,
+                                         int ln, int32_t fn)
+{
+  int vi;
+  assert(node == 0);
+  for (vi = 0; vi < v_len; vi++)
+    chpl_memmove(raddr_v[vi], addr_v[vi], size_v[vi]);
+  return NULL;
+}
+
 chpl_comm_nb_handle_t chpl_comm_get_nb(void* addr, c_nodeid_t node, void* raddr,
                                        size_t size, int32_t commID,
                                        int ln, int32_t fn)
@@ -259,3 +271,13 @@ void chpl_comm_execute_on_fast(c_nodeid_t node, c_sublocid_t subloc,
 
   chpl_ftable_call(fid, arg);
 }
+
+// There is no other node, so the common code never calls these.
+void chpl_comm_impl_remote_alloc(c_nodeid_t node, size_t size, size_t n,
+                                 void** ptrs) {
+  chpl_internal_error("comm=none: remote allocation requested");
+}
+
+void chpl_comm_impl_remote_free(c_nodeid_t node, void* p) {
+  chpl_internal_error("comm=none: remote free requested");
+}
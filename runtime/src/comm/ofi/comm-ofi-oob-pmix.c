@@ -0,0 +1,177 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// PMIx-based out-of-band support for the OFI-based Chapel comm layer.
+//
+// The collectives here are built on the PMIx key-value store: each
+// process puts its contribution, a fence publishes everything, and
+// then each process gets what it needs.  The PMIx server keeps the
+// published data in a node-local shared-memory store, so processes
+// on the same node share one copy of it rather than each receiving
+// its own, which matters for the address exchange at startup on
+// large jobs.
+//
+
+#include "chplrt.h"
+#include "chpl-env-gen.h"
+
+#include "chpl-comm.h"
+#include "chpl-mem.h"
+#include "chpl-mem-sys.h"
+#include "chpl-gen-includes.h"
+#include "chplsys.h"
+#include "error.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <pmix.h>
+
+#include "comm-ofi-internal.h"
+
+
+#define PMIX_CHK(expr) CHK_EQ_TYPED(expr, PMIX_SUCCESS, pmix_status_t, "d")
+
+
+static pmix_proc_t myProc;
+
+//
+// Each collective publishes under its own keys, so that a later one
+// can never pick up a value left over from an earlier one.
+//
+static int collSeq;
+
+
+static
+void setProc(pmix_proc_t* proc, pmix_rank_t rank) {
+  PMIX_PROC_CONSTRUCT(proc);
+  (void) strncpy(proc->nspace, myProc.nspace, PMIX_MAX_NSLEN);
+  proc->rank = rank;
+}
+
+
+static
+void fence(chpl_bool collect) {
+  pmix_info_t info;
+  bool flag = true;
+
+  PMIX_INFO_CONSTRUCT(&info);
+  PMIX_INFO_LOAD(&info, PMIX_COLLECT_DATA, &flag, PMIX_BOOL);
+  PMIX_CHK(PMIx_Fence(NULL, 0, collect ? &info : NULL, collect ? 1 : 0));
+  PMIX_INFO_DESTRUCT(&info);
+}
+
+
+static
+void putBytes(const char* key, const void* buf, size_t size) {
+  pmix_value_t val;
+
+  PMIX_VALUE_CONSTRUCT(&val);
+  val.type = PMIX_BYTE_OBJECT;
+  val.data.bo.bytes = (char*) buf;
+  val.data.bo.size = size;
+  PMIX_CHK(PMIx_Put(PMIX_GLOBAL, key, &val));
+  PMIX_CHK(PMIx_Commit());
+}
+
+
+static
+void getBytes(pmix_rank_t rank, const char* key, void* buf, size_t size) {
+  pmix_proc_t proc;
+  pmix_value_t* val;
+
+  setProc(&proc, rank);
+  PMIX_CHK(PMIx_Get(&proc, key, NULL, 0, &val));
+  CHK_TRUE(val->type == PMIX_BYTE_OBJECT && val->data.bo.size == size);
+  memcpy(buf, val->data.bo.bytes, size);
+  PMIX_VALUE_RELEASE(val);
+}
+
+
+void chpl_comm_ofi_oob_init(void) {
+  if (!PMIx_Initialized()) {
+    pmix_proc_t proc;
+    pmix_value_t* val;
+
+    PMIX_CHK(PMIx_Init(&myProc, NULL, 0));
+    setProc(&proc, PMIX_RANK_WILDCARD);
+    PMIX_CHK(PMIx_Get(&proc, PMIX_JOB_SIZE, NULL, 0, &val));
+    chpl_nodeID = (c_nodeid_t) myProc.rank;
+    chpl_numNodes = (int32_t) val->data.uint32;
+    PMIX_VALUE_RELEASE(val);
+  }
+
+  DBG_PRINTF(DBG_OOB, "OOB init: node %" PRI_c_nodeid_t " of %" PRId32,
+             chpl_nodeID, chpl_numNodes);
+}
+
+
+void chpl_comm_ofi_oob_fini(void) {
+  if (PMIx_Initialized()) {
+    DBG_PRINTF(DBG_OOB, "OOB finalize");
+    PMIX_CHK(PMIx_Finalize(NULL, 0));
+  }
+}
+
+
+void chpl_comm_ofi_oob_barrier(void) {
+  DBG_PRINTF(DBG_OOB, "OOB barrier");
+  fence(false);
+}
+
+
+void chpl_comm_ofi_oob_allgather(const void* mine, void* all, size_t size) {
+  DBG_PRINTF(DBG_OOB, "OOB allGather: %zd", size);
+
+  char key[PMIX_MAX_KEYLEN + 1];
+  snprintf(key, sizeof(key), "chpl.allgather.%d", collSeq++);
+
+  putBytes(key, mine, size);
+  fence(true);
+
+  for (int i = 0; i < chpl_numNodes; i++) {
+    char* p_a = (char*) all + i * size;
+    if (i == chpl_nodeID) {
+      memcpy(p_a, mine, size);
+    } else {
+      getBytes((pmix_rank_t) i, key, p_a, size);
+    }
+  }
+}
+
+
+void chpl_comm_ofi_oob_bcast(void* buf, size_t size) {
+  DBG_PRINTF(DBG_OOB, "OOB bcast: %zd", size);
+
+  char key[PMIX_MAX_KEYLEN + 1];
+  snprintf(key, sizeof(key), "chpl.bcast.%d", collSeq++);
+
+  if (chpl_nodeID == 0) {
+    putBytes(key, buf, size);
+  }
+  fence(true);
+  if (chpl_nodeID != 0) {
+    getBytes(0, key, buf, size);
+  }
+}
@@ -25,6 +25,8 @@
 #include "chplrt.h"
 #include "chpl-env-gen.h"
 
+#include "chpl-align.h"
+
 #include "chpl-comm.h"
 #include "chpl-comm-callbacks.h"
 #include "chpl-comm-callbacks-internal.h"
@@ -51,6 +53,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <limits.h>
 #include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -67,6 +70,7 @@
 #include <rdma/fabric.h>
 #include <rdma/fi_atomic.h>
 #include <rdma/fi_cm.h>
+#include <rdma/fi_collective.h>
 #include <rdma/fi_domain.h>
 #include <rdma/fi_endpoint.h>
 #include <rdma/fi_errno.h>
@@ -134,8 +138,33 @@ static void (*checkRxRmaCmplsFn)(void); // fn: check for RMA/AMO EP completions
 static struct fid_av* ofi_av;           // address vector
 static fi_addr_t* ofi_rxAddrs;          // table of remote endpoint addresses
 
-#define rxMsgAddr(tcip, n) (ofi_rxAddrs[2 * (n)])
-#define rxRmaAddr(tcip, n) (ofi_rxAddrs[2 * (n) + 1])
+//
+// With lazy AV insertion (CHPL_RT_COMM_OFI_LAZY_AV) we keep the raw
+// endpoint names from the startup exchange and only insert a node's
+// pair of them into the AV the first time we send to that node.  A
+// program in which each node only talks to a few others then never
+// pays to insert (and for some providers, connect to) all the rest.
+//
+static chpl_bool avLazy;                // insert AV entries on first use?
+static char* ofi_rxNames;               // raw rx EP names, 2 per node
+static size_t ofi_rxNameLen;            // length of one rx EP name
+static atomic_bool* ofi_rxAddrsValid;   // node's ofi_rxAddrs[] are set?
+static pthread_mutex_t avInsertLock = PTHREAD_MUTEX_INITIALIZER;
+
+static void avInsertNode(c_nodeid_t);
+
+static inline
+fi_addr_t rxAddr(c_nodeid_t node, int which) {
+  if (avLazy
+      && !atomic_load_explicit_bool(&ofi_rxAddrsValid[node],
+                                    memory_order_acquire)) {
+    avInsertNode(node);
+  }
+  return ofi_rxAddrs[2 * node + which];
+}
+
+#define rxMsgAddr(tcip, n) rxAddr(n, 0)
+#define rxRmaAddr(tcip, n) rxAddr(n, 1)
 
 //
 // Transmit support.
@@ -143,6 +172,20 @@ static fi_addr_t* ofi_rxAddrs;          // table of remote endpoint addresses
 static int numTxCtxs;
 static int numRxCtxs;
 
+//
+// Bounce buffers for RMA to and from local memory that isn't
+// registered come from pools in the tx contexts, in power-of-2 size
+// classes from BB_MIN_SIZE to BB_MAX_SIZE.  Being in the tx context
+// means only the thread holding it touches the pool, so no locking.
+// Bigger transfers are pipelined through a pair of BB_MAX_SIZE
+// buffers.
+//
+#define BB_MIN_SIZE_LOG2 6
+#define BB_MAX_SIZE_LOG2 16
+#define BB_NUM_CLASSES (BB_MAX_SIZE_LOG2 - BB_MIN_SIZE_LOG2 + 1)
+#define BB_MAX_SIZE ((size_t) 1 << BB_MAX_SIZE_LOG2)
+#define BB_POOL_DEPTH 4
+
 struct perTxCtxInfo_t {
   atomic_bool allocated;        // true: in use; false: available
   chpl_bool bound;              // true: bound to an owner (usually a thread)
@@ -156,6 +199,9 @@ struct perTxCtxInfo_t {
   void (*ensureProgressFn)(struct perTxCtxInfo_t*);
   uint64_t numTxnsOut;          // number of transactions in flight now
   uint64_t numTxnsSent;         // number of transactions ever initiated
+                                // free bounce buffers, by size class
+  void* bbPool[BB_NUM_CLASSES];
+  int bbPoolLen[BB_NUM_CLASSES];
 };
 
 static int tciTabLen;
@@ -187,6 +233,37 @@ typedef struct memEntry (memTab_t)[MAX_MEM_REGIONS];
 static memTab_t memTab;
 static memTab_t* memTabMap;
 
+//
+// Regions past the first are external memory registered at run time
+// (see chpl_comm_impl_regMemRegister()).  Lookups aren't locked, so
+// an entry's size is set last when adding it and cleared first when
+// removing it; removed entries stay in the table, with size 0.
+//
+static pthread_mutex_t memTabLock = PTHREAD_MUTEX_INITIALIZER;
+
+//
+// Lazy registration cache for local memory outside the regions above,
+// so that blocking RMA to and from such memory doesn't need a bounce
+// buffer.  Entries are page-aligned and are reused LRU-style; they are
+// dropped when memory inside them is freed through the Chapel memory
+// layer.
+//
+struct mrCacheEntry {
+  char* start;
+  char* end;
+  struct fid_mr* mr;
+  void* desc;
+  uint64_t lastUse;
+  int refCnt;
+  chpl_bool stale;
+};
+
+static int mrCacheMax;                  // 0 means disabled
+static struct mrCacheEntry* mrCache;    // slots in use have mr != NULL
+static uint64_t mrCacheClock;
+static uint64_t mrCacheNextKey = MAX_MEM_REGIONS;
+static pthread_mutex_t mrCacheLock = PTHREAD_MUTEX_INITIALIZER;
+
 //
 // Messaging (AM) support.
 //
@@ -230,10 +307,23 @@ static inline void ofi_put_ll(const void*, c_nodeid_t,
                               void*, size_t, void*, struct perTxCtxInfo_t*,
                               chpl_bool);
 static inline void do_remote_put_buff(void*, c_nodeid_t, void*, size_t);
+static inline chpl_bool do_remote_put_agg(void*, c_nodeid_t, void*, size_t);
+static inline void put_agg_flush(void);
+struct bitmap_t;
+static void ofi_put_V(int, void**, void**, c_nodeid_t*, void**, uint64_t*,
+                      size_t*, struct bitmap_t*);
+struct nbHandle;
+static chpl_comm_nb_handle_t ofi_get_nb(void*, c_nodeid_t, void*, size_t);
+static chpl_bool nbHandleCheck(struct nbHandle*);
+static void nbHandleFree(struct nbHandle*);
 static inline chpl_comm_nb_handle_t ofi_get(void*, c_nodeid_t,
                                             void*, size_t);
 static inline void ofi_get_ll(void*, c_nodeid_t,
                               void*, size_t, void*, struct perTxCtxInfo_t*);
+static void ofi_put_bounced(struct perTxCtxInfo_t*, const void*, c_nodeid_t,
+                            uint64_t, uint64_t, size_t);
+static void ofi_get_bounced(struct perTxCtxInfo_t*, void*, c_nodeid_t,
+                            uint64_t, uint64_t, size_t);
 static inline void do_remote_get_buff(void*, c_nodeid_t, void*, size_t);
 static inline void do_remote_amo_nf_buff(void*, c_nodeid_t, void*, size_t,
                                          enum fi_op, enum fi_datatype);
@@ -251,6 +341,9 @@ static inline void waitForPutsVisAllNodes(struct perTxCtxInfo_t*,
                                           chpl_comm_taskPrvData_t*, chpl_bool);
 static void* allocBounceBuf(size_t);
 static void freeBounceBuf(void*);
+static void* bbAlloc(struct perTxCtxInfo_t*, size_t);
+static void bbFree(struct perTxCtxInfo_t*, void*, size_t);
+static void bbPoolDrain(struct perTxCtxInfo_t*);
 static inline void local_yield(void);
 
 static void time_init(void);
@@ -588,6 +681,7 @@ static uint32_t** orderDummyMap;
 
 struct bitmap_t {
   size_t len;
+  size_t numSet;                // number of bits set, for quick isEmpty
   bitmapBaseType_t map[0];
 };
 
@@ -619,6 +713,7 @@ size_t bitmapSizeof(size_t len) {
 static inline
 void bitmapZero(struct bitmap_t* b) {
   memset(&b->map, 0, bitmapSizeofMap(b->len));
+  b->numSet = 0;
 }
 
 static inline
@@ -626,19 +721,30 @@ bitmapBaseType_t bitmapElemBit(size_t i) {
   return ((bitmapBaseType_t) 1) << bitmapOff(i);
 }
 
+static inline
+int bitmapTest(struct bitmap_t* b, size_t i) {
+  return (b->map[bitmapElemIdx(i)] & bitmapElemBit(i)) != 0;
+}
+
 static inline
 void bitmapClear(struct bitmap_t* b, size_t i) {
-  b->map[bitmapElemIdx(i)] &= ~bitmapElemBit(i);
+  if (bitmapTest(b, i)) {
+    b->map[bitmapElemIdx(i)] &= ~bitmapElemBit(i);
+    b->numSet--;
+  }
 }
 
 static inline
 void bitmapSet(struct bitmap_t* b, size_t i) {
-  b->map[bitmapElemIdx(i)] |= bitmapElemBit(i);
+  if (!bitmapTest(b, i)) {
+    b->map[bitmapElemIdx(i)] |= bitmapElemBit(i);
+    b->numSet++;
+  }
 }
 
 static inline
-int bitmapTest(struct bitmap_t* b, size_t i) {
-  return (b->map[bitmapElemIdx(i)] & bitmapElemBit(i)) != 0;
+chpl_bool bitmapIsEmpty(struct bitmap_t* b) {
+  return b->numSet == 0;
 }
 
 #define BITMAP_FOREACH_SET(b, i)                                        \
@@ -718,7 +824,8 @@ chpl_comm_taskPrvData_t* get_comm_taskPrvdata(void) {
 enum BuffType {
   amo_nf_buff = 1 << 0,
   get_buff    = 1 << 1,
-  put_buff    = 1 << 2
+  put_buff    = 1 << 2,
+  put_agg_buff = 1 << 3
 };
 
 // Per task information about non-fetching AMO buffers
@@ -758,6 +865,7 @@ typedef struct {
   size_t        size_v[MAX_CHAINED_PUT_LEN];
   uint64_t      remote_mr_v[MAX_CHAINED_PUT_LEN];
   void*         local_mr_v[MAX_CHAINED_PUT_LEN];
+  double        firstTime;       // when entry 0 was added (put_agg_buff)
   struct bitmap_t nodeBitmap;
 } put_buff_task_info_t;
 
@@ -783,6 +891,7 @@ void* task_local_buff_acquire(enum BuffType t, size_t extra_size) {
   DEFINE_INIT(amo_nf_buff_task_info_t, amo_nf_buff);
   DEFINE_INIT(get_buff_task_info_t, get_buff);
   DEFINE_INIT(put_buff_task_info_t, put_buff);
+  DEFINE_INIT(put_buff_task_info_t, put_agg_buff);
 
 #undef DEFINE_INIT
   return NULL;
@@ -810,6 +919,7 @@ void task_local_buff_flush(enum BuffType t) {
                amo_nf_buff_task_info_flush);
   DEFINE_FLUSH(get_buff_task_info_t, get_buff, get_buff_task_info_flush);
   DEFINE_FLUSH(put_buff_task_info_t, put_buff, put_buff_task_info_flush);
+  DEFINE_FLUSH(put_buff_task_info_t, put_agg_buff, put_buff_task_info_flush);
 
 #undef DEFINE_FLUSH
 }
@@ -834,6 +944,7 @@ void task_local_buff_end(enum BuffType t) {
              amo_nf_buff_task_info_flush);
   DEFINE_END(get_buff_task_info_t, get_buff, get_buff_task_info_flush);
   DEFINE_END(put_buff_task_info_t, put_buff, put_buff_task_info_flush);
+  DEFINE_END(put_buff_task_info_t, put_agg_buff, put_buff_task_info_flush);
 
 #undef END
 }
@@ -860,6 +971,11 @@ static void init_ofiForAms(void);
 
 static void init_bar(void);
 
+static void init_amoReadCache(void);
+static void init_putAgg(void);
+static void init_amoCombine(void);
+static void init_tciStats(void);
+
 static void init_broadcast_private(void);
 
 
@@ -868,6 +984,8 @@ static void init_broadcast_private(void);
 //
 static inline int mrGetLocalKey(void*, size_t);
 static inline int mrGetDesc(void**, void*, size_t);
+static int mrCacheGetDesc(void**, struct mrCacheEntry**, void*, size_t);
+static void mrCacheRelease(struct mrCacheEntry*);
 
 
 void chpl_comm_init(int *argc_p, char ***argv_p) {
@@ -876,6 +994,10 @@ void chpl_comm_init(int *argc_p, char ***argv_p) {
   time_init();
   chpl_comm_ofi_oob_init();
   DBG_INIT();
+  init_amoReadCache();
+  init_putAgg();
+  init_amoCombine();
+  init_tciStats();
 
   //
   // The user can specify the provider by setting either the Chapel
@@ -1169,18 +1291,125 @@ chpl_bool isGoodCoreProvider(struct fi_info* info) {
 }
 
 
+static inline
+chpl_bool isAcceptableProv(struct fi_info* info,
+                           chpl_bool skip_ungood_provs,
+                           chpl_bool skip_RxD_provs,
+                           chpl_bool skip_RxM_provs) {
+  return !(   (skip_ungood_provs && !isGoodCoreProvider(info))
+           || (skip_RxD_provs && isInProvider("ofi_rxd", info))
+           || (skip_RxM_provs && isInProvider("ofi_rxm", info)));
+}
+
+
+//
+// Is this provider entry's NIC attached near our CPUs?  1 if so, 0 if
+// not, -1 if we can't tell.
+//
+static
+int isNicNear(struct fi_info* info) {
+  if (info->nic == NULL
+      || info->nic->bus_attr == NULL
+      || info->nic->bus_attr->bus_type != FI_BUS_PCI) {
+    return -1;
+  }
+
+  const struct fi_pci_attr* pci = &info->nic->bus_attr->attr.pci;
+  return chpl_topo_isPCIDevNear(pci->domain_id, pci->bus_id,
+                                pci->device_id, pci->function_id);
+}
+
+
+//
+// How far is this provider entry's NIC from our CPUs, in NUMA distance
+// units?  -1 if we can't tell.
+//
+static
+int nicDistance(struct fi_info* info) {
+  if (info->nic == NULL
+      || info->nic->bus_attr == NULL
+      || info->nic->bus_attr->bus_type != FI_BUS_PCI) {
+    return -1;
+  }
+
+  const struct fi_pci_attr* pci = &info->nic->bus_attr->attr.pci;
+  return chpl_topo_getPCIDevDistance(pci->domain_id, pci->bus_id,
+                                     pci->device_id, pci->function_id);
+}
+
+
 static inline
 struct fi_info* findProvInList(struct fi_info* info,
                                chpl_bool skip_ungood_provs,
                                chpl_bool skip_RxD_provs,
                                chpl_bool skip_RxM_provs) {
   while (info != NULL
-         && (   (skip_ungood_provs && !isGoodCoreProvider(info))
-             || (skip_RxD_provs && isInProvider("ofi_rxd", info))
-             || (skip_RxM_provs && isInProvider("ofi_rxm", info)))) {
+         && !isAcceptableProv(info, skip_ungood_provs,
+                              skip_RxD_provs, skip_RxM_provs)) {
     info = info->next;
   }
-  return (info == NULL) ? NULL : fi_dupinfo(info);
+
+  if (info == NULL) {
+    return NULL;
+  }
+
+  //
+  // A node may have several NICs, each of which the provider lists as
+  // a separate domain.  Among the entries for the same provider as the
+  // first acceptable one, use the domain named by the user, if any, or
+  // else the one whose NIC is the least NUMA distance from the CPUs
+  // we're running on.  If the distances aren't known, use the first
+  // one whose NIC is near our CPUs.  With one process per socket (for
+  // example) this spreads processes across the NICs instead of having
+  // them all share the first one.
+  //
+  const char* domName = chpl_env_rt_get("COMM_OFI_DOMAIN", NULL);
+  struct fi_info* best = NULL;
+  struct fi_info* firstNear = NULL;
+  int bestDist = -1;
+  for (struct fi_info* p = info; p != NULL; p = p->next) {
+    if (strcmp(p->fabric_attr->prov_name, info->fabric_attr->prov_name) != 0
+        || !isAcceptableProv(p, skip_ungood_provs,
+                             skip_RxD_provs, skip_RxM_provs)) {
+      continue;
+    }
+    if (domName != NULL) {
+      if (p->domain_attr->name != NULL
+          && strcmp(p->domain_attr->name, domName) == 0) {
+        best = p;
+        break;
+      }
+    } else {
+      int dist = nicDistance(p);
+      if (dist >= 0 && (bestDist < 0 || dist < bestDist)) {
+        best = p;
+        bestDist = dist;
+      } else if (dist < 0 && firstNear == NULL && isNicNear(p) == 1) {
+        firstNear = p;
+      }
+    }
+  }
+
+  if (best == NULL) {
+    best = firstNear;
+  }
+
+  if (best == NULL && domName != NULL && chpl_nodeID == 0) {
+    static chpl_bool warned = false;
+    if (!warned) {
+      char msg[200];
+      (void) snprintf(msg, sizeof(msg),
+                      "CHPL_RT_COMM_OFI_DOMAIN \"%s\" not found for "
+                      "provider \"%s\"; using \"%s\"",
+                      domName, info->fabric_attr->prov_name,
+                      (info->domain_attr->name == NULL)
+                      ? "<none>" : info->domain_attr->name);
+      chpl_warning(msg, 0, 0);
+      warned = true;
+    }
+  }
+
+  return fi_dupinfo((best == NULL) ? info : best);
 }
 
 
@@ -1494,8 +1723,10 @@ void init_ofiFabricDomain(void) {
 
   if (verbosity >= 2) {
     if (chpl_nodeID == 0) {
-      printf("COMM=ofi: using \"%s\" provider\n",
-             ofi_info->fabric_attr->prov_name);
+      printf("COMM=ofi: using \"%s\" provider, \"%s\" domain\n",
+             ofi_info->fabric_attr->prov_name,
+             (ofi_info->domain_attr->name == NULL)
+             ? "<none>" : ofi_info->domain_attr->name);
     }
   }
 
@@ -1922,15 +2153,48 @@ void init_ofiExchangeAvInfo(void) {
   // Only when the provider cannot support scalable EPs and we have
   // multiple actual endpoints are the AVs individualized to those.
   //
+  // With lazy insertion we just hang onto the names here and let
+  // rxAddr() insert each node's on first reference.
+  //
   CHPL_CALLOC(ofi_rxAddrs, 2 * chpl_numNodes);
-  CHK_TRUE(fi_av_insert(ofi_av, addrs, 2 * chpl_numNodes, ofi_rxAddrs, 0, NULL)
-           == 2 * chpl_numNodes);
+  avLazy = chpl_env_rt_get_bool("COMM_OFI_LAZY_AV", false);
+  if (avLazy) {
+    ofi_rxNames = addrs;
+    ofi_rxNameLen = my_addr_len;
+    CHPL_CALLOC(ofi_rxAddrsValid, chpl_numNodes);
+    for (int i = 0; i < chpl_numNodes; i++) {
+      ofi_rxAddrs[2 * i] = ofi_rxAddrs[2 * i + 1] = FI_ADDR_NOTAVAIL;
+      atomic_init_bool(&ofi_rxAddrsValid[i], false);
+    }
+  } else {
+    CHK_TRUE(fi_av_insert(ofi_av, addrs, 2 * chpl_numNodes, ofi_rxAddrs,
+                          0, NULL)
+             == 2 * chpl_numNodes);
+    CHPL_FREE(addrs);
+  }
 
   CHPL_FREE(my_addr);
-  CHPL_FREE(addrs);
 }
 
 
+static
+void avInsertNode(c_nodeid_t node) {
+  PTHREAD_CHK(pthread_mutex_lock(&avInsertLock));
+  if (!atomic_load_explicit_bool(&ofi_rxAddrsValid[node],
+                                 memory_order_acquire)) {
+    DBG_PRINTF(DBG_CFG_AV, "lazy AV insert for node %" PRI_c_nodeid_t, node);
+    CHK_TRUE(fi_av_insert(ofi_av, ofi_rxNames + 2 * node * ofi_rxNameLen, 2,
+                          &ofi_rxAddrs[2 * node], 0, NULL)
+             == 2);
+    atomic_store_explicit_bool(&ofi_rxAddrsValid[node], true,
+                               memory_order_release);
+  }
+  PTHREAD_CHK(pthread_mutex_unlock(&avInsertLock));
+}
+
+
+static void init_mrCache(void);
+
 static
 void init_ofiForMem(void) {
   void* fixedHeapStart;
@@ -2012,6 +2276,8 @@ void init_ofiForMem(void) {
     CHPL_CALLOC(memTabMap, chpl_numNodes);
     chpl_comm_ofi_oob_allgather(&memTab, memTabMap, sizeof(memTabMap[0]));
   }
+
+  init_mrCache();
 }
 
 
@@ -2194,11 +2460,16 @@ static void fini_amHandling(void);
 static void fini_ofi(void);
 
 static void amRequestShutdown(c_nodeid_t);
+static void amLatReport(void);
+static void tciStatsReport(void);
 
 void chpl_comm_pre_task_exit(int all) {
   DBG_PRINTF(DBG_IFACE_SETUP, "%s(%d)", __func__, all);
 
   if (all) {
+    amLatReport();
+    tciStatsReport();
+
     if (chpl_nodeID == 0) {
       for (int node = 1; node < chpl_numNodes; node++) {
         amRequestShutdown(node);
@@ -2251,13 +2522,21 @@ static void exit_any(int status) {
 }
 
 
+static void fini_mrCache(void);
+static void fini_barColl(void);
+
 static
 void fini_ofi(void) {
   if (chpl_numNodes <= 1)
     return;
 
+  fini_barColl();
+  fini_mrCache();
+
   for (int i = 0; i < numMemRegions; i++) {
-    OFI_CHK(fi_close(&ofiMrTab[i]->fid));
+    if (ofiMrTab[i] != NULL) {
+      OFI_CHK(fi_close(&ofiMrTab[i]->fid));
+    }
   }
 
   if (memTabMap != NULL) {
@@ -2267,6 +2546,14 @@ void fini_ofi(void) {
   CHPL_FREE(amLZs[1]);
   CHPL_FREE(amLZs[0]);
 
+  if (avLazy) {
+    for (int i = 0; i < chpl_numNodes; i++) {
+      atomic_destroy_bool(&ofi_rxAddrsValid[i]);
+    }
+    CHPL_FREE(ofi_rxAddrsValid);
+    CHPL_FREE(ofi_rxNames);
+  }
+
   CHPL_FREE(ofi_rxAddrs);
 
   if (ofi_amhPollSet != NULL) {
@@ -2283,6 +2570,7 @@ void fini_ofi(void) {
   for (int i = 0; i < tciTabLen; i++) {
     OFI_CHK(fi_close(&tciTab[i].txCtx->fid));
     OFI_CHK(fi_close(tciTab[i].txCmplFid));
+    bbPoolDrain(&tciTab[i]);
   }
 
   if (useScalableTxEp) {
@@ -2311,6 +2599,8 @@ void fini_ofi(void) {
 static pthread_once_t fixedHeapOnce = PTHREAD_ONCE_INIT;
 static size_t fixedHeapSize;
 static void*  fixedHeapStart;
+static int    fixedHeapNumaParts;       // 0: not split by NUMA domain
+static size_t fixedHeapNumaPartSize;
 
 static pthread_once_t hugepageOnce = PTHREAD_ONCE_INIT;
 static size_t hugepageSize;
@@ -2414,7 +2704,33 @@ void init_fixedHeap(void) {
   if (start == NULL)
     chpl_error("cannot initialize heap: cannot get memory", 0, 0);
 
-  chpl_comm_regMemHeapTouch(start, size);
+  //
+  // Normally we interleave the heap across the NUMA domains.  If asked,
+  // instead split it into one contiguous part per domain, localized to
+  // that domain, so the memory layer can allocate from nearby memory.
+  //
+  int numParts = 0;
+  if (chpl_env_rt_get_bool("COMM_OFI_HEAP_NUMA_SPLIT", false)) {
+    numParts = chpl_topo_getNumNumaDomains();
+    if (numParts <= 1 || size / numParts < page_size) {
+      numParts = 0;
+    }
+  }
+
+  if (numParts > 0) {
+    const size_t partSize = ALIGN_DN(size / numParts, page_size);
+    for (int i = 0; i < numParts; i++) {
+      char* p = (char*) start + i * partSize;
+      chpl_topo_setMemLocality(p, partSize, true, i);
+    }
+    chpl_comm_regMemHeapTouchParts(start, numParts, partSize);
+    fixedHeapNumaParts = numParts;
+    fixedHeapNumaPartSize = partSize;
+    DBG_PRINTF(DBG_MR, "fixed heap split into %d NUMA parts of %#zx",
+               numParts, partSize);
+  } else {
+    chpl_comm_regMemHeapTouch(start, size);
+  }
 
   DBG_PRINTF(DBG_MR, "fixed heap on %spages, start=%p size=%#zx\n",
              have_hugepages ? "huge" : "regular ", start, size);
@@ -2478,6 +2794,111 @@ size_t chpl_comm_impl_regMemHeapPageSize(void) {
 }
 
 
+int chpl_comm_impl_regMemHeapNumaParts(size_t* partSize_p) {
+  DBG_PRINTF(DBG_IFACE_SETUP, "%s()", __func__);
+
+  PTHREAD_CHK(pthread_once(&fixedHeapOnce, init_fixedHeap));
+  *partSize_p = fixedHeapNumaPartSize;
+  return fixedHeapNumaParts;
+}
+
+
+chpl_bool chpl_comm_impl_regMemRegister(void* p, size_t size) {
+  DBG_PRINTF(DBG_IFACE_SETUP, "%s(%p, %#zx)", __func__, p, size);
+
+  //
+  // With scalable registration all memory is already registered.
+  // Otherwise, registering the memory and adding it to our own table
+  // lets it be the local side of RMA without a bounce buffer.  The
+  // other nodes' copies of our table were gathered at startup and are
+  // not updated, so RMA from other nodes that targets this memory
+  // still goes through AMs.
+  //
+  if (scalableMemReg || size == 0 || mrGetLocalKey(p, size) == 0) {
+    return false;
+  }
+
+  chpl_bool ret = false;
+  PTHREAD_CHK(pthread_mutex_lock(&memTabLock));
+
+  int i;
+  for (i = 1; i < numMemRegions && memTab[i].size != 0; i++)
+    ;
+  if (i >= MAX_MEM_REGIONS) {
+    DBG_PRINTF(DBG_MR, "%s(%p, %#zx): no free table entries",
+               __func__, p, size);
+    goto unlock;
+  }
+
+  const chpl_bool prov_key =
+    ((ofi_info->domain_attr->mr_mode & FI_MR_PROV_KEY) != 0);
+
+  uint64_t bufAcc = FI_RECV | FI_REMOTE_READ | FI_REMOTE_WRITE;
+  if ((ofi_info->domain_attr->mr_mode & FI_MR_LOCAL) != 0) {
+    bufAcc |= FI_SEND | FI_READ | FI_WRITE;
+  }
+
+  DBG_PRINTF(DBG_MR, "[%d] fi_mr_reg(%p, %#zx, %#" PRIx64 ")",
+             i, p, size, bufAcc);
+  if (fi_mr_reg(ofi_domain, p, size, bufAcc, (prov_key ? 0 : i),
+                0, 0, &ofiMrTab[i], NULL) != FI_SUCCESS) {
+    DBG_PRINTF(DBG_MR, "[%d] fi_mr_reg() failed", i);
+    ofiMrTab[i] = NULL;
+    goto unlock;
+  }
+  if ((ofi_info->domain_attr->mr_mode & FI_MR_ENDPOINT) != 0) {
+    OFI_CHK(fi_mr_bind(ofiMrTab[i], &ofi_rxEpRma->fid, 0));
+    OFI_CHK(fi_mr_enable(ofiMrTab[i]));
+  }
+
+  struct memEntry ent = { .addr = p,
+                          .base = ((ofi_info->domain_attr->mr_mode
+                                    & FI_MR_VIRT_ADDR) == 0)
+                                  ? (size_t) p
+                                  : (size_t) 0,
+                          .size = 0,
+                          .desc = fi_mr_desc(ofiMrTab[i]),
+                          .key = fi_mr_key(ofiMrTab[i]), };
+  memTab[i] = ent;
+  memTabMap[chpl_nodeID][i] = ent;
+  memTab[i].size = size;
+  memTabMap[chpl_nodeID][i].size = size;
+  if (i == numMemRegions) {
+    numMemRegions++;
+  }
+  DBG_PRINTF(DBG_MR, "[%d]     key %#" PRIx64, i, memTab[i].key);
+  ret = true;
+
+unlock:
+  PTHREAD_CHK(pthread_mutex_unlock(&memTabLock));
+  return ret;
+}
+
+
+void chpl_comm_impl_regMemDeregister(void* p, size_t size) {
+  DBG_PRINTF(DBG_IFACE_SETUP, "%s(%p, %#zx)", __func__, p, size);
+
+  PTHREAD_CHK(pthread_mutex_lock(&memTabLock));
+
+  int i;
+  for (i = 1;
+       i < numMemRegions && (memTab[i].addr != p || memTab[i].size != size);
+       i++)
+    ;
+  if (i >= numMemRegions) {
+    INTERNAL_ERROR_V("%s(%p, %#zx): not registered", __func__, p, size);
+  }
+
+  memTab[i].size = 0;
+  memTabMap[chpl_nodeID][i].size = 0;
+  DBG_PRINTF(DBG_MR, "[%d] fi_close(%p, %#zx)", i, p, size);
+  OFI_CHK(fi_close(&ofiMrTab[i]->fid));
+  ofiMrTab[i] = NULL;
+
+  PTHREAD_CHK(pthread_mutex_unlock(&memTabLock));
+}
+
+
 static
 size_t get_hugepageSize(void) {
   PTHREAD_CHK(pthread_once(&hugepageOnce, init_hugepageSize));
@@ -2574,6 +2995,193 @@ int mrGetLocalKey(void* addr, size_t size) {
 }
 
 
+static void mrCacheFreeNotify(void*);
+
+static
+void init_mrCache(void) {
+  //
+  // Only local-access registrations are cached.  A remote node can't
+  // learn about them, so they help only the initiator side of RMA.
+  //
+  if (scalableMemReg) {
+    return;
+  }
+
+  int64_t n = chpl_env_rt_get_int("COMM_OFI_MR_CACHE_ENTRIES", 0);
+  if (n <= 0) {
+    return;
+  }
+  mrCacheMax = (n > 1024) ? 1024 : (int) n;
+
+  if ((ofi_info->domain_attr->mr_mode & FI_MR_LOCAL) != 0) {
+    CHPL_CALLOC(mrCache, mrCacheMax);
+    chpl_memhook_free_notify = mrCacheFreeNotify;
+  }
+}
+
+
+static
+void mrCacheDrop(struct mrCacheEntry* ent) {
+  DBG_PRINTF(DBG_MR, "mrCache drop [%p, %p)", ent->start, ent->end);
+  OFI_CHK(fi_close(&ent->mr->fid));
+  ent->mr = NULL;
+}
+
+
+static
+void fini_mrCache(void) {
+  if (mrCache == NULL) {
+    return;
+  }
+
+  chpl_memhook_free_notify = NULL;
+  PTHREAD_CHK(pthread_mutex_lock(&mrCacheLock));
+  for (int i = 0; i < mrCacheMax; i++) {
+    if (mrCache[i].mr != NULL) {
+      mrCacheDrop(&mrCache[i]);
+    }
+  }
+  PTHREAD_CHK(pthread_mutex_unlock(&mrCacheLock));
+  CHPL_FREE(mrCache);
+}
+
+
+//
+// Get a local descriptor for memory not covered by the fixed regions,
+// registering it if needed.  On success the returned entry (which is
+// NULL if the provider doesn't need descriptors) must be released by
+// mrCacheRelease() once the transfer using the descriptor is done.
+//
+static
+int mrCacheGetDesc(void** pDesc, struct mrCacheEntry** pEnt,
+                   void* addr, size_t size) {
+  if (mrCacheMax == 0) {
+    return -1;
+  }
+
+  if (mrCache == NULL) {
+    // The provider doesn't need descriptors for local memory.
+    *pDesc = NULL;
+    *pEnt = NULL;
+    return 0;
+  }
+
+  char* myAddr = (char*) addr;
+  int ret = -1;
+
+  PTHREAD_CHK(pthread_mutex_lock(&mrCacheLock));
+
+  struct mrCacheEntry* ent = NULL;
+  struct mrCacheEntry* entFree = NULL;
+  for (int i = 0; i < mrCacheMax; i++) {
+    struct mrCacheEntry* e = &mrCache[i];
+    if (e->mr == NULL) {
+      if (entFree == NULL || entFree->mr != NULL) {
+        entFree = e;
+      }
+    } else if (!e->stale
+               && myAddr >= e->start
+               && myAddr + size <= e->end) {
+      ent = e;
+      break;
+    } else if (e->refCnt == 0
+               && (entFree == NULL
+                   || (entFree->mr != NULL
+                       && e->lastUse < entFree->lastUse))) {
+      entFree = e;
+    }
+  }
+
+  if (ent == NULL) {
+    if (entFree == NULL) {
+      // Every entry is in use; the caller will use a bounce buffer.
+      goto unlock;
+    }
+    if (entFree->mr != NULL) {
+      mrCacheDrop(entFree);
+    }
+
+    const size_t pgSize = chpl_getSysPageSize();
+    char* start = (char*) round_down_to_mask_ptr((unsigned char*) myAddr,
+                                                 pgSize - 1);
+    char* end = (char*) round_up_to_mask_ptr((unsigned char*) myAddr + size,
+                                             pgSize - 1);
+    const chpl_bool prov_key =
+      ((ofi_info->domain_attr->mr_mode & FI_MR_PROV_KEY) != 0);
+    struct fid_mr* mr;
+    if (fi_mr_reg(ofi_domain, start, end - start,
+                  FI_SEND | FI_RECV | FI_READ | FI_WRITE,
+                  0, (prov_key ? 0 : mrCacheNextKey++), 0, &mr, NULL)
+        != FI_SUCCESS) {
+      DBG_PRINTF(DBG_MR, "mrCache fi_mr_reg(%p, %#zx) failed",
+                 start, (size_t) (end - start));
+      goto unlock;
+    }
+    if ((ofi_info->domain_attr->mr_mode & FI_MR_ENDPOINT) != 0) {
+      OFI_CHK(fi_mr_bind(mr, &ofi_rxEpRma->fid, 0));
+      OFI_CHK(fi_mr_enable(mr));
+    }
+    DBG_PRINTF(DBG_MR, "mrCache add [%p, %p)", start, end);
+
+    ent = entFree;
+    *ent = (struct mrCacheEntry) { .start = start,
+                                   .end = end,
+                                   .mr = mr,
+                                   .desc = fi_mr_desc(mr), };
+  }
+
+  ent->lastUse = ++mrCacheClock;
+  ent->refCnt++;
+  *pDesc = ent->desc;
+  *pEnt = ent;
+  ret = 0;
+
+unlock:
+  PTHREAD_CHK(pthread_mutex_unlock(&mrCacheLock));
+  DBG_PRINTF(DBG_MR_DESC, "mrCacheGetDesc(%p, %zd): %s",
+             addr, size, (ret == 0) ? "ok" : "failed");
+  return ret;
+}
+
+
+static
+void mrCacheRelease(struct mrCacheEntry* ent) {
+  if (ent == NULL) {
+    return;
+  }
+
+  PTHREAD_CHK(pthread_mutex_lock(&mrCacheLock));
+  if (--ent->refCnt == 0 && ent->stale) {
+    mrCacheDrop(ent);
+  }
+  PTHREAD_CHK(pthread_mutex_unlock(&mrCacheLock));
+}
+
+
+static
+void mrCacheFreeNotify(void* p) {
+  char* myAddr = (char*) p;
+
+  //
+  // We don't know the size of the memory being freed, only where it
+  // starts, so we drop any entry that contains that start.  Entries
+  // still in use are dropped when their last user releases them.
+  //
+  PTHREAD_CHK(pthread_mutex_lock(&mrCacheLock));
+  for (int i = 0; i < mrCacheMax; i++) {
+    struct mrCacheEntry* ent = &mrCache[i];
+    if (ent->mr != NULL && myAddr >= ent->start && myAddr < ent->end) {
+      if (ent->refCnt == 0) {
+        mrCacheDrop(ent);
+      } else {
+        ent->stale = true;
+      }
+    }
+  }
+  PTHREAD_CHK(pthread_mutex_unlock(&mrCacheLock));
+}
+
+
 ////////////////////////////////////////
 //
 // Interface: memory consistency
@@ -2582,6 +3190,7 @@ int mrGetLocalKey(void* addr, size_t size) {
 static inline void amRequestNop(c_nodeid_t, chpl_bool);
 static inline chpl_bool setUpDelayedAmDone(chpl_comm_taskPrvData_t**, void**);
 static inline void retireDelayedAmDone(chpl_bool);
+static inline void retireXfers(chpl_comm_taskPrvData_t*);
 
 static inline
 void mcmReleaseOneNode(c_nodeid_t node, struct perTxCtxInfo_t* tcip,
@@ -2607,29 +3216,45 @@ static
 void mcmReleaseAllNodes(struct bitmap_t* b, struct perTxCtxInfo_t* tcip,
                         const char* dbgOrderStr) {
   //
-  // Do a transaction (dummy GET or no-op AM) on every node in a bitmap.
-  // Combined with our ordering assertions, this forces the results of
-  // previous transactions to be visible in memory.  The effects of the
+  // Do a transaction (dummy GET) on every node in a bitmap.  Combined
+  // with our ordering assertions, this forces the results of previous
+  // transactions to be visible in memory.  The effects of the
   // transactions we do here don't matter, only their completions.
   //
-  // TODO: Allow multiple of these transactions outstanding at once,
-  //       instead of waiting for each one before firing the next.
+  // We start all the GETs and then wait for them together, so the cost
+  // is about one round trip rather than one per node.
   //
+  if (bitmapIsEmpty(b)) {
+    return;
+  }
+
   struct perTxCtxInfo_t* myTcip = tcip;
   if (myTcip == NULL) {
     CHK_TRUE((myTcip = tciAlloc()) != NULL);
   }
 
-  BITMAP_FOREACH_SET(b, node) {
-    bitmapClear(b, node);
-    (*myTcip->checkTxCmplsFn)(myTcip);
-    // If using CQ, need room for at least 1 txn.
-    while (myTcip->txCQ != NULL && myTcip->numTxnsOut >= txCQLen) {
-      sched_yield();
+  if (b->numSet == 1) {
+    BITMAP_FOREACH_SET(b, node) {
+      bitmapClear(b, node);
+      mcmReleaseOneNode(node, myTcip, dbgOrderStr);
+    } BITMAP_FOREACH_SET_END
+  } else {
+    void* ctx = (myTcip->txCQ == NULL) ? NULL : txnTrkEncodeId(__LINE__);
+    BITMAP_FOREACH_SET(b, node) {
+      bitmapClear(b, node);
       (*myTcip->checkTxCmplsFn)(myTcip);
-    }
-    mcmReleaseOneNode(node, myTcip, dbgOrderStr);
-  } BITMAP_FOREACH_SET_END
+      // If using CQ, need room for at least 1 txn.
+      while (myTcip->txCQ != NULL && myTcip->numTxnsOut >= txCQLen) {
+        sched_yield();
+        (*myTcip->checkTxCmplsFn)(myTcip);
+      }
+      DBG_PRINTF(DBG_ORDER,
+                 "dummy GET from %d for %s ordering",
+                 (int) node, dbgOrderStr);
+      ofi_get_ll(orderDummy, node, orderDummyMap[node], 1, ctx, myTcip);
+    } BITMAP_FOREACH_SET_END
+    waitForTxnComplete(myTcip, ctx);
+  }
 
   if (tcip == NULL) {
     tciFree(myTcip);
@@ -2640,7 +3265,7 @@ void mcmReleaseAllNodes(struct bitmap_t* b, struct perTxCtxInfo_t* tcip,
 void chpl_comm_impl_unordered_task_fence(void) {
   DBG_PRINTF(DBG_IFACE_MCM, "%s()", __func__);
 
-  task_local_buff_end(get_buff | put_buff | amo_nf_buff);
+  task_local_buff_end(get_buff | put_buff | amo_nf_buff | put_agg_buff);
 }
 
 
@@ -2648,7 +3273,9 @@ inline
 void chpl_comm_impl_task_create(void) {
   DBG_PRINTF(DBG_IFACE_MCM, "%s()", __func__);
 
+  put_agg_flush();
   retireDelayedAmDone(false /*taskIsEnding*/);
+  retireXfers(NULL);
   waitForPutsVisAllNodes(NULL, NULL, false /*taskIsEnding*/);
 }
 
@@ -2656,7 +3283,8 @@ void chpl_comm_impl_task_create(void) {
 void chpl_comm_impl_task_end(void) {
   DBG_PRINTF(DBG_IFACE_MCM, "%s()", __func__);
 
-  task_local_buff_end(get_buff | put_buff | amo_nf_buff);
+  task_local_buff_end(get_buff | put_buff | amo_nf_buff | put_agg_buff);
+  retireXfers(NULL);
   retireDelayedAmDone(true /*taskIsEnding*/);
   waitForPutsVisAllNodes(NULL, NULL, true /*taskIsEnding*/);
 }
@@ -2672,8 +3300,10 @@ typedef enum {
   am_opExecOnLrg,                          // on-stmt, large arg
   am_opGet,                                // do an RMA GET
   am_opPut,                                // do an RMA PUT
+  am_opXfer,                               // do an RMA PUT to a 3rd node
   am_opAMO,                                // do an AMO
   am_opFree,                               // free some memory
+  am_opAlloc,                              // allocate some memory
   am_opNop,                                // do nothing; for MCM & liveness
   am_opShutdown,                           // signal main process for shutdown
 } amOp_t;
@@ -2732,18 +3362,35 @@ struct amRequest_AMO_t {
   void* result;                 // result address on initiator's node
 };
 
+struct amRequest_xfer_t {
+  struct amRequest_base_t b;
+  void* srcAddr;                // source address, on AM target node
+  void* dstAddr;                // destination address, on dstNode
+  size_t size;                  // number of bytes
+  c_nodeid_t dstNode;           // destination node
+};
+
 struct amRequest_free_t {
   struct amRequest_base_t b;
   void* p;                      // address to free, on AM target node
 };
 
+struct amRequest_alloc_t {
+  struct amRequest_base_t b;
+  size_t size;                  // bytes per block
+  uint32_t n;                   // number of blocks
+  void** ptrs;                  // block addresses go here, on initiator
+};
+
 typedef union {
   struct amRequest_base_t b;
   struct amRequest_execOn_t xo;      // present only to set the max req size
   struct amRequest_execOnLrg_t xol;
   struct amRequest_RMA_t rma;
+  struct amRequest_xfer_t xfer;
   struct amRequest_AMO_t amo;
   struct amRequest_free_t free;
+  struct amRequest_alloc_t alloc;
 } amRequest_t;
 
 struct taskArg_RMA_t {
@@ -2751,6 +3398,11 @@ struct taskArg_RMA_t {
   struct amRequest_RMA_t rma;
 };
 
+struct taskArg_xfer_t {
+  chpl_task_bundle_t hdr;
+  struct amRequest_xfer_t xfer;
+};
+
 
 #ifdef CHPL_COMM_DEBUG
 static const char* am_opName(amOp_t);
@@ -2765,15 +3417,32 @@ static void amRequestExecOn(c_nodeid_t, c_sublocid_t, chpl_fn_int_t,
                             chpl_comm_on_bundle_t*, size_t,
                             chpl_bool, chpl_bool);
 static void amRequestRMA(c_nodeid_t, amOp_t, void*, void*, size_t);
+static void amRequestXfer(c_nodeid_t, void*, c_nodeid_t, void*, size_t);
 static void amRequestAMO(c_nodeid_t, void*, const void*, const void*, void*,
                          int, enum fi_datatype, size_t);
 static void amRequestFree(c_nodeid_t, void*);
+static void amRequestAlloc(c_nodeid_t, size_t, size_t, void**);
 static void amRequestNop(c_nodeid_t, chpl_bool);
 static void amRequestCommon(c_nodeid_t, amRequest_t*, size_t,
                             amDone_t**, chpl_bool, struct perTxCtxInfo_t*);
 static inline void amWaitForDone(amDone_t*);
 
 
+void chpl_comm_impl_remote_alloc(c_nodeid_t node, size_t size, size_t n,
+                                 void** ptrs) {
+  DBG_PRINTF(DBG_IFACE,
+             "chpl_comm_impl_remote_alloc(%d, %zd, %zd, %p)",
+             (int) node, size, n, ptrs);
+  amRequestAlloc(node, size, n, ptrs);
+}
+
+
+void chpl_comm_impl_remote_free(c_nodeid_t node, void* p) {
+  DBG_PRINTF(DBG_IFACE, "chpl_comm_impl_remote_free(%d, %p)", (int) node, p);
+  amRequestFree(node, p);
+}
+
+
 void chpl_comm_execute_on(c_nodeid_t node, c_sublocid_t subloc,
                           chpl_fn_int_t fid,
                           chpl_comm_on_bundle_t *arg, size_t argSize,
@@ -2793,8 +3462,10 @@ void chpl_comm_execute_on(c_nodeid_t node, c_sublocid_t subloc,
 
   chpl_comm_diags_verbose_executeOn("", node, ln, fn);
   chpl_comm_diags_incr(execute_on);
+  const uint64_t lat_start = chpl_comm_diags_lat_start();
 
   amRequestExecOn(node, subloc, fid, arg, argSize, false, true);
+  chpl_comm_diags_lat_end(execute_on, lat_start);
 }
 
 
@@ -2925,17 +3596,55 @@ void amRequestRMA(c_nodeid_t node, amOp_t op,
 }
 
 
+//
+// Ask 'srcNode' to PUT from 'srcAddr' to 'dstAddr' on 'dstNode', so
+// that a transfer between two other nodes doesn't come through us.
+// These are unordered: the task records the 'done' indicator and only
+// waits for it at its next unordered-op fence (or when it ends, or when
+// it has too many in flight).
+//
 static inline
-void amRequestAMO(c_nodeid_t node, void* object,
-                  const void* operand1, const void* operand2, void* result,
-                  int ofiOp, enum fi_datatype ofiType, size_t size) {
+void amRequestXfer(c_nodeid_t dstNode, void* dstAddr,
+                   c_nodeid_t srcNode, void* srcAddr, size_t size) {
   assert(!isAmHandler);
-  DBG_PRINTF((ofiOp == FI_ATOMIC_READ) ? DBG_AMO_READ : DBG_AMO,
-             "AMO via AM: obj %d:%p, opnd1 <%s>, opnd2 <%s>, res %p, "
-             "op %s, typ %s, sz %zd",
-             (int) node, object,
-             DBG_VAL(operand1, ofiType), DBG_VAL(operand2, ofiType), result,
-             amo_opName(ofiOp), amo_typeName(ofiType), size);
+  amRequest_t req = { .xfer = { .b = { .op = am_opXfer,
+                                       .node = chpl_nodeID, },
+                                .srcAddr = srcAddr,
+                                .dstAddr = dstAddr,
+                                .size = size,
+                                .dstNode = dstNode, }, };
+  retireDelayedAmDone(false /*taskIsEnding*/);
+
+  chpl_comm_taskPrvData_t* prvData = get_comm_taskPrvdata();
+  if (prvData == NULL) {
+    amRequestCommon(srcNode, &req, sizeof(req.xfer),
+                    &req.b.pAmDone, true /*yieldDuringTxnWait*/, NULL);
+    return;
+  }
+
+  if (prvData->numXfers >= CHPL_COMM_OFI_MAX_XFERS) {
+    retireXfers(prvData);
+  }
+  amDone_t* pAmDone = &prvData->xferDone[prvData->numXfers++];
+  *pAmDone = 0;
+  chpl_atomic_thread_fence(memory_order_release);
+  req.b.pAmDone = pAmDone;
+  amRequestCommon(srcNode, &req, sizeof(req.xfer),
+                  NULL, true /*yieldDuringTxnWait*/, NULL);
+}
+
+
+static inline
+void amRequestAMO(c_nodeid_t node, void* object,
+                  const void* operand1, const void* operand2, void* result,
+                  int ofiOp, enum fi_datatype ofiType, size_t size) {
+  assert(!isAmHandler);
+  DBG_PRINTF((ofiOp == FI_ATOMIC_READ) ? DBG_AMO_READ : DBG_AMO,
+             "AMO via AM: obj %d:%p, opnd1 <%s>, opnd2 <%s>, res %p, "
+             "op %s, typ %s, sz %zd",
+             (int) node, object,
+             DBG_VAL(operand1, ofiType), DBG_VAL(operand2, ofiType), result,
+             amo_opName(ofiOp), amo_typeName(ofiType), size);
 
   struct perTxCtxInfo_t* tcip;
   CHK_TRUE((tcip = tciAlloc()) != NULL);
@@ -3004,6 +3713,37 @@ void amRequestFree(c_nodeid_t node, void* p) {
 }
 
 
+static inline
+void amRequestAlloc(c_nodeid_t node, size_t size, size_t n, void** ptrs) {
+  assert(!isAmHandler);
+
+  //
+  // The target PUTs the addresses back to us, so they have to land in
+  // registered memory.
+  //
+  size_t ptrsSize = n * sizeof(void*);
+  void** myPtrs = ptrs;
+  if (mrGetLocalKey(myPtrs, ptrsSize) != 0) {
+    myPtrs = allocBounceBuf(ptrsSize);
+    CHK_TRUE(mrGetLocalKey(myPtrs, ptrsSize) == 0);
+  }
+
+  amRequest_t req = { .alloc = { .b = { .op = am_opAlloc,
+                                        .node = chpl_nodeID, },
+                                 .size = size,
+                                 .n = n,
+                                 .ptrs = myPtrs, }, };
+  retireDelayedAmDone(false /*taskIsEnding*/);
+  amRequestCommon(node, &req, sizeof(req.alloc),
+                  &req.b.pAmDone, true /*yieldDuringTxnWait*/, NULL);
+
+  if (myPtrs != ptrs) {
+    memcpy(ptrs, myPtrs, ptrsSize);
+    freeBounceBuf(myPtrs);
+  }
+}
+
+
 static inline
 void amRequestNop(c_nodeid_t node, chpl_bool blocking) {
   amRequest_t req = { .b = { .op = am_opNop,
@@ -3024,6 +3764,99 @@ void amRequestShutdown(c_nodeid_t node) {
 }
 
 
+//
+// AM service latency statistics
+//
+// With CHPL_RT_COMM_OFI_AM_LATENCY_STATS set, we time every blocking AM
+// whose target side is done entirely by the AM handler (RMA, AMOs,
+// frees, no-ops and "fast" executeOns), from just before we send it
+// until we see its 'done' indicator.  At exit each node reports the
+// percentiles of those times, so that the effect of reserving a CPU
+// for the AM handler (CHPL_RT_COMM_OFI_AM_HANDLER_CPU) can be judged.
+// The times go in power-of-2 nanosecond buckets.
+//
+#define AM_LAT_BUCKETS 40
+
+static chpl_bool amLatStats = false;
+static atomic_uint_least64_t amLatHist[AM_LAT_BUCKETS];
+
+static
+void init_amLatStats(void) {
+  amLatStats = chpl_env_rt_get_bool("COMM_OFI_AM_LATENCY_STATS", false);
+  for (int i = 0; i < AM_LAT_BUCKETS; i++) {
+    atomic_init_uint_least64_t(&amLatHist[i], 0);
+  }
+}
+
+static inline
+chpl_bool amLatIsServiceOp(amRequest_t* req) {
+  return (req->b.op == am_opGet
+          || req->b.op == am_opPut
+          || req->b.op == am_opAMO
+          || req->b.op == am_opFree
+          || req->b.op == am_opAlloc
+          || req->b.op == am_opNop
+          || (req->b.op == am_opExecOn && req->xo.hdr.comm.fast));
+}
+
+static inline
+void amLatRecord(double seconds) {
+  uint64_t ns = (seconds <= 0.0) ? 0 : (uint64_t) (seconds * 1.0e9);
+  int b = 0;
+  while (ns > 1 && b < AM_LAT_BUCKETS - 1) {
+    ns >>= 1;
+    b++;
+  }
+  (void) atomic_fetch_add_uint_least64_t(&amLatHist[b], 1);
+}
+
+static
+void amLatReport(void) {
+  static const int pcts[] = { 50, 90, 99, 100 };
+  uint64_t counts[AM_LAT_BUCKETS];
+  uint64_t total = 0;
+
+  if (!amLatStats) {
+    return;
+  }
+
+  for (int i = 0; i < AM_LAT_BUCKETS; i++) {
+    counts[i] = atomic_load_uint_least64_t(&amLatHist[i]);
+    total += counts[i];
+  }
+
+  char buf[200];
+  int len = snprintf(buf, sizeof(buf),
+                     "%d: AM service latency: %" PRIu64 " AMs",
+                     (int) chpl_nodeID, total);
+  if (total > 0) {
+    uint64_t sum = 0;
+    int b = 0;
+    for (int p = 0; p < sizeof(pcts) / sizeof(pcts[0]); p++) {
+      const uint64_t want = (total * pcts[p] + 99) / 100;
+      while (sum + counts[b] < want) {
+        sum += counts[b++];
+      }
+      // report the upper edge of the bucket, in microseconds
+      char label[10];
+      if (pcts[p] == 100) {
+        (void) snprintf(label, sizeof(label), "max");
+      } else {
+        (void) snprintf(label, sizeof(label), "p%d", pcts[p]);
+      }
+      len += snprintf(&buf[len], sizeof(buf) - len,
+                      ", %s <= %.3g us", label,
+                      (double) ((uint64_t) 1 << (b + 1)) * 1.0e-3);
+      if (len >= sizeof(buf)) {
+        len = sizeof(buf) - 1;
+        break;
+      }
+    }
+  }
+  printf("%s\n", buf);
+}
+
+
 static inline
 void amRequestCommon(c_nodeid_t node,
                      amRequest_t* req, size_t reqSize,
@@ -3082,9 +3915,18 @@ void amRequestCommon(c_nodeid_t node,
     CHK_TRUE((myTcip = tciAlloc()) != NULL);
   }
 
+  //
+  // Inject the message if it's small enough.  The provider copies it
+  // before fi_inject() returns, so it needn't be in registered memory,
+  // and we don't have to wait for a transmit completion even when the
+  // request is blocking: for those we wait for the target's "done"
+  // indicator, which can only come after the request arrives.
+  //
+  const chpl_bool inject = (reqSize <= ofi_info->tx_attr->inject_size);
+
   amRequest_t* myReq = req;
   void* mrDesc = NULL;
-  if (mrGetDesc(&mrDesc, myReq, reqSize) != 0) {
+  if (!inject && mrGetDesc(&mrDesc, myReq, reqSize) != 0) {
     myReq = allocBounceBuf(reqSize);
     DBG_PRINTF(DBG_AM | DBG_AM_SEND, "AM req BB: %p", myReq);
     CHK_TRUE(mrGetDesc(NULL, myReq, reqSize) == 0);
@@ -3107,21 +3949,39 @@ void amRequestCommon(c_nodeid_t node,
   // be strictly correct we need to allow for overlapping transfers to
   // go via different methods.
   //
+  // Aggregated PUTs haven't even been started yet, so in those same
+  // cases they have to go out first.  (The AM handler has none.)
+  //
+  if (myReq->b.op == am_opExecOn
+      || myReq->b.op == am_opExecOnLrg
+      || myReq->b.op == am_opAMO
+      || myReq->b.op == am_opGet
+      || myReq->b.op == am_opPut
+      || myReq->b.op == am_opXfer) {
+    put_agg_flush();
+  }
+
   if (myReq->b.op == am_opExecOn
       || myReq->b.op == am_opExecOnLrg
       || (myReq->b.op == am_opAMO && myReq->amo.ofiOp != FI_ATOMIC_READ)) {
     waitForPutsVisAllNodes(myTcip, NULL, false /*taskIsEnding*/);
   } else if (myReq->b.op == am_opGet
-             || myReq->b.op == am_opPut) {
+             || myReq->b.op == am_opPut
+             || myReq->b.op == am_opXfer) {
     waitForPutsVisOneNode(node, myTcip, NULL);
   }
 
+  const double latStart = (amLatStats && pAmDone != NULL
+                           && amLatIsServiceOp(myReq))
+                          ? chpl_comm_ofi_time_get()
+                          : -1.0;
+
   //
-  // Inject the message if it's small enough and we're not going to wait
-  // for it anyway.  Otherwise, do a regular send.  Don't count injected
-  // messages as "outstanding", because they won't generate CQ events.
+  // Inject the message if we can (see above).  Otherwise, do a regular
+  // send.  Don't count injected messages as "outstanding", because they
+  // won't generate CQ events.
   //
-  if (pAmDone == NULL && reqSize <= ofi_info->tx_attr->inject_size) {
+  if (inject) {
     if (DBG_TEST_MASK(DBG_AM | DBG_AM_SEND)
         || (req->b.op == am_opAMO && DBG_TEST_MASK(DBG_AMO))) {
       DBG_DO_PRINTF("tx AM req inject to %d: %s",
@@ -3160,6 +4020,9 @@ void amRequestCommon(c_nodeid_t node,
 
   if (pAmDone != NULL) {
     amWaitForDone(pAmDone);
+    if (latStart >= 0.0) {
+      amLatRecord(chpl_comm_ofi_time_get() - latStart);
+    }
     if (pAmDone != &amDone) {
       freeBounceBuf(pAmDone);
     }
@@ -3215,6 +4078,24 @@ chpl_bool setUpDelayedAmDone(chpl_comm_taskPrvData_t** pPrvData,
 }
 
 
+static inline
+void retireXfers(chpl_comm_taskPrvData_t* prvData) {
+  //
+  // Wait for the completion of any unordered third-party transfers.
+  //
+  chpl_comm_taskPrvData_t* myPrvData = prvData;
+  if (myPrvData == NULL
+      && (myPrvData = get_comm_taskPrvdata()) == NULL) {
+    return;
+  }
+
+  for (int i = 0; i < myPrvData->numXfers; i++) {
+    amWaitForDone((amDone_t*) &myPrvData->xferDone[i]);
+  }
+  myPrvData->numXfers = 0;
+}
+
+
 static inline
 void retireDelayedAmDone(chpl_bool taskIsEnding) {
   //
@@ -3239,6 +4120,7 @@ void retireDelayedAmDone(chpl_bool taskIsEnding) {
 //
 
 static int numAmHandlersActive;
+static int amHandlerCPU = -1;  // CPU to bind the AM handler to, or -1
 static pthread_cond_t amStartStopCond = PTHREAD_COND_INITIALIZER;
 static pthread_mutex_t amStartStopMutex = PTHREAD_MUTEX_INITIALIZER;
 
@@ -3250,7 +4132,9 @@ static void amHandleExecOnLrg(chpl_comm_on_bundle_t*);
 static void amWrapExecOnLrgBody(struct amRequest_execOnLrg_t*);
 static void amWrapGet(struct taskArg_RMA_t*);
 static void amWrapPut(struct taskArg_RMA_t*);
+static void amWrapXfer(struct taskArg_xfer_t*);
 static void amHandleAMO(struct amRequest_AMO_t*);
+static void amHandleAlloc(struct amRequest_alloc_t*);
 static inline void amSendDone(c_nodeid_t, amDone_t*);
 static inline void amCheckLiveness(void);
 
@@ -3268,6 +4152,16 @@ void init_amHandling(void) {
     CHK_TRUE(sizeof(pd.amDone) >= sizeof(amDone_t));
   }
 
+  //
+  // The AM handler can be bound to a CPU of its own, so that compute-
+  // bound tasks don't delay servicing of AMs.  (For this to help, the
+  // user also has to keep worker threads off that CPU, for example by
+  // reducing CHPL_RT_NUM_THREADS_PER_LOCALE.)
+  //
+  amHandlerCPU = (int) chpl_env_rt_get_int("COMM_OFI_AM_HANDLER_CPU", -1);
+
+  init_amLatStats();
+
   //
   // Start AM handler thread(s).  Don't proceed from here until at
   // least one is running.
@@ -3314,6 +4208,13 @@ void amHandler(void* argNil) {
 
   isAmHandler = true;
 
+  if (amHandlerCPU >= 0 && chpl_topo_setThreadCPU(amHandlerCPU) != 0) {
+    char msg[100];
+    (void) snprintf(msg, sizeof(msg),
+                    "cannot bind AM handler to CPU %d", amHandlerCPU);
+    chpl_warning(msg, 0, 0);
+  }
+
   DBG_PRINTF(DBG_AM, "AM handler running");
 
   //
@@ -3434,12 +4335,14 @@ void processRxAmReq(struct perTxCtxInfo_t* tcip) {
           req->b.crc = 0;
           reqSize = (req->b.op == am_opGet || req->b.op == am_opPut)
                     ? sizeof(struct amRequest_RMA_t)
+                    : (req->b.op == am_opXfer)
+                    ? sizeof(struct amRequest_xfer_t)
                     : (req->b.op == am_opAMO)
                     ? sizeof(struct amRequest_AMO_t)
                     : (req->b.op == am_opFree)
                     ? sizeof(struct amRequest_free_t)
-                    : (req->b.op == am_opFree)
-                    ? sizeof(struct amRequest_free_t)
+                    : (req->b.op == am_opAlloc)
+                    ? sizeof(struct amRequest_alloc_t)
                     : sizeof(struct amRequest_base_t);
         }
         uint32_t rcvd_crc = xcrc32((void*) req, reqSize, ~(uint32_t) 0);
@@ -3483,6 +4386,16 @@ void processRxAmReq(struct perTxCtxInfo_t* tcip) {
         }
         break;
 
+      case am_opXfer:
+        {
+          struct taskArg_xfer_t arg = { .hdr.kind = CHPL_ARG_BUNDLE_KIND_TASK,
+                                        .xfer = req->xfer, };
+          chpl_task_startMovedTask(FID_NONE, (chpl_fn_p) amWrapXfer,
+                                   &arg, sizeof(arg), c_sublocid_any,
+                                   chpl_nullTaskID);
+        }
+        break;
+
       case am_opAMO:
         amHandleAMO(&req->amo);
         break;
@@ -3491,6 +4404,10 @@ void processRxAmReq(struct perTxCtxInfo_t* tcip) {
         CHPL_FREE(req->free.p);
         break;
 
+      case am_opAlloc:
+        amHandleAlloc(&req->alloc);
+        break;
+
       case am_opNop:
         DBG_PRINTF(DBG_AM | DBG_AM_RECV, "%s", am_reqDoneStr(req));
         if (req->b.pAmDone != NULL) {
@@ -3643,6 +4560,23 @@ void amWrapPut(struct taskArg_RMA_t* tsk_rma) {
 }
 
 
+static
+void amWrapXfer(struct taskArg_xfer_t* tsk_xfer) {
+  struct amRequest_xfer_t* xfer = &tsk_xfer->xfer;
+
+  (void) ofi_put(xfer->srcAddr, xfer->dstNode, xfer->dstAddr, xfer->size);
+
+  //
+  // As for amWrapPut(), the bytes must be visible on the destination
+  // before the initiator sees 'done'.
+  //
+  waitForPutsVisAllNodes(NULL, NULL, false /*taskIsEnding*/);
+
+  DBG_PRINTF(DBG_AM | DBG_AM_RECV, "%s", am_reqDoneStr((amRequest_t*) xfer));
+  amSendDone(xfer->b.node, xfer->b.pAmDone);
+}
+
+
 static
 void amHandleAMO(struct amRequest_AMO_t* amo) {
   assert(amo->b.node != chpl_nodeID);    // should be handled on initiator
@@ -3669,6 +4603,31 @@ void amHandleAMO(struct amRequest_AMO_t* amo) {
 }
 
 
+static
+void amHandleAlloc(struct amRequest_alloc_t* alloc) {
+  assert(alloc->b.node != chpl_nodeID);  // should be handled on initiator
+  assert(alloc->n <= CHPL_COMM_REMOTE_ALLOC_MAX);
+
+  void* ptrs[CHPL_COMM_REMOTE_ALLOC_MAX];
+  size_t ptrsSize = alloc->n * sizeof(void*);
+
+  for (uint32_t i = 0; i < alloc->n; i++) {
+    ptrs[i] = chpl_mem_alloc(alloc->size, CHPL_RT_MD_REMOTE_ALLOC, 0, 0);
+  }
+
+  CHK_TRUE(mrGetKey(NULL, NULL, alloc->b.node, alloc->ptrs, ptrsSize) == 0);
+  (void) ofi_put(ptrs, alloc->b.node, alloc->ptrs, ptrsSize);
+
+  //
+  // Note: the addresses must be visible in target memory before the
+  // 'done' indicator is.
+  //
+
+  DBG_PRINTF(DBG_AM | DBG_AM_RECV, "%s", am_reqDoneStr((amRequest_t*) alloc));
+  amSendDone(alloc->b.node, alloc->b.pAmDone);
+}
+
+
 static inline
 void amSendDone(c_nodeid_t node, amDone_t* pAmDone) {
   static __thread amDone_t* amDone = NULL;
@@ -3753,18 +4712,140 @@ chpl_comm_nb_handle_t chpl_comm_put_nb(void* addr, c_nodeid_t node,
 }
 
 
+//
+// Like chpl_comm_put_nb() above, this is a blocking fallback: we have
+// no nonblocking handles, so all of the PUTs are complete and visible
+// when it returns, and the handle is NULL.  What it does save is
+// per-element overhead: the directly doable PUTs go out as chained
+// writemsg()s with one visibility transaction per batch, rather than
+// one each.  Only elements that can't be done directly block one at a
+// time, in ofi_put().
+//
+chpl_comm_nb_handle_t chpl_comm_put_nb_v(int v_len, void** addr_v,
+                                         c_nodeid_t node, void** raddr_v,
+                                         size_t* size_v, int32_t commID,
+                                         int ln, int32_t fn) {
+  DBG_PRINTF(DBG_IFACE,
+             "%s(%d, %p, %d, %p, %zd, %d)", __func__,
+             v_len, addr_v[0], (int) node, raddr_v[0], size_v[0],
+             (int) commID);
+
+  if (v_len == 1 || node == chpl_nodeID) {
+    for (int vi = 0; vi < v_len; vi++) {
+      chpl_comm_put(addr_v[vi], node, raddr_v[vi], size_v[vi],
+                    commID, ln, fn);
+    }
+    return NULL;
+  }
+
+  retireDelayedAmDone(false /*taskIsEnding*/);
+  put_agg_flush();
+
+  //
+  // Gather the PUTs we can do directly into chained batches of
+  // writemsg()s to the one node.  Anything too big or not in registered
+  // memory goes through the regular PUT path instead.
+  //
+  void* src_v[MAX_CHAINED_PUT_LEN];
+  void* local_mr_v[MAX_CHAINED_PUT_LEN];
+  c_nodeid_t locale_v[MAX_CHAINED_PUT_LEN];
+  void* tgt_v[MAX_CHAINED_PUT_LEN];
+  uint64_t remote_mr_v[MAX_CHAINED_PUT_LEN];
+  size_t sz_v[MAX_CHAINED_PUT_LEN];
+  int bi = 0;
+
+  for (int vi = 0; vi < v_len; vi++) {
+    uint64_t mrKey;
+    uint64_t mrRaddr;
+    void* mrDesc = NULL;
+
+    if (size_v[vi] == 0) {
+      continue;
+    }
+
+    // Communications callback support
+    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put)) {
+        chpl_comm_cb_info_t cb_data =
+          {chpl_comm_cb_event_kind_put, chpl_nodeID, node,
+           .iu.comm={addr_v[vi], raddr_v[vi], size_v[vi], commID, ln, fn}};
+        chpl_comm_do_callbacks (&cb_data);
+    }
+
+    chpl_comm_diags_verbose_rdma("put", node, size_v[vi], ln, fn, commID);
+    chpl_comm_diags_xfer(put, size_v[vi]);
+
+    if (size_v[vi] > MAX_UNORDERED_TRANS_SZ
+        || mrGetKey(&mrKey, &mrRaddr, node, raddr_v[vi], size_v[vi]) != 0
+        || mrGetDesc(&mrDesc, addr_v[vi], size_v[vi]) != 0) {
+      (void) ofi_put(addr_v[vi], node, raddr_v[vi], size_v[vi]);
+      continue;
+    }
+
+    src_v[bi] = addr_v[vi];
+    local_mr_v[bi] = mrDesc;
+    locale_v[bi] = node;
+    tgt_v[bi] = (void*) mrRaddr;
+    remote_mr_v[bi] = mrKey;
+    sz_v[bi] = size_v[vi];
+    if (++bi == MAX_CHAINED_PUT_LEN) {
+      ofi_put_V(bi, src_v, local_mr_v, locale_v, tgt_v, remote_mr_v, sz_v,
+                NULL);
+      bi = 0;
+    }
+  }
+
+  if (bi > 0) {
+    ofi_put_V(bi, src_v, local_mr_v, locale_v, tgt_v, remote_mr_v, sz_v,
+              NULL);
+  }
+
+  return NULL;
+}
+
+
 chpl_comm_nb_handle_t chpl_comm_get_nb(void* addr, c_nodeid_t node,
                                        void* raddr, size_t size,
                                        int32_t commID, int ln, int32_t fn) {
-  chpl_comm_get(addr, node, raddr, size, commID, ln, fn);
-  return NULL;
+  DBG_PRINTF(DBG_IFACE,
+             "%s(%p, %d, %p, %zd, %d)", __func__,
+             addr, (int) node, raddr, size, (int) commID);
+
+  retireDelayedAmDone(false /*taskIsEnding*/);
+
+  CHK_TRUE(addr != NULL);
+  CHK_TRUE(raddr != NULL);
+
+  if (size == 0) {
+    return NULL;
+  }
+
+  if (node == chpl_nodeID) {
+    memmove(addr, raddr, size);
+    return NULL;
+  }
+
+  // Communications callback support
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get)) {
+      chpl_comm_cb_info_t cb_data =
+        {chpl_comm_cb_event_kind_get, chpl_nodeID, node,
+         .iu.comm={addr, raddr, size, commID, ln, fn}};
+      chpl_comm_do_callbacks (&cb_data);
+  }
+
+  chpl_comm_diags_verbose_rdma("get_nb", node, size, ln, fn, commID);
+  chpl_comm_diags_xfer(get_nb, size);
+
+  return ofi_get_nb(addr, node, raddr, size);
 }
 
 
 int chpl_comm_test_nb_complete(chpl_comm_nb_handle_t h) {
   chpl_comm_diags_incr(test_nb);
 
-  // fi_cq_readfrom?
+  //
+  // Handles are only cleared by chpl_comm_{wait,try}_nb_some(), which
+  // is where we actually check for completion.
+  //
   return ((void*) h) == NULL;
 }
 
@@ -3772,23 +4853,36 @@ int chpl_comm_test_nb_complete(chpl_comm_nb_handle_t h) {
 void chpl_comm_wait_nb_some(chpl_comm_nb_handle_t* h, size_t nhandles) {
   chpl_comm_diags_incr(wait_nb);
 
-  size_t i;
-  // fi_cq_readfrom?
-  for( i = 0; i < nhandles; i++ ) {
-    CHK_TRUE(h[i] == NULL);
-  }
+  chpl_bool allDone;
+  do {
+    allDone = true;
+    for (size_t i = 0; i < nhandles; i++) {
+      if (h[i] != NULL && !nbHandleCheck((struct nbHandle*) h[i])) {
+        allDone = false;
+      } else if (h[i] != NULL) {
+        nbHandleFree((struct nbHandle*) h[i]);
+        h[i] = NULL;
+      }
+    }
+    if (!allDone) {
+      local_yield();
+    }
+  } while (!allDone);
 }
 
 
 int chpl_comm_try_nb_some(chpl_comm_nb_handle_t* h, size_t nhandles) {
   chpl_comm_diags_incr(try_nb);
 
-  size_t i;
-  // fi_cq_readfrom?
-  for( i = 0; i < nhandles; i++ ) {
-    CHK_TRUE(h[i] == NULL);
+  int sawDone = 0;
+  for (size_t i = 0; i < nhandles; i++) {
+    if (h[i] != NULL && nbHandleCheck((struct nbHandle*) h[i])) {
+      nbHandleFree((struct nbHandle*) h[i]);
+      h[i] = NULL;
+      sawDone = 1;
+    }
   }
-  return 0;
+  return sawDone;
 }
 
 
@@ -3824,9 +4918,15 @@ void chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
   }
 
   chpl_comm_diags_verbose_rdma("put", node, size, ln, fn, commID);
-  chpl_comm_diags_incr(put);
+  chpl_comm_diags_xfer(put, size);
+
+  if (do_remote_put_agg(addr, node, raddr, size)) {
+    return;
+  }
 
+  const uint64_t lat_start = chpl_comm_diags_lat_start();
   (void) ofi_put(addr, node, raddr, size);
+  chpl_comm_diags_lat_end(put, lat_start);
 }
 
 
@@ -3862,9 +4962,11 @@ void chpl_comm_get(void* addr, int32_t node, void* raddr,
   }
 
   chpl_comm_diags_verbose_rdma("get", node, size, ln, fn, commID);
-  chpl_comm_diags_incr(get);
+  chpl_comm_diags_xfer(get, size);
+  const uint64_t lat_start = chpl_comm_diags_lat_start();
 
   (void) ofi_get(addr, node, raddr, size);
+  chpl_comm_diags_lat_end(get, lat_start);
 }
 
 
@@ -3931,19 +5033,28 @@ void chpl_comm_getput_unordered(c_nodeid_t dstnode, void* dstaddr,
     chpl_comm_get_unordered(dstaddr, srcnode, srcaddr, size, commID, ln, fn);
   } else if (srcnode == chpl_nodeID) {
     chpl_comm_put_unordered(srcaddr, dstnode, dstaddr, size, commID, ln, fn);
+  } else if (size <= MAX_UNORDERED_TRANS_SZ) {
+    char buf[MAX_UNORDERED_TRANS_SZ];
+    chpl_comm_get(buf, srcnode, srcaddr, size, commID, ln, fn);
+    chpl_comm_put(buf, dstnode, dstaddr, size, commID, ln, fn);
   } else {
-    if (size <= MAX_UNORDERED_TRANS_SZ) {
-      char buf[MAX_UNORDERED_TRANS_SZ];
-      chpl_comm_get(buf, srcnode, srcaddr, size, commID, ln, fn);
-      chpl_comm_put(buf, dstnode, dstaddr, size, commID, ln, fn);
-    } else {
-      // Note, we do not expect this case to trigger, but if it does we may
-      // want to do on-stmt to src node and then transfer
-      char* buf = chpl_mem_alloc(size, CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
-      chpl_comm_get(buf, srcnode, srcaddr, size, commID, ln, fn);
-      chpl_comm_put(buf, dstnode, dstaddr, size, commID, ln, fn);
-      chpl_mem_free(buf, 0, 0);
+    //
+    // Have the source node PUT the data straight to the destination,
+    // rather than bringing it here and sending it back out.
+    //
+    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put)) {
+      chpl_comm_cb_info_t cb_data =
+        {chpl_comm_cb_event_kind_put, srcnode, dstnode,
+         .iu.comm={srcaddr, dstaddr, size, commID, ln, fn}};
+      chpl_comm_do_callbacks (&cb_data);
     }
+
+    chpl_comm_diags_verbose_rdma("unordered 3rd-party put", dstnode, size,
+                                 ln, fn, commID);
+    chpl_comm_diags_incr(execute_on_nb);
+    chpl_comm_diags_xfer(put, size);
+
+    amRequestXfer(dstnode, dstaddr, srcnode, srcaddr, size);
   }
 }
 
@@ -3980,7 +5091,7 @@ void chpl_comm_get_unordered(void* addr, c_nodeid_t node, void* raddr,
   }
 
   chpl_comm_diags_verbose_rdma("unordered get", node, size, ln, fn, commID);
-  chpl_comm_diags_incr(get);
+  chpl_comm_diags_xfer(get, size);
 
   do_remote_get_buff(addr, node, raddr, size);
 }
@@ -4018,7 +5129,7 @@ void chpl_comm_put_unordered(void* addr, c_nodeid_t node, void* raddr,
   }
 
   chpl_comm_diags_verbose_rdma("unordered put", node, size, ln, fn, commID);
-  chpl_comm_diags_incr(put);
+  chpl_comm_diags_xfer(put, size);
 
   do_remote_put_buff(addr, node, raddr, size);
 }
@@ -4028,6 +5139,7 @@ void chpl_comm_getput_unordered_task_fence(void) {
   DBG_PRINTF(DBG_IFACE_MCM, "%s()", __func__);
 
   task_local_buff_flush(get_buff | put_buff);
+  retireXfers(NULL);
 }
 
 
@@ -4041,6 +5153,41 @@ static struct perTxCtxInfo_t* findFreeTciTabEntry(chpl_bool);
 
 static __thread struct perTxCtxInfo_t* _ttcip;
 
+//
+// Optional tx context allocation statistics: how often a thread can't
+// reuse its previous context, and how long it then waits for one.
+//
+static chpl_bool tciStats = false;
+static atomic_uint_least64_t tciStatAllocs;
+static atomic_uint_least64_t tciStatSearches;
+static atomic_uint_least64_t tciStatWaits;
+static atomic_uint_least64_t tciStatWaitNs;
+
+static
+void init_tciStats(void) {
+  tciStats = chpl_env_rt_get_bool("COMM_OFI_TCI_STATS", false);
+  atomic_init_uint_least64_t(&tciStatAllocs, 0);
+  atomic_init_uint_least64_t(&tciStatSearches, 0);
+  atomic_init_uint_least64_t(&tciStatWaits, 0);
+  atomic_init_uint_least64_t(&tciStatWaitNs, 0);
+}
+
+
+static
+void tciStatsReport(void) {
+  if (!tciStats) {
+    return;
+  }
+
+  const uint64_t allocs = atomic_load_uint_least64_t(&tciStatAllocs);
+  const uint64_t waits = atomic_load_uint_least64_t(&tciStatWaits);
+  printf("%d: tx ctx allocs: %" PRIu64 ", searched %" PRIu64
+         ", waited %" PRIu64 " (%.3f ms total)\n",
+         (int) chpl_nodeID, allocs,
+         atomic_load_uint_least64_t(&tciStatSearches), waits,
+         (double) atomic_load_uint_least64_t(&tciStatWaitNs) * 1.0e-6);
+}
+
 
 static inline
 struct perTxCtxInfo_t* tciAlloc(void) {
@@ -4056,6 +5203,10 @@ struct perTxCtxInfo_t* tciAllocForAmHandler(void) {
 
 static inline
 struct perTxCtxInfo_t* tciAllocCommon(chpl_bool bindToAmHandler) {
+  if (tciStats) {
+    (void) atomic_fetch_add_uint_least64_t(&tciStatAllocs, 1);
+  }
+
   if (_ttcip != NULL) {
     //
     // If the last tx context we used is bound to our thread or can be
@@ -4077,6 +5228,9 @@ struct perTxCtxInfo_t* tciAllocCommon(chpl_bool bindToAmHandler) {
   // for either the AM handler or a tasking layer fixed worker thread,
   // bind it permanently.
   //
+  if (tciStats) {
+    (void) atomic_fetch_add_uint_least64_t(&tciStatSearches, 1);
+  }
   _ttcip = findFreeTciTabEntry(bindToAmHandler);
   if (bindToAmHandler
       || (tciTabFixedAssignments && chpl_task_isFixedThread())) {
@@ -4115,8 +5269,19 @@ struct perTxCtxInfo_t* findFreeTciTabEntry(chpl_bool bindToAmHandler) {
   // discover they're all bound, because if that's true we can predict
   // we'll never find a free one.
   //
-  static __thread int last_iw = 0;
+  // Each thread starts its first search at a different place, so that
+  // threads coming in together don't all fight over the same entries,
+  // and we only try to grab entries that look free, so that searching
+  // doesn't bounce the cache lines of busy ones around.
+  //
+  static atomic_uint_least32_t nextStart;
+  static __thread int last_iw = -1;
+  if (last_iw < 0) {
+    last_iw = atomic_fetch_add_uint_least32_t(&nextStart, 1)
+              % numWorkerTxCtxs;
+  }
   tcip = NULL;
+  double waitStart = -1.0;
 
   do {
     int iw = last_iw;
@@ -4126,17 +5291,32 @@ struct perTxCtxInfo_t* findFreeTciTabEntry(chpl_bool bindToAmHandler) {
       if (++iw >= numWorkerTxCtxs)
         iw = 0;
       allBound = allBound && tciTab[iw].bound;
-      if (!atomic_exchange_bool(&tciTab[iw].allocated, true)) {
+      if (!atomic_load_explicit_bool(&tciTab[iw].allocated,
+                                     memory_order_relaxed)
+          && !atomic_exchange_bool(&tciTab[iw].allocated, true)) {
         tcip = &tciTab[iw];
       }
     } while (tcip == NULL && iw != last_iw);
 
     if (tcip == NULL) {
       CHK_FALSE(allBound);
+      if (tciStats && waitStart < 0.0) {
+        waitStart = chpl_comm_ofi_time_get();
+      }
       local_yield();
+    } else {
+      last_iw = iw;
     }
   } while (tcip == NULL);
 
+  if (waitStart >= 0.0) {
+    (void) atomic_fetch_add_uint_least64_t(&tciStatWaits, 1);
+    (void) atomic_fetch_add_uint_least64_t(&tciStatWaitNs,
+                                           (uint64_t)
+                                           ((chpl_comm_ofi_time_get()
+                                             - waitStart) * 1.0e9));
+  }
+
   return tcip;
 }
 
@@ -4156,6 +5336,11 @@ void tciFree(struct perTxCtxInfo_t* tcip) {
 static inline
 chpl_comm_nb_handle_t ofi_put(const void* addr, c_nodeid_t node,
                               void* raddr, size_t size) {
+  //
+  // Aggregated PUTs were issued earlier, so they have to go out first.
+  //
+  put_agg_flush();
+
   //
   // Don't ask the provider to transfer more than it wants to.
   //
@@ -4189,16 +5374,27 @@ chpl_comm_nb_handle_t ofi_put(const void* addr, c_nodeid_t node,
     // The remote address is RMA-accessible; PUT directly to it.
     //
     void* mrDesc = NULL;
-    if (mrGetDesc(&mrDesc, myAddr, size) != 0) {
-      myAddr = allocBounceBuf(size);
+    struct mrCacheEntry* mrce = NULL;
+    const chpl_bool bounce = (mrGetDesc(&mrDesc, myAddr, size) != 0
+                              && mrCacheGetDesc(&mrDesc, &mrce,
+                                                myAddr, size) != 0);
+
+    struct perTxCtxInfo_t* tcip;
+    CHK_TRUE((tcip = tciAlloc()) != NULL);
+
+    if (bounce && size > BB_MAX_SIZE) {
+      ofi_put_bounced(tcip, addr, node, mrRaddr, mrKey, size);
+      tciFree(tcip);
+      return NULL;
+    }
+
+    if (bounce) {
+      myAddr = bbAlloc(tcip, size);
       DBG_PRINTF(DBG_RMA | DBG_RMA_WRITE, "PUT src BB: %p", myAddr);
       CHK_TRUE(mrGetDesc(&mrDesc, myAddr, size) == 0);
       memcpy(myAddr, addr, size);
     }
 
-    struct perTxCtxInfo_t* tcip;
-    CHK_TRUE((tcip = tciAlloc()) != NULL);
-
     //
     // If we're using delivery-complete for MCM conformance we just
     // write the data and wait for the CQ event.  If we're using message
@@ -4260,7 +5456,11 @@ chpl_comm_nb_handle_t ofi_put(const void* addr, c_nodeid_t node,
       bitmapSet(prvData->putBitmap, node);
     }
 
+    if (bounce) {
+      bbFree(tcip, myAddr, size);
+    }
     tciFree(tcip);
+    mrCacheRelease(mrce);
   } else {
     //
     // The remote address is not RMA-accessible.  Make sure that the
@@ -4277,16 +5477,75 @@ chpl_comm_nb_handle_t ofi_put(const void* addr, c_nodeid_t node,
                "PUT %d:%p <= %p, size %zd, via AM GET",
                (int) node, raddr, myAddr, size);
     amRequestRMA(node, am_opGet, myAddr, raddr, size);
-  }
 
-  if (myAddr != addr) {
-    freeBounceBuf(myAddr);
+    if (myAddr != addr) {
+      freeBounceBuf(myAddr);
+    }
   }
 
   return NULL;
 }
 
 
+//
+// PUT from unregistered local memory, through a pair of bounce buffers:
+// we fill one while the PUT from the other is in flight.
+//
+static
+void ofi_put_bounced(struct perTxCtxInfo_t* tcip,
+                     const void* addr, c_nodeid_t node,
+                     uint64_t mrRaddr, uint64_t mrKey, size_t size) {
+  void* bb[2];
+  void* bbDesc[2];
+  atomic_bool txnDone[2];
+  void* ctx[2] = { NULL, NULL };
+
+  assert(tcip->txCQ != NULL);  // PUTs require a CQ, at least for now
+
+  for (int b = 0; b < 2; b++) {
+    bb[b] = bbAlloc(tcip, BB_MAX_SIZE);
+    CHK_TRUE(mrGetDesc(&bbDesc[b], bb[b], BB_MAX_SIZE) == 0);
+    atomic_init_bool(&txnDone[b], false);
+  }
+
+  DBG_PRINTF(DBG_RMA | DBG_RMA_WRITE,
+             "PUT %d:0x%" PRIx64 " <= %p, size %zd, pipelined via BBs %p, %p",
+             (int) node, mrRaddr, addr, size, bb[0], bb[1]);
+
+  for (size_t off = 0, i = 0; off < size; off += BB_MAX_SIZE, i++) {
+    const int b = i % 2;
+    const size_t len = (size - off < BB_MAX_SIZE) ? size - off : BB_MAX_SIZE;
+
+    if (ctx[b] != NULL) {
+      waitForTxnComplete(tcip, ctx[b]);
+      atomic_store_bool(&txnDone[b], false);
+    }
+
+    memcpy(bb[b], (const char*) addr + off, len);
+    ctx[b] = txnTrkEncodeDone(&txnDone[b]);
+    OFI_RIDE_OUT_EAGAIN(tcip,
+                        fi_write(tcip->txCtx, bb[b], len,
+                                 bbDesc[b], rxRmaAddr(tcip, node),
+                                 mrRaddr + off, mrKey,
+                                 haveDeliveryComplete ? ctx[b] : NULL));
+    tcip->numTxnsOut++;
+    tcip->numTxnsSent++;
+
+    if (!haveDeliveryComplete) {
+      ofi_get_ll(orderDummy, node, orderDummyMap[node], 1, ctx[b], tcip);
+    }
+  }
+
+  for (int b = 0; b < 2; b++) {
+    if (ctx[b] != NULL) {
+      waitForTxnComplete(tcip, ctx[b]);
+    }
+    atomic_destroy_bool(&txnDone[b]);
+    bbFree(tcip, bb[b], BB_MAX_SIZE);
+  }
+}
+
+
 static inline
 void ofi_put_ll(const void* addr, c_nodeid_t node,
                 void* raddr, size_t size, void* ctx,
@@ -4339,6 +5598,10 @@ static
 void ofi_put_V(int v_len, void** addr_v, void** local_mr_v,
                c_nodeid_t* locale_v, void** raddr_v, uint64_t* remote_mr_v,
                size_t* size_v, struct bitmap_t* b) {
+  //
+  // If b is NULL then all the PUTs must target locale_v[0], and we
+  // only need to force visibility on that one node.
+  //
   DBG_PRINTF(DBG_RMA | DBG_RMA_WRITE | DBG_RMA_UNORD,
              "put_V(%d): %d:%p <= %p, size %zd, key 0x%" PRIx64,
              v_len, (int) locale_v[0], raddr_v[0], addr_v[0], size_v[0],
@@ -4365,7 +5628,9 @@ void ofi_put_V(int v_len, void** addr_v, void** local_mr_v,
   // Initiate the batch.  Record which nodes we PUT to, so that we can
   // force them to be visible in target memory at the end.
   //
-  bitmapZero(b);
+  if (b != NULL) {
+    bitmapZero(b);
+  }
   for (int vi = 0; vi < v_len; vi++) {
     struct iovec msg_iov = (struct iovec)
                            { .iov_base = addr_v[vi],
@@ -4396,14 +5661,27 @@ void ofi_put_V(int v_len, void** addr_v, void** local_mr_v,
                                     (vi < v_len - 1) ? FI_MORE : 0));
     tcip->numTxnsOut++;
     tcip->numTxnsSent++;
-    bitmapSet(b, locale_v[vi]);
+    if (b != NULL) {
+      bitmapSet(b, locale_v[vi]);
+    } else {
+      assert(locale_v[vi] == locale_v[0]);
+    }
   }
 
   //
   // Enforce Chapel MCM: force all of the above PUTs to appear in
   // target memory.
   //
-  mcmReleaseAllNodes(b, tcip, "unordered PUT");
+  if (b != NULL) {
+    mcmReleaseAllNodes(b, tcip, "unordered PUT");
+  } else {
+    (*tcip->checkTxCmplsFn)(tcip);
+    while (tcip->txCQ != NULL && tcip->numTxnsOut >= txCQLen) {
+      sched_yield();
+      (*tcip->checkTxCmplsFn)(tcip);
+    }
+    mcmReleaseOneNode(locale_v[0], tcip, "vector PUT");
+  }
 
   tciFree(tcip);
 }
@@ -4438,6 +5716,10 @@ void do_remote_put_buff(void* addr, c_nodeid_t node, void* raddr,
   uint64_t mrRaddr;
   put_buff_task_info_t* info;
   size_t extra_size = bitmapSizeofMap(chpl_numNodes);
+
+  // Unordered PUTs may pass each other, but not earlier regular ones.
+  put_agg_flush();
+
   if (size > MAX_UNORDERED_TRANS_SZ
       || mrGetKey(&mrKey, &mrRaddr, node, raddr, size) != 0
       || (info = task_local_buff_acquire(put_buff, extra_size)) == NULL) {
@@ -4476,9 +5758,137 @@ void do_remote_put_buff(void* addr, c_nodeid_t node, void* raddr,
 /*** END OF BUFFERED PUT OPERATIONS ***/
 
 
+/*
+ *** START OF AGGREGATED PUT OPERATIONS ***
+ *
+ * Optional aggregation of small regular (ordered) PUTs.  With
+ * CHPL_RT_COMM_OFI_PUT_AGG_MAX_SIZE set, regular PUTs up to that size
+ * are copied into a per-task buffer instead of being done one at a
+ * time.  A PUT that continues the previous one in the buffer is merged
+ * into it.  The buffer goes out as one chained fi_writemsg() batch via
+ * ofi_put_V(), whose mcmReleaseAllNodes() makes it visible before we go
+ * on.  That happens when the buffer is full, when the oldest PUT in it
+ * is older than CHPL_RT_COMM_OFI_PUT_AGG_MAX_US, and before anything
+ * that could observe the PUTs: any other RMA, an AMO, an executeOn,
+ * task creation or end, a task fence, or a barrier.
+ */
+
+static size_t putAggMaxSize = 0;       // 0 means aggregation is off
+static double putAggMaxAge = 100e-6;   // seconds
+
+static
+void init_putAgg(void) {
+  const int64_t sz = chpl_env_rt_get_int("COMM_OFI_PUT_AGG_MAX_SIZE", 0);
+  const int64_t us = chpl_env_rt_get_int("COMM_OFI_PUT_AGG_MAX_US", 100);
+  if (sz > 0) {
+    putAggMaxSize = (sz > MAX_UNORDERED_TRANS_SZ)
+                    ? MAX_UNORDERED_TRANS_SZ
+                    : (size_t) sz;
+  }
+  if (us >= 0) {
+    putAggMaxAge = us * 1.0e-6;
+  }
+}
+
+
+static inline
+void put_agg_flush(void) {
+  if (putAggMaxSize > 0 && !isAmHandler) {
+    task_local_buff_flush(put_agg_buff);
+  }
+}
+
+
+//
+// Returns true if the PUT was aggregated; otherwise, the caller must do
+// it.  Any earlier aggregated PUT it overlaps has been flushed by then.
+//
+static inline
+chpl_bool do_remote_put_agg(void* addr, c_nodeid_t node, void* raddr,
+                            size_t size) {
+  uint64_t mrKey;
+  uint64_t mrRaddr;
+  put_buff_task_info_t* info;
+
+  if (size > putAggMaxSize || isAmHandler
+      || mrGetKey(&mrKey, &mrRaddr, node, raddr, size) != 0
+      || (info = task_local_buff_acquire(put_agg_buff,
+                                         bitmapSizeofMap(chpl_numNodes)))
+         == NULL) {
+    return false;
+  }
+
+  if (info->new) {
+    info->nodeBitmap.len = chpl_numNodes;
+    info->new = false;
+  }
+
+  //
+  // Extend the last PUT if this one continues it.  Otherwise, since a
+  // batch gives no ordering among its own transactions, flush if this
+  // PUT overlaps any that are already buffered for the same node.
+  //
+  int vi = info->vi;
+  if (vi > 0
+      && info->locale_v[vi - 1] == node
+      && info->remote_mr_v[vi - 1] == mrKey
+      && (char*) info->tgt_addr_v[vi - 1] + info->size_v[vi - 1]
+         == (char*) mrRaddr
+      && info->size_v[vi - 1] + size <= MAX_UNORDERED_TRANS_SZ) {
+    memcpy(&info->src_v[vi - 1][info->size_v[vi - 1]], addr, size);
+    info->size_v[vi - 1] += size;
+    DBG_PRINTF(DBG_RMA | DBG_RMA_WRITE,
+               "do_remote_put_agg(): info[%d] += %zd bytes", vi - 1, size);
+    return true;
+  }
+
+  for (int i = 0; i < vi; i++) {
+    if (info->locale_v[i] == node
+        && (char*) info->tgt_addr_v[i] < (char*) mrRaddr + size
+        && (char*) mrRaddr < (char*) info->tgt_addr_v[i] + info->size_v[i]) {
+      put_buff_task_info_flush(info);
+      vi = 0;
+      break;
+    }
+  }
+
+  void* mrDesc = NULL;
+  CHK_TRUE(mrGetDesc(&mrDesc, info->src_v, size) == 0);
+
+  memcpy(&info->src_v[vi], addr, size);
+  info->src_addr_v[vi] = &info->src_v[vi];
+  info->locale_v[vi] = node;
+  info->tgt_addr_v[vi] = (void*) mrRaddr;
+  info->size_v[vi] = size;
+  info->remote_mr_v[vi] = mrKey;
+  info->local_mr_v[vi] = mrDesc;
+  info->vi++;
+
+  DBG_PRINTF(DBG_RMA | DBG_RMA_WRITE,
+             "do_remote_put_agg(): info[%d] = "
+             "{%p, %d, %p, %zd, %" PRIx64 ", %p}",
+             vi, info->src_addr_v[vi], (int) node, raddr, size, mrKey, mrDesc);
+
+  //
+  // Flush if the buffer is full or the oldest PUT has waited too long.
+  //
+  if (vi == 0) {
+    info->firstTime = chpl_comm_ofi_time_get();
+  } else if (info->vi == MAX_CHAINED_PUT_LEN
+             || chpl_comm_ofi_time_get() - info->firstTime > putAggMaxAge) {
+    put_buff_task_info_flush(info);
+  }
+
+  return true;
+}
+/*** END OF AGGREGATED PUT OPERATIONS ***/
+
+
 static inline
 chpl_comm_nb_handle_t ofi_get(void* addr, c_nodeid_t node,
                               void* raddr, size_t size) {
+  put_agg_flush();
+
   //
   // Don't ask the provider to transfer more than it wants to.
   //
@@ -4512,70 +5922,250 @@ chpl_comm_nb_handle_t ofi_get(void* addr, c_nodeid_t node,
     // The remote address is RMA-accessible; GET directly from it.
     //
     void* mrDesc = NULL;
-    if (mrGetDesc(&mrDesc, myAddr, size) != 0) {
-      myAddr = allocBounceBuf(size);
+    struct mrCacheEntry* mrce = NULL;
+    const chpl_bool bounce = (mrGetDesc(&mrDesc, myAddr, size) != 0
+                              && mrCacheGetDesc(&mrDesc, &mrce,
+                                                myAddr, size) != 0);
+
+    struct perTxCtxInfo_t* tcip;
+    CHK_TRUE((tcip = tciAlloc()) != NULL);
+
+    if (bounce && size > BB_MAX_SIZE && tcip->txCQ != NULL) {
+      ofi_get_bounced(tcip, addr, node, mrRaddr, mrKey, size);
+      tciFree(tcip);
+      return NULL;
+    }
+
+    if (bounce) {
+      myAddr = bbAlloc(tcip, size);
       DBG_PRINTF(DBG_RMA | DBG_RMA_READ, "GET tgt BB: %p", myAddr);
       CHK_TRUE(mrGetDesc(&mrDesc, myAddr, size) == 0);
     }
 
-    struct perTxCtxInfo_t* tcip;
-    CHK_TRUE((tcip = tciAlloc()) != NULL);
+    atomic_bool txnDone;
+    atomic_init_bool(&txnDone, false);
+    void* ctx = (tcip->txCQ == NULL)
+                ? txnTrkEncodeId(__LINE__)
+                : txnTrkEncodeDone(&txnDone);
+
+    DBG_PRINTF(DBG_RMA | DBG_RMA_READ,
+               "tx read: %p <= %d:%p(0x%" PRIx64 "), size %zd, key 0x%" PRIx64
+               ", ctx %p",
+               myAddr, (int) node, raddr, mrRaddr, size, mrKey, ctx);
+    OFI_RIDE_OUT_EAGAIN(tcip,
+                        fi_read(tcip->txCtx, myAddr, size,
+                                mrDesc, rxRmaAddr(tcip, node),
+                                mrRaddr, mrKey, ctx));
+    tcip->numTxnsOut++;
+    tcip->numTxnsSent++;
+
+    //
+    // This GET will force any outstanding PUT to the same node
+    // to be visible.
+    //
+    if (!haveDeliveryComplete && tcip->bound) {
+      chpl_comm_taskPrvData_t* prvData = get_comm_taskPrvdata();
+      assert(prvData != NULL);
+      if (prvData->putBitmap != NULL) {
+        bitmapClear(prvData->putBitmap, node);
+      }
+    }
+
+    waitForTxnComplete(tcip, ctx);
+    atomic_destroy_bool(&txnDone);
+    if (bounce) {
+      memcpy(addr, myAddr, size);
+      bbFree(tcip, myAddr, size);
+    }
+    tciFree(tcip);
+    mrCacheRelease(mrce);
+  } else {
+    //
+    // The remote address is not RMA-accessible.  Make sure that the
+    // local one is, then do the opposite RMA from the remote side.
+    //
+    if (mrGetLocalKey(myAddr, size) != 0) {
+      myAddr = allocBounceBuf(size);
+      DBG_PRINTF(DBG_RMA | DBG_RMA_READ, "GET via AM PUT src BB: %p", myAddr);
+      CHK_TRUE(mrGetLocalKey(myAddr, size) == 0);
+    }
+
+    DBG_PRINTF(DBG_RMA | DBG_RMA_READ,
+               "GET %p <= %d:%p, size %zd, via AM PUT",
+               myAddr, (int) node, raddr, size);
+    amRequestRMA(node, am_opPut, myAddr, raddr, size);
+
+    if (myAddr != addr) {
+      memcpy(addr, myAddr, size);
+      freeBounceBuf(myAddr);
+    }
+  }
+
+  return NULL;
+}
+
+
+//
+// GET into unregistered local memory, through a pair of bounce
+// buffers: we copy out of one while the GET into the other is in
+// flight.
+//
+static
+void ofi_get_bounced(struct perTxCtxInfo_t* tcip,
+                     void* addr, c_nodeid_t node,
+                     uint64_t mrRaddr, uint64_t mrKey, size_t size) {
+  void* bb[2];
+  void* bbDesc[2];
+  atomic_bool txnDone[2];
+  void* ctx[2];
+  const size_t numChunks = (size + BB_MAX_SIZE - 1) / BB_MAX_SIZE;
+
+  assert(tcip->txCQ != NULL);
+
+  for (int b = 0; b < 2; b++) {
+    bb[b] = bbAlloc(tcip, BB_MAX_SIZE);
+    CHK_TRUE(mrGetDesc(&bbDesc[b], bb[b], BB_MAX_SIZE) == 0);
+    atomic_init_bool(&txnDone[b], false);
+    ctx[b] = txnTrkEncodeDone(&txnDone[b]);
+  }
+
+  DBG_PRINTF(DBG_RMA | DBG_RMA_READ,
+             "GET %p <= %d:0x%" PRIx64 ", size %zd, pipelined via BBs %p, %p",
+             addr, (int) node, mrRaddr, size, bb[0], bb[1]);
+
+  for (size_t i = 0; i <= numChunks; i++) {
+    //
+    // Start the GET of chunk i, then finish off chunk i - 1.
+    //
+    if (i < numChunks) {
+      const int b = i % 2;
+      const size_t off = i * BB_MAX_SIZE;
+      const size_t len = (size - off < BB_MAX_SIZE) ? size - off : BB_MAX_SIZE;
+      OFI_RIDE_OUT_EAGAIN(tcip,
+                          fi_read(tcip->txCtx, bb[b], len,
+                                  bbDesc[b], rxRmaAddr(tcip, node),
+                                  mrRaddr + off, mrKey, ctx[b]));
+      tcip->numTxnsOut++;
+      tcip->numTxnsSent++;
+    }
+
+    if (i > 0) {
+      const int b = (i - 1) % 2;
+      const size_t off = (i - 1) * BB_MAX_SIZE;
+      const size_t len = (size - off < BB_MAX_SIZE) ? size - off : BB_MAX_SIZE;
+      waitForTxnComplete(tcip, ctx[b]);
+      atomic_store_bool(&txnDone[b], false);
+      memcpy((char*) addr + off, bb[b], len);
+    }
+  }
+
+  //
+  // These GETs forced any outstanding PUT to the same node to be
+  // visible.
+  //
+  if (!haveDeliveryComplete && tcip->bound) {
+    chpl_comm_taskPrvData_t* prvData = get_comm_taskPrvdata();
+    assert(prvData != NULL);
+    if (prvData->putBitmap != NULL) {
+      bitmapClear(prvData->putBitmap, node);
+    }
+  }
+
+  for (int b = 0; b < 2; b++) {
+    atomic_destroy_bool(&txnDone[b]);
+    bbFree(tcip, bb[b], BB_MAX_SIZE);
+  }
+}
+
+
+//
+// Nonblocking GET.  We start the transaction and release the tx context
+// right away.  When the completion comes in, whoever reaps the tx CQ
+// sets the done flag in the handle.
+//
+struct nbHandle {
+  atomic_bool done;
+  struct perTxCtxInfo_t* tcip;  // tx context the transaction went on
+};
+
+
+static
+chpl_comm_nb_handle_t ofi_get_nb(void* addr, c_nodeid_t node,
+                                 void* raddr, size_t size) {
+  put_agg_flush();
+
+  //
+  // We can only start the GET and return if neither side needs extra
+  // handling afterward.  Otherwise just do a blocking GET.
+  //
+  uint64_t mrKey;
+  uint64_t mrRaddr;
+  void* mrDesc;
+  if (size > ofi_info->ep_attr->max_msg_size
+      || mrGetKey(&mrKey, &mrRaddr, node, raddr, size) != 0
+      || mrGetDesc(&mrDesc, addr, size) != 0) {
+    return ofi_get(addr, node, raddr, size);
+  }
+
+  struct perTxCtxInfo_t* tcip;
+  CHK_TRUE((tcip = tciAlloc()) != NULL);
+  if (tcip->txCQ == NULL) {
+    tciFree(tcip);
+    return ofi_get(addr, node, raddr, size);
+  }
 
-    atomic_bool txnDone;
-    atomic_init_bool(&txnDone, false);
-    void* ctx = (tcip->txCQ == NULL)
-                ? txnTrkEncodeId(__LINE__)
-                : txnTrkEncodeDone(&txnDone);
+  struct nbHandle* h;
+  CHPL_CALLOC(h, 1);
+  atomic_init_bool(&h->done, false);
+  h->tcip = tcip;
+  void* ctx = txnTrkEncodeDone(&h->done);
 
-    DBG_PRINTF(DBG_RMA | DBG_RMA_READ,
-               "tx read: %p <= %d:%p(0x%" PRIx64 "), size %zd, key 0x%" PRIx64
-               ", ctx %p",
-               myAddr, (int) node, raddr, mrRaddr, size, mrKey, ctx);
-    OFI_RIDE_OUT_EAGAIN(tcip,
-                        fi_read(tcip->txCtx, myAddr, size,
-                                mrDesc, rxRmaAddr(tcip, node),
-                                mrRaddr, mrKey, ctx));
-    tcip->numTxnsOut++;
-    tcip->numTxnsSent++;
+  DBG_PRINTF(DBG_RMA | DBG_RMA_READ,
+             "tx read nb: %p <= %d:%p(0x%" PRIx64 "), size %zd, key 0x%" PRIx64
+             ", ctx %p",
+             addr, (int) node, raddr, mrRaddr, size, mrKey, ctx);
+  OFI_RIDE_OUT_EAGAIN(tcip,
+                      fi_read(tcip->txCtx, addr, size,
+                              mrDesc, rxRmaAddr(tcip, node),
+                              mrRaddr, mrKey, ctx));
+  tcip->numTxnsOut++;
+  tcip->numTxnsSent++;
+  tciFree(tcip);
 
-    //
-    // This GET will force any outstanding PUT to the same node
-    // to be visible.
-    //
-    if (!haveDeliveryComplete && tcip->bound) {
-      chpl_comm_taskPrvData_t* prvData = get_comm_taskPrvdata();
-      assert(prvData != NULL);
-      if (prvData->putBitmap != NULL) {
-        bitmapClear(prvData->putBitmap, node);
-      }
-    }
+  return h;
+}
 
-    waitForTxnComplete(tcip, ctx);
-    atomic_destroy_bool(&txnDone);
-    tciFree(tcip);
-  } else {
-    //
-    // The remote address is not RMA-accessible.  Make sure that the
-    // local one is, then do the opposite RMA from the remote side.
-    //
-    if (mrGetLocalKey(myAddr, size) != 0) {
-      myAddr = allocBounceBuf(size);
-      DBG_PRINTF(DBG_RMA | DBG_RMA_READ, "GET via AM PUT src BB: %p", myAddr);
-      CHK_TRUE(mrGetLocalKey(myAddr, size) == 0);
-    }
 
-    DBG_PRINTF(DBG_RMA | DBG_RMA_READ,
-               "GET %p <= %d:%p, size %zd, via AM PUT",
-               myAddr, (int) node, raddr, size);
-    amRequestRMA(node, am_opPut, myAddr, raddr, size);
+static
+chpl_bool nbHandleCheck(struct nbHandle* h) {
+  if (atomic_load_explicit_bool(&h->done, memory_order_acquire)) {
+    return true;
   }
 
-  if (myAddr != addr) {
-    memcpy(addr, myAddr, size);
-    freeBounceBuf(myAddr);
+  //
+  // Not done yet.  Drive progress on the tx context the transaction
+  // went on, if we can get it.  If it's bound it can only be ours, and
+  // if it's in use by some other thread then that thread will reap our
+  // completion.
+  //
+  struct perTxCtxInfo_t* tcip = h->tcip;
+  if (tcip->bound) {
+    if (tcip == _ttcip) {
+      (*tcip->checkTxCmplsFn)(tcip);
+    }
+  } else if (!atomic_exchange_bool(&tcip->allocated, true)) {
+    (*tcip->checkTxCmplsFn)(tcip);
+    atomic_store_bool(&tcip->allocated, false);
   }
 
-  return NULL;
+  return atomic_load_explicit_bool(&h->done, memory_order_acquire);
+}
+
+
+static
+void nbHandleFree(struct nbHandle* h) {
+  atomic_destroy_bool(&h->done);
+  CHPL_FREE(h);
 }
 
 
@@ -4628,6 +6218,8 @@ void ofi_get_V(int v_len, void** addr_v, void** local_mr_v,
 
   assert(!isAmHandler);
 
+  put_agg_flush();
+
   struct perTxCtxInfo_t* tcip;
   CHK_TRUE((tcip = tciAlloc()) != NULL);
 
@@ -5106,6 +6698,7 @@ void waitForPutsVisOneNode(c_nodeid_t node, struct perTxCtxInfo_t* tcip,
     }
 
     if (myPrvData->putBitmap != NULL
+        && !bitmapIsEmpty(myPrvData->putBitmap)
         && bitmapTest(myPrvData->putBitmap, node)) {
       bitmapClear(myPrvData->putBitmap, node);
       mcmReleaseOneNode(node, tcip, "PUT");
@@ -5125,29 +6718,41 @@ void waitForPutsVisAllNodes(struct perTxCtxInfo_t* tcip,
   // ordering because the provider lacks delivery-complete and we've
   // got a bound tx context.
   //
+  // The PUT bitmap only ever has bits set for nodes we've left PUTs
+  // outstanding to on our bound tx context, and GETs on that context
+  // clear them as they go.  So we check it first: usually it's empty
+  // and we needn't even look up a tx context, and otherwise we only
+  // fence the nodes it names.
+  //
   if (chpl_numNodes > 1 && !haveDeliveryComplete) {
-    struct perTxCtxInfo_t* myTcip = tcip;
-    if (myTcip == NULL) {
-      CHK_TRUE((myTcip = tciAlloc()) != NULL);
+    chpl_comm_taskPrvData_t* myPrvData = prvData;
+    if (myPrvData == NULL
+        && (myPrvData = get_comm_taskPrvdata()) == NULL) {
+      return;
+    }
+
+    if (myPrvData->putBitmap == NULL) {
+      return;
     }
 
-    if (myTcip->bound) {
-      chpl_comm_taskPrvData_t* myPrvData = prvData;
-      if (myPrvData == NULL) {
-        CHK_TRUE((myPrvData = get_comm_taskPrvdata()) != NULL);
+    if (!bitmapIsEmpty(myPrvData->putBitmap)) {
+      struct perTxCtxInfo_t* myTcip = tcip;
+      if (myTcip == NULL) {
+        CHK_TRUE((myTcip = tciAlloc()) != NULL);
       }
 
-      if (myPrvData->putBitmap != NULL) {
-        mcmReleaseAllNodes(myPrvData->putBitmap, NULL, "PUT");
-        if (taskIsEnding) {
-          bitmapFree(myPrvData->putBitmap);
-          myPrvData->putBitmap = NULL;
-        }
+      if (myTcip->bound) {
+        mcmReleaseAllNodes(myPrvData->putBitmap, myTcip, "PUT");
+      }
+
+      if (myTcip != tcip) {
+        tciFree(myTcip);
       }
     }
 
-    if (myTcip != tcip) {
-      tciFree(myTcip);
+    if (taskIsEnding) {
+      bitmapFree(myPrvData->putBitmap);
+      myPrvData->putBitmap = NULL;
     }
   }
 }
@@ -5167,6 +6772,69 @@ void freeBounceBuf(void* p) {
 }
 
 
+static inline
+int bbSizeClass(size_t size) {
+  int c = 0;
+  while (((size_t) 1 << (BB_MIN_SIZE_LOG2 + c)) < size) {
+    c++;
+  }
+  return c;
+}
+
+
+//
+// Pooled bounce buffers.  The caller must hold tcip from before
+// bbAlloc() until after bbFree().  Sizes over BB_MAX_SIZE aren't
+// pooled.
+//
+static
+void* bbAlloc(struct perTxCtxInfo_t* tcip, size_t size) {
+  if (size > BB_MAX_SIZE) {
+    return allocBounceBuf(size);
+  }
+
+  const int c = bbSizeClass(size);
+  void* p = tcip->bbPool[c];
+  if (p == NULL) {
+    return allocBounceBuf((size_t) 1 << (BB_MIN_SIZE_LOG2 + c));
+  }
+  tcip->bbPool[c] = *(void**) p;
+  tcip->bbPoolLen[c]--;
+  return p;
+}
+
+
+static
+void bbFree(struct perTxCtxInfo_t* tcip, void* p, size_t size) {
+  if (size > BB_MAX_SIZE) {
+    freeBounceBuf(p);
+    return;
+  }
+
+  const int c = bbSizeClass(size);
+  if (tcip->bbPoolLen[c] >= BB_POOL_DEPTH) {
+    freeBounceBuf(p);
+    return;
+  }
+  *(void**) p = tcip->bbPool[c];
+  tcip->bbPool[c] = p;
+  tcip->bbPoolLen[c]++;
+}
+
+
+static
+void bbPoolDrain(struct perTxCtxInfo_t* tcip) {
+  for (int c = 0; c < BB_NUM_CLASSES; c++) {
+    while (tcip->bbPool[c] != NULL) {
+      void* p = tcip->bbPool[c];
+      tcip->bbPool[c] = *(void**) p;
+      freeBounceBuf(p);
+    }
+    tcip->bbPoolLen[c] = 0;
+  }
+}
+
+
 static inline
 void local_yield(void) {
 #ifdef CHPL_COMM_DEBUG
@@ -5209,6 +6877,116 @@ static inline void doAMO(c_nodeid_t, void*, const void*, const void*, void*,
                          int, enum fi_datatype, size_t);
 
 
+//
+// Relaxed remote atomic read cache
+//
+// Polling loops (termination detection, for example) spin on a remote
+// atomic read with memory_order_relaxed and would otherwise do an AMO
+// on every iteration.  When CHPL_RT_COMM_OFI_AMO_READ_CACHE_US is set
+// we instead keep, per thread, the last value read from a few remote
+// atomics and hand it back to later relaxed reads.  A cached value is
+// never older than that many microseconds.  Each entry backs off on
+// its own: every refetch that finds the value unchanged doubles the
+// number of reads it may serve next time, up to
+// CHPL_RT_COMM_OFI_AMO_READ_CACHE_POLLS, and a changed value puts it
+// back to refetching every time.  Any other AMO done by the thread, and
+// any read that isn't relaxed, drops the whole cache, so this thread's
+// own updates and acquires are always seen.
+//
+static double amoReadCacheMaxAge = 0.0;  // seconds; 0 means disabled
+static int amoReadCacheMaxPolls = 64;
+
+#define AMO_READ_CACHE_LEN 16            // must be a power of 2
+
+struct amoReadCacheEnt_t {
+  void* object;                         // NULL if the entry is unused
+  c_nodeid_t node;
+  size_t size;
+  chpl_amo_datum_t val;
+  double fetchTime;                     // when val was read
+  int pollsLeft;                        // reads still to serve from val
+  int pollsAllowed;                     // current backoff
+};
+
+static __thread struct amoReadCacheEnt_t amoReadCache[AMO_READ_CACHE_LEN];
+static __thread chpl_bool amoReadCacheInUse = false;
+
+static
+void init_amoReadCache(void) {
+  const int64_t us = chpl_env_rt_get_int("COMM_OFI_AMO_READ_CACHE_US", 0);
+  const int64_t polls = chpl_env_rt_get_int("COMM_OFI_AMO_READ_CACHE_POLLS",
+                                            amoReadCacheMaxPolls);
+  if (us > 0 && polls > 0) {
+    amoReadCacheMaxAge = us * 1.0e-6;
+    amoReadCacheMaxPolls = (polls > INT_MAX) ? INT_MAX : (int) polls;
+  }
+}
+
+static inline
+struct amoReadCacheEnt_t* amoReadCacheSlot(c_nodeid_t node, void* object) {
+  uintptr_t h = ((uintptr_t) object >> 3) ^ ((uintptr_t) node * 0x9e3779b1);
+  return &amoReadCache[(h ^ (h >> 7)) & (AMO_READ_CACHE_LEN - 1)];
+}
+
+static inline
+void amoReadCacheClear(void) {
+  if (amoReadCacheInUse) {
+    memset(amoReadCache, 0, sizeof(amoReadCache));
+    amoReadCacheInUse = false;
+  }
+}
+
+//
+// Returns true and fills in *result if a cached value can be used.
+//
+static inline
+chpl_bool amoReadCacheGet(c_nodeid_t node, void* object, void* result,
+                          size_t size) {
+  struct amoReadCacheEnt_t* ent = amoReadCacheSlot(node, object);
+  if (ent->object != object || ent->node != node || ent->size != size
+      || ent->pollsLeft <= 0) {
+    return false;
+  }
+
+  if (chpl_comm_ofi_time_get() - ent->fetchTime > amoReadCacheMaxAge) {
+    ent->pollsLeft = 0;
+    return false;
+  }
+
+  ent->pollsLeft--;
+  memcpy(result, &ent->val, size);
+  return true;
+}
+
+static inline
+void amoReadCachePut(c_nodeid_t node, void* object, const void* result,
+                     size_t size) {
+  struct amoReadCacheEnt_t* ent = amoReadCacheSlot(node, object);
+  chpl_amo_datum_t val;
+
+  memset(&val, 0, sizeof(val));
+  memcpy(&val, result, size);
+  if (ent->object == object && ent->node == node && ent->size == size
+      && memcmp(&ent->val, &val, sizeof(val)) == 0) {
+    // Unchanged since the last fetch; back off further.
+    ent->pollsAllowed = (ent->pollsAllowed == 0)
+                        ? 1
+                        : ((ent->pollsAllowed > amoReadCacheMaxPolls / 2)
+                           ? amoReadCacheMaxPolls
+                           : 2 * ent->pollsAllowed);
+  } else {
+    ent->object = object;
+    ent->node = node;
+    ent->size = size;
+    ent->val = val;
+    ent->pollsAllowed = 0;
+  }
+  ent->pollsLeft = ent->pollsAllowed;
+  ent->fetchTime = chpl_comm_ofi_time_get();
+  amoReadCacheInUse = true;
+}
+
+
 //
 // WRITE
 //
@@ -5245,6 +7023,20 @@ DEFN_CHPL_COMM_ATOMIC_WRITE(real64, FI_DOUBLE, _real64)
                "%s(%p, %d, %p, %d, %s)", __func__,                      \
                result, (int) node, object,                              \
                ln, chpl_lookupFilename(fn));                            \
+    if (amoReadCacheMaxAge > 0.0 && node != chpl_nodeID) {              \
+      if (order == memory_order_relaxed) {                              \
+        if (amoReadCacheGet(node, object, result, sizeof(Type))) {      \
+          return;                                                       \
+        }                                                               \
+        chpl_comm_diags_verbose_amo("amo read", node, ln, fn);          \
+        chpl_comm_diags_incr(amo);                                      \
+        doAMO(node, object, NULL, NULL, result,                         \
+              FI_ATOMIC_READ, ofiType, sizeof(Type));                   \
+        amoReadCachePut(node, object, result, sizeof(Type));            \
+        return;                                                         \
+      }                                                                 \
+      amoReadCacheClear();                                              \
+    }                                                                   \
     chpl_comm_diags_verbose_amo("amo read", node, ln, fn);              \
     chpl_comm_diags_incr(amo);                                          \
     doAMO(node, object, NULL, NULL, result,                             \
@@ -5521,6 +7313,13 @@ void doAMO(c_nodeid_t node, void* object,
     return;
   }
 
+  if (ofiOp != FI_ATOMIC_READ) {
+    // Our own updates must be visible to our later cached reads.
+    amoReadCacheClear();
+  }
+
+  put_agg_flush();
+
   retireDelayedAmDone(false /*taskIsEnding*/);
 
   uint64_t mrKey;
@@ -5728,6 +7527,73 @@ void doCpuAMO(void* obj,
  * transaction rate.
  */
 
+// Combine real-typed AMOs too?  Off by default, because it reassociates
+// floating point sums.
+static chpl_bool amoCombineReals = false;
+
+static
+void init_amoCombine(void) {
+  amoCombineReals = chpl_env_rt_get_bool("COMM_OFI_AMO_COMBINE_REALS", false);
+}
+
+
+//
+// Combine a new operand into one already buffered for the same op on
+// the same target, so that the target sees a single AMO with the same
+// effect as both.  Returns false if the op can't be combined this way.
+//
+#define AMO_COMBINE_CASES(Type, v, a)                                   \
+      switch (ofiOp) {                                                  \
+      case FI_SUM:  *(Type*) (a) += (Type) (v); break;                  \
+      case FI_MIN:  if ((Type) (v) < *(Type*) (a)) *(Type*) (a) = (v);  \
+                    break;                                              \
+      case FI_MAX:  if ((Type) (v) > *(Type*) (a)) *(Type*) (a) = (v);  \
+                    break;                                              \
+      default: return false;                                            \
+      }
+
+#define AMO_COMBINE_BIT_CASES(Type, v, a)                               \
+      switch (ofiOp) {                                                  \
+      case FI_BAND: *(Type*) (a) &= (Type) (v); break;                  \
+      case FI_BOR:  *(Type*) (a) |= (Type) (v); break;                  \
+      case FI_BXOR: *(Type*) (a) ^= (Type) (v); break;                  \
+      default: AMO_COMBINE_CASES(Type, v, a)                            \
+      }
+
+static inline
+chpl_bool amoCombine(uint64_t* pAcc, void* opnd,
+                     enum fi_op ofiOp, enum fi_datatype ofiType) {
+  switch (ofiType) {
+  case FI_INT32:
+    AMO_COMBINE_BIT_CASES(int32_t, *(int32_t*) opnd, pAcc);
+    break;
+  case FI_UINT32:
+    AMO_COMBINE_BIT_CASES(uint32_t, *(uint32_t*) opnd, pAcc);
+    break;
+  case FI_INT64:
+    AMO_COMBINE_BIT_CASES(int64_t, *(int64_t*) opnd, pAcc);
+    break;
+  case FI_UINT64:
+    AMO_COMBINE_BIT_CASES(uint64_t, *(uint64_t*) opnd, pAcc);
+    break;
+  case FI_FLOAT:
+    if (!amoCombineReals) return false;
+    AMO_COMBINE_CASES(float, *(float*) opnd, pAcc);
+    break;
+  case FI_DOUBLE:
+    if (!amoCombineReals) return false;
+    AMO_COMBINE_CASES(double, *(double*) opnd, pAcc);
+    break;
+  default:
+    return false;
+  }
+  return true;
+}
+
+#undef AMO_COMBINE_BIT_CASES
+#undef AMO_COMBINE_CASES
+
+
 // Flush buffered AMOs for the specified task info and reset the counter.
 static inline
 void amo_nf_buff_task_info_flush(amo_nf_buff_task_info_t* info) {
@@ -5755,6 +7621,9 @@ void do_remote_amo_nf_buff(void* opnd1, c_nodeid_t node,
     return;
   }
 
+  amoReadCacheClear();
+  put_agg_flush();
+
   retireDelayedAmDone(false /*taskIsEnding*/);
 
   uint64_t mrKey;
@@ -5785,6 +7654,23 @@ void do_remote_amo_nf_buff(void* opnd1, c_nodeid_t node,
     info->new = false;
   }
 
+  //
+  // If there's already a buffered AMO doing the same thing to the same
+  // target, fold this one into it.  Unordered AMOs give no ordering
+  // among themselves, so nothing can tell the difference.
+  //
+  for (int i = info->vi - 1; i >= 0; i--) {
+    if (info->object_v[i] == object
+        && info->locale_v[i] == node
+        && info->cmd_v[i] == ofiOp
+        && info->type_v[i] == ofiType
+        && amoCombine(&info->opnd1_v[i], opnd1, ofiOp, ofiType)) {
+      DBG_PRINTF(DBG_AMO_UNORD,
+                 "do_remote_amo_nf_buff(): combined into info[%d]", i);
+      return;
+    }
+  }
+
   int vi = info->vi;
   info->opnd1_v[vi]     = size == 4 ? *(uint32_t*) opnd1:
                                       *(uint64_t*) opnd1;
@@ -5873,6 +7759,178 @@ static c_nodeid_t bar_parent;
 static bar_info_t bar_info;
 static bar_info_t** bar_infoMap;
 
+//
+// Offloaded barrier.  If the provider supports libfabric collectives,
+// we do barriers with fi_barrier() on a dedicated endpoint joined to a
+// collective group covering all the nodes, instead of with the tree.
+// Setup is all-or-nothing across the job: if any node can't do it then
+// every node uses the tree.
+//
+static chpl_bool bar_useColl;
+static struct fid_ep* bar_collEp;
+static struct fid_cq* bar_collCQ;
+static struct fid_eq* bar_collEQ;
+static struct fid_av_set* bar_collAvSet;
+static struct fid_mc* bar_collMc;
+static fi_addr_t bar_collAddr;
+
+
+static
+chpl_bool barCollAllOk(chpl_bool ok) {
+  chpl_bool* oks;
+  CHPL_CALLOC(oks, chpl_numNodes);
+  chpl_comm_ofi_oob_allgather(&ok, oks, sizeof(ok));
+  for (int i = 0; i < chpl_numNodes; i++) {
+    ok = ok && oks[i];
+  }
+  CHPL_FREE(oks);
+  return ok;
+}
+
+
+static
+void barCollProgress(void) {
+  //
+  // Reading the CQ drives progress for providers that do collectives
+  // in software.  The only completions are for our own operations.
+  //
+  struct fi_cq_entry cqe;
+  ssize_t ret;
+  CHK_TRUE((ret = fi_cq_read(bar_collCQ, &cqe, 1)) == -FI_EAGAIN
+           || ret == -FI_EAVAIL);
+  if (ret == -FI_EAVAIL) {
+    reportCQError(bar_collCQ);
+  }
+}
+
+
+static
+void fini_barColl(void) {
+  if (bar_collMc != NULL) {
+    OFI_CHK(fi_close(&bar_collMc->fid));
+  }
+  if (bar_collAvSet != NULL) {
+    OFI_CHK(fi_close(&bar_collAvSet->fid));
+  }
+  if (bar_collEp != NULL) {
+    OFI_CHK(fi_close(&bar_collEp->fid));
+  }
+  if (bar_collCQ != NULL) {
+    OFI_CHK(fi_close(&bar_collCQ->fid));
+  }
+  if (bar_collEQ != NULL) {
+    OFI_CHK(fi_close(&bar_collEQ->fid));
+  }
+  bar_collMc = NULL;
+  bar_collAvSet = NULL;
+  bar_collEp = NULL;
+  bar_collCQ = NULL;
+  bar_collEQ = NULL;
+  bar_useColl = false;
+}
+
+
+static
+void init_barColl(void) {
+  chpl_bool ok = chpl_env_rt_get_bool("COMM_OFI_BARRIER_OFFLOAD", true);
+
+  //
+  // Local setup: see if the provider can do barriers, and make an
+  // endpoint with the resources a collective join needs.
+  //
+  if (ok) {
+    struct fi_collective_attr collAttr = { .op = FI_NOOP,
+                                           .datatype = FI_VOID, };
+    ok = (fi_query_collective(ofi_domain, FI_BARRIER, &collAttr, 0)
+          == FI_SUCCESS);
+    DBG_PRINTF(DBG_BARRIER, "fi_query_collective(FI_BARRIER): %s",
+               ok ? "supported" : "not supported");
+  }
+
+  if (ok) {
+    struct fi_info* info;
+    CHK_TRUE((info = fi_dupinfo(ofi_info)) != NULL);
+    info->caps |= FI_COLLECTIVE;
+
+    struct fi_eq_attr eqAttr = { .size = 8, .wait_obj = FI_WAIT_NONE, };
+    struct fi_cq_attr cqAttr = { .format = FI_CQ_FORMAT_CONTEXT,
+                                 .size = 8,
+                                 .wait_obj = FI_WAIT_NONE, };
+    ok = (fi_eq_open(ofi_fabric, &eqAttr, &bar_collEQ, NULL) == FI_SUCCESS
+          && fi_cq_open(ofi_domain, &cqAttr, &bar_collCQ, NULL) == FI_SUCCESS
+          && fi_endpoint(ofi_domain, info, &bar_collEp, NULL) == FI_SUCCESS
+          && fi_ep_bind(bar_collEp, &ofi_av->fid, 0) == FI_SUCCESS
+          && fi_ep_bind(bar_collEp, &bar_collCQ->fid,
+                        FI_TRANSMIT | FI_RECV) == FI_SUCCESS
+          && fi_ep_bind(bar_collEp, &bar_collEQ->fid, 0) == FI_SUCCESS
+          && fi_enable(bar_collEp) == FI_SUCCESS);
+    fi_freeinfo(info);
+  }
+
+  if (!barCollAllOk(ok)) {
+    fini_barColl();
+    return;
+  }
+
+  //
+  // Exchange the new endpoint addresses and build a set of them.
+  //
+  size_t addrLen = 0;
+  OFI_CHK_1(fi_getname(&bar_collEp->fid, NULL, &addrLen), -FI_ETOOSMALL);
+  char* addrs;
+  CHPL_CALLOC_SZ(addrs, chpl_numNodes, addrLen);
+  OFI_CHK(fi_getname(&bar_collEp->fid, addrs + chpl_nodeID * addrLen,
+                     &addrLen));
+  chpl_comm_ofi_oob_allgather(addrs + chpl_nodeID * addrLen, addrs, addrLen);
+
+  fi_addr_t* collAddrs;
+  CHPL_CALLOC(collAddrs, chpl_numNodes);
+  ok = (fi_av_insert(ofi_av, addrs, chpl_numNodes, collAddrs, 0, NULL)
+        == chpl_numNodes);
+  CHPL_FREE(addrs);
+
+  if (ok) {
+    struct fi_av_set_attr setAttr = { .count = 0,
+                                      .start_addr = FI_ADDR_NOTAVAIL,
+                                      .end_addr = FI_ADDR_NOTAVAIL,
+                                      .stride = 1, };
+    ok = (fi_av_set(ofi_av, &setAttr, &bar_collAvSet, NULL) == FI_SUCCESS);
+    for (int i = 0; ok && i < chpl_numNodes; i++) {
+      ok = (fi_av_set_insert(bar_collAvSet, collAddrs[i]) == FI_SUCCESS);
+    }
+  }
+  CHPL_FREE(collAddrs);
+
+  if (!barCollAllOk(ok)) {
+    fini_barColl();
+    return;
+  }
+
+  //
+  // Join the collective group.  Everyone gets here together, so any
+  // failure from now on is fatal rather than a reason to fall back.
+  //
+  fi_addr_t setAddr;
+  OFI_CHK(fi_av_set_addr(bar_collAvSet, &setAddr));
+  OFI_CHK(fi_join_collective(bar_collEp, setAddr, bar_collAvSet, 0,
+                             &bar_collMc, NULL));
+
+  uint32_t event;
+  struct fi_eq_entry eqe;
+  ssize_t ret;
+  do {
+    barCollProgress();
+    ret = fi_eq_read(bar_collEQ, &event, &eqe, sizeof(eqe), 0);
+  } while (ret == -FI_EAGAIN);
+  if (ret < 0 || event != FI_JOIN_COMPLETE) {
+    INTERNAL_ERROR_V("collective join failed: ret %zd, event %u",
+                     ret, event);
+  }
+
+  bar_collAddr = fi_mc_addr(bar_collMc);
+  bar_useColl = true;
+}
+
 
 static
 void init_bar(void) {
@@ -5889,6 +7947,15 @@ void init_bar(void) {
   CHPL_CALLOC(bar_infoMap, chpl_numNodes);
   const bar_info_t* p = &bar_info;
   chpl_comm_ofi_oob_allgather(&p, bar_infoMap, sizeof(p));
+
+  init_barColl();
+
+  if (verbosity >= 2) {
+    if (chpl_nodeID == 0) {
+      printf("COMM=ofi: barriers use %s\n",
+             bar_useColl ? "fi_barrier()" : "a tree of PUTs");
+    }
+  }
 }
 
 
@@ -5922,9 +7989,35 @@ void chpl_comm_barrier(const char *msg) {
   // (Visibility of operations done by other tasks on this node is
   // the caller's responsibility.)
   //
+  put_agg_flush();
   retireDelayedAmDone(false /*taskIsEnding*/);
   waitForPutsVisAllNodes(NULL, NULL, false /*taskIsEnding*/);
 
+  if (bar_useColl) {
+    ssize_t ret;
+    do {
+      OFI_CHK_2(fi_barrier(bar_collEp, bar_collAddr, &bar_collEp),
+                ret, -FI_EAGAIN);
+      if (ret == -FI_EAGAIN) {
+        barCollProgress();
+      }
+    } while (ret == -FI_EAGAIN);
+
+    struct fi_cq_entry cqe;
+    while ((ret = fi_cq_read(bar_collCQ, &cqe, 1)) != 1) {
+      CHK_TRUE(ret == -FI_EAGAIN || ret == -FI_EAVAIL);
+      if (ret == -FI_EAVAIL) {
+        reportCQError(bar_collCQ);
+      }
+      local_yield();
+    }
+    CHK_TRUE(cqe.op_context == &bar_collEp);
+
+    DBG_PRINTF(DBG_BARRIER, "barrier '%s' done via fi_barrier()",
+               (msg == NULL) ? "" : msg);
+    return;
+  }
+
   //
   // Wait for our child locales to notify us that they have reached the
   // barrier.
@@ -6242,8 +8335,10 @@ const char* am_opName(amOp_t op) {
   case am_opExecOnLrg: return "opExecOnLrg";
   case am_opGet: return "opGet";
   case am_opPut: return "opPut";
+  case am_opXfer: return "opXfer";
   case am_opAMO: return "opAMO";
   case am_opFree: return "opFree";
+  case am_opAlloc: return "opAlloc";
   case am_opNop: return "opNop";
   case am_opShutdown: return "opShutdown";
   default: return "op???";
@@ -6328,6 +8423,13 @@ const char* am_reqStr(c_nodeid_t tgtNode, amRequest_t* req, size_t reqSize) {
                     req->rma.b.node, req->rma.raddr, req->rma.size);
     break;
 
+  case am_opXfer:
+    len += snprintf(buf + len, sizeof(buf) - len, ", %d:%p -> %d:%p, sz %zd",
+                    (int) tgtNode, req->xfer.srcAddr,
+                    (int) req->xfer.dstNode, req->xfer.dstAddr,
+                    req->xfer.size);
+    break;
+
   case am_opAMO:
     if (req->amo.ofiOp == FI_CSWAP) {
       len += snprintf(buf + len, sizeof(buf) - len,
@@ -6371,6 +8473,11 @@ const char* am_reqStr(c_nodeid_t tgtNode, amRequest_t* req, size_t reqSize) {
                     req->free.p);
     break;
 
+  case am_opAlloc:
+    len += snprintf(buf + len, sizeof(buf) - len, ", %" PRIu32 " x %zd -> %p",
+                    req->alloc.n, req->alloc.size, req->alloc.ptrs);
+    break;
+
   default:
     break;
   }
@@ -0,0 +1,1505 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Shared-memory implementation of the Chapel communication interface,
+// for running multiple locales on a single node.
+//
+// The locales are processes forked by node 0 in chpl_comm_init().
+// Before forking, node 0 maps one shared segment that holds all of the
+// locales' heaps, one slice each.  Since the mapping is inherited, the
+// segment is at the same address in every locale, and since everything
+// the runtime and the generated code may reach remotely is allocated
+// from the heap, almost all PUTs and GETs are just memcpy()s and almost
+// all AMOs are just processor atomics on the target location.
+//
+// Anything else (on-stmts, and transfers and AMOs on memory outside the
+// segment, such as other locales' static data) is done with active
+// messages.  Every ordered pair of locales has a single-producer,
+// single-consumer ring of fixed-size request slots in a second shared
+// mapping.  Tasks on the initiating locale take turns at producing into
+// a ring using a local lock, and a progress thread on the target locale
+// is the only consumer.  The progress thread never sends requests
+// itself, so it can never block on a full ring.  Any response goes into
+// a reply buffer allocated from the initiator's heap, where the target
+// can write it directly.
+//
+// Since processor atomics are used across processes, CHPL_ATOMICS must
+// not be 'locks'.
+//
+
+#include "chplrt.h"
+#include "chpl-env-gen.h"
+
+#include "chpl-atomics.h"
+#include "chpl-comm.h"
+#include "chpl-comm-callbacks.h"
+#include "chpl-comm-callbacks-internal.h"
+#include "chpl-comm-diags.h"
+#include "chpl-comm-internal.h"
+#include "chpl-comm-strd-xfer.h"
+#include "chpl-env.h"
+#include "chplexit.h"
+#include "chpl-gen-includes.h"
+#include "chpl-linefile-support.h"
+#include "chpl-locks.h"
+#include "chpl-mem.h"
+#include "chplsys.h"
+#include "chpl-tasks.h"
+#include "chplcgfns.h"
+#include "chpltypes.h"
+#include "error.h"
+
+// Don't get warning macros for chpl_comm_get etc
+#include "chpl-comm-no-warning-macros.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+
+////////////////////////////////////////
+//
+// Shared state
+//
+
+#define SHM_MAX_NODES     1024
+#define AM_RING_SLOTS     64    // must be a power of 2
+#define AM_SLOT_SIZE      512
+#define CACHE_LINE_SIZE   64
+
+struct amRing_t {
+  atomic_uint_least64_t head;   // next slot to consume; target writes
+  char pad1[CACHE_LINE_SIZE - sizeof(atomic_uint_least64_t)];
+  atomic_uint_least64_t tail;   // next slot to fill; initiator writes
+  char pad2[CACHE_LINE_SIZE - sizeof(atomic_uint_least64_t)];
+  char slots[AM_RING_SLOTS][AM_SLOT_SIZE];
+};
+
+struct shmCtl_t {
+  atomic_uint_least32_t barCount;       // nodes arrived at the barrier
+  atomic_bool barSense;                 // flips when the barrier completes
+  atomic_bool shuttingDown;             // normal exit has begun
+  atomic_bool exitAny;                  // some node is exiting alone
+  int exitStatus;                       // ... with this status
+  wide_ptr_t* globalsBuf;               // node 0's global var wide ptrs
+  pid_t pids[SHM_MAX_NODES];            // process of each node
+};
+
+static struct shmCtl_t* shmCtl;         // control area
+static struct amRing_t* amRings;        // [target][initiator] rings
+static char*            segBase;        // start of all the heaps
+static size_t           segSize;        // total size of all the heaps
+static size_t           heapSize;       // size of each node's heap
+
+static chpl_mcs_lock_t*   txLocks;      // per-target producer locks
+static chpl_bool          barSense;     // this node's barrier sense
+
+static atomic_bool amHandlerStop;       // ask the progress thread to stop
+static atomic_bool amHandlerDone;       // the progress thread has stopped
+
+
+static inline
+chpl_bool inSegment(const void* p, size_t size) {
+  const char* cp = (const char*) p;
+  return cp >= segBase && cp + size <= segBase + segSize;
+}
+
+
+static inline
+struct amRing_t* amRing(c_nodeid_t target, c_nodeid_t initiator) {
+  return &amRings[(size_t) target * chpl_numNodes + initiator];
+}
+
+
+static void* shmMap(size_t size) {
+  void* p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+  if (p == MAP_FAILED) {
+    chpl_error_explicit("comm=shm cannot map shared memory", 0, NULL);
+  }
+
+  return p;
+}
+
+
+////////////////////////////////////////
+//
+// Interface: initialization
+//
+
+static void init_forkNodes(void);
+
+void chpl_comm_init(int *argc_p, char ***argv_p) {
+  int64_t numNodes = chpl_env_rt_get_int("COMM_SHM_NODES", 1);
+
+  if (numNodes < 1 || numNodes > SHM_MAX_NODES) {
+    char msg[100];
+    snprintf(msg, sizeof(msg),
+             "comm=shm supports 1 to %d locales", SHM_MAX_NODES);
+    chpl_error(msg, 0, 0);
+  }
+
+  chpl_numNodes = (int32_t) numNodes;
+  chpl_nodeID = 0;
+
+  //
+  // Size the heaps.  The segment is only reserved, not committed, so
+  // by default we let each node have an equal share of the physical
+  // memory.
+  //
+  size_t pageSize = chpl_getSysPageSize();
+  heapSize = chpl_comm_getenvMaxHeapSize();
+  if (heapSize == 0) {
+    heapSize = (size_t) (chpl_sys_physicalMemoryBytes() / chpl_numNodes);
+  }
+  heapSize &= ~(pageSize - 1);
+  segSize = heapSize * chpl_numNodes;
+  segBase = (char*) shmMap(segSize);
+
+  shmCtl = (struct shmCtl_t*) shmMap(sizeof(*shmCtl));
+  atomic_init_uint_least32_t(&shmCtl->barCount, 0);
+  atomic_init_bool(&shmCtl->barSense, false);
+  atomic_init_bool(&shmCtl->shuttingDown, false);
+  atomic_init_bool(&shmCtl->exitAny, false);
+  barSense = false;
+
+  amRings = (struct amRing_t*)
+            shmMap((size_t) chpl_numNodes * chpl_numNodes * sizeof(*amRings));
+
+  init_forkNodes();
+}
+
+
+//
+// Fork the other nodes.  Each one just carries on from here with its
+// own node ID.
+//
+static void init_forkNodes(void) {
+  shmCtl->pids[0] = getpid();
+
+  fflush(NULL);
+
+  for (c_nodeid_t node = 1; node < chpl_numNodes; node++) {
+    pid_t pid = fork();
+
+    if (pid < 0) {
+      chpl_error_explicit("comm=shm cannot fork locale processes", 0, NULL);
+    }
+
+    if (pid == 0) {
+#ifdef __linux__
+      // Don't outlive node 0.
+      (void) prctl(PR_SET_PDEATHSIG, SIGKILL);
+      if (getppid() != shmCtl->pids[0]) {
+        _exit(1);
+      }
+#endif
+      chpl_nodeID = node;
+      shmCtl->pids[node] = getpid();
+      return;
+    }
+
+    shmCtl->pids[node] = pid;
+  }
+}
+
+
+void chpl_comm_post_mem_init(void) {
+  //
+  // Cross-process AMOs are done directly with processor atomics, which
+  // the 'locks' implementation doesn't provide.
+  //
+  if (strcmp(CHPL_ATOMICS, "locks") == 0) {
+    chpl_error_explicit("comm=shm requires processor atomics, "
+                        "but CHPL_ATOMICS=locks", 0, NULL);
+  }
+
+  chpl_comm_init_prv_bcast_tab();
+
+  txLocks = chpl_mem_allocManyZero(chpl_numNodes, sizeof(txLocks[0]),
+                                   CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+
+  //
+  // Everything reachable remotely must come from this node's slice of
+  // the shared segment.  If the memory layer ignored the fixed heap we
+  // registered, fail now rather than on the first remote access.
+  //
+  {
+    const char* heapStart = segBase + (size_t) chpl_nodeID * heapSize;
+    const char* p = (const char*) txLocks;
+    size_t size = chpl_numNodes * sizeof(txLocks[0]);
+    if (p < heapStart || p + size > heapStart + heapSize) {
+      chpl_error_explicit("comm=shm requires the heap to be in the shared "
+                          "segment; CHPL_MEM must support a fixed heap",
+                          0, NULL);
+    }
+  }
+
+  for (c_nodeid_t node = 0; node < chpl_numNodes; node++) {
+    chpl_mcs_lock_init(&txLocks[node], "comm-shm txLock");
+  }
+}
+
+
+//
+// No support for gdb for now
+//
+int chpl_comm_run_in_gdb(int argc, char* argv[], int gdbArgnum, int* status) {
+  return 0;
+}
+
+//
+// No support for lldb for now
+//
+int chpl_comm_run_in_lldb(int argc, char* argv[], int lldbArgnum, int* status) {
+  return 0;
+}
+
+
+static void amHandler(void*);
+
+void chpl_comm_post_task_init(void) {
+  if (chpl_numNodes == 1)
+    return;
+
+  atomic_init_bool(&amHandlerStop, false);
+  atomic_init_bool(&amHandlerDone, false);
+
+  if (chpl_task_createCommTask(amHandler, NULL) != 0) {
+    chpl_error_explicit("comm=shm cannot start the progress thread", 0, NULL);
+  }
+}
+
+
+void chpl_comm_rollcall(void) {
+  // Initialize diags
+  chpl_comm_diags_init();
+
+  chpl_msg(2, "executing on node %d of %d node(s): %s\n", chpl_nodeID,
+           chpl_numNodes, chpl_nodeName());
+}
+
+
+int32_t chpl_comm_getMaxThreads(void) {
+  return 0;
+}
+
+
+void chpl_comm_impl_regMemHeapInfo(void** start_p, size_t* size_p) {
+  *start_p = segBase + (size_t) chpl_nodeID * heapSize;
+  *size_p = heapSize;
+}
+
+
+int chpl_comm_addr_gettable(c_nodeid_t node, void* start, size_t len) {
+  return 0;
+}
+
+
+////////////////////////////////////////
+//
+// Interface: global and private variables
+//
+
+wide_ptr_t* chpl_comm_broadcast_global_vars_helper(void) {
+  //
+  // Gather the global variables' wide pointers on node 0 into a buffer
+  // in its heap, where the other nodes can fetch them.
+  //
+  if (chpl_nodeID == 0) {
+    wide_ptr_t* buf = chpl_mem_allocManyZero(chpl_numGlobalsOnHeap,
+                                             sizeof(buf[0]),
+                                             CHPL_RT_MD_COMM_PER_LOC_INFO,
+                                             0, 0);
+    for (int i = 0; i < chpl_numGlobalsOnHeap; i++) {
+      buf[i] = *chpl_globals_registry[i];
+    }
+    shmCtl->globalsBuf = buf;
+  }
+
+  chpl_comm_barrier("broadcast global vars helper");
+  return shmCtl->globalsBuf;
+}
+
+
+void chpl_comm_broadcast_private(int id, size_t size) {
+  //
+  // All the nodes are forks of the same program, so the broadcast
+  // table entries, which point at static data, are the same everywhere.
+  //
+  for (c_nodeid_t node = 0; node < chpl_numNodes; node++) {
+    if (node != chpl_nodeID) {
+      chpl_comm_put(chpl_rt_priv_bcast_tab[id], node,
+                    chpl_rt_priv_bcast_tab[id], size,
+                    CHPL_COMM_UNKNOWN_ID, 0, 0);
+    }
+  }
+}
+
+
+////////////////////////////////////////
+//
+// Interface: barrier
+//
+
+static void checkExitAny(void);
+
+void chpl_comm_barrier(const char *msg) {
+  if (chpl_numNodes == 1)
+    return;
+
+  barSense = !barSense;
+
+  if (atomic_fetch_add_uint_least32_t(&shmCtl->barCount, 1)
+      == (uint_least32_t) chpl_numNodes - 1) {
+    atomic_store_uint_least32_t(&shmCtl->barCount, 0);
+    atomic_store_bool(&shmCtl->barSense, barSense);
+  } else {
+    while (atomic_load_bool(&shmCtl->barSense) != barSense) {
+      checkExitAny();
+      sched_yield();
+    }
+  }
+}
+
+
+////////////////////////////////////////
+//
+// Interface: shutdown
+//
+
+static void amRequestShutdown(c_nodeid_t);
+static void fini_amHandling(void);
+
+void chpl_comm_pre_task_exit(int all) {
+  if (all && chpl_numNodes > 1) {
+    if (chpl_nodeID == 0) {
+      atomic_store_bool(&shmCtl->shuttingDown, true);
+      for (c_nodeid_t node = 1; node < chpl_numNodes; node++) {
+        amRequestShutdown(node);
+      }
+    } else {
+      chpl_wait_for_shutdown();
+    }
+
+    chpl_comm_barrier("chpl_comm_pre_task_exit");
+    fini_amHandling();
+  }
+}
+
+
+void chpl_comm_exit(int all, int status) {
+  if (chpl_numNodes == 1)
+    return;
+
+  if (all) {
+    //
+    // Node 0 is the process our launcher waits for, so it must be the
+    // last to go.
+    //
+    if (chpl_nodeID == 0) {
+      for (c_nodeid_t node = 1; node < chpl_numNodes; node++) {
+        while (waitpid(shmCtl->pids[node], NULL, 0) < 0 && errno == EINTR)
+          ;
+      }
+    }
+  } else if (chpl_nodeID == 0) {
+    fflush(NULL);
+    for (c_nodeid_t node = 1; node < chpl_numNodes; node++) {
+      (void) kill(shmCtl->pids[node], SIGKILL);
+    }
+  } else {
+    //
+    // Have node 0 take the program down with our status.
+    //
+    shmCtl->exitStatus = status;
+    atomic_store_bool(&shmCtl->exitAny, true);
+  }
+}
+
+
+//
+// On node 0, if another node is exiting alone, stop the others and
+// exit with its status.
+//
+static void checkExitAny(void) {
+  if (chpl_nodeID != 0 || !atomic_load_bool(&shmCtl->exitAny))
+    return;
+
+  fflush(NULL);
+  for (c_nodeid_t node = 1; node < chpl_numNodes; node++) {
+    (void) kill(shmCtl->pids[node], SIGKILL);
+  }
+  _exit(shmCtl->exitStatus);
+}
+
+
+//
+// On node 0, make sure the other nodes haven't died underneath us.
+//
+static void checkLiveness(void) {
+  if (chpl_nodeID != 0 || atomic_load_bool(&shmCtl->shuttingDown))
+    return;
+
+  for (c_nodeid_t node = 1; node < chpl_numNodes; node++) {
+    int status;
+    if (waitpid(shmCtl->pids[node], &status, WNOHANG) == shmCtl->pids[node]) {
+      // If it exited on purpose it will have told us its status.
+      if (!atomic_load_bool(&shmCtl->exitAny)) {
+        fprintf(stderr, "error: comm=shm: node %d terminated unexpectedly\n",
+                (int) node);
+        shmCtl->exitStatus = 1;
+        atomic_store_bool(&shmCtl->exitAny, true);
+      }
+      checkExitAny();
+    }
+  }
+}
+
+
+////////////////////////////////////////
+//
+// Active messages
+//
+
+typedef enum {
+  am_opExecOn = CHPL_ARG_BUNDLE_KIND_COMM, // on-stmt, bundle in request
+  am_opExecOnLrg,                          // on-stmt, bundle in initr heap
+  am_opGet,                                // GET outside the segment
+  am_opPut,                                // PUT outside the segment
+  am_opAMO,                                // AMO outside the segment
+  am_opAlloc,                              // allocate memory
+  am_opFree,                               // free memory
+  am_opShutdown,                           // signal main process for shutdown
+} amOp_t;
+
+typedef atomic_bool amDone_t;
+
+typedef union {
+  int32_t i32;
+  uint32_t u32;
+  int64_t i64;
+  uint64_t u64;
+  _real32 r32;
+  _real64 r64;
+} chpl_amo_datum_t;
+
+typedef enum {
+  amo_write,
+  amo_read,
+  amo_xchg,
+  amo_cmpxchg,
+  amo_and,
+  amo_or,
+  amo_xor,
+  amo_add,
+} amoOp_t;
+
+typedef enum {
+  amo_int32,
+  amo_int64,
+  amo_uint32,
+  amo_uint64,
+  amo_real32,
+  amo_real64,
+} amoType_t;
+
+//
+// Where a target puts its response, in the initiator's heap.  For GETs
+// and PUTs the data follows this.
+//
+struct amReply_t {
+  amDone_t done;
+  chpl_amo_datum_t result;
+};
+
+//
+// The 'op' member must come first in all requests, so the progress
+// thread can tell what kind of request it's looking at.
+//
+struct amRequest_base_t {
+  chpl_arg_bundle_kind_t op;    // operation
+  c_nodeid_t node;              // initiator's node
+  struct amReply_t* reply;      // initiator's reply buffer
+};
+
+struct amRequest_execOnLrg_t {
+  struct amRequest_base_t b;
+  chpl_comm_on_bundle_t* pBundle; // bundle copy in initiator's heap
+};
+
+struct amRequest_RMA_t {
+  struct amRequest_base_t b;
+  void* addr;                   // address on target node
+  size_t size;                  // number of bytes
+};
+
+struct amRequest_AMO_t {
+  struct amRequest_base_t b;
+  amoOp_t op;
+  amoType_t type;
+  void* obj;                    // object address on target node
+  chpl_amo_datum_t operand1;    // first operand, if needed
+  chpl_amo_datum_t operand2;    // second operand, if needed
+};
+
+struct amRequest_alloc_t {
+  struct amRequest_base_t b;
+  size_t size;                  // bytes per block
+  size_t n;                     // number of blocks; addresses go in reply
+};
+
+struct amRequest_free_t {
+  struct amRequest_base_t b;
+  void* p;                      // address to free, on target node
+};
+
+static inline void doCpuAMO(void*, const chpl_amo_datum_t*,
+                            const chpl_amo_datum_t*, chpl_amo_datum_t*,
+                            amoOp_t, amoType_t);
+
+
+static struct amReply_t* amReplyAlloc(size_t dataSize) {
+  struct amReply_t* reply =
+    chpl_mem_alloc(sizeof(*reply) + dataSize,
+                   CHPL_RT_MD_COMM_FRK_DONE_FLAG, 0, 0);
+  atomic_init_bool(&reply->done, false);
+  return reply;
+}
+
+
+static inline
+void* amReplyData(struct amReply_t* reply) {
+  return reply + 1;
+}
+
+
+static void amReplyFree(struct amReply_t* reply) {
+  chpl_mem_free(reply, 0, 0);
+}
+
+
+static inline
+void amSetDone(amDone_t* pDone) {
+  atomic_store_explicit_bool(pDone, true, memory_order_release);
+}
+
+
+static inline
+void amWaitForDone(amDone_t* pDone) {
+  while (!atomic_load_explicit_bool(pDone, memory_order_acquire)) {
+    chpl_task_yield();
+  }
+}
+
+
+//
+// Put a request into the ring to 'node'.
+//
+static void amSend(c_nodeid_t node, const void* req, size_t reqSize) {
+  struct amRing_t* ring = amRing(node, chpl_nodeID);
+  chpl_mcs_node_t  txNode;
+
+  assert(reqSize <= AM_SLOT_SIZE);
+
+  chpl_mcs_lock(&txLocks[node], &txNode);
+
+  uint_least64_t tail = atomic_load_explicit_uint_least64_t(&ring->tail,
+                                                          memory_order_relaxed);
+  while (tail - atomic_load_explicit_uint_least64_t(&ring->head,
+                                                    memory_order_acquire)
+         >= AM_RING_SLOTS) {
+    chpl_task_yield();
+  }
+
+  memcpy(ring->slots[tail & (AM_RING_SLOTS - 1)], req, reqSize);
+  atomic_store_explicit_uint_least64_t(&ring->tail, tail + 1,
+                                       memory_order_release);
+
+  chpl_mcs_unlock(&txLocks[node], &txNode);
+}
+
+
+static void amRequestExecOn(c_nodeid_t node, c_sublocid_t subloc,
+                            chpl_fn_int_t fid,
+                            chpl_comm_on_bundle_t* arg, size_t argSize,
+                            chpl_bool blocking) {
+  struct amReply_t* reply = blocking ? amReplyAlloc(0) : NULL;
+
+  arg->comm = (chpl_comm_bundleData_t) { .fid = fid,
+                                         .node = chpl_nodeID,
+                                         .subloc = subloc,
+                                         .argSize = argSize,
+                                         .pAmDone = (reply == NULL)
+                                                    ? NULL
+                                                    : &reply->done, };
+
+  if (argSize <= AM_SLOT_SIZE) {
+    arg->kind = am_opExecOn;
+    amSend(node, arg, argSize);
+  } else {
+    //
+    // The bundle is too large for a request slot.  Copy it into our
+    // heap and have the target start its task from there.  We can free
+    // the copy once the task has been started, since that copies it.
+    //
+    struct amReply_t* started = amReplyAlloc(argSize);
+    chpl_comm_on_bundle_t* bundle = amReplyData(started);
+
+    memcpy(bundle, arg, argSize);
+    bundle->kind = am_opExecOn;
+
+    struct amRequest_execOnLrg_t xol = { .b = { .op = am_opExecOnLrg,
+                                                .node = chpl_nodeID,
+                                                .reply = started, },
+                                         .pBundle = bundle, };
+    amSend(node, &xol, sizeof(xol));
+    amWaitForDone(&started->done);
+    amReplyFree(started);
+  }
+
+  if (blocking) {
+    amWaitForDone(&reply->done);
+    amReplyFree(reply);
+  }
+}
+
+
+static void amRequestRMA(c_nodeid_t node, amOp_t op,
+                         void* addr, void* raddr, size_t size) {
+  struct amReply_t* reply = amReplyAlloc(size);
+
+  if (op == am_opPut) {
+    memcpy(amReplyData(reply), addr, size);
+  }
+
+  struct amRequest_RMA_t rma = { .b = { .op = op,
+                                        .node = chpl_nodeID,
+                                        .reply = reply, },
+                                 .addr = raddr,
+                                 .size = size, };
+  amSend(node, &rma, sizeof(rma));
+  amWaitForDone(&reply->done);
+
+  if (op == am_opGet) {
+    memcpy(addr, amReplyData(reply), size);
+  }
+
+  amReplyFree(reply);
+}
+
+
+static void amRequestAMO(c_nodeid_t node, void* object,
+                         const void* operand1, const void* operand2,
+                         void* result, amoOp_t op, amoType_t type,
+                         size_t size) {
+  struct amReply_t* reply = amReplyAlloc(0);
+
+  struct amRequest_AMO_t amo = { .b = { .op = am_opAMO,
+                                        .node = chpl_nodeID,
+                                        .reply = reply, },
+                                 .op = op,
+                                 .type = type,
+                                 .obj = object, };
+  if (operand1 != NULL) {
+    memcpy(&amo.operand1, operand1, size);
+  }
+  if (operand2 != NULL) {
+    memcpy(&amo.operand2, operand2, size);
+  }
+
+  amSend(node, &amo, sizeof(amo));
+  amWaitForDone(&reply->done);
+
+  if (result != NULL) {
+    memcpy(result, &reply->result, size);
+  }
+
+  amReplyFree(reply);
+}
+
+
+static void amRequestAlloc(c_nodeid_t node, size_t size, size_t n,
+                           void** ptrs) {
+  struct amReply_t* reply = amReplyAlloc(n * sizeof(void*));
+
+  struct amRequest_alloc_t req = { .b = { .op = am_opAlloc,
+                                          .node = chpl_nodeID,
+                                          .reply = reply, },
+                                   .size = size,
+                                   .n = n, };
+  amSend(node, &req, sizeof(req));
+  amWaitForDone(&reply->done);
+
+  memcpy(ptrs, amReplyData(reply), n * sizeof(void*));
+  amReplyFree(reply);
+}
+
+
+static void amRequestFree(c_nodeid_t node, void* p) {
+  struct amRequest_free_t req = { .b = { .op = am_opFree,
+                                         .node = chpl_nodeID,
+                                         .reply = NULL, },
+                                  .p = p, };
+  amSend(node, &req, sizeof(req));
+}
+
+
+static void amRequestShutdown(c_nodeid_t node) {
+  struct amRequest_base_t req = { .op = am_opShutdown,
+                                  .node = chpl_nodeID,
+                                  .reply = NULL, };
+  amSend(node, &req, sizeof(req));
+}
+
+
+//
+// Progress thread
+//
+
+static void amWrapExecOnBody(void* p) {
+  chpl_comm_bundleData_t* comm = &((chpl_comm_on_bundle_t*) p)->comm;
+
+  chpl_ftable_call(comm->fid, p);
+  amSetDone((amDone_t*) comm->pAmDone);
+}
+
+
+static void amHandleExecOn(chpl_comm_on_bundle_t* req) {
+  chpl_comm_bundleData_t* comm = &req->comm;
+
+  //
+  // We only need a wrapper if we have to tell the initiator when the
+  // body is done.  In either case the task gets its own copy of the
+  // bundle.
+  //
+  chpl_fn_p fn = (comm->pAmDone == NULL)
+                 ? chpl_ftable[comm->fid]
+                 : amWrapExecOnBody;
+  chpl_task_startMovedTask(comm->fid, fn, req,
+                           comm->argSize, comm->subloc, chpl_nullTaskID);
+}
+
+
+static void amHandleRequest(void* p) {
+  struct amRequest_base_t* b = (struct amRequest_base_t*) p;
+
+  switch (b->op) {
+  case am_opExecOn:
+    amHandleExecOn((chpl_comm_on_bundle_t*) p);
+    break;
+
+  case am_opExecOnLrg:
+    {
+      struct amRequest_execOnLrg_t* xol = (struct amRequest_execOnLrg_t*) p;
+      amHandleExecOn(xol->pBundle);
+      amSetDone(&b->reply->done);
+    }
+    break;
+
+  case am_opGet:
+    {
+      struct amRequest_RMA_t* rma = (struct amRequest_RMA_t*) p;
+      memcpy(amReplyData(b->reply), rma->addr, rma->size);
+      amSetDone(&b->reply->done);
+    }
+    break;
+
+  case am_opPut:
+    {
+      struct amRequest_RMA_t* rma = (struct amRequest_RMA_t*) p;
+      memcpy(rma->addr, amReplyData(b->reply), rma->size);
+      amSetDone(&b->reply->done);
+    }
+    break;
+
+  case am_opAMO:
+    {
+      struct amRequest_AMO_t* amo = (struct amRequest_AMO_t*) p;
+      doCpuAMO(amo->obj, &amo->operand1, &amo->operand2, &b->reply->result,
+               amo->op, amo->type);
+      amSetDone(&b->reply->done);
+    }
+    break;
+
+  case am_opAlloc:
+    {
+      struct amRequest_alloc_t* al = (struct amRequest_alloc_t*) p;
+      void** ptrs = amReplyData(b->reply);
+      for (size_t i = 0; i < al->n; i++) {
+        ptrs[i] = chpl_mem_alloc(al->size, CHPL_RT_MD_REMOTE_ALLOC, 0, 0);
+      }
+      amSetDone(&b->reply->done);
+    }
+    break;
+
+  case am_opFree:
+    chpl_mem_free(((struct amRequest_free_t*) p)->p, 0, 0);
+    break;
+
+  case am_opShutdown:
+    chpl_signal_shutdown();
+    break;
+
+  default:
+    chpl_internal_error("comm=shm: unexpected AM request");
+  }
+}
+
+
+//
+// Handle whatever is in the rings to us.  Returns the number of
+// requests handled.
+//
+static int amPoll(void) {
+  int numHandled = 0;
+
+  for (c_nodeid_t node = 0; node < chpl_numNodes; node++) {
+    struct amRing_t* ring = amRing(chpl_nodeID, node);
+    uint_least64_t head =
+      atomic_load_explicit_uint_least64_t(&ring->head, memory_order_relaxed);
+    uint_least64_t tail =
+      atomic_load_explicit_uint_least64_t(&ring->tail, memory_order_acquire);
+
+    for ( ; head != tail; head++, numHandled++) {
+      amHandleRequest(ring->slots[head & (AM_RING_SLOTS - 1)]);
+      atomic_store_explicit_uint_least64_t(&ring->head, head + 1,
+                                           memory_order_release);
+    }
+  }
+
+  return numHandled;
+}
+
+
+static void amHandler(void* argNil) {
+  const struct timespec nap = { .tv_sec = 0, .tv_nsec = 1000 };
+  int idle = 0;
+
+  while (!atomic_load_bool(&amHandlerStop)) {
+    if (amPoll() > 0) {
+      idle = 0;
+      continue;
+    }
+
+    //
+    // Back off gradually when there is nothing to do, so that idle
+    // nodes don't compete for cores with busy ones.
+    //
+    idle++;
+    if ((idle & 1023) == 0) {
+      checkExitAny();
+      checkLiveness();
+    }
+
+    if (idle >= 4096) {
+      nanosleep(&nap, NULL);
+    } else if (idle >= 64) {
+      sched_yield();
+    }
+  }
+
+  atomic_store_bool(&amHandlerDone, true);
+}
+
+
+static void fini_amHandling(void) {
+  atomic_store_bool(&amHandlerStop, true);
+  while (!atomic_load_bool(&amHandlerDone)) {
+    sched_yield();
+  }
+}
+
+
+////////////////////////////////////////
+//
+// Interface: executeOn
+//
+
+void chpl_comm_impl_remote_alloc(c_nodeid_t node, size_t size, size_t n,
+                                 void** ptrs) {
+  amRequestAlloc(node, size, n, ptrs);
+}
+
+
+void chpl_comm_impl_remote_free(c_nodeid_t node, void* p) {
+  amRequestFree(node, p);
+}
+
+
+void chpl_comm_execute_on(c_nodeid_t node, c_sublocid_t subloc,
+                          chpl_fn_int_t fid,
+                          chpl_comm_on_bundle_t *arg, size_t argSize,
+                          int ln, int32_t fn) {
+  assert(node != chpl_nodeID); // handled by the locale model
+
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn)) {
+    chpl_comm_cb_info_t cb_data =
+      {chpl_comm_cb_event_kind_executeOn, chpl_nodeID, node,
+       .iu.executeOn={subloc, fid, arg, argSize, ln, fn}};
+    chpl_comm_do_callbacks (&cb_data);
+  }
+
+  chpl_comm_diags_verbose_executeOn("", node, ln, fn);
+  chpl_comm_diags_incr(execute_on);
+
+  amRequestExecOn(node, subloc, fid, arg, argSize, true);
+}
+
+
+void chpl_comm_execute_on_nb(c_nodeid_t node, c_sublocid_t subloc,
+                             chpl_fn_int_t fid,
+                             chpl_comm_on_bundle_t *arg, size_t argSize,
+                             int ln, int32_t fn) {
+  assert(node != chpl_nodeID); // handled by the locale model
+
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn_nb)) {
+    chpl_comm_cb_info_t cb_data =
+      {chpl_comm_cb_event_kind_executeOn_nb, chpl_nodeID, node,
+       .iu.executeOn={subloc, fid, arg, argSize, ln, fn}};
+    chpl_comm_do_callbacks (&cb_data);
+  }
+
+  chpl_comm_diags_verbose_executeOn("non-blocking", node, ln, fn);
+  chpl_comm_diags_incr(execute_on_nb);
+
+  amRequestExecOn(node, subloc, fid, arg, argSize, false);
+}
+
+
+//
+// The body always runs in a task, since the progress thread must not
+// block.  So this is the same as chpl_comm_execute_on().
+//
+void chpl_comm_execute_on_fast(c_nodeid_t node, c_sublocid_t subloc,
+                               chpl_fn_int_t fid,
+                               chpl_comm_on_bundle_t *arg, size_t argSize,
+                               int ln, int32_t fn) {
+  assert(node != chpl_nodeID); // handled by the locale model
+
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_executeOn_fast)) {
+    chpl_comm_cb_info_t cb_data =
+      {chpl_comm_cb_event_kind_executeOn_fast, chpl_nodeID, node,
+       .iu.executeOn={subloc, fid, arg, argSize, ln, fn}};
+    chpl_comm_do_callbacks (&cb_data);
+  }
+
+  chpl_comm_diags_verbose_executeOn("fast", node, ln, fn);
+  chpl_comm_diags_incr(execute_on_fast);
+
+  amRequestExecOn(node, subloc, fid, arg, argSize, true);
+}
+
+
+////////////////////////////////////////
+//
+// Interface: RMA
+//
+
+static inline
+void shm_put(void* addr, c_nodeid_t node, void* raddr, size_t size) {
+  if (node == chpl_nodeID || inSegment(raddr, size)) {
+    memmove(raddr, addr, size);
+  } else {
+    amRequestRMA(node, am_opPut, addr, raddr, size);
+  }
+}
+
+
+static inline
+void shm_get(void* addr, c_nodeid_t node, void* raddr, size_t size) {
+  if (node == chpl_nodeID || inSegment(raddr, size)) {
+    memmove(addr, raddr, size);
+  } else {
+    amRequestRMA(node, am_opGet, addr, raddr, size);
+  }
+}
+
+
+void chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
+                   size_t size, int32_t commID, int ln, int32_t fn) {
+  assert(addr != NULL);
+  assert(raddr != NULL);
+
+  if (size == 0) {
+    return;
+  }
+
+  if (node == chpl_nodeID) {
+    memmove(raddr, addr, size);
+    return;
+  }
+
+  // Communications callback support
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put)) {
+      chpl_comm_cb_info_t cb_data =
+        {chpl_comm_cb_event_kind_put, chpl_nodeID, node,
+         .iu.comm={addr, raddr, size, commID, ln, fn}};
+      chpl_comm_do_callbacks (&cb_data);
+  }
+
+  chpl_comm_diags_verbose_rdma("put", node, size, ln, fn, commID);
+  chpl_comm_diags_xfer(put, size);
+
+  shm_put(addr, node, raddr, size);
+}
+
+
+void chpl_comm_get(void* addr, c_nodeid_t node, void* raddr,
+                   size_t size, int32_t commID, int ln, int32_t fn) {
+  assert(addr != NULL);
+  assert(raddr != NULL);
+
+  if (size == 0) {
+    return;
+  }
+
+  if (node == chpl_nodeID) {
+    memmove(addr, raddr, size);
+    return;
+  }
+
+  // Communications callback support
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get)) {
+      chpl_comm_cb_info_t cb_data =
+        {chpl_comm_cb_event_kind_get, chpl_nodeID, node,
+         .iu.comm={addr, raddr, size, commID, ln, fn}};
+      chpl_comm_do_callbacks (&cb_data);
+  }
+
+  chpl_comm_diags_verbose_rdma("get", node, size, ln, fn, commID);
+  chpl_comm_diags_xfer(get, size);
+
+  shm_get(addr, node, raddr, size);
+}
+
+
+//
+// Transfers are complete when they return, so the nonblocking forms
+// are the same as the blocking ones, with NULL handles.
+//
+chpl_comm_nb_handle_t chpl_comm_put_nb(void* addr, c_nodeid_t node,
+                                       void* raddr, size_t size,
+                                       int32_t commID, int ln, int32_t fn) {
+  chpl_comm_put(addr, node, raddr, size, commID, ln, fn);
+  return NULL;
+}
+
+
+chpl_comm_nb_handle_t chpl_comm_put_nb_v(int v_len, void** addr_v,
+                                         c_nodeid_t node, void** raddr_v,
+                                         size_t* size_v, int32_t commID,
+                                         int ln, int32_t fn) {
+  for (int vi = 0; vi < v_len; vi++) {
+    chpl_comm_put(addr_v[vi], node, raddr_v[vi], size_v[vi], commID, ln, fn);
+  }
+  return NULL;
+}
+
+
+chpl_comm_nb_handle_t chpl_comm_get_nb(void* addr, c_nodeid_t node,
+                                       void* raddr, size_t size,
+                                       int32_t commID, int ln, int32_t fn) {
+  chpl_comm_get(addr, node, raddr, size, commID, ln, fn);
+  return NULL;
+}
+
+
+int chpl_comm_test_nb_complete(chpl_comm_nb_handle_t h) {
+  chpl_comm_diags_incr(test_nb);
+  return ((void*) h) == NULL;
+}
+
+
+void chpl_comm_wait_nb_some(chpl_comm_nb_handle_t* h, size_t nhandles) {
+  chpl_comm_diags_incr(wait_nb);
+  for (size_t i = 0; i < nhandles; i++) {
+    assert(h[i] == NULL);
+  }
+}
+
+
+int chpl_comm_try_nb_some(chpl_comm_nb_handle_t* h, size_t nhandles) {
+  chpl_comm_diags_incr(try_nb);
+  for (size_t i = 0; i < nhandles; i++) {
+    assert(h[i] == NULL);
+  }
+  return 0;
+}
+
+
+void chpl_comm_put_strd(void* dstaddr_arg, size_t* dststrides,
+                        c_nodeid_t dstnode,
+                        void* srcaddr_arg, size_t* srcstrides,
+                        size_t* count, int32_t stridelevels, size_t elemSize,
+                        int32_t commID, int ln, int32_t fn) {
+  put_strd_common(dstaddr_arg, dststrides,
+                  dstnode,
+                  srcaddr_arg, srcstrides,
+                  count, stridelevels, elemSize,
+                  1, NULL, // "nb" xfers block, so no need for yield
+                  commID, ln, fn);
+}
+
+
+void chpl_comm_get_strd(void* dstaddr_arg, size_t* dststrides,
+                        c_nodeid_t srcnode,
+                        void* srcaddr_arg, size_t* srcstrides, size_t* count,
+                        int32_t stridelevels, size_t elemSize,
+                        int32_t commID, int ln, int32_t fn) {
+  get_strd_common(dstaddr_arg, dststrides,
+                  srcnode,
+                  srcaddr_arg, srcstrides,
+                  count, stridelevels, elemSize,
+                  1, NULL, // "nb" xfers block, so no need for yield
+                  commID, ln, fn);
+}
+
+
+void chpl_comm_getput_unordered(c_nodeid_t dstnode, void* dstaddr,
+                                c_nodeid_t srcnode, void* srcaddr,
+                                size_t size, int32_t commID,
+                                int ln, int32_t fn) {
+  assert(dstaddr != NULL);
+  assert(srcaddr != NULL);
+
+  if (size == 0)
+    return;
+
+  if (dstnode == chpl_nodeID) {
+    chpl_comm_get(dstaddr, srcnode, srcaddr, size, commID, ln, fn);
+  } else if (srcnode == chpl_nodeID) {
+    chpl_comm_put(srcaddr, dstnode, dstaddr, size, commID, ln, fn);
+  } else if (inSegment(dstaddr, size) && inSegment(srcaddr, size)) {
+    memmove(dstaddr, srcaddr, size);
+  } else {
+    char* buf = chpl_mem_alloc(size, CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+    chpl_comm_get(buf, srcnode, srcaddr, size, commID, ln, fn);
+    chpl_comm_put(buf, dstnode, dstaddr, size, commID, ln, fn);
+    chpl_mem_free(buf, 0, 0);
+  }
+}
+
+
+void chpl_comm_get_unordered(void* addr, c_nodeid_t node, void* raddr,
+                             size_t size, int32_t commID, int ln, int32_t fn) {
+  chpl_comm_get(addr, node, raddr, size, commID, ln, fn);
+}
+
+
+void chpl_comm_put_unordered(void* addr, c_nodeid_t node, void* raddr,
+                             size_t size, int32_t commID, int ln, int32_t fn) {
+  chpl_comm_put(addr, node, raddr, size, commID, ln, fn);
+}
+
+
+void chpl_comm_getput_unordered_task_fence(void) { }
+
+
+////////////////////////////////////////
+//
+// Interface: network atomics
+//
+
+static inline
+void doAMO(c_nodeid_t node, void* object,
+           const void* operand1, const void* operand2, void* result,
+           amoOp_t op, amoType_t type, size_t size) {
+  if (node == chpl_nodeID || inSegment(object, size)) {
+    chpl_amo_datum_t myOpnd1 = { 0 };
+    chpl_amo_datum_t myOpnd2 = { 0 };
+    chpl_amo_datum_t myResult;
+    if (operand1 != NULL) {
+      memcpy(&myOpnd1, operand1, size);
+    }
+    if (operand2 != NULL) {
+      memcpy(&myOpnd2, operand2, size);
+    }
+    doCpuAMO(object, &myOpnd1, &myOpnd2, &myResult, op, type);
+    if (result != NULL) {
+      memcpy(result, &myResult, size);
+    }
+  } else {
+    amRequestAMO(node, object, operand1, operand2, result, op, type, size);
+  }
+}
+
+
+#define DEFN_CHPL_COMM_ATOMIC_WRITE(fnType, amoType, Type)              \
+  void chpl_comm_atomic_write_##fnType                                  \
+         (void* desired, c_nodeid_t node, void* object,                 \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo write", node, ln, fn);             \
+    chpl_comm_diags_incr(amo);                                          \
+    doAMO(node, object, desired, NULL, NULL,                            \
+          amo_write, amoType, sizeof(Type));                            \
+  }
+
+DEFN_CHPL_COMM_ATOMIC_WRITE(int32, amo_int32, int32_t)
+DEFN_CHPL_COMM_ATOMIC_WRITE(int64, amo_int64, int64_t)
+DEFN_CHPL_COMM_ATOMIC_WRITE(uint32, amo_uint32, uint32_t)
+DEFN_CHPL_COMM_ATOMIC_WRITE(uint64, amo_uint64, uint64_t)
+DEFN_CHPL_COMM_ATOMIC_WRITE(real32, amo_real32, _real32)
+DEFN_CHPL_COMM_ATOMIC_WRITE(real64, amo_real64, _real64)
+
+
+#define DEFN_CHPL_COMM_ATOMIC_READ(fnType, amoType, Type)               \
+  void chpl_comm_atomic_read_##fnType                                   \
+         (void* result, c_nodeid_t node, void* object,                  \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo read", node, ln, fn);              \
+    chpl_comm_diags_incr(amo);                                          \
+    doAMO(node, object, NULL, NULL, result,                             \
+          amo_read, amoType, sizeof(Type));                             \
+  }
+
+DEFN_CHPL_COMM_ATOMIC_READ(int32, amo_int32, int32_t)
+DEFN_CHPL_COMM_ATOMIC_READ(int64, amo_int64, int64_t)
+DEFN_CHPL_COMM_ATOMIC_READ(uint32, amo_uint32, uint32_t)
+DEFN_CHPL_COMM_ATOMIC_READ(uint64, amo_uint64, uint64_t)
+DEFN_CHPL_COMM_ATOMIC_READ(real32, amo_real32, _real32)
+DEFN_CHPL_COMM_ATOMIC_READ(real64, amo_real64, _real64)
+
+
+#define DEFN_CHPL_COMM_ATOMIC_XCHG(fnType, amoType, Type)               \
+  void chpl_comm_atomic_xchg_##fnType                                   \
+         (void* desired, c_nodeid_t node, void* object, void* result,   \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo xchg", node, ln, fn);              \
+    chpl_comm_diags_incr(amo);                                          \
+    doAMO(node, object, desired, NULL, result,                          \
+          amo_xchg, amoType, sizeof(Type));                             \
+  }
+
+DEFN_CHPL_COMM_ATOMIC_XCHG(int32, amo_int32, int32_t)
+DEFN_CHPL_COMM_ATOMIC_XCHG(int64, amo_int64, int64_t)
+DEFN_CHPL_COMM_ATOMIC_XCHG(uint32, amo_uint32, uint32_t)
+DEFN_CHPL_COMM_ATOMIC_XCHG(uint64, amo_uint64, uint64_t)
+DEFN_CHPL_COMM_ATOMIC_XCHG(real32, amo_real32, _real32)
+DEFN_CHPL_COMM_ATOMIC_XCHG(real64, amo_real64, _real64)
+
+
+#define DEFN_CHPL_COMM_ATOMIC_CMPXCHG(fnType, amoType, Type)            \
+  void chpl_comm_atomic_cmpxchg_##fnType                                \
+         (void* expected, void* desired, c_nodeid_t node, void* object, \
+          chpl_bool32* result, memory_order succ, memory_order fail,    \
+          int ln, int32_t fn) {                                         \
+    chpl_comm_diags_verbose_amo("amo cmpxchg", node, ln, fn);           \
+    chpl_comm_diags_incr(amo);                                          \
+    Type old_value;                                                     \
+    Type old_expected;                                                  \
+    memcpy(&old_expected, expected, sizeof(Type));                      \
+    doAMO(node, object, &old_expected, desired, &old_value,             \
+          amo_cmpxchg, amoType, sizeof(Type));                          \
+    *result = (chpl_bool32)(memcmp(&old_value, &old_expected,           \
+                                   sizeof(Type)) == 0);                 \
+    if (!*result) memcpy(expected, &old_value, sizeof(Type));           \
+  }
+
+DEFN_CHPL_COMM_ATOMIC_CMPXCHG(int32, amo_int32, int32_t)
+DEFN_CHPL_COMM_ATOMIC_CMPXCHG(int64, amo_int64, int64_t)
+DEFN_CHPL_COMM_ATOMIC_CMPXCHG(uint32, amo_uint32, uint32_t)
+DEFN_CHPL_COMM_ATOMIC_CMPXCHG(uint64, amo_uint64, uint64_t)
+DEFN_CHPL_COMM_ATOMIC_CMPXCHG(real32, amo_real32, _real32)
+DEFN_CHPL_COMM_ATOMIC_CMPXCHG(real64, amo_real64, _real64)
+
+
+#define DEFN_IFACE_AMO_SIMPLE_OP(fnOp, amoOp, fnType, amoType, Type)    \
+  void chpl_comm_atomic_##fnOp##_##fnType                               \
+         (void* operand, c_nodeid_t node, void* object,                 \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo " #fnOp, node, ln, fn);            \
+    chpl_comm_diags_incr(amo);                                          \
+    doAMO(node, object, operand, NULL, NULL,                            \
+          amoOp, amoType, sizeof(Type));                                \
+  }                                                                     \
+                                                                        \
+  void chpl_comm_atomic_##fnOp##_unordered_##fnType                     \
+         (void* operand, c_nodeid_t node, void* object,                 \
+          int ln, int32_t fn) {                                         \
+    chpl_comm_diags_verbose_amo("amo unord_" #fnOp, node, ln, fn);      \
+    chpl_comm_diags_incr(amo);                                          \
+    doAMO(node, object, operand, NULL, NULL,                            \
+          amoOp, amoType, sizeof(Type));                                \
+  }                                                                     \
+                                                                        \
+  void chpl_comm_atomic_fetch_##fnOp##_##fnType                         \
+         (void* operand, c_nodeid_t node, void* object, void* result,   \
+          memory_order order, int ln, int32_t fn) {                     \
+    chpl_comm_diags_verbose_amo("amo fetch_" #fnOp, node, ln, fn);      \
+    chpl_comm_diags_incr(amo);                                          \
+    doAMO(node, object, operand, NULL, result,                          \
+          amoOp, amoType, sizeof(Type));                                \
+  }
+
+DEFN_IFACE_AMO_SIMPLE_OP(and, amo_and, int32, amo_int32, int32_t)
+DEFN_IFACE_AMO_SIMPLE_OP(and, amo_and, int64, amo_int64, int64_t)
+DEFN_IFACE_AMO_SIMPLE_OP(and, amo_and, uint32, amo_uint32, uint32_t)
+DEFN_IFACE_AMO_SIMPLE_OP(and, amo_and, uint64, amo_uint64, uint64_t)
+
+DEFN_IFACE_AMO_SIMPLE_OP(or, amo_or, int32, amo_int32, int32_t)
+DEFN_IFACE_AMO_SIMPLE_OP(or, amo_or, int64, amo_int64, int64_t)
+DEFN_IFACE_AMO_SIMPLE_OP(or, amo_or, uint32, amo_uint32, uint32_t)
+DEFN_IFACE_AMO_SIMPLE_OP(or, amo_or, uint64, amo_uint64, uint64_t)
+
+DEFN_IFACE_AMO_SIMPLE_OP(xor, amo_xor, int32, amo_int32, int32_t)
+DEFN_IFACE_AMO_SIMPLE_OP(xor, amo_xor, int64, amo_int64, int64_t)
+DEFN_IFACE_AMO_SIMPLE_OP(xor, amo_xor, uint32, amo_uint32, uint32_t)
+DEFN_IFACE_AMO_SIMPLE_OP(xor, amo_xor, uint64, amo_uint64, uint64_t)
+
+DEFN_IFACE_AMO_SIMPLE_OP(add, amo_add, int32, amo_int32, int32_t)
+DEFN_IFACE_AMO_SIMPLE_OP(add, amo_add, int64, amo_int64, int64_t)
+DEFN_IFACE_AMO_SIMPLE_OP(add, amo_add, uint32, amo_uint32, uint32_t)
+DEFN_IFACE_AMO_SIMPLE_OP(add, amo_add, uint64, amo_uint64, uint64_t)
+DEFN_IFACE_AMO_SIMPLE_OP(add, amo_add, real32, amo_real32, _real32)
+DEFN_IFACE_AMO_SIMPLE_OP(add, amo_add, real64, amo_real64, _real64)
+
+
+#define DEFN_IFACE_AMO_SUB(fnType, amoType, Type, negate)               \
+  void chpl_comm_atomic_sub_##fnType                                    \
+         (void* operand, c_nodeid_t node, void* object,                 \
+          memory_order order, int ln, int32_t fn) {                     \
+    Type myOpnd = negate(*(Type*) operand);                             \
+    chpl_comm_diags_verbose_amo("amo sub", node, ln, fn);               \
+    chpl_comm_diags_incr(amo);                                          \
+    doAMO(node, object, &myOpnd, NULL, NULL,                            \
+          amo_add, amoType, sizeof(Type));                              \
+  }                                                                     \
+                                                                        \
+  void chpl_comm_atomic_sub_unordered_##fnType                          \
+         (void* operand, c_nodeid_t node, void* object,                 \
+          int ln, int32_t fn) {                                         \
+    Type myOpnd = negate(*(Type*) operand);                             \
+    chpl_comm_diags_verbose_amo("amo unord_sub", node, ln, fn);         \
+    chpl_comm_diags_incr(amo);                                          \
+    doAMO(node, object, &myOpnd, NULL, NULL,                            \
+          amo_add, amoType, sizeof(Type));                              \
+  }                                                                     \
+                                                                        \
+  void chpl_comm_atomic_fetch_sub_##fnType                              \
+         (void* operand, c_nodeid_t node, void* object, void* result,   \
+          memory_order order, int ln, int32_t fn) {                     \
+    Type myOpnd = negate(*(Type*) operand);                             \
+    chpl_comm_diags_verbose_amo("amo fetch_sub", node, ln, fn);         \
+    chpl_comm_diags_incr(amo);                                          \
+    doAMO(node, object, &myOpnd, NULL, result,                          \
+          amo_add, amoType, sizeof(Type));                              \
+  }
+
+#define NEGATE_I32(x) ((x) == INT32_MIN ? (x) : -(x))
+#define NEGATE_I64(x) ((x) == INT64_MIN ? (x) : -(x))
+#define NEGATE_U_OR_R(x) (-(x))
+
+DEFN_IFACE_AMO_SUB(int32, amo_int32, int32_t, NEGATE_I32)
+DEFN_IFACE_AMO_SUB(int64, amo_int64, int64_t, NEGATE_I64)
+DEFN_IFACE_AMO_SUB(uint32, amo_uint32, uint32_t, NEGATE_U_OR_R)
+DEFN_IFACE_AMO_SUB(uint64, amo_uint64, uint64_t, NEGATE_U_OR_R)
+DEFN_IFACE_AMO_SUB(real32, amo_real32, _real32, NEGATE_U_OR_R)
+DEFN_IFACE_AMO_SUB(real64, amo_real64, _real64, NEGATE_U_OR_R)
+
+void chpl_comm_atomic_unordered_task_fence(void) { }
+
+
+//
+// Do an AMO on 'obj' with the processor's atomics.  This works across
+// locales because they are all processes on the same node.
+//
+static inline
+void doCpuAMO(void* obj,
+              const chpl_amo_datum_t* opnd1, const chpl_amo_datum_t* opnd2,
+              chpl_amo_datum_t* result,
+              amoOp_t op, amoType_t type) {
+
+#define CPU_COMMON_AMO(_t, _m)                                          \
+  case amo_write:                                                       \
+    atomic_store_##_t((atomic_##_t*) obj, opnd1->_m);                   \
+    break;                                                              \
+  case amo_read:                                                        \
+    result->_m = atomic_load_##_t((atomic_##_t*) obj);                  \
+    break;                                                              \
+  case amo_xchg:                                                        \
+    result->_m = atomic_exchange_##_t((atomic_##_t*) obj, opnd1->_m);   \
+    break;                                                              \
+  case amo_cmpxchg:                                                     \
+    {                                                                   \
+      _t expected = opnd1->_m;                                          \
+      (void) atomic_compare_exchange_strong_##_t((atomic_##_t*) obj,    \
+                                                 &expected, opnd2->_m); \
+      result->_m = expected;                                            \
+    }                                                                   \
+    break;                                                              \
+  case amo_add:                                                         \
+    result->_m = atomic_fetch_add_##_t((atomic_##_t*) obj, opnd1->_m);  \
+    break;
+
+#define CPU_INT_AMO(_t, _m)                                             \
+  do {                                                                  \
+    switch (op) {                                                       \
+    CPU_COMMON_AMO(_t, _m)                                              \
+    case amo_and:                                                       \
+      result->_m = atomic_fetch_and_##_t((atomic_##_t*) obj, opnd1->_m);\
+      break;                                                            \
+    case amo_or:                                                        \
+      result->_m = atomic_fetch_or_##_t((atomic_##_t*) obj, opnd1->_m); \
+      break;                                                            \
+    case amo_xor:                                                       \
+      result->_m = atomic_fetch_xor_##_t((atomic_##_t*) obj, opnd1->_m);\
+      break;                                                            \
+    }                                                                   \
+  } while (0)
+
+#define CPU_REAL_AMO(_t, _m)                                            \
+  do {                                                                  \
+    switch (op) {                                                       \
+    CPU_COMMON_AMO(_t, _m)                                              \
+    default:                                                            \
+      chpl_internal_error("comm=shm: unsupported real AMO");            \
+    }                                                                   \
+  } while (0)
+
+  switch (type) {
+  case amo_int32:  CPU_INT_AMO(int_least32_t, i32);  break;
+  case amo_int64:  CPU_INT_AMO(int_least64_t, i64);  break;
+  case amo_uint32: CPU_INT_AMO(uint_least32_t, u32); break;
+  case amo_uint64: CPU_INT_AMO(uint_least64_t, u64); break;
+  case amo_real32: CPU_REAL_AMO(_real32, r32);       break;
+  case amo_real64: CPU_REAL_AMO(_real64, r64);       break;
+  }
+
+#undef CPU_COMMON_AMO
+#undef CPU_INT_AMO
+#undef CPU_REAL_AMO
+}
@@ -37,6 +37,7 @@
 #include <sys/resource.h>
 #include <sys/sysinfo.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <gni_pub.h>    // <stddef.h> and <stdint.h> must come first
@@ -71,6 +72,7 @@
 #include "chpl-atomics.h"
 #include "chplcast.h"
 #include "chpl-linefile-support.h"
+#include "chpl-locks.h"
 #include "comm-ugni-heap-pages.h"
 #include "comm-ugni-mem.h"
 #include "config.h"
@@ -245,9 +247,11 @@ static uint64_t debug_stats_flag = 0;
         MACRO(fork_call_fast_cnt)                                       \
         MACRO(fork_call_small_cnt)                                      \
         MACRO(fork_call_large_cnt)                                      \
+        MACRO(fork_call_batch_cnt)                                      \
         MACRO(fork_put_cnt)                                             \
         MACRO(fork_get_cnt)                                             \
         MACRO(fork_free_cnt)                                            \
+        MACRO(fork_alloc_cnt)                                           \
         MACRO(fork_amo_cnt)                                             \
         MACRO(regMemAlloc_cnt)                                          \
         MACRO(regMemPostAlloc_cnt)                                      \
@@ -255,6 +259,7 @@ static uint64_t debug_stats_flag = 0;
         MACRO(regMemPostRealloc_cnt)                                    \
         MACRO(regMemFree_cnt)                                           \
         MACRO(regMem_bCast_cnt)                                         \
+        MACRO(regMem_pull_cnt)                                          \
         MACRO(regMem_locks)                                             \
         MACRO(regMem_lock_nsecs)                                        \
         MACRO(regMem_critsec_nsecs)                                     \
@@ -559,6 +564,7 @@ typedef struct {
 
 typedef struct {
   uint32_t     mreg_cnt;  // really hi idx + 1 (mregs[] may have holes)
+  uint32_t     mreg_vers; // bumped when entries are added, for lazy pulls
   mem_region_t mregs[];
 } mem_region_table_t;
 
@@ -574,6 +580,15 @@ static mem_region_table_t** mem_regions_all_entries;
 
 static mem_region_table_t** mem_regions_all_my_entry_map;
 
+//
+// If this is set then newly registered regions are not broadcast.
+// Instead we just update our own public copy and bump its version,
+// and other nodes pull our public copy when a lookup for one of our
+// addresses misses.  Deregistrations are still broadcast, because a
+// stale entry would let a remote node target memory we've given back.
+//
+static chpl_bool mreg_lazy_pull;
+
 static chpl_bool can_register_memory = false;
 
 //
@@ -637,6 +652,7 @@ struct mregs_supp {
   chpl_mem_descInt_t desc;
   int ln;
   int32_t fn;
+  chpl_bool external;  // from chpl_comm_impl_regMemRegister()
 };
 
 struct mregs_supp* mr_mregs_supplement;  // parallels mem_regions->mregs[]
@@ -734,6 +750,12 @@ typedef atomic_uint_least32_t cq_cnt_atomic_t;
 // effectiveness of that depends on which atomic layer is used (cstdlib
 // is the only one with cheap atomic reads.)
 
+typedef struct {
+  atomic_uint_least64_t cnt;
+  atomic_uint_least64_t nsecs;
+  atomic_uint_least64_t hist[CHPL_COMM_UGNI_LAT_HIST_BINS];
+} cd_lat_stats_t;
+
 typedef struct {
   atomic_spinlock_t  busy CACHE_LINE_ALIGN;
   cq_cnt_atomic_t    cq_cnt_curr CACHE_LINE_ALIGN;
@@ -749,6 +771,9 @@ typedef struct {
   uint64_t           acqs_with_rb_looks;
   uint64_t           reacqs;
 #endif
+  atomic_uint_least64_t acq_cnt CACHE_LINE_ALIGN;
+  atomic_uint_least64_t acq_wait_nsecs;
+  cd_lat_stats_t     lat[chpl_comm_ugni_op_count];
 } CACHE_LINE_ALIGN comm_dom_t;
 
 
@@ -769,6 +794,69 @@ static __thread int cd_idx = -1;
 #define ACQUIRE_CD_MAYBE(cd)  atomic_try_lock_spinlock_t(&(cd)->busy)
 #define RELEASE_CD(cd)        atomic_unlock_spinlock_t(&(cd)->busy)
 
+//
+// Per-comm-domain statistics.  See chpl-comm-impl.h.  The post time
+// is taken after the comm domain has been acquired, so that latencies
+// don't include acquisition waits.
+//
+static chpl_bool cd_stats_env;
+static __thread uint64_t cd_stats_post_ts;
+
+static inline
+chpl_bool cd_stats_on(void) {
+  return cd_stats_env
+         || (chpl_comm_diagnostics && chpl_comm_diags_is_enabled());
+}
+
+static inline
+uint64_t cd_stats_nsecs(void) {
+  struct timespec ts;
+  (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+}
+
+static inline
+void cd_stats_acq_done(comm_dom_t* acq_cd, uint64_t start_ts) {
+  uint64_t wait_ns = cd_stats_nsecs() - start_ts;
+  atomic_fetch_add_explicit_uint_least64_t(&acq_cd->acq_cnt, 1,
+                                           memory_order_relaxed);
+  atomic_fetch_add_explicit_uint_least64_t(&acq_cd->acq_wait_nsecs, wait_ns,
+                                           memory_order_relaxed);
+  chpl_comm_diags_incr(comm_dom_acquires);
+  chpl_comm_diags_add(comm_dom_wait_nsecs, wait_ns);
+}
+
+static inline
+void cd_stats_post_done(int cdi, chpl_comm_ugni_op_t op) {
+  cd_lat_stats_t* ls = &comm_doms[cdi].lat[op];
+  uint64_t lat_ns = cd_stats_nsecs() - cd_stats_post_ts;
+  int bin;
+
+  for (bin = 0;
+       bin < CHPL_COMM_UGNI_LAT_HIST_BINS - 1
+       && lat_ns >= ((uint64_t) 1 << (bin + CHPL_COMM_UGNI_LAT_HIST_SHIFT));
+       bin++)
+    ;
+
+  atomic_fetch_add_explicit_uint_least64_t(&ls->cnt, 1,
+                                           memory_order_relaxed);
+  atomic_fetch_add_explicit_uint_least64_t(&ls->nsecs, lat_ns,
+                                           memory_order_relaxed);
+  atomic_fetch_add_explicit_uint_least64_t(&ls->hist[bin], 1,
+                                           memory_order_relaxed);
+}
+
+static inline
+chpl_comm_ugni_op_t cd_stats_op(gni_post_type_t type) {
+  switch (type) {
+  case GNI_POST_FMA_PUT:  return chpl_comm_ugni_op_fma_put;
+  case GNI_POST_FMA_GET:  return chpl_comm_ugni_op_fma_get;
+  case GNI_POST_RDMA_PUT: return chpl_comm_ugni_op_rdma_put;
+  case GNI_POST_RDMA_GET: return chpl_comm_ugni_op_rdma_get;
+  default:                return chpl_comm_ugni_op_amo;
+  }
+}
+
 
 //
 // Declarations having to do with individual remote references.
@@ -943,10 +1031,12 @@ typedef enum {
   fork_op_free,
   fork_op_amo,
   fork_op_shutdown,
+  fork_op_batch,
+  fork_op_alloc,
   fork_op_num_ops
 } fork_op_t;
 
-#define FORK_OP_BITS 3
+#define FORK_OP_BITS 4
 
 typedef struct {
   chpl_arg_bundle_kind_t op;         // operation
@@ -986,6 +1076,13 @@ typedef struct {
   void*            p;                   // pointer to memory to be freed
 } fork_free_info_t;
 
+typedef struct {
+  fork_base_info_t b;
+  size_t           size;                // bytes per block
+  uint32_t         n;                   // number of blocks
+  void**           ptrs;                // where to PUT block addresses
+} fork_alloc_info_t;
+
 typedef enum {
   put_32,
   put_64,
@@ -1026,14 +1123,31 @@ typedef struct {
   fork_base_info_t b;
 } fork_shutdown_info_t;
 
+//
+// A batch holds several nonblocking small-call bundles bound for the
+// same node, packed back to back with each one starting on a
+// FORK_BATCH_ALIGN boundary.  See fork_call_coalesce().
+//
+#define FORK_BATCH_ALIGN 16
+
+typedef struct {
+  fork_base_info_t b;
+  uint32_t         cnt;                 // number of bundles in space[]
+  uint32_t         used;                // bytes of space[] in use
+  unsigned char    space[MAX_SMALL_CALL_PAYLOAD]
+                     __attribute__((aligned(FORK_BATCH_ALIGN)));
+} fork_batch_info_t;
+
 typedef union fork_t {
   fork_base_info_t b;
   fork_small_call_info_t sc;  // present only to set the max req size
   fork_large_call_info_t lc;
   fork_xfer_info_t x;
   fork_free_info_t f;
+  fork_alloc_info_t al;
   fork_amo_info_t  a;
   fork_shutdown_info_t s;
+  fork_batch_info_t bt;
 } fork_t;
 
 typedef struct {
@@ -1065,6 +1179,21 @@ static int _fork_req_bufs_per_cd = 2;
 static fork_t*  fork_reqs     = NULL;
 static fork_t** fork_reqs_map = NULL;
 
+//
+// Sender-side fork request coalescing, per target node.  The first
+// task to add a bundle to an empty batch becomes its leader and sends
+// it; whatever other tasks add while the leader is acquiring a comm
+// domain and request buffer goes along in the same request.
+//
+typedef struct {
+  chpl_ticket_lock_t lock;
+  chpl_bool          leader;
+  fork_batch_info_t  req;
+} CACHE_LINE_ALIGN fork_batch_t;
+
+static chpl_bool     fork_coalesce = false;
+static fork_batch_t* fork_batches  = NULL;
+
 //
 // These access the fork request buffers.
 //
@@ -1374,6 +1503,7 @@ static void      deregister_mem_region(mem_region_t*);
 static mem_region_t* mreg_for_addr(void*, mem_region_table_t*);
 static mem_region_t* mreg_for_local_addr(void*);
 static mem_region_t* mreg_for_remote_addr(void*, c_nodeid_t);
+static chpl_bool mreg_pull_remote(c_nodeid_t);
 static void      polling_task(void*);
 static void      set_up_for_polling(void);
 static void      ensure_registered_heap_info_set(void);
@@ -1385,6 +1515,7 @@ static void      SIGBUS_handler(int, siginfo_t *, void *);
 static void      regMemLock(void);
 static void      regMemUnlock(void);
 static void      regMemBroadcast(int, int, chpl_bool);
+static void      regMemPublish(int, int);
 static void      exit_all(int);
 static void      exit_any(int);
 static void      rf_handler(gni_cq_entry_t*);
@@ -1435,13 +1566,18 @@ static void      do_nic_amo_nf_buff(void*, c_nodeid_t, void*, size_t,
                                     gni_fma_cmd_type_t, mem_region_t*);
 static void      do_nic_amo_nf_V(int, uint64_t*, c_nodeid_t*, void**, size_t*,
                                  gni_fma_cmd_type_t*, mem_region_t**);
+static void      do_nic_amo_V(int, uint64_t*, uint64_t*, c_nodeid_t*, void**,
+                              size_t*, gni_fma_cmd_type_t*, void**,
+                              mem_region_t**);
 static void      fork_call_common(int, c_sublocid_t,
                                   chpl_fn_int_t,
                                   chpl_comm_on_bundle_t*, size_t,
                                   chpl_bool, chpl_bool);
+static chpl_bool fork_call_coalesce(c_nodeid_t, chpl_comm_on_bundle_t*);
 static void      fork_put(void*, c_nodeid_t, void*, size_t);
 static void      fork_get(void*, c_nodeid_t, void*, size_t);
 static void      fork_free(c_nodeid_t, void*);
+static void      fork_alloc(c_nodeid_t, size_t, size_t, void**);
 static void      fork_amo(fork_t*, c_nodeid_t);
 static void      fork_shutdown(c_nodeid_t);
 static void      do_fork_post(c_nodeid_t, chpl_bool,
@@ -1518,6 +1654,8 @@ static void dbg_init(void)
 
   debug_stats_flag = chpl_env_rt_get_int("COMM_UGNI_DEBUG_STATS", 0);
 
+  cd_stats_env = chpl_env_rt_get_bool("COMM_UGNI_CD_STATS", false);
+
 #ifdef CHPL_COMM_DEBUG
   FORK_REQ_BUFS_PER_CD =
       chpl_env_rt_get_int("COMM_UGNI_FORK_REQ_BUFS_PER_CD", 1);
@@ -1534,7 +1672,10 @@ static const char* fork_op_name(fork_op_t op)
                                  "put",
                                  "get",
                                  "free",
-                                 "amo" };
+                                 "amo",
+                                 "shutdown",
+                                 "batch",
+                                 "alloc" };
   return ((int)op >= 0 && op < fork_op_num_ops) ? names[op] : "?op?";
 }
 
@@ -1641,6 +1782,22 @@ static char* sprintf_rf_req(int loc, void* f_in)
     }
     break;
 
+  case fork_op_batch:
+    {
+      fork_batch_info_t* pb = (fork_batch_info_t*) f;
+      snprintf(&buf[bufcnt], sizeof(buf) - bufcnt, "%d calls (%d bytes)",
+               (int) pb->cnt, (int) pb->used);
+    }
+    break;
+
+  case fork_op_alloc:
+    {
+      fork_alloc_info_t* pal = (fork_alloc_info_t*) f;
+      snprintf(&buf[bufcnt], sizeof(buf) - bufcnt, "%d x %zd -> %d:%p",
+               (int) pal->n, pal->size, loc, pal->ptrs);
+    }
+    break;
+
   default:
     snprintf(&buf[bufcnt], sizeof(buf) - bufcnt, "(op %d)", (int) op);
     break;
@@ -1889,6 +2046,8 @@ void chpl_comm_init(int *argc_p, char ***argv_p)
   // We can reach 16k memory regions on Aries.
   max_mem_regions = chpl_env_rt_get_int("COMM_UGNI_MAX_MEM_REGIONS", 16384);
 
+  mreg_lazy_pull = chpl_env_rt_get_bool("COMM_UGNI_MEM_REG_LAZY_PULL", false);
+
   //
   // We have to create the local memory region table before the first
   // call to regMemAlloc() is made.  But that could come from the memory
@@ -2277,6 +2436,15 @@ void gni_setup_per_comm_dom(int cdi)
   cd->acqs_with_rb_looks = 0;
   cd->reacqs             = 0;
 #endif
+
+  atomic_init_uint_least64_t(&cd->acq_cnt, 0);
+  atomic_init_uint_least64_t(&cd->acq_wait_nsecs, 0);
+  for (int oi = 0; oi < chpl_comm_ugni_op_count; oi++) {
+    atomic_init_uint_least64_t(&cd->lat[oi].cnt, 0);
+    atomic_init_uint_least64_t(&cd->lat[oi].nsecs, 0);
+    for (int bi = 0; bi < CHPL_COMM_UGNI_LAT_HIST_BINS; bi++)
+      atomic_init_uint_least64_t(&cd->lat[oi].hist[bi], 0);
+  }
 }
 
 
@@ -2781,12 +2949,76 @@ mem_region_t* mreg_for_remote_addr(void* addr, c_nodeid_t locale)
                   ((mr == NULL)
                    ? mem_regions_all_entries[locale]->mreg_cnt
                    : (mr - &mem_regions_all_entries[locale]->mregs[0] + 1)));
+    if (mr == NULL && mreg_lazy_pull && mreg_pull_remote(locale)) {
+      mr = mrs[locale] = mreg_for_addr(addr, mem_regions_all_entries[locale]);
+    }
   }
   PERFSTATS_ADD(remote_mreg_nsecs, PERFSTATS_TELAPSED(pstStart));
   return mr;
 }
 
 
+//
+// Refresh our copy of a remote node's memory region table from that
+// node's own public copy, if the latter has changed since we last
+// looked.  Returns true if we pulled new entries.  This costs a small
+// GET on every remote lookup miss, but misses already mean we'll be
+// doing an AM-based transfer, which costs considerably more.  Racing
+// pulls of the same table just write the same data twice.
+//
+static
+chpl_bool mreg_pull_remote(c_nodeid_t locale)
+{
+  mem_region_table_t* tab = mem_regions_all_entries[locale];
+  mem_region_table_t* src;
+  mem_region_table_t* hdr;
+  uint32_t mreg_cnt;
+  uint32_t mreg_vers;
+
+  if (locale == chpl_nodeID || !can_register_memory)
+    return false;
+
+  //
+  // The remote node's own copy is at its index in its mem_regions_all,
+  // which is laid out just like ours.  We know where our entry is there,
+  // so we can find its entry by offsetting from that.
+  //
+  src = (mem_region_table_t*)
+        ((char*) mem_regions_all_my_entry_map[locale]
+         + ((ptrdiff_t) locale - (ptrdiff_t) chpl_nodeID) * mem_regions_size);
+
+  hdr = (mem_region_table_t*) get_buf_alloc(sizeof(*hdr));
+  do_nic_get(hdr, locale, &gnr_mreg_map[locale], src, sizeof(*hdr), gnr_mreg);
+  mreg_cnt = hdr->mreg_cnt;
+  mreg_vers = hdr->mreg_vers;
+  get_buf_free((int64_t*) hdr);
+
+  if (mreg_vers == tab->mreg_vers)
+    return false;
+
+  PERFSTATS_INC(regMem_pull_cnt);
+  DBG_P_L(DBGF_MEMREG_BCAST,
+          "mreg_pull_remote(%d): vers %d -> %d, cnt %d",
+          (int) locale, (int) tab->mreg_vers, (int) mreg_vers,
+          (int) mreg_cnt);
+
+  //
+  // Pull the entries before publishing the new count, so that lookups
+  // running concurrently never see a count covering entries we don't
+  // have yet.  The owner orders its updates the same way.
+  //
+  if (mreg_cnt > 0) {
+    do_nic_get(&tab->mregs[0], locale, &gnr_mreg_map[locale], &src->mregs[0],
+               mreg_cnt * sizeof(tab->mregs[0]), gnr_mreg);
+  }
+  chpl_atomic_thread_fence(memory_order_release);
+  tab->mreg_cnt = mreg_cnt;
+  tab->mreg_vers = mreg_vers;
+
+  return true;
+}
+
+
 static
 void polling_task(void* ignore)
 {
@@ -2863,6 +3095,19 @@ void set_up_for_polling(void)
   for (uint32_t i = 0; i < FORK_REQ_BUFS_PER_LOCALE; i++)
     fork_reqs_free[i] = true;
 
+  fork_coalesce = chpl_env_rt_get_bool("COMM_UGNI_FORK_COALESCE", false);
+  if (fork_coalesce) {
+    fork_batches =
+      (fork_batch_t*) chpl_mem_allocManyZero(chpl_numNodes,
+                                             sizeof(fork_batches[0]),
+                                             CHPL_RT_MD_COMM_PER_LOC_INFO,
+                                             0, 0);
+    for (uint32_t i = 0; i < chpl_numNodes; i++) {
+      chpl_ticket_lock_init(&fork_batches[i].lock, "comm-ugni fork batch");
+      fork_batches[i].req.b.op = fork_op_batch;
+    }
+  }
+
   fork_reqs_free_map =
     (chpl_bool32**) chpl_mem_allocMany(chpl_numNodes,
                                        sizeof(fork_reqs_free_map[0]),
@@ -3432,6 +3677,7 @@ void* chpl_comm_impl_regMemAlloc(size_t size,
   mr_mregs_supplement[mr_i].desc = desc;
   mr_mregs_supplement[mr_i].ln = ln;
   mr_mregs_supplement[mr_i].fn = fn;
+  mr_mregs_supplement[mr_i].external = false;
 
   //
   // Adjust the region count, if necessary.
@@ -3462,6 +3708,64 @@ void* chpl_comm_impl_regMemAlloc(size_t size,
 }
 
 
+//
+// Make a newly registered entry in our memory region table known to
+// the other nodes, either by broadcasting it or by publishing it for
+// them to pull when they need it.
+//
+static
+void regMemShareEntry(int mr_i)
+{
+  regMemLock();
+
+  if (mreg_lazy_pull) {
+    //
+    // Other nodes will pull this when they need it.
+    //
+    DBG_P_L(DBGF_MEMREG_BCAST,
+            "regMemShareEntry(): entry %d, publish",
+            mr_i);
+    regMemPublish(mr_i, 1);
+    regMemUnlock();
+    return;
+  }
+
+  //
+  // Update the copies of our memory regions on all nodes.  If this
+  // entry is within the already-known range of our table entries then
+  // send only this one.  Otherwise, send both all the entries beyond
+  // the already-known range and the new count.  In general this will
+  // include some new unregistered entries for which we have an address
+  // but no length or MDH.  But the presence of those won't create
+  // confusion because the remote nodes won't be trying to address
+  // within them yet anyway, and later when we do register them we may
+  // be able to send just the entries and not the count again.
+  //
+  if (mr_i < mem_regions_all_entries[chpl_nodeID]->mreg_cnt) {
+    DBG_P_L(DBGF_MEMREG_BCAST,
+            "regMemShareEntry(): entry %d, bcast",
+            mr_i);
+    PERFSTATS_INC(regMem_bCast_cnt);
+    regMemBroadcast(mr_i, 1, false /*send_mreg_cnt*/);
+  } else {
+    const uint32_t mreg_cnt_public =
+                     mem_regions_all_entries[chpl_nodeID]->mreg_cnt;
+
+    DBG_P_L(DBGF_MEMREG_BCAST,
+            "regMemShareEntry(): "
+            "entry %d, bcast %d-%d and cnt %d",
+            mr_i,
+            (int) mreg_cnt_public, (int) mem_regions->mreg_cnt - 1,
+            (int) mem_regions->mreg_cnt);
+    PERFSTATS_INC(regMem_bCast_cnt);
+    regMemBroadcast(mreg_cnt_public, mem_regions->mreg_cnt - mreg_cnt_public,
+                    true /*send_mreg_cnt*/);
+  }
+
+  regMemUnlock();
+}
+
+
 void chpl_comm_impl_regMemPostAlloc(void* p, size_t size)
 {
   mem_region_t* mr;
@@ -3509,41 +3813,7 @@ void chpl_comm_impl_regMemPostAlloc(void* p, size_t size)
   mrtl_setReg(&mr->len);
   PERFSTATS_ADD(regMem_reg_nsecs, PERFSTATS_TELAPSED(reg_ts));
 
-  regMemLock();
-
-  //
-  // Update the copies of our memory regions on all nodes.  If this
-  // entry is within the already-known range of our table entries then
-  // send only this one.  Otherwise, send both all the entries beyond
-  // the already-known range and the new count.  In general this will
-  // include some new unregistered entries for which we have an address
-  // but no length or MDH.  But the presence of those won't create
-  // confusion because the remote nodes won't be trying to address
-  // within them yet anyway, and later when we do register them we may
-  // be able to send just the entries and not the count again.
-  //
-  if (mr_i < mem_regions_all_entries[chpl_nodeID]->mreg_cnt) {
-    DBG_P_L(DBGF_MEMREG_BCAST,
-            "chpl_comm_impl_regMemPostAlloc(): entry %d, bcast",
-            mr_i);
-    PERFSTATS_INC(regMem_bCast_cnt);
-    regMemBroadcast(mr_i, 1, false /*send_mreg_cnt*/);
-  } else {
-    const uint32_t mreg_cnt_public =
-                     mem_regions_all_entries[chpl_nodeID]->mreg_cnt;
-
-    DBG_P_L(DBGF_MEMREG_BCAST,
-            "chpl_comm_impl_regMemPostAlloc(): "
-            "entry %d, bcast %d-%d and cnt %d",
-            mr_i,
-            (int) mreg_cnt_public, (int) mem_regions->mreg_cnt - 1,
-            (int) mem_regions->mreg_cnt);
-    PERFSTATS_INC(regMem_bCast_cnt);
-    regMemBroadcast(mreg_cnt_public, mem_regions->mreg_cnt - mreg_cnt_public,
-                    true /*send_mreg_cnt*/);
-  }
-
-  regMemUnlock();
+  regMemShareEntry(mr_i);
 }
 
 
@@ -3575,7 +3845,7 @@ void* chpl_comm_impl_regMemRealloc(void* p, size_t oldSize, size_t newSize,
        mr_i--, mr--)
     ;
 
-  if (mr_i < 0)
+  if (mr_i < 0 || mr_mregs_supplement[mr_i].external)
     return NULL;
 
   assert(mrtl_isReg(mr->len));
@@ -3685,41 +3955,13 @@ void chpl_comm_impl_regMemPostRealloc(void* oldp, size_t oldSize,
 }
 
 
-chpl_bool chpl_comm_impl_regMemFree(void* p, size_t size)
+//
+// Deregister a memory region and empty its table entry, updating the
+// other nodes' copies of our table.
+//
+static
+void regMemDropEntry(mem_region_t* mr, int mr_i)
 {
-  mem_region_t* mr;
-  int mr_i;
-
-  if (get_hugepage_size() == 0)
-    return false;
-
-  //
-  // Is this memory in our table?
-  //
-  for (mr_i = mem_regions->mreg_cnt - 1, mr = &mem_regions->mregs[mr_i];
-       mr_i >= 0 && (mr->addr != (uint64_t) p || mrtl_len(mr->len) != size);
-       mr_i--, mr--)
-    ;
-
-  if (mr_i < 0)
-    return false;
-
-  assert(mrtl_isReg(mr->len));
-
-  PERFSTATS_INC(regMemFree_cnt);
-
-  DBG_P_LP(DBGF_MEMREG,
-           "chpl_comm_impl_regMemFree(%p, %#zx): [%d]",
-           p, size, mr_i);
-
-  //
-  // Deregister the memory and empty the entry in our table.  Note that
-  // even with single-threading we can't compress the table or do
-  // anything else that would move entries around, because other threads
-  // may be doing lookups in it and they aren't locked out.  Also, we
-  // have to finish broadcasting the update before we unlock, because as
-  // soon as we unlock, the entry could be reused.
-  //
   PERFSTATS_TSTAMP(dereg_ts);
   deregister_mem_region(mr);
   PERFSTATS_ADD(regMem_dereg_nsecs, PERFSTATS_TELAPSED(dereg_ts));
@@ -3754,13 +3996,13 @@ chpl_bool chpl_comm_impl_regMemFree(void* p, size_t size)
   //
   if (mem_regions->mreg_cnt < mem_regions_all_entries[chpl_nodeID]->mreg_cnt) {
     DBG_P_L(DBGF_MEMREG_BCAST,
-            "chpl_comm_impl_regMemFree(): entry %d, bcast cnt %d",
+            "regMemDropEntry(): entry %d, bcast cnt %d",
             mr_i, (int) mem_regions->mreg_cnt);
     PERFSTATS_INC(regMem_bCast_cnt);
     regMemBroadcast(0, 0, true /*send_mreg_cnt*/);
   } else {
     DBG_P_L(DBGF_MEMREG_BCAST,
-            "chpl_comm_impl_regMemFree(): entry %d, bcast",
+            "regMemDropEntry(): entry %d, bcast",
             mr_i);
     PERFSTATS_INC(regMem_bCast_cnt);
     regMemBroadcast(mr_i, 1, false /*send_mreg_cnt*/);
@@ -3769,6 +4011,45 @@ chpl_bool chpl_comm_impl_regMemFree(void* p, size_t size)
   regMemUnlock();
 
   atomic_fetch_add_int_least32_t(&mreg_free_cnt, 1);
+}
+
+
+chpl_bool chpl_comm_impl_regMemFree(void* p, size_t size)
+{
+  mem_region_t* mr;
+  int mr_i;
+
+  if (get_hugepage_size() == 0)
+    return false;
+
+  //
+  // Is this memory in our table?
+  //
+  for (mr_i = mem_regions->mreg_cnt - 1, mr = &mem_regions->mregs[mr_i];
+       mr_i >= 0 && (mr->addr != (uint64_t) p || mrtl_len(mr->len) != size);
+       mr_i--, mr--)
+    ;
+
+  if (mr_i < 0 || mr_mregs_supplement[mr_i].external)
+    return false;
+
+  assert(mrtl_isReg(mr->len));
+
+  PERFSTATS_INC(regMemFree_cnt);
+
+  DBG_P_LP(DBGF_MEMREG,
+           "chpl_comm_impl_regMemFree(%p, %#zx): [%d]",
+           p, size, mr_i);
+
+  //
+  // Deregister the memory and empty the entry in our table.  Note that
+  // even with single-threading we can't compress the table or do
+  // anything else that would move entries around, because other threads
+  // may be doing lookups in it and they aren't locked out.  Also, we
+  // have to finish broadcasting the update before we unlock, because as
+  // soon as we unlock, the entry could be reused.
+  //
+  regMemDropEntry(mr, mr_i);
 
   PERFSTATS_TSTAMP(free_ts);
   free_huge_pages(p);
@@ -3778,6 +4059,108 @@ chpl_bool chpl_comm_impl_regMemFree(void* p, size_t size)
 }
 
 
+chpl_bool chpl_comm_impl_regMemRegister(void* p, size_t size)
+{
+  mem_region_t* mr;
+  int mr_i;
+  gni_mem_handle_t mdh;
+
+  //
+  // External memory goes in the dynamic part of our memory region
+  // table, along with regMemAlloc()ed memory, so it needs the same
+  // support.  If the memory is already covered, there's nothing to do.
+  //
+  if (get_hugepage_size() == 0 || !can_register_memory || size == 0)
+    return false;
+
+  if ((mr = mreg_for_addr(p, mem_regions)) != NULL
+      && (uint64_t) p + size <= mr->addr + mrtl_len(mr->len))
+    return false;
+
+  if (atomic_fetch_sub_int_least32_t(&mreg_free_cnt, 1) < 1) {
+    atomic_fetch_add_int_least32_t(&mreg_free_cnt, 1);
+
+    (void)pthread_once(&warned_out_of_mem_regions, issue_out_of_mem_regions_warning);
+
+    DBG_P_LP(DBGF_MEMREG,
+             "chpl_comm_impl_regMemRegister(%p, %#zx): out of table entries",
+             p, size);
+    return false;
+  }
+
+  PERFSTATS_TSTAMP(reg_ts);
+  if (register_mem_region((uint64_t) (uintptr_t) p, size, &mdh,
+                          true /*allow_failure*/) != GNI_RC_SUCCESS) {
+    atomic_fetch_add_int_least32_t(&mreg_free_cnt, 1);
+    return false;
+  }
+  PERFSTATS_ADD(regMem_reg_nsecs, PERFSTATS_TELAPSED(reg_ts));
+
+  regMemLock();
+
+  for (mr_i = 0;
+       mr_i < max_mem_regions && mem_regions->mregs[mr_i].addr != 0;
+       mr_i++)
+    ;
+
+  assert(mr_i < max_mem_regions);
+
+  //
+  // Lookups aren't locked out, so fill in the handle and length before
+  // the address makes the entry findable.
+  //
+  mr = &mem_regions->mregs[mr_i];
+  mr->mdh = mdh;
+  mr->len = mrtl_encode(size, true);
+  mr->addr = (uint64_t) (uintptr_t) p;
+
+  mr_mregs_supplement[mr_i].desc = CHPL_RT_MD_ARRAY_ELEMENTS;
+  mr_mregs_supplement[mr_i].ln = 0;
+  mr_mregs_supplement[mr_i].fn = 0;
+  mr_mregs_supplement[mr_i].external = true;
+
+  if (mr_i >= mem_regions->mreg_cnt) {
+    mem_regions->mreg_cnt = mr_i + 1;
+    if (mem_regions->mreg_cnt > mreg_cnt_max)
+      mreg_cnt_max = mem_regions->mreg_cnt;
+  }
+
+  regMemUnlock();
+
+  DBG_P_LP(DBGF_MEMREG,
+           "chpl_comm_impl_regMemRegister(%p, %#zx): mregs[%d], cnt %d",
+           p, size, mr_i, (int) mem_regions->mreg_cnt);
+
+  regMemShareEntry(mr_i);
+  return true;
+}
+
+
+void chpl_comm_impl_regMemDeregister(void* p, size_t size)
+{
+  mem_region_t* mr;
+  int mr_i;
+
+  for (mr_i = mem_regions->mreg_cnt - 1, mr = &mem_regions->mregs[mr_i];
+       mr_i >= 0
+         && (mr->addr != (uint64_t) p || mrtl_len(mr->len) != size
+             || !mr_mregs_supplement[mr_i].external);
+       mr_i--, mr--)
+    ;
+
+  if (mr_i < 0)
+    CHPL_INTERNAL_ERROR("chpl_comm_impl_regMemDeregister(): "
+                        "can't find the memory");
+
+  DBG_P_LP(DBGF_MEMREG,
+           "chpl_comm_impl_regMemDeregister(%p, %#zx): [%d]",
+           p, size, mr_i);
+
+  mr_mregs_supplement[mr_i].external = false;
+  regMemDropEntry(mr, mr_i);
+}
+
+
 #ifdef PERFSTATS_COMM_UGNI
 static _PSV_C_TYPE critsec_ts;
 #endif
@@ -3803,6 +4186,27 @@ void regMemUnlock(void) {
 }
 
 
+//
+// Update our own public copy of our memory region table, for other
+// nodes to pull lazily.  Must be called with the region lock held.
+//
+static inline
+void regMemPublish(int mr_i, int mr_cnt)
+{
+  mem_region_table_t* pub = mem_regions_all_my_entry_map[chpl_nodeID];
+
+  if (mr_cnt > 0) {
+    memcpy((char*) &pub->mregs[mr_i],
+           (char*) &mem_regions->mregs[mr_i],
+           mr_cnt * sizeof(mem_region_t));
+  }
+  chpl_atomic_thread_fence(memory_order_release);
+  if (pub->mreg_cnt < mem_regions->mreg_cnt)
+    pub->mreg_cnt = mem_regions->mreg_cnt;
+  pub->mreg_vers++;
+}
+
+
 static inline
 void regMemBroadcast(int mr_i, int mr_cnt, chpl_bool send_mreg_cnt)
 {
@@ -3816,22 +4220,25 @@ void regMemBroadcast(int mr_i, int mr_cnt, chpl_bool send_mreg_cnt)
                        : MAX_CHAINED_PUT_LEN;       // using 1 V elems per node
   int vi;
 
+  //
+  // Update our own map in place.  Do this first, so that with lazy
+  // pulls a remote node can't pull an entry we're about to replace
+  // after our PUT of the replacement has already reached it.
+  //
+  if (mr_cnt > 0) {
+    memcpy((char*) &mem_regions_all_my_entry_map[chpl_nodeID]->mregs[mr_i],
+           (char*) &mem_regions->mregs[mr_i],
+           mr_cnt * sizeof(mem_region_t));
+  }
+
+  if (send_mreg_cnt) {
+    mem_regions_all_my_entry_map[chpl_nodeID]->mreg_cnt =
+      mem_regions->mreg_cnt;
+  }
+
   vi = 0;
   for (int ni = 0; ni < (int) chpl_numNodes; ni++) {
-    if (ni == chpl_nodeID) {
-      //
-      // Update our own map in place.
-      //
-      if (mr_cnt > 0) {
-        memcpy((char*) &mem_regions_all_my_entry_map[ni]->mregs[mr_i],
-               (char*) &mem_regions->mregs[mr_i],
-               mr_cnt * sizeof(mem_region_t));
-      }
-
-      if (send_mreg_cnt) {
-        mem_regions_all_my_entry_map[ni]->mreg_cnt = mem_regions->mreg_cnt;
-      }
-    } else {
+    if (ni != chpl_nodeID) {
       //
       // Update every other node's map remotely.
       //
@@ -4221,6 +4628,26 @@ void rf_handler(gni_cq_entry_t* ev)
     }
     break;
 
+  case fork_op_alloc:
+    DBG_P_LP(DBGF_RF, "forkFrom(%d) %s",
+             (int) req_li, sprintf_rf_req((int) req_li, f));
+
+    {
+      fork_alloc_info_t f_al = f->al;
+      void* ptrs[CHPL_COMM_REMOTE_ALLOC_MAX];
+
+      release_req_buf(req_li, req_cdi, req_rbi);
+
+      assert(f_al.n <= CHPL_COMM_REMOTE_ALLOC_MAX);
+      for (uint32_t i = 0; i < f_al.n; i++) {
+        ptrs[i] = chpl_mem_alloc(f_al.size, CHPL_RT_MD_REMOTE_ALLOC, 0, 0);
+      }
+      do_remote_put(ptrs, f_al.b.caller, f_al.ptrs, f_al.n * sizeof(void*),
+                    NULL, may_proxy_false);
+      indicate_done(&f_al.b);
+    }
+    break;
+
   case fork_op_amo:
     DBG_P_LP(DBGF_AMO|DBGF_RF, "forkFrom(%d) %s",
              (int) req_li, sprintf_rf_req((int) req_li, f));
@@ -4232,6 +4659,33 @@ void rf_handler(gni_cq_entry_t* ev)
     }
     break;
 
+  case fork_op_batch:
+    DBG_P_LP(DBGF_RF, "forkFrom(%d) %s",
+             (int) req_li, sprintf_rf_req(-1, f));
+
+    {
+      //
+      // Batches only hold nonblocking, non-fast small calls, so we
+      // can start all of them as moved tasks and release the buffer.
+      //
+      fork_batch_info_t* bt = &f->bt;
+      size_t off = 0;
+
+      for (uint32_t i = 0; i < bt->cnt; i++) {
+        chpl_comm_on_bundle_t* f_c = (chpl_comm_on_bundle_t*) &bt->space[off];
+        chpl_task_startMovedTask(f_c->comm.fid,
+                                 (chpl_fn_p) chpl_ftable[f_c->comm.fid],
+                                 f_c,
+                                 f_c->comm.size,
+                                 f_c->comm.subloc,
+                                 chpl_nullTaskID);
+        off += ALIGN_UP(f_c->comm.size, FORK_BATCH_ALIGN);
+      }
+
+      release_req_buf(req_li, req_cdi, req_rbi);
+    }
+    break;
+
   case fork_op_shutdown:
     DBG_P_LP(DBGF_RF, "shutdownFrom(%d) %s",
              (int) req_li, sprintf_rf_req(-1, f));
@@ -5071,9 +5525,11 @@ void chpl_comm_put(void* addr, c_nodeid_t locale, void* raddr,
   }
 
   chpl_comm_diags_verbose_rdma("put", locale, size, ln, fn, commID);
-  chpl_comm_diags_incr(put);
+  chpl_comm_diags_xfer(put, size);
 
+  const uint64_t lat_start = chpl_comm_diags_lat_start();
   do_remote_put(addr, locale, raddr, size, NULL, may_proxy_true);
+  chpl_comm_diags_lat_end(put, lat_start);
 }
 
 
@@ -5451,6 +5907,24 @@ void do_nic_amo_nf_V(int v_len, uint64_t* opnd1_v, c_nodeid_t* locale_v,
                      void** object_v, size_t* size_v,
                      gni_fma_cmd_type_t* cmd_v, mem_region_t** remote_mr_v)
 {
+  do_nic_amo_V(v_len, opnd1_v, NULL, locale_v, object_v, size_v, cmd_v,
+               NULL, remote_mr_v);
+}
+
+
+//
+// Do a vector of NIC AMOs, posting them as chained transactions and
+// waiting once for the lot.  The second operands (for cmpxchg) and
+// the results are optional; either vector may be NULL, and within the
+// result vector a NULL element means that AMO's result isn't wanted.
+// The AMOs are independent and may be performed in any order.
+//
+static
+void do_nic_amo_V(int v_len, uint64_t* opnd1_v, uint64_t* opnd2_v,
+                  c_nodeid_t* locale_v, void** object_v, size_t* size_v,
+                  gni_fma_cmd_type_t* cmd_v, void** result_v,
+                  mem_region_t** remote_mr_v)
+{
 
 #if HAVE_GNI_FMA_CHAIN_TRANSACTIONS
 
@@ -5462,24 +5936,36 @@ void do_nic_amo_nf_V(int v_len, uint64_t* opnd1_v, c_nodeid_t* locale_v,
   // If there are more than we can handle at once, block them up.
   //
   while (v_len > MAX_CHAINED_AMO_LEN) {
-    do_nic_amo_nf_V(MAX_CHAINED_PUT_LEN, opnd1_v, locale_v, object_v,
-                    size_v, cmd_v, remote_mr_v);
+    do_nic_amo_V(MAX_CHAINED_AMO_LEN, opnd1_v, opnd2_v, locale_v, object_v,
+                 size_v, cmd_v, result_v, remote_mr_v);
     v_len -= MAX_CHAINED_AMO_LEN;
     opnd1_v += MAX_CHAINED_AMO_LEN;
+    if (opnd2_v != NULL)
+      opnd2_v += MAX_CHAINED_AMO_LEN;
     locale_v += MAX_CHAINED_AMO_LEN;
     object_v += MAX_CHAINED_AMO_LEN;
     size_v += MAX_CHAINED_AMO_LEN;
     cmd_v += MAX_CHAINED_AMO_LEN;
+    if (result_v != NULL)
+      result_v += MAX_CHAINED_AMO_LEN;
     remote_mr_v += MAX_CHAINED_AMO_LEN;
   }
 
   gni_post_descriptor_t post_desc;
   gni_ct_amo_post_descriptor_t pdc[MAX_CHAINED_AMO_LEN - 1];
+  uint64_t* res_buf = NULL;
   int vi, ci;
 
   if (v_len <= 0)
     return;
 
+  //
+  // Fetched results go into a trampoline buffer, one 8-byte slot per
+  // AMO, and are copied out once everything is done.
+  //
+  if (result_v != NULL)
+    res_buf = (uint64_t*) get_buf_alloc(v_len * sizeof(res_buf[0]));
+
   //
   // Build up the base post descriptor
   //
@@ -5495,6 +5981,12 @@ void do_nic_amo_nf_V(int v_len, uint64_t* opnd1_v, c_nodeid_t* locale_v,
   post_desc.length          = size_v[0];
   post_desc.amo_cmd         = cmd_v[0];
   post_desc.first_operand   = opnd1_v[0];
+  if (opnd2_v != NULL)
+    post_desc.second_operand = opnd2_v[0];
+  if (res_buf != NULL && result_v[0] != NULL) {
+    post_desc.local_addr     = (uint64_t) (intptr_t) &res_buf[0];
+    post_desc.local_mem_hndl = gnr_mreg->mdh;
+  }
 
   //
   // Build up the chain of descriptors
@@ -5504,12 +5996,19 @@ void do_nic_amo_nf_V(int v_len, uint64_t* opnd1_v, c_nodeid_t* locale_v,
       post_desc.next_descr  = &pdc[0];
     else
       pdc[ci-1].next_descr  = &pdc[ci];
+    pdc[ci]                 = (gni_ct_amo_post_descriptor_t) { 0 };
     pdc[ci].next_descr      = NULL;
     pdc[ci].remote_addr     = (uint64_t) (intptr_t) object_v[vi];
     pdc[ci].remote_mem_hndl = remote_mr_v[vi]->mdh;
     pdc[ci].length          = size_v[vi];
     pdc[ci].amo_cmd         = cmd_v[vi];
     pdc[ci].first_operand   = opnd1_v[vi];
+    if (opnd2_v != NULL)
+      pdc[ci].second_operand = opnd2_v[vi];
+    if (res_buf != NULL && result_v[vi] != NULL) {
+      pdc[ci].local_addr     = (uint64_t) (intptr_t) &res_buf[vi];
+      pdc[ci].local_mem_hndl = gnr_mreg->mdh;
+    }
   }
 
   //
@@ -5517,6 +6016,14 @@ void do_nic_amo_nf_V(int v_len, uint64_t* opnd1_v, c_nodeid_t* locale_v,
   //
   post_fma_ct_and_wait(locale_v, &post_desc);
 
+  if (res_buf != NULL) {
+    for (vi = 0; vi < v_len; vi++) {
+      if (result_v[vi] != NULL)
+        memcpy(result_v[vi], &res_buf[vi], size_v[vi]);
+    }
+    get_buf_free((int64_t*) res_buf);
+  }
+
 #else // HAVE_GNI_FMA_CHAIN_TRANSACTIONS
 
   //
@@ -5524,8 +6031,14 @@ void do_nic_amo_nf_V(int v_len, uint64_t* opnd1_v, c_nodeid_t* locale_v,
   // normal ones.
   //
   for (int vi = 0; vi < v_len; vi++) {
-    do_nic_amo_nf(&opnd1_v[vi], locale_v[vi], object_v[vi], size_v[vi],
-                  cmd_v[vi], remote_mr_v[vi]);
+    if (result_v == NULL || result_v[vi] == NULL) {
+      do_nic_amo_nf(&opnd1_v[vi], locale_v[vi], object_v[vi], size_v[vi],
+                    cmd_v[vi], remote_mr_v[vi]);
+    } else {
+      do_nic_amo(&opnd1_v[vi], (opnd2_v == NULL) ? NULL : &opnd2_v[vi],
+                 locale_v[vi], object_v[vi], size_v[vi],
+                 cmd_v[vi], result_v[vi], remote_mr_v[vi]);
+    }
   }
 
 #endif // HAVE_GNI_FMA_CHAIN_TRANSACTIONS
@@ -5595,7 +6108,7 @@ void chpl_comm_get_unordered(void* addr, c_nodeid_t locale, void* raddr,
   }
 
   chpl_comm_diags_verbose_rdma("unordered get", locale, size, ln, fn, commID);
-  chpl_comm_diags_incr(get);
+  chpl_comm_diags_xfer(get, size);
 
   do_remote_get_buff(addr, locale, raddr, size, may_proxy_true);
 }
@@ -5626,7 +6139,7 @@ void chpl_comm_put_unordered(void* addr, c_nodeid_t locale, void* raddr,
   }
 
   chpl_comm_diags_verbose_rdma("unordered put", locale, size, ln, fn, commID);
-  chpl_comm_diags_incr(put);
+  chpl_comm_diags_xfer(put, size);
 
   do_remote_put_buff(addr, locale, raddr, size, may_proxy_true);
 }
@@ -5661,9 +6174,11 @@ void chpl_comm_get(void* addr, c_nodeid_t locale, void* raddr,
   }
 
   chpl_comm_diags_verbose_rdma("get", locale, size, ln, fn, commID);
-  chpl_comm_diags_incr(get);
+  chpl_comm_diags_xfer(get, size);
 
+  const uint64_t lat_start = chpl_comm_diags_lat_start();
   do_remote_get(addr, locale, raddr, size, may_proxy_true);
+  chpl_comm_diags_lat_end(get, lat_start);
 }
 
 /*
@@ -6113,6 +6628,77 @@ chpl_comm_nb_handle_t chpl_comm_put_nb(void* addr, c_nodeid_t locale,
 }
 
 
+chpl_comm_nb_handle_t chpl_comm_put_nb_v(int v_len, void** addr_v,
+                                         c_nodeid_t locale, void** raddr_v,
+                                         size_t* size_v, int32_t commID,
+                                         int ln, int32_t fn)
+{
+  void*         src_v[MAX_CHAINED_PUT_LEN];
+  c_nodeid_t    locale_v[MAX_CHAINED_PUT_LEN];
+  void*         tgt_v[MAX_CHAINED_PUT_LEN];
+  size_t        sz_v[MAX_CHAINED_PUT_LEN];
+  mem_region_t* remote_mr_v[MAX_CHAINED_PUT_LEN];
+  int           vi, bi;
+
+  DBG_P_LP(DBGF_IFACE|DBGF_GETPUT,
+           "IFACE chpl_comm_put_nb_v(%d, %p, %d, %p, %zd)",
+           v_len, addr_v[0], (int) locale, raddr_v[0], size_v[0]);
+
+  if (v_len == 1 || locale == chpl_nodeID) {
+    for (vi = 0; vi < v_len; vi++)
+      chpl_comm_put(addr_v[vi], locale, raddr_v[vi], size_v[vi],
+                    commID, ln, fn);
+    return NULL;
+  }
+
+  //
+  // Do these as chained FMA PUTs where we can.  Like the buffered PUTs,
+  // anything big or targeting unregistered memory is done by itself.
+  //
+  for (vi = 0, bi = 0; vi < v_len; vi++) {
+    mem_region_t* remote_mr;
+
+    if (size_v[vi] == 0)
+      continue;
+
+    // Communications callback support
+    if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put)) {
+        chpl_comm_cb_info_t cb_data =
+          {chpl_comm_cb_event_kind_put, chpl_nodeID, locale,
+           .iu.comm={addr_v[vi], raddr_v[vi], size_v[vi], commID, ln, fn}};
+        chpl_comm_do_callbacks (&cb_data);
+    }
+
+    chpl_comm_diags_verbose_rdma("put", locale, size_v[vi], ln, fn, commID);
+    chpl_comm_diags_xfer(put, size_v[vi]);
+
+    remote_mr = mreg_for_remote_addr(raddr_v[vi], locale);
+    if (remote_mr == NULL || size_v[vi] > MAX_UNORDERED_TRANS_SZ) {
+      do_remote_put(addr_v[vi], locale, raddr_v[vi], size_v[vi], remote_mr,
+                    may_proxy_true);
+      continue;
+    }
+
+    src_v[bi] = addr_v[vi];
+    locale_v[bi] = locale;
+    tgt_v[bi] = raddr_v[vi];
+    sz_v[bi] = size_v[vi];
+    remote_mr_v[bi] = remote_mr;
+    if (++bi == MAX_CHAINED_PUT_LEN) {
+      do_remote_put_V(bi, src_v, locale_v, tgt_v, sz_v, remote_mr_v,
+                      may_proxy_true);
+      bi = 0;
+    }
+  }
+
+  if (bi > 0)
+    do_remote_put_V(bi, src_v, locale_v, tgt_v, sz_v, remote_mr_v,
+                    may_proxy_true);
+
+  return NULL;
+}
+
+
 int chpl_comm_test_nb_complete(chpl_comm_nb_handle_t h)
 {
   chpl_comm_diags_incr(test_nb);
@@ -6889,9 +7475,11 @@ void chpl_comm_execute_on(c_nodeid_t locale, c_sublocid_t subloc,
 
   chpl_comm_diags_verbose_executeOn("", locale, ln, fn);
   chpl_comm_diags_incr(execute_on);
+  const uint64_t lat_start = chpl_comm_diags_lat_start();
 
   PERFSTATS_INC(fork_call_cnt);
   fork_call_common(locale, subloc, fid, arg, arg_size, false, true);
+  chpl_comm_diags_lat_end(execute_on, lat_start);
 }
 
 
@@ -6953,6 +7541,41 @@ void chpl_comm_execute_on_fast(c_nodeid_t locale, c_sublocid_t subloc,
 }
 
 
+//
+// Try to add a nonblocking small call to the pending batch for its
+// target node.  Returns false if there isn't room, in which case the
+// caller should send it by itself.  If we're the first to add to the
+// batch we send it, and by the time do_fork_post() takes the batch
+// contents there may be more calls in it than just ours.
+//
+static
+chpl_bool fork_call_coalesce(c_nodeid_t locale, chpl_comm_on_bundle_t* arg)
+{
+  fork_batch_t* fb = &fork_batches[locale];
+  const size_t arg_size = arg->comm.size;
+  chpl_bool lead;
+
+  chpl_ticket_lock(&fb->lock);
+  if (fb->req.used + arg_size > sizeof(fb->req.space)) {
+    chpl_ticket_unlock(&fb->lock);
+    return false;
+  }
+  memcpy(&fb->req.space[fb->req.used], arg, arg_size);
+  fb->req.used += ALIGN_UP(arg_size, FORK_BATCH_ALIGN);
+  fb->req.cnt++;
+  lead = !fb->leader;
+  fb->leader = true;
+  chpl_ticket_unlock(&fb->lock);
+
+  if (lead) {
+    PERFSTATS_INC(fork_call_batch_cnt);
+    do_fork_post(locale, false /*blocking*/, 0, &fb->req.b, NULL, NULL);
+  }
+
+  return true;
+}
+
+
 static
 void fork_call_common(c_nodeid_t locale, c_sublocid_t subloc,
                       chpl_fn_int_t fid,
@@ -6988,6 +7611,9 @@ void fork_call_common(c_nodeid_t locale, c_sublocid_t subloc,
              sprintf_rf_req(locale, arg));
     PERFSTATS_INC(fork_call_small_cnt);
 
+    if (fork_coalesce && !blocking && fork_call_coalesce(locale, arg))
+      return;
+
     do_fork_post(locale, blocking, arg_size, (fork_base_info_t*) arg,
                  &cdi, &rbi);
 
@@ -7139,6 +7765,57 @@ void fork_free(c_nodeid_t locale, void* p)
 }
 
 
+static
+void fork_alloc(c_nodeid_t locale, size_t size, size_t n, void** ptrs)
+{
+  size_t ptrs_size = n * sizeof(void*);
+  void** my_ptrs = ptrs;
+
+  if (locale < 0 || locale >= chpl_numNodes)
+    CHPL_INTERNAL_ERROR("fork_alloc(): remote locale out of range");
+
+  //
+  // The target PUTs the addresses back to us, so they have to land in
+  // memory known to the NIC.
+  //
+  if (mreg_for_local_addr(ptrs) == NULL) {
+    my_ptrs = chpl_mem_allocMany(n, sizeof(void*), CHPL_RT_MD_COMM_UTIL,
+                                 0, 0);
+  }
+
+  fork_alloc_info_t req = { .b = { .op = fork_op_alloc,
+                                   .caller = chpl_nodeID },
+                            .size = size,
+                            .n = n,
+                            .ptrs = my_ptrs };
+
+  DBG_SET_SEQ(req.b.seq);
+  DBG_P_LP(DBGF_RF, "forkTo(%d) %s",
+           (int) locale, sprintf_rf_req(locale, &req));
+
+  PERFSTATS_INC(fork_alloc_cnt);
+  do_fork_post(locale, true /*blocking*/, sizeof(req), &req.b, NULL, NULL);
+
+  if (my_ptrs != ptrs) {
+    memcpy(ptrs, my_ptrs, ptrs_size);
+    chpl_mem_free(my_ptrs, 0, 0);
+  }
+}
+
+
+void chpl_comm_impl_remote_alloc(c_nodeid_t node, size_t size, size_t n,
+                                 void** ptrs)
+{
+  fork_alloc(node, size, n, ptrs);
+}
+
+
+void chpl_comm_impl_remote_free(c_nodeid_t node, void* p)
+{
+  fork_free(node, p);
+}
+
+
 static
 void fork_amo(fork_t* p_rf_req, c_nodeid_t locale)
 {
@@ -7265,7 +7942,31 @@ void do_fork_post(c_nodeid_t locale,
     // consume the completion event
     //
     nb_fork[nb_fork_first_free].free = false;
-    memcpy(&nb_fork[nb_fork_first_free].fork, p_rf_req, f_size);
+    if (p_rf_req->op == fork_op_batch) {
+      //
+      // Take the whole pending batch and reset it, which also ends our
+      // leadership.  A batch of one is just sent as the call itself.
+      //
+      fork_batch_t* fb = &fork_batches[locale];
+      fork_t* nbf = &nb_fork[nb_fork_first_free].fork;
+
+      chpl_ticket_lock(&fb->lock);
+      if (fb->req.cnt == 1) {
+        f_size = ((chpl_comm_on_bundle_t*) fb->req.space)->comm.size;
+        memcpy(nbf, fb->req.space, f_size);
+      } else {
+        f_size = offsetof(fork_batch_info_t, space) + fb->req.used;
+        memcpy(nbf, &fb->req, f_size);
+      }
+      fb->req.cnt = 0;
+      fb->req.used = 0;
+      fb->leader = false;
+      chpl_ticket_unlock(&fb->lock);
+
+      p_rf_req = &nbf->b;
+    } else {
+      memcpy(&nb_fork[nb_fork_first_free].fork, p_rf_req, f_size);
+    }
     post_desc_p = &nb_fork[nb_fork_first_free].nb_desc.post_desc;
     atomic_store_bool(&nb_fork[nb_fork_first_free].nb_desc.done, false);
     post_desc_p->post_id = (uint64_t) (intptr_t) &nb_fork[nb_fork_first_free].nb_desc.done;
@@ -7387,6 +8088,8 @@ void acquire_comm_dom(void)
 
   assert(cd == NULL);
 
+  const uint64_t acq_ts = cd_stats_on() ? cd_stats_nsecs() : 0;
+
   //
   // Find an available CD with at least one free CQ entry.  Each time we
   // go through all of the CDs without acquiring one, yield before trying
@@ -7428,6 +8131,9 @@ void acquire_comm_dom(void)
   cd = want_cd;
   cd_idx = want_cdi;
 
+  if (acq_ts != 0)
+    cd_stats_acq_done(cd, acq_ts);
+
 #ifdef DEBUG_STATS
   cd->acqs++;
   cd->acqs_looks += acq_looks;
@@ -7453,6 +8159,8 @@ void acquire_comm_dom_and_req_buf(c_nodeid_t remote_locale, int* p_rbi)
 
   assert(cd == NULL);
 
+  const uint64_t acq_ts = cd_stats_on() ? cd_stats_nsecs() : 0;
+
   //
   // Find an available CD with at least one free CQ entry and fork
   // request buffer.  Each time we go through all of the CDs without
@@ -7506,6 +8214,9 @@ void acquire_comm_dom_and_req_buf(c_nodeid_t remote_locale, int* p_rbi)
   cd = want_cd;
   cd_idx = want_cdi;
 
+  if (acq_ts != 0)
+    cd_stats_acq_done(cd, acq_ts);
+
   *p_rbi = rbi;
 
 #ifdef DEBUG_STATS
@@ -7599,6 +8310,9 @@ int post_fma(c_nodeid_t locale, gni_post_descriptor_t* post_desc)
     acquire_comm_dom();
   cdi = cd_idx;
 
+  if (cd_stats_on())
+    cd_stats_post_ts = cd_stats_nsecs();
+
   CQ_CNT_INC(cd);
   GNI_CHECK(GNI_PostFma(cd->remote_eps[locale], post_desc));
   release_comm_dom();
@@ -7635,6 +8349,9 @@ void post_fma_and_wait(c_nodeid_t locale, gni_post_descriptor_t* post_desc,
     consume_all_outstanding_cq_events(cdi);
     iters++;
   } while (!atomic_load_explicit_bool(&post_done, memory_order_acquire));
+
+  if (cd_stats_on())
+    cd_stats_post_done(cdi, cd_stats_op(post_desc->type));
 }
 
 #if HAVE_GNI_FMA_CHAIN_TRANSACTIONS
@@ -7680,6 +8397,9 @@ int post_fma_ct(c_nodeid_t* locale_v, gni_post_descriptor_t* post_desc)
     }
   }
 
+  if (cd_stats_on())
+    cd_stats_post_ts = cd_stats_nsecs();
+
   CQ_CNT_INC(cd);
   GNI_CHECK(GNI_CtPostFma(cd->remote_eps[locale_v[0]], post_desc));
   release_comm_dom();
@@ -7712,6 +8432,9 @@ void post_fma_ct_and_wait(c_nodeid_t* locale_v,
     }
     consume_all_outstanding_cq_events(cdi);
   } while (!atomic_load_explicit_bool(&post_done, memory_order_acquire));
+
+  if (cd_stats_on())
+    cd_stats_post_done(cdi, chpl_comm_ugni_op_chained);
 }
 
 #endif
@@ -7731,6 +8454,9 @@ int post_rdma(c_nodeid_t locale, gni_post_descriptor_t* post_desc)
 
   post_desc->src_cq_hndl = cd->cqh;
 
+  if (cd_stats_on())
+    cd_stats_post_ts = cd_stats_nsecs();
+
   CQ_CNT_INC(cd);
   GNI_CHECK(GNI_PostRdma(cd->remote_eps[locale], post_desc));
   release_comm_dom();
@@ -7763,6 +8489,9 @@ void post_rdma_and_wait(c_nodeid_t locale, gni_post_descriptor_t* post_desc,
     }
     consume_all_outstanding_cq_events(cdi);
   } while (!atomic_load_explicit_bool(&post_done, memory_order_acquire));
+
+  if (cd_stats_on())
+    cd_stats_post_done(cdi, cd_stats_op(post_desc->type));
 }
 
 
@@ -7811,6 +8540,44 @@ void chpl_comm_statsStartHere(void)
 #define _PSZM(psv) PERFSTATS_STZ(psv);
   PERFSTATS_DO_EPHEMERAL(_PSZM);
 #undef _PSZM
+
+  for (int cdi = 0; cdi < comm_dom_cnt; cdi++) {
+    comm_dom_t* zcd = &comm_doms[cdi];
+    atomic_store_uint_least64_t(&zcd->acq_cnt, 0);
+    atomic_store_uint_least64_t(&zcd->acq_wait_nsecs, 0);
+    for (int oi = 0; oi < chpl_comm_ugni_op_count; oi++) {
+      atomic_store_uint_least64_t(&zcd->lat[oi].cnt, 0);
+      atomic_store_uint_least64_t(&zcd->lat[oi].nsecs, 0);
+      for (int bi = 0; bi < CHPL_COMM_UGNI_LAT_HIST_BINS; bi++)
+        atomic_store_uint_least64_t(&zcd->lat[oi].hist[bi], 0);
+    }
+  }
+}
+
+
+int chpl_comm_statsNumCommDoms(void)
+{
+  return comm_dom_cnt;
+}
+
+
+void chpl_comm_statsGetCommDom(int cdi, chpl_comm_ugni_commDomStats_t* st)
+{
+  comm_dom_t* scd;
+
+  if (cdi < 0 || cdi >= comm_dom_cnt)
+    CHPL_INTERNAL_ERROR("chpl_comm_statsGetCommDom(): bad comm domain index");
+
+  scd = &comm_doms[cdi];
+  st->acq_cnt = atomic_load_uint_least64_t(&scd->acq_cnt);
+  st->acq_wait_nsecs = atomic_load_uint_least64_t(&scd->acq_wait_nsecs);
+  for (int oi = 0; oi < chpl_comm_ugni_op_count; oi++) {
+    st->ops[oi].cnt = atomic_load_uint_least64_t(&scd->lat[oi].cnt);
+    st->ops[oi].nsecs = atomic_load_uint_least64_t(&scd->lat[oi].nsecs);
+    for (int bi = 0; bi < CHPL_COMM_UGNI_LAT_HIST_BINS; bi++)
+      st->ops[oi].hist[bi] =
+        atomic_load_uint_least64_t(&scd->lat[oi].hist[bi]);
+  }
 }
 
 
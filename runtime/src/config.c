@@ -26,6 +26,7 @@
 #include "chplio.h"
 #include "chpl-mem.h"
 #include "chpl-linefile-support.h"
+#include "chpl-string-support.h"
 #include "config.h"
 #include "error.h"
 
@@ -339,7 +340,8 @@ void installConfigVar(const char* varName, const char* value,
   }
   lastInTable = configVar;
   configVar->varName = chpl_glom_strings(1, varName);
-  configVar->moduleName = chpl_glom_strings(1, moduleName);
+  // Many config vars share each module name, so keep one copy of it.
+  configVar->moduleName = string_intern(moduleName);
   configVar->defaultValue = chpl_glom_strings(1, value);
   configVar->setValue = NULL;
   configVar->private = private;
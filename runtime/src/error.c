@@ -183,6 +183,44 @@ void chpl_stack_unwind(FILE* out, char sep) {
   }
 }
 
+//
+// Programs compiled with --unwind-line-numbers don't pass the user's
+// line and file through library functions, so an error raised in one
+// carries the library's location.  Replace it with the location in the
+// innermost user function on the stack, if there is one.
+//
+static void chpl_unwind_user_location(int32_t* lineno, int32_t* filenameIdx) {
+  unw_cursor_t cursor;
+  unw_context_t uc;
+  unw_word_t wordValue;
+  char buffer[256];
+
+  if (chpl_sizeUserSymTable == 0)
+    return;
+
+  unw_getcontext(&uc);
+  unw_init_local(&cursor, &uc);
+
+  while (unw_step(&cursor) > 0) {
+    unw_get_proc_name(&cursor, buffer, sizeof(buffer), &wordValue);
+    for (int t = 0; t < chpl_sizeUserSymTable; t += 2) {
+      if (!strcmp(chpl_funSymTable[t], buffer)) {
+        int line = 0;
+#ifdef __linux__
+        unw_proc_info_t info;
+        unw_get_proc_info(&cursor, &info);
+        line = chpl_unwind_getLineNum((void *)(info.start_ip + wordValue));
+#endif
+        if (line == 0)
+          line = chpl_filenumSymTable[t+1];
+        *lineno = line;
+        *filenameIdx = chpl_filenumSymTable[t];
+        return;
+      }
+    }
+  }
+}
+
 // bufsz is the allocate size of the buffer
 // strsz is the number of bytes in the buffer currently used
 // str is the buffer
@@ -307,6 +345,9 @@ void chpl_warning(const char* message, int32_t lineno, int32_t filenameIdx) {
   if (verbosity == 0) {
     return;
   }
+#ifdef CHPL_UNWIND_NOT_LAUNCHER
+  chpl_unwind_user_location(&lineno, &filenameIdx);
+#endif
   if (filenameIdx != 0)
     filename = chpl_lookupFilename(filenameIdx);
   chpl_warning_explicit(message, lineno, filename);
@@ -433,6 +474,9 @@ void chpl_error_preformatted(const char* message) {
 
 void chpl_error(const char *message, int32_t lineno, int32_t filenameIdx) {
   const char *filename = NULL;
+#ifdef CHPL_UNWIND_NOT_LAUNCHER
+  chpl_unwind_user_location(&lineno, &filenameIdx);
+#endif
   if (filenameIdx != 0)
     filename= chpl_lookupFilename(filenameIdx);
   chpl_error_explicit(message, lineno, filename);
@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -64,6 +65,19 @@ static const char* getTmpDir(void) {
   return "/tmp";
 }
 
+// Where to broadcast the real binary to, or NULL if we aren't.  Setting
+// CHPL_LAUNCHER_SLURM_BCAST to a directory uses that directory on each
+// compute node; setting it to anything else but "0" or "false" uses
+// getTmpDir().
+static const char* getBcastDir(void) {
+  const char* bcast = getenv("CHPL_LAUNCHER_SLURM_BCAST");
+  if (bcast == NULL || bcast[0] == '\0' ||
+      strcmp(bcast, "0") == 0 || strcasecmp(bcast, "false") == 0) {
+    return NULL;
+  }
+  return (bcast[0] == '/') ? bcast : getTmpDir();
+}
+
 // Check what version of slurm is on the system 
 static sbatchVersion determineSlurmVersion(void) {
   const int buflen = 256;
@@ -187,6 +201,18 @@ static char* chpl_launch_create_command(int argc, char* argv[],
   char stdoutFileNoFmt    [MAX_COM_LEN];
   char tmpStdoutFileNoFmt [MAX_COM_LEN];
 
+  // At scale, having every compute node read the real binary from a
+  // shared file system at the same moment is a big part of startup.
+  // If asked, we have slurm copy it to node-local storage first, which
+  // it does with a tree fan-out, and run it from there.  Batch jobs use
+  // sbcast (with CHPL_LAUNCHER_SLURM_BCAST_FANOUT as its --fanout) and
+  // remove the copies afterward; interactive jobs use srun --bcast.
+  const char* bcastDir    = getBcastDir();
+  char* bcastFanout       = getenv("CHPL_LAUNCHER_SLURM_BCAST_FANOUT");
+  const char* realName;
+  const char* realBasename;
+  char bcastFile          [MAX_COM_LEN];
+
   // command line walltime takes precedence over env var
   if (!walltime) {
     walltime = getenv("CHPL_LAUNCHER_WALLTIME");
@@ -229,6 +255,9 @@ static char* chpl_launch_create_command(int argc, char* argv[],
   }
   
   chpl_compute_real_binary_name(argv[0]);
+  realName = chpl_get_real_binary_name();
+  realBasename = strrchr(realName, '/');
+  realBasename = (realBasename == NULL) ? realName : realBasename + 1;
 
   if (debug) {
     mypid = 0;
@@ -327,9 +356,20 @@ static char* chpl_launch_create_command(int argc, char* argv[],
       sprintf(tmpStdoutFileNoFmt, "%s/%s.%s.out", tmpDir, argv[0], "$SLURM_JOB_ID");
     }
 
+    // broadcast the real binary to the compute nodes, if asked
+    if (bcastDir != NULL) {
+      sprintf(bcastFile, "%s/%s.%s", bcastDir, realBasename, "$SLURM_JOB_ID");
+      fprintf(slurmFile, "sbcast --force ");
+      if (bcastFanout != NULL) {
+        fprintf(slurmFile, "--fanout=%s ", bcastFanout);
+      }
+      fprintf(slurmFile, "%s %s || exit 1\n", realName, bcastFile);
+    }
+
     // add the srun command and the (possibly wrapped) binary name.
     fprintf(slurmFile, "srun --kill-on-bad-exit %s %s ",
-        chpl_get_real_binary_wrapper(), chpl_get_real_binary_name());
+        chpl_get_real_binary_wrapper(),
+        (bcastDir != NULL) ? bcastFile : realName);
 
     // add any arguments passed to the launcher to the binary 
     for (i=1; i<argc; i++) {
@@ -341,6 +381,12 @@ static char* chpl_launch_create_command(int argc, char* argv[],
       fprintf(slurmFile, "> %s", tmpStdoutFileNoFmt);
     }
     fprintf(slurmFile, "\n");
+    fprintf(slurmFile, "chpl_status=$?\n");
+
+    // remove the broadcast copies of the binary
+    if (bcastDir != NULL) {
+      fprintf(slurmFile, "srun --ntasks-per-node=1 rm -f %s\n", bcastFile);
+    }
 
     // After the job is run, if we buffered stdout to <tmpDir>, we need
     // to copy the output to the actual output file. The <tmpDir> output
@@ -350,6 +396,9 @@ static char* chpl_launch_create_command(int argc, char* argv[],
       fprintf(slurmFile, "rm  %s &> /dev/null\n", tmpStdoutFileNoFmt);
     }
 
+    // exit with the program's status, not that of the cleanup
+    fprintf(slurmFile, "exit $chpl_status\n");
+
     // close the batch file and change permissions 
     fclose(slurmFile);
     chmod(slurmFilename, 0755);
@@ -423,9 +472,23 @@ static char* chpl_launch_create_command(int argc, char* argv[],
       len += sprintf(iCom+len, "--account=%s ", account);
     }
     
+    // broadcast the real binary to the compute nodes, if asked.  srun
+    // copies whatever it is told to run, so this can't be combined with
+    // a wrapper.
+    if (bcastDir != NULL) {
+      if (chpl_get_real_binary_wrapper()[0] != '\0') {
+        chpl_warning("CHPL_LAUNCHER_SLURM_BCAST is ignored for interactive "
+                     "jobs when CHPL_LAUNCHER_REAL_WRAPPER is set", 0, 0);
+      } else {
+        snprintf(bcastFile, sizeof(bcastFile), "%s/%s.%d",
+                 bcastDir, realBasename, (int) getpid());
+        len += snprintf(iCom+len, sizeof(iCom)-len, "--bcast=%s ", bcastFile);
+      }
+    }
+
     // add the (possibly wrapped) binary name
     len += sprintf(iCom+len, "%s %s ",
-        chpl_get_real_binary_wrapper(), chpl_get_real_binary_name());
+        chpl_get_real_binary_wrapper(), realName);
 
     // add any arguments passed to the launcher to the binary 
     for (i=1; i<argc; i++) {
@@ -565,4 +628,7 @@ void chpl_launch_print_help(void) {
   fprintf(stdout, "                           (or use $CHPL_LAUNCHER_PARTITION)\n");
   fprintf(stdout, "  %s <nodes> : specify node(s) to exclude\n", CHPL_EXCLUDE_FLAG);
   fprintf(stdout, "                           (or use $CHPL_LAUNCHER_EXCLUDE)\n");
+  fprintf(stdout, "\n");
+  fprintf(stdout, "  Set $CHPL_LAUNCHER_SLURM_BCAST to copy the program to node-local\n");
+  fprintf(stdout, "  storage (the directory it names, or %s) before running it.\n", getTmpDir());
 }
@@ -45,3 +45,14 @@ void chpl_mem_layerInit(void) {
 
 
 void chpl_mem_layerExit(void) { }
+
+
+void chpl_mem_bindThreadArena(void) { }
+
+
+int chpl_mem_setDecayTime(ssize_t seconds) {
+  return -1;
+}
+
+
+void chpl_mem_layerReportStats(FILE* f) { }
@@ -27,9 +27,12 @@
 #include <string.h>
 
 #include "chpl-comm.h"
+#include "chpl-env.h"
 #include "chpl-linefile-support.h"
 #include "chpl-mem.h"
 #include "chpl-mem-desc.h"
+#include "chpl-thread-local-storage.h"
+#include "chpl-topo.h"
 #include "chplmemtrack.h"
 #include "chpltypes.h"
 #include "error.h"
@@ -47,15 +50,47 @@
 
 enum heap_type {FIXED, DYNAMIC, NONE};
 
+// A fixed heap may be split into per-NUMA-domain parts by the comm layer.
+#define MAX_HEAP_PARTS 64
+
 static struct shared_heap {
   enum heap_type type;
   void* base;
   size_t size;
   size_t cur_offset;
+  int num_parts;                  // 0: the heap is not split
+  size_t part_size;
+  size_t part_offset[MAX_HEAP_PARTS];
   pthread_mutex_t alloc_lock;
 } heap;
 
 
+//
+// Optional per-NUMA-domain arenas (CHPL_RT_MEM_NUMA_ARENAS).  These
+// are created after jemalloc's own, so arena numa_arena_first + i
+// belongs to NUMA domain i.  Threads bind to the one for the domain
+// they run on, and with a split fixed heap its chunks come from that
+// domain's part.
+//
+#define MAX_NUMA_ARENAS MAX_HEAP_PARTS
+
+static int num_numa_arenas;             // 0: not in use
+static unsigned numa_arena_first;
+
+#ifdef CHPL_TLS
+static CHPL_TLS chpl_bool thread_arena_bound;
+#endif
+
+
+//
+// jemalloc reads its configuration from this when it initializes, so
+// we fill it in (from CHPL_RT_MEM_TCACHE_MAX, CHPL_RT_MEM_DECAY_TIME)
+// before our first allocation.  The environment overrides it.
+//
+const char* CHPL_JE_(malloc_conf);
+static char je_conf_buf[128];
+
+
 // compute aligned index into our shared heap, alignment must be a power of 2
 static inline void* alignHelper(void* base_ptr, size_t offset, size_t alignment) {
   uintptr_t p;
@@ -75,6 +110,59 @@ static inline void* alignHelper(void* base_ptr, size_t offset, size_t alignment)
 #ifdef USE_JE_CHUNK_HOOKS
 
 
+// Grab a chunk from one fixed heap part, or return NULL if it won't fit.
+// Called with the heap lock held.
+static void* chunk_alloc_from_part(int part, void* chunk, size_t size,
+                                   size_t alignment) {
+  void* part_base = (char*) heap.base + part * heap.part_size;
+  void* cur_chunk_base = alignHelper(part_base, heap.part_offset[part],
+                                     alignment);
+  size_t cur_part_size = (uintptr_t)cur_chunk_base - (uintptr_t)part_base;
+
+  if ((chunk && chunk != cur_chunk_base)
+      || size > heap.part_size
+      || cur_part_size > heap.part_size - size) {
+    return NULL;
+  }
+
+  heap.part_offset[part] = cur_part_size + size;
+  return cur_chunk_base;
+}
+
+// Grab a chunk from the fixed heap parts, preferring the one for the
+// NUMA domain of the calling thread.  Called with the heap lock held.
+static void* chunk_alloc_from_parts(void* chunk, size_t size,
+                                    size_t alignment, unsigned arena_ind) {
+  if (chunk) {
+    // The caller wants a specific address; only its part can supply it.
+    uintptr_t offset = (uintptr_t)chunk - (uintptr_t)heap.base;
+    if ((uintptr_t)chunk < (uintptr_t)heap.base
+        || offset >= heap.num_parts * heap.part_size) {
+      return NULL;
+    }
+    return chunk_alloc_from_part(offset / heap.part_size, chunk, size,
+                                 alignment);
+  }
+
+  c_sublocid_t subloc;
+  if (num_numa_arenas > 0 && arena_ind >= numa_arena_first
+      && arena_ind < numa_arena_first + num_numa_arenas) {
+    subloc = arena_ind - numa_arena_first;
+  } else {
+    subloc = chpl_topo_getThreadLocality();
+  }
+  int first = (subloc >= 0 && subloc < heap.num_parts) ? subloc : 0;
+  for (int i = 0; i < heap.num_parts; i++) {
+    void* p;
+    if ((p = chunk_alloc_from_part((first + i) % heap.num_parts,
+                                   NULL, size, alignment)) != NULL) {
+      return p;
+    }
+  }
+  return NULL;
+}
+
+
 // Our chunk replacement hook for allocations (Essentially a replacement for
 // mmap/sbrk.) Grab memory out of the fixed shared heap or get an extension
 // chunk, and give it to jemalloc.
@@ -82,7 +170,20 @@ static void* chunk_alloc(void *chunk, size_t size, size_t alignment, bool *zero,
 
   void* cur_chunk_base = NULL;
 
-  if (heap.type == FIXED) {
+  if (heap.type == FIXED && heap.num_parts > 0) {
+    //
+    // Get more space out of the part of the fixed heap for the NUMA
+    // domain we're running on, or any other part if that one is full.
+    //
+    pthread_mutex_lock(&heap.alloc_lock);
+    cur_chunk_base = chunk_alloc_from_parts(chunk, size, alignment,
+                                            arena_ind);
+    pthread_mutex_unlock(&heap.alloc_lock);
+
+    if (cur_chunk_base == NULL) {
+      return NULL;
+    }
+  } else if (heap.type == FIXED) {
     //
     // Get more space out of the fixed heap.
     //
@@ -213,6 +314,11 @@ static unsigned get_num_arenas(void) {
   return get_unsigned_mallctl_value("opt.narenas");
 }
 
+// get the number of arenas, including any we've created
+static unsigned get_num_arenas_total(void) {
+  return get_unsigned_mallctl_value("arenas.narenas");
+}
+
 // set the current threads arena
 static void set_arena(unsigned arena) {
   if (CHPL_JE_MALLCTL("thread.arena", NULL, NULL, &arena, sizeof(arena)) != 0) {
@@ -241,6 +347,164 @@ static void initialize_arenas(void) {
 }
 
 
+// create the per-NUMA-domain arenas, if they're wanted and would help
+static void create_numa_arenas(void) {
+  int num_doms = chpl_topo_getNumNumaDomains();
+
+  if (!chpl_env_rt_get_bool("MEM_NUMA_ARENAS", false) || num_doms <= 1) {
+    return;
+  }
+  if (num_doms > MAX_NUMA_ARENAS) {
+    chpl_warning("too many NUMA domains for CHPL_RT_MEM_NUMA_ARENAS; "
+                 "not using per-NUMA arenas", 0, 0);
+    return;
+  }
+
+  for (int i = 0; i < num_doms; i++) {
+    unsigned arena;
+    size_t sz = sizeof(arena);
+    if (CHPL_JE_MALLCTL("arenas.extend", &arena, &sz, NULL, 0) != 0) {
+      chpl_internal_error("could not create a per-NUMA arena");
+    }
+    if (i == 0) {
+      numa_arena_first = arena;
+    } else if (arena != numa_arena_first + i) {
+      chpl_internal_error("per-NUMA arenas are not consecutive");
+    }
+  }
+  num_numa_arenas = num_doms;
+}
+
+
+void chpl_mem_bindThreadArena(void) {
+  c_sublocid_t subloc;
+
+  if (num_numa_arenas == 0) {
+    return;
+  }
+
+#ifdef CHPL_TLS
+  if (thread_arena_bound) {
+    return;
+  }
+  thread_arena_bound = true;
+#endif
+
+  subloc = chpl_topo_getThreadLocality();
+  if (subloc >= 0 && subloc < num_numa_arenas) {
+    set_arena(numa_arena_first + subloc);
+  }
+}
+
+
+int chpl_mem_setDecayTime(ssize_t seconds) {
+  unsigned narenas = get_num_arenas_total();
+  int ret = 0;
+
+  // the default for arenas yet to be created, then all the current ones
+  if (CHPL_JE_MALLCTL("arenas.decay_time", NULL, NULL,
+                      &seconds, sizeof(seconds)) != 0) {
+    ret = -1;
+  }
+  for (unsigned arena = 0; arena < narenas; arena++) {
+    char path[128];
+    snprintf(path, sizeof(path), "arena.%u.decay_time", arena);
+    if (CHPL_JE_MALLCTL(path, NULL, NULL, &seconds, sizeof(seconds)) != 0) {
+      ret = -1;
+    }
+  }
+  return ret;
+}
+
+
+void chpl_mem_layerReportStats(FILE* f) {
+  static const char* const names[] = { "allocated", "active", "metadata",
+                                       "resident", "mapped" };
+  uint64_t epoch = 1;
+  size_t sz = sizeof(epoch);
+
+  // refresh the cached statistics, then report them if we have them
+  if (CHPL_JE_MALLCTL("epoch", &epoch, &sz, &epoch, sz) != 0) {
+    return;
+  }
+  for (int i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+    char path[32];
+    size_t value;
+    sz = sizeof(value);
+    snprintf(path, sizeof(path), "stats.%s", names[i]);
+    if (CHPL_JE_MALLCTL(path, &value, &sz, NULL, 0) == 0) {
+      fprintf(f, "jemalloc: node %d: %-9s %zu\n",
+              (int) chpl_nodeID, names[i], value);
+    }
+  }
+  for (int i = 0; i < num_numa_arenas; i++) {
+    char path[64];
+    size_t pactive;
+    sz = sizeof(pactive);
+    snprintf(path, sizeof(path), "stats.arenas.%u.pactive",
+             numa_arena_first + i);
+    if (CHPL_JE_MALLCTL(path, &pactive, &sz, NULL, 0) == 0) {
+      fprintf(f, "jemalloc: node %d: NUMA arena %d active pages %zu\n",
+              (int) chpl_nodeID, i, pactive);
+    }
+  }
+}
+
+
+//
+// The tcache size limit is a power of 2 in jemalloc, so we round
+// CHPL_RT_MEM_TCACHE_MAX down to one.  Returns -1 if it isn't set.
+//
+static int get_lg_tcache_max(void) {
+  size_t tcache_max = chpl_env_rt_get_size("MEM_TCACHE_MAX", 0);
+  int lg = 0;
+
+  if (tcache_max == 0) {
+    return -1;
+  }
+  while (((size_t) 2 << lg) <= tcache_max) {
+    lg++;
+  }
+  return lg;
+}
+
+
+// build jemalloc's configuration from our environment
+static void set_je_conf(void) {
+  int lg_tcache_max = get_lg_tcache_max();
+  int64_t decay_time = chpl_env_rt_get_int("MEM_DECAY_TIME", -2);
+  int len = 0;
+
+  if (lg_tcache_max >= 0) {
+    len += snprintf(je_conf_buf + len, sizeof(je_conf_buf) - len,
+                    "lg_tcache_max:%d", lg_tcache_max);
+  }
+  if (decay_time >= -1) {
+    len += snprintf(je_conf_buf + len, sizeof(je_conf_buf) - len,
+                    "%spurge:decay,decay_time:%lld", (len > 0) ? "," : "",
+                    (long long) decay_time);
+  }
+  if (len > 0) {
+    CHPL_JE_(malloc_conf) = je_conf_buf;
+  }
+}
+
+
+// warn if jemalloc was already running when we set its configuration
+static void check_je_conf(void) {
+  int lg_tcache_max = get_lg_tcache_max();
+  size_t lg;
+  size_t sz = sizeof(lg);
+
+  if (lg_tcache_max >= 0
+      && CHPL_JE_MALLCTL("opt.lg_tcache_max", &lg, &sz, NULL, 0) == 0
+      && lg != (size_t) lg_tcache_max) {
+    chpl_warning("CHPL_RT_MEM_TCACHE_MAX could not be applied; jemalloc "
+                 "was initialized before the Chapel memory layer", 0, 0);
+  }
+}
+
+
 // replace the chunk hooks for each arena with the hooks we provided above
 static void replaceChunkHooks(void) {
 
@@ -261,8 +525,8 @@ static void replaceChunkHooks(void) {
     null_merge
   };
 
-  // for each arena, change the chunk hooks
-  narenas = get_num_arenas();
+  // for each arena, including the per-NUMA ones, change the chunk hooks
+  narenas = get_num_arenas_total();
   for (arena=0; arena<narenas; arena++) {
     char path[128];
     snprintf(path, sizeof(path), "arena.%u.chunk_hooks", arena);
@@ -361,6 +625,8 @@ static void useUpMemNotInHeap(void) {
 static void initializeSharedHeap(void) {
   initialize_arenas();
 
+  create_numa_arenas();
+
   replaceChunkHooks();
 
   useUpMemNotInHeap();
@@ -380,6 +646,8 @@ void chpl_mem_layerInit(void) {
     chpl_internal_error("if heap address is specified, size must be also");
   }
 
+  set_je_conf();
+
   // If we have a fixed shared heap, initialize it. This will take care
   // of initializing jemalloc. Otherwise, do a first allocation to allow
   // jemalloc to set up. Note that if we have a dynamic shared heap this
@@ -392,6 +660,14 @@ void chpl_mem_layerInit(void) {
     heap.base = heap_base;
     heap.size = heap_size;
     heap.cur_offset = 0;
+    heap.num_parts = chpl_comm_regMemHeapNumaParts(&heap.part_size);
+    if (heap.num_parts > MAX_HEAP_PARTS) {
+      // Too many to track; allocate from it as a single heap.
+      heap.num_parts = 0;
+    }
+    for (int i = 0; i < heap.num_parts; i++) {
+      heap.part_offset[i] = 0;
+    }
     if (pthread_mutex_init(&heap.alloc_lock, NULL) != 0) {
       chpl_internal_error("cannot init chunk_alloc lock");
     }
@@ -406,8 +682,11 @@ void chpl_mem_layerInit(void) {
       chpl_internal_error("cannot init heap: chpl_je_malloc() failed");
     }
     CHPL_JE_DALLOCX(p, MALLOCX_NO_FLAGS);
+    create_numa_arenas();
   }
+  check_je_conf();
   CHPL_JE_LG_ARENA = get_num_arenas()-1;
+  chpl_mem_bindThreadArena();
 }
 
 
@@ -29,8 +29,11 @@
 #include "error.h"
 
 #include "sys.h"
+#include "chpl-mem-sys.h"
+#include "qio_stats.h"
 
 #include <limits.h>
+#include <pthread.h>
 #include <sys/mman.h>
 
 #include <ctype.h>
@@ -41,6 +44,9 @@
 // but we can't know page size at compile time
 size_t qbytes_iobuf_size = 64*1024;
 
+// how many free iobufs each thread keeps
+int qbytes_iobuf_cache_max = 32;
+
 // prototypes.
 
 void qbytes_free_iobuf(qbytes_t* b);
@@ -167,25 +173,298 @@ qioerr _qbytes_init_iobuf(qbytes_t* ret)
 }
 
 
-qioerr qbytes_create_iobuf(qbytes_t** out)
+// Direct I/O iobufs are recycled through this pool, so that streaming
+// with O_DIRECT doesn't pay for an aligned allocation and a memset per
+// buffer.  The pool memory comes from the system allocator rather than
+// the Chapel one, so buffers kept here at exit aren't reported as leaks.
+#define QBYTES_DIRECT_POOL_MAX 64
+static pthread_mutex_t direct_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static void* direct_pool[QBYTES_DIRECT_POOL_MAX];
+static int direct_pool_count = 0;
+
+static
+size_t qbytes_direct_iobuf_len(void)
 {
-  qbytes_t* ret = NULL;
+  size_t mask = QBYTES_DIRECT_ALIGN - 1;
+  size_t len = (qbytes_iobuf_size + mask) & ~mask;
+  return (len == 0) ? QBYTES_DIRECT_ALIGN : len;
+}
+
+void qbytes_free_direct_iobuf(qbytes_t* b)
+{
+  int pooled = 0;
+
+  if( (size_t) b->len == qbytes_direct_iobuf_len() ) {
+    pthread_mutex_lock(&direct_pool_lock);
+    if( direct_pool_count < QBYTES_DIRECT_POOL_MAX ) {
+      direct_pool[direct_pool_count++] = b->data;
+      pooled = 1;
+    }
+    pthread_mutex_unlock(&direct_pool_lock);
+  }
+  if( ! pooled ) sys_free(b->data);
+
+  _qbytes_free_qbytes(b);
+}
+
+qioerr qbytes_create_direct_iobuf(qbytes_t** out)
+{
+  size_t len = qbytes_direct_iobuf_len();
+  void* data = NULL;
   qioerr err;
 
-  ret = (qbytes_t*) qio_calloc(1, sizeof(qbytes_t));
-  if( ! ret ) {
+  pthread_mutex_lock(&direct_pool_lock);
+  if( direct_pool_count > 0 ) data = direct_pool[--direct_pool_count];
+  pthread_mutex_unlock(&direct_pool_lock);
+
+  if( ! data ) {
+    data = sys_memalign(QBYTES_DIRECT_ALIGN, len);
+    if( ! data ) {
+      *out = NULL;
+      return QIO_ENOMEM;
+    }
+    memset(data, 0, len);
+  }
+
+  err = qbytes_create_generic(out, data, len, qbytes_free_direct_iobuf);
+  if( err ) {
+    sys_free(data);
+    *out = NULL;
+  }
+  return err;
+}
+
+// Iobufs from qbytes_create_iobuf are recycled through a freelist per
+// thread, so that channels which are created and destroyed constantly
+// don't go to the allocator (and zero 64k) for every buffer.  An iobuf
+// freed on the thread that created it goes back on that thread's list;
+// one freed on another thread is pushed onto its owner's return queue,
+// which the owner takes over when its own list runs out.  Both are
+// bounded by qbytes_iobuf_cache_max, and anything beyond that is freed.
+//
+// As with the direct I/O pool, the memory comes from the system
+// allocator so that buffers kept here at exit aren't reported as leaks.
+struct qbytes_iobuf_cache_s;
+
+typedef struct qbytes_iobuf_s {
+  qbytes_t b; // must be first
+  struct qbytes_iobuf_s* next;
+  struct qbytes_iobuf_cache_s* owner;
+} qbytes_iobuf_t;
+
+typedef struct qbytes_iobuf_cache_s {
+  qbytes_iobuf_t* local;
+  int nlocal;
+  qbytes_iobuf_t* returned; // pushed by other threads, atomically
+  int nreturned;
+} qbytes_iobuf_cache_t;
+
+// Once a thread has exited its return queue is closed with this, and
+// other threads free its iobufs instead.
+static qbytes_iobuf_t iobuf_queue_closed;
+
+static pthread_once_t iobuf_cache_once = PTHREAD_ONCE_INIT;
+static pthread_key_t iobuf_cache_key;
+static __thread qbytes_iobuf_cache_t* iobuf_cache = NULL;
+static __thread int iobuf_cache_state = 0; // 1 if created, -1 if exited/failed
+
+static
+void iobuf_free_node(qbytes_iobuf_t* n)
+{
+  DO_DESTROY_REFCNT((&n->b));
+  sys_free(n->b.data);
+  sys_free(n);
+}
+
+static
+void iobuf_free_list(qbytes_iobuf_t* n)
+{
+  while( n ) {
+    qbytes_iobuf_t* next = n->next;
+    iobuf_free_node(n);
+    n = next;
+  }
+}
+
+static
+void iobuf_cache_destroy(void* arg)
+{
+  qbytes_iobuf_cache_t* c = (qbytes_iobuf_cache_t*) arg;
+  qbytes_iobuf_t* ret;
+
+  iobuf_cache = NULL;
+  iobuf_cache_state = -1;
+
+  ret = __atomic_exchange_n(&c->returned, &iobuf_queue_closed,
+                            __ATOMIC_ACQ_REL);
+  iobuf_free_list(ret);
+  iobuf_free_list(c->local);
+  c->local = NULL;
+  c->nlocal = 0;
+  // Other threads might still be looking at c->returned, so the cache
+  // itself is not freed.
+}
+
+static
+void iobuf_cache_key_init(void)
+{
+  if( pthread_key_create(&iobuf_cache_key, iobuf_cache_destroy) != 0 )
+    iobuf_cache_state = -1;
+}
+
+static
+qbytes_iobuf_cache_t* iobuf_get_cache(void)
+{
+  qbytes_iobuf_cache_t* c;
+
+  if( iobuf_cache_state ) return iobuf_cache;
+
+  iobuf_cache_state = -1;
+  pthread_once(&iobuf_cache_once, iobuf_cache_key_init);
+  c = (qbytes_iobuf_cache_t*) sys_calloc(1, sizeof(qbytes_iobuf_cache_t));
+  if( ! c ) return NULL;
+  if( pthread_setspecific(iobuf_cache_key, c) != 0 ) {
+    sys_free(c);
+    return NULL;
+  }
+  iobuf_cache = c;
+  iobuf_cache_state = 1;
+  return c;
+}
+
+// Put an iobuf freed by another thread on its owner's return queue.
+// Returns 0 if the queue is full or closed.
+static
+int iobuf_return_remote(qbytes_iobuf_cache_t* c, qbytes_iobuf_t* n)
+{
+  qbytes_iobuf_t* head;
+
+  if( __atomic_fetch_add(&c->nreturned, 1, __ATOMIC_RELAXED) >=
+      qbytes_iobuf_cache_max ) {
+    __atomic_fetch_sub(&c->nreturned, 1, __ATOMIC_RELAXED);
+    return 0;
+  }
+
+  head = __atomic_load_n(&c->returned, __ATOMIC_ACQUIRE);
+  do {
+    if( head == &iobuf_queue_closed ) return 0;
+    n->next = head;
+  } while( ! __atomic_compare_exchange_n(&c->returned, &head, n, 1,
+                                         __ATOMIC_RELEASE, __ATOMIC_ACQUIRE) );
+  return 1;
+}
+
+// Take over the iobufs other threads have returned.
+static
+void iobuf_take_returned(qbytes_iobuf_cache_t* c)
+{
+  qbytes_iobuf_t* ret;
+  qbytes_iobuf_t* last;
+  int count;
+
+  if( __atomic_load_n(&c->returned, __ATOMIC_RELAXED) == NULL ) return;
+
+  ret = __atomic_exchange_n(&c->returned, NULL, __ATOMIC_ACQUIRE);
+  if( ! ret ) return;
+  for( last = ret, count = 1; last->next; last = last->next ) count++;
+
+  __atomic_fetch_sub(&c->nreturned, count, __ATOMIC_RELAXED);
+  last->next = c->local;
+  c->local = ret;
+  c->nlocal += count;
+}
+
+static
+void iobuf_count_stats(int64_t hits, int64_t misses, int64_t remote)
+{
+  qio_io_stats_t s;
+
+  if( ! qio_stats_enabled() ) return;
+  memset(&s, 0, sizeof(s));
+  s.iobuf_hits = hits;
+  s.iobuf_misses = misses;
+  s.iobuf_remote_frees = remote;
+  qio_stats_add_global(&s);
+}
+
+static
+void qbytes_free_cached_iobuf(qbytes_t* b)
+{
+  qbytes_iobuf_t* n = (qbytes_iobuf_t*) b;
+  qbytes_iobuf_cache_t* owner = n->owner;
+  qbytes_iobuf_cache_t* c = iobuf_cache; // a thread without one isn't owner
+
+  if( owner && (size_t) b->len == qbytes_iobuf_size ) {
+    if( c == owner ) {
+      if( c->nlocal < qbytes_iobuf_cache_max ) {
+        n->next = c->local;
+        c->local = n;
+        c->nlocal++;
+        return;
+      }
+    } else if( iobuf_return_remote(owner, n) ) {
+      iobuf_count_stats(0, 0, 1);
+      return;
+    }
+  }
+
+  iobuf_free_node(n);
+}
+
+qioerr qbytes_create_iobuf(qbytes_t** out)
+{
+  qbytes_iobuf_cache_t* c = iobuf_get_cache();
+  qbytes_iobuf_t* n = NULL;
+  void* data = NULL;
+  size_t page_size;
+
+  if( c ) {
+    if( ! c->local ) iobuf_take_returned(c);
+    while( c->local ) {
+      n = c->local;
+      c->local = n->next;
+      c->nlocal--;
+      if( (size_t) n->b.len == qbytes_iobuf_size ) break;
+      // qbytes_iobuf_size changed since this one was cached
+      iobuf_free_node(n);
+      n = NULL;
+    }
+  }
+
+  if( n ) {
+    DO_DESTROY_REFCNT((&n->b));
+    _qbytes_init_generic(&n->b, n->b.data, n->b.len, qbytes_free_cached_iobuf);
+    n->next = NULL;
+    iobuf_count_stats(1, 0, 0);
+    *out = &n->b;
+    return 0;
+  }
+
+  n = (qbytes_iobuf_t*) sys_calloc(1, sizeof(qbytes_iobuf_t));
+  if( ! n ) {
     *out = NULL;
     return QIO_ENOMEM;
   }
 
-  err = _qbytes_init_iobuf(ret);
-  if( err ) {
-    qio_free(ret);
+  // See _qbytes_init_iobuf
+  page_size = sys_page_size();
+  if (qbytes_iobuf_size >= page_size)
+    data = sys_memalign(page_size, qbytes_iobuf_size);
+  else
+    data = sys_malloc(qbytes_iobuf_size);
+
+  if( ! data ) {
+    sys_free(n);
     *out = NULL;
-    return err;
+    return QIO_ENOMEM;
   }
+  memset(data, 0, qbytes_iobuf_size);
 
-  *out = ret;
+  _qbytes_init_generic(&n->b, data, qbytes_iobuf_size, qbytes_free_cached_iobuf);
+  n->owner = c;
+  iobuf_count_stats(0, 1, 0);
+
+  *out = &n->b;
   return 0;
 }
 
@@ -545,7 +824,7 @@ void qbuffer_trim_back(qbuffer_t* buf, int64_t remove_bytes)
         qbytes_t* bytes = qbp->bytes;
         // starts entirely after new_end, remove the chunk.
         // Remove it from the deque
-        deque_pop_front(sizeof(qbuffer_part_t), &buf->deque);
+        deque_pop_back(sizeof(qbuffer_part_t), &buf->deque);
         // release the bytes.
         qbytes_release(bytes);
       } else {
@@ -706,29 +985,82 @@ void qbuffer_iter_ceil_part(qbuffer_t* buf, qbuffer_iter_t* iter)
 }
 
 
-/* Advances an iterator using linear search.
+// Binary search: find the first part in [first, last) that ends after
+// offset.  Since each part records its end offset, the parts form a
+// sorted index of the buffer that append, prepend and trim keep up
+// to date.
+static
+deque_iterator_t qbuffer_search_parts(deque_iterator_t first,
+                                      deque_iterator_t last,
+                                      int64_t offset)
+{
+  deque_iterator_t middle;
+  qbuffer_part_t* qbp;
+  ssize_t num_parts = deque_it_difference(sizeof(qbuffer_part_t), last, first);
+  ssize_t half;
+
+  while( num_parts > 0 ) {
+    half = num_parts >> 1;
+    middle = first;
+
+    deque_it_forward_n(sizeof(qbuffer_part_t), &middle, half);
+
+    qbp = (qbuffer_part_t*) deque_it_get_cur_ptr(sizeof(qbuffer_part_t), middle);
+    if( offset < qbp->end_offset ) {
+      num_parts = half;
+    } else {
+      first = middle;
+      deque_it_forward_one(sizeof(qbuffer_part_t), &first);
+      num_parts = num_parts - half - 1;
+    }
+  }
+
+  return first;
+}
+
+// How many parts qbuffer_iter_advance checks one at a time before
+// switching to a binary search.  Most advances stay within the current
+// part or move to the next one.
+#define QBUFFER_ADVANCE_LINEAR_PARTS 2
+
+/* Advances an iterator.  Nearby parts are checked in order, and
+ * anything further away is found with a binary search.
  */
 void qbuffer_iter_advance(qbuffer_t* buf, qbuffer_iter_t* iter, int64_t amt)
 {
   deque_iterator_t d_begin = deque_begin( & buf->deque );
   deque_iterator_t d_end = deque_end( & buf->deque );
+  int i;
 
   if( amt >= 0 ) {
     // forward search.
     iter->offset += amt;
-    while( ! deque_it_equals(iter->iter, d_end) ) {
-      qbuffer_part_t* qbp = (qbuffer_part_t*) deque_it_get_cur_ptr(sizeof(qbuffer_part_t), iter->iter);
+    if( iter->offset >= buf->offset_end ) {
+      *iter = qbuffer_end(buf);
+      return;
+    }
+    for( i = 0; i < QBUFFER_ADVANCE_LINEAR_PARTS; i++ ) {
+      qbuffer_part_t* qbp;
+      if( deque_it_equals(iter->iter, d_end) ) break;
+      qbp = (qbuffer_part_t*) deque_it_get_cur_ptr(sizeof(qbuffer_part_t), iter->iter);
       if( iter->offset < qbp->end_offset ) {
         // it's in this one.
         return;
       }
       deque_it_forward_one(sizeof(qbuffer_part_t), & iter->iter);
     }
-    // If we get here, we didn't find it. Return the buffer end.
-    *iter = qbuffer_end(buf);
+    iter->iter = qbuffer_search_parts(iter->iter, d_end, iter->offset);
+    // If we didn't find it, return the buffer end.
+    if( deque_it_equals(iter->iter, d_end) ) *iter = qbuffer_end(buf);
   } else {
+    deque_iterator_t stop;
+
     // backward search.
     iter->offset += amt; // amt is negative
+    if( iter->offset < buf->offset_start ) {
+      *iter = qbuffer_begin(buf);
+      return;
+    }
 
     if( ! deque_it_equals( iter->iter, d_end ) ) {
       // is it within the current buffer?
@@ -740,9 +1072,15 @@ void qbuffer_iter_advance(qbuffer_t* buf, qbuffer_iter_t* iter, int64_t amt)
     }
 
     // now we have a valid deque element.
-    do {
+    for( i = 0; i < QBUFFER_ADVANCE_LINEAR_PARTS; i++ ) {
       qbuffer_part_t* qbp;
 
+      if( deque_it_equals(iter->iter, d_begin) ) {
+        // If we get here, we didn't find it. Return the buffer start.
+        *iter = qbuffer_begin(buf);
+        return;
+      }
+
       deque_it_back_one(sizeof(qbuffer_part_t), & iter->iter);
 
       qbp = (qbuffer_part_t*) deque_it_get_cur_ptr(sizeof(qbuffer_part_t), iter->iter);
@@ -750,9 +1088,11 @@ void qbuffer_iter_advance(qbuffer_t* buf, qbuffer_iter_t* iter, int64_t amt)
         // it's in this one.
         return;
       }
-    } while( ! deque_it_equals(iter->iter, d_begin) );
-    // If we get here, we didn't find it. Return the buffer start.
-    *iter = qbuffer_begin(buf);
+    }
+    // It's before the part we're at now.
+    stop = iter->iter;
+    iter->iter = qbuffer_search_parts(d_begin, stop, iter->offset);
+    if( deque_it_equals(iter->iter, stop) ) *iter = qbuffer_begin(buf);
   }
 }
 
@@ -765,28 +1105,11 @@ void qbuffer_iter_advance(qbuffer_t* buf, qbuffer_iter_t* iter, int64_t amt)
 qbuffer_iter_t qbuffer_iter_at(qbuffer_t* buf, int64_t offset)
 {
   qbuffer_iter_t ret;
-  deque_iterator_t first = deque_begin(& buf->deque);
+  deque_iterator_t first;
   deque_iterator_t last = deque_end(& buf->deque);
-  deque_iterator_t middle;
   qbuffer_part_t* qbp;
-  ssize_t num_parts = deque_it_difference(sizeof(qbuffer_part_t), last, first);
-  ssize_t half;
-
-  while( num_parts > 0 ) {
-    half = num_parts >> 1;
-    middle = first;
-
-    deque_it_forward_n(sizeof(qbuffer_part_t), &middle, half);
 
-    qbp = (qbuffer_part_t*) deque_it_get_cur_ptr(sizeof(qbuffer_part_t), middle);
-    if( offset < qbp->end_offset ) {
-      num_parts = half;
-    } else {
-      first = middle;
-      deque_it_forward_one(sizeof(qbuffer_part_t), &first);
-      num_parts = num_parts - half - 1;
-    }
-  }
+  first = qbuffer_search_parts(deque_begin(& buf->deque), last, offset);
 
   if( deque_it_equals(first, last) ) {
     ret = qbuffer_end(buf);
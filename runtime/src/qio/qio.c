@@ -34,11 +34,15 @@
 
 #ifndef CHPL_RT_UNIT_TEST
 #include "chplrt.h"
+#include "chpl-env.h"
 #endif
 
 #include "qio.h"
 #include "qbuffer.h"
 #include "qio_plugin_api.h"
+#include "qio_uring.h"
+#include "qio_async.h"
+#include "qio_linebuf.h"
 
 #include "error.h"
 
@@ -57,6 +61,11 @@
 //#include <sys/fcntl.h> no sys/fcntl.h on AIX, fcntl.h should cover it.
 #include <sys/stat.h>
 
+#ifdef __linux__
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#endif
+
 #include <assert.h>
 
 // Default to using close-on-exec for systems that support it.
@@ -83,6 +92,8 @@
 
 static qioerr open_flags_for_string(const char* s, int *flags_out);
 static void _qio_buffered_advance_cached_leave_bits(qio_channel_t* ch);
+static qioerr _qio_channel_async_init(qio_channel_t* ch);
+static qioerr _qio_channel_async_destroy(qio_channel_t* ch);
 
 // A few global variables that control which I/O strategy is used.
 // See choose_io_method.
@@ -92,9 +103,27 @@ static void _qio_buffered_advance_cached_leave_bits(qio_channel_t* ch);
 // when rounding up to 4k pages.
 ssize_t qio_too_small_for_default_mmap = 16*1024;
 ssize_t qio_mmap_chunk_iobufs = 128; // mmap 128 iobufs at a time (8M)
+// Channels reading big files map bigger chunks, up to this many iobufs
+// (1G), so that a scan doesn't spend its time in mmap and munmap.
+ssize_t qio_mmap_chunk_max_iobufs = 16*1024;
 
 // Future - possibly set this based on ulimit?
 ssize_t qio_initial_mmap_max = 8*1024*1024;
+// Read-only files up to this size are mapped whole when they are
+// opened with the mmap method; address space is plentiful on 64-bit
+// systems and the pages are only read in as they are touched.
+ssize_t qio_initial_mmap_max_readonly =
+  sizeof(void*) >= 8 ? (ssize_t) 1024*1024*1024 : 8*1024*1024;
+
+// Ask for transparent huge pages on read-only mappings?
+// -1 until CHPL_RT_QIO_MMAP_HUGEPAGE is checked.
+int qio_mmap_hugepage = -1;
+
+#ifndef CHPL_RT_UNIT_TEST
+#define MMAP_ENV_BOOL(name, dflt) chpl_env_rt_get_bool(name, dflt)
+#else
+#define MMAP_ENV_BOOL(name, dflt) (dflt)
+#endif
 
 #ifdef _chplrt_H_
 qioerr qio_lock(qio_lock_t* x) {
@@ -111,7 +140,7 @@ qioerr qio_lock(qio_lock_t* x) {
   }
 
   // we have to get the mutex.
-  atomic_lock_spinlock_t(&x->lock);
+  chpl_ticket_lock(&x->lock);
 
   assert( chpl_task_idEquals(x->owner, NULL_OWNER) );
   x->count = 1;
@@ -133,7 +162,7 @@ void qio_unlock(qio_lock_t* x) {
   }
 
   x->owner = NULL_OWNER;
-  atomic_unlock_spinlock_t(&x->lock);
+  chpl_ticket_unlock(&x->lock);
 }
 #endif
 
@@ -553,6 +582,8 @@ qio_hint_t choose_io_method(qio_file_t* file, qio_hint_t hints, qio_hint_t defau
 
           if (mmap_ok)
             method = QIO_METHOD_MMAP;
+          else if (qio_uring_is_default())
+            method = QIO_METHOD_URING;
           else
             method = QIO_METHOD_PREADPWRITE;
         } else {
@@ -562,6 +593,16 @@ qio_hint_t choose_io_method(qio_file_t* file, qio_hint_t hints, qio_hint_t defau
     } else {
       // method already chosen in hints.
     }
+
+    // io_uring requests carry an offset, so they need a seekable file,
+    // and the kernel might not support them.  Direct files use
+    // pread/pwrite, which handle unaligned requests.
+    if( method == QIO_METHOD_URING ) {
+      if( ! (fdflags & QIO_FDFLAG_SEEKABLE) )
+        method = QIO_METHOD_READWRITE;
+      else if( ! qio_uring_available() || (ret & QIO_HINT_DIRECT) )
+        method = QIO_METHOD_PREADPWRITE;
+    }
   }
 
   // Always use fread/fwrite with FILE*
@@ -628,24 +669,36 @@ qioerr qio_fadvise_for_hints(qio_file_t* file)
   return 0;
 }
 
+// Advise the kernel about a new mapping according to the hints.
+// The advice values aren't flags, so each one is a separate call.
+// Huge pages are only asked for on read-only mappings (where Linux
+// can use them for file data) and only when CHPL_RT_QIO_MMAP_HUGEPAGE
+// is set; failing to get them is not an error.
 static
-qioerr qio_madvise_for_hints(void* data, int64_t len, qio_hint_t hints)
+qioerr qio_madvise_for_hints(void* data, int64_t len, qio_hint_t hints,
+                             int prot)
 {
-  int advice = 0;
-  qioerr err;
+  qioerr err = 0;
 
 #ifdef POSIX_MADV_RANDOM
-  if( hints & QIO_HINT_RANDOM ) advice |= POSIX_MADV_RANDOM;
+  if( !err && (hints & QIO_HINT_RANDOM) )
+    err = qio_int_to_err(sys_posix_madvise(data, len, POSIX_MADV_RANDOM));
 #endif
 #ifdef POSIX_MADV_SEQUENTIAL
-  if( hints & QIO_HINT_SEQUENTIAL ) advice |= POSIX_MADV_SEQUENTIAL;
+  if( !err && (hints & QIO_HINT_SEQUENTIAL) )
+    err = qio_int_to_err(sys_posix_madvise(data, len, POSIX_MADV_SEQUENTIAL));
 #endif
 #ifdef POSIX_MADV_WILLNEED
-  if( hints & QIO_HINT_CACHED ) advice |= POSIX_MADV_WILLNEED;
+  if( !err && (hints & QIO_HINT_CACHED) )
+    err = qio_int_to_err(sys_posix_madvise(data, len, POSIX_MADV_WILLNEED));
 #endif
 
-  if( advice == 0 ) err = 0; // do nothing.
-  else err = qio_int_to_err(sys_posix_madvise(data, len, advice));
+#ifdef MADV_HUGEPAGE
+  if( qio_mmap_hugepage < 0 )
+    qio_mmap_hugepage = MMAP_ENV_BOOL("QIO_MMAP_HUGEPAGE", false);
+  if( !err && qio_mmap_hugepage && !(prot & PROT_WRITE) )
+    sys_madvise(data, len, MADV_HUGEPAGE);
+#endif
 
   return err;
 }
@@ -663,7 +716,9 @@ qioerr qio_mmap_initial(qio_file_t* file)
     if( len > 0 ) {
       // Can't mmap a zero-length file initially
       if ( (file->hints & QIO_HINT_PARALLEL) ||
-           (len <= qio_initial_mmap_max) ) {
+           (len <= qio_initial_mmap_max) ||
+           (!(file->fdflags & QIO_FDFLAG_WRITEABLE) &&
+            len <= qio_initial_mmap_max_readonly) ) {
         do_mmap_initial = 1;
       }
     }
@@ -689,7 +744,7 @@ qioerr qio_mmap_initial(qio_file_t* file)
     err = qio_int_to_err(sys_mmap(NULL, len, prot, MAP_SHARED|populate, file->fd, 0, &data));
     if( err ) return err;
 
-    err = qio_madvise_for_hints(data, len, file->hints);
+    err = qio_madvise_for_hints(data, len, file->hints, prot);
     if( err ) {
       sys_munmap(data, len);
       return err;
@@ -702,6 +757,14 @@ qioerr qio_mmap_initial(qio_file_t* file)
       sys_munmap(data, len);
       return err;
     }
+
+    if( qio_stats_enabled() ) {
+      qio_io_stats_t s = {0};
+      s.mmaps = 1;
+      s.mmap_bytes = len;
+      qio_stats_add(&file->stats, &s);
+      qio_stats_add_global(&s);
+    }
   }
 
   return 0;
@@ -861,7 +924,22 @@ error:
   return err;
 }
 
+// Call a plugin entry point for a file, using its C ops if it has them.
+#define PLUGIN_CALL(file_, op, ...) \
+  ((file_)->plugin_ops ? \
+     ((file_)->plugin_ops->op ? \
+        (file_)->plugin_ops->op(__VA_ARGS__) : \
+        qio_int_to_err(ENOSYS)) : \
+     chpl_qio_##op(__VA_ARGS__))
+
 qioerr qio_file_init_plugin(qio_file_t** file_out, void* file_info, int fdflags, const qio_style_t* style)
+{
+  return qio_file_init_plugin_ops(file_out, file_info, NULL, fdflags, style);
+}
+
+qioerr qio_file_init_plugin_ops(qio_file_t** file_out, void* file_info,
+                                const qio_plugin_ops_t* ops,
+                                int fdflags, const qio_style_t* style)
 {
   off_t initial_pos = 0;
   int64_t initial_length = 0;
@@ -876,7 +954,12 @@ qioerr qio_file_init_plugin(qio_file_t** file_out, void* file_info, int fdflags,
   }
 
   if (seekable) {
-    err = chpl_qio_filelength(file_info, &initial_length);
+    if( ops ) {
+      err = ops->filelength ? ops->filelength(file_info, &initial_length)
+                            : qio_int_to_err(ENOSYS);
+    } else {
+      err = chpl_qio_filelength(file_info, &initial_length);
+    }
     // Disregard errors in case it is not seekable (and if we need seek to get the
     // length). If we can't get the length, we'll set initial_pos below anyways.
     if (err) initial_length = 0;
@@ -907,6 +990,7 @@ qioerr qio_file_init_plugin(qio_file_t** file_out, void* file_info, int fdflags,
   file->initial_length = initial_length;
   file->initial_pos = initial_pos;
   file->file_info  = file_info;
+  file->plugin_ops = ops;
 
   file->hints = choose_io_method(file, iohints, 0, initial_length,
                                  (fdflags & QIO_FDFLAG_READABLE) > 0,
@@ -973,8 +1057,10 @@ qioerr _qio_file_do_close(qio_file_t* f)
 
   if (f->file_info) {
     if (f->hints & QIO_HINT_OWNED)  // Should always be true
-      err = chpl_qio_file_close(f->file_info);
+      err = PLUGIN_CALL(f, file_close, f->file_info);
     f->hints &= ~QIO_HINT_OWNED;
+    // C plugins free their state in file_close.
+    if( f->plugin_ops ) f->file_info = NULL;
   }
 
   if( f->fd >= 0 ) {
@@ -1020,7 +1106,7 @@ qioerr qio_file_sync(qio_file_t* f)
   } else if( f->fd >= 0 ) {
     err = qio_int_to_err(sys_fsync(f->fd));
   } else if( f->file_info ) {
-    err = chpl_qio_fsync(f->file_info);
+    err = PLUGIN_CALL(f, fsync, f->file_info);
   }
 
   return err;
@@ -1281,7 +1367,7 @@ qioerr qio_file_path(qio_file_t* f, const char** string_out)
   if (f->fd != -1)
     return qio_file_path_for_fd(f->fd, string_out);
   else if (f->file_info != NULL)
-    return chpl_qio_getpath(f->file_info, string_out, &len);
+    return PLUGIN_CALL(f, getpath, f->file_info, string_out, &len);
   else
     QIO_RETURN_CONSTANT_ERROR(ENOSYS, "no fd or plugin");
 }
@@ -1304,7 +1390,7 @@ qioerr qio_file_length(qio_file_t* f, int64_t *len_out)
     err = qio_int_to_err(sys_fstat(f->fd, &stats));
     *len_out = stats.st_size;
   } else if (f->file_info) {
-    err = chpl_qio_filelength(f->file_info, len_out);
+    err = PLUGIN_CALL(f, filelength, f->file_info, len_out);
   } else {
     QIO_RETURN_CONSTANT_ERROR(ENOSYS, "no fd or plugin");
   }
@@ -1355,6 +1441,20 @@ qioerr _qio_channel_init_file_internal(qio_channel_t* ch, qio_file_t* file, qio_
                                file->initial_length, readable, writeable,
                                file->fp != NULL && file->use_fp);
   //method = use_hints & QIO_METHODMASK;
+
+  // Writes to stdout/stderr can go to per-task line buffers, in which
+  // case the channel itself doesn't buffer anything.
+  use_hints &= ~QIO_HINT_TASKLINEBUF;
+  if( writeable && ! readable &&
+      file->file_info == NULL &&
+      (use_hints & QIO_METHODMASK) == QIO_METHOD_READWRITE &&
+      ! (file->hints & QIO_HINT_DIRECT) &&
+      (file->fd == STDOUT_FILENO || file->fd == STDERR_FILENO) &&
+      ((hints & QIO_HINT_TASKLINEBUF) || qio_linebuf_enabled()) ) {
+    use_hints = (use_hints & ~QIO_CHTYPEMASK) | QIO_CH_ALWAYS_UNBUFFERED |
+                QIO_HINT_TASKLINEBUF;
+  }
+
   type = (qio_chtype_t) (use_hints & QIO_CHTYPEMASK);
 
   err = _qio_channel_init(ch, type);
@@ -1377,7 +1477,8 @@ qioerr _qio_channel_init_file_internal(qio_channel_t* ch, qio_file_t* file, qio_
   // Setup any plugin channel, if necessary
   if (file->file_info != NULL) {
     void* chan_info = NULL;
-    err = chpl_qio_setup_plugin_channel(file->file_info, &chan_info, start, end, ch);
+    err = PLUGIN_CALL(file, setup_plugin_channel,
+                      file->file_info, &chan_info, start, end, ch);
     if (err) return err;
     ch->chan_info = chan_info;
   }
@@ -1385,6 +1486,9 @@ qioerr _qio_channel_init_file_internal(qio_channel_t* ch, qio_file_t* file, qio_
   qio_file_retain(file);
   ch->file = file;
 
+  err = _qio_channel_async_init(ch);
+  if( err ) return err;
+
   // update the file with start_pos.
   err = 0;
   newerr = qio_lock(&ch->file->lock);
@@ -1787,6 +1891,13 @@ qioerr _qio_channel_final_flush_unlocked(qio_channel_t* ch)
     }
   }
 
+  // Finish any read-ahead or write-behind before the buffer and the
+  // file go away.
+  {
+    qioerr async_err = _qio_channel_async_destroy(ch);
+    if( ! err ) err = async_err;
+  }
+
   // Make a note of any error from flush/truncate so we don't forget it
   flush_or_truncate_error = err;
 
@@ -1794,8 +1905,12 @@ qioerr _qio_channel_final_flush_unlocked(qio_channel_t* ch)
   ch->end_pos = qio_channel_offset_unlocked(ch);
 
   // Close plugin structure if any
-  if (ch->chan_info != NULL)
-    chpl_qio_channel_close(ch->chan_info);
+  if (ch->chan_info != NULL) {
+    qioerr close_err = PLUGIN_CALL(ch->file, channel_close, ch->chan_info);
+    // Only C plugins report errors from close.
+    if( ch->file->plugin_ops && ! flush_or_truncate_error )
+      flush_or_truncate_error = close_err;
+  }
 
   if( !destroyed_buffer && qbuffer_is_initialized(&ch->buf) ) {
     // Destroy the buffer.
@@ -1804,6 +1919,10 @@ qioerr _qio_channel_final_flush_unlocked(qio_channel_t* ch)
 
   ch->hints |= QIO_CHTYPE_CLOSED; // set to invalid type so funcs return EINVAL
 
+  // Fold this channel's I/O statistics into its file's and the totals.
+  qio_stats_add(&ch->file->stats, &ch->stats);
+  qio_stats_add_global(&ch->stats);
+
   // If this channel is the last owner of the file, close the file
   // now so we can return an error here if there was one.
   // The file will be destroyed in the qio_file_release call below.
@@ -1885,6 +2004,34 @@ void _set_right_mark_start(qio_channel_t* ch, int64_t pos)
   ch->mark_stack[ch->mark_cur] = pos;
 }
 
+// I/O statistics (see qio_stats.h). _qio_stats_start returns 0
+// when statistics are off, and the others then do nothing.
+static inline
+int64_t _qio_stats_start(void)
+{
+  return qio_stats_enabled() ? qio_stats_now_ns() : 0;
+}
+
+static inline
+void _qio_stats_read(qio_channel_t* ch, int64_t t0, int64_t nbytes)
+{
+  if( t0 ) {
+    ch->stats.read_calls++;
+    ch->stats.bytes_read += nbytes;
+    ch->stats.read_ns += qio_stats_now_ns() - t0;
+  }
+}
+
+static inline
+void _qio_stats_write(qio_channel_t* ch, int64_t t0, int64_t nbytes)
+{
+  if( t0 ) {
+    ch->stats.write_calls++;
+    ch->stats.bytes_written += nbytes;
+    ch->stats.write_ns += qio_stats_now_ns() - t0;
+  }
+}
+
 static
 qbuffer_iter_t _right_mark_start_iter(qio_channel_t* ch)
 {
@@ -1903,6 +2050,278 @@ qbuffer_iter_t _right_mark_start_iter(qio_channel_t* ch)
 }
 
 
+// Direct I/O (QIO_HINT_DIRECT).
+//
+// With O_DIRECT, the address, file offset and length of each transfer
+// must be multiples of the device block size.  I/O that meets that
+// (QBYTES_DIRECT_ALIGN) goes straight to the device.  Reads that don't
+// are done through aligned bounce iobufs.  Unaligned pieces of writes
+// (which would otherwise need a read-modify-write, and would pad the
+// file at its end) are written with O_DIRECT briefly turned off.
+static inline
+int _direct_aligned(int64_t v)
+{
+  return (v & (QBYTES_DIRECT_ALIGN - 1)) == 0;
+}
+
+// Turn O_DIRECT off for the file, and hold the file lock until
+// _qio_direct_on_unlock, so that no other unaligned I/O turns it back
+// on underneath us.  Aligned I/O on other channels works either way.
+static
+qioerr _qio_direct_off_lock(qio_file_t* file)
+{
+  qioerr err;
+  int flags;
+  int rc;
+
+  err = qio_lock(&file->lock);
+  if( err ) return err;
+
+  err = qio_int_to_err(sys_fcntl(file->fd, F_GETFL, &flags));
+#ifdef O_DIRECT
+  if( ! err ) {
+    err = qio_int_to_err(sys_fcntl_long(file->fd, F_SETFL,
+                                        flags & ~O_DIRECT, &rc));
+  }
+#endif
+  if( err ) qio_unlock(&file->lock);
+  return err;
+}
+
+static
+qioerr _qio_direct_on_unlock(qio_file_t* file)
+{
+  qioerr err = 0;
+#ifdef O_DIRECT
+  int flags;
+  int rc;
+
+  err = qio_int_to_err(sys_fcntl(file->fd, F_GETFL, &flags));
+  if( ! err ) {
+    err = qio_int_to_err(sys_fcntl_long(file->fd, F_SETFL,
+                                        flags | O_DIRECT, &rc));
+  }
+#endif
+  qio_unlock(&file->lock);
+  return err;
+}
+
+// Is the part of buf between start and end, at offset, suitable for
+// O_DIRECT as it stands?
+static
+int _qbuffer_direct_aligned(qbuffer_t* buf, qbuffer_iter_t start,
+                            qbuffer_iter_t end, int64_t offset)
+{
+  ssize_t num_parts = qbuffer_iter_num_parts(start, end);
+  struct iovec* iov = NULL;
+  size_t iovcnt;
+  size_t i;
+  int ok;
+  MAYBE_STACK_SPACE(struct iovec, iov_onstack);
+
+  if( ! _direct_aligned(offset) || num_parts < 0 ) return 0;
+
+  MAYBE_STACK_ALLOC(struct iovec, num_parts, iov, iov_onstack);
+  if( ! iov ) return 0;
+
+  ok = (qbuffer_to_iov(buf, start, end, num_parts, iov, NULL, &iovcnt) == 0);
+  for( i = 0; ok && i < iovcnt; i++ ) {
+    ok = _direct_aligned((intptr_t) iov[i].iov_base) &&
+         _direct_aligned(iov[i].iov_len);
+  }
+
+  MAYBE_STACK_FREE(iov, iov_onstack);
+  return ok;
+}
+
+// qio_readv/writev/preadv/pwritev on a direct file, for the buffered
+// channel methods.  offset is the file offset the I/O starts at.
+static
+qioerr _qio_direct_iov(qio_file_t* file, qio_method_t method, int writing,
+                       qbuffer_t* buf, qbuffer_iter_t start,
+                       qbuffer_iter_t end, int64_t offset, ssize_t* num)
+{
+  int aligned = _qbuffer_direct_aligned(buf, start, end, offset);
+  qioerr err, err2 = 0;
+
+  if( ! aligned ) {
+    err = _qio_direct_off_lock(file);
+    if( err ) {
+      *num = 0;
+      return err;
+    }
+  }
+
+  if( method == QIO_METHOD_READWRITE ) {
+    if( writing ) err = qio_writev(file, buf, start, end, num);
+    else err = qio_readv(file, buf, start, end, num);
+  } else {
+    if( writing ) err = qio_pwritev(file, buf, start, end, offset, num);
+    else err = qio_preadv(file, buf, start, end, offset, num);
+  }
+
+  if( ! aligned ) err2 = _qio_direct_on_unlock(file);
+  return err ? err : err2;
+}
+
+// sys_read/sys_write on a direct file, for unbuffered READWRITE
+// channels.  offset is the current file position.
+static
+err_t _qio_direct_rw(qio_file_t* file, int writing, void* ptr, size_t len,
+                     int64_t offset, ssize_t* num)
+{
+  int aligned = _direct_aligned((intptr_t) ptr) && _direct_aligned(offset) &&
+                _direct_aligned(len);
+  err_t err;
+
+  if( ! aligned && _qio_direct_off_lock(file) ) {
+    *num = 0;
+    return EINVAL;
+  }
+
+  if( writing ) err = sys_write(file->fd, ptr, len, num);
+  else err = sys_read(file->fd, ptr, len, num);
+
+  if( ! aligned ) _qio_direct_on_unlock(file);
+  return err;
+}
+// sys_pread for a direct file.
+static
+err_t _qio_direct_pread(qio_file_t* file, void* ptr, size_t len,
+                        int64_t offset, ssize_t* num_read)
+{
+  qbytes_t* bounce;
+  size_t total = 0;
+  err_t err = 0;
+
+  if( _direct_aligned((intptr_t) ptr) && _direct_aligned(offset) &&
+      _direct_aligned(len) ) {
+    return sys_pread(file->fd, ptr, len, offset, num_read);
+  }
+
+  if( qbytes_create_direct_iobuf(&bounce) ) {
+    *num_read = 0;
+    return ENOMEM;
+  }
+
+  // Read whole aligned blocks around the request and copy out the
+  // part that was asked for.
+  while( total < len ) {
+    int64_t pos = offset + total;
+    int64_t apos = pos & ~((int64_t) QBYTES_DIRECT_ALIGN - 1);
+    int64_t skip = pos - apos;
+    int64_t want = skip + (len - total);
+    ssize_t got = 0;
+    int64_t use;
+
+    want = (want + QBYTES_DIRECT_ALIGN - 1) & ~((int64_t) QBYTES_DIRECT_ALIGN - 1);
+    if( want > bounce->len ) want = bounce->len;
+
+    err = sys_pread(file->fd, bounce->data, want, apos, &got);
+    if( err == EINTR ) continue;
+    if( err == EEOF ) err = 0;
+    if( err || got <= skip ) break;
+
+    use = got - skip;
+    if( use > (int64_t) (len - total) ) use = len - total;
+    qio_memcpy(qio_ptr_add(ptr, total), qio_ptr_add(bounce->data, skip), use);
+    total += use;
+
+    if( got < want ) break; // end of file
+  }
+
+  qbytes_release(bounce);
+
+  *num_read = total;
+  if( err == 0 && total == 0 && len != 0 ) err = EEOF;
+  return err;
+}
+
+// sys_pwrite for a direct file.
+static
+err_t _qio_direct_pwrite(qio_file_t* file, const void* ptr, size_t len,
+                         int64_t offset, ssize_t* num_written)
+{
+  size_t head;
+  size_t tail;
+  size_t middle;
+  size_t total = 0;
+  ssize_t got;
+  err_t err = 0;
+
+  if( _direct_aligned((intptr_t) ptr) && _direct_aligned(offset) &&
+      _direct_aligned(len) ) {
+    return sys_pwrite(file->fd, ptr, len, offset, num_written);
+  }
+
+  // Split into an unaligned head, an aligned middle and an unaligned
+  // tail.  The head and tail are written without O_DIRECT.
+  head = (QBYTES_DIRECT_ALIGN - (offset & (QBYTES_DIRECT_ALIGN - 1)))
+         & (QBYTES_DIRECT_ALIGN - 1);
+  if( head > len ) head = len;
+  tail = (len - head) & (QBYTES_DIRECT_ALIGN - 1);
+  middle = len - head - tail;
+
+  if( head > 0 ) {
+    if( _qio_direct_off_lock(file) ) {
+      *num_written = 0;
+      return EINVAL;
+    }
+    err = sys_pwrite(file->fd, ptr, head, offset, &got);
+    _qio_direct_on_unlock(file);
+    if( err ) goto done;
+    total += got;
+    if( (size_t) got < head ) goto done;
+  }
+
+  if( middle > 0 && _direct_aligned((intptr_t) qio_ptr_add((void*) ptr, head)) ) {
+    err = sys_pwrite(file->fd, qio_ptr_add((void*) ptr, head), middle,
+                     offset + head, &got);
+    if( err ) goto done;
+    total += got;
+    if( (size_t) got < middle ) goto done;
+  } else if( middle > 0 ) {
+    // The caller's memory isn't aligned; copy through a bounce iobuf.
+    qbytes_t* bounce;
+    size_t done_middle = 0;
+
+    if( qbytes_create_direct_iobuf(&bounce) ) {
+      err = ENOMEM;
+      goto done;
+    }
+    while( done_middle < middle ) {
+      size_t n = middle - done_middle;
+      if( n > (size_t) bounce->len ) n = bounce->len;
+      qio_memcpy(bounce->data,
+                 qio_ptr_add((void*) ptr, head + done_middle), n);
+      err = sys_pwrite(file->fd, bounce->data, n,
+                       offset + head + done_middle, &got);
+      if( err || got <= 0 ) break;
+      done_middle += got;
+      total += got;
+      if( (size_t) got < n ) break;
+    }
+    qbytes_release(bounce);
+    if( err || done_middle < middle ) goto done;
+  }
+
+  if( tail > 0 ) {
+    if( _qio_direct_off_lock(file) ) {
+      err = EINVAL;
+      goto done;
+    }
+    err = sys_pwrite(file->fd, qio_ptr_add((void*) ptr, head + middle), tail,
+                     offset + head + middle, &got);
+    _qio_direct_on_unlock(file);
+    if( err ) goto done;
+    total += got;
+  }
+
+done:
+  *num_written = total;
+  return err;
+}
+
 // allocate >= amt buffer space, and put it into the
 // buffer, but don't advance any iterators.
 static
@@ -1916,7 +2335,8 @@ qioerr _buffered_allocate_bufferspace(qio_channel_t* ch, int64_t amt, int64_t ma
 
   // allocate some space!
   while( left > 0 ) {
-    err = qbytes_create_iobuf(&tmp);
+    if( ch->file && (ch->file->hints & QIO_HINT_DIRECT) ) err = qbytes_create_direct_iobuf(&tmp);
+    else err = qbytes_create_iobuf(&tmp);
     if( err ) goto error;
     uselen = tmp->len;
     if( uselen > max_left ) uselen = max_left;
@@ -2074,12 +2494,44 @@ qioerr _buffered_get_memory(qio_channel_t* ch, int64_t amt, int writing)
   return err;
 }
 
+// How much of a file a reading channel maps at a time.  Each mapping
+// costs an mmap, a munmap and the page faults on it, so channels
+// scanning a big file map bigger chunks: about a sixteenth of the file,
+// or a quarter with QIO_HINT_SEQUENTIAL, up to
+// qio_mmap_chunk_max_iobufs.  QIO_HINT_RANDOM maps small chunks
+// instead.  Writers keep to qio_mmap_chunk_iobufs since mapping
+// extends the file.
+static
+int64_t _mmap_chunk_len(qio_channel_t* ch, int64_t file_len, int writing)
+{
+  int64_t base = qio_mmap_chunk_iobufs * qbytes_iobuf_size;
+  int64_t max = qio_mmap_chunk_max_iobufs * qbytes_iobuf_size;
+  int64_t chunk = base;
+  int64_t want;
+  qio_hint_t hints = ch->hints | ch->file->hints;
+
+  if( writing ) return base;
+
+  if( hints & QIO_HINT_RANDOM ) {
+    chunk = base / 8;
+  } else {
+    want = file_len / ((hints & QIO_HINT_SEQUENTIAL) ? 4 : 16);
+    if( want > chunk ) chunk = want;
+  }
+  if( chunk > max ) chunk = max;
+
+  // Use whole iobufs (which are whole pages).
+  chunk = (chunk + qbytes_iobuf_size - 1) / qbytes_iobuf_size;
+  if( chunk < 1 ) chunk = 1;
+  return chunk * qbytes_iobuf_size;
+}
+
 static
 qioerr _buffered_get_mmap(qio_channel_t* ch, int64_t amt_in, int writing)
 {
   qbuffer_iter_t start;
   qioerr err;
-  size_t mmap_chunk = qio_mmap_chunk_iobufs * qbytes_iobuf_size;
+  int64_t mmap_chunk;
   struct stat stats;
   int prot;
   void* data;
@@ -2110,6 +2562,12 @@ qioerr _buffered_get_mmap(qio_channel_t* ch, int64_t amt_in, int writing)
 
   amt += skip;
 
+  // Get the file's length.
+  err = qio_int_to_err(sys_fstat(ch->file->fd, &stats));
+  if( err ) return err;
+
+  mmap_chunk = _mmap_chunk_len(ch, stats.st_size, writing);
+
   // Round amt up to mmap_chunk size, store in len.
   // We'll map len bytes starting at map_start.
   {
@@ -2123,11 +2581,6 @@ qioerr _buffered_get_mmap(qio_channel_t* ch, int64_t amt_in, int writing)
     else len = rounded_down;
   }
 
-  // Seek to the end of the file.
-  // Get the file's length.
-  err = qio_int_to_err(sys_fstat(ch->file->fd, &stats));
-  if( err ) return err;
-
   // do not exceed end_pos.
   if( ch->end_pos < INT64_MAX ) {
     if( map_start + len > ch->end_pos ) {
@@ -2168,7 +2621,8 @@ qioerr _buffered_get_mmap(qio_channel_t* ch, int64_t amt_in, int writing)
   // If we're not going to get all the requested data, return EEOF.
   if( len < amt ) eof = 1;
 
-  if( len > 0 ) {
+  // Don't map the last page again just to find the end of the file.
+  if( len > skip ) {
     // OK, now mmap
     prot = PROT_READ;
     if( ch->flags & QIO_FDFLAG_WRITEABLE ) prot |= PROT_WRITE;
@@ -2176,8 +2630,30 @@ qioerr _buffered_get_mmap(qio_channel_t* ch, int64_t amt_in, int writing)
     // This check is (only) important for 32-bit systems.
     if( len > SSIZE_MAX ) QIO_RETURN_CONSTANT_ERROR(EOVERFLOW, "overflow in mmap");
 
-    err = qio_int_to_err(sys_mmap(NULL, len, prot, MAP_SHARED, ch->file->fd, map_start, &data));
-    if( err ) return err;
+    {
+      int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+      // A sequential reader will touch the whole chunk, so fault it
+      // in with the mmap rather than a page at a time.
+      if( ! writing &&
+          ((ch->hints | ch->file->hints) &
+           (QIO_HINT_SEQUENTIAL | QIO_HINT_CACHED)) )
+        flags |= MAP_POPULATE;
+#endif
+      err = qio_int_to_err(sys_mmap(NULL, len, prot, flags, ch->file->fd, map_start, &data));
+      if( err ) return err;
+    }
+
+    err = qio_madvise_for_hints(data, len, ch->hints | ch->file->hints, prot);
+    if( err ) {
+      sys_munmap(data, len);
+      return err;
+    }
+
+    if( qio_stats_enabled() ) {
+      ch->stats.mmaps++;
+      ch->stats.mmap_bytes += len;
+    }
 
     err = qbytes_create_generic(&bytes, data, len, qbytes_free_munmap);
     if( err ) {
@@ -2198,6 +2674,341 @@ qioerr _buffered_get_mmap(qio_channel_t* ch, int64_t amt_in, int writing)
   else return 0;
 }
 
+// Read-ahead and write-behind for sequential channels.
+//
+// A buffered channel using pread/pwrite (or io_uring) with the
+// QIO_HINT_SEQUENTIAL hint keeps up to qio_async_depth() iobufs in
+// flight on the qio async threads.  When reading, the iobufs after the
+// one being consumed are being read while the task parses the current
+// one.  When writing, _qio_buffered_behind hands full chunks to the
+// async threads and returns; a full flush waits for them.
+typedef struct {
+  qio_async_job_t job; // must be first
+  fd_t fd;
+  qbytes_t* bytes;
+  int64_t offset;
+  int64_t len;
+  ssize_t nread;
+  err_t err;
+} qio_readahead_t;
+
+typedef struct {
+  qio_async_job_t job; // must be first
+  fd_t fd;
+  int64_t offset;
+  size_t iovcnt;
+  struct iovec* iov;
+  qbytes_t** bytes;
+  err_t err;
+} qio_writebehind_t;
+
+struct qio_channel_async_s {
+  int depth;
+
+  // read-ahead: a ring of requests for consecutive iobufs
+  int ra_head;
+  int ra_count;
+  int64_t ra_next; // file offset after the last request
+  qio_readahead_t* ra;
+
+  // write-behind: a ring of outstanding writes
+  int wb_head;
+  int wb_count;
+  qio_writebehind_t* wb;
+  qioerr wb_err; // first write-behind error not yet reported
+};
+
+static
+void _readahead_job(qio_async_job_t* job)
+{
+  qio_readahead_t* r = (qio_readahead_t*) job;
+  ssize_t got;
+  err_t err;
+
+  r->nread = 0;
+  r->err = 0;
+  while( r->nread < r->len ) {
+    got = 0;
+    err = sys_pread(r->fd, qio_ptr_add(r->bytes->data, r->nread),
+                    r->len - r->nread, r->offset + r->nread, &got);
+    if( err == EINTR ) continue;
+    if( err == EEOF || (err == 0 && got == 0) ) break;
+    if( err ) {
+      r->err = err;
+      break;
+    }
+    r->nread += got;
+  }
+}
+
+static
+void _writebehind_job(qio_async_job_t* job)
+{
+  qio_writebehind_t* w = (qio_writebehind_t*) job;
+  int64_t offset = w->offset;
+  size_t i;
+
+  w->err = 0;
+  for( i = 0; i < w->iovcnt && w->err == 0; i++ ) {
+    size_t done = 0;
+    while( done < w->iov[i].iov_len ) {
+      ssize_t got = 0;
+      err_t err = sys_pwrite(w->fd, qio_ptr_add(w->iov[i].iov_base, done),
+                             w->iov[i].iov_len - done, offset + done, &got);
+      if( err == EINTR ) continue;
+      if( err ) {
+        w->err = err;
+        break;
+      }
+      done += got;
+    }
+    offset += w->iov[i].iov_len;
+  }
+}
+
+static
+qioerr _qio_channel_async_init(qio_channel_t* ch)
+{
+  qio_method_t method = (qio_method_t) (ch->hints & QIO_METHODMASK);
+  qio_chtype_t type = (qio_chtype_t) (ch->hints & QIO_CHTYPEMASK);
+  struct qio_channel_async_s* a;
+  int depth;
+
+  // Direct channels already bypass the page cache; keep them simple.
+  if( ! (ch->hints & QIO_HINT_SEQUENTIAL) ||
+      (ch->file->hints & QIO_HINT_DIRECT) ||
+      type != QIO_CH_BUFFERED ||
+      (method != QIO_METHOD_PREADPWRITE && method != QIO_METHOD_URING) ||
+      ch->file->fd == -1 || ch->chan_info != NULL ) {
+    return 0;
+  }
+
+  depth = qio_async_depth();
+  if( depth <= 0 ) return 0;
+
+  a = (struct qio_channel_async_s*) qio_calloc(1, sizeof(*a));
+  if( ! a ) return QIO_ENOMEM;
+  a->depth = depth;
+  if( ch->flags & QIO_FDFLAG_READABLE ) {
+    a->ra = (qio_readahead_t*) qio_calloc(depth, sizeof(qio_readahead_t));
+    if( ! a->ra ) goto error;
+  }
+  if( ch->flags & QIO_FDFLAG_WRITEABLE ) {
+    a->wb = (qio_writebehind_t*) qio_calloc(depth, sizeof(qio_writebehind_t));
+    if( ! a->wb ) goto error;
+  }
+
+  ch->async = a;
+  return 0;
+
+error:
+  if( a->ra ) qio_free(a->ra);
+  qio_free(a);
+  return QIO_ENOMEM;
+}
+
+// Wait for and discard all outstanding read-ahead.
+static
+void _readahead_drain(struct qio_channel_async_s* a)
+{
+  while( a->ra_count > 0 ) {
+    qio_readahead_t* r = &a->ra[a->ra_head];
+    qio_async_wait(&r->job);
+    qbytes_release(r->bytes);
+    r->bytes = NULL;
+    a->ra_head = (a->ra_head + 1) % a->depth;
+    a->ra_count--;
+  }
+}
+
+// Start reads of the iobufs after the ones in flight, up to the depth.
+static
+void _readahead_fill(qio_channel_t* ch)
+{
+  struct qio_channel_async_s* a = ch->async;
+
+  while( a->ra_count < a->depth && a->ra_next < ch->end_pos ) {
+    qio_readahead_t* r = &a->ra[(a->ra_head + a->ra_count) % a->depth];
+    if( qbytes_create_iobuf(&r->bytes) ) break; // just read less ahead
+    r->fd = ch->file->fd;
+    r->offset = a->ra_next;
+    r->len = r->bytes->len;
+    if( ch->end_pos - r->offset < r->len ) r->len = ch->end_pos - r->offset;
+    r->job.fn = _readahead_job;
+    qio_async_submit(&r->job);
+    a->ra_next += r->len;
+    a->ra_count++;
+  }
+}
+
+// Like the loop in _buffered_read_atleast, but takes the data from
+// read-ahead requests.  The channel buffer must end at av_end.
+static
+qioerr _buffered_readahead_atleast(qio_channel_t* ch, int64_t amt)
+{
+  struct qio_channel_async_s* a = ch->async;
+  int64_t got = 0;
+  qioerr err = 0;
+
+  while( got < amt ) {
+    qio_readahead_t* r;
+
+    // After a seek or a short read the requests in flight are for the
+    // wrong place, so start over at av_end.
+    if( a->ra_count == 0 || a->ra[a->ra_head].offset != ch->av_end ) {
+      _readahead_drain(a);
+      a->ra_next = ch->av_end;
+    }
+    _readahead_fill(ch);
+    if( a->ra_count == 0 ) {
+      QIO_GET_CONSTANT_ERROR(err, ENOMEM, "could not start read-ahead");
+      if( ch->av_end >= ch->end_pos ) err = QIO_EEOF;
+      break;
+    }
+
+    r = &a->ra[a->ra_head];
+    {
+      int64_t t0 = _qio_stats_start();
+      qio_async_wait(&r->job);
+      _qio_stats_read(ch, t0, r->err ? 0 : r->nread);
+    }
+    a->ra_head = (a->ra_head + 1) % a->depth;
+    a->ra_count--;
+
+    if( r->err ) {
+      err = qio_int_to_err(r->err);
+    } else if( r->nread == 0 ) {
+      err = QIO_EEOF;
+    } else {
+      err = qbuffer_append(&ch->buf, r->bytes, 0, r->nread);
+      if( ! err ) {
+        ch->av_end += r->nread;
+        got += r->nread;
+      }
+    }
+    qbytes_release(r->bytes);
+    r->bytes = NULL;
+
+    if( err ) break;
+  }
+
+  // Keep reading ahead while the caller works on this data.
+  if( ! err ) _readahead_fill(ch);
+
+  return err;
+}
+
+// Wait for the oldest write-behind request and note any error.
+static
+void _writebehind_finish_one(struct qio_channel_async_s* a)
+{
+  qio_writebehind_t* w = &a->wb[a->wb_head];
+  size_t i;
+
+  qio_async_wait(&w->job);
+  if( w->err && ! a->wb_err ) a->wb_err = qio_int_to_err(w->err);
+  for( i = 0; i < w->iovcnt; i++ ) qbytes_release(w->bytes[i]);
+  qio_free(w->bytes);
+  qio_free(w->iov);
+  w->bytes = NULL;
+  w->iov = NULL;
+  a->wb_head = (a->wb_head + 1) % a->depth;
+  a->wb_count--;
+}
+
+// Wait for all write-behind and return (and clear) the first error.
+static
+qioerr _writebehind_drain(struct qio_channel_async_s* a)
+{
+  qioerr err;
+
+  while( a->wb_count > 0 ) _writebehind_finish_one(a);
+  err = a->wb_err;
+  a->wb_err = 0;
+  return err;
+}
+
+// Start writing the part of the buffer between start and end in the
+// background.  The request holds references to the qbytes, so the
+// caller can trim them from the buffer right away.
+static
+qioerr _writebehind_submit(qio_channel_t* ch,
+                           qbuffer_iter_t start, qbuffer_iter_t end)
+{
+  struct qio_channel_async_s* a = ch->async;
+  ssize_t num_parts = qbuffer_iter_num_parts(start, end);
+  qio_writebehind_t* w;
+  qioerr err;
+  size_t i;
+  int64_t t0 = _qio_stats_start();
+
+  // Only waiting here blocks the channel; count it as write time.
+  if( a->wb_count == a->depth ) _writebehind_finish_one(a);
+
+  // Report an earlier failure rather than writing past it.
+  if( a->wb_err ) {
+    err = a->wb_err;
+    a->wb_err = 0;
+    return err;
+  }
+
+  if( num_parts < 0 ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "negative count");
+  }
+
+  w = &a->wb[(a->wb_head + a->wb_count) % a->depth];
+  w->iov = (struct iovec*) qio_calloc(num_parts + 1, sizeof(struct iovec));
+  w->bytes = (qbytes_t**) qio_calloc(num_parts + 1, sizeof(qbytes_t*));
+  if( ! w->iov || ! w->bytes ) {
+    err = QIO_ENOMEM;
+    goto error;
+  }
+
+  err = qbuffer_to_iov(&ch->buf, start, end, num_parts + 1,
+                       w->iov, w->bytes, &w->iovcnt);
+  if( err ) goto error;
+
+  for( i = 0; i < w->iovcnt; i++ ) qbytes_retain(w->bytes[i]);
+
+  w->fd = ch->file->fd;
+  w->offset = start.offset;
+  w->job.fn = _writebehind_job;
+  qio_async_submit(&w->job);
+  a->wb_count++;
+
+  _qio_stats_write(ch, t0, qbuffer_iter_num_bytes(start, end));
+
+  return 0;
+
+error:
+  if( w->iov ) qio_free(w->iov);
+  if( w->bytes ) qio_free(w->bytes);
+  w->iov = NULL;
+  w->bytes = NULL;
+  return err;
+}
+
+// Finish all background I/O for a channel and free its state.
+static
+qioerr _qio_channel_async_destroy(qio_channel_t* ch)
+{
+  struct qio_channel_async_s* a = ch->async;
+  qioerr err;
+
+  if( ! a ) return 0;
+
+  if( a->ra ) _readahead_drain(a);
+  err = 0;
+  if( a->wb ) err = _writebehind_drain(a);
+
+  if( a->ra ) qio_free(a->ra);
+  if( a->wb ) qio_free(a->wb);
+  qio_free(a);
+  ch->async = NULL;
+
+  return err;
+}
+
 // Runs read or pread, whichever is appropriate,
 // to read into the buffer.
 static
@@ -2228,7 +3039,19 @@ qioerr _buffered_read_atleast(qio_channel_t* ch, int64_t amt)
   }
 
   if (ch->chan_info) {
-    return chpl_qio_read_atleast(ch->chan_info, amt);
+    err = PLUGIN_CALL(ch->file, read_atleast, ch->chan_info, amt);
+    if( ! err && return_eof ) err = QIO_EEOF;
+    return err;
+  }
+
+  if( qio_stats_enabled() ) ch->stats.refills++;
+
+  if( ch->async && ch->async->ra &&
+      ch->av_end == qbuffer_end_offset(&ch->buf) ) {
+    err = _buffered_readahead_atleast(ch, amt);
+    if( err ) return err;
+    if( return_eof ) return QIO_EEOF;
+    else return 0;
   }
 
   //printf("Allocating bufferspace %lli\n", (long long int) amt);
@@ -2239,6 +3062,8 @@ qioerr _buffered_read_atleast(qio_channel_t* ch, int64_t amt)
 
   left = amt;
   while(left > 0) {
+    int64_t t0;
+
     read_end = read_start;
     qbuffer_iter_advance(&ch->buf, &read_end, left);
 
@@ -2247,16 +3072,26 @@ qioerr _buffered_read_atleast(qio_channel_t* ch, int64_t amt)
 
     QIO_GET_CONSTANT_ERROR(err, EINVAL, "read method not implemented");
     num_read = 0;
+    t0 = _qio_stats_start();
     switch (method) {
       case QIO_METHOD_READWRITE:
-        err = qio_readv(ch->file, &ch->buf, read_start, read_end, &num_read);
+        if( ch->file->hints & QIO_HINT_DIRECT )
+          err = _qio_direct_iov(ch->file, method, 0, &ch->buf, read_start, read_end, read_start.offset, &num_read);
+        else
+          err = qio_readv(ch->file, &ch->buf, read_start, read_end, &num_read);
         break;
       case QIO_METHOD_PREADPWRITE:
-        err = qio_preadv(ch->file, &ch->buf, read_start, read_end, read_start.offset, &num_read);
+        if( ch->file->hints & QIO_HINT_DIRECT )
+          err = _qio_direct_iov(ch->file, method, 0, &ch->buf, read_start, read_end, read_start.offset, &num_read);
+        else
+          err = qio_preadv(ch->file, &ch->buf, read_start, read_end, read_start.offset, &num_read);
         break;
       case QIO_METHOD_FREADFWRITE:
         err = qio_freadv(ch->file->fp, &ch->buf, read_start, read_end, &num_read);
         break;
+      case QIO_METHOD_URING:
+        err = qio_uring_preadv(ch->file, &ch->buf, read_start, read_end, read_start.offset, &num_read);
+        break;
       case QIO_METHOD_MMAP:
       case QIO_METHOD_MEMORY:
         // should've been handled outside this method!
@@ -2264,6 +3099,7 @@ qioerr _buffered_read_atleast(qio_channel_t* ch, int64_t amt)
         break;
       // no default to get warnings when new methods are added
     }
+    _qio_stats_read(ch, t0, num_read);
 
     left -= num_read;
     qbuffer_iter_advance(&ch->buf, &read_start, num_read);
@@ -2655,28 +3491,54 @@ qioerr _qio_buffered_behind(qio_channel_t* ch, int flushall)
   //debug_print_qbuffer(&ch->buf);
 
   if (ch->chan_info && (ch->flags & QIO_FDFLAG_WRITEABLE)) {
-    return chpl_qio_write(ch->chan_info, nbytes);
+    return PLUGIN_CALL(ch->file, write, ch->chan_info, nbytes);
   }
 
-  if(ch->hints & QIO_HINT_DIRECT) {
-    // Round out the data to write to the end of the current chunk.
-    qbuffer_iter_ceil_part(&ch->buf, &write_end);
+  if( qio_stats_enabled() && (ch->flags & QIO_FDFLAG_WRITEABLE) )
+    ch->stats.flushes++;
+
+  if( ch->async && ch->async->wb ) {
+    if( ! flushall ) {
+      // Write these chunks in the background.
+      err = _writebehind_submit(ch, write_start, write_end);
+      if( err ) goto error;
+      write_start = write_end;
+    } else {
+      // Writing everything; finish the background writes first so
+      // any error from them is reported by this flush.
+      err = _writebehind_drain(ch->async);
+      if( err ) goto error;
+    }
   }
 
   if(ch->flags & QIO_FDFLAG_WRITEABLE) {
     while( qbuffer_iter_num_bytes(write_start, write_end) > 0 ) {
+      int64_t t0 = 0;
+
       QIO_GET_CONSTANT_ERROR(err, EINVAL, "write method not implemented");
       num_written = 0;
+      // (mmap and memory channels don't make system calls here)
+      if( method != QIO_METHOD_MMAP && method != QIO_METHOD_MEMORY )
+        t0 = _qio_stats_start();
       switch (method) {
         case QIO_METHOD_READWRITE:
-          err = qio_writev(ch->file, &ch->buf, write_start, write_end, &num_written);
+          if( ch->file->hints & QIO_HINT_DIRECT )
+            err = _qio_direct_iov(ch->file, method, 1, &ch->buf, write_start, write_end, write_start.offset, &num_written);
+          else
+            err = qio_writev(ch->file, &ch->buf, write_start, write_end, &num_written);
           break;
         case QIO_METHOD_PREADPWRITE:
-          err = qio_pwritev(ch->file, &ch->buf, write_start, write_end, write_start.offset, &num_written);
+          if( ch->file->hints & QIO_HINT_DIRECT )
+            err = _qio_direct_iov(ch->file, method, 1, &ch->buf, write_start, write_end, write_start.offset, &num_written);
+          else
+            err = qio_pwritev(ch->file, &ch->buf, write_start, write_end, write_start.offset, &num_written);
           break;
         case QIO_METHOD_FREADFWRITE:
           err = qio_fwritev(ch->file->fp, &ch->buf, write_start, write_end, &num_written);
           break;
+        case QIO_METHOD_URING:
+          err = qio_uring_pwritev(ch->file, &ch->buf, write_start, write_end, write_start.offset, &num_written);
+          break;
         case QIO_METHOD_MMAP:
         case QIO_METHOD_MEMORY:
           // do nothing; mmap already puts data.
@@ -2686,6 +3548,7 @@ qioerr _qio_buffered_behind(qio_channel_t* ch, int flushall)
           break;
         // no default to get warnings when new methods are added
       }
+      _qio_stats_write(ch, t0, num_written);
       qbuffer_iter_advance(&ch->buf, &write_start, num_written);
 
       // Ignore interrupted system call, just keep writing.
@@ -2902,16 +3765,29 @@ qioerr _qio_unbuffered_write(qio_channel_t* ch, const void* ptr, ssize_t len_in,
     _add_right_mark_start(ch, len);
   } else {
     while( len > 0 ) {
+      int64_t t0 = _qio_stats_start();
+
       QIO_GET_CONSTANT_ERROR(err, EINVAL, "write method not implemented");
       num_written = 0;
       switch (method) {
         case QIO_METHOD_READWRITE:
-          err = qio_int_to_err(sys_write(ch->file->fd, ptr, len, &num_written));
+          if( ch->hints & QIO_HINT_TASKLINEBUF )
+            err = qio_int_to_err(qio_linebuf_write(ch->file->fd, ptr, len, &num_written));
+          else if( ch->file->hints & QIO_HINT_DIRECT )
+            err = qio_int_to_err(_qio_direct_rw(ch->file, 1, (void*) ptr, len, _right_mark_start(ch), &num_written));
+          else
+            err = qio_int_to_err(sys_write(ch->file->fd, ptr, len, &num_written));
           break;
         case QIO_METHOD_MMAP: // mmap uses pread/pwrite when we're
                               // outside the mmap'd region.
         case QIO_METHOD_PREADPWRITE:
-          err = qio_int_to_err(sys_pwrite(ch->file->fd, ptr, len, _right_mark_start(ch), &num_written));
+          if( ch->file->hints & QIO_HINT_DIRECT )
+            err = qio_int_to_err(_qio_direct_pwrite(ch->file, ptr, len, _right_mark_start(ch), &num_written));
+          else
+            err = qio_int_to_err(sys_pwrite(ch->file->fd, ptr, len, _right_mark_start(ch), &num_written));
+          break;
+        case QIO_METHOD_URING:
+          err = qio_int_to_err(qio_uring_pwrite(ch->file->fd, ptr, len, _right_mark_start(ch), &num_written));
           break;
         case QIO_METHOD_FREADFWRITE:
           if( ch->file->fp ) {
@@ -2947,6 +3823,7 @@ qioerr _qio_unbuffered_write(qio_channel_t* ch, const void* ptr, ssize_t len_in,
           break;
         // no default to get warnings when new methods are added
       }
+      _qio_stats_write(ch, t0, num_written);
       if( err ) {
         *amt_written = num_written + len_in - len;
         return err;
@@ -2997,15 +3874,26 @@ qioerr _qio_unbuffered_read(qio_channel_t* ch, void* ptr, ssize_t len_in, ssize_
     _add_right_mark_start(ch, len);
   } else {
     while( len > 0 ) {
+      int64_t t0 = _qio_stats_start();
+
       QIO_GET_CONSTANT_ERROR(err, EINVAL, "read method not implemented");
       num_read = 0;
       switch (method) {
         case QIO_METHOD_READWRITE:
-          err = qio_int_to_err(sys_read(ch->file->fd, ptr, len, &num_read));
+          if( ch->file->hints & QIO_HINT_DIRECT )
+            err = qio_int_to_err(_qio_direct_rw(ch->file, 0, ptr, len, _right_mark_start(ch), &num_read));
+          else
+            err = qio_int_to_err(sys_read(ch->file->fd, ptr, len, &num_read));
           break;
         case QIO_METHOD_MMAP:
         case QIO_METHOD_PREADPWRITE:
-          err = qio_int_to_err(sys_pread(ch->file->fd, ptr, len, _right_mark_start(ch), &num_read));
+          if( ch->file->hints & QIO_HINT_DIRECT )
+            err = qio_int_to_err(_qio_direct_pread(ch->file, ptr, len, _right_mark_start(ch), &num_read));
+          else
+            err = qio_int_to_err(sys_pread(ch->file->fd, ptr, len, _right_mark_start(ch), &num_read));
+          break;
+        case QIO_METHOD_URING:
+          err = qio_int_to_err(qio_uring_pread(ch->file->fd, ptr, len, _right_mark_start(ch), &num_read));
           break;
         case QIO_METHOD_FREADFWRITE:
           if( ch->file->fp ) {
@@ -3039,6 +3927,7 @@ qioerr _qio_unbuffered_read(qio_channel_t* ch, void* ptr, ssize_t len_in, ssize_
           break;
         // no default to get warnings when new methods are added
       }
+      _qio_stats_read(ch, t0, num_read);
       // Return early on an error or on EOF.
       if( err ) {
         *amt_read = num_read + len_in - len;
@@ -3078,6 +3967,12 @@ qioerr _qio_channel_flush_qio_unlocked(qio_channel_t* ch)
     if( err ) return err;
   }
 
+  // Write out this task's lines for stdout/stderr.
+  if( ch->hints & QIO_HINT_TASKLINEBUF ) {
+    err = qio_int_to_err(qio_linebuf_flush(ch->file->fd));
+    if( err ) return err;
+  }
+
   // If there was an error saved earlier, report it now.
   // We don't report EILSEQ, EEOF, or EFORMAT on a flush.
   saved_err = qio_channel_error(ch);
@@ -3192,6 +4087,29 @@ qioerr qio_channel_offset(const int threadsafe, qio_channel_t* ch, int64_t* offs
   return 0;
 }
 
+qioerr qio_channel_get_stats(const int threadsafe, qio_channel_t* ch, qio_io_stats_t* stats_out)
+{
+  qioerr err;
+
+  if( threadsafe ) {
+    err = qio_lock(&ch->lock);
+    if( err ) return err;
+  }
+
+  *stats_out = ch->stats;
+
+  if( threadsafe ) {
+    qio_unlock(&ch->lock);
+  }
+
+  return 0;
+}
+
+void qio_file_get_stats(qio_file_t* f, qio_io_stats_t* stats_out)
+{
+  qio_stats_get(&f->stats, stats_out);
+}
+
 qioerr qio_channel_end_offset(const int threadsafe, qio_channel_t* ch, int64_t* offset_out)
 {
   qioerr err;
@@ -3425,7 +4343,9 @@ qioerr _qio_channel_put_buffer_unlocked(qio_channel_t* ch, qbuffer_t* src, qbuff
 
   // Now, copy data from src_buffer in as long as there's
   // buffer area to copy in to.
+  // (the mmap area can extend well past what we're putting)
   copylen = ch->av_end - _right_mark_start(ch);
+  if( copylen > use_len ) copylen = use_len;
   if( copylen > 0 ) {
     src_copy_end = src_start;
     qbuffer_iter_advance(src, &src_copy_end, copylen);
@@ -3502,6 +4422,311 @@ qioerr qio_channel_put_buffer(const int threadsafe, qio_channel_t* ch, qbuffer_t
   return err;
 }
 
+// Can the kernel move data for this channel directly on its fd?
+// We need an fd-based method whose position is fully described by
+// the channel's right mark (no plugin, marks, bits or readahead in
+// flight).
+static
+int _qio_transfer_kernel_ok(qio_channel_t* ch)
+{
+  qio_method_t method = (qio_method_t) (ch->hints & QIO_METHODMASK);
+
+  if( ch->chan_info != NULL || ch->async != NULL ) return 0;
+  if( ch->file == NULL || ch->file->fd == -1 ||
+      ch->file->file_info != NULL ) return 0;
+  if( ch->file->hints & QIO_HINT_DIRECT ) return 0;
+  if( ch->mark_cur != 0 || ch->bit_buffer_bits != 0 ) return 0;
+
+  return method == QIO_METHOD_READWRITE ||
+         method == QIO_METHOD_PREADPWRITE ||
+         method == QIO_METHOD_URING;
+}
+
+// Drop any buffered data and move a channel to pos. Only used
+// once the channel buffer holds nothing we still need.
+static
+void _qio_channel_transfer_reposition(qio_channel_t* ch, int64_t pos)
+{
+  if( qbuffer_is_initialized(&ch->buf) ) {
+    int64_t trim_bytes;
+
+    _qio_buffered_advance_cached(ch);
+    trim_bytes = qbuffer_end_offset(&ch->buf) - qbuffer_start_offset(&ch->buf);
+    qbuffer_trim_back(&ch->buf, trim_bytes);
+    qbuffer_reposition(&ch->buf, pos);
+  }
+
+  _set_right_mark_start(ch, pos);
+  ch->av_end = pos;
+}
+
+#ifdef __linux__
+enum {
+  QIO_TRANSFER_COPY_FILE_RANGE = 0,
+  QIO_TRANSFER_SENDFILE,
+  QIO_TRANSFER_SPLICE,
+  QIO_TRANSFER_NONE
+};
+
+// Errors meaning "this kind of fd doesn't support that call",
+// as opposed to a real I/O error.
+static
+int _qio_transfer_unsupported(int errcode)
+{
+  return errcode == EINVAL || errcode == ENOSYS || errcode == EXDEV ||
+         errcode == EOPNOTSUPP || errcode == ENOTSUP ||
+         errcode == ESPIPE || errcode == EBADF;
+}
+
+// Move up to len bytes from src's fd to dst's fd with
+// copy_file_range, sendfile or splice, trying them in that order.
+// Sets *handled_out to 0 if none of them works for these fds,
+// in which case nothing was moved.
+static
+qioerr _qio_channel_transfer_kernel(qio_channel_t* dst, qio_channel_t* src,
+                                    int64_t len, int64_t* amt_out,
+                                    int* eof_out, int* handled_out)
+{
+  qio_method_t src_method = (qio_method_t) (src->hints & QIO_METHODMASK);
+  qio_method_t dst_method = (qio_method_t) (dst->hints & QIO_METHODMASK);
+  // READWRITE channels use (and advance) the fd offset, so we let the
+  // kernel do the same for them; the others pass explicit offsets.
+  loff_t in_off = _right_mark_start(src);
+  loff_t out_off = _right_mark_start(dst);
+  loff_t* in_p = (src_method == QIO_METHOD_READWRITE) ? NULL : &in_off;
+  loff_t* out_p = (dst_method == QIO_METHOD_READWRITE) ? NULL : &out_off;
+  int use = QIO_TRANSFER_COPY_FILE_RANGE;
+  int64_t total = 0;
+  qioerr err = 0;
+
+  *eof_out = 0;
+  *handled_out = 1;
+
+  while( total < len && use != QIO_TRANSFER_NONE ) {
+    size_t chunk = len - total;
+    ssize_t got = -1;
+    int64_t t0;
+    int errcode;
+
+    if( chunk > (1 << 30) ) chunk = 1 << 30;
+
+    errno = ENOSYS;
+    t0 = _qio_stats_start();
+    STARTING_SLOW_SYSCALL;
+    switch( use ) {
+      case QIO_TRANSFER_COPY_FILE_RANGE:
+#ifdef SYS_copy_file_range
+        got = syscall(SYS_copy_file_range, src->file->fd, in_p,
+                      dst->file->fd, out_p, chunk, 0);
+#endif
+        break;
+      case QIO_TRANSFER_SENDFILE:
+        // sendfile always writes at the output fd offset.
+        if( out_p == NULL ) {
+          off_t sf_off = in_off;
+          got = sendfile(dst->file->fd, src->file->fd,
+                         in_p ? &sf_off : NULL, chunk);
+          if( got > 0 && in_p ) in_off = sf_off;
+        }
+        break;
+      case QIO_TRANSFER_SPLICE:
+        got = splice(src->file->fd, in_p, dst->file->fd, out_p, chunk,
+                     SPLICE_F_MOVE);
+        break;
+    }
+    errcode = errno;
+    DONE_SLOW_SYSCALL;
+
+    if( got < 0 ) {
+      if( errcode == EINTR ) continue;
+      if( total == 0 && _qio_transfer_unsupported(errcode) ) {
+        use++;
+        continue;
+      }
+      err = qio_int_to_err(errcode);
+      break;
+    }
+
+    if( got == 0 ) {
+      // Some kernels return 0 from copy_file_range for files they
+      // can't copy (e.g. procfs), so let sendfile confirm an EOF.
+      if( total == 0 && use == QIO_TRANSFER_COPY_FILE_RANGE ) {
+        use++;
+        continue;
+      }
+      *eof_out = 1;
+      break;
+    }
+
+    // The time goes to the reading side only.
+    _qio_stats_read(src, t0, got);
+    if( t0 ) {
+      dst->stats.write_calls++;
+      dst->stats.bytes_written += got;
+    }
+
+    total += got;
+    if( in_p == NULL ) in_off += got;
+    if( out_p == NULL ) out_off += got;
+  }
+
+  if( use == QIO_TRANSFER_NONE ) {
+    *handled_out = 0;
+    total = 0;
+    in_off = _right_mark_start(src);
+    out_off = _right_mark_start(dst);
+  }
+
+  if( total > 0 || *eof_out ) {
+    _qio_channel_transfer_reposition(src, in_off);
+    _qio_channel_transfer_reposition(dst, out_off);
+  }
+
+  *amt_out = total;
+  return err;
+}
+#endif
+
+static
+qioerr _qio_channel_transfer_unlocked(qio_channel_t* dst, qio_channel_t* src,
+                                      int64_t len, int64_t* amt_out)
+{
+  int64_t remaining = (len < 0) ? INT64_MAX : len;
+  int64_t total = 0;
+  int eof = 0;
+  qioerr err = 0;
+
+  // Limit the transfer to the region both channels cover.
+  if( src->end_pos - _right_mark_start(src) < remaining )
+    remaining = src->end_pos - _right_mark_start(src);
+
+  while( remaining > 0 ) {
+    qbuffer_iter_t start, end;
+    int64_t avail, dst_before, put;
+
+    // First hand over whatever the source has buffered by sharing
+    // its iobufs (or mmap'd bytes) with the destination.
+    err = _qio_channel_needbuffer_unlocked(src);
+    if( err ) break;
+    _qio_buffered_advance_cached(src);
+
+    avail = src->av_end - _right_mark_start(src);
+    if( avail > 0 ) {
+      if( avail > remaining ) avail = remaining;
+
+      start = _right_mark_start_iter(src);
+      end = start;
+      qbuffer_iter_advance(&src->buf, &end, avail);
+
+      dst_before = _right_mark_start(dst);
+      err = _qio_channel_put_buffer_unlocked(dst, &src->buf, start, end);
+      if( err ) break;
+      put = _right_mark_start(dst) - dst_before;
+
+      err = qio_channel_advance_unlocked(src, put);
+      if( err ) break;
+
+      total += put;
+      remaining -= put;
+      // put_buffer stops at the destination's end_pos.
+      if( put < avail ) break;
+      continue;
+    }
+
+#ifdef __linux__
+    // The source buffer is empty; see if the kernel can move the
+    // rest without it passing through user space.
+    if( _qio_transfer_kernel_ok(src) && _qio_transfer_kernel_ok(dst) ) {
+      int64_t moved = 0;
+      int64_t room = dst->end_pos - _right_mark_start(dst);
+      int handled = 0;
+
+      err = _qio_channel_flush_qio_unlocked(dst);
+      if( err ) break;
+
+      if( room < remaining ) remaining = room;
+      if( remaining <= 0 ) break;
+
+      err = _qio_channel_transfer_kernel(dst, src, remaining,
+                                         &moved, &eof, &handled);
+      total += moved;
+      remaining -= moved;
+      if( err || eof ) break;
+      if( handled ) continue;
+    }
+#endif
+
+    // Otherwise read some more into the source buffer.
+    err = _qio_channel_require_unlocked(src,
+                                        remaining < (int64_t) qbytes_iobuf_size ?
+                                        remaining : (int64_t) qbytes_iobuf_size,
+                                        false);
+    if( qio_err_to_int(err) == EEOF ) {
+      err = 0;
+      if( src->av_end - _right_mark_start(src) <= 0 ) {
+        eof = 1;
+        break;
+      }
+    }
+    if( err ) break;
+  }
+
+  if( eof ) {
+    // Make the EOF sticky, as qio_channel_read does.
+    src->end_pos = src->av_end;
+  }
+
+  *amt_out = total;
+
+  if( !err && len >= 0 && total < len ) err = QIO_EEOF;
+  return err;
+}
+
+qioerr qio_channel_transfer(const int threadsafe, qio_channel_t* dst, qio_channel_t* src, int64_t len, int64_t* amt_out)
+{
+  qioerr err;
+  qio_channel_t* first;
+  qio_channel_t* second;
+
+  *amt_out = 0;
+
+  if( dst == src )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "cannot transfer a channel to itself");
+  if( ! (src->flags & QIO_FDFLAG_READABLE) )
+    QIO_RETURN_CONSTANT_ERROR(EBADF, "not readable");
+  if( ! (dst->flags & QIO_FDFLAG_WRITEABLE) )
+    QIO_RETURN_CONSTANT_ERROR(EBADF, "not writeable");
+
+  // Lock in address order so two transfers in opposite
+  // directions can't deadlock.
+  first = (dst < src) ? dst : src;
+  second = (dst < src) ? src : dst;
+
+  if( threadsafe ) {
+    err = qio_lock(&first->lock);
+    if( err ) return err;
+    err = qio_lock(&second->lock);
+    if( err ) {
+      qio_unlock(&first->lock);
+      return err;
+    }
+  }
+
+  // clear out any bits.
+  src->bit_buffer = 0;
+  src->bit_buffer_bits = 0;
+  err = _qio_flush_bits_if_needed_unlocked(dst);
+
+  if( !err ) err = _qio_channel_transfer_unlocked(dst, src, len, amt_out);
+
+  if( threadsafe ) {
+    qio_unlock(&second->lock);
+    qio_unlock(&first->lock);
+  }
+
+  return err;
+}
+
 // you don't have to call end_peek_buffer if this returns an error
 qioerr qio_channel_begin_peek_buffer(const int threadsafe, qio_channel_t* ch, int64_t require, int writing, qbuffer_t** buf_out, qbuffer_iter_t* start_out, qbuffer_iter_t* end_out)
 {
@@ -4388,6 +5613,37 @@ qioerr qio_get_fs_type(qio_file_t* fl, int* out)
   return 0;
 }
 
+qioerr qio_file_is_shared_fs(qio_file_t* fl, int* shared_out)
+{
+  sys_statfs_t s;
+  int rc = 1;
+
+  *shared_out = 0;
+
+  if (fl->fp)
+    rc = sys_fstatfs(fileno(fl->fp), &s);
+  else if (fl->fd != -1)
+    rc = sys_fstatfs(fl->fd, &s);
+
+  if (rc != 0)
+    QIO_RETURN_CONSTANT_ERROR(ENOTSUP, "Unable to find file system type");
+
+  switch (s.f_type) {
+    case LUSTRE_SUPER_MAGIC:
+    case NFS_SUPER_MAGIC:
+    case GPFS_SUPER_MAGIC:
+    case CIFS_MAGIC_NUMBER:
+    case SMB2_MAGIC_NUMBER:
+    case CEPH_SUPER_MAGIC:
+      *shared_out = 1;
+      break;
+    default:
+      break;
+  }
+
+  return 0;
+}
+
 
 qioerr qio_get_chunk(qio_file_t* fl, int64_t* len_out)
 {
@@ -4398,7 +5654,7 @@ qioerr qio_get_chunk(qio_file_t* fl, int64_t* len_out)
   sys_statfs_t s;
 
   if (fl->file_info) {
-    err = chpl_qio_get_chunk(fl->file_info, len_out);
+    err = PLUGIN_CALL(fl, get_chunk, fl->file_info, len_out);
   } else {
     fd = fl->fd;
     if (fl->fp) fd = fileno(fl->fp);
@@ -4431,7 +5687,8 @@ qioerr qio_locales_for_region(qio_file_t* fl, off_t start, off_t end, const char
   qioerr err = 0;
   if (fl->file_info) {
     void* tmp = NULL;
-    err = chpl_qio_get_locales_for_region(fl->file_info, start, end, &tmp, num_locs_out);
+    err = PLUGIN_CALL(fl, get_locales_for_region,
+                      fl->file_info, start, end, &tmp, num_locs_out);
     *loc_names_out = (const char**) tmp;
     return err;
   } else {
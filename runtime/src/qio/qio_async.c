@@ -0,0 +1,154 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Background I/O threads for read-ahead and write-behind
+//
+#include "sys_basic.h"
+
+#ifndef CHPL_RT_UNIT_TEST
+#include "chplrt.h"
+#include "chpl-env.h"
+#include "chpl-tasks.h"
+#include "error.h"
+#endif
+
+#include "qio_async.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef CHPL_RT_UNIT_TEST
+#define ASYNC_YIELD() chpl_task_yield()
+#define ASYNC_ENV_INT(name, dflt) chpl_env_rt_get_int(name, dflt)
+#define ASYNC_FATAL(msg) chpl_internal_error(msg)
+#else
+#define ASYNC_YIELD() sched_yield()
+#define ASYNC_ENV_INT(name, dflt) (dflt)
+#define ASYNC_FATAL(msg) abort()
+#endif
+
+// After this many yields, a waiter also sleeps briefly between checks,
+// so that a lone task waiting on a slow disk doesn't spin a core.
+#define ASYNC_WAIT_SPINS 1000
+
+static pthread_once_t async_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t async_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t async_cond = PTHREAD_COND_INITIALIZER;
+static qio_async_job_t* async_head = NULL;
+static qio_async_job_t* async_tail = NULL;
+static int async_depth = 8;
+static int async_nthreads = 0;
+static int async_started = 0;
+
+static
+void async_setup(void)
+{
+  int64_t depth = ASYNC_ENV_INT("QIO_ASYNC_DEPTH", 8);
+  int64_t nthreads = ASYNC_ENV_INT("QIO_ASYNC_THREADS", 4);
+
+  if( depth < 0 ) depth = 0;
+  if( depth > 1024 ) depth = 1024;
+  if( nthreads < 1 ) nthreads = 1;
+  if( nthreads > 256 ) nthreads = 256;
+
+  async_depth = (int) depth;
+  async_nthreads = (int) nthreads;
+}
+
+int qio_async_depth(void)
+{
+  pthread_once(&async_once, async_setup);
+  return async_depth;
+}
+
+static
+void* async_thread(void* arg)
+{
+  while( 1 ) {
+    qio_async_job_t* job;
+
+    pthread_mutex_lock(&async_lock);
+    while( async_head == NULL ) {
+      pthread_cond_wait(&async_cond, &async_lock);
+    }
+    job = async_head;
+    async_head = job->next;
+    if( async_head == NULL ) async_tail = NULL;
+    pthread_mutex_unlock(&async_lock);
+
+    job->fn(job);
+    __atomic_store_n(&job->done, 1, __ATOMIC_RELEASE);
+  }
+
+  return NULL;
+}
+
+// Start the threads.  Call with async_lock held.
+static
+void async_start_locked(void)
+{
+  pthread_attr_t attr;
+  int i;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  for( i = 0; i < async_nthreads; i++ ) {
+    pthread_t thread;
+    if( pthread_create(&thread, &attr, async_thread, NULL) != 0 ) {
+      if( i == 0 ) ASYNC_FATAL("could not create qio async I/O thread");
+      break;
+    }
+  }
+  pthread_attr_destroy(&attr);
+
+  async_started = 1;
+}
+
+void qio_async_submit(qio_async_job_t* job)
+{
+  pthread_once(&async_once, async_setup);
+
+  job->next = NULL;
+  job->done = 0;
+
+  pthread_mutex_lock(&async_lock);
+  if( ! async_started ) async_start_locked();
+  if( async_tail ) async_tail->next = job;
+  else async_head = job;
+  async_tail = job;
+  pthread_cond_signal(&async_cond);
+  pthread_mutex_unlock(&async_lock);
+}
+
+void qio_async_wait(qio_async_job_t* job)
+{
+  int spins = 0;
+
+  while( ! __atomic_load_n(&job->done, __ATOMIC_ACQUIRE) ) {
+    ASYNC_YIELD();
+    if( ++spins >= ASYNC_WAIT_SPINS ) {
+      struct timespec ts = { 0, 50 * 1000 };
+      nanosleep(&ts, NULL);
+    }
+  }
+}
@@ -0,0 +1,1003 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sys_basic.h"
+
+#ifndef CHPL_RT_UNIT_TEST
+#include "chplrt.h"
+#endif
+
+#include "qio_compress.h"
+#include "qio_plugin_api.h"
+#include "qio_async.h"
+
+#include <string.h>
+#include <limits.h>
+
+#ifdef QIO_COMPRESS_ZLIB
+#include <zlib.h>
+#endif
+#ifdef QIO_COMPRESS_ZSTD
+#include <zstd.h>
+#ifndef ZSTD_CLEVEL_DEFAULT
+#define ZSTD_CLEVEL_DEFAULT 3
+#endif
+#endif
+#ifdef QIO_COMPRESS_LZ4
+#include <lz4frame.h>
+#endif
+
+// gzip member header: the fixed fields, then an extra field of
+// XLEN=12 holding one 'QZ' subfield of SLEN=8 with the compressed
+// (whole member) and uncompressed sizes.  The raw deflate data and
+// the usual CRC32/ISIZE trailer follow.
+#define GZ_HEADER_LEN 24
+#define GZ_TRAILER_LEN 8
+
+// zstd and lz4 blocks: a skippable frame holding the sizes
+// (compressed including this header, then uncompressed).
+#define SKIP_MAGIC 0x184D2A5BU
+#define SKIP_HEADER_LEN 16
+#define ZSTD_MAGIC 0xFD2FB528U
+#define LZ4_MAGIC 0x184D2204U
+
+// Enough of a block to parse its header and find its codec.
+#define PEEK_LEN 24
+
+typedef struct qio_cblock_s {
+  int64_t uoff;  // uncompressed offset of the block
+  int64_t coff;  // offset of its header in the base file
+  int64_t usize;
+  int64_t csize; // including header and trailer
+} qio_cblock_t;
+
+typedef struct qio_cfile_s {
+  qio_file_t* base;
+  fd_t fd;
+  int codec;
+  int level;
+  int64_t block_size;
+  int writing;
+
+  qio_lock_t lock; // protects the fields below while writing
+  qio_cblock_t* blocks;
+  int64_t nblocks;
+  int64_t blocks_cap;
+  int64_t ulen; // uncompressed bytes in finished blocks
+  int64_t clen; // bytes of the base file used
+  int has_writer;
+} qio_cfile_t;
+
+// One block being compressed or decompressed.
+typedef struct qio_cjob_s {
+  qio_async_job_t job; // must be first
+  int codec;
+  int level;
+  fd_t fd;
+  int64_t coff;
+  int64_t uoff;
+  int64_t usize;
+  int64_t csize;
+  int64_t ccap;
+  unsigned char* cbuf;
+  unsigned char* ubuf;
+  int64_t used; // reading: bytes of ubuf already given to the channel
+  err_t err;
+} qio_cjob_t;
+
+typedef struct qio_cchannel_s {
+  qio_cfile_t* cf;
+  qio_channel_t* ch;
+  int writing;
+  int async;
+  int depth;
+  // a ring of blocks in flight, oldest first
+  qio_cjob_t* jobs;
+  int head;
+  int count;
+  // reading: the next block to start
+  int64_t next_block;
+  // writing: the block being filled
+  unsigned char* fill;
+  int64_t fill_len;
+  qioerr err; // first error from a finished block
+} qio_cchannel_t;
+
+static inline
+uint32_t get_le32(const unsigned char* p)
+{
+  return (uint32_t) p[0] | ((uint32_t) p[1] << 8) |
+         ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static inline
+void put_le32(unsigned char* p, uint32_t v)
+{
+  p[0] = v & 0xff;
+  p[1] = (v >> 8) & 0xff;
+  p[2] = (v >> 16) & 0xff;
+  p[3] = (v >> 24) & 0xff;
+}
+
+int qio_compress_supported(int codec)
+{
+  switch( codec ) {
+#ifdef QIO_COMPRESS_ZLIB
+    case QIO_COMPRESS_GZIP:
+      return 1;
+#endif
+#ifdef QIO_COMPRESS_ZSTD
+    case QIO_COMPRESS_ZSTD:
+      return 1;
+#endif
+#ifdef QIO_COMPRESS_LZ4
+    case QIO_COMPRESS_LZ4:
+      return 1;
+#endif
+    default:
+      return 0;
+  }
+}
+
+// Find the codec and sizes of the block starting with hdr.
+static
+err_t parse_block_header(const unsigned char* hdr, ssize_t n,
+                         int* codec_out, int64_t* csize_out,
+                         int64_t* usize_out)
+{
+  int codec;
+  int64_t csize, usize, min_csize;
+
+  if( n >= GZ_HEADER_LEN && hdr[0] == 0x1f && hdr[1] == 0x8b ) {
+    if( hdr[2] != 8 || (hdr[3] & 4) == 0 ||
+        hdr[10] != 12 || hdr[11] != 0 ||
+        hdr[12] != 'Q' || hdr[13] != 'Z' ||
+        hdr[14] != 8 || hdr[15] != 0 )
+      return EFORMAT;
+    codec = QIO_COMPRESS_GZIP;
+    csize = get_le32(hdr + 16);
+    usize = get_le32(hdr + 20);
+    min_csize = GZ_HEADER_LEN + GZ_TRAILER_LEN;
+  } else if( n >= SKIP_HEADER_LEN + 4 &&
+             get_le32(hdr) == SKIP_MAGIC && get_le32(hdr + 4) == 8 ) {
+    uint32_t magic = get_le32(hdr + SKIP_HEADER_LEN);
+    if( magic == ZSTD_MAGIC ) codec = QIO_COMPRESS_ZSTD;
+    else if( magic == LZ4_MAGIC ) codec = QIO_COMPRESS_LZ4;
+    else return EFORMAT;
+    csize = get_le32(hdr + 8);
+    usize = get_le32(hdr + 12);
+    min_csize = SKIP_HEADER_LEN + 4;
+  } else {
+    return EFORMAT;
+  }
+
+  if( csize < min_csize || usize > QIO_COMPRESS_MAX_BLOCK ) return EFORMAT;
+
+  *codec_out = codec;
+  *csize_out = csize;
+  *usize_out = usize;
+  return 0;
+}
+
+// The most space a compressed block of usize bytes can take.
+static
+int64_t block_bound(int codec, int level, int64_t usize)
+{
+  switch( codec ) {
+#ifdef QIO_COMPRESS_ZLIB
+    case QIO_COMPRESS_GZIP:
+      return compressBound(usize) + GZ_HEADER_LEN + GZ_TRAILER_LEN;
+#endif
+#ifdef QIO_COMPRESS_ZSTD
+    case QIO_COMPRESS_ZSTD:
+      return ZSTD_compressBound(usize) + SKIP_HEADER_LEN;
+#endif
+#ifdef QIO_COMPRESS_LZ4
+    case QIO_COMPRESS_LZ4:
+    {
+      LZ4F_preferences_t prefs;
+      memset(&prefs, 0, sizeof(prefs));
+      prefs.compressionLevel = level;
+      prefs.frameInfo.contentSize = usize;
+      return LZ4F_compressFrameBound(usize, &prefs) + SKIP_HEADER_LEN;
+    }
+#endif
+    default:
+      return 0;
+  }
+}
+
+#if defined(QIO_COMPRESS_ZSTD) || defined(QIO_COMPRESS_LZ4)
+static
+void put_skip_header(qio_cjob_t* j)
+{
+  put_le32(j->cbuf, SKIP_MAGIC);
+  put_le32(j->cbuf + 4, 8);
+  put_le32(j->cbuf + 8, j->csize);
+  put_le32(j->cbuf + 12, j->usize);
+}
+#endif
+
+// Compress ubuf[usize] into cbuf, setting csize.
+static
+err_t compress_block(qio_cjob_t* j)
+{
+  switch( j->codec ) {
+#ifdef QIO_COMPRESS_ZLIB
+    case QIO_COMPRESS_GZIP:
+    {
+      z_stream zs;
+      unsigned char* p = j->cbuf;
+      uLong crc;
+      int rc;
+
+      memset(&zs, 0, sizeof(zs));
+      if( deflateInit2(&zs, j->level, Z_DEFLATED, -15, 8,
+                       Z_DEFAULT_STRATEGY) != Z_OK )
+        return ENOMEM;
+      zs.next_in = j->ubuf;
+      zs.avail_in = j->usize;
+      zs.next_out = p + GZ_HEADER_LEN;
+      zs.avail_out = j->ccap - GZ_HEADER_LEN - GZ_TRAILER_LEN;
+      rc = deflate(&zs, Z_FINISH);
+      j->csize = GZ_HEADER_LEN + zs.total_out + GZ_TRAILER_LEN;
+      deflateEnd(&zs);
+      if( rc != Z_STREAM_END ) return EINVAL;
+
+      crc = crc32(0L, j->ubuf, j->usize);
+
+      memset(p, 0, GZ_HEADER_LEN);
+      p[0] = 0x1f; p[1] = 0x8b;
+      p[2] = 8;    // deflate
+      p[3] = 4;    // FEXTRA
+      p[9] = 0xff; // unknown OS
+      p[10] = 12;  // XLEN
+      p[12] = 'Q'; p[13] = 'Z';
+      p[14] = 8;   // SLEN
+      put_le32(p + 16, j->csize);
+      put_le32(p + 20, j->usize);
+      put_le32(p + j->csize - 8, crc);
+      put_le32(p + j->csize - 4, j->usize);
+      return 0;
+    }
+#endif
+#ifdef QIO_COMPRESS_ZSTD
+    case QIO_COMPRESS_ZSTD:
+    {
+      size_t got = ZSTD_compress(j->cbuf + SKIP_HEADER_LEN,
+                                 j->ccap - SKIP_HEADER_LEN,
+                                 j->ubuf, j->usize, j->level);
+      if( ZSTD_isError(got) ) return EINVAL;
+      j->csize = SKIP_HEADER_LEN + got;
+      put_skip_header(j);
+      return 0;
+    }
+#endif
+#ifdef QIO_COMPRESS_LZ4
+    case QIO_COMPRESS_LZ4:
+    {
+      LZ4F_preferences_t prefs;
+      size_t got;
+
+      memset(&prefs, 0, sizeof(prefs));
+      prefs.compressionLevel = j->level;
+      prefs.frameInfo.contentSize = j->usize;
+      got = LZ4F_compressFrame(j->cbuf + SKIP_HEADER_LEN,
+                               j->ccap - SKIP_HEADER_LEN,
+                               j->ubuf, j->usize, &prefs);
+      if( LZ4F_isError(got) ) return EINVAL;
+      j->csize = SKIP_HEADER_LEN + got;
+      put_skip_header(j);
+      return 0;
+    }
+#endif
+    default:
+      return ENOSYS;
+  }
+}
+
+// Decompress cbuf[csize] into ubuf[usize].
+static
+err_t decompress_block(qio_cjob_t* j)
+{
+  switch( j->codec ) {
+#ifdef QIO_COMPRESS_ZLIB
+    case QIO_COMPRESS_GZIP:
+    {
+      z_stream zs;
+      const unsigned char* trailer = j->cbuf + j->csize - GZ_TRAILER_LEN;
+      int rc;
+
+      memset(&zs, 0, sizeof(zs));
+      if( inflateInit2(&zs, -15) != Z_OK ) return ENOMEM;
+      zs.next_in = j->cbuf + GZ_HEADER_LEN;
+      zs.avail_in = j->csize - GZ_HEADER_LEN - GZ_TRAILER_LEN;
+      zs.next_out = j->ubuf;
+      zs.avail_out = j->usize;
+      rc = inflate(&zs, Z_FINISH);
+      inflateEnd(&zs);
+      if( rc != Z_STREAM_END || zs.total_out != (uLong) j->usize )
+        return EFORMAT;
+      if( get_le32(trailer) != crc32(0L, j->ubuf, j->usize) ||
+          get_le32(trailer + 4) != (uint32_t) j->usize )
+        return EFORMAT;
+      return 0;
+    }
+#endif
+#ifdef QIO_COMPRESS_ZSTD
+    case QIO_COMPRESS_ZSTD:
+    {
+      size_t got = ZSTD_decompress(j->ubuf, j->usize,
+                                   j->cbuf + SKIP_HEADER_LEN,
+                                   j->csize - SKIP_HEADER_LEN);
+      if( ZSTD_isError(got) || got != (size_t) j->usize ) return EFORMAT;
+      return 0;
+    }
+#endif
+#ifdef QIO_COMPRESS_LZ4
+    case QIO_COMPRESS_LZ4:
+    {
+      LZ4F_decompressionContext_t dctx;
+      size_t in = SKIP_HEADER_LEN;
+      size_t out = 0;
+      err_t err = 0;
+
+      if( LZ4F_isError(LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION)) )
+        return ENOMEM;
+      while( 1 ) {
+        size_t dst_len = j->usize - out;
+        size_t src_len = j->csize - in;
+        size_t rc = LZ4F_decompress(dctx, j->ubuf + out, &dst_len,
+                                    j->cbuf + in, &src_len, NULL);
+        if( LZ4F_isError(rc) ) { err = EFORMAT; break; }
+        out += dst_len;
+        in += src_len;
+        if( rc == 0 ) break;
+        if( dst_len == 0 && src_len == 0 ) { err = EFORMAT; break; }
+      }
+      LZ4F_freeDecompressionContext(dctx);
+      if( ! err && out != (size_t) j->usize ) err = EFORMAT;
+      return err;
+    }
+#endif
+    default:
+      return ENOSYS;
+  }
+}
+
+static
+err_t pread_all(fd_t fd, void* buf, int64_t len, int64_t offset,
+                int64_t* nread_out)
+{
+  int64_t nread = 0;
+  err_t err = 0;
+
+  while( nread < len ) {
+    ssize_t got = 0;
+    err = sys_pread(fd, qio_ptr_add(buf, nread), len - nread,
+                    offset + nread, &got);
+    if( err == EINTR ) continue;
+    if( err == EEOF || (err == 0 && got == 0) ) {
+      err = 0;
+      break;
+    }
+    if( err ) break;
+    nread += got;
+  }
+
+  *nread_out = nread;
+  return err;
+}
+
+static
+err_t pwrite_all(fd_t fd, const void* buf, int64_t len, int64_t offset)
+{
+  int64_t done = 0;
+
+  while( done < len ) {
+    ssize_t got = 0;
+    err_t err = sys_pwrite(fd, (const char*) buf + done, len - done,
+                           offset + done, &got);
+    if( err == EINTR ) continue;
+    if( err ) return err;
+    done += got;
+  }
+  return 0;
+}
+
+static
+void _decompress_job(qio_async_job_t* job)
+{
+  qio_cjob_t* j = (qio_cjob_t*) job;
+  int64_t got = 0;
+
+  j->err = pread_all(j->fd, j->cbuf, j->csize, j->coff, &got);
+  if( ! j->err && got != j->csize ) j->err = EFORMAT; // truncated
+  if( ! j->err ) j->err = decompress_block(j);
+}
+
+static
+void _compress_job(qio_async_job_t* job)
+{
+  qio_cjob_t* j = (qio_cjob_t*) job;
+
+  j->err = compress_block(j);
+}
+
+static
+void start_job(qio_cchannel_t* cc, qio_cjob_t* j,
+               void (*fn)(qio_async_job_t*))
+{
+  j->job.fn = fn;
+  if( cc->async ) {
+    qio_async_submit(&j->job);
+  } else {
+    fn(&j->job);
+    j->job.done = 1;
+  }
+}
+
+static
+void free_job(qio_cjob_t* j)
+{
+  qio_free(j->cbuf);
+  qio_free(j->ubuf);
+  j->cbuf = NULL;
+  j->ubuf = NULL;
+}
+
+// Wait for the oldest block in flight; the caller removes it.
+static
+qio_cjob_t* wait_head(qio_cchannel_t* cc)
+{
+  qio_cjob_t* j = &cc->jobs[cc->head];
+  qio_async_wait(&j->job);
+  return j;
+}
+
+static
+void pop_head(qio_cchannel_t* cc)
+{
+  free_job(&cc->jobs[cc->head]);
+  cc->head = (cc->head + 1) % cc->depth;
+  cc->count--;
+}
+
+static
+void drain(qio_cchannel_t* cc)
+{
+  while( cc->count > 0 ) {
+    wait_head(cc);
+    pop_head(cc);
+  }
+}
+
+// The block holding uncompressed offset pos, or nblocks if none does.
+static
+int64_t find_block(qio_cfile_t* cf, int64_t pos)
+{
+  int64_t lo = 0;
+  int64_t hi = cf->nblocks;
+
+  while( lo < hi ) {
+    int64_t mid = lo + (hi - lo) / 2;
+    if( cf->blocks[mid].uoff + cf->blocks[mid].usize <= pos ) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+// Start decompressing blocks until the ring is full.
+static
+qioerr start_reads(qio_cchannel_t* cc)
+{
+  qio_cfile_t* cf = cc->cf;
+
+  while( cc->count < cc->depth && cc->next_block < cf->nblocks ) {
+    qio_cblock_t* b = &cf->blocks[cc->next_block];
+    qio_cjob_t* j = &cc->jobs[(cc->head + cc->count) % cc->depth];
+
+    // Stop at the end of the channel.
+    if( b->uoff >= cc->ch->end_pos ) break;
+
+    memset(j, 0, sizeof(*j));
+    j->codec = cf->codec;
+    j->fd = cf->fd;
+    j->coff = b->coff;
+    j->uoff = b->uoff;
+    j->usize = b->usize;
+    j->csize = b->csize;
+    j->cbuf = qio_malloc(b->csize);
+    j->ubuf = qio_malloc(b->usize ? b->usize : 1);
+    if( ! j->cbuf || ! j->ubuf ) {
+      free_job(j);
+      return QIO_ENOMEM;
+    }
+    cc->count++;
+    cc->next_block++;
+    start_job(cc, j, _decompress_job);
+  }
+  return 0;
+}
+
+static
+qioerr compress_read_atleast(void* plugin_ch, int64_t amt)
+{
+  qio_cchannel_t* cc = (qio_cchannel_t*) plugin_ch;
+  qio_cfile_t* cf = cc->cf;
+  qio_channel_t* ch = cc->ch;
+  int64_t got = 0;
+  qioerr err = 0;
+
+  if( cc->writing ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "channel is not readable");
+
+  // qio asks for 0 bytes when the channel is at its end.
+  if( ch->av_end >= ch->end_pos || ch->av_end >= cf->ulen ) return QIO_EEOF;
+
+  while( got < amt ) {
+    int64_t pos = ch->av_end;
+    int64_t b;
+    qio_cjob_t* j;
+    int64_t skip, len;
+
+    if( pos >= ch->end_pos ) return QIO_EEOF;
+
+    // Restart the ring if the channel moved away from it.
+    b = find_block(cf, pos);
+    if( b >= cf->nblocks ) return QIO_EEOF;
+    if( cc->count > 0 &&
+        cc->jobs[cc->head].uoff != cf->blocks[b].uoff ) {
+      drain(cc);
+    }
+    if( cc->count == 0 ) cc->next_block = b;
+
+    err = start_reads(cc);
+    if( err ) return err;
+
+    j = wait_head(cc);
+    if( j->err ) {
+      err = qio_int_to_err(j->err);
+      pop_head(cc);
+      return err;
+    }
+
+    skip = pos - j->uoff;
+    len = j->usize - skip;
+    if( len > ch->end_pos - pos ) len = ch->end_pos - pos;
+    if( len > SSIZE_MAX ) len = SSIZE_MAX;
+
+    err = qio_channel_copy_to_available_unlocked(ch, j->ubuf + skip, len);
+    got += ch->av_end - pos;
+    if( ch->av_end - j->uoff >= j->usize ) pop_head(cc);
+    if( err ) {
+      if( qio_err_to_int(err) == EEOF && got >= amt ) err = 0;
+      return err;
+    }
+    if( ch->av_end == pos ) break; // no buffer space
+  }
+
+  return 0;
+}
+
+// Write out the oldest block in flight and add it to the index.
+static
+qioerr finish_write(qio_cchannel_t* cc)
+{
+  qio_cfile_t* cf = cc->cf;
+  qio_cjob_t* j = wait_head(cc);
+  err_t err = j->err;
+  qioerr qerr;
+
+  if( ! err && ! cc->err ) {
+    err = pwrite_all(cf->fd, j->cbuf, j->csize, cf->clen);
+    if( ! err ) {
+      qerr = qio_lock(&cf->lock);
+      if( ! qerr ) {
+        if( cf->nblocks == cf->blocks_cap ) {
+          int64_t cap = cf->blocks_cap ? 2 * cf->blocks_cap : 64;
+          qio_cblock_t* blocks = qio_realloc(cf->blocks,
+                                             cap * sizeof(qio_cblock_t));
+          if( blocks ) {
+            cf->blocks = blocks;
+            cf->blocks_cap = cap;
+          }
+        }
+        if( cf->nblocks < cf->blocks_cap ) {
+          qio_cblock_t* b = &cf->blocks[cf->nblocks++];
+          b->uoff = cf->ulen;
+          b->coff = cf->clen;
+          b->usize = j->usize;
+          b->csize = j->csize;
+        }
+        cf->ulen += j->usize;
+        cf->clen += j->csize;
+        qio_unlock(&cf->lock);
+      } else if( ! cc->err ) {
+        cc->err = qerr;
+      }
+    }
+  }
+  if( err && ! cc->err ) cc->err = qio_int_to_err(err);
+
+  pop_head(cc);
+  return cc->err;
+}
+
+// Start compressing the block being filled.
+static
+qioerr submit_fill(qio_cchannel_t* cc)
+{
+  qio_cfile_t* cf = cc->cf;
+  qio_cjob_t* j;
+  int64_t ccap;
+  qioerr err;
+
+  if( cc->fill_len == 0 ) return 0;
+
+  if( cc->count == cc->depth ) {
+    err = finish_write(cc);
+    if( err ) return err;
+  }
+
+  ccap = block_bound(cf->codec, cf->level, cc->fill_len);
+  j = &cc->jobs[(cc->head + cc->count) % cc->depth];
+  memset(j, 0, sizeof(*j));
+  j->codec = cf->codec;
+  j->level = cf->level;
+  j->usize = cc->fill_len;
+  j->ccap = ccap;
+  j->cbuf = qio_malloc(ccap);
+  if( ! j->cbuf ) return QIO_ENOMEM;
+  j->ubuf = cc->fill;
+  cc->fill = NULL;
+  cc->fill_len = 0;
+  cc->count++;
+  start_job(cc, j, _compress_job);
+  return 0;
+}
+
+static
+qioerr compress_write(void* plugin_ch, int64_t amt)
+{
+  qio_cchannel_t* cc = (qio_cchannel_t*) plugin_ch;
+  qio_cfile_t* cf = cc->cf;
+  qioerr err;
+
+  if( ! cc->writing ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "channel is not writeable");
+  if( cc->err ) return cc->err;
+
+  while( amt > 0 ) {
+    ssize_t n, got = 0;
+
+    if( ! cc->fill ) {
+      cc->fill = qio_malloc(cf->block_size);
+      if( ! cc->fill ) return QIO_ENOMEM;
+    }
+
+    n = cf->block_size - cc->fill_len;
+    if( n > amt ) n = amt;
+    err = qio_channel_copy_from_buffered_unlocked(cc->ch,
+                                                  cc->fill + cc->fill_len,
+                                                  n, &got);
+    if( err ) return err;
+    if( got == 0 ) break;
+    cc->fill_len += got;
+    amt -= got;
+
+    if( cc->fill_len == cf->block_size ) {
+      err = submit_fill(cc);
+      if( err ) return err;
+    }
+  }
+
+  return 0;
+}
+
+static
+qioerr compress_channel_close(void* plugin_ch)
+{
+  qio_cchannel_t* cc = (qio_cchannel_t*) plugin_ch;
+  qio_cfile_t* cf = cc->cf;
+  qioerr err = 0;
+
+  if( cc->writing ) {
+    if( ! cc->err ) err = submit_fill(cc);
+    if( err && ! cc->err ) cc->err = err;
+    while( cc->count > 0 ) finish_write(cc);
+    err = cc->err;
+
+    if( ! qio_lock(&cf->lock) ) {
+      cf->has_writer = 0;
+      qio_unlock(&cf->lock);
+    }
+  } else {
+    drain(cc);
+  }
+
+  qio_free(cc->fill);
+  qio_free(cc->jobs);
+  qio_free(cc);
+  return err;
+}
+
+static
+qioerr compress_setup_channel(void* file, void** plugin_ch, int64_t start,
+                              int64_t end, qio_channel_t* qio_ch)
+{
+  qio_cfile_t* cf = (qio_cfile_t*) file;
+  qio_cchannel_t* cc;
+  qioerr err;
+  int writing = (qio_ch->flags & QIO_FDFLAG_WRITEABLE) != 0;
+
+  if( writing != cf->writing ) {
+    if( cf->writing ) {
+      QIO_RETURN_CONSTANT_ERROR(EINVAL, "compressed file is write-only");
+    } else {
+      QIO_RETURN_CONSTANT_ERROR(EINVAL, "compressed file is read-only");
+    }
+  }
+
+  if( writing ) {
+    err = qio_lock(&cf->lock);
+    if( err ) return err;
+    if( cf->has_writer || start != cf->ulen ) {
+      qio_unlock(&cf->lock);
+      QIO_RETURN_CONSTANT_ERROR(ESPIPE, "compressed files can only be appended to by one channel");
+    }
+    cf->has_writer = 1;
+    qio_unlock(&cf->lock);
+  }
+
+  cc = (qio_cchannel_t*) qio_calloc(1, sizeof(qio_cchannel_t));
+  if( ! cc ) {
+    err = QIO_ENOMEM;
+    goto error;
+  }
+  cc->cf = cf;
+  cc->ch = qio_ch;
+  cc->writing = writing;
+  cc->depth = qio_async_depth();
+  cc->async = cc->depth > 0;
+  if( cc->depth < 1 ) cc->depth = 1;
+  cc->jobs = (qio_cjob_t*) qio_calloc(cc->depth, sizeof(qio_cjob_t));
+  if( ! cc->jobs ) {
+    qio_free(cc);
+    err = QIO_ENOMEM;
+    goto error;
+  }
+
+  *plugin_ch = cc;
+  return 0;
+
+error:
+  if( writing && ! qio_lock(&cf->lock) ) {
+    cf->has_writer = 0;
+    qio_unlock(&cf->lock);
+  }
+  return err;
+}
+
+static
+qioerr compress_filelength(void* file, int64_t* length)
+{
+  qio_cfile_t* cf = (qio_cfile_t*) file;
+  qioerr err;
+
+  err = qio_lock(&cf->lock);
+  if( err ) return err;
+  *length = cf->ulen;
+  qio_unlock(&cf->lock);
+  return 0;
+}
+
+static
+qioerr compress_getpath(void* file, const char** str, int64_t* len)
+{
+  qio_cfile_t* cf = (qio_cfile_t*) file;
+  qioerr err;
+
+  err = qio_file_path(cf->base, str);
+  if( ! err ) *len = strlen(*str);
+  return err;
+}
+
+static
+qioerr compress_fsync(void* file)
+{
+  qio_cfile_t* cf = (qio_cfile_t*) file;
+  return qio_file_sync(cf->base);
+}
+
+static
+qioerr compress_get_chunk(void* file, int64_t* length)
+{
+  qio_cfile_t* cf = (qio_cfile_t*) file;
+  *length = cf->block_size;
+  return 0;
+}
+
+static
+qioerr compress_file_close(void* file)
+{
+  qio_cfile_t* cf = (qio_cfile_t*) file;
+
+  qio_file_release(cf->base);
+  qio_lock_destroy(&cf->lock);
+  qio_free(cf->blocks);
+  qio_free(cf);
+  return 0;
+}
+
+static const qio_plugin_ops_t compress_ops = {
+  compress_setup_channel,
+  compress_read_atleast,
+  compress_write,
+  compress_channel_close,
+  compress_filelength,
+  compress_getpath,
+  compress_fsync,
+  compress_get_chunk,
+  NULL, // get_locales_for_region
+  compress_file_close,
+};
+
+// Walk the block headers of the base file.
+static
+qioerr build_index(qio_cfile_t* cf, int codec)
+{
+  int64_t base_len = 0;
+  int64_t off = 0;
+  int64_t largest = 0;
+  qioerr err;
+
+  err = qio_file_length(cf->base, &base_len);
+  if( err ) return err;
+
+  while( off < base_len ) {
+    unsigned char hdr[PEEK_LEN];
+    int64_t got = 0;
+    int64_t csize = 0, usize = 0;
+    int got_codec = 0;
+    err_t e;
+
+    e = pread_all(cf->fd, hdr, PEEK_LEN, off, &got);
+    if( ! e ) e = parse_block_header(hdr, got, &got_codec, &csize, &usize);
+    if( ! e && off + csize > base_len ) e = EFORMAT; // truncated
+    if( e == EFORMAT ) {
+      QIO_RETURN_CONSTANT_ERROR(EFORMAT, "not a qio compressed file or corrupt block header");
+    }
+    if( e ) return qio_int_to_err(e);
+
+    if( codec == QIO_COMPRESS_DETECT ) codec = got_codec;
+    if( got_codec != codec ) {
+      QIO_RETURN_CONSTANT_ERROR(EFORMAT, "compressed file uses a different codec");
+    }
+
+    if( cf->nblocks == cf->blocks_cap ) {
+      int64_t cap = cf->blocks_cap ? 2 * cf->blocks_cap : 64;
+      qio_cblock_t* blocks = qio_realloc(cf->blocks,
+                                         cap * sizeof(qio_cblock_t));
+      if( ! blocks ) return QIO_ENOMEM;
+      cf->blocks = blocks;
+      cf->blocks_cap = cap;
+    }
+    cf->blocks[cf->nblocks].uoff = cf->ulen;
+    cf->blocks[cf->nblocks].coff = off;
+    cf->blocks[cf->nblocks].usize = usize;
+    cf->blocks[cf->nblocks].csize = csize;
+    cf->nblocks++;
+
+    if( usize > largest ) largest = usize;
+    cf->ulen += usize;
+    off += csize;
+  }
+
+  if( codec == QIO_COMPRESS_DETECT ) codec = QIO_COMPRESS_GZIP; // empty file
+  cf->codec = codec;
+  cf->clen = off;
+  cf->block_size = largest ? largest : QIO_COMPRESS_DEFAULT_BLOCK;
+
+  if( ! qio_compress_supported(codec) ) {
+    QIO_RETURN_CONSTANT_ERROR(ENOSYS, "compression codec not supported by this build");
+  }
+  return 0;
+}
+
+qioerr qio_file_open_compressed(qio_file_t** file_out, qio_file_t* base,
+                                int codec, int level, int64_t block_size,
+                                qio_fdflag_t fdflags,
+                                const qio_style_t* style)
+{
+  qio_cfile_t* cf;
+  int readable = (fdflags & QIO_FDFLAG_READABLE) != 0;
+  int writeable = (fdflags & QIO_FDFLAG_WRITEABLE) != 0;
+  qioerr err;
+
+  *file_out = NULL;
+
+  if( readable == writeable ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "compressed files are either read or written");
+  }
+  if( base->fd < 0 ) {
+    QIO_RETURN_CONSTANT_ERROR(ENOTSUP, "compressed files need a file descriptor");
+  }
+  if( writeable && ! qio_compress_supported(codec) ) {
+    QIO_RETURN_CONSTANT_ERROR(ENOSYS, "compression codec not supported by this build");
+  }
+  if( block_size > QIO_COMPRESS_MAX_BLOCK ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "compressed block size too large");
+  }
+
+  cf = (qio_cfile_t*) qio_calloc(1, sizeof(qio_cfile_t));
+  if( ! cf ) return QIO_ENOMEM;
+
+  err = qio_lock_init(&cf->lock);
+  if( err ) {
+    qio_free(cf);
+    return err;
+  }
+
+  cf->base = base;
+  cf->fd = base->fd;
+  cf->writing = writeable;
+
+  if( writeable ) {
+    int64_t base_len = 0;
+
+    err = qio_file_length(base, &base_len);
+    if( ! err && base_len != 0 ) {
+      QIO_GET_CONSTANT_ERROR(err, EINVAL, "can only write a new compressed file");
+    }
+    if( err ) goto error;
+
+    cf->codec = codec;
+    cf->block_size = block_size > 0 ? block_size : QIO_COMPRESS_DEFAULT_BLOCK;
+    if( level < 0 ) {
+#ifdef QIO_COMPRESS_ZLIB
+      if( codec == QIO_COMPRESS_GZIP ) level = Z_DEFAULT_COMPRESSION;
+#endif
+#ifdef QIO_COMPRESS_ZSTD
+      if( codec == QIO_COMPRESS_ZSTD ) level = ZSTD_CLEVEL_DEFAULT;
+#endif
+      if( level < 0 && codec != QIO_COMPRESS_GZIP ) level = 0;
+    }
+    if( codec == QIO_COMPRESS_GZIP && level > 9 ) level = 9;
+    cf->level = level;
+  } else {
+    err = build_index(cf, codec);
+    if( err ) goto error;
+    fdflags |= QIO_FDFLAG_SEEKABLE;
+  }
+
+  qio_file_retain(base);
+
+  err = qio_file_init_plugin_ops(file_out, cf, &compress_ops, fdflags, style);
+  if( err ) {
+    qio_file_release(base);
+    goto error;
+  }
+  return 0;
+
+error:
+  qio_lock_destroy(&cf->lock);
+  qio_free(cf->blocks);
+  qio_free(cf);
+  return err;
+}
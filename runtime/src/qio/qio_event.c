@@ -0,0 +1,275 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Event-driven waiting for sockets
+//
+#include "sys_basic.h"
+
+#ifndef CHPL_RT_UNIT_TEST
+#include "chplrt.h"
+#include "chpl-env.h"
+#include "chpl-tasks.h"
+#include "error.h"
+#endif
+
+#include "qio_event.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#define QIO_HAVE_EPOLL 1
+#endif
+
+#ifndef CHPL_RT_UNIT_TEST
+#define EVENT_YIELD() chpl_task_yield()
+#define EVENT_ENV_BOOL(name, dflt) chpl_env_rt_get_bool(name, dflt)
+#define EVENT_FATAL(msg) chpl_internal_error(msg)
+#else
+#define EVENT_YIELD() sched_yield()
+#define EVENT_ENV_BOOL(name, dflt) (dflt)
+#define EVENT_FATAL(msg) abort()
+#endif
+
+
+#ifdef QIO_HAVE_EPOLL
+
+// After this many yields, the polling task waits in epoll_wait() for
+// up to EVENT_BLOCK_MS instead of just checking, so that a locale
+// where every task is waiting on the network doesn't spin.
+#define EVENT_WAIT_SPINS 1000
+#define EVENT_BLOCK_MS 1
+
+#define EVENT_MAX_EVENTS 64
+
+// One waiting task.  Lives on the waiter's stack.
+typedef struct event_waiter_s {
+  struct event_waiter_s* next;
+  int writing;
+  int ready;
+} event_waiter_t;
+
+// The waiters for one fd.  epoll allows only one registration per fd,
+// so readers and writers of the same socket share it.
+typedef struct {
+  event_waiter_t* waiters;
+  uint32_t armed;          // events currently registered, 0 if none
+} event_fd_t;
+
+static pthread_once_t event_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t event_lock = PTHREAD_MUTEX_INITIALIZER;
+static int event_ok = 0;
+static int event_epfd = -1;
+static event_fd_t* event_fds = NULL;  // indexed by fd
+static size_t event_nfds = 0;
+
+
+static
+void event_setup(void)
+{
+  if( ! EVENT_ENV_BOOL("QIO_EVENT_SOCKETS", 0) ) return;
+
+  event_epfd = epoll_create1(EPOLL_CLOEXEC);
+  if( event_epfd >= 0 ) event_ok = 1;
+}
+
+int qio_event_enabled(void)
+{
+  pthread_once(&event_once, event_setup);
+  return event_ok;
+}
+
+// Make sure event_fds has a slot for fd.  Called with the lock held.
+static
+err_t event_grow_locked(fd_t fd)
+{
+  size_t n;
+  event_fd_t* fds;
+
+  if( (size_t) fd < event_nfds ) return 0;
+
+  n = event_nfds ? event_nfds : 1024;
+  while( n <= (size_t) fd ) n *= 2;
+
+  fds = (event_fd_t*) realloc(event_fds, n * sizeof(event_fd_t));
+  if( ! fds ) return ENOMEM;
+  memset(&fds[event_nfds], 0, (n - event_nfds) * sizeof(event_fd_t));
+
+  event_fds = fds;
+  event_nfds = n;
+  return 0;
+}
+
+// Register fd for whatever its waiters want, as a one-shot.  Called
+// with the lock held.
+static
+err_t event_arm_locked(fd_t fd)
+{
+  event_fd_t* efd = &event_fds[fd];
+  event_waiter_t* w;
+  struct epoll_event ev;
+  uint32_t want = 0;
+  int op;
+
+  for( w = efd->waiters; w; w = w->next ) {
+    want |= w->writing ? EPOLLOUT : EPOLLIN;
+  }
+
+  if( want == 0 || want == efd->armed ) return 0;
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = want | EPOLLONESHOT;
+  ev.data.fd = fd;
+
+  // A one-shot registration stays in the set after it fires, so try
+  // modifying it first and only add it if it isn't there.
+  op = EPOLL_CTL_MOD;
+  if( epoll_ctl(event_epfd, op, fd, &ev) != 0 ) {
+    if( errno != ENOENT ) return errno;
+    op = EPOLL_CTL_ADD;
+    if( epoll_ctl(event_epfd, op, fd, &ev) != 0 ) return errno;
+  }
+
+  efd->armed = want;
+  return 0;
+}
+
+// Mark the waiters on fd that 'events' satisfies as ready, and drop
+// them from the list.  Called with the lock held.
+static
+void event_wake_locked(fd_t fd, uint32_t events)
+{
+  event_fd_t* efd = &event_fds[fd];
+  event_waiter_t** p = &efd->waiters;
+  int all = (events & (EPOLLERR | EPOLLHUP)) != 0;
+
+  efd->armed = 0;
+
+  while( *p ) {
+    event_waiter_t* w = *p;
+    if( all
+        || (w->writing && (events & EPOLLOUT))
+        || (! w->writing && (events & EPOLLIN)) ) {
+      *p = w->next;
+      __atomic_store_n(&w->ready, 1, __ATOMIC_RELEASE);
+    } else {
+      p = &w->next;
+    }
+  }
+
+  // Anyone left is waiting for the other direction.
+  (void) event_arm_locked(fd);
+}
+
+// Collect events and wake their waiters.  Called with the lock held.
+static
+void event_poll_locked(int timeout_ms)
+{
+  struct epoll_event evs[EVENT_MAX_EVENTS];
+  int n;
+  int i;
+
+  n = epoll_wait(event_epfd, evs, EVENT_MAX_EVENTS, timeout_ms);
+  if( n < 0 ) {
+    if( errno == EINTR ) return;
+    EVENT_FATAL("epoll_wait failed");
+  }
+
+  for( i = 0; i < n; i++ ) {
+    fd_t fd = evs[i].data.fd;
+    if( (size_t) fd < event_nfds ) event_wake_locked(fd, evs[i].events);
+  }
+}
+
+err_t qio_event_wait(fd_t fd, int writing)
+{
+  event_waiter_t w;
+  err_t err;
+  int spins;
+
+  if( ! qio_event_enabled() ) return ENOSYS;
+  if( fd < 0 ) return EBADF;
+
+  w.writing = writing;
+  w.ready = 0;
+
+  pthread_mutex_lock(&event_lock);
+  err = event_grow_locked(fd);
+  if( ! err ) {
+    // With no waiters, any registration left over may be for an
+    // earlier file that had this number, so always re-arm.
+    if( ! event_fds[fd].waiters ) event_fds[fd].armed = 0;
+    w.next = event_fds[fd].waiters;
+    event_fds[fd].waiters = &w;
+    err = event_arm_locked(fd);
+    if( err ) event_fds[fd].waiters = w.next;
+  }
+  pthread_mutex_unlock(&event_lock);
+
+  if( err ) return err;
+
+  for( spins = 0; ! __atomic_load_n(&w.ready, __ATOMIC_ACQUIRE); spins++ ) {
+    EVENT_YIELD();
+
+    if( pthread_mutex_trylock(&event_lock) != 0 ) continue;
+    if( ! __atomic_load_n(&w.ready, __ATOMIC_ACQUIRE) ) {
+      event_poll_locked(spins >= EVENT_WAIT_SPINS ? EVENT_BLOCK_MS : 0);
+    }
+    pthread_mutex_unlock(&event_lock);
+  }
+
+  return 0;
+}
+
+void qio_event_forget(fd_t fd)
+{
+  if( ! event_ok || fd < 0 ) return;
+
+  pthread_mutex_lock(&event_lock);
+  if( (size_t) fd < event_nfds && event_fds[fd].waiters ) {
+    // Wake everyone; their retried calls will see EBADF.
+    event_wake_locked(fd, EPOLLERR);
+  }
+  if( (size_t) fd < event_nfds ) event_fds[fd].armed = 0;
+  pthread_mutex_unlock(&event_lock);
+}
+
+#else
+
+int qio_event_enabled(void)
+{
+  return 0;
+}
+
+err_t qio_event_wait(fd_t fd, int writing)
+{
+  return ENOSYS;
+}
+
+void qio_event_forget(fd_t fd)
+{
+}
+
+#endif
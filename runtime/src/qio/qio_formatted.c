@@ -27,6 +27,9 @@
 
 #include <limits.h>
 #include <ctype.h>
+#include <float.h>
+#include <pthread.h>
+#include <string.h>
 
 #ifdef HAS_WCTYPE_H
 #include <wctype.h>
@@ -154,6 +157,223 @@ qioerr qio_channel_write_svarint(const int threadsafe, qio_channel_t* restrict c
   return qio_channel_write_uvarint(threadsafe, ch, u_num);
 }
 
+// The longest varint is 10 bytes.  When at least that much is in the
+// fast path buffer, the array functions below decode/encode straight
+// out of it rather than going through a channel call per byte.
+#define QIO_MAX_VARINT_LEN 10
+
+// Returns the number of bytes used, or 0 if the varint is too long.
+static inline
+int _qio_decode_uvarint(const uint8_t* restrict p, uint64_t* restrict ptr) {
+  uint64_t num = 0;
+  int i;
+
+  for( i = 0; i < QIO_MAX_VARINT_LEN; i++ ) {
+    num |= ((uint64_t) (p[i] & 0x7f)) << (7*i);
+    if( ! (p[i] & 0x80) ) {
+      *ptr = num;
+      return i + 1;
+    }
+  }
+
+  *ptr = num;
+  return 0;
+}
+
+static inline
+int _qio_encode_uvarint(uint8_t* restrict p, uint64_t num) {
+  int i = 0;
+
+  while( num >= 0x80 ) {
+    p[i++] = (uint8_t) (num | 0x80);
+    num >>= 7;
+  }
+  p[i++] = (uint8_t) num;
+
+  return i;
+}
+
+qioerr qio_channel_read_uvarints(const int threadsafe, qio_channel_t* restrict ch, uint64_t* restrict ptr, ssize_t n) {
+  qioerr err = 0;
+  ssize_t i;
+  int used;
+
+  if( threadsafe ) {
+    err = qio_lock(&ch->lock);
+    if( err ) return err;
+  }
+
+  for( i = 0; i < n; i++ ) {
+    if( qio_space_in_ptr_diff(QIO_MAX_VARINT_LEN, ch->cached_end, ch->cached_cur) ) {
+      used = _qio_decode_uvarint((const uint8_t*) ch->cached_cur, &ptr[i]);
+      if( used == 0 ) {
+        QIO_GET_CONSTANT_ERROR(err, EFORMAT, "overflow in varint");
+        _qio_channel_set_error_unlocked(ch, err);
+        break;
+      }
+      ch->cached_cur = qio_ptr_add(ch->cached_cur, used);
+    } else {
+      // Near the end of the buffer; take the byte-at-a-time path.
+      err = qio_channel_read_uvarint(false, ch, &ptr[i]);
+      if( err ) break;
+    }
+  }
+
+  if( threadsafe ) {
+    qio_unlock(&ch->lock);
+  }
+
+  return err;
+}
+
+qioerr qio_channel_read_svarints(const int threadsafe, qio_channel_t* restrict ch, int64_t* restrict ptr, ssize_t n) {
+  qioerr err;
+  ssize_t i;
+
+  // Decode in place; uint64_t and int64_t have the same size.
+  err = qio_channel_read_uvarints(threadsafe, ch, (uint64_t*) ptr, n);
+
+  for( i = 0; i < n; i++ ) {
+    uint64_t u_num = (uint64_t) ptr[i];
+    ptr[i] = (u_num >> 1) ^ -((int64_t)(u_num & 1));
+  }
+
+  return err;
+}
+
+qioerr qio_channel_write_uvarints(const int threadsafe, qio_channel_t* restrict ch, const uint64_t* restrict ptr, ssize_t n) {
+  qioerr err = 0;
+  ssize_t i;
+  int wrote_cached = 0;
+
+  if( threadsafe ) {
+    err = qio_lock(&ch->lock);
+    if( err ) return err;
+  }
+
+  for( i = 0; i < n; i++ ) {
+    if( qio_space_in_ptr_diff(QIO_MAX_VARINT_LEN, ch->cached_end, ch->cached_cur) ) {
+      int used = _qio_encode_uvarint((uint8_t*) ch->cached_cur, ptr[i]);
+      ch->cached_cur = qio_ptr_add(ch->cached_cur, used);
+      wrote_cached = 1;
+    } else {
+      err = qio_channel_write_uvarint(false, ch, ptr[i]);
+      if( err ) break;
+    }
+  }
+
+  if( wrote_cached ) {
+    // As for a single write, this never returns an error.
+    _qio_channel_post_cached_write(ch);
+  }
+
+  if( threadsafe ) {
+    qio_unlock(&ch->lock);
+  }
+
+  return err;
+}
+
+qioerr qio_channel_write_svarints(const int threadsafe, qio_channel_t* restrict ch, const int64_t* restrict ptr, ssize_t n) {
+  uint64_t tmp[256];
+  qioerr err = 0;
+  ssize_t i, j, len;
+
+  if( threadsafe ) {
+    err = qio_lock(&ch->lock);
+    if( err ) return err;
+  }
+
+  for( i = 0; i < n && ! err; i += len ) {
+    len = n - i;
+    if( len > (ssize_t) (sizeof(tmp) / sizeof(tmp[0])) )
+      len = sizeof(tmp) / sizeof(tmp[0]);
+    for( j = 0; j < len; j++ ) {
+      int64_t num = ptr[i+j];
+      tmp[j] = ((uint64_t) num << 1) ^ (uint64_t) (num >> 63);
+    }
+    err = qio_channel_write_uvarints(false, ch, tmp, len);
+  }
+
+  if( threadsafe ) {
+    qio_unlock(&ch->lock);
+  }
+
+  return err;
+}
+
+// Does data in 'byteorder' need swapping to/from the host order?
+static inline
+int _qio_byteorder_needs_swap(const int byteorder) {
+  if( byteorder == QIO_BIG ) return htobe16(1) != 1;
+  if( byteorder == QIO_LITTLE ) return htole16(1) != 1;
+  return 0;
+}
+
+static inline
+void _qio_bswap_array(void* restrict ptr, size_t elt_size, size_t n) {
+  switch( elt_size ) {
+    case 2:
+      qio_bswap_array16((uint16_t*) ptr, n);
+      break;
+    case 4:
+      qio_bswap_array32((uint32_t*) ptr, n);
+      break;
+    case 8:
+      qio_bswap_array64((uint64_t*) ptr, n);
+      break;
+  }
+}
+
+qioerr qio_channel_read_ints(const int threadsafe, const int byteorder, qio_channel_t* restrict ch, void* restrict ptr, size_t elt_size, ssize_t n) {
+  qioerr err;
+
+  if( elt_size != 1 && elt_size != 2 && elt_size != 4 && elt_size != 8 )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "bad integer size");
+
+  // One copy out of the channel, then one pass to fix the byte order.
+  err = qio_channel_read_amt(threadsafe, ch, ptr, elt_size * n);
+  if( err ) return err;
+
+  if( elt_size > 1 && _qio_byteorder_needs_swap(byteorder) )
+    _qio_bswap_array(ptr, elt_size, n);
+
+  return 0;
+}
+
+qioerr qio_channel_write_ints(const int threadsafe, const int byteorder, qio_channel_t* restrict ch, const void* restrict ptr, size_t elt_size, ssize_t n) {
+  uint64_t tmp[512];
+  ssize_t per_chunk = sizeof(tmp) / elt_size;
+  ssize_t i, len;
+  qioerr err = 0;
+
+  if( elt_size != 1 && elt_size != 2 && elt_size != 4 && elt_size != 8 )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "bad integer size");
+
+  if( elt_size == 1 || ! _qio_byteorder_needs_swap(byteorder) )
+    return qio_channel_write_amt(threadsafe, ch, ptr, elt_size * n);
+
+  // The caller's array is const, so swap a chunk at a time into 'tmp'.
+  if( threadsafe ) {
+    err = qio_lock(&ch->lock);
+    if( err ) return err;
+  }
+
+  for( i = 0; i < n && ! err; i += len ) {
+    len = n - i;
+    if( len > per_chunk ) len = per_chunk;
+    qio_memcpy(tmp, qio_ptr_add((void*) ptr, i * elt_size), len * elt_size);
+    _qio_bswap_array(tmp, elt_size, len);
+    err = qio_channel_write_amt(false, ch, tmp, len * elt_size);
+  }
+
+  if( threadsafe ) {
+    qio_unlock(&ch->lock);
+  }
+
+  return err;
+}
+
 
 
 static
@@ -2088,6 +2308,139 @@ static inline bool is_json_whitespace(int32_t c)
            c == '\f' || c == '\n' || c == '\r' || c == '\t' );
 }
 
+// Fast path for qio_channel_skip_json_field.
+//
+// When the whole field is in the channel's cached buffer, skip it
+// there: string bodies are searched 8 bytes at a time for '"' or '\',
+// and objects and arrays are skipped by tracking only strings and
+// bracket nesting (as in the structural index of simdjson) instead of
+// by recursive descent. The brackets must match, but the rest of a
+// skipped object or array isn't checked. Anything else - a field that
+// crosses the end of the buffer, deep nesting, mismatched brackets,
+// unusual input - returns NULL so the general code handles it.
+
+#define JSON_BYTES(c) (0x0101010101010101ULL * (uint8_t) (c))
+
+// Does any byte of w equal the byte repeated in b?
+static inline
+uint64_t _json_has_byte(uint64_t w, uint64_t b)
+{
+  uint64_t x = w ^ b;
+  return (x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL;
+}
+
+static inline
+const char* _json_fast_whitespace(const char* p, const char* end)
+{
+  while( p < end && is_json_whitespace(*p) ) p++;
+  return p;
+}
+
+// p is just after the opening '"'; returns just after the closing '"'.
+static
+const char* _json_fast_string(const char* p, const char* end)
+{
+  char c;
+
+  while( true ) {
+    while( end - p >= 8 ) {
+      uint64_t w;
+      memcpy(&w, p, 8);
+      if( _json_has_byte(w, JSON_BYTES('"')) |
+          _json_has_byte(w, JSON_BYTES('\\')) ) break;
+      p += 8;
+    }
+    if( p >= end ) return NULL;
+    c = *p++;
+    if( c == '"' ) return p;
+    if( c == '\\' ) {
+      if( p >= end ) return NULL;
+      p++;
+    }
+  }
+}
+
+// p is just after the opening '{' or '['; returns just after the
+// matching close.
+static
+const char* _json_fast_container(const char* p, const char* end, char open)
+{
+  uint64_t is_object = (open == '{'); // one bit per nesting level
+  int depth = 1;
+  char c;
+
+  while( p < end ) {
+    c = *p++;
+    if( c == '"' ) {
+      p = _json_fast_string(p, end);
+      if( ! p ) return NULL;
+    } else if( c == '{' || c == '[' ) {
+      if( depth == 64 ) return NULL;
+      is_object = (is_object << 1) | (c == '{');
+      depth++;
+    } else if( c == '}' || c == ']' ) {
+      if( (is_object & 1) != (c == '}') ) return NULL;
+      is_object >>= 1;
+      depth--;
+      if( depth == 0 ) return p;
+    }
+  }
+  return NULL;
+}
+
+static
+const char* _json_fast_value(const char* p, const char* end)
+{
+  char c;
+
+  p = _json_fast_whitespace(p, end);
+  if( p >= end ) return NULL;
+
+  c = *p++;
+  if( c == '"' ) {
+    return _json_fast_string(p, end);
+  } else if( c == '{' || c == '[' ) {
+    return _json_fast_container(p, end, c);
+  } else if( c == '-' || ('0' <= c && c <= '9') ) {
+    // Same grammar as qio_skip_json_value_unlocked; stops before the
+    // first character that isn't part of the number.
+    while( p < end && '0' <= *p && *p <= '9' ) p++;
+    if( p < end && *p == '.' ) {
+      p++;
+      while( p < end && '0' <= *p && *p <= '9' ) p++;
+    }
+    if( p < end && (*p == 'e' || *p == 'E') ) {
+      p++;
+      if( p >= end ) return NULL;
+      if( ! (*p == '+' || *p == '-' || ('0' <= *p && *p <= '9')) ) return NULL;
+      p++;
+      while( p < end && '0' <= *p && *p <= '9' ) p++;
+    }
+    // qio_skip_json_value_unlocked needs to see the next character.
+    return p < end ? p : NULL;
+  } else if( c == 't' ) {
+    return (end - p >= 3 && 0 == memcmp(p, "rue", 3)) ? p + 3 : NULL;
+  } else if( c == 'f' ) {
+    return (end - p >= 4 && 0 == memcmp(p, "alse", 4)) ? p + 4 : NULL;
+  } else if( c == 'n' ) {
+    return (end - p >= 3 && 0 == memcmp(p, "ull", 3)) ? p + 3 : NULL;
+  }
+  return NULL;
+}
+
+// Returns where the field starting at p ends, or NULL.
+static
+const char* _json_fast_field(const char* p, const char* end)
+{
+  p = _json_fast_whitespace(p, end);
+  if( p >= end || *p != '"' ) return NULL;
+  p = _json_fast_string(p + 1, end);
+  if( ! p ) return NULL;
+  p = _json_fast_whitespace(p, end);
+  if( p >= end || *p != ':' ) return NULL;
+  return _json_fast_value(p + 1, end);
+}
+
 // Read and skip an arbitrary JSON object, assuming the leading '{'
 // has already been read. Returns 0 on success or a negative error code.
 int32_t qio_skip_json_object_unlocked(qio_channel_t* restrict ch)
@@ -2166,6 +2519,21 @@ int32_t qio_skip_json_value_unlocked(qio_channel_t* restrict ch)
 {
   int32_t c;
 
+  if( ch->cached_cur ) {
+    const char* start = (const char*) ch->cached_cur;
+    const char* p = _json_fast_value(start, (const char*) ch->cached_end);
+    if( p ) {
+      start = _json_fast_whitespace(start, p);
+      if( *start == '-' || ('0' <= *start && *start <= '9') ) {
+        // Numbers return the character after them, as below.
+        ch->cached_cur = (void*) (p + 1);
+        return (unsigned char) *p;
+      }
+      ch->cached_cur = (void*) p;
+      return 0;
+    }
+  }
+
   // Read whitespace and then a value.
   while( true ) {
     c = qio_channel_read_byte(false, ch);
@@ -2289,6 +2657,15 @@ int32_t qio_skip_json_string_unlocked(qio_channel_t* restrict ch)
 {
   int32_t c;
 
+  if( ch->cached_cur ) {
+    const char* p = _json_fast_string((const char*) ch->cached_cur,
+                                      (const char*) ch->cached_end);
+    if( p ) {
+      ch->cached_cur = (void*) p;
+      return 0;
+    }
+  }
+
   while( true ) {
     c = qio_channel_read_byte(false, ch);
     if( c < 0 ) return c;
@@ -2366,12 +2743,23 @@ qioerr qio_channel_skip_json_field(const int threadsafe, qio_channel_t* ch)
   int32_t got;
   int64_t start_offset;
   int64_t offset;
+  const char* fast_end;
 
   if( threadsafe ) {
     err = qio_lock(&ch->lock);
     if( err ) return err;
   }
 
+  if( ch->cached_cur ) {
+    fast_end = _json_fast_field((const char*) ch->cached_cur,
+                                (const char*) ch->cached_end);
+    if( fast_end ) {
+      ch->cached_cur = (void*) fast_end;
+      err = 0;
+      goto unlock;
+    }
+  }
+
   start_offset = qio_channel_offset_unlocked(ch);
 
   err = qio_channel_mark(false, ch);
@@ -2658,6 +3046,208 @@ error:
   return err;
 }
 
+// Fast paths for scanning decimal numbers.
+//
+// When a whole number (and the character after it) is already in the
+// channel's cached buffer, it can be parsed in place instead of
+// through _peek_number_unlocked, qio_channel_read_char and strtoull or
+// strtod.  Anything unusual - another base, inf/nan, a number that
+// runs to the end of the buffer, or one too long to convert exactly -
+// returns 0 so that the general path handles it.
+
+static inline
+int _fast_is_space(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' ||
+         c == '\v' || c == '\f';
+}
+
+static inline
+int _fast_is_digit(char c)
+{
+  return (unsigned char) (c - '0') < 10;
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define QIO_SCAN_SWAR 1
+// Are all 8 bytes of w ASCII digits?
+static inline
+int _swar_eight_digits(uint64_t w)
+{
+  return ((w & 0xF0F0F0F0F0F0F0F0ULL) |
+          (((w + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+         0x3333333333333333ULL;
+}
+
+// The value of 8 ASCII digits, first digit in the low byte.
+static inline
+uint64_t _swar_eight_digits_value(uint64_t w)
+{
+  w = (w & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;
+  w = (w & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;
+  return (w & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >> 32;
+}
+#endif
+
+// Accumulate the digits starting at p into *val and return a pointer
+// past them.  The caller checks the digit count for overflow.
+static inline
+const char* _fast_digits(const char* p, const char* end, uint64_t* val)
+{
+  uint64_t v = *val;
+#ifdef QIO_SCAN_SWAR
+  while( end - p >= 8 ) {
+    uint64_t w;
+    memcpy(&w, p, 8);
+    if( ! _swar_eight_digits(w) ) break;
+    v = v * 100000000 + _swar_eight_digits_value(w);
+    p += 8;
+  }
+#endif
+  while( p < end && _fast_is_digit(*p) ) {
+    v = v * 10 + (*p - '0');
+    p++;
+  }
+  *val = v;
+  return p;
+}
+
+// Skip whitespace and read a sign. Returns NULL at the end of the buffer.
+static inline
+const char* _fast_sign(const char* p, const char* end,
+                       const number_reading_state_t* st, int* sign)
+{
+  char c;
+
+  while( p < end && _fast_is_space(*p) ) p++;
+  if( p >= end ) return NULL;
+
+  c = tolower((unsigned char) *p);
+  *sign = 0;
+  if( st->allow_pos_sign && c == st->positive_char ) {
+    *sign = 1;
+    p++;
+  } else if( st->allow_neg_sign && c == st->negative_char ) {
+    *sign = -1;
+    p++;
+  }
+  return p;
+}
+
+static
+int _scan_int_fast_unlocked(qio_channel_t* restrict ch,
+                            const number_reading_state_t* restrict st,
+                            unsigned long long* num_out, int* sign_out)
+{
+  const char* p = (const char*) ch->cached_cur;
+  const char* end = (const char*) ch->cached_end;
+  const char* digits;
+  uint64_t num = 0;
+
+  if( p == NULL || (st->base != 0 && st->base != 10) || st->allow_point )
+    return 0;
+
+  p = _fast_sign(p, end, st, sign_out);
+  if( p == NULL ) return 0;
+
+  digits = p;
+  p = _fast_digits(p, end, &num);
+
+  // Need a character after the number, and at most 19 digits so that
+  // num can't have overflowed.
+  if( p == digits || p >= end || p - digits > 19 ) return 0;
+  // 0x, 0o, 0b
+  if( st->allow_base && p - digits == 1 && *digits == '0' ) {
+    char c = tolower((unsigned char) *p);
+    if( c == 'x' || c == 'o' || c == 'b' ) return 0;
+  }
+
+  ch->cached_cur = (void*) p;
+  *num_out = num;
+  return 1;
+}
+
+// Clinger's fast path: a decimal with at most 2^53 as its significand
+// and at most 22 as the magnitude of its power of ten converts with a
+// single correctly rounded multiply or divide.  Needs double
+// arithmetic without extended precision.
+static
+int _scan_float_fast_unlocked(qio_channel_t* restrict ch,
+                              const number_reading_state_t* restrict st,
+                              double* num_out)
+{
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+  static const double pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+  const char* p = (const char*) ch->cached_cur;
+  const char* end = (const char*) ch->cached_end;
+  const char* digits;
+  int64_t ndigits;
+  int64_t exp10 = 0;
+  uint64_t m = 0;
+  int sign;
+  double d;
+  char c;
+
+  if( p == NULL || (st->base != 0 && st->base != 10) || st->allow_i_after )
+    return 0;
+
+  p = _fast_sign(p, end, st, &sign);
+  if( p == NULL ) return 0;
+
+  digits = p;
+  p = _fast_digits(p, end, &m);
+  ndigits = p - digits;
+  if( p < end && tolower((unsigned char) *p) == st->point_char ) {
+    const char* frac = ++p;
+    p = _fast_digits(p, end, &m);
+    ndigits += p - frac;
+    exp10 = -(p - frac);
+  }
+  if( ndigits == 0 || ndigits > 19 || p >= end ) return 0;
+
+  if( tolower((unsigned char) *p) == st->exponent_char ) {
+    int esign = 1;
+    int64_t e = 0;
+    int edigits = 0;
+
+    p++;
+    if( p < end && tolower((unsigned char) *p) == st->negative_char ) {
+      esign = -1;
+      p++;
+    } else if( p < end && tolower((unsigned char) *p) == st->positive_char ) {
+      p++;
+    }
+    while( p < end && _fast_is_digit(*p) && edigits < 5 ) {
+      e = e * 10 + (*p - '0');
+      p++;
+      edigits++;
+    }
+    if( edigits == 0 || edigits == 5 || p >= end ) return 0;
+    exp10 += esign * e;
+  }
+
+  // Anything that might continue the number (e.g. 0x, 1.2.3, an i for
+  // an imaginary number) goes to the general path.
+  c = tolower((unsigned char) *p);
+  if( isalnum((unsigned char) c) || c == st->point_char || c == '_' )
+    return 0;
+
+  if( m > (UINT64_C(1) << 53) || exp10 < -22 || exp10 > 22 ) return 0;
+
+  d = (double) m;
+  if( exp10 < 0 ) d /= pow10[-exp10];
+  else d *= pow10[exp10];
+
+  ch->cached_cur = (void*) p;
+  *num_out = (sign < 0) ? -d : d;
+  return 1;
+#else
+  return 0;
+#endif
+}
 
 qioerr qio_channel_scan_int(const int threadsafe, qio_channel_t* restrict ch, void* restrict out, size_t len, int issigned)
 {
@@ -2697,6 +3287,12 @@ qioerr qio_channel_scan_int(const int threadsafe, qio_channel_t* restrict ch, vo
   st.positive_char = tolower(style->positive_char);
   st.negative_char = tolower(style->negative_char);
 
+  if( _scan_int_fast_unlocked(ch, &st, &num, &sign) ) {
+    if( ! issigned ) sign = 1;
+    err = 0;
+    goto error; // err is 0; just store num
+  }
+
   err = _peek_number_unlocked(ch, &st, &amount);
   if( qio_err_to_int(err) == EEOF && st.end > 0 ) err = 0; // we tolerate EOF if there's data.
   if( err ) goto error;
@@ -2859,6 +3455,11 @@ qioerr qio_channel_scan_float_or_imag(const int threadsafe, qio_channel_t* restr
   st.allow_i_after = needs_i;
   st.i_char = style->i_char;
 
+  if( _scan_float_fast_unlocked(ch, &st, &num) ) {
+    err = 0;
+    goto error; // err is 0; just store num
+  }
+
   err = _peek_number_unlocked(ch, &st, &amount);
   if( qio_err_to_int(err) == EEOF && st.end > 0 ) err = 0; // we tolerate EOF if there's data.
   if( err ) goto error;
@@ -3025,6 +3626,33 @@ static inline int _ltoa_convert(char *tmp, int tmplen, uint64_t num, int base, i
   return at;
 }
 
+static const char _ltoa_digit_pairs[201] =
+  "0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+  "5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+// _ltoa_convert for base 10, two digits at a time.
+static inline int _ltoa_convert_dec(char *tmp, int tmplen, uint64_t num)
+{
+  int at = tmplen - 1;
+  int pair;
+
+  tmp[at] = '\0';
+  while( num >= 100 ) {
+    pair = (int) (num % 100) * 2;
+    num /= 100;
+    tmp[--at] = _ltoa_digit_pairs[pair + 1];
+    tmp[--at] = _ltoa_digit_pairs[pair];
+  }
+  if( num >= 10 ) {
+    pair = (int) num * 2;
+    tmp[--at] = _ltoa_digit_pairs[pair + 1];
+    tmp[--at] = _ltoa_digit_pairs[pair];
+  } else {
+    tmp[--at] = '0' + (char) num;
+  }
+  return at;
+}
+
 // dst must have room (at most 65 bytes for binary + '\0')
 // Returns the number of characters written (not including '\0')
 // or >= size if there wasn't room in the buffer (returns amt needed)
@@ -3050,7 +3678,7 @@ int _ltoa(char* restrict dst, size_t size, uint64_t num, int isnegative,
   else if( base == 8 )
     tmp_skip = _ltoa_convert(tmp, sizeof(tmp), num, 8, 0);
   else if( base == 10 )
-    tmp_skip = _ltoa_convert(tmp, sizeof(tmp), num, 10, 0);
+    tmp_skip = _ltoa_convert_dec(tmp, sizeof(tmp), num);
   else if( base == 16 )
     tmp_skip = _ltoa_convert(tmp, sizeof(tmp), num, 16, style->uppercase);
   else
@@ -3143,6 +3771,452 @@ int _ltoa(char* restrict dst, size_t size, uint64_t num, int isnegative,
   return i;
 }
 
+// Shortest round-trip decimal digits for doubles.
+//
+// This is the Ryu algorithm (Ulf Adams, "Ryu: fast float-to-string
+// conversion", PLDI 2018).  It finds the shortest decimal that reads
+// back as the same double, choosing the closest one if there are
+// several.  The 125-bit power-of-5 multipliers it needs are computed
+// once, on first use, with a little bignum arithmetic rather than
+// being kept in a large table here.
+
+#define RYU_MANTISSA_BITS 52
+#define RYU_EXPONENT_BITS 11
+#define RYU_BIAS 1023
+#define RYU_POW5_INV_BITCOUNT 125
+#define RYU_POW5_BITCOUNT 125
+#define RYU_POW5_INV_TABLE_SIZE 342
+#define RYU_POW5_TABLE_SIZE 326
+#define RYU_BIG_LIMBS 28 // 32-bit limbs; enough for 2*5^341
+
+static uint64_t ryu_pow5_inv_split[RYU_POW5_INV_TABLE_SIZE][2];
+static uint64_t ryu_pow5_split[RYU_POW5_TABLE_SIZE][2];
+static pthread_once_t ryu_tables_once = PTHREAD_ONCE_INIT;
+
+typedef struct ryu_big_s {
+  uint32_t w[RYU_BIG_LIMBS];
+} ryu_big_t;
+
+static
+int ryu_big_bitlen(const ryu_big_t* b)
+{
+  int i, bits;
+  for( i = RYU_BIG_LIMBS - 1; i >= 0; i-- ) {
+    if( b->w[i] ) {
+      for( bits = 32; ! (b->w[i] & (1u << (bits - 1))); bits-- ) ;
+      return 32 * i + bits;
+    }
+  }
+  return 0;
+}
+
+static
+int ryu_big_bit(const ryu_big_t* b, int i)
+{
+  if( i < 0 || i >= 32 * RYU_BIG_LIMBS ) return 0;
+  return (b->w[i / 32] >> (i % 32)) & 1;
+}
+
+static
+void ryu_big_shl1(ryu_big_t* b)
+{
+  int i;
+  for( i = RYU_BIG_LIMBS - 1; i > 0; i-- )
+    b->w[i] = (b->w[i] << 1) | (b->w[i-1] >> 31);
+  b->w[0] <<= 1;
+}
+
+// if a >= b, a -= b and return 1
+static
+int ryu_big_sub_if_ge(ryu_big_t* a, const ryu_big_t* b)
+{
+  uint64_t borrow = 0;
+  int i;
+
+  for( i = RYU_BIG_LIMBS - 1; i >= 0; i-- ) {
+    if( a->w[i] != b->w[i] ) break;
+  }
+  if( i >= 0 && a->w[i] < b->w[i] ) return 0;
+
+  for( i = 0; i < RYU_BIG_LIMBS; i++ ) {
+    uint64_t d = (uint64_t) a->w[i] - b->w[i] - borrow;
+    a->w[i] = (uint32_t) d;
+    borrow = (d >> 63) & 1;
+  }
+  return 1;
+}
+
+static
+void ryu_init_tables(void)
+{
+  ryu_big_t pow5;
+  int i, t;
+
+  memset(&pow5, 0, sizeof(pow5));
+  pow5.w[0] = 1;
+
+  for( i = 0; i < RYU_POW5_INV_TABLE_SIZE; i++ ) {
+    int len = ryu_big_bitlen(&pow5);
+
+    if( i < RYU_POW5_TABLE_SIZE ) {
+      // the top RYU_POW5_BITCOUNT bits of 5^i
+      uint64_t v[2] = {0, 0};
+      for( t = 0; t < 128; t++ ) {
+        if( ryu_big_bit(&pow5, t + len - RYU_POW5_BITCOUNT) )
+          v[t / 64] |= UINT64_C(1) << (t % 64);
+      }
+      ryu_pow5_split[i][0] = v[0];
+      ryu_pow5_split[i][1] = v[1];
+    }
+
+    {
+      // floor(2^(len - 1 + RYU_POW5_INV_BITCOUNT) / 5^i) + 1,
+      // by long division.  Until 2^(len-1) there are no quotient bits.
+      ryu_big_t r;
+      uint64_t q[2] = {0, 0};
+
+      memset(&r, 0, sizeof(r));
+      r.w[(len - 1) / 32] = 1u << ((len - 1) % 32);
+      for( t = RYU_POW5_INV_BITCOUNT; t >= 0; t-- ) {
+        if( t != RYU_POW5_INV_BITCOUNT ) ryu_big_shl1(&r);
+        if( ryu_big_sub_if_ge(&r, &pow5) )
+          q[t / 64] |= UINT64_C(1) << (t % 64);
+      }
+      q[0]++;
+      if( q[0] == 0 ) q[1]++;
+      ryu_pow5_inv_split[i][0] = q[0];
+      ryu_pow5_inv_split[i][1] = q[1];
+    }
+
+    // pow5 *= 5
+    {
+      uint64_t carry = 0;
+      for( t = 0; t < RYU_BIG_LIMBS; t++ ) {
+        uint64_t p = (uint64_t) pow5.w[t] * 5 + carry;
+        pow5.w[t] = (uint32_t) p;
+        carry = p >> 32;
+      }
+    }
+  }
+}
+
+// (m * mul) >> j, where mul is 128 bits and 64 < j < 128
+static inline
+uint64_t ryu_mul_shift64(uint64_t m, const uint64_t* mul, int32_t j)
+{
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 b0 = (unsigned __int128) m * mul[0];
+  unsigned __int128 b2 = (unsigned __int128) m * mul[1];
+  return (uint64_t) (((b0 >> 64) + b2) >> (j - 64));
+#else
+  uint64_t a_lo = (uint32_t) m, a_hi = m >> 32;
+  uint64_t lo[2], hi[2];
+  uint64_t sum, high1;
+  int k;
+
+  for( k = 0; k < 2; k++ ) {
+    uint64_t b_lo = (uint32_t) mul[k], b_hi = mul[k] >> 32;
+    uint64_t b00 = a_lo * b_lo, b01 = a_lo * b_hi;
+    uint64_t b10 = a_hi * b_lo, b11 = a_hi * b_hi;
+    uint64_t mid1 = b10 + (b00 >> 32);
+    uint64_t mid2 = b01 + (uint32_t) mid1;
+    hi[k] = b11 + (mid1 >> 32) + (mid2 >> 32);
+    lo[k] = (mid2 << 32) | (uint32_t) b00;
+  }
+  sum = hi[0] + lo[1];
+  high1 = hi[1] + (sum < hi[0]);
+  return (high1 << (128 - j)) | (sum >> (j - 64));
+#endif
+}
+
+static inline
+int32_t ryu_pow5bits(int32_t e)
+{
+  return (int32_t) (((uint32_t) e * 1217359) >> 19) + 1;
+}
+
+static inline
+uint32_t ryu_log10_pow2(int32_t e)
+{
+  return ((uint32_t) e * 78913) >> 18;
+}
+
+static inline
+uint32_t ryu_log10_pow5(int32_t e)
+{
+  return ((uint32_t) e * 732923) >> 20;
+}
+
+static inline
+int ryu_multiple_of_pow5(uint64_t value, uint32_t p)
+{
+  uint32_t count = 0;
+  while( value % 5 == 0 && count < p ) {
+    value /= 5;
+    count++;
+  }
+  return count >= p;
+}
+
+static inline
+int ryu_multiple_of_pow2(uint64_t value, uint32_t p)
+{
+  return (value & ((UINT64_C(1) << p) - 1)) == 0;
+}
+
+// Puts the shortest digits of finite num >= 0 in digits (at most 17,
+// no '\0') and the decimal exponent of the first digit in *exp10_out.
+// Returns the number of digits.
+static
+int _shortest_digits(double num, char* digits, int* exp10_out)
+{
+  uint64_t bits;
+  uint64_t ieee_mantissa;
+  uint32_t ieee_exponent;
+  int32_t e2;
+  uint64_t m2;
+  int even, mm_shift;
+  uint64_t mv, vr, vp, vm;
+  int32_t e10;
+  int vm_trailing_zeros = 0, vr_trailing_zeros = 0;
+  int32_t removed = 0;
+  uint8_t last_removed_digit = 0;
+  uint64_t output;
+  int n, i;
+
+  if( num == 0.0 ) {
+    digits[0] = '0';
+    *exp10_out = 0;
+    return 1;
+  }
+
+  pthread_once(&ryu_tables_once, ryu_init_tables);
+
+  memcpy(&bits, &num, sizeof(bits));
+  ieee_mantissa = bits & ((UINT64_C(1) << RYU_MANTISSA_BITS) - 1);
+  ieee_exponent = (uint32_t) ((bits >> RYU_MANTISSA_BITS) &
+                              ((1u << RYU_EXPONENT_BITS) - 1));
+
+  if( ieee_exponent == 0 ) {
+    e2 = 1 - RYU_BIAS - RYU_MANTISSA_BITS - 2;
+    m2 = ieee_mantissa;
+  } else {
+    e2 = (int32_t) ieee_exponent - RYU_BIAS - RYU_MANTISSA_BITS - 2;
+    m2 = (UINT64_C(1) << RYU_MANTISSA_BITS) | ieee_mantissa;
+  }
+  even = (m2 & 1) == 0;
+  mv = 4 * m2;
+  mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+  if( e2 >= 0 ) {
+    uint32_t q = ryu_log10_pow2(e2) - (e2 > 3);
+    int32_t k = RYU_POW5_INV_BITCOUNT + ryu_pow5bits(q) - 1;
+    int32_t j = -e2 + q + k;
+    e10 = q;
+    vr = ryu_mul_shift64(4 * m2, ryu_pow5_inv_split[q], j);
+    vp = ryu_mul_shift64(4 * m2 + 2, ryu_pow5_inv_split[q], j);
+    vm = ryu_mul_shift64(4 * m2 - 1 - mm_shift, ryu_pow5_inv_split[q], j);
+    if( q <= 21 ) {
+      if( mv % 5 == 0 ) {
+        vr_trailing_zeros = ryu_multiple_of_pow5(mv, q);
+      } else if( even ) {
+        vm_trailing_zeros = ryu_multiple_of_pow5(mv - 1 - mm_shift, q);
+      } else {
+        vp -= ryu_multiple_of_pow5(mv + 2, q);
+      }
+    }
+  } else {
+    uint32_t q = ryu_log10_pow5(-e2) - (-e2 > 1);
+    int32_t i5 = -e2 - q;
+    int32_t k = ryu_pow5bits(i5) - RYU_POW5_BITCOUNT;
+    int32_t j = q - k;
+    e10 = q + e2;
+    vr = ryu_mul_shift64(4 * m2, ryu_pow5_split[i5], j);
+    vp = ryu_mul_shift64(4 * m2 + 2, ryu_pow5_split[i5], j);
+    vm = ryu_mul_shift64(4 * m2 - 1 - mm_shift, ryu_pow5_split[i5], j);
+    if( q <= 1 ) {
+      vr_trailing_zeros = 1;
+      if( even ) vm_trailing_zeros = mm_shift == 1;
+      else --vp;
+    } else if( q < 63 ) {
+      vr_trailing_zeros = ryu_multiple_of_pow2(mv, q);
+    }
+  }
+
+  // Remove digits while the bounds still differ.
+  if( vm_trailing_zeros || vr_trailing_zeros ) {
+    while( vp / 10 > vm / 10 ) {
+      vm_trailing_zeros &= vm % 10 == 0;
+      vr_trailing_zeros &= last_removed_digit == 0;
+      last_removed_digit = (uint8_t) (vr % 10);
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      removed++;
+    }
+    if( vm_trailing_zeros ) {
+      while( vm % 10 == 0 ) {
+        vr_trailing_zeros &= last_removed_digit == 0;
+        last_removed_digit = (uint8_t) (vr % 10);
+        vr /= 10;
+        vp /= 10;
+        vm /= 10;
+        removed++;
+      }
+    }
+    if( vr_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0 ) {
+      last_removed_digit = 4; // round to even
+    }
+    output = vr + ((vr == vm && (! even || ! vm_trailing_zeros)) ||
+                   last_removed_digit >= 5);
+  } else {
+    int round_up = 0;
+    if( vp / 100 > vm / 100 ) {
+      round_up = vr % 100 >= 50;
+      vr /= 100;
+      vp /= 100;
+      vm /= 100;
+      removed += 2;
+    }
+    while( vp / 10 > vm / 10 ) {
+      round_up = vr % 10 >= 5;
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      removed++;
+    }
+    output = vr + (vr == vm || round_up);
+  }
+
+  // Write out the digits.
+  {
+    char tmp[20];
+    n = 0;
+    do {
+      tmp[n++] = '0' + (char) (output % 10);
+      output /= 10;
+    } while( output != 0 );
+    for( i = 0; i < n; i++ ) digits[i] = tmp[n - 1 - i];
+  }
+
+  *exp10_out = e10 + removed + n - 1;
+  return n;
+}
+
+// Writes digits (ndigits of them, the first one at exponent exp10)
+// like printf %g would: fixed notation if fixed is set, otherwise
+// d.ddde+XX.  Returns the length written to out.
+static
+int _format_digits(char* out, const char* digits, int ndigits, int exp10,
+                   int fixed, int uppercase)
+{
+  int len = 0;
+  int i;
+
+  if( ! fixed ) {
+    int e = exp10 < 0 ? -exp10 : exp10;
+    char edigits[4];
+    int ne = 0;
+
+    out[len++] = digits[0];
+    if( ndigits > 1 ) {
+      out[len++] = '.';
+      for( i = 1; i < ndigits; i++ ) out[len++] = digits[i];
+    }
+    out[len++] = uppercase ? 'E' : 'e';
+    out[len++] = exp10 < 0 ? '-' : '+';
+    do {
+      edigits[ne++] = '0' + e % 10;
+      e /= 10;
+    } while( e != 0 );
+    if( ne < 2 ) edigits[ne++] = '0';
+    while( ne > 0 ) out[len++] = edigits[--ne];
+  } else if( exp10 >= 0 ) {
+    for( i = 0; i <= exp10; i++ ) out[len++] = i < ndigits ? digits[i] : '0';
+    if( ndigits > exp10 + 1 ) {
+      out[len++] = '.';
+      for( i = exp10 + 1; i < ndigits; i++ ) out[len++] = digits[i];
+    }
+  } else {
+    out[len++] = '0';
+    out[len++] = '.';
+    for( i = -1; i > exp10; i-- ) out[len++] = '0';
+    for( i = 0; i < ndigits; i++ ) out[len++] = digits[i];
+  }
+
+  return len;
+}
+
+// Fast conversion of finite num >= 0 for _ftoa_core.
+//
+// With shortest set, this is realfmt 3: like %.17g, but with the
+// fewest digits that read back as num.
+//
+// Otherwise it is the default %g (6 significant digits, with numbers
+// in [100000,1000000) always shown with an exponent; see _ftoa_core).
+// Rounding the shortest digits to 6 places gives the same answer as
+// rounding the exact value, except maybe when the shortest digits are
+// exactly a tie (7 digits ending in 5), or for subnormals, which have
+// too few bits for their shortest digits to be 6 digits' worth. Those
+// return -1, as do infinities and NaN, to use snprintf.
+//
+// Returns the length of the conversion, with the same truncation
+// behavior as snprintf.
+static
+int _ftoa_fast(char* buf, size_t buf_sz, double num, int shortest,
+               int uppercase)
+{
+  char digits[20];
+  char tmp[32];
+  char* out;
+  int ndigits;
+  int exp10;
+  int fixed;
+  int len;
+
+  if( isnan(num) || isinf(num) ) return -1;
+  if( ! shortest && num != 0.0 && num < DBL_MIN ) return -1;
+
+  ndigits = _shortest_digits(num, digits, &exp10);
+
+  if( shortest ) {
+    fixed = (exp10 >= -4 && exp10 < 17);
+  } else {
+    if( ndigits > 6 ) {
+      int i;
+      if( ndigits == 7 && digits[6] == '5' ) return -1;
+      ndigits = 6;
+      if( digits[6] >= '5' ) {
+        for( i = 5; i >= 0 && digits[i] == '9'; i-- ) digits[i] = '0';
+        if( i >= 0 ) {
+          digits[i]++;
+        } else {
+          digits[0] = '1';
+          ndigits = 1;
+          exp10++;
+        }
+      }
+    }
+    while( ndigits > 1 && digits[ndigits - 1] == '0' ) ndigits--;
+    if( num >= 100000.0 && num < 1000000.0 ) fixed = 0;
+    else fixed = (exp10 >= -4 && exp10 < 6);
+  }
+
+  // Write directly when there's surely room.
+  out = (buf_sz >= sizeof(tmp)) ? buf : tmp;
+  len = _format_digits(out, digits, ndigits, exp10, fixed, uppercase);
+
+  if( out == tmp && buf_sz > 0 ) {
+    size_t n = (size_t) len < buf_sz ? (size_t) len : buf_sz - 1;
+    qio_memcpy(buf, tmp, n);
+    buf[n] = '\0';
+  } else if( out == buf ) {
+    buf[len] = '\0';
+  }
+
+  return len;
+}
+
 //This function finds where the last non-zero digit
 //is in the decimal part of an exponential number.
 //
@@ -3179,7 +4253,7 @@ static int _find_prec(char *buf, int len){
 // num is the number to be converted
 // buf and buf_sz are the output buffer
 // base is the numeric base (10 or 16 only)
-// realfmt is style->realfmt; 0->%g, 1->%f, 2->%e
+// realfmt is style->realfmt; 0->%g, 1->%f, 2->%e, 3->shortest round-trip
 // precision is the number of digits after . for %f or %e or
 //   the number of significant digits
 // uppercase indicates hex digits or exponent character should be uppercase
@@ -3212,6 +4286,15 @@ int _ftoa_core(char* buf, size_t buf_sz, double num,
 
   *skip = 0;
 
+  // The default %g, and the shortest round-trip format, usually don't
+  // need snprintf.
+  if( base == 10 && (realfmt == 3 || (realfmt == 0 && precision < 0)) ) {
+    got = _ftoa_fast(buf, buf_sz, num, realfmt == 3, uppercase);
+    if( got >= 0 ) return got;
+    // Otherwise, use %g (e.g. for inf and nan)
+    realfmt = 0;
+  }
+
   if( base == 16 ) {
     if( precision < 0 ) {
       if( uppercase ) {
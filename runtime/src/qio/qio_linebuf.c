@@ -0,0 +1,264 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Per-task line buffering for stdout and stderr
+//
+#include "sys_basic.h"
+
+#ifndef CHPL_RT_UNIT_TEST
+#include "chplrt.h"
+#include "chpl-env.h"
+#include "chpl-tasks.h"
+#endif
+
+#include "qio_linebuf.h"
+#include "qbuffer.h"
+#include "sys.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifndef CHPL_RT_UNIT_TEST
+#define LINEBUF_ENV_BOOL(name, dflt) chpl_env_rt_get_bool(name, dflt)
+#else
+#define LINEBUF_ENV_BOOL(name, dflt) (dflt)
+#endif
+
+#define LINEBUF_SIZE 4096
+
+// Buffers for fd 1 and fd 2.
+#define LINEBUF_NFDS 2
+#define LINEBUF_INDEX(fd) ((fd) - STDOUT_FILENO)
+
+struct qio_linebuf_s {
+  qio_linebuf_t* next;
+  qio_linebuf_t* prev;
+  // Only contended when qio_linebuf_flush_all() runs at exit.
+  pthread_mutex_t lock;
+  size_t len[LINEBUF_NFDS];
+  char buf[LINEBUF_NFDS][LINEBUF_SIZE];
+};
+
+// Every task's buffer, so that they can all be written out at exit.
+static qio_linebuf_t* all_linebufs;
+static pthread_mutex_t all_linebufs_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Held while writing to each fd, so that a buffer goes out in one
+// piece even if write() takes more than one call.
+static pthread_mutex_t fd_lock[LINEBUF_NFDS] = { PTHREAD_MUTEX_INITIALIZER,
+                                                 PTHREAD_MUTEX_INITIALIZER };
+
+static int enabled = -1;
+
+int qio_linebuf_enabled(void)
+{
+  if( enabled < 0 )
+    enabled = LINEBUF_ENV_BOOL("QIO_TASK_LINEBUF", 0) ? 1 : 0;
+  return enabled;
+}
+
+static
+err_t write_all_locked(int fd, const char* ptr, size_t len)
+{
+  ssize_t num_written;
+  err_t err = 0;
+
+  pthread_mutex_lock(&fd_lock[LINEBUF_INDEX(fd)]);
+
+  while( len > 0 ) {
+    err = sys_write(fd, ptr, len, &num_written);
+    if( err == EINTR ) continue;
+    if( err ) break;
+    ptr += num_written;
+    len -= num_written;
+  }
+
+  pthread_mutex_unlock(&fd_lock[LINEBUF_INDEX(fd)]);
+
+  return err;
+}
+
+// Write out the buffer for fd up through its last newline, or all of
+// it if 'all' is set or there is no newline.  Called with lb->lock held.
+static
+err_t drain(qio_linebuf_t* lb, int fd, int all)
+{
+  int i = LINEBUF_INDEX(fd);
+  size_t n = lb->len[i];
+  err_t err;
+
+  if( n == 0 ) return 0;
+
+  if( ! all ) {
+    const char* nl = NULL;
+    size_t j;
+    for( j = n; j > 0; j-- ) {
+      if( lb->buf[i][j-1] == '\n' ) {
+        nl = &lb->buf[i][j-1];
+        break;
+      }
+    }
+    if( nl ) n = nl - lb->buf[i] + 1;
+  }
+
+  err = write_all_locked(fd, lb->buf[i], n);
+
+  // Drop what was written even on error, so that a bad fd doesn't
+  // leave the task unable to make progress.
+  memmove(lb->buf[i], lb->buf[i] + n, lb->len[i] - n);
+  lb->len[i] -= n;
+
+  return err;
+}
+
+static
+qio_linebuf_t* task_linebuf(void)
+{
+#ifndef CHPL_RT_UNIT_TEST
+  chpl_task_infoRuntime_t* infoRuntime = chpl_task_getInfoRuntime();
+  qio_linebuf_t* lb;
+
+  if( infoRuntime == NULL ) return NULL;
+  if( infoRuntime->linebuf ) return infoRuntime->linebuf;
+
+  lb = (qio_linebuf_t*) qio_calloc(1, sizeof(qio_linebuf_t));
+  if( lb == NULL ) return NULL;
+  pthread_mutex_init(&lb->lock, NULL);
+
+  pthread_mutex_lock(&all_linebufs_lock);
+  lb->next = all_linebufs;
+  if( all_linebufs ) all_linebufs->prev = lb;
+  all_linebufs = lb;
+  pthread_mutex_unlock(&all_linebufs_lock);
+
+  infoRuntime->linebuf = lb;
+  return lb;
+#else
+  return NULL;
+#endif
+}
+
+int qio_linebuf_write(int fd, const void* ptr, size_t len,
+                      ssize_t* num_written_out)
+{
+  const char* p = (const char*) ptr;
+  size_t left = len;
+  qio_linebuf_t* lb;
+  err_t err = 0;
+  int i;
+
+  *num_written_out = 0;
+
+  if( fd != STDOUT_FILENO && fd != STDERR_FILENO )
+    return sys_write(fd, ptr, len, num_written_out);
+
+  lb = task_linebuf();
+  if( lb == NULL ) {
+    err = write_all_locked(fd, p, len);
+    if( ! err ) *num_written_out = len;
+    return err;
+  }
+
+  i = LINEBUF_INDEX(fd);
+
+  pthread_mutex_lock(&lb->lock);
+
+  while( left > 0 ) {
+    size_t amt = LINEBUF_SIZE - lb->len[i];
+    if( amt > left ) amt = left;
+
+    memcpy(lb->buf[i] + lb->len[i], p, amt);
+    lb->len[i] += amt;
+    p += amt;
+    left -= amt;
+
+    if( lb->len[i] == LINEBUF_SIZE ) {
+      err = drain(lb, fd, false);
+      if( err ) break;
+    }
+  }
+
+  pthread_mutex_unlock(&lb->lock);
+
+  *num_written_out = len - left;
+  return err;
+}
+
+int qio_linebuf_flush(int fd)
+{
+#ifndef CHPL_RT_UNIT_TEST
+  chpl_task_infoRuntime_t* infoRuntime;
+  qio_linebuf_t* lb;
+  err_t err;
+
+  if( fd != STDOUT_FILENO && fd != STDERR_FILENO ) return 0;
+
+  infoRuntime = chpl_task_getInfoRuntime();
+  if( infoRuntime == NULL || infoRuntime->linebuf == NULL ) return 0;
+
+  lb = infoRuntime->linebuf;
+  pthread_mutex_lock(&lb->lock);
+  err = drain(lb, fd, true);
+  pthread_mutex_unlock(&lb->lock);
+
+  return err;
+#else
+  return 0;
+#endif
+}
+
+void qio_linebuf_task_end(qio_linebuf_t** lbp)
+{
+  qio_linebuf_t* lb = *lbp;
+
+  if( lb == NULL ) return;
+
+  pthread_mutex_lock(&all_linebufs_lock);
+  if( lb->prev ) lb->prev->next = lb->next;
+  else all_linebufs = lb->next;
+  if( lb->next ) lb->next->prev = lb->prev;
+  pthread_mutex_unlock(&all_linebufs_lock);
+
+  pthread_mutex_lock(&lb->lock);
+  drain(lb, STDOUT_FILENO, true);
+  drain(lb, STDERR_FILENO, true);
+  pthread_mutex_unlock(&lb->lock);
+
+  pthread_mutex_destroy(&lb->lock);
+  qio_free(lb);
+  *lbp = NULL;
+}
+
+void qio_linebuf_flush_all(void)
+{
+  qio_linebuf_t* lb;
+
+  pthread_mutex_lock(&all_linebufs_lock);
+  for( lb = all_linebufs; lb != NULL; lb = lb->next ) {
+    pthread_mutex_lock(&lb->lock);
+    drain(lb, STDOUT_FILENO, true);
+    drain(lb, STDERR_FILENO, true);
+    pthread_mutex_unlock(&lb->lock);
+  }
+  pthread_mutex_unlock(&all_linebufs_lock);
+}
@@ -18,10 +18,15 @@
  * limitations under the License.
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // for POSIX_SPAWN_USEVFORK
+#endif
+
 #include "sys_basic.h"
 
 #ifndef CHPL_RT_UNIT_TEST
 #include "chplrt.h"
+#include "chpl-env.h"
 #endif
 
 #include "chpl-mem-sys.h" // need to call system allocator
@@ -31,8 +36,11 @@
 #include "qio_popen.h"
 
 #include <sys/select.h>
+#include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <sys/wait.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <spawn.h>
 
@@ -175,6 +183,8 @@ qioerr qio_do_openproc(const char** argv,
   int err_pipe[2];
   posix_spawn_file_actions_t actions;
   bool inited_actions = false;
+  posix_spawnattr_t attr;
+  bool inited_attr = false;
   bool hasactions = false;
   const char* progname;
 
@@ -219,21 +229,12 @@ qioerr qio_do_openproc(const char** argv,
   // In order for Cygwin support to work, because Windows
   // doesn't have a 'fork' call, we use posix_spawn.
 
-  // Note that posix_spawn *might* be faster on Linux if
-  // we don't specify any file actions, since it can use
-  // vfork and so avoid duplicating page tables.
-
-  // To request vfork for posix_spawn on linux/glibc,
-  // set the spawn attr POSIX_SPAWN_USEVFORK.
-  // It is unclear whether or not the linux implementation
-  // will work correctly when combining POSIX_SPAWN_USEVFORK
-  // with file actions (e.g. to make a pipe for stdin/stdout).
-
-  // If we seek to improve performance on linux, here are some options:
-  //  * POSIX_SPAWN_USEVFORK
-  //  * madvise(MADV_DONTFORK) on the Chapel heap
-  //  * implement fork/dup/exec with clone instead of fork on linux
-  //    (clone can avoid copying page tables).
+  // On linux/glibc we ask for POSIX_SPAWN_USEVFORK, so the child
+  // shares our address space until it execs instead of getting a copy
+  // of our page tables.  With a large registered heap that copy is
+  // slow and can fail outright.  (Recent glibc always spawns this way
+  // and ignores the flag; file actions work either way.)  Where even
+  // that isn't enough, see the spawn helper below.
 
   // Note: posix_spawn can use file descriptors that have
   // close-on-exec set as long as they are dup'd in a file action.
@@ -247,6 +248,20 @@ qioerr qio_do_openproc(const char** argv,
   inited_actions = true;
   hasactions = false;
 
+  rc = posix_spawnattr_init(&attr);
+  if( rc ) {
+    err = qio_int_to_err(rc);
+    goto error;
+  }
+  inited_attr = true;
+#ifdef POSIX_SPAWN_USEVFORK
+  rc = posix_spawnattr_setflags(&attr, POSIX_SPAWN_USEVFORK);
+  if( rc ) {
+    err = qio_int_to_err(rc);
+    goto error;
+  }
+#endif
+
   err = setup_actions(&actions, stdin_fd, in_pipe, 0, true, &hasactions);
   if( err ) goto error;
   err = setup_actions(&actions, stdout_fd, out_pipe, 1, false, &hasactions);
@@ -274,7 +289,7 @@ qioerr qio_do_openproc(const char** argv,
   // spawn the subprogram, searching the path, returning the pid in pid
   rc = posix_spawnp(&pid, progname,
                    hasactions?(&actions):(NULL), /* file actions */
-                   NULL, /* attributes */
+                   &attr, /* attributes */
                    (char*const*) argv,
                    // Use the current environment if none was specified.
                    (envp==NULL)?(environ):((char*const*) envp) );
@@ -283,9 +298,11 @@ qioerr qio_do_openproc(const char** argv,
     goto error;
   }
 
-  // destroy file actions, ignoring return code.
+  // destroy file actions and attributes, ignoring return codes.
   posix_spawn_file_actions_destroy(&actions);
   inited_actions = false;
+  posix_spawnattr_destroy(&attr);
+  inited_attr = false;
 
   // close the child-side of pipes. Return the parent side.
   if( in_pipe[0] != -1 ) {
@@ -312,6 +329,7 @@ error:
   DONE_SLOW_SYSCALL;
   // intentionally ignoring error returns here...
   if( inited_actions ) posix_spawn_file_actions_destroy(&actions);
+  if( inited_attr ) posix_spawnattr_destroy(&attr);
 
   if( in_pipe[0] ) close(in_pipe[0]);
   if( in_pipe[1] ) close(in_pipe[1]);
@@ -323,6 +341,493 @@ error:
   return err;
 }
 
+/* Persistent spawn helper.
+
+   With CHPL_RT_QIO_SPAWN_HELPER set, qio_spawn_helper_start() forks a
+   helper process early in program startup, while our heap is still
+   small.  From then on this process never forks: qio_openproc() sends
+   each request to the helper over a Unix socket, along with the file
+   descriptors the child should get (passed with SCM_RIGHTS), and the
+   helper spawns the child with qio_do_openproc().  The child is the
+   helper's, so the helper also does the waitpid() for qio_waitpid().
+
+   Only the process that started the helper uses it; a process forked
+   from that one after startup spawns for itself.
+ */
+
+enum {
+  SPAWN_HELPER_SPAWN = 1,
+  SPAWN_HELPER_WAIT = 2
+};
+
+// In a spawn request, a std fd that was sent along with the request.
+#define SPAWN_HELPER_FD_SENT (-100)
+
+typedef struct {
+  int32_t op;
+  int32_t std_fd[3];  // QIO_FD_FORWARD, QIO_FD_CLOSE or FD_SENT
+  int64_t pid;        // for WAIT
+  int64_t len;        // bytes of argument data following (SPAWN)
+} spawn_helper_req_t;
+
+typedef struct {
+  int32_t err;
+  int32_t done;
+  int32_t exitcode;
+  int64_t pid;
+} spawn_helper_reply_t;
+
+static int spawn_helper_fd = -1;
+static pid_t spawn_helper_owner = 0;
+static pthread_mutex_t spawn_helper_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static
+int spawn_helper_active(void)
+{
+  return spawn_helper_fd != -1 && getpid() == spawn_helper_owner;
+}
+
+static
+int spawn_helper_write_all(int fd, const void* buf, size_t len)
+{
+  const char* p = (const char*) buf;
+  while( len > 0 ) {
+    ssize_t n = write(fd, p, len);
+    if( n < 0 && errno == EINTR ) continue;
+    if( n <= 0 ) return errno ? errno : EPIPE;
+    p += n;
+    len -= n;
+  }
+  return 0;
+}
+
+static
+int spawn_helper_read_all(int fd, void* buf, size_t len)
+{
+  char* p = (char*) buf;
+  while( len > 0 ) {
+    ssize_t n = read(fd, p, len);
+    if( n < 0 && errno == EINTR ) continue;
+    if( n < 0 ) return errno;
+    if( n == 0 ) return EPIPE;
+    p += n;
+    len -= n;
+  }
+  return 0;
+}
+
+// Send a request header with up to 3 fds attached.
+static
+int spawn_helper_send_req(int sock, const spawn_helper_req_t* req,
+                          const int* fds, int nfds)
+{
+  struct msghdr msg;
+  struct iovec iov;
+  union {
+    struct cmsghdr align;
+    char buf[CMSG_SPACE(3 * sizeof(int))];
+  } cbuf;
+  ssize_t n;
+
+  memset(&msg, 0, sizeof(msg));
+  iov.iov_base = (void*) req;
+  iov.iov_len = sizeof(*req);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+
+  if( nfds > 0 ) {
+    struct cmsghdr* cmsg;
+    memset(&cbuf, 0, sizeof(cbuf));
+    msg.msg_control = cbuf.buf;
+    msg.msg_controllen = CMSG_SPACE(nfds * sizeof(int));
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(nfds * sizeof(int));
+    memcpy(CMSG_DATA(cmsg), fds, nfds * sizeof(int));
+  }
+
+  do {
+    n = sendmsg(sock, &msg, 0);
+  } while( n < 0 && errno == EINTR );
+
+  if( n < 0 ) return errno;
+  if( n != (ssize_t) sizeof(*req) ) return EPIPE;
+  return 0;
+}
+
+// Receive a request header and any fds attached to it.
+static
+int spawn_helper_recv_req(int sock, spawn_helper_req_t* req,
+                          int* fds, int* nfds)
+{
+  struct msghdr msg;
+  struct iovec iov;
+  union {
+    struct cmsghdr align;
+    char buf[CMSG_SPACE(3 * sizeof(int))];
+  } cbuf;
+  struct cmsghdr* cmsg;
+  ssize_t n;
+
+  memset(&msg, 0, sizeof(msg));
+  iov.iov_base = req;
+  iov.iov_len = sizeof(*req);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = cbuf.buf;
+  msg.msg_controllen = sizeof(cbuf.buf);
+
+  do {
+    n = recvmsg(sock, &msg, 0);
+  } while( n < 0 && errno == EINTR );
+
+  if( n <= 0 ) return n == 0 ? EPIPE : errno;
+
+  *nfds = 0;
+  for( cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg) ) {
+    if( cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS ) {
+      *nfds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+      memcpy(fds, CMSG_DATA(cmsg), *nfds * sizeof(int));
+    }
+  }
+
+  // The header is small, but a stream socket could still split it.
+  if( n < (ssize_t) sizeof(*req) ) {
+    return spawn_helper_read_all(sock, (char*) req + n, sizeof(*req) - n);
+  }
+  return 0;
+}
+
+// Argument data: executable, argc, argv..., envc (-1 for none), envp...
+// as NUL-terminated strings, with the counts in decimal.
+static
+char* spawn_helper_pack(const char** argv, const char** envp,
+                        const char* executable, int64_t* len_out)
+{
+  size_t len = 0;
+  int argc = 0;
+  int envc = -1;
+  char num[32];
+  char* buf;
+  char* p;
+  int i;
+
+  while( argv[argc] ) argc++;
+  if( envp ) for( envc = 0; envp[envc]; envc++ ) ;
+
+  len += strlen(executable ? executable : "") + 1;
+  len += 2 * sizeof(num);
+  for( i = 0; i < argc; i++ ) len += strlen(argv[i]) + 1;
+  for( i = 0; i < envc; i++ ) len += strlen(envp[i]) + 1;
+
+  buf = sys_malloc(len);
+  if( ! buf ) return NULL;
+  p = buf;
+
+  p = stpcpy(p, executable ? executable : "") + 1;
+  snprintf(num, sizeof(num), "%d", argc);
+  p = stpcpy(p, num) + 1;
+  for( i = 0; i < argc; i++ ) p = stpcpy(p, argv[i]) + 1;
+  snprintf(num, sizeof(num), "%d", envc);
+  p = stpcpy(p, num) + 1;
+  for( i = 0; i < envc; i++ ) p = stpcpy(p, envp[i]) + 1;
+
+  *len_out = p - buf;
+  return buf;
+}
+
+// Build argv/envp vectors pointing into packed argument data.
+static
+int spawn_helper_unpack(char* buf, int64_t len, const char** executable,
+                        const char*** argv, const char*** envp)
+{
+  char* p = buf;
+  char* end = buf + len;
+  int argc;
+  int envc;
+  int i;
+
+#define NEXT_STR(var) \
+  do { if( p >= end ) return EINVAL; var = p; p += strlen(p) + 1; } while(0)
+
+  NEXT_STR(*executable);
+  { const char* n; NEXT_STR(n); argc = atoi(n); }
+  if( argc < 1 ) return EINVAL;
+  *argv = qio_spawn_allocate_ptrvec(argc + 1);
+  for( i = 0; i < argc; i++ ) NEXT_STR((*argv)[i]);
+  { const char* n; NEXT_STR(n); envc = atoi(n); }
+  *envp = NULL;
+  if( envc >= 0 ) {
+    *envp = qio_spawn_allocate_ptrvec(envc + 1);
+    for( i = 0; i < envc; i++ ) NEXT_STR((*envp)[i]);
+  }
+
+#undef NEXT_STR
+
+  return 0;
+}
+
+static
+void spawn_helper_do_spawn(int sock, const spawn_helper_req_t* req,
+                           int* fds, int nfds)
+{
+  spawn_helper_reply_t reply;
+  const char* executable = NULL;
+  const char** argv = NULL;
+  const char** envp = NULL;
+  int std_fd[3];
+  char* buf = NULL;
+  int next = 0;
+  int i;
+
+  memset(&reply, 0, sizeof(reply));
+
+  buf = sys_malloc(req->len > 0 ? req->len : 1);
+  reply.err = buf ? spawn_helper_read_all(sock, buf, req->len) : ENOMEM;
+
+  if( ! reply.err ) {
+    reply.err = spawn_helper_unpack(buf, req->len, &executable, &argv, &envp);
+  }
+
+  for( i = 0; i < 3; i++ ) {
+    std_fd[i] = req->std_fd[i];
+    if( std_fd[i] == SPAWN_HELPER_FD_SENT ) {
+      std_fd[i] = (next < nfds) ? fds[next++] : QIO_FD_CLOSE;
+    }
+  }
+
+  if( ! reply.err ) {
+    int64_t pid = 0;
+    qioerr err = qio_do_openproc(argv, envp, executable,
+                                 &std_fd[0], &std_fd[1], &std_fd[2], &pid);
+    reply.err = qio_err_to_int(err);
+    reply.pid = pid;
+  }
+
+  // The child has its own copies of the fds now.
+  for( i = 0; i < nfds; i++ ) close(fds[i]);
+
+  if( argv ) qio_spawn_free_ptrvec(argv);
+  if( envp ) qio_spawn_free_ptrvec(envp);
+  if( buf ) sys_free(buf);
+
+  (void) spawn_helper_write_all(sock, &reply, sizeof(reply));
+}
+
+static
+void spawn_helper_do_wait(int sock, const spawn_helper_req_t* req)
+{
+  spawn_helper_reply_t reply;
+  int status = 0;
+  pid_t got;
+
+  memset(&reply, 0, sizeof(reply));
+
+  do {
+    got = waitpid((pid_t) req->pid, &status, WNOHANG);
+  } while( got == -1 && errno == EINTR );
+
+  if( got == -1 ) {
+    reply.err = errno;
+  } else if( got == (pid_t) req->pid ) {
+    if( WIFEXITED(status) ) {
+      reply.exitcode = WEXITSTATUS(status);
+      reply.done = 1;
+    } else if( WIFSIGNALED(status) ) {
+      reply.exitcode = -WTERMSIG(status);
+      reply.done = 1;
+    }
+  }
+
+  (void) spawn_helper_write_all(sock, &reply, sizeof(reply));
+}
+
+static
+void spawn_helper_main(int sock)
+{
+  while( 1 ) {
+    spawn_helper_req_t req;
+    int fds[3];
+    int nfds = 0;
+
+    // The program closed its end: it's done, and so are we.
+    if( spawn_helper_recv_req(sock, &req, fds, &nfds) != 0 ) _exit(0);
+
+    if( req.op == SPAWN_HELPER_SPAWN ) {
+      spawn_helper_do_spawn(sock, &req, fds, nfds);
+    } else {
+      int i;
+      for( i = 0; i < nfds; i++ ) close(fds[i]);
+      spawn_helper_do_wait(sock, &req);
+    }
+  }
+}
+
+void qio_spawn_helper_start(void)
+{
+  int sv[2];
+  pid_t pid;
+
+#ifndef CHPL_RT_UNIT_TEST
+  if( ! chpl_env_rt_get_bool("QIO_SPAWN_HELPER", false) ) return;
+#else
+  if( ! getenv("CHPL_RT_QIO_SPAWN_HELPER") ) return;
+#endif
+
+  if( socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0 ) return;
+
+  pid = fork();
+  if( pid == 0 ) {
+    close(sv[0]);
+    spawn_helper_main(sv[1]);
+    _exit(0);
+  }
+
+  close(sv[1]);
+  if( pid < 0 ) {
+    close(sv[0]);
+    return;
+  }
+
+  (void) fcntl(sv[0], F_SETFD, FD_CLOEXEC);
+  spawn_helper_fd = sv[0];
+  spawn_helper_owner = getpid();
+}
+
+// Send one request (and its argument data) and get the reply.
+static
+int spawn_helper_call(const spawn_helper_req_t* req, const int* fds, int nfds,
+                      const char* data, spawn_helper_reply_t* reply)
+{
+  int rc;
+
+  pthread_mutex_lock(&spawn_helper_lock);
+  rc = spawn_helper_send_req(spawn_helper_fd, req, fds, nfds);
+  if( ! rc && req->len > 0 ) {
+    rc = spawn_helper_write_all(spawn_helper_fd, data, req->len);
+  }
+  if( ! rc ) {
+    rc = spawn_helper_read_all(spawn_helper_fd, reply, sizeof(*reply));
+  }
+  pthread_mutex_unlock(&spawn_helper_lock);
+
+  return rc;
+}
+
+// The spawn helper version of qio_do_openproc().  We make the pipes
+// here and send the helper the child's ends of them.
+static
+qioerr spawn_helper_openproc(const char** argv,
+                             const char** envp,
+                             const char* executable,
+                             int* stdin_fd,
+                             int* stdout_fd,
+                             int* stderr_fd,
+                             int64_t *pid_out)
+{
+  int* std_fd[3] = { stdin_fd, stdout_fd, stderr_fd };
+  int pipes[3][2] = { { -1, -1 }, { -1, -1 }, { -1, -1 } };
+  spawn_helper_req_t req;
+  spawn_helper_reply_t reply;
+  int fds[3];
+  int nfds = 0;
+  char* data;
+  int rc = 0;
+  int i;
+
+  memset(&req, 0, sizeof(req));
+  req.op = SPAWN_HELPER_SPAWN;
+
+  for( i = 0; i < 3 && ! rc; i++ ) {
+    int fd = *std_fd[i];
+
+    if( fd == QIO_FD_TO_STDOUT ) {
+      // Same as stdout, which is already settled.
+      if( *stdout_fd == QIO_FD_PIPE || *stdout_fd == QIO_FD_BUFFERED_PIPE ) {
+        fd = pipes[1][1];
+      } else if( *stdout_fd == QIO_FD_FORWARD ) {
+        fd = 1;
+      } else {
+        fd = *stdout_fd;
+      }
+    } else if( fd == QIO_FD_PIPE || fd == QIO_FD_BUFFERED_PIPE ) {
+      if( pipe(pipes[i]) != 0 ) {
+        rc = errno;
+        break;
+      }
+      // For stdin the child reads from pipe[0]; otherwise it writes
+      // to pipe[1].
+      fd = (i == 0) ? pipes[i][0] : pipes[i][1];
+    }
+
+    if( fd == QIO_FD_FORWARD || fd == QIO_FD_CLOSE ) {
+      req.std_fd[i] = fd;
+    } else {
+      req.std_fd[i] = SPAWN_HELPER_FD_SENT;
+      fds[nfds++] = fd;
+    }
+  }
+
+  if( ! rc ) {
+    // The helper's environment is ours as of startup, so always send
+    // the current one.
+    data = spawn_helper_pack(argv, envp ? envp : (const char**) environ,
+                             executable, &req.len);
+    if( ! data ) rc = ENOMEM;
+  }
+
+  if( ! rc ) {
+    rc = spawn_helper_call(&req, fds, nfds, data, &reply);
+    sys_free(data);
+    if( ! rc ) rc = reply.err;
+  }
+
+  // Close the child's ends of the pipes and hand back ours.
+  for( i = 0; i < 3; i++ ) {
+    int parent_end = (i == 0) ? pipes[i][1] : pipes[i][0];
+    int child_end = (i == 0) ? pipes[i][0] : pipes[i][1];
+    if( child_end != -1 ) close(child_end);
+    if( parent_end != -1 ) {
+      if( rc ) close(parent_end);
+      else *std_fd[i] = parent_end;
+    }
+  }
+
+  if( rc ) return qio_int_to_err(rc);
+
+  *pid_out = reply.pid;
+  return 0;
+}
+
+static
+qioerr spawn_helper_waitpid(int64_t pid,
+                            int blocking, int* done, int* exitcode)
+{
+  spawn_helper_req_t req;
+  spawn_helper_reply_t reply;
+  int rc;
+
+  memset(&req, 0, sizeof(req));
+  req.op = SPAWN_HELPER_WAIT;
+  req.pid = pid;
+
+  while( 1 ) {
+    rc = spawn_helper_call(&req, NULL, 0, NULL, &reply);
+    if( ! rc ) rc = reply.err;
+    if( rc ) return qio_int_to_err(rc);
+    if( reply.done || ! blocking ) break;
+    chpl_task_yield();
+  }
+
+  if( reply.done ) {
+    *exitcode = reply.exitcode;
+    *done = 1;
+  }
+
+  return 0;
+}
+
 struct openproc_args_s {
   const char** argv;
   const char** envp;
@@ -369,6 +874,12 @@ qioerr qio_openproc(const char** argv,
   pthread_t thread;
   struct openproc_args_s s;
 
+  // The helper does the spawning, so no thread is needed.
+  if( spawn_helper_active() ) {
+    return spawn_helper_openproc(argv, envp, executable,
+                                 stdin_fd, stdout_fd, stderr_fd, pid_out);
+  }
+
   s.argv = argv;
   s.envp = envp;
   s.executable = executable;
@@ -398,6 +909,11 @@ qioerr qio_waitpid(int64_t pid,
   int flags = 0;
   pid_t got;
 
+  // Children spawned by the helper are its to wait for.
+  if( spawn_helper_active() ) {
+    return spawn_helper_waitpid(pid, blocking, done, exitcode);
+  }
+
   flags |= WNOHANG;
 
   do {
@@ -0,0 +1,1059 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sys_basic.h"
+
+#ifndef CHPL_RT_UNIT_TEST
+#include "chplrt.h"
+#include "chpl-env.h"
+#endif
+
+#include "qio_s3.h"
+#include "qio_plugin_api.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef CHPL_RT_UNIT_TEST
+#define S3_ENV_INT(name, dflt) chpl_env_rt_get_int(name, dflt)
+#define S3_ENV_STR(name, dflt) chpl_env_rt_get(name, dflt)
+#else
+#define S3_ENV_INT(name, dflt) (dflt)
+#define S3_ENV_STR(name, dflt) (dflt)
+#endif
+
+#ifdef QIO_S3
+
+#include <curl/curl.h>
+#include <pthread.h>
+
+#define S3_DEFAULT_CONNECTIONS 8
+#define S3_MAX_CONNECTIONS 256
+#define S3_ETAG_LEN 128
+
+typedef struct qio_s3_file_s {
+  char* url;      // endpoint/bucket/key
+  char* path;     // s3://bucket/key
+  char* userpwd;  // access key:secret key, or NULL to not sign
+  char* sigv4;    // CURLOPT_AWS_SIGV4 provider string
+  char* token;    // x-amz-security-token header, or NULL
+  int writing;
+  qio_hint_t hints;
+  int64_t chunk;
+  int connections;
+
+  qio_lock_t lock; // protects the fields below
+  int64_t length;
+  int has_writer;
+} qio_s3_file_t;
+
+// One request on a channel's multi handle
+typedef struct qio_s3_xfer_s {
+  CURL* easy;
+  struct curl_slist* headers;
+  int64_t offset;  // reading: where the range starts
+  int64_t len;
+  int64_t got;     // bytes received or sent
+  int64_t used;    // reading: bytes given to the channel
+  char* buf;
+  int part;        // writing: part number
+  char etag[S3_ETAG_LEN];
+  int done;
+  CURLcode rc;
+  long status;
+} qio_s3_xfer_t;
+
+typedef struct qio_s3_channel_s {
+  qio_s3_file_t* sf;
+  qio_channel_t* ch;
+  int writing;
+  CURLM* multi;
+  int depth;
+  // a ring of requests in flight, oldest first
+  qio_s3_xfer_t* xfers;
+  int head;
+  int count;
+  // reading: where the next range starts
+  int64_t next_off;
+  // writing
+  char* fill;
+  int64_t fill_len;
+  int64_t written;
+  char* upload_id;
+  int nparts;
+  int parts_cap;
+  char (*etags)[S3_ETAG_LEN];
+  qioerr err; // first error from a finished part
+} qio_s3_channel_t;
+
+// A growing buffer for small response bodies
+typedef struct s3_body_s {
+  char* data;
+  size_t len;
+  size_t cap;
+} s3_body_t;
+
+static pthread_once_t s3_curl_once = PTHREAD_ONCE_INIT;
+static CURLcode s3_curl_init_rc;
+
+static
+void s3_curl_init(void)
+{
+  s3_curl_init_rc = curl_global_init(CURL_GLOBAL_DEFAULT);
+}
+
+static
+qioerr s3_curl_error(CURLcode rc)
+{
+  switch( rc ) {
+    case CURLE_OK:
+      return 0;
+    case CURLE_OUT_OF_MEMORY:
+      return QIO_ENOMEM;
+    case CURLE_COULDNT_RESOLVE_HOST:
+    case CURLE_COULDNT_CONNECT:
+      QIO_RETURN_CONSTANT_ERROR(ECONNREFUSED, "could not connect to object store");
+    case CURLE_OPERATION_TIMEDOUT:
+      QIO_RETURN_CONSTANT_ERROR(ETIMEDOUT, "object store request timed out");
+    default:
+      QIO_RETURN_CONSTANT_ERROR(EIO, "object store request failed");
+  }
+}
+
+static
+qioerr s3_status_error(long status)
+{
+  if( status >= 200 && status < 300 ) return 0;
+  switch( status ) {
+    case 401:
+    case 403:
+      QIO_RETURN_CONSTANT_ERROR(EACCES, "object store denied access");
+    case 404:
+      QIO_RETURN_CONSTANT_ERROR(ENOENT, "no such object");
+    case 416:
+      return QIO_EEOF;
+    default:
+      QIO_RETURN_CONSTANT_ERROR(EIO, "object store returned an error");
+  }
+}
+
+static
+qioerr xfer_error(qio_s3_xfer_t* x)
+{
+  // An error response body can be cut short by the write callback,
+  // so the status says more than the curl code.
+  if( x->status != 0 && (x->status < 200 || x->status >= 300) )
+    return s3_status_error(x->status);
+  return s3_curl_error(x->rc);
+}
+
+static
+size_t s3_range_write_cb(char* data, size_t size, size_t n, void* arg)
+{
+  qio_s3_xfer_t* x = (qio_s3_xfer_t*) arg;
+  size_t len = size * n;
+
+  if( x->got + (int64_t) len > x->len ) return 0; // more than we asked for
+  memcpy(x->buf + x->got, data, len);
+  x->got += len;
+  return len;
+}
+
+static
+size_t s3_part_read_cb(char* data, size_t size, size_t n, void* arg)
+{
+  qio_s3_xfer_t* x = (qio_s3_xfer_t*) arg;
+  size_t len = size * n;
+
+  if( (int64_t) len > x->len - x->got ) len = x->len - x->got;
+  if( len > 0 ) memcpy(data, x->buf + x->got, len);
+  x->got += len;
+  return len;
+}
+
+// Save the ETag response header.
+static
+size_t s3_etag_header_cb(char* data, size_t size, size_t n, void* arg)
+{
+  qio_s3_xfer_t* x = (qio_s3_xfer_t*) arg;
+  size_t len = size * n;
+
+  if( len > 5 && strncasecmp(data, "ETag:", 5) == 0 ) {
+    size_t i = 5;
+    size_t j = len;
+    while( i < j && (data[i] == ' ' || data[i] == '\t') ) i++;
+    while( j > i && (data[j-1] == '\r' || data[j-1] == '\n' ||
+                     data[j-1] == ' ') ) j--;
+    if( j - i < S3_ETAG_LEN ) {
+      memcpy(x->etag, data + i, j - i);
+      x->etag[j - i] = '\0';
+    }
+  }
+  return len;
+}
+
+static
+size_t s3_body_write_cb(char* data, size_t size, size_t n, void* arg)
+{
+  s3_body_t* b = (s3_body_t*) arg;
+  size_t len = size * n;
+
+  if( b->len + len + 1 > b->cap ) {
+    size_t cap = 2 * (b->len + len + 1);
+    char* p = (char*) qio_realloc(b->data, cap);
+    if( ! p ) return 0;
+    b->data = p;
+    b->cap = cap;
+  }
+  memcpy(b->data + b->len, data, len);
+  b->len += len;
+  b->data[b->len] = '\0';
+  return len;
+}
+
+// Set the options every request uses.  url_suffix is appended to the
+// object's URL (e.g. "?uploads").
+static
+qioerr s3_setup_easy(qio_s3_file_t* sf, CURL* easy, const char* url_suffix,
+                     struct curl_slist** headers)
+{
+  char* url;
+  size_t len;
+
+  len = strlen(sf->url) + strlen(url_suffix) + 1;
+  url = (char*) qio_malloc(len);
+  if( ! url ) return QIO_ENOMEM;
+  snprintf(url, len, "%s%s", sf->url, url_suffix);
+  curl_easy_setopt(easy, CURLOPT_URL, url);
+  qio_free(url); // curl copies string options
+
+  curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+  if( sf->userpwd ) {
+    curl_easy_setopt(easy, CURLOPT_USERPWD, sf->userpwd);
+#if LIBCURL_VERSION_NUM >= 0x074b00
+    curl_easy_setopt(easy, CURLOPT_AWS_SIGV4, sf->sigv4);
+#endif
+  }
+
+  // Don't wait for 100 Continue before sending a part.
+  *headers = curl_slist_append(*headers, "Expect:");
+  if( sf->token ) *headers = curl_slist_append(*headers, sf->token);
+  curl_easy_setopt(easy, CURLOPT_HTTPHEADER, *headers);
+  return 0;
+}
+
+// Do one request and wait for it, saving the body if body_out is set.
+static
+qioerr s3_request(qio_s3_file_t* sf, const char* method,
+                  const char* url_suffix, const char* upload,
+                  int64_t upload_len, s3_body_t* body_out,
+                  int64_t* length_out)
+{
+  CURL* easy;
+  struct curl_slist* headers = NULL;
+  qio_s3_xfer_t up;
+  s3_body_t ignored = { NULL, 0, 0 };
+  long status = 0;
+  CURLcode rc;
+  qioerr err;
+
+  easy = curl_easy_init();
+  if( ! easy ) return QIO_ENOMEM;
+
+  err = s3_setup_easy(sf, easy, url_suffix, &headers);
+  if( err ) goto done;
+
+  if( ! body_out ) body_out = &ignored;
+  curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, s3_body_write_cb);
+  curl_easy_setopt(easy, CURLOPT_WRITEDATA, body_out);
+
+  if( strcmp(method, "HEAD") == 0 ) {
+    curl_easy_setopt(easy, CURLOPT_NOBODY, 1L);
+  } else if( strcmp(method, "PUT") == 0 ) {
+    memset(&up, 0, sizeof(up));
+    up.buf = (char*) upload;
+    up.len = upload_len;
+    curl_easy_setopt(easy, CURLOPT_UPLOAD, 1L);
+    curl_easy_setopt(easy, CURLOPT_READFUNCTION, s3_part_read_cb);
+    curl_easy_setopt(easy, CURLOPT_READDATA, &up);
+    curl_easy_setopt(easy, CURLOPT_INFILESIZE_LARGE, (curl_off_t) upload_len);
+  } else if( strcmp(method, "POST") == 0 ) {
+    curl_easy_setopt(easy, CURLOPT_POST, 1L);
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDS, upload ? upload : "");
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE_LARGE,
+                     (curl_off_t) (upload ? upload_len : 0));
+  } else {
+    curl_easy_setopt(easy, CURLOPT_CUSTOMREQUEST, method);
+  }
+
+  rc = curl_easy_perform(easy);
+  curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &status);
+  if( status != 0 ) err = s3_status_error(status);
+  else err = s3_curl_error(rc);
+  if( ! err && rc != CURLE_OK ) err = s3_curl_error(rc);
+
+  if( ! err && length_out ) {
+    curl_off_t len = -1;
+    curl_easy_getinfo(easy, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &len);
+    if( len < 0 ) {
+      QIO_GET_CONSTANT_ERROR(err, EIO, "object store did not give a length");
+    }
+    *length_out = len;
+  }
+
+  // Some stores report a failed completion with 200 and an Error body.
+  if( ! err && body_out->data && strstr(body_out->data, "<Error>") ) {
+    QIO_GET_CONSTANT_ERROR(err, EIO, "object store returned an error");
+  }
+
+done:
+  curl_slist_free_all(headers);
+  curl_easy_cleanup(easy);
+  qio_free(ignored.data);
+  return err;
+}
+
+static
+void xfer_free(qio_s3_channel_t* sc, qio_s3_xfer_t* x)
+{
+  if( x->easy ) {
+    curl_multi_remove_handle(sc->multi, x->easy);
+    curl_easy_cleanup(x->easy);
+  }
+  curl_slist_free_all(x->headers);
+  qio_free(x->buf);
+  x->easy = NULL;
+  x->headers = NULL;
+  x->buf = NULL;
+}
+
+// Let the multi handle make progress, and mark finished requests done.
+// Waits for x to finish if x is not NULL.
+static
+void s3_pump(qio_s3_channel_t* sc, qio_s3_xfer_t* x)
+{
+  while( 1 ) {
+    int running = 0;
+    int left = 0;
+    CURLMsg* msg;
+
+    curl_multi_perform(sc->multi, &running);
+    while( (msg = curl_multi_info_read(sc->multi, &left)) ) {
+      if( msg->msg == CURLMSG_DONE ) {
+        qio_s3_xfer_t* done = NULL;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**) &done);
+        done->rc = msg->data.result;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE,
+                          &done->status);
+        done->done = 1;
+      }
+    }
+
+    if( ! x || x->done ) break;
+    curl_multi_wait(sc->multi, NULL, 0, 100, NULL);
+  }
+}
+
+static
+qioerr xfer_start(qio_s3_channel_t* sc, qio_s3_xfer_t* x,
+                  const char* url_suffix)
+{
+  qioerr err;
+
+  x->easy = curl_easy_init();
+  if( ! x->easy ) return QIO_ENOMEM;
+  err = s3_setup_easy(sc->sf, x->easy, url_suffix, &x->headers);
+  if( err ) return err;
+  curl_easy_setopt(x->easy, CURLOPT_PRIVATE, x);
+
+  if( sc->writing ) {
+    curl_easy_setopt(x->easy, CURLOPT_UPLOAD, 1L);
+    curl_easy_setopt(x->easy, CURLOPT_READFUNCTION, s3_part_read_cb);
+    curl_easy_setopt(x->easy, CURLOPT_READDATA, x);
+    curl_easy_setopt(x->easy, CURLOPT_INFILESIZE_LARGE, (curl_off_t) x->len);
+    curl_easy_setopt(x->easy, CURLOPT_HEADERFUNCTION, s3_etag_header_cb);
+    curl_easy_setopt(x->easy, CURLOPT_HEADERDATA, x);
+  } else {
+    char range[64];
+    snprintf(range, sizeof(range), "%lld-%lld", (long long) x->offset,
+             (long long) (x->offset + x->len - 1));
+    curl_easy_setopt(x->easy, CURLOPT_RANGE, range);
+    curl_easy_setopt(x->easy, CURLOPT_WRITEFUNCTION, s3_range_write_cb);
+    curl_easy_setopt(x->easy, CURLOPT_WRITEDATA, x);
+  }
+
+  if( curl_multi_add_handle(sc->multi, x->easy) != CURLM_OK ) return QIO_ENOMEM;
+  return 0;
+}
+
+static
+void pop_head(qio_s3_channel_t* sc)
+{
+  xfer_free(sc, &sc->xfers[sc->head]);
+  sc->head = (sc->head + 1) % sc->depth;
+  sc->count--;
+}
+
+static
+void drain(qio_s3_channel_t* sc)
+{
+  while( sc->count > 0 ) pop_head(sc);
+}
+
+// Start ranged GETs until the ring is full, stopping at end.
+static
+qioerr start_reads(qio_s3_channel_t* sc, int64_t end)
+{
+  qioerr err;
+
+  while( sc->count < sc->depth && sc->next_off < end ) {
+    qio_s3_xfer_t* x = &sc->xfers[(sc->head + sc->count) % sc->depth];
+
+    memset(x, 0, sizeof(*x));
+    x->offset = sc->next_off;
+    x->len = sc->sf->chunk;
+    if( x->len > end - x->offset ) x->len = end - x->offset;
+    x->buf = (char*) qio_malloc(x->len);
+    sc->count++;
+    if( ! x->buf ) return QIO_ENOMEM;
+    err = xfer_start(sc, x, "");
+    if( err ) return err;
+    sc->next_off += x->len;
+  }
+  s3_pump(sc, NULL);
+  return 0;
+}
+
+static
+qioerr s3_read_atleast(void* plugin_ch, int64_t amt)
+{
+  qio_s3_channel_t* sc = (qio_s3_channel_t*) plugin_ch;
+  qio_channel_t* ch = sc->ch;
+  int64_t end = sc->sf->length;
+  int64_t got = 0;
+  qioerr err = 0;
+
+  if( sc->writing ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "channel is not readable");
+
+  if( end > ch->end_pos ) end = ch->end_pos;
+  if( ch->av_end >= end ) return QIO_EEOF;
+
+  while( got < amt ) {
+    int64_t pos = ch->av_end;
+    qio_s3_xfer_t* x;
+    int64_t skip, len;
+
+    if( pos >= end ) return QIO_EEOF;
+
+    // Start over if the channel moved away from the ranges in flight.
+    if( sc->count > 0 ) {
+      x = &sc->xfers[sc->head];
+      if( pos < x->offset || pos >= x->offset + x->len ) drain(sc);
+    }
+    if( sc->count == 0 ) sc->next_off = pos;
+
+    err = start_reads(sc, end);
+    if( err ) {
+      drain(sc);
+      return err;
+    }
+
+    x = &sc->xfers[sc->head];
+    s3_pump(sc, x);
+    err = xfer_error(x);
+    if( ! err && x->got != x->len ) {
+      QIO_GET_CONSTANT_ERROR(err, EIO, "object store returned a short range");
+    }
+    if( err ) {
+      drain(sc);
+      return err;
+    }
+
+    skip = pos - x->offset;
+    len = x->len - skip;
+    err = qio_channel_copy_to_available_unlocked(ch, x->buf + skip, len);
+    got += ch->av_end - pos;
+    if( ch->av_end >= x->offset + x->len ) pop_head(sc);
+    if( err ) {
+      if( qio_err_to_int(err) == EEOF && got >= amt ) err = 0;
+      return err;
+    }
+    if( ch->av_end == pos ) break; // no buffer space
+  }
+
+  return 0;
+}
+
+// Pull the value of <tag>...</tag> out of an XML response.
+static
+char* xml_value(const char* xml, const char* tag)
+{
+  char open[64], close[64];
+  const char* start;
+  const char* stop;
+  char* ret;
+
+  snprintf(open, sizeof(open), "<%s>", tag);
+  snprintf(close, sizeof(close), "</%s>", tag);
+  if( ! xml ) return NULL;
+  start = strstr(xml, open);
+  if( ! start ) return NULL;
+  start += strlen(open);
+  stop = strstr(start, close);
+  if( ! stop ) return NULL;
+
+  ret = (char*) qio_malloc(stop - start + 1);
+  if( ! ret ) return NULL;
+  memcpy(ret, start, stop - start);
+  ret[stop - start] = '\0';
+  return ret;
+}
+
+static
+qioerr create_upload(qio_s3_channel_t* sc)
+{
+  s3_body_t body = { NULL, 0, 0 };
+  qioerr err;
+
+  err = s3_request(sc->sf, "POST", "?uploads", NULL, 0, &body, NULL);
+  if( ! err ) {
+    sc->upload_id = xml_value(body.data, "UploadId");
+    if( ! sc->upload_id ) {
+      QIO_GET_CONSTANT_ERROR(err, EIO, "object store did not start an upload");
+    }
+  }
+  qio_free(body.data);
+  return err;
+}
+
+// Wait for the oldest part in flight and record its ETag.
+static
+qioerr finish_part(qio_s3_channel_t* sc)
+{
+  qio_s3_xfer_t* x = &sc->xfers[sc->head];
+  qioerr err;
+
+  s3_pump(sc, x);
+  err = xfer_error(x);
+  if( ! err && x->etag[0] == '\0' ) {
+    QIO_GET_CONSTANT_ERROR(err, EIO, "object store did not return an ETag");
+  }
+  if( ! err ) memcpy(sc->etags[x->part - 1], x->etag, S3_ETAG_LEN);
+  if( err && ! sc->err ) sc->err = err;
+
+  pop_head(sc);
+  return sc->err;
+}
+
+// Start uploading the filled buffer as the next part.
+static
+qioerr submit_part(qio_s3_channel_t* sc)
+{
+  qio_s3_xfer_t* x;
+  char* id;
+  char* suffix;
+  size_t len;
+  qioerr err;
+
+  if( ! sc->upload_id ) {
+    err = create_upload(sc);
+    if( err ) return err;
+  }
+
+  if( sc->count == sc->depth ) {
+    err = finish_part(sc);
+    if( err ) return err;
+  }
+
+  if( sc->nparts == sc->parts_cap ) {
+    int cap = sc->parts_cap ? 2 * sc->parts_cap : 16;
+    char (*etags)[S3_ETAG_LEN] = qio_realloc(sc->etags, cap * S3_ETAG_LEN);
+    if( ! etags ) return QIO_ENOMEM;
+    sc->etags = etags;
+    sc->parts_cap = cap;
+  }
+  sc->nparts++;
+
+  x = &sc->xfers[(sc->head + sc->count) % sc->depth];
+  memset(x, 0, sizeof(*x));
+  x->part = sc->nparts;
+  x->len = sc->fill_len;
+  x->buf = sc->fill;
+  sc->fill = NULL;
+  sc->fill_len = 0;
+  sc->count++;
+
+  id = curl_easy_escape(NULL, sc->upload_id, 0);
+  len = id ? strlen(id) + 64 : 0;
+  suffix = id ? (char*) qio_malloc(len) : NULL;
+  if( ! suffix ) {
+    curl_free(id);
+    return QIO_ENOMEM;
+  }
+  snprintf(suffix, len, "?partNumber=%d&uploadId=%s", x->part, id);
+  curl_free(id);
+  err = xfer_start(sc, x, suffix);
+  qio_free(suffix);
+  if( err ) return err;
+
+  s3_pump(sc, NULL);
+  return 0;
+}
+
+static
+qioerr s3_write(void* plugin_ch, int64_t amt)
+{
+  qio_s3_channel_t* sc = (qio_s3_channel_t*) plugin_ch;
+  int64_t chunk = sc->sf->chunk;
+  qioerr err;
+
+  if( ! sc->writing ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "channel is not writeable");
+  if( sc->err ) return sc->err;
+
+  while( amt > 0 ) {
+    ssize_t n, got = 0;
+
+    if( ! sc->fill ) {
+      sc->fill = (char*) qio_malloc(chunk);
+      if( ! sc->fill ) return QIO_ENOMEM;
+    }
+
+    n = chunk - sc->fill_len;
+    if( n > amt ) n = amt;
+    err = qio_channel_copy_from_buffered_unlocked(sc->ch,
+                                                  sc->fill + sc->fill_len,
+                                                  n, &got);
+    if( err ) return err;
+    if( got == 0 ) break;
+    sc->fill_len += got;
+    sc->written += got;
+    amt -= got;
+
+    if( sc->fill_len == chunk ) {
+      err = submit_part(sc);
+      if( err ) {
+        if( ! sc->err ) sc->err = err;
+        return err;
+      }
+    }
+  }
+
+  return 0;
+}
+
+static
+qioerr complete_upload(qio_s3_channel_t* sc)
+{
+  char* xml;
+  char* id;
+  char* suffix;
+  size_t cap, len = 0;
+  int i;
+  qioerr err;
+
+  cap = 64 + (size_t) sc->nparts * (64 + S3_ETAG_LEN);
+  xml = (char*) qio_malloc(cap);
+  id = curl_easy_escape(NULL, sc->upload_id, 0);
+  suffix = id ? (char*) qio_malloc(strlen(id) + 16) : NULL;
+  if( ! xml || ! id || ! suffix ) {
+    qio_free(xml);
+    curl_free(id);
+    return QIO_ENOMEM;
+  }
+  sprintf(suffix, "?uploadId=%s", id);
+  curl_free(id);
+
+  len += snprintf(xml + len, cap - len, "<CompleteMultipartUpload>");
+  for( i = 0; i < sc->nparts; i++ ) {
+    len += snprintf(xml + len, cap - len,
+                    "<Part><PartNumber>%d</PartNumber><ETag>%s</ETag></Part>",
+                    i + 1, sc->etags[i]);
+  }
+  len += snprintf(xml + len, cap - len, "</CompleteMultipartUpload>");
+
+  err = s3_request(sc->sf, "POST", suffix, xml, len, NULL, NULL);
+  if( err ) {
+    s3_request(sc->sf, "DELETE", suffix, NULL, 0, NULL, NULL);
+  }
+
+  qio_free(xml);
+  qio_free(suffix);
+  return err;
+}
+
+static
+void abort_upload(qio_s3_channel_t* sc)
+{
+  char* id = curl_easy_escape(NULL, sc->upload_id, 0);
+  char* suffix = id ? (char*) qio_malloc(strlen(id) + 16) : NULL;
+
+  if( suffix ) {
+    sprintf(suffix, "?uploadId=%s", id);
+    s3_request(sc->sf, "DELETE", suffix, NULL, 0, NULL, NULL);
+  }
+  curl_free(id);
+  qio_free(suffix);
+}
+
+static
+qioerr s3_channel_close(void* plugin_ch)
+{
+  qio_s3_channel_t* sc = (qio_s3_channel_t*) plugin_ch;
+  qio_s3_file_t* sf = sc->sf;
+  qioerr err = 0;
+
+  if( sc->writing ) {
+    if( ! sc->upload_id && ! sc->err ) {
+      // Small enough for one PUT.
+      err = s3_request(sf, "PUT", "", sc->fill, sc->fill_len, NULL, NULL);
+      if( err ) sc->err = err;
+    } else {
+      if( ! sc->err && sc->fill_len > 0 ) {
+        err = submit_part(sc);
+        if( err && ! sc->err ) sc->err = err;
+      }
+      while( sc->count > 0 ) finish_part(sc);
+      if( ! sc->err ) sc->err = complete_upload(sc);
+      else if( sc->upload_id ) abort_upload(sc);
+    }
+    err = sc->err;
+
+    if( ! qio_lock(&sf->lock) ) {
+      if( ! err ) sf->length = sc->written;
+      sf->has_writer = 0;
+      qio_unlock(&sf->lock);
+    }
+  } else {
+    drain(sc);
+  }
+
+  curl_multi_cleanup(sc->multi);
+  qio_free(sc->xfers);
+  qio_free(sc->fill);
+  qio_free(sc->upload_id);
+  qio_free(sc->etags);
+  qio_free(sc);
+  return err;
+}
+
+static
+qioerr s3_setup_channel(void* file, void** plugin_ch, int64_t start,
+                        int64_t end, qio_channel_t* qio_ch)
+{
+  qio_s3_file_t* sf = (qio_s3_file_t*) file;
+  qio_s3_channel_t* sc;
+  qio_hint_t hints = sf->hints | qio_ch->hints;
+  int writing = (qio_ch->flags & QIO_FDFLAG_WRITEABLE) != 0;
+  qioerr err;
+
+  if( writing != sf->writing ) {
+    if( sf->writing ) {
+      QIO_RETURN_CONSTANT_ERROR(EINVAL, "object is open for writing only");
+    } else {
+      QIO_RETURN_CONSTANT_ERROR(EINVAL, "object is open for reading only");
+    }
+  }
+
+  if( writing ) {
+    err = qio_lock(&sf->lock);
+    if( err ) return err;
+    if( sf->has_writer || start != 0 ) {
+      qio_unlock(&sf->lock);
+      QIO_RETURN_CONSTANT_ERROR(ESPIPE, "objects are written by one channel from the start");
+    }
+    sf->has_writer = 1;
+    qio_unlock(&sf->lock);
+  }
+
+  sc = (qio_s3_channel_t*) qio_calloc(1, sizeof(qio_s3_channel_t));
+  if( ! sc ) {
+    err = QIO_ENOMEM;
+    goto error;
+  }
+  sc->sf = sf;
+  sc->ch = qio_ch;
+  sc->writing = writing;
+
+  if( writing || (hints & QIO_HINT_SEQUENTIAL) ) {
+    sc->depth = sf->connections;
+  } else if( hints & QIO_HINT_PARALLEL ) {
+    sc->depth = 2;
+  } else {
+    sc->depth = sf->connections / 2;
+  }
+  if( sc->depth < 1 ) sc->depth = 1;
+
+  sc->xfers = (qio_s3_xfer_t*) qio_calloc(sc->depth, sizeof(qio_s3_xfer_t));
+  sc->multi = curl_multi_init();
+  if( ! sc->xfers || ! sc->multi ) {
+    if( sc->multi ) curl_multi_cleanup(sc->multi);
+    qio_free(sc->xfers);
+    qio_free(sc);
+    err = QIO_ENOMEM;
+    goto error;
+  }
+  curl_multi_setopt(sc->multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long) sc->depth);
+
+  *plugin_ch = sc;
+  return 0;
+
+error:
+  if( writing && ! qio_lock(&sf->lock) ) {
+    sf->has_writer = 0;
+    qio_unlock(&sf->lock);
+  }
+  return err;
+}
+
+static
+qioerr s3_filelength(void* file, int64_t* length)
+{
+  qio_s3_file_t* sf = (qio_s3_file_t*) file;
+  qioerr err;
+
+  err = qio_lock(&sf->lock);
+  if( err ) return err;
+  *length = sf->length;
+  qio_unlock(&sf->lock);
+  return 0;
+}
+
+static
+qioerr s3_getpath(void* file, const char** str, int64_t* len)
+{
+  qio_s3_file_t* sf = (qio_s3_file_t*) file;
+
+  *str = qio_strdup(sf->path);
+  if( ! *str ) return QIO_ENOMEM;
+  *len = strlen(*str);
+  return 0;
+}
+
+static
+qioerr s3_fsync(void* file)
+{
+  // Objects are stored when the writing channel is closed.
+  return 0;
+}
+
+static
+qioerr s3_get_chunk(void* file, int64_t* length)
+{
+  qio_s3_file_t* sf = (qio_s3_file_t*) file;
+  *length = sf->chunk;
+  return 0;
+}
+
+static
+void s3_file_free(qio_s3_file_t* sf)
+{
+  qio_free(sf->url);
+  qio_free(sf->path);
+  qio_free(sf->userpwd);
+  qio_free(sf->sigv4);
+  qio_free(sf->token);
+  qio_free(sf);
+}
+
+static
+qioerr s3_file_close(void* file)
+{
+  qio_s3_file_t* sf = (qio_s3_file_t*) file;
+
+  qio_lock_destroy(&sf->lock);
+  s3_file_free(sf);
+  return 0;
+}
+
+static const qio_plugin_ops_t s3_ops = {
+  s3_setup_channel,
+  s3_read_atleast,
+  s3_write,
+  s3_channel_close,
+  s3_filelength,
+  s3_getpath,
+  s3_fsync,
+  s3_get_chunk,
+  NULL, // get_locales_for_region
+  s3_file_close,
+};
+
+static
+char* s3_strcat3(const char* a, const char* b, const char* c)
+{
+  size_t len = strlen(a) + strlen(b) + strlen(c) + 1;
+  char* ret = (char*) qio_malloc(len);
+  if( ret ) snprintf(ret, len, "%s%s%s", a, b, c);
+  return ret;
+}
+
+// Build endpoint/bucket/key, escaping each part of the key.
+static
+char* s3_object_url(const char* endpoint, const char* bucket, const char* key)
+{
+  size_t cap = strlen(endpoint) + 3 * (strlen(bucket) + strlen(key)) + 3;
+  char* url = (char*) qio_malloc(cap);
+  size_t len;
+  const char* p = key;
+
+  if( ! url ) return NULL;
+  len = snprintf(url, cap, "%s/%s", endpoint, bucket);
+  if( len > 0 && url[len-1] == '/' ) len--; // trailing / on endpoint
+  while( *p ) {
+    const char* slash = strchr(p, '/');
+    size_t n = slash ? (size_t) (slash - p) : strlen(p);
+    char* part = curl_easy_escape(NULL, p, n);
+    if( ! part ) {
+      qio_free(url);
+      return NULL;
+    }
+    len += snprintf(url + len, cap - len, "/%s", part);
+    curl_free(part);
+    p += n;
+    if( *p == '/' ) p++;
+  }
+  return url;
+}
+
+static
+qioerr s3_file_setup(qio_s3_file_t* sf, const char* path,
+                     const char* endpoint)
+{
+  const char* access = getenv("AWS_ACCESS_KEY_ID");
+  const char* secret = getenv("AWS_SECRET_ACCESS_KEY");
+  const char* token = getenv("AWS_SESSION_TOKEN");
+  const char* region = getenv("AWS_REGION");
+  const char* slash;
+  char* bucket;
+  char* aws = NULL;
+
+  if( ! region || ! region[0] ) region = getenv("AWS_DEFAULT_REGION");
+  if( ! region || ! region[0] ) region = "us-east-1";
+
+  if( strncmp(path, "s3://", 5) == 0 ) path += 5;
+  slash = strchr(path, '/');
+  if( ! slash || slash == path || slash[1] == '\0' ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "object path should be s3://bucket/key");
+  }
+
+  if( ! endpoint ) endpoint = S3_ENV_STR("QIO_S3_ENDPOINT", NULL);
+  if( ! endpoint || ! endpoint[0] ) {
+    aws = s3_strcat3("https://s3.", region, ".amazonaws.com");
+    if( ! aws ) return QIO_ENOMEM;
+    endpoint = aws;
+  }
+
+  bucket = (char*) qio_malloc(slash - path + 1);
+  if( ! bucket ) {
+    qio_free(aws);
+    return QIO_ENOMEM;
+  }
+  memcpy(bucket, path, slash - path);
+  bucket[slash - path] = '\0';
+
+  sf->url = s3_object_url(endpoint, bucket, slash + 1);
+  sf->path = s3_strcat3("s3://", path, "");
+  qio_free(bucket);
+  qio_free(aws);
+  if( ! sf->url || ! sf->path ) return QIO_ENOMEM;
+
+  if( access && access[0] && secret && secret[0] ) {
+    sf->userpwd = s3_strcat3(access, ":", secret);
+    sf->sigv4 = s3_strcat3("aws:amz:", region, ":s3");
+    if( ! sf->userpwd || ! sf->sigv4 ) return QIO_ENOMEM;
+    if( token && token[0] ) {
+      sf->token = s3_strcat3("x-amz-security-token: ", token, "");
+      if( ! sf->token ) return QIO_ENOMEM;
+    }
+  }
+
+  return 0;
+}
+
+qioerr qio_file_open_s3(qio_file_t** file_out, const char* path,
+                        const char* endpoint, qio_fdflag_t fdflags,
+                        qio_hint_t iohints, const qio_style_t* style)
+{
+  qio_s3_file_t* sf;
+  int readable = (fdflags & QIO_FDFLAG_READABLE) != 0;
+  int writeable = (fdflags & QIO_FDFLAG_WRITEABLE) != 0;
+  int64_t chunk, connections;
+  qioerr err;
+
+  *file_out = NULL;
+
+  if( readable == writeable ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "objects are either read or written");
+  }
+
+  pthread_once(&s3_curl_once, s3_curl_init);
+  if( s3_curl_init_rc != CURLE_OK ) return s3_curl_error(s3_curl_init_rc);
+
+  sf = (qio_s3_file_t*) qio_calloc(1, sizeof(qio_s3_file_t));
+  if( ! sf ) return QIO_ENOMEM;
+
+  err = qio_lock_init(&sf->lock);
+  if( err ) {
+    qio_free(sf);
+    return err;
+  }
+
+  err = s3_file_setup(sf, path, endpoint);
+  if( err ) goto error;
+
+  chunk = S3_ENV_INT("QIO_S3_CHUNK", QIO_S3_DEFAULT_CHUNK);
+  connections = S3_ENV_INT("QIO_S3_CONNECTIONS", S3_DEFAULT_CONNECTIONS);
+  if( chunk < 1 ) chunk = QIO_S3_DEFAULT_CHUNK;
+  if( writeable && chunk < QIO_S3_MIN_PART ) chunk = QIO_S3_MIN_PART;
+  if( connections < 1 ) connections = 1;
+  if( connections > S3_MAX_CONNECTIONS ) connections = S3_MAX_CONNECTIONS;
+  sf->chunk = chunk;
+  sf->connections = connections;
+  sf->hints = iohints;
+  sf->writing = writeable;
+
+  if( readable ) {
+    err = s3_request(sf, "HEAD", "", NULL, 0, NULL, &sf->length);
+    if( err ) goto error;
+    fdflags |= QIO_FDFLAG_SEEKABLE;
+  }
+
+  err = qio_file_init_plugin_ops(file_out, sf, &s3_ops, fdflags, style);
+  if( err ) goto error;
+  return 0;
+
+error:
+  qio_lock_destroy(&sf->lock);
+  s3_file_free(sf);
+  return err;
+}
+
+#else
+
+qioerr qio_file_open_s3(qio_file_t** file_out, const char* path,
+                        const char* endpoint, qio_fdflag_t fdflags,
+                        qio_hint_t iohints, const qio_style_t* style)
+{
+  *file_out = NULL;
+  QIO_RETURN_CONSTANT_ERROR(ENOSYS, "object store support requires libcurl");
+}
+
+#endif
@@ -0,0 +1,241 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sys_basic.h"
+
+#ifndef CHPL_RT_UNIT_TEST
+#include "chplrt.h"
+#endif
+
+#include "qio_split.h"
+
+#include <string.h>
+#include <fcntl.h>
+
+#define SPLIT_SCAN_BYTES 4096
+
+// Find the offset just past the first delimiter that ends at or after
+// target; end if there isn't one.
+static
+qioerr find_record_start(qio_file_t* file, int64_t target, int64_t end,
+                         int32_t delim, const qio_regexp_t* regexp,
+                         int64_t* start_out)
+{
+  qio_channel_t* ch = NULL;
+  char buf[SPLIT_SCAN_BYTES];
+  int64_t from;
+  qioerr err;
+
+  // Start with the byte before target so that a target that already
+  // begins a record is kept.
+  from = target - 1;
+
+  err = qio_channel_create(&ch, file, QIO_CH_BUFFERED, 1, 0, from, end, NULL);
+  if( err ) return err;
+
+  *start_out = end;
+
+  if( regexp ) {
+    err = qio_channel_mark(false, ch);
+    if( ! err ) {
+      err = qio_regexp_channel_match(regexp, false, ch, end - from,
+                                     QIO_REGEXP_ANCHOR_UNANCHORED,
+                                     true, false, false, NULL, 0);
+      if( ! err ) *start_out = qio_channel_offset_unlocked(ch);
+      qio_channel_commit_unlocked(ch);
+      if( qio_err_to_int(err) == EFORMAT ) err = 0; // no more records
+    }
+  } else {
+    int64_t pos = from;
+    while( pos < end ) {
+      ssize_t amt = 0;
+      char* found;
+
+      err = qio_channel_read(false, ch, buf, sizeof(buf), &amt);
+      if( amt > 0 ) {
+        found = memchr(buf, delim, amt);
+        if( found ) {
+          *start_out = pos + (found - buf) + 1;
+          err = 0;
+          break;
+        }
+        pos += amt;
+      }
+      if( err ) {
+        if( qio_err_to_int(err) == EEOF ) err = 0;
+        break;
+      }
+    }
+  }
+
+  qio_channel_release(ch);
+  return err;
+}
+
+qioerr qio_file_split_records(qio_file_t* file, int64_t start, int64_t end,
+                              int64_t nranges, int32_t delim,
+                              const qio_regexp_t* regexp,
+                              int64_t* bounds_out)
+{
+  int64_t len;
+  int64_t i;
+  qioerr err;
+
+  if( nranges < 1 || start < 0 )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid range to split");
+
+  if( end < 0 ) {
+    err = qio_file_length(file, &end);
+    if( err ) return err;
+  }
+  if( end < start ) end = start;
+
+  len = end - start;
+  bounds_out[0] = start;
+  bounds_out[nranges] = end;
+
+  for( i = 1; i < nranges; i++ ) {
+    int64_t prev = bounds_out[i-1];
+    // start + len*i/nranges without overflowing for large files
+    int64_t target = start + (len / nranges) * i +
+                     ((len % nranges) * i) / nranges;
+
+    if( target <= prev ) {
+      // The previous record ran past this target (or the range is
+      // shorter than nranges bytes); leave this range empty.
+      bounds_out[i] = prev;
+      continue;
+    }
+
+    err = find_record_start(file, target, end, delim, regexp, &bounds_out[i]);
+    if( err ) return err;
+  }
+
+  return 0;
+}
+
+qioerr qio_file_open_split_channels(qio_file_t* file, qio_hint_t hints,
+                                    int readable, int writeable,
+                                    int64_t nranges, const int64_t* bounds,
+                                    qio_style_t* style,
+                                    qio_channel_t** channels_out)
+{
+  int64_t i;
+  qioerr err = 0;
+
+  for( i = 0; i < nranges; i++ ) {
+    err = qio_channel_create(&channels_out[i], file, hints,
+                             readable, writeable,
+                             bounds[i], bounds[i+1], style);
+    if( err ) break;
+  }
+
+  if( err ) {
+    // Don't hand back a partial set.
+    while( i > 0 ) {
+      i--;
+      qio_channel_release(channels_out[i]);
+      channels_out[i] = NULL;
+    }
+  }
+
+  return err;
+}
+
+qioerr qio_file_split_locales(qio_file_t* file, int64_t start, int64_t end,
+                              int64_t nlocales, int64_t* bounds_out)
+{
+  int64_t chunk = 0;
+  int64_t len;
+  int64_t i;
+  qioerr err;
+
+  if( nlocales < 1 || start < 0 )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid range to split");
+
+  if( end < 0 ) {
+    err = qio_file_length(file, &end);
+    if( err ) return err;
+  }
+  if( end < start ) end = start;
+
+  // Without a chunk size, split evenly.
+  err = qio_get_chunk(file, &chunk);
+  if( err || chunk < 1 ) chunk = 1;
+
+  len = end - start;
+  bounds_out[0] = start;
+  bounds_out[nlocales] = end;
+
+  for( i = 1; i < nlocales; i++ ) {
+    int64_t target = start + (len / nlocales) * i +
+                     ((len % nlocales) * i) / nlocales;
+
+    // Round to the nearest chunk boundary in the file.
+    target = ((target + chunk / 2) / chunk) * chunk;
+    if( target < bounds_out[i-1] ) target = bounds_out[i-1];
+    if( target > end ) target = end;
+
+    bounds_out[i] = target;
+  }
+
+  return 0;
+}
+
+qioerr qio_file_open_shared_region(qio_file_t** file_out, const char* path,
+                                   int64_t start, int64_t end,
+                                   qio_hint_t iohints,
+                                   const qio_style_t* style)
+{
+  qio_file_t* file = NULL;
+  int shared = 0;
+  qioerr err;
+
+  *file_out = NULL;
+
+  if( start < 0 || (end >= 0 && end < start) )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid region");
+
+  // Prefetch just our region below, not the whole file on every locale.
+  err = qio_file_open_access(&file, path, "r", iohints & ~QIO_HINT_CACHED,
+                             style);
+  if( err ) return err;
+
+  err = qio_file_is_shared_fs(file, &shared);
+  if( ! err && ! shared ) {
+    QIO_GET_CONSTANT_ERROR(err, ENOTSUP, "file is not on a shared filesystem");
+  }
+  if( err ) {
+    qio_file_release(file);
+    return err;
+  }
+
+#ifdef POSIX_FADV_WILLNEED
+  if( (iohints & QIO_HINT_CACHED) && file->fd != -1 ) {
+    int64_t len = 0;
+    if( end >= 0 ) len = end - start; // 0 means to the end of the file
+    // The advice is only a hint, so ignore errors.
+    (void) sys_posix_fadvise(file->fd, start, len, POSIX_FADV_WILLNEED);
+  }
+#endif
+
+  *file_out = file;
+  return 0;
+}
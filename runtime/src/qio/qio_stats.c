@@ -0,0 +1,147 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// I/O statistics; see qio_stats.h
+//
+#include "sys_basic.h"
+
+#ifndef CHPL_RT_UNIT_TEST
+#include "chplrt.h"
+#include "chpl-comm.h"
+#include "chpl-env.h"
+#include "chpltimers.h"
+#endif
+
+#include "qio_stats.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#ifndef CHPL_RT_UNIT_TEST
+#define STATS_ENV_BOOL(name, dflt) chpl_env_rt_get_bool(name, dflt)
+#define STATS_NODE_ID ((int) chpl_nodeID)
+#else
+#define STATS_ENV_BOOL(name, dflt) (dflt)
+#define STATS_NODE_ID 0
+#endif
+
+int qio_stats_state = -1;
+
+static pthread_once_t stats_once = PTHREAD_ONCE_INIT;
+static qio_io_stats_t stats_global;
+
+static
+void stats_at_exit(void)
+{
+  if( qio_stats_state > 0 ) qio_stats_print(stderr);
+}
+
+static
+void stats_once_setup(void)
+{
+  if( qio_stats_state < 0 ) qio_stats_state = STATS_ENV_BOOL("QIO_STATS", 0);
+  atexit(stats_at_exit);
+}
+
+void qio_stats_setup(void)
+{
+  pthread_once(&stats_once, stats_once_setup);
+}
+
+void qio_stats_enable(int on)
+{
+  qio_stats_setup();
+  qio_stats_state = on ? 1 : 0;
+}
+
+int64_t qio_stats_now_ns(void)
+{
+#ifndef CHPL_RT_UNIT_TEST
+  return (int64_t) chpl_timer_now_ns();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+#define STATS_FIELDS(X) \
+  X(bytes_read) X(bytes_written) X(read_calls) X(write_calls) \
+  X(read_ns) X(write_ns) X(refills) X(flushes) X(mmaps) X(mmap_bytes) \
+  X(iobuf_hits) X(iobuf_misses) X(iobuf_remote_frees)
+
+void qio_stats_add(qio_io_stats_t* dst, const qio_io_stats_t* src)
+{
+#define STATS_ADD(f) \
+  if( src->f ) __atomic_fetch_add(&dst->f, src->f, __ATOMIC_RELAXED);
+  STATS_FIELDS(STATS_ADD)
+#undef STATS_ADD
+}
+
+void qio_stats_get(const qio_io_stats_t* src, qio_io_stats_t* out)
+{
+#define STATS_GET(f) out->f = __atomic_load_n(&src->f, __ATOMIC_RELAXED);
+  STATS_FIELDS(STATS_GET)
+#undef STATS_GET
+}
+
+void qio_stats_get_global(qio_io_stats_t* out)
+{
+  qio_stats_get(&stats_global, out);
+}
+
+void qio_stats_add_global(const qio_io_stats_t* src)
+{
+  qio_stats_add(&stats_global, src);
+}
+
+void qio_stats_print(FILE* f)
+{
+  qio_io_stats_t s;
+  struct rusage ru;
+  long minflt = 0, majflt = 0;
+  int64_t iobufs;
+
+  qio_stats_get_global(&s);
+  if( getrusage(RUSAGE_SELF, &ru) == 0 ) {
+    minflt = ru.ru_minflt;
+    majflt = ru.ru_majflt;
+  }
+
+  fprintf(f, "qio stats (locale %i):\n", STATS_NODE_ID);
+  fprintf(f, "  read:  %" PRId64 " bytes in %" PRId64 " calls, %.3f s blocked,"
+             " %" PRId64 " refills\n",
+          s.bytes_read, s.read_calls, s.read_ns / 1e9, s.refills);
+  fprintf(f, "  write: %" PRId64 " bytes in %" PRId64 " calls, %.3f s blocked,"
+             " %" PRId64 " flushes\n",
+          s.bytes_written, s.write_calls, s.write_ns / 1e9, s.flushes);
+  fprintf(f, "  mmap:  %" PRId64 " bytes in %" PRId64 " mappings;"
+             " process page faults: %ld minor, %ld major\n",
+          s.mmap_bytes, s.mmaps, minflt, majflt);
+  iobufs = s.iobuf_hits + s.iobuf_misses;
+  fprintf(f, "  iobuf: %" PRId64 " created, %.1f%% from the freelist,"
+             " %" PRId64 " returned from other threads\n",
+          iobufs, iobufs ? 100.0 * s.iobuf_hits / iobufs : 0.0,
+          s.iobuf_remote_frees);
+}
@@ -0,0 +1,463 @@
+/*
+ * Copyright 2020-2021 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ * 
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ * 
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// QIO_METHOD_URING: channel reads and writes through io_uring
+//
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "sys_basic.h"
+
+#ifndef CHPL_RT_UNIT_TEST
+#include "chplrt.h"
+#include "chpl-env.h"
+#include "chpl-tasks.h"
+#include "error.h"
+#endif
+
+#include "qio_uring.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#ifdef __NR_io_uring_setup
+#define QIO_HAVE_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#endif
+#endif
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+#ifndef CHPL_RT_UNIT_TEST
+#define URING_YIELD() chpl_task_yield()
+#define URING_ENV_INT(name, dflt) chpl_env_rt_get_int(name, dflt)
+#define URING_ENV_BOOL(name, dflt) chpl_env_rt_get_bool(name, dflt)
+#define URING_FATAL(msg) chpl_internal_error(msg)
+#else
+#define URING_YIELD() sched_yield()
+#define URING_ENV_INT(name, dflt) (dflt)
+#define URING_ENV_BOOL(name, dflt) (dflt)
+#define URING_FATAL(msg) abort()
+#endif
+
+
+#ifdef QIO_HAVE_URING
+
+// Completion record for one request.  Protected by the ring lock.
+typedef struct {
+  int done;
+  int32_t res;
+} uring_req_t;
+
+static struct {
+  pthread_mutex_t lock;
+  int fd;
+
+  unsigned* sq_head;
+  unsigned* sq_tail;
+  unsigned sq_mask;
+  unsigned sq_entries;
+  unsigned* sq_array;
+  struct io_uring_sqe* sqes;
+
+  unsigned* cq_head;
+  unsigned* cq_tail;
+  unsigned cq_mask;
+  unsigned cq_entries;
+  struct io_uring_cqe* cqes;
+
+  unsigned pending;   // prepared but not yet submitted
+  unsigned inflight;  // prepared and not yet reaped
+} ring = { PTHREAD_MUTEX_INITIALIZER, -1 };
+
+static pthread_once_t ring_once = PTHREAD_ONCE_INIT;
+static int ring_ok = 0;
+static int ring_default = 0;
+
+// Submit when this many requests are waiting, rather than waiting
+// for the submitter to come back around.  Set by CHPL_RT_QIO_URING_BATCH.
+static unsigned ring_batch = 16;
+
+// How many times a waiting task yields before it blocks its pthread
+// in the kernel.  Set by CHPL_RT_QIO_URING_SPINS.
+static int ring_spins = 1000;
+
+
+static
+void ring_setup(void)
+{
+  struct io_uring_params p;
+  size_t sq_size;
+  size_t cq_size;
+  unsigned char* sq;
+  unsigned char* cq;
+  void* sqes;
+  int64_t entries;
+  int64_t batch;
+  int fd;
+
+  ring_default = URING_ENV_BOOL("QIO_URING", false);
+
+  entries = URING_ENV_INT("QIO_URING_ENTRIES", 256);
+  if( entries < 1 || entries > 32768 ) entries = 256;
+  batch = URING_ENV_INT("QIO_URING_BATCH", 16);
+  if( batch < 1 ) batch = 1;
+  if( batch > entries ) batch = entries;
+  ring_batch = (unsigned) batch;
+  ring_spins = (int) URING_ENV_INT("QIO_URING_SPINS", 1000);
+  if( ring_spins < 0 ) ring_spins = 0;
+
+  memset(&p, 0, sizeof(p));
+  fd = (int) syscall(__NR_io_uring_setup, (unsigned) entries, &p);
+  if( fd < 0 ) return; // no io_uring (old kernel, or not permitted)
+
+  sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+#ifdef IORING_FEAT_SINGLE_MMAP
+  if( p.features & IORING_FEAT_SINGLE_MMAP ) {
+    if( cq_size > sq_size ) sq_size = cq_size;
+    cq_size = sq_size;
+  }
+#endif
+
+  sq = (unsigned char*) mmap(NULL, sq_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if( sq == MAP_FAILED ) {
+    close(fd);
+    return;
+  }
+
+#ifdef IORING_FEAT_SINGLE_MMAP
+  if( p.features & IORING_FEAT_SINGLE_MMAP ) {
+    cq = sq;
+  } else
+#endif
+  {
+    cq = (unsigned char*) mmap(NULL, cq_size, PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if( cq == MAP_FAILED ) {
+      munmap(sq, sq_size);
+      close(fd);
+      return;
+    }
+  }
+
+  sqes = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe),
+              PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+              fd, IORING_OFF_SQES);
+  if( sqes == MAP_FAILED ) {
+    if( cq != sq ) munmap(cq, cq_size);
+    munmap(sq, sq_size);
+    close(fd);
+    return;
+  }
+
+  ring.fd = fd;
+  ring.sq_head = (unsigned*) (sq + p.sq_off.head);
+  ring.sq_tail = (unsigned*) (sq + p.sq_off.tail);
+  ring.sq_mask = *(unsigned*) (sq + p.sq_off.ring_mask);
+  ring.sq_entries = p.sq_entries;
+  ring.sq_array = (unsigned*) (sq + p.sq_off.array);
+  ring.sqes = (struct io_uring_sqe*) sqes;
+  ring.cq_head = (unsigned*) (cq + p.cq_off.head);
+  ring.cq_tail = (unsigned*) (cq + p.cq_off.tail);
+  ring.cq_mask = *(unsigned*) (cq + p.cq_off.ring_mask);
+  ring.cq_entries = p.cq_entries;
+  ring.cqes = (struct io_uring_cqe*) (cq + p.cq_off.cqes);
+
+  ring_ok = 1;
+}
+
+int qio_uring_available(void)
+{
+  pthread_once(&ring_once, ring_setup);
+  return ring_ok;
+}
+
+int qio_uring_is_default(void)
+{
+  pthread_once(&ring_once, ring_setup);
+  return ring_ok && ring_default;
+}
+
+
+// Hand the prepared requests to the kernel.  Call with the lock held.
+static
+void ring_submit_locked(void)
+{
+  while( ring.pending > 0 ) {
+    int got = (int) syscall(__NR_io_uring_enter, ring.fd, ring.pending,
+                            0, 0, NULL, 0);
+    if( got < 0 ) {
+      if( errno == EINTR ) continue;
+      if( errno == EAGAIN || errno == EBUSY ) return; // try again later
+      URING_FATAL("io_uring_enter submission failed");
+    }
+    ring.pending -= got;
+  }
+}
+
+// Record the results of any finished requests.  Call with the lock held.
+static
+void ring_reap_locked(void)
+{
+  unsigned head = *ring.cq_head;
+  unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+
+  while( head != tail ) {
+    struct io_uring_cqe* cqe = &ring.cqes[head & ring.cq_mask];
+    uring_req_t* req = (uring_req_t*) (uintptr_t) cqe->user_data;
+    req->res = cqe->res;
+    req->done = 1;
+    ring.inflight--;
+    head++;
+  }
+
+  __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+}
+
+// Run one readv or writev through the ring, yielding while it's in
+// flight.  Returns the system call result: bytes moved, or -errno.
+static
+int32_t ring_rw(uint8_t opcode, fd_t fd, const struct iovec* iov,
+                int iovcnt, off_t offset)
+{
+  uring_req_t req = { 0, 0 };
+  struct io_uring_sqe* sqe;
+  unsigned tail;
+  int spins;
+
+  // Get a submission slot.  Keep the number in flight within the
+  // completion queue size so completions can't overflow.
+  pthread_mutex_lock(&ring.lock);
+  while( 1 ) {
+    tail = *ring.sq_tail;
+    if( tail - __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE)
+          < ring.sq_entries
+        && ring.inflight < ring.cq_entries ) {
+      break;
+    }
+    ring_submit_locked();
+    ring_reap_locked();
+    pthread_mutex_unlock(&ring.lock);
+    URING_YIELD();
+    pthread_mutex_lock(&ring.lock);
+  }
+
+  sqe = &ring.sqes[tail & ring.sq_mask];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->off = (uint64_t) offset;
+  sqe->addr = (uint64_t) (uintptr_t) iov;
+  sqe->len = (uint32_t) iovcnt;
+  sqe->user_data = (uint64_t) (uintptr_t) &req;
+  ring.sq_array[tail & ring.sq_mask] = tail & ring.sq_mask;
+  __atomic_store_n(ring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+  ring.pending++;
+  ring.inflight++;
+
+  // Submit now if enough requests have piled up.  Otherwise give other
+  // tasks a chance to add theirs, and we'll submit after yielding.
+  if( ring.pending >= ring_batch ) ring_submit_locked();
+  pthread_mutex_unlock(&ring.lock);
+
+  for( spins = 0; ; spins++ ) {
+    int done;
+
+    URING_YIELD();
+
+    if( pthread_mutex_trylock(&ring.lock) != 0 ) continue;
+
+    ring_submit_locked();
+    ring_reap_locked();
+    if( ! req.done && spins >= ring_spins && ring.pending == 0 ) {
+      // Nothing else to do; wait in the kernel.  Holding the lock is
+      // OK because our own request is in flight, so this will return.
+      int got = (int) syscall(__NR_io_uring_enter, ring.fd, 0, 1,
+                              IORING_ENTER_GETEVENTS, NULL, 0);
+      if( got < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY ) {
+        URING_FATAL("io_uring_enter wait failed");
+      }
+      ring_reap_locked();
+    }
+    done = req.done;
+    pthread_mutex_unlock(&ring.lock);
+
+    if( done ) break;
+  }
+
+  return req.res;
+}
+
+// Like sys_preadv/sys_pwritev, but through the ring.
+static
+err_t ring_rwv(uint8_t opcode, fd_t fd, const struct iovec* iov, int iovcnt,
+               off_t offset, ssize_t* num_out)
+{
+  ssize_t total = 0;
+  err_t err = 0;
+  int niovs;
+  int i;
+
+  if( ! qio_uring_available() ) {
+    *num_out = 0;
+    return ENOSYS;
+  }
+
+  for( i = 0; i < iovcnt; i += niovs ) {
+    int32_t got;
+
+    niovs = iovcnt - i;
+    if( niovs > IOV_MAX ) niovs = IOV_MAX;
+
+    got = ring_rw(opcode, fd, &iov[i], niovs, offset + total);
+    if( got < 0 ) {
+      err = -got;
+      break;
+    }
+    total += got;
+    if( got != sys_iov_total_bytes(&iov[i], niovs) ) break;
+  }
+
+  if( opcode == IORING_OP_READV &&
+      err == 0 && total == 0 && sys_iov_total_bytes(iov, iovcnt) != 0 ) {
+    err = EEOF;
+  }
+
+  *num_out = total;
+  return err;
+}
+
+#else // QIO_HAVE_URING
+
+int qio_uring_available(void)
+{
+  return 0;
+}
+
+int qio_uring_is_default(void)
+{
+  return 0;
+}
+
+#define IORING_OP_READV 1
+#define IORING_OP_WRITEV 2
+
+static
+err_t ring_rwv(uint8_t opcode, fd_t fd, const struct iovec* iov, int iovcnt,
+               off_t offset, ssize_t* num_out)
+{
+  // choose_io_method() doesn't pick this method without io_uring
+  *num_out = 0;
+  return ENOSYS;
+}
+
+#endif // QIO_HAVE_URING
+
+
+static
+qioerr uring_qbuffer_rw(uint8_t opcode, qio_file_t* file, qbuffer_t* buf,
+                        qbuffer_iter_t start, qbuffer_iter_t end,
+                        int64_t seek_to_offset, ssize_t* num_out)
+{
+  ssize_t n = 0;
+  int64_t num_bytes = qbuffer_iter_num_bytes(start, end);
+  ssize_t num_parts = qbuffer_iter_num_parts(start, end);
+  struct iovec* iov = NULL;
+  size_t iovcnt;
+  MAYBE_STACK_SPACE(struct iovec, iov_onstack);
+  qioerr err;
+
+  if( num_bytes < 0 || num_parts < 0 || num_parts > INT_MAX ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "negative count");
+  }
+
+  if( file->fd == -1 ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid file descriptor");
+  }
+
+  MAYBE_STACK_ALLOC(struct iovec, num_parts, iov, iov_onstack);
+  if( ! iov ) {
+    err = QIO_ENOMEM;
+    goto error;
+  }
+
+  err = qbuffer_to_iov(buf, start, end, num_parts, iov, NULL, &iovcnt);
+  if( err ) goto error;
+
+  err = qio_int_to_err(ring_rwv(opcode, file->fd, iov, iovcnt,
+                                seek_to_offset, &n));
+
+error:
+  MAYBE_STACK_FREE(iov, iov_onstack);
+
+  *num_out = n;
+
+  return err;
+}
+
+qioerr qio_uring_preadv(qio_file_t* file, qbuffer_t* buf,
+                        qbuffer_iter_t start, qbuffer_iter_t end,
+                        int64_t seek_to_offset, ssize_t* num_read)
+{
+  return uring_qbuffer_rw(IORING_OP_READV, file, buf, start, end,
+                          seek_to_offset, num_read);
+}
+
+qioerr qio_uring_pwritev(qio_file_t* file, qbuffer_t* buf,
+                         qbuffer_iter_t start, qbuffer_iter_t end,
+                         int64_t seek_to_offset, ssize_t* num_written)
+{
+  return uring_qbuffer_rw(IORING_OP_WRITEV, file, buf, start, end,
+                          seek_to_offset, num_written);
+}
+
+err_t qio_uring_pread(fd_t fd, void* buf, size_t count, off_t offset,
+                      ssize_t* num_read_out)
+{
+  struct iovec iov;
+  iov.iov_base = buf;
+  iov.iov_len = count;
+  return ring_rwv(IORING_OP_READV, fd, &iov, 1, offset, num_read_out);
+}
+
+err_t qio_uring_pwrite(fd_t fd, const void* buf, size_t count, off_t offset,
+                       ssize_t* num_written_out)
+{
+  struct iovec iov;
+  iov.iov_base = (void*) buf;
+  iov.iov_len = count;
+  return ring_rwv(IORING_OP_WRITEV, fd, &iov, 1, offset, num_written_out);
+}
@@ -23,10 +23,17 @@
 #define CHPL_RE2
 #endif
 
+#include <algorithm>
 #include <limits>
+#include <list>
+#include <mutex>
 #include <pthread.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 // We have run into issues when using our chpl-atomics.h file from C++ code
 // under CHPL_ATOMICS=cstdlib. As a workaround, just use std::atomic and avoid
@@ -36,6 +43,7 @@
 
 #ifndef CHPL_RT_UNIT_TEST
 #include "stdchplrt.h"
+#include "chpl-env.h"
 #endif
 #include "qio_regexp.h"
 #include "qbuffer.h" // qio_strdup, refcount functions, qio_ptr_diff, etc
@@ -43,6 +51,13 @@
 #undef printf
 
 #include "re2/re2.h"
+#include "re2/set.h"
+
+#ifndef CHPL_RT_UNIT_TEST
+#define REGEXP_ENV_INT(name, dflt) chpl_env_rt_get_int(name, dflt)
+#else
+#define REGEXP_ENV_INT(name, dflt) (dflt)
+#endif
 
 using namespace re2;
 
@@ -128,6 +143,113 @@ void re_free(re_t* re)
   delete re;
 }
 
+// The process-wide regexp cache.  Each thread's local cache is checked
+// first, so this one (and its lock) is only used when a thread sees a
+// pattern for the first time.  Matching with an RE2 is thread-safe, so
+// all threads can share the compiled regexps here.  It holds a reference
+// to each regexp it contains and keeps at most max_size of them,
+// dropping the least recently used.
+#define REGEXP_SHARED_CACHE_SIZE 256
+
+struct re_shared_cache {
+  typedef std::list<std::pair<std::string, re_t*> > lru_t;
+  std::mutex lock;
+  int64_t max_size;
+  lru_t lru; // most recently used first
+  std::unordered_map<std::string, lru_t::iterator> index;
+};
+
+static
+re_shared_cache* shared_cache(void)
+{
+  // Never destroyed, since thread-local caches may still be releasing
+  // regexps as the process exits.
+  static re_shared_cache* cache = NULL;
+  static std::once_flag once;
+  std::call_once(once, [] {
+    cache = new re_shared_cache();
+    cache->max_size = REGEXP_ENV_INT("QIO_REGEXP_CACHE_SIZE",
+                                     REGEXP_SHARED_CACHE_SIZE);
+    if( cache->max_size < 0 ) cache->max_size = 0;
+  });
+  return cache;
+}
+
+// The pattern followed by one byte holding the options.
+static
+std::string shared_cache_key(const char* str, int64_t str_len, const qio_regexp_options_t* options)
+{
+  std::string key(str, str_len);
+  char opts = (options->utf8 ? 1 : 0) |
+              (options->posix ? 2 : 0) |
+              (options->literal ? 4 : 0) |
+              (options->nocapture ? 8 : 0) |
+              (options->ignorecase ? 16 : 0) |
+              (options->multiline ? 32 : 0) |
+              (options->dotnl ? 64 : 0) |
+              (options->nongreedy ? 128 : 0);
+  key.push_back(opts);
+  return key;
+}
+
+// Returns a regexp with a reference for the caller, compiling it if
+// it isn't in the shared cache.
+static
+re_t* shared_cache_get(const char* str, int64_t str_len, const qio_regexp_options_t* options, re_cache* home) {
+  re_shared_cache* c = shared_cache();
+  re_t* re;
+
+  if( c->max_size == 0 ) {
+    RE2::Options opts;
+    qio_re_options_to_re2_options(options, &opts);
+    StringPiece strp(str, str_len);
+    // The initial reference goes to the caller.
+    return new re_t(strp, opts, home);
+  }
+
+  std::string key = shared_cache_key(str, str_len, options);
+  {
+    std::lock_guard<std::mutex> guard(c->lock);
+    auto found = c->index.find(key);
+    if( found != c->index.end() ) {
+      c->lru.splice(c->lru.begin(), c->lru, found->second);
+      re = found->second->second;
+      DO_RETAIN(re);
+      return re;
+    }
+  }
+
+  // Compile without holding the lock, so that threads compiling
+  // different patterns don't wait for each other.
+  RE2::Options opts;
+  qio_re_options_to_re2_options(options, &opts);
+  StringPiece strp(str, str_len);
+  re = new re_t(strp, opts, home);
+
+  std::lock_guard<std::mutex> guard(c->lock);
+  auto found = c->index.find(key);
+  if( found != c->index.end() ) {
+    // Another thread compiled it first; use theirs.
+    re_free(re);
+    c->lru.splice(c->lru.begin(), c->lru, found->second);
+    re = found->second->second;
+    DO_RETAIN(re);
+    return re;
+  }
+
+  // The initial reference is the shared cache's.
+  c->lru.emplace_front(key, re);
+  c->index.emplace(std::move(key), c->lru.begin());
+  while( (int64_t) c->lru.size() > c->max_size ) {
+    re_t* old = c->lru.back().second;
+    c->index.erase(c->lru.back().first);
+    c->lru.pop_back();
+    DO_RELEASE(old, re_free);
+  }
+  DO_RETAIN(re);
+  return re;
+}
+
 static
 re_t* local_cache_get(const char* str, int64_t str_len, const qio_regexp_options_t* options) {
   thread_local re_cache cache;
@@ -164,11 +286,9 @@ re_t* local_cache_get(const char* str, int64_t str_len, const qio_regexp_options
   // If we found no match, replace oldest.
   if( c->elems[oldest].re) DO_RELEASE(c->elems[oldest].re, re_free);
 
-  // Put a new RE in that slot.
-  RE2::Options opts;
-  qio_re_options_to_re2_options(options, &opts);
-  StringPiece strp(str, str_len);
-  re_t* re = new re_t(strp, opts, c);
+  // Put the shared cache's RE in that slot.  The reference it returns
+  // is the one held by this slot.
+  re_t* re = shared_cache_get(str, str_len, options, c);
   c->elems[oldest].date = c->date;
   c->elems[oldest].re = re;
   // We increment the reference count before returning a copy to the
@@ -202,12 +322,11 @@ void qio_regexp_init_default_options(qio_regexp_options_t* opt)
 // The returned re_t (passed back through "compiled") must be released by the caller.
 void qio_regexp_create_compile(const char* str, int64_t str_len, const qio_regexp_options_t* options, qio_regexp_t* compiled)
 {
+  // local_cache_get bumps the reference count, because the caller "owns" its
+  // copy of the cached regexp.  This way, a regexp can be removed from the
+  // caches without causing a copy that is still in use to be deleted early.
   re_t* regexp = local_cache_get(str, str_len, options);
   compiled->regexp = (void*) regexp;
-  // We bump the reference count, because caller "owns" its copy of the cached
-  // regexp.  This way, a regexp can be removed from the cache without causing a
-  // copy that is still in use to be deleted early.
-  DO_RETAIN(regexp);
 }
 
 // The re_t returned in compiled must be released by the caller.
@@ -380,6 +499,228 @@ void qio_regexp_channel_discard(qio_channel_s* ch, int64_t cur, int64_t min)
 }
 
 
+// Searching a channel one byte at a time (with MatchFile) costs a
+// function call per byte.  When a regexp's matches have a bounded
+// length, we can instead let RE2 search each contiguous span of the
+// channel buffer in place.  The only matches that need special handling
+// are the ones that could run past the end of a span; those are found
+// by searching a small carry buffer holding the undecided end of one
+// span and the start of the next.  Regexps with longer (or unbounded)
+// matches use MatchFile.
+#define REGEXP_BLOCK_CARRY_MAX 4096
+// Channels without a cached buffer (QIO_HINT_NOFAST) are read in
+// blocks of this size instead.
+#define REGEXP_BLOCK_READ_SIZE (64*1024)
+
+enum {
+  BLOCK_NONE = 0, // no match starts among the candidates
+  BLOCK_FOUND,    // found the match
+  BLOCK_MORE      // need more text to decide
+};
+
+// Search text for a match starting in [startpos, limit).  The bytes
+// before startpos are only context (for ^ and \b).  If final is set, the
+// text ends where the region being searched ends, and a match starting
+// anywhere in it counts.  On BLOCK_MORE, *undecided is the first start
+// position that can't be ruled out yet.
+static
+int re_block_search(const RE2* re, RE2::Anchor ranchor, int64_t maxmatch,
+                    const StringPiece& text, int64_t startpos, int64_t limit,
+                    bool final, StringPiece* subs, int nsubs,
+                    int64_t* undecided)
+{
+  int64_t size = text.size();
+  int64_t first_open;
+  bool found;
+
+  found = re->Match(text, startpos, size, ranchor, subs, nsubs);
+  if( found ) {
+    int64_t s = qio_ptr_diff((void*) subs[0].data(), (void*) text.data());
+    if( final ) return BLOCK_FOUND;
+    if( s < limit && s + maxmatch < size ) return BLOCK_FOUND;
+  }
+
+  if( final ) return BLOCK_NONE;
+
+  // A match starting at or after size - maxmatch could still continue
+  // past the end of text.
+  first_open = size - maxmatch;
+  if( first_open < startpos ) first_open = startpos;
+  if( first_open >= limit ) return BLOCK_NONE;
+  *undecided = first_open;
+  return BLOCK_MORE;
+}
+
+// Searches [start_offset, end) of a channel (positioned at start_offset,
+// and locked if need be).  Returns with the channel after the last byte
+// it looked at.
+static
+qioerr re_channel_search_blocks(const RE2* re, RE2::Anchor ranchor,
+                                qio_channel_s* ch, int64_t start_offset,
+                                int64_t end, qio_bool can_discard,
+                                qio_bool keep_unmatched,
+                                qio_regexp_string_piece_t* captures,
+                                int64_t ncaptures, bool* found_out,
+                                int64_t* match_start_out,
+                                int64_t* match_len_out)
+{
+  int64_t maxmatch = re->max_match_length_bytes();
+  int nsubs = ncaptures > 0 ? (int) ncaptures : 1;
+  // The undecided match starts, preceded by one byte of context
+  // unless carry_off is at the start of the search.
+  std::string carry;
+  std::vector<char> scratch;
+  int64_t carry_off = start_offset;
+  int64_t pos = start_offset;
+  qioerr err = 0;
+  int result = BLOCK_NONE;
+  StringPiece found_text;
+  int64_t found_base = 0;
+  MAYBE_STACK_SPACE(StringPiece, subs_onstack);
+  StringPiece* subs;
+
+  MAYBE_STACK_ALLOC(StringPiece, nsubs, subs, subs_onstack);
+
+  // Like MatchFile, don't look past the start for a pattern like ^abc.
+  if( re->anchored_start() ) ranchor = RE2::ANCHOR_START;
+
+  while( true ) {
+    void* bufstart = NULL;
+    void* bufend = NULL;
+    int64_t n = 0;
+    int64_t take;
+    int64_t limit;
+    int64_t ctx = (carry_off > start_offset) ? 1 : 0;
+    int64_t undecided = 0;
+    bool final = false;
+    bool consumed = false;
+
+    if( pos >= end ) {
+      final = true;
+    } else {
+      err = qio_channel_require_read(false, ch, 1);
+      if( qio_err_to_int(err) == EEOF ) {
+        err = 0;
+        final = true;
+      } else if( err ) {
+        break;
+      } else {
+        err = qio_channel_begin_peek_cached(false, ch, &bufstart, &bufend);
+        if( err ) break;
+        n = qio_ptr_diff(bufend, bufstart);
+        if( n == 0 ) {
+          ssize_t amt = 0;
+          ssize_t len = REGEXP_BLOCK_READ_SIZE;
+          if( len > end - pos ) len = end - pos;
+          scratch.resize(len);
+          err = qio_channel_read(false, ch, &scratch[0], len, &amt);
+          if( qio_err_to_int(err) == EEOF ) {
+            err = 0;
+            final = true;
+          }
+          if( err ) break;
+          bufstart = &scratch[0];
+          n = amt;
+          consumed = true;
+        }
+        if( n >= end - pos ) {
+          n = end - pos;
+          final = true;
+        }
+      }
+    }
+
+    StringPiece span((const char*) bufstart, n);
+
+    // First, the carried match starts and the first byte of this span,
+    // which need the end of the last span as context.
+    take = n;
+    if( take > maxmatch + 1 ) take = maxmatch + 1;
+    carry.append(span.data(), take);
+    StringPiece window(carry);
+    if( ranchor == RE2::UNANCHORED ) {
+      limit = carry.size() - take + (take > 0 ? 1 : 0);
+    } else {
+      // Only the start of the search is a candidate, and anchored
+      // searches never drop it from the carry buffer.
+      limit = 1;
+    }
+    result = re_block_search(re, ranchor, maxmatch, window, ctx, limit,
+                             final && take == n, subs, nsubs, &undecided);
+    if( result == BLOCK_FOUND ) {
+      found_text = window;
+      found_base = carry_off - ctx;
+      break;
+    }
+    if( result == BLOCK_MORE ) {
+      // All of this span is in the carry buffer now.
+      int64_t keep = undecided > 0 ? undecided - 1 : 0;
+      carry.erase(0, keep);
+      carry_off = carry_off - ctx + keep + (undecided > 0 ? 1 : 0);
+    } else if( final && take == n ) {
+      break;
+    } else if( ranchor != RE2::UNANCHORED ) {
+      // The only candidate was the start.
+      result = BLOCK_NONE;
+      break;
+    } else if( n > 1 ) {
+      // Then the rest of this span, in place.
+      result = re_block_search(re, ranchor, maxmatch, span, 1, n,
+                               final, subs, nsubs, &undecided);
+      if( result == BLOCK_FOUND ) {
+        found_text = span;
+        found_base = pos;
+        break;
+      }
+      if( result == BLOCK_NONE ) {
+        if( final ) break;
+        undecided = n;
+      }
+      carry.assign(span.data() + undecided - 1, n - undecided + 1);
+      carry_off = pos + undecided;
+    } else {
+      // Only the context byte is left.
+      carry.assign(span.data(), n);
+      carry_off = pos + n;
+    }
+
+    if( ! consumed ) {
+      err = qio_channel_advance_unlocked(ch, n);
+      if( err ) break;
+    }
+    pos += n;
+
+    if( final ) break;
+
+    // Let the channel drop what's before the carried text.
+    if( can_discard && ! keep_unmatched ) {
+      qio_regexp_channel_discard(ch, pos, carry_off - 1);
+    }
+  }
+
+  if( ! err && result == BLOCK_FOUND ) {
+    for( int64_t i = 0; i < ncaptures; i++ ) {
+      if( subs[i].data() == NULL ) {
+        captures[i].offset = -1;
+        captures[i].len = 0;
+      } else {
+        captures[i].offset = found_base +
+          qio_ptr_diff((void*) subs[i].data(), (void*) found_text.data());
+        captures[i].len = subs[i].length();
+      }
+    }
+    *match_start_out = found_base +
+      qio_ptr_diff((void*) subs[0].data(), (void*) found_text.data());
+    *match_len_out = subs[0].length();
+  }
+  *found_out = ( ! err && result == BLOCK_FOUND );
+
+  MAYBE_STACK_FREE(subs, subs_onstack);
+
+  return err;
+}
+
+
 qioerr qio_regexp_channel_match(const qio_regexp_t* regexp, const int threadsafe, struct qio_channel_s* ch, int64_t maxlen, int anchor, qio_bool can_discard, qio_bool keep_unmatched, qio_bool keep_whole_pattern, qio_regexp_string_piece_t* captures, int64_t ncaptures)
 {
   RE2* re = (RE2*) regexp->regexp;
@@ -454,6 +795,18 @@ qioerr qio_regexp_channel_match(const qio_regexp_t* regexp, const int threadsafe
     err = 0;
   }
 
+  if( FilePiece::allow_buffer_search() &&
+      re->ok() &&
+      ranchor != RE2::ANCHOR_BOTH &&
+      re->max_match_length_bytes() >= 0 &&
+      re->max_match_length_bytes() <= REGEXP_BLOCK_CARRY_MAX ) {
+    err = re_channel_search_blocks(re, ranchor, ch, start_offset, end,
+                                   can_discard, keep_unmatched,
+                                   captures, ncaptures,
+                                   &found, &match_start, &match_len);
+    goto error;
+  }
+
   // Require at least 1 byte and at most 1024 bytes.
   need = re->min_match_length_bytes();
   if( need <= 0 ) need = 1;
@@ -550,3 +903,138 @@ markerror:
 
   return err;
 }
+
+struct re_set_t {
+  RE2::Set set;
+  bool compiled;
+  re_set_t(const RE2::Options& options, RE2::Anchor anchor)
+    : set(options, anchor), compiled(false)
+  {
+  }
+};
+
+void qio_regexp_set_create(const qio_regexp_options_t* options, int anchor, qio_regexp_set_t* set)
+{
+  RE2::Options opts;
+  RE2::Anchor ranchor = RE2::UNANCHORED;
+
+  qio_re_options_to_re2_options(options, &opts);
+
+  if( anchor == QIO_REGEXP_ANCHOR_UNANCHORED ) ranchor = RE2::UNANCHORED;
+  else if( anchor == QIO_REGEXP_ANCHOR_START ) ranchor = RE2::ANCHOR_START;
+  else if( anchor == QIO_REGEXP_ANCHOR_BOTH ) ranchor = RE2::ANCHOR_BOTH;
+
+  set->set = (void*) new re_set_t(opts, ranchor);
+}
+
+int64_t qio_regexp_set_add(qio_regexp_set_t* set, const char* str, int64_t str_len, const char** err_str)
+{
+  re_set_t* s = (re_set_t*) set->set;
+  StringPiece strp(str, str_len);
+  std::string error;
+  int idx;
+
+  if( s->compiled ) {
+    *err_str = qio_strdup("regexp set is already compiled");
+    return -1;
+  }
+
+  idx = s->set.Add(strp, &error);
+  if( idx < 0 ) {
+    *err_str = qio_strdup(error.c_str());
+    return -1;
+  }
+
+  *err_str = NULL;
+  return idx;
+}
+
+qio_bool qio_regexp_set_compile(qio_regexp_set_t* set)
+{
+  re_set_t* s = (re_set_t*) set->set;
+
+  if( ! s->compiled ) s->compiled = s->set.Compile();
+
+  return s->compiled;
+}
+
+void qio_regexp_set_destroy(qio_regexp_set_t* set)
+{
+  re_set_t* s = (re_set_t*) set->set;
+  delete s;
+  set->set = NULL;
+}
+
+static
+int64_t re_set_match(const re_set_t* s, const StringPiece& text, int64_t* matched, int64_t nmatched)
+{
+  std::vector<int> v;
+  RE2::Set::ErrorInfo info;
+
+  if( ! s->compiled ) return -1;
+
+  if( ! s->set.Match(text, &v, &info) ) {
+    // No match, or the DFA ran out of memory.
+    return info.kind == RE2::Set::kNoError ? 0 : -1;
+  }
+
+  std::sort(v.begin(), v.end());
+  for( size_t i = 0; i < v.size() && (int64_t) i < nmatched; i++ ) {
+    matched[i] = v[i];
+  }
+
+  return v.size();
+}
+
+int64_t qio_regexp_set_match(const qio_regexp_set_t* set, const char* str, int64_t str_len, int64_t* matched, int64_t nmatched)
+{
+  StringPiece text(str, str_len);
+  return re_set_match((const re_set_t*) set->set, text, matched, nmatched);
+}
+
+qioerr qio_regexp_set_channel_match(const qio_regexp_set_t* set, const int threadsafe, struct qio_channel_s* ch, int64_t maxlen, int32_t delim, int64_t* matched, int64_t nmatched, int64_t* nfound_out)
+{
+  const re_set_t* s = (const re_set_t*) set->set;
+  std::string record;
+  int64_t nfound;
+  int64_t nread = 0;
+  qioerr err = 0;
+  int32_t c;
+
+  if( ! s->compiled ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "regexp set is not compiled");
+
+  if( threadsafe ) {
+    err = qio_lock(&ch->lock);
+    if( err ) {
+      return err;
+    }
+  }
+
+  // Read the record and its delimiter.
+  while( nread < maxlen ) {
+    c = qio_channel_read_byte(false, ch);
+    if( c < 0 ) {
+      err = qio_int_to_err(-c);
+      break;
+    }
+    nread++;
+    if( c == delim ) break;
+    record.push_back((char) c);
+  }
+
+  if( threadsafe ) {
+    qio_unlock(&ch->lock);
+  }
+
+  if( qio_err_to_int(err) == EEOF ) {
+    // EOF only matters if there was no record at all.
+    if( nread > 0 ) err = 0;
+  }
+  if( err ) return err;
+
+  nfound = re_set_match(s, StringPiece(record), matched, nmatched);
+  if( nfound < 0 ) QIO_RETURN_CONSTANT_ERROR(ENOMEM, "out of memory in regexp set match");
+
+  *nfound_out = nfound;
+  return 0;
+}
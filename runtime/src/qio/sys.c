@@ -30,6 +30,7 @@
 
 #include "sys.h"
 #include "qbuffer.h"
+#include "qio_event.h"
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -38,6 +39,7 @@
 #include <sys/uio.h> // maybe need this for preadv/pwritev
 #include <netdb.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -318,6 +320,23 @@ err_t sys_posix_madvise(void* addr, size_t len, int advice)
   return err_out;
 }
 
+err_t sys_madvise(void* addr, size_t len, int advice)
+{
+  int got;
+  err_t err_out;
+
+  got = 0;
+#ifdef MADV_NORMAL
+  got = madvise(addr, len, advice);
+  if( got != 0 ) err_out = errno;
+  else err_out = 0;
+#else
+  err_out = ENOSYS;
+#endif
+
+  return err_out;
+}
+
 
 
 // Some systems use "No error" and some use "Success"
@@ -518,6 +537,8 @@ err_t sys_close(fd_t fd)
   int got;
   err_t err_out;
 
+  qio_event_forget(fd);
+
   // might block with SO_LINGER
   STARTING_SLOW_SYSCALL;
   got = close(fd);
@@ -1364,6 +1385,37 @@ poll
 epoll
 */
 
+#ifndef MSG_DONTWAIT
+#define MSG_DONTWAIT 0
+#endif
+
+// Is fd one the program made non-blocking itself?  Those keep their
+// EAGAIN behavior even with event-driven sockets.
+static int sys_fd_is_nonblocking(fd_t fd)
+{
+  int fl = fcntl(fd, F_GETFL);
+  return fl == -1 || (fl & O_NONBLOCK) != 0;
+}
+
+// With event-driven sockets (see qio_event.h) socket calls are made
+// with MSG_DONTWAIT.  Returns true if the one that just failed would
+// have blocked and we've now waited for the socket to be ready, so it
+// should be tried again.  Leaves errno alone otherwise.
+static int sys_event_retry(fd_t fd, int flags, int writing)
+{
+  int saved_errno = errno;
+  int retry = 0;
+
+  if( (saved_errno == EAGAIN || saved_errno == EWOULDBLOCK)
+      && (flags & MSG_DONTWAIT) == 0
+      && ! sys_fd_is_nonblocking(fd) ) {
+    retry = (qio_event_wait(fd, writing) == 0);
+  }
+
+  errno = saved_errno;
+  return retry;
+}
+
 err_t sys_accept(fd_t sockfd, sys_sockaddr_t* addr_out, fd_t* fd_out)
 {
   int got;
@@ -1372,6 +1424,15 @@ err_t sys_accept(fd_t sockfd, sys_sockaddr_t* addr_out, fd_t* fd_out)
 
   STARTING_SLOW_SYSCALL;
 
+  // accept() has no MSG_DONTWAIT, so wait for a pending connection
+  // first.
+  if( qio_event_enabled() && ! sys_fd_is_nonblocking(sockfd) ) {
+    struct pollfd pfd = { sockfd, POLLIN, 0 };
+    while( poll(&pfd, 1, 0) == 0 ) {
+      if( qio_event_wait(sockfd, 0) != 0 ) break;
+    }
+  }
+
   got = accept(sockfd, (struct sockaddr*) & addr_out->addr, &addr_len);
   if( got != -1 ) {
     if( addr_len > (socklen_t) sizeof(sys_sockaddr_storage_t) ) {
@@ -1632,9 +1693,12 @@ err_t sys_recv(fd_t sockfd, void* buf, size_t len, int flags, ssize_t* num_recvd
 {
   ssize_t got;
   err_t err_out;
+  int ev = qio_event_enabled();
 
   STARTING_SLOW_SYSCALL;
-  got = recv(sockfd, buf, len, flags);
+  do {
+    got = recv(sockfd, buf, len, ev ? (flags | MSG_DONTWAIT) : flags);
+  } while( got == -1 && ev && sys_event_retry(sockfd, flags, 0) );
   if( got != -1 ) {
     *num_recvd_out = got;
     err_out = 0;
@@ -1651,9 +1715,13 @@ err_t sys_recvfrom(fd_t sockfd, void* buf, size_t len, int flags, sys_sockaddr_t
 {
   ssize_t got;
   err_t err_out;
+  int ev = qio_event_enabled();
 
   STARTING_SLOW_SYSCALL;
-  got = recvfrom(sockfd, buf, len, flags, (struct sockaddr*) &src_addr_out->addr, & src_addr_out->len);
+  do {
+    got = recvfrom(sockfd, buf, len, ev ? (flags | MSG_DONTWAIT) : flags,
+                   (struct sockaddr*) &src_addr_out->addr, & src_addr_out->len);
+  } while( got == -1 && ev && sys_event_retry(sockfd, flags, 0) );
   if( got != -1 ) {
     *num_recvd_out = got;
     err_out = 0;
@@ -1671,9 +1739,12 @@ err_t sys_recvmsg(fd_t sockfd, struct msghdr *msg, int flags, ssize_t* num_recvd
 {
   ssize_t got;
   err_t err_out;
+  int ev = qio_event_enabled();
 
   STARTING_SLOW_SYSCALL;
-  got = recvmsg(sockfd, msg, flags);
+  do {
+    got = recvmsg(sockfd, msg, ev ? (flags | MSG_DONTWAIT) : flags);
+  } while( got == -1 && ev && sys_event_retry(sockfd, flags, 0) );
 
   if( got != -1 ) {
     *num_recvd_out = got;
@@ -1692,9 +1763,12 @@ err_t sys_send(fd_t sockfd, const void* buf, int64_t len, int flags, ssize_t* nu
 {
   ssize_t sent;
   err_t err_out;
+  int ev = qio_event_enabled();
 
   STARTING_SLOW_SYSCALL;
-  sent = send(sockfd, buf, len, flags);
+  do {
+    sent = send(sockfd, buf, len, ev ? (flags | MSG_DONTWAIT) : flags);
+  } while( sent == -1 && ev && sys_event_retry(sockfd, flags, 1) );
   if( sent != -1 ) {
     *num_sent_out = sent;
     err_out = 0;
@@ -1711,9 +1785,13 @@ err_t sys_sendto(fd_t sockfd, const void* buf, int64_t len, int flags, const sys
 {
   ssize_t sent;
   err_t err_out;
+  int ev = qio_event_enabled();
 
   STARTING_SLOW_SYSCALL;
-  sent = sendto(sockfd, buf, len, flags, (const struct sockaddr*) &dest_addr->addr, dest_addr->len);
+  do {
+    sent = sendto(sockfd, buf, len, ev ? (flags | MSG_DONTWAIT) : flags,
+                  (const struct sockaddr*) &dest_addr->addr, dest_addr->len);
+  } while( sent == -1 && ev && sys_event_retry(sockfd, flags, 1) );
   if( sent != -1 ) {
     *num_sent_out = sent;
     err_out = 0;
@@ -1730,9 +1808,12 @@ err_t sys_sendmsg(fd_t sockfd, const struct msghdr *msg, int flags, ssize_t* num
 {
   ssize_t sent;
   err_t err_out;
+  int ev = qio_event_enabled();
 
   STARTING_SLOW_SYSCALL;
-  sent = sendmsg(sockfd, msg, flags);
+  do {
+    sent = sendmsg(sockfd, msg, ev ? (flags | MSG_DONTWAIT) : flags);
+  } while( sent == -1 && ev && sys_event_retry(sockfd, flags, 1) );
   if( sent != -1 ) {
     *num_sent_out = sent;
     err_out = 0;
@@ -26,7 +26,9 @@
 #include "chpl_rt_utils_static.h"
 #include "chplcgfns.h"
 #include "chpl-arg-bundle.h"
+#include "chpl-atomics.h"
 #include "chpl-comm.h"
+#include "chpl-env.h"
 #include "chplexit.h"
 #include "chpl-locale-model.h"
 #include "chpl-mem.h"
@@ -36,6 +38,7 @@
 #include "chpltypes.h"
 #include "chpl-linefile-support.h"
 #include "error.h"
+#include "qio_linebuf.h"
 #include <stdio.h>
 #include <string.h>
 #include <signal.h>
@@ -44,6 +47,7 @@
 #include <errno.h>
 #include <sys/time.h>
 #include <sys/mman.h>
+#include <time.h>
 #include <unistd.h>
 #include <math.h>
 
@@ -64,6 +68,17 @@ typedef struct task_pool_struct {
   task_pool_p      next;         // double-link pointers for pool
   task_pool_p      prev;
 
+  //
+  // Work-stealing mode only.  A task may be reachable both from a deque
+  // (or the pool) and from its parent's task list.  Whoever sets
+  // ws_claimed first runs it, and the last one to drop a reference
+  // frees it.
+  //
+  chpl_bool        ws;           // created in work-stealing mode
+  chpl_bool        ws_in_deque;  // counted in ws_queued_cnt until claimed
+  atomic_bool      ws_claimed;
+  atomic_int_least32_t ws_refs;
+
   chpl_task_prvDataImpl_t chpl_data;
 
   chpl_task_bundle_t* taskBundle; // addr of task bundle in bundle below
@@ -80,10 +95,31 @@ typedef struct lockReport {
 } lockReport_t;
 
 
+//
+// Work-stealing mode: each thread that creates tasks gets a
+// fixed-size Chase-Lev deque.  The owner pushes and pops at the
+// bottom; other threads steal from the top.  When a deque is full we
+// fall back to the global pool.
+//
+#define WS_DEQUE_SIZE 4096              // must be a power of 2
+#define WS_MAX_DEQUES 1024
+
+typedef struct {
+  atomic_int_least64_t top;
+  char pad[64 - sizeof(atomic_int_least64_t)];
+  atomic_int_least64_t bottom;
+  atomic_uintptr_t tasks[WS_DEQUE_SIZE];
+  c_sublocid_t numa;                    // owner's NUMA domain, if known
+} ws_deque_t;
+
+
 // This is the data that is private to each thread.
 typedef struct {
   task_pool_p   ptask;
   lockReport_t* lockRprt;
+  ws_deque_t*   deque;          // work-stealing mode: my deque, if any
+  chpl_bool     deque_tried;    //   did we try to get one?
+  uint32_t      steal_seed;     //   for picking victims
 } thread_private_data_t;
 
 
@@ -103,7 +139,8 @@ static int64_t             extra_task_cnt;     // number of tasks being run by
                                                //   threads occupied already
 static int                 blocked_thread_cnt; // number of threads that
                                                //   cannot make progress
-static int                 idle_thread_cnt;    // number of threads looking
+static atomic_int_least32_t
+                           idle_thread_cnt;    // number of threads looking
                                                //   for work
 static uint64_t            progress_cnt;       // number of unblock operations,
                                                //   as a proxy for progress
@@ -117,6 +154,11 @@ static chpl_thread_mutex_t taskTable_lock;     // critical section lock
 
 static chpl_fn_p comm_task_fn;
 
+static chpl_bool ws_mode;                      // work stealing enabled?
+static atomic_int_least32_t ws_queued_cnt;     // unclaimed tasks in deques
+static atomic_uintptr_t ws_deques[WS_MAX_DEQUES]; // all deques, for stealing
+static atomic_int_least32_t ws_num_deques;
+
 //
 // Internal functions.
 //
@@ -141,10 +183,20 @@ static void                    check_for_deadlock(void);
 static void                    thread_begin(void*);
 static void                    thread_end(void);
 static void                    maybe_add_thread(void);
+static task_pool_p             new_ptask(chpl_fn_int_t, chpl_fn_p,
+                                         void*, size_t, chpl_bool,
+                                         int, int32_t);
+static void                    announce_ptask(task_pool_p);
 static task_pool_p             add_to_task_pool(chpl_fn_int_t, chpl_fn_p,
                                                 void*, size_t,
                                                 chpl_bool, task_pool_p*,
                                                 chpl_bool, int, int32_t);
+static void                    ws_add_task(chpl_fn_int_t, chpl_task_bundle_t*,
+                                           size_t, task_pool_p*,
+                                           int, int32_t);
+static task_pool_p             ws_find_task(thread_private_data_t*);
+static chpl_bool               ws_claim(task_pool_p);
+static void                    ws_release(task_pool_p);
 
 //
 // Condition variable methods
@@ -160,11 +212,54 @@ static void chpl_thread_sync_awaken(chpl_sync_aux_t *s);
 
 // Sync variables
 
+//
+// Spin, then yield, waiting for the sync var to reach the wanted
+// state before we take its lock and fall into the blocking wait
+// below.  See chpl-sync-wait.h.
+//
+static void sync_wait_adaptive(chpl_sync_aux_t *s, chpl_bool want_full) {
+  chpl_task_infoRuntime_t* infoRuntime;
+  uint32_t limit, spun;
+  int i;
+
+  if (s->is_full == want_full)
+    return;
+
+  infoRuntime = chpl_task_getInfoRuntime();
+
+  limit = chpl_sync_spin_limit(s->spin_hint);
+  for (spun = 0; spun < limit; spun++) {
+    if (s->is_full == want_full) {
+      chpl_sync_spin_update(&s->spin_hint, spun, true);
+      if (infoRuntime)
+        infoRuntime->sync_wait.spins++;
+      return;
+    }
+    chpl_sync_cpu_relax();
+  }
+
+  chpl_sync_spin_update(&s->spin_hint, spun, false);
+
+  for (i = 0; i < CHPL_SYNC_NUM_YIELDS; i++) {
+    chpl_thread_yield();
+    if (s->is_full == want_full) {
+      if (infoRuntime)
+        infoRuntime->sync_wait.yields++;
+      return;
+    }
+  }
+
+  if (infoRuntime)
+    infoRuntime->sync_wait.parks++;
+}
+
 static void sync_wait_and_lock(chpl_sync_aux_t *s,
                                chpl_bool want_full,
                                int32_t lineno, int32_t filename) {
   chpl_bool suspend_using_cond;
 
+  sync_wait_adaptive(s, want_full);
+
   chpl_thread_mutexLock(&s->lock);
 
   // If we're oversubscribing the hardware, we wait using conditionals
@@ -288,6 +383,7 @@ void chpl_sync_initAux(chpl_sync_aux_t *s) {
   chpl_thread_mutexInit(&s->lock);
   chpl_thread_condvar_init(&s->signal_full);
   chpl_thread_condvar_init(&s->signal_empty);
+  s->spin_hint = CHPL_SYNC_SPIN_MIN;
 }
 
 static void chpl_thread_condvar_destroy(chpl_thread_condvar_t* cv) {
@@ -345,10 +441,17 @@ void chpl_task_init(void) {
   chpl_thread_mutexInit(&task_list_lock);
   queued_task_cnt = 0;
   blocked_thread_cnt = 0;
-  idle_thread_cnt = 0;
+  atomic_init_int_least32_t(&idle_thread_cnt, 0);
   extra_task_cnt = 0;
   task_pool_head = task_pool_tail = NULL;
 
+  ws_mode = chpl_env_rt_get_bool("TASKS_FIFO_WORK_STEALING", false);
+  atomic_init_int_least32_t(&ws_queued_cnt, 0);
+  atomic_init_int_least32_t(&ws_num_deques, 0);
+  for (int i = 0; i < WS_MAX_DEQUES; i++) {
+    atomic_init_uintptr_t(&ws_deques[i], 0);
+  }
+
   chpl_thread_init(thread_begin, thread_end);
 
   //
@@ -614,6 +717,12 @@ void chpl_task_addToTaskList(chpl_fn_int_t fid,
 
   arg->kind = CHPL_ARG_BUNDLE_KIND_TASK;
 
+  if (ws_mode && task_list_locale == chpl_nodeID) {
+    ws_add_task(fid, arg, arg_size, (task_pool_p*) p_task_list_void,
+                lineno, filename);
+    return;
+  }
+
   // begin critical section
   chpl_thread_mutexLock(&threading_lock);
 
@@ -639,6 +748,45 @@ void chpl_task_addToTaskList(chpl_fn_int_t fid,
 }
 
 
+void chpl_task_addTasksToTaskList(chpl_fn_int_t fid,
+                                  void* args, size_t arg_size,
+                                  int32_t num_tasks,
+                                  c_sublocid_t subloc,
+                                  void** p_task_list_void,
+                                  int32_t task_list_locale,
+                                  int lineno,
+                                  int32_t filename) {
+  //
+  // Each task gets its own pool descriptor here anyway, so there is
+  // nothing to gain by doing more than adding them one at a time.
+  //
+  for (int32_t i = 0; i < num_tasks; i++) {
+    chpl_task_addToTaskList(fid,
+                            (chpl_task_bundle_t*) ((char*) args
+                                                   + i * arg_size),
+                            arg_size, subloc, p_task_list_void,
+                            task_list_locale, false, lineno, filename);
+  }
+}
+
+
+void chpl_task_addLeafToTaskList(chpl_fn_int_t fid,
+                                 chpl_task_bundle_t* arg, size_t arg_size,
+                                 c_sublocid_t subloc,
+                                 void** p_task_list_void,
+                                 int32_t task_list_locale,
+                                 chpl_bool is_begin_stmt,
+                                 int lineno,
+                                 int32_t filename) {
+  //
+  // Tasks here already run on their thread's stack rather than one of
+  // their own, so leaf tasks need nothing special.
+  //
+  chpl_task_addToTaskList(fid, arg, arg_size, subloc, p_task_list_void,
+                          task_list_locale, is_begin_stmt, lineno, filename);
+}
+
+
 void chpl_task_executeTasksInList(void** p_task_list_void) {
   task_pool_p* p_task_list_head = (task_pool_p*) p_task_list_void;
   task_pool_p curr_ptask;
@@ -652,16 +800,30 @@ void chpl_task_executeTasksInList(void** p_task_list_void) {
   while (*p_task_list_head != NULL) {
     chpl_fn_p task_to_run_fun = NULL;
 
-    // begin critical section
-    chpl_thread_mutexLock(&threading_lock);
-
-    if ((child_ptask = *p_task_list_head) != NULL) {
+    if (ws_mode) {
+      //
+      // In work-stealing mode the list belongs to this task alone, and
+      // its entries may have been stolen already.  See ws_add_task().
+      //
+      child_ptask = *p_task_list_head;
+      *p_task_list_head = child_ptask->list_next;
+      if (!ws_claim(child_ptask)) {
+        ws_release(child_ptask);
+        continue;
+      }
       task_to_run_fun = child_ptask->taskBundle->requested_fn;
-      dequeue_task(child_ptask);
-    }
+    } else {
+      // begin critical section
+      chpl_thread_mutexLock(&threading_lock);
 
-    // end critical section
-    chpl_thread_mutexUnlock(&threading_lock);
+      if ((child_ptask = *p_task_list_head) != NULL) {
+        task_to_run_fun = child_ptask->taskBundle->requested_fn;
+        dequeue_task(child_ptask);
+      }
+
+      // end critical section
+      chpl_thread_mutexUnlock(&threading_lock);
+    }
 
     if (task_to_run_fun == NULL)
       continue;
@@ -695,6 +857,9 @@ void chpl_task_executeTasksInList(void** p_task_list_void) {
 
     (*task_to_run_fun)(&child_ptask->bundle);
 
+    chpl_task_arena_release(&child_ptask->chpl_data.infoRuntime.arena);
+    qio_linebuf_task_end(&child_ptask->chpl_data.infoRuntime.linebuf);
+
     chpl_task_do_callbacks(chpl_task_cb_event_kind_end,
                            child_ptask->taskBundle->requested_fid,
                            child_ptask->taskBundle->filename,
@@ -718,7 +883,10 @@ void chpl_task_executeTasksInList(void** p_task_list_void) {
     chpl_thread_mutexUnlock(&extra_task_lock);
 
     set_current_ptask(curr_ptask);
-    chpl_mem_free(child_ptask, 0, 0);
+    if (child_ptask->ws)
+      ws_release(child_ptask);
+    else
+      chpl_mem_free(child_ptask, 0, 0);
 
   }
 }
@@ -804,27 +972,24 @@ void chpl_task_yield(void) {
 
 
 void chpl_task_sleep(double secs) {
-  struct timeval deadline;
-  struct timeval now;
+  struct timespec deadline;
 
   //
-  // Figure out when this task can proceed again, and until then, keep
-  // yielding.
+  // Here a task is a thread, so there's no worker to give back while
+  // we sleep.  Just block the thread until we're due rather than
+  // yielding in a loop, which burns a CPU per sleeping task.
   //
-  gettimeofday(&deadline, NULL);
-  deadline.tv_usec += (suseconds_t) lround((secs - trunc(secs)) * 1.0e6);
-  if (deadline.tv_usec > 1000000) {
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+  deadline.tv_nsec += (long) lround((secs - trunc(secs)) * 1.0e9);
+  if (deadline.tv_nsec >= 1000000000) {
     deadline.tv_sec++;
-    deadline.tv_usec -= 1000000;
+    deadline.tv_nsec -= 1000000000;
   }
   deadline.tv_sec += (time_t) trunc(secs);
 
-  do {
-    chpl_task_yield();
-    gettimeofday(&now, NULL);
-  } while (now.tv_sec < deadline.tv_sec
-           || (now.tv_sec == deadline.tv_sec
-               && now.tv_usec < deadline.tv_usec));
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL)
+         == EINTR)
+    ;
 }
 
 uint32_t chpl_task_getMaxPar(void) {
@@ -864,7 +1029,7 @@ chpl_bool chpl_task_guardPagesInUse(void) {
 }
 
 uint32_t chpl_task_getNumQueuedTasks(void) {
-  return queued_task_cnt;
+  return queued_task_cnt + atomic_load_int_least32_t(&ws_queued_cnt);
 }
 
 int32_t chpl_task_getNumBlockedTasks(void) {
@@ -875,7 +1040,8 @@ int32_t chpl_task_getNumBlockedTasks(void) {
     chpl_thread_mutexLock(&threading_lock);
     chpl_thread_mutexLock(&block_report_lock);
 
-    numBlockedTasks = blocked_thread_cnt - idle_thread_cnt;
+    numBlockedTasks = blocked_thread_cnt
+                      - atomic_load_int_least32_t(&idle_thread_cnt);
 
     // end critical section
     chpl_thread_mutexUnlock(&block_report_lock);
@@ -1139,6 +1305,10 @@ static void check_for_deadlock(void) {
 // When we create a thread it runs this wrapper function, which just
 // executes tasks out of the pool as they become available.
 //
+#define WORK_AVAILABLE() \
+  (task_pool_head != NULL \
+   || (ws_mode && atomic_load_int_least32_t(&ws_queued_cnt) > 0))
+
 static void
 thread_begin(void* ptask_void) {
   task_pool_p ptask;
@@ -1151,6 +1321,9 @@ thread_begin(void* ptask_void) {
 
   tp->ptask = NULL;
   tp->lockRprt = NULL;
+  tp->deque = NULL;
+  tp->deque_tried = false;
+  tp->steal_seed = (uint32_t) (uintptr_t) tp | 1;
   if (blockreport)
     initializeLockReportForThread();
 
@@ -1169,7 +1342,7 @@ thread_begin(void* ptask_void) {
     // that were waiting on the signal, but since there was a performance
     // impact from keeping it as a hybrid as opposed to merely yielding,
     // it was decided that we would return to the simple yield case.
-    while (!task_pool_head) {
+    while (!WORK_AVAILABLE()) {
       if (set_block_loc(0, CHPL_FILE_IDX_IDLE_TASK)) {
         // all other tasks appear to be blocked
         struct timeval deadline, now;
@@ -1177,54 +1350,77 @@ thread_begin(void* ptask_void) {
         deadline.tv_sec += 1;
         do {
           chpl_thread_yield();
-          if (!task_pool_head)
+          if (!WORK_AVAILABLE())
             gettimeofday(&now, NULL);
-        } while (!task_pool_head
+        } while (!WORK_AVAILABLE()
                  && (now.tv_sec < deadline.tv_sec
                      || (now.tv_sec == deadline.tv_sec
                          && now.tv_usec < deadline.tv_usec)));
-        if (!task_pool_head) {
+        if (!WORK_AVAILABLE()) {
           check_for_deadlock();
         }
       }
       else {
         do {
           chpl_thread_yield();
-        } while (!task_pool_head);
+        } while (!WORK_AVAILABLE());
       }
 
       unset_block_loc();
     }
 
     //
-    // Just now the pool had at least one task in it.  Lock and see if
-    // there's something still there.
+    // In work-stealing mode, look in my own deque and then try to
+    // steal, before going to the pool.
     //
-    chpl_thread_mutexLock(&threading_lock);
-    if (!task_pool_head) {
-      chpl_thread_mutexUnlock(&threading_lock);
-      continue;
+    if (ws_mode && (ptask = ws_find_task(tp)) != NULL) {
+      if (blockreport) {
+        chpl_thread_mutexLock(&threading_lock);
+        progress_cnt++;
+        chpl_thread_mutexUnlock(&threading_lock);
+      }
     }
+    else {
+      //
+      // Just now the pool had at least one task in it.  Lock and see if
+      // there's something still there.
+      //
+      chpl_thread_mutexLock(&threading_lock);
+      if (!task_pool_head) {
+        chpl_thread_mutexUnlock(&threading_lock);
+        continue;
+      }
 
-    //
-    // We've found a task to run.
-    //
+      //
+      // We've found a task to run.
+      //
 
-    if (blockreport)
-      progress_cnt++;
+      if (blockreport)
+        progress_cnt++;
 
-    //
-    // start new task; remove task from pool also add to task to task-table
-    // (structure in ChapelRuntime that keeps track of currently running tasks
-    // for task-reports on deadlock or Ctrl+C).
-    //
-    ptask = task_pool_head;
-    idle_thread_cnt--;
+      //
+      // start new task; remove task from pool also add to task to
+      // task-table (structure in ChapelRuntime that keeps track of
+      // currently running tasks for task-reports on deadlock or Ctrl+C).
+      //
+      ptask = task_pool_head;
 
-    dequeue_task(ptask);
+      dequeue_task(ptask);
 
-    // end critical section
-    chpl_thread_mutexUnlock(&threading_lock);
+      // end critical section
+      chpl_thread_mutexUnlock(&threading_lock);
+
+      //
+      // A work-stealing task that overflowed into the pool may have
+      // been run by its parent already.
+      //
+      if (ptask->ws && !ws_claim(ptask)) {
+        ws_release(ptask);
+        continue;
+      }
+    }
+
+    (void) atomic_fetch_add_int_least32_t(&idle_thread_cnt, -1);
 
     tp->ptask = ptask;
 
@@ -1243,6 +1439,9 @@ thread_begin(void* ptask_void) {
 
     (ptask->taskBundle->requested_fn)(&ptask->bundle);
 
+    chpl_task_arena_release(&ptask->chpl_data.infoRuntime.arena);
+    qio_linebuf_task_end(&ptask->chpl_data.infoRuntime.linebuf);
+
     chpl_task_do_callbacks(chpl_task_cb_event_kind_end,
                            ptask->taskBundle->requested_fid,
                            ptask->taskBundle->filename,
@@ -1257,18 +1456,15 @@ thread_begin(void* ptask_void) {
     }
 
     tp->ptask = NULL;
-    chpl_mem_free(ptask, 0, 0);
-
-    // begin critical section
-    chpl_thread_mutexLock(&threading_lock);
+    if (ptask->ws)
+      ws_release(ptask);
+    else
+      chpl_mem_free(ptask, 0, 0);
 
     //
     // finished task; increment idle count
     //
-    idle_thread_cnt++;
-
-    // end critical section
-    chpl_thread_mutexUnlock(&threading_lock);
+    (void) atomic_fetch_add_int_least32_t(&idle_thread_cnt, 1);
   }
 }
 
@@ -1300,7 +1496,7 @@ static void maybe_add_thread(void) {
 
   if (!warning_issued && chpl_thread_canCreate()) {
     if (chpl_thread_create(NULL) == 0) {
-      idle_thread_cnt++;
+      (void) atomic_fetch_add_int_least32_t(&idle_thread_cnt, 1);
     }
     else {
       int32_t max_threads = chpl_thread_getMaxThreads();
@@ -1323,18 +1519,12 @@ static void maybe_add_thread(void) {
 }
 
 
-// create a task from the given function pointer and arguments
-// and append it to the end of the task pool
-// assumes threading_lock has already been acquired!
+// create a task descriptor from the given function pointer and arguments
 static inline
-task_pool_p add_to_task_pool(chpl_fn_int_t fid, chpl_fn_p fp,
-                             void* a, size_t a_size,
-                             chpl_bool is_executeOn,
-                             task_pool_p* p_task_list_head,
-                             chpl_bool is_begin_stmt,
-                             int lineno, int32_t filename) {
-
-
+task_pool_p new_ptask(chpl_fn_int_t fid, chpl_fn_p fp,
+                      void* a, size_t a_size,
+                      chpl_bool is_executeOn,
+                      int lineno, int32_t filename) {
   task_pool_p ptask;
   chpl_task_prvDataImpl_t pv;
 
@@ -1357,6 +1547,8 @@ task_pool_p add_to_task_pool(chpl_fn_int_t fid, chpl_fn_p fp,
   ptask->list_prev              = NULL;
   ptask->next                   = NULL;
   ptask->prev                   = NULL;
+  ptask->ws                     = false;
+  ptask->ws_in_deque            = false;
   ptask->chpl_data              = pv;
 
   *ptask->taskBundle =
@@ -1371,8 +1563,13 @@ task_pool_p add_to_task_pool(chpl_fn_int_t fid, chpl_fn_p fp,
       .infoChapel      = ptask->taskBundle->infoChapel,// retain; set by caller
     };
 
-  enqueue_task(ptask, p_task_list_head);
+  return ptask;
+}
 
+
+// tell the callbacks and the task table about a new task
+static inline
+void announce_ptask(task_pool_p ptask) {
   chpl_task_do_callbacks(chpl_task_cb_event_kind_create,
                          ptask->taskBundle->requested_fid,
                          ptask->taskBundle->filename,
@@ -1388,10 +1585,30 @@ task_pool_p add_to_task_pool(chpl_fn_int_t fid, chpl_fn_p fp,
                           (uint64_t) (intptr_t) ptask);
     chpl_thread_mutexUnlock(&taskTable_lock);
   }
+}
+
+
+// create a task from the given function pointer and arguments
+// and append it to the end of the task pool
+// assumes threading_lock has already been acquired!
+static inline
+task_pool_p add_to_task_pool(chpl_fn_int_t fid, chpl_fn_p fp,
+                             void* a, size_t a_size,
+                             chpl_bool is_executeOn,
+                             task_pool_p* p_task_list_head,
+                             chpl_bool is_begin_stmt,
+                             int lineno, int32_t filename) {
+  task_pool_p ptask;
+
+  ptask = new_ptask(fid, fp, a, a_size, is_executeOn, lineno, filename);
+
+  enqueue_task(ptask, p_task_list_head);
+
+  announce_ptask(ptask);
 
   // If we now have more tasks than threads to run them on, try to start
   // another thread
-  if (queued_task_cnt > idle_thread_cnt) {
+  if (queued_task_cnt > atomic_load_int_least32_t(&idle_thread_cnt)) {
     maybe_add_thread();
   }
 
@@ -1399,6 +1616,258 @@ task_pool_p add_to_task_pool(chpl_fn_int_t fid, chpl_fn_p fp,
 }
 
 
+////////////////////
+//
+// Work-stealing mode
+//
+// Tasks created locally by begin, cobegin and coforall go on the
+// creating thread's deque instead of the global pool, so creating them
+// doesn't need threading_lock.  Idle threads pop from their own deque
+// first and then steal the oldest task from a randomly chosen victim's
+// deque.  Tasks from elsewhere (moved executeOns) still use the pool.
+//
+// Cobegin and coforall tasks are also on their parent's task list, so
+// the parent can run them when it waits.  The list is only ever touched
+// by the parent, so it is singly linked and needs no lock.  The task
+// is claimed by whoever sets ws_claimed first, and freed when the
+// deque (or pool) and list references have both been dropped.
+//
+
+static inline
+void ws_deque_init(ws_deque_t* d) {
+  atomic_init_int_least64_t(&d->top, 0);
+  atomic_init_int_least64_t(&d->bottom, 0);
+  for (int i = 0; i < WS_DEQUE_SIZE; i++) {
+    atomic_init_uintptr_t(&d->tasks[i], 0);
+  }
+}
+
+
+// owner only; returns false if the deque is full
+static inline
+chpl_bool ws_deque_push(ws_deque_t* d, task_pool_p ptask) {
+  int_least64_t b = atomic_load_explicit_int_least64_t(&d->bottom,
+                                                       memory_order_relaxed);
+  int_least64_t t = atomic_load_explicit_int_least64_t(&d->top,
+                                                       memory_order_acquire);
+  if (b - t >= WS_DEQUE_SIZE)
+    return false;
+  atomic_store_explicit_uintptr_t(&d->tasks[b & (WS_DEQUE_SIZE - 1)],
+                                  (uintptr_t) ptask, memory_order_relaxed);
+  chpl_atomic_thread_fence(memory_order_release);
+  atomic_store_explicit_int_least64_t(&d->bottom, b + 1,
+                                      memory_order_relaxed);
+  return true;
+}
+
+
+// owner only
+static inline
+task_pool_p ws_deque_pop(ws_deque_t* d) {
+  int_least64_t b = atomic_load_explicit_int_least64_t(&d->bottom,
+                                                       memory_order_relaxed)
+                    - 1;
+  int_least64_t t;
+  task_pool_p ptask = NULL;
+
+  atomic_store_explicit_int_least64_t(&d->bottom, b, memory_order_relaxed);
+  chpl_atomic_thread_fence(memory_order_seq_cst);
+  t = atomic_load_explicit_int_least64_t(&d->top, memory_order_relaxed);
+
+  if (t <= b) {
+    ptask = (task_pool_p)
+            atomic_load_explicit_uintptr_t(&d->tasks[b & (WS_DEQUE_SIZE - 1)],
+                                           memory_order_relaxed);
+    if (t == b) {
+      // last one; race any thieves for it
+      if (!atomic_compare_exchange_strong_explicit_int_least64_t(
+             &d->top, &t, t + 1,
+             memory_order_seq_cst, memory_order_relaxed)) {
+        ptask = NULL;
+      }
+      atomic_store_explicit_int_least64_t(&d->bottom, b + 1,
+                                          memory_order_relaxed);
+    }
+  } else {
+    atomic_store_explicit_int_least64_t(&d->bottom, b + 1,
+                                        memory_order_relaxed);
+  }
+
+  return ptask;
+}
+
+
+// any thread
+static inline
+task_pool_p ws_deque_steal(ws_deque_t* d) {
+  int_least64_t t = atomic_load_explicit_int_least64_t(&d->top,
+                                                       memory_order_acquire);
+  int_least64_t b;
+  task_pool_p ptask;
+
+  chpl_atomic_thread_fence(memory_order_seq_cst);
+  b = atomic_load_explicit_int_least64_t(&d->bottom, memory_order_acquire);
+  if (t >= b)
+    return NULL;
+
+  ptask = (task_pool_p)
+          atomic_load_explicit_uintptr_t(&d->tasks[t & (WS_DEQUE_SIZE - 1)],
+                                         memory_order_relaxed);
+  if (!atomic_compare_exchange_strong_explicit_int_least64_t(
+         &d->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+    return NULL;
+  }
+
+  return ptask;
+}
+
+
+static
+ws_deque_t* ws_get_my_deque(thread_private_data_t* tp) {
+  if (tp->deque == NULL && !tp->deque_tried) {
+    int_least32_t i;
+
+    tp->deque_tried = true;
+    i = atomic_fetch_add_int_least32_t(&ws_num_deques, 1);
+    if (i < WS_MAX_DEQUES) {
+      tp->deque = (ws_deque_t*) chpl_mem_alloc(sizeof(ws_deque_t),
+                                               CHPL_RT_MD_TASK_POOL_DESC,
+                                               0, 0);
+      ws_deque_init(tp->deque);
+      tp->deque->numa = chpl_topo_getThreadLocality();
+      atomic_store_explicit_uintptr_t(&ws_deques[i], (uintptr_t) tp->deque,
+                                      memory_order_release);
+    }
+  }
+
+  return tp->deque;
+}
+
+
+static inline
+chpl_bool ws_claim(task_pool_p ptask) {
+  if (atomic_exchange_bool(&ptask->ws_claimed, true))
+    return false;
+  if (ptask->ws_in_deque)
+    (void) atomic_fetch_add_int_least32_t(&ws_queued_cnt, -1);
+  return true;
+}
+
+
+static inline
+void ws_release(task_pool_p ptask) {
+  if (atomic_fetch_add_int_least32_t(&ptask->ws_refs, -1) == 1)
+    chpl_mem_free(ptask, 0, 0);
+}
+
+
+static
+void ws_add_task(chpl_fn_int_t fid,
+                 chpl_task_bundle_t* arg, size_t arg_size,
+                 task_pool_p* p_task_list_head,
+                 int lineno, int32_t filename) {
+  thread_private_data_t* tp = chpl_thread_getPrivateData();
+  ws_deque_t* d = (tp == NULL) ? NULL : ws_get_my_deque(tp);
+  task_pool_p ptask;
+
+  ptask = new_ptask(fid, chpl_ftable[fid], arg, arg_size, false,
+                    lineno, filename);
+  ptask->ws = true;
+  atomic_init_bool(&ptask->ws_claimed, false);
+  atomic_init_int_least32_t(&ptask->ws_refs,
+                            (p_task_list_head == NULL) ? 1 : 2);
+
+  if (p_task_list_head != NULL) {
+    ptask->list_next = *p_task_list_head;
+    *p_task_list_head = ptask;
+  }
+
+  // Announce before publishing, since it could run as soon as we do.
+  announce_ptask(ptask);
+
+  if (d != NULL) {
+    ptask->ws_in_deque = true;
+    (void) atomic_fetch_add_int_least32_t(&ws_queued_cnt, 1);
+    if (ws_deque_push(d, ptask)) {
+      // start another thread, if it looks like there's no one to steal
+      if (atomic_load_int_least32_t(&ws_queued_cnt)
+          > atomic_load_int_least32_t(&idle_thread_cnt)) {
+        chpl_thread_mutexLock(&threading_lock);
+        maybe_add_thread();
+        chpl_thread_mutexUnlock(&threading_lock);
+      }
+      return;
+    }
+    (void) atomic_fetch_add_int_least32_t(&ws_queued_cnt, -1);
+    ptask->ws_in_deque = false;
+  }
+
+  // No deque, or it's full: use the pool.
+  chpl_thread_mutexLock(&threading_lock);
+  enqueue_task(ptask, NULL);
+  if (queued_task_cnt > atomic_load_int_least32_t(&idle_thread_cnt)) {
+    maybe_add_thread();
+  }
+  chpl_thread_mutexUnlock(&threading_lock);
+}
+
+
+//
+// Find a task in my own deque or someone else's.  Returns a claimed
+// task, or NULL if we didn't find one.
+//
+static
+task_pool_p ws_find_task(thread_private_data_t* tp) {
+  ws_deque_t* d = ws_get_my_deque(tp);
+  task_pool_p ptask;
+  int_least32_t n;
+
+  if (d != NULL) {
+    while ((ptask = ws_deque_pop(d)) != NULL) {
+      if (ws_claim(ptask))
+        return ptask;
+      ws_release(ptask);
+    }
+  }
+
+  n = atomic_load_int_least32_t(&ws_num_deques);
+  if (n > WS_MAX_DEQUES)
+    n = WS_MAX_DEQUES;
+
+  //
+  // Make the first half of our attempts only on victims in our own
+  // NUMA domain, so stolen tasks tend to stay near their data.
+  //
+  for (int_least32_t tries = 0; tries < 2 * n; tries++) {
+    uint32_t x = tp->steal_seed;
+    ws_deque_t* victim;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    tp->steal_seed = x;
+
+    victim = (ws_deque_t*)
+             atomic_load_explicit_uintptr_t(&ws_deques[x % n],
+                                            memory_order_acquire);
+    if (victim == NULL || victim == d)
+      continue;
+
+    if (tries < n && d != NULL
+        && isActualSublocID(d->numa) && victim->numa != d->numa)
+      continue;
+
+    if ((ptask = ws_deque_steal(victim)) != NULL) {
+      if (ws_claim(ptask))
+        return ptask;
+      ws_release(ptask);
+    }
+  }
+
+  return NULL;
+}
+
+
 // Threads
 
 uint32_t chpl_task_getNumThreads(void) {
@@ -1406,5 +1875,5 @@ uint32_t chpl_task_getNumThreads(void) {
 }
 
 uint32_t chpl_task_getNumIdleThreads(void) {
-  return idle_thread_cnt;
+  return atomic_load_int_least32_t(&idle_thread_cnt);
 }
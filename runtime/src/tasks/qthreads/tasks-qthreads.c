@@ -35,6 +35,7 @@
 
 #include "arg.h"
 #include "error.h"
+#include "chpl-cache.h"
 #include "chplcgfns.h"
 #include "chpl-arg-bundle.h"
 #include "chpl-comm.h"
@@ -47,8 +48,10 @@
 #include "chpl-tasks.h"
 #include "chpl-tasks-callbacks-internal.h"
 #include "chpl-tasks-impl.h"
+#include "chpl-timer-wheel.h"
 #include "chpl-topo.h"
 #include "chpltypes.h"
+#include "qio_linebuf.h"
 
 #include "qthread.h"
 #include "qthread/qtimer.h"
@@ -62,7 +65,9 @@
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 #include <math.h>
 
@@ -122,6 +127,188 @@ static void profile_print(void)
 # define PROFILE_INCR(counter,count)
 #endif /* CHAPEL_PROFILE */
 
+//
+// Task profiling (CHPL_RT_TASKS_PROFILE).  For each task function we
+// count spawns and completions and total up the queue wait (spawn to
+// start) and run (start to finish) times, along with how often its
+// tasks yielded and parked on sync variables.  Each worker has its own
+// table, indexed by function ID + 1 so that FID_NONE (the main task and
+// the like) gets a row too.  Threads that aren't Qthreads workers share
+// one extra table, updated atomically.  The tables are summed and a
+// ranked report printed to stderr at exit.
+//
+typedef struct {
+    aligned_t spawns;
+    aligned_t runs;
+    aligned_t wait_ns;
+    aligned_t run_ns;
+    aligned_t yields;
+    aligned_t blocks;
+} task_prof_entry_t;
+
+static chpl_bool          task_prof_enabled = false;
+static int                task_prof_num_fns;        // rows per table
+static int                task_prof_num_tables;     // workers + 1
+static task_prof_entry_t *task_prof_tables;
+
+#define TASK_PROF_REPORT_ROWS 25
+
+static inline uint64_t task_prof_now(void)
+{
+    struct timespec ts;
+    (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+}
+
+// Returns the calling thread's row for fid; *shared tells whether that
+// row is in the shared table and so needs atomic updates.
+static inline task_prof_entry_t *task_prof_row(chpl_fn_int_t fid,
+                                               chpl_bool *shared)
+{
+    qthread_worker_id_t w = qthread_worker(NULL);
+    int row = (fid >= 0 && fid + 1 < task_prof_num_fns) ? fid + 1 : 0;
+
+    *shared = (w == NO_WORKER || w >= task_prof_num_tables - 1);
+    if (*shared)
+        w = task_prof_num_tables - 1;
+
+    return &task_prof_tables[(size_t) w * task_prof_num_fns + row];
+}
+
+static inline void task_prof_add(aligned_t *ctr, uint64_t val,
+                                 chpl_bool shared)
+{
+    if (shared)
+        (void) qthread_incr(ctr, val);
+    else
+        *ctr += val;
+}
+
+static inline void task_prof_spawn(chpl_task_bundle_t *bundle)
+{
+    task_prof_entry_t *ent;
+    chpl_bool shared;
+
+    if (!task_prof_enabled) {
+        bundle->spawn_time = 0;
+        return;
+    }
+
+    bundle->spawn_time = task_prof_now();
+    ent = task_prof_row(bundle->requested_fid, &shared);
+    task_prof_add(&ent->spawns, 1, shared);
+}
+
+static inline void task_prof_end(chpl_qthread_tls_t *tls, uint64_t t_start)
+{
+    chpl_task_bundle_t *bundle = tls->bundle;
+    uint64_t t_end = task_prof_now();
+    task_prof_entry_t *ent;
+    chpl_bool shared;
+
+    ent = task_prof_row(bundle->requested_fid, &shared);
+    task_prof_add(&ent->runs, 1, shared);
+    if (bundle->spawn_time != 0 && t_start > bundle->spawn_time)
+        task_prof_add(&ent->wait_ns, t_start - bundle->spawn_time, shared);
+    task_prof_add(&ent->run_ns, t_end - t_start, shared);
+    task_prof_add(&ent->blocks, tls->infoRuntime.sync_wait.parks, shared);
+}
+
+static void task_prof_init(void)
+{
+    if (!chpl_env_rt_get_bool("TASKS_PROFILE", false))
+        return;
+
+    for (task_prof_num_fns = 0;
+         chpl_finfo[task_prof_num_fns].name != NULL;
+         task_prof_num_fns++)
+        ;
+    task_prof_num_fns++;        // row 0 is for FID_NONE
+    task_prof_num_tables = qthread_num_workers() + 1;
+    task_prof_tables =
+        chpl_mem_allocManyZero((size_t) task_prof_num_tables
+                               * task_prof_num_fns,
+                               sizeof(task_prof_entry_t),
+                               CHPL_RT_MD_TASK_LAYER_UNSPEC, 0, 0);
+    task_prof_enabled = true;
+}
+
+static int task_prof_cmp(const void *a, const void *b)
+{
+    const task_prof_entry_t *ea = *(task_prof_entry_t * const *) a;
+    const task_prof_entry_t *eb = *(task_prof_entry_t * const *) b;
+    return (ea->run_ns < eb->run_ns) - (ea->run_ns > eb->run_ns);
+}
+
+static void task_prof_report(void)
+{
+    task_prof_entry_t *sums;
+    task_prof_entry_t **ranked;
+    int num_ranked = 0;
+
+    if (!task_prof_enabled)
+        return;
+    task_prof_enabled = false;
+
+    sums = chpl_mem_allocManyZero(task_prof_num_fns, sizeof(*sums),
+                                  CHPL_RT_MD_TASK_LAYER_UNSPEC, 0, 0);
+    ranked = chpl_mem_allocMany(task_prof_num_fns, sizeof(*ranked),
+                                CHPL_RT_MD_TASK_LAYER_UNSPEC, 0, 0);
+
+    for (int t = 0; t < task_prof_num_tables; t++) {
+        for (int f = 0; f < task_prof_num_fns; f++) {
+            task_prof_entry_t *e =
+                &task_prof_tables[(size_t) t * task_prof_num_fns + f];
+            sums[f].spawns  += e->spawns;
+            sums[f].runs    += e->runs;
+            sums[f].wait_ns += e->wait_ns;
+            sums[f].run_ns  += e->run_ns;
+            sums[f].yields  += e->yields;
+            sums[f].blocks  += e->blocks;
+        }
+    }
+
+    for (int f = 0; f < task_prof_num_fns; f++) {
+        if (sums[f].spawns != 0 || sums[f].runs != 0)
+            ranked[num_ranked++] = &sums[f];
+    }
+    qsort(ranked, num_ranked, sizeof(*ranked), task_prof_cmp);
+
+    fprintf(stderr,
+            "%d: task profile, by total run time\n"
+            "%d: %12s %12s %12s %12s %12s %10s %10s  %s\n",
+            (int) chpl_nodeID, (int) chpl_nodeID,
+            "spawns", "runs", "run (s)", "avg run (us)", "avg wait (us)",
+            "yields", "blocks", "function");
+    for (int i = 0; i < num_ranked && i < TASK_PROF_REPORT_ROWS; i++) {
+        task_prof_entry_t *e = ranked[i];
+        int f = (int) (e - sums);
+        double runs = (e->runs == 0) ? 1.0 : (double) e->runs;
+        char where[200];
+
+        if (f == 0) {
+            snprintf(where, sizeof(where), "<no function ID>");
+        } else {
+            const chpl_fn_info *fi = &chpl_finfo[f - 1];
+            snprintf(where, sizeof(where), "%s (%s:%d)", fi->name,
+                     chpl_lookupFilename(fi->fileno), fi->lineno);
+        }
+
+        fprintf(stderr,
+                "%d: %12" PRIu64 " %12" PRIu64 " %12.6f %12.3f %12.3f"
+                " %10" PRIu64 " %10" PRIu64 "  %s\n",
+                (int) chpl_nodeID,
+                (uint64_t) e->spawns, (uint64_t) e->runs,
+                (double) e->run_ns / 1e9,
+                (double) e->run_ns / runs / 1e3,
+                (double) e->wait_ns / runs / 1e3,
+                (uint64_t) e->yields, (uint64_t) e->blocks, where);
+    }
+
+    chpl_mem_free(ranked, 0, 0);
+    chpl_mem_free(sums, 0, 0);
+}
+
 //
 // Startup and shutdown control.  The mutex is used just for the side
 // effect of its (very portable) memory fence.
@@ -186,6 +373,15 @@ static chpl_bool guardPagesInUse = true;
 void chpl_task_yield(void)
 {
     PROFILE_INCR(profile_task_yield,1);
+    if (task_prof_enabled) {
+        chpl_qthread_tls_t *tls = chpl_qthread_get_tasklocal();
+        if (tls != NULL && tls->bundle != NULL) {
+            chpl_bool shared;
+            task_prof_entry_t *ent =
+                task_prof_row(tls->bundle->requested_fid, &shared);
+            task_prof_add(&ent->yields, 1, shared);
+        }
+    }
     if (qthread_shep() == NO_SHEPHERD) {
         sched_yield();
     } else {
@@ -194,6 +390,50 @@ void chpl_task_yield(void)
 }
 
 // Sync variables
+
+//
+// Spin, then yield, waiting for the sync var to reach the wanted
+// state, before falling back to parking on the FEB.  See
+// chpl-sync-wait.h.
+//
+static void sync_wait_adaptive(chpl_sync_aux_t *s, int want_full)
+{
+    volatile int *is_full = &s->is_full;
+    chpl_task_infoRuntime_t *infoRuntime;
+    uint32_t limit, spun;
+    int i;
+
+    if ((*is_full != 0) == want_full)
+        return;
+
+    infoRuntime = chpl_task_getInfoRuntime();
+
+    limit = chpl_sync_spin_limit(s->spin_hint);
+    for (spun = 0; spun < limit; spun++) {
+        if ((*is_full != 0) == want_full) {
+            chpl_sync_spin_update(&s->spin_hint, spun, true);
+            if (infoRuntime)
+                infoRuntime->sync_wait.spins++;
+            return;
+        }
+        chpl_sync_cpu_relax();
+    }
+
+    chpl_sync_spin_update(&s->spin_hint, spun, false);
+
+    for (i = 0; i < CHPL_SYNC_NUM_YIELDS; i++) {
+        qthread_yield();
+        if ((*is_full != 0) == want_full) {
+            if (infoRuntime)
+                infoRuntime->sync_wait.yields++;
+            return;
+        }
+    }
+
+    if (infoRuntime)
+        infoRuntime->sync_wait.parks++;
+}
+
 void chpl_sync_lock(chpl_sync_aux_t *s)
 {
     PROFILE_INCR(profile_sync_lock, 1);
@@ -214,6 +454,7 @@ void chpl_sync_waitFullAndLock(chpl_sync_aux_t *s,
 {
     PROFILE_INCR(profile_sync_waitFullAndLock, 1);
 
+    sync_wait_adaptive(s, 1);
     chpl_sync_lock(s);
     while (s->is_full == 0) {
         chpl_sync_unlock(s);
@@ -228,6 +469,7 @@ void chpl_sync_waitEmptyAndLock(chpl_sync_aux_t *s,
 {
     PROFILE_INCR(profile_sync_waitEmptyAndLock, 1);
 
+    sync_wait_adaptive(s, 0);
     chpl_sync_lock(s);
     while (s->is_full != 0) {
         chpl_sync_unlock(s);
@@ -270,6 +512,7 @@ void chpl_sync_initAux(chpl_sync_aux_t *s)
     s->is_full      = 0;
     s->signal_empty = 0;
     s->signal_full  = 0;
+    s->spin_hint    = CHPL_SYNC_SPIN_MIN;
 }
 
 void chpl_sync_destroyAux(chpl_sync_aux_t *s)
@@ -646,6 +889,23 @@ static void setupCallStacks(void) {
     }
     snprintf(newenv_alloc, sizeof(newenv_alloc), "%zu", maxPoolAllocSize);
     chpl_qt_setenv("MAX_POOL_ALLOC_SIZE", newenv_alloc, 0);
+
+    // With guard pages, Qthreads keeps a per-shepherd cache of freed
+    // stacks with their guard pages still in place, so reusing a stack
+    // doesn't cost mprotect() calls.  The high-water mark is in stacks,
+    // settable via CHPL_RT_TASKS_STACK_POOL_MAX; by default it allows up
+    // to 64 MiB of cached stacks per shepherd.
+    if (guardPagesEnabled) {
+        char newenv_cache[QT_ENV_S];
+        int64_t cacheMax = chpl_env_rt_get_int("TASKS_STACK_POOL_MAX", -1);
+        if (cacheMax < 0) {
+            cacheMax = (64 << 20) / stackSize;
+            if (cacheMax < 1)
+                cacheMax = 1;
+        }
+        snprintf(newenv_cache, sizeof(newenv_cache), "%" PRId64, cacheMax);
+        chpl_qt_setenv("GUARDED_STACK_CACHE", newenv_cache, 0);
+    }
 }
 
 static void setupTasklocalStorage(void) {
@@ -679,6 +939,126 @@ static void setupSpinWaiting(void) {
   }
 }
 
+//
+// NUMA placement.  Once Qthreads is up we ask each shepherd which NUMA
+// domain it is running in and group the shepherds by domain, so that
+// tasks created under a NUMA hint (see chpl_task_setNumaHint()) can be
+// sent round-robin to the shepherds in the hinted domain.
+//
+static int                    numa_num_doms = 0;
+static qthread_shepherd_id_t *numa_sheps = NULL;    // grouped by domain
+static int                   *numa_sheps_start;     // [d] .. [d+1]
+static aligned_t             *numa_next_shep;       // per-domain cursor
+
+static aligned_t probe_shep_numa(void *arg)
+{
+    *(c_sublocid_t*) arg = chpl_topo_getThreadLocality();
+    return 0;
+}
+
+static void setupNumaPlacement(void)
+{
+    qthread_shepherd_id_t num_sheps = qthread_num_shepherds();
+    int num_doms = chpl_topo_getNumNumaDomains();
+    c_sublocid_t *shep_numa;
+    aligned_t *rets;
+
+    if (num_doms <= 1 || num_sheps <= 1)
+        return;
+
+    shep_numa = chpl_mem_allocMany(num_sheps, sizeof(*shep_numa),
+                                   CHPL_RT_MD_TASK_LAYER_UNSPEC, 0, 0);
+    rets = chpl_mem_allocMany(num_sheps, sizeof(*rets),
+                              CHPL_RT_MD_TASK_LAYER_UNSPEC, 0, 0);
+    for (qthread_shepherd_id_t s = 0; s < num_sheps; s++)
+        qthread_fork_to(probe_shep_numa, &shep_numa[s], &rets[s], s);
+    for (qthread_shepherd_id_t s = 0; s < num_sheps; s++)
+        qthread_readFF(NULL, &rets[s]);
+
+    numa_sheps_start = chpl_mem_allocManyZero(num_doms + 1,
+                                              sizeof(*numa_sheps_start),
+                                              CHPL_RT_MD_TASK_LAYER_UNSPEC,
+                                              0, 0);
+    numa_next_shep = chpl_mem_allocManyZero(num_doms,
+                                            sizeof(*numa_next_shep),
+                                            CHPL_RT_MD_TASK_LAYER_UNSPEC,
+                                            0, 0);
+    numa_sheps = chpl_mem_allocMany(num_sheps, sizeof(*numa_sheps),
+                                    CHPL_RT_MD_TASK_LAYER_UNSPEC, 0, 0);
+
+    // counting sort of the shepherds by domain
+    for (qthread_shepherd_id_t s = 0; s < num_sheps; s++) {
+        if (isActualSublocID(shep_numa[s]) && shep_numa[s] < num_doms)
+            numa_sheps_start[shep_numa[s] + 1]++;
+    }
+    for (int d = 0; d < num_doms; d++)
+        numa_sheps_start[d + 1] += numa_sheps_start[d];
+    {
+        int fill[num_doms];
+        for (int d = 0; d < num_doms; d++)
+            fill[d] = numa_sheps_start[d];
+        for (qthread_shepherd_id_t s = 0; s < num_sheps; s++) {
+            if (isActualSublocID(shep_numa[s]) && shep_numa[s] < num_doms)
+                numa_sheps[fill[shep_numa[s]]++] = s;
+        }
+    }
+
+    chpl_mem_free(rets, 0, 0);
+    chpl_mem_free(shep_numa, 0, 0);
+
+    numa_num_doms = num_doms;
+}
+
+//
+// If the current task has a NUMA hint we can honor, return the next
+// shepherd in that domain.  Otherwise return NO_SHEPHERD.
+//
+static qthread_shepherd_id_t numaHintShep(void)
+{
+    c_sublocid_t d = chpl_task_getNumaHint();
+    int n;
+
+    if (numa_sheps == NULL || !isActualSublocID(d) || d >= numa_num_doms)
+        return NO_SHEPHERD;
+
+    n = numa_sheps_start[d + 1] - numa_sheps_start[d];
+    if (n == 0)
+        return NO_SHEPHERD;
+
+    return numa_sheps[numa_sheps_start[d]
+                      + qthread_incr(&numa_next_shep[d], 1) % n];
+}
+
+//
+// Leaf tasks.  Rather than each getting a qthread (and thus a stack) of
+// its own, leaf tasks go on a per-shepherd queue that is drained by a
+// single carrier qthread, which runs them one after another on its own
+// stack.  A carrier is forked when a leaf is queued and none is active
+// for that shepherd, and it exits when it finds the queue empty.  Each
+// queued leaf holds a link to the next, then its arg bundle.
+//
+typedef struct leaf_task {
+    struct leaf_task *next;
+} leaf_task_t;
+
+#define LEAF_TASK_HDR ALIGN_UP(sizeof(leaf_task_t), BULK_ALIGN)
+#define LEAF_TASKS_PER_YIELD 64
+
+typedef struct {
+    leaf_task_t *volatile head;         // pushed LIFO, run FIFO
+    aligned_t             active;       // carrier running?
+    char                  pad[64 - sizeof(void*) - sizeof(aligned_t)];
+} leaf_queue_t;
+
+static leaf_queue_t *leaf_queues;
+
+static void setupLeafQueues(void)
+{
+    leaf_queues = chpl_mem_allocManyZero(qthread_num_shepherds(),
+                                         sizeof(*leaf_queues),
+                                         CHPL_RT_MD_TASK_LAYER_UNSPEC, 0, 0);
+}
+
 static void setupAffinity(void) {
   if (chpl_env_rt_get_bool("OVERSUBSCRIBED", false)) {
     chpl_qt_setenv("AFFINITY", "no", 0);
@@ -714,6 +1094,10 @@ void chpl_task_init(void)
     while (chpl_qthread_done_initializing == 0)
         sched_yield();
 
+    setupNumaPlacement();
+    setupLeafQueues();
+    task_prof_init();
+
     // Now that Qthreads is up and running, do a sanity check and make sure
     // that the number of workers is less than any comm layer limit. This is
     // mainly need for the case where a user set QT_NUM_SHEPHERDS and/or
@@ -730,6 +1114,8 @@ void chpl_task_init(void)
 
 void chpl_task_exit(void)
 {
+    task_prof_report();
+
 #ifdef CHAPEL_PROFILE
     profile_print();
 #endif /* CHAPEL_PROFILE */
@@ -766,13 +1152,32 @@ static aligned_t chapel_wrapper(void *arg)
     chpl_qthread_tls_t    *tls = chpl_qthread_get_tasklocal();
     chpl_task_bundle_t *bundle = chpl_argBundleTaskArgBundle(arg);
     chpl_qthread_tls_t      pv = {.bundle = bundle};
+    uint64_t           t_start = 0;
 
     *tls = pv;
 
+    // Qthreads creates its workers itself, so bind them to their NUMA
+    // arenas lazily, here.  This is cheap once a worker is bound.
+    chpl_mem_bindThreadArena();
+
     wrap_callbacks(chpl_task_cb_event_kind_begin, bundle);
 
+    if (task_prof_enabled)
+        t_start = task_prof_now();
+
     (bundle->requested_fn)(arg);
 
+    if (t_start != 0)
+        task_prof_end(tls, t_start);
+
+    chpl_task_arena_release(&tls->infoRuntime.arena);
+    qio_linebuf_task_end(&tls->infoRuntime.linebuf);
+
+#ifdef HAS_CHPL_CACHE_FNS
+    // If tasks can migrate, the remote cache belongs to this task.
+    chpl_cache_task_end();
+#endif
+
     wrap_callbacks(chpl_task_cb_event_kind_end, bundle);
 
     return 0;
@@ -809,6 +1214,7 @@ void chpl_task_callMain(void (*chpl_main)(void))
           .id              = chpl_qthread_process_bundle.id,
         };
 
+    task_prof_spawn(&arg);
     wrap_callbacks(chpl_task_cb_event_kind_create, &arg);
     qthread_fork_copyargs(chapel_wrapper, &arg, sizeof(arg), &exit_ret);
     qthread_readFF(NULL, &exit_ret);
@@ -865,16 +1271,234 @@ void chpl_task_addToTaskList(chpl_fn_int_t       fid,
              .infoChapel      = arg->infoChapel, // retain; set by caller
            };
 
+    task_prof_spawn(arg);
     wrap_callbacks(chpl_task_cb_event_kind_create, arg);
 
     if (execution_subloc == c_sublocid_any) {
-        qthread_fork_copyargs(chapel_wrapper, arg, arg_size, NULL);
+        qthread_shepherd_id_t shep = numaHintShep();
+        if (shep == NO_SHEPHERD) {
+            qthread_fork_copyargs(chapel_wrapper, arg, arg_size, NULL);
+        } else {
+            qthread_fork_copyargs_to(chapel_wrapper, arg, arg_size, NULL,
+                                     shep);
+        }
     } else {
         qthread_fork_copyargs_to(chapel_wrapper, arg, arg_size, NULL,
                                  (qthread_shepherd_id_t) execution_subloc);
     }
 }
 
+//
+// Bulk spawn.  All the tasks' arg bundles go in one allocation, headed
+// by a reference count so that the last task to finish can free it.
+// Each slot holds a pointer back to the header, then the bundle.
+//
+typedef struct {
+    aligned_t refs;
+} bulk_tasks_hdr_t;
+
+#define BULK_ALIGN 16
+#define BULK_SLOT_HDR ALIGN_UP(sizeof(bulk_tasks_hdr_t*), BULK_ALIGN)
+
+static aligned_t bulk_next_shep = 0;
+
+static aligned_t chapel_bulk_wrapper(void *slot)
+{
+    bulk_tasks_hdr_t *hdr = *(bulk_tasks_hdr_t**) slot;
+
+    (void) chapel_wrapper((char*) slot + BULK_SLOT_HDR);
+
+    if (qthread_incr(&hdr->refs, -1) == 1)
+        chpl_mem_free(hdr, 0, 0);
+
+    return 0;
+}
+
+void chpl_task_addTasksToTaskList(chpl_fn_int_t       fid,
+                                  void               *args,
+                                  size_t              arg_size,
+                                  int32_t             num_tasks,
+                                  c_sublocid_t        full_subloc,
+                                  void              **task_list,
+                                  int32_t             task_list_locale,
+                                  int                 lineno,
+                                  int32_t             filename)
+{
+    chpl_fn_p requested_fn = chpl_ftable[fid];
+    size_t slot_size = BULK_SLOT_HDR + ALIGN_UP(arg_size, BULK_ALIGN);
+    bulk_tasks_hdr_t *hdr;
+    char *slots;
+    qthread_shepherd_id_t num_sheps;
+    qthread_shepherd_id_t shep;
+    chpl_bool use_numa_hint = false;
+
+    assert(isActualSublocID(full_subloc) || full_subloc == c_sublocid_any);
+
+    if (num_tasks <= 0)
+        return;
+
+    PROFILE_INCR(profile_task_addToTaskList,num_tasks);
+
+    c_sublocid_t execution_subloc =
+      chpl_localeModel_sublocToExecutionSubloc(full_subloc);
+
+    hdr = chpl_mem_alloc(ALIGN_UP(sizeof(*hdr), BULK_ALIGN) + num_tasks * slot_size,
+                         CHPL_RT_MD_TASK_ARG, lineno, filename);
+    hdr->refs = num_tasks;
+    slots = (char*) hdr + ALIGN_UP(sizeof(*hdr), BULK_ALIGN);
+
+    //
+    // Spread the tasks round-robin across the shepherds, starting where
+    // the last batch left off, unless a particular one was asked for.
+    // Under a NUMA hint, spread them across that domain's shepherds.
+    //
+    num_sheps = qthread_num_shepherds();
+    if (execution_subloc == c_sublocid_any) {
+        shep = numaHintShep();
+        if (shep != NO_SHEPHERD)
+            use_numa_hint = true;
+        else
+            shep = qthread_incr(&bulk_next_shep, num_tasks) % num_sheps;
+    } else {
+        shep = (qthread_shepherd_id_t) execution_subloc;
+    }
+
+    for (int32_t i = 0; i < num_tasks; i++) {
+        char *slot = slots + i * slot_size;
+        chpl_task_bundle_t *arg =
+            (chpl_task_bundle_t*) (slot + BULK_SLOT_HDR);
+
+        *(bulk_tasks_hdr_t**) slot = hdr;
+        memcpy(arg, (char*) args + i * arg_size, arg_size);
+
+        *arg = (chpl_task_bundle_t)
+               { .kind            = CHPL_ARG_BUNDLE_KIND_TASK,
+                 .is_executeOn    = false,
+                 .lineno          = lineno,
+                 .filename        = filename,
+                 .requestedSubloc = full_subloc,
+                 .requested_fid   = fid,
+                 .requested_fn    = requested_fn,
+                 .id              = chpl_nullTaskID,
+                 .infoChapel      = arg->infoChapel, // retain; set by caller
+               };
+
+        task_prof_spawn(arg);
+        wrap_callbacks(chpl_task_cb_event_kind_create, arg);
+
+        qthread_fork_to(chapel_bulk_wrapper, slot, NULL, shep);
+
+        if (use_numa_hint) {
+            if (i + 1 < num_tasks)
+                shep = numaHintShep();
+        } else if (execution_subloc == c_sublocid_any) {
+            if (++shep == num_sheps)
+                shep = 0;
+        }
+    }
+}
+
+//
+// Leaf tasks; see setupLeafQueues().
+//
+static aligned_t leaf_carrier(void *arg)
+{
+    leaf_queue_t *q = (leaf_queue_t*) arg;
+    int num_run = 0;
+
+    for (;;) {
+        leaf_task_t *list, *rev, *next;
+
+        do {
+            list = q->head;
+        } while (list != NULL
+                 && qthread_cas_ptr(&q->head, list, NULL) != list);
+
+        if (list == NULL) {
+            // Go idle, unless something was queued as we did so and
+            // no other carrier has picked it up.  The CAS is a full
+            // fence, so we can't miss a push that saw us as active.
+            (void) qthread_cas(&q->active, 1, 0);
+            if (q->head == NULL || qthread_cas(&q->active, 0, 1) != 0)
+                return 0;
+            continue;
+        }
+
+        for (rev = NULL; list != NULL; list = next) {
+            next = list->next;
+            list->next = rev;
+            rev = list;
+        }
+
+        for ( ; rev != NULL; rev = next) {
+            next = rev->next;
+            (void) chapel_wrapper((char*) rev + LEAF_TASK_HDR);
+            chpl_mem_free(rev, 0, 0);
+            if (++num_run % LEAF_TASKS_PER_YIELD == 0)
+                qthread_yield();
+        }
+    }
+}
+
+void chpl_task_addLeafToTaskList(chpl_fn_int_t       fid,
+                                 chpl_task_bundle_t *arg,
+                                 size_t              arg_size,
+                                 c_sublocid_t        full_subloc,
+                                 void              **task_list,
+                                 int32_t             task_list_locale,
+                                 chpl_bool           is_begin_stmt,
+                                 int                 lineno,
+                                 int32_t             filename)
+{
+    chpl_fn_p requested_fn = chpl_ftable[fid];
+    qthread_shepherd_id_t shep;
+    leaf_task_t *leaf;
+    chpl_task_bundle_t *bundle;
+    leaf_queue_t *q;
+
+    assert(isActualSublocID(full_subloc) || full_subloc == c_sublocid_any);
+
+    PROFILE_INCR(profile_task_addToTaskList,1);
+
+    c_sublocid_t execution_subloc =
+      chpl_localeModel_sublocToExecutionSubloc(full_subloc);
+
+    if (execution_subloc != c_sublocid_any) {
+        shep = (qthread_shepherd_id_t) execution_subloc;
+    } else if ((shep = numaHintShep()) == NO_SHEPHERD
+               && (shep = qthread_shep()) == NO_SHEPHERD) {
+        shep = qthread_incr(&bulk_next_shep, 1) % qthread_num_shepherds();
+    }
+
+    leaf = chpl_mem_alloc(LEAF_TASK_HDR + arg_size, CHPL_RT_MD_TASK_ARG,
+                          lineno, filename);
+    bundle = (chpl_task_bundle_t*) ((char*) leaf + LEAF_TASK_HDR);
+    memcpy(bundle, arg, arg_size);
+
+    *bundle = (chpl_task_bundle_t)
+              { .kind            = CHPL_ARG_BUNDLE_KIND_TASK,
+                .is_executeOn    = false,
+                .lineno          = lineno,
+                .filename        = filename,
+                .requestedSubloc = full_subloc,
+                .requested_fid   = fid,
+                .requested_fn    = requested_fn,
+                .id              = chpl_nullTaskID,
+                .infoChapel      = arg->infoChapel, // retain; set by caller
+              };
+
+    task_prof_spawn(bundle);
+    wrap_callbacks(chpl_task_cb_event_kind_create, bundle);
+
+    q = &leaf_queues[shep];
+    do {
+        leaf->next = q->head;
+    } while (qthread_cas_ptr(&q->head, leaf->next, leaf) != leaf->next);
+
+    if (q->active == 0 && qthread_cas(&q->active, 0, 1) == 0)
+        qthread_fork_to(leaf_carrier, q, NULL, shep);
+}
+
 void chpl_task_executeTasksInList(void **task_list)
 {
     PROFILE_INCR(profile_task_executeTasksInList,1);
@@ -901,6 +1525,7 @@ static inline void taskCallBody(chpl_fn_int_t fid, chpl_fn_p fp,
                 .infoChapel      = bundle->infoChapel, // retain; set by caller
               };
 
+    task_prof_spawn(bundle);
     wrap_callbacks(chpl_task_cb_event_kind_create, bundle);
 
     if (execution_subloc < 0) {
@@ -985,6 +1610,11 @@ char* chpl_task_idToString(char* buff, size_t size, chpl_taskID_t id) {
     return NULL;
 }
 
+static void sleep_wake(void* feb)
+{
+    qthread_fill((aligned_t*) feb);
+}
+
 void chpl_task_sleep(double secs)
 {
     if (qthread_shep() == NO_SHEPHERD) {
@@ -1009,7 +1639,7 @@ void chpl_task_sleep(double secs)
         } while (now.tv_sec < deadline.tv_sec
                  || (now.tv_sec == deadline.tv_sec
                      && now.tv_usec < deadline.tv_usec));
-    } else {
+    } else if (secs < CHPL_TIMER_WHEEL_TICK_SECS) {
         qtimer_t t = qtimer_create();
         qtimer_start(t);
         do {
@@ -1017,6 +1647,17 @@ void chpl_task_sleep(double secs)
             qtimer_stop(t);
         } while (qtimer_secs(t) < secs);
         qtimer_destroy(t);
+    } else {
+        //
+        // Park on an empty FEB and let the timer wheel fill it when
+        // we're due.  That frees our worker for other tasks meanwhile.
+        //
+        aligned_t feb;
+        chpl_timer_wheel_entry_t e;
+
+        qthread_empty(&feb);
+        chpl_timer_wheel_add(&e, secs, sleep_wake, &feb);
+        qthread_readFE(NULL, &feb);
     }
 }
 
@@ -604,6 +604,8 @@ static void* pthread_func(void* arg) {
 
   CHPL_TLS_SET(chpl_thread_id, (intptr_t) my_thread_id);
 
+  chpl_mem_bindThreadArena();
+
   if (saved_threadEndFn == NULL)
     (*saved_threadBeginFn)(arg);
   else {
@@ -64,8 +64,13 @@ static int topoDepth;
 static int numaLevel;
 static int numNumaDomains;
 
+// accessible CPUs, as of when the cache information was gathered
+static hwloc_cpuset_t llcAccSet = NULL;
+
 
 static hwloc_obj_t getNumaObj(c_sublocid_t);
+static void getAccessibleCPUs(hwloc_cpuset_t);
+static int getPCIDevCPUs(int, int, int, int, hwloc_cpuset_t);
 static void alignAddrSize(void*, size_t, chpl_bool,
                           size_t*, unsigned char**, size_t*);
 static void chpl_topo_setMemLocalityByPages(unsigned char*, size_t,
@@ -198,6 +203,9 @@ void chpl_topo_exit(void) {
     return;
   }
 
+  if (llcAccSet != NULL) {
+    hwloc_bitmap_free(llcAccSet);
+  }
   hwloc_topology_destroy(topology);
 }
 
@@ -229,6 +237,32 @@ int chpl_topo_getNumCPUsLogical(chpl_bool accessible_only) {
 }
 
 
+//
+// Get the set of accessible PUs.
+//
+// We could seemingly use hwloc_topology_get_allowed_cpuset() to get
+// the set of accessible PUs here.  But that seems not to reflect the
+// schedaffinity settings, so use hwloc_get_proc_cpubind() instead.
+//
+static
+void getAccessibleCPUs(hwloc_cpuset_t set) {
+  if (hwloc_get_proc_cpubind(topology, getpid(), set, 0) != 0) {
+#ifdef __APPLE__
+    const int errRecoverable = (errno == ENOSYS); // no cpubind on macOS
+#else
+    const int errRecoverable = 0;
+#endif
+    if (errRecoverable) {
+      hwloc_bitmap_fill(set);
+    } else {
+      REPORT_ERR_ERRNO(hwloc_get_proc_cpubind(topology, getpid(), set, 0)
+                       == 0);
+    }
+  }
+  hwloc_bitmap_and(set, set, hwloc_topology_get_online_cpuset(topology));
+}
+
+
 static
 void getNumCPUs(void) {
   //
@@ -239,29 +273,9 @@ void getNumCPUs(void) {
   // Hwloc can't tell us the number of accessible cores directly, so
   // get that by counting the parent cores of the accessible PUs.
   //
-
-  //
-  // We could seemingly use hwloc_topology_get_allowed_cpuset() to get
-  // the set of accessible PUs here.  But that seems not to reflect the
-  // schedaffinity settings, so use hwloc_get_proc_cpubind() instead.
-  //
   hwloc_cpuset_t logAccSet;
   CHK_ERR_ERRNO((logAccSet = hwloc_bitmap_alloc()) != NULL);
-  if (hwloc_get_proc_cpubind(topology, getpid(), logAccSet, 0) != 0) {
-#ifdef __APPLE__
-    const int errRecoverable = (errno == ENOSYS); // no cpubind on macOS
-#else
-    const int errRecoverable = 0;
-#endif
-    if (errRecoverable) {
-      hwloc_bitmap_fill(logAccSet);
-    } else {
-      REPORT_ERR_ERRNO(hwloc_get_proc_cpubind(topology, getpid(), logAccSet, 0)
-                       == 0);
-    }
-  }
-  hwloc_bitmap_and(logAccSet, logAccSet,
-                   hwloc_topology_get_online_cpuset(topology));
+  getAccessibleCPUs(logAccSet);
 
   hwloc_cpuset_t physAccSet;
   CHK_ERR_ERRNO((physAccSet = hwloc_bitmap_alloc()) != NULL);
@@ -338,6 +352,62 @@ void chpl_topo_setThreadLocality(c_sublocid_t subloc) {
 }
 
 
+int chpl_topo_setThreadCPU(int cpu) {
+  hwloc_obj_t pu;
+  int flags;
+
+  _DBG_P("chpl_topo_setThreadCPU(%d)\n", cpu);
+
+  if (!haveTopology || !topoSupport->cpubind->set_thread_cpubind) {
+    return -1;
+  }
+
+  if ((pu = hwloc_get_pu_obj_by_os_index(topology, (unsigned) cpu)) == NULL) {
+    return -1;
+  }
+
+  flags = HWLOC_CPUBIND_THREAD | HWLOC_CPUBIND_STRICT;
+  if (hwloc_set_cpubind(topology, pu->cpuset, flags) != 0) {
+    return -1;
+  }
+
+  return 0;
+}
+
+
+int chpl_topo_getNumaCPU(c_sublocid_t subloc, int i) {
+  hwloc_cpuset_t cpuset;
+  hwloc_obj_t numa;
+  hwloc_obj_t core;
+  hwloc_obj_t pu;
+  int numCores;
+
+  if (!haveTopology
+      || (numa = getNumaObj(subloc < 0 ? 0 : subloc)) == NULL) {
+    return -1;
+  }
+
+  CHK_ERR_ERRNO((cpuset = hwloc_bitmap_alloc()) != NULL);
+  hwloc_cpuset_from_nodeset(topology, cpuset, numa->allowed_nodeset);
+  hwloc_bitmap_and(cpuset, cpuset, hwloc_topology_get_allowed_cpuset(topology));
+
+  numCores = hwloc_get_nbobjs_inside_cpuset_by_type(topology, cpuset,
+                                                    HWLOC_OBJ_CORE);
+  if (numCores <= 0
+      || (core = hwloc_get_obj_inside_cpuset_by_type(topology, cpuset,
+                                                     HWLOC_OBJ_CORE,
+                                                     i % numCores)) == NULL
+      || (pu = hwloc_get_obj_inside_cpuset_by_type(topology, core->cpuset,
+                                                   HWLOC_OBJ_PU, 0)) == NULL) {
+    hwloc_bitmap_free(cpuset);
+    return -1;
+  }
+
+  hwloc_bitmap_free(cpuset);
+  return (int) pu->os_index;
+}
+
+
 c_sublocid_t chpl_topo_getThreadLocality(void) {
   hwloc_cpuset_t cpuset;
   hwloc_nodeset_t nodeset;
@@ -578,6 +648,320 @@ c_sublocid_t chpl_topo_getMemLocality(void* p) {
 }
 
 
+//
+// Read a one-line file describing a PCI device from sysfs.  Returns 0
+// on success, -1 if there's no such file or it's empty.
+//
+static
+int readPCIDevFile(int domain, int bus, int device, int function,
+                   const char* name, char* buf, size_t bufSize) {
+  char path[100];
+  FILE* f;
+
+  snprintf(path, sizeof(path),
+           "/sys/bus/pci/devices/%04x:%02x:%02x.%x/%s",
+           domain, bus, device, function, name);
+  if ((f = fopen(path, "r")) == NULL) {
+    return -1;
+  }
+  if (fgets(buf, bufSize, f) == NULL) {
+    fclose(f);
+    return -1;
+  }
+  fclose(f);
+  return 0;
+}
+
+
+//
+// Get the set of CPUs local to a PCI device.  Returns 0 on success,
+// -1 if we can't tell.
+//
+// We don't have hwloc discover I/O devices, because that makes
+// loading the topology quite a bit slower.  Instead, ask Linux which
+// CPUs are local to the device.
+//
+static
+int getPCIDevCPUs(int domain, int bus, int device, int function,
+                  hwloc_cpuset_t set) {
+  char buf[1000];
+
+  if (readPCIDevFile(domain, bus, device, function, "local_cpulist",
+                     buf, sizeof(buf)) != 0
+      || hwloc_bitmap_list_sscanf(set, buf) != 0) {
+    return -1;
+  }
+  return 0;
+}
+
+
+int chpl_topo_isPCIDevNear(int domain, int bus, int device, int function) {
+  hwloc_cpuset_t devSet;
+  hwloc_cpuset_t mySet;
+  int near;
+
+  if (!haveTopology) {
+    return -1;
+  }
+
+  CHK_ERR_ERRNO((devSet = hwloc_bitmap_alloc()) != NULL);
+  CHK_ERR_ERRNO((mySet = hwloc_bitmap_alloc()) != NULL);
+
+  if (getPCIDevCPUs(domain, bus, device, function, devSet) != 0
+      || hwloc_get_proc_cpubind(topology, getpid(), mySet, 0) != 0) {
+    near = -1;
+  } else {
+    near = hwloc_bitmap_intersects(devSet, mySet) ? 1 : 0;
+  }
+
+  hwloc_bitmap_free(mySet);
+  hwloc_bitmap_free(devSet);
+
+  return near;
+}
+
+
+c_sublocid_t chpl_topo_getPCIDevLocality(int domain, int bus, int device,
+                                         int function) {
+  hwloc_cpuset_t devSet;
+  hwloc_nodeset_t devNodes;
+  c_sublocid_t subloc;
+  int i;
+
+  if (!haveTopology) {
+    return c_sublocid_any;
+  }
+
+  CHK_ERR_ERRNO((devSet = hwloc_bitmap_alloc()) != NULL);
+  CHK_ERR_ERRNO((devNodes = hwloc_bitmap_alloc()) != NULL);
+
+  subloc = c_sublocid_any;
+  if (getPCIDevCPUs(domain, bus, device, function, devSet) == 0) {
+    hwloc_cpuset_to_nodeset(topology, devSet, devNodes);
+    for (i = 0; i < numNumaDomains && subloc == c_sublocid_any; i++) {
+      hwloc_obj_t numa = getNumaObj(i);
+      if (numa != NULL
+          && hwloc_bitmap_intersects(devNodes, numa->allowed_nodeset)) {
+        subloc = i;
+      }
+    }
+  }
+
+  hwloc_bitmap_free(devNodes);
+  hwloc_bitmap_free(devSet);
+
+  return subloc;
+}
+
+
+//
+// Get the distance between two NUMA nodes, given their OS indices, from
+// the firmware (ACPI SLIT) table Linux exposes.  Returns -1 if we can't
+// tell.
+//
+static
+int getNumaNodeDistance(int from, int to) {
+  char path[100];
+  FILE* f;
+  int d;
+  int i;
+
+  snprintf(path, sizeof(path),
+           "/sys/devices/system/node/node%d/distance", from);
+  if ((f = fopen(path, "r")) == NULL) {
+    return -1;
+  }
+  for (i = 0; i <= to; i++) {
+    if (fscanf(f, "%d", &d) != 1) {
+      d = -1;
+      break;
+    }
+  }
+  fclose(f);
+  return d;
+}
+
+
+int chpl_topo_getPCIDevDistance(int domain, int bus, int device,
+                                int function) {
+  char buf[20];
+  int devNode;
+  hwloc_cpuset_t mySet;
+  hwloc_nodeset_t myNodes;
+  unsigned node;
+  int dist;
+
+  if (!haveTopology) {
+    return -1;
+  }
+
+  if (readPCIDevFile(domain, bus, device, function, "numa_node",
+                     buf, sizeof(buf)) != 0
+      || sscanf(buf, "%d", &devNode) != 1
+      || devNode < 0) {
+    return -1;
+  }
+
+  CHK_ERR_ERRNO((mySet = hwloc_bitmap_alloc()) != NULL);
+  CHK_ERR_ERRNO((myNodes = hwloc_bitmap_alloc()) != NULL);
+
+  getAccessibleCPUs(mySet);
+  hwloc_cpuset_to_nodeset(topology, mySet, myNodes);
+
+  dist = -1;
+  hwloc_bitmap_foreach_begin(node, myNodes) {
+    int d = getNumaNodeDistance((int) node, devNode);
+    if (d >= 0 && (dist < 0 || d < dist)) {
+      dist = d;
+    }
+  } hwloc_bitmap_foreach_end();
+
+  hwloc_bitmap_free(myNodes);
+  hwloc_bitmap_free(mySet);
+
+  return dist;
+}
+
+
+//
+// Cache hierarchy
+//
+#define MAX_CACHE_LEVELS 5
+static pthread_once_t cacheInfo_ctrl = PTHREAD_ONCE_INIT;
+static void getCacheInfo(void);
+static int numCacheLevels = 0;
+static chpl_topo_cacheInfo_t cacheInfo[MAX_CACHE_LEVELS];
+static int llcDepth = -1;
+
+static
+void getCacheInfo(void) {
+  if (!haveTopology) {
+    return;
+  }
+
+  CHK_ERR_ERRNO((llcAccSet = hwloc_bitmap_alloc()) != NULL);
+  getAccessibleCPUs(llcAccSet);
+
+  //
+  // Find the data (or unified) cache at each level, stopping at the
+  // first level hwloc doesn't know about (or has more than one depth
+  // for, which we don't try to describe).  We count the instances
+  // covering the accessible CPUs rather than those inside them, so
+  // that a cache we only partly run on still counts.
+  //
+#define NEXT_CACHE(depth, obj)                                          \
+  hwloc_get_next_obj_covering_cpuset_by_depth(topology, llcAccSet,      \
+                                              depth, obj)
+
+  for (int level = 1; level <= MAX_CACHE_LEVELS; level++) {
+    int depth = hwloc_get_cache_type_depth(topology, level,
+                                           HWLOC_OBJ_CACHE_DATA);
+    if (depth < 0) {
+      break;
+    }
+
+    hwloc_obj_t obj = NEXT_CACHE(depth, NULL);
+    if (obj == NULL) {
+      break;
+    }
+
+    chpl_topo_cacheInfo_t* ci = &cacheInfo[numCacheLevels++];
+    ci->level = level;
+    ci->size = (size_t) obj->attr->cache.size;
+    ci->lineSize = (int) obj->attr->cache.linesize;
+    ci->associativity = obj->attr->cache.associativity;
+    ci->numSharingCPUs = hwloc_bitmap_weight(obj->cpuset);
+    ci->numInstances = 0;
+    for (hwloc_obj_t o = obj; o != NULL; o = NEXT_CACHE(depth, o)) {
+      ci->numInstances++;
+    }
+    llcDepth = depth;
+
+    _DBG_P("L%d: %zd bytes, %d-byte lines, %d-way, %d CPUs, %d instances",
+           ci->level, ci->size, ci->lineSize, ci->associativity,
+           ci->numSharingCPUs, ci->numInstances);
+  }
+
+#undef NEXT_CACHE
+}
+
+
+int chpl_topo_getNumCacheLevels(void) {
+  CHK_ERR(pthread_once(&cacheInfo_ctrl, getCacheInfo) == 0);
+  return numCacheLevels;
+}
+
+
+int chpl_topo_getCacheInfo(int level, chpl_topo_cacheInfo_t* info) {
+  CHK_ERR(pthread_once(&cacheInfo_ctrl, getCacheInfo) == 0);
+  if (level < 1 || level > numCacheLevels) {
+    return -1;
+  }
+  *info = cacheInfo[level - 1];
+  return 0;
+}
+
+
+size_t chpl_topo_getCacheSize(int level) {
+  CHK_ERR(pthread_once(&cacheInfo_ctrl, getCacheInfo) == 0);
+  if (level == 0) {
+    level = numCacheLevels;
+  }
+  return (level < 1 || level > numCacheLevels)
+         ? 0
+         : cacheInfo[level - 1].size;
+}
+
+
+size_t chpl_topo_getLLCSizePerCPU(void) {
+  CHK_ERR(pthread_once(&cacheInfo_ctrl, getCacheInfo) == 0);
+  if (numCacheLevels == 0
+      || cacheInfo[numCacheLevels - 1].numSharingCPUs <= 0) {
+    return 0;
+  }
+  return cacheInfo[numCacheLevels - 1].size
+         / cacheInfo[numCacheLevels - 1].numSharingCPUs;
+}
+
+
+int chpl_topo_getNumLLCGroups(void) {
+  CHK_ERR(pthread_once(&cacheInfo_ctrl, getCacheInfo) == 0);
+  return (numCacheLevels == 0)
+         ? 0
+         : cacheInfo[numCacheLevels - 1].numInstances;
+}
+
+
+int chpl_topo_getLLCGroup(int cpu) {
+  hwloc_obj_t pu;
+  hwloc_obj_t llc;
+  hwloc_obj_t obj;
+  int group;
+
+  CHK_ERR(pthread_once(&cacheInfo_ctrl, getCacheInfo) == 0);
+  if (llcDepth < 0
+      || (pu = hwloc_get_pu_obj_by_os_index(topology, (unsigned) cpu)) == NULL
+      || !hwloc_bitmap_isset(llcAccSet, (unsigned) cpu)
+      || (llc = hwloc_get_ancestor_obj_by_depth(topology, llcDepth, pu))
+         == NULL) {
+    return -1;
+  }
+
+#define NEXT_LLC(obj)                                                   \
+  hwloc_get_next_obj_covering_cpuset_by_depth(topology, llcAccSet,      \
+                                              llcDepth, obj)
+
+  for (obj = NEXT_LLC(NULL), group = 0;
+       obj != NULL && obj != llc;
+       obj = NEXT_LLC(obj), group++)
+    ;
+
+#undef NEXT_LLC
+
+  return (obj == NULL) ? -1 : group;
+}
+
+
 static
 void chk_err_fn(const char* file, int lineno, const char* what) {
   chpl_internal_error_v("%s: %d: !(%s)", file, lineno, what);
@@ -60,6 +60,16 @@ int chpl_topo_getNumNumaDomains(void) {
 void chpl_topo_setThreadLocality(c_sublocid_t subloc) { }
 
 
+int chpl_topo_setThreadCPU(int cpu) {
+  return -1;
+}
+
+
+int chpl_topo_getNumaCPU(c_sublocid_t subloc, int i) {
+  return -1;
+}
+
+
 c_sublocid_t chpl_topo_getThreadLocality(void) {
   return c_sublocid_any;
 }
@@ -81,3 +91,50 @@ void chpl_topo_touchMemFromSubloc(void* p, size_t size, chpl_bool onlyInside,
 c_sublocid_t chpl_topo_getMemLocality(void* p) {
   return c_sublocid_any;
 }
+
+
+int chpl_topo_isPCIDevNear(int domain, int bus, int device, int function) {
+  return -1;
+}
+
+
+c_sublocid_t chpl_topo_getPCIDevLocality(int domain, int bus, int device,
+                                         int function) {
+  return c_sublocid_any;
+}
+
+
+int chpl_topo_getPCIDevDistance(int domain, int bus, int device,
+                                int function) {
+  return -1;
+}
+
+
+int chpl_topo_getNumCacheLevels(void) {
+  return 0;
+}
+
+
+int chpl_topo_getCacheInfo(int level, chpl_topo_cacheInfo_t* info) {
+  return -1;
+}
+
+
+size_t chpl_topo_getCacheSize(int level) {
+  return 0;
+}
+
+
+size_t chpl_topo_getLLCSizePerCPU(void) {
+  return 0;
+}
+
+
+int chpl_topo_getNumLLCGroups(void) {
+  return 0;
+}
+
+
+int chpl_topo_getLLCGroup(int cpu) {
+  return -1;
+}
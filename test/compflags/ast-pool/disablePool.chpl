@@ -0,0 +1,22 @@
+// Build with the AST node pool on (the normal compile) and off (the
+// recompile in the .prediff); both executables must behave the same.
+
+record Pair {
+  var a: int;
+  var b: real;
+}
+
+proc combine(p: Pair) {
+  return p.a + p.b;
+}
+
+iter evens(n: int) {
+  for i in 1..n do
+    if i % 2 == 0 then yield i;
+}
+
+var total = 0.0;
+for i in evens(10) do
+  total += combine(new Pair(i, i / 2.0));
+
+writeln(total);
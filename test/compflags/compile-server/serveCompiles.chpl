@@ -0,0 +1,7 @@
+config const n = 5;
+
+proc square(x: int) {
+  return x * x;
+}
+
+writeln(square(n));
@@ -0,0 +1,13 @@
+// Extern blocks are precompiled into a cache with --extern-c-cache-dir.
+// A later compile reuses the cache, and one after a header the extern
+// code includes has changed sees the change.
+
+extern {
+  #include "cachedExternValue.h"
+
+  static int helperValue(void) {
+    return CACHED_EXTERN_VALUE;
+  }
+}
+
+writeln(helperValue());
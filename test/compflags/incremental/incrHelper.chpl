@@ -0,0 +1,5 @@
+module incrHelper {
+  proc helperValue() {
+    return 42;
+  }
+}
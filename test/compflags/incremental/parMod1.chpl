@@ -0,0 +1,5 @@
+module parMod1 {
+  proc value1() {
+    return 1 * 100;
+  }
+}
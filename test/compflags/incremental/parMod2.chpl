@@ -0,0 +1,5 @@
+module parMod2 {
+  proc value2() {
+    return 2 * 100;
+  }
+}
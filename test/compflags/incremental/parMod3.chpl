@@ -0,0 +1,5 @@
+module parMod3 {
+  proc value3() {
+    return 3 * 100;
+  }
+}
@@ -0,0 +1,4 @@
+// Several user modules, each compiled to its own object in parallel.
+use parMod1, parMod2, parMod3;
+
+writeln(value1() + value2() + value3());
@@ -0,0 +1,5 @@
+use incrHelper;
+
+config param variant = 0;
+
+writeln(helperValue(), " ", variant);
@@ -0,0 +1,33 @@
+// Split code generation across threads: the program has to link and
+// run the same as with one partition.
+
+record Point {
+  var x, y: real;
+}
+
+proc dist2(p: Point) {
+  return p.x * p.x + p.y * p.y;
+}
+
+proc sumTo(n: int) {
+  var s = 0;
+  for i in 1..n do s += i;
+  return s;
+}
+
+class Shape {
+  proc area(): real { return 0.0; }
+}
+
+class Square: Shape {
+  var side: real;
+  override proc area(): real { return side * side; }
+}
+
+var A: [1..100] int = 1..100;
+
+writeln(dist2(new Point(3.0, 4.0)));
+writeln(sumTo(100));
+var s: Shape = new Square(3.0);
+writeln(s.area());
+writeln(+ reduce A);
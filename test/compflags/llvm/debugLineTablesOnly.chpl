@@ -0,0 +1,15 @@
+// --debug-line-tables-only keeps line tables, but no descriptions of
+// variables, formals or types.
+
+record PointRecordForDebugInfo {
+  var x, y: real;
+}
+
+proc scaledDistanceForDebugInfo(p: PointRecordForDebugInfo,
+                                scaleFactorForDebugInfo: real) {
+  const localSumForDebugInfo = p.x * p.x + p.y * p.y;
+  return localSumForDebugInfo * scaleFactorForDebugInfo;
+}
+
+writeln(scaledDistanceForDebugInfo(new PointRecordForDebugInfo(3.0, 4.0),
+                                   2.0));
@@ -0,0 +1,5 @@
+proc twice(x) {
+  return x + x;
+}
+
+writeln(twice(21), " ", twice(1.5));
@@ -0,0 +1,30 @@
+// Many instantiations of the same generics, some with identical
+// substitutions, so that the instantiation caches have to tell apart
+// entries that differ in only one substitution.
+
+proc conv(type t, param p: int) {
+  return p: t;
+}
+
+record R {
+  type t;
+  param n: int;
+  var x: t;
+}
+
+proc R.show() {
+  writeln(n, " ", x);
+}
+
+for param p in 1..8 {
+  writeln(conv(int, p), " ", conv(real, p), " ", conv(int, p) + p);
+}
+
+for param p in 1..4 {
+  var a = new R(int, p, p * 10);
+  var b = new R(real, p, p / 4.0);
+  var c = new R(int, p, p * 100);
+  a.show();
+  b.show();
+  c.show();
+}
@@ -0,0 +1,39 @@
+// Generic functions and records with many substitutions, and inlined
+// functions with many formals and locals, so the compiler's symbol
+// maps grow past their small inline size.
+
+record Rec {
+  type t1, t2, t3, t4, t5, t6;
+  var a: t1;
+  var b: t2;
+  var c: t3;
+  var d: t4;
+  var e: t5;
+  var f: t6;
+}
+
+proc sum6(a, b, c, d, e, f) {
+  return a + b + c + d + e + f;
+}
+
+inline proc mix(a: int, b: int, c: int, d: int, e: int, f: int,
+                g: int, h: int, i: int, j: int) {
+  const x1 = a * b, x2 = c * d, x3 = e * f, x4 = g * h, x5 = i * j;
+  const y1 = x1 + x2, y2 = x3 + x4;
+  return y1 + y2 + x5;
+}
+
+var r = new Rec(int, real, int(32), uint, real(32), int(8),
+                1, 2.5, 3: int(32), 4: uint, 5.5: real(32), 6: int(8));
+writeln(sum6(r.a, r.b, r.c, r.d, r.e, r.f));
+writeln(sum6(1, 2, 3, 4, 5, 6));
+writeln(mix(1, 2, 3, 4, 5, 6, 7, 8, 9, 10));
+
+proc outer(n: int) {
+  const p1 = n + 1, p2 = n + 2, p3 = n + 3, p4 = n + 4, p5 = n + 5;
+  proc inner(m: int) {
+    return m * (p1 + p2 + p3 + p4 + p5);
+  }
+  return inner(2);
+}
+writeln(outer(10));
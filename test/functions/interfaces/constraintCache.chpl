@@ -0,0 +1,62 @@
+// Interface constraints are checked once per visibility scope and the
+// result reused.  Repeated and nested calls from one scope, and calls
+// from a scope that sees other implements statements, have to find
+// the right implementation.
+
+interface Describe(T) {
+  proc describe(x: T): string;
+}
+
+proc show(x: ?T) where T implements Describe {
+  writeln(describe(x));
+}
+
+proc describe(x: int) {
+  return "int " + x:string;
+}
+
+int implements Describe;
+
+record R {
+  var v: real;
+}
+
+proc describe(r: R) {
+  return "R " + r.v:string;
+}
+
+R implements Describe;
+
+module Flags {
+  interface Describe2(T) {
+    proc describe2(x: T): string;
+  }
+
+  proc show2(x: ?T) where T implements Describe2 {
+    writeln(describe2(x));
+  }
+
+  proc describe2(x: bool) {
+    return if x then "on" else "off";
+  }
+
+  bool implements Describe2;
+
+  proc showFlags() {
+    show2(true);
+    show2(false);
+  }
+}
+
+for i in 1..3 do show(i);
+show(new R(1.5));
+show(42);
+show(new R(-2.0));
+
+proc nested() {
+  show(7);
+  show(new R(0.25));
+}
+nested();
+
+Flags.showFlags();
@@ -0,0 +1,31 @@
+// Overloads that differ in how many actuals they can take: defaults,
+// varargs, named actuals, methods and operators.  Candidates are now
+// rejected by arity before their formals are aligned.
+
+proc f() { writeln("f()"); }
+proc f(a: bool) { writeln("f(a)"); }
+proc f(a: int, b: int = 2) { writeln("f(a, b=", b, ")"); }
+proc f(a: real, b: real, c: real) { writeln("f(a, b, c)"); }
+proc f(xs: string ...) { writeln("f(", xs.size, " strings)"); }
+
+record R {
+  var v: int;
+  proc get() { return v; }
+  proc get(scale: int) { return v * scale; }
+}
+
+operator R.+(x: R, y: R) { return new R(x.v + y.v); }
+operator R.-(x: R) { return new R(-x.v); }
+operator R.-(x: R, y: R) { return new R(x.v - y.v); }
+
+f();
+f(true);
+f(1, 3);
+f(b=4, a=1);
+f(1.0, 2.0, 3.0);
+f("a", "b", "c", "d");
+f("a");
+
+var r = new R(5);
+writeln(r.get(), " ", r.get(3), " ", r.get(scale=4));
+writeln((r + r).v, " ", (-r).v, " ", (r - new R(2)).v);
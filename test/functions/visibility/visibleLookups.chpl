@@ -0,0 +1,69 @@
+// The same names looked up from many scopes, where the answer depends
+// on the scope: shadowing uses, nested functions, renaming, private
+// symbols and point-of-instantiation lookups.
+
+module A {
+  proc f() { writeln("A.f"); }
+  proc g(x: int) { writeln("A.g int"); }
+}
+
+module B {
+  proc f() { writeln("B.f"); }
+  private proc h() { writeln("B.h"); }
+  proc callH() { h(); }
+}
+
+module C {
+  use A only f as af;
+  proc run() { af(); }
+}
+
+module Lib {
+  proc callIt(x) { helper(x); }
+}
+
+module P1 {
+  import Lib;
+  record R1 { var x: int; }
+  proc helper(r: R1) { writeln("P1 helper"); }
+  proc run() { Lib.callIt(new R1()); }
+}
+
+module P2 {
+  import Lib;
+  record R2 { var x: int; }
+  proc helper(r: R2) { writeln("P2 helper"); }
+  proc run() { Lib.callIt(new R2()); }
+}
+
+module Main {
+  use A;
+  import B, C, P1, P2;
+
+  proc test1() { f(); }
+
+  proc test2() {
+    use B;
+    f();
+  }
+
+  proc test3() {
+    {
+      proc f() { writeln("local f"); }
+      f();
+    }
+    f();
+  }
+
+  proc main() {
+    test1();
+    test2();
+    test3();
+    test1();
+    C.run();
+    B.callH();
+    g(1);
+    P1.run();
+    P2.run();
+  }
+}
@@ -0,0 +1,21 @@
+// Exports for use_batchedCalls: calls that return nothing can be
+// batched, and the ones that return a value see the effect of every
+// call made before them.
+var total = 0;
+var lengths = 0;
+
+export proc add(x: int) {
+  total += x;
+}
+
+export proc addString(s: c_string) {
+  lengths += s.size;
+}
+
+export proc getTotal(): int {
+  return total;
+}
+
+export proc getLengths(): int {
+  return lengths;
+}
@@ -0,0 +1,49 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "lib/batchedCalls.h"
+
+void chpl_library_batch_begin(void);
+void chpl_library_batch_end(void);
+
+int main(int argc, char* argv[]) {
+  char buf[100];
+  int i;
+
+  chpl_library_init(argc, argv);
+
+  // A batch of calls that return nothing.
+  chpl_library_batch_begin();
+  for (i = 1; i <= 1000; i++)
+    add(i);
+  chpl_library_batch_end();
+  printf("%lld\n", (long long) getTotal());
+
+  // A call that returns a value in the middle of a batch.
+  chpl_library_batch_begin();
+  add(1);
+  printf("%lld\n", (long long) getTotal());
+  add(2);
+  chpl_library_batch_end();
+  printf("%lld\n", (long long) getTotal());
+
+  // Nested batches with strings, some longer than the ring's slots.
+  chpl_library_batch_begin();
+  for (i = 0; i < 100; i++) {
+    chpl_library_batch_begin();
+    memset(buf, 'x', i);
+    buf[i] = '\0';
+    addString(buf);
+    chpl_library_batch_end();
+  }
+  chpl_library_batch_end();
+  printf("%lld\n", (long long) getLengths());
+
+  // And the same without batching.
+  for (i = 0; i < 10; i++)
+    add(i);
+  printf("%lld\n", (long long) getTotal());
+
+  chpl_library_finalize();
+  return 0;
+}
@@ -0,0 +1,17 @@
+// Arrays passed from Python are shared with Chapel when they're NumPy
+// arrays of the element type, and copied otherwise.  Arrays returned to
+// Python become NumPy arrays over the Chapel memory.
+
+export proc scaleInPlace(ref x: [] real, f: real) {
+  x *= f;
+}
+
+export proc total(const ref x: [] int): int {
+  return + reduce x;
+}
+
+export proc makeSquares(): [0..4] int {
+  var A: [0..4] int;
+  for i in 0..4 do A[i] = i * i;
+  return A;
+}
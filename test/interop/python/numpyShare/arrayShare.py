@@ -0,0 +1,36 @@
+import numpy
+import arrayShare
+
+arrayShare.chpl_setup()
+
+# A NumPy array of reals is shared, so Chapel's writes show up here.
+a = numpy.array([1.0, 2.0, 3.0])
+arrayShare.scaleInPlace(a, 2.0)
+print(a.tolist())
+
+# A list is copied, so it's left alone.
+l = [1.0, 2.0]
+arrayShare.scaleInPlace(l, 2.0)
+print(l)
+
+# A NumPy array of another element type is copied as well.
+f = numpy.array([1.0, 2.0], dtype=numpy.float32)
+arrayShare.scaleInPlace(f, 2.0)
+print(f.tolist())
+
+# A non-contiguous view is copied.
+v = numpy.arange(10, dtype=numpy.int64)[::2]
+print(arrayShare.total(v))
+print(arrayShare.total(numpy.arange(10, dtype=numpy.int64)))
+print(arrayShare.total([1, 2, 3]))
+
+# Returned arrays outlive the call and own their memory.
+s = arrayShare.makeSquares()
+t = arrayShare.makeSquares()
+s[0] = 100
+print(type(s).__name__, s.tolist(), t.tolist())
+del s
+print(t.sum())
+del t
+
+arrayShare.chpl_cleanup()
@@ -0,0 +1,176 @@
+#include "qbuffer.h"
+#include "qio_stats.h"
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include <pthread.h>
+
+int verbose = 0;
+
+#define N 8
+
+static qbytes_t* handoff[N];
+
+static
+void get_counts(int64_t* hits, int64_t* misses, int64_t* remote)
+{
+  qio_io_stats_t s;
+  qio_stats_get_global(&s);
+  *hits = s.iobuf_hits;
+  *misses = s.iobuf_misses;
+  *remote = s.iobuf_remote_frees;
+}
+
+static
+void* create_thread(void* arg)
+{
+  int i;
+  for( i = 0; i < N; i++ ) {
+    qioerr err = qbytes_create_iobuf(&handoff[i]);
+    assert(!err);
+    memset(handoff[i]->data, 0xff, handoff[i]->len);
+  }
+  return NULL;
+}
+
+static
+void* release_thread(void* arg)
+{
+  int i;
+  for( i = 0; i < N; i++ ) qbytes_release(handoff[i]);
+  return NULL;
+}
+
+// Buffers freed on the creating thread are reused from its freelist.
+static
+void check_local(void)
+{
+  qbytes_t* b[N];
+  void* data[N];
+  int64_t h0, m0, r0, h1, m1, r1;
+  qioerr err;
+  int i, j, found;
+
+  get_counts(&h0, &m0, &r0);
+  for( i = 0; i < N; i++ ) {
+    err = qbytes_create_iobuf(&b[i]);
+    assert(!err);
+    assert( (size_t) b[i]->len == qbytes_iobuf_size );
+    data[i] = b[i]->data;
+  }
+  for( i = 0; i < N; i++ ) qbytes_release(b[i]);
+  for( i = 0; i < N; i++ ) {
+    err = qbytes_create_iobuf(&b[i]);
+    assert(!err);
+    assert( DO_GET_REFCNT(b[i]) == 1 );
+    found = 0;
+    for( j = 0; j < N; j++ ) found |= (b[i]->data == data[j]);
+    assert( found );
+  }
+  get_counts(&h1, &m1, &r1);
+  assert( h1 - h0 == N );
+  assert( m1 - m0 == N );
+  assert( r1 == r0 );
+
+  for( i = 0; i < N; i++ ) qbytes_release(b[i]);
+}
+
+// Only qbytes_iobuf_cache_max buffers are kept.
+static
+void check_bound(void)
+{
+  qbytes_t* b[N];
+  int64_t h0, m0, r0, h1, m1, r1;
+  int save = qbytes_iobuf_cache_max;
+  int i;
+
+  // empty the freelist
+  for( i = 0; i < N; i++ ) assert( !qbytes_create_iobuf(&b[i]) );
+  qbytes_iobuf_cache_max = 2;
+  for( i = 0; i < N; i++ ) qbytes_release(b[i]);
+
+  get_counts(&h0, &m0, &r0);
+  for( i = 0; i < N; i++ ) assert( !qbytes_create_iobuf(&b[i]) );
+  get_counts(&h1, &m1, &r1);
+  assert( h1 - h0 == 2 );
+  assert( m1 - m0 == N - 2 );
+  for( i = 0; i < N; i++ ) qbytes_release(b[i]);
+
+  qbytes_iobuf_cache_max = save;
+}
+
+// Buffers freed by another thread go back to the creating thread.
+static
+void check_remote(void)
+{
+  pthread_t t;
+  int64_t h0, m0, r0, h1, m1, r1;
+  int i;
+
+  // Created here, released elsewhere.
+  for( i = 0; i < N; i++ ) assert( !qbytes_create_iobuf(&handoff[i]) );
+  get_counts(&h0, &m0, &r0);
+  assert( pthread_create(&t, NULL, release_thread, NULL) == 0 );
+  assert( pthread_join(t, NULL) == 0 );
+  get_counts(&h1, &m1, &r1);
+  assert( r1 - r0 == N );
+
+  // The returned buffers are reused; make sure they can be
+  // written and released again.
+  for( i = 0; i < N; i++ ) {
+    assert( !qbytes_create_iobuf(&handoff[i]) );
+    memset(handoff[i]->data, 0, handoff[i]->len);
+  }
+  get_counts(&h0, &m0, &r0);
+  assert( h0 - h1 == N );
+  assert( m0 == m1 );
+  for( i = 0; i < N; i++ ) qbytes_release(handoff[i]);
+
+  // Created by a thread that has exited; these are just freed.
+  assert( pthread_create(&t, NULL, create_thread, NULL) == 0 );
+  assert( pthread_join(t, NULL) == 0 );
+  get_counts(&h0, &m0, &r0);
+  for( i = 0; i < N; i++ ) {
+    assert( ((unsigned char*) handoff[i]->data)[0] == 0xff );
+    qbytes_release(handoff[i]);
+  }
+  get_counts(&h1, &m1, &r1);
+  assert( r1 == r0 );
+}
+
+// Cached buffers of a different size are not reused.
+static
+void check_resize(void)
+{
+  size_t save = qbytes_iobuf_size;
+  qbytes_t* b;
+
+  assert( !qbytes_create_iobuf(&b) );
+  qbytes_release(b);
+  qbytes_iobuf_size = 4096;
+  assert( !qbytes_create_iobuf(&b) );
+  assert( b->len == 4096 );
+  qbytes_release(b);
+  qbytes_iobuf_size = save;
+  assert( !qbytes_create_iobuf(&b) );
+  assert( (size_t) b->len == save );
+  qbytes_release(b);
+}
+
+int main(int argc, char** argv)
+{
+  if( argc > 1 ) verbose = 1;
+
+  qio_stats_enable(1);
+
+  check_local();
+  check_bound();
+  check_remote();
+  check_resize();
+
+  if( verbose ) qio_stats_print(stdout);
+  qio_stats_enable(0);
+
+  printf("qbuffer_iobuf_test PASS\n");
+  return 0;
+}
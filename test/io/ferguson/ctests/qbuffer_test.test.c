@@ -550,6 +550,93 @@ void test_qbuffer_edges(void)
 }
 
 
+// Check advancing and seeking against the part boundaries in a buffer
+// with many parts, and that trimming either end keeps them right.
+#define MANY_PARTS 1000
+static
+ssize_t part_index(qbuffer_t* buf, qbuffer_iter_t it)
+{
+  return deque_it_difference(sizeof(qbuffer_part_t), it.iter,
+                             deque_begin(&buf->deque));
+}
+
+static
+ssize_t expect_part(int64_t* ends, int nparts, int64_t offset)
+{
+  ssize_t i;
+  for( i = 0; i < nparts; i++ ) {
+    if( offset < ends[i] ) return i;
+  }
+  return nparts;
+}
+
+void test_qbuffer_many_parts(void)
+{
+  qbuffer_t buf;
+  qbytes_t* b;
+  qbuffer_iter_t cur;
+  int64_t ends[MANY_PARTS];
+  int64_t total = 0, off, amt;
+  int nparts = MANY_PARTS;
+  qioerr err;
+  int i, j;
+
+  err = qbytes_create_calloc(&b, 16);
+  assert(!err);
+  err = qbuffer_init(&buf);
+  assert(!err);
+  for( i = 0; i < MANY_PARTS; i++ ) {
+    int64_t len = 1 + (i * 7) % 16;
+    err = qbuffer_append(&buf, b, 0, len);
+    assert(!err);
+    total += len;
+    ends[i] = total;
+  }
+  assert( qbuffer_num_parts(&buf) == MANY_PARTS );
+
+  for( off = 0; off <= total; off += 3 ) {
+    cur = qbuffer_iter_at(&buf, off);
+    assert( cur.offset == off );
+    assert( part_index(&buf, cur) == expect_part(ends, nparts, off) );
+
+    for( j = 0; j < 9; j++ ) {
+      static const int64_t amts[] = {0, 1, 15, 16, 17, 100, 5000, -1, -5000};
+      qbuffer_iter_t it = cur;
+      int64_t want;
+
+      amt = amts[j];
+      want = off + amt;
+      if( want < 0 ) want = 0;
+      if( want > total ) want = total;
+      qbuffer_iter_advance(&buf, &it, amt);
+      assert( it.offset == want );
+      assert( part_index(&buf, it) == expect_part(ends, nparts, want) );
+    }
+  }
+
+  // Trimming the back removes whole parts from the back.
+  qbuffer_trim_back(&buf, ends[MANY_PARTS-1] - ends[MANY_PARTS-11] + 1);
+  nparts = MANY_PARTS - 10;
+  ends[nparts-1] -= 1;
+  assert( qbuffer_num_parts(&buf) == nparts );
+  assert( qbuffer_end_offset(&buf) == ends[nparts-1] );
+  cur = qbuffer_iter_at(&buf, ends[nparts-1] - 1);
+  assert( part_index(&buf, cur) == nparts - 1 );
+
+  // Trimming the front keeps the offsets of the rest.
+  qbuffer_trim_front(&buf, ends[9] + 1);
+  assert( qbuffer_num_parts(&buf) == nparts - 10 );
+  assert( qbuffer_start_offset(&buf) == ends[9] + 1 );
+  cur = qbuffer_iter_at(&buf, ends[500]);
+  assert( part_index(&buf, cur) == 501 - 10 );
+  cur = qbuffer_begin(&buf);
+  qbuffer_iter_advance(&buf, &cur, ends[500] - cur.offset);
+  assert( part_index(&buf, cur) == 501 - 10 );
+
+  qbuffer_destroy(&buf);
+  qbytes_release(b);
+}
+
 int main(int argc, char** argv)
 {
   test_qbytes();
@@ -560,6 +647,8 @@ int main(int argc, char** argv)
 
   test_qbuffer_edges();
 
+  test_qbuffer_many_parts();
+
   printf("qbuffer_test PASS\n");
 
   return 0;
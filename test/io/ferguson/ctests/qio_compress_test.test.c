@@ -0,0 +1,301 @@
+#include "qio.h"
+#include "qio_compress.h"
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+
+int verbose = 0;
+
+static
+char data_byte(int64_t i)
+{
+  // compressible, but not trivially so
+  return "abcdefghij"[(i * 7 + (i >> 10)) % 10];
+}
+
+// Write len bytes compressed with the given block size, in pieces of
+// chunk bytes.
+static
+void make_file(qio_file_t** base_out, int64_t block_size, int64_t len,
+               int64_t chunk)
+{
+  qio_file_t* base;
+  qio_file_t* f;
+  qio_channel_t* ch;
+  qioerr err;
+  char* buf;
+  int64_t i, off;
+
+  buf = qio_malloc(len + 1);
+  for( i = 0; i < len; i++ ) buf[i] = data_byte(i);
+
+  err = qio_file_open_tmp(&base, 0, NULL);
+  assert(!err);
+  err = qio_file_open_compressed(&f, base, QIO_COMPRESS_GZIP, -1, block_size,
+                                 QIO_FDFLAG_WRITEABLE, NULL);
+  assert(!err);
+  err = qio_channel_create(&ch, f, 0, 0, 1, 0, INT64_MAX, NULL);
+  assert(!err);
+  for( off = 0; off < len; off += chunk ) {
+    int64_t n = len - off < chunk ? len - off : chunk;
+    err = qio_channel_write_amt(1, ch, buf + off, n);
+    assert(!err);
+  }
+  err = qio_channel_close(1, ch);
+  assert(!err);
+  qio_channel_release(ch);
+
+  {
+    int64_t flen = -1;
+    err = qio_file_length(f, &flen);
+    assert(!err);
+    assert( flen == len );
+  }
+
+  qio_file_release(f);
+  qio_free(buf);
+
+  *base_out = base;
+}
+
+// Read [start, end) of the uncompressed data.
+static
+void check_range(qio_file_t* f, int64_t start, int64_t end, int64_t len)
+{
+  qio_channel_t* ch;
+  qioerr err;
+  char* buf;
+  ssize_t amt = 0;
+  int64_t expect, i;
+
+  expect = (end < len ? end : len) - start;
+  if( expect < 0 ) expect = 0;
+
+  err = qio_channel_create(&ch, f, 0, 1, 0, start, end, NULL);
+  assert(!err);
+  buf = qio_malloc(expect + 1);
+  err = qio_channel_read(1, ch, buf, expect + 1, &amt);
+  assert( amt == expect );
+  assert( qio_err_to_int(err) == EEOF );
+  for( i = 0; i < expect; i++ ) {
+    assert( buf[i] == data_byte(start + i) );
+  }
+  qio_channel_release(ch);
+  qio_free(buf);
+}
+
+// The file should also be readable with zlib's gzip reader.
+static
+void check_gunzip(qio_file_t* base, int64_t len)
+{
+  gzFile gz;
+  char buf[4096];
+  int64_t off = 0;
+  int got, i;
+  int fd = dup(base->fd);
+
+  assert( fd >= 0 );
+  assert( lseek(fd, 0, SEEK_SET) == 0 );
+  gz = gzdopen(fd, "rb");
+  assert( gz );
+  while( (got = gzread(gz, buf, sizeof(buf))) > 0 ) {
+    for( i = 0; i < got; i++ ) assert( buf[i] == data_byte(off + i) );
+    off += got;
+  }
+  assert( got == 0 );
+  assert( off == len );
+  gzclose(gz);
+}
+
+static
+void check(int64_t block_size, int64_t len, int64_t chunk)
+{
+  qio_file_t* base;
+  qio_file_t* f;
+  qioerr err;
+  int64_t flen = -1;
+
+  if( verbose ) {
+    printf("block_size=%lli len=%lli chunk=%lli\n",
+           (long long) block_size, (long long) len, (long long) chunk);
+  }
+
+  make_file(&base, block_size, len, chunk);
+  if( len > 0 ) check_gunzip(base, len);
+
+  err = qio_file_open_compressed(&f, base, QIO_COMPRESS_DETECT, -1, 0,
+                                 QIO_FDFLAG_READABLE, NULL);
+  assert(!err);
+  err = qio_file_length(f, &flen);
+  assert(!err);
+  assert( flen == len );
+
+  check_range(f, 0, INT64_MAX, len);
+  check_range(f, len / 3, INT64_MAX, len);
+  check_range(f, len / 3, len / 2 + 1, len);
+  check_range(f, len, INT64_MAX, len);
+
+  // Two channels open at once on different parts of the file.
+  if( len > 10 ) {
+    qio_channel_t* a;
+    qio_channel_t* b;
+    int64_t i;
+
+    err = qio_channel_create(&a, f, 0, 1, 0, 0, INT64_MAX, NULL);
+    assert(!err);
+    err = qio_channel_create(&b, f, 0, 1, 0, len / 2, INT64_MAX, NULL);
+    assert(!err);
+    for( i = 0; i < len / 2; i++ ) {
+      assert( qio_channel_read_byte(1, a) == (uint8_t) data_byte(i) );
+      assert( qio_channel_read_byte(1, b) == (uint8_t) data_byte(len/2 + i) );
+    }
+    qio_channel_release(a);
+    qio_channel_release(b);
+  }
+
+  // A compressed file open for reading can't be written.
+  {
+    qio_channel_t* ch;
+    err = qio_channel_create(&ch, f, 0, 0, 1, 0, INT64_MAX, NULL);
+    assert( err );
+  }
+
+  qio_file_release(f);
+  qio_file_release(base);
+}
+
+// Damaged data should be reported, not returned.
+static
+void check_corrupt(void)
+{
+  qio_file_t* base;
+  qio_file_t* f;
+  qio_channel_t* ch;
+  char buf[100000];
+  ssize_t amt = 0;
+  char c = 0;
+  qioerr err;
+
+  make_file(&base, 10000, 100000, 4096);
+
+  assert( pread(base->fd, &c, 1, 30) == 1 );
+  c ^= 0x55;
+  assert( pwrite(base->fd, &c, 1, 30) == 1 );
+
+  err = qio_file_open_compressed(&f, base, QIO_COMPRESS_DETECT, -1, 0,
+                                 QIO_FDFLAG_READABLE, NULL);
+  assert(!err);
+  err = qio_channel_create(&ch, f, 0, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_read(1, ch, buf, sizeof(buf), &amt);
+  assert( qio_err_to_int(err) == EFORMAT );
+  qio_channel_release(ch);
+  qio_file_release(f);
+
+  // A bad header is noticed when the file is opened.
+  c = 0;
+  assert( pwrite(base->fd, &c, 1, 12) == 1 );
+  err = qio_file_open_compressed(&f, base, QIO_COMPRESS_DETECT, -1, 0,
+                                 QIO_FDFLAG_READABLE, NULL);
+  assert( qio_err_to_int(err) == EFORMAT );
+
+  qio_file_release(base);
+}
+
+static
+void check_errors(void)
+{
+  qio_file_t* base;
+  qio_file_t* f;
+  qio_channel_t* a;
+  qio_channel_t* b;
+  qioerr err;
+
+  err = qio_file_open_tmp(&base, 0, NULL);
+  assert(!err);
+
+  // Can't open for both reading and writing.
+  err = qio_file_open_compressed(&f, base, QIO_COMPRESS_GZIP, -1, 0,
+                                 QIO_FDFLAG_READABLE|QIO_FDFLAG_WRITEABLE,
+                                 NULL);
+  assert( qio_err_to_int(err) == EINVAL );
+
+  assert( ! qio_compress_supported(QIO_COMPRESS_DETECT) );
+  if( ! qio_compress_supported(QIO_COMPRESS_ZSTD) ) {
+    err = qio_file_open_compressed(&f, base, QIO_COMPRESS_ZSTD, -1, 0,
+                                   QIO_FDFLAG_WRITEABLE, NULL);
+    assert( qio_err_to_int(err) == ENOSYS );
+  }
+
+  // Only one writer, and only at the end.
+  err = qio_file_open_compressed(&f, base, QIO_COMPRESS_GZIP, -1, 100,
+                                 QIO_FDFLAG_WRITEABLE, NULL);
+  assert(!err);
+  err = qio_channel_create(&a, f, 0, 0, 1, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_create(&b, f, 0, 0, 1, 0, INT64_MAX, NULL);
+  assert( qio_err_to_int(err) == ESPIPE );
+  err = qio_channel_write_amt(1, a, "hello world", 11);
+  assert(!err);
+  err = qio_channel_close(1, a);
+  assert(!err);
+  qio_channel_release(a);
+
+  err = qio_channel_create(&b, f, 0, 0, 1, 0, INT64_MAX, NULL);
+  assert( qio_err_to_int(err) == ESPIPE );
+  err = qio_channel_create(&b, f, 0, 0, 1, 11, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_write_amt(1, b, "!", 1);
+  assert(!err);
+  err = qio_channel_close(1, b);
+  assert(!err);
+  qio_channel_release(b);
+  qio_file_release(f);
+
+  // Can't start writing over existing data.
+  err = qio_file_open_compressed(&f, base, QIO_COMPRESS_GZIP, -1, 0,
+                                 QIO_FDFLAG_WRITEABLE, NULL);
+  assert( qio_err_to_int(err) == EINVAL );
+
+  err = qio_file_open_compressed(&f, base, QIO_COMPRESS_DETECT, -1, 0,
+                                 QIO_FDFLAG_READABLE, NULL);
+  assert(!err);
+  err = qio_channel_create(&a, f, 0, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+  {
+    char buf[20];
+    ssize_t amt = 0;
+    err = qio_channel_read(1, a, buf, sizeof(buf), &amt);
+    assert( amt == 12 );
+    assert( memcmp(buf, "hello world!", 12) == 0 );
+  }
+  qio_channel_release(a);
+  qio_file_release(f);
+  qio_file_release(base);
+}
+
+int main(int argc, char** argv)
+{
+  int64_t block_sizes[] = { 1000, 65536, 0 };
+  int nblock_sizes = sizeof(block_sizes)/sizeof(block_sizes[0]);
+  int64_t lens[] = { 0, 1, 999, 1000, 1001, 100000, 300000 + 17 };
+  int nlens = sizeof(lens)/sizeof(lens[0]);
+  int b, l;
+
+  if( argc > 1 ) verbose = 1;
+
+  for( b = 0; b < nblock_sizes; b++ ) {
+    for( l = 0; l < nlens; l++ ) {
+      check(block_sizes[b], lens[l], 4096);
+      check(block_sizes[b], lens[l], 777);
+    }
+  }
+
+  check_corrupt();
+  check_errors();
+
+  printf("qio_compress_test PASS\n");
+  return 0;
+}
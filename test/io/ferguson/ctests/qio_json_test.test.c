@@ -0,0 +1,153 @@
+#include "qio.h"
+#include "qio_formatted.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+// Skip JSON fields with a normal channel and with the fast path turned
+// off (QIO_HINT_NOFAST), and check they end up in the same places.
+
+#define NFIELDS 20000
+
+static uint64_t seed = 777;
+
+static
+uint32_t next_random(void)
+{
+  seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return (uint32_t) (seed >> 33);
+}
+
+static char* text;
+static size_t text_len;
+static size_t text_size;
+
+static
+void put(const char* s)
+{
+  size_t n = strlen(s);
+  if( text_len + n + 1 > text_size ) {
+    text_size = 2 * (text_len + n + 1);
+    text = realloc(text, text_size);
+    assert(text);
+  }
+  memcpy(text + text_len, s, n + 1);
+  text_len += n;
+}
+
+static
+void put_string(void)
+{
+  int len = next_random() % 40;
+  int i;
+
+  // an occasional long string crosses buffer boundaries
+  if( next_random() % 500 == 0 ) len = 100000;
+
+  put("\"");
+  for( i = 0; i < len; i++ ) {
+    switch( next_random() % 12 ) {
+      case 0: put("\\\""); break;
+      case 1: put("\\\\"); break;
+      case 2: put("{"); break;
+      case 3: put("]"); break;
+      default: {
+        char c[2] = { 'a' + next_random() % 26, 0 };
+        put(c);
+      }
+    }
+  }
+  put("\"");
+}
+
+static
+void put_value(int depth)
+{
+  char buf[64];
+  int i, n;
+
+  switch( next_random() % (depth < 4 ? 8 : 6) ) {
+    case 0: put_string(); break;
+    case 1:
+      snprintf(buf, sizeof(buf), "%d", (int) next_random() - (1 << 30));
+      put(buf);
+      break;
+    case 2:
+      snprintf(buf, sizeof(buf), "%.6e", (next_random() % 100000) / 7.0);
+      put(buf);
+      break;
+    case 3: put("true"); break;
+    case 4: put("false"); break;
+    case 5: put("null"); break;
+    case 6:
+      n = next_random() % 5;
+      put("{");
+      for( i = 0; i < n; i++ ) {
+        if( i > 0 ) put(", ");
+        put_string();
+        put(" : ");
+        put_value(depth + 1);
+      }
+      put(" }");
+      break;
+    default:
+      n = next_random() % 5;
+      put("[");
+      for( i = 0; i < n; i++ ) {
+        if( i > 0 ) put(",");
+        put_value(depth + 1);
+      }
+      put("]");
+      break;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  qio_file_t* f;
+  qio_channel_t* writing;
+  qio_channel_t* fast;
+  qio_channel_t* slow;
+  qioerr err, err2;
+  int i;
+
+  for( i = 0; i < NFIELDS; i++ ) {
+    put(i % 3 == 0 ? "\n " : " ");
+    put_string();
+    put(":");
+    put_value(0);
+    put(",");
+  }
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&writing, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_write_amt(true, writing, text, text_len);
+  assert(!err);
+  qio_channel_release(writing);
+
+  err = qio_channel_create(&fast, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_create(&slow, f, QIO_CH_BUFFERED | QIO_HINT_NOFAST, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+
+  for( i = 0; i < NFIELDS; i++ ) {
+    err = qio_channel_skip_json_field(true, fast);
+    err2 = qio_channel_skip_json_field(true, slow);
+    assert(!err);
+    assert(!err2);
+    assert(qio_channel_offset_unlocked(fast) == qio_channel_offset_unlocked(slow));
+    assert(qio_channel_read_byte(true, fast) == ',');
+    assert(qio_channel_read_byte(true, slow) == ',');
+  }
+
+  qio_channel_release(fast);
+  qio_channel_release(slow);
+  qio_file_release(f);
+  free(text);
+
+  printf("qio_json_test PASS\n");
+  return 0;
+}
@@ -0,0 +1,118 @@
+#include "qio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+
+int verbose = 0;
+
+#define LEN (40*1024*1024 + 17)
+#define PIECE (64*1024)
+
+static
+char data_byte(int64_t i)
+{
+  return (char) ((i * 7 + (i >> 12)) & 0xff);
+}
+
+static
+void fill_fd(int fd)
+{
+  char* buf = malloc(PIECE);
+  int64_t off, i;
+
+  for( off = 0; off < LEN; off += PIECE ) {
+    int64_t n = LEN - off < PIECE ? LEN - off : PIECE;
+    for( i = 0; i < n; i++ ) buf[i] = data_byte(off + i);
+    assert( pwrite(fd, buf, n, off) == n );
+  }
+  free(buf);
+}
+
+// Read the whole file a piece at a time; return the channel's mmaps.
+static
+int64_t read_file(qio_file_t* f, qio_hint_t hints)
+{
+  qio_channel_t* ch;
+  qio_io_stats_t s;
+  char* buf = malloc(PIECE);
+  int64_t off, i;
+  qioerr err;
+
+  err = qio_channel_create(&ch, f, hints, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+  for( off = 0; off < LEN; off += PIECE ) {
+    int64_t n = LEN - off < PIECE ? LEN - off : PIECE;
+    err = qio_channel_read_amt(1, ch, buf, n);
+    assert(!err);
+    for( i = 0; i < n; i++ ) assert( buf[i] == data_byte(off + i) );
+  }
+  assert( qio_channel_read_byte(1, ch) == -EEOF );
+  err = qio_channel_get_stats(1, ch, &s);
+  assert(!err);
+  qio_channel_release(ch);
+  free(buf);
+
+  if( verbose ) printf("hints=%x mmaps=%lli\n", (int) hints, (long long) s.mmaps);
+  return s.mmaps;
+}
+
+int main(int argc, char** argv)
+{
+  char filename[] = "qio_mmap_test.XXXXXX";
+  qio_file_t* f;
+  int64_t chunk = qio_mmap_chunk_iobufs * qbytes_iobuf_size;
+  int64_t plain, seq, rnd;
+  int fd;
+  qioerr err;
+
+  if( argc > 1 ) verbose = 1;
+
+  qio_stats_enable(1);
+
+  fd = mkstemp(filename);
+  assert( fd >= 0 );
+  fill_fd(fd);
+  close(fd);
+
+  // A writeable file this big isn't mapped whole, so channels map
+  // chunks, sized by their hints.
+  err = qio_file_open_access(&f, filename, "r+", QIO_METHOD_MMAP, NULL);
+  assert(!err);
+  assert( f->mmap == NULL );
+  plain = read_file(f, QIO_METHOD_MMAP);
+  seq = read_file(f, QIO_METHOD_MMAP | QIO_HINT_SEQUENTIAL);
+  rnd = read_file(f, QIO_METHOD_MMAP | QIO_HINT_RANDOM);
+  assert( plain <= LEN / chunk + 2 );
+  assert( seq <= 6 );
+  assert( seq <= plain );
+  assert( rnd > plain );
+  qio_file_release(f);
+
+  // A read-only one is mapped whole when the file is opened.
+  qio_mmap_hugepage = 1;
+  err = qio_file_open_access(&f, filename, "r",
+                             QIO_METHOD_MMAP | QIO_HINT_SEQUENTIAL, NULL);
+  assert(!err);
+  assert( f->mmap != NULL );
+  assert( f->mmap->len == LEN );
+  assert( read_file(f, QIO_METHOD_MMAP) == 0 );
+  qio_file_release(f);
+
+  // Unless it's over the limit.
+  qio_initial_mmap_max_readonly = LEN - 1;
+  err = qio_file_open_access(&f, filename, "r", QIO_METHOD_MMAP, NULL);
+  assert(!err);
+  assert( f->mmap == NULL );
+  assert( read_file(f, QIO_METHOD_MMAP | QIO_HINT_SEQUENTIAL) > 0 );
+  qio_file_release(f);
+
+  unlink(filename);
+
+  // Don't print the statistics at exit.
+  qio_stats_enable(0);
+
+  printf("qio_mmap_test PASS\n");
+  return 0;
+}
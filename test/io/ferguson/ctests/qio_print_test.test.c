@@ -0,0 +1,302 @@
+#include "qio.h"
+#include "qio_formatted.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+// Check the default %g float output, the shortest round-trip float
+// output (realfmt 3) and decimal integer output against snprintf.
+
+#define NNUMS 200000
+
+static uint64_t seed = 4321;
+
+static
+uint64_t next_random(void)
+{
+  seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return seed;
+}
+
+static
+double random_double(void)
+{
+  uint64_t r = next_random();
+  double d;
+
+  switch( r % 5 ) {
+    case 0:
+      // any finite double
+      do {
+        uint64_t bits = next_random() ^ (next_random() << 17);
+        memcpy(&d, &bits, sizeof(d));
+      } while( isnan(d) || isinf(d) );
+      return fabs(d);
+    case 1:
+      return (double) (next_random() >> 11) / (double) (1ULL << 53);
+    case 2:
+      return (double) (next_random() % 10000000) / 100.0;
+    case 3:
+      return (double) (next_random() % 2000000);
+    default:
+      return ldexp((double) (next_random() >> 11), (int) (next_random() % 200) - 100);
+  }
+}
+
+// The default %g conversion, as _ftoa_core does it with snprintf.
+static
+void expect_default(char* buf, size_t size, double d)
+{
+  if( d >= 100000.0 && d < 1000000.0 ) {
+    int got = snprintf(buf, size, "%.5e", d);
+    int dp = 0, last = 0, i;
+    while( dp < got && buf[dp++] != '.' ) ;
+    for( i = dp; i < got && buf[i] != 'e'; i++ ) {
+      if( buf[i] != '0' ) last = i - dp + 1;
+    }
+    snprintf(buf, size, "%.*e", last, d);
+  } else {
+    snprintf(buf, size, "%g", d);
+  }
+}
+
+// Returns the significant digits in a printed number.
+static
+int significant_digits(const char* s, char* digits)
+{
+  int n = 0;
+  int has_point = strchr(s, '.') != NULL;
+
+  for( ; *s && *s != 'e'; s++ ) {
+    if( *s == '.' ) continue;
+    if( n == 0 && *s == '0' ) continue;
+    digits[n++] = *s;
+  }
+  if( ! has_point ) {
+    while( n > 1 && digits[n-1] == '0' ) n--;
+  }
+  if( n == 0 ) digits[n++] = '0';
+  digits[n] = '\0';
+  return n;
+}
+
+static
+void print_all(qio_style_t* style, double* nums, char** text_out)
+{
+  qio_file_t* f;
+  qio_channel_t* ch;
+  qioerr err;
+  int64_t len;
+  int i;
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&ch, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, style);
+  assert(!err);
+  for( i = 0; i < NNUMS; i++ ) {
+    err = qio_channel_print_float(true, ch, &nums[i], 8);
+    assert(!err);
+    err = qio_channel_write_amt(true, ch, "\n", 1);
+    assert(!err);
+  }
+  qio_channel_release(ch);
+
+  err = qio_file_length(f, &len);
+  assert(!err);
+  *text_out = qio_malloc(len + 1);
+  err = qio_channel_create(&ch, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_read_amt(true, ch, *text_out, len);
+  assert(!err);
+  (*text_out)[len] = '\0';
+  qio_channel_release(ch);
+  qio_file_release(f);
+}
+
+static
+void check_floats(void)
+{
+  qio_style_t style;
+  double* nums;
+  char* text;
+  char* line;
+  char* save;
+  char expect[64];
+  int i;
+
+  nums = qio_malloc(NNUMS * sizeof(double));
+  for( i = 0; i < NNUMS; i++ ) nums[i] = random_double();
+  nums[0] = 0.0;
+  nums[1] = 999999.5;
+  nums[2] = 99999.95;
+  nums[3] = 5e-324;
+
+  // Default style, but without the .0 after integers that plain
+  // %g wouldn't print.
+  qio_style_init_default(&style);
+  style.showpointzero = 0;
+  print_all(&style, nums, &text);
+  line = strtok_r(text, "\n", &save);
+  for( i = 0; i < NNUMS; i++ ) {
+    assert(line);
+    expect_default(expect, sizeof(expect), nums[i]);
+    if( strcmp(line, expect) != 0 ) {
+      printf("default: %.17g printed '%s' expected '%s'\n", nums[i], line, expect);
+      assert(0);
+    }
+    line = strtok_r(NULL, "\n", &save);
+  }
+  qio_free(text);
+
+  // Shortest round-trip.
+  style.realfmt = 3;
+  print_all(&style, nums, &text);
+  line = strtok_r(text, "\n", &save);
+  for( i = 0; i < NNUMS; i++ ) {
+    char got_digits[32];
+    char expect_digits[32];
+    int p;
+
+    assert(line);
+    // It reads back exactly.
+    assert(strtod(line, NULL) == nums[i]);
+    // It has the same digits as the shortest %.*e that reads back.
+    for( p = 1; p < 17; p++ ) {
+      snprintf(expect, sizeof(expect), "%.*e", p - 1, nums[i]);
+      if( strtod(expect, NULL) == nums[i] ) break;
+    }
+    snprintf(expect, sizeof(expect), "%.*e", p - 1, nums[i]);
+    significant_digits(line, got_digits);
+    significant_digits(expect, expect_digits);
+    if( strcmp(got_digits, expect_digits) != 0 ) {
+      printf("shortest: %.17g printed '%s' expected digits %s\n", nums[i], line, expect_digits);
+      assert(0);
+    }
+    line = strtok_r(NULL, "\n", &save);
+  }
+  qio_free(text);
+  qio_free(nums);
+}
+
+static
+void check_one_shortest(double d, int showpointzero, const char* expect)
+{
+  qio_style_t style;
+  qio_file_t* f;
+  qio_channel_t* ch;
+  char got[64];
+  int64_t len;
+  qioerr err;
+
+  qio_style_init_default(&style);
+  style.realfmt = 3;
+  style.showpointzero = showpointzero;
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&ch, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, &style);
+  assert(!err);
+  err = qio_channel_print_float(true, ch, &d, 8);
+  assert(!err);
+  qio_channel_release(ch);
+
+  err = qio_file_length(f, &len);
+  assert(!err);
+  assert(len < sizeof(got));
+  err = qio_channel_create(&ch, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_read_amt(true, ch, got, len);
+  assert(!err);
+  got[len] = '\0';
+  qio_channel_release(ch);
+  qio_file_release(f);
+
+  if( strcmp(got, expect) != 0 ) {
+    printf("shortest: printed '%s' expected '%s'\n", got, expect);
+    assert(0);
+  }
+}
+
+static
+void check_ints(void)
+{
+  qio_file_t* f;
+  qio_channel_t* ch;
+  int64_t* nums;
+  char* text;
+  char* line;
+  char* save;
+  char expect[32];
+  int64_t len;
+  qioerr err;
+  int i;
+
+  nums = qio_malloc(NNUMS * sizeof(int64_t));
+  for( i = 0; i < NNUMS; i++ ) {
+    nums[i] = (int64_t) next_random() >> (next_random() % 64);
+  }
+  nums[0] = 0;
+  nums[1] = INT64_MIN;
+  nums[2] = INT64_MAX;
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&ch, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, NULL);
+  assert(!err);
+  for( i = 0; i < NNUMS; i++ ) {
+    err = qio_channel_print_int(true, ch, &nums[i], 8, 1);
+    assert(!err);
+    err = qio_channel_write_amt(true, ch, "\n", 1);
+    assert(!err);
+  }
+  qio_channel_release(ch);
+
+  err = qio_file_length(f, &len);
+  assert(!err);
+  text = qio_malloc(len + 1);
+  err = qio_channel_create(&ch, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_read_amt(true, ch, text, len);
+  assert(!err);
+  text[len] = '\0';
+  qio_channel_release(ch);
+  qio_file_release(f);
+
+  line = strtok_r(text, "\n", &save);
+  for( i = 0; i < NNUMS; i++ ) {
+    assert(line);
+    snprintf(expect, sizeof(expect), "%" PRId64, nums[i]);
+    assert(0 == strcmp(line, expect));
+    line = strtok_r(NULL, "\n", &save);
+  }
+
+  qio_free(text);
+  qio_free(nums);
+}
+
+int main(int argc, char** argv)
+{
+  check_one_shortest(0.0, 0, "0");
+  check_one_shortest(-0.0, 0, "-0");
+  check_one_shortest(0.1, 0, "0.1");
+  check_one_shortest(0.1 + 0.2, 0, "0.30000000000000004");
+  check_one_shortest(123.456, 0, "123.456");
+  check_one_shortest(-2.5, 0, "-2.5");
+  check_one_shortest(1e-5, 0, "1e-05");
+  check_one_shortest(1e16, 0, "10000000000000000");
+  check_one_shortest(1e17, 0, "1e+17");
+  check_one_shortest(5e-324, 0, "5e-324");
+  check_one_shortest(1.7976931348623157e308, 0, "1.7976931348623157e+308");
+  check_one_shortest(INFINITY, 0, "inf");
+  check_one_shortest(2.0, 1, "2.0");
+  check_one_shortest(1e17, 1, "1e+17");
+
+  check_floats();
+  check_ints();
+
+  printf("qio_print_test PASS\n");
+  return 0;
+}
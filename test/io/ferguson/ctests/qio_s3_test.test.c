@@ -0,0 +1,567 @@
+#define _GNU_SOURCE
+#include "qio.h"
+#include "qio_s3.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+int verbose = 0;
+
+// A tiny object store: enough of S3's REST API for the plugin, with
+// objects and multipart uploads kept in memory.
+
+#define MAX_OBJECTS 64
+#define MAX_PARTS 64
+
+typedef struct {
+  char name[256];
+  char* data;
+  int64_t len;
+  int upload; // nonzero for an upload in progress
+  char* parts[MAX_PARTS];
+  int64_t part_lens[MAX_PARTS];
+} object_t;
+
+static object_t objects[MAX_OBJECTS];
+static pthread_mutex_t store_lock = PTHREAD_MUTEX_INITIALIZER;
+static int next_upload = 1;
+static int active_gets = 0;
+static int max_active_gets = 0;
+static int completed_uploads = 0;
+static int aborted_uploads = 0;
+static int fail_parts = 0; // reject part uploads
+
+static
+object_t* find_object(const char* name, int upload)
+{
+  int i;
+  for( i = 0; i < MAX_OBJECTS; i++ ) {
+    if( objects[i].name[0] && objects[i].upload == upload &&
+        strcmp(objects[i].name, name) == 0 )
+      return &objects[i];
+  }
+  return NULL;
+}
+
+static
+object_t* new_object(const char* name)
+{
+  int i;
+  for( i = 0; i < MAX_OBJECTS; i++ ) {
+    if( ! objects[i].name[0] ) {
+      memset(&objects[i], 0, sizeof(objects[i]));
+      strncpy(objects[i].name, name, sizeof(objects[i].name) - 1);
+      return &objects[i];
+    }
+  }
+  assert(0);
+  return NULL;
+}
+
+static
+void free_object(object_t* o)
+{
+  int i;
+  free(o->data);
+  for( i = 0; i < MAX_PARTS; i++ ) free(o->parts[i]);
+  memset(o, 0, sizeof(*o));
+}
+
+static
+void put_object(const char* name, char* data, int64_t len)
+{
+  object_t* o = find_object(name, 0);
+  if( o ) free_object(o);
+  o = new_object(name);
+  o->data = data;
+  o->len = len;
+}
+
+static
+void send_all(int fd, const char* p, int64_t len)
+{
+  while( len > 0 ) {
+    ssize_t got = send(fd, p, len, MSG_NOSIGNAL);
+    if( got <= 0 ) return;
+    p += got;
+    len -= got;
+  }
+}
+
+static
+void respond(int fd, int status, const char* extra, const char* body,
+             int64_t len, int head)
+{
+  char hdr[512];
+  int n = snprintf(hdr, sizeof(hdr),
+                   "HTTP/1.1 %d X\r\nContent-Length: %lld\r\n%s\r\n",
+                   status, (long long) len, extra ? extra : "");
+  send_all(fd, hdr, n);
+  if( ! head && len > 0 ) send_all(fd, body, len);
+}
+
+// Value of a query parameter, or NULL.
+static
+const char* query_param(const char* query, const char* name, char* buf,
+                        size_t cap)
+{
+  size_t nlen = strlen(name);
+  const char* p = query;
+  while( p && *p ) {
+    if( strncmp(p, name, nlen) == 0 && (p[nlen] == '=' || p[nlen] == '&' ||
+                                        p[nlen] == '\0') ) {
+      size_t i = 0;
+      if( p[nlen] == '=' ) {
+        p += nlen + 1;
+        while( *p && *p != '&' && i + 1 < cap ) buf[i++] = *p++;
+      }
+      buf[i] = '\0';
+      return buf;
+    }
+    p = strchr(p, '&');
+    if( p ) p++;
+  }
+  return NULL;
+}
+
+static
+void handle(int fd, const char* method, char* target, const char* range,
+            char* body, int64_t body_len)
+{
+  char* query = strchr(target, '?');
+  char val[64];
+  object_t* o;
+
+  if( query ) *query++ = '\0';
+
+  pthread_mutex_lock(&store_lock);
+
+  if( strcmp(method, "HEAD") == 0 || strcmp(method, "GET") == 0 ) {
+    int head = method[0] == 'H';
+    o = find_object(target, 0);
+    if( ! o ) {
+      pthread_mutex_unlock(&store_lock);
+      respond(fd, 404, NULL, "<Error>NoSuchKey</Error>", 24, head);
+      return;
+    }
+    if( range && ! head ) {
+      long long a = 0, b = 0;
+      char extra[128];
+      assert( sscanf(range, "bytes=%lld-%lld", &a, &b) == 2 );
+      if( a >= o->len ) {
+        pthread_mutex_unlock(&store_lock);
+        respond(fd, 416, NULL, NULL, 0, 0);
+        return;
+      }
+      if( b >= o->len ) b = o->len - 1;
+      active_gets++;
+      if( active_gets > max_active_gets ) max_active_gets = active_gets;
+      {
+        char* copy = malloc(b - a + 1);
+        memcpy(copy, o->data + a, b - a + 1);
+        pthread_mutex_unlock(&store_lock);
+        usleep(5000); // long enough for others to overlap
+        snprintf(extra, sizeof(extra),
+                 "Content-Range: bytes %lld-%lld/%lld\r\n",
+                 a, b, (long long) o->len);
+        respond(fd, 206, extra, copy, b - a + 1, 0);
+        free(copy);
+      }
+      pthread_mutex_lock(&store_lock);
+      active_gets--;
+      pthread_mutex_unlock(&store_lock);
+      return;
+    }
+    respond(fd, 200, NULL, o->data, o->len, head);
+  } else if( strcmp(method, "PUT") == 0 && ! query ) {
+    char* data = malloc(body_len + 1);
+    memcpy(data, body, body_len);
+    put_object(target, data, body_len);
+    respond(fd, 200, "ETag: \"whole\"\r\n", NULL, 0, 0);
+  } else if( strcmp(method, "POST") == 0 && query &&
+             query_param(query, "uploads", val, sizeof(val)) ) {
+    char xml[256];
+    o = new_object(target);
+    o->upload = next_upload++;
+    snprintf(xml, sizeof(xml),
+             "<InitiateMultipartUploadResult><UploadId>up+%d/x"
+             "</UploadId></InitiateMultipartUploadResult>", o->upload);
+    respond(fd, 200, NULL, xml, strlen(xml), 0);
+  } else if( strcmp(method, "PUT") == 0 && query ) {
+    char extra[64];
+    int part, id;
+    assert( query_param(query, "partNumber", val, sizeof(val)) );
+    part = atoi(val);
+    assert( query_param(query, "uploadId", val, sizeof(val)) );
+    // The ID has to arrive escaped.
+    assert( sscanf(val, "up%%2B%d%%2Fx", &id) == 1 );
+    o = find_object(target, id);
+    assert( o && part >= 1 && part <= MAX_PARTS );
+    if( fail_parts ) {
+      pthread_mutex_unlock(&store_lock);
+      respond(fd, 500, NULL, NULL, 0, 0);
+      return;
+    }
+    free(o->parts[part-1]);
+    o->parts[part-1] = malloc(body_len + 1);
+    memcpy(o->parts[part-1], body, body_len);
+    o->part_lens[part-1] = body_len;
+    snprintf(extra, sizeof(extra), "ETag: \"etag%d\"\r\n", part);
+    respond(fd, 200, extra, NULL, 0, 0);
+  } else if( (strcmp(method, "POST") == 0 || strcmp(method, "DELETE") == 0) &&
+             query ) {
+    int id, i, nparts = 0;
+    int64_t len = 0;
+    assert( query_param(query, "uploadId", val, sizeof(val)) );
+    assert( sscanf(val, "up%%2B%d%%2Fx", &id) == 1 );
+    o = find_object(target, id);
+    assert( o );
+    if( method[0] == 'D' ) {
+      free_object(o);
+      aborted_uploads++;
+      respond(fd, 204, NULL, NULL, 0, 0);
+    } else {
+      char* data;
+      body[body_len] = '\0';
+      while( nparts < MAX_PARTS && o->parts[nparts] ) {
+        char want[128];
+        snprintf(want, sizeof(want),
+                 "<Part><PartNumber>%d</PartNumber><ETag>\"etag%d\"</ETag></Part>",
+                 nparts + 1, nparts + 1);
+        assert( strstr(body, want) );
+        // every part but the last meets the minimum size
+        if( nparts > 0 ) assert( o->part_lens[nparts-1] >= QIO_S3_MIN_PART );
+        len += o->part_lens[nparts];
+        nparts++;
+      }
+      data = malloc(len + 1);
+      len = 0;
+      for( i = 0; i < nparts; i++ ) {
+        memcpy(data + len, o->parts[i], o->part_lens[i]);
+        len += o->part_lens[i];
+      }
+      free_object(o);
+      put_object(target, data, len);
+      completed_uploads++;
+      respond(fd, 200, NULL, "<CompleteMultipartUploadResult/>", 32, 0);
+    }
+  } else {
+    respond(fd, 400, NULL, NULL, 0, 0);
+  }
+
+  pthread_mutex_unlock(&store_lock);
+}
+
+static
+void* connection_thread(void* arg)
+{
+  int fd = (int) (intptr_t) arg;
+  char* buf = malloc(1 << 16);
+  int64_t have = 0;
+
+  while( 1 ) {
+    char* end;
+    char method[16], target[1024];
+    char* range = NULL;
+    char* cl;
+    int64_t hdr_len, body_len = 0;
+    char* body;
+
+    // Read the request headers.
+    buf[have] = '\0';
+    while( ! (end = strstr(buf, "\r\n\r\n")) ) {
+      ssize_t got = recv(fd, buf + have, (1 << 16) - 1 - have, 0);
+      if( got <= 0 ) goto done;
+      have += got;
+      buf[have] = '\0';
+    }
+    hdr_len = end + 4 - buf;
+    *end = '\0';
+
+    assert( sscanf(buf, "%15s %1023s", method, target) == 2 );
+    cl = strcasestr(buf, "\r\nContent-Length:");
+    if( cl ) body_len = atoll(cl + 17);
+    range = strcasestr(buf, "\r\nRange:");
+    if( range ) {
+      range += 8;
+      while( *range == ' ' ) range++;
+    }
+    assert( ! strcasestr(buf, "Transfer-Encoding") );
+
+    // Read the body.
+    body = malloc(body_len + 1);
+    {
+      int64_t from_buf = have - hdr_len;
+      if( from_buf > body_len ) from_buf = body_len;
+      memcpy(body, buf + hdr_len, from_buf);
+      while( from_buf < body_len ) {
+        ssize_t got = recv(fd, body + from_buf, body_len - from_buf, 0);
+        if( got <= 0 ) {
+          free(body);
+          goto done;
+        }
+        from_buf += got;
+      }
+      // keep anything after the body
+      if( have - hdr_len > body_len ) {
+        int64_t rest = have - hdr_len - body_len;
+        char range_copy[128];
+        if( range ) {
+          strncpy(range_copy, range, sizeof(range_copy) - 1);
+          range_copy[sizeof(range_copy) - 1] = '\0';
+          range = range_copy;
+        }
+        handle(fd, method, target, range, body, body_len);
+        memmove(buf, buf + hdr_len + body_len, rest);
+        have = rest;
+      } else {
+        handle(fd, method, target, range, body, body_len);
+        have = 0;
+      }
+    }
+    free(body);
+  }
+
+done:
+  close(fd);
+  free(buf);
+  return NULL;
+}
+
+static
+void* server_thread(void* arg)
+{
+  int lfd = (int) (intptr_t) arg;
+  while( 1 ) {
+    pthread_t t;
+    int fd = accept(lfd, NULL, NULL);
+    if( fd < 0 ) continue;
+    pthread_create(&t, NULL, connection_thread, (void*) (intptr_t) fd);
+    pthread_detach(t);
+  }
+  return NULL;
+}
+
+static char endpoint[64];
+
+static
+void start_server(void)
+{
+  struct sockaddr_in addr;
+  socklen_t len = sizeof(addr);
+  pthread_t t;
+  int lfd = socket(AF_INET, SOCK_STREAM, 0);
+
+  assert( lfd >= 0 );
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  assert( bind(lfd, (struct sockaddr*) &addr, sizeof(addr)) == 0 );
+  assert( listen(lfd, 64) == 0 );
+  assert( getsockname(lfd, (struct sockaddr*) &addr, &len) == 0 );
+  snprintf(endpoint, sizeof(endpoint), "http://127.0.0.1:%d",
+           (int) ntohs(addr.sin_port));
+  pthread_create(&t, NULL, server_thread, (void*) (intptr_t) lfd);
+  pthread_detach(t);
+}
+
+static
+char data_byte(int64_t i)
+{
+  return (char) ((i * 7 + (i >> 8)) & 0xff);
+}
+
+static
+void write_object(const char* path, int64_t len, int64_t chunk)
+{
+  qio_file_t* f;
+  qio_channel_t* ch;
+  char* buf;
+  int64_t i, off, flen = -1;
+  qioerr err;
+
+  buf = qio_malloc(len + 1);
+  for( i = 0; i < len; i++ ) buf[i] = data_byte(i);
+
+  err = qio_file_open_s3(&f, path, endpoint, QIO_FDFLAG_WRITEABLE, 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&ch, f, 0, 0, 1, 0, INT64_MAX, NULL);
+  assert(!err);
+  for( off = 0; off < len; off += chunk ) {
+    int64_t n = len - off < chunk ? len - off : chunk;
+    err = qio_channel_write_amt(1, ch, buf + off, n);
+    assert(!err);
+  }
+  err = qio_channel_close(1, ch);
+  assert(!err);
+  qio_channel_release(ch);
+
+  err = qio_file_length(f, &flen);
+  assert(!err);
+  assert( flen == len );
+  qio_file_release(f);
+  qio_free(buf);
+}
+
+static
+void check_range(qio_file_t* f, qio_hint_t hints, int64_t start, int64_t end,
+                 int64_t len)
+{
+  qio_channel_t* ch;
+  qioerr err;
+  char* buf;
+  ssize_t amt = 0;
+  int64_t expect, i;
+
+  expect = (end < len ? end : len) - start;
+  if( expect < 0 ) expect = 0;
+
+  err = qio_channel_create(&ch, f, hints, 1, 0, start, end, NULL);
+  assert(!err);
+  buf = qio_malloc(expect + 1);
+  err = qio_channel_read(1, ch, buf, expect + 1, &amt);
+  assert( amt == expect );
+  assert( qio_err_to_int(err) == EEOF );
+  for( i = 0; i < expect; i++ ) {
+    assert( buf[i] == data_byte(start + i) );
+  }
+  qio_channel_release(ch);
+  qio_free(buf);
+}
+
+static
+void check(int64_t len)
+{
+  qio_file_t* f;
+  int64_t flen = -1;
+  const char* path = NULL;
+  qioerr err;
+  int uploads = completed_uploads;
+
+  if( verbose ) printf("len=%lli\n", (long long) len);
+
+  write_object("s3://bucket/dir/my object", len, 100000);
+  // Objects smaller than a part are written with one PUT.
+  if( len >= QIO_S3_DEFAULT_CHUNK ) assert( completed_uploads == uploads + 1 );
+  else assert( completed_uploads == uploads );
+
+  err = qio_file_open_s3(&f, "bucket/dir/my object", endpoint,
+                         QIO_FDFLAG_READABLE, 0, NULL);
+  assert(!err);
+  err = qio_file_length(f, &flen);
+  assert(!err);
+  assert( flen == len );
+  err = qio_file_path(f, &path);
+  assert(!err);
+  assert( strcmp(path, "s3://bucket/dir/my object") == 0 );
+  qio_free((void*) path);
+
+  max_active_gets = 0;
+  check_range(f, QIO_HINT_SEQUENTIAL, 0, INT64_MAX, len);
+  if( len > 2 * QIO_S3_DEFAULT_CHUNK ) assert( max_active_gets > 1 );
+  check_range(f, 0, len / 3, INT64_MAX, len);
+  check_range(f, QIO_HINT_PARALLEL, len / 3, len / 2 + 1, len);
+  check_range(f, 0, len, INT64_MAX, len);
+
+  // Reading channels at different parts of the object at once.
+  if( len > 10 ) {
+    qio_channel_t* a;
+    qio_channel_t* b;
+    int64_t i, n = len / 2 < 300000 ? len / 2 : 300000;
+
+    err = qio_channel_create(&a, f, 0, 1, 0, 0, INT64_MAX, NULL);
+    assert(!err);
+    err = qio_channel_create(&b, f, 0, 1, 0, len / 2, INT64_MAX, NULL);
+    assert(!err);
+    for( i = 0; i < n; i++ ) {
+      assert( qio_channel_read_byte(1, a) == (uint8_t) data_byte(i) );
+      assert( qio_channel_read_byte(1, b) == (uint8_t) data_byte(len/2 + i) );
+    }
+    qio_channel_release(a);
+    qio_channel_release(b);
+  }
+
+  qio_file_release(f);
+}
+
+static
+void check_errors(void)
+{
+  qio_file_t* f;
+  qio_channel_t* a;
+  qio_channel_t* b;
+  qioerr err;
+  int aborted = aborted_uploads;
+
+  // No such object
+  err = qio_file_open_s3(&f, "s3://bucket/missing", endpoint,
+                         QIO_FDFLAG_READABLE, 0, NULL);
+  assert( qio_err_to_int(err) == ENOENT );
+
+  // Bad paths
+  err = qio_file_open_s3(&f, "s3://bucket", endpoint,
+                         QIO_FDFLAG_READABLE, 0, NULL);
+  assert( qio_err_to_int(err) == EINVAL );
+  err = qio_file_open_s3(&f, "s3://bucket/x", endpoint,
+                         QIO_FDFLAG_READABLE|QIO_FDFLAG_WRITEABLE, 0, NULL);
+  assert( qio_err_to_int(err) == EINVAL );
+
+  // One writer from the start only
+  err = qio_file_open_s3(&f, "s3://bucket/w", endpoint,
+                         QIO_FDFLAG_WRITEABLE, 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&a, f, 0, 1, 0, 0, INT64_MAX, NULL);
+  assert( err );
+  err = qio_channel_create(&a, f, 0, 0, 1, 10, INT64_MAX, NULL);
+  assert( qio_err_to_int(err) == ESPIPE );
+  err = qio_channel_create(&a, f, 0, 0, 1, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_create(&b, f, 0, 0, 1, 0, INT64_MAX, NULL);
+  assert( qio_err_to_int(err) == ESPIPE );
+
+  // A failed part aborts the upload and is reported at close.
+  fail_parts = 1;
+  {
+    int64_t len = 2 * QIO_S3_DEFAULT_CHUNK + 5;
+    char* buf = qio_calloc(len, 1);
+    err = qio_channel_write_amt(1, a, buf, len);
+    qio_free(buf);
+  }
+  err = qio_channel_close(1, a);
+  assert( qio_err_to_int(err) == EIO );
+  qio_channel_release(a);
+  qio_file_release(f);
+  fail_parts = 0;
+  assert( aborted_uploads == aborted + 1 );
+
+  pthread_mutex_lock(&store_lock);
+  assert( ! find_object("/bucket/w", 0) );
+  pthread_mutex_unlock(&store_lock);
+}
+
+int main(int argc, char** argv)
+{
+  int64_t lens[] = { 0, 1, 100000, QIO_S3_DEFAULT_CHUNK,
+                     2 * QIO_S3_DEFAULT_CHUNK + 3 * 100000 + 17 };
+  int nlens = sizeof(lens)/sizeof(lens[0]);
+  int l;
+
+  if( argc > 1 ) verbose = 1;
+
+  unsetenv("AWS_ACCESS_KEY_ID");
+  start_server();
+
+  for( l = 0; l < nlens; l++ ) check(lens[l]);
+
+  check_errors();
+
+  printf("qio_s3_test PASS\n");
+  return 0;
+}
@@ -0,0 +1,111 @@
+#include "qio.h"
+#include "qio_formatted.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <inttypes.h>
+
+// Scan many numbers from one channel so that most of them are parsed
+// in place in the channel's buffer and some of them straddle buffer
+// boundaries. Check the results against strtoll and strtod.
+
+#define NNUMS 200000
+
+static uint64_t seed = 12345;
+
+static
+uint64_t next_random(void)
+{
+  seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return seed >> 11;
+}
+
+static
+void make_int(char* s, size_t len)
+{
+  int64_t v;
+  switch( next_random() % 4 ) {
+    case 0: v = next_random() % 100; break;
+    case 1: v = (int64_t) (next_random() % 2000000) - 1000000; break;
+    case 2: v = (int64_t) (next_random() << 11); break;
+    default: v = - (int64_t) (next_random() % INT64_MAX); break;
+  }
+  if( next_random() % 8 == 0 ) snprintf(s, len, "+%" PRId64, v < 0 ? -v : v);
+  else snprintf(s, len, "%" PRId64, v);
+}
+
+static
+void make_float(char* s, size_t len)
+{
+  double d = (double) next_random() / (double) (1ULL << 40);
+  if( next_random() % 2 ) d = -d;
+  switch( next_random() % 6 ) {
+    case 0: snprintf(s, len, "%.17g", d); break;
+    case 1: snprintf(s, len, "%.6f", d); break;
+    case 2: snprintf(s, len, "%.3e", d * 1e10); break;
+    case 3: snprintf(s, len, "%.2f", d * 100); break;
+    case 4: snprintf(s, len, "%g", d / 1e30); break;
+    default: snprintf(s, len, "%d", (int) (next_random() % 1000)); break;
+  }
+}
+
+static
+void check_scan(int floats)
+{
+  qio_file_t* f;
+  qio_channel_t* writing;
+  qio_channel_t* reading;
+  char (*strs)[64];
+  qioerr err;
+  int i;
+
+  strs = qio_malloc(NNUMS * sizeof(*strs));
+  assert(strs);
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+
+  err = qio_channel_create(&writing, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, NULL);
+  assert(!err);
+  for( i = 0; i < NNUMS; i++ ) {
+    if( floats ) make_float(strs[i], sizeof(strs[i]));
+    else make_int(strs[i], sizeof(strs[i]));
+    err = qio_channel_write_amt(true, writing, strs[i], strlen(strs[i]));
+    assert(!err);
+    err = qio_channel_write_amt(true, writing, (i % 10 == 9) ? "\n" : " ", 1);
+    assert(!err);
+  }
+  qio_channel_release(writing);
+
+  err = qio_channel_create(&reading, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+  for( i = 0; i < NNUMS; i++ ) {
+    if( floats ) {
+      double got = 0.0;
+      double expect = strtod(strs[i], NULL);
+      err = qio_channel_scan_float(true, reading, &got, 8);
+      assert(!err);
+      assert(memcmp(&got, &expect, sizeof(double)) == 0);
+    } else {
+      int64_t got = 0;
+      int64_t expect = strtoll(strs[i], NULL, 10);
+      err = qio_channel_scan_int(true, reading, &got, 8, 1);
+      assert(!err);
+      assert(got == expect);
+    }
+  }
+  qio_channel_release(reading);
+
+  qio_file_release(f);
+  qio_free(strs);
+}
+
+int main(int argc, char** argv)
+{
+  check_scan(0);
+  check_scan(1);
+
+  printf("qio_scan_test PASS\n");
+  return 0;
+}
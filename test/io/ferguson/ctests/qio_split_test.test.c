@@ -0,0 +1,207 @@
+#include "qio.h"
+#include "qio_split.h"
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+
+int verbose = 0;
+
+// This test only splits on a delimiter byte, so it doesn't link in a
+// regexp library.
+qioerr qio_regexp_channel_match(const qio_regexp_t* regexp, const int threadsafe, struct qio_channel_s* ch, int64_t maxlen, int anchor, qio_bool can_discard, qio_bool keep_unmatched, qio_bool keep_whole_pattern, qio_regexp_string_piece_t* submatch, int64_t nsubmatch)
+{
+  QIO_RETURN_CONSTANT_ERROR(ENOSYS, "no regexp support in this test");
+}
+
+// Write a file of newline-terminated records of varying length
+// (and, if unterminated, a last record with no newline).
+static
+void make_file(qio_file_t** f_out, int nrecords, int unterminated,
+               char** data_out, int64_t* len_out)
+{
+  qio_file_t* f;
+  qio_channel_t* ch;
+  qioerr err;
+  char* data;
+  int64_t len = 0;
+  int i, j;
+
+  data = qio_malloc(nrecords * 100 + 100);
+  for( i = 0; i < nrecords; i++ ) {
+    int reclen = (i * 37) % 97; // includes some empty records
+    for( j = 0; j < reclen; j++ ) data[len++] = 'a' + (i + j) % 26;
+    if( i < nrecords - 1 || ! unterminated ) data[len++] = '\n';
+  }
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&ch, f, 0, 0, 1, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_write_amt(1, ch, data, len);
+  assert(!err);
+  qio_channel_release(ch);
+
+  *f_out = f;
+  *data_out = data;
+  *len_out = len;
+}
+
+static
+void check_split(int nrecords, int unterminated, int64_t nranges)
+{
+  qio_file_t* f;
+  qio_channel_t* chs[64];
+  int64_t bounds[65];
+  char* data;
+  char* got;
+  int64_t len;
+  int64_t i;
+  qioerr err;
+
+  if( verbose ) {
+    printf("check_split(nrecords=%i, unterminated=%i, nranges=%i)\n",
+           nrecords, unterminated, (int) nranges);
+  }
+
+  make_file(&f, nrecords, unterminated, &data, &len);
+
+  err = qio_file_split_records(f, 0, -1, nranges, '\n', NULL, bounds);
+  assert(!err);
+
+  assert(bounds[0] == 0);
+  assert(bounds[nranges] == len);
+  for( i = 1; i < nranges; i++ ) {
+    assert(bounds[i] >= bounds[i-1]);
+    // Each boundary starts a record.
+    assert(bounds[i] == 0 || bounds[i] == len || data[bounds[i]-1] == '\n');
+  }
+
+  // Reading all of the ranges gives back the file.
+  err = qio_file_open_split_channels(f, 0, 1, 0, nranges, bounds, NULL, chs);
+  assert(!err);
+
+  got = qio_malloc(len + 1);
+  for( i = 0; i < nranges; i++ ) {
+    ssize_t amt = 0;
+    int64_t want = bounds[i+1] - bounds[i];
+    err = qio_channel_read(1, chs[i], got + bounds[i], want + 1, &amt);
+    assert(amt == want);
+    assert(qio_err_to_int(err) == EEOF || (want == 0 && !err));
+    qio_channel_release(chs[i]);
+  }
+  assert(0 == memcmp(got, data, len));
+
+  qio_free(got);
+  qio_free(data);
+  qio_file_release(f);
+}
+
+static
+void check_split_locales(int nrecords, int64_t nlocales)
+{
+  qio_file_t* f;
+  int64_t bounds[65];
+  int64_t chunk = 1;
+  char* data;
+  int64_t len;
+  int64_t i;
+  qioerr err;
+
+  if( verbose ) printf("split locales nrecords=%i nlocales=%i\n",
+                       nrecords, (int) nlocales);
+
+  make_file(&f, nrecords, 0, &data, &len);
+
+  err = qio_get_chunk(f, &chunk);
+  if( err || chunk < 1 ) chunk = 1;
+
+  err = qio_file_split_locales(f, 0, -1, nlocales, bounds);
+  assert(!err);
+
+  assert( bounds[0] == 0 );
+  assert( bounds[nlocales] == len );
+  for( i = 1; i < nlocales; i++ ) {
+    assert( bounds[i-1] <= bounds[i] );
+    assert( bounds[i] <= len );
+    // interior boundaries land on chunks unless clamped to the end
+    assert( bounds[i] % chunk == 0 || bounds[i] == len );
+  }
+
+  qio_free(data);
+  qio_file_release(f);
+}
+
+static
+void check_open_shared_region(void)
+{
+  const char* path = "qio_split_test.tmp";
+  qio_file_t* f;
+  qio_file_t* copy;
+  qio_channel_t* ch;
+  qioerr err;
+  int shared = -1;
+
+  err = qio_file_open_access(&f, path, "w+", 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&ch, f, 0, 0, 1, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_write_amt(1, ch, "abcdefgh", 8);
+  assert(!err);
+  qio_channel_release(ch);
+
+  err = qio_file_is_shared_fs(f, &shared);
+  assert(!err);
+  assert( shared == 0 || shared == 1 );
+
+  err = qio_file_open_shared_region(&copy, path, 2, 6, QIO_HINT_CACHED, NULL);
+  if( shared ) {
+    char buf[4];
+    assert(!err);
+    err = qio_channel_create(&ch, copy, 0, 1, 0, 2, 6, NULL);
+    assert(!err);
+    err = qio_channel_read_amt(1, ch, buf, 4);
+    assert(!err);
+    assert( memcmp(buf, "cdef", 4) == 0 );
+    qio_channel_release(ch);
+    qio_file_release(copy);
+  } else {
+    // A local file might not be the same one on other nodes.
+    assert( qio_err_to_int(err) == ENOTSUP );
+    assert( copy == NULL );
+  }
+
+  err = qio_file_open_shared_region(&copy, path, 6, 2, 0, NULL);
+  assert( qio_err_to_int(err) == EINVAL );
+
+  qio_file_release(f);
+  unlink(path);
+}
+
+int main(int argc, char** argv)
+{
+  int nrecords[] = {1, 2, 10, 1000, 20000};
+  int64_t nranges[] = {1, 2, 3, 7, 64};
+  int i, j, u;
+
+  if( argc != 1 ) verbose = 1;
+
+  for( i = 0; i < sizeof(nrecords)/sizeof(nrecords[0]); i++ ) {
+    for( j = 0; j < sizeof(nranges)/sizeof(nranges[0]); j++ ) {
+      for( u = 0; u < 2; u++ ) {
+        check_split(nrecords[i], u, nranges[j]);
+      }
+    }
+  }
+
+  for( i = 0; i < sizeof(nrecords)/sizeof(nrecords[0]); i++ ) {
+    for( j = 0; j < sizeof(nranges)/sizeof(nranges[0]); j++ ) {
+      check_split_locales(nrecords[i], nranges[j]);
+    }
+  }
+
+  check_open_shared_region();
+
+  printf("qio_split_test PASS\n");
+  return 0;
+}
@@ -0,0 +1,133 @@
+#include "qio.h"
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+
+int verbose = 0;
+
+#define LEN (3*1024*1024 + 5)
+
+static
+void check_method(qio_hint_t hints, int on)
+{
+  qio_file_t* f;
+  qio_channel_t* ch;
+  qio_io_stats_t s, fs, g0, g1;
+  char* buf;
+  qioerr err;
+  int i;
+
+  if( verbose ) printf("hints=%x stats=%i\n", (int) hints, on);
+
+  qio_stats_enable(on);
+  qio_stats_get_global(&g0);
+
+  buf = qio_malloc(LEN);
+  for( i = 0; i < LEN; i++ ) buf[i] = 'a' + i % 26;
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+
+  // Write it.
+  err = qio_channel_create(&ch, f, hints, 0, 1, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_write_amt(1, ch, buf, LEN);
+  assert(!err);
+  err = qio_channel_flush(1, ch);
+  assert(!err);
+  err = qio_channel_get_stats(1, ch, &s);
+  assert(!err);
+  if( on ) {
+    if( (hints & QIO_METHODMASK) == QIO_METHOD_MMAP ) {
+      assert( s.mmaps > 0 );
+      assert( s.mmap_bytes >= LEN );
+    } else {
+      assert( s.bytes_written == LEN );
+      assert( s.write_calls > 0 );
+      assert( s.write_ns >= 0 );
+    }
+    if( (hints & QIO_CHTYPEMASK) != QIO_CH_ALWAYS_UNBUFFERED ) {
+      assert( s.flushes > 0 );
+    }
+    assert( s.bytes_read == 0 );
+  } else {
+    assert( s.bytes_written == 0 && s.write_calls == 0 && s.mmaps == 0 );
+  }
+  qio_channel_release(ch);
+
+  // Read it back (rewinding for READWRITE).
+  memset(buf, 0, LEN);
+  lseek(f->fd, 0, SEEK_SET);
+  err = qio_channel_create(&ch, f, hints, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_read_amt(1, ch, buf, LEN);
+  assert(!err);
+  for( i = 0; i < LEN; i++ ) assert( buf[i] == 'a' + i % 26 );
+  err = qio_channel_get_stats(1, ch, &s);
+  assert(!err);
+  if( on ) {
+    if( (hints & QIO_METHODMASK) == QIO_METHOD_MMAP ) {
+      assert( s.mmaps > 0 );
+    } else {
+      assert( s.bytes_read == LEN );
+      assert( s.read_calls > 0 );
+      if( (hints & QIO_CHTYPEMASK) != QIO_CH_ALWAYS_UNBUFFERED ) {
+        assert( s.refills > 0 );
+      }
+    }
+    assert( s.bytes_written == 0 );
+  } else {
+    assert( s.bytes_read == 0 && s.read_calls == 0 && s.refills == 0 );
+  }
+  qio_channel_release(ch);
+
+  // The file has both channels' counts, and so do the totals.
+  qio_file_get_stats(f, &fs);
+  qio_stats_get_global(&g1);
+  if( verbose ) printf("file read %lli written %lli\n", (long long) fs.bytes_read, (long long) fs.bytes_written);
+  if( on ) {
+    if( (hints & QIO_METHODMASK) != QIO_METHOD_MMAP ) {
+      assert( fs.bytes_read == LEN );
+      assert( fs.bytes_written == LEN );
+      assert( g1.bytes_read - g0.bytes_read == LEN );
+      assert( g1.bytes_written - g0.bytes_written == LEN );
+    }
+    assert( g1.read_calls - g0.read_calls == fs.read_calls );
+    assert( g1.write_calls - g0.write_calls == fs.write_calls );
+  } else {
+    assert( fs.bytes_read == 0 && fs.bytes_written == 0 );
+    assert( g1.bytes_read == g0.bytes_read );
+  }
+
+  qio_file_release(f);
+  qio_free(buf);
+}
+
+int main(int argc, char** argv)
+{
+  qio_hint_t hints[] = {
+    QIO_METHOD_READWRITE,
+    QIO_METHOD_PREADPWRITE,
+    QIO_METHOD_MMAP,
+    QIO_CH_ALWAYS_UNBUFFERED | QIO_METHOD_PREADPWRITE,
+    QIO_METHOD_PREADPWRITE | QIO_HINT_SEQUENTIAL,
+  };
+  int i, on;
+
+  if( argc > 1 ) verbose = 1;
+
+  for( on = 0; on < 2; on++ ) {
+    for( i = 0; i < sizeof(hints)/sizeof(hints[0]); i++ ) {
+      check_method(hints[i], on);
+    }
+  }
+
+  if( verbose ) qio_stats_print(stdout);
+
+  // Don't print the summary at exit.
+  qio_stats_enable(0);
+
+  printf("qio_stats_test PASS\n");
+  return 0;
+}
@@ -0,0 +1,271 @@
+#include "qio.h"
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+
+int verbose = 0;
+
+static
+char data_byte(int64_t i)
+{
+  return (char) ((i * 7 + (i >> 8)) & 0xff);
+}
+
+static
+void make_file(qio_file_t** f_out, qio_hint_t hints, int64_t len)
+{
+  qio_file_t* f;
+  qio_channel_t* ch;
+  qioerr err;
+  char* buf;
+  int64_t i;
+
+  buf = qio_malloc(len + 1);
+  for( i = 0; i < len; i++ ) buf[i] = data_byte(i);
+
+  err = qio_file_open_tmp(&f, hints, NULL);
+  assert(!err);
+  // Write with pwrite to leave the fd offset at 0 for READWRITE readers.
+  err = qio_channel_create(&ch, f, QIO_METHOD_PREADPWRITE, 0, 1, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_write_amt(1, ch, buf, len);
+  assert(!err);
+  qio_channel_release(ch);
+  qio_free(buf);
+
+  *f_out = f;
+}
+
+static
+void check_contents(qio_file_t* f, int64_t skip, int64_t len)
+{
+  qio_channel_t* ch;
+  qioerr err;
+  char* buf;
+  ssize_t amt = 0;
+  int64_t i;
+
+  // Use pread so that we don't depend on the fd offset.
+  err = qio_channel_create(&ch, f, f->fd == -1 ? 0 : QIO_METHOD_PREADPWRITE,
+                           1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+  buf = qio_malloc(len + 1);
+  err = qio_channel_read(1, ch, buf, len + 1, &amt);
+  assert( amt == len );
+  for( i = 0; i < len; i++ ) {
+    assert( buf[i] == data_byte(skip + i) );
+  }
+  qio_channel_release(ch);
+  qio_free(buf);
+}
+
+// Copy len bytes of a file with skip bytes read before the
+// transfer (so some of it comes from the source buffer).
+static
+void check_file_to_file(qio_hint_t src_hints, qio_hint_t dst_hints,
+                        int64_t filelen, int64_t skip, int64_t len)
+{
+  qio_file_t* src_f;
+  qio_file_t* dst_f;
+  qio_channel_t* src;
+  qio_channel_t* dst;
+  int64_t expect, amt, i;
+  qioerr err;
+
+  if( verbose ) {
+    printf("file to file src_hints=%x dst_hints=%x filelen=%lli skip=%lli len=%lli\n",
+           (int) src_hints, (int) dst_hints,
+           (long long) filelen, (long long) skip, (long long) len);
+  }
+
+  make_file(&src_f, src_hints, filelen);
+  err = qio_file_open_tmp(&dst_f, dst_hints, NULL);
+  assert(!err);
+
+  err = qio_channel_create(&src, src_f, src_hints, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_create(&dst, dst_f, dst_hints, 0, 1, 0, INT64_MAX, NULL);
+  assert(!err);
+
+  for( i = 0; i < skip; i++ ) {
+    assert( qio_channel_read_byte(1, src) == (uint8_t) data_byte(i) );
+  }
+
+  expect = filelen - skip;
+  if( len >= 0 && len < expect ) expect = len;
+
+  err = qio_channel_transfer(1, dst, src, len, &amt);
+  assert( amt == expect );
+  if( len >= 0 && len > filelen - skip ) assert( qio_err_to_int(err) == EEOF );
+  else assert( !err );
+
+  // The source should be positioned after the transferred data.
+  if( skip + expect < filelen ) {
+    assert( qio_channel_read_byte(1, src) == (uint8_t) data_byte(skip + expect) );
+  } else {
+    assert( qio_channel_read_byte(1, src) == -EEOF );
+  }
+
+  // The destination should be positioned after it too.
+  {
+    int64_t off = -1;
+    err = qio_channel_offset(1, dst, &off);
+    assert(!err);
+    assert( off == expect );
+  }
+
+  qio_channel_release(src);
+  err = qio_channel_close(1, dst);
+  assert(!err);
+  qio_channel_release(dst);
+
+  check_contents(dst_f, skip, expect);
+
+  qio_file_release(src_f);
+  qio_file_release(dst_f);
+}
+
+// Transfer into a pipe and back out of it.
+static
+void check_pipe(qio_hint_t hints, int64_t len)
+{
+  qio_file_t* src_f;
+  qio_file_t* pipe_w_f;
+  qio_file_t* pipe_r_f;
+  qio_file_t* dst_f;
+  qio_channel_t* src;
+  qio_channel_t* pw;
+  qio_channel_t* pr;
+  qio_channel_t* dst;
+  int64_t amt;
+  int fds[2];
+  qioerr err;
+
+  if( verbose ) printf("pipe hints=%x len=%lli\n", (int) hints, (long long) len);
+
+  assert( pipe(fds) == 0 );
+
+  make_file(&src_f, 0, len);
+  err = qio_file_init(&pipe_r_f, NULL, fds[0], hints | QIO_HINT_OWNED, NULL, 0);
+  assert(!err);
+  err = qio_file_init(&pipe_w_f, NULL, fds[1], hints | QIO_HINT_OWNED, NULL, 0);
+  assert(!err);
+  err = qio_file_open_tmp(&dst_f, 0, NULL);
+  assert(!err);
+
+  err = qio_channel_create(&src, src_f, 0, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_create(&pw, pipe_w_f, hints, 0, 1, 0, INT64_MAX, NULL);
+  assert(!err);
+
+  // file -> pipe
+  err = qio_channel_transfer(1, pw, src, -1, &amt);
+  assert(!err);
+  assert( amt == len );
+  qio_channel_release(src);
+  err = qio_channel_close(1, pw);
+  assert(!err);
+  qio_channel_release(pw);
+  err = qio_file_close(pipe_w_f);
+  assert(!err);
+
+  // pipe -> file
+  err = qio_channel_create(&pr, pipe_r_f, hints, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_create(&dst, dst_f, 0, 0, 1, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_transfer(1, dst, pr, -1, &amt);
+  assert(!err);
+  assert( amt == len );
+  assert( qio_channel_read_byte(1, pr) == -EEOF );
+  qio_channel_release(pr);
+  err = qio_channel_close(1, dst);
+  assert(!err);
+  qio_channel_release(dst);
+
+  check_contents(dst_f, 0, len);
+
+  qio_file_release(src_f);
+  qio_file_release(pipe_w_f);
+  qio_file_release(pipe_r_f);
+  qio_file_release(dst_f);
+}
+
+// Transfer from a file into a memory file, which always uses the
+// buffer-sharing path.
+static
+void check_to_memory(int64_t len)
+{
+  qio_file_t* src_f;
+  qio_file_t* dst_f;
+  qio_channel_t* src;
+  qio_channel_t* dst;
+  int64_t amt;
+  qioerr err;
+
+  if( verbose ) printf("to memory len=%lli\n", (long long) len);
+
+  make_file(&src_f, 0, len);
+  err = qio_file_open_mem(&dst_f, NULL, NULL);
+  assert(!err);
+
+  err = qio_channel_create(&src, src_f, 0, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_create(&dst, dst_f, 0, 0, 1, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_transfer(1, dst, src, -1, &amt);
+  assert(!err);
+  assert( amt == len );
+  qio_channel_release(src);
+  err = qio_channel_close(1, dst);
+  assert(!err);
+  qio_channel_release(dst);
+
+  check_contents(dst_f, 0, len);
+
+  qio_file_release(src_f);
+  qio_file_release(dst_f);
+}
+
+int main(int argc, char** argv)
+{
+  qio_hint_t hints[] = {
+    0,
+    QIO_METHOD_READWRITE,
+    QIO_METHOD_PREADPWRITE,
+    QIO_METHOD_MMAP,
+    QIO_METHOD_PREADPWRITE | QIO_HINT_NOFAST,
+    QIO_CH_ALWAYS_UNBUFFERED | QIO_METHOD_PREADPWRITE,
+  };
+  int nhints = sizeof(hints)/sizeof(hints[0]);
+  int64_t lens[] = { 0, 1, 100, 4096, 100000, 300000 + 17 };
+  int nlens = sizeof(lens)/sizeof(lens[0]);
+  int s, d, l;
+
+  if( argc > 1 ) verbose = 1;
+
+  for( s = 0; s < nhints; s++ ) {
+    for( d = 0; d < nhints; d++ ) {
+      for( l = 0; l < nlens; l++ ) {
+        int64_t len = lens[l];
+        check_file_to_file(hints[s], hints[d], len, 0, -1);
+        check_file_to_file(hints[s], hints[d], len, 0, len / 2);
+        check_file_to_file(hints[s], hints[d], len, len / 3, -1);
+        check_file_to_file(hints[s], hints[d], len, len / 3, len / 3);
+        check_file_to_file(hints[s], hints[d], len, len / 3, len);
+      }
+    }
+  }
+
+  check_pipe(0, 0);
+  check_pipe(0, 1000);
+  check_pipe(0, 50000);
+  check_pipe(QIO_METHOD_READWRITE | QIO_HINT_NOFAST, 50000);
+
+  check_to_memory(0);
+  check_to_memory(100000);
+
+  printf("qio_transfer_test PASS\n");
+  return 0;
+}
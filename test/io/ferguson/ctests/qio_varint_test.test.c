@@ -0,0 +1,217 @@
+#include "qio_formatted.h"
+#include <assert.h>
+
+int verbose = 0;
+
+#define NVALS 1000
+
+static uint64_t uvals[NVALS];
+static int64_t svals[NVALS];
+
+static void fill_values(void)
+{
+  uint64_t x = 0x9e3779b97f4a7c15ULL;
+  int i;
+
+  for( i = 0; i < NVALS; i++ ) {
+    // Cover every varint length, from 1 to 10 bytes.
+    int shift = (i % 10) * 7;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    uvals[i] = (i % 10 == 9) ? x : (x & ((1ULL << (shift + 7)) - 1));
+    svals[i] = (i % 2) ? -(int64_t) (uvals[i] >> 1) : (int64_t) (uvals[i] >> 1);
+  }
+  uvals[0] = 0;
+  uvals[1] = UINT64_MAX;
+  svals[0] = INT64_MIN;
+  svals[1] = INT64_MAX;
+}
+
+// Write the values in one call, read them back one at a time, and the
+// other way around.  Both have to agree on the encoding.
+static void test_varints(int batch_write)
+{
+  qioerr err;
+  qio_file_t* f;
+  qio_channel_t* writing;
+  qio_channel_t* reading;
+  uint64_t ugot[NVALS];
+  int64_t sgot[NVALS];
+  int i;
+
+  if( verbose ) printf("Testing varints batch_write=%i\n", batch_write);
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+
+  err = qio_channel_create(&writing, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, NULL);
+  assert(!err);
+
+  if( batch_write ) {
+    err = qio_channel_write_uvarints(true, writing, uvals, NVALS);
+    assert(!err);
+    err = qio_channel_write_svarints(true, writing, svals, NVALS);
+    assert(!err);
+  } else {
+    for( i = 0; i < NVALS; i++ ) {
+      err = qio_channel_write_uvarint(true, writing, uvals[i]);
+      assert(!err);
+    }
+    for( i = 0; i < NVALS; i++ ) {
+      err = qio_channel_write_svarint(true, writing, svals[i]);
+      assert(!err);
+    }
+  }
+
+  qio_channel_release(writing);
+
+  err = qio_channel_create(&reading, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+
+  memset(ugot, 0, sizeof(ugot));
+  memset(sgot, 0, sizeof(sgot));
+
+  if( batch_write ) {
+    for( i = 0; i < NVALS; i++ ) {
+      err = qio_channel_read_uvarint(true, reading, &ugot[i]);
+      assert(!err);
+    }
+    for( i = 0; i < NVALS; i++ ) {
+      err = qio_channel_read_svarint(true, reading, &sgot[i]);
+      assert(!err);
+    }
+  } else {
+    err = qio_channel_read_uvarints(true, reading, ugot, NVALS);
+    assert(!err);
+    err = qio_channel_read_svarints(true, reading, sgot, NVALS);
+    assert(!err);
+  }
+
+  for( i = 0; i < NVALS; i++ ) {
+    assert( ugot[i] == uvals[i] );
+    assert( sgot[i] == svals[i] );
+  }
+
+  // There's nothing left, so reading more is EOF.
+  err = qio_channel_read_uvarints(true, reading, ugot, 1);
+  assert( qio_err_to_int(err) == EEOF );
+
+  qio_channel_release(reading);
+  qio_file_release(f);
+}
+
+// Write integer arrays in each byte order and check the bytes.
+static void test_ints(int b_order)
+{
+  qioerr err;
+  qio_file_t* f;
+  qio_channel_t* writing;
+  qio_channel_t* reading;
+  uint8_t a8[3] = {0x01, 0x02, 0x03};
+  uint16_t a16[3] = {0x0102, 0x0304, 0x0506};
+  uint32_t a32[3] = {0x01020304, 0x05060708, 0x090a0b0c};
+  uint64_t a64[3] = {0x0102030405060708ULL, 0x1112131415161718ULL,
+                     0x2122232425262728ULL};
+  uint8_t g8[3];
+  uint16_t g16[3];
+  uint32_t g32[3];
+  uint64_t g64[3];
+  uint8_t bytes[2*3 + 4*3 + 8*3];
+  int i;
+
+  if( verbose ) printf("Testing int arrays b_order=%i\n", b_order);
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+
+  err = qio_channel_create(&writing, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_write_ints(true, b_order, writing, a8, 1, 3);
+  assert(!err);
+  err = qio_channel_write_ints(true, b_order, writing, a16, 2, 3);
+  assert(!err);
+  err = qio_channel_write_ints(true, b_order, writing, a32, 4, 3);
+  assert(!err);
+  err = qio_channel_write_ints(true, b_order, writing, a64, 8, 3);
+  assert(!err);
+  qio_channel_release(writing);
+
+  // The caller's arrays are left in native order.
+  assert( a16[0] == 0x0102 );
+  assert( a32[0] == 0x01020304 );
+  assert( a64[0] == 0x0102030405060708ULL );
+
+  // Check the encoding against the one-at-a-time functions.
+  err = qio_channel_create(&reading, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_read_amt(true, reading, g8, 3);
+  assert(!err);
+  assert( 0 == memcmp(g8, a8, 3) );
+  for( i = 0; i < 3; i++ ) {
+    err = qio_channel_read_uint16(true, b_order, reading, &g16[i]);
+    assert(!err);
+    assert( g16[i] == a16[i] );
+  }
+  for( i = 0; i < 3; i++ ) {
+    err = qio_channel_read_uint32(true, b_order, reading, &g32[i]);
+    assert(!err);
+    assert( g32[i] == a32[i] );
+  }
+  for( i = 0; i < 3; i++ ) {
+    err = qio_channel_read_uint64(true, b_order, reading, &g64[i]);
+    assert(!err);
+    assert( g64[i] == a64[i] );
+  }
+  qio_channel_release(reading);
+
+  // And read them back in bulk.
+  memset(g16, 0, sizeof(g16));
+  memset(g32, 0, sizeof(g32));
+  memset(g64, 0, sizeof(g64));
+  err = qio_channel_create(&reading, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, NULL);
+  assert(!err);
+  err = qio_channel_read_ints(true, b_order, reading, g8, 1, 3);
+  assert(!err);
+  err = qio_channel_read_ints(true, b_order, reading, g16, 2, 3);
+  assert(!err);
+  err = qio_channel_read_ints(true, b_order, reading, g32, 4, 3);
+  assert(!err);
+  err = qio_channel_read_ints(true, b_order, reading, g64, 8, 3);
+  assert(!err);
+  assert( 0 == memcmp(g8, a8, sizeof(a8)) );
+  assert( 0 == memcmp(g16, a16, sizeof(a16)) );
+  assert( 0 == memcmp(g32, a32, sizeof(a32)) );
+  assert( 0 == memcmp(g64, a64, sizeof(a64)) );
+
+  // A short read is an EOF.
+  err = qio_channel_read_ints(true, b_order, reading, bytes, 8, 1);
+  assert( qio_err_to_int(err) == EEOF );
+  qio_channel_release(reading);
+
+  qio_file_release(f);
+}
+
+int main(int argc, char** argv)
+{
+  int sizes[] = {qbytes_iobuf_size, 64, 16, 1, 0};
+
+  fill_values();
+
+  for( int i = 0; sizes[i] != 0; i++ ) {
+    qbytes_iobuf_size = sizes[i];
+
+    if( verbose ) printf("Testing qbytes_iobuf_size=%i\n",
+                         (int) qbytes_iobuf_size);
+
+    test_varints(1);
+    test_varints(0);
+    test_ints(QIO_BIG);
+    test_ints(QIO_LITTLE);
+    test_ints(QIO_NATIVE);
+  }
+
+  printf("qio_varint_test PASS\n");
+
+  return 0;
+}
@@ -0,0 +1,31 @@
+// Modules reached only through a chain of uses, or only through a
+// qualified name, must be kept when unreachable modules are dropped
+// early in scope resolution; an unreachable one must not run.
+
+module Leaf {
+  writeln("Leaf init");
+  proc leafValue() { return 1; }
+}
+
+module Mid {
+  use Leaf;
+  proc midValue() { return leafValue() + 10; }
+}
+
+module Qualified {
+  writeln("Qualified init");
+  var x = 100;
+}
+
+module Unreached {
+  writeln("Unreached init");
+  proc neverCalled() { return 0; }
+}
+
+module Main {
+  use Mid;
+
+  proc main() {
+    writeln(midValue() + Qualified.x);
+  }
+}
@@ -0,0 +1,16 @@
+use BlockDist;
+
+const D = {1..10} dmapped Block({1..10});
+var A: [D] int;
+var B: [1..10] int;
+var Idx: [D] int = [i in 1..10] 11 - i;
+
+// A compound update of a possibly remote element: not aggregated.
+forall i in D do
+  A[Idx[i]] += i;
+
+// No local access on either side: not aggregated.
+forall i in D do
+  B[Idx[i]] = i;
+
+writeln("result: ", + reduce A, " ", + reduce B);
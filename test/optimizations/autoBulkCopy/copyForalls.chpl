@@ -0,0 +1,39 @@
+use BlockDist;
+
+config const n = 12;
+
+const D = {1..n} dmapped Block({1..n});
+var A, B: [D] int;
+var L: [1..n] int;
+
+B = [i in D] i * 10;
+
+// Over a domain.
+forall i in D do A[i] = B[i];
+writeln(A);
+
+// Over another array's domain, from a distributed to a local array.
+forall i in B.domain do L[i] = B[i];
+writeln(L);
+
+// Over a bounded range of symbols.
+const lo = 3, hi = 6;
+A = 0;
+forall i in lo..hi do A[i] = L[i];
+writeln(A);
+
+// A record with its own accessor keeps the original loop.
+record Squares {
+  proc this(i: int) ref {
+    return L[i];
+  }
+}
+var S: Squares;
+forall i in 1..n do S[i] = i * i;
+writeln(L);
+
+// Loops that don't match the pattern are left alone.
+forall (i, j) in zip(D, 1..n) do A[i] = L[j] + 1;
+writeln(A);
+forall i in D with (ref L) do L[i] = B[i];
+writeln(L);
@@ -0,0 +1,16 @@
+use BlockDist;
+
+const D = {1..8, 1..8} dmapped Block({1..8, 1..8});
+const Inner = D[2..7, 2..7];
+var A, B: [D] real;
+A = 1.0;
+
+// Stencil accesses: reported as loop indices with offsets.
+forall (i, j) in Inner do
+  B[i, j] = A[i+1, j-1] + A[i-1, j+1];
+
+// Not an offset: reported as not matching the indices cleanly.
+forall (i, j) in Inner do
+  B[i, j] += A[j, i*1];
+
+writeln("result: ", + reduce B);
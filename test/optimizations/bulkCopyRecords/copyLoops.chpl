@@ -0,0 +1,43 @@
+// Copies of arrays of simple records must give the same results whether
+// or not their element-by-element loops are turned into bulk copies.
+record R {
+  var x: int;
+  var y: real;
+}
+
+config const n = 8;
+
+proc fill(ref A: [] R, k: int) {
+  for i in A.domain do A[i] = new R(k*100 + i, i + 0.5);
+}
+
+var A, B: [0..n] R;
+fill(B, 1);
+
+// whole-array copy
+A = B;
+writeln(A);
+
+// slice copy from a shifted source
+fill(A, 0);
+A[1..5] = B[3..7];
+writeln(A);
+
+// unit-stride serial loop with two induction variables
+fill(A, 0);
+for (i, j) in zip(2..6, 0..4) do A[i] = B[j];
+writeln(A);
+
+// overlapping forward copy: every element ends up a copy of A[0]
+fill(A, 2);
+for i in 1..n do A[i] = A[i-1];
+writeln(A);
+
+// non-affine source indices must not become a contiguous copy
+fill(A, 0);
+for i in 0..2 do A[i] = B[i*i];
+writeln(A);
+
+fill(A, 0);
+for (i, j) in zip(0..2, 0..2) do A[i] = B[i*j];
+writeln(A);
@@ -0,0 +1,13 @@
+// With CHPL_RT_CACHE_SITE_STATS=true each locale prints the cache hits
+// and misses for each source location at exit.  The prediff checks the
+// line that reads A against locale 1's communication counts.
+config const n = 8192;
+
+var A: [1..n] int = 1..n;
+
+on Locales[1] {
+  var sum = 0;
+  for i in 1..n do
+    sum += A[i];
+  writeln(sum);
+}
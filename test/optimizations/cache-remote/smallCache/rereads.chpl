@@ -0,0 +1,16 @@
+// Sweep a 32 KiB remote array several times through a cache set to 16
+// one-KiB pages with CHPL_RT_CACHE_PAGES.  The array doesn't fit, so
+// each sweep has to fetch most of it again; with the default size it
+// would be fetched once.  The prediff checks the bytes locale 1 got.
+config const n = 4096,
+             reps = 4;
+
+var A: [1..n] int = 1..n;
+
+on Locales[1] {
+  var sum = 0;
+  for r in 1..reps do
+    for i in 1..n do
+      sum += A[i];
+  writeln(sum);
+}
@@ -0,0 +1,18 @@
+// Reads of a remote array at a fixed stride bigger than a cache page
+// should be fetched ahead by the cache's strided readahead.  The
+// prediff checks the communication counts that locale 1 wrote.
+extern const CHPL_CACHE_REMOTE: c_int;
+
+config const n = 64 * 1024,
+             stride = 256;   // 2 KiB between reads
+
+var A: [1..n] int = 1..n;
+
+on Locales[1] {
+  var sum = 0;
+  for i in 1..n by stride do
+    sum += A[i];
+  writeln(sum);
+}
+
+writeln("cache ", if CHPL_CACHE_REMOTE != 0 then "on" else "off");
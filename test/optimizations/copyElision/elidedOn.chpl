@@ -0,0 +1,45 @@
+// With --local, on-statements are elided and run their body in place.
+// A last use of an outer variable inside one should be moved, not copied.
+
+record R {
+  var x: int;
+
+  proc init(x: int) {
+    this.x = x;
+  }
+
+  proc init=(other: R) {
+    this.x = other.x;
+    writeln("copy of ", other.x);
+  }
+}
+
+proc take(in r: R) {
+  writeln("took ", r.x);
+}
+
+proc lastUseInOn() {
+  var r = new R(1);
+  on here {
+    var s = r;
+    writeln(s.x);
+  }
+}
+
+proc usedAfterOn() {
+  var r = new R(2);
+  on here {
+    var s = r;
+    writeln(s.x);
+  }
+  writeln(r.x);
+}
+
+proc passedInOn() {
+  var r = new R(3);
+  on here do take(r);
+}
+
+lastUseInOn();
+usedAfterOn();
+passedInOn();
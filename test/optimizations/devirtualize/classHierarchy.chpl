@@ -0,0 +1,72 @@
+// Dynamically dispatched calls whose target can be narrowed down from
+// the classes the program creates have to call the same methods as
+// ordinary dispatch.
+
+class Shape {
+  proc area(): real { return 0.0; }
+  proc name(): string { return "shape"; }
+}
+
+// Only Square is ever created, so Shape.area() always reaches
+// Square.area().
+class Square: Shape {
+  var side: real;
+  override proc area(): real { return side * side; }
+}
+
+class Animal {
+  proc sound(): string { return "..."; }
+}
+
+// Dog and Cat are both created; sound() has two targets, one of them
+// reached only from Cat.
+class Dog: Animal {
+}
+
+class Cat: Animal {
+  override proc sound(): string { return "meow"; }
+}
+
+// Three different targets: dispatched as before.
+class Vehicle {
+  proc wheels(): int { return 0; }
+}
+
+class Bike: Vehicle {
+  override proc wheels(): int { return 2; }
+}
+
+class Car: Vehicle {
+  override proc wheels(): int { return 4; }
+}
+
+proc describe(s: borrowed Shape) {
+  writeln(s.name(), " ", s.area());
+}
+
+proc total(xs: [] borrowed Animal) {
+  for a in xs do writeln(a.sound());
+}
+
+var sq = new Square(3.0);
+describe(sq.borrow());
+
+var d = new Dog(), c = new Cat();
+const animals = [d.borrow(): borrowed Animal, c.borrow(): borrowed Animal,
+                 d.borrow(): borrowed Animal];
+total(animals);
+
+var v = new Vehicle(), b = new Bike(), car = new Car();
+var wheels = 0;
+for x in [v.borrow(): borrowed Vehicle, b.borrow(): borrowed Vehicle,
+          car.borrow(): borrowed Vehicle] do
+  wheels += x.wheels();
+writeln(wheels);
+
+// A moved result from a guarded call.
+var sounds: string;
+for a in animals {
+  const s = a.sound();
+  sounds += s;
+}
+writeln(sounds);
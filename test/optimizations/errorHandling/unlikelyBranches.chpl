@@ -0,0 +1,43 @@
+// The error checks after throwing calls are marked unlikely; the error
+// paths have to behave the same as before.
+
+class OddError: Error {
+  var n: int;
+  override proc message() {
+    return "odd " + n:string;
+  }
+}
+
+proc half(n: int) throws {
+  if n % 2 != 0 then
+    throw new OddError(n);
+  return n / 2;
+}
+
+proc halveAll(n: int) throws {
+  var sum = 0;
+  for i in 1..n do
+    sum += half(2 * i);
+  return sum + half(n);
+}
+
+var caught = 0, total = 0;
+for i in 1..10 {
+  try {
+    total += half(i);
+  } catch e: OddError {
+    caught += 1;
+  } catch {
+    writeln("unexpected");
+  }
+}
+writeln(total, " ", caught);
+
+try {
+  writeln(halveAll(4));
+  writeln(halveAll(5));
+} catch e {
+  writeln(e.message());
+}
+
+writeln(try! half(8));
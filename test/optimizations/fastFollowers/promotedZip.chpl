@@ -0,0 +1,34 @@
+use BlockDist;
+
+config const n = 10;
+
+const Dom = {1..n} dmapped Block({1..n});
+var A, B, C, E: [Dom] int;
+
+forall i in Dom {
+  B[i] = i;
+  C[i] = 2;
+  E[i] = i + 1;
+}
+
+// A chain of promoted operators over arrays sharing the forall's domain.
+forall (a, b) in zip(A, B + C * E) do a = b;
+writeln(A);
+
+// Literal operands don't affect alignment.
+forall (a, b) in zip(A, 2 * B + 1) do a = b;
+writeln(A);
+
+// Several promoted iterands.
+forall (a, b, c) in zip(A, B + C, C * E) do a = b - c;
+writeln(A);
+
+// An operand over a differently distributed domain is not aligned, and
+// has to take the slow followers.
+const Other = {1..n} dmapped Block({1..2*n});
+var F: [Other] int;
+forall i in Other do F[i] = i * i;
+forall (a, b) in zip(A, B + F) do a = b;
+writeln(A);
+
+writeln(+ reduce (B * C + E));
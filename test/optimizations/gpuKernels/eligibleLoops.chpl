@@ -0,0 +1,20 @@
+// Check which forall loops are outlined into GPU kernels.  This stops
+// before codegen, so it needs the gpu locale model but not a GPU.
+
+config const n = 10;
+
+var A: [1..n] int;
+var x = 3;
+
+// Only primitives on array elements and a captured value: outlined.
+forall i in 1..n do
+  A[i] = i * x;
+
+// Writes a variable declared outside of the loop: not eligible.
+var sum = 0;
+forall i in 1..n with (+ reduce sum) do
+  sum += A[i];
+
+// Calls a function that can't run on a GPU: not eligible.
+forall i in 1..n do
+  writeln(A[i]);
@@ -0,0 +1,11 @@
+// Strength reduction of index arithmetic runs before the GPU outliner
+// and must leave loops it could outline alone.  Check that a loop
+// indexing a 2-D array is still outlined.
+
+config const n = 10;
+
+var A: [1..n] int;
+var M: [1..n, 1..n] int;
+
+forall i in 1..n do
+  A[i] = M[i, 1];
@@ -0,0 +1,36 @@
+// Small leaf functions are inlined without the inline keyword, while
+// leaves over --inline-size-limit are not.
+
+config const n = 3;
+
+proc tinyLeaf(x: int) {
+  return x * 2 + 1;
+}
+
+proc bigLeaf(x: int) {
+  var y = x;
+  y = (y * 2 + x) % 1009;
+  y = (y * 3 + x) % 1009;
+  y = (y * 4 + x) % 1009;
+  y = (y * 5 + x) % 1009;
+  y = (y * 6 + x) % 1009;
+  y = (y * 7 + x) % 1009;
+  y = (y * 8 + x) % 1009;
+  y = (y * 9 + x) % 1009;
+  y = (y * 10 + x) % 1009;
+  y = (y * 11 + x) % 1009;
+  y = (y * 12 + x) % 1009;
+  y = (y * 13 + x) % 1009;
+  y = (y * 14 + x) % 1009;
+  y = (y * 15 + x) % 1009;
+  y = (y * 16 + x) % 1009;
+  y = (y * 17 + x) % 1009;
+  y = (y * 18 + x) % 1009;
+  y = (y * 19 + x) % 1009;
+  y = (y * 20 + x) % 1009;
+  y = (y * 21 + x) % 1009;
+  return y;
+}
+
+writeln(tinyLeaf(n));
+writeln(bigLeaf(n));
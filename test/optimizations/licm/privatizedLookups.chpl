@@ -0,0 +1,56 @@
+// Privatized-object lookups and the metadata of const domain formals
+// can be loaded once before a loop.  A domain that does change in the
+// loop, and arrays over it, have to be read afresh each time.
+use BlockDist;
+
+config const n = 20;
+
+const D = {1..n} dmapped Block({1..n});
+var A, B: [D] int;
+
+// Each access to a distributed array looks up its privatized copy.
+proc sumBoth(const ref X: [] int, const ref Y: [] int) {
+  var s = 0;
+  for i in X.domain do s += X[i] + 2 * Y[i];
+  return s;
+}
+
+// Const domain formal: its bounds and stride are loop invariant.
+proc countInside(const dom: domain(1), k: int) {
+  var c = 0;
+  for i in 1..k do
+    if dom.contains(i) then c += dom.size;
+  return c;
+}
+
+// Ref domain formal that the loop changes.
+proc growing(ref dom: domain(1), k: int) {
+  var total = 0;
+  for i in 1..k {
+    dom = {1..i};
+    total += dom.size + dom.high;
+  }
+  return total;
+}
+
+forall i in D {
+  A[i] = i;
+  B[i] = n - i;
+}
+writeln(sumBoth(A, B));
+
+on Locales[numLocales-1] do writeln(sumBoth(A, B));
+
+writeln(countInside({3..12 by 3}, n));
+
+var G = {1..0};
+var GA: [G] int;
+writeln(growing(G, 10));
+writeln(GA.size);
+
+// Strided loops over a distributed array, run where the data isn't.
+on Locales[numLocales-1] {
+  var s = 0;
+  for i in D by 3 do s += A[i];
+  writeln(s);
+}
@@ -0,0 +1,30 @@
+// LICM may only treat a ref formal's value as loop invariant when no
+// call site passes it aliased with another ref formal that the loop
+// writes.
+
+config const n = 5;
+
+// Called with both distinct and aliased actuals.
+proc accumulate(ref total: int, ref step: int, count: int) {
+  for 1..count do
+    total += step;
+}
+
+// Only ever called with distinct actuals.
+proc scaleAll(ref dst: [] int, ref factor: int) {
+  for i in dst.domain do
+    dst[i] *= factor;
+}
+
+var t = 0, s = 3;
+accumulate(t, s, n);
+writeln(t);
+
+var u = 1;
+accumulate(u, u, n);
+writeln(u);
+
+var A: [1..n] int = 1..n;
+var f = 2;
+scaleAll(A, f);
+writeln(A);
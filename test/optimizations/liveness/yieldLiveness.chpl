@@ -0,0 +1,62 @@
+// Locals live across yields are kept in the iterator's class, as found
+// by liveness analysis.  Values set before a yield and read after it
+// have to survive, in straight-line code, branches, nested loops and
+// loops with early exits.
+
+config const n = 6;
+
+iter manyLive(k: int) {
+  var a = k, b = 2*k, c = 3*k, d = 4*k, e = 5*k;
+  var f = a + b, g = c + d, h = e + f, i = g + h, j = i + a;
+  yield a + b + c + d + e;
+  a += 1; b += 1;
+  yield f + g + h + i + j;
+  for x in 1..k {
+    const t = x * a;
+    if x % 2 == 0 {
+      c += t;
+      yield c;
+    } else {
+      d -= t;
+      yield d;
+    }
+    e += b;
+  }
+  label outer for y in 1..k {
+    for z in 1..k {
+      if y * z > k then continue outer;
+      h += y * z;
+    }
+    yield h + e;
+  }
+  while j > 0 {
+    j -= i;
+    if j < 0 then break;
+    yield j;
+  }
+  yield a + b + c + d + e + f + g + h + i + j;
+}
+
+var results: [1..0] int;
+for r in manyLive(n) do results.push_back(r);
+writeln(results);
+var sum = 0;
+for r in manyLive(n) do sum += r;
+writeln(sum);
+
+// The same iterator zippered with a range.
+var total = 0;
+for (r, i) in zip(manyLive(n), 1..) do
+  total += r * i;
+writeln(total);
+
+// Code after a return can't be reached; it mustn't change anything.
+proc early(x: int) {
+  var y = x;
+  for i in 1..10 {
+    y += i;
+    if i == 3 then return y;
+  }
+  return -1;
+}
+writeln(early(5));
@@ -0,0 +1,36 @@
+// Remote loads done on both sides of a branch are hoisted above it
+// and aggregated with the loads before it; the values read must not
+// change, including when the branch writes memory in between.
+
+record R {
+  var a, b, c, d: int;
+}
+
+class C {
+  var r: R;
+}
+
+proc test(obj: C, flag: bool, ref out1: int, ref out2: int) {
+  const x = obj.r.a;
+  if flag {
+    out1 = obj.r.b + x;
+    out2 = obj.r.c;
+  } else {
+    out1 = obj.r.b - x;
+    out2 = obj.r.d;
+  }
+}
+
+proc main() {
+  const obj = new unmanaged C(new R(1, 2, 3, 4));
+
+  on Locales[numLocales-1] {
+    var o1, o2: int;
+    test(obj, true, o1, o2);
+    writeln(o1, " ", o2);
+    test(obj, false, o1, o2);
+    writeln(o1, " ", o2);
+  }
+
+  delete obj;
+}
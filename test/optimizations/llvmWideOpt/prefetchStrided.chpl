@@ -0,0 +1,20 @@
+// Strided remote loads in a loop may be prefetched ahead of use; the
+// prefetch address is clamped to the last iteration, so short loops
+// and loops shorter than the distance must still read the right data.
+
+config const n = 1000;
+
+proc main() {
+  var A: [0..#n] int = 0..#n;
+
+  on Locales[numLocales-1] {
+    for stride in (1, 3, 7) {
+      for count in (2, 5, n / stride) {
+        var sum = 0;
+        for i in 0..#count do
+          sum += A[i * stride];
+        writeln(stride, " ", count, " ", sum);
+      }
+    }
+  }
+}
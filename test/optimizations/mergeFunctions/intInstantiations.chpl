@@ -0,0 +1,25 @@
+// Instantiations that lower to the same LLVM IR, such as int and uint
+// versions of a bit-twiddling function, may be merged.  Each caller has
+// to get the same results either way.
+
+proc mix(x) {
+  var h = x;
+  h ^= h >> 7;
+  h ^= h << 3;
+  h += x & 0xff;
+  return h;
+}
+
+proc sumList(ref xs) {
+  var s: xs.eltType = 0;
+  for x in xs do s += x;
+  return s;
+}
+
+var ints: [1..4] int = [1, 20, 300, 4000];
+var uints: [1..4] uint = [1: uint, 20, 300, 4000];
+
+writeln(mix(1234), " ", mix(1234: uint));
+writeln(mix(98765: int(32)), " ", mix(98765: uint(32)));
+writeln(sumList(ints), " ", sumList(uints));
+writeln(mix(-5));
@@ -0,0 +1,34 @@
+// Nil checks that repeat an earlier check on the same path can go, but
+// a check after the value may have changed has to stay and fire.
+
+class C {
+  var x: int;
+}
+
+proc steal(ref c: owned C) {
+  var other = c;
+}
+
+config const n = 3;
+
+proc checkedTwice() {
+  var c = new C(1);
+  var sum = 0;
+  sum += c.x;
+  sum += c.x;
+  for i in 1..n do sum += c.x;
+  writeln(sum);
+}
+
+proc checkedAfterChange() {
+  var c = new C(2);
+  var sum = 0;
+  for i in 1..n {
+    sum += c.x;
+    writeln(sum);
+    if i == 2 then steal(c);
+  }
+}
+
+checkedTwice();
+checkedAfterChange();
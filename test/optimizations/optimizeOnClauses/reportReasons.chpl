@@ -0,0 +1,26 @@
+// Every on clause that isn't made fast must be reported with a reason,
+// and on-bodies making virtual calls must still dispatch correctly.
+
+class Base {
+  proc val(): int { return 1; }
+}
+
+class Child: Base {
+  override proc val(): int { return 2; }
+}
+
+proc main() {
+  const last = Locales[numLocales-1];
+
+  var o = new owned Child();
+  var b: borrowed Base = o.borrow();
+  var v: int;
+  on last do v = b.val();
+  writeln(v);
+
+  var s = 0;
+  on last do for i in 1..10 do s += i;
+  writeln(s);
+
+  on last do writeln("on ", here.id);
+}
@@ -0,0 +1,21 @@
+// Build with an instrumented binary, then rebuild using the merged
+// profile.  Both builds have to produce the same results.
+
+config const n = 100000;
+
+proc classify(x: int) {
+  if x % 97 == 0 then
+    return 2;
+  else if x % 2 == 0 then
+    return 1;
+  return 0;
+}
+
+var counts: [0..2] int;
+for i in 1..n do counts[classify(i)] += 1;
+writeln(counts);
+
+var total = 0;
+forall i in 1..n with (+ reduce total) do
+  total += classify(i);
+writeln(total);
@@ -0,0 +1,78 @@
+// Recursive iterators are lowered to callbacks, with their argument
+// bundles on the stack unless tasks started by the iterator might
+// outlive the call.  Walks of a tree in several orders, with many
+// yields per iterator, have to produce the same sequences.
+
+class Node {
+  var val: int;
+  var left, right: owned Node?;
+}
+
+proc build(lo: int, hi: int): owned Node? {
+  if lo > hi then return nil;
+  const mid = (lo + hi) / 2;
+  return new Node(mid, build(lo, mid-1), build(mid+1, hi));
+}
+
+iter inorder(n: borrowed Node?): int {
+  if n != nil {
+    for x in inorder(n!.left) do yield x;
+    yield n!.val;
+    for x in inorder(n!.right) do yield x;
+  }
+}
+
+// More yields than the inline limit.
+iter preorderTagged(n: borrowed Node?, depth: int): (int, int) {
+  if n == nil then return;
+  yield (n!.val, depth);
+  if n!.left != nil then
+    for x in preorderTagged(n!.left, depth+1) do yield x;
+  else
+    yield (-1, depth+1);
+  if n!.right != nil then
+    for x in preorderTagged(n!.right, depth+1) do yield x;
+  else
+    yield (-1, depth+1);
+}
+
+iter countdown(k: int): int {
+  if k < 0 then return;
+  yield k;
+  for x in countdown(k-1) do yield x;
+}
+
+// A recursive iterator whose body starts tasks that use its arguments.
+iter sumsBelow(n: borrowed Node?): int {
+  if n != nil {
+    var s: atomic int;
+    const v = n!.val;
+    sync {
+      begin s.add(v);
+    }
+    yield s.read();
+    for x in sumsBelow(n!.left) do yield x;
+    for x in sumsBelow(n!.right) do yield x;
+  }
+}
+
+const root = build(1, 15);
+
+var order: [1..0] int;
+for x in inorder(root.borrow()) do order.push_back(x);
+writeln(order);
+
+var leaves = 0, maxDepth = 0, total = 0;
+for (v, d) in preorderTagged(root.borrow(), 0) {
+  if v == -1 then leaves += 1; else total += v;
+  maxDepth = max(maxDepth, d);
+}
+writeln(leaves, " ", maxDepth, " ", total);
+
+var down = 0;
+for x in countdown(1000) do down += x;
+writeln(down);
+
+var sums = 0;
+for x in sumsBelow(root.borrow()) do sums += x;
+writeln(sums);
@@ -0,0 +1,44 @@
+// Small records and tuples that an on-body only reads may be sent with
+// the on-statement.  The on-body must still see the current value each
+// time, and values it writes or synchronizes on must not be copied.
+
+record P {
+  var x: int;
+  var y: real;
+}
+
+proc work() {
+  var p = new P(1, 2.5);
+  var t = (3, 4.5);
+
+  for loc in Locales do on loc do
+    writeln(here.id, ": ", p.x + t(0), " ", p.y + t(1));
+
+  // Updated between on-statements.
+  p.x = 10;
+  t(0) = 20;
+  on Locales[numLocales-1] do
+    writeln(p.x + t(0));
+
+  // Written by the on-body.
+  var q = new P(0, 0.0);
+  on Locales[numLocales-1] do
+    q.x = 7;
+  writeln(q.x);
+
+  // Read while another task updates it, through an atomic handshake.
+  var r = (0, 0);
+  var ready: atomic bool;
+  cobegin with (ref r) {
+    on Locales[numLocales-1] {
+      ready.waitFor(true);
+      writeln(r(0) + r(1));
+    }
+    {
+      r = (5, 6);
+      ready.write(true);
+    }
+  }
+}
+
+work();
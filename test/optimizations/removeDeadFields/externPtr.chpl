@@ -0,0 +1,22 @@
+use CPtr;
+
+// Fields b and c are never read from Chapel, but C sees the whole
+// record through the pointer, so they must not be removed.
+record R {
+  var a: int;
+  var b: int;
+  var c: int;
+}
+
+record Unused {
+  var kept: int;
+  var dead: int;
+}
+
+extern proc sumFields(p: c_ptr(R)): int;
+
+var r = new R(1, 2, 3);
+writeln(sumFields(c_ptrTo(r)));
+
+var u = new Unused(4, 5);
+writeln(u.kept);
@@ -0,0 +1,6 @@
+#include <stdint.h>
+
+static int64_t sumFields(void* p) {
+  int64_t* fields = (int64_t*) p;
+  return fields[0] + fields[1] + fields[2];
+}
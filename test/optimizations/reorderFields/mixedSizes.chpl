@@ -0,0 +1,67 @@
+// Compiler-generated types with fields of mixed sizes are laid out by
+// alignment.  Values have to get through argument bundles, iterators
+// and tuples intact.
+
+config const n = 4;
+
+var b: bool = true;
+var i8: int(8) = -3;
+var r: real = 2.5;
+var i16: int(16) = 1000;
+var i32: int(32) = -70000;
+var i64: int = 1 << 40;
+
+proc show(b: bool, i8: int(8), r: real, i16: int(16), i32: int(32),
+          i64: int) {
+  writeln(b, " ", i8, " ", r, " ", i16, " ", i32, " ", i64);
+}
+
+// On and task argument bundles.
+on Locales[numLocales-1] do show(b, i8, r, i16, i32, i64);
+
+sync begin with (in b, in i8, in r, in i16, in i32, in i64) do
+  show(b, i8, r, i16, i32, i64);
+
+coforall loc in Locales with (in i8, in r) do on loc {
+  if loc.id == 0 then show(b, i8, r, i16, i32, i64);
+}
+
+// Heterogeneous tuples.
+var t = (i8, r, b, i32, i16, i64);
+writeln(t);
+t[0] += 1;
+t[3] *= 2;
+writeln(t);
+var nested = ((b, i64), (i8, (r, i16)));
+writeln(nested);
+
+// Iterator classes keep their locals in fields.
+iter mixed() {
+  var small: int(8) = 1;
+  var big: real = 0.5;
+  var flag = false;
+  var mid: int(32) = 7;
+  for j in 1..n {
+    small += 1;
+    big *= 2;
+    flag = !flag;
+    mid += j: int(32);
+    yield (small, big, flag, mid);
+  }
+}
+
+for x in mixed() do writeln(x);
+
+// A record opting in to reordering.
+pragma "reorder fields"
+record Packed {
+  var a: int(8);
+  var b: real;
+  var c: int(16);
+  var d: int(32);
+}
+
+var p = new Packed(1, 2.0, 3, 4);
+p.c += 10;
+writeln(p);
+on Locales[numLocales-1] do writeln(p);
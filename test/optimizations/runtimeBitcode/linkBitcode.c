@@ -0,0 +1,17 @@
+#include "linkBitcode.h"
+
+static int64_t count;
+
+int64_t scaleBy3(int64_t x) {
+  return 3 * x;
+}
+
+// These reach a mutable static, so only their declarations may be
+// imported: a copied body would bump a private copy of 'count'.
+void bump(void) {
+  count++;
+}
+
+int64_t readCount(void) {
+  return count;
+}
@@ -0,0 +1,19 @@
+// Link bitcode for C code the program also links as an object file.
+// Functions imported from the bitcode are only there for the optimizer;
+// the program has to behave as if they had not been imported.
+
+require "linkBitcode.h", "linkBitcode.c";
+
+extern proc scaleBy3(x: int): int;
+extern proc bump();
+extern proc readCount(): int;
+
+config const n = 10;
+
+var sum = 0;
+for i in 1..n {
+  sum += scaleBy3(i);
+  bump();
+}
+writeln(sum);
+writeln(readCount());
@@ -0,0 +1,5 @@
+#include <stdint.h>
+
+int64_t scaleBy3(int64_t x);
+void bump(void);
+int64_t readCount(void);
@@ -0,0 +1,76 @@
+// Instances of plain classes that never escape may be replaced by their
+// fields.  Instances that are stored, passed, returned or subclassed
+// must keep working as objects.
+
+class Acc {
+  var sum: int;
+  var count: int;
+}
+
+class Node {
+  var val: int;
+  var next: unmanaged Node?;
+}
+
+class Base {
+  var b: int;
+  proc get(): int { return b; }
+}
+
+class Derived: Base {
+  var d: int;
+  override proc get(): int { return b + d; }
+}
+
+var saved: unmanaged Acc?;
+
+proc average(n: int) {
+  // Never escapes.
+  var acc = new unmanaged Acc(0, 0);
+  for i in 1..n {
+    acc.sum += i;
+    acc.count += 1;
+  }
+  const result = acc.sum / acc.count;
+  delete acc;
+  return result;
+}
+
+proc keep(n: int) {
+  // Escapes into a global.
+  var acc = new unmanaged Acc(n, 1);
+  saved = acc;
+}
+
+proc makeList(n: int) {
+  // Escapes through the return value and through other nodes.
+  var head: unmanaged Node? = nil;
+  for i in 1..n do
+    head = new unmanaged Node(i, head);
+  return head;
+}
+
+proc useBase(x: borrowed Base) {
+  return x.get();
+}
+
+writeln(average(9));
+
+keep(42);
+writeln(saved!.sum);
+delete saved;
+
+var l = makeList(4);
+var total = 0;
+while l != nil {
+  total += l!.val;
+  const next = l!.next;
+  delete l;
+  l = next;
+}
+writeln(total);
+
+{
+  var d = new owned Derived(1, 2);
+  writeln(useBase(d.borrow()));
+}
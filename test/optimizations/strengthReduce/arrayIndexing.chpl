@@ -0,0 +1,47 @@
+// Offsets of array elements computed from the loop index are turned
+// into variables advanced with the loop.  Loops over rows, columns,
+// strided and negative steps, and copies of the index have to touch
+// the same elements as before.
+
+config const n = 7, m = 9;
+
+var A: [1..n, 1..m] int;
+var B: [0..#n*m] int;
+
+// Row-major fill.
+for i in 1..n do
+  for j in 1..m do
+    A[i, j] = i * 100 + j;
+
+// Column walk: the index multiplies the row stride.
+var colSum = 0;
+for j in 1..m do
+  for i in 1..n do
+    colSum += A[i, j] * j;
+writeln(colSum);
+
+// Strided and reversed loops, with a copy of the index.
+var s = 0;
+for i in 1..n by 2 {
+  const ii = i;
+  for j in 1..m by -3 do
+    s += A[ii, j];
+}
+writeln(s);
+
+// Two accesses sharing a factor, and a 1-D view of the same data.
+for i in 1..n do
+  for j in 1..m do
+    B[(i-1)*m + (j-1)] = A[i, j] - A[i, 1];
+writeln(+ reduce B);
+
+// A forall body and an explicit local access.
+var C: [1..n, 1..m] int;
+forall i in 1..n do
+  for j in 1..m do
+    C[i, j] = A[i, j] + A[i, m-j+1];
+writeln(+ reduce C);
+
+forall (i, j) in C.domain do
+  C.localAccess[i, j] = A.localAccess[i, j] * 2;
+writeln(C[n, m], " ", + reduce C);
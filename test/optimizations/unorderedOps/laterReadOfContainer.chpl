@@ -0,0 +1,30 @@
+// A field store in a forall body must not be made unordered when a
+// later statement in the same iteration reads the record containing it.
+use BlockDist;
+
+record R {
+  var x: int;
+  var y: (int, int);
+}
+
+config const n = 100;
+
+const D = {1..n} dmapped Block({1..n});
+var A, B: [D] R;
+var T: [D] (int, R);
+
+forall i in D {
+  A[i].x = i;
+  B[i] = A[i];
+}
+
+forall i in D {
+  A[i].y(1) = 2*i;
+  T[i] = (i, A[i]);
+}
+
+var ok = true;
+for i in D {
+  if B[i].x != i || T[i](1).y(1) != 2*i then ok = false;
+}
+writeln(if ok then "OK" else "FAILED");
@@ -0,0 +1,54 @@
+// Statements before the last one in a forall body are made unordered
+// when nothing after them in the iteration could observe them.  Each
+// loop stores to memory of a different type in each statement, so all
+// of these should be reported.
+
+record Pt {
+  var a: int(8);
+  var b: real(32);
+  var c: uint(16);
+}
+
+class Stats {
+  var count: uint(32);
+  var mean: real(32);
+}
+
+config const n = 100;
+
+var A, B: [1..n] int;
+var P: [1..n] Pt;
+var S = [i in 1..n] new unmanaged Stats();
+var sum: atomic real;
+
+A = 1..n;
+
+// A non-fetching atomic that is not the last statement.
+forall i in 1..n {
+  sum.add(1.0);
+  B[i] = A[i];
+}
+
+// Class field stores, only the second of which is last.
+forall i in 1..n {
+  S[i].count = i: uint(32);
+  S[i].mean = i: real(32);
+}
+
+// A run of record field stores at the end of the body.
+forall i in 1..n {
+  P[i].a = (i % 100): int(8);
+  P[i].b = i: real(32);
+  P[i].c = i: uint(16);
+}
+
+var ok = sum.read() == n;
+for i in 1..n {
+  if B[i] != i ||
+     S[i].count != i || S[i].mean != i ||
+     P[i].a != i % 100 || P[i].b != i || P[i].c != i then
+    ok = false;
+}
+writeln(if ok then "OK" else "FAILED");
+
+for s in S do delete s;
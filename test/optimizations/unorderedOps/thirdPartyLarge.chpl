@@ -0,0 +1,40 @@
+// Unordered assignments of large elements between two other nodes are
+// done by the source node PUTting to the destination directly.  All of
+// them have to be done by the end of the forall, and they must not mix
+// up elements.
+use BlockDist;
+
+config const n = 64;
+param eltInts = 256;  // bigger than the largest staged transfer
+
+type Elt = eltInts*int;
+
+const D = {0..#n} dmapped Block({0..#n});
+var A, B: [D] Elt;
+
+forall i in D do
+  for j in 0..#eltInts do B[i][j] = i * eltInts + j;
+
+// Run the loop on locale 0, copying between elements on other nodes
+// whenever there are more than two locales.
+on Locales[0] {
+  forall i in 0..#n do
+    A[(i + n/2) % n] = B[(i + n/4) % n];
+}
+
+var ok = true;
+for i in D {
+  const src = (i - n/2 + n/4 + n) % n;
+  for j in 0..#eltInts do
+    if A[i][j] != src * eltInts + j then ok = false;
+}
+writeln(if ok then "OK" else "FAILED");
+
+// And again, with the loop followed at once by reads from another task.
+on Locales[numLocales-1] {
+  forall i in 0..#n do
+    B[i] = A[(i + 1) % n];
+  var sum = 0;
+  for i in 0..#n do sum += B[i][0];
+  writeln(sum == (+ reduce [i in 0..#n] A[i][0]));
+}
@@ -0,0 +1,39 @@
+// Perfect nests of serial loops, with trip counts that don't divide
+// the unroll-and-jam count, must compute the same results.
+
+config const n = 7, m = 5, k = 6;
+
+var A: [1..n, 1..k] real;
+var B: [1..k, 1..m] real;
+var C: [1..n, 1..m] real;
+
+for i in 1..n do
+  for j in 1..k do
+    A[i, j] = i + j / 2.0;
+
+for i in 1..k do
+  for j in 1..m do
+    B[i, j] = i * j;
+
+for i in 1..n do
+  for j in 1..m do
+    for l in 1..k do
+      C[i, j] += A[i, l] * B[l, j];
+
+writeln(+ reduce C);
+
+// An outer loop whose inner loop depends on it.
+var T = 0;
+for i in 1..n do
+  for j in 1..i do
+    T += i * j;
+writeln(T);
+
+// An outer loop that isn't a perfect nest.
+var U = 0;
+for i in 1..n {
+  U += 1;
+  for j in 1..m do
+    U += j;
+}
+writeln(U);
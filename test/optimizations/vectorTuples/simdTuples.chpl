@@ -0,0 +1,50 @@
+// Star tuples of SIMD width are represented as LLVM vectors with
+// --vector-tuples.  Element access and the element-wise operators have
+// to behave the same as for arrays of elements.
+
+config const n = 8;
+
+var a: 2*real = (1.5, -2.0);
+var b: 4*real = (1.0, 2.0, 3.0, 4.0);
+var c: 4*int(32) = (1, -2, 3, -4);
+var d: 3*real = (1.0, 2.0, 3.0);
+
+a += (0.5, 0.5);
+writeln(a);
+writeln(a * a);
+
+var acc: 4*real;
+for i in 1..n do
+  acc += b * i;
+writeln(acc);
+b[2] = 10.0;
+writeln(b, " ", b[0] + b[1] + b[2] + b[3]);
+
+var ci: 4*int(32);
+for i in 1..n do
+  ci += c;
+writeln(ci);
+writeln(-ci);
+for j in 0..<4 do ci[j] = ci[j] / 2;
+writeln(ci);
+
+// Not a vector: three elements.
+d *= 2.0;
+writeln(d);
+
+// Arrays of vector tuples and passing them by value and by ref.
+proc scale(x: 4*real, f: real) {
+  return x * f;
+}
+
+proc bump(ref x: 2*real) {
+  x[1] += 1.0;
+}
+
+var A: [1..n] 4*real;
+forall i in 1..n do A[i] = scale((1.0, 2.0, 3.0, 4.0), i);
+var s: 4*real;
+for x in A do s += x;
+writeln(s);
+bump(a);
+writeln(a);
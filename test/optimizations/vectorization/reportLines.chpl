@@ -0,0 +1,14 @@
+// --report-vectorized-loops must report foralls at the user's line,
+// not inside the range iterator, including loops left unhinted.
+
+config const n = 100;
+
+var A: [1..n] int;
+forall i in 1..n do
+  A[i] = i;
+
+var s: sync int = 0;
+forall i in 1..n do
+  s.writeEF(s.readFE() + A[i]);
+
+writeln(s.readFE());
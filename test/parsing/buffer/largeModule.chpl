@@ -0,0 +1,6 @@
+// Parse a generated module of about 70KB that ends without a newline,
+// and this file, which also has none.
+use largeGenerated;
+
+writeln(total());
+// no newline after this comment
\ No newline at end of file
@@ -0,0 +1,14 @@
+// Module files are read ahead on other threads while earlier modules
+// are parsed.  Modules found through -M, used from the top level, from
+// other modules and only inside a function all have to be parsed in
+// the same order and to the same program as without prefetching.
+
+use PrefetchA;
+
+proc late() {
+  use PrefetchD;
+  return d();
+}
+
+writeln(a());
+writeln(late());
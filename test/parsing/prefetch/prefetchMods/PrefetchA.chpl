@@ -0,0 +1,7 @@
+module PrefetchA {
+  use PrefetchB;
+
+  proc a() {
+    return "A" + b();
+  }
+}
@@ -0,0 +1,7 @@
+module PrefetchB {
+  use PrefetchC;
+
+  proc b() {
+    return "B" + c();
+  }
+}
@@ -0,0 +1,5 @@
+module PrefetchC {
+  proc c() {
+    return "C";
+  }
+}
@@ -0,0 +1,9 @@
+module PrefetchD {
+  use PrefetchC;
+
+  config const dValue = 4;
+
+  proc d() {
+    return "D" + dValue:string + c();
+  }
+}
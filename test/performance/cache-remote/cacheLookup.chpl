@@ -0,0 +1,51 @@
+// Measure the cost of looking up pages in the remote data cache at
+// different occupancies. This uses chpl_cache_mock_get, which goes
+// through the cache's data structures without communicating.
+
+use Time;
+
+config const cachePages = 1024;   // match CHPL_RT_CACHE_PAGES if set
+config const lookups = 1000000;
+config const printTiming = false;
+
+extern proc chpl_cache_mock_get(node: int(32), raddr: uint(64),
+                                size: c_size_t): c_int;
+
+const pageSize = 1024;
+const node = (numLocales - 1): int(32);
+const base = 0x100000000: uint(64);
+
+proc pageAddr(i: int) {
+  return base + (i * pageSize): uint(64);
+}
+
+// Occupancy in sixteenths of the cache; past 16 the pages don't all fit.
+for sixteenths in [1, 4, 8, 16, 24] {
+  const nPages = max(1, cachePages * sixteenths / 16);
+
+  // Fill the cache with the pages we're about to look up.
+  for i in 0..#nPages do
+    chpl_cache_mock_get(node, pageAddr(i), 8);
+
+  // Cycle through all of the pages ...
+  var t: Timer;
+  t.start();
+  for j in 0..#lookups do
+    chpl_cache_mock_get(node, pageAddr(j % nPages), 8);
+  t.stop();
+  const cycleNs = t.elapsed() * 1e9 / lookups;
+
+  // ... and keep going back to the same few.
+  t.clear();
+  t.start();
+  for j in 0..#lookups do
+    chpl_cache_mock_get(node, pageAddr(j % min(4, nPages)), 8);
+  t.stop();
+  const hotNs = t.elapsed() * 1e9 / lookups;
+
+  writeln("occupancy ", sixteenths, "/16 (", nPages, " pages)");
+  if printTiming {
+    writeln("cycle lookup ns/op at ", sixteenths, "/16: ", cycleNs);
+    writeln("hot lookup ns/op at ", sixteenths, "/16: ", hotNs);
+  }
+}
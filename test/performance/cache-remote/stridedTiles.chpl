@@ -0,0 +1,41 @@
+// Repeatedly copy tiles of a remote block to and from local arrays.
+// With the remote cache on, the strided gets and puts go through the
+// cache, so the tiles fetched on the first pass should be reused on
+// later passes and writes should be visible to later reads.
+
+config const n = 64;
+config const tile = 8;
+config const passes = 4;
+
+on Locales[numLocales-1] {
+  var A: [0..#n, 0..#n] int = [(i,j) in {0..#n, 0..#n}] i*n + j;
+
+  on Locales[0] {
+    var T: [0..#tile, 0..#tile] int;
+    var ok = true;
+
+    for p in 0..#passes {
+      for ti in 0..#(n/tile) {
+        for tj in 0..#(n/tile) {
+          const rows = ti*tile..#tile, cols = tj*tile..#tile;
+          T = A[rows, cols];
+          for (i,j) in {0..#tile, 0..#tile} do
+            if T[i,j] != (ti*tile+i)*n + (tj*tile+j) + p then ok = false;
+        }
+      }
+      // Bump every element with strided puts before the next pass.
+      for ti in 0..#(n/tile) {
+        for tj in 0..#(n/tile) {
+          const rows = ti*tile..#tile, cols = tj*tile..#tile;
+          T = A[rows, cols];
+          T += 1;
+          A[rows, cols] = T;
+        }
+      }
+    }
+    writeln(if ok then "tiles ok" else "tiles MISMATCH");
+  }
+
+  var sum = + reduce A;
+  writeln(sum == (n*n*(n*n-1))/2 + passes*n*n);
+}
@@ -0,0 +1,119 @@
+//
+// Comm layer microbenchmarks.
+//
+// Measures latency and bandwidth of the chpl-comm.h operations (PUT,
+// GET, their _nb, _strd, and unordered variants, and AMOs) plus the
+// three kinds of executeOn, from locale 0 to the last locale, over a
+// range of message sizes and task counts.  With --output=csv or
+// --output=json the results are written to stdout in that form, so
+// runs on different comm layers or builds can be compared directly.
+//
+use SysCTypes, Time;
+
+config const output = "none";          // none, csv, or json
+config const minSize = 8;
+config const maxSize = 1 << 16;
+config const maxTasks = 1;
+config const iters = 100;
+
+extern proc cb_num_ops(): c_int;
+extern proc cb_op_name(op: c_int): c_string;
+extern proc cb_op_sized(op: c_int): c_int;
+extern proc cb_alloc(size: size_t): c_void_ptr;
+extern proc cb_free(p: c_void_ptr);
+extern proc cb_run(op: c_int, node: int(32), lbuf: c_void_ptr,
+                   rbuf: c_void_ptr, size: size_t, iters: int): real;
+extern proc cb_not_fast();
+
+const tgt = Locales[numLocales-1];
+var nRows = 0;
+
+if output != "none" && output != "csv" && output != "json" then
+  halt("--output must be none, csv, or json");
+
+proc report(op: string, size: int, tasks: int, secs: real) {
+  const nOps = tasks * iters;
+  const latUs = secs / iters * 1e6;
+  const mBps = if size == 0 || secs <= 0.0 then 0.0
+               else (nOps * size) / secs / 1e6;
+
+  select output {
+    when "csv" {
+      if nRows == 0 then
+        writeln("comm,op,size,tasks,iters,seconds,lat_us,MBps");
+      writef("%s,%s,%i,%i,%i,%.9dr,%.3dr,%.3dr\n",
+             CHPL_COMM, op, size, tasks, iters, secs, latUs, mBps);
+    }
+    when "json" {
+      writef('%s{"comm":"%s","op":"%s","size":%i,"tasks":%i,"iters":%i,'
+             + '"seconds":%.9dr,"lat_us":%.3dr,"MBps":%.3dr}\n',
+             if nRows == 0 then "[" else ",",
+             CHPL_COMM, op, size, tasks, iters, secs, latUs, mBps);
+    }
+  }
+  nRows += 1;
+}
+
+//
+// Each task gets its own local and remote buffers, twice maxSize so
+// the strided ops have room for their gaps.
+//
+const bufSize = (2 * maxSize): size_t;
+var rbufs: [0..#maxTasks] c_void_ptr;
+on tgt do
+  for r in rbufs do r = cb_alloc(bufSize);
+
+var tasks = 1;
+while tasks <= maxTasks {
+  for op in 0..#cb_num_ops() {
+    const opName = createStringWithNewBuffer(cb_op_name(op: c_int));
+    var sizes = if cb_op_sized(op: c_int) != 0 then minSize..maxSize
+                else 8..8;
+    var size = sizes.low;
+    while size <= sizes.high {
+      var secs: [0..#tasks] real;
+      coforall t in 0..#tasks {
+        const lbuf = cb_alloc(bufSize);
+        secs[t] = cb_run(op: c_int, tgt.id: int(32), lbuf, rbufs[t],
+                         size: size_t, iters);
+        cb_free(lbuf);
+      }
+      if min reduce secs >= 0.0 then
+        report(opName, size, tasks, max reduce secs);
+      size *= 2;
+    }
+  }
+
+  //
+  // executeOns: an empty body runs as a fast executeOn, and one that
+  // calls an extern function does not.
+  //
+  for kind in ["execute_on", "execute_on_fast", "execute_on_nb"] {
+    var secs: [0..#tasks] real;
+    coforall t in 0..#tasks {
+      var timer: Timer;
+      timer.start();
+      select kind {
+        when "execute_on" do
+          for 1..iters do on tgt do cb_not_fast();
+        when "execute_on_fast" do
+          for 1..iters do on tgt do ;
+        when "execute_on_nb" do
+          sync { for 1..iters do begin on tgt do cb_not_fast(); }
+      }
+      timer.stop();
+      secs[t] = timer.elapsed();
+    }
+    report(kind, 0, tasks, max reduce secs);
+  }
+
+  tasks *= 2;
+}
+
+on tgt do
+  for r in rbufs do cb_free(r);
+
+select output {
+  when "none" do writeln("commBench: done");
+  when "json" do if nRows > 0 then writeln("]");
+}
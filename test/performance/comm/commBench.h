@@ -0,0 +1,234 @@
+//////////////////////
+//
+// Interface
+//
+
+//
+// Microbenchmarks for the chpl-comm.h interface, driven from
+// commBench.chpl.  Each cb_run() call does 'iters' repetitions of one
+// op against 'rbuf' on 'node' and returns the elapsed seconds, or -1.0
+// if the op can't be done with this size or comm layer.
+//
+int cb_num_ops(void);
+const char* cb_op_name(int op);
+int cb_op_sized(int op);
+void* cb_alloc(size_t size);
+void cb_free(void* p);
+double cb_run(int op, int32_t node, void* lbuf, void* rbuf,
+              size_t size, int64_t iters);
+void cb_not_fast(void);
+
+
+//////////////////////
+//
+// Implementation
+//
+
+#ifndef _commBench_h_
+#define _commBench_h_
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "chpl-comm.h"
+#include "chpl-mem.h"
+
+typedef enum {
+  cb_op_put,
+  cb_op_get,
+  cb_op_put_nb,
+  cb_op_get_nb,
+  cb_op_put_strd,
+  cb_op_get_strd,
+  cb_op_put_unordered,
+  cb_op_get_unordered,
+  cb_op_amo_fetch_add,
+  cb_op_amo_add_unordered,
+  cb_op_num
+} cb_op_t;
+
+static const char* cb_op_names[] = {
+  "put",
+  "get",
+  "put_nb",
+  "get_nb",
+  "put_strd",
+  "get_strd",
+  "put_unordered",
+  "get_unordered",
+  "amo_fetch_add",
+  "amo_add_unordered",
+};
+
+//
+// Non-blocking ops are issued this many at a time before waiting.
+//
+#define CB_NB_WINDOW 64
+
+//
+// Strided ops move 'size' bytes as this many rows, each followed by a
+// gap of the same size, so the buffers must be 2*size bytes.
+//
+#define CB_STRD_ROWS 8
+
+int cb_num_ops(void) {
+  return cb_op_num;
+}
+
+const char* cb_op_name(int op) {
+  return (op >= 0 && op < cb_op_num) ? cb_op_names[op] : "unknown";
+}
+
+int cb_op_sized(int op) {
+  return op != cb_op_amo_fetch_add && op != cb_op_amo_add_unordered;
+}
+
+void* cb_alloc(size_t size) {
+  void* p = chpl_mem_alloc(size, CHPL_RT_MD_ARRAY_ELEMENTS, 0, 0);
+  memset(p, 0, size);
+  return p;
+}
+
+void cb_free(void* p) {
+  chpl_mem_free(p, 0, 0);
+}
+
+static double cb_now(void) {
+  struct timespec ts;
+  (void) clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void cb_nb(int op, int32_t node, void* lbuf, void* rbuf,
+                  size_t size, int64_t iters) {
+  chpl_comm_nb_handle_t h[CB_NB_WINDOW];
+  int64_t i;
+  int n = 0;
+
+  for (i = 0; i < iters; i++) {
+    h[n++] = (op == cb_op_put_nb)
+             ? chpl_comm_put_nb(lbuf, node, rbuf, size,
+                                CHPL_COMM_UNKNOWN_ID, 0, 0)
+             : chpl_comm_get_nb(lbuf, node, rbuf, size,
+                                CHPL_COMM_UNKNOWN_ID, 0, 0);
+    if (n == CB_NB_WINDOW || i == iters - 1) {
+      int j;
+      for (j = 0; j < n; j++) {
+        while (!chpl_comm_test_nb_complete(h[j])) {
+          chpl_comm_wait_nb_some(&h[j], n - j);
+        }
+      }
+      n = 0;
+    }
+  }
+}
+
+static void cb_strd(int op, int32_t node, void* lbuf, void* rbuf,
+                    size_t size, int64_t iters) {
+  size_t rowBytes = size / CB_STRD_ROWS;
+  size_t strides[1] = { 2 * rowBytes };
+  size_t count[2] = { rowBytes, CB_STRD_ROWS };
+  int64_t i;
+
+  for (i = 0; i < iters; i++) {
+    if (op == cb_op_put_strd) {
+      chpl_comm_put_strd(rbuf, strides, node, lbuf, strides, count,
+                         1, 1, CHPL_COMM_UNKNOWN_ID, 0, 0);
+    } else {
+      chpl_comm_get_strd(lbuf, strides, node, rbuf, strides, count,
+                         1, 1, CHPL_COMM_UNKNOWN_ID, 0, 0);
+    }
+  }
+}
+
+//
+// AMOs need a comm layer with network atomics.
+//
+static int cb_amo(int op, int32_t node, void* rbuf, int64_t iters) {
+#ifdef _chpl_comm_native_atomics_h_
+  int64_t one = 1;
+  int64_t res;
+  int64_t i;
+
+  for (i = 0; i < iters; i++) {
+    if (op == cb_op_amo_fetch_add) {
+      chpl_comm_atomic_fetch_add_int64(&one, node, rbuf, &res,
+                                       memory_order_seq_cst, 0, 0);
+    } else {
+      chpl_comm_atomic_add_unordered_int64(&one, node, rbuf, 0, 0);
+    }
+  }
+  if (op == cb_op_amo_add_unordered) {
+    chpl_comm_atomic_unordered_task_fence();
+  }
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+double cb_run(int op, int32_t node, void* lbuf, void* rbuf,
+              size_t size, int64_t iters) {
+  double start;
+  int64_t i;
+
+  if ((op == cb_op_put_strd || op == cb_op_get_strd)
+      && size < CB_STRD_ROWS) {
+    return -1.0;
+  }
+
+  start = cb_now();
+
+  switch (op) {
+  case cb_op_put:
+    for (i = 0; i < iters; i++) {
+      chpl_comm_put(lbuf, node, rbuf, size, CHPL_COMM_UNKNOWN_ID, 0, 0);
+    }
+    break;
+  case cb_op_get:
+    for (i = 0; i < iters; i++) {
+      chpl_comm_get(lbuf, node, rbuf, size, CHPL_COMM_UNKNOWN_ID, 0, 0);
+    }
+    break;
+  case cb_op_put_nb:
+  case cb_op_get_nb:
+    cb_nb(op, node, lbuf, rbuf, size, iters);
+    break;
+  case cb_op_put_strd:
+  case cb_op_get_strd:
+    cb_strd(op, node, lbuf, rbuf, size, iters);
+    break;
+  case cb_op_put_unordered:
+    for (i = 0; i < iters; i++) {
+      chpl_comm_put_unordered(lbuf, node, rbuf, size,
+                              CHPL_COMM_UNKNOWN_ID, 0, 0);
+    }
+    chpl_comm_getput_unordered_task_fence();
+    break;
+  case cb_op_get_unordered:
+    for (i = 0; i < iters; i++) {
+      chpl_comm_get_unordered(lbuf, node, rbuf, size,
+                              CHPL_COMM_UNKNOWN_ID, 0, 0);
+    }
+    chpl_comm_getput_unordered_task_fence();
+    break;
+  case cb_op_amo_fetch_add:
+  case cb_op_amo_add_unordered:
+    if (!cb_amo(op, node, rbuf, iters)) {
+      return -1.0;
+    }
+    break;
+  default:
+    return -1.0;
+  }
+
+  return cb_now() - start;
+}
+
+//
+// Called in on-bodies that must not be run as fast executeOns.
+//
+void cb_not_fast(void) { }
+
+#endif
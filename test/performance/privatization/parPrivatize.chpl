@@ -0,0 +1,24 @@
+//
+// Stress test for the privatized object table: many tasks creating and
+// destroying distributed domains and arrays at the same time, each of
+// which privatizes itself on every locale.
+//
+use BlockDist, Time;
+
+config const n = 1000;
+config const printTiming = false;
+
+const Space = {1..numLocales};
+
+var st = getCurrentTime();
+forall i in 1..n {
+  const D = Space dmapped Block(Space);
+  var A: [D] int;
+  A = i;
+}
+var dt = getCurrentTime()-st;
+
+if printTiming then
+  writeln("parallel privatization: ", dt);
+
+writeln("done");
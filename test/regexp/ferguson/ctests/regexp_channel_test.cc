@@ -440,6 +440,124 @@ void check_re_channels(void)
   }
 }
 
+// Put a match right around the iobuf boundaries, so that it straddles
+// the buffer parts the channel search looks at.
+void check_block_boundaries(void)
+{
+  qio_hint_t hints[] = {QIO_METHOD_DEFAULT, QIO_METHOD_MEMORY, QIO_METHOD_PREADPWRITE|QIO_HINT_NOFAST};
+  int nhints = sizeof(hints)/sizeof(qio_hint_t);
+  const char* pattern = "ne(e)dle([0-9]{1,3})";
+  const char* needle = "needle427";
+  int64_t len = 3 * qbytes_iobuf_size;
+  char* data = (char*) qio_malloc(len);
+  qio_regexp_t compiled;
+  qioerr err;
+
+  qio_regexp_create_compile_flags(pattern, strlen(pattern), "", 0, false, &compiled);
+
+  for( int h = 0; h < nhints; h++ ) {
+    for( int allow = 0; allow < 2; allow++ ) {
+      re2::FilePiece::set_global_options(1, allow);
+      for( int64_t at = qbytes_iobuf_size - 12; at <= 2*qbytes_iobuf_size + 1; at++ ) {
+        qio_file_t* f;
+        qio_channel_t* writing;
+        qio_channel_t* reading;
+        qio_regexp_string_piece_t caps[3];
+        int64_t maxlen = std::numeric_limits<int64_t>::max();
+
+        if( at == qbytes_iobuf_size + 2 ) at = 2*qbytes_iobuf_size - 12;
+
+        memset(data, 'n', len);
+        memcpy(data + at, needle, strlen(needle));
+
+        if( (hints[h] & QIO_METHODMASK) == QIO_METHOD_MEMORY ) {
+          err = qio_file_open_mem_ext(&f, NULL, (qio_fdflag_t)(QIO_FDFLAG_READABLE|QIO_FDFLAG_WRITEABLE|QIO_FDFLAG_SEEKABLE), hints[h], NULL);
+        } else {
+          err = qio_file_open_tmp(&f, hints[h], NULL);
+        }
+        assert(!err);
+        err = qio_channel_create(&writing, f, hints[h], 0, 1, 0, maxlen, NULL);
+        assert(!err);
+        err = qio_channel_write_amt(false, writing, data, len);
+        assert(!err);
+        qio_channel_release(writing);
+
+        err = qio_channel_create(&reading, f, hints[h], 1, 0, 0, maxlen, NULL);
+        assert(!err);
+        qio_channel_mark(false, reading);
+        err = qio_regexp_channel_match(&compiled, false, reading, maxlen, QIO_REGEXP_ANCHOR_UNANCHORED, true, false, false, caps, 3);
+        assert(!err);
+        assert(caps[0].offset == at && caps[0].len == 9);
+        assert(caps[1].offset == at + 2 && caps[1].len == 1);
+        assert(caps[2].offset == at + 6 && caps[2].len == 3);
+        assert(qio_channel_offset_unlocked(reading) == at + 9);
+
+        // There's no second match.
+        err = qio_regexp_channel_match(&compiled, false, reading, maxlen, QIO_REGEXP_ANCHOR_UNANCHORED, true, false, false, caps, 3);
+        assert(qio_err_to_int(err) == EFORMAT);
+        assert(caps[0].offset == -1);
+
+        qio_channel_release(reading);
+        qio_file_release(f);
+      }
+    }
+  }
+
+  qio_regexp_release(&compiled);
+  qio_free(data);
+}
+
+// Match a set of patterns against each line of a channel.
+void check_set_channel(void)
+{
+  const char* data = "INFO start\nwarning: slow\n\nerror 42 ms";
+  const char* pats[] = {"error", "warn(ing)?", "^INFO", "[0-9]+ ms"};
+  int npats = sizeof(pats)/sizeof(pats[0]);
+  int64_t expect_n[] = {1, 1, 0, 2};
+  int64_t expect_first[] = {2, 1, -1, 0};
+  int nlines = sizeof(expect_n)/sizeof(expect_n[0]);
+  qio_regexp_options_t opts;
+  qio_regexp_set_t set;
+  const char* err_str = NULL;
+  qio_file_t* f;
+  qio_channel_t* writing;
+  qio_channel_t* reading;
+  int64_t matched[4];
+  int64_t n;
+  qioerr err;
+
+  qio_regexp_init_default_options(&opts);
+  qio_regexp_set_create(&opts, QIO_REGEXP_ANCHOR_UNANCHORED, &set);
+  for( int i = 0; i < npats; i++ ) {
+    assert(qio_regexp_set_add(&set, pats[i], strlen(pats[i]), &err_str) == i);
+  }
+  assert(qio_regexp_set_compile(&set));
+
+  err = qio_file_open_mem_ext(&f, NULL, (qio_fdflag_t)(QIO_FDFLAG_READABLE|QIO_FDFLAG_WRITEABLE|QIO_FDFLAG_SEEKABLE), QIO_METHOD_MEMORY, NULL);
+  assert(!err);
+  err = qio_channel_create(&writing, f, 0, 0, 1, 0, std::numeric_limits<int64_t>::max(), NULL);
+  assert(!err);
+  err = qio_channel_write_amt(true, writing, data, strlen(data));
+  assert(!err);
+  qio_channel_release(writing);
+
+  err = qio_channel_create(&reading, f, 0, 1, 0, 0, std::numeric_limits<int64_t>::max(), NULL);
+  assert(!err);
+
+  for( int i = 0; i < nlines; i++ ) {
+    err = qio_regexp_set_channel_match(&set, true, reading, std::numeric_limits<int64_t>::max(), '\n', matched, 4, &n);
+    assert(!err);
+    assert(n == expect_n[i]);
+    if( n > 0 ) assert(matched[0] == expect_first[i]);
+  }
+  err = qio_regexp_set_channel_match(&set, true, reading, std::numeric_limits<int64_t>::max(), '\n', matched, 4, &n);
+  assert(qio_err_to_int(err) == EEOF);
+
+  qio_channel_release(reading);
+  qio_file_release(f);
+  qio_regexp_set_destroy(&set);
+}
+
 int main(int argc, char** argv)
 {
   // use smaller mmap chunks for testing.
@@ -450,6 +568,8 @@ int main(int argc, char** argv)
 
   assert(RE2::FullMatch("hello", "h.*o"));
   check_re_channels();
+  check_block_boundaries();
+  check_set_channel();
   return 0;
 }
 
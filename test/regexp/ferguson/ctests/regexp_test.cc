@@ -2,7 +2,9 @@
 #include "qio.h"
 #include "qio_regexp.h"
 #include <assert.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "re2/re2.h"
 
@@ -49,6 +51,78 @@ void check_minmax_match(void)
   }
 }
 
+// Regexps compiled on different threads come from the shared cache.
+static void* compile_on_thread(void* arg)
+{
+  qio_regexp_t* compiled = (qio_regexp_t*) arg;
+  const char* pat = "shared (cache)+";
+  qio_regexp_create_compile_flags(pat, strlen(pat), "i", 1, true, compiled);
+  return NULL;
+}
+
+void check_shared_cache(void)
+{
+  qio_regexp_t a, b, c;
+  pthread_t thread;
+  const char* pat = "shared (cache)+";
+
+  qio_regexp_create_compile_flags(pat, strlen(pat), "i", 1, true, &a);
+  assert(qio_regexp_ok(&a));
+
+  pthread_create(&thread, NULL, compile_on_thread, &b);
+  pthread_join(thread, NULL);
+  assert(b.regexp == a.regexp);
+
+  // Different options are a different regexp.
+  qio_regexp_create_compile_flags(pat, strlen(pat), "", 0, true, &c);
+  assert(c.regexp != a.regexp);
+
+  qio_regexp_release(&a);
+  qio_regexp_release(&b);
+  qio_regexp_release(&c);
+}
+
+void check_set_match(void)
+{
+  const char* pats[] = {"error", "warn(ing)?", "^INFO", "[0-9]+ ms"};
+  int npats = sizeof(pats)/sizeof(pats[0]);
+  qio_regexp_options_t opts;
+  qio_regexp_set_t set;
+  const char* err_str = NULL;
+  int64_t matched[4];
+  int64_t n;
+
+  qio_regexp_init_default_options(&opts);
+  qio_regexp_set_create(&opts, QIO_REGEXP_ANCHOR_UNANCHORED, &set);
+
+  // Matching before compiling fails.
+  assert(qio_regexp_set_match(&set, "error", 5, matched, 4) == -1);
+
+  for( int i = 0; i < npats; i++ ) {
+    assert(qio_regexp_set_add(&set, pats[i], strlen(pats[i]), &err_str) == i);
+    assert(err_str == NULL);
+  }
+  assert(qio_regexp_set_add(&set, "(", 1, &err_str) == -1);
+  assert(err_str != NULL);
+  qio_free((void*) err_str);
+
+  assert(qio_regexp_set_compile(&set));
+
+  n = qio_regexp_set_match(&set, "INFO took 12 ms", 15, matched, 4);
+  assert(n == 2 && matched[0] == 2 && matched[1] == 3);
+
+  n = qio_regexp_set_match(&set, "error: warning 3 ms", 19, matched, 4);
+  assert(n == 3 && matched[0] == 0 && matched[1] == 1 && matched[2] == 3);
+
+  // Only as many as fit are stored.
+  n = qio_regexp_set_match(&set, "error: warning 3 ms", 19, matched, 1);
+  assert(n == 3 && matched[0] == 0);
+
+  n = qio_regexp_set_match(&set, "all quiet", 9, matched, 4);
+  assert(n == 0);
+
+  qio_regexp_set_destroy(&set);
+}
 
 int main(int argc, char** argv)
 {
@@ -58,6 +132,8 @@ int main(int argc, char** argv)
   assert(RE2::FullMatch("", "$"));
 
   check_minmax_match();
+  check_shared_cache();
+  check_set_match();
 
   return 0;
 }
@@ -0,0 +1,69 @@
+#include "deque.h"
+#include "rt-bench.h"
+#include <assert.h>
+
+// Each thread works on its own deque, as the I/O layer does.
+
+// Queue use: push at the back, pop at the front once it holds 64.
+static uint64_t bench_push_pop(int tid, int nthreads, int64_t nops,
+                               void* arg) {
+  const ssize_t sz = sizeof(int64_t);
+  deque_t d;
+  qioerr err;
+  uint64_t sum = 0;
+  int64_t i;
+
+  err = deque_init(sz, &d, 0);
+  assert(!err);
+  for (i = 0; i < nops; i++) {
+    err = deque_push_back(sz, &d, &i);
+    assert(!err);
+    if (deque_size(sz, &d) >= 64) {
+      int64_t v;
+      deque_it_get_cur(sz, deque_begin(&d), &v);
+      sum += v;
+      deque_pop_front(sz, &d);
+    }
+  }
+  while (deque_size(sz, &d) > 0) {
+    int64_t v;
+    deque_it_get_cur(sz, deque_begin(&d), &v);
+    sum += v;
+    deque_pop_front(sz, &d);
+  }
+  deque_destroy(&d);
+  return sum;
+}
+
+// Stack use at the front, which has to grow the map at the front.
+static uint64_t bench_push_front(int tid, int nthreads, int64_t nops,
+                                 void* arg) {
+  const ssize_t sz = sizeof(int64_t);
+  deque_t d;
+  qioerr err;
+  uint64_t sum = 0;
+  int64_t i;
+
+  err = deque_init(sz, &d, 0);
+  assert(!err);
+  for (i = 0; i < nops; i++) {
+    err = deque_push_front(sz, &d, &i);
+    assert(!err);
+  }
+  while (deque_size(sz, &d) > 0) {
+    int64_t v;
+    deque_it_get_cur(sz, deque_begin(&d), &v);
+    sum += v;
+    deque_pop_front(sz, &d);
+  }
+  deque_destroy(&d);
+  return sum;
+}
+
+int main(int argc, char** argv) {
+  rt_bench_run("deque_push_pop", bench_push_pop, NULL,
+               RT_BENCH_OPS(20000000));
+  rt_bench_run("deque_push_front", bench_push_front, NULL,
+               RT_BENCH_OPS(10000000));
+  return 0;
+}
@@ -0,0 +1,68 @@
+#include "qbuffer.h"
+#include "rt-bench.h"
+#include <assert.h>
+
+// Reference counting on bytes shared by all threads, which is where
+// threads doing I/O on one channel's buffers contend.
+static uint64_t bench_retain_release(int tid, int nthreads, int64_t nops,
+                                     void* arg) {
+  qbytes_t* b = (qbytes_t*) arg;
+  int64_t i;
+
+  for (i = 0; i < nops; i++) {
+    qbytes_retain(b);
+    qbytes_release(b);
+  }
+  return nops;
+}
+
+// Build up a buffer from many small parts and walk it.
+static uint64_t bench_append(int tid, int nthreads, int64_t nops,
+                             void* arg) {
+  qbuffer_t buf;
+  qbytes_t* b;
+  qbuffer_iter_t cur, end;
+  uint64_t len;
+  int64_t i;
+  qioerr err;
+
+  err = qbytes_create_calloc(&b, 64);
+  assert(!err);
+  err = qbuffer_init(&buf);
+  assert(!err);
+  for (i = 0; i < nops; i++) {
+    err = qbuffer_append(&buf, b, i % 16, 32);
+    assert(!err);
+  }
+
+  len = 0;
+  cur = qbuffer_begin(&buf);
+  end = qbuffer_end(&buf);
+  while (!qbuffer_iter_same_part(cur, end)) {
+    qbytes_t* bytes;
+    int64_t skip, n;
+    qbuffer_iter_get(cur, end, &bytes, &skip, &n);
+    len += n;
+    qbuffer_iter_next_part(&buf, &cur);
+  }
+
+  qbuffer_destroy(&buf);
+  qbytes_release(b);
+  return len;
+}
+
+int main(int argc, char** argv) {
+  qbytes_t* shared;
+  qioerr err;
+
+  err = qbytes_create_calloc(&shared, 64);
+  assert(!err);
+
+  rt_bench_run("qbytes_retain_release", bench_retain_release, shared,
+               RT_BENCH_OPS(10000000));
+  qbytes_release(shared);
+
+  rt_bench_run("qbuffer_append", bench_append, NULL,
+               RT_BENCH_OPS(2000000));
+  return 0;
+}
@@ -0,0 +1,154 @@
+//
+// A small harness for runtime microbenchmarks.  Like the runtime unit
+// tests these are .test.c files built with -DCHPL_RT_UNIT_TEST and the
+// runtime sources they exercise named in their .compopts.
+//
+// A benchmark is a function that each thread calls to do some number
+// of operations, returning a check value.  rt_bench_run() runs it for
+// each thread count in CHPL_RT_BENCH_THREADS (a comma-separated list,
+// default "1,2,4") and prints, per thread count,
+//
+//   <name> <n>T check: <sum of the check values>
+//
+// and, when built with -DPRINT_TIMING (the .perfcompopts),
+//
+//   <name> <n>T ns/op: <wall time / ops per thread>
+//   <name> <n>T Mops/s: <total ops / wall time>
+//
+// for the .perfkeys.  If CHPL_RT_BENCH_JSON names a file, each result
+// is also appended to it as one line of JSON, so results from runs on
+// different commits can be diffed.  CHPL_RT_BENCH_LABEL, if set, is
+// included in those lines to tell the runs apart.
+//
+// Without PRINT_TIMING the operation counts are cut down so that the
+// correctness run is quick.
+//
+
+#ifndef _rt_bench_h_
+#define _rt_bench_h_
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef PRINT_TIMING
+#define RT_BENCH_OPS(n) ((int64_t) (n))
+#else
+#define RT_BENCH_OPS(n) ((int64_t) (n) / 1000 + 1)
+#endif
+
+typedef uint64_t (*rt_bench_fn_t)(int tid, int nthreads,
+                                  int64_t nops, void* arg);
+
+typedef struct {
+  rt_bench_fn_t fn;
+  void* arg;
+  int tid;
+  int nthreads;
+  int64_t nops;
+  pthread_barrier_t* bar;
+  uint64_t check;
+  double start;
+  double end;
+} rt_bench_thread_t;
+
+static double rt_bench_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void* rt_bench_thread(void* a) {
+  rt_bench_thread_t* t = (rt_bench_thread_t*) a;
+  pthread_barrier_wait(t->bar);
+  t->start = rt_bench_now_ns();
+  t->check = t->fn(t->tid, t->nthreads, t->nops, t->arg);
+  t->end = rt_bench_now_ns();
+  return NULL;
+}
+
+static void rt_bench_json(const char* name, int nthreads, int64_t nops,
+                          double nsPerOp, double opsPerSec) {
+  const char* path = getenv("CHPL_RT_BENCH_JSON");
+  const char* label = getenv("CHPL_RT_BENCH_LABEL");
+  FILE* f;
+
+  if (path == NULL || path[0] == '\0')
+    return;
+  if ((f = fopen(path, "a")) == NULL) {
+    perror(path);
+    return;
+  }
+  fprintf(f, "{\"benchmark\": \"%s\", \"label\": \"%s\", \"threads\": %d, "
+          "\"ops_per_thread\": %" PRId64 ", \"ns_per_op\": %.3f, "
+          "\"ops_per_sec\": %.0f}\n",
+          name, (label == NULL) ? "" : label, nthreads, nops,
+          nsPerOp, opsPerSec);
+  fclose(f);
+}
+
+static void rt_bench_run_one(const char* name, rt_bench_fn_t fn, void* arg,
+                             int nthreads, int64_t nops) {
+  rt_bench_thread_t* ts = calloc(nthreads, sizeof(*ts));
+  pthread_t* tids = calloc(nthreads, sizeof(*tids));
+  pthread_barrier_t bar;
+  uint64_t check = 0;
+  double start, end, elapsed;
+  int i;
+
+  // The threads start together at the barrier.  The wall time is from
+  // the first of them starting to the last finishing.
+  pthread_barrier_init(&bar, NULL, nthreads);
+  for (i = 0; i < nthreads; i++) {
+    ts[i] = (rt_bench_thread_t) { fn, arg, i, nthreads, nops, &bar, 0 };
+    pthread_create(&tids[i], NULL, rt_bench_thread, &ts[i]);
+  }
+  start = end = 0;
+  for (i = 0; i < nthreads; i++) {
+    pthread_join(tids[i], NULL);
+    check += ts[i].check;
+    if (i == 0 || ts[i].start < start)
+      start = ts[i].start;
+    if (ts[i].end > end)
+      end = ts[i].end;
+  }
+  elapsed = end - start;
+  pthread_barrier_destroy(&bar);
+
+  printf("%s %dT check: %" PRIu64 "\n", name, nthreads, check);
+#ifdef PRINT_TIMING
+  printf("%s %dT ns/op: %.3f\n", name, nthreads, elapsed / nops);
+  printf("%s %dT Mops/s: %.3f\n", name, nthreads,
+         (nops * nthreads) / elapsed * 1e3);
+#endif
+  rt_bench_json(name, nthreads, nops, elapsed / nops,
+                (nops * nthreads) / elapsed * 1e9);
+
+  free(tids);
+  free(ts);
+}
+
+static void rt_bench_run(const char* name, rt_bench_fn_t fn, void* arg,
+                         int64_t nops) {
+  const char* list = getenv("CHPL_RT_BENCH_THREADS");
+  char* p;
+
+  if (list == NULL || list[0] == '\0')
+    list = "1,2,4";
+  for (p = (char*) list; *p != '\0'; ) {
+    long n = strtol(p, &p, 10);
+    if (n > 0)
+      rt_bench_run_one(name, fn, arg, (int) n, nops);
+    if (*p == ',')
+      p++;
+    else if (*p != '\0')
+      break;
+  }
+  fflush(stdout);
+}
+
+#endif
@@ -0,0 +1,61 @@
+// Every node calls the comm layer's collectives in the same order and
+// has to get the same results.  Three nodes aren't a power of two, so
+// the allreduce has to fold the extra node in.
+
+use CPtr, SysCTypes;
+
+extern type chpl_comm_coll_type_t = c_int;
+extern type chpl_comm_coll_op_t = c_int;
+
+extern const chpl_comm_coll_int64: chpl_comm_coll_type_t;
+extern const chpl_comm_coll_real64: chpl_comm_coll_type_t;
+extern const chpl_comm_coll_sum: chpl_comm_coll_op_t;
+extern const chpl_comm_coll_max: chpl_comm_coll_op_t;
+extern const chpl_comm_coll_bxor: chpl_comm_coll_op_t;
+
+extern proc chpl_comm_allreduce(buf: c_void_ptr, count: c_size_t,
+                                type_: chpl_comm_coll_type_t,
+                                op: chpl_comm_coll_op_t);
+extern proc chpl_comm_allgather(src: c_void_ptr, dst: c_void_ptr,
+                                size: c_size_t);
+extern proc chpl_comm_bcast(buf: c_void_ptr, size: c_size_t, root: int(32));
+
+config const count = 1000;
+
+var results: [0..#numLocales] string;
+
+coforall loc in Locales do on loc {
+  const me = here.id;
+
+  // Sums and maxima of many elements, and an xor of one.
+  var sums: [0..#count] int = [i in 0..#count] i + me;
+  chpl_comm_allreduce(c_ptrTo(sums[0]), count: c_size_t,
+                      chpl_comm_coll_int64, chpl_comm_coll_sum);
+  var sumsOk = true;
+  for i in 0..#count do
+    if sums[i] != numLocales * i + numLocales * (numLocales - 1) / 2 then
+      sumsOk = false;
+
+  var m: real = me * 1.5;
+  chpl_comm_allreduce(c_ptrTo(m), 1, chpl_comm_coll_real64,
+                      chpl_comm_coll_max);
+
+  var x = 1 << me;
+  chpl_comm_allreduce(c_ptrTo(x), 1, chpl_comm_coll_int64,
+                      chpl_comm_coll_bxor);
+
+  // Gather each node's id and square.
+  var mine = (me, me * me);
+  var all: [0..#numLocales] 2*int;
+  chpl_comm_allgather(c_ptrTo(mine), c_ptrTo(all[0]),
+                      c_sizeof(2*int));
+
+  // Broadcast from the last node.
+  var b = if me == numLocales - 1 then 42 else -1;
+  chpl_comm_bcast(c_ptrTo(b), c_sizeof(int), (numLocales - 1): int(32));
+
+  results[me] = sumsOk:string + " " + m:string + " " + x:string + " " +
+                all:string + " " + b:string;
+}
+
+for r in results do writeln(r);
@@ -0,0 +1,14 @@
+// With CHPL_RT_COMM_DIAGS_COUNTS_FILE set, each locale writes its
+// communication counts to a file at exit, without the program asking
+// for diagnostics.
+
+config const n = 100;
+
+var A: [1..n] int;
+
+on Locales[1] {
+  for i in 1..n do A[i] = i;
+  var s = 0;
+  for i in 1..n do s += A[i];
+  writeln(s);
+}
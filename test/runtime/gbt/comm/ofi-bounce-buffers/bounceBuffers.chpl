@@ -0,0 +1,69 @@
+// PUTs and GETs from memory the network doesn't know about, here memory
+// from the system allocator, go through bounce buffers: pooled ones for
+// small transfers and a pipeline of them for large ones.  Data has to
+// arrive intact whatever the size.
+
+use CPtr, SysCTypes;
+
+require "chpl-mem-sys.h";
+
+extern proc sys_malloc(size: c_size_t): c_void_ptr;
+extern proc sys_free(p: c_void_ptr);
+extern proc chpl_comm_put(addr: c_void_ptr, node: int(32), raddr: c_void_ptr,
+                          size: c_size_t, commID: int(32), ln: c_int,
+                          fn: int(32));
+extern proc chpl_comm_get(addr: c_void_ptr, node: int(32), raddr: c_void_ptr,
+                          size: c_size_t, commID: int(32), ln: c_int,
+                          fn: int(32));
+
+config const maxInts = 40000;
+
+const other = Locales[numLocales-1];
+const otherNode = other.id: int(32);
+
+// One registered buffer per task on the other node.
+config const numTasks = 8;
+var remoteBufs: [0..numTasks] c_void_ptr;
+on other {
+  for b in remoteBufs do b = c_malloc(int, maxInts): c_void_ptr;
+}
+
+proc check(len: int, buf = 0) {
+  const raddr = remoteBufs[buf];
+  const size = (len * numBytes(int)): c_size_t;
+  const local = sys_malloc(size): c_ptr(int);
+  var ok = true;
+
+  for i in 0..#len do local[i] = i * 3 + len;
+  chpl_comm_put(local: c_void_ptr, otherNode, raddr, size, 0, 0, 0);
+
+  on other {
+    const r = raddr: c_ptr(int);
+    for i in 0..#len do
+      if r[i] != i * 3 + len then ok = false;
+  }
+
+  for i in 0..#len do local[i] = 0;
+  chpl_comm_get(local: c_void_ptr, otherNode, raddr, size, 0, 0, 0);
+  for i in 0..#len do
+    if local[i] != i * 3 + len then ok = false;
+
+  sys_free(local: c_void_ptr);
+  return ok;
+}
+
+// Sizes in the small pools, at and just past the largest pool buffer,
+// and several pipeline stages long.
+writeln(check(1), " ", check(8), " ", check(100), " ", check(1000));
+writeln(check(8192), " ", check(8193), " ", check(maxInts));
+
+// Several tasks using their tx contexts' pools at once.
+var allOk: atomic bool = true;
+coforall t in 1..numTasks do
+  for 1..10 do
+    if !check(300, t) || !check(9000, t) then allOk.write(false);
+writeln(allOk.read());
+
+on other {
+  for b in remoteBufs do c_free(b);
+}
@@ -0,0 +1,35 @@
+// With lazy address vector insertion, a node's address is inserted the
+// first time something is sent to it.  Reach the nodes in different
+// orders and through different kinds of operations.
+
+config const n = 100;
+
+var A: [0..#numLocales] int;
+var counts: [0..#numLocales] atomic int;
+
+// First contact from node 0 by a GET, then by a PUT.
+for loc in Locales by -1 {
+  var x: int;
+  on loc do x = here.id;
+  A[loc.id] = x;
+}
+writeln(A);
+
+// Every node contacts every other, higher ids first.
+coforall loc in Locales do on loc {
+  for other in Locales by -1 do
+    counts[other.id].add(1);
+}
+writeln(counts.read());
+
+// Executes an on-statement on a node that only node 0 has talked to.
+var sums: [0..#numLocales] int;
+coforall loc in Locales do on loc {
+  const peer = Locales[(here.id + 1) % numLocales];
+  var s = 0;
+  on peer {
+    for i in 1..n do s += i;
+  }
+  sums[here.id] = s;
+}
+writeln(sums);
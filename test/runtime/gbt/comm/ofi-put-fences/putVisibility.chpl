@@ -0,0 +1,43 @@
+// PUTs to remote nodes have to be visible after the fences the memory
+// consistency model requires: task end, on-statements, and atomic
+// writes used as flags.  Tasks write to several nodes, one node, or
+// none at all before each fence.
+
+use BlockDist;
+
+config const n = 1000;
+
+const D = {0..#n*numLocales} dmapped Block({0..#n*numLocales});
+var A: [D] int;
+
+// Each task writes everywhere; task end must make it all visible.
+coforall loc in Locales do on loc {
+  for i in D by numLocales align here.id do A[i] = i;
+}
+writeln(+ reduce A == (n*numLocales) * (n*numLocales - 1) / 2);
+
+// A write followed by an on-statement to another node.
+var x: [0..#numLocales] int;
+on Locales[numLocales-1] {
+  x[0] = 42;
+  on Locales[0] do writeln(x[0]);
+}
+
+// Release/acquire through an atomic flag.
+var data: int;
+var flag: atomic bool;
+cobegin {
+  on Locales[numLocales-1] {
+    data = 7;
+    flag.write(true);
+  }
+  {
+    flag.waitFor(true);
+    writeln(data);
+  }
+}
+
+// Tasks with nothing outstanding.
+var total: atomic int;
+coforall loc in Locales do on loc do total.add(here.id);
+writeln(total.read());
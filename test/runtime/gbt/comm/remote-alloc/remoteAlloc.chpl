@@ -0,0 +1,61 @@
+// Memory allocated on another node without an on-statement has to be
+// usable there, both small blocks from the pools and large ones, and
+// freeing it must not disturb the blocks still in use.
+
+use CPtr, SysCTypes;
+
+extern proc chpl_comm_remote_alloc(node: int(32), size: c_size_t,
+                                   ln: c_int, fn: int(32)): c_void_ptr;
+extern proc chpl_comm_remote_alloc_batch(node: int(32), size: c_size_t,
+                                         n: c_size_t, ptrs: c_ptr(c_void_ptr),
+                                         ln: c_int, fn: int(32));
+extern proc chpl_comm_remote_free(node: int(32), p: c_void_ptr,
+                                  ln: c_int, fn: int(32));
+
+config const numBlocks = 100;
+
+proc check(loc: locale, size: int, n: int) {
+  const node = loc.id: int(32);
+  var ptrs: [0..#n] c_void_ptr;
+
+  if n == 1 then
+    ptrs[0] = chpl_comm_remote_alloc(node, size: c_size_t, 0, 0);
+  else
+    chpl_comm_remote_alloc_batch(node, size: c_size_t, n: c_size_t,
+                                 c_ptrTo(ptrs[0]), 0, 0);
+
+  const numInts = size / numBytes(int);
+  var ok = true;
+  on loc {
+    const ps = ptrs;
+    // Fill every block, then check none of them overlap.
+    for (p, i) in zip(ps, 0..) {
+      const ip = p: c_ptr(int);
+      for j in 0..#numInts do ip[j] = i * numInts + j;
+    }
+    for (p, i) in zip(ps, 0..) {
+      const ip = p: c_ptr(int);
+      for j in 0..#numInts do
+        if ip[j] != i * numInts + j then ok = false;
+    }
+  }
+
+  for p in ptrs do chpl_comm_remote_free(node, p, 0, 0);
+  return ok;
+}
+
+for loc in Locales {
+  writeln(loc.id, ": ",
+          check(loc, 16, 1), " ",
+          check(loc, 256, numBlocks), " ",
+          check(loc, 4096, 1), " ",
+          check(loc, 1 << 20, 4));
+}
+
+// Several tasks allocating on the same node at once.
+var allOk: atomic bool = true;
+coforall t in 1..8 {
+  for loc in Locales do
+    if !check(loc, 64, numBlocks) then allOk.write(false);
+}
+writeln(allOk.read());
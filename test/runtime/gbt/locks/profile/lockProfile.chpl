@@ -0,0 +1,32 @@
+// Channels are guarded by ticket locks.  Many tasks writing through one
+// channel have to get their writes in whole, and with lock profiling on
+// the channel lock's site is reported at exit.
+
+use IO;
+
+config const numTasks = 16;
+config const n = 1000;
+
+var f = openmem();
+{
+  var w = f.writer();
+  coforall t in 1..numTasks with (ref w) {
+    for i in 1..n do w.writeln(t, " ", i);
+  }
+  w.close();
+}
+
+var counts: [1..numTasks] int;
+var sums: [1..numTasks] int;
+{
+  var r = f.reader();
+  var t, i: int;
+  while r.read(t, i) {
+    counts[t] += 1;
+    sums[t] += i;
+  }
+  r.close();
+}
+writeln(&& reduce (counts == n));
+writeln(&& reduce (sums == n * (n + 1) / 2));
+f.close();
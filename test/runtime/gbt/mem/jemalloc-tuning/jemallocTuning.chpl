@@ -0,0 +1,10 @@
+// Run allocation-heavy string work with per-NUMA arenas, a bigger
+// tcache limit, and decay-based purging all turned on.
+config const n = 100_000;
+
+var total = 0;
+forall i in 1..n with (+ reduce total) {
+  const s = "item-" + i:string;
+  total += s.size;
+}
+writeln(total);
@@ -0,0 +1,28 @@
+// Exercise the large-array allocation path: allocate arrays above the
+// (lowered) threshold, grow and shrink them across it, and check that
+// the contents survive.
+config const n = 1_000_000;
+
+var D = {1..n};
+var A: [D] int;
+forall i in D do A[i] = i;
+writeln(+ reduce A == n * (n + 1) / 2);
+
+// grow, staying large
+D = {1..2*n};
+writeln(&& reduce [i in 1..n] A[i] == i);
+forall i in n+1..2*n do A[i] = i;
+
+// shrink below the threshold, then grow back above it
+D = {1..n/100};
+writeln(&& reduce [i in 1..n/100] A[i] == i);
+D = {1..n};
+writeln(&& reduce [i in 1..n/100] A[i] == i);
+
+// grow repeatedly, past any reservation, then shrink while staying large
+for k in 2..4 {
+  D = {1..k*n};
+  forall i in (k-1)*n+1..k*n do A[i] = i;
+}
+D = {1..2*n};
+writeln(&& reduce [i in 1..2*n] A[i] == i);
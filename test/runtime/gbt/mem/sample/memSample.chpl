@@ -0,0 +1,14 @@
+// Exercise the sampling heap profiler: allocate enough that some
+// allocations are sampled, then check that a heap profile is printed
+// at exit.
+config const n = 10_000;
+
+class C { var x: [1..100] int; }
+
+var total = 0;
+for i in 1..n {
+  var c = new owned C();
+  c.x[1] = i;
+  total += c.x[1];
+}
+writeln(total == n * (n + 1) / 2);
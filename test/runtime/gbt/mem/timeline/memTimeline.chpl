@@ -0,0 +1,12 @@
+// Run long enough for the memory timeline sampler to write some rows,
+// with usage that rises and falls.
+use Time;
+
+config const phases = 3;
+
+for p in 1..phases {
+  var A: [1..100_000*p] real;
+  A = p;
+  sleep(0.3);
+  writeln(+ reduce A == 100_000*p*p);
+}
@@ -0,0 +1,19 @@
+// Allocate and free from many tasks at once with memory tracking on,
+// enough to make the tracking table shards resize both ways, and check
+// that the tracked total comes back to where it started.
+use MemDiagnostics;
+
+config const n = 100_000;
+
+class C { var x: int; }
+
+const before = memoryUsed();
+coforall t in 1..here.maxTaskPar {
+  var cs: [1..n/here.maxTaskPar] unmanaged C?;
+  for c in cs do c = new unmanaged C(t);
+  var sum = 0;
+  for c in cs do sum += c!.x;
+  for c in cs do delete c;
+  if sum != t * (n/here.maxTaskPar) then writeln("bad sum in task ", t);
+}
+writeln(memoryUsed() == before);
@@ -0,0 +1,41 @@
+// With the spawn helper, subprocesses are started by a helper process
+// rather than by the program.  Pipes, environments, exit codes and
+// concurrent spawns have to work the same as without it.
+
+use Spawn;
+
+// Output through a pipe.
+var echo = spawn(["echo", "hello"], stdout=PIPE);
+var line: string;
+while echo.stdout.readline(line) do write(line);
+echo.wait();
+writeln(echo.exitCode);
+
+// Input and output through pipes.
+var cat = spawn(["cat"], stdin=BUFFERED_PIPE, stdout=PIPE);
+cat.stdin.writeln("through cat");
+cat.communicate();
+while cat.stdout.readline(line) do write(line);
+writeln(cat.exitCode);
+
+// An explicit environment and a nonzero exit code.
+var sh = spawn(["sh", "-c", "echo $GREETING; exit 3"],
+               env=["GREETING=hi there"], stdout=PIPE);
+while sh.stdout.readline(line) do write(line);
+sh.wait();
+writeln(sh.exitCode);
+
+// Standard error, forwarded to a pipe.
+var err = spawn(["sh", "-c", "echo oops 1>&2"], stderr=PIPE);
+while err.stderr.readline(line) do write(line);
+err.wait();
+
+// Several tasks spawning and waiting at once.
+config const numTasks = 8;
+var codes: [1..numTasks] int;
+coforall i in 1..numTasks {
+  var sub = spawn(["sh", "-c", "exit " + i:string]);
+  sub.wait();
+  codes[i] = sub.exitCode;
+}
+writeln(codes);
@@ -0,0 +1,13 @@
+// Check the runtime's in-place short string helpers around word and
+// buffer boundaries, and the interned string table.
+proc main {
+  extern proc short_copy_report();
+  extern proc short_concat_report();
+  extern proc short_select_report();
+  extern proc intern_report();
+
+  short_copy_report();
+  short_concat_report();
+  short_select_report();
+  intern_report();
+}
@@ -0,0 +1,161 @@
+//////////////////////
+//
+// Interface
+//
+
+void short_copy_report(void);
+void short_concat_report(void);
+void short_select_report(void);
+void intern_report(void);
+
+
+//////////////////////
+//
+// Implementation
+//
+
+#ifndef _str_util_h_
+#define _str_util_h_
+
+#include <stdio.h>
+#include <string.h>
+
+#include "chpl-string.h"
+#include "chpl-string-support.h"
+
+// A string of n bytes, cycling through the lowercase letters.
+static const char* str_n(int n) {
+  static char s[2 * CHPL_SHORT_STRING_SIZE + 2];
+  int i;
+  for (i = 0; i < n; i++)
+    s[i] = 'a' + i % 26;
+  s[n] = '\0';
+  return s;
+}
+
+static const char* where(chpl__inPlaceBuffer* buf, c_string s) {
+  return chpl__isInPlaceBufferData(buf, s) ? "inline" : "heap";
+}
+
+// Lengths around the 8-byte words and the end of the in-place buffer.
+static const int str_lens[] = { 0, 7, 8, 9, 15, 16, 17,
+                                CHPL_SHORT_STRING_SIZE - 1,
+                                CHPL_SHORT_STRING_SIZE,
+                                CHPL_SHORT_STRING_SIZE + 1, -1 };
+
+void short_copy_report(void) {
+  int i;
+  for (i = 0; str_lens[i] >= 0; i++) {
+    chpl__inPlaceBuffer buf;
+    const char* x = str_n(str_lens[i]);
+    c_string s = chpl__inPlaceBufferCopy(&buf, x, 0, 0);
+    printf("copy %d: %s %s\n", str_lens[i], where(&buf, s),
+           strcmp(s, x) == 0 ? "ok" : "WRONG");
+    chpl__inPlaceBufferFree(&buf, s, 0, 0);
+  }
+}
+
+void short_concat_report(void) {
+  // Split each length in two, unevenly so a word boundary can fall
+  // inside either half.
+  int i;
+  for (i = 0; str_lens[i] >= 0; i++) {
+    chpl__inPlaceBuffer buf;
+    char x[2 * CHPL_SHORT_STRING_SIZE + 2];
+    int n = str_lens[i];
+    int nx = n / 3;
+    c_string s;
+
+    strcpy(x, str_n(n));
+    s = chpl__inPlaceBufferConcat(&buf, str_n(nx), x + nx, 0, 0);
+    printf("concat %d+%d: %s %s\n", nx, n - nx, where(&buf, s),
+           strcmp(s, x) == 0 ? "ok" : "WRONG");
+    chpl__inPlaceBufferFree(&buf, s, 0, 0);
+  }
+}
+
+void short_select_report(void) {
+  chpl__inPlaceBuffer buf;
+  char x[2 * CHPL_SHORT_STRING_SIZE + 2];
+  c_string s;
+
+  strcpy(x, str_n(2 * CHPL_SHORT_STRING_SIZE));
+
+  // every byte but the last one still fits
+  s = chpl__inPlaceBufferSelect(&buf, x, 2, CHPL_SHORT_STRING_SIZE, 1, 0, 0);
+  printf("select 2..%d: %s %s\n", CHPL_SHORT_STRING_SIZE, where(&buf, s), s);
+  chpl__inPlaceBufferFree(&buf, s, 0, 0);
+
+  s = chpl__inPlaceBufferSelect(&buf, x, 1, CHPL_SHORT_STRING_SIZE, 1, 0, 0);
+  printf("select 1..%d: %s %s\n", CHPL_SHORT_STRING_SIZE, where(&buf, s), s);
+  chpl__inPlaceBufferFree(&buf, s, 0, 0);
+
+  s = chpl__inPlaceBufferSelect(&buf, x, 1, 2 * CHPL_SHORT_STRING_SIZE, 2,
+                                0, 0);
+  printf("select by 2: %s %s\n", where(&buf, s), s);
+  chpl__inPlaceBufferFree(&buf, s, 0, 0);
+
+  s = chpl__inPlaceBufferSelect(&buf, x, 1, 2 * CHPL_SHORT_STRING_SIZE, -3,
+                                0, 0);
+  printf("select by -3: %s %s\n", where(&buf, s), s);
+  chpl__inPlaceBufferFree(&buf, s, 0, 0);
+
+  s = chpl__inPlaceBufferSelect(&buf, x, 5, 4, 1, 0, 0);
+  printf("select 5..4: %s\n", s == NULL ? "NULL" : s);
+}
+
+void intern_report(void) {
+  char x[2 * CHPL_SHORT_STRING_SIZE + 2];
+  char name[32];
+  c_string first[1000];
+  int same = 1;
+  int i;
+
+  // Equal strings intern to the same pointer, wherever they come from.
+  strcpy(x, "module");
+  printf("equal: %s\n",
+         string_intern(x) == string_intern("module") ? "same" : "different");
+  printf("copy: %s\n", string_intern(x) != x ? "separate" : "caller's");
+
+  // Prefixes are different strings, and the table's copy is
+  // NUL-terminated even when the input isn't.
+  strcpy(x, "moduleName");
+  printf("prefix: %s %s\n",
+         string_intern_len(x, 6) == string_intern("module") ? "same"
+                                                            : "different",
+         string_intern_len(x, 7) == string_intern("module") ? "same"
+                                                            : "different");
+  printf("terminated: %s\n", string_intern_len(x, 7));
+
+  // Lengths on either side of a word, and non-ASCII bytes at the end.
+  strcpy(x, str_n(9));
+  {
+    c_string s8 = string_intern_len(x, 8);
+    c_string s9 = string_intern_len(x, 9);
+    printf("lengths: %s\n",
+           s8 != s9 && strlen(s8) == 8 && strlen(s9) == 9 ? "ok" : "WRONG");
+  }
+  printf("non-ASCII: %s\n",
+         string_intern("caf\xc3\xa9") == string_intern("caf\xc3\xa9") &&
+         string_intern("caf\xc3\xa9") != string_intern("caf\xc3")
+         ? "ok" : "WRONG");
+
+  printf("empty: %s\n",
+         string_intern("") == string_intern_len("abc", 0) ? "same"
+                                                          : "different");
+  printf("NULL: %s\n", string_intern(NULL) == NULL ? "NULL" : "WRONG");
+
+  // Pointers stay put as the table grows.
+  for (i = 0; i < 1000; i++) {
+    snprintf(name, sizeof(name), "name%d", i);
+    first[i] = string_intern(name);
+  }
+  for (i = 0; i < 1000; i++) {
+    snprintf(name, sizeof(name), "name%d", i);
+    if (string_intern(name) != first[i] || strcmp(first[i], name) != 0)
+      same = 0;
+  }
+  printf("after growing: %s\n", same ? "same" : "different");
+}
+
+#endif
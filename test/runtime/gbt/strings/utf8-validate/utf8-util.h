@@ -0,0 +1,83 @@
+//////////////////////
+//
+// Interface
+//
+
+void utf8_validate_report(void);
+
+
+//////////////////////
+//
+// Implementation
+//
+
+#ifndef _utf8_util_h_
+#define _utf8_util_h_
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "encoding/encoding-support.h"
+
+// Validates the first len bytes of nascii ASCII bytes followed by tail.
+// The buffer goes on past len, so a decoder that reads beyond the end
+// of a truncated sequence would find the rest of it.
+static void check(const char* what, int nascii, const char* tail, int len) {
+  char buf[64];
+  int64_t num_cp = -1;
+  int i;
+
+  for (i = 0; i < nascii; i++)
+    buf[i] = 'a' + i % 26;
+  strcpy(buf + nascii, tail);
+  if (len < 0)
+    len = strlen(buf);
+
+  if (chpl_enc_validate_buf(buf, len, &num_cp) == 0)
+    printf("%s (%d bytes): valid, %d codepoints\n", what, len, (int) num_cp);
+  else
+    printf("%s (%d bytes): invalid\n", what, len);
+}
+
+void utf8_validate_report(void) {
+  // ASCII ending on and just past 8- and 16-byte boundaries
+  check("ascii", 0, "", -1);
+  check("ascii", 8, "", -1);
+  check("ascii", 9, "", -1);
+  check("ascii", 16, "", -1);
+  check("ascii", 17, "", -1);
+  check("ascii", 32, "", -1);
+  check("ascii", 33, "", -1);
+
+  // non-ASCII in the final partial word, or straddling a boundary
+  check("2-byte after 16", 16, "\xc3\xa9", -1);
+  check("2-byte across 16", 15, "\xc3\xa9", -1);
+  check("2-byte across 8", 7, "\xc3\xa9" "abc", -1);
+  check("3-byte in last word", 20, "\xe2\x82\xac", -1);
+  check("4-byte in last word", 12, "\xf0\x9f\x98\x80", -1);
+  check("mixed", 9, "\xc3\xa9" "abcdefgh" "\xe2\x82\xac" "z", -1);
+
+  // truncated sequences, at the end of the string and cut off by the
+  // length with the rest of the sequence just past it
+  check("truncated 2-byte", 8, "\xc3", -1);
+  check("truncated 3-byte", 16, "\xe2\x82", -1);
+  check("cut 2-byte", 8, "\xc3\xa9", 9);
+  check("cut 3-byte", 16, "\xe2\x82\xac", 18);
+  check("cut 4-byte", 12, "\xf0\x9f\x98\x80", 15);
+  check("lone continuation", 16, "\x80", -1);
+
+  // overlong encodings of '/' and of U+07FF, surrogates, and past U+10FFFF
+  check("overlong 2-byte", 8, "\xc0\xaf", -1);
+  check("overlong 2-byte", 8, "\xc1\xbf", -1);
+  check("overlong 3-byte", 16, "\xe0\x80\xaf", -1);
+  check("overlong 3-byte", 16, "\xe0\x9f\xbf", -1);
+  check("overlong 4-byte", 5, "\xf0\x80\x80\xaf", -1);
+  check("surrogate", 3, "\xed\xa0\x80", -1);
+  check("too large", 3, "\xf4\x90\x80\x80", -1);
+
+  // an escaped byte is one codepoint
+  check("escaped byte", 16, "\xed\xb2\x80", -1);
+}
+
+#endif
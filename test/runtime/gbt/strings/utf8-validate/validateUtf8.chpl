@@ -0,0 +1,8 @@
+// Check UTF-8 validation and codepoint counts for inputs around the
+// word-at-a-time ASCII scan's boundaries, and for truncated and
+// overlong sequences.
+proc main {
+  extern proc utf8_validate_report();
+
+  utf8_validate_report();
+}
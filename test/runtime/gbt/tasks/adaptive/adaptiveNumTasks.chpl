@@ -0,0 +1,41 @@
+// The adaptive task count is always between 1 and the maximum asked
+// for, including from inside tasks that keep the locale busy, and work
+// split up by it has to add up.
+
+extern proc chpl_task_getAdaptiveNumTasks(maxTasks: uint(32)): uint(32);
+extern proc chpl_task_shouldSplitWork(): bool;
+
+config const n = 100000;
+
+proc inBounds(maxTasks: int) {
+  const num = chpl_task_getAdaptiveNumTasks(maxTasks: uint(32));
+  return num >= 1 && num <= max(maxTasks, 1);
+}
+
+writeln(inBounds(0), " ", inBounds(1), " ", inBounds(here.maxTaskPar));
+
+var ok: atomic bool = true;
+coforall i in 1..here.maxTaskPar {
+  coforall j in 1..4 {
+    if !inBounds(here.maxTaskPar) then ok.write(false);
+    chpl_task_shouldSplitWork();
+  }
+}
+writeln(ok.read());
+
+// Split a loop into as many chunks as the runtime says.
+proc adaptiveSum(lo: int, hi: int) {
+  const numTasks = chpl_task_getAdaptiveNumTasks(here.maxTaskPar: uint(32));
+  var sum: atomic int;
+  coforall t in 0..#numTasks {
+    var s = 0;
+    for i in lo+t..hi by numTasks: int do s += i;
+    sum.add(s);
+  }
+  return sum.read();
+}
+
+writeln(adaptiveSum(1, n));
+var nested: atomic int;
+forall i in 1..4 do nested.add(adaptiveSum(1, n / 4));
+writeln(nested.read());
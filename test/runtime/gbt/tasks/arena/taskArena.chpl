@@ -0,0 +1,29 @@
+// Check that task arena allocations are usable, distinct, and survive
+// until their task ends, across many short-lived tasks.
+use CPtr, SysCTypes;
+
+extern proc chpl_task_arena_alloc(size: c_size_t, lineno: int(32),
+                                  filename: int(32)): c_void_ptr;
+
+config const numTasks = 200;
+config const allocsPerTask = 100;
+
+var bad: atomic int;
+
+coforall t in 0..#numTasks {
+  var ptrs: [0..#allocsPerTask] c_ptr(int);
+  for i in 0..#allocsPerTask {
+    // mix in some allocations bigger than an arena chunk
+    const n = if i % 50 == 49 then 10000 else i + 1;
+    ptrs[i] = chpl_task_arena_alloc((n * numBytes(int)): c_size_t,
+                                    0, 0): c_ptr(int);
+    for j in 0..#n do ptrs[i][j] = t * allocsPerTask + i;
+  }
+  for i in 0..#allocsPerTask {
+    const n = if i % 50 == 49 then 10000 else i + 1;
+    for j in 0..#n do
+      if ptrs[i][j] != t * allocsPerTask + i then bad.add(1);
+  }
+}
+
+writeln("bad values: ", bad.read());
@@ -0,0 +1,27 @@
+// Check that the task event ring sees each task's create, begin, and
+// end events, and that draining empties it.
+proc main {
+  extern proc ring_install();
+  extern proc ring_uninstall();
+  extern proc ring_report();
+
+  var counter: atomic int;
+
+  ring_install();
+
+  cobegin {
+    counter.add(1);
+    counter.add(1);
+  }
+
+  ring_uninstall();
+
+  // tasks started after uninstalling aren't recorded
+  cobegin {
+    counter.add(1);
+    counter.add(1);
+  }
+
+  ring_report();
+  writeln(counter.read());
+}
@@ -0,0 +1,59 @@
+//////////////////////
+//
+// Interface
+//
+
+void ring_install(void);
+void ring_uninstall(void);
+void ring_report(void);
+
+
+//////////////////////
+//
+// Implementation
+//
+
+#ifndef _ring_util_h_
+#define _ring_util_h_
+
+#include <stdio.h>
+
+#include "chpl-tasks-callbacks.h"
+
+#define RING_EVS_N 1000
+
+static chpl_task_cb_event_t ring_evs[RING_EVS_N];
+
+void ring_install(void) {
+  if (chpl_task_install_event_ring() != 0)
+    perror("chpl_task_install_event_ring()");
+}
+
+void ring_uninstall(void) {
+  if (chpl_task_uninstall_event_ring() != 0)
+    perror("chpl_task_uninstall_event_ring()");
+}
+
+void ring_report(void) {
+  int counts[chpl_task_cb_num_event_kinds] = { 0 };
+  int ordered = 1;
+  size_t n, i;
+
+  n = chpl_task_drain_events(ring_evs, RING_EVS_N);
+  for (i = 0; i < n; i++) {
+    counts[ring_evs[i].event_kind]++;
+    if (ring_evs[i].time == 0)
+      ordered = 0;
+  }
+
+  printf("create %d, begin %d, end %d\n",
+         counts[chpl_task_cb_event_kind_create],
+         counts[chpl_task_cb_event_kind_begin],
+         counts[chpl_task_cb_event_kind_end]);
+  printf("timestamps %s\n", ordered ? "ok" : "missing");
+  printf("dropped %d\n", (int) chpl_task_events_dropped());
+  printf("drained again %d\n",
+         (int) chpl_task_drain_events(ring_evs, RING_EVS_N));
+}
+
+#endif
@@ -0,0 +1,39 @@
+// Exercise the fifo tasking layer's work-stealing mode: nested
+// coforalls, begins synced through a counter, and tasks that block on
+// each other so that more threads have to be created.
+
+config const n = 1000;
+config const depth = 3;
+
+proc tree(d: int): int {
+  if d == 0 then return 1;
+  var sub: [0..3] int;
+  coforall i in 0..3 do sub[i] = tree(d - 1);
+  return + reduce sub;
+}
+
+writeln("tree leaves: ", tree(depth));
+
+var count: atomic int;
+sync {
+  for 1..n do begin count.add(1);
+}
+writeln("begins: ", count.read());
+
+var total: atomic int;
+cobegin {
+  forall i in 1..n do total.add(i);
+  forall i in 1..n do total.add(i);
+}
+writeln("cobegin forall sum: ", total.read());
+
+// Producer/consumer chain over sync variables.
+const numStages = 8;
+var stage: [0..numStages] sync int;
+coforall s in 0..numStages {
+  if s == 0 then
+    stage[0].writeEF(1);
+  else
+    stage[s].writeEF(stage[s-1].readFE() + 1);
+}
+writeln("pipeline: ", stage[numStages].readFE());
@@ -0,0 +1,19 @@
+// Check that NUMA placement hints can be set, read back, and cleared,
+// and that tasks created under a hint all run.
+extern proc chpl_task_setNumaHint(numa: int(32));
+extern proc chpl_task_getNumaHint(): int(32);
+extern const c_sublocid_any: int(32);
+
+config const numTasks = 100;
+
+writeln(chpl_task_getNumaHint() == c_sublocid_any);
+
+chpl_task_setNumaHint(0);
+writeln(chpl_task_getNumaHint());
+
+var cnt: atomic int;
+coforall 1..numTasks do cnt.add(1);
+writeln(cnt.read());
+
+chpl_task_setNumaHint(c_sublocid_any);
+writeln(chpl_task_getNumaHint() == c_sublocid_any);
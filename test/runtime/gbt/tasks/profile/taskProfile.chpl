@@ -0,0 +1,8 @@
+// Run some tasks with the qthreads task profiler on.  The report's
+// numbers vary, so the prediff keeps only its header and checks that
+// a row for the coforall body is present.
+config const numTasks = 100;
+
+var cnt: atomic int;
+coforall 1..numTasks do cnt.add(1);
+writeln(cnt.read());
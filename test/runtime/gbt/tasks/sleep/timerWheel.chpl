@@ -0,0 +1,38 @@
+// Sleeping tasks wake up in order of their deadlines, not before them,
+// and don't hold up each other or tasks that are running.
+
+use Time;
+
+config const numSleepers = 8;
+
+// Sleepers with staggered deadlines, started in reverse order.
+var order: [1..numSleepers] int;
+var next: atomic int = 1;
+var t: Timer;
+t.start();
+coforall i in 1..numSleepers by -1 {
+  sleep(0.05 * i);
+  order[next.fetchAdd(1)] = i;
+}
+t.stop();
+writeln(order);
+// The sleeps overlap, so the whole thing takes about the longest one.
+writeln(t.elapsed() >= 0.05 * numSleepers, " ",
+        t.elapsed() < 0.05 * numSleepers * (numSleepers + 1) / 2);
+
+// Sleeps shorter than a tick, and of zero length.
+t.clear();
+t.start();
+for 1..100 do sleep(0.0001);
+sleep(0.0);
+t.stop();
+writeln(t.elapsed() >= 0.01);
+
+// A task that computes while others sleep gets its work done.
+var sum: atomic int;
+cobegin {
+  sleep(0.2);
+  sleep(0.1);
+  for i in 1..1000000 do sum.add(1);
+}
+writeln(sum.read());
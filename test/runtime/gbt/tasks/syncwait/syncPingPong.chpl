@@ -0,0 +1,26 @@
+// Hand values back and forth through sync variables, so that waiters
+// hit every stage of the adaptive spin/yield/park wait, and check that
+// nothing is lost or duplicated.
+config const numRounds = 100000;
+config const numPairs = 4;
+
+var errs: atomic int;
+
+coforall p in 1..numPairs {
+  var ping, pong: sync int;
+  cobegin {
+    for i in 1..numRounds {
+      ping = i;
+      if pong != i then errs.add(1);
+    }
+    for i in 1..numRounds {
+      const v = ping;
+      if v != i then errs.add(1);
+      // every so often dawdle, so the other side has to park
+      if i % 1000 == 0 then for 1..100000 { }
+      pong = v;
+    }
+  }
+}
+
+writeln("errors: ", errs.read());
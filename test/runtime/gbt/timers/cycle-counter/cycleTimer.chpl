@@ -0,0 +1,42 @@
+// The instrumentation timestamps never go backwards, in one task or
+// across tasks, and converted tick counts agree with the wall clock.
+
+use Time;
+
+require "chpltimers.h";
+
+extern proc chpl_timer_ticks(): uint(64);
+extern proc chpl_timer_ticks_to_ns(ticks: uint(64)): uint(64);
+extern proc chpl_timer_now_ns(): uint(64);
+
+config const n = 100000;
+
+var monotonic = true;
+var last = chpl_timer_now_ns();
+for 1..n {
+  const now = chpl_timer_now_ns();
+  if now < last then monotonic = false;
+  last = now;
+}
+writeln(monotonic);
+
+// Each task sees its own sequence in order, and every stamp taken after
+// the tasks are done is later than all of theirs.
+var latest: [1..here.maxTaskPar] uint(64);
+var allOrdered: atomic bool = true;
+coforall t in 1..here.maxTaskPar {
+  var prev = chpl_timer_now_ns();
+  for 1..n/10 {
+    const now = chpl_timer_now_ns();
+    if now < prev then allOrdered.write(false);
+    prev = now;
+  }
+  latest[t] = prev;
+}
+writeln(allOrdered.read(), " ", chpl_timer_now_ns() >= (max reduce latest));
+
+// A 100 ms sleep measured in ticks.
+const start = chpl_timer_ticks();
+sleep(0.1);
+const ns = chpl_timer_ticks_to_ns(chpl_timer_ticks() - start);
+writeln(ns >= 90_000_000, " ", ns < 5_000_000_000);
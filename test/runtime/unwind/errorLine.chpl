@@ -0,0 +1,14 @@
+// An error raised inside a library function reports the line in user
+// code that led to it, whether that line is passed down to the library
+// or found by unwinding the stack.
+
+config const i = 5;
+
+var A: [1..3] int;
+
+proc get(j: int) {
+  return A[j];
+}
+
+writeln(get(2));
+writeln(get(i));
@@ -222,10 +222,106 @@ static QINLINE void FREE_STACK(void *t)
 #else /* if defined(UNPOOLED_STACKS) || defined(UNPOOLED) */
 static qt_mpool generic_stack_pool = NULL;
 # ifdef QTHREAD_GUARD_PAGES
+/*
+ * Cache of freed stacks whose guard pages are still in place, so that
+ * reusing one costs no mprotect() calls.  There is one cache per
+ * shepherd, plus one for threads that aren't shepherds, each holding
+ * at most stack_cache_max stacks (QT_GUARDED_STACK_CACHE).  Every
+ * STACK_CACHE_TRIM_INTERVAL frees, a cache gives back half of the
+ * stacks that went unused over that interval, so an idle cache drains
+ * down over time without any one free paying much for it.
+ */
+typedef struct {
+    QTHREAD_FASTLOCK_TYPE lock;
+    size_t                len;      /* stacks cached now */
+    size_t                low;      /* fewest cached since last trim */
+    size_t                frees;    /* frees since last trim */
+    void                **stacks;   /* oldest first */
+} qt_stack_cache_t;
+
+static qt_stack_cache_t *stack_caches    = NULL;
+static size_t            stack_cache_max = 0;
+
+#  define STACK_CACHE_TRIM_INTERVAL 1024
+
+static QINLINE qt_stack_cache_t *my_stack_cache(void)
+{                      /*{{{ */
+    qthread_shepherd_t *shep = qthread_internal_getshep();
+
+    return &stack_caches[shep ? shep->shepherd_id : qlib->nshepherds];
+}                      /*}}} */
+
+static void release_guarded_stack(void *t)
+{                      /*{{{ */
+    t = (uint8_t*)t - getpagesize();
+    if (mprotect(t, getpagesize(), PROT_READ | PROT_WRITE) != 0) {
+        perror("mprotect in release_guarded_stack (1)");
+    }
+    if (mprotect(((uint8_t*)t) + qlib->qthread_stack_size + getpagesize(),
+                getpagesize(),
+                PROT_READ | PROT_WRITE) != 0) {
+        perror("mprotect in release_guarded_stack (2)");
+    }
+    qt_mpool_free(generic_stack_pool, t);
+}                      /*}}} */
+
+static void stack_caches_init(void)
+{                      /*{{{ */
+    stack_cache_max = qt_internal_get_env_num("GUARDED_STACK_CACHE", 64, 0);
+    if (stack_cache_max == 0) {
+        return;
+    }
+    stack_caches = MALLOC((qlib->nshepherds + 1) * sizeof(qt_stack_cache_t));
+    assert(stack_caches);
+    for (qthread_shepherd_id_t i = 0; i <= qlib->nshepherds; i++) {
+        QTHREAD_FASTLOCK_INIT(stack_caches[i].lock);
+        stack_caches[i].len    = 0;
+        stack_caches[i].low    = 0;
+        stack_caches[i].frees  = 0;
+        stack_caches[i].stacks = MALLOC(stack_cache_max * sizeof(void *));
+        assert(stack_caches[i].stacks);
+    }
+}                      /*}}} */
+
+static void stack_caches_destroy(void)
+{                      /*{{{ */
+    if (stack_caches == NULL) {
+        return;
+    }
+    for (qthread_shepherd_id_t i = 0; i <= qlib->nshepherds; i++) {
+        qt_stack_cache_t *c = &stack_caches[i];
+
+        while (c->len > 0) {
+            release_guarded_stack(c->stacks[--c->len]);
+        }
+        FREE(c->stacks, stack_cache_max * sizeof(void *));
+        QTHREAD_FASTLOCK_DESTROY(c->lock);
+    }
+    FREE(stack_caches, (qlib->nshepherds + 1) * sizeof(qt_stack_cache_t));
+    stack_caches = NULL;
+}                      /*}}} */
+
 static QINLINE void *ALLOC_STACK(void)
 {                      /*{{{ */
     if (GUARD_PAGES) {
-        uint8_t *tmp = qt_mpool_alloc(generic_stack_pool);
+        uint8_t *tmp;
+
+        if (stack_caches) {
+            qt_stack_cache_t *c = my_stack_cache();
+
+            QTHREAD_FASTLOCK_LOCK(&c->lock);
+            if (c->len > 0) {
+                tmp = c->stacks[--c->len];
+                if (c->len < c->low) {
+                    c->low = c->len;
+                }
+                QTHREAD_FASTLOCK_UNLOCK(&c->lock);
+                return tmp;
+            }
+            QTHREAD_FASTLOCK_UNLOCK(&c->lock);
+        }
+
+        tmp = qt_mpool_alloc(generic_stack_pool);
 
         assert(tmp);
         if (tmp == NULL) {
@@ -247,6 +343,30 @@ static QINLINE void *ALLOC_STACK(void)
 
 static QINLINE void FREE_STACK(void *t)
 {                      /*{{{ */
+    if (GUARD_PAGES && stack_caches) {
+        qt_stack_cache_t *c = my_stack_cache();
+
+        assert(t);
+        QTHREAD_FASTLOCK_LOCK(&c->lock);
+        if (++c->frees >= STACK_CACHE_TRIM_INTERVAL) {
+            size_t trim = c->low / 2;
+
+            for (size_t i = 0; i < trim; i++) {
+                release_guarded_stack(c->stacks[i]);
+            }
+            memmove(c->stacks, c->stacks + trim,
+                    (c->len - trim) * sizeof(void *));
+            c->len  -= trim;
+            c->low   = c->len;
+            c->frees = 0;
+        }
+        if (c->len < stack_cache_max) {
+            c->stacks[c->len++] = t;
+            QTHREAD_FASTLOCK_UNLOCK(&c->lock);
+            return;
+        }
+        QTHREAD_FASTLOCK_UNLOCK(&c->lock);
+    }
     if (GUARD_PAGES) {
         assert(t);
         t = (uint8_t*)t - getpagesize();
@@ -967,6 +1087,9 @@ int API_FUNC qthread_initialize(void)
         generic_stack_pool =
             qt_mpool_create_aligned(qlib->qthread_stack_size + sizeof(struct qthread_runtime_data_s) +
                                     (2 * getpagesize()), getpagesize());
+# ifdef QTHREAD_GUARD_PAGES
+        stack_caches_init();
+# endif
     } else {
         generic_stack_pool = qt_mpool_create_aligned(qlib->qthread_stack_size + sizeof(struct qthread_runtime_data_s), QTHREAD_STACK_ALIGNMENT);     // stacks on most platforms must be 16-byte aligned (or less)
     }
@@ -1665,6 +1788,9 @@ void API_FUNC qthread_finalize(void)
     generic_qthread_pool = NULL;
     qt_mpool_destroy(generic_big_qthread_pool);
     generic_big_qthread_pool = NULL;
+# ifdef QTHREAD_GUARD_PAGES
+    stack_caches_destroy();
+# endif
     qt_mpool_destroy(generic_stack_pool);
     generic_stack_pool = NULL;
     qt_mpool_destroy(generic_rdata_pool);
@@ -279,6 +279,12 @@ RE2::~RE2() {
     delete group_names_;
 }
 
+bool RE2::anchored_start() const {
+  // A required prefix is only split off of a pattern starting with ^,
+  // and the prog for the rest of the pattern doesn't have the anchor.
+  return !prefix_.empty() || (prog_ != NULL && prog_->anchor_start());
+}
+
 int RE2::ProgramSize() const {
   if (prog_ == NULL)
     return -1;
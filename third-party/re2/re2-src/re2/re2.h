@@ -324,6 +324,8 @@ class RE2 {
   int min_match_length_bytes() const { return min_match_length_; }
   // Return the maximum number of matched bytes or -1 for unbounded
   int max_match_length_bytes() const { return max_match_length_; }
+  // Return true if every match has to start at the beginning of the text
+  bool anchored_start() const;
 
   /***** The array-based matching interface ******/
 
@@ -186,8 +186,8 @@ void ConcurrencyData::buildData(void) {
   DataModel::tagData *tmpTag;
   long tmpTagNo;
 
-  std::list <DataModel::timelineEntry>::iterator tl_itr;
-  std::list <DataModel::timelineEntry>::iterator tagStart;
+  std::vector <DataModel::timelineEntry>::iterator tl_itr;
+  std::vector <DataModel::timelineEntry>::iterator tagStart;
 
   taskData *theTask;
   bool done;
@@ -217,27 +217,27 @@ void ConcurrencyData::buildData(void) {
     numLines =  VisData.taskTimeline[parent->localeNum].size();
     tagStart = VisData.taskTimeline[parent->localeNum].begin();
   } else {
-    // Walk the timeline keeping tasks that go past the tag
+    // The tag's entries start at timelineStart.  Count them, then walk
+    // the earlier entries keeping tasks that go past their tag.
+    tmpTag = VisData.getTagData(parent->tagNum);
+    tagStart = VisData.taskTimeline[parent->localeNum].begin()
+               + tmpTag->locales[parent->localeNum].timelineStart;
+    if (parent->tagNum != DataModel::TagStart)
+      width = 30 + 60 * tmpTag->locales[parent->localeNum].maxConc;
+    tl_itr = tagStart;
+    while (tl_itr != VisData.taskTimeline[parent->localeNum].end()
+           && tl_itr->first != DataModel::Tl_Tag) {
+      numLines++;
+      tl_itr++;
+    }
+
     tl_itr = VisData.taskTimeline[parent->localeNum].begin();
-    tmpTag = VisData.getTagData(DataModel::TagStart);
     tmpTagNo = DataModel::TagStart;
-    if (parent->tagNum == DataModel::TagStart)
-      tagStart = tl_itr;
-
-    // counting the number of lines if in the tag
-    while (tl_itr !=  VisData.taskTimeline[parent->localeNum].end()) {
-      if (tl_itr->first != DataModel::Tl_Tag && tmpTagNo == parent->tagNum) 
-        numLines++;
+    while (tl_itr != tagStart) {
       switch (tl_itr->first) {
 
         case DataModel::Tl_Tag:
           tmpTagNo = tl_itr->second;
-          tmpTag = VisData.getTagData(tmpTagNo);
-          if (tmpTagNo == parent->tagNum) {
-            tagStart = tl_itr;
-            tagStart++; // Move to the first record after the tag
-            width = 30 + 60 * tmpTag->locales[parent->localeNum].maxConc;
-          }
           break;
 
         case DataModel::Tl_Begin:
@@ -265,8 +265,6 @@ void ConcurrencyData::buildData(void) {
         default:
           break;
       }
-      if (tmpTagNo > parent->tagNum)
-        break;
       tl_itr++;
     }
   }
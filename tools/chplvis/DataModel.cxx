@@ -34,9 +34,19 @@
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
 
 // C++ Libraries
 #include <set>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+// Binary event records, shared with the runtime
+#include "chpl-visual-debug-format.h"
 
 #ifndef MAXPATHLEN
 #define MAXPATHLEN 2048
@@ -45,14 +55,98 @@
 #define MAX_LINE_LEN 1024
 
 #define EXPECTED_VMAJOR 1
-#define EXPECTED_VMINOR 4
+#define EXPECTED_VMINOR 5
+// Version 1.4 files have text event records and can still be read
+#define OLDEST_VMINOR 4
 
 void DataModel::newList()
 {
-  curEvent = theEvents.begin();
-  while (curEvent != theEvents.end()) {
-    curEvent = theEvents.erase(curEvent);
+  theEvents.clear();
+}
+
+// The files are loaded by several threads, each taking the next file
+// to load from here.
+
+struct DataModel::loadWork {
+  DataModel *model;
+  double seq;
+  std::vector<std::string> names;
+  std::vector<const char *> sections;   // Shared file sections, or NULL
+  std::vector<size_t> sectionLens;
+  std::vector< std::vector<Event *> > *fileEvents;
+  std::vector<int> ok;
+  size_t next;
+  pthread_mutex_t lock;
+};
+
+void *DataModel::loadFiles (void *arg)
+{
+  loadWork *work = (loadWork *)arg;
+
+  while (true) {
+    pthread_mutex_lock(&work->lock);
+    size_t ix = work->next++;
+    pthread_mutex_unlock(&work->lock);
+    if (ix >= work->names.size())
+      break;
+    work->ok[ix] = work->model->LoadFile(work->names[ix].c_str(), ix, work->seq,
+                                         (*work->fileEvents)[ix],
+                                         work->sections[ix],
+                                         work->sectionLens[ix]);
   }
+  return NULL;
+}
+
+// Map a shared file (CHPL_RT_VDEBUG_SHARED_FILE) and find the nodes'
+// sections in it.  Returns the number of nodes, or -1.
+
+static long mapSharedFile (const char *name, const char **mapOut, size_t *mapLenOut,
+                           std::vector<const char *> &sections,
+                           std::vector<size_t> &sectionLens)
+{
+  struct stat sb;
+  chpl_vdebug_shared_hdr_t hdr;
+  int fd = open(name, O_RDONLY);
+
+  if (fd < 0)
+    return -1;
+  if (fstat(fd, &sb) < 0 || (size_t)sb.st_size < sizeof(hdr)) {
+    close(fd);
+    return -1;
+  }
+  const char *map = (const char *)mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE,
+                                       fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    return -1;
+
+  memcpy(&hdr, map, sizeof(hdr));
+  if (memcmp(hdr.magic, CHPL_VDEBUG_SHARED_MAGIC, sizeof(hdr.magic)) != 0
+      || hdr.numNodes <= 0
+      || CHPL_VDEBUG_SHARED_HDR_SIZE(hdr.numNodes) > (size_t)sb.st_size) {
+    (void)munmap((void *)map, sb.st_size);
+    return -1;
+  }
+
+  sections.resize(hdr.numNodes);
+  sectionLens.resize(hdr.numNodes);
+  for (int ix = 0; ix < hdr.numNodes; ix++) {
+    chpl_vdebug_section_t sect;
+    memcpy(&sect, map + sizeof(hdr) + ix * sizeof(sect), sizeof(sect));
+    if (sect.offset > (uint64_t)sb.st_size
+        || sect.length > (uint64_t)sb.st_size - sect.offset) {
+      (void)munmap((void *)map, sb.st_size);
+      return -1;
+    }
+    sections[ix] = map + sect.offset;
+    sectionLens[ix] = sect.length;
+  }
+  // Sections are read in parallel
+  (void)madvise((void *)map, sb.st_size, MADV_WILLNEED);
+
+  *mapOut = map;
+  *mapLenOut = sb.st_size;
+  return hdr.numNodes;
 }
 
 int DataModel::LoadData(const char * filename, bool fromArgv)
@@ -78,11 +172,18 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
   }
 
   if ((statbuf.st_mode & S_IFMT) == S_IFDIR) {
+    // Use the shared file if there is one, otherwise the node 0 file
     char *lastelement = strrchr(mfilename, '/');
     if (lastelement)
-      snprintf (fullfilename, MAXPATHLEN, "%s%s-0", mfilename, lastelement);
+      snprintf (fullfilename, MAXPATHLEN, "%s%s-all", mfilename, lastelement);
     else
-      snprintf (fullfilename, MAXPATHLEN, "%s/%s-0", mfilename, mfilename);
+      snprintf (fullfilename, MAXPATHLEN, "%s/%s-all", mfilename, mfilename);
+    if (stat(fullfilename, &statbuf) < 0) {
+      if (lastelement)
+        snprintf (fullfilename, MAXPATHLEN, "%s%s-0", mfilename, lastelement);
+      else
+        snprintf (fullfilename, MAXPATHLEN, "%s/%s-0", mfilename, mfilename);
+    }
   }  else
     snprintf (fullfilename, MAXPATHLEN, "%s", filename);
 
@@ -101,9 +202,38 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
 
   newList();
   strDB.clear();
-  curEvent = theEvents.begin();
 
-  FILE *data = fopen(fullfilename, "r");
+  // A shared file has all the nodes' data
+  bool isShared = strcmp(suffix, "all") == 0;
+  const char *sharedMap = NULL;
+  size_t sharedLen = 0;
+  std::vector<const char *> sections;
+  std::vector<size_t> sectionLens;
+  long sharedNodes = -1;
+
+  if (isShared) {
+    sharedNodes = mapSharedFile(fullfilename, &sharedMap, &sharedLen,
+                                sections, sectionLens);
+    if (sharedNodes < 0 || sectionLens[0] == 0) {
+      if (!fromArgv)
+        fl_message ("LoadData: %s is not a valid shared data file.", fullfilename);
+      else
+        printf ("LoadData: %s is not a valid shared data file.\n", fullfilename);
+      if (sharedMap != NULL)
+        (void)munmap((void *)sharedMap, sharedLen);
+      return 0;
+    }
+  }
+
+  // Events copy what they need, so unmap when done loading
+  struct unmapper {
+    const char *map;
+    size_t len;
+    ~unmapper() { if (map != NULL) (void)munmap((void *)map, len); }
+  } sharedUnmapper = { sharedMap, sharedLen };
+
+  FILE *data = isShared ? fmemopen((void *)sections[0], sectionLens[0], "r")
+                        : fopen(fullfilename, "r");
   if (!data) {
     if (!fromArgv)
       fl_message ("LoadData: Could not open %s.", fullfilename);
@@ -147,7 +277,8 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
   fclose(data);
 
   // Should make this more parameterized !!!!
-  if (VerMajor != EXPECTED_VMAJOR || VerMinor != EXPECTED_VMINOR) {
+  if (VerMajor != EXPECTED_VMAJOR || VerMinor < OLDEST_VMINOR
+      || VerMinor > EXPECTED_VMINOR) {
     if (!fromArgv)
       fl_alert("VisualDebug data files are not version %d.%d - got %d.%d", EXPECTED_VMAJOR, EXPECTED_VMINOR, VerMajor, VerMinor);
     else
@@ -155,6 +286,14 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
     return 0;
   }
 
+  if (isShared && nlocales != sharedNodes) {
+    if (!fromArgv)
+      fl_message ("LoadData: %s has inconsistent node counts.", fullfilename);
+    else
+      printf ("LoadData: %s has inconsistent node counts.\n", fullfilename);
+    return 0;
+  }
+
   char fname[namesize+15];
   // printf ("LoadData: nlocalse = %d, fnum = %d seq = %.3lf\n", nlocales, fnum, seq);
 
@@ -165,33 +304,67 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
   mainTID = tid;
   mainTask.taskRec = new E_task (0, 0, 0, tid, 0, 0, -1, -1);
 
-  // Debug
-  std::list<Event *>::iterator itr;
+  // Each file's events, in file order
+  std::vector< std::vector<Event *> > fileEvents(nlocales);
+  long ix_e;
+
+  loadWork work;
+  work.model = this;
+  work.seq = seq;
+  work.fileEvents = &fileEvents;
+  work.ok.resize(nlocales, 0);
+  work.next = 0;
+  pthread_mutex_init(&work.lock, NULL);
+  for (int i = 0; i < nlocales; i++) {
+    if (isShared) {
+      // Name used only for messages
+      snprintf (fname, namesize+15, "%.*sall[%d]", namesize, fullfilename, i);
+      work.sections.push_back(sections[i]);
+      work.sectionLens.push_back(sectionLens[i]);
+    } else {
+      snprintf (fname, namesize+15, "%.*s%d", namesize, fullfilename, i);
+      work.sections.push_back(NULL);
+      work.sectionLens.push_back(0);
+    }
+    work.names.push_back(fname);
+  }
+
+  // File 0 has the tables and tag names the others refer to, so load it
+  // first, then the rest in parallel
+  work.next = 1;
+  work.ok[0] = LoadFile(work.names[0].c_str(), 0, seq, fileEvents[0],
+                        work.sections[0], work.sectionLens[0]);
+  if (work.ok[0] && nlocales > 1) {
+    long nThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nThreads > nlocales - 1)
+      nThreads = nlocales - 1;
+    if (nThreads < 1)
+      nThreads = 1;
+    std::vector<pthread_t> threads(nThreads);
+    long nStarted = 0;
+    while (nStarted < nThreads
+           && pthread_create(&threads[nStarted], NULL, loadFiles, &work) == 0)
+      nStarted++;
+    if (nStarted == 0)
+      (void)loadFiles(&work);
+    for (long ix = 0; ix < nStarted; ix++)
+      pthread_join(threads[ix], NULL);
+  }
+  pthread_mutex_destroy(&work.lock);
 
   for (int i = 0; i < nlocales; i++) {
-    snprintf (fname, namesize+15, "%.*s%d", namesize, fullfilename, i);
-    if (!LoadFile(fname, i, seq)) {
+    if (!work.ok[i]) {
       if (!fromArgv)
-        fl_message ("Error processing data from %s", fname);
+        fl_message ("Error processing data from %s", work.names[i].c_str());
       else
-        fl_message ("Error processing data from %s\n", fname);
+        fl_message ("Error processing data from %s\n", work.names[i].c_str());
       numLocales = -1;
       return 0;
     }
-    // Debug
-    /*
-
-    printf ("\nAfter file %s\n", fname);
-    itr = theEvents.begin();
-    while (itr != theEvents.end()) {
-      (*itr)->print();
-      itr++;
-    }
-    printf ("---------------\n");
-    */
-
   }
 
+  MergeEvents(fileEvents);
+
   // Build data structures, taglist: comms/tag
 
   if (tagList != NULL) {
@@ -209,7 +382,11 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
 
   if (taskTimeline != NULL)
     delete [] taskTimeline;
-  taskTimeline = new std::list<std::pair<Tl_Kind,long> >[numLocales];
+  taskTimeline = new std::vector<timelineEntry>[numLocales];
+
+  if (taskTag != NULL)
+    delete [] taskTag;
+  taskTag = new std::map<long,int>[numLocales];
 
   int cTagNo = TagStart;
   tagData *curTag = tagList[1];
@@ -217,8 +394,7 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
   // printf ("number of events %ld\n", (long)theEvents.size());
   // int DebC = 0;
 
-  itr = theEvents.begin();
-  while (itr != theEvents.end()) {
+  for (ix_e = 0; ix_e < (long)theEvents.size(); ix_e++) {
 
     // if ((DebC++ % 10) == 0 ) {printf ("\r%d", DebC); fflush(stdout); }
 
@@ -233,7 +409,7 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
     E_begin_task *btp = NULL;
     E_end_task   *etp = NULL;
 
-    Event *ev = *itr;
+    Event *ev = theEvents[ix_e];
     int curNodeId = ev->nodeId();
     curTag = tagList[cTagNo+2];
 
@@ -260,7 +436,7 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
         if (curNodeId == 0) {
           cTagNo++;
           curTag = tagList[cTagNo+2];
-          curTag->firstTag = itr;
+          curTag->firstTag = ix_e;
           curTag->name = gp->tagName();
         }
         // Set ref times on current tag
@@ -368,21 +544,22 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
       case Ev_comm:
         cp = (E_comm *)ev;
         for (int i = 0; i < 2; i++) {
-          if (++(curTag->comms[cp->srcId()][cp->dstId()].numComms) > curTag->maxComms)
+          curTag->comms[cp->srcId()][cp->dstId()].numComms += cp->numComms();
+          if (curTag->comms[cp->srcId()][cp->dstId()].numComms > curTag->maxComms)
             curTag->maxComms = curTag->comms[cp->srcId()][cp->dstId()].numComms;
           curTag->comms[cp->srcId()][cp->dstId()].commSize += cp->totalLen();
           if (curTag->comms[cp->srcId()][cp->dstId()].commSize > curTag->maxSize)
             curTag->maxSize = curTag->comms[cp->srcId()][cp->dstId()].commSize;
           if (cp->isGet())
-            curTag->comms[cp->srcId()][cp->dstId()].numGets++;
+            curTag->comms[cp->srcId()][cp->dstId()].numGets += cp->numComms();
           else
-            curTag->comms[cp->srcId()][cp->dstId()].numPuts++;
+            curTag->comms[cp->srcId()][cp->dstId()].numPuts += cp->numComms();
           // For 2nd time through loop, do the same thing for All
           curTag = tagList[0];
         }
 
-        // function communication
-        {
+        // function communication, summaries of sampled-out comms have no task
+        if (!cp->isSummary()) {
           taskData *task;
           long thisId = 0;
           if (cp->isGet()) {
@@ -457,6 +634,8 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
             fprintf (stderr, "Duplicate task! nodeId %d, taskId %ld\n",
                      curNodeId, tp->taskId());
           }
+          // Remember the tag for getTaskData, first one wins
+          (void)taskTag[curNodeId].insert(std::pair<long,int>(tp->taskId(), cTagNo));
         }
 
         // function event
@@ -510,10 +689,8 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
               }
               tryTagNo--;
             }
-            if (!validEnd) { // Erase this end record
-              itr = theEvents.erase(itr);
-              if (itr != theEvents.begin())
-                itr--;
+            if (!validEnd) { // Erase this end record, after this loop
+              theEvents[ix_e] = NULL;
               break;
             }
           }
@@ -537,11 +714,12 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
         // Shouldn't get here
         assert(false);
     }
-    // Move to next event record
-    if (itr != theEvents.end())
-      itr++;
   }
 
+  // Remove the end records erased above
+  theEvents.erase(std::remove(theEvents.begin(), theEvents.end(), (Event *)NULL),
+                  theEvents.end());
+
   // Go back and update task counts
   // printf ("Updating task counts ..\n");
   tagList[0]->locales[0].numTasks = 1;
@@ -565,17 +743,19 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
 
   // Build timeline and set concurrency rates
   // printf ("building timeline ..\n");
-  itr = theEvents.begin();
   tagList[0]->maxConc = 1;
   cTagNo = TagStart;
   curTag = tagList[1];
   curTag->locales[0].maxConc = 1;
   curTag->maxConc = 1;
 
+  // Tasks with a begin entry in the timeline, per locale
+  std::vector< std::set<long> > begunTasks(numLocales);
+
   // DebC = 0;
 
-  while (itr != theEvents.end()) {
-    Event *ev = *itr;
+  for (ix_e = 0; ix_e < (long)theEvents.size(); ix_e++) {
+    Event *ev = theEvents[ix_e];
     int curNodeId = ev->nodeId();
     E_tag *tp;
     E_begin_task *btp;
@@ -607,6 +787,7 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
         }
         assert(cTagNo == tp->tagNo());
         taskTimeline[curNodeId].push_back(timelineEntry(Tl_Tag,cTagNo));
+        curTag->locales[curNodeId].timelineStart = taskTimeline[curNodeId].size();
         curTag->locales[curNodeId].runConc
           = tagList[cTagNo+1]->locales[curNodeId].runConc;
         curTag->locales[curNodeId].maxConc = curTag->locales[curNodeId].runConc;
@@ -620,6 +801,7 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
             curTag->locales[curNodeId].tasks.end()) {
           // Found this task in the tag, it should be in the timeline
           taskTimeline[curNodeId].push_back(timelineEntry(Tl_Begin,btp->taskId()));
+          (void)begunTasks[curNodeId].insert(btp->taskId());
           curTag->locales[curNodeId].runConc++;
           if (curTag->locales[curNodeId].runConc >
               curTag->locales[curNodeId].maxConc) {
@@ -639,21 +821,13 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
 
       case Ev_end_task:
         etp = (E_end_task *)ev;
-        {
-          std::list< timelineEntry >::reverse_iterator tl_itr;
-          tl_itr = taskTimeline[curNodeId].rbegin();
-          while (tl_itr != taskTimeline[curNodeId].rend()) {
-            if (tl_itr->first == Tl_Begin
-                && tl_itr->second == etp->taskId()) {
-              // Found the begin record in the timeline, add the end record
-              taskTimeline[curNodeId].push_back(timelineEntry(Tl_End,etp->taskId()));
-              curTag->locales[curNodeId].runConc--;
-              break;
-            }
-            tl_itr++;
-          }
-          if (tl_itr == taskTimeline[curNodeId].rend())
-            printf ("Timeline: did not find task %ld, nid %d\n", etp->taskId(), curNodeId);
+        if (begunTasks[curNodeId].find(etp->taskId())
+            != begunTasks[curNodeId].end()) {
+          // Found the begin record in the timeline, add the end record
+          taskTimeline[curNodeId].push_back(timelineEntry(Tl_End,etp->taskId()));
+          curTag->locales[curNodeId].runConc--;
+        } else {
+          printf ("Timeline: did not find task %ld, nid %d\n", etp->taskId(), curNodeId);
         }
         break;
 
@@ -674,7 +848,7 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
 
       case Ev_comm:
         cp = (E_comm *)ev;
-        {
+        if (!cp->isSummary()) {
           taskData *theTask = getTaskData(cp->isGet() ? cp->dstId() : cp->srcId(), cp->inTask());
           if (theTask != NULL) {
             // Insert the event
@@ -693,9 +867,6 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
         }
         break;
     }
-
-    // Move to next event record
-    itr++;
   }
 
   // If duplicate tags, build unique tag information
@@ -760,15 +931,12 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
 #if 0
   // Debug print of full DB
   printf ("Final Events DB.\n");
-  itr = theEvents.begin();
-  while (itr != theEvents.end()) {
-    (*itr)->print();
-    itr++;
-  }
+  for (ix_e = 0; ix_e < (long)theEvents.size(); ix_e++)
+    theEvents[ix_e]->print();
 
   // Timeline debug
   printf ("\nTimeline for node 0.\n");
-  std::list<timelineEntry>::iterator tl_itr = taskTimeline[0].begin();
+  std::vector<timelineEntry>::iterator tl_itr = taskTimeline[0].begin();
   while (tl_itr != taskTimeline[0].end()) {
     switch (tl_itr->first) {
       case Tl_Tag: printf ("Tag: %ld\n", tl_itr->second); break;
@@ -794,11 +962,101 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
 }
 
 
+// Order for sorting a file's binary records by time
+
+static bool eventLess (Event *lh, Event *rh)
+{
+  return *lh < *rh;
+}
+
+// Add one of a file's events to fileEvents.  Events between Starts,
+// Tags, Pauses and Ends are collected in pending and sorted by time,
+// since a file's records need not be in time order.
+
+static void addFileEvent (Event *newEvent, std::vector<Event *> &pending,
+                          std::vector<Event *> &fileEvents)
+{
+  if (newEvent == NULL || newEvent->Ekind() <= Ev_end) {
+    std::stable_sort(pending.begin(), pending.end(), eventLess);
+    fileEvents.insert(fileEvents.end(), pending.begin(), pending.end());
+    pending.clear();
+  }
+  if (newEvent == NULL)
+    return;
+  if (newEvent->Ekind() <= Ev_end)
+    fileEvents.push_back(newEvent);
+  else
+    pending.push_back(newEvent);
+}
+
+// Merge the events of all the files into theEvents.  Every file has the
+// same sequence of Start, Tag, Pause and End events, which are grouped
+// together; the events between them are merged in time order.
+
+void DataModel::MergeEvents (std::vector< std::vector<Event*> > &fileEvents)
+{
+  size_t nFiles = fileEvents.size();
+  std::vector<size_t> pos(nFiles, 0);
+  size_t total = 0;
+
+  for (size_t f = 0; f < nFiles; f++)
+    total += fileEvents[f].size();
+  theEvents.clear();
+  theEvents.reserve(total);
+  numTags = 0;
+
+  while (theEvents.size() < total) {
+    // The next group
+    Event *first = NULL;
+    for (size_t f = 0; f < nFiles; f++) {
+      if (pos[f] < fileEvents[f].size()
+          && fileEvents[f][pos[f]]->Ekind() <= Ev_end) {
+        Event *ev = fileEvents[f][pos[f]++];
+        if (first == NULL) {
+          first = ev;
+        } else if (ev->Ekind() != first->Ekind()) {
+          fprintf (stderr, "Internal error, event mismatch. file %ld\n", (long)f);
+          printf ("newEvent: "); ev->print();
+          printf ("group: "); first->print();
+        }
+        if (ev->Ekind() == Ev_tag && ((E_tag *)ev)->tagNo() >= numTags)
+          numTags = ((E_tag *)ev)->tagNo() + 1;
+        theEvents.push_back(ev);
+      }
+    }
+
+    // Then everything up to the next group, each file is already sorted
+    size_t segStart = theEvents.size();
+    for (size_t f = 0; f < nFiles; f++) {
+      size_t segMid = theEvents.size();
+      while (pos[f] < fileEvents[f].size()
+             && fileEvents[f][pos[f]]->Ekind() > Ev_end)
+        theEvents.push_back(fileEvents[f][pos[f]++]);
+      std::inplace_merge(theEvents.begin() + segStart,
+                         theEvents.begin() + segMid,
+                         theEvents.end(), eventLess);
+    }
+  }
+
+  for (size_t f = 0; f < nFiles; f++)
+    std::vector<Event *>().swap(fileEvents[f]);
+}
+
 // Load the data in the current file
 
-int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
+int DataModel::LoadFile (const char *fileToOpen, int index, double seq,
+                         std::vector<Event*> &fileEvents,
+                         const char *section, size_t sectionLen)
 {
-  FILE *data = fopen(fileToOpen, "r");
+  // Files 1 and up are loaded in parallel, so only file 0 may change
+  // anything but fileEvents.
+  FILE *data;
+  if (section == NULL)
+    data = fopen(fileToOpen, "r");
+  else if (sectionLen > 0)
+    data = fmemopen((void *)section, sectionLen, "r");
+  else
+    data = NULL;
   char line[MAX_LINE_LEN];
 
   int floc;        // Number of locales in the file
@@ -809,6 +1067,9 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
 
   int  nErrs = 0;
 
+  // Offset of the binary event records, -1 for text event records
+  long binOffset = -1;
+
   if (!data) return 0;
 
   //printf ("LoadFile %s\n", fileToOpen);
@@ -835,7 +1096,8 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
 
   // Verify the data
 
-  if (floc != numLocales || findex != index || fabs(seq-fseq) > .01 || VerMinor != EXPECTED_VMINOR) {
+  if (floc != numLocales || findex != index || fabs(seq-fseq) > .01
+      || VerMinor < OLDEST_VMINOR || VerMinor > EXPECTED_VMINOR) {
     fprintf (stderr, "Data file %s does not match other data.\n", fileToOpen);
     return 0;
   }
@@ -846,21 +1108,14 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
   if (findex != 0)
     (void)vdbTids.insert(vdbTid);
 
-  // Create a start event with starting user/sys times.
-  std::list<Event *>::iterator itr = theEvents.begin();
+  // Events between the grouped ones, see addFileEvent
+  std::vector<Event *> pending;
 
-  // Other initializations
-  numTags = 0;
+  // Create a start event with starting user/sys times.
+  Event *newEvent = new E_start(e_sec, e_usec, findex, u_sec, u_usec, s_sec, s_usec);
+  addFileEvent(newEvent, pending, fileEvents);
 
   // Now read the rest of the file
-  Event *newEvent = new E_start(e_sec, e_usec, findex, u_sec, u_usec, s_sec, s_usec);
-  if (itr == theEvents.end()) {
-    theEvents.push_front(newEvent);
-  } else {
-    // Move past existing start events
-    while ((*itr)->Ekind() == Ev_start) { itr++; }
-    theEvents.insert(itr,newEvent);
-  }
 
   while ( fgets(line, MAX_LINE_LEN, data) == line ) {
     // Common Data
@@ -900,6 +1155,18 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
 
     int cvt;
 
+    // Binary records follow, see chpl-visual-debug-format.h
+    if (strncmp(line, "Binary:", 7) == 0) {
+      if (sscanf(line, "Binary: %d", &ix) != 1
+          || ix != (int)sizeof(chpl_vdebug_rec_t)) {
+        fprintf (stderr, "Unexpected binary record size in %s.\n", fileToOpen);
+        fclose(data);
+        return 0;
+      }
+      binOffset = ftell(data);
+      break;
+    }
+
     // Process the line
     linedata = strchr(line, ':');
     if (linedata) {
@@ -1128,8 +1395,6 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
         } else {
           newEvent = new E_tag(sec, usec, nid, u_sec, u_usec, s_sec, s_usec, tagId,
                                tagNames[tagId], vdbTid);
-          if (tagId >= numTags)
-            numTags = tagId+1;
           if (nid == 0) {
             nid0vdbtask = 0;
           }
@@ -1179,73 +1444,209 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
         /* Do nothing */ ;
     }
 
-    //  Add the newEvent to the list, group Starts, Tags, Resumes and Ends together.
-    if (newEvent) {
-      if (theEvents.empty()) {
-        theEvents.push_front (newEvent);
-      } else if (itr == theEvents.end()) {
-        theEvents.insert(itr, newEvent);
-      } else {
-        if (newEvent->Ekind() <= Ev_end) {
-          // Group together
-          while (itr != theEvents.end()
-                 && (*itr)->Ekind() != newEvent->Ekind())
-            itr++;
-          if (itr == theEvents.end() || (*itr)->Ekind() != newEvent->Ekind()) {
-            fprintf (stderr, "Internal error, event mismatch. file '%s'\n", fileToOpen); \
-            printf ("newEvent: "); newEvent->print();
-            if (itr != theEvents.end()) {
-               printf ("itr: "); (*itr)->print();
-            } else {
-               printf ("At end of list\n");
-            }
+    if (newEvent)
+      addFileEvent(newEvent, pending, fileEvents);
+  }
+
+  if (binOffset >= 0) {
+    // Map the binary records and turn them into events
+    struct stat sb;
+    const char *map = NULL;
+    size_t mapLen = 0;
+
+    if (section != NULL) {
+      map = section;
+      mapLen = sectionLen;
+    } else if (fstat(fileno(data), &sb) == 0 && sb.st_size > binOffset) {
+      mapLen = sb.st_size;
+      map = (const char *)mmap(NULL, mapLen, PROT_READ, MAP_PRIVATE,
+                               fileno(data), 0);
+      if (map == MAP_FAILED) {
+        fprintf (stderr, "Can't map %s: %s\n", fileToOpen, strerror(errno));
+        fclose(data);
+        return 0;
+      }
+      (void)madvise((void *)map, mapLen, MADV_SEQUENTIAL);
+    }
+
+    size_t nRecs = (mapLen - binOffset) / sizeof(chpl_vdebug_rec_t);
+    if (map != NULL && (mapLen - binOffset) % sizeof(chpl_vdebug_rec_t) != 0)
+      nErrs++;
+
+    for (size_t ri = 0; map != NULL && ri < nRecs; ri++) {
+      chpl_vdebug_rec_t rec;
+      memcpy(&rec, map + binOffset + ri * sizeof(rec), sizeof(rec));
+
+      int nid = rec.nodeID;
+      long sec = rec.sec;
+      long usec = rec.usec;
+      int taskid = rec.taskID;
+      int nfileno;
+      int fid;
+      int isGet;
+      int tagId;
+
+      newEvent = NULL;
+
+      switch (rec.kind) {
+
+        case chpl_vdebug_rec_vdb_mark:
+          if (nid == 0)
+            nid0vdbtask = taskid;
+          else
+            (void)vdbTids.insert(taskid);
+          break;
+
+        case chpl_vdebug_rec_task:
+          // On tasks are not real children of VDebug tasks
+          if (!rec.isOn && (vdbTids.find(rec.u.task.parentID) != vdbTids.end()
+                            || (nid == 0 && rec.u.task.parentID == nid0vdbtask))) {
+            (void)vdbTids.insert(taskid);
           } else {
-            // More complicated ... move past proper kinds ...
-            E_tag *tp = NULL;
-            if (newEvent->Ekind() == Ev_start || newEvent->Ekind() == Ev_end) {
-              // Just find the end of the group
-              while (itr != theEvents.end() && (*itr)->Ekind() == newEvent->Ekind())
-                itr++;
-            } else {
-              // Need to move past them only if they have the same tag!
-              if (newEvent->Ekind() == Ev_tag) {
-                // Work with tags
-                tp = (E_tag *)newEvent;
-                while (itr != theEvents.end()
-                       && (*itr)->Ekind() == Ev_tag
-                       && ((E_tag *)(*itr))->tagNo() == tp->tagNo())
-                  itr++;
-              } else {
-                // Work with pauses
-                E_pause *rp = (E_pause *)newEvent;
-                while (itr != theEvents.end()
-                       && (*itr)->Ekind() == Ev_pause
-                       && ((E_pause *)(*itr))->tagId() == rp->tagId())
-                  itr++;
-              }
-            }
-            /*std::list<Event*>::iterator newElem = */ theEvents.insert (itr, newEvent);
-            //      if (tp != NULL && tp->nodeId() == 0) {
-            //        tagVec[tp->tagNo()-1] = newElem;
-            //      }
+            nfileno = rec.u.task.fileno;
+            if (nfileno < 0 || nfileno >= fileTblSize) nfileno = 0;
+            fid = rec.u.task.fid < 0 ? 0 : rec.u.task.fid;
+            newEvent = new E_task (sec, usec, nid, taskid, fid, rec.isOn,
+                                   rec.lineno, nfileno);
           }
-        } else {
-          // Insert by time
-          while (itr != theEvents.end() &&
-                 (*itr)->Ekind() > Ev_end &&
-                 **itr < *newEvent)
-            itr++;
-          theEvents.insert (itr, newEvent);
+          break;
+
+        case chpl_vdebug_rec_put_nb:
+        case chpl_vdebug_rec_get_nb:
+        case chpl_vdebug_rec_put:
+        case chpl_vdebug_rec_get:
+        case chpl_vdebug_rec_put_strd:
+        case chpl_vdebug_rec_get_strd:
+          if (vdbTids.find(taskid) != vdbTids.end())
+            break;
+          nfileno = rec.u.comm.fileno;
+          if (nfileno < 0 || nfileno >= fileTblSize) nfileno = 0;
+          isGet = (rec.kind == chpl_vdebug_rec_get_nb
+                   || rec.kind == chpl_vdebug_rec_get
+                   || rec.kind == chpl_vdebug_rec_get_strd);
+          if (isGet)
+            newEvent = new E_comm (sec, usec, rec.u.comm.remoteNodeID, nid,
+                                   rec.u.comm.elemSize, rec.u.comm.length,
+                                   isGet, taskid, rec.lineno, nfileno);
+          else
+            newEvent = new E_comm (sec, usec, nid, rec.u.comm.remoteNodeID,
+                                   rec.u.comm.elemSize, rec.u.comm.length,
+                                   isGet, taskid, rec.lineno, nfileno);
+          break;
+
+        case chpl_vdebug_rec_fork:
+        case chpl_vdebug_rec_fork_nb:
+        case chpl_vdebug_rec_fork_fast:
+          if (vdbTids.find(taskid) != vdbTids.end())
+            break;
+          fid = rec.u.fork.fid < 0 ? 0 : rec.u.fork.fid;
+          newEvent = new E_fork(sec, usec, nid, rec.u.fork.remoteNodeID,
+                                rec.u.fork.argSize,
+                                rec.kind == chpl_vdebug_rec_fork_fast,
+                                taskid, fid);
+          break;
+
+        case chpl_vdebug_rec_pause:
+          newEvent = new E_pause(sec, usec, nid,
+                                 rec.u.times.userSec, rec.u.times.userUsec,
+                                 rec.u.times.sysSec, rec.u.times.sysUsec,
+                                 rec.u.times.tagno, taskid);
+          if (nid == 0)
+            nid0vdbtask = 0;
+          break;
+
+        case chpl_vdebug_rec_tag:
+          tagId = rec.u.times.tagno;
+          if (tagId < 0 || (unsigned)tagId >= tagNames.size()) {
+            fprintf (stderr, "Bad 'Tag' record: %s\n", fileToOpen);
+            nErrs++;
+            break;
+          }
+          newEvent = new E_tag(sec, usec, nid,
+                               rec.u.times.userSec, rec.u.times.userUsec,
+                               rec.u.times.sysSec, rec.u.times.sysUsec,
+                               tagId, tagNames[tagId], taskid);
+          if (nid == 0)
+            nid0vdbtask = 0;
+          break;
+
+        case chpl_vdebug_rec_end:
+          newEvent = new E_end(sec, usec, nid,
+                               rec.u.times.userSec, rec.u.times.userUsec,
+                               rec.u.times.sysSec, rec.u.times.sysUsec, taskid);
+          break;
+
+        case chpl_vdebug_rec_end_task:
+          if (vdbTids.find(taskid) == vdbTids.end())
+            newEvent = new E_end_task(sec, usec, nid, taskid);
+          break;
+
+        case chpl_vdebug_rec_begin_task:
+          if (vdbTids.find(taskid) == vdbTids.end())
+            newEvent = new E_begin_task(sec, usec, nid, taskid);
+          break;
+
+        case chpl_vdebug_rec_comm_sum:
+          // Puts or gets that were sampled out.  Put summaries go from
+          // this node, get summaries come to it.
+          if (rec.u.commSum.isGet)
+            newEvent = new E_comm (sec, usec, rec.u.commSum.remoteNodeID, nid,
+                                   true, rec.u.commSum.count,
+                                   rec.u.commSum.bytes);
+          else
+            newEvent = new E_comm (sec, usec, nid, rec.u.commSum.remoteNodeID,
+                                   false, rec.u.commSum.count,
+                                   rec.u.commSum.bytes);
+          break;
+
+        case chpl_vdebug_rec_tag_name: {
+          // The name is in the records that follow
+          size_t nameRecs = (rec.u.tagName.len + sizeof(rec) - 1) / sizeof(rec);
+          tagId = rec.u.tagName.tagno;
+          if (tagId < 0 || rec.u.tagName.len < 0 || rec.u.tagName.len > MAXPATHLEN
+              || ri + nameRecs >= nRecs) {
+            fprintf (stderr, "Bad tag name record: %s\n", fileToOpen);
+            nErrs++;
+            ri = nRecs;
+            break;
+          }
+          char tmpname[MAXPATHLEN+1];
+          memcpy(tmpname, map + binOffset + (ri+1) * sizeof(rec),
+                 rec.u.tagName.len);
+          tmpname[rec.u.tagName.len] = 0;
+          ri += nameRecs;
+          if (findex != 0)    // Only node 0 names tags
+            break;
+          if (tagNames.size() <= (unsigned)tagId) {
+            if (tagNames.size() == 0)
+              tagNames.resize(64);
+            while (tagNames.size() <= (unsigned)tagId)
+              tagNames.resize(2*tagNames.size());
+          }
+          tagNames[tagId] = strDB.getString(tmpname);
+          break;
         }
+
+        default:
+          nErrs++;
+          break;
       }
+
+      if (newEvent)
+        addFileEvent(newEvent, pending, fileEvents);
     }
+
+    if (map != NULL && section == NULL)
+      (void)munmap((void *)map, mapLen);
   }
 
+  addFileEvent(NULL, pending, fileEvents);
+
   // Remove any task or Btask records that are in the vdbTids db.
-  itr = theEvents.begin();
-  while (itr != theEvents.end()) {
+  size_t keep = 0;
+  for (size_t ix = 0; ix < fileEvents.size(); ix++) {
     bool doErase = false;
-    Event *ev = *itr;
+    Event *ev = fileEvents[ix];
     // ev->print();
     if (ev->nodeId() == findex) {
       switch (ev->Ekind()) {
@@ -1262,14 +1663,11 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
         default:
           break;
       }
-      if (doErase)
-        itr = theEvents.erase(itr);
-      else
-        itr++;
-    } else {
-      itr++;
     }
+    if (!doErase)
+      fileEvents[keep++] = ev;
   }
+  fileEvents.resize(keep);
 
   if (nErrs) fprintf(stderr, "%d errors in data file '%s'.\n", nErrs, fileToOpen);
 
@@ -1278,9 +1676,10 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
   //         fileToOpen, ignoreFork, ignoreTask);
   //  }
 
-  if ( !feof(data) ) return 0;
+  int atEnd = binOffset >= 0 || feof(data);
+  fclose(data);
 
-  return 1;
+  return atEnd;
 }
 
 // Get the task data by task Id and locale.
@@ -1300,13 +1699,14 @@ taskData * DataModel::getTaskData (long locale, long taskId, long tagNo)
       return &(tskItr->second);
   }
 
-  curTag = TagStart;
-  while (curTag < numTags) {
-    tskItr = tagList[curTag+2]->locales[locale].tasks.find(taskId);
-    if (tskItr != tagList[curTag+2]->locales[locale].tasks.end())
-      return &(tskItr->second);
-    curTag++;
-  }
+  // Look in the tag the task was created in
+  std::map<long,int>::iterator tagItr = taskTag[locale].find(taskId);
+  if (tagItr == taskTag[locale].end())
+    return NULL;
+  curTag = tagItr->second;
+  tskItr = tagList[curTag+2]->locales[locale].tasks.find(taskId);
+  if (tskItr != tagList[curTag+2]->locales[locale].tasks.end())
+    return &(tskItr->second);
 
   return NULL;
 }
@@ -25,9 +25,10 @@
 #include <list>
 #include <vector>
 #include <map>
+#include <set>
 #include "StringCache.h"
 
-// This class builds a list of events 
+// This class builds a vector of events 
 //   Start, Stop, Pause, and Tag events are grouped together 
 //   Other events are placed in a time sorted group between
 //   the grouped events.
@@ -35,9 +36,13 @@
 // This is the class that reads the files as generated by runtime/src/chpl-visual-debug.c
 // in the Chapel runtime.
 //
-// Initially the data files are in ascii.  To turn these into binary data files,
-// both this class and runtime/src/chpl-visual-debug.c need to be modified to
-// write (chpl-visual-debug.c) and read (this class) in binary.
+// The data files start with a text header.  Version 1.5 files then have
+// binary event records (see runtime/include/chpl-visual-debug-format.h),
+// version 1.4 files have text event records.
+//
+// Events are kept in vectors rather than lists, and tasks and timelines
+// are indexed per locale and per tag when the data is loaded, so that
+// switching tags doesn't need to walk all the events.
 
 // Support Structs used by DataModel
 
@@ -59,7 +64,7 @@ struct taskData {
   E_end_task *endRec;
   int endTagNo;
   double taskClock;
-  std::list<Event *>commList;
+  std::vector<Event *>commList;
   commData commSum;
 
   taskData() : taskRec(NULL), beginRec(NULL), endRec(NULL), endTagNo(-2) {};
@@ -78,12 +83,13 @@ struct localeData {
   long    numTasks;
   long    runConc;
   long    maxConc;
+  long    timelineStart;   // Index in taskTimeline of the first entry in the tag
 
   std::map<long,taskData> tasks;
 
   localeData() : userCpu(0), sysCpu(0), Cpu(0), refUserCpu(0), refSysCpu(0),
                  clockTime(0), refTime(0), maxTaskClock(0), // minTaskClock(1E10),
-                 numTasks(0), runConc(0), maxConc(0) {};
+                 numTasks(0), runConc(0), maxConc(0), timelineStart(0) {};
 };
 
 // File names, rel2Home says the names starts with $CHPL_HOME
@@ -97,7 +103,7 @@ typedef struct funcInfo {
   char *name;
   long  fileNo;
   long  lineNo;
-  std::list<Event *> func_events;
+  std::vector<Event *> func_events;
   long  noOnTasks;
   long  noTasks;
   long  noGets;
@@ -124,7 +130,7 @@ class DataModel {
   //     long => task number or tag number
   enum Tl_Kind { Tl_Tag, Tl_Begin, Tl_End };
   typedef std::pair < Tl_Kind, long > timelineEntry;
-  std::list < timelineEntry > *taskTimeline;
+  std::vector < timelineEntry > *taskTimeline;
 
  private:
 
@@ -143,10 +149,12 @@ class DataModel {
 
   funcInfo *funcTbl;
   int funcTblSize;
+
+  // Per locale index of the tag each task was created in
+  std::map<long,int> *taskTag;
   
   std::vector<const char *> tagNames;
 
-  typedef std::list<Event*>::iterator evItr;
 
   int numLocales;
   int numTags;
@@ -159,12 +167,16 @@ class DataModel {
   std::map<const char *, int> name2tag;
   tagData **utagList;
 
-  std::list < Event* > theEvents;
-  std::list < Event* >::iterator curEvent;
+  std::vector < Event* > theEvents;
   
   // Utility routines
   
-  int LoadFile (const char *filename, int index, double seq);
+  int LoadFile (const char *filename, int index, double seq,
+                std::vector<Event*> &fileEvents,
+                const char *section = NULL, size_t sectionLen = 0);
+  struct loadWork;
+  static void *loadFiles (void *arg);
+  void MergeEvents (std::vector< std::vector<Event*> > &fileEvents);
   
   void newList ();
   
@@ -194,7 +206,8 @@ class DataModel {
     long   maxSize;
     
     tagData(long numLoc) : numLocales(numLoc), name(""),  maxCpu(0), maxClock(0),
-                           maxTasks(0),  maxConc(0), maxComms(0), maxSize(0) {
+                           maxTasks(0),  maxConc(0), maxComms(0), maxSize(0),
+                           firstTag(0) {
       locales = new localeData[numLocales];
       comms = new  commData * [numLocales];
       for (int i = 0; i < numLocales; i++ )
@@ -213,7 +226,7 @@ class DataModel {
     }
 
     private:
-      evItr firstTag;
+      long firstTag;    // Index in theEvents of the first Tag record
   };
   // End of struct tagData
 
@@ -244,7 +257,7 @@ class DataModel {
   taskData * getTaskData (long locale, long taskId, long tagNo = TagALL);
 
   double start_clock() {
-    return (*theEvents.begin())->clock_time();
+    return theEvents.front()->clock_time();
   }
 
   // File name access
@@ -289,7 +302,7 @@ class DataModel {
     numTags = 0;
     tagList = NULL;
     taskTimeline = NULL;
-    curEvent = theEvents.begin();
+    taskTag = NULL;
     uniqueTags = true;
     utagList = NULL;
     tagNames.resize(64);
@@ -304,6 +317,8 @@ class DataModel {
     }
     if (taskTimeline != NULL)
       delete [] taskTimeline;
+    if (taskTag != NULL)
+      delete [] taskTag;
     if (utagList != NULL) {
       for (unsigned int ix = 0; ix < name2tag.size(); ix++)
         delete utagList[ix];
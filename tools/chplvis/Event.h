@@ -121,24 +121,36 @@ class E_comm : public Event {
 
    private:
      int  dstid;
-     int  elemsize, datalen;
+     int  elemsize;
+     long datalen;
      bool isget;
      long byTask;
      long lineNo;
      long srcFileNo;
+     long ncomms;      // > 1 only for a summary of sampled-out comms
+     bool summary;
 
    public:
      E_comm (long esec, long eusec, int esrcid, int edstid, int elSize,
-             int dLen, bool get, long origTask, long line, long fileno) :
+             long dLen, bool get, long origTask, long line, long fileno) :
           Event(esec, eusec, esrcid), dstid(edstid), elemsize(elSize),
             datalen(dLen), isget(get), byTask(origTask), lineNo(line),
-            srcFileNo(fileno) {};
+            srcFileNo(fileno), ncomms(1), summary(false) {};
+
+     // Summary of comms that were not recorded individually, not in any task
+     E_comm (long esec, long eusec, int esrcid, int edstid, bool get,
+             long count, long bytes) :
+          Event(esec, eusec, esrcid), dstid(edstid), elemsize(1),
+            datalen(bytes), isget(get), byTask(-1), lineNo(0),
+            srcFileNo(0), ncomms(count), summary(true) {};
 
      int srcId() { return nodeId(); }
      int dstId() { return dstid; }
      int elemSize() { return elemsize; }
-     int dataLen() { return datalen; }
-     int totalLen() { return elemsize * datalen; }
+     long dataLen() { return datalen; }
+     long totalLen() { return elemsize * datalen; }
+     long numComms() { return ncomms; }
+     bool isSummary() { return summary; }
      bool isGet() { return isget; }
      long srcLine () { return lineNo; }
      long srcFile () { return srcFileNo; }
@@ -146,9 +158,12 @@ class E_comm : public Event {
 
      virtual int Ekind() {return Ev_comm;}
      virtual void print() { 
-       printf ("Comm(%s): node %d time %ld.%06ld to %d size %d, inTask %ld\n",
+       printf ("Comm(%s): node %d time %ld.%06ld to %d size %ld, inTask %ld",
                isget ? "get" : "put", nodeid, sec, usec, dstid, 
                elemsize * datalen, byTask);
+       if (summary)
+         printf (", %ld comms", ncomms);
+       printf ("\n");
      }
 };
 
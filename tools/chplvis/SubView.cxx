@@ -140,7 +140,7 @@ bool SubView::ShowTaskComm (taskData *task)
   // Data lines
   SelectBrowser *theList = new SelectBrowser (x(), y()+24, w(), h()-24);
   theList->callback(CommListItemClickCB);
-  std::list<Event *>::iterator itr;
+  std::vector<Event *>::iterator itr;
   itr = task->commList.begin();
   while (itr != task->commList.end()) {
     E_fork *fp;
@@ -163,12 +163,12 @@ bool SubView::ShowTaskComm (taskData *task)
       fName = VisData.fileName(cp->srcFile());
       if (cp->isGet()) 
         snprintf (tmpText, sizeof(tmpText),
-                  "[%f] Get from %d, total size %d, file %s:%ld\n",
+                  "[%f] Get from %d, total size %ld, file %s:%ld\n",
                   cp->clock_time() - startTime, cp->srcId(), cp->totalLen(), 
                   (fName[0] == '$' ? &fName[11] : fName), cp->srcLine());
       else
         snprintf (tmpText, sizeof(tmpText),
-                  "[%f] Put to %d, total size %d, file %s:%ld\n",
+                  "[%f] Put to %d, total size %ld, file %s:%ld\n",
                   cp->clock_time() - startTime, cp->dstId(), cp->totalLen(),
                   (fName[0] == '$' ? &fName[11] : fName), cp->srcLine());
       theList->add(tmpText);
@@ -187,7 +187,7 @@ bool SubView::ShowTaskComm (taskData *task)
 
 void SubView::TaskCommCB (void)
 {
-  std::list<Event *>::iterator itr;
+  std::vector<Event *>::iterator itr;
   SelectBrowser *theList = (SelectBrowser *)body;
 
   int ix = 1;  // Browser indexes start at 1, not 0
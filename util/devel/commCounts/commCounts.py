@@ -0,0 +1,220 @@
+#!/usr/bin/env python3
+
+"""
+Run multi-locale programs with communication diagnostics on and check the
+per-locale counts against stored expectations.
+
+Each program in the list (tests.txt by default) is compiled and run with
+CHPL_RT_COMM_DIAGS_COUNTS_FILE set, which has every locale write the
+counts for the user program to a file at exit.  The GET, PUT, AMO and
+on-statement counts and the GET/PUT byte totals are compared against
+expected.json; the script exits with status 1 if any count went up.
+Counts that went down are reported so the expectations can be tightened.
+
+With --update the counts become the new expectations.  Expectations are
+per communication layer, so record them with the configuration CI runs,
+e.g. CHPL_COMM=gasnet with CHPL_COMM_SUBSTRATE=smp.  With CHPL_COMM=none
+every program runs on one locale.
+
+Usage:
+
+  commCounts.py [--update] [--expected FILE] [--slack FRACTION] [TEST...]
+"""
+
+import argparse
+import glob
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+
+script_dir = os.path.dirname(os.path.abspath(__file__))
+
+# Counters that don't depend on timing.  The cache and non-blocking test
+# and wait counts do, so they are recorded but not checked.
+checked = ['get', 'put', 'get_nb', 'put_nb', 'amo',
+           'execute_on', 'execute_on_fast', 'execute_on_nb',
+           'get_bytes', 'put_bytes', 'get_nb_bytes', 'put_nb_bytes']
+
+
+def find_chpl_home():
+    if 'CHPL_HOME' in os.environ:
+        return os.environ['CHPL_HOME']
+    return os.path.abspath(os.path.join(script_dir, '..', '..', '..'))
+
+
+def find_chpl(chpl_home):
+    chpl = shutil.which('chpl')
+    if chpl is not None:
+        return chpl
+
+    found = sorted(glob.glob(os.path.join(chpl_home, 'bin', '*', 'chpl')))
+    if not found:
+        sys.exit('commCounts: cannot find chpl; build the compiler first')
+    return found[0]
+
+
+def chpl_comm(chpl):
+    out = subprocess.run([chpl, '--print-chpl-settings'],
+                         stdout=subprocess.PIPE, universal_newlines=True)
+    match = re.search(r'^\s*CHPL_COMM\s*[:=]\s*(\S+)', out.stdout, re.M)
+    return match.group(1) if match else os.environ.get('CHPL_COMM', 'none')
+
+
+def read_list(filename):
+    tests = []
+    with open(filename) as f:
+        for line in f:
+            line = line.split('#', 1)[0].strip()
+            if line:
+                tests.append(line)
+    return tests
+
+
+def read_opts(program_path, suffix):
+    """The first line of the program's .compopts/.execopts file."""
+    opts = os.path.splitext(program_path)[0] + suffix
+    if not os.path.exists(opts):
+        return []
+    with open(opts) as f:
+        first = f.readline()
+    return first.split('#', 1)[0].split()
+
+
+def num_locales(program_path, comm):
+    if comm == 'none':
+        return 1
+    nl = os.path.splitext(program_path)[0] + '.numlocales'
+    if not os.path.exists(nl):
+        return 2
+    with open(nl) as f:
+        return int(f.readline().split()[0])
+
+
+def run_test(chpl, test_dir, test, comm, work_dir):
+    """Compile and run 'test'; return a list of per-locale count dicts."""
+    program_path = os.path.join(test_dir, test)
+    cwd = os.path.dirname(program_path)
+    base = os.path.splitext(os.path.basename(test))[0]
+    exe = os.path.join(work_dir, base)
+    counts = os.path.join(work_dir, base + '.counts')
+    nl = num_locales(program_path, comm)
+
+    cmd = ([chpl, os.path.basename(program_path), '-o', exe]
+           + read_opts(program_path, '.compopts'))
+    proc = subprocess.run(cmd, cwd=cwd, stdout=subprocess.PIPE,
+                          stderr=subprocess.STDOUT, universal_newlines=True)
+    if proc.returncode != 0:
+        sys.stderr.write(proc.stdout)
+        sys.exit('commCounts: {0} failed to compile'.format(test))
+
+    for stale in glob.glob(counts + '.*'):
+        os.remove(stale)
+
+    env = dict(os.environ, CHPL_RT_COMM_DIAGS_COUNTS_FILE=counts)
+    cmd = [exe, '-nl', str(nl)] + read_opts(program_path, '.execopts')
+    proc = subprocess.run(cmd, cwd=cwd, env=env, stdout=subprocess.PIPE,
+                          stderr=subprocess.STDOUT, universal_newlines=True)
+    if proc.returncode != 0:
+        sys.stderr.write(proc.stdout)
+        sys.exit('commCounts: {0} failed to run'.format(test))
+
+    locales = []
+    for node in range(nl):
+        filename = '{0}.{1}'.format(counts, node)
+        if not os.path.exists(filename):
+            sys.exit('commCounts: {0} wrote no counts for locale {1}'
+                     .format(test, node))
+        with open(filename) as f:
+            locales.append({k: int(v) for k, v in
+                            (line.split() for line in f if line.strip())})
+    return locales
+
+
+def compare(test, expected, actual, slack):
+    failures = []
+    if len(expected) != len(actual):
+        failures.append('{0}: ran on {1} locales, expected {2}'
+                        .format(test, len(actual), len(expected)))
+        return failures
+
+    for node, (old, new) in enumerate(zip(expected, actual)):
+        for counter in checked:
+            o = old.get(counter, 0)
+            n = new.get(counter, 0)
+            if n > o * (1.0 + slack):
+                failures.append('{0}: locale {1} {2} went from {3} to {4}'
+                                .format(test, node, counter, o, n))
+            elif n < o:
+                print('commCounts: {0}: locale {1} {2} went from {3} to {4};'
+                      ' consider --update'.format(test, node, counter, o, n))
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('tests', nargs='*',
+                        help='tests to run instead of the list')
+    parser.add_argument('--list',
+                        default=os.path.join(script_dir, 'tests.txt'))
+    parser.add_argument('--expected',
+                        default=os.path.join(script_dir, 'expected.json'))
+    parser.add_argument('--update', action='store_true',
+                        help='write the counts as the new expectations')
+    parser.add_argument('--slack', type=float, default=0.0,
+                        help='fraction by which a count may grow')
+    args = parser.parse_args()
+
+    chpl_home = find_chpl_home()
+    chpl = find_chpl(chpl_home)
+    test_dir = os.path.join(chpl_home, 'test')
+    comm = chpl_comm(chpl)
+    tests = args.tests or read_list(args.list)
+
+    expected = {}
+    if os.path.exists(args.expected):
+        with open(args.expected) as f:
+            expected = json.load(f)
+    elif not args.update:
+        sys.exit('commCounts: no expectations in {0}; run with --update'
+                 .format(args.expected))
+
+    work_dir = tempfile.mkdtemp(prefix='commCounts.')
+    results = {}
+    try:
+        for test in tests:
+            results[test] = run_test(chpl, test_dir, test, comm, work_dir)
+            print('{0}: {1}'.format(test, ', '.join(
+                '{0} {1}'.format(c, sum(l.get(c, 0) for l in results[test]))
+                for c in ('get', 'put', 'amo', 'execute_on'))))
+    finally:
+        shutil.rmtree(work_dir, ignore_errors=True)
+
+    if args.update:
+        expected.setdefault(comm, {}).update(results)
+        with open(args.expected, 'w') as f:
+            json.dump(expected, f, indent=2, sort_keys=True)
+            f.write('\n')
+        print('commCounts: wrote {0}'.format(args.expected))
+        return 0
+
+    failures = []
+    for test, actual in results.items():
+        old = expected.get(comm, {}).get(test)
+        if old is None:
+            print('commCounts: no expectations for {0} with CHPL_COMM={1}'
+                  .format(test, comm))
+            continue
+        failures += compare(test, old, actual, args.slack)
+
+    for failure in failures:
+        print('REGRESSION ' + failure)
+    return 1 if failures else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
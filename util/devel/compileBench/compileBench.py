@@ -0,0 +1,239 @@
+#!/usr/bin/env python3
+
+"""
+Compile a fixed set of programs and check the compiler's time and memory
+use against stored baselines.
+
+For each program in the corpus (corpus.txt by default) this runs chpl with
+--profile-compile and --print-passes-file and records:
+
+  - the time spent in each pass, and the total over all passes
+  - the compiler's peak resident set size
+  - the size of the generated code (--savec output) and of the executable
+
+With --update the results become the new baselines.  Otherwise they are
+compared against the baselines and the script exits with status 1 if any
+measurement grew by more than its threshold.  The time thresholds have an
+absolute floor so short passes don't fail on timer noise.
+
+Usage:
+
+  compileBench.py [--update] [--baseline FILE] [--repeat N] [--keep DIR]
+"""
+
+import argparse
+import glob
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+
+script_dir = os.path.dirname(os.path.abspath(__file__))
+
+
+def find_chpl_home():
+    if 'CHPL_HOME' in os.environ:
+        return os.environ['CHPL_HOME']
+    return os.path.abspath(os.path.join(script_dir, '..', '..', '..'))
+
+
+def find_chpl(chpl_home):
+    chpl = shutil.which('chpl')
+    if chpl is not None:
+        return chpl
+
+    found = sorted(glob.glob(os.path.join(chpl_home, 'bin', '*', 'chpl')))
+    if not found:
+        sys.exit('compileBench: cannot find chpl; build the compiler first')
+    return found[0]
+
+
+def read_corpus(filename):
+    programs = []
+    with open(filename) as f:
+        for line in f:
+            line = line.split('#', 1)[0].strip()
+            if line:
+                programs.append(line)
+    return programs
+
+
+def read_compopts(program_path):
+    """The first line of the program's .compopts file, without comments."""
+    compopts = os.path.splitext(program_path)[0] + '.compopts'
+    if not os.path.exists(compopts):
+        return []
+    with open(compopts) as f:
+        first = f.readline()
+    return first.split('#', 1)[0].split()
+
+
+def dir_size(path):
+    total = 0
+    for root, _, files in os.walk(path):
+        for name in files:
+            total += os.path.getsize(os.path.join(root, name))
+    return total
+
+
+def read_profile(filename):
+    """Per-pass seconds and the peak RSS in KiB from a --profile-compile
+       trace.  A trace cut short by an error has no closing bracket."""
+    with open(filename) as f:
+        text = f.read().strip()
+    if not text.endswith(']'):
+        text += ']'
+
+    passes = {}
+    peak_rss = 0
+    for event in json.loads(text):
+        if event.get('cat') != 'pass':
+            continue
+        name = event['name']
+        passes[name] = passes.get(name, 0.0) + event['dur'] / 1e6
+        peak_rss = max(peak_rss, event['args'].get('peakRssKB', 0))
+    return passes, peak_rss
+
+
+def compile_once(chpl, test_dir, program, work_dir):
+    program_path = os.path.join(test_dir, program)
+    base = os.path.splitext(os.path.basename(program))[0]
+    profile = os.path.join(work_dir, base + '.profile.json')
+    passes_log = os.path.join(work_dir, base + '.passes')
+    savec = os.path.join(work_dir, base + '.c')
+    exe = os.path.join(work_dir, base)
+
+    shutil.rmtree(savec, ignore_errors=True)
+
+    cmd = [chpl, os.path.basename(program_path),
+           '--profile-compile', profile,
+           '--print-passes-file', passes_log,
+           '--savec', savec,
+           '-o', exe] + read_compopts(program_path)
+
+    proc = subprocess.run(cmd, cwd=os.path.dirname(program_path),
+                          stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                          universal_newlines=True)
+    if proc.returncode != 0:
+        sys.stderr.write(proc.stdout)
+        sys.exit('compileBench: {0} failed to compile'.format(program))
+
+    passes, peak_rss = read_profile(profile)
+    exe_size = os.path.getsize(exe) if os.path.exists(exe) else 0
+
+    return {'passes': passes,
+            'totalSecs': sum(passes.values()),
+            'peakRssKB': peak_rss,
+            'codeBytes': dir_size(savec),
+            'exeBytes': exe_size}
+
+
+def measure(chpl, test_dir, program, work_dir, repeat):
+    """Compile 'program' 'repeat' times, keeping the fastest time for each
+       pass and the smallest peak RSS."""
+    best = None
+    for _ in range(repeat):
+        result = compile_once(chpl, test_dir, program, work_dir)
+        if best is None:
+            best = result
+            continue
+        for name, secs in result['passes'].items():
+            best['passes'][name] = min(best['passes'].get(name, secs), secs)
+        best['totalSecs'] = min(best['totalSecs'], result['totalSecs'])
+        best['peakRssKB'] = min(best['peakRssKB'], result['peakRssKB'])
+    return best
+
+
+def check(name, what, old, new, rel, floor, failures):
+    limit = old * (1.0 + rel) + floor
+    if new > limit:
+        failures.append('{0}: {1} went from {2:g} to {3:g} (limit {4:g})'
+                        .format(name, what, old, new, limit))
+
+
+def compare(baseline, results, args):
+    failures = []
+    for program, new in results.items():
+        old = baseline.get(program)
+        if old is None:
+            print('compileBench: no baseline for {0}'.format(program))
+            continue
+        check(program, 'total time', old['totalSecs'], new['totalSecs'],
+              args.time_threshold, args.time_floor, failures)
+        for pass_name, secs in new['passes'].items():
+            check(program, 'time in ' + pass_name,
+                  old['passes'].get(pass_name, 0.0), secs,
+                  args.pass_threshold, args.time_floor, failures)
+        check(program, 'peak RSS (KiB)', old['peakRssKB'], new['peakRssKB'],
+              args.rss_threshold, 0, failures)
+        check(program, 'generated code (bytes)', old['codeBytes'],
+              new['codeBytes'], args.size_threshold, 0, failures)
+        check(program, 'executable (bytes)', old['exeBytes'],
+              new['exeBytes'], args.size_threshold, 0, failures)
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--corpus',
+                        default=os.path.join(script_dir, 'corpus.txt'))
+    parser.add_argument('--baseline',
+                        default=os.path.join(script_dir, 'baseline.json'))
+    parser.add_argument('--update', action='store_true',
+                        help='write the results as the new baselines')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='compiles per program; the best is kept')
+    parser.add_argument('--keep', metavar='DIR',
+                        help='keep the profiles, pass logs and code in DIR')
+    parser.add_argument('--time-threshold', type=float, default=0.05)
+    parser.add_argument('--pass-threshold', type=float, default=0.15)
+    parser.add_argument('--time-floor', type=float, default=0.05,
+                        help='seconds of slack on every time check')
+    parser.add_argument('--rss-threshold', type=float, default=0.05)
+    parser.add_argument('--size-threshold', type=float, default=0.02)
+    args = parser.parse_args()
+
+    chpl_home = find_chpl_home()
+    chpl = find_chpl(chpl_home)
+    test_dir = os.path.join(chpl_home, 'test')
+
+    work_dir = args.keep or tempfile.mkdtemp(prefix='compileBench.')
+    os.makedirs(work_dir, exist_ok=True)
+
+    results = {}
+    try:
+        for program in read_corpus(args.corpus):
+            result = measure(chpl, test_dir, program, work_dir, args.repeat)
+            print('{0}: {1:.2f}s, peak RSS {2} KiB, {3} bytes of code'
+                  .format(program, result['totalSecs'], result['peakRssKB'],
+                          result['codeBytes']))
+            results[program] = result
+    finally:
+        if args.keep is None:
+            shutil.rmtree(work_dir, ignore_errors=True)
+
+    if args.update:
+        with open(args.baseline, 'w') as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+            f.write('\n')
+        print('compileBench: wrote {0}'.format(args.baseline))
+        return 0
+
+    if not os.path.exists(args.baseline):
+        sys.exit('compileBench: no baselines in {0}; run with --update'
+                 .format(args.baseline))
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+
+    failures = compare(baseline, results, args)
+    for failure in failures:
+        print('REGRESSION ' + failure)
+    return 1 if failures else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())